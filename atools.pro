@@ -42,6 +42,10 @@
 # Optional. Set this to "true" to omit all GRIB2 decoding code if not needed.
 # Reduces compilation time.
 #
+# ATOOLS_SQLITE_FUNCTIONS
+# Optional. Set this to "true" to register native geo functions like geo_distance_meter() in SQLite.
+# Links the system SQLite library. Qt has to be built with "-system-sqlite" to use the same library.
+#
 # More components can be disabled. Note that disabling the wrong combinations can result in build errors.
 # Full list is:
 # ATOOLS_NO_FS,  ATOOLS_NO_GRIB,  ATOOLS_NO_GUI,  ATOOLS_NO_ROUTING,  ATOOLS_NO_SQL,  ATOOLS_NO_TRACK,
@@ -99,6 +103,7 @@ ATOOLS_NO_TIMEZONE=$$(ATOOLS_NO_TIMEZONE)
 ATOOLS_NO_NAVSERVER=$$(ATOOLS_NO_NAVSERVER)
 ATOOLS_NO_CRASHHANDLER=$$(ATOOLS_NO_CRASHHANDLER)
 ATOOLS_NO_QT5COMPAT=$$(ATOOLS_NO_QT5COMPAT)
+ATOOLS_SQLITE_FUNCTIONS=$$(ATOOLS_SQLITE_FUNCTIONS)
 
 !isEqual(ATOOLS_NO_GUI, "true"): QT += svg widgets
 isEqual(ATOOLS_NO_GUI, "true"): QT -= gui
@@ -159,6 +164,11 @@ else {
   DEFINES += DISABLE_CRASHHANDLER
 }
 
+isEqual(ATOOLS_SQLITE_FUNCTIONS, "true"):!isEqual(ATOOLS_NO_SQL, "true") {
+  DEFINES += ATOOLS_SQLITE_FUNCTIONS
+  LIBS += -lsqlite3
+}
+
 DEFINES += QT_DISABLE_DEPRECATED_UP_TO=0x061000
 
 macx {
@@ -217,6 +227,7 @@ message(ATOOLS_NO_TIMEZONE: $$ATOOLS_NO_TIMEZONE)
 message(ATOOLS_NO_NAVSERVER: $$ATOOLS_NO_NAVSERVER)
 message(ATOOLS_NO_CRASHHANDLER: $$ATOOLS_NO_CRASHHANDLER)
 message(ATOOLS_NO_QT5COMPAT: $$ATOOLS_NO_QT5COMPAT)
+message(ATOOLS_SQLITE_FUNCTIONS: $$ATOOLS_SQLITE_FUNCTIONS)
 message(SIMCONNECT_PATH_WIN32: $$SIMCONNECT_PATH_WIN32)
 message(ATOOLS_SIMCONNECT_PATH_WIN64_MSFS_2020: $$ATOOLS_SIMCONNECT_PATH_WIN64_MSFS_2020)
 message(ATOOLS_SIMCONNECT_PATH_WIN64_MSFS_2024: $$ATOOLS_SIMCONNECT_PATH_WIN64_MSFS_2024)
@@ -257,6 +268,7 @@ HEADERS += \
   src/atools.h \
   src/exception.h \
   src/fs/db/countryupdater.h \
+  src/fs/gpx/gpxbinary.h \
   src/fs/gpx/gpxio.h \
   src/fs/gpx/gpxtypes.h \
   src/fs/navdatabaseflags.h \
@@ -266,11 +278,15 @@ HEADERS += \
   src/fs/sc/db/simconnectnav.h \
   src/fs/sc/db/simconnectwriter.h \
   src/fs/sc/connecthandler.h \
+  src/fs/sc/datareaderstats.h \
   src/fs/sc/datareaderthread.h \
+  src/fs/sc/loadtesthandler.h \
   src/fs/sc/simconnectaircraft.h \
+  src/fs/sc/simconnectaircraftstore.h \
   src/fs/sc/simconnectapi.h \
   src/fs/sc/simconnectdata.h \
   src/fs/sc/simconnectdatabase.h \
+  src/fs/sc/simconnectdatadelta.h \
   src/fs/sc/simconnectdummy.h \
   src/fs/sc/simconnecthandler.h \
   src/fs/sc/simconnectreply.h \
@@ -278,17 +294,24 @@ HEADERS += \
   src/fs/sc/simconnectuseraircraft.h \
   src/fs/sc/weatherrequest.h \
   src/fs/sc/xpconnecthandler.h \
+  src/fs/sc/xpsharedmemory.h \
   src/fs/scenery/aircraftindex.h \
   src/fs/util/airportcoordtypes.h \
   src/fs/util/coordinates.h \
   src/fs/util/fsutil.h \
   src/fs/util/morsecode.h \
   src/fs/util/tacanfrequencies.h \
+  src/geo/batchcalculations.h \
   src/geo/calculations.h \
+  src/geo/fastpos.h \
+  src/geo/geobenchmark.h \
   src/geo/line.h \
   src/geo/linestring.h \
+  src/geo/linestringlod.h \
   src/geo/nanoflann.h \
+  src/geo/packedlinestring.h \
   src/geo/point3d.h \
+  src/geo/preparedpolygon.h \
   src/geo/pos.h \
   src/geo/rect.h \
   src/geo/spatialindex.h \
@@ -300,12 +323,16 @@ HEADERS += \
   src/io/inireader.h \
   src/io/tempfile.h \
   src/json/nlohmann/json.hpp \
+  src/logging/loggingbinary.h \
   src/logging/loggingconfig.h \
   src/logging/loggingguiabort.h \
   src/logging/logginghandler.h \
+  src/logging/loggingmacros.h \
   src/logging/loggingtypes.h \
   src/logging/loggingutil.h \
+  src/logging/loggingwriter.h \
   src/settings/settings.h \
+  src/util/asynctask.h \
   src/util/average.h \
   src/util/contextsaver.h \
   src/util/crashhandler.h \
@@ -315,21 +342,30 @@ HEADERS += \
   src/util/fileoperations.h \
   src/util/filesystemwatcher.h \
   src/util/flags.h \
+  src/util/flathash.h \
   src/util/heap.h \
+  src/util/indexedheap.h \
+  src/util/jsonstreamreader.h \
   src/util/httpdownloader.h \
   src/util/locker.h \
+  src/util/memoryusage.h \
+  src/util/nativefilewatcher.h \
   src/util/properties.h \
   src/util/props.h \
   src/util/signalhandler.h \
   src/util/simplecrypt.h \
+  src/util/spscringbuffer.h \
   src/util/str.h \
+  src/util/stringpool.h \
   src/util/timedcache.h \
+  src/util/tracer.h \
   src/util/updatecheck.h \
   src/util/updatechecktypes.h \
   src/util/version.h \
   src/util/xmlstream.h \
   src/win/activationcontext.h \
   src/zip/gzip.h \
+  src/zip/gzipdevice.h \
   src/zip/zipreader.h \
   src/zip/zipwriter.h \
   src/zlib/crc32.h \
@@ -347,6 +383,7 @@ SOURCES += \
   src/atools.cpp \
   src/exception.cpp \
   src/fs/db/countryupdater.cpp \
+  src/fs/gpx/gpxbinary.cpp \
   src/fs/gpx/gpxio.cpp \
   src/fs/gpx/gpxtypes.cpp \
   src/fs/navdatabaseflags.cpp \
@@ -356,11 +393,15 @@ SOURCES += \
   src/fs/sc/db/simconnectnav.cpp \
   src/fs/sc/db/simconnectwriter.cpp \
   src/fs/sc/connecthandler.cpp \
+  src/fs/sc/datareaderstats.cpp \
   src/fs/sc/datareaderthread.cpp \
+  src/fs/sc/loadtesthandler.cpp \
   src/fs/sc/simconnectaircraft.cpp \
+  src/fs/sc/simconnectaircraftstore.cpp \
   src/fs/sc/simconnectapi.cpp \
   src/fs/sc/simconnectdata.cpp \
   src/fs/sc/simconnectdatabase.cpp \
+  src/fs/sc/simconnectdatadelta.cpp \
   src/fs/sc/simconnectdummy.cpp \
   src/fs/sc/simconnecthandler.cpp \
   src/fs/sc/simconnectreply.cpp \
@@ -368,15 +409,22 @@ SOURCES += \
   src/fs/sc/simconnectuseraircraft.cpp \
   src/fs/sc/weatherrequest.cpp \
   src/fs/sc/xpconnecthandler.cpp \
+  src/fs/sc/xpsharedmemory.cpp \
   src/fs/scenery/aircraftindex.cpp \
   src/fs/util/coordinates.cpp \
   src/fs/util/fsutil.cpp \
   src/fs/util/morsecode.cpp \
   src/fs/util/tacanfrequencies.cpp \
+  src/geo/batchcalculations.cpp \
   src/geo/calculations.cpp \
+  src/geo/fastpos.cpp \
+  src/geo/geobenchmark.cpp \
   src/geo/line.cpp \
   src/geo/linestring.cpp \
+  src/geo/linestringlod.cpp \
+  src/geo/packedlinestring.cpp \
   src/geo/point3d.cpp \
+  src/geo/preparedpolygon.cpp \
   src/geo/pos.cpp \
   src/geo/rect.cpp \
   src/geo/spatialindex.cpp \
@@ -387,11 +435,14 @@ SOURCES += \
   src/io/fileroller.cpp \
   src/io/inireader.cpp \
   src/io/tempfile.cpp \
+  src/logging/loggingbinary.cpp \
   src/logging/loggingconfig.cpp \
   src/logging/loggingguiabort.cpp \
   src/logging/logginghandler.cpp \
   src/logging/loggingutil.cpp \
+  src/logging/loggingwriter.cpp \
   src/settings/settings.cpp \
+  src/util/asynctask.cpp \
   src/util/average.cpp \
   src/util/contextsaver.cpp \
   src/util/crashhandler.cpp \
@@ -401,21 +452,29 @@ SOURCES += \
   src/util/fileoperations.cpp \
   src/util/filesystemwatcher.cpp \
   src/util/flags.cpp \
+  src/util/flathash.cpp \
   src/util/heap.cpp \
+  src/util/indexedheap.cpp \
+  src/util/jsonstreamreader.cpp \
   src/util/httpdownloader.cpp \
   src/util/locker.cpp \
+  src/util/memoryusage.cpp \
+  src/util/nativefilewatcher.cpp \
   src/util/properties.cpp \
   src/util/props.cpp \
   src/util/signalhandler.cpp \
   src/util/simplecrypt.cpp \
   src/util/str.cpp \
+  src/util/stringpool.cpp \
   src/util/timedcache.cpp \
+  src/util/tracer.cpp \
   src/util/updatecheck.cpp \
   src/util/updatechecktypes.cpp \
   src/util/version.cpp \
   src/util/xmlstream.cpp \
   src/win/activationcontext.cpp \
   src/zip/gzip.cpp \
+  src/zip/gzipdevice.cpp \
   src/zip/zip.cpp \
   src/zlib/adler32.c \
   src/zlib/compress.c \
@@ -440,11 +499,13 @@ SOURCES += \
 HEADERS += \
   src/sql/datamanagerbase.h \
   src/fs/userdata/logdatamanager.h \
+  src/fs/userdata/logstatistics.h \
   src/fs/userdata/userdatamanager.h
 
 SOURCES += \
   src/sql/datamanagerbase.cpp \
   src/fs/userdata/logdatamanager.cpp \
+  src/fs/userdata/logstatistics.cpp \
   src/fs/userdata/userdatamanager.cpp
 } # ATOOLS_NO_USERDATA
 
@@ -453,25 +514,39 @@ SOURCES += \
 
 !isEqual(ATOOLS_NO_SQL, "true") {
 HEADERS += \
+  src/sql/sqlcachedquery.h \
   src/sql/sqlcolumn.h \
+  src/sql/sqlconnectionpool.h \
+  src/sql/sqlcursor.h \
   src/sql/sqldatabase.h \
   src/sql/sqlexception.h \
   src/sql/sqlexport.h \
+  src/sql/sqlfulltextsearch.h \
+  src/sql/sqlfunctions.h \
+  src/sql/sqlprofiler.h \
   src/sql/sqlquery.h \
   src/sql/sqlrecord.h \
   src/sql/sqlscript.h \
+  src/sql/sqlstreamexport.h \
   src/sql/sqltransaction.h \
   src/sql/sqltypes.h \
   src/sql/sqlutil.h
 
 SOURCES += \
+  src/sql/sqlcachedquery.cpp \
   src/sql/sqlcolumn.cpp \
+  src/sql/sqlconnectionpool.cpp \
+  src/sql/sqlcursor.cpp \
   src/sql/sqldatabase.cpp \
   src/sql/sqlexception.cpp \
   src/sql/sqlexport.cpp \
+  src/sql/sqlfulltextsearch.cpp \
+  src/sql/sqlfunctions.cpp \
+  src/sql/sqlprofiler.cpp \
   src/sql/sqlquery.cpp \
   src/sql/sqlrecord.cpp \
   src/sql/sqlscript.cpp \
+  src/sql/sqlstreamexport.cpp \
   src/sql/sqltransaction.cpp \
   src/sql/sqlutil.cpp
 } # ATOOLS_NO_SQL
@@ -484,12 +559,14 @@ HEADERS += \
   src/fs/weather/metar.h \
   src/fs/weather/metarindex.h \
   src/fs/weather/metarparser.h \
+  src/fs/weather/metarviewparser.h \
   src/fs/weather/weathertypes.h \
 
 SOURCES += \
   src/fs/weather/metar.cpp \
   src/fs/weather/metarindex.cpp \
   src/fs/weather/metarparser.cpp \
+  src/fs/weather/metarviewparser.cpp \
   src/fs/weather/weathertypes.cpp \
 } # ATOOLS_NO_WEATHER
 
@@ -658,14 +735,20 @@ HEADERS += \
   src/httpserver/httpconnectionhandler.h \
   src/httpserver/httpconnectionhandlerpool.h \
   src/httpserver/httpcookie.h \
+  src/httpserver/httpeventlooppool.h \
+  src/httpserver/httpeventstreamcontroller.h \
   src/httpserver/httpglobal.h \
   src/httpserver/httplistener.h \
+  src/httpserver/httpmetricscontroller.h \
   src/httpserver/httprequest.h \
   src/httpserver/httprequesthandler.h \
   src/httpserver/httpresponse.h \
+  src/httpserver/httpresponsecache.h \
+  src/httpserver/httpservermetrics.h \
   src/httpserver/httpsession.h \
   src/httpserver/httpsessionstore.h \
   src/httpserver/staticfilecontroller.h \
+  src/templateengine/compiledtemplate.h \
   src/templateengine/template.h \
   src/templateengine/templatecache.h \
   src/templateengine/templateglobal.h \
@@ -675,14 +758,20 @@ SOURCES += \
   src/httpserver/httpconnectionhandler.cpp \
   src/httpserver/httpconnectionhandlerpool.cpp \
   src/httpserver/httpcookie.cpp \
+  src/httpserver/httpeventlooppool.cpp \
+  src/httpserver/httpeventstreamcontroller.cpp \
   src/httpserver/httpglobal.cpp \
   src/httpserver/httplistener.cpp \
+  src/httpserver/httpmetricscontroller.cpp \
   src/httpserver/httprequest.cpp \
   src/httpserver/httprequesthandler.cpp \
   src/httpserver/httpresponse.cpp \
+  src/httpserver/httpresponsecache.cpp \
+  src/httpserver/httpservermetrics.cpp \
   src/httpserver/httpsession.cpp \
   src/httpserver/httpsessionstore.cpp \
   src/httpserver/staticfilecontroller.cpp \
+  src/templateengine/compiledtemplate.cpp \
   src/templateengine/template.cpp \
   src/templateengine/templatecache.cpp \
   src/templateengine/templateloader.cpp
@@ -746,12 +835,15 @@ HEADERS += \
   src/fs/bgl/surface.h \
   src/fs/bgl/util.h \
   src/fs/common/airportindex.h \
+  src/fs/common/airspaceindex.h \
   src/fs/common/binarygeometry.h \
   src/fs/common/binarymsageometry.h \
   src/fs/common/globereader.h \
+  src/fs/common/magdecgrid.h \
   src/fs/common/magdecreader.h \
   src/fs/common/metadatawriter.h \
   src/fs/common/morareader.h \
+  src/fs/common/navsnapshot.h \
   src/fs/common/procedurewriter.h \
   src/fs/common/xpgeometry.h \
   src/fs/db/airwayresolver.h \
@@ -787,26 +879,32 @@ HEADERS += \
   src/fs/db/nav/tacanwriter.h \
   src/fs/db/nav/vorwriter.h \
   src/fs/db/nav/waypointwriter.h \
+  src/fs/db/databasedelta.h \
+  src/fs/db/navsnapshotwriter.h \
   src/fs/db/runwayindex.h \
   src/fs/db/writerbase.h \
   src/fs/db/writerbasebasic.h \
   src/fs/dfd/dfdcompiler.h \
   src/fs/fspaths.h \
   src/fs/navdatabase.h \
+  src/fs/navdatabasebenchmark.h \
   src/fs/navdatabaseerrors.h \
   src/fs/navdatabaseoptions.h \
   src/fs/navdatabaseprogress.h \
   src/fs/online/onlinedatamanager.h \
+  src/fs/online/onlinesnapshot.h \
   src/fs/online/onlinetypes.h \
   src/fs/online/statustextparser.h \
   src/fs/online/whazzuptextparser.h \
   src/fs/perf/aircraftperf.h \
+  src/fs/perf/aircraftperfbatch.h \
   src/fs/perf/aircraftperfconstants.h \
   src/fs/perf/aircraftperfhandler.h \
   src/fs/pln/flightplan.h \
   src/fs/pln/flightplanconstants.h \
   src/fs/pln/flightplanentry.h \
   src/fs/pln/flightplanio.h \
+  src/fs/pln/routestringparser.h \
   src/fs/progresshandler.h \
   src/fs/scenery/addoncfg.h \
   src/fs/scenery/addoncomponent.h \
@@ -819,10 +917,13 @@ HEADERS += \
   src/fs/scenery/materiallib.h \
   src/fs/scenery/sceneryarea.h \
   src/fs/scenery/scenerycfg.h \
+  src/fs/scenery/scenerychangedetector.h \
+  src/fs/scenery/sceneryfilecache.h \
   src/fs/userdata/airspacereaderbase.h \
   src/fs/userdata/airspacereaderivao.h \
   src/fs/userdata/airspacereaderopenair.h \
   src/fs/userdata/airspacereadervatsim.h \
+  src/fs/weather/weatherbenchmark.h \
   src/fs/xp/scenerypacks.h \
   src/fs/xp/xpairportmsareader.h \
   src/fs/xp/xpairportreader.h \
@@ -832,6 +933,7 @@ HEADERS += \
   src/fs/xp/xpcifpreader.h \
   src/fs/xp/xpconstants.h \
   src/fs/xp/xpdatacompiler.h \
+  src/fs/xp/xpdattokenizer.h \
   src/fs/xp/xpfixreader.h \
   src/fs/xp/xpholdingreader.h \
   src/fs/xp/xpmorareader.h \
@@ -839,7 +941,9 @@ HEADERS += \
   src/fs/xp/xpreader.h \
   src/grib/windquery.h \
   src/grib/windtypes.h \
-  src/routing/routefinder.h
+  src/routing/routefinder.h \
+  src/routing/routefinderbatch.h \
+  src/routing/routefinderbenchmark.h
 
 SOURCES += \
   src/fs/bgl/ap/airport.cpp \
@@ -895,12 +999,15 @@ SOURCES += \
   src/fs/bgl/surface.cpp \
   src/fs/bgl/util.cpp \
   src/fs/common/airportindex.cpp \
+  src/fs/common/airspaceindex.cpp \
   src/fs/common/binarygeometry.cpp \
   src/fs/common/binarymsageometry.cpp \
   src/fs/common/globereader.cpp \
+  src/fs/common/magdecgrid.cpp \
   src/fs/common/magdecreader.cpp \
   src/fs/common/metadatawriter.cpp \
   src/fs/common/morareader.cpp \
+  src/fs/common/navsnapshot.cpp \
   src/fs/common/procedurewriter.cpp \
   src/fs/common/xpgeometry.cpp \
   src/fs/db/airwayresolver.cpp \
@@ -936,25 +1043,31 @@ SOURCES += \
   src/fs/db/nav/tacanwriter.cpp \
   src/fs/db/nav/vorwriter.cpp \
   src/fs/db/nav/waypointwriter.cpp \
+  src/fs/db/databasedelta.cpp \
+  src/fs/db/navsnapshotwriter.cpp \
   src/fs/db/runwayindex.cpp \
   src/fs/db/writerbasebasic.cpp \
   src/fs/dfd/dfdcompiler.cpp \
   src/fs/fspaths.cpp \
   src/fs/navdatabase.cpp \
+  src/fs/navdatabasebenchmark.cpp \
   src/fs/navdatabaseerrors.cpp \
   src/fs/navdatabaseoptions.cpp \
   src/fs/navdatabaseprogress.cpp \
   src/fs/online/onlinedatamanager.cpp \
+  src/fs/online/onlinesnapshot.cpp \
   src/fs/online/onlinetypes.cpp \
   src/fs/online/statustextparser.cpp \
   src/fs/online/whazzuptextparser.cpp \
   src/fs/perf/aircraftperf.cpp \
+  src/fs/perf/aircraftperfbatch.cpp \
   src/fs/perf/aircraftperfconstants.cpp \
   src/fs/perf/aircraftperfhandler.cpp \
   src/fs/pln/flightplan.cpp \
   src/fs/pln/flightplanconstants.cpp \
   src/fs/pln/flightplanentry.cpp \
   src/fs/pln/flightplanio.cpp \
+  src/fs/pln/routestringparser.cpp \
   src/fs/progresshandler.cpp \
   src/fs/scenery/addoncfg.cpp \
   src/fs/scenery/addoncomponent.cpp \
@@ -967,10 +1080,13 @@ SOURCES += \
   src/fs/scenery/materiallib.cpp \
   src/fs/scenery/sceneryarea.cpp \
   src/fs/scenery/scenerycfg.cpp \
+  src/fs/scenery/scenerychangedetector.cpp \
+  src/fs/scenery/sceneryfilecache.cpp \
   src/fs/userdata/airspacereaderbase.cpp \
   src/fs/userdata/airspacereaderivao.cpp \
   src/fs/userdata/airspacereaderopenair.cpp \
   src/fs/userdata/airspacereadervatsim.cpp \
+  src/fs/weather/weatherbenchmark.cpp \
   src/fs/xp/scenerypacks.cpp \
   src/fs/xp/xpairportmsareader.cpp \
   src/fs/xp/xpairportreader.cpp \
@@ -980,6 +1096,7 @@ SOURCES += \
   src/fs/xp/xpcifpreader.cpp \
   src/fs/xp/xpconstants.cpp \
   src/fs/xp/xpdatacompiler.cpp \
+  src/fs/xp/xpdattokenizer.cpp \
   src/fs/xp/xpfixreader.cpp \
   src/fs/xp/xpholdingreader.cpp \
   src/fs/xp/xpmorareader.cpp \
@@ -987,7 +1104,9 @@ SOURCES += \
   src/fs/xp/xpreader.cpp \
   src/grib/windquery.cpp \
   src/grib/windtypes.cpp \
-  src/routing/routefinder.cpp
+  src/routing/routefinder.cpp \
+  src/routing/routefinderbatch.cpp \
+  src/routing/routefinderbenchmark.cpp
 } # ATOOLS_NO_FS
 
 
@@ -1061,14 +1180,25 @@ SOURCES += \
 HEADERS += \
   src/fs/ns/navserver.h \
   src/fs/ns/navservercommon.h \
+  src/fs/ns/navserverloadtest.h \
   src/fs/ns/navserverworker.h
 
 SOURCES += \
   src/fs/ns/navserver.cpp \
   src/fs/ns/navservercommon.cpp \
+  src/fs/ns/navserverloadtest.cpp \
   src/fs/ns/navserverworker.cpp
 } # ATOOLS_NO_NAVSERVER
 
+# Navserver web push needs the web server
+!isEqual(ATOOLS_NO_NAVSERVER, "true"):!isEqual(ATOOLS_NO_WEB, "true") {
+HEADERS += \
+  src/fs/ns/aircrafteventpublisher.h
+
+SOURCES += \
+  src/fs/ns/aircrafteventpublisher.cpp
+} # ATOOLS_NO_NAVSERVER ATOOLS_NO_WEB
+
 
 RESOURCES += \
   atools.qrc
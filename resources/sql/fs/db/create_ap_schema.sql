@@ -115,6 +115,8 @@ create table airport
   altitude integer not null,                    -- Feet
   lonx double not null,                         -- Coordinates of the airport center
   laty double not null,                         -- Coordinates of the airport center
+  cell_id integer,                              -- Hierarchical cell id for the center. See atools::geo::Rect::cellId()
+  min_zoom integer,                             -- Minimum cell level for display. See update_min_zoom.sql
 foreign key(file_id) references bgl_file(bgl_file_id)
 );
 
@@ -207,9 +209,10 @@ create table apron
   is_draw_detail integer not null,  -- Draw FS detail texture
   vertices blob,                    -- Coordinate list of the apron. Single precision float binary format.
                                     -- boundary (lon1 lat1, lon2 lat2, ...).
-  vertices2 blob,                   -- Apron triangle vertices - not used
-  triangles blob,                   -- Apron triangle vertex references - space and comma separated - not used
-                                    -- vertex index for vertices2 (i1 i2 i3, i2 i3 i4, ...)
+  vertices2 blob,                   -- Apron triangle vertices. Either from BGL or simplified outline of vertices
+                                    -- calculated at compile time. Same format as vertices.
+  triangles blob,                   -- Apron triangle vertex references. Binary vertex count and index triplets
+                                    -- for vertices2 (i1 i2 i3, i2 i3 i4, ...)
   geometry blob,                    -- Optional field: X-Plane apron and taxiway geometry
 foreign key(airport_id) references airport(airport_id)
 );
@@ -0,0 +1,42 @@
+-- *****************************************************************************
+-- Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+--
+-- This program is free software: you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation, either version 3 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program.  If not, see <http://www.gnu.org/licenses/>.
+-- ****************************************************************************/
+
+-- *************************************************************
+-- Create optional full text search tables for airports and
+-- navaids. Needs FTS5 with trigram tokenizer (SQLite 3.34+).
+-- The trigram tokenizer allows infix searches and speeds up
+-- "like" queries with three or more characters.
+-- Tables use external content and do not duplicate the text.
+-- Row ids are airport_id and nav_search_id.
+-- *************************************************************
+
+drop table if exists airport_fts;
+drop table if exists nav_search_fts;
+
+create virtual table airport_fts using fts5(ident, icao, iata, faa, local, name, city,
+  content='airport', content_rowid='airport_id', tokenize='trigram');
+
+create virtual table nav_search_fts using fts5(ident, name, airport_ident,
+  content='nav_search', content_rowid='nav_search_id', tokenize='trigram');
+
+-- Build index from content tables
+insert into airport_fts(airport_fts) values('rebuild');
+insert into nav_search_fts(nav_search_fts) values('rebuild');
+
+-- Merge index segments for faster queries
+insert into airport_fts(airport_fts) values('optimize');
+insert into nav_search_fts(nav_search_fts) values('optimize');
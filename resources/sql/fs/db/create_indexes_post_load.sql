@@ -36,6 +36,7 @@ create index if not exists idx_waypoint_num_vairway on waypoint(num_victor_airwa
 create index if not exists idx_waypoint_num_rairway on waypoint(num_jet_airway);
 create index if not exists idx_waypoint_lonx on waypoint(lonx);
 create index if not exists idx_waypoint_laty on waypoint(laty);
+create index if not exists idx_waypoint_cell_id on waypoint(cell_id);
 
 create index if not exists idx_runway_end_ils_ident on runway_end(ils_ident);
 
@@ -44,9 +45,11 @@ create index if not exists idx_vor_type on vor(type);
 create index if not exists idx_vor_region on vor(region);
 create index if not exists idx_vor_lonx on vor(lonx);
 create index if not exists idx_vor_laty on vor(laty);
+create index if not exists idx_vor_cell_id on vor(cell_id);
 
 create index if not exists idx_ndb_ident on ndb(ident);
 create index if not exists idx_ndb_type on ndb(type);
 create index if not exists idx_ndb_region on ndb(region);
 create index if not exists idx_ndb_lonx on ndb(lonx);
 create index if not exists idx_ndb_laty on ndb(laty);
+create index if not exists idx_ndb_cell_id on ndb(cell_id);
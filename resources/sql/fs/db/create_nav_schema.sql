@@ -44,6 +44,8 @@ create table waypoint
   mag_var double not null,            -- Magnetic variance in degree < 0 for West and > 0 for East
   lonx double not null,
   laty double not null,
+  cell_id integer,                    -- Hierarchical cell id for the coordinates. See atools::geo::Rect::cellId()
+  min_zoom integer,                   -- Minimum cell level for display. See update_min_zoom.sql
 foreign key(file_id) references bgl_file(bgl_file_id),
 foreign key(airport_id) references airport(airport_id)
 );
@@ -81,6 +83,8 @@ create table vor
   altitude integer,             -- Feet or null if not available
   lonx double not null,
   laty double not null,
+  cell_id integer,              -- Hierarchical cell id for the coordinates. See atools::geo::Rect::cellId()
+  min_zoom integer,             -- Minimum cell level for display. See update_min_zoom.sql
 foreign key(file_id) references bgl_file(bgl_file_id),
 foreign key(airport_id) references airport(airport_id)
 );
@@ -110,6 +114,8 @@ create table ndb
   altitude integer,           -- Feet
   lonx double not null,
   laty double not null,
+  cell_id integer,            -- Hierarchical cell id for the coordinates. See atools::geo::Rect::cellId()
+  min_zoom integer,           -- Minimum cell level for display. See update_min_zoom.sql
 foreign key(file_id) references bgl_file(bgl_file_id),
 foreign key(airport_id) references airport(airport_id)
 );
@@ -196,6 +202,7 @@ create table ils
   altitude integer not null,       -- Feet
   lonx double not null,            -- Coordinates of the ILS origin
   laty double not null,            -- "
+  cell_id integer,                 -- Hierarchical cell id for the coordinates. See atools::geo::Rect::cellId()
 foreign key(loc_runway_end_id) references runway_end(runway_end_id)
 );
 
@@ -0,0 +1,69 @@
+-- *****************************************************************************
+-- Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+--
+-- This program is free software: you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation, either version 3 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program.  If not, see <http://www.gnu.org/licenses/>.
+-- ****************************************************************************/
+
+-- ==================================================================================
+-- Fill airway segments from enroute airways in one pass
+-- Each row is joined with the next waypoint of the same route. A waypoint description code having "E"
+-- at the second position denotes the end of a fragment. No segment is created from such a waypoint and
+-- the next row starts a new fragment.
+
+insert into airway (airway_name, airway_type, route_type, airway_fragment_no, sequence_no,
+  from_waypoint_id, to_waypoint_id, direction, minimum_altitude, maximum_altitude,
+  left_lonx, top_laty, right_lonx, bottom_laty, from_lonx, from_laty, to_lonx, to_laty)
+select
+  name as airway_name,
+  -- V = victor, J = jet, B = both
+  -- B = All Altitudes, H = High Level Airways, L = Low Level Airways
+  case when flightlevel = 'H' then 'J' when flightlevel = 'L' then 'V' else 'B' end as airway_type,
+  route_type,
+  fragment_no as airway_fragment_no,
+  row_number() over (partition by name, fragment_no order by seqno) as sequence_no,
+  waypoint_id as from_waypoint_id,
+  next_waypoint_id as to_waypoint_id,
+  -- N = none, B = backward, F = forward
+  case when trim(coalesce(direction_restriction, '')) = '' then 'N' else direction_restriction end as direction,
+  coalesce(minimum_altitude1, 0) as minimum_altitude,
+  coalesce(maximum_altitude, 0) as maximum_altitude,
+  -- Bounding rectangle - west is larger than east if segment crosses the anti-meridian
+  case when abs(lonx - next_lonx) > 180 then max(lonx, next_lonx) else min(lonx, next_lonx) end as left_lonx,
+  max(laty, next_laty) as top_laty,
+  case when abs(lonx - next_lonx) > 180 then min(lonx, next_lonx) else max(lonx, next_lonx) end as right_lonx,
+  min(laty, next_laty) as bottom_laty,
+  lonx as from_lonx,
+  laty as from_laty,
+  next_lonx as to_lonx,
+  next_laty as to_laty
+from (
+  select p.*,
+    -- Fragment number is one plus the number of fragment ends before this row
+    1 + coalesce(sum(end_of_route) over (partition by name order by seqno
+                                         rows between unbounded preceding and 1 preceding), 0) as fragment_no
+  from (
+    select a.route_identifier as name, a.seqno, a.flightlevel, a.route_type, a.direction_restriction,
+      a.minimum_altitude1, a.maximum_altitude, w.waypoint_id, w.lonx, w.laty,
+      substr(a.waypoint_description_code, 2, 1) = 'E' as end_of_route,
+      lead(w.waypoint_id) over route as next_waypoint_id,
+      lead(w.lonx) over route as next_lonx,
+      lead(w.laty) over route as next_laty
+    from tbl_enroute_airways a
+    join waypoint w on
+      a.waypoint_identifier = w.ident and a.icao_code = w.region and a.waypoint_longitude = w.lonx and
+      a.waypoint_latitude = w.laty
+    window route as (partition by a.route_identifier order by a.seqno)
+  ) p
+) f
+where not end_of_route and next_waypoint_id is not null;
@@ -22,5 +22,7 @@
 -- Order is important to avoid fk conflicts
 
 -- drop routing and search
+drop table if exists airport_fts;
+drop table if exists nav_search_fts;
 drop table if exists nav_search;
 
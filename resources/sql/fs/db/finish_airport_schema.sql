@@ -66,4 +66,6 @@ create index if not exists idx_airport_bottom_laty on airport(bottom_laty);
 create index if not exists idx_airport_altitude on airport(altitude);
 create index if not exists idx_airport_lonx on airport(lonx);
 create index if not exists idx_airport_laty on airport(laty);
+create index if not exists idx_airport_cell_id on airport(cell_id);
+create index if not exists idx_airport_cell_id_min_zoom on airport(cell_id, min_zoom);
 
@@ -22,6 +22,12 @@
 -- Create indexes which are used in searches
 create index if not exists idx_ils_ident on ils(ident);
 create index if not exists idx_ils_type on ils(type);
+create index if not exists idx_ils_cell_id on ils(cell_id);
+
+-- Viewport queries by cell id and display level
+create index if not exists idx_waypoint_cell_id_min_zoom on waypoint(cell_id, min_zoom);
+create index if not exists idx_vor_cell_id_min_zoom on vor(cell_id, min_zoom);
+create index if not exists idx_ndb_cell_id_min_zoom on ndb(cell_id, min_zoom);
 
 create index if not exists idx_airway_left_lonx on airway(left_lonx);
 create index if not exists idx_airway_top_laty on airway(top_laty);
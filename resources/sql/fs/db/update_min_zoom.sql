@@ -0,0 +1,59 @@
+-- *****************************************************************************
+-- Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+--
+-- This program is free software: you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License as published by
+-- the Free Software Foundation, either version 3 of the License, or
+-- (at your option) any later version.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+-- GNU General Public License for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program.  If not, see <http://www.gnu.org/licenses/>.
+-- ****************************************************************************/
+
+-- *************************************************************
+-- Assign the minimum display level to airports and navaids
+-- Level uses the same quad tree levels as cell_id (0 = whole world to 16 = about 600 m).
+-- Viewport queries at low zoom can filter by "min_zoom <= level" and cell id ranges
+-- to get bounded result sets.
+-- *************************************************************
+
+-- Airports by runway length and surface. Good rating and add-ons appear one level earlier
+-- and closed airports two levels later.
+update airport set min_zoom = max(0,
+  case
+    when longest_runway_length >= 8000 and num_runway_hard > 0 then 3
+    when longest_runway_length >= 5000 and num_runway_hard > 0 then 5
+    when longest_runway_length >= 2500 then 7
+    else 9
+  end
+  - case when rating >= 4 or is_addon = 1 then 1 else 0 end
+  + case when is_closed = 1 then 2 else 0 end);
+
+-- VOR by range. High power VOR cover 130 NM and more.
+update vor set min_zoom =
+  case
+    when range >= 130 then 5
+    when range >= 40 then 7
+    else 9
+  end;
+
+-- NDB by range. Null range is treated like a compass locator.
+update ndb set min_zoom =
+  case
+    when type = 'HH' or range >= 75 then 7
+    when range >= 25 then 9
+    else 10
+  end;
+
+-- Waypoints on high airways first, then low airways and then all others
+update waypoint set min_zoom =
+  case
+    when num_jet_airway > 0 then 8
+    when num_victor_airway > 0 then 9
+    else 11
+  end;
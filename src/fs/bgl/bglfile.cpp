@@ -34,6 +34,8 @@
 #include "fs/bgl/boundary.h"
 #include "fs/bgl/recordtypes.h"
 #include "fs/scenery/sceneryarea.h"
+#include "logging/loggingmacros.h"
+#include "util/tracer.h"
 
 #include <QList>
 #include <QDebug>
@@ -47,8 +49,11 @@ namespace bgl {
 
 using atools::io::BinaryStream;
 
+/* Initial size of the record arena which grows in larger blocks if needed */
+const static size_t RECORD_ARENA_INITIAL_SIZE = 64 * 1024;
+
 BglFile::BglFile(const NavDatabaseOptions *readerOptions)
-  : size(0), options(readerOptions)
+  : size(0), options(readerOptions), recordArena(RECORD_ARENA_INITIAL_SIZE)
 {
 }
 
@@ -59,6 +64,8 @@ BglFile::~BglFile()
 
 void BglFile::readFile(const QString& filenameParam, const atools::fs::scenery::SceneryArea& area)
 {
+  ATOOLS_TRACE_SPAN_DETAIL("BglFile::readFile", filenameParam);
+
   deleteAllObjects();
   filename = filenameParam;
 
@@ -72,7 +79,8 @@ void BglFile::readFile(const QString& filenameParam, const atools::fs::scenery::
 
   if(file.open(QIODevice::ReadOnly))
   {
-    BinaryStream stream(&file);
+    // Map file into memory to avoid device calls for each value and seek
+    BinaryStream stream(&file, QDataStream::LittleEndian, true /* memoryMap */);
 
     size = stream.getFileSize();
 
@@ -83,6 +91,10 @@ void BglFile::readFile(const QString& filenameParam, const atools::fs::scenery::
 
     readSections(&stream);
 
+    // Drop sections which are not needed for the current filter set before touching any of their records
+    removeNotRequiredSections(&stream, area);
+    readSubsections(&stream);
+
     if(options->isIncludedNavDbObject(type::BOUNDARY) && !area.isMsfsNavigraphNavdata())
       readBoundaryRecords(&stream);
 
@@ -92,12 +104,36 @@ void BglFile::readFile(const QString& filenameParam, const atools::fs::scenery::
   }
 }
 
-bool BglFile::isValid()
+void BglFile::readFileSections(const QString& filenameParam)
+{
+  deleteAllObjects();
+  filename = filenameParam;
+
+  QFile file(filename);
+
+  if(file.size() < Header::HEADER_SIZE)
+    return;
+
+  if(file.open(QIODevice::ReadOnly))
+  {
+    BinaryStream stream(&file, QDataStream::LittleEndian, true /* memoryMap */);
+
+    size = stream.getFileSize();
+
+    readHeader(&stream);
+    if(header.isValid())
+      readSections(&stream);
+
+    file.close();
+  }
+}
+
+bool BglFile::isValid() const
 {
   return header.isValid();
 }
 
-bool BglFile::hasContent()
+bool BglFile::hasContent() const
 {
   return !(airports.isEmpty() &&
            namelists.isEmpty() &&
@@ -172,14 +208,14 @@ void BglFile::handleBoundaries(BinaryStream *bs)
     rec.seekToEnd();
   }
   if(options->isVerbose())
-    qDebug() << "Num boundary records" << numRecs;
+    ATOOLS_DEBUG() << "Num boundary records" << numRecs;
 }
 
 void BglFile::readHeader(BinaryStream *bs)
 {
   header = Header(options, bs);
   if(options->isVerbose())
-    qDebug() << header;
+    ATOOLS_DEBUG() << header;
 }
 
 void BglFile::readSections(BinaryStream *bs)
@@ -193,14 +229,82 @@ void BglFile::readSections(BinaryStream *bs)
     if(supportedSectionTypes.isEmpty() || supportedSectionTypes.contains(s.getType()))
     {
       if(options->isVerbose())
-        qDebug() << "Section" << s;
+        ATOOLS_DEBUG() << "Section" << s;
       sections.append(s);
     }
     else if(options->isVerbose())
-      qDebug() << "Unsupported section" << s;
+      ATOOLS_DEBUG() << "Unsupported section" << s;
+
+  }
+}
+
+bool BglFile::isSectionRequired(section::SectionType type, const scenery::SceneryArea& area) const
+{
+  FsPaths::SimulatorType sim = options->getSimulatorType();
+  bool msfsNavigraphNavdata = area.isMsfsNavigraphNavdata();
+  bool navaids = options->isIncludedNavDbObject(type::NAVAIDS) && !msfsNavigraphNavdata;
+
+  // Has to match the conditions in readRecords() and readFile()
+  switch(type)
+  {
+    case section::AIRPORT:
+    case section::AIRPORT_ALT:
+      return sim != FsPaths::MSFS_2024 && options->isIncludedNavDbObject(type::AIRPORT);
+
+    case section::NAME_LIST:
+      return sim != FsPaths::MSFS_2024;
+
+    case section::P3D_TACAN:
+      return sim != FsPaths::MSFS_2024 && options->isIncludedNavDbObject(type::NAVAIDS);
 
+    case section::ILS_VOR:
+      return navaids;
+
+    case section::NDB:
+      return navaids && options->isIncludedNavDbObject(type::NDB);
+
+    case section::MARKER:
+      return navaids && options->isIncludedNavDbObject(type::MARKER);
+
+    case section::WAYPOINT:
+      return navaids && options->isIncludedNavDbObject(type::WAYPOINT);
+
+    case section::BOUNDARY:
+      return options->isIncludedNavDbObject(type::BOUNDARY) && !msfsNavigraphNavdata;
+
+    default:
+      // Keep all others which were explicitly requested in supportedSectionTypes
+      return true;
   }
+}
 
+void BglFile::removeNotRequiredSections(BinaryStream *bs, const scenery::SceneryArea& area)
+{
+  for(auto it = sections.begin(); it != sections.end();)
+  {
+    if(isSectionRequired(it->getType(), area))
+      ++it;
+    else
+    {
+      // Sum up record data size from the subsection table but do not read any records
+      if(it->getType() != atools::fs::bgl::section::BOUNDARY && it->getType() != atools::fs::bgl::section::GEOPOL)
+      {
+        bs->seekg(it->getFirstSubsectionOffset());
+        for(unsigned int i = 0; i < it->getNumSubsections(); i++)
+          bytesSkipped += Subsection(options, bs, *it).getDataSize();
+      }
+      else
+        bytesSkipped += it->getTotalSubsectionSize();
+
+      if(options->isVerbose())
+        ATOOLS_DEBUG() << "Skipping section" << *it;
+      it = sections.erase(it);
+    }
+  }
+}
+
+void BglFile::readSubsections(BinaryStream *bs)
+{
   // Read subsections for each section
   for(Section& section : sections)
   {
@@ -213,7 +317,7 @@ void BglFile::readSections(BinaryStream *bs)
       {
         Subsection s(options, bs, section);
         if(options->isVerbose())
-          qDebug() << s;
+          ATOOLS_DEBUG() << s;
         subsections.append(s);
       }
     }
@@ -269,8 +373,8 @@ void BglFile::readRecords(BinaryStream *bs, const atools::fs::scenery::SceneryAr
 
     if(options->isVerbose())
     {
-      qDebug() << "=======================";
-      qDebug().nospace().noquote() << "Records of 0x" << Qt::hex << subsection.getFirstDataRecordOffset() << Qt::dec
+      ATOOLS_DEBUG() << "=======================";
+      ATOOLS_DEBUG().nospace().noquote() << "Records of 0x" << Qt::hex << subsection.getFirstDataRecordOffset() << Qt::dec
                                    << " type " << sectionTypeStr(type);
     }
 
@@ -336,7 +440,7 @@ void BglFile::readRecords(BinaryStream *bs, const atools::fs::scenery::SceneryAr
         case section::NAME_LIST:
           // Do not read airports/namelists from MSFS 2024. These are fetched via SimConnect.
           if(sim != FsPaths::MSFS_2024)
-            rec = createRecord<Namelist>(bs, &namelists);
+            rec = createRecord<Namelist>(bs, &namelists, stringPool);
           break;
 
         case section::P3D_TACAN:
@@ -352,7 +456,7 @@ void BglFile::readRecords(BinaryStream *bs, const atools::fs::scenery::SceneryAr
           {
             rec = handleIlsVor(bs);
             if(options->isVerbose() && rec != nullptr)
-              qDebug() << Q_FUNC_INFO << "ILS_VOR" << Qt::hex << rec->getId();
+              ATOOLS_DEBUG() << Q_FUNC_INFO << "ILS_VOR" << Qt::hex << rec->getId();
           }
           break;
 
@@ -362,7 +466,7 @@ void BglFile::readRecords(BinaryStream *bs, const atools::fs::scenery::SceneryAr
           {
             rec = createRecord<Ndb>(bs, &ndbs);
             if(options->isVerbose() && rec != nullptr)
-              qDebug() << Q_FUNC_INFO << "NDB" << Qt::hex << rec->getId();
+              ATOOLS_DEBUG() << Q_FUNC_INFO << "NDB" << Qt::hex << rec->getId();
           }
           break;
 
@@ -379,7 +483,7 @@ void BglFile::readRecords(BinaryStream *bs, const atools::fs::scenery::SceneryAr
             // Read waypoints and airways
             rec = createRecord<Waypoint>(bs, &waypoints);
             if(options->isVerbose() && rec != nullptr)
-              qDebug() << Q_FUNC_INFO << "WAYPOINT" << Qt::hex << rec->getId();
+              ATOOLS_DEBUG() << Q_FUNC_INFO << "WAYPOINT" << Qt::hex << rec->getId();
           }
           break;
 
@@ -470,11 +574,15 @@ void BglFile::deleteAllObjects()
   sections.clear();
   subsections.clear();
 
-  qDeleteAll(allRecords);
+  // Records are placed in the arena - call destructors and release all memory at once
+  for(const Record *rec : std::as_const(allRecords))
+    rec->~Record();
   allRecords.clear();
+  recordArena.release();
 
   filename.clear();
   size = 0;
+  bytesSkipped = 0;
 }
 
 } // namespace bgl
@@ -28,10 +28,15 @@
 #include <QDebug>
 #include <QCoreApplication>
 
+#include <memory_resource>
+
 namespace atools {
 namespace io {
 class BinaryStream;
 }
+namespace util {
+class StringPool;
+}
 
 namespace fs {
 
@@ -83,11 +88,20 @@ public:
   explicit BglFile(const NavDatabaseOptions *readerOptions);
   virtual ~BglFile();
 
+  BglFile(const BglFile& other) = delete;
+  BglFile& operator=(const BglFile& other) = delete;
+
   void setSupportedSectionTypes(const QSet<atools::fs::bgl::section::SectionType>& sects)
   {
     supportedSectionTypes = sects;
   }
 
+  /* Pool for deduplicating name list strings across files. Not owned and has to outlive this object. */
+  void setStringPool(atools::util::StringPool *pool)
+  {
+    stringPool = pool;
+  }
+
   /*
    * Reads the full content of the BGL file into the internal lists including header, sections,
    * airports and so on.
@@ -95,6 +109,13 @@ public:
    */
   void readFile(const QString& filenameParam, const scenery::SceneryArea& area);
 
+  /*
+   * Reads only header and supported sections without any records. Used to check quickly if a file
+   * contains anything of interest.
+   * @param file BGL filename
+   */
+  void readFileSections(const QString& filenameParam);
+
   QString getFilepath() const
   {
     return filename;
@@ -108,6 +129,14 @@ public:
     return size;
   }
 
+  /*
+   * @return Size of record data in sections skipped due to the filter options
+   */
+  qint64 getBytesSkipped() const
+  {
+    return bytesSkipped;
+  }
+
   const QList<const atools::fs::bgl::Airport *>& getAirports() const
   {
     return airports;
@@ -161,18 +190,36 @@ public:
   /*
    * @return true if any relevant content is available. Header and sections do not count.
    */
-  bool hasContent();
+  bool hasContent() const;
 
   /*
    * @return true if header and section structure is valid
    */
-  bool isValid();
+  bool isValid() const;
+
+  /*
+   * @return true if file has any supported sections. Valid after readFile() or readFileSections().
+   */
+  bool hasSections() const
+  {
+    return !sections.isEmpty();
+  }
 
 private:
   void deleteAllObjects();
   void readHeader(atools::io::BinaryStream *bs);
+  /* Read section table */
   void readSections(atools::io::BinaryStream *bs);
 
+  /* Read subsection tables of all sections */
+  void readSubsections(atools::io::BinaryStream *bs);
+
+  /* true if records of a section type are needed for the options and area */
+  bool isSectionRequired(atools::fs::bgl::section::SectionType type, const scenery::SceneryArea& area) const;
+
+  /* Remove sections which are not needed and add their data size to bytesSkipped */
+  void removeNotRequiredSections(atools::io::BinaryStream *bs, const scenery::SceneryArea& area);
+
   void readRecords(atools::io::BinaryStream *bs, const atools::fs::scenery::SceneryArea& area);
   const Record *handleIlsVor(atools::io::BinaryStream *bs);
 
@@ -183,15 +230,28 @@ private:
   template<typename TYPE>
   const TYPE *createRecord(atools::io::BinaryStream *bs, QList<const TYPE *> *list);
 
+  /* Passes arg as additional constructor parameter like flags */
+  template<typename TYPE, typename ARG>
+  const TYPE *createRecord(atools::io::BinaryStream *bs, QList<const TYPE *> *list, ARG arg);
+
+  /* Get memory for a record from the arena. Memory of records which are destroyed directly after
+   * creation is not reused but freed with all others on reset. */
   template<typename TYPE>
-  const TYPE *createRecord(atools::io::BinaryStream *bs, QList<const TYPE *> *list,
-                           atools::fs::bgl::CreateFlags flags);
+  void *allocateRecord()
+  {
+    return recordArena.allocate(sizeof(TYPE), alignof(TYPE));
+  }
 
   QString filename;
-  qint64 size;
+  qint64 size, bytesSkipped = 0;
   const NavDatabaseOptions *options = nullptr;
+  atools::util::StringPool *stringPool = nullptr;
+
+  /* All top level records are placed in this arena. Grows in few large blocks and avoids a heap allocation
+   * for each record. */
+  std::pmr::monotonic_buffer_resource recordArena;
 
-  /* Keep a list of all records to make object deletion easier */
+  /* Keep a list of all records to call destructors */
   QList<const atools::fs::bgl::Record *> allRecords;
 
   QList<const atools::fs::bgl::Airport *> airports;
@@ -217,11 +277,11 @@ private:
 template<typename TYPE>
 const TYPE *BglFile::createRecord(atools::io::BinaryStream *bs, QList<const TYPE *> *list)
 {
-  TYPE *rec = new TYPE(options, bs);
+  TYPE *rec = new (allocateRecord<TYPE>()) TYPE(options, bs);
 
   if(rec->isExcluded())
   {
-    delete rec;
+    rec->~TYPE();
     return nullptr;
   }
 
@@ -231,7 +291,7 @@ const TYPE *BglFile::createRecord(atools::io::BinaryStream *bs, QList<const TYPE
     if(!rec->isDisabled())
       qWarning() << "Found invalid record: " << rec->getObjectName();
     rec->seekToStart();
-    delete rec;
+    rec->~TYPE();
     return nullptr;
   }
 
@@ -247,15 +307,14 @@ const TYPE *BglFile::createRecord(atools::io::BinaryStream *bs, QList<const TYPE
   return rec;
 }
 
-template<typename TYPE>
-const TYPE *BglFile::createRecord(atools::io::BinaryStream *bs, QList<const TYPE *> *list,
-                                  atools::fs::bgl::CreateFlags flags)
+template<typename TYPE, typename ARG>
+const TYPE *BglFile::createRecord(atools::io::BinaryStream *bs, QList<const TYPE *> *list, ARG arg)
 {
-  TYPE *rec = new TYPE(options, bs, flags);
+  TYPE *rec = new (allocateRecord<TYPE>()) TYPE(options, bs, arg);
 
   if(rec->isExcluded())
   {
-    delete rec;
+    rec->~TYPE();
     return nullptr;
   }
 
@@ -265,7 +324,7 @@ const TYPE *BglFile::createRecord(atools::io::BinaryStream *bs, QList<const TYPE
     if(!rec->isDisabled())
       qWarning() << "Found invalid record: " << rec->getObjectName();
     rec->seekToStart();
-    delete rec;
+    rec->~TYPE();
     return nullptr;
   }
 
@@ -20,6 +20,7 @@
 #include "io/binarystream.h"
 #include "fs/bgl/converter.h"
 #include "fs/navdatabaseoptions.h"
+#include "util/stringpool.h"
 
 namespace atools {
 namespace fs {
@@ -27,7 +28,7 @@ namespace bgl {
 
 using atools::io::BinaryStream;
 
-Namelist::Namelist(const NavDatabaseOptions *options, BinaryStream *stream)
+Namelist::Namelist(const NavDatabaseOptions *options, BinaryStream *stream, atools::util::StringPool *stringPool)
   : Record(options, stream)
 {
   int numRegionNames = stream->readShort();
@@ -49,19 +50,19 @@ Namelist::Namelist(const NavDatabaseOptions *options, BinaryStream *stream)
 
   // Read all names from the different offsets
   QStringList regions;
-  readList(regions, stream, numRegionNames, regionListOffset, encoding);
+  readList(regions, stream, numRegionNames, regionListOffset, encoding, stringPool);
 
   QStringList countries;
-  readList(countries, stream, numCountryNames, countryListOffset, encoding);
+  readList(countries, stream, numCountryNames, countryListOffset, encoding, stringPool);
 
   QStringList states;
-  readList(states, stream, numStateNames, stateListOffset, encoding);
+  readList(states, stream, numStateNames, stateListOffset, encoding, stringPool);
 
   QStringList cities;
-  readList(cities, stream, numCityNames, cityListOffset, encoding);
+  readList(cities, stream, numCityNames, cityListOffset, encoding, stringPool);
 
   QStringList airports;
-  readList(airports, stream, numAirportNames, airportListOffset, encoding);
+  readList(airports, stream, numAirportNames, airportListOffset, encoding, stringPool);
 
   // Goto to the offset that contains the name indexes
   stream->seekg(startOffset + icaoListOffset);
@@ -88,7 +89,8 @@ Namelist::~Namelist()
 {
 }
 
-void Namelist::readList(QStringList& names, BinaryStream *stream, int numNames, int listOffset, atools::io::Encoding encoding)
+void Namelist::readList(QStringList& names, BinaryStream *stream, int numNames, int listOffset, atools::io::Encoding encoding,
+                        atools::util::StringPool *stringPool)
 {
   stream->seekg(startOffset + listOffset);
 
@@ -100,7 +102,12 @@ void Namelist::readList(QStringList& names, BinaryStream *stream, int numNames,
   for(int i = 0; i < numNames; i++)
   {
     stream->seekg(offset + indexes[i]);
-    names.append(stream->readString(encoding));
+
+    // City, state and country names repeat across files - keep only one instance for the whole compilation
+    if(stringPool != nullptr)
+      names.append(stringPool->shared(stream->readString(encoding)));
+    else
+      names.append(stream->readString(encoding));
   }
   delete[] indexes;
 }
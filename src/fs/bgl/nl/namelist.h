@@ -29,6 +29,9 @@ namespace atools {
 namespace io {
 class BinaryStream;
 }
+namespace util {
+class StringPool;
+}
 }
 
 namespace atools {
@@ -43,8 +46,9 @@ class Namelist :
   public atools::fs::bgl::Record
 {
 public:
-  /* read nameslist from BGL */
-  Namelist(const atools::fs::NavDatabaseOptions *options, atools::io::BinaryStream *stream);
+  /* read nameslist from BGL. Names are replaced with shared instances from stringPool if not null. */
+  Namelist(const atools::fs::NavDatabaseOptions *options, atools::io::BinaryStream *stream,
+           atools::util::StringPool *stringPool = nullptr);
   virtual ~Namelist() override;
 
   const QList<atools::fs::bgl::NamelistEntry>& getNameList() const
@@ -55,7 +59,8 @@ public:
 private:
   friend QDebug operator<<(QDebug out, const atools::fs::bgl::Namelist& record);
 
-  void readList(QStringList& names, atools::io::BinaryStream *bs, int numRegionNames, int regionListOffset, atools::io::Encoding encoding);
+  void readList(QStringList& names, atools::io::BinaryStream *bs, int numRegionNames, int regionListOffset,
+                atools::io::Encoding encoding, atools::util::StringPool *stringPool);
 
   QList<atools::fs::bgl::NamelistEntry> entries;
 };
@@ -19,6 +19,9 @@
 
 #include "geo/pos.h"
 #include "fs/util/fsutil.h"
+#include "util/memoryusage.h"
+
+#include <algorithm>
 
 namespace atools {
 namespace fs {
@@ -56,18 +59,18 @@ int AirportIndex::getAirportId(const QString& ident, bool allIdents) const
   if(ident.isEmpty() || ident == EN_ROUTE)
     return -1;
 
-  int id = identToAirportMap.value(Name(ident), EMPTY_IDPOS).first;
+  int id = lookup(identToAirportMap, identToAirportFlat, Name(ident), EMPTY_IDPOS).first;
 
   if(allIdents)
   {
     if(id == -1)
-      id = icaoToAirportMap.value(Name(ident), EMPTY_IDPOS).first;
+      id = lookup(icaoToAirportMap, icaoToAirportFlat, Name(ident), EMPTY_IDPOS).first;
 
     if(id == -1)
-      id = faaToAirportMap.value(Name(ident), EMPTY_IDPOS).first;
+      id = lookup(faaToAirportMap, faaToAirportFlat, Name(ident), EMPTY_IDPOS).first;
 
     if(id == -1)
-      id = localToAirportMap.value(Name(ident), EMPTY_IDPOS).first;
+      id = lookup(localToAirportMap, localToAirportFlat, Name(ident), EMPTY_IDPOS).first;
   }
 
   return id;
@@ -78,18 +81,18 @@ atools::geo::Pos AirportIndex::getAirportPos(const QString& ident, bool allIdent
   if(ident.isEmpty() || ident == EN_ROUTE)
     return atools::geo::EMPTY_POS;
 
-  atools::geo::Pos pos = identToAirportMap.value(Name(ident), EMPTY_IDPOS).second;
+  atools::geo::Pos pos = lookup(identToAirportMap, identToAirportFlat, Name(ident), EMPTY_IDPOS).second;
 
   if(allIdents)
   {
     if(!pos.isValid())
-      pos = icaoToAirportMap.value(Name(ident), EMPTY_IDPOS).second;
+      pos = lookup(icaoToAirportMap, icaoToAirportFlat, Name(ident), EMPTY_IDPOS).second;
 
     if(!pos.isValid())
-      pos = faaToAirportMap.value(Name(ident), EMPTY_IDPOS).second;
+      pos = lookup(faaToAirportMap, faaToAirportFlat, Name(ident), EMPTY_IDPOS).second;
 
     if(!pos.isValid())
-      pos = localToAirportMap.value(Name(ident), EMPTY_IDPOS).second;
+      pos = lookup(localToAirportMap, localToAirportFlat, Name(ident), EMPTY_IDPOS).second;
   }
 
   return pos;
@@ -108,21 +111,42 @@ QVariant AirportIndex::getRunwayEndIdVar(int airportId, const QString& runwayNam
 
 int AirportIndex::runwayEndId(int airportId, const QString& runwayName) const
 {
-  return idNameToEnd.value(IdName(airportId, Name(util::normalizeRunway(runwayName))), EMPTY_IDPOS).first;
+  return runwayEnd(airportId, runwayName).first;
 }
 
 atools::geo::Pos AirportIndex::getRunwayEndPos(const QString& airportIdent, const QString& runwayName, bool allAirportIdents) const
 {
   if(!airportIdent.isEmpty())
-    return idNameToEnd.value(IdName(getAirportId(airportIdent, allAirportIdents), Name(util::normalizeRunway(runwayName))),
-                             EMPTY_IDPOS).second;
+    return runwayEnd(getAirportId(airportIdent, allAirportIdents), runwayName).second;
 
   return atools::geo::EMPTY_POS;
 }
 
+AirportIndex::IdPos AirportIndex::runwayEnd(int airportId, const QString& runwayName) const
+{
+  quint16 packed = util::runwayPacked(runwayName, true /* normalize */);
+  if(packed == 0)
+    // Name like "N" or "H1"
+    return lookup(idNameToEnd, idNameToEndFlat, IdName(airportId, Name(util::normalizeRunway(runwayName))), EMPTY_IDPOS);
+
+  quint64 key = runwayKey(airportId, packed);
+  if(frozen)
+  {
+    auto it = std::lower_bound(runwayKeyToEndSorted.constBegin(), runwayKeyToEndSorted.constEnd(), key,
+                               [](const std::pair<quint64, IdPos>& entry, quint64 k) {
+      return entry.first < k;
+    });
+    return it != runwayKeyToEndSorted.constEnd() && it->first == key ? it->second : EMPTY_IDPOS;
+  }
+  else
+    return runwayKeyToEnd.value(key, EMPTY_IDPOS);
+}
+
 bool AirportIndex::addAirportId(const QString& ident, const QString& icao, const QString& faa, const QString& local, int airportId,
                                 const geo::Pos& pos)
 {
+  unfreeze();
+
   if(identToAirportMap.contains(Name(ident)))
     return false;
   else
@@ -145,17 +169,24 @@ bool AirportIndex::addAirportId(const QString& ident, const QString& icao, const
 
 void AirportIndex::addRunwayEnd(int airportId, const QString& runwayName, int runwayEndId, const geo::Pos& runwayEndPos)
 {
-  idNameToEnd.insert(IdName(airportId, util::normalizeRunway(runwayName)), IdPos(runwayEndId, runwayEndPos));
+  unfreeze();
+
+  quint16 packed = util::runwayPacked(runwayName, true /* normalize */);
+  if(packed == 0)
+    idNameToEnd.insert(IdName(airportId, Name(util::normalizeRunway(runwayName))), IdPos(runwayEndId, runwayEndPos));
+  else
+    runwayKeyToEnd.insert(runwayKey(airportId, packed), IdPos(runwayEndId, runwayEndPos));
 }
 
 void AirportIndex::addAirportIls(const QString& airportIdent, const QString& airportRegion, const QString& ilsIdent, int ilsId)
 {
+  unfreeze();
   airportIlsIdMap.insert(Name3(airportIdent, airportRegion, ilsIdent), ilsId);
 }
 
 int AirportIndex::getAirportIlsId(const QString& airportIdent, const QString& airportRegion, const QString& ilsIdent) const
 {
-  return airportIlsIdMap.value(Name3(airportIdent, airportRegion, ilsIdent), -1);
+  return lookup(airportIlsIdMap, airportIlsIdFlat, Name3(airportIdent, airportRegion, ilsIdent), -1);
 }
 
 void AirportIndex::addSkippedAirportIls(const QString& airportIdent, const QString& airportRegion, const QString& ilsIdent)
@@ -176,7 +207,73 @@ void AirportIndex::clear()
   localToAirportMap.clear();
   airportIdents.clear();
   idNameToEnd.clear();
+  runwayKeyToEnd.clear();
+  runwayKeyToEndSorted.clear();
   airportIlsIdMap.clear();
+  unfreeze();
+}
+
+void AirportIndex::freeze()
+{
+  identToAirportFlat.build(identToAirportMap);
+  icaoToAirportFlat.build(icaoToAirportMap);
+  faaToAirportFlat.build(faaToAirportMap);
+  localToAirportFlat.build(localToAirportMap);
+  idNameToEndFlat.build(idNameToEnd);
+  airportIlsIdFlat.build(airportIlsIdMap);
+
+  // Move packed runway ends into a sorted list which needs less memory than the hash
+  runwayKeyToEndSorted.clear();
+  runwayKeyToEndSorted.reserve(runwayKeyToEnd.size());
+  for(auto it = runwayKeyToEnd.constBegin(); it != runwayKeyToEnd.constEnd(); ++it)
+    runwayKeyToEndSorted.append(std::make_pair(it.key(), it.value()));
+  runwayKeyToEnd.clear();
+
+  std::sort(runwayKeyToEndSorted.begin(), runwayKeyToEndSorted.end(),
+            [](const std::pair<quint64, IdPos>& entry1, const std::pair<quint64, IdPos>& entry2) {
+    return entry1.first < entry2.first;
+  });
+
+  frozen = true;
+}
+
+void AirportIndex::unfreezeInternal()
+{
+  identToAirportFlat.clear();
+  icaoToAirportFlat.clear();
+  faaToAirportFlat.clear();
+  localToAirportFlat.clear();
+  idNameToEndFlat.clear();
+  airportIlsIdFlat.clear();
+
+  // Move packed runway ends back into the hash to allow adding
+  for(const std::pair<quint64, IdPos>& entry : std::as_const(runwayKeyToEndSorted))
+    runwayKeyToEnd.insert(entry.first, entry.second);
+  runwayKeyToEndSorted.clear();
+
+  frozen = false;
+}
+
+void AirportIndex::getMemoryUsage(atools::util::MemoryUsage& usage) const
+{
+  using atools::util::MemoryUsage;
+
+  usage.add(QStringLiteral("AirportIndex/airports"),
+            MemoryUsage::hashBytes(identToAirportMap) + MemoryUsage::hashBytes(icaoToAirportMap) +
+            MemoryUsage::hashBytes(faaToAirportMap) + MemoryUsage::hashBytes(localToAirportMap) +
+            MemoryUsage::hashBytes(airportIdents) +
+            identToAirportFlat.getMemorySize() + icaoToAirportFlat.getMemorySize() +
+            faaToAirportFlat.getMemorySize() + localToAirportFlat.getMemorySize(),
+            identToAirportMap.size());
+
+  usage.add(QStringLiteral("AirportIndex/runwayEnds"),
+            MemoryUsage::hashBytes(idNameToEnd) + MemoryUsage::hashBytes(runwayKeyToEnd) +
+            MemoryUsage::listBytes(runwayKeyToEndSorted) + idNameToEndFlat.getMemorySize(),
+            idNameToEnd.size() + runwayKeyToEnd.size() + runwayKeyToEndSorted.size());
+
+  usage.add(QStringLiteral("AirportIndex/ils"),
+            MemoryUsage::hashBytes(airportIlsIdMap) + MemoryUsage::hashBytes(skippedIlsSet) + airportIlsIdFlat.getMemorySize(),
+            airportIlsIdMap.size());
 }
 
 } // namespace common
@@ -18,6 +18,7 @@
 #ifndef ATOOLS_XPAIRPORTINDEX_H
 #define ATOOLS_XPAIRPORTINDEX_H
 
+#include "util/flathash.h"
 #include "util/str.h"
 
 #include <QHash>
@@ -29,6 +30,10 @@ namespace geo {
 class Pos;
 }
 
+namespace util {
+class MemoryUsage;
+}
+
 namespace fs {
 namespace common {
 
@@ -91,6 +96,19 @@ public:
 
   void clear();
 
+  /* Copy airport, runway end and ILS maps into read only flat maps for faster lookups. Call when all
+   * airports are added. Adding entries afterwards falls back to the normal maps.
+   * Lookups are safe to call concurrently from several threads as long as nothing is added. */
+  void freeze();
+
+  bool isFrozen() const
+  {
+    return frozen;
+  }
+
+  /* Add estimated memory of airport, runway end and ILS maps including flat copies if frozen */
+  void getMemoryUsage(atools::util::MemoryUsage& usage) const;
+
   typedef atools::util::Str<10> Name;
   typedef atools::util::StrPair<10> Name2;
   typedef atools::util::StrTriple<10> Name3;
@@ -101,19 +119,56 @@ public:
 private:
   int runwayEndId(int airportId, const QString& runwayName) const;
 
+  /* Runway end id and position from packed or string index */
+  IdPos runwayEnd(int airportId, const QString& runwayName) const;
+
+  /* Airport id in upper and packed runway name from atools::fs::util::runwayPacked() in lower bits */
+  static quint64 runwayKey(int airportId, quint16 packedRunway)
+  {
+    return (static_cast<quint64>(static_cast<quint32>(airportId)) << 16) | packedRunway;
+  }
+
+  /* Drop flat maps before adding */
+  void unfreeze()
+  {
+    if(frozen)
+      unfreezeInternal();
+  }
+
+  void unfreezeInternal();
+
+  /* Look up in flat map if frozen */
+  template<typename KEY, typename VALUE>
+  VALUE lookup(const QHash<KEY, VALUE>& hash, const atools::util::FlatHash<KEY, VALUE>& flatHash, const KEY& key,
+               const VALUE& defaultValue) const
+  {
+    return frozen ? flatHash.value(key, defaultValue) : hash.value(key, defaultValue);
+  }
+
   // Airport ident, ICAO and FAA to airport_id and pos
   QHash<Name, IdPos> identToAirportMap, icaoToAirportMap, faaToAirportMap, localToAirportMap;
 
   // Airport idents
   QSet<Name> airportIdents;
 
-  // Airport ICAO and runway name to runway_end_id and pos
+  // Airport id and runway name to runway_end_id and pos. Used only for names which cannot be packed.
   QHash<IdName, IdPos> idNameToEnd;
 
+  // Packed airport id and runway name from runwayKey() to runway_end_id and pos.
+  // Moved into the sorted list by freeze() which is used for a binary search then.
+  QHash<quint64, IdPos> runwayKeyToEnd;
+  QList<std::pair<quint64, IdPos> > runwayKeyToEndSorted;
+
   // Airport ICAO, airport region and ILS ident to ils_id
   QHash<Name3, int> airportIlsIdMap;
   QSet<Name3> skippedIlsSet;
 
+  // Read only copies of the maps above created by freeze()
+  atools::util::FlatHash<Name, IdPos> identToAirportFlat, icaoToAirportFlat, faaToAirportFlat, localToAirportFlat;
+  atools::util::FlatHash<IdName, IdPos> idNameToEndFlat;
+  atools::util::FlatHash<Name3, int> airportIlsIdFlat;
+  bool frozen = false;
+
 };
 
 } // namespace common
@@ -0,0 +1,332 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/common/airspaceindex.h"
+
+#include "fs/common/binarygeometry.h"
+#include "geo/calculations.h"
+#include "geo/linestring.h"
+#include "geo/rect.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+
+#include <QDebug>
+#include <QVarLengthArray>
+
+#include <cmath>
+
+namespace atools {
+namespace fs {
+namespace common {
+
+using atools::geo::Pos;
+using atools::geo::Rect;
+using atools::geo::LineString;
+
+/* Maximum number of children per tree node */
+const static int NODE_SIZE = 16;
+
+/* Legs are split into parts of this length to follow the great circle */
+const static float SEGMENT_LENGTH_METER = 50000.f;
+
+void AirspaceIndex::addAirspace(int id, const LineString& boundary, int minAltitudeFt, int maxAltitudeFt)
+{
+  Airspace airspace;
+  airspace.id = id;
+  airspace.minAltitudeFt = minAltitudeFt;
+  airspace.maxAltitudeFt = maxAltitudeFt;
+  airspace.polygon = atools::geo::PreparedPolygon(boundary);
+
+  if(!airspace.polygon.isValid())
+    return;
+
+  int index = static_cast<int>(airspaces.size());
+  for(const Rect& rect : airspace.polygon.getBoundingRect().splitAtAntiMeridian())
+    entries.append({rect.getWest(), rect.getSouth(), rect.getEast(), rect.getNorth(), index, 1});
+
+  airspaces.append(airspace);
+}
+
+int AirspaceIndex::loadFromTable(atools::sql::SqlDatabase& db, const QString& table)
+{
+  int num = 0;
+  atools::sql::SqlQuery query(db);
+  query.exec("select boundary_id, min_altitude, max_altitude, geometry from " + table);
+  while(query.next())
+  {
+    BinaryGeometry geometry(query.value(QStringLiteral("geometry")).toByteArray());
+    QVariant maxAltitude = query.value(QStringLiteral("max_altitude"));
+
+    addAirspace(query.value(QStringLiteral("boundary_id")).toInt(), geometry.getGeometry(),
+                query.value(QStringLiteral("min_altitude")).toInt(),
+                maxAltitude.isNull() ? std::numeric_limits<int>::max() : maxAltitude.toInt());
+    num++;
+  }
+
+  build();
+
+  qDebug() << Q_FUNC_INFO << table << "airspaces" << num << "levels" << levels.size();
+  return num;
+}
+
+QList<AirspaceIndex::Node> AirspaceIndex::packLevel(QList<Node>& nodes)
+{
+  int numNodes = static_cast<int>(nodes.size());
+  int numParents = (numNodes + NODE_SIZE - 1) / NODE_SIZE;
+  int numSlices = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(numParents))));
+  int sliceSize = numSlices * NODE_SIZE;
+
+  // Sort into vertical slices by center longitude and each slice by center latitude
+  std::sort(nodes.begin(), nodes.end(), [](const Node& n1, const Node& n2) {
+    return n1.west + n1.east < n2.west + n2.east;
+  });
+
+  QList<Node> parents;
+  parents.reserve(numParents);
+  for(int slice = 0; slice < numNodes; slice += sliceSize)
+  {
+    int sliceEnd = std::min(slice + sliceSize, numNodes);
+    std::sort(nodes.begin() + slice, nodes.begin() + sliceEnd, [](const Node& n1, const Node& n2) {
+      return n1.south + n1.north < n2.south + n2.north;
+    });
+
+    for(int first = slice; first < sliceEnd; first += NODE_SIZE)
+    {
+      Node parent = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                     std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(),
+                     first, std::min(NODE_SIZE, sliceEnd - first)};
+
+      for(int i = first; i < first + parent.count; i++)
+      {
+        const Node& node = nodes.at(i);
+        parent.west = std::min(parent.west, node.west);
+        parent.south = std::min(parent.south, node.south);
+        parent.east = std::max(parent.east, node.east);
+        parent.north = std::max(parent.north, node.north);
+      }
+      parents.append(parent);
+    }
+  }
+  return parents;
+}
+
+void AirspaceIndex::build()
+{
+  levels.clear();
+
+  if(entries.isEmpty())
+    return;
+
+  QList<Node> level = entries;
+  while(level.size() > 1)
+  {
+    QList<Node> parents = packLevel(level);
+    levels.append(level);
+    level = parents;
+  }
+
+  // Root
+  levels.append(level);
+}
+
+void AirspaceIndex::clear()
+{
+  airspaces.clear();
+  entries.clear();
+  levels.clear();
+}
+
+void AirspaceIndex::query(QList<int>& indexes, float west, float south, float east, float north) const
+{
+  if(levels.isEmpty())
+    return;
+
+  // Level and node index
+  QVarLengthArray<std::pair<int, int>, 64> stack;
+  stack.append(std::make_pair(static_cast<int>(levels.size()) - 1, 0));
+
+  while(!stack.isEmpty())
+  {
+    std::pair<int, int> entry = stack.takeLast();
+    const Node& node = levels.at(entry.first).at(entry.second);
+
+    if(node.east < west || node.west > east || node.north < south || node.south > north)
+      continue;
+
+    if(entry.first == 0)
+      indexes.append(node.first);
+    else
+    {
+      for(int i = node.first; i < node.first + node.count; i++)
+        stack.append(std::make_pair(entry.first - 1, i));
+    }
+  }
+}
+
+void AirspaceIndex::queryRect(QList<int>& indexes, const Rect& rect) const
+{
+  for(const Rect& part : rect.splitAtAntiMeridian())
+    query(indexes, part.getWest(), part.getSouth(), part.getEast(), part.getNorth());
+
+  std::sort(indexes.begin(), indexes.end());
+  indexes.erase(std::unique(indexes.begin(), indexes.end()), indexes.end());
+}
+
+void AirspaceIndex::getInRect(QList<int>& ids, const Rect& rect) const
+{
+  QList<int> indexes;
+  queryRect(indexes, rect);
+
+  for(int index : std::as_const(indexes))
+  {
+    if(airspaces.at(index).polygon.intersects(rect))
+      ids.append(airspaces.at(index).id);
+  }
+}
+
+void AirspaceIndex::getAtPos(QList<int>& ids, const Pos& pos) const
+{
+  if(!pos.isValid())
+    return;
+
+  QList<int> indexes;
+  queryRect(indexes, Rect(pos));
+
+  for(int index : std::as_const(indexes))
+  {
+    if(airspaces.at(index).polygon.contains(pos))
+      ids.append(airspaces.at(index).id);
+  }
+}
+
+QList<AirspaceCrossing> AirspaceIndex::getCrossings(const LineString& route) const
+{
+  QList<AirspaceCrossing> crossings;
+  if(levels.isEmpty() || route.size() < 2)
+    return crossings;
+
+  QList<int> openCrossings;
+  openCrossings.fill(-1, airspaces.size());
+
+  float distanceMeter = 0.f;
+  bool first = true;
+  for(int i = 0; i < route.size() - 1; i++)
+  {
+    const Pos& from = route.at(i), & to = route.at(i + 1);
+    if(!from.isValid() || !to.isValid())
+      continue;
+
+    float legDistanceMeter = from.distanceMeterTo(to);
+    int numSegments = std::max(1, static_cast<int>(std::ceil(legDistanceMeter / SEGMENT_LENGTH_METER)));
+    float segmentDistanceMeter = legDistanceMeter / numSegments;
+
+    // Split leg along great circle
+    Pos segmentFrom = from;
+    for(int j = 1; j <= numSegments; j++)
+    {
+      Pos segmentTo = j < numSegments ? from.interpolate(to, legDistanceMeter, static_cast<float>(j) / numSegments) : to;
+      segmentTo.setAltitude(from.getAltitude() + (to.getAltitude() - from.getAltitude()) * j / numSegments);
+
+      segmentCrossings(crossings, openCrossings, segmentFrom, segmentTo, distanceMeter, segmentDistanceMeter, first);
+      distanceMeter += segmentDistanceMeter;
+      segmentFrom = segmentTo;
+      first = false;
+    }
+  }
+
+  // Close all crossings where the route ends inside
+  for(int index : std::as_const(openCrossings))
+  {
+    if(index != -1)
+    {
+      AirspaceCrossing& crossing = crossings[index];
+      crossing.exitPos = route.constLast();
+      crossing.exitDistanceMeter = distanceMeter;
+      crossing.endsInside = true;
+    }
+  }
+
+  std::stable_sort(crossings.begin(), crossings.end(), [](const AirspaceCrossing& c1, const AirspaceCrossing& c2) {
+    return c1.entryDistanceMeter < c2.entryDistanceMeter;
+  });
+
+  return crossings;
+}
+
+void AirspaceIndex::segmentCrossings(QList<AirspaceCrossing>& crossings, QList<int>& openCrossings, const Pos& from,
+                                     const Pos& to, float fromDistanceMeter, float distanceMeter, bool first) const
+{
+  // Candidates by bounding rectangle of segment
+  QList<int> indexes;
+  if(atools::geo::crossesAntiMeridian(from.getLonX(), to.getLonX()))
+    queryRect(indexes, Rect(std::max(from.getLonX(), to.getLonX()), std::max(from.getLatY(), to.getLatY()),
+                            std::min(from.getLonX(), to.getLonX()), std::min(from.getLatY(), to.getLatY())));
+  else
+    queryRect(indexes, Rect(std::min(from.getLonX(), to.getLonX()), std::max(from.getLatY(), to.getLatY()),
+                            std::max(from.getLonX(), to.getLonX()), std::min(from.getLatY(), to.getLatY())));
+
+  // Longitude difference on the short way for interpolation
+  float deltaLon = to.getLonX() - from.getLonX();
+  if(deltaLon > 180.f)
+    deltaLon -= 360.f;
+  else if(deltaLon < -180.f)
+    deltaLon += 360.f;
+
+  QList<float> fractions;
+  for(int index : std::as_const(indexes))
+  {
+    const Airspace& airspace = airspaces.at(index);
+
+    if(first && airspace.polygon.contains(from))
+    {
+      openCrossings[index] = static_cast<int>(crossings.size());
+      crossings.append({airspace.id, airspace.minAltitudeFt, airspace.maxAltitudeFt, from, Pos(),
+                        fromDistanceMeter, 0.f, true, false});
+    }
+
+    fractions.clear();
+    airspace.polygon.getCrossingFractions(fractions, from, to);
+
+    for(float fraction : std::as_const(fractions))
+    {
+      Pos pos = Pos(from.getLonX() + deltaLon * fraction, from.getLatY() + (to.getLatY() - from.getLatY()) * fraction,
+                    from.getAltitude() + (to.getAltitude() - from.getAltitude()) * fraction).normalized();
+      float posDistanceMeter = fromDistanceMeter + distanceMeter * fraction;
+
+      int& open = openCrossings[index];
+      if(open == -1)
+      {
+        // Entering
+        open = static_cast<int>(crossings.size());
+        crossings.append({airspace.id, airspace.minAltitudeFt, airspace.maxAltitudeFt, pos, Pos(),
+                          posDistanceMeter, 0.f, false, false});
+      }
+      else
+      {
+        // Leaving
+        AirspaceCrossing& crossing = crossings[open];
+        crossing.exitPos = pos;
+        crossing.exitDistanceMeter = posDistanceMeter;
+        open = -1;
+      }
+    }
+  }
+}
+
+} // namespace common
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,153 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_AIRSPACEINDEX_H
+#define ATOOLS_AIRSPACEINDEX_H
+
+#include "geo/pos.h"
+#include "geo/preparedpolygon.h"
+
+#include <QList>
+
+namespace atools {
+namespace geo {
+class LineString;
+class Rect;
+}
+
+namespace sql {
+class SqlDatabase;
+}
+
+namespace fs {
+namespace common {
+
+/* Part of a route inside an airspace */
+struct AirspaceCrossing
+{
+  /* boundary_id */
+  int id;
+
+  /* Airspace altitude limits in feet. maxAltitudeFt is INT_MAX if unlimited or unknown */
+  int minAltitudeFt, maxAltitudeFt;
+
+  /* Positions where the route enters and leaves the airspace. Altitude is interpolated from the route. */
+  atools::geo::Pos entryPos, exitPos;
+
+  /* Distance from route start */
+  float entryDistanceMeter, exitDistanceMeter;
+
+  /* Entry is route start or exit is route end */
+  bool startsInside, endsInside;
+
+  /* true if the route altitude range between entry and exit overlaps the airspace altitude range */
+  bool isAltitudeOverlap() const
+  {
+    float lower = std::min(entryPos.getAltitude(), exitPos.getAltitude());
+    float upper = std::max(entryPos.getAltitude(), exitPos.getAltitude());
+    return upper >= minAltitudeFt && lower <= maxAltitudeFt;
+  }
+
+};
+
+/*
+ * In-memory R-tree over airspace bounding rectangles for route airspace analysis.
+ *
+ * Filled from the boundary table of the navdata, online or user airspace databases or manually.
+ * Bulk loaded once using sort-tile-recursive packing. Airspaces crossing the anti-meridian are inserted
+ * with two rectangles. Exact tests use PreparedPolygon with edges as straight lines in degree coordinates.
+ *
+ * Not thread safe while adding. Queries are read only and can run concurrently after build().
+ */
+class AirspaceIndex
+{
+public:
+  /* Add airspace. Call build() after adding all airspaces. */
+  void addAirspace(int id, const atools::geo::LineString& boundary, int minAltitudeFt, int maxAltitudeFt);
+
+  /* Add all airspaces from table having the schema of "boundary" and build the tree.
+   *  Returns number of airspaces added. */
+  int loadFromTable(atools::sql::SqlDatabase& db, const QString& table = QStringLiteral("boundary"));
+
+  /* Build tree. Needed after adding airspaces and before queries. */
+  void build();
+
+  void clear();
+
+  /* Get all crossings of route with airspaces sorted by entry distance. Airspaces can appear more than
+   * once if the route leaves and enters again. Legs are great circle lines. Altitude of the route positions is
+   * interpolated into entry and exit positions. */
+  QList<atools::fs::common::AirspaceCrossing> getCrossings(const atools::geo::LineString& route) const;
+
+  /* ids of airspaces overlapping rectangle */
+  void getInRect(QList<int>& ids, const atools::geo::Rect& rect) const;
+
+  /* ids of airspaces containing position */
+  void getAtPos(QList<int>& ids, const atools::geo::Pos& pos) const;
+
+  int size() const
+  {
+    return static_cast<int>(airspaces.size());
+  }
+
+  bool isEmpty() const
+  {
+    return airspaces.isEmpty();
+  }
+
+private:
+  struct Airspace
+  {
+    int id, minAltitudeFt, maxAltitudeFt;
+    atools::geo::PreparedPolygon polygon;
+  };
+
+  /* Box in degrees and range of child nodes or airspace index for leaves */
+  struct Node
+  {
+    float west, south, east, north;
+    int first, count;
+  };
+
+  /* Sort nodes using sort-tile-recursive and return parent nodes covering consecutive ranges */
+  static QList<Node> packLevel(QList<Node>& nodes);
+
+  /* Airspace indexes in tree overlapping box. Can contain duplicates for anti-meridian crossing airspaces. */
+  void query(QList<int>& indexes, float west, float south, float east, float north) const;
+
+  /* As above but splits at the anti-meridian and removes duplicates */
+  void queryRect(QList<int>& indexes, const atools::geo::Rect& rect) const;
+
+  /* Add crossings for a short part of a leg which is treated as a straight line in degrees.
+   * openCrossings contains the index into crossings for each airspace the route is inside or -1. */
+  void segmentCrossings(QList<AirspaceCrossing>& crossings, QList<int>& openCrossings, const atools::geo::Pos& from,
+                        const atools::geo::Pos& to, float fromDistanceMeter, float distanceMeter, bool first) const;
+
+  QList<Airspace> airspaces;
+
+  /* Leaf nodes collected by addAirspace() */
+  QList<Node> entries;
+
+  /* Leaves at index 0 and root at last index */
+  QList<QList<Node> > levels;
+};
+
+} // namespace common
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_AIRSPACEINDEX_H
@@ -17,13 +17,139 @@
 
 #include "fs/common/binarygeometry.h"
 
+#include "geo/packedlinestring.h"
+
 #include <QDataStream>
 #include <QIODevice>
+#include <QtEndian>
+
+#include <cmath>
 
 namespace atools {
 namespace fs {
 namespace common {
 
+/* Written in place of the size for the delta formats. Too large to be a valid size of the float format. */
+const static quint32 MAGIC_DELTA = 0xFFFFFF01;
+const static quint32 MAGIC_DELTA_ZLIB = 0xFFFFFF02;
+
+inline quint32 zigzagEncode(qint32 value)
+{
+  return (static_cast<quint32>(value) << 1) ^ static_cast<quint32>(value >> 31);
+}
+
+inline qint32 zigzagDecode(quint32 value)
+{
+  return static_cast<qint32>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+inline void writeVarint(QByteArray& bytes, quint32 value)
+{
+  while(value >= 0x80)
+  {
+    bytes.append(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  bytes.append(static_cast<char>(value));
+}
+
+/* Returns false if data ends before the last byte of the value */
+inline bool readVarint(const uchar *& data, const uchar *end, quint32& value)
+{
+  value = 0;
+  for(int shift = 0; shift < 35 && data < end; shift += 7)
+  {
+    uchar byte = *data++;
+    value |= static_cast<quint32>(byte & 0x7f) << shift;
+    if(!(byte & 0x80))
+      return true;
+  }
+  return false;
+}
+
+/* Encode size coordinates using accessor functions for longitude and latitude */
+template<typename LONX, typename LATY>
+QByteArray encodeDelta(int size, const LONX& lonXAt, const LATY& latYAt, BinaryGeometry::Format format)
+{
+  // Usually one to three bytes per delta
+  QByteArray payload;
+  payload.reserve(5 + size * 6);
+  writeVarint(payload, static_cast<quint32>(size));
+
+  // Columnar - write all longitudes first and latitudes after. Deltas wrap around in unsigned arithmetic.
+  for(int column = 0; column < 2; column++)
+  {
+    quint32 last = 0;
+    for(int i = 0; i < size; i++)
+    {
+      float value = column == 0 ? lonXAt(i) : latYAt(i);
+      quint32 quantized =
+        static_cast<quint32>(static_cast<qint32>(std::round(value * atools::geo::PackedLineString::TO_QUANTIZED)));
+      writeVarint(payload, zigzagEncode(static_cast<qint32>(quantized - last)));
+      last = quantized;
+    }
+  }
+
+  QByteArray bytes(sizeof(quint32), '\0');
+  if(format == BinaryGeometry::DELTA_ZLIB)
+  {
+    QByteArray compressed = qCompress(payload);
+    if(compressed.size() < payload.size())
+    {
+      qToBigEndian<quint32>(MAGIC_DELTA_ZLIB, bytes.data());
+      bytes.append(compressed);
+      return bytes;
+    }
+  }
+
+  qToBigEndian<quint32>(MAGIC_DELTA, bytes.data());
+  bytes.append(payload);
+  return bytes;
+}
+
+/* Decode one of the delta formats */
+static bool decodeDelta(const QByteArray& bytes, atools::geo::PackedLineString& packed)
+{
+  const uchar *data = reinterpret_cast<const uchar *>(bytes.constData());
+  const uchar *end = data + bytes.size();
+
+  QByteArray uncompressed;
+  if(qFromBigEndian<quint32>(data) == MAGIC_DELTA_ZLIB)
+  {
+    uncompressed = qUncompress(data + sizeof(quint32), bytes.size() - static_cast<qsizetype>(sizeof(quint32)));
+    if(uncompressed.isEmpty())
+      return false;
+
+    data = reinterpret_cast<const uchar *>(uncompressed.constData());
+    end = data + uncompressed.size();
+  }
+  else
+    data += sizeof(quint32);
+
+  quint32 size;
+  // Each delta needs at least one byte
+  if(!readVarint(data, end, size) || static_cast<quint64>(size) * 2 > static_cast<quint64>(end - data))
+    return false;
+
+  packed.resizeFloat(static_cast<int>(size));
+  float *columns[2] = {packed.lonXData(), packed.latYData()};
+  for(float *column : columns)
+  {
+    quint32 value = 0, delta;
+    for(quint32 i = 0; i < size; i++)
+    {
+      if(!readVarint(data, end, delta))
+      {
+        packed.clear();
+        return false;
+      }
+      value += static_cast<quint32>(zigzagDecode(delta));
+      column[i] = static_cast<float>(static_cast<qint32>(value) * atools::geo::PackedLineString::FROM_QUANTIZED);
+    }
+  }
+  return true;
+}
+
 BinaryGeometry::BinaryGeometry(const atools::geo::LineString& lineString)
   : geometry(lineString)
 {
@@ -34,10 +160,31 @@ BinaryGeometry::BinaryGeometry(const QByteArray& bytes)
   readFromByteArray(bytes);
 }
 
+bool BinaryGeometry::isDeltaFormat(const QByteArray& bytes)
+{
+  if(bytes.size() < static_cast<int>(sizeof(quint32)))
+    return false;
+
+  quint32 magic = qFromBigEndian<quint32>(bytes.constData());
+  return magic == MAGIC_DELTA || magic == MAGIC_DELTA_ZLIB;
+}
+
 void BinaryGeometry::readFromByteArray(const QByteArray& bytes)
 {
   geometry.clear();
 
+  if(isDeltaFormat(bytes))
+  {
+    atools::geo::PackedLineString packed;
+    if(decodeDelta(bytes, packed))
+    {
+      geometry.reserve(packed.size());
+      for(int i = 0; i < packed.size(); i++)
+        geometry.append(packed.getLonX(i), packed.getLatY(i));
+    }
+    return;
+  }
+
   QDataStream in(bytes);
   in.setVersion(QDataStream::Qt_5_5);
   in.setFloatingPointPrecision(QDataStream::SinglePrecision);
@@ -52,8 +199,15 @@ void BinaryGeometry::readFromByteArray(const QByteArray& bytes)
   }
 }
 
-QByteArray BinaryGeometry::writeToByteArray() const
+QByteArray BinaryGeometry::writeToByteArray(Format format) const
 {
+  if(format != FLOAT)
+    return encodeDelta(static_cast<int>(geometry.size()), [this](int i) -> float {
+      return geometry.at(i).getLonX();
+    }, [this](int i) -> float {
+      return geometry.at(i).getLatY();
+    }, format);
+
   QByteArray bytes;
   QDataStream out(&bytes, QIODevice::WriteOnly);
   out.setVersion(QDataStream::Qt_5_5);
@@ -65,6 +219,59 @@ QByteArray BinaryGeometry::writeToByteArray() const
   return bytes;
 }
 
+bool BinaryGeometry::readFromByteArray(const QByteArray& bytes, atools::geo::PackedLineString& packed)
+{
+  packed.clear();
+  if(bytes.size() < static_cast<int>(sizeof(quint32)))
+    return false;
+
+  if(isDeltaFormat(bytes))
+    return decodeDelta(bytes, packed);
+
+  // Same format as written by QDataStream - big endian size followed by longitude/latitude pairs
+  const uchar *data = reinterpret_cast<const uchar *>(bytes.constData());
+  quint32 size = qFromBigEndian<quint32>(data);
+  data += sizeof(quint32);
+
+  if(static_cast<quint64>(bytes.size()) < sizeof(quint32) + static_cast<quint64>(size) * 2 * sizeof(float))
+    return false;
+
+  packed.resizeFloat(static_cast<int>(size));
+  float *lonX = packed.lonXData(), *latY = packed.latYData();
+  for(quint32 i = 0; i < size; i++)
+  {
+    lonX[i] = qFromBigEndian<float>(data);
+    latY[i] = qFromBigEndian<float>(data + sizeof(float));
+    data += 2 * sizeof(float);
+  }
+  return true;
+}
+
+QByteArray BinaryGeometry::writeToByteArray(const atools::geo::PackedLineString& packed, Format format)
+{
+  if(format != FLOAT)
+    return encodeDelta(packed.size(), [&packed](int i) -> float {
+      return packed.getLonX(i);
+    }, [&packed](int i) -> float {
+      return packed.getLatY(i);
+    }, format);
+
+  int size = packed.size();
+  QByteArray bytes(static_cast<int>(sizeof(quint32) + static_cast<size_t>(size) * 2 * sizeof(float)), '\0');
+  uchar *data = reinterpret_cast<uchar *>(bytes.data());
+
+  qToBigEndian<quint32>(static_cast<quint32>(size), data);
+  data += sizeof(quint32);
+
+  for(int i = 0; i < size; i++)
+  {
+    qToBigEndian<float>(packed.getLonX(i), data);
+    qToBigEndian<float>(packed.getLatY(i), data + sizeof(float));
+    data += 2 * sizeof(float);
+  }
+  return bytes;
+}
+
 } // namespace common
 } // namespace fs
 } // namespace atools
@@ -23,6 +23,10 @@
 class QByteArray;
 
 namespace atools {
+namespace geo {
+class PackedLineString;
+}
+
 namespace fs {
 namespace common {
 
@@ -31,10 +35,26 @@ namespace common {
  *
  * Writes a simple lat/long (not altitude) list in single floating point precision into a byte array which can be used
  * to write and read it into and from a database BLOB.
+ *
+ * The compact delta formats start with a magic number in place of the size and are detected automatically
+ * when reading.
  */
 class BinaryGeometry
 {
 public:
+  enum Format
+  {
+    /* Big endian size followed by float longitude/latitude pairs. Readable by all versions. */
+    FLOAT,
+
+    /* Coordinates quantized to 1E-7 degree. All longitudes followed by all latitudes, each stored as
+     * zigzag varint encoded delta to the previous value. */
+    DELTA,
+
+    /* Like DELTA but zlib compressed if this results in a smaller array */
+    DELTA_ZLIB
+  };
+
   BinaryGeometry()
   {
 
@@ -47,7 +67,7 @@ public:
   explicit BinaryGeometry(const QByteArray& bytes);
 
   void readFromByteArray(const QByteArray& bytes);
-  QByteArray writeToByteArray() const;
+  QByteArray writeToByteArray(atools::fs::common::BinaryGeometry::Format format = FLOAT) const;
 
   const atools::geo::LineString& getGeometry() const
   {
@@ -64,6 +84,17 @@ public:
     geometry = value;
   }
 
+  /* Decode byte array directly into coordinate arrays without creating positions or a stream.
+   * Returns false if the byte array is truncated or invalid. */
+  static bool readFromByteArray(const QByteArray& bytes, atools::geo::PackedLineString& packed);
+
+  /* Write packed geometry in the same format as writeToByteArray(). Altitude is ignored. */
+  static QByteArray writeToByteArray(const atools::geo::PackedLineString& packed,
+                                     atools::fs::common::BinaryGeometry::Format format = FLOAT);
+
+  /* true if bytes use one of the DELTA formats */
+  static bool isDeltaFormat(const QByteArray& bytes);
+
 private:
   atools::geo::LineString geometry;
 };
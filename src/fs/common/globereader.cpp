@@ -19,6 +19,7 @@
 #include "exception.h"
 #include "atools.h"
 
+#include "geo/calculations.h"
 #include "geo/pos.h"
 #include "geo/linestring.h"
 #include "geo/line.h"
@@ -26,7 +27,13 @@
 #include <cmath>
 #include <QDataStream>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QHash>
+#include <QMap>
+#include <QMutexLocker>
+#include <QThread>
+#include <QThreadPool>
+#include <QtEndian>
 
 using atools::geo::Pos;
 using atools::geo::Line;
@@ -36,11 +43,26 @@ namespace atools {
 namespace fs {
 namespace common {
 
+/* Level value for cells without any data */
+const static qint16 NO_ELEVATION = std::numeric_limits<qint16>::min();
+
+/* Minimum number of samples per thread for parallel profiles */
+const static int MIN_SAMPLES_PER_THREAD = 2000;
+
+/* Number of elevation samples between cancellation checks */
+const static int CANCEL_CHECK_SAMPLES = 256;
+
+/* Pyramid file header */
+const static quint32 PYRAMID_MAGIC_NUMBER = 0x5950474C;
+const static quint16 PYRAMID_FILE_VERSION = 1;
+
 GlobeReader::GlobeReader(const QString& dataDirParam)
   : dataDir(dataDirParam)
 {
   dataFiles.fill(nullptr, NUM_DATAFILES);
   dataStreams.fill(nullptr, NUM_DATAFILES);
+  for(std::atomic<const uchar *>& dataMap : dataMaps)
+    dataMap.store(nullptr);
   dataFilenames.fill(QStringLiteral(), NUM_DATAFILES);
 }
 
@@ -107,8 +129,20 @@ void GlobeReader::openFile(int i)
       dataFiles[i] = new QFile(name);
       if(dataFiles[i]->open(QIODevice::ReadOnly))
       {
-        dataStreams[i] = new QDataStream(dataFiles[i]);
-        dataStreams[i]->setByteOrder(QDataStream::LittleEndian);
+        if(memoryMapped)
+        {
+          // Publish mapping for lock free reading
+          dataMaps[i].store(dataFiles[i]->map(0, dataFiles[i]->size()), std::memory_order_release);
+          if(dataMaps[i].load() == nullptr)
+            qWarning() << Q_FUNC_INFO << "Cannot map file" << name << dataFiles[i]->errorString();
+        }
+
+        if(dataMaps[i].load() == nullptr)
+        {
+          // Fall back to reading from the file
+          dataStreams[i] = new QDataStream(dataFiles[i]);
+          dataStreams[i]->setByteOrder(QDataStream::LittleEndian);
+        }
       }
       else
       {
@@ -133,6 +167,10 @@ void GlobeReader::closeFile(int i)
 
   if(dataFiles[i] != nullptr)
   {
+    const uchar *dataMap = dataMaps[i].exchange(nullptr);
+    if(dataMap != nullptr)
+      dataFiles[i]->unmap(const_cast<uchar *>(dataMap));
+
     dataFiles[i]->close();
     delete dataFiles[i];
     dataFiles[i] = nullptr;
@@ -141,6 +179,7 @@ void GlobeReader::closeFile(int i)
 
 void GlobeReader::closeFiles()
 {
+  QMutexLocker locker(&fileMutex);
   for(int i = 0; i < NUM_DATAFILES; i++)
     closeFile(i);
 }
@@ -210,9 +249,20 @@ float GlobeReader::elevationMax(const geo::Pos& pos, float sampleRadiusMeter)
 
 float GlobeReader::elevationFromIndexAndOffset(int fileIndex, qint64 fileOffset)
 {
+  // Read directly from memory without locking - file size was checked when collecting the files
+  const uchar *dataMap = dataMaps[fileIndex].load(std::memory_order_acquire);
+  if(dataMap != nullptr)
+    return qFromLittleEndian<qint16>(dataMap + fileOffset);
+
+  // Open file on demand and read from stream
+  QMutexLocker locker(&fileMutex);
   openFile(fileIndex);
-  QFile *dataFile = dataFiles[fileIndex];
 
+  dataMap = dataMaps[fileIndex].load(std::memory_order_acquire);
+  if(dataMap != nullptr)
+    return qFromLittleEndian<qint16>(dataMap + fileOffset);
+
+  QFile *dataFile = dataFiles[fileIndex];
   if(dataFile != nullptr)
   {
     dataFile->seek(fileOffset);
@@ -226,55 +276,482 @@ float GlobeReader::elevationFromIndexAndOffset(int fileIndex, qint64 fileOffset)
     return INVALID;
 }
 
-void GlobeReader::getElevations(atools::geo::LineString& elevations, const atools::geo::LineString& linestring, float sampleRadiusMeter)
+void GlobeReader::getElevations(atools::geo::LineString& elevations, const atools::geo::LineString& linestring,
+                                float sampleRadiusMeter, const atools::util::CancelToken& token)
 {
   if(linestring.isEmpty() || !valid)
     return;
 
+  elevationsForLineString(elevations, linestring, INTERPOLATION_SEGMENT_LENGTH_M, [this, sampleRadiusMeter](const Pos& pos) -> float {
+        return getElevation(pos, sampleRadiusMeter);
+      }, false /* parallel */, token);
+}
+
+void GlobeReader::getElevationsForSpacing(geo::LineString& elevations, const geo::LineString& linestring,
+                                          float sampleSpacingMeter)
+{
+  if(linestring.isEmpty() || !valid)
+    return;
+
+  const ElevationLevel *level = levelForSpacing(sampleSpacingMeter);
+  float segmentLength = std::max(sampleSpacingMeter, INTERPOLATION_SEGMENT_LENGTH_M);
+
+  if(level != nullptr)
+    elevationsForLineString(elevations, linestring, segmentLength, [this, level](const Pos& pos) -> float {
+          return elevationForLevel(*level, pos);
+        });
+  else
+    elevationsForLineString(elevations, linestring, segmentLength, [this](const Pos& pos) -> float {
+          return getElevation(pos);
+        });
+}
+
+void GlobeReader::getElevationsParallel(geo::LineString& elevations, const geo::LineString& linestring,
+                                        float sampleRadiusMeter, const atools::util::CancelToken& token)
+{
+  if(linestring.isEmpty() || !valid)
+    return;
+
+  elevationsForLineString(elevations, linestring, INTERPOLATION_SEGMENT_LENGTH_M,
+                          [this, sampleRadiusMeter](const Pos& pos) -> float {
+        return getElevation(pos, sampleRadiusMeter);
+      }, true /* parallel */, token);
+}
+
+QFuture<LineString> GlobeReader::getElevationsAsync(const LineString& linestring, float sampleRadiusMeter,
+                                                    const atools::util::CancelToken& token)
+{
+  auto task = [this, linestring, sampleRadiusMeter](QPromise<LineString>& promise,
+                                                     const atools::util::CancelToken& taskToken) -> void {
+        LineString elevations;
+        getElevationsParallel(elevations, linestring, sampleRadiusMeter, taskToken);
+        if(!taskToken.isCanceled())
+          promise.addResult(elevations);
+      };
+  return atools::util::async::run<LineString>(task, token);
+}
+
+void GlobeReader::elevationsForLineString(geo::LineString& elevations, const geo::LineString& linestring, float segmentLengthMeter,
+                                          const std::function<float(const geo::Pos&)>& elevationFunc, bool parallel,
+                                          const atools::util::CancelToken& token)
+{
   if(linestring.size() == 1)
-    elevations.append(linestring.constFirst().alt(getElevation(linestring.constFirst(), sampleRadiusMeter)));
+  {
+    elevations.append(linestring.constFirst().alt(elevationFunc(linestring.constFirst())));
+    return;
+  }
+
+  // Collect sample positions for all legs. Samples for leg i are at legOffsets[i] to legOffsets[i + 1].
+  // Last position is the end of the line string.
+  LineString positions;
+  QList<int> legOffsets;
+  legOffsets.reserve(linestring.size());
+  for(int i = 0; i < linestring.size() - 1; i++)
+  {
+    legOffsets.append(static_cast<int>(positions.size()));
+    Line line = Line(linestring.at(i), linestring.at(i + 1));
+    float length = line.lengthMeter();
+    line.interpolatePoints(length, static_cast<int>(length / segmentLengthMeter), positions);
+  }
+  legOffsets.append(static_cast<int>(positions.size()));
+  positions.append(linestring.constLast());
+
+  // Get elevation for all samples ===============================
+  int num = static_cast<int>(positions.size());
+  QList<float> sampleElevations(num);
+  float *elevationData = sampleElevations.data();
+  const Pos *posData = positions.constData();
+
+  auto sampleRange = [&elevationFunc, &token, elevationData, posData](int start, int end) -> void {
+        for(int i = start; i < end; i++)
+        {
+          // Check cancellation only every few samples to avoid the overhead
+          if((i - start) % CANCEL_CHECK_SAMPLES == 0 && token.isCanceled())
+            return;
+          elevationData[i] = elevationFunc(posData[i]);
+        }
+      };
+
+  int numThreads = parallel ? std::max(1, std::min(QThread::idealThreadCount(), num / MIN_SAMPLES_PER_THREAD)) : 1;
+  if(numThreads > 1)
+  {
+    QThreadPool pool;
+    pool.setMaxThreadCount(numThreads);
+    int chunkSize = (num + numThreads - 1) / numThreads;
+    for(int start = 0; start < num; start += chunkSize)
+    {
+      int end = std::min(start + chunkSize, num);
+      pool.start([&sampleRange, start, end]() -> void {
+            sampleRange(start, end);
+          });
+    }
+    pool.waitForDone();
+  }
   else
+    sampleRange(0, num);
+
+  if(token.isCanceled())
+    return;
+
+  // Merge samples and drop points with similar elevation ===============================
+  for(int i = 0; i < legOffsets.size() - 1; i++)
   {
-    LineString positions;
-    for(int i = 0; i < linestring.size() - 1; i++)
+    Pos lastDropped;
+    for(int j = legOffsets.at(i); j < legOffsets.at(i + 1); j++)
     {
-      Line line = Line(linestring.at(i), linestring.at(i + 1));
+      const Pos& pos = posData[j];
+      float elevation = elevationData[j];
+
+      if(!elevations.isEmpty())
+      {
+        if(atools::almostEqual(elevations.constLast().getAltitude(), elevation, SAME_ELEVATION_EPSILON_M))
+        {
+          // Drop points with similar altitude
+          lastDropped = pos;
+          lastDropped.setAltitude(elevation);
+          continue;
+        }
+        else if(lastDropped.isValid())
+        {
+          // Add last point of a stretch with similar altitude
+          elevations.append(lastDropped);
+          lastDropped = Pos();
+        }
+      }
 
-      float length = line.lengthMeter();
+      elevations.append(pos.alt(elevation));
+    }
+  }
+
+  elevations.append(positions.constLast().alt(elevationData[num - 1]));
+}
 
-      positions.clear();
-      line.interpolatePoints(length, static_cast<int>(length / INTERPOLATION_SEGMENT_LENGTH_M), positions);
+void GlobeReader::getCorridorElevations(QList<CorridorElevation>& elevations, const geo::LineString& linestring,
+                                        float halfWidthNm)
+{
+  if(!valid)
+    return;
 
-      Pos lastDropped;
-      for(const Pos& pos : std::as_const(positions))
+  float halfWidthMeter = atools::geo::nmToMeter(std::max(halfWidthNm, 0.f));
+  for(int i = 0; i < linestring.size() - 1; i++)
+    elevations.append(corridorElevation(linestring.at(i), linestring.at(i + 1), halfWidthMeter));
+}
+
+CorridorElevation GlobeReader::corridorElevation(const geo::Pos& from, const geo::Pos& to, float halfWidthMeter)
+{
+  CorridorElevation result;
+  if(!from.isValid() || !to.isValid())
+    return result;
+
+  // Size of a cell in north south direction - also east west at the equator
+  const float cellMeter = atools::geo::nmToMeter(60.f) * 180.f / GRID_ROWS;
+  float halfWidthCells = halfWidthMeter / cellMeter;
+
+  // Sample the leg densely enough that the rectangles around the samples overlap
+  float lengthMeter = from.distanceMeterTo(to);
+  float spacingMeter = std::max(halfWidthMeter, cellMeter);
+  int numSamples = static_cast<int>(std::ceil(lengthMeter / spacingMeter)) + 1;
+
+  // Collect column range for each row covered by the corridor ==================
+  // Columns can be outside of the grid if the leg crosses the anti-meridian and are normalized when reading
+  QMap<int, std::pair<int, int> > rowSpans;
+  float lastLonX = from.getLonX(), lonXOffset = 0.f;
+  for(int i = 0; i < numSamples; i++)
+  {
+    Pos pos = i == 0 ? from :
+              (i == numSamples - 1 ? to : from.interpolate(to, lengthMeter, static_cast<float>(i) / (numSamples - 1)));
+
+    // Keep longitude continuous across the anti-meridian
+    float lonX = pos.getLonX() + lonXOffset;
+    if(lonX - lastLonX > 180.f)
+    {
+      lonXOffset -= 360.f;
+      lonX -= 360.f;
+    }
+    else if(lonX - lastLonX < -180.f)
+    {
+      lonXOffset += 360.f;
+      lonX += 360.f;
+    }
+    lastLonX = lonX;
+
+    float col = GRID_COLUMNS * (lonX + 180.f) / 360.f;
+    float row = GRID_ROWS * (90.f - pos.getLatY()) / 180.f;
+
+    // Cells get narrower towards the poles
+    float halfWidthCols = halfWidthCells / std::max(std::cos(atools::geo::toRadians(pos.getLatY())), 0.01f);
+    int colFrom = static_cast<int>(std::floor(col - halfWidthCols));
+    int colTo = static_cast<int>(std::floor(col + halfWidthCols));
+    if(colTo - colFrom >= GRID_COLUMNS)
+      colTo = colFrom + GRID_COLUMNS - 1;
+
+    int rowFrom = std::max(0, static_cast<int>(std::floor(row - halfWidthCells)));
+    int rowTo = std::min(GRID_ROWS - 1, static_cast<int>(std::floor(row + halfWidthCells)));
+    for(int r = rowFrom; r <= rowTo; r++)
+    {
+      auto it = rowSpans.find(r);
+      if(it == rowSpans.end())
+        rowSpans.insert(r, std::make_pair(colFrom, colTo));
+      else
       {
-        float elevation = getElevation(pos, sampleRadiusMeter);
+        it->first = std::min(it->first, colFrom);
+        it->second = std::min(std::max(it->second, colTo), it->first + GRID_COLUMNS - 1);
+      }
+    }
+  }
 
-        if(!elevations.isEmpty())
+  // Scan spans ==================
+  for(auto it = rowSpans.constBegin(); it != rowSpans.constEnd(); ++it)
+  {
+    int row = it.key();
+    int col = it->first;
+    while(col <= it->second)
+    {
+      // Read consecutive cells until the end of the span or the tile
+      int fileIndex;
+      qint64 fileOffset = calcFileOffset(col, row, fileIndex);
+      int tileCol = static_cast<int>(fileOffset / 2 % TILE_COLUMNS);
+      int numCells = std::min(it->second - col + 1, TILE_COLUMNS - tileCol);
+
+      for(int i = 0; i < numCells; i++)
+      {
+        float elevation = elevationFromIndexAndOffset(fileIndex, fileOffset + i * 2);
+        if(elevation > atools::fs::common::OCEAN && elevation < atools::fs::common::INVALID &&
+           (!result.pos.isValid() || elevation > result.elevationMeter))
         {
-          if(atools::almostEqual(elevations.constLast().getAltitude(), elevation, SAME_ELEVATION_EPSILON_M))
-          {
-            // Drop points with similar altitude
-            lastDropped = pos;
-            lastDropped.setAltitude(elevation);
-            continue;
-          }
-          else if(lastDropped.isValid())
+          result.elevationMeter = elevation;
+          result.pos = Pos((col + i + 0.5f) * 360.f / GRID_COLUMNS - 180.f, 90.f - (row + 0.5f) * 180.f / GRID_ROWS,
+                           elevation).normalized();
+        }
+      }
+      col += numCells;
+    }
+  }
+
+  return result;
+}
+
+float GlobeReader::getElevationForSpacing(const geo::Pos& pos, float sampleSpacingMeter)
+{
+  if(!valid || !pos.isValid())
+    return atools::fs::common::INVALID;
+
+  const ElevationLevel *level = levelForSpacing(sampleSpacingMeter);
+  return level != nullptr ? elevationForLevel(*level, pos) : getElevation(pos);
+}
+
+const GlobeReader::ElevationLevel *GlobeReader::levelForSpacing(float sampleSpacingMeter) const
+{
+  // Cell height in meter for full resolution
+  float cellMeter = atools::geo::nmToMeter(60.f) * 180.f / GRID_ROWS;
+
+  const ElevationLevel *found = nullptr;
+  for(const ElevationLevel& level : levels)
+  {
+    if(level.factor * cellMeter <= sampleSpacingMeter)
+      found = &level;
+  }
+  return found;
+}
+
+float GlobeReader::elevationForLevel(const ElevationLevel& level, const geo::Pos& pos) const
+{
+  int col = static_cast<int>(level.columns * (pos.getLonX() + 180.) / 360.);
+  int row = static_cast<int>(level.rows * (90. - pos.getLatY()) / 180.);
+
+  // Wrap at anti-meridian and clamp at poles
+  col = (col % level.columns + level.columns) % level.columns;
+  row = std::max(0, std::min(row, level.rows - 1));
+
+  qint16 elevation = level.values.at(col + row * level.columns);
+  return elevation == NO_ELEVATION ? INVALID : elevation;
+}
+
+bool GlobeReader::buildPyramid()
+{
+  clearPyramid();
+
+  if(!valid)
+    return false;
+
+  QElapsedTimer timer;
+  timer.start();
+
+  // 2 arc minutes, 8 arc minutes and 30 arc minutes
+  ElevationLevel level2, level8, level30;
+  buildLevel(level2, nullptr, 4);
+  buildLevel(level8, &level2, 4);
+  buildLevel(level30, &level2, 15);
+
+  levels.append(level2);
+  levels.append(level8);
+  levels.append(level30);
+
+  qDebug() << Q_FUNC_INFO << "Building took" << timer.elapsed() << "ms";
+  return true;
+}
+
+void GlobeReader::buildLevel(ElevationLevel& level, const ElevationLevel *source, int factor)
+{
+  int sourceColumns = source != nullptr ? source->columns : GRID_COLUMNS;
+  int sourceRows = source != nullptr ? source->rows : GRID_ROWS;
+
+  level.factor = factor * (source != nullptr ? source->factor : 1);
+  level.columns = sourceColumns / factor;
+  level.rows = sourceRows / factor;
+  level.values.resize(static_cast<qsizetype>(level.columns) * level.rows);
+
+  // Open all files before reading concurrently
+  bool allMapped = true;
+  if(source == nullptr)
+  {
+    QMutexLocker locker(&fileMutex);
+    for(int i = 0; i < NUM_DATAFILES; i++)
+    {
+      openFile(i);
+      if(dataFiles.at(i) != nullptr && dataMaps[i].load() == nullptr)
+        allMapped = false;
+    }
+  }
+
+  qint16 *values = level.values.data();
+  auto buildRows = [this, &level, source, factor, sourceColumns, values](int startRow, int endRow) -> void {
+        for(int row = startRow; row < endRow; row++)
+        {
+          for(int col = 0; col < level.columns; col++)
           {
-            // Add last point of a stretch with similar altitude
-            elevations.append(lastDropped);
-            lastDropped = Pos();
+            // Maximum of all source cells ignoring missing data
+            qint16 maxElevation = NO_ELEVATION;
+            for(int sourceRow = row * factor; sourceRow < (row + 1) * factor; sourceRow++)
+            {
+              for(int sourceCol = col * factor; sourceCol < (col + 1) * factor; sourceCol++)
+              {
+                qint16 elevation;
+                if(source != nullptr)
+                  elevation = source->values.at(sourceCol + sourceRow * sourceColumns);
+                else
+                {
+                  int fileIndex;
+                  qint64 fileOffset = calcFileOffset(sourceCol, sourceRow, fileIndex);
+                  float value = elevationFromIndexAndOffset(fileIndex, fileOffset);
+                  elevation = value < INVALID ? static_cast<qint16>(value) : NO_ELEVATION;
+                }
+                maxElevation = std::max(maxElevation, elevation);
+              }
+            }
+            values[col + row * level.columns] = maxElevation;
           }
         }
+      };
+
+  // Streams cannot be read concurrently
+  int numThreads = allMapped ? std::max(1, std::min(QThread::idealThreadCount(), level.rows)) : 1;
+  if(numThreads > 1)
+  {
+    QThreadPool pool;
+    pool.setMaxThreadCount(numThreads);
+    int chunkSize = (level.rows + numThreads - 1) / numThreads;
+    for(int start = 0; start < level.rows; start += chunkSize)
+    {
+      int end = std::min(start + chunkSize, level.rows);
+      pool.start([&buildRows, start, end]() -> void {
+            buildRows(start, end);
+          });
+    }
+    pool.waitForDone();
+  }
+  else
+    buildRows(0, level.rows);
+}
+
+void GlobeReader::clearPyramid()
+{
+  levels.clear();
+}
+
+bool GlobeReader::writePyramid(const QString& filename) const
+{
+  QFile file(filename);
+  if(file.open(QIODevice::WriteOnly))
+  {
+    QDataStream out(&file);
+    out.setByteOrder(QDataStream::LittleEndian);
+    out << PYRAMID_MAGIC_NUMBER << PYRAMID_FILE_VERSION << static_cast<qint32>(levels.size());
+
+    for(const ElevationLevel& level : levels)
+    {
+      out << static_cast<qint32>(level.factor) << static_cast<qint32>(level.columns) << static_cast<qint32>(level.rows);
+      for(qint16 value : level.values)
+        out << value;
+    }
+
+    if(out.status() != QDataStream::Ok)
+    {
+      qWarning() << Q_FUNC_INFO << "Error writing" << filename;
+      return false;
+    }
+    return true;
+  }
+  else
+    qWarning() << Q_FUNC_INFO << "Cannot open" << filename << file.errorString();
+  return false;
+}
+
+bool GlobeReader::readPyramid(const QString& filename)
+{
+  clearPyramid();
 
-        elevations.append(pos.alt(elevation));
+  QFile file(filename);
+  if(file.open(QIODevice::ReadOnly))
+  {
+    QDataStream in(&file);
+    in.setByteOrder(QDataStream::LittleEndian);
+
+    quint32 magicNumber;
+    quint16 version;
+    qint32 numLevels;
+    in >> magicNumber >> version >> numLevels;
+
+    if(magicNumber != PYRAMID_MAGIC_NUMBER || version != PYRAMID_FILE_VERSION || numLevels < 0 || numLevels > 16)
+    {
+      qWarning() << Q_FUNC_INFO << "Invalid file" << filename;
+      return false;
+    }
+
+    QList<ElevationLevel> loaded;
+    for(int i = 0; i < numLevels && in.status() == QDataStream::Ok; i++)
+    {
+      ElevationLevel level;
+      qint32 factor, columns, rows;
+      in >> factor >> columns >> rows;
+
+      if(factor <= 0 || columns * factor != GRID_COLUMNS || rows * factor != GRID_ROWS)
+      {
+        qWarning() << Q_FUNC_INFO << "Invalid level in" << filename;
+        return false;
       }
+
+      level.factor = factor;
+      level.columns = columns;
+      level.rows = rows;
+      level.values.resize(static_cast<qsizetype>(columns) * rows);
+      for(qint16& value : level.values)
+        in >> value;
+      loaded.append(level);
     }
 
-    elevations.append(linestring.constLast());
-    if(!elevations.isEmpty())
-      elevations.last().setAltitude(getElevation(elevations.constLast(), sampleRadiusMeter));
+    if(in.status() != QDataStream::Ok)
+    {
+      qWarning() << Q_FUNC_INFO << "Error reading" << filename;
+      return false;
+    }
+
+    levels = loaded;
+    return true;
   }
+  else
+    qWarning() << Q_FUNC_INFO << "Cannot open" << filename << file.errorString();
+  return false;
 }
 
 qint64 GlobeReader::calcFileOffset(const atools::geo::Pos& pos, int& fileIndex)
@@ -18,15 +18,21 @@
 #ifndef ATOOLS_DTM_GLOBEREADER_H
 #define ATOOLS_DTM_GLOBEREADER_H
 
+#include "geo/pos.h"
+#include "util/asynctask.h"
+
 #include <QFile>
 #include <QList>
+#include <QMutex>
+
+#include <atomic>
+#include <functional>
 
 class DtmTest;
 class QFileInfo;
 
 namespace atools {
 namespace geo {
-class Pos;
 class LineString;
 }
 
@@ -36,8 +42,21 @@ namespace common {
 static Q_DECL_CONSTEXPR float INVALID = std::numeric_limits<float>::max();
 static Q_DECL_CONSTEXPR float OCEAN = -500.f;
 
+/* Highest terrain within the corridor of one route leg */
+struct CorridorElevation
+{
+  /* Maximum elevation in meter. 0 if there is only ocean or no data. */
+  float elevationMeter = 0.f;
+
+  /* Center of the highest grid cell with elevation in meter as altitude. Invalid if there is no land. */
+  atools::geo::Pos pos;
+};
+
 /*
  * DTM reader class for the GLOBE data which can be get at https://www.ngdc.noaa.gov/mgg/topo/globeget.html
+ *
+ * Elevation queries can be called concurrently. Files are opened on demand and mapped into memory if possible.
+ * openFiles(), closeFiles() and building or loading the pyramid must not run concurrently with queries.
  */
 class GlobeReader
 {
@@ -62,7 +81,66 @@ public:
   /* Get elevations along a great circle line. Will create a point every 500 meters and delete
    * consecutive ones with same elevation
    * "sampleRadiusMeter" defines a rectangle where five points are sampled and the maximum is used.*/
-  void getElevations(geo::LineString& elevations, const atools::geo::LineString& linestring, float sampleRadiusMeter = 0.f);
+  void getElevations(geo::LineString& elevations, const atools::geo::LineString& linestring, float sampleRadiusMeter = 0.f,
+                     const atools::util::CancelToken& token = atools::util::CancelToken());
+
+  /* Same as getElevations() with the same result but samples are evaluated on all cores for long routes.
+   * Sampling stops and elevations are left unchanged if the token is canceled. */
+  void getElevationsParallel(geo::LineString& elevations, const atools::geo::LineString& linestring,
+                             float sampleRadiusMeter = 0.f, const atools::util::CancelToken& token = atools::util::CancelToken());
+
+  /* Runs getElevationsParallel() on the shared thread pool of atools::util::async. The future has one result
+   * or is canceled. Files have to be memory mapped or opened and this object has to outlive the future. */
+  QFuture<atools::geo::LineString> getElevationsAsync(const atools::geo::LineString& linestring, float sampleRadiusMeter = 0.f,
+                                                       const atools::util::CancelToken& token = atools::util::CancelToken());
+
+  /* Build downsampled maximum elevation levels from the GLOBE files for fast long distance profiles.
+   * Levels have cell sizes of 2, 8 and 30 arc minutes and contain the maximum elevation in each cell.
+   * Reads all files once which takes a while and uses about 125 MB of memory. Uses all cores if files are mapped.
+   * Returns false if no files are available. */
+  bool buildPyramid();
+
+  /* Save and load levels to avoid rebuilding them from the files. Returns false on error. */
+  bool writePyramid(const QString& filename) const;
+  bool readPyramid(const QString& filename);
+
+  /* Free levels */
+  void clearPyramid();
+
+  bool hasPyramid() const
+  {
+    return !levels.isEmpty();
+  }
+
+  /* Maximum elevation in meter at position for samples spaced sampleSpacingMeter apart.
+   * Uses the coarsest level having cells not larger than the spacing or the full resolution data
+   * if spacing is small or no levels are available. */
+  float getElevationForSpacing(const atools::geo::Pos& pos, float sampleSpacingMeter);
+
+  /* Get elevations along a great circle line with a point every sampleSpacingMeter. Elevations are taken from
+   * the level matching the spacing and show the maximum terrain between the samples.
+   * Consecutive points with same elevation are removed like in getElevations(). */
+  void getElevationsForSpacing(geo::LineString& elevations, const atools::geo::LineString& linestring,
+                               float sampleSpacingMeter);
+
+  /* Highest terrain for each leg within the corridor of halfWidthNm on each side of the great circle line.
+   * Appends one entry per leg to elevations. Scans all full resolution grid cells touching the corridor row by row
+   * which can be used for minimum safe altitude checks. The corridor is slightly wider than given at the leg ends
+   * and never misses terrain. */
+  void getCorridorElevations(QList<atools::fs::common::CorridorElevation>& elevations,
+                             const atools::geo::LineString& linestring, float halfWidthNm);
+
+  /* Map files into memory when opened which turns each sample into a direct read from memory.
+   * Falls back to file access if mapping fails. Enabled by default. Takes effect for files opened later. */
+  void setMemoryMapped(bool value)
+  {
+    memoryMapped = value;
+  }
+
+  bool isMemoryMapped() const
+  {
+    return memoryMapped;
+  }
 
   /* true if folder exists and files were found */
   bool isValid() const
@@ -95,16 +173,51 @@ private:
   qint64 calcFileOffset(double lonx, double laty, int& fileIndex);
   static bool fileEntryValid(const QFileInfo& fileEntry);
   void closeFile(int i);
+
+  /* Open file if not already done. Caller has to lock fileMutex. */
   void openFile(int i);
   float elevationFromIndexAndOffset(int fileIndex, qint64 fileOffset);
   float elevationMax(const atools::geo::Pos& pos, float sampleRadiusMeter);
 
+  /* Get highest cell for the corridor around one leg */
+  CorridorElevation corridorElevation(const atools::geo::Pos& from, const atools::geo::Pos& to, float halfWidthMeter);
+
+  /* Downsampled maximum elevations. Values are ordered by rows from north to south like the GLOBE grid. */
+  struct ElevationLevel
+  {
+    /* Number of full resolution cells in one level cell in each direction */
+    int factor = 0, columns = 0, rows = 0;
+    QList<qint16> values;
+  };
+
+  /* Fill level from source having factor times more columns and rows. Source is full resolution if null. */
+  void buildLevel(ElevationLevel& level, const ElevationLevel *source, int factor);
+  float elevationForLevel(const ElevationLevel& level, const atools::geo::Pos& pos) const;
+
+  /* Level for spacing or null if full resolution should be used */
+  const ElevationLevel *levelForSpacing(float sampleSpacingMeter) const;
+
+  /* Sample lines every segmentLengthMeter using elevationFunc and drop points with same elevation.
+   * elevationFunc has to be thread safe if parallel is true. Returns without changes if the token is canceled. */
+  void elevationsForLineString(geo::LineString& elevations, const atools::geo::LineString& linestring,
+                               float segmentLengthMeter, const std::function<float(const atools::geo::Pos& pos)>& elevationFunc,
+                               bool parallel = false, const atools::util::CancelToken& token = atools::util::CancelToken());
+
   QString dataDir;
   QList<QString> dataFilenames;
   QList<QFile *> dataFiles;
   QList<QDataStream *> dataStreams;
 
-  bool valid = false;
+  /* Memory mapped file content or null if not mapped */
+  std::atomic<const uchar *> dataMaps[NUM_DATAFILES];
+
+  /* Protects lazy opening of files and reading from streams if not mapped */
+  QMutex fileMutex;
+
+  /* Ordered from finest to coarsest */
+  QList<ElevationLevel> levels;
+
+  bool valid = false, memoryMapped = true;
 };
 
 } // namespace common
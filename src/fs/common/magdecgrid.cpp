@@ -0,0 +1,99 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/common/magdecgrid.h"
+
+#include "fs/common/magdecreader.h"
+#include "geo/pos.h"
+
+#include <QDebug>
+
+namespace atools {
+namespace fs {
+namespace common {
+
+MagDecGrid::MagDecGrid(const MagDecReader& reader, float resolutionDeg, Precision precisionParam)
+{
+  build(reader, resolutionDeg, precisionParam);
+}
+
+void MagDecGrid::build(const MagDecReader& reader, float resolutionDeg, Precision precisionParam)
+{
+  clear();
+
+  // Adjust resolution to get full rows and columns
+  int rowSteps = std::max(1, static_cast<int>(std::round(180.f / std::max(resolutionDeg, 0.01f))));
+  resolution = 180.f / rowSteps;
+  invResolution = rowSteps / 180.f;
+  precision = precisionParam;
+
+  numRows = rowSteps + 1;
+  numColumns = rowSteps * 2 + 1;
+
+  if(precision == HALF)
+    halfValues.reserve(numRows * numColumns);
+  else
+    values.reserve(numRows * numColumns);
+
+  for(int row = 0; row < numRows; row++)
+  {
+    float latY = std::min(-90.f + row * resolution, 90.f);
+    for(int col = 0; col < numColumns; col++)
+    {
+      float magvar = reader.getMagVar(std::min(-180.f + col * resolution, 180.f), latY);
+      if(precision == HALF)
+        halfValues.append(qfloat16(magvar));
+      else
+        values.append(magvar);
+    }
+  }
+
+  qDebug() << Q_FUNC_INFO << "resolution" << resolution << "rows" << numRows << "columns" << numColumns
+           << "bytes" << getMemorySize();
+}
+
+void MagDecGrid::clear()
+{
+  values.clear();
+  halfValues.clear();
+  numColumns = numRows = 0;
+}
+
+float MagDecGrid::getMagVar(const atools::geo::Pos& pos) const
+{
+  return pos.isValid() ? getMagVar(pos.getLonX(), pos.getLatY()) : 0.f;
+}
+
+void MagDecGrid::getMagVars(float *magvars, const float *lonX, const float *latY, int num) const
+{
+  // Decide precision once for all values
+  if(precision == HALF)
+    interpolateBatch(halfValues.constData(), magvars, lonX, latY, num);
+  else
+    interpolateBatch(values.constData(), magvars, lonX, latY, num);
+}
+
+void MagDecGrid::getMagVars(QList<float>& magvars, const QList<atools::geo::Pos>& positions) const
+{
+  magvars.resize(positions.size());
+  for(int i = 0; i < positions.size(); i++)
+    magvars[i] = getMagVar(positions.at(i));
+}
+
+} // namespace common
+} // namespace fs
+} // namespace atools
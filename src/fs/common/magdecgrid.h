@@ -0,0 +1,158 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_COMMON_MAGDECGRID_H
+#define ATOOLS_FS_COMMON_MAGDECGRID_H
+
+#include <QList>
+#include <QtNumeric>
+#include <qfloat16.h>
+
+#include <cmath>
+
+namespace atools {
+namespace geo {
+class Pos;
+}
+
+namespace fs {
+namespace common {
+
+class MagDecReader;
+
+/*
+ * Dense precomputed grid of magnetic declination values sampled from a MagDecReader for fast bulk lookups,
+ * e.g. when updating all navaids in a database.
+ *
+ * Values are stored row by row from south to north and west to east including a duplicate column at 180°
+ * so interpolation needs no wrap around or range checks. Lookups use bilinear interpolation like MagDecReader.
+ * Lookups never throw and return 0 for an invalid grid.
+ *
+ * Half precision halves the memory size at a loss of about 0.01° precision.
+ */
+class MagDecGrid
+{
+public:
+  enum Precision
+  {
+    SINGLE,
+    HALF
+  };
+
+  MagDecGrid()
+  {
+  }
+
+  /* Sample reader in steps of resolutionDeg. Resolution is adjusted to divide 180° evenly.
+   * A resolution of one degree gives the same values as the reader. Reader has to be valid. */
+  explicit MagDecGrid(const atools::fs::common::MagDecReader& reader, float resolutionDeg = 1.f,
+                      Precision precisionParam = SINGLE);
+
+  void build(const atools::fs::common::MagDecReader& reader, float resolutionDeg = 1.f,
+             Precision precisionParam = SINGLE);
+
+  /* Frees memory and sets state to invalid */
+  void clear();
+
+  bool isValid() const
+  {
+    return numColumns > 0;
+  }
+
+  /* East values are positive while West values are negative. */
+  float getMagVar(const atools::geo::Pos& pos) const;
+
+  float getMagVar(float lonX, float latY) const
+  {
+    if(precision == HALF)
+      return interpolate(halfValues.constData(), lonX, latY);
+    else
+      return interpolate(values.constData(), lonX, latY);
+  }
+
+  /* Batch lookup for coordinate arrays writing num values into magvars */
+  void getMagVars(float *magvars, const float *lonX, const float *latY, int num) const;
+
+  /* Batch lookup. Invalid positions get a value of 0. */
+  void getMagVars(QList<float>& magvars, const QList<atools::geo::Pos>& positions) const;
+
+  float getResolution() const
+  {
+    return resolution;
+  }
+
+  Precision getPrecision() const
+  {
+    return precision;
+  }
+
+  /* Approximate memory size of values in bytes */
+  qsizetype getMemorySize() const
+  {
+    return values.size() * static_cast<qsizetype>(sizeof(float)) +
+           halfValues.size() * static_cast<qsizetype>(sizeof(qfloat16));
+  }
+
+private:
+  template<typename TYPE>
+  float interpolate(const TYPE *data, float lonX, float latY) const;
+
+  template<typename TYPE>
+  void interpolateBatch(const TYPE *data, float *magvars, const float *lonX, const float *latY, int num) const;
+
+  QList<float> values;
+  QList<qfloat16> halfValues;
+
+  float resolution = 1.f, invResolution = 1.f;
+  int numColumns = 0, numRows = 0;
+  Precision precision = SINGLE;
+};
+
+template<typename TYPE>
+float MagDecGrid::interpolate(const TYPE *data, float lonX, float latY) const
+{
+  if(numColumns == 0 || qIsNaN(lonX) || qIsNaN(latY))
+    return 0.f;
+
+  // Wrap longitude and clamp latitude into grid
+  if(lonX < -180.f || lonX > 180.f)
+    lonX = std::remainder(lonX, 360.f);
+  latY = std::max(-90.f, std::min(latY, 90.f));
+
+  float x = (lonX + 180.f) * invResolution, y = (latY + 90.f) * invResolution;
+  int col = std::max(0, std::min(static_cast<int>(x), numColumns - 2));
+  int row = std::max(0, std::min(static_cast<int>(y), numRows - 2));
+  float fx = x - col, fy = y - row;
+
+  const TYPE *p = data + row * numColumns + col;
+  float bottom = static_cast<float>(p[0]) * (1.f - fx) + static_cast<float>(p[1]) * fx;
+  float top = static_cast<float>(p[numColumns]) * (1.f - fx) + static_cast<float>(p[numColumns + 1]) * fx;
+  return bottom * (1.f - fy) + top * fy;
+}
+
+template<typename TYPE>
+void MagDecGrid::interpolateBatch(const TYPE *data, float *magvars, const float *lonX, const float *latY, int num) const
+{
+  for(int i = 0; i < num; i++)
+    magvars[i] = interpolate(data, lonX[i], latY[i]);
+}
+
+} // namespace common
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_COMMON_MAGDECGRID_H
@@ -27,6 +27,8 @@
 
 #include <QFile>
 #include <QDebug>
+#include <QDir>
+#include <QSaveFile>
 #include <cmath>
 
 using atools::geo::Pos;
@@ -36,6 +38,7 @@ namespace fs {
 namespace common {
 
 MagDecReader::MagDecReader()
+  : wmmCacheDirectory(atools::tempDir())
 {
 }
 
@@ -58,6 +61,18 @@ void MagDecReader::readFromWmm(int year, int month)
 {
   clear();
 
+  // Look for a grid calculated earlier for the same model and month
+  QString cacheFile, modelKey;
+  if(!wmmCacheDirectory.isEmpty() && year > 0 && month > 0)
+  {
+    modelKey = atools::wmm::MagDecTool::getModelKey();
+    cacheFile = QDir(wmmCacheDirectory).filePath(QStringLiteral("atools_wmm_%1_%2_%3.bin").
+                                                 arg(qHash(modelKey), 0, 16).arg(year).arg(month, 2, 10, QChar('0')));
+
+    if(readWmmCache(cacheFile, modelKey, year, month))
+      return;
+  }
+
   // Create WMM model data
   atools::wmm::MagDecTool magDecTool;
   magDecTool.init(year, month);
@@ -72,6 +87,71 @@ void MagDecReader::readFromWmm(int year, int month)
     for(int lonX = -180; lonX < 180; lonX++)
       magDecValues[offset(lonX, latY)] = magDecTool.getMagVar(lonX, latY);
   }
+
+  if(!cacheFile.isEmpty())
+    writeWmmCache(cacheFile, modelKey, year, month);
+}
+
+bool MagDecReader::readWmmCache(const QString& filename, const QString& modelKey, int year, int month)
+{
+  QFile file(filename);
+  if(!file.open(QIODevice::ReadOnly))
+    return false;
+
+  QDataStream in(&file);
+  in.setVersion(QDataStream::Qt_5_5);
+
+  quint32 magic;
+  quint16 version;
+  in >> magic >> version;
+
+  if(magic != WMM_CACHE_MAGIC_NUMBER || version != WMM_CACHE_VERSION)
+  {
+    qWarning() << Q_FUNC_INFO << "Invalid cache file" << filename;
+    return false;
+  }
+
+  QString key;
+  qint32 cacheYear, cacheMonth;
+  QDate date;
+  QByteArray bytes;
+  in >> key >> cacheYear >> cacheMonth >> date >> bytes;
+
+  if(in.status() != QDataStream::Ok || key != modelKey || cacheYear != year || cacheMonth != month)
+  {
+    qWarning() << Q_FUNC_INFO << "Outdated or invalid cache file" << filename;
+    return false;
+  }
+
+  readFromBytes(bytes);
+  if(numValues != 360 * 181)
+  {
+    qWarning() << Q_FUNC_INFO << "Invalid number of values in cache file" << filename << numValues;
+    clear();
+    return false;
+  }
+
+  referenceDate = date;
+  qInfo() << Q_FUNC_INFO << "Read WMM grid from" << filename << "reference date" << referenceDate;
+  return true;
+}
+
+void MagDecReader::writeWmmCache(const QString& filename, const QString& modelKey, int year, int month) const
+{
+  QSaveFile file(filename);
+  if(file.open(QIODevice::WriteOnly))
+  {
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_5);
+
+    out << WMM_CACHE_MAGIC_NUMBER << WMM_CACHE_VERSION << modelKey << static_cast<qint32>(year) << static_cast<qint32>(month)
+        << referenceDate << writeToBytes();
+
+    if(!file.commit())
+      qWarning() << Q_FUNC_INFO << "Cannot write" << filename << file.errorString();
+  }
+  else
+    qWarning() << Q_FUNC_INFO << "Cannot open" << filename << file.errorString();
 }
 
 void MagDecReader::readFromBgl(const QString& filename)
@@ -54,6 +54,13 @@ public:
   void readFromWmm(const QDate& date);
   void readFromWmm();
 
+  /* Directory where calculated WMM grids are cached. Cache files are keyed by model version, year and month.
+   * Default is the temporary directory. Caching is disabled if empty. */
+  void setWmmCacheDirectory(const QString& directory)
+  {
+    wmmCacheDirectory = directory;
+  }
+
   /* Read values from magdec.bgl file */
   void readFromBgl(const QString& filename);
 
@@ -88,6 +95,14 @@ public:
   }
 
 private:
+  /* Magic number and version for the WMM cache file */
+  const static quint32 WMM_CACHE_MAGIC_NUMBER = 0x4D4D5743;
+  const static quint16 WMM_CACHE_VERSION = 1;
+
+  /* Read grid from cache file. Returns false if not found or not matching */
+  bool readWmmCache(const QString& filename, const QString& modelKey, int year, int month);
+  void writeWmmCache(const QString& filename, const QString& modelKey, int year, int month) const;
+
   QByteArray writeToBytes() const;
   void readFromBytes(const QByteArray& bytes);
 
@@ -100,7 +115,7 @@ private:
   /* https://www.fsdeveloper.com/wiki/index.php?title=Magdec_BGL_File */
   float *magDecValues = nullptr;
 
-  QString wmmVersion;
+  QString wmmVersion, wmmCacheDirectory;
 };
 
 } // namespace common
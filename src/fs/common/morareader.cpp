@@ -20,10 +20,16 @@
 #include "sql/sqldatabase.h"
 #include "sql/sqlutil.h"
 #include "geo/pos.h"
+#include "geo/linestring.h"
 #include "exception.h"
+#include "util/memoryusage.h"
 
 #include <QDataStream>
+#include <QFile>
 #include <QIODevice>
+#include <QtEndian>
+
+#include <cmath>
 
 using atools::sql::SqlQuery;
 using atools::sql::SqlUtil;
@@ -32,6 +38,9 @@ namespace atools {
 namespace fs {
 namespace common {
 
+/* Legs are sampled in this distance to find all touched grid cells. Cells have a size of about 110 km or less. */
+const static float LEG_SAMPLE_DISTANCE_METER = 5000.f;
+
 MoraReader::MoraReader(sql::SqlDatabase *sqlDb1, sql::SqlDatabase *sqlDb2)
 {
   assignDatabase(sqlDb1, sqlDb2);
@@ -51,7 +60,7 @@ MoraReader::MoraReader(sql::SqlDatabase& sqlDb)
 
 MoraReader::~MoraReader()
 {
-
+  clear();
 }
 
 bool MoraReader::readFromTable(sql::SqlDatabase *sqlDbNav, sql::SqlDatabase *sqlDbSim)
@@ -313,6 +322,103 @@ void MoraReader::writeToTable(const QList<quint16>& grid, int columns, int rows,
   moraWriteQuery.exec();
 }
 
+bool MoraReader::writeToFile(const QString& filename) const
+{
+  if(!isValid())
+  {
+    qWarning() << Q_FUNC_INFO << "No MORA data loaded";
+    return false;
+  }
+
+  QFile file(filename);
+  if(file.open(QIODevice::WriteOnly))
+  {
+    QDataStream out(&file);
+    out.setByteOrder(QDataStream::LittleEndian);
+
+    // Write header
+    out << MAGIC_NUMBER_FILE << FILE_VERSION << static_cast<quint32>(lonxColums) << static_cast<quint32>(latyRows);
+
+    // Write data as 16 bit values keeping UNKNOWN and ERROR
+    for(int i = 0; i < lonxColums * latyRows; i++)
+      out << valueAt(i);
+
+    if(out.status() != QDataStream::Ok || file.error() != QFile::NoError)
+    {
+      qWarning() << Q_FUNC_INFO << "Error writing" << filename << file.errorString();
+      return false;
+    }
+
+    qInfo() << Q_FUNC_INFO << "MORA data written to" << filename << file.size() << "bytes";
+    return true;
+  }
+  else
+    qWarning() << Q_FUNC_INFO << "Cannot open" << filename << file.errorString();
+  return false;
+}
+
+bool MoraReader::readFromFile(const QString& filename)
+{
+  clear();
+
+  QFile *file = new QFile(filename);
+  if(!file->open(QIODevice::ReadOnly))
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot open" << filename << file->errorString();
+    delete file;
+    return false;
+  }
+
+  // Read and check header
+  QByteArray header = file->read(FILE_HEADER_SIZE);
+  if(header.size() != FILE_HEADER_SIZE)
+  {
+    qWarning() << Q_FUNC_INFO << "File too small" << filename;
+    delete file;
+    return false;
+  }
+
+  const uchar *headerData = reinterpret_cast<const uchar *>(header.constData());
+  quint32 magicNumber = qFromLittleEndian<quint32>(headerData), version = qFromLittleEndian<quint32>(headerData + 4);
+  int columns = static_cast<int>(qFromLittleEndian<quint32>(headerData + 8));
+  int rows = static_cast<int>(qFromLittleEndian<quint32>(headerData + 12));
+
+  // Lookup requires the fixed one degree grid
+  if(magicNumber != MAGIC_NUMBER_FILE || version != FILE_VERSION || columns != 360 || rows != 180 ||
+     file->size() != FILE_HEADER_SIZE + static_cast<qint64>(columns) * rows * 2)
+  {
+    qWarning() << Q_FUNC_INFO << "Invalid MORA file" << filename;
+    delete file;
+    return false;
+  }
+
+  const uchar *data = file->map(0, file->size());
+  if(data != nullptr)
+  {
+    mappedFile = file;
+    mappedData = data + FILE_HEADER_SIZE;
+  }
+  else
+  {
+    // Fall back to reading all values
+    qWarning() << Q_FUNC_INFO << "Cannot map" << filename << file->errorString();
+    QByteArray bytes = file->readAll();
+    const uchar *values = reinterpret_cast<const uchar *>(bytes.constData());
+    datagrid.resize(columns * rows);
+    for(int i = 0; i < columns * rows; i++)
+      datagrid[i] = qFromLittleEndian<quint16>(values + i * 2);
+    delete file;
+  }
+
+  lonxColums = columns;
+  latyRows = rows;
+  dataAvailable = true;
+
+  qInfo() << Q_FUNC_INFO << filename << "MORA data loaded" << lonxColums << "x *" << latyRows << "y"
+          << (mappedData != nullptr ? "mapped" : "read");
+  return true;
+}
+
 bool MoraReader::isDataAvailable()
 {
   return dataAvailable;
@@ -320,11 +426,31 @@ bool MoraReader::isDataAvailable()
 
 void MoraReader::clear()
 {
+  if(mappedFile != nullptr)
+  {
+    mappedFile->unmap(const_cast<uchar *>(mappedData - FILE_HEADER_SIZE));
+    mappedFile->close();
+    delete mappedFile;
+    mappedFile = nullptr;
+    mappedData = nullptr;
+  }
+
   datagrid.clear();
   lonxColums = latyRows = 0;
   dataAvailable = false;
 }
 
+void MoraReader::getMemoryUsage(atools::util::MemoryUsage& usage) const
+{
+  usage.add(QStringLiteral("MoraReader/grid"), atools::util::MemoryUsage::listBytes(datagrid), datagrid.size());
+
+  if(mappedData != nullptr)
+  {
+    qint64 numValues = static_cast<qint64>(lonxColums) * latyRows;
+    usage.add(QStringLiteral("MoraReader/mapped"), numValues * static_cast<qint64>(sizeof(quint16)), numValues);
+  }
+}
+
 int MoraReader::getMoraFt(const geo::Pos& pos) const
 {
   return getMoraFt(static_cast<int>(pos.getLonX()), static_cast<int>(pos.getLatY()));
@@ -364,7 +490,50 @@ int MoraReader::getMoraFt(int lonx, int laty) const
 
   int pos = (-laty + 90) * 360 + lonx + 180;
 
-  return datagrid.at(pos);
+  return valueAt(pos);
+}
+
+quint16 MoraReader::valueAt(int index) const
+{
+  if(mappedData != nullptr)
+    return qFromLittleEndian<quint16>(mappedData + index * 2);
+  else
+    return datagrid.at(index);
+}
+
+void MoraReader::getMoraFtForLegs(QList<int>& moraFt, const geo::LineString& linestring) const
+{
+  if(!dataAvailable)
+    throw Exception("MORA data not available");
+
+  for(int i = 0; i < linestring.size() - 1; i++)
+    moraFt.append(moraFtForLeg(linestring.at(i), linestring.at(i + 1)));
+}
+
+int MoraReader::moraFtForLeg(const geo::Pos& from, const geo::Pos& to) const
+{
+  float distanceMeter = from.distanceMeterTo(to);
+  int numSamples = static_cast<int>(std::ceil(distanceMeter / LEG_SAMPLE_DISTANCE_METER)) + 1;
+
+  int maxMora = -1;
+  int lastLonX = std::numeric_limits<int>::max(), lastLatY = std::numeric_limits<int>::max();
+  for(int i = 0; i < numSamples; i++)
+  {
+    float fraction = static_cast<float>(i) / (numSamples - 1);
+    geo::Pos pos = i == 0 ? from : (i == numSamples - 1 ? to : from.interpolate(to, distanceMeter, fraction));
+    int lonx = static_cast<int>(pos.getLonX()), laty = static_cast<int>(pos.getLatY());
+
+    // Skip samples in the same cell
+    if(lonx == lastLonX && laty == lastLatY)
+      continue;
+    lastLonX = lonx;
+    lastLatY = laty;
+
+    int mora = getMoraFt(lonx, laty);
+    if(mora != UNKNOWN && mora != ERROR)
+      maxMora = std::max(maxMora, mora);
+  }
+  return maxMora == -1 ? UNKNOWN : maxMora;
 }
 
 void MoraReader::assignDatabase(sql::SqlDatabase *sqlDb1, sql::SqlDatabase *sqlDb2)
@@ -23,14 +23,20 @@
 #include <QString>
 #include <QList>
 
+class QFile;
+
 namespace atools {
 namespace geo {
 class Pos;
+class LineString;
 }
 namespace sql {
 class SqlDatabase;
 class SqlQuery;
 }
+namespace util {
+class MemoryUsage;
+}
 
 namespace fs {
 namespace common {
@@ -52,6 +58,9 @@ public:
   MoraReader(atools::sql::SqlDatabase& sqlDb);
   virtual ~MoraReader();
 
+  MoraReader(const MoraReader& other) = delete;
+  MoraReader& operator=(const MoraReader& other) = delete;
+
   /* Read values from table "mora_grid". returns true if successfull and table exists. */
   bool readFromTable();
 
@@ -61,6 +70,15 @@ public:
   /* Writes values to table "mora_grid". Object has to be valid. Copies data to this instance. */
   void writeToTable(const QList<quint16>& datagrid, int columns, int rows, int fileId);
 
+  /* Write loaded grid into a binary file which can be mapped into memory by readFromFile().
+   * Values are stored as 16 bit little endian after a small header. Returns false on error. */
+  bool writeToFile(const QString& filename) const;
+
+  /* Map a file written by writeToFile() into memory. Values are read directly from the mapping without
+   * copying and parsing. Falls back to reading the file if mapping is not possible.
+   * Returns false and leaves the object invalid on error. */
+  bool readFromFile(const QString& filename);
+
   /* True if table is present in schema and has one row */
   bool isDataAvailable();
 
@@ -70,9 +88,13 @@ public:
   /* true if loaded */
   bool isValid() const
   {
-    return !datagrid.isEmpty();
+    return !datagrid.isEmpty() || mappedData != nullptr;
   }
 
+  /* Add memory of the loaded grid. A memory mapped grid is reported separately as "MoraReader/mapped"
+   * since pages are shared with the file cache. */
+  void getMemoryUsage(atools::util::MemoryUsage& usage) const;
+
   /* Fill table and commit */
   void fillDbFromQuery(atools::sql::SqlQuery *moraQuery, int fileId);
   void fillDbFromFile(const QList<QStringList>& lines, int fileId);
@@ -87,6 +109,11 @@ public:
   int getMoraFt(const atools::geo::Pos& pos) const;
   int getMoraFt(int lonx, int laty) const;
 
+  /* Highest MORA for each leg of the great circle line string in feet * 100. Appends one value per leg.
+   * Looks at all grid cells touched by the leg and ignores UNKNOWN and ERROR cells.
+   * Value is UNKNOWN if no cell has a known MORA. Throws exception if object is not valid. */
+  void getMoraFtForLegs(QList<int>& moraFt, const atools::geo::LineString& linestring) const;
+
   /* Print world map to log */
   void debugPrint(const QList<quint16>& grid);
 
@@ -114,14 +141,29 @@ public:
 private:
   void assignDatabase(sql::SqlDatabase *sqlDb1, sql::SqlDatabase *sqlDb2);
 
+  /* Value at grid index from loaded or mapped data */
+  quint16 valueAt(int index) const;
+
+  /* Highest known MORA for one leg */
+  int moraFtForLeg(const atools::geo::Pos& from, const atools::geo::Pos& to) const;
+
   atools::sql::SqlDatabase *db;
   bool dataAvailable = false, navdata = false;
   QList<quint16> datagrid;
   int lonxColums = 0, latyRows = 0;
 
+  /* Memory mapped file and pointer to first value if loaded by readFromFile() */
+  QFile *mappedFile = nullptr;
+  const uchar *mappedData = nullptr;
+
   const static quint32 MAGIC_NUMBER_DATA = 0xA5B44CDB;
   const static quint32 DATA_VERSION = 1;
 
+  /* Binary file header: magic number, version, columns and rows as 32 bit little endian values */
+  const static quint32 MAGIC_NUMBER_FILE = 0xA5B44CDC;
+  const static quint32 FILE_VERSION = 1;
+  const static int FILE_HEADER_SIZE = 16;
+
 };
 
 } // namespace common
@@ -0,0 +1,241 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/common/navsnapshot.h"
+
+#include "geo/rect.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QtEndian>
+
+#include <cstring>
+#include <type_traits>
+
+namespace atools {
+namespace fs {
+namespace common {
+
+using namespace atools::fs::common::snapshot;
+
+/* Size of one record for each section used to check the section bounds */
+static const quint32 RECORD_SIZES[NUM_SECTIONS] =
+{
+  1, sizeof(Airport), sizeof(Runway), sizeof(Navaid), sizeof(AirwaySegment), sizeof(Procedure),
+  4, 4, 4, 4, 4, 4
+};
+
+NavSnapshot::NavSnapshot()
+{
+  std::fill(std::begin(offsets), std::end(offsets), 0);
+  std::fill(std::begin(counts), std::end(counts), 0);
+}
+
+NavSnapshot::~NavSnapshot()
+{
+  close();
+}
+
+bool NavSnapshot::open(const QString& filename)
+{
+  close();
+
+#if Q_BYTE_ORDER != Q_LITTLE_ENDIAN
+  // Records are used directly from the mapping
+  qWarning() << Q_FUNC_INFO << "Snapshot not supported on big endian systems";
+  return false;
+#endif
+
+  file = new QFile(filename);
+  if(!file->open(QIODevice::ReadOnly))
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot open" << filename << file->errorString();
+    close();
+    return false;
+  }
+
+  qint64 size = file->size();
+  if(size < HEADER_SIZE)
+  {
+    qWarning() << Q_FUNC_INFO << "File too small" << filename;
+    close();
+    return false;
+  }
+
+  const uchar *mapped = file->map(0, size);
+  if(mapped == nullptr)
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot map" << filename << file->errorString();
+    close();
+    return false;
+  }
+
+  // Check header ===================================
+  if(qFromLittleEndian<quint32>(mapped) != MAGIC_NUMBER || qFromLittleEndian<quint32>(mapped + 4) != VERSION ||
+     qFromLittleEndian<quint32>(mapped + 8) != BYTE_ORDER_MARK ||
+     qFromLittleEndian<quint32>(mapped + 12) != NUM_SECTIONS)
+  {
+    qWarning() << Q_FUNC_INFO << "Invalid header or version" << filename;
+    file->unmap(const_cast<uchar *>(mapped));
+    close();
+    return false;
+  }
+
+  for(int i = 0; i < NUM_SECTIONS; i++)
+  {
+    offsets[i] = qFromLittleEndian<quint32>(mapped + 16 + i * 8);
+    counts[i] = qFromLittleEndian<quint32>(mapped + 20 + i * 8);
+
+    // Check bounds and alignment
+    if(offsets[i] < static_cast<quint32>(HEADER_SIZE) || offsets[i] % 8 != 0 ||
+       offsets[i] + static_cast<qint64>(counts[i]) * RECORD_SIZES[i] > size)
+    {
+      qWarning() << Q_FUNC_INFO << "Invalid section" << i << filename;
+      file->unmap(const_cast<uchar *>(mapped));
+      close();
+      return false;
+    }
+  }
+
+  const quint32 numTiles = NUM_TILES + 1;
+  if(counts[AIRPORT_TILES] != numTiles || counts[NAVAID_TILES] != numTiles || counts[AIRWAY_TILES] != numTiles ||
+     counts[STRINGS] == 0)
+  {
+    qWarning() << Q_FUNC_INFO << "Invalid tiles" << filename;
+    file->unmap(const_cast<uchar *>(mapped));
+    close();
+    return false;
+  }
+
+  data = mapped;
+
+  qInfo() << Q_FUNC_INFO << filename << "airports" << counts[AIRPORTS] << "runways" << counts[RUNWAYS]
+          << "navaids" << counts[NAVAIDS] << "airways" << counts[AIRWAYS] << "procedures" << counts[PROCEDURES];
+  return true;
+}
+
+void NavSnapshot::close()
+{
+  if(file != nullptr)
+  {
+    if(data != nullptr)
+      file->unmap(const_cast<uchar *>(data));
+    file->close();
+    delete file;
+    file = nullptr;
+  }
+  data = nullptr;
+  std::fill(std::begin(offsets), std::end(offsets), 0);
+  std::fill(std::begin(counts), std::end(counts), 0);
+}
+
+template<typename TYPE>
+std::pair<const quint32 *, const quint32 *> NavSnapshot::identRange(Section indexSection, Section recordSection,
+                                                                    const QByteArray& ident) const
+{
+  const quint32 *first = uintArray(indexSection), *last = first + counts[indexSection];
+  const TYPE *records = reinterpret_cast<const TYPE *>(data + offsets[recordSection]);
+
+  return std::equal_range(first, last, ident, [this, records](const auto& left, const auto& right) -> bool {
+    // Either side can be the ident or an index depending on the call
+    const char *l, *r;
+    if constexpr (std::is_same_v<std::decay_t<decltype(left)>, QByteArray>)
+      l = left.constData();
+    else
+      l = stringData(records[left].ident);
+
+    if constexpr (std::is_same_v<std::decay_t<decltype(right)>, QByteArray>)
+      r = right.constData();
+    else
+      r = stringData(records[right].ident);
+    return std::strcmp(l, r) < 0;
+  });
+}
+
+int NavSnapshot::findAirport(const QString& ident) const
+{
+  if(!isOpen())
+    return -1;
+
+  auto found = identRange<Airport>(AIRPORT_IDENT_INDEX, AIRPORTS, ident.toUtf8());
+  return found.first != found.second ? static_cast<int>(*found.first) : -1;
+}
+
+void NavSnapshot::findNavaids(QList<int>& indexes, const QString& ident) const
+{
+  if(!isOpen())
+    return;
+
+  auto found = identRange<Navaid>(NAVAID_IDENT_INDEX, NAVAIDS, ident.toUtf8());
+  for(const quint32 *it = found.first; it != found.second; ++it)
+    indexes.append(static_cast<int>(*it));
+}
+
+template<typename FUNC>
+void NavSnapshot::forEachTile(const geo::Rect& rect, FUNC func) const
+{
+  if(!isOpen() || !rect.isValid())
+    return;
+
+  for(const geo::Rect& r : rect.splitAtAntiMeridian())
+  {
+    // Tile numbers of the south west and north east corners
+    int southWest = tileIndex(r.getWest(), r.getSouth()), northEast = tileIndex(r.getEast(), r.getNorth());
+
+    for(int row = southWest / TILE_COLUMNS; row <= northEast / TILE_COLUMNS; row++)
+    {
+      for(int col = southWest % TILE_COLUMNS; col <= northEast % TILE_COLUMNS; col++)
+        func(row * TILE_COLUMNS + col);
+    }
+  }
+}
+
+void NavSnapshot::airportsInRect(QList<int>& indexes, const geo::Rect& rect) const
+{
+  const quint32 *tiles = uintArray(AIRPORT_TILES);
+  forEachTile(rect, [tiles, &indexes](int tile) {
+    for(quint32 i = tiles[tile]; i < tiles[tile + 1]; i++)
+      indexes.append(static_cast<int>(i));
+  });
+}
+
+void NavSnapshot::navaidsInRect(QList<int>& indexes, const geo::Rect& rect) const
+{
+  const quint32 *tiles = uintArray(NAVAID_TILES);
+  forEachTile(rect, [tiles, &indexes](int tile) {
+    for(quint32 i = tiles[tile]; i < tiles[tile + 1]; i++)
+      indexes.append(static_cast<int>(i));
+  });
+}
+
+void NavSnapshot::airwaysInRect(QList<int>& indexes, const geo::Rect& rect) const
+{
+  const quint32 *tiles = uintArray(AIRWAY_TILES), *segments = uintArray(AIRWAY_TILE_INDEX);
+  int first = indexes.size();
+  forEachTile(rect, [tiles, segments, &indexes](int tile) {
+    for(quint32 i = tiles[tile]; i < tiles[tile + 1]; i++)
+      indexes.append(static_cast<int>(segments[i]));
+  });
+
+  // Segments are stored in all tiles they touch - remove duplicates
+  std::sort(indexes.begin() + first, indexes.end());
+  indexes.erase(std::unique(indexes.begin() + first, indexes.end()), indexes.end());
+}
+
+} // namespace common
+} // namespace fs
+} // namespace atools
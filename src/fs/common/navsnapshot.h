@@ -0,0 +1,305 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_COMMON_NAVSNAPSHOT_H
+#define ATOOLS_FS_COMMON_NAVSNAPSHOT_H
+
+#include <QList>
+#include <QString>
+
+#include <algorithm>
+#include <cmath>
+
+class QFile;
+
+namespace atools {
+namespace geo {
+class Rect;
+}
+
+namespace fs {
+namespace common {
+
+/* Record layouts of the navigation snapshot file. All values are little endian and records are stored as
+ * packed arrays which can be used directly from the memory mapped file.
+ * Strings are offsets into the string table section pointing to null terminated UTF-8. Offset 0 is the empty string.
+ * Indexes refer to the position in the respective section and are -1 if not resolved. */
+namespace snapshot {
+
+enum Section : quint32
+{
+  STRINGS, /* Null terminated UTF-8 strings. Count is number of bytes. */
+  AIRPORTS, /* Airport records sorted by tile and ident */
+  RUNWAYS, /* Runway records grouped by airport */
+  NAVAIDS, /* VOR, NDB and waypoint records sorted by tile and ident */
+  AIRWAYS, /* Airway segments sorted by name, fragment and sequence */
+  PROCEDURES, /* Procedure headers grouped by airport */
+  AIRPORT_TILES, /* NUM_TILES + 1 start indexes into AIRPORTS */
+  NAVAID_TILES, /* NUM_TILES + 1 start indexes into NAVAIDS */
+  AIRWAY_TILES, /* NUM_TILES + 1 start indexes into AIRWAY_TILE_INDEX */
+  AIRWAY_TILE_INDEX, /* Airway segment indexes for all tiles touched by the bounding rectangle */
+  AIRPORT_IDENT_INDEX, /* Airport indexes sorted by ident */
+  NAVAID_IDENT_INDEX, /* Navaid indexes sorted by ident */
+  NUM_SECTIONS
+};
+
+enum AirportFlag : quint8
+{
+  AP_CLOSED = 1 << 0,
+  AP_MILITARY = 1 << 1,
+  AP_ADDON = 1 << 2,
+  AP_HARD = 1 << 3,
+  AP_SOFT = 1 << 4,
+  AP_WATER = 1 << 5,
+  AP_HELIPAD = 1 << 6,
+  AP_3D = 1 << 7
+};
+
+enum NavaidType : quint8
+{
+  VOR,
+  NDB,
+  WAYPOINT
+};
+
+struct Airport
+{
+  qint32 id;
+  quint32 ident, icao, iata, name;
+  float lonx, laty;
+  float magvar;
+  qint32 altitude;
+  quint32 firstRunway, firstProcedure;
+  quint16 numRunways, numProcedures;
+  quint16 longestRunwayLength; /* Feet limited to 65535 */
+  quint8 rating;
+  quint8 flags; /* AirportFlag */
+};
+
+struct Runway
+{
+  qint32 id;
+  qint32 airportIndex;
+  quint32 primaryName, secondaryName, surface;
+  float heading, length, width; /* Degrees true and feet */
+  float primaryLonx, primaryLaty, secondaryLonx, secondaryLaty;
+  qint32 altitude;
+};
+
+struct Navaid
+{
+  qint32 id; /* vor_id, ndb_id or waypoint_id depending on type */
+  quint32 ident, region, name;
+  quint32 typeName; /* Type column like "HIGH", "VORDME", "HH" or "WN" */
+  float lonx, laty;
+  float magvar;
+  qint32 frequency; /* VOR MHz * 1000, NDB kHz * 100, 0 for waypoints */
+  quint8 type; /* NavaidType */
+  quint8 artificial; /* Waypoint was created for VOR or NDB */
+  quint16 padding;
+};
+
+struct AirwaySegment
+{
+  qint32 id;
+  quint32 name;
+  qint32 fromNavaid, toNavaid;
+  float fromLonx, fromLaty, toLonx, toLaty;
+  qint32 minAltitude, maxAltitude;
+  quint16 fragment, sequence;
+  quint8 airwayType; /* 'V', 'J' or 'B' */
+  quint8 direction; /* 'N', 'F' or 'B' */
+  quint16 padding;
+};
+
+struct Procedure
+{
+  qint32 id;
+  qint32 airportIndex;
+  quint32 arincName, runwayName, type, fixIdent, fixType;
+  quint8 suffix;
+  quint8 padding[3];
+};
+
+static_assert(sizeof(Airport) == 52, "Airport size");
+static_assert(sizeof(Runway) == 52, "Runway size");
+static_assert(sizeof(Navaid) == 40, "Navaid size");
+static_assert(sizeof(AirwaySegment) == 48, "AirwaySegment size");
+static_assert(sizeof(Procedure) == 32, "Procedure size");
+
+/* One degree tiles row by row from south to north and west to east */
+const static int TILE_COLUMNS = 360;
+const static int TILE_ROWS = 180;
+const static int NUM_TILES = TILE_COLUMNS * TILE_ROWS;
+
+inline int tileIndex(float lonx, float laty)
+{
+  int x = std::clamp(static_cast<int>(std::floor(lonx + 180.f)), 0, TILE_COLUMNS - 1);
+  int y = std::clamp(static_cast<int>(std::floor(laty + 90.f)), 0, TILE_ROWS - 1);
+  return y * TILE_COLUMNS + x;
+}
+
+/* Header: magic number, version, byte order mark, number of sections followed by offset and count for each section */
+const static quint32 MAGIC_NUMBER = 0xA5B44CF1;
+const static quint32 VERSION = 1;
+const static quint32 BYTE_ORDER_MARK = 0x01020304;
+const static int HEADER_SIZE = 16 + NUM_SECTIONS * 8;
+
+/* Simple view on a range of records in the mapped file */
+template<typename TYPE>
+struct Range
+{
+  const TYPE *first = nullptr;
+  int count = 0;
+
+  const TYPE *begin() const
+  {
+    return first;
+  }
+
+  const TYPE *end() const
+  {
+    return first + count;
+  }
+
+  int size() const
+  {
+    return count;
+  }
+
+  bool isEmpty() const
+  {
+    return count == 0;
+  }
+
+  const TYPE& at(int i) const
+  {
+    return first[i];
+  }
+
+};
+
+} // namespace snapshot
+
+/*
+ * Read only access to the immutable navigation snapshot file written by atools::fs::db::NavSnapshotWriter.
+ *
+ * The file is memory mapped and all records and strings are used directly from the mapping, so opening is
+ * instant and lookups need no SQL. Records are sorted by one degree tiles which allows to get all airports
+ * or navaids in a rectangle as contiguous ranges. Ident lookups use binary search on sorted index arrays.
+ *
+ * Accessors do no range checks. Ids are the same as in the database the snapshot was created from.
+ */
+class NavSnapshot
+{
+public:
+  NavSnapshot();
+  ~NavSnapshot();
+
+  NavSnapshot(const NavSnapshot& other) = delete;
+  NavSnapshot& operator=(const NavSnapshot& other) = delete;
+
+  /* Map file and check header. Returns false and logs a warning if the file is missing or invalid. */
+  bool open(const QString& filename);
+  void close();
+
+  bool isOpen() const
+  {
+    return data != nullptr;
+  }
+
+  /* Null terminated UTF-8 string from the string table */
+  const char *stringData(quint32 offset) const
+  {
+    return reinterpret_cast<const char *>(data + offsets[snapshot::STRINGS] + offset);
+  }
+
+  QString string(quint32 offset) const
+  {
+    return QString::fromUtf8(stringData(offset));
+  }
+
+  snapshot::Range<snapshot::Airport> airports() const
+  {
+    return range<snapshot::Airport>(snapshot::AIRPORTS);
+  }
+
+  snapshot::Range<snapshot::Navaid> navaids() const
+  {
+    return range<snapshot::Navaid>(snapshot::NAVAIDS);
+  }
+
+  snapshot::Range<snapshot::AirwaySegment> airways() const
+  {
+    return range<snapshot::AirwaySegment>(snapshot::AIRWAYS);
+  }
+
+  /* All runways of an airport */
+  snapshot::Range<snapshot::Runway> runways(const snapshot::Airport& airport) const
+  {
+    return {range<snapshot::Runway>(snapshot::RUNWAYS).first + airport.firstRunway, airport.numRunways};
+  }
+
+  /* All procedure headers of an airport */
+  snapshot::Range<snapshot::Procedure> procedures(const snapshot::Airport& airport) const
+  {
+    return {range<snapshot::Procedure>(snapshot::PROCEDURES).first + airport.firstProcedure, airport.numProcedures};
+  }
+
+  /* Index of airport with the ident or -1 if not found */
+  int findAirport(const QString& ident) const;
+
+  /* Indexes of all navaids with the ident */
+  void findNavaids(QList<int>& indexes, const QString& ident) const;
+
+  /* Indexes of all airports, navaids or airway segments in tiles touched by the rectangle.
+   * Objects are not filtered by exact coordinates. */
+  void airportsInRect(QList<int>& indexes, const atools::geo::Rect& rect) const;
+  void navaidsInRect(QList<int>& indexes, const atools::geo::Rect& rect) const;
+  void airwaysInRect(QList<int>& indexes, const atools::geo::Rect& rect) const;
+
+private:
+  template<typename TYPE>
+  snapshot::Range<TYPE> range(snapshot::Section section) const
+  {
+    return {reinterpret_cast<const TYPE *>(data + offsets[section]), static_cast<int>(counts[section])};
+  }
+
+  const quint32 *uintArray(snapshot::Section section) const
+  {
+    return reinterpret_cast<const quint32 *>(data + offsets[section]);
+  }
+
+  /* Call func for all tile numbers touched by rect */
+  template<typename FUNC>
+  void forEachTile(const atools::geo::Rect& rect, FUNC func) const;
+
+  /* Equal range of ident in sorted ident index section */
+  template<typename TYPE>
+  std::pair<const quint32 *, const quint32 *> identRange(snapshot::Section indexSection, snapshot::Section recordSection,
+                                                         const QByteArray& ident) const;
+
+  QFile *file = nullptr;
+  const uchar *data = nullptr;
+  quint32 offsets[snapshot::NUM_SECTIONS], counts[snapshot::NUM_SECTIONS];
+};
+
+} // namespace common
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_COMMON_NAVSNAPSHOT_H
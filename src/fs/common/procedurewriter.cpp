@@ -25,6 +25,8 @@
 
 #include "sql/sqlutil.h"
 
+#include <QDataStream>
+
 #pragma GCC diagnostic ignored "-Wswitch-enum"
 
 using atools::sql::SqlQuery;
@@ -395,6 +397,52 @@ void ProcedureWriter::assignTransitionIds(ProcedureWriter::Procedure& proc)
   }
 }
 
+void ProcedureWriter::insertTransition(ProcedureWriter::Procedure& trans)
+{
+  assignTransitionIds(trans);
+  insertTransitionQuery->bindAndExecRecord(trans.record);
+
+  if(trans.legRecords.isEmpty())
+    return;
+
+  int firstLegId = trans.legRecords.constFirst().valueInt(QStringLiteral(":transition_leg_id"));
+  QByteArray key = legSequenceKey(trans.legRecords);
+
+  auto it = transitionLegSequences.constFind(key);
+  if(it != transitionLegSequences.constEnd())
+  {
+    // Same legs already written for another runway or procedure - let the database copy the rows
+    // Leg ids of a sequence are consecutive which allows to shift them by an offset
+    copyTransitionLegQuery->bindValue(QStringLiteral(":offset"), firstLegId - it->firstLegId);
+    copyTransitionLegQuery->bindValue(QStringLiteral(":transition_id"), curTransitionId);
+    copyTransitionLegQuery->bindValue(QStringLiteral(":source_id"), it->transitionId);
+    copyTransitionLegQuery->exec();
+  }
+  else
+  {
+    insertTransitionLegQuery->bindAndExecRecords(trans.legRecords);
+    transitionLegSequences.insert(key, {curTransitionId, firstLegId});
+  }
+}
+
+QByteArray ProcedureWriter::legSequenceKey(const atools::sql::SqlRecordList& records)
+{
+  QByteArray key;
+  QDataStream stream(&key, QIODevice::WriteOnly);
+  stream.setVersion(QDataStream::Qt_5_5);
+
+  for(const SqlRecord& rec : records)
+  {
+    for(int i = 0; i < rec.count(); i++)
+    {
+      QString name = rec.fieldName(i);
+      if(name != QStringLiteral(":transition_leg_id") && name != QStringLiteral(":transition_id"))
+        stream << rec.value(i);
+    }
+  }
+  return key;
+}
+
 void ProcedureWriter::finishProcedure(const ProcedureInput& line)
 {
   if(curRowCode == rc::APPROACH)
@@ -427,9 +475,7 @@ void ProcedureWriter::finishProcedure(const ProcedureInput& line)
       // Write transitions for one approach
       for(Procedure& trans : transitions)
       {
-        assignTransitionIds(trans);
-        insertTransitionQuery->bindAndExecRecord(trans.record);
-        insertTransitionLegQuery->bindAndExecRecords(trans.legRecords);
+        insertTransition(trans);
       }
     }
   }
@@ -532,10 +578,8 @@ void ProcedureWriter::finishProcedure(const ProcedureInput& line)
         // Assign a new set of ids and write a duplicate of all transitions for the current approach
         for(Procedure& trans : transitions)
         {
-          assignTransitionIds(trans);
           // qDebug() << trans.legRecords;
-          insertTransitionQuery->bindAndExecRecord(trans.record);
-          insertTransitionLegQuery->bindAndExecRecords(trans.legRecords);
+          insertTransition(trans);
         }
       }
     }
@@ -961,6 +1005,9 @@ void ProcedureWriter::finish(const ProcedureInput& line)
   updateAirportQuery->bindValue(QStringLiteral(":id"), line.airportId);
   updateAirportQuery->exec();
   numProcedures = 0;
+
+  // Legs are shared only within an airport to keep the memory usage low
+  transitionLegSequences.clear();
 }
 
 void ProcedureWriter::reset()
@@ -1392,6 +1439,14 @@ void ProcedureWriter::initQueries()
   insertTransitionLegQuery = new SqlQuery(db);
   insertTransitionLegQuery->prepare(util.buildInsertStatement(QStringLiteral("transition_leg")));
 
+  // Copy all legs of a transition to a new one with shifted leg ids
+  QString legColumns = util.buildColumnList(QStringLiteral("transition_leg"),
+                                            {QStringLiteral("transition_leg_id"), QStringLiteral("transition_id")}).join(", ");
+  copyTransitionLegQuery = new SqlQuery(db);
+  copyTransitionLegQuery->prepare("insert into transition_leg (transition_leg_id, transition_id, " + legColumns + ") "
+                                  "select transition_leg_id + :offset, :transition_id, " + legColumns +
+                                  " from transition_leg where transition_id = :source_id");
+
   updateAirportQuery = new SqlQuery(db);
   updateAirportQuery->prepare(QStringLiteral("update airport set num_approach = :num where airport_id = :id"));
 
@@ -1428,6 +1483,9 @@ void ProcedureWriter::deInitQueries()
   delete insertTransitionLegQuery;
   insertTransitionLegQuery = nullptr;
 
+  delete copyTransitionLegQuery;
+  copyTransitionLegQuery = nullptr;
+
   delete updateAirportQuery;
   updateAirportQuery = nullptr;
 
@@ -22,6 +22,8 @@
 #include "geo/pos.h"
 #include "sql/sqltypes.h"
 
+#include <QHash>
+
 namespace atools {
 
 namespace sql {
@@ -220,6 +222,13 @@ private:
   /* Assigns new ids to the currently stored transitions */
   void assignTransitionIds(ProcedureWriter::Procedure& proc);
 
+  /* Assigns ids and writes the transition. Legs are copied within the database if an identical
+   * leg sequence was already written for this airport. */
+  void insertTransition(ProcedureWriter::Procedure& trans);
+
+  /* Content of leg records without ids used to find identical leg sequences */
+  static QByteArray legSequenceKey(const atools::sql::SqlRecordList& records);
+
   /* Extract runway names */
   void apprRunwayNameAndSuffix(const ProcedureInput& line, QString& runway, QString& suffix);
   QString sidStarRunwayNameAndSuffix(const ProcedureInput& line);
@@ -239,6 +248,7 @@ private:
   atools::sql::SqlDatabase& db;
   atools::sql::SqlQuery *insertApproachQuery = nullptr, *insertTransitionQuery = nullptr,
                         *insertApproachLegQuery = nullptr, *insertTransitionLegQuery = nullptr,
+                        *copyTransitionLegQuery = nullptr,
                         *updateAirportQuery = nullptr,
                         *findWaypointExactQuery = nullptr, *findWaypointQuery = nullptr,
                         *findIlsExactQuery = nullptr, *findIlsQuery = nullptr;
@@ -252,6 +262,15 @@ private:
   QList<Procedure> approaches;
   QList<Procedure> transitions;
 
+  /* First transition and first leg id of an already written leg sequence */
+  struct LegSequence
+  {
+    int transitionId, firstLegId;
+  };
+
+  /* Leg sequences written for the current airport. Key is the content from legSequenceKey(). */
+  QHash<QByteArray, LegSequence> transitionLegSequences;
+
   rc::RowCode curRowCode;
   int curSeqNo = std::numeric_limits<int>::max();
   char curRouteType = ' ';
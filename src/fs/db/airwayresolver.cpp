@@ -17,6 +17,8 @@
 
 #include "fs/db/airwayresolver.h"
 
+#include "atools.h"
+
 #include "sql/sqldatabase.h"
 #include "sql/sqlquery.h"
 #include "sql/sqlutil.h"
@@ -31,7 +33,6 @@
 #include <algorithm>
 #include <QQueue>
 #include <QElapsedTimer>
-#include <QStringBuilder>
 
 namespace atools {
 namespace fs {
@@ -45,6 +46,7 @@ using atools::sql::SqlQuery;
 using atools::sql::SqlUtil;
 using atools::geo::Pos;
 using atools::geo::Rect;
+using atools::util::StringPool;
 
 /* Airway segment with from/to position and IDs */
 struct AirwayResolver::AirwaySegment
@@ -121,7 +123,8 @@ bool AirwayResolver::run(int numReportSteps)
   QSet<AirwaySegment> airway;
   QString currentAirway;
 
-  int totalRowCount = SqlUtil(db).rowCount(QStringLiteral("tmp_airway_point"));
+  int totalRowCount = useAirwayPoints ? static_cast<int>(airwayPoints.size()) :
+                      SqlUtil(db).rowCount(QStringLiteral("tmp_airway_point"));
 
   int rowsPerStep = static_cast<int>(std::ceil(static_cast<float>(totalRowCount) / static_cast<float>(numReportSteps)));
   int row = 0, steps = 0;
@@ -130,20 +133,71 @@ bool AirwayResolver::run(int numReportSteps)
   timer.start();
   qint64 elapsed = timer.elapsed();
 
-  SqlQuery tmpWaypointQuery(db);
-  tmpWaypointQuery.prepare("select waypoint_id, ident, region, type, lonx, laty "
-                           "from tmp_waypoint where ident = ? and region = ? and type = ?");
+  // Read all waypoints once instead of querying for each airway point
+  TmpWaypointIndex waypointIndex;
+  loadWaypoints(waypointIndex);
+
+  // Column indexes
+  enum
+  {
+    NAME, TYPE, MID_TYPE, MID_IDENT, MID_REGION,
+    PREV_TYPE, PREV_IDENT, PREV_REGION, PREV_MIN_ALT, PREV_MAX_ALT, PREV_DIR,
+    NEXT_TYPE, NEXT_IDENT, NEXT_REGION, NEXT_MIN_ALT, NEXT_MAX_ALT, NEXT_DIR
+  };
 
-  // Get all tmp_airway_point rows and join previous and next waypoints to the result by ident and region
+  // Get all tmp_airway_point rows if not given in memory
   // Result is ordered by airway name
   SqlQuery tmpAirwayPointQuery(db);
-  tmpAirwayPointQuery.exec(QStringLiteral("select * from tmp_airway_point order by name")); // where name = 'Y655'
+  if(!useAirwayPoints)
+    tmpAirwayPointQuery.exec(QStringLiteral("select name, type, mid_type, mid_ident, mid_region, "
+                                            "previous_type, previous_ident, previous_region, "
+                                            "previous_minimum_altitude, previous_maximum_altitude, previous_direction, "
+                                            "next_type, next_ident, next_region, "
+                                            "next_minimum_altitude, next_maximum_altitude, next_direction "
+                                            "from tmp_airway_point order by name")); // where name = 'Y655'
+
+  // Point to either given rows or current row of query
+  AirwayPointRow queryRow;
+  const AirwayPointRow *point = nullptr;
+  int pointIndex = 0;
+  auto nextPoint = [&]() -> bool {
+                     if(useAirwayPoints)
+                     {
+                       point = pointIndex < airwayPoints.size() ? &airwayPoints.at(pointIndex++) : nullptr;
+                       return point != nullptr;
+                     }
+
+                     if(!tmpAirwayPointQuery.next())
+                       return false;
+
+                     queryRow.name = tmpAirwayPointQuery.valueStr(NAME);
+                     queryRow.type = tmpAirwayPointQuery.valueStr(TYPE);
+                     queryRow.midType = tmpAirwayPointQuery.valueStr(MID_TYPE);
+                     queryRow.midIdent = tmpAirwayPointQuery.valueStr(MID_IDENT);
+                     queryRow.midRegion = tmpAirwayPointQuery.valueStr(MID_REGION);
+                     queryRow.previousType = tmpAirwayPointQuery.valueStr(PREV_TYPE);
+                     queryRow.previousIdent = tmpAirwayPointQuery.valueStr(PREV_IDENT);
+                     queryRow.previousRegion = tmpAirwayPointQuery.valueStr(PREV_REGION);
+                     queryRow.previousMinAlt = tmpAirwayPointQuery.valueInt(PREV_MIN_ALT);
+                     queryRow.previousMaxAlt = tmpAirwayPointQuery.valueInt(PREV_MAX_ALT);
+                     queryRow.previousDir = atools::strToChar(tmpAirwayPointQuery.valueStr(PREV_DIR));
+                     queryRow.nextType = tmpAirwayPointQuery.valueStr(NEXT_TYPE);
+                     queryRow.nextIdent = tmpAirwayPointQuery.valueStr(NEXT_IDENT);
+                     queryRow.nextRegion = tmpAirwayPointQuery.valueStr(NEXT_REGION);
+                     queryRow.nextMinAlt = tmpAirwayPointQuery.valueInt(NEXT_MIN_ALT);
+                     queryRow.nextMaxAlt = tmpAirwayPointQuery.valueInt(NEXT_MAX_ALT);
+                     queryRow.nextDir = atools::strToChar(tmpAirwayPointQuery.valueStr(NEXT_DIR));
+                     point = &queryRow;
+                     return true;
+                   };
+
   atools::geo::Pos lastPosition;
   float longestAirwaySegmentMeter = 0.f;
-  while(tmpAirwayPointQuery.next())
+  while(nextPoint())
   {
-    QString awName = tmpAirwayPointQuery.value(QStringLiteral("name")).toString();
-    QString awType = tmpAirwayPointQuery.value(QStringLiteral("type")).toString();
+    const QString& awName = point->name;
+    // Share type string between all segments
+    QString awType = stringPool.shared(point->type);
 
     if((row++ % rowsPerStep) == 0)
     {
@@ -168,15 +222,16 @@ bool AirwayResolver::run(int numReportSteps)
 
     int midWpId = -1, prevWpId = -1, nextWpId = -1;
     Pos midWpPos, prevWpPos, nextWpPos;
-    fetchNavaid(prevWpId, prevWpPos, tmpAirwayPointQuery, tmpWaypointQuery, QStringLiteral("previous_"), lastPosition);
+    fetchNavaid(prevWpId, prevWpPos, point->previousIdent, point->previousRegion, point->previousType, waypointIndex,
+                lastPosition);
     if(prevWpPos.isValidRange())
       lastPosition = prevWpPos;
 
-    fetchNavaid(midWpId, midWpPos, tmpAirwayPointQuery, tmpWaypointQuery, QStringLiteral("mid_"), lastPosition);
+    fetchNavaid(midWpId, midWpPos, point->midIdent, point->midRegion, point->midType, waypointIndex, lastPosition);
     if(midWpPos.isValidRange())
       lastPosition = midWpPos;
 
-    fetchNavaid(nextWpId, nextWpPos, tmpAirwayPointQuery, tmpWaypointQuery, QStringLiteral("next_"), lastPosition);
+    fetchNavaid(nextWpId, nextWpPos, point->nextIdent, point->nextRegion, point->nextType, waypointIndex, lastPosition);
     if(nextWpPos.isValidRange())
       lastPosition = nextWpPos;
 
@@ -185,12 +240,8 @@ bool AirwayResolver::run(int numReportSteps)
       // Previous waypoint found - add segment
       float midPrevDist = midWpPos.distanceMeterTo(prevWpPos);
       if(maxAirwaySegmentLengthNm <= 1.f || midPrevDist < atools::geo::nmToMeter(maxAirwaySegmentLengthNm))
-      {
-        int prevMinAlt = tmpAirwayPointQuery.value(QStringLiteral("previous_minimum_altitude")).toInt();
-        int prevMaxAlt = tmpAirwayPointQuery.value(QStringLiteral("previous_maximum_altitude")).toInt();
-        char prevDir = atools::strToChar(tmpAirwayPointQuery.value(QStringLiteral("previous_direction")).toString());
-        airway.insert(AirwaySegment(prevWpId, midWpId, prevDir, prevMinAlt, prevMaxAlt, awType, prevWpPos, midWpPos));
-      }
+        airway.insert(AirwaySegment(prevWpId, midWpId, point->previousDir, point->previousMinAlt, point->previousMaxAlt,
+                                    awType, prevWpPos, midWpPos));
 
       longestAirwaySegmentMeter = std::max(longestAirwaySegmentMeter, midPrevDist);
     }
@@ -200,12 +251,8 @@ bool AirwayResolver::run(int numReportSteps)
       // Next waypoint found - add segment
       float midNextDist = midWpPos.distanceMeterTo(nextWpPos);
       if(maxAirwaySegmentLengthNm <= 1.f || midNextDist < atools::geo::nmToMeter(maxAirwaySegmentLengthNm))
-      {
-        int nextMinAlt = tmpAirwayPointQuery.value(QStringLiteral("next_minimum_altitude")).toInt();
-        int nextMaxAlt = tmpAirwayPointQuery.value(QStringLiteral("next_maximum_altitude")).toInt();
-        char nextDir = atools::strToChar(tmpAirwayPointQuery.value(QStringLiteral("next_direction")).toString());
-        airway.insert(AirwaySegment(midWpId, nextWpId, nextDir, nextMinAlt, nextMaxAlt, awType, midWpPos, nextWpPos));
-      }
+        airway.insert(AirwaySegment(midWpId, nextWpId, point->nextDir, point->nextMinAlt, point->nextMaxAlt,
+                                    awType, midWpPos, nextWpPos));
 
       longestAirwaySegmentMeter = std::max(longestAirwaySegmentMeter, midNextDist);
     }
@@ -214,6 +261,11 @@ bool AirwayResolver::run(int numReportSteps)
   // Save last remaining airway
   saveAirway(airway, currentAirway);
 
+  qInfo() << Q_FUNC_INFO << "Interned" << stringPool.size() << "strings";
+  stringPool.clear();
+  airwayPoints.clear();
+  useAirwayPoints = false;
+
   // Eat up any remaining progress steps
   progressHandler.increaseCurrent(numReportSteps - steps);
 
@@ -226,44 +278,51 @@ bool AirwayResolver::run(int numReportSteps)
   return aborted;
 }
 
-void AirwayResolver::fetchNavaid(int& id, atools::geo::Pos& pos, atools::sql::SqlQuery& tmpAirwayPointQuery,
-                                 atools::sql::SqlQuery& tmpWaypointQuery, const QString& prefix, const Pos& lastPos)
+void AirwayResolver::loadWaypoints(TmpWaypointIndex& index)
 {
-  enum {BIND_IDENT, BIND_REGION, BIND_TYPE};
-
   enum {WAYPOINT_ID, IDENT, REGION, TYPE, LONX, LATY};
 
-  // waypoint_id integer primary key,
-  // type varchar(15) not null,
-  // ident varchar(5) not null,
-  // region varchar(2) not null,
-  // lonx double not null,
-  // laty double not null
-  tmpWaypointQuery.bindValue(BIND_IDENT, tmpAirwayPointQuery.valueStr(prefix % QStringLiteral("ident")));
-  tmpWaypointQuery.bindValue(BIND_REGION, tmpAirwayPointQuery.valueStr(prefix % QStringLiteral("region")));
-  tmpWaypointQuery.bindValue(BIND_TYPE, tmpAirwayPointQuery.valueStr(prefix % QStringLiteral("type")));
-  tmpWaypointQuery.exec();
-
-  QList<std::pair<int, Pos> > wpList;
-  while(tmpWaypointQuery.next())
-    wpList.append(std::make_pair(tmpWaypointQuery.valueInt(WAYPOINT_ID),
-                                 Pos(tmpWaypointQuery.valueFloat(LONX), tmpWaypointQuery.valueFloat(LATY))));
+  SqlQuery query(db);
+  query.exec(QStringLiteral("select waypoint_id, ident, region, type, lonx, laty from tmp_waypoint"));
+  while(query.next())
+    index[{stringPool.intern(query.valueStr(IDENT)), stringPool.intern(query.valueStr(REGION)),
+           stringPool.intern(query.valueStr(TYPE))}].append(
+      {query.valueInt(WAYPOINT_ID), Pos(query.valueFloat(LONX), query.valueFloat(LATY))});
 
+  qInfo() << Q_FUNC_INFO << "Loaded" << index.size() << "waypoint keys";
+}
+
+void AirwayResolver::fetchNavaid(int& id, atools::geo::Pos& pos, const QString& ident, const QString& region, const QString& type,
+                                 const TmpWaypointIndex& index, const Pos& lastPos)
+{
+  id = -1;
+  pos = Pos();
+
+  // Null ident means no previous or next waypoint - would never match in SQL
+  if(ident.isEmpty())
+    return;
+
+  // Strings not in the pool cannot match any waypoint
+  WaypointKey key = {stringPool.find(ident), stringPool.find(region), stringPool.find(type)};
+  if(key.ident == StringPool::INVALID || key.region == StringPool::INVALID || key.type == StringPool::INVALID)
+    return;
+
+  auto it = index.constFind(key);
+  if(it == index.constEnd() || it->isEmpty())
+    return;
+
+  const QList<TmpWaypoint>& wpList = it.value();
+  const TmpWaypoint *nearest = &wpList.constFirst();
+
+  // Take the nearest to the last position if ambiguous
   if(lastPos.isValidRange() && wpList.size() > 1)
-    std::sort(wpList.begin(), wpList.end(), [&lastPos](const std::pair<int, Pos>& t1, const std::pair<int, Pos>& t2) -> bool {
-            return t1.second.distanceMeterTo(lastPos) < t2.second.distanceMeterTo(lastPos);
+    nearest = &*std::min_element(wpList.constBegin(), wpList.constEnd(),
+                                 [&lastPos](const TmpWaypoint& wp1, const TmpWaypoint& wp2) -> bool {
+            return wp1.pos.distanceMeterTo(lastPos) < wp2.pos.distanceMeterTo(lastPos);
           });
 
-  if(!wpList.isEmpty())
-  {
-    id = wpList.constFirst().first;
-    pos = wpList.constFirst().second;
-  }
-  else
-  {
-    id = -1;
-    pos = Pos();
-  }
+  id = nearest->id;
+  pos = nearest->pos;
 }
 
 void AirwayResolver::saveAirway(QSet<AirwaySegment>& airway, const QString& currentAirway)
@@ -19,18 +19,30 @@
 #define ATOOLS_FS_DB_AIRWAYRESOLVER_H
 
 #include "sql/sqlquery.h"
+#include "geo/pos.h"
+#include "util/stringpool.h"
 
 #include <QSet>
+#include <QHash>
 #include <QCoreApplication>
 
 namespace atools {
-namespace geo {
-class Pos;
-}
 namespace fs {
 class ProgressHandler;
 namespace db {
 
+/* One row of table tmp_airway_point with a waypoint and its previous and next neighbors along an airway.
+ * Empty idents denote a missing previous or next waypoint. */
+struct AirwayPointRow
+{
+  QString name, type,
+          midType, midIdent, midRegion,
+          previousType, previousIdent, previousRegion,
+          nextType, nextIdent, nextRegion;
+  int previousMinAlt = 0, previousMaxAlt = 0, nextMinAlt = 0, nextMaxAlt = 0;
+  char previousDir = '\0', nextDir = '\0';
+};
+
 /*
  * Reads from the tmp_airway_point table that was filled with waypoint record data and connects the
  * waypoint lists to airways that are stored in table airway.
@@ -59,6 +71,14 @@ public:
    */
   void assignWaypointIds();
 
+  /* Use the given rows instead of reading table tmp_airway_point in run().
+   * Rows have to be grouped by airway name. Avoids writing and reading all points through the database. */
+  void setAirwayPoints(const QList<atools::fs::db::AirwayPointRow>& points)
+  {
+    airwayPoints = points;
+    useAirwayPoints = true;
+  }
+
   /* Maximum length before creating a new fragment in meter */
   void setMaxAirwaySegmentLengthNm(float value)
   {
@@ -77,6 +97,35 @@ private:
     QList<TypeRowValueList> boundValues;
   };
 
+  /* Waypoint id and position from table tmp_waypoint */
+  struct TmpWaypoint
+  {
+    int id;
+    atools::geo::Pos pos;
+  };
+
+  /* Interned ident, region and type of a waypoint */
+  struct WaypointKey
+  {
+    atools::util::StringPool::Handle ident, region, type;
+
+    bool operator==(const WaypointKey& other) const
+    {
+      return ident == other.ident && region == other.region && type == other.type;
+    }
+  };
+
+  friend size_t qHash(const WaypointKey& key, size_t seed)
+  {
+    return qHashMulti(seed, key.ident, key.region, key.type);
+  }
+
+  /* All waypoints from tmp_waypoint indexed by ident, region and type */
+  typedef QHash<WaypointKey, QList<TmpWaypoint> > TmpWaypointIndex;
+
+  /* Load table tmp_waypoint once into memory to avoid a query for each airway point */
+  void loadWaypoints(TmpWaypointIndex& index);
+
   void buildAirway(const QString& airwayName, QSet<atools::fs::db::AirwayResolver::AirwaySegment>& airway,
                    QList<Fragment>& fragments);
 
@@ -86,9 +135,16 @@ private:
   /* Save airways to table airway */
   void saveAirway(QSet<AirwaySegment>& airway, const QString& currentAirway);
 
-  /* Fetch navaid id and position. Takes the nearest in case of disambiguities */
-  void fetchNavaid(int& id, atools::geo::Pos& pos, sql::SqlQuery& tmpAirwayPointQuery, sql::SqlQuery& tmpWaypointQuery,
-                   const QString& prefix, const atools::geo::Pos& lastPos);
+  /* Fetch navaid id and position from index. Takes the nearest in case of disambiguities */
+  void fetchNavaid(int& id, atools::geo::Pos& pos, const QString& ident, const QString& region, const QString& type,
+                   const TmpWaypointIndex& index, const atools::geo::Pos& lastPos);
+
+  /* Airway points given by setAirwayPoints() */
+  QList<atools::fs::db::AirwayPointRow> airwayPoints;
+  bool useAirwayPoints = false;
+
+  /* Idents, regions and types from tmp_waypoint and airway types. Cleared after each run. */
+  atools::util::StringPool stringPool;
 
   atools::fs::ProgressHandler& progressHandler;
   int curAirwayId, numAirways;
@@ -114,6 +114,9 @@ void AirportWriter::writeObject(const Airport *type)
   bool msfsNavdata = currentArea.isNavdata();
   bool msfs = options.getSimulatorType() == atools::fs::FsPaths::MSFS;
 
+  // Previous airports with this ident have to be removed before looking it up again
+  deleteProcessor.flushIdent(ident);
+
   int predId = airportIdByIdent(ident, msfsNavdata /* warn */);
 
   if(ident.isEmpty())
@@ -409,6 +412,9 @@ void AirportWriter::writeObject(const Airport *type)
     TaxiPathWriter *taxiWriter = dw.getTaxiPathWriter();
     taxiWriter->write(type->getTaxiPaths());
 
+    // Delete processing reads and moves sub-objects of the airport
+    dw.flushBatches();
+
     if(options.isDeletes() && (delAp != nullptr || realAddon))
       // Now delete the stock/default/prev airport if there is any
       deleteProcessor.postProcessDelete();
@@ -59,6 +59,12 @@ public:
     return currentPos;
   }
 
+  /* Apply pending batch deletes. Called at the end of each scenery area. */
+  void flushDeletes()
+  {
+    deleteProcessor.flush();
+  }
+
 private:
   virtual void writeObject(const atools::fs::bgl::Airport *type) override;
 
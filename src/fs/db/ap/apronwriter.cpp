@@ -34,6 +34,9 @@ using atools::fs::bgl::Apron2;
 using atools::fs::bgl::Runway;
 using atools::fs::bgl::surface::surfaceToDbStr;
 
+/* Maximum deviation of simplified apron outline */
+const static float APRON_SIMPLIFY_TOLERANCE_METER = 0.5f;
+
 void ApronWriter::writeObject(const std::pair<const bgl::Apron *, const bgl::Apron2 *> *type)
 {
   if(getOptions().isVerbose())
@@ -57,21 +60,41 @@ void ApronWriter::writeObject(const std::pair<const bgl::Apron *, const bgl::Apr
   for(const bgl::BglPosition& pos : type->first->getVertices())
     positions.append(pos.getPos());
 
-  atools::fs::common::BinaryGeometry geo(positions);
-  bind(QStringLiteral(":vertices"), geo.writeToByteArray());
-
-  if(getOptions().isIncludedNavDbObject(type::APRON2) && type->second != nullptr)
-  {
-    positions.clear();
-    for(const bgl::BglPosition& pos : type->first->getVertices())
-      positions.append(pos.getPos());
+  using atools::fs::common::BinaryGeometry;
+  BinaryGeometry::Format format = getOptions().isCompactGeometry() ? BinaryGeometry::DELTA_ZLIB : BinaryGeometry::FLOAT;
 
-    geo.setGeometry(positions);
+  BinaryGeometry geo(positions);
+  bind(QStringLiteral(":vertices"), geo.writeToByteArray(format));
 
-    bind(QStringLiteral(":vertices2"), geo.writeToByteArray());
-
-    // Triangles are space and comma separated
-    bind(QStringLiteral(":triangles"), toBytes(type->second->getTriangleIndex()));
+  if(getOptions().isIncludedNavDbObject(type::APRON2))
+  {
+    QList<int> triangles;
+    if(type->second != nullptr && !type->second->getTriangleIndex().isEmpty())
+    {
+      // Use triangles from BGL
+      positions.clear();
+      for(const bgl::BglPosition& pos : type->second->getVertices())
+        positions.append(pos.getPos());
+      triangles = type->second->getTriangleIndex();
+    }
+    else
+    {
+      // Calculate simplified outline and triangles at compile time to avoid polygon processing when drawing
+      positions = positions.simplifiedDouglasPeucker(APRON_SIMPLIFY_TOLERANCE_METER);
+      triangles = positions.triangulated();
+    }
+
+    if(!triangles.isEmpty())
+    {
+      geo.setGeometry(positions);
+      bind(QStringLiteral(":vertices2"), geo.writeToByteArray(format));
+      bind(QStringLiteral(":triangles"), toBytes(triangles));
+    }
+    else
+    {
+      bindNullString(QStringLiteral(":vertices2"));
+      bindNullString(QStringLiteral(":triangles"));
+    }
   }
   else
   {
@@ -76,6 +76,25 @@ DeleteProcessor::DeleteProcessor(atools::sql::SqlDatabase& sqlDb, const atools::
   updateBoundingStmt = new SqlQuery(sqlDb);
   fetchBoundingStmt = new SqlQuery(sqlDb);
 
+  if(options.isBatchDeletes())
+  {
+    // Collects previous and current airport ids for the whole scenery area - rows are removed in flush()
+    sqlDb.exec("create temp table if not exists delete_airport_op ("
+               "prev_airport_id integer primary key, cur_airport_id integer not null, "
+               "delete_flags integer not null, delete_parking integer not null)");
+
+    // Runway ends of deleted runways which have to be removed after the runways
+    sqlDb.exec("create temp table if not exists delete_runway_end_id (runway_end_id integer primary key)");
+
+    // Remove leftovers from an aborted compilation
+    sqlDb.exec("delete from temp.delete_airport_op");
+    sqlDb.exec("delete from temp.delete_runway_end_id");
+
+    insertDeleteOpStmt = new SqlQuery(sqlDb);
+    insertDeleteOpStmt->prepare("insert into temp.delete_airport_op (prev_airport_id, cur_airport_id, delete_flags, delete_parking) "
+                                "values(:prevApId, :curApId, :flags, :parking)");
+  }
+
   // Most queries act on all other airports with the given ident except the current one
   // where a.ident = :apIdent and a.airport_id <> :curApId
 
@@ -189,6 +208,7 @@ DeleteProcessor::~DeleteProcessor()
 
   delete updateBoundingStmt;
   delete fetchBoundingStmt;
+  delete insertDeleteOpStmt;
 }
 
 void DeleteProcessor::init(const DeleteAirport *deleteAirportRec, const scenery::SceneryArea *sceneryArea,
@@ -243,6 +263,9 @@ void DeleteProcessor::postProcessDelete()
   if(prevAirportId == -1)
     return;
 
+  // Features are deleted or moved in flush() if false
+  bool immediate = insertDeleteOpStmt == nullptr;
+
   // Collects all columns that will be copied from the previous airport to this new one
   QStringList copyAirportColumns;
 
@@ -293,7 +316,8 @@ void DeleteProcessor::postProcessDelete()
 
   if(prevHasApproach)
   {
-    removeOrUpdate(deleteApproachStmt, updateApproachStmt, bgl::del::APPROACHES);
+    if(immediate)
+      removeOrUpdate(deleteApproachStmt, updateApproachStmt, bgl::del::APPROACHES);
 
     if(hasPrevious && !isFlagSet(deleteFlags, bgl::del::APPROACHES))
       // Relink the approaches to the new airport and update the count on the airport
@@ -304,7 +328,8 @@ void DeleteProcessor::postProcessDelete()
   // Work on facilities that will be either removed or attached to the new airport depending on flags
   if(prevHasApron)
   {
-    removeOrUpdate(deleteApronStmt, updateApronStmt, bgl::del::APRONS);
+    if(immediate)
+      removeOrUpdate(deleteApronStmt, updateApronStmt, bgl::del::APRONS);
 
     if(!isFlagSet(deleteFlags, bgl::del::APRONS) && hasPrevious)
       // Update apron count in new airport
@@ -313,7 +338,8 @@ void DeleteProcessor::postProcessDelete()
 
   if(prevHasCom)
   {
-    removeOrUpdate(deleteComStmt, updateComStmt, bgl::del::COMS);
+    if(immediate)
+      removeOrUpdate(deleteComStmt, updateComStmt, bgl::del::COMS);
 
     if(!isFlagSet(deleteFlags, bgl::del::COMS) && hasPrevious)
       // Copy all frequencies to the new airport
@@ -322,7 +348,8 @@ void DeleteProcessor::postProcessDelete()
 
   if(prevHasHelipad)
   {
-    removeOrUpdate(deleteHelipadStmt, updateHelipadStmt, bgl::del::HELIPADS);
+    if(immediate)
+      removeOrUpdate(deleteHelipadStmt, updateHelipadStmt, bgl::del::HELIPADS);
 
     if(!isFlagSet(deleteFlags, bgl::del::HELIPADS) && hasPrevious)
       // Update helipad count in new airport
@@ -331,7 +358,8 @@ void DeleteProcessor::postProcessDelete()
 
   if(prevHasTaxi)
   {
-    removeOrUpdate(deleteTaxiPathStmt, updateTaxiPathStmt, bgl::del::TAXIWAYS);
+    if(immediate)
+      removeOrUpdate(deleteTaxiPathStmt, updateTaxiPathStmt, bgl::del::TAXIWAYS);
 
     if(!isFlagSet(deleteFlags, bgl::del::TAXIWAYS) && hasPrevious)
       // Update taxi count in new airport
@@ -340,7 +368,8 @@ void DeleteProcessor::postProcessDelete()
 
   if(prevHasStart)
   {
-    removeOrUpdate(deleteStartStmt, updateStartStmt, bgl::del::STARTS);
+    if(immediate)
+      removeOrUpdate(deleteStartStmt, updateStartStmt, bgl::del::STARTS);
 
     if(!isFlagSet(deleteFlags, bgl::del::STARTS) && hasPrevious)
       // Update start count in new airport
@@ -350,22 +379,30 @@ void DeleteProcessor::postProcessDelete()
   if(prevHasRunways)
   {
     if(isFlagSet(deleteFlags, bgl::del::RUNWAYS))
-      removePrevRunways();
+    {
+      if(immediate)
+        removePrevRunways();
+    }
     else if(hasPrevious)
     {
       // Relink runways
-      bindAndExecute(updateRunwayStmt, QStringLiteral("runways updated"));
+      if(immediate)
+        bindAndExecute(updateRunwayStmt, QStringLiteral("runways updated"));
       copyAirportColumns.append(RUNWAY_COLUMNS);
     }
   }
 
   if(!curAirport->getParkings().isEmpty())
+  {
     // New airport has parking - delete the previous ones
-    bindAndExecute(deleteParkingStmt, QStringLiteral("parking spots deleted"));
+    if(immediate)
+      bindAndExecute(deleteParkingStmt, QStringLiteral("parking spots deleted"));
+  }
   else if(hasPrevious)
   {
     // New airport has no parking - transfer previous ones and update counts
-    bindAndExecute(updateParkingStmt, QStringLiteral("parking spots updated"));
+    if(immediate)
+      bindAndExecute(updateParkingStmt, QStringLiteral("parking spots updated"));
     copyAirportColumns.append(AIRPORT_COLUMNS);
   }
 
@@ -403,17 +440,102 @@ void DeleteProcessor::postProcessDelete()
   copyAirportValues(copyAirportColumns);
 
   // Airport has moved more than 500 meter from previous or has moved to a far position - update bounding rectangle for current airport
-  if(hasPrevious && (curAirport->getPos().distanceMeterTo(prevPos) > 500.f || movedFar))
-    updateBoundingRect();
+  bool updateBounding = hasPrevious && (curAirport->getPos().distanceMeterTo(prevPos) > 500.f || movedFar);
+
+  if(immediate)
+  {
+    if(updateBounding)
+      updateBoundingRect(curAirportId, curAirport->getPos(), curIdent);
+
+    // Remove previous airport "delete from airport where airport_id = :prevApId"
+    removePrevAirport();
+  }
+  else
+  {
+    // Remember operation - bounding rectangle needs the moved features
+    insertDeleteOpStmt->bindValue(QStringLiteral(":flags"), static_cast<int>(deleteFlags));
+    insertDeleteOpStmt->bindValue(QStringLiteral(":parking"), !curAirport->getParkings().isEmpty());
+    bindAndExecute(insertDeleteOpStmt, QStringLiteral("delete operation added"));
+
+    pendingIdents.insert(curIdent);
+    if(updateBounding)
+      pendingBounding.append(PendingBounding{curAirportId, curAirport->getPos(), curIdent});
+  }
+}
+
+void DeleteProcessor::flushIdent(const QString& ident)
+{
+  if(pendingIdents.contains(ident))
+    flush();
+}
+
+void DeleteProcessor::flush()
+{
+  if(insertDeleteOpStmt == nullptr || pendingIdents.isEmpty())
+    return;
+
+  static const QList<std::pair<QString, bgl::del::DeleteAllFlag> > FEATURES({
+    std::make_pair(QStringLiteral("approach"), bgl::del::APPROACHES),
+    std::make_pair(QStringLiteral("apron"), bgl::del::APRONS),
+    std::make_pair(QStringLiteral("com"), bgl::del::COMS),
+    std::make_pair(QStringLiteral("helipad"), bgl::del::HELIPADS),
+    std::make_pair(QStringLiteral("taxi_path"), bgl::del::TAXIWAYS),
+    std::make_pair(QStringLiteral("start"), bgl::del::STARTS)
+  });
 
-  // Remove previous airport "delete from airport where airport_id = :prevApId"
-  removePrevAirport();
+  if(options.isVerbose())
+    qInfo() << Q_FUNC_INFO << "airports" << pendingIdents.size();
+
+  // Features which are removed or moved to the new airport depending on delete flags
+  for(const std::pair<QString, bgl::del::DeleteAllFlag>& feature : FEATURES)
+  {
+    QString flag = QString::number(feature.second);
+    executeBatch(delAptFeatureBatchStmt(feature.first, "(delete_flags & " % flag % ") <> 0"), feature.first % " deleted");
+    executeBatch(updateAptFeatureBatchStmt(feature.first, "(delete_flags & " % flag % ") = 0"), feature.first % " updated");
+  }
+
+  // Runways - delete runway before ends due to foreign key from rw -> rw end
+  QString runwayFlag = "(delete_flags & " % QString::number(bgl::del::RUNWAYS) % ") <> 0";
+  executeBatch("insert or ignore into temp.delete_runway_end_id (runway_end_id) "
+               "select primary_end_id from runway where airport_id in "
+               "(select prev_airport_id from temp.delete_airport_op where " % runwayFlag % ") "
+               "union "
+               "select secondary_end_id from runway where airport_id in "
+               "(select prev_airport_id from temp.delete_airport_op where " % runwayFlag % ")",
+               QStringLiteral("runway ends to delete"));
+  executeBatch(delAptFeatureBatchStmt(QStringLiteral("runway"), runwayFlag), QStringLiteral("runways deleted"));
+  executeBatch(QStringLiteral("delete from runway_end where runway_end_id in (select runway_end_id from temp.delete_runway_end_id)"),
+               QStringLiteral("runway ends deleted"));
+  executeBatch(updateAptFeatureBatchStmt(QStringLiteral("runway"), "(delete_flags & " % QString::number(bgl::del::RUNWAYS) % ") = 0"),
+               QStringLiteral("runways updated"));
+
+  executeBatch(delAptFeatureBatchStmt(QStringLiteral("parking"), QStringLiteral("delete_parking = 1")),
+               QStringLiteral("parking spots deleted"));
+  executeBatch(updateAptFeatureBatchStmt(QStringLiteral("parking"), QStringLiteral("delete_parking = 0")),
+               QStringLiteral("parking spots updated"));
+
+  // Unlink navigation - will be updated later in update_nav_ids.sql script
+  executeBatch(updateAptFeatureBatchStmt(QStringLiteral("waypoint"), QStringLiteral("1 = 1")), QStringLiteral("waypoints updated"));
+  executeBatch(updateAptFeatureBatchStmt(QStringLiteral("vor"), QStringLiteral("1 = 1")), QStringLiteral("vors updated"));
+  executeBatch(updateAptFeatureBatchStmt(QStringLiteral("ndb"), QStringLiteral("1 = 1")), QStringLiteral("ndb updated"));
+
+  executeBatch(QStringLiteral("delete from airport where airport_id in (select prev_airport_id from temp.delete_airport_op)"),
+               QStringLiteral("airports deleted"));
+
+  // Features are moved now - update rectangles
+  for(const PendingBounding& bounding : std::as_const(pendingBounding))
+    updateBoundingRect(bounding.airportId, bounding.pos, bounding.ident);
+
+  executeBatch(QStringLiteral("delete from temp.delete_runway_end_id"), QString());
+  executeBatch(QStringLiteral("delete from temp.delete_airport_op"), QString());
+  pendingIdents.clear();
+  pendingBounding.clear();
 }
 
-void DeleteProcessor::updateBoundingRect()
+void DeleteProcessor::updateBoundingRect(int airportId, const atools::geo::Pos& pos, const QString& ident)
 {
   // Fetch min/max runway, taxipath, parking and other coordinates from current airport
-  fetchBoundingStmt->bindValue(QStringLiteral(":apid"), curAirportId);
+  fetchBoundingStmt->bindValue(QStringLiteral(":apid"), airportId);
   executeStatement(fetchBoundingStmt, QStringLiteral("Fetch bounding"));
   if(fetchBoundingStmt->next())
   {
@@ -427,21 +549,21 @@ void DeleteProcessor::updateBoundingRect()
 
       if(bounding.isValid())
       {
-        bounding.extend(curAirport->getPos());
+        bounding.extend(pos);
 
         // Check if rectangle exceeds 20 NM and convert to 500 meter rect if needed
         if(bounding.getHeightMeter() > atools::geo::nmToMeter(10) || bounding.getWidthMeter() > atools::geo::nmToMeter(10))
         {
-          qDebug() << Q_FUNC_INFO << "Correcting bounding rectangle of" << curIdent << "bounding" << bounding;
-          bounding = geo::Rect(curAirport->getPos(), 500.f, false /* fast */);
+          qDebug() << Q_FUNC_INFO << "Correcting bounding rectangle of" << ident << "bounding" << bounding;
+          bounding = geo::Rect(pos, 500.f, false /* fast */);
         }
 
 #ifdef DEBUG_INFORMATION
-        qDebug() << Q_FUNC_INFO << "ident" << curIdent << "currentAirportId" << curAirportId << "bounding" << bounding;
+        qDebug() << Q_FUNC_INFO << "ident" << ident << "airportId" << airportId << "bounding" << bounding;
 #endif
 
         // Update current airport
-        updateBoundingStmt->bindValue(QStringLiteral(":apid"), curAirportId);
+        updateBoundingStmt->bindValue(QStringLiteral(":apid"), airportId);
         updateBoundingStmt->bindValue(QStringLiteral(":leftlonx"), bounding.getWest());
         updateBoundingStmt->bindValue(QStringLiteral(":toplaty"), bounding.getNorth());
         updateBoundingStmt->bindValue(QStringLiteral(":rightlonx"), bounding.getEast());
@@ -537,6 +659,28 @@ QString DeleteProcessor::delAptFeatureStmt(const QString& table)
   return "delete from " % table % " where airport_id = :prevApId";
 }
 
+/* Create a statement that moves features of all previous airports in the batch matching the condition to the current airports */
+QString DeleteProcessor::updateAptFeatureBatchStmt(const QString& table, const QString& condition)
+{
+  return "update " % table % " set airport_id = "
+         "(select o.cur_airport_id from temp.delete_airport_op o where o.prev_airport_id = " % table % ".airport_id) "
+         "where airport_id in (select prev_airport_id from temp.delete_airport_op where " % condition % ")";
+}
+
+/* Create a statement that deletes features of all previous airports in the batch matching the condition */
+QString DeleteProcessor::delAptFeatureBatchStmt(const QString& table, const QString& condition)
+{
+  return "delete from " % table % " where airport_id in "
+         "(select prev_airport_id from temp.delete_airport_op where " % condition % ")";
+}
+
+int DeleteProcessor::executeBatch(const QString& sql, const QString& msg)
+{
+  SqlQuery query(db);
+  query.prepare(sql);
+  return executeStatement(&query, msg);
+}
+
 int DeleteProcessor::bindAndExecute(const QString& sql, const QString& msg)
 {
   SqlQuery query(db);
@@ -20,6 +20,8 @@
 
 #include "fs/bgl/ap/del/deleteairport.h"
 
+#include <QSet>
+
 namespace atools {
 namespace sql {
 class SqlQuery;
@@ -46,6 +48,9 @@ class ApproachWriter;
  * old airports and their facilities.
  *
  * Copies values from previous airport to new and current airport. The previous airport is then deleted.
+ *
+ * If batch deletes are enabled in the options, removing and moving features and deleting the previous airports
+ * is deferred and done in flush() for all airports of a scenery area with a few set based statements.
  */
 class DeleteProcessor
 {
@@ -75,6 +80,15 @@ public:
    */
   void postProcessDelete();
 
+  /*
+   * Apply all collected delete and update operations if batch deletes are enabled in the options.
+   * Has to be called at the end of a scenery area. Does nothing if nothing is pending.
+   */
+  void flush();
+
+  /* Call flush() if the airport ident has pending operations. Needed before the ident is looked up again. */
+  void flushIdent(const QString& ident);
+
   const QString& getBglFilename() const
   {
     return bglFilename;
@@ -108,7 +122,12 @@ private:
   int bindAndExecute(const QString& sql, const QString& msg);
   void extractPreviousAirportFeatures();
   void copyAirportValues(const QStringList& copyAirportColumns);
-  void updateBoundingRect();
+  void updateBoundingRect(int airportId, const atools::geo::Pos& pos, const QString& ident);
+
+  /* Set based statements using the temporary table delete_airport_op */
+  QString updateAptFeatureBatchStmt(const QString& table, const QString& condition);
+  QString delAptFeatureBatchStmt(const QString& table, const QString& condition);
+  int executeBatch(const QString& sql, const QString& msg);
 
   const atools::fs::NavDatabaseOptions& options;
 
@@ -131,7 +150,8 @@ private:
   *deleteTaxiPathStmt = nullptr, *updateTaxiPathStmt = nullptr,
   *deleteComStmt = nullptr, *updateComStmt = nullptr,
   *fetchPrimaryAppStmt = nullptr, *fetchSecondaryAppStmt = nullptr,
-  *updateBoundingStmt = nullptr, *fetchBoundingStmt = nullptr;
+  *updateBoundingStmt = nullptr, *fetchBoundingStmt = nullptr,
+  *insertDeleteOpStmt = nullptr; /* Only created in batch mode */
 
   const atools::fs::bgl::DeleteAirport *deleteAirport = nullptr;
   atools::fs::bgl::del::DeleteAllFlags deleteFlags = atools::fs::bgl::del::NONE;
@@ -150,6 +170,19 @@ private:
   atools::geo::Pos prevPos;
 
   const scenery::SceneryArea *curSceneryArea;
+
+  /* Airports which need a bounding rectangle update after flush() */
+  struct PendingBounding
+  {
+    int airportId;
+    atools::geo::Pos pos;
+    QString ident;
+  };
+
+  QList<PendingBounding> pendingBounding;
+
+  /* Idents of current airports in the batch */
+  QSet<QString> pendingIdents;
 };
 
 } // namespace writer
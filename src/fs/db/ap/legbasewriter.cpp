@@ -32,6 +32,28 @@ using atools::fs::bgl::ApproachLeg;
 LegBaseWriter::LegBaseWriter(sql::SqlDatabase& db, DataWriter& dataWriter, const QLatin1String& table)
   : WriterBase(db, dataWriter, table)
 {
+  typeIdx = placeholderIndex(QStringLiteral(":type"));
+  altDescriptorIdx = placeholderIndex(QStringLiteral(":alt_descriptor"));
+  turnDirectionIdx = placeholderIndex(QStringLiteral(":turn_direction"));
+  fixTypeIdx = placeholderIndex(QStringLiteral(":fix_type"));
+  fixIdentIdx = placeholderIndex(QStringLiteral(":fix_ident"));
+  fixRegionIdx = placeholderIndex(QStringLiteral(":fix_region"));
+  fixAirportIdentIdx = placeholderIndex(QStringLiteral(":fix_airport_ident"));
+  recommendedFixTypeIdx = placeholderIndex(QStringLiteral(":recommended_fix_type"));
+  recommendedFixIdentIdx = placeholderIndex(QStringLiteral(":recommended_fix_ident"));
+  recommendedFixRegionIdx = placeholderIndex(QStringLiteral(":recommended_fix_region"));
+  isFlyoverIdx = placeholderIndex(QStringLiteral(":is_flyover"));
+  isTrueCourseIdx = placeholderIndex(QStringLiteral(":is_true_course"));
+  courseIdx = placeholderIndex(QStringLiteral(":course"));
+  timeIdx = placeholderIndex(QStringLiteral(":time"));
+  distanceIdx = placeholderIndex(QStringLiteral(":distance"));
+  thetaIdx = placeholderIndex(QStringLiteral(":theta"));
+  rhoIdx = placeholderIndex(QStringLiteral(":rho"));
+  altitude1Idx = placeholderIndex(QStringLiteral(":altitude1"));
+  altitude2Idx = placeholderIndex(QStringLiteral(":altitude2"));
+  speedLimitIdx = placeholderIndex(QStringLiteral(":speed_limit"));
+  speedLimitTypeIdx = placeholderIndex(QStringLiteral(":speed_limit_type"));
+  verticalAngleIdx = placeholderIndex(QStringLiteral(":vertical_angle"));
 }
 
 void LegBaseWriter::writeObject(const ApproachLeg *type)
@@ -47,53 +69,51 @@ void LegBaseWriter::writeObject(const ApproachLeg *type)
     return;
   }
 
-  bind(QStringLiteral(":type"), typeStr);
-  bind(QStringLiteral(":alt_descriptor"),
-       bgl::util::enumToStr(bgl::ApproachLeg::altDescriptorToString, type->getAltDescriptor()));
-  bind(QStringLiteral(":turn_direction"), bgl::util::enumToStr(bgl::ApproachLeg::turnDirToString, type->getTurnDirection()));
-  bind(QStringLiteral(":fix_type"), bgl::util::enumToStr(bgl::ap::approachFixTypeToStr, type->getFixType()));
-  bind(QStringLiteral(":fix_ident"), type->getFixIdent());
-  bind(QStringLiteral(":fix_region"), type->getFixRegion());
-  bind(QStringLiteral(":fix_airport_ident"), type->getFixAirportIdent());
-  bind(QStringLiteral(":recommended_fix_type"),
-       bgl::util::enumToStr(bgl::ap::approachFixTypeToStr, type->getRecommendedFixType()));
-  bind(QStringLiteral(":recommended_fix_ident"), type->getRecommendedFixIdent());
-  bind(QStringLiteral(":recommended_fix_region"), type->getRecommendedFixRegion());
-  bindBool(QStringLiteral(":is_flyover"), type->isFlyover());
-  bindBool(QStringLiteral(":is_true_course"), type->isTrueCourse());
-  bind(QStringLiteral(":course"), type->getCourse());
+  bindStr(typeIdx, typeStr);
+  bindStr(altDescriptorIdx, bgl::util::enumToStr(bgl::ApproachLeg::altDescriptorToString, type->getAltDescriptor()));
+  bindStr(turnDirectionIdx, bgl::util::enumToStr(bgl::ApproachLeg::turnDirToString, type->getTurnDirection()));
+  bindStr(fixTypeIdx, bgl::util::enumToStr(bgl::ap::approachFixTypeToStr, type->getFixType()));
+  bindStr(fixIdentIdx, type->getFixIdent());
+  bindStr(fixRegionIdx, type->getFixRegion());
+  bindStr(fixAirportIdentIdx, type->getFixAirportIdent());
+  bindStr(recommendedFixTypeIdx, bgl::util::enumToStr(bgl::ap::approachFixTypeToStr, type->getRecommendedFixType()));
+  bindStr(recommendedFixIdentIdx, type->getRecommendedFixIdent());
+  bindStr(recommendedFixRegionIdx, type->getRecommendedFixRegion());
+  bindBool(isFlyoverIdx, type->isFlyover());
+  bindBool(isTrueCourseIdx, type->isTrueCourse());
+  bindDouble(courseIdx, type->getCourse());
 
   if(type->isTime())
   {
-    bind(QStringLiteral(":time"), type->getDistOrTime());
-    bindNullFloat(QStringLiteral(":distance"));
+    bindDouble(timeIdx, type->getDistOrTime());
+    bindNullFloat(distanceIdx);
   }
   else
   {
-    bind(QStringLiteral(":distance"), roundToInt(atools::geo::meterToNm(type->getDistOrTime())));
-    bindNullFloat(QStringLiteral(":time"));
+    bindInt(distanceIdx, roundToInt(atools::geo::meterToNm(type->getDistOrTime())));
+    bindNullFloat(timeIdx);
   }
 
-  bind(QStringLiteral(":theta"), type->getTheta());
-  bind(QStringLiteral(":rho"), atools::geo::meterToNm(type->getRho()));
-  bind(QStringLiteral(":altitude1"), roundToInt(atools::geo::meterToFeet(type->getAltitude1())));
-  bind(QStringLiteral(":altitude2"), roundToInt(atools::geo::meterToFeet(type->getAltitude2())));
+  bindDouble(thetaIdx, type->getTheta());
+  bindDouble(rhoIdx, atools::geo::meterToNm(type->getRho()));
+  bindInt(altitude1Idx, roundToInt(atools::geo::meterToFeet(type->getAltitude1())));
+  bindInt(altitude2Idx, roundToInt(atools::geo::meterToFeet(type->getAltitude2())));
 
   if(type->getSpeedLimit() > 10.f)
   {
-    bind(QStringLiteral(":speed_limit"), roundToInt(type->getSpeedLimit()));
-    bind(QStringLiteral(":speed_limit_type"), QStringLiteral("-")); // Assume limit for maximum speed - type is not given in BGL
+    bindInt(speedLimitIdx, roundToInt(type->getSpeedLimit()));
+    bindStr(speedLimitTypeIdx, QStringLiteral("-")); // Assume limit for maximum speed - type is not given in BGL
   }
   else
   {
-    bindNullInt(QStringLiteral(":speed_limit"));
-    bindNullString(QStringLiteral(":speed_limit_type"));
+    bindNullInt(speedLimitIdx);
+    bindNullString(speedLimitTypeIdx);
   }
 
   if(std::abs(type->getVerticalAngle()) > 0.f)
-    bind(QStringLiteral(":vertical_angle"), -type->getVerticalAngle() / 100.f);
+    bindDouble(verticalAngleIdx, -type->getVerticalAngle() / 100.f);
   else
-    bindNullInt(QStringLiteral(":vertical_angle"));
+    bindNullInt(verticalAngleIdx);
 
   executeStatement();
 }
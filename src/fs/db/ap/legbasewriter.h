@@ -39,6 +39,13 @@ public:
 protected:
   virtual void writeObject(const atools::fs::bgl::ApproachLeg *type) override;
 
+private:
+  /* Placeholder indexes resolved once */
+  int typeIdx, altDescriptorIdx, turnDirectionIdx, fixTypeIdx, fixIdentIdx, fixRegionIdx, fixAirportIdentIdx,
+      recommendedFixTypeIdx, recommendedFixIdentIdx, recommendedFixRegionIdx, isFlyoverIdx, isTrueCourseIdx, courseIdx,
+      timeIdx, distanceIdx, thetaIdx, rhoIdx, altitude1Idx, altitude2Idx, speedLimitIdx, speedLimitTypeIdx,
+      verticalAngleIdx;
+
 };
 
 } // namespace writer
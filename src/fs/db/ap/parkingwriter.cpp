@@ -30,25 +30,43 @@ namespace db {
 using atools::fs::bgl::Parking;
 using atools::geo::meterToFeet;
 
+ParkingWriter::ParkingWriter(sql::SqlDatabase& db, DataWriter& dataWriter)
+  : WriterBase(db, dataWriter, QLatin1String("parking"))
+{
+  parkingIdIdx = placeholderIndex(QStringLiteral(":parking_id"));
+  airportIdIdx = placeholderIndex(QStringLiteral(":airport_id"));
+  typeIdx = placeholderIndex(QStringLiteral(":type"));
+  suffixIdx = placeholderIndex(QStringLiteral(":suffix"));
+  pushbackIdx = placeholderIndex(QStringLiteral(":pushback"));
+  nameIdx = placeholderIndex(QStringLiteral(":name"));
+  numberIdx = placeholderIndex(QStringLiteral(":number"));
+  airlineCodesIdx = placeholderIndex(QStringLiteral(":airline_codes"));
+  radiusIdx = placeholderIndex(QStringLiteral(":radius"));
+  headingIdx = placeholderIndex(QStringLiteral(":heading"));
+  hasJetwayIdx = placeholderIndex(QStringLiteral(":has_jetway"));
+  lonxIdx = placeholderIndex(QStringLiteral(":lonx"));
+  latyIdx = placeholderIndex(QStringLiteral(":laty"));
+}
+
 void ParkingWriter::writeObject(const Parking *type)
 {
   if(getOptions().isVerbose())
     qDebug() << "Writing Parking for airport "
              << getDataWriter().getAirportWriter()->getCurrentAirportIdent();
 
-  bind(QStringLiteral(":parking_id"), getNextId());
-  bind(QStringLiteral(":airport_id"), getDataWriter().getAirportWriter()->getCurrentId());
-  bind(QStringLiteral(":type"), bgl::util::enumToStr(Parking::parkingTypeToStr, type->getType()));
-  bind(QStringLiteral(":suffix"), bgl::util::enumToStr(Parking::parkingSuffixToStr, type->getSuffix()));
-  bind(QStringLiteral(":pushback"), bgl::util::enumToStr(Parking::pushBackToStr, type->getPushBack()));
-  bind(QStringLiteral(":name"), Parking::parkingNameToStr(type->getName())); // Also allow NONE and UNKNOWN
-  bind(QStringLiteral(":number"), type->getNumber());
-  bind(QStringLiteral(":airline_codes"), type->getAirlineCodes().join(QStringLiteral(",")));
-  bind(QStringLiteral(":radius"), roundToInt(meterToFeet(type->getRadius())));
-  bind(QStringLiteral(":heading"), type->getHeading());
-  bindBool(QStringLiteral(":has_jetway"), type->hasJetway());
-  bind(QStringLiteral(":lonx"), type->getPosD().getLonX());
-  bind(QStringLiteral(":laty"), type->getPosD().getLatY());
+  bindInt(parkingIdIdx, getNextId());
+  bindInt(airportIdIdx, getDataWriter().getAirportWriter()->getCurrentId());
+  bindStr(typeIdx, bgl::util::enumToStr(Parking::parkingTypeToStr, type->getType()));
+  bindStr(suffixIdx, bgl::util::enumToStr(Parking::parkingSuffixToStr, type->getSuffix()));
+  bindStr(pushbackIdx, bgl::util::enumToStr(Parking::pushBackToStr, type->getPushBack()));
+  bindStr(nameIdx, Parking::parkingNameToStr(type->getName())); // Also allow NONE and UNKNOWN
+  bindInt(numberIdx, type->getNumber());
+  bindStr(airlineCodesIdx, type->getAirlineCodes().join(QStringLiteral(",")));
+  bindInt(radiusIdx, roundToInt(meterToFeet(type->getRadius())));
+  bindDouble(headingIdx, type->getHeading());
+  bindBool(hasJetwayIdx, type->hasJetway());
+  bindDouble(lonxIdx, type->getPosD().getLonX());
+  bindDouble(latyIdx, type->getPosD().getLatY());
 
   executeStatement();
 }
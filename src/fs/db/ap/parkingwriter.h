@@ -29,14 +29,16 @@ class ParkingWriter :
   public atools::fs::db::WriterBase<atools::fs::bgl::Parking>
 {
 public:
-  ParkingWriter(atools::sql::SqlDatabase& db, atools::fs::db::DataWriter& dataWriter)
-    : WriterBase(db, dataWriter, QLatin1String("parking"))
-  {
-  }
+  ParkingWriter(atools::sql::SqlDatabase& db, atools::fs::db::DataWriter& dataWriter);
 
 protected:
   virtual void writeObject(const atools::fs::bgl::Parking *type) override;
 
+private:
+  /* Placeholder indexes resolved once */
+  int parkingIdIdx, airportIdIdx, typeIdx, suffixIdx, pushbackIdx, nameIdx, numberIdx, airlineCodesIdx, radiusIdx,
+      headingIdx, hasJetwayIdx, lonxIdx, latyIdx;
+
 };
 
 } // namespace writer
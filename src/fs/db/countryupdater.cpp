@@ -17,17 +17,26 @@
 
 #include "countryupdater.h"
 #include "fs/util/fsutil.h"
+#include "geo/pos.h"
 #include "sql/sqldatabase.h"
 #include "sql/sqlquery.h"
 #include "timezone/timezonemanager.h"
 
+#include <QElapsedTimer>
 #include <QHash>
 #include <QStringList>
 
+#include <cmath>
+
 namespace atools {
 namespace fs {
 namespace db {
 
+/* Size of territory raster cells in degree */
+const static float CELL_SIZE_DEG = 0.1f;
+const static int CELL_COLUMNS = 3600;
+const static int CELL_ROWS = 1800;
+
 // All possible country errors collected from X-Plane 11 and 12 community airports
 // Key is upper case
 const QHash<QString, QString> CountryUpdater::countries({
@@ -475,11 +484,63 @@ CountryUpdater::CountryUpdater(sql::SqlDatabase& sqlDb, const QString& timezoneF
 
 CountryUpdater::~CountryUpdater()
 {
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << "calls" << numCalls << "raster hits" << numCellHits
+             << "raster cells" << territoryCells.size();
+
   delete timezone;
 }
 
+QString CountryUpdater::territoryName(QLocale::Territory territory)
+{
+  auto it = territoryNames.constFind(territory);
+  if(it != territoryNames.constEnd())
+    return it.value();
+
+  QString name = QLocale::territoryToString(territory);
+  territoryNames.insert(territory, name);
+  return name;
+}
+
+QLocale::Territory CountryUpdater::territoryForPos(const atools::geo::Pos& pos)
+{
+  float lonX = pos.getLonX(), latY = pos.getLatY();
+  int col = std::max(0, std::min(static_cast<int>((lonX + 180.f) / CELL_SIZE_DEG), CELL_COLUMNS - 1));
+  int row = std::max(0, std::min(static_cast<int>((latY + 90.f) / CELL_SIZE_DEG), CELL_ROWS - 1));
+  int key = row * CELL_COLUMNS + col;
+
+  auto it = territoryCells.constFind(key);
+  if(it != territoryCells.constEnd())
+  {
+    numCellHits++;
+    return it.value();
+  }
+
+  float safezoneDeg = 0.f;
+  QByteArray id = timezone->getTimezoneId(lonX, latY, &safezoneDeg);
+  QLocale::Territory territory = QLocale::AnyTerritory;
+  if(!id.isEmpty())
+  {
+    QTimeZone zone(id);
+    if(zone.isValid())
+      territory = zone.territory();
+  }
+
+  // Remember cell if the safe zone covers the farthest cell corner. Safe zone is conservative for longitude.
+  float west = col * CELL_SIZE_DEG - 180.f, south = row * CELL_SIZE_DEG - 90.f;
+  float dx = std::max(lonX - west, west + CELL_SIZE_DEG - lonX);
+  float dy = std::max(latY - south, south + CELL_SIZE_DEG - latY);
+  if(!id.isEmpty() && safezoneDeg > std::sqrt(dx * dx + dy * dy))
+    territoryCells.insert(key, territory);
+
+  return territory;
+}
+
 QString CountryUpdater::updateAirportCountry(const QString& country, const atools::geo::Pos& pos)
 {
+  QElapsedTimer timer;
+  timer.start();
+
   QString countryNew(country);
 
   if(!country.isEmpty())
@@ -495,21 +556,24 @@ QString CountryUpdater::updateAirportCountry(const QString& country, const atool
       // A country code - lookup name
       QLocale::Territory territory = QLocale::codeToTerritory(country3To2.value(country.toUpper()));
       if(territory != QLocale::AnyTerritory)
-        countryNew = QLocale::territoryToString(territory);
+        countryNew = territoryName(territory);
     }
   }
   else if(timezone != nullptr)
   {
     // No country given - look up in time zone database
-    QTimeZone zone = timezone->getTimezone(pos);
-    if(zone.isValid() && zone.territory() != QLocale::AnyTerritory)
-      countryNew = QLocale::territoryToString(zone.territory());
+    QLocale::Territory territory = territoryForPos(pos);
+    if(territory != QLocale::AnyTerritory)
+      countryNew = territoryName(territory);
   }
 
   if(countryNew == QStringLiteral("Default")) // From territoryToString()
     countryNew.clear();
 
-  return atools::fs::util::capAdminName(countryNew);
+  countryNew = atools::fs::util::capAdminName(countryNew);
+  elapsedNs += timer.nsecsElapsed();
+  numCalls++;
+  return countryNew;
 }
 
 } // namespace writer
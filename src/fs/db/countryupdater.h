@@ -19,6 +19,7 @@
 #define ATOOLS_COUNTRYREPAIR_H
 
 #include <QHash>
+#include <QLocale>
 
 namespace atools {
 
@@ -49,12 +50,43 @@ public:
   /* Fix broken country name. Needs coordinates for time zone lookup. */
   QString updateAirportCountry(const QString& country, const atools::geo::Pos& pos);
 
+  /* Total time spent in updateAirportCountry() */
+  qint64 getElapsedMs() const
+  {
+    return elapsedNs / 1000000;
+  }
+
+  int getNumCalls() const
+  {
+    return numCalls;
+  }
+
+  /* Number of time zone lookups resolved from the territory raster */
+  int getNumCellHits() const
+  {
+    return numCellHits;
+  }
+
 private:
+  /* Territory for position from the raster or from the time zone database for cells near borders */
+  QLocale::Territory territoryForPos(const atools::geo::Pos& pos);
+
+  /* Memoized QLocale::territoryToString() */
+  QString territoryName(QLocale::Territory territory);
+
   atools::sql::SqlDatabase& db;
   atools::timezone::TimeZoneManager *timezone = nullptr;
   const static QHash<QString, QString> countries, /* Wrong country names with replacements */
                                        country3To2; /* convert ISO 3166-1 alpha-3 to alpha-2 for QLocale::codeToTerritory() */
+
+  /* Raster of 0.1 degree cells which are completely inside one time zone. Key is row * columns + column.
+   * Filled on demand from the safe zone distance of the time zone lookups. */
+  QHash<int, QLocale::Territory> territoryCells;
+  QHash<int, QString> territoryNames;
+
   bool verbose;
+  qint64 elapsedNs = 0;
+  int numCalls = 0, numCellHits = 0;
 };
 
 } // namespace writer
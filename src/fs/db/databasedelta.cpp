@@ -0,0 +1,822 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/db/databasedelta.h"
+
+#include "exception.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+#include "sql/sqlutil.h"
+
+#include <QAtomicInt>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSet>
+#include <QStringBuilder>
+
+#include <exception>
+
+using atools::sql::SqlDatabase;
+using atools::sql::SqlQuery;
+using atools::sql::SqlUtil;
+
+namespace atools {
+namespace fs {
+namespace db {
+
+namespace delta {
+
+/* Separates key parts. Not used in navigation data. */
+static const QChar KEY_SEPARATOR(0x1f);
+
+/* Replaces null values in keys */
+static const QChar KEY_NULL(0x1e);
+
+static const QLatin1String KEY_COLUMN("delta_key");
+static const QLatin1String TABLE_TABLE("delta_table");
+static const QLatin1String DELETE_TABLE_PREFIX("delta_delete_");
+static const QLatin1String ROW_TABLE_PREFIX("delta_row_");
+
+/* Foreign key column referencing the row id of table or of one of tablesByType depending on the type column */
+struct ForeignKey
+{
+  QString table;
+  int typeColumn = -1;
+  QHash<QString, QString> tablesByType;
+
+  QString referencedTable(const QVariantList& values) const
+  {
+    return typeColumn == -1 ? table : tablesByType.value(values.at(typeColumn).toString());
+  }
+
+  QStringList referencedTables() const
+  {
+    return typeColumn == -1 ? QStringList({table}) : tablesByType.values();
+  }
+
+};
+
+struct Table
+{
+  QString name;
+
+  /* All columns except an integer primary key which is an alias for the row id */
+  QStringList columns;
+
+  /* Indexes into columns. Empty if the row content is used as key. */
+  QList<int> keyColumns;
+
+  /* Column index to foreign key */
+  QHash<int, ForeignKey> foreignKeys;
+
+  QStringList referencedTables() const
+  {
+    QStringList tables;
+    for(const ForeignKey& foreignKey : foreignKeys)
+      tables.append(foreignKey.referencedTables());
+    return tables;
+  }
+
+};
+
+/* Row id and hash of the content with foreign keys replaced by keys */
+struct Row
+{
+  qint64 id;
+  QByteArray hash;
+};
+
+struct Keys
+{
+  QHash<QString, Row> rows;
+
+  /* Only filled for tables referenced by foreign keys */
+  QHash<qint64, QString> keyById;
+};
+
+/* Counts from table delta_table */
+struct TableInfo
+{
+  qint64 oldRows = 0, numDelete = 0, numRow = 0;
+};
+
+static QString quoted(const QString& name)
+{
+  return '"' % name % '"';
+}
+
+static QString selectStatement(const Table& table)
+{
+  QStringList columns;
+  for(const QString& column : table.columns)
+    columns.append(quoted(column));
+  return "select rowid, " % columns.join(", ") % " from " % quoted(table.name) % " order by rowid";
+}
+
+/* Read values of all columns except the row id. Foreign keys are replaced by the key of the referenced row
+ * or null if the row or its table is not found. */
+static QVariantList readValues(const Table& table, const SqlQuery& query, const QHash<QString, Keys>& keys)
+{
+  QVariantList values;
+  values.reserve(table.columns.size());
+  for(int i = 0; i < table.columns.size(); i++)
+    values.append(query.value(i + 1));
+
+  for(auto it = table.foreignKeys.constBegin(); it != table.foreignKeys.constEnd(); ++it)
+  {
+    QVariant& value = values[it.key()];
+    if(!value.isNull())
+    {
+      auto keysIt = keys.constFind(it.value().referencedTable(values));
+      if(keysIt != keys.constEnd())
+      {
+        auto keyIt = keysIt->keyById.constFind(value.toLongLong());
+        value = keyIt != keysIt->keyById.constEnd() ? QVariant(keyIt.value()) : QVariant();
+      }
+      else
+        value = QVariant();
+    }
+  }
+  return values;
+}
+
+/* Hash of all values. Values are prefixed with their size to avoid equal hashes for shifted values. */
+static QByteArray hashValues(QCryptographicHash& hasher, const QVariantList& values)
+{
+  QByteArray bytes;
+  for(const QVariant& value : values)
+  {
+    if(value.isNull())
+      bytes.append('-');
+    else
+    {
+      QByteArray data = value.typeId() == QMetaType::QByteArray ? value.toByteArray() : value.toString().toUtf8();
+      bytes.append(QByteArray::number(data.size())).append(':').append(data);
+    }
+  }
+
+  hasher.reset();
+  hasher.addData(bytes);
+  return hasher.result();
+}
+
+/* Natural key or content hash. Duplicates are numbered in row id order. */
+static QString rowKey(const Table& table, const QVariantList& values, const QByteArray& hash, QHash<QString, int>& duplicates)
+{
+  QString key;
+  if(table.keyColumns.isEmpty())
+    key = QString::fromLatin1(hash.toHex());
+  else
+  {
+    QStringList parts;
+    for(int column : table.keyColumns)
+    {
+      const QVariant& value = values.at(column);
+      parts.append(value.isNull() ? QString(KEY_NULL) : value.toString());
+    }
+    key = parts.join(KEY_SEPARATOR);
+  }
+
+  int number = duplicates[key]++;
+  if(number > 0)
+    key += KEY_SEPARATOR % QString::number(number);
+  return key;
+}
+
+/* Names of all tables referenced by foreign keys */
+static QSet<QString> referencedTables(const QList<Table>& tables)
+{
+  QSet<QString> referenced;
+  for(const Table& table : tables)
+  {
+    for(const QString& name : table.referencedTables())
+      referenced.insert(name);
+  }
+  return referenced;
+}
+
+static bool equalSchema(const QList<Table>& tables1, const QList<Table>& tables2)
+{
+  if(tables1.size() != tables2.size())
+    return false;
+
+  for(int i = 0; i < tables1.size(); i++)
+  {
+    if(tables1.at(i).name != tables2.at(i).name || tables1.at(i).columns != tables2.at(i).columns)
+      return false;
+  }
+  return true;
+}
+
+/* Rebuild external content full text search tables which are not updated by changes in their content tables */
+static void rebuildFullTextSearch(SqlDatabase& db)
+{
+  QStringList names;
+  SqlQuery query(db);
+  query.exec("select name, sql from sqlite_master where type = 'table'");
+  while(query.next())
+  {
+    QString sql = query.valueStr(1).simplified().toLower();
+    if(sql.startsWith("create virtual table") && sql.contains("using fts5") && sql.contains("content="))
+      names.append(query.valueStr(0));
+  }
+
+  for(const QString& name : std::as_const(names))
+    query.exec("insert into " % quoted(name) % '(' % quoted(name) % ") values('rebuild')");
+}
+
+/* Open file in a new connection and call func. Connection is closed and removed also if an exception is thrown. */
+template<typename FUNC>
+static DatabaseDeltaStats withDatabase(const QString& filename, const QStringList& pragmas, bool readonly, FUNC func)
+{
+  static QAtomicInt connectionCounter;
+  QString connectionName = QStringLiteral("atools_database_delta_%1").arg(connectionCounter.fetchAndAddRelaxed(1));
+
+  DatabaseDeltaStats stats;
+  std::exception_ptr exception;
+  {
+    SqlDatabase db = SqlDatabase::addDatabase("QSQLITE", connectionName);
+    try
+    {
+      db.setDatabaseName(filename);
+      db.open(pragmas, readonly);
+      stats = func(db);
+    }
+    catch(...)
+    {
+      exception = std::current_exception();
+    }
+
+    if(db.isOpen())
+      db.close();
+  }
+  SqlDatabase::removeDatabase(connectionName);
+
+  if(exception)
+    std::rethrow_exception(exception);
+  return stats;
+}
+
+} // namespace delta
+
+DatabaseDelta::DatabaseDelta()
+{
+  // Navaids and airports are identified by ident and region =================
+  setNaturalKey("bgl_file", {"filepath"});
+  setNaturalKey("airport", {"ident"});
+  setNaturalKey("vor", {"ident", "region", "type"});
+  setNaturalKey("ndb", {"ident", "region", "type"});
+  setNaturalKey("waypoint", {"ident", "region", "type"});
+  setNaturalKey("ils", {"ident", "region", "loc_airport_ident"});
+
+  // Procedures by airport and name, runways and legs by parent and position in id order =================
+  setNaturalKey("runway", {"airport_id"});
+  setNaturalKey("approach", {"airport_id", "arinc_name", "type", "suffix", "runway_name", "fix_ident", "fix_region"});
+  setNaturalKey("transition", {"approach_id", "type", "fix_ident", "fix_region"});
+  setNaturalKey("approach_leg", {"approach_id"});
+  setNaturalKey("transition_leg", {"transition_id"});
+
+  // Foreign keys not declared in the schema =================
+  addForeignKey("mora_grid", "file_id", "bgl_file");
+  addForeignKey("airport_msa", "file_id", "bgl_file");
+  addForeignKey("holding", "file_id", "bgl_file");
+
+  addTypedForeignKey("waypoint", "nav_id", "type", {
+    {"V", "vor"}, {"N", "ndb"}
+  });
+  addTypedForeignKey("nav_search", "waypoint_nav_id", "type", {
+    {"V", "vor"}, {"N", "ndb"}
+  });
+  addTypedForeignKey("airport_msa", "nav_id", "nav_type", {
+    {"N", "ndb"}, {"W", "waypoint"}, {"V", "vor"}, {"A", "airport"}, {"R", "runway_end"}
+  });
+  addTypedForeignKey("holding", "nav_id", "nav_type", {
+    {"N", "ndb"}, {"W", "waypoint"}, {"V", "vor"}
+  });
+}
+
+DatabaseDelta::~DatabaseDelta()
+{
+
+}
+
+void DatabaseDelta::setNaturalKey(const QString& table, const QStringList& columns)
+{
+  naturalKeys.insert(table, columns);
+}
+
+void DatabaseDelta::addForeignKey(const QString& table, const QString& column, const QString& referencedTable)
+{
+  undeclaredForeignKeys[table].insert(column, referencedTable);
+}
+
+void DatabaseDelta::addTypedForeignKey(const QString& table, const QString& column, const QString& typeColumn,
+                                       const QHash<QString, QString>& tablesByType)
+{
+  typedForeignKeys[table].append({column, typeColumn, tablesByType});
+}
+
+QList<delta::Table> DatabaseDelta::readSchema(SqlDatabase& db) const
+{
+  // Collect tables excluding internal and virtual tables and the shadow tables of virtual tables =================
+  QStringList names, virtualNames;
+  SqlQuery query(db);
+  query.exec("select name, sql from sqlite_master where type = 'table' order by name");
+  while(query.next())
+  {
+    QString name = query.valueStr(0);
+    if(name.startsWith("sqlite_"))
+      continue;
+
+    if(query.valueStr(1).simplified().startsWith("create virtual table", Qt::CaseInsensitive))
+      virtualNames.append(name);
+    else
+      names.append(name);
+  }
+
+  QHash<QString, delta::Table> tables;
+  for(const QString& name : std::as_const(names))
+  {
+    bool shadow = false;
+    for(const QString& virtualName : std::as_const(virtualNames))
+      shadow |= name.startsWith(virtualName + '_');
+    if(shadow)
+      continue;
+
+    delta::Table table;
+    table.name = name;
+
+    // cid, name, type, notnull, dflt_value, pk
+    QString primaryKey, primaryKeyType;
+    int numPrimaryKey = 0;
+    query.exec("pragma table_info(" % delta::quoted(name) % ")");
+    while(query.next())
+    {
+      table.columns.append(query.valueStr(1));
+      if(query.valueInt(5) > 0)
+      {
+        numPrimaryKey++;
+        primaryKey = query.valueStr(1);
+        primaryKeyType = query.valueStr(2);
+      }
+    }
+
+    // Integer primary key is an alias for the row id which is different in each database
+    if(numPrimaryKey == 1 && primaryKeyType.compare("integer", Qt::CaseInsensitive) == 0)
+      table.columns.removeOne(primaryKey);
+
+    // id, seq, table, from, to, on_update, on_delete, match
+    query.exec("pragma foreign_key_list(" % delta::quoted(name) % ")");
+    while(query.next())
+    {
+      int column = table.columns.indexOf(query.valueStr(3));
+      if(column != -1)
+        table.foreignKeys[column].table = query.valueStr(2);
+    }
+
+    const QHash<QString, QString> undeclaredKeys = undeclaredForeignKeys.value(name);
+    for(auto it = undeclaredKeys.constBegin(); it != undeclaredKeys.constEnd(); ++it)
+    {
+      int column = table.columns.indexOf(it.key());
+      if(column != -1)
+        table.foreignKeys[column].table = it.value();
+    }
+
+    for(const TypedForeignKey& typedKey : typedForeignKeys.value(name))
+    {
+      int column = table.columns.indexOf(typedKey.column), typeColumn = table.columns.indexOf(typedKey.typeColumn);
+      if(column != -1 && typeColumn != -1)
+      {
+        delta::ForeignKey& foreignKey = table.foreignKeys[column];
+        foreignKey.typeColumn = typeColumn;
+        foreignKey.tablesByType = typedKey.tablesByType;
+      }
+    }
+
+    for(const QString& keyColumn : naturalKeys.value(name))
+    {
+      int column = table.columns.indexOf(keyColumn);
+      if(column == -1)
+      {
+        qWarning() << Q_FUNC_INFO << "Key column" << keyColumn << "not found in" << name << "using content";
+        table.keyColumns.clear();
+        break;
+      }
+      table.keyColumns.append(column);
+    }
+
+    if(!table.columns.isEmpty())
+      tables.insert(name, table);
+  }
+
+  // Sort tables so that referenced tables come first. Self references are ignored. =================
+  QList<delta::Table> sorted;
+  QSet<QString> done;
+  while(sorted.size() < tables.size())
+  {
+    int numSorted = sorted.size();
+    for(const QString& name : std::as_const(names))
+    {
+      auto it = tables.constFind(name);
+      if(it == tables.constEnd() || done.contains(name))
+        continue;
+
+      bool resolved = true;
+      for(const QString& referenced : it->referencedTables())
+        resolved &= referenced == name || done.contains(referenced) || !tables.contains(referenced);
+
+      if(resolved)
+      {
+        sorted.append(it.value());
+        done.insert(name);
+      }
+    }
+
+    if(sorted.size() == numSorted)
+      throw Exception(QStringLiteral("Cyclic foreign keys in database \"%1\"").arg(db.databaseName()));
+  }
+  return sorted;
+}
+
+void DatabaseDelta::readKeys(SqlDatabase& db, const delta::Table& table, QHash<QString, delta::Keys>& keys,
+                             bool keyById) const
+{
+  delta::Keys tableKeys;
+  QHash<QString, int> duplicates;
+  QCryptographicHash hasher(QCryptographicHash::Md5);
+
+  SqlQuery query(db);
+  query.setForwardOnly(true);
+  query.exec(delta::selectStatement(table));
+  while(query.next())
+  {
+    qint64 id = query.value(0).toLongLong();
+    QVariantList values = delta::readValues(table, query, keys);
+    QByteArray hash = delta::hashValues(hasher, values);
+    QString key = delta::rowKey(table, values, hash, duplicates);
+
+    tableKeys.rows.insert(key, {id, hash});
+    if(keyById)
+      tableKeys.keyById.insert(id, key);
+  }
+  keys.insert(table.name, tableKeys);
+}
+
+DatabaseDeltaStats DatabaseDelta::createDelta(SqlDatabase& oldDb, SqlDatabase& newDb, const QString& deltaFilename)
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  const QList<delta::Table> tables = readSchema(oldDb);
+  if(!delta::equalSchema(tables, readSchema(newDb)))
+    throw Exception(QStringLiteral("Database schemas of \"%1\" and \"%2\" differ").
+                    arg(oldDb.databaseName()).arg(newDb.databaseName()));
+
+  const QSet<QString> referenced = delta::referencedTables(tables);
+
+  QFile::remove(deltaFilename);
+  DatabaseDeltaStats stats = delta::withDatabase(deltaFilename, {"PRAGMA synchronous = OFF", "PRAGMA journal_mode = OFF"}, false,
+                                                 [&](SqlDatabase& deltaDb) -> DatabaseDeltaStats {
+    DatabaseDeltaStats deltaStats;
+    SqlQuery deltaQuery(deltaDb);
+    deltaQuery.exec("create table " % delta::TABLE_TABLE %
+                    " (name varchar(100) primary key, position integer, old_rows integer, num_delete integer, num_row integer)");
+
+    SqlQuery tableInsert(deltaDb);
+    tableInsert.prepare("insert into " % delta::TABLE_TABLE %
+                        " (name, position, old_rows, num_delete, num_row) values(?, ?, ?, ?, ?)");
+
+    QHash<QString, delta::Keys> oldKeys, newKeys;
+    for(int position = 0; position < tables.size(); position++)
+    {
+      const delta::Table& table = tables.at(position);
+      readKeys(oldDb, table, oldKeys, referenced.contains(table.name));
+      readKeys(newDb, table, newKeys, referenced.contains(table.name));
+      delta::Keys& oldTableKeys = oldKeys[table.name];
+      delta::Keys& newTableKeys = newKeys[table.name];
+
+      // Compare keys and hashes =================
+      QStringList deletedKeys;
+      for(auto it = oldTableKeys.rows.constBegin(); it != oldTableKeys.rows.constEnd(); ++it)
+      {
+        if(!newTableKeys.rows.contains(it.key()))
+          deletedKeys.append(it.key());
+      }
+
+      // Row id in new database to key for inserted and changed rows
+      QHash<qint64, QString> changedRows;
+      for(auto it = newTableKeys.rows.constBegin(); it != newTableKeys.rows.constEnd(); ++it)
+      {
+        auto oldIt = oldTableKeys.rows.constFind(it.key());
+        if(oldIt == oldTableKeys.rows.constEnd())
+        {
+          changedRows.insert(it->id, it.key());
+          deltaStats.inserted++;
+        }
+        else if(oldIt->hash != it->hash)
+        {
+          changedRows.insert(it->id, it.key());
+          deltaStats.updated++;
+        }
+      }
+      deltaStats.deleted += deletedKeys.size();
+
+      tableInsert.bindValue(0, table.name);
+      tableInsert.bindValue(1, position);
+      tableInsert.bindValue(2, oldTableKeys.rows.size());
+      tableInsert.bindValue(3, deletedKeys.size());
+      tableInsert.bindValue(4, changedRows.size());
+      tableInsert.exec();
+
+      // Only keys by id are needed for foreign keys of the following tables
+      oldTableKeys.rows.clear();
+      newTableKeys.rows.clear();
+
+      if(deletedKeys.isEmpty() && changedRows.isEmpty())
+        continue;
+
+      deltaStats.tables++;
+
+      // Write deleted keys =================
+      deltaQuery.exec("create table " % delta::quoted(delta::DELETE_TABLE_PREFIX % table.name) %
+                      " (" % delta::KEY_COLUMN % " text)");
+      SqlQuery deleteInsert(deltaDb);
+      deleteInsert.prepare("insert into " % delta::quoted(delta::DELETE_TABLE_PREFIX % table.name) % " values(?)");
+      for(const QString& key : std::as_const(deletedKeys))
+      {
+        deleteInsert.bindValue(0, key);
+        deleteInsert.exec();
+      }
+
+      // Write inserted and changed rows in row id order to keep the order of positional keys =================
+      QStringList columns({delta::KEY_COLUMN}), placeholders({"?"});
+      for(const QString& column : table.columns)
+      {
+        columns.append(delta::quoted(column));
+        placeholders.append("?");
+      }
+      deltaQuery.exec("create table " % delta::quoted(delta::ROW_TABLE_PREFIX % table.name) % " (" % columns.join(", ") % ")");
+
+      SqlQuery rowInsert(deltaDb);
+      rowInsert.prepare("insert into " % delta::quoted(delta::ROW_TABLE_PREFIX % table.name) %
+                        " values(" % placeholders.join(", ") % ")");
+
+      SqlQuery query(newDb);
+      query.setForwardOnly(true);
+      query.exec(delta::selectStatement(table));
+      while(query.next())
+      {
+        auto it = changedRows.constFind(query.value(0).toLongLong());
+        if(it != changedRows.constEnd())
+        {
+          QVariantList values = delta::readValues(table, query, newKeys);
+          rowInsert.bindValue(0, it.value());
+          for(int i = 0; i < values.size(); i++)
+            rowInsert.bindValue(i + 1, values.at(i));
+          rowInsert.exec();
+        }
+      }
+    }
+
+    deltaDb.commit();
+    return deltaStats;
+  });
+
+  qDebug() << Q_FUNC_INFO << deltaFilename << stats << "in" << timer.elapsed() << "ms";
+  return stats;
+}
+
+DatabaseDeltaStats DatabaseDelta::applyDelta(SqlDatabase& db, const QString& deltaFilename)
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  DatabaseDeltaStats stats = delta::withDatabase(deltaFilename, {}, true /* readonly */,
+                                                 [&](SqlDatabase& deltaDb) -> DatabaseDeltaStats {
+    DatabaseDeltaStats deltaStats;
+    const QList<delta::Table> tables = readSchema(db);
+
+    // Read delta table list =================
+    QHash<QString, delta::TableInfo> infos;
+    SqlQuery deltaQuery(deltaDb);
+    deltaQuery.exec("select name, old_rows, num_delete, num_row from " % delta::TABLE_TABLE);
+    while(deltaQuery.next())
+      infos.insert(deltaQuery.valueStr(0), {deltaQuery.value(1).toLongLong(), deltaQuery.value(2).toLongLong(),
+                                            deltaQuery.value(3).toLongLong()});
+
+    // Check if delta was created for this database =================
+    if(infos.size() != tables.size())
+      throw Exception(QStringLiteral("Delta \"%1\" has %2 tables but database \"%3\" has %4").
+                      arg(deltaFilename).arg(infos.size()).arg(db.databaseName()).arg(tables.size()));
+
+    SqlUtil util(db);
+    for(const delta::Table& table : tables)
+    {
+      auto it = infos.constFind(table.name);
+      if(it == infos.constEnd())
+        throw Exception(QStringLiteral("Table \"%1\" not found in delta \"%2\"").arg(table.name).arg(deltaFilename));
+
+      qint64 rows = util.rowCount(table.name);
+      if(rows != it->oldRows)
+        throw Exception(QStringLiteral("Table \"%1\" has %2 rows but delta \"%3\" expects %4").
+                        arg(table.name).arg(rows).arg(deltaFilename).arg(it->oldRows));
+
+      if(it->numRow > 0)
+      {
+        QStringList columns;
+        deltaQuery.exec("pragma table_info(" % delta::quoted(delta::ROW_TABLE_PREFIX % table.name) % ")");
+        while(deltaQuery.next())
+          columns.append(deltaQuery.valueStr(1));
+
+        if(columns != QStringList({delta::KEY_COLUMN}) + table.columns)
+          throw Exception(QStringLiteral("Columns of table \"%1\" differ in delta \"%2\"").arg(table.name).arg(deltaFilename));
+      }
+    }
+
+    // Collect changed tables and tables referenced by these. Referenced tables come first in the list. =================
+    QSet<QString> needed;
+    QList<delta::Table> neededTables;
+    for(auto it = tables.crbegin(); it != tables.crend(); ++it)
+    {
+      const delta::TableInfo& info = infos.value(it->name);
+      if(info.numDelete > 0 || info.numRow > 0)
+        deltaStats.tables++;
+
+      if(info.numDelete > 0 || info.numRow > 0 || needed.contains(it->name))
+      {
+        needed.insert(it->name);
+        neededTables.prepend(*it);
+        for(const QString& name : it->referencedTables())
+          needed.insert(name);
+      }
+    }
+
+    const QSet<QString> referenced = delta::referencedTables(neededTables);
+    QHash<QString, delta::Keys> keys;
+    for(const delta::Table& table : std::as_const(neededTables))
+      readKeys(db, table, keys, referenced.contains(table.name));
+
+    try
+    {
+      // Delete in reverse order =================
+      for(auto it = neededTables.crbegin(); it != neededTables.crend(); ++it)
+      {
+        if(infos.value(it->name).numDelete == 0)
+          continue;
+
+        delta::Keys& tableKeys = keys[it->name];
+        SqlQuery deleteQuery(db);
+        deleteQuery.prepare("delete from " % delta::quoted(it->name) % " where rowid = ?");
+
+        deltaQuery.exec("select " % delta::KEY_COLUMN % " from " % delta::quoted(delta::DELETE_TABLE_PREFIX % it->name));
+        while(deltaQuery.next())
+        {
+          auto rowIt = tableKeys.rows.find(deltaQuery.valueStr(0));
+          if(rowIt == tableKeys.rows.end())
+            throw Exception(QStringLiteral("Deleted row not found in table \"%1\"").arg(it->name));
+
+          deleteQuery.bindValue(0, rowIt->id);
+          deleteQuery.exec();
+          tableKeys.keyById.remove(rowIt->id);
+          tableKeys.rows.erase(rowIt);
+          deltaStats.deleted++;
+        }
+      }
+
+      // Update and insert in dependency order so that referenced rows exist =================
+      for(const delta::Table& table : std::as_const(neededTables))
+      {
+        if(infos.value(table.name).numRow == 0)
+          continue;
+
+        QStringList columns, placeholders, assignments;
+        for(const QString& column : table.columns)
+        {
+          columns.append(delta::quoted(column));
+          placeholders.append("?");
+          assignments.append(delta::quoted(column) % " = ?");
+        }
+
+        SqlQuery insertQuery(db);
+        insertQuery.prepare("insert into " % delta::quoted(table.name) % " (" % columns.join(", ") % ") values(" %
+                            placeholders.join(", ") % ")");
+        SqlQuery updateQuery(db);
+        updateQuery.prepare("update " % delta::quoted(table.name) % " set " % assignments.join(", ") % " where rowid = ?");
+
+        delta::Keys& tableKeys = keys[table.name];
+        deltaQuery.exec("select * from " % delta::quoted(delta::ROW_TABLE_PREFIX % table.name) % " order by rowid");
+        while(deltaQuery.next())
+        {
+          QString key = deltaQuery.valueStr(0);
+          QVariantList values;
+          values.reserve(table.columns.size());
+          for(int i = 0; i < table.columns.size(); i++)
+            values.append(deltaQuery.value(i + 1));
+
+          // Resolve keys of referenced rows to ids - only null stays null
+          for(auto it = table.foreignKeys.constBegin(); it != table.foreignKeys.constEnd(); ++it)
+          {
+            QVariant& value = values[it.key()];
+            if(!value.isNull())
+            {
+              QString referencedTable = it.value().referencedTable(values);
+              auto keysIt = keys.constFind(referencedTable);
+              if(keysIt == keys.constEnd())
+                throw Exception(QStringLiteral("No referenced table for column \"%1.%2\" in delta \"%3\"").
+                                arg(table.name).arg(table.columns.at(it.key())).arg(deltaFilename));
+
+              auto rowIt = keysIt->rows.constFind(value.toString());
+              if(rowIt == keysIt->rows.constEnd())
+                throw Exception(QStringLiteral("Row \"%1\" in table \"%2\" referenced by column \"%3.%4\" not found "
+                                               "when applying delta \"%5\"").
+                                arg(value.toString()).arg(referencedTable).arg(table.name).
+                                arg(table.columns.at(it.key())).arg(deltaFilename));
+              value = rowIt->id;
+            }
+          }
+
+          auto rowIt = tableKeys.rows.constFind(key);
+          SqlQuery& query = rowIt != tableKeys.rows.constEnd() ? updateQuery : insertQuery;
+          for(int i = 0; i < values.size(); i++)
+            query.bindValue(i, values.at(i));
+
+          if(rowIt != tableKeys.rows.constEnd())
+          {
+            updateQuery.bindValue(static_cast<int>(values.size()), rowIt->id);
+            updateQuery.exec();
+            deltaStats.updated++;
+          }
+          else
+          {
+            insertQuery.exec();
+            qint64 id = insertQuery.lastInsertId().toLongLong();
+            tableKeys.rows.insert(key, {id, QByteArray()});
+            if(referenced.contains(table.name))
+              tableKeys.keyById.insert(id, key);
+            deltaStats.inserted++;
+          }
+        }
+      }
+
+      if(deltaStats.tables > 0)
+        delta::rebuildFullTextSearch(db);
+
+      db.commit();
+    }
+    catch(...)
+    {
+      db.rollback();
+      throw;
+    }
+
+    return deltaStats;
+  });
+
+  qDebug() << Q_FUNC_INFO << deltaFilename << stats << "in" << timer.elapsed() << "ms";
+  return stats;
+}
+
+DatabaseDeltaStats DatabaseDelta::createDeltaFile(const QString& oldFilename, const QString& newFilename,
+                                                  const QString& deltaFilename)
+{
+  return delta::withDatabase(oldFilename, {}, true /* readonly */, [&](SqlDatabase& oldDb) -> DatabaseDeltaStats {
+    return delta::withDatabase(newFilename, {}, true /* readonly */, [&](SqlDatabase& newDb) -> DatabaseDeltaStats {
+      return DatabaseDelta().createDelta(oldDb, newDb, deltaFilename);
+    });
+  });
+}
+
+DatabaseDeltaStats DatabaseDelta::applyDeltaFile(const QString& filename, const QString& deltaFilename)
+{
+  return delta::withDatabase(filename, {}, false, [&](SqlDatabase& db) -> DatabaseDeltaStats {
+    return DatabaseDelta().applyDelta(db, deltaFilename);
+  });
+}
+
+QDebug operator<<(QDebug out, const DatabaseDeltaStats& stats)
+{
+  QDebugStateSaver saver(out);
+  out.noquote().nospace() << "DatabaseDeltaStats[tables " << stats.tables << ", inserted " << stats.inserted
+                          << ", updated " << stats.updated << ", deleted " << stats.deleted << "]";
+  return out;
+}
+
+} // namespace db
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,126 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_DB_DATABASEDELTA_H
+#define ATOOLS_FS_DB_DATABASEDELTA_H
+
+#include <QHash>
+#include <QStringList>
+
+class QDebug;
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+}
+
+namespace fs {
+namespace db {
+
+namespace delta {
+struct Table;
+struct Keys;
+}
+
+/* Number of changed rows in a delta */
+struct DatabaseDeltaStats
+{
+  qint64 inserted = 0, updated = 0, deleted = 0;
+
+  /* Number of tables having changes */
+  int tables = 0;
+};
+
+QDebug operator<<(QDebug out, const atools::fs::db::DatabaseDeltaStats& stats);
+
+/*
+ * Computes a row level delta between two compiled navigation databases of the same schema, for example two
+ * AIRAC cycles, and applies it in place to a copy of the older database. Avoids distributing the whole database.
+ *
+ * Rows are identified by natural keys like ident and region since ids differ between compilations.
+ * Foreign keys are read from the schema and from undeclared or type dependent keys like waypoint.nav_id. They are saved as the
+ * natural key of the referenced row in the delta and resolved to ids of the target database when applying.
+ *
+ * Rows with equal key are matched in id order. This keeps the order of legs and runways which are keyed by parent.
+ * Tables without natural key use the row content as key. Changed rows are deleted and inserted for these.
+ * Applying fails if a referenced row cannot be found in the target database.
+ *
+ * The delta is an SQLite file with the table "delta_table" containing all tables and row counts of the old database
+ * and tables "delta_delete_<table>" and "delta_row_<table>" for each changed table.
+ * External content full text search tables are rebuilt after applying.
+ *
+ * All methods throw Exception or SqlException on error.
+ */
+class DatabaseDelta
+{
+public:
+  /* Uses natural keys for the navigation database schema */
+  DatabaseDelta();
+  ~DatabaseDelta();
+
+  DatabaseDelta(const DatabaseDelta& other) = delete;
+  DatabaseDelta& operator=(const DatabaseDelta& other) = delete;
+
+  /* Set natural key columns for table. Foreign key columns are allowed. Empty list uses the row content as key. */
+  void setNaturalKey(const QString& table, const QStringList& columns);
+
+  /* Add foreign key which is not declared in the schema */
+  void addForeignKey(const QString& table, const QString& column, const QString& referencedTable);
+
+  /* Add foreign key where the referenced table depends on the value of typeColumn. Types not in tablesByType
+   * are saved as null. */
+  void addTypedForeignKey(const QString& table, const QString& column, const QString& typeColumn,
+                          const QHash<QString, QString>& tablesByType);
+
+  /* Compare both databases and write differences to a new SQLite file. Databases are not modified. */
+  DatabaseDeltaStats createDelta(atools::sql::SqlDatabase& oldDb, atools::sql::SqlDatabase& newDb, const QString& deltaFilename);
+
+  /* Apply delta to a database which has to be equal to the old database used in createDelta().
+   * Commits on success and rolls back on error. */
+  DatabaseDeltaStats applyDelta(atools::sql::SqlDatabase& db, const QString& deltaFilename);
+
+  /* Same as above but opens and closes the database files */
+  static DatabaseDeltaStats createDeltaFile(const QString& oldFilename, const QString& newFilename, const QString& deltaFilename);
+  static DatabaseDeltaStats applyDeltaFile(const QString& filename, const QString& deltaFilename);
+
+private:
+  /* Foreign key depending on a type column */
+  struct TypedForeignKey
+  {
+    QString column, typeColumn;
+    QHash<QString, QString> tablesByType;
+  };
+
+  /* Read tables in dependency order. Referenced tables come first. */
+  QList<delta::Table> readSchema(atools::sql::SqlDatabase& db) const;
+
+  /* Read keys and content hashes of all rows in table. Foreign keys of referenced tables have to be read before. */
+  void readKeys(atools::sql::SqlDatabase& db, const delta::Table& table, QHash<QString, delta::Keys>& keys,
+                bool keyById) const;
+
+  QHash<QString, QStringList> naturalKeys;
+  QHash<QString, QList<TypedForeignKey> > typedForeignKeys;
+
+  /* Table name to column and referenced table */
+  QHash<QString, QHash<QString, QString> > undeclaredForeignKeys;
+};
+
+} // namespace db
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_DB_DATABASEDELTA_H
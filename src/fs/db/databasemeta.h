@@ -33,6 +33,13 @@ namespace fs {
 namespace db {
 
 const static QLatin1String PROPERTYNAME_MSFS_NAVIGRAPH_FOUND("NavigraphUpdate");
+
+/* Storage statistics saved at the end of the compilation */
+const static QLatin1String PROPERTYNAME_DB_PAGE_SIZE("PageSize");
+const static QLatin1String PROPERTYNAME_DB_PAGE_COUNT("PageCount");
+const static QLatin1String PROPERTYNAME_DB_FREE_PAGES("FreePages");
+const static QLatin1String PROPERTYNAME_DB_COMPACT_PAGE_SIZE("CompactPageSize");
+const static QLatin1String PROPERTYNAME_DB_ANALYZE_TIMESTAMP("AnalyzeTimestamp");
 /*
  * Maintains versions and load time for a navdatabases
  */
@@ -280,11 +287,17 @@ private:
    *    Tables "airport_medium", "airport_large", "route_node_radio", "route_edge_radio", "route_node_airway" and
    *    "route_edge_airway" removed for good.
    *    View creation now disabled.
+   * 30 Added indexed column "cell_id" with hierarchical quad tree cell id to tables "airport", "waypoint", "vor", "ndb"
+   *    and "ils".
+   *    Column "apron.vertices2" contains the Apron2 vertices instead of the outline. Column "apron.triangles" is
+   *    filled. Both contain a simplified and triangulated outline if the Apron2 record has no triangles.
+   *    Added column "min_zoom" to tables "airport", "waypoint", "vor" and "ndb" and indexes on "cell_id" and
+   *    "min_zoom".
    *
    *
    * VERSION_NUMBER_TODO update database version
    */
-  static const int DB_VERSION_MINOR = 29;
+  static const int DB_VERSION_MINOR = 30;
 
   /* Additionally checking for last schema change using minor version to avoid user. Usually version of last version change. */
   static const int DB_VERSION_MINOR_OUTDATED = 24;
@@ -56,12 +56,19 @@
 #include "fs/scenery/fileresolver.h"
 #include "fs/db/meta/sceneryareawriter.h"
 #include "atools.h"
+#include "fs/common/magdecgrid.h"
 #include "fs/common/magdecreader.h"
 #include "settings/settings.h"
 #include "exception.h"
 
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QFileInfo>
+#include <QMutex>
+#include <QScopedPointer>
+#include <QThread>
+#include <QThreadPool>
+#include <QWaitCondition>
 
 namespace atools {
 namespace fs {
@@ -80,6 +87,11 @@ static const QSet<atools::fs::bgl::section::SectionType> SUPPORTED_SECTION_TYPES
   bgl::section::P3D_TACAN // , bgl::section::MSFS_DELETE_AIRPORT_NAV, bgl::section::MSFS_DELETE_NAV
 };
 
+const QSet<SectionType>& DataWriter::getSupportedSectionTypes()
+{
+  return SUPPORTED_SECTION_TYPES;
+}
+
 DataWriter::DataWriter(SqlDatabase& sqlDb, const NavDatabaseOptions& opts, atools::fs::ProgressHandler *progress)
   : db(sqlDb), progressHandler(progress), options(opts)
 {
@@ -116,6 +128,26 @@ DataWriter::DataWriter(SqlDatabase& sqlDb, const NavDatabaseOptions& opts, atool
 
   runwayIndex = new RunwayIndex();
   magDecReader = new MagDecReader();
+  magDecGrid = new atools::fs::common::MagDecGrid();
+
+  // Tables which are not read while writing can use multi row inserts. Flushed after each airport and file.
+  if(options.getInsertBatchSize() > 1)
+  {
+    for(WriterBaseBasic *writer : batchWriters())
+      writer->setBatchSize(options.getInsertBatchSize());
+  }
+}
+
+QList<WriterBaseBasic *> DataWriter::batchWriters() const
+{
+  return {approachLegWriter, approachTransLegWriter, sidStarApproachLegWriter, sidStarTransLegWriter, parkingWriter,
+          airportTaxiPathWriter};
+}
+
+void DataWriter::flushBatches()
+{
+  for(WriterBaseBasic *writer : batchWriters())
+    writer->flush();
 }
 
 DataWriter::~DataWriter()
@@ -155,13 +187,18 @@ void DataWriter::close()
   ATOOLS_DELETE(boundaryWriter);
   ATOOLS_DELETE(runwayIndex);
   ATOOLS_DELETE(magDecReader);
+  ATOOLS_DELETE(magDecGrid);
+
+  if(countryUpdater != nullptr && countryUpdater->getNumCalls() > 0)
+    progressHandler->addPhaseTime(tr("Updating airport countries"), countryUpdater->getElapsedMs(), 0,
+                                  countryUpdater->getNumCalls());
   ATOOLS_DELETE(countryUpdater);
 }
 
 float DataWriter::getMagVar(const geo::Pos& pos, float defaultValue) const
 {
-  if(magDecReader->isValid())
-    return magDecReader->getMagVar(pos);
+  if(magDecGrid->isValid())
+    return magDecGrid->getMagVar(pos);
   else
     return defaultValue;
 }
@@ -204,12 +241,22 @@ QString DataWriter::getLanguage(const QString& key)
     return key;
 }
 
+/* Result of parsing a BGL file in a worker thread */
+struct BglParseResult
+{
+  BglFile *bglFile = nullptr;
+  QString errorMessage;
+  qint64 elapsedMs = 0;
+  bool error = false, done = false;
+};
+
 void DataWriter::writeSceneryArea(const SceneryArea& area)
 {
   QStringList filepaths, filenames;
 
   // Get all BGL files in this scenery area
   atools::fs::scenery::FileResolver resolver(options);
+  resolver.setCache(sceneryFileCache);
   resolver.getFiles(area, &filepaths, &filenames);
 
   if(sceneryErrors != nullptr)
@@ -221,8 +268,81 @@ void DataWriter::writeSceneryArea(const SceneryArea& area)
     // Write the scenery area metadata
     sceneryAreaWriter->writeOne(area);
 
-    for(int i = 0; i < filepaths.size(); i++)
+    // Files are parsed by worker threads ahead of this thread which writes them in the original
+    // order to keep the layering and delete semantics
+    int numFilepaths = static_cast<int>(filepaths.size());
+    int numThreads = options.getNumParserThreads() > 0 ? options.getNumParserThreads() : QThread::idealThreadCount();
+    numThreads = std::max(1, std::min(numThreads, numFilepaths));
+
+    // Limit number of parsed files waiting in memory
+    int maxAhead = numThreads * 2;
+
+    QList<BglParseResult> results(numFilepaths);
+
+    // Get pointer before starting threads to avoid any detach
+    BglParseResult *resultData = results.data();
+
+    QMutex mutex;
+    QWaitCondition parsedCondition;
+    QAtomicInt cancel(0);
+    QThreadPool pool;
+    pool.setMaxThreadCount(numThreads);
+
+    // Read all records into a internal object tree (atools::fs::bgl namespace)
+    auto parseFile = [this, &area, &filepaths](int index) -> BglParseResult {
+      BglParseResult result;
+      QElapsedTimer timer;
+      timer.start();
+      result.bglFile = new BglFile(&options);
+      try
+      {
+        result.bglFile->setSupportedSectionTypes(SUPPORTED_SECTION_TYPES);
+        result.bglFile->setStringPool(&namePool);
+        result.bglFile->readFile(filepaths.at(index), area);
+      }
+      catch(atools::Exception& e)
+      {
+        result.error = true;
+        result.errorMessage = e.what();
+      }
+      catch(...)
+      {
+        result.error = true;
+      }
+
+      if(result.error)
+      {
+        delete result.bglFile;
+        result.bglFile = nullptr;
+      }
+      result.elapsedMs = timer.elapsed();
+      result.done = true;
+      return result;
+    };
+
+    auto startParse = [&pool, &mutex, &parsedCondition, &cancel, &parseFile, resultData](int index) -> void {
+      pool.start([&mutex, &parsedCondition, &cancel, &parseFile, resultData, index]() -> void {
+        BglParseResult result;
+        if(cancel.loadRelaxed() == 0)
+          result = parseFile(index);
+        result.done = true;
+
+        QMutexLocker locker(&mutex);
+        resultData[index] = result;
+        parsedCondition.wakeAll();
+      });
+    };
+
+    int nextParse = 0;
+    for(int i = 0; i < numFilepaths; i++)
     {
+      // Keep workers busy
+      if(numThreads > 1)
+      {
+        while(nextParse < numFilepaths && nextParse <= i + maxAhead)
+          startParse(nextParse++);
+      }
+
       progressHandler->setNumFiles(numFiles);
 
       // Do not reset airport counter which was read before from MSFS 2024 SimConnect
@@ -235,123 +355,169 @@ void DataWriter::writeSceneryArea(const SceneryArea& area)
       progressHandler->setNumBoundaries(numBoundaries);
       progressHandler->setNumWaypoints(numWaypoints);
       progressHandler->setNumObjectsWritten(numObjectsWritten);
+      progressHandler->setNumBytesSkipped(numBytesSkipped);
 
       QString currentBglFilePath = filepaths.at(i);
 
       if((aborted = progressHandler->reportBglFile(currentBglFilePath)) == true)
+      {
+        // Stop workers and delete all files parsed ahead
+        cancel.storeRelaxed(1);
+        pool.waitForDone();
+        for(int j = i; j < numFilepaths; j++)
+          delete resultData[j].bglFile;
         return;
+      }
 
-      try
+      // Wait for worker or parse in this thread
+      BglParseResult result;
+      if(numThreads > 1)
       {
-        // ================================================================================
-        // Read all records into a internal object tree (atools::fs::bgl namespace)
-        BglFile bglFile(&options);
-        bglFile.setSupportedSectionTypes(SUPPORTED_SECTION_TYPES);
-        bglFile.readFile(currentBglFilePath, area);
-
-        if(bglFile.hasContent() && bglFile.isValid())
-        {
-          // ================================================================================
-          // Write to the database
-
-          // if(!bglFile.getHeader().hasValidMagicNumber())
-          // qWarning() << "Content in file with invalid magic number";
-
-          // Write BGL file metadata
-          bglFileWriter->writeOne(bglFile);
-
-          // Clear the indexes
-          runwayIndex->clear();
-
-          // Execution order is important due to dependencies between the writers
-          // (i.e. ILS writer looks for runway end ids)
-          // Writer also need to access the ids of their parent record objects
-          // (i.e. runway needs the current airport ID
-
-          airportWriter->setNameLists(bglFile.getNamelists());
-
-          // Write airport and all subrecords like runways, approaches, parking and so on
-          airportWriter->write(bglFile.getAirports());
-
-          airportFileWriter->write(bglFile.getAirports());
-
-          // Ignore navaids from the Navigraph update
-          if(!area.isMsfsNavigraphNavdata() && options.isIncludedNavDbObject(type::NAVAIDS))
-          {
-            // Write all navaids to the database
-            waypointWriter->write(bglFile.getWaypoints());
-            vorWriter->write(bglFile.getVors());
-            tacanWriter->write(bglFile.getTacans());
-            ndbWriter->write(bglFile.getNdbs());
-            markerWriter->write(bglFile.getMarker());
-          }
-
-          ilsWriter->write(bglFile.getIls());
-
-          if(!area.isMsfsNavigraphNavdata())
-            // Ignore boundaries from the Navigraph update
-            boundaryWriter->write(bglFile.getBoundaries());
-
-          for(const atools::fs::bgl::Airport *ap : bglFile.getAirports())
-            airportIdents.insert(ap->getIdent());
-
-          numNamelists += bglFile.getNamelists().size();
-
-          // Ignore navaids from the Navigraph update
-          if(!area.isMsfsNavigraphNavdata())
-          {
-            numVors += bglFile.getVors().size() + bglFile.getTacans().size();
-            numNdbs += bglFile.getNdbs().size();
-            numMarker += bglFile.getMarker().size();
-            numWaypoints += bglFile.getWaypoints().size();
-            numBoundaries += bglFile.getBoundaries().size();
-          }
-          numIls += bglFile.getIls().size();
-          numFiles++;
-        }
-
-        // Print a one line short report on airports that were found in the BGL
-        if(!bglFile.getAirports().isEmpty())
-        {
-          QStringList apIcaos;
-#ifdef DEBUG_INFORMATION
-          for(const atools::fs::bgl::Airport *ap : bglFile.getAirports())
-            apIcaos.append(ap->getIdent());
-#else
-          for(const atools::fs::bgl::Airport *ap : bglFile.getAirports())
-          {
-            // Truncate at 20
-            if(apIcaos.size() < 20)
-              apIcaos.append(ap->getIdent());
-            else
-              break;
-          }
-          if(bglFile.getAirports().size() > 20)
-            apIcaos.append("...");
-#endif
+        QMutexLocker locker(&mutex);
+        while(!resultData[i].done)
+          parsedCondition.wait(&mutex);
+        result = resultData[i];
+        resultData[i].bglFile = nullptr;
+      }
+      else
+        result = parseFile(i);
 
-          qDebug() << "Found" << bglFile.getAirports().size() << "airports. idents:" << apIcaos.join(",");
-        }
+      QScopedPointer<BglFile> bglFile(result.bglFile);
+      if(result.error)
+      {
+        reportBglFileError(currentBglFilePath, result.errorMessage);
+        continue;
+      }
+
+      progressHandler->addPhaseTime(tr("Parsing BGL files"), result.elapsedMs,
+                                    bglFile->getFilesize() - bglFile->getBytesSkipped());
+
+      try
+      {
+        QElapsedTimer timer;
+        timer.start();
+        int objectsWritten = numObjectsWritten;
+        writeBglFile(*bglFile, area);
+        progressHandler->addPhaseTime(tr("Writing BGL records"), timer.elapsed(), 0, numObjectsWritten - objectsWritten);
       }
       catch(atools::Exception& e)
       {
-        qCritical() << "Caught exception reading" << currentBglFilePath << ":" << e.what();
-        progressHandler->reportError();
-        if(sceneryErrors != nullptr)
-          sceneryErrors->appendFileError(SceneryFileError(currentBglFilePath, QString(e.what())));
+        reportBglFileError(currentBglFilePath, e.what());
       }
       catch(...)
       {
-        qCritical() << "Caught unknown exception reading" << currentBglFilePath;
-        progressHandler->reportError();
-        if(sceneryErrors != nullptr)
-          sceneryErrors->appendFileError(SceneryFileError(currentBglFilePath, QStringLiteral()));
+        reportBglFileError(currentBglFilePath, QStringLiteral());
       }
     }
+    flushBatches();
+
+    // Delete previous airports replaced in this area
+    airportWriter->flushDeletes();
     db.commit();
   }
 }
 
+void DataWriter::reportBglFileError(const QString& filepath, const QString& message)
+{
+  if(message.isEmpty())
+    qCritical() << "Caught unknown exception reading" << filepath;
+  else
+    qCritical() << "Caught exception reading" << filepath << ":" << message;
+
+  progressHandler->reportError();
+  if(sceneryErrors != nullptr)
+    sceneryErrors->appendFileError(SceneryFileError(filepath, message));
+}
+
+void DataWriter::writeBglFile(const BglFile& bglFile, const SceneryArea& area)
+{
+  numBytesSkipped += bglFile.getBytesSkipped();
+
+  if(bglFile.hasContent() && bglFile.isValid())
+  {
+    // ================================================================================
+    // Write to the database
+
+    // if(!bglFile.getHeader().hasValidMagicNumber())
+    // qWarning() << "Content in file with invalid magic number";
+
+    // Write BGL file metadata
+    bglFileWriter->writeOne(bglFile);
+
+    // Clear the indexes
+    runwayIndex->clear();
+
+    // Execution order is important due to dependencies between the writers
+    // (i.e. ILS writer looks for runway end ids)
+    // Writer also need to access the ids of their parent record objects
+    // (i.e. runway needs the current airport ID
+
+    airportWriter->setNameLists(bglFile.getNamelists());
+
+    // Write airport and all subrecords like runways, approaches, parking and so on
+    airportWriter->write(bglFile.getAirports());
+
+    airportFileWriter->write(bglFile.getAirports());
+
+    // Ignore navaids from the Navigraph update
+    if(!area.isMsfsNavigraphNavdata() && options.isIncludedNavDbObject(type::NAVAIDS))
+    {
+      // Write all navaids to the database
+      waypointWriter->write(bglFile.getWaypoints());
+      vorWriter->write(bglFile.getVors());
+      tacanWriter->write(bglFile.getTacans());
+      ndbWriter->write(bglFile.getNdbs());
+      markerWriter->write(bglFile.getMarker());
+    }
+
+    ilsWriter->write(bglFile.getIls());
+
+    if(!area.isMsfsNavigraphNavdata())
+      // Ignore boundaries from the Navigraph update
+      boundaryWriter->write(bglFile.getBoundaries());
+
+    for(const atools::fs::bgl::Airport *ap : bglFile.getAirports())
+      airportIdents.insert(ap->getIdent());
+
+    numNamelists += bglFile.getNamelists().size();
+
+    // Ignore navaids from the Navigraph update
+    if(!area.isMsfsNavigraphNavdata())
+    {
+      numVors += bglFile.getVors().size() + bglFile.getTacans().size();
+      numNdbs += bglFile.getNdbs().size();
+      numMarker += bglFile.getMarker().size();
+      numWaypoints += bglFile.getWaypoints().size();
+      numBoundaries += bglFile.getBoundaries().size();
+    }
+    numIls += bglFile.getIls().size();
+    numFiles++;
+  }
+
+  // Print a one line short report on airports that were found in the BGL
+  if(!bglFile.getAirports().isEmpty())
+  {
+    QStringList apIcaos;
+#ifdef DEBUG_INFORMATION
+    for(const atools::fs::bgl::Airport *ap : bglFile.getAirports())
+      apIcaos.append(ap->getIdent());
+#else
+    for(const atools::fs::bgl::Airport *ap : bglFile.getAirports())
+    {
+      // Truncate at 20
+      if(apIcaos.size() < 20)
+        apIcaos.append(ap->getIdent());
+      else
+        break;
+    }
+    if(bglFile.getAirports().size() > 20)
+      apIcaos.append("...");
+#endif
+
+    qDebug() << "Found" << bglFile.getAirports().size() << "airports. idents:" << apIcaos.join(",");
+  }
+}
+
 void DataWriter::readMagDeclBgl(const QString& fileScenery, bool forceWmm)
 {
   QString file;
@@ -424,6 +590,8 @@ void DataWriter::readMagDeclBgl(const QString& fileScenery, bool forceWmm)
     magDecReader->writeToTable(db);
     db.commit();
   }
+
+  magDecGrid->build(*magDecReader);
 }
 
 void DataWriter::logResults()
@@ -439,6 +607,8 @@ void DataWriter::logResults()
                     << numBoundaries << " boundaries and "
                     << numWaypoints << " waypoints.";
   qInfo().nospace() << "Wrote " << numObjectsWritten << " objects.";
+  qInfo().nospace() << "Skipped " << numBytesSkipped << " bytes of records in filtered sections.";
+  qInfo().nospace() << "Interned " << namePool.size() << " distinct name list strings.";
 }
 
 } // namespace writer
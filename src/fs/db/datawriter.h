@@ -18,7 +18,9 @@
 #ifndef ATOOLS_FS_DB_DATAWRITER_H
 #define ATOOLS_FS_DB_DATAWRITER_H
 
+#include "fs/bgl/sectiontype.h"
 #include "fs/navdatabaseerrors.h"
+#include "util/stringpool.h"
 
 #include <QList>
 #include <QSet>
@@ -36,12 +38,17 @@ namespace fs {
 class NavDatabaseOptions;
 class NavDatabaseErrors;
 namespace common {
+class MagDecGrid;
 class MagDecReader;
 }
+namespace bgl {
+class BglFile;
+}
 namespace scenery {
 class SceneryArea;
 class LanguageJson;
 class MaterialLib;
+class SceneryFileCache;
 }
 class ProgressHandler;
 
@@ -78,9 +85,14 @@ class RunwayIndex;
 class ApronWriter;
 class TaxiPathWriter;
 class BoundaryWriter;
+class WriterBaseBasic;
 
 /*
  * Keeps all writer objects and calls them in order to write BGL records to the database.
+ *
+ * BGL files are parsed in parallel but written on one connection in scenery order. Writing cannot be split into
+ * separate databases since delete processing for add-on airports queries and modifies records written by
+ * previous files and scenery areas in the same database.
  */
 class DataWriter
 {
@@ -101,6 +113,9 @@ public:
 
   void readMagDeclBgl(const QString& fileScenery, bool forceWmm = false);
 
+  /* BGL section types which are read by the writer */
+  static const QSet<atools::fs::bgl::section::SectionType>& getSupportedSectionTypes();
+
   /*
    * Log written record number, etc. to the log/console.
    */
@@ -258,6 +273,9 @@ public:
     sceneryErrors = errors;
   }
 
+  /* Insert all rows collected by writers using multi row inserts */
+  void flushBatches();
+
   /* Close all writers and queries */
   void close();
 
@@ -287,6 +305,12 @@ public:
     materialLibScenery = value;
   }
 
+  /* Cache for directory listings used when collecting the files of a scenery area. Not owned. */
+  void setSceneryFileCache(atools::fs::scenery::SceneryFileCache *value)
+  {
+    sceneryFileCache = value;
+  }
+
   atools::sql::SqlDatabase& getDatabase() const
   {
     return db;
@@ -302,8 +326,18 @@ public:
   }
 
 private:
+  /* Write all objects of a parsed BGL file to the database */
+  void writeBglFile(const atools::fs::bgl::BglFile& bglFile, const atools::fs::scenery::SceneryArea& area);
+
+  /* Writers for tables which are never read while loading and can use batched inserts */
+  QList<atools::fs::db::WriterBaseBasic *> batchWriters() const;
+
+  /* Log and collect error for file. Empty message for unknown exceptions. */
+  void reportBglFileError(const QString& filepath, const QString& message);
+
   int numFiles = 0, numNamelists = 0, numVors = 0, numIls = 0,
       numNdbs = 0, numMarker = 0, numWaypoints = 0, numBoundaries = 0, numObjectsWritten = 0;
+  qint64 numBytesSkipped = 0;
   bool aborted = false;
 
   QSet<QString> airportIdents;
@@ -349,11 +383,17 @@ private:
 
   atools::fs::db::RunwayIndex *runwayIndex = nullptr;
   atools::fs::common::MagDecReader *magDecReader = nullptr;
+  atools::fs::common::MagDecGrid *magDecGrid = nullptr; /* Sampled from magDecReader for fast lookups */
   atools::fs::db::CountryUpdater *countryUpdater = nullptr;
 
   const atools::fs::NavDatabaseOptions& options;
   const atools::fs::scenery::LanguageJson *languageIndex = nullptr;
   const atools::fs::scenery::MaterialLib *materialLib = nullptr, *materialLibScenery = nullptr;
+  atools::fs::scenery::SceneryFileCache *sceneryFileCache = nullptr;
+
+  /* Airport, city, state and country names from name lists shared by all BGL files of the compilation.
+   * Filled by parser threads. */
+  atools::util::StringPool namePool;
 };
 
 } // namespace writer
@@ -81,8 +81,10 @@ void BoundaryWriter::writeObject(const Boundary *type)
   bind(QStringLiteral(":min_lonx"), type->getMinPosition().getLonX());
   bind(QStringLiteral(":min_laty"), type->getMinPosition().getLatY());
 
+  using atools::fs::common::BinaryGeometry;
   bind(QStringLiteral(":geometry"),
-       atools::fs::common::BinaryGeometry(atools::fs::util::correctBoundary(fetchAirspaceLines(type))).writeToByteArray());
+       BinaryGeometry(atools::fs::util::correctBoundary(fetchAirspaceLines(type))).
+       writeToByteArray(getOptions().isCompactGeometry() ? BinaryGeometry::DELTA_ZLIB : BinaryGeometry::FLOAT));
   executeStatement();
 }
 
@@ -0,0 +1,503 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/db/navsnapshotwriter.h"
+
+#include "sql/sqlcursor.h"
+#include "sql/sqldatabase.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QSaveFile>
+#include <QtEndian>
+
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+using atools::sql::SqlCursor;
+using namespace atools::fs::common::snapshot;
+
+namespace atools {
+namespace fs {
+namespace db {
+
+/* Clamp value to unsigned 16 bit range */
+static quint16 toUInt16(int value)
+{
+  return static_cast<quint16>(std::clamp(value, 0, 65535));
+}
+
+NavSnapshotWriter::NavSnapshotWriter(sql::SqlDatabase& sqlDb)
+  : db(sqlDb)
+{
+}
+
+quint32 NavSnapshotWriter::string(const QString& str)
+{
+  if(str.isEmpty())
+    return 0;
+
+  QByteArray utf8 = str.toUtf8();
+  auto it = stringOffsets.constFind(utf8);
+  if(it != stringOffsets.constEnd())
+    return it.value();
+
+  quint32 offset = static_cast<quint32>(strings.size());
+  strings.append(utf8).append('\0');
+  stringOffsets.insert(utf8, offset);
+  return offset;
+}
+
+void NavSnapshotWriter::readAirports()
+{
+  SqlCursor cursor("select airport_id, ident, icao, iata, name, lonx, laty, mag_var, altitude, longest_runway_length, "
+                   "rating, is_closed, is_military, is_addon, num_runway_hard, num_runway_soft, num_runway_water, "
+                   "num_helipad, is_3d from airport", &db);
+
+  int idCol = cursor.column("airport_id"), identCol = cursor.column("ident"), icaoCol = cursor.column("icao"),
+      iataCol = cursor.column("iata"), nameCol = cursor.column("name"), lonxCol = cursor.column("lonx"),
+      latyCol = cursor.column("laty"), magvarCol = cursor.column("mag_var"), altitudeCol = cursor.column("altitude"),
+      lengthCol = cursor.column("longest_runway_length"), ratingCol = cursor.column("rating"),
+      closedCol = cursor.column("is_closed"), militaryCol = cursor.column("is_military"),
+      addonCol = cursor.column("is_addon"), hardCol = cursor.column("num_runway_hard"),
+      softCol = cursor.column("num_runway_soft"), waterCol = cursor.column("num_runway_water"),
+      helipadCol = cursor.column("num_helipad"), is3dCol = cursor.column("is_3d");
+
+  while(cursor.next())
+  {
+    Airport airport = {};
+    airport.id = cursor.valueInt(idCol);
+    airport.ident = string(cursor.valueStr(identCol));
+    airport.icao = string(cursor.valueStr(icaoCol));
+    airport.iata = string(cursor.valueStr(iataCol));
+    airport.name = string(cursor.valueStr(nameCol));
+    airport.lonx = cursor.valueFloat(lonxCol);
+    airport.laty = cursor.valueFloat(latyCol);
+    airport.magvar = cursor.valueFloat(magvarCol);
+    airport.altitude = cursor.valueInt(altitudeCol);
+    airport.longestRunwayLength = toUInt16(cursor.valueInt(lengthCol));
+    airport.rating = static_cast<quint8>(cursor.valueInt(ratingCol));
+
+    quint8 flags = 0;
+    if(cursor.valueBool(closedCol))
+      flags |= AP_CLOSED;
+    if(cursor.valueBool(militaryCol))
+      flags |= AP_MILITARY;
+    if(cursor.valueBool(addonCol))
+      flags |= AP_ADDON;
+    if(cursor.valueInt(hardCol) > 0)
+      flags |= AP_HARD;
+    if(cursor.valueInt(softCol) > 0)
+      flags |= AP_SOFT;
+    if(cursor.valueInt(waterCol) > 0)
+      flags |= AP_WATER;
+    if(cursor.valueInt(helipadCol) > 0)
+      flags |= AP_HELIPAD;
+    if(cursor.valueBool(is3dCol))
+      flags |= AP_3D;
+    airport.flags = flags;
+
+    airports.append(airport);
+  }
+
+  // Sort by tile to allow access by contiguous ranges
+  const char *str = strings.constData();
+  std::sort(airports.begin(), airports.end(), [str](const Airport& a1, const Airport& a2) -> bool {
+    int t1 = tileIndex(a1.lonx, a1.laty), t2 = tileIndex(a2.lonx, a2.laty);
+    return t1 == t2 ? std::strcmp(str + a1.ident, str + a2.ident) < 0 : t1 < t2;
+  });
+
+  for(int i = 0; i < airports.size(); i++)
+    airportIndexById.insert(airports.at(i).id, i);
+}
+
+void NavSnapshotWriter::readRunways()
+{
+  SqlCursor cursor("select r.runway_id, r.airport_id, p.name as primary_name, s.name as secondary_name, r.surface, "
+                   "r.heading, r.length, r.width, r.primary_lonx, r.primary_laty, r.secondary_lonx, r.secondary_laty, "
+                   "r.altitude "
+                   "from runway r join runway_end p on r.primary_end_id = p.runway_end_id "
+                   "join runway_end s on r.secondary_end_id = s.runway_end_id", &db);
+
+  int idCol = cursor.column("runway_id"), airportIdCol = cursor.column("airport_id"),
+      primaryNameCol = cursor.column("primary_name"), secondaryNameCol = cursor.column("secondary_name"),
+      surfaceCol = cursor.column("surface"), headingCol = cursor.column("heading"), lengthCol = cursor.column("length"),
+      widthCol = cursor.column("width"), primaryLonxCol = cursor.column("primary_lonx"),
+      primaryLatyCol = cursor.column("primary_laty"), secondaryLonxCol = cursor.column("secondary_lonx"),
+      secondaryLatyCol = cursor.column("secondary_laty"), altitudeCol = cursor.column("altitude");
+
+  while(cursor.next())
+  {
+    int airportIndex = airportIndexById.value(cursor.valueInt(airportIdCol), -1);
+    if(airportIndex == -1)
+      continue;
+
+    Runway runway = {};
+    runway.id = cursor.valueInt(idCol);
+    runway.airportIndex = airportIndex;
+    runway.primaryName = string(cursor.valueStr(primaryNameCol));
+    runway.secondaryName = string(cursor.valueStr(secondaryNameCol));
+    runway.surface = string(cursor.valueStr(surfaceCol));
+    runway.heading = cursor.valueFloat(headingCol);
+    runway.length = cursor.valueFloat(lengthCol);
+    runway.width = cursor.valueFloat(widthCol);
+    runway.primaryLonx = cursor.valueFloat(primaryLonxCol);
+    runway.primaryLaty = cursor.valueFloat(primaryLatyCol);
+    runway.secondaryLonx = cursor.valueFloat(secondaryLonxCol);
+    runway.secondaryLaty = cursor.valueFloat(secondaryLatyCol);
+    runway.altitude = cursor.valueInt(altitudeCol);
+    runways.append(runway);
+  }
+
+  // Group by airport and assign ranges
+  std::stable_sort(runways.begin(), runways.end(), [](const Runway& r1, const Runway& r2) -> bool {
+    return r1.airportIndex < r2.airportIndex;
+  });
+
+  for(int i = 0; i < runways.size(); i++)
+  {
+    Airport& airport = airports[runways.at(i).airportIndex];
+    if(airport.numRunways == 0)
+      airport.firstRunway = static_cast<quint32>(i);
+    airport.numRunways++;
+  }
+}
+
+void NavSnapshotWriter::readProcedures()
+{
+  SqlCursor cursor("select approach_id, airport_id, arinc_name, runway_name, type, fix_ident, fix_type, suffix "
+                   "from approach", &db);
+
+  int idCol = cursor.column("approach_id"), airportIdCol = cursor.column("airport_id"),
+      arincNameCol = cursor.column("arinc_name"), runwayNameCol = cursor.column("runway_name"),
+      typeCol = cursor.column("type"), fixIdentCol = cursor.column("fix_ident"), fixTypeCol = cursor.column("fix_type"),
+      suffixCol = cursor.column("suffix");
+
+  while(cursor.next())
+  {
+    int airportIndex = airportIndexById.value(cursor.valueInt(airportIdCol), -1);
+    if(airportIndex == -1)
+      continue;
+
+    Procedure procedure = {};
+    procedure.id = cursor.valueInt(idCol);
+    procedure.airportIndex = airportIndex;
+    procedure.arincName = string(cursor.valueStr(arincNameCol));
+    procedure.runwayName = string(cursor.valueStr(runwayNameCol));
+    procedure.type = string(cursor.valueStr(typeCol));
+    procedure.fixIdent = string(cursor.valueStr(fixIdentCol));
+    procedure.fixType = string(cursor.valueStr(fixTypeCol));
+
+    QString suffix = cursor.valueStr(suffixCol);
+    procedure.suffix = suffix.isEmpty() ? 0 : static_cast<quint8>(suffix.at(0).toLatin1());
+    procedures.append(procedure);
+  }
+
+  std::stable_sort(procedures.begin(), procedures.end(), [](const Procedure& p1, const Procedure& p2) -> bool {
+    return p1.airportIndex < p2.airportIndex;
+  });
+
+  for(int i = 0; i < procedures.size(); i++)
+  {
+    Airport& airport = airports[procedures.at(i).airportIndex];
+    if(airport.numProcedures == 0)
+      airport.firstProcedure = static_cast<quint32>(i);
+    airport.numProcedures++;
+  }
+}
+
+void NavSnapshotWriter::readNavaids()
+{
+  // VOR, NDB and waypoints ========================================================
+  // Column aliases are the same for all three queries
+  const static QList<std::pair<NavaidType, QString> > QUERIES = {
+    {VOR, "select vor_id as id, ident, region, name, type, lonx, laty, mag_var, frequency, 0 as artificial from vor"},
+    {NDB, "select ndb_id as id, ident, region, name, type, lonx, laty, mag_var, frequency, 0 as artificial from ndb"},
+    {WAYPOINT, "select waypoint_id as id, ident, region, name, type, lonx, laty, mag_var, 0 as frequency, "
+               "artificial from waypoint"}
+  };
+
+  for(const std::pair<NavaidType, QString>& query : QUERIES)
+  {
+    SqlCursor cursor(query.second, &db);
+
+    int idCol = cursor.column("id"), identCol = cursor.column("ident"), regionCol = cursor.column("region"),
+        nameCol = cursor.column("name"), typeCol = cursor.column("type"), lonxCol = cursor.column("lonx"),
+        latyCol = cursor.column("laty"), magvarCol = cursor.column("mag_var"), frequencyCol = cursor.column("frequency"),
+        artificialCol = cursor.column("artificial");
+
+    while(cursor.next())
+    {
+      Navaid navaid = {};
+      navaid.id = cursor.valueInt(idCol);
+      navaid.ident = string(cursor.valueStr(identCol));
+      navaid.region = string(cursor.valueStr(regionCol));
+      navaid.name = string(cursor.valueStr(nameCol));
+      navaid.typeName = string(cursor.valueStr(typeCol));
+      navaid.lonx = cursor.valueFloat(lonxCol);
+      navaid.laty = cursor.valueFloat(latyCol);
+      navaid.magvar = cursor.valueFloat(magvarCol);
+      navaid.frequency = cursor.valueInt(frequencyCol);
+      navaid.type = query.first;
+      navaid.artificial = cursor.valueInt(artificialCol) > 0 ? 1 : 0;
+      navaids.append(navaid);
+    }
+  }
+
+  const char *str = strings.constData();
+  std::sort(navaids.begin(), navaids.end(), [str](const Navaid& n1, const Navaid& n2) -> bool {
+    int t1 = tileIndex(n1.lonx, n1.laty), t2 = tileIndex(n2.lonx, n2.laty);
+    return t1 == t2 ? std::strcmp(str + n1.ident, str + n2.ident) < 0 : t1 < t2;
+  });
+
+  // Airways refer to waypoints only
+  for(int i = 0; i < navaids.size(); i++)
+  {
+    if(navaids.at(i).type == WAYPOINT)
+      waypointIndexById.insert(navaids.at(i).id, i);
+  }
+}
+
+void NavSnapshotWriter::readAirways()
+{
+  SqlCursor cursor("select airway_id, airway_name, airway_type, airway_fragment_no, sequence_no, "
+                   "from_waypoint_id, to_waypoint_id, direction, minimum_altitude, maximum_altitude, "
+                   "left_lonx, top_laty, right_lonx, bottom_laty, from_lonx, from_laty, to_lonx, to_laty "
+                   "from airway order by airway_name, airway_fragment_no, sequence_no", &db);
+
+  int idCol = cursor.column("airway_id"), nameCol = cursor.column("airway_name"), typeCol = cursor.column("airway_type"),
+      fragmentCol = cursor.column("airway_fragment_no"), sequenceCol = cursor.column("sequence_no"),
+      fromIdCol = cursor.column("from_waypoint_id"), toIdCol = cursor.column("to_waypoint_id"),
+      directionCol = cursor.column("direction"), minAltCol = cursor.column("minimum_altitude"),
+      maxAltCol = cursor.column("maximum_altitude"), leftCol = cursor.column("left_lonx"),
+      topCol = cursor.column("top_laty"), rightCol = cursor.column("right_lonx"), bottomCol = cursor.column("bottom_laty"),
+      fromLonxCol = cursor.column("from_lonx"), fromLatyCol = cursor.column("from_laty"),
+      toLonxCol = cursor.column("to_lonx"), toLatyCol = cursor.column("to_laty");
+
+  // Bounding rectangles in degree for tile assignment
+  struct Bounds
+  {
+    float left, top, right, bottom;
+  };
+  QList<Bounds> bounds;
+
+  while(cursor.next())
+  {
+    AirwaySegment segment = {};
+    segment.id = cursor.valueInt(idCol);
+    segment.name = string(cursor.valueStr(nameCol));
+    segment.fromNavaid = waypointIndexById.value(cursor.valueInt(fromIdCol), -1);
+    segment.toNavaid = waypointIndexById.value(cursor.valueInt(toIdCol), -1);
+    segment.fromLonx = cursor.valueFloat(fromLonxCol);
+    segment.fromLaty = cursor.valueFloat(fromLatyCol);
+    segment.toLonx = cursor.valueFloat(toLonxCol);
+    segment.toLaty = cursor.valueFloat(toLatyCol);
+    segment.minAltitude = cursor.valueInt(minAltCol);
+    segment.maxAltitude = cursor.valueInt(maxAltCol);
+    segment.fragment = toUInt16(cursor.valueInt(fragmentCol));
+    segment.sequence = toUInt16(cursor.valueInt(sequenceCol));
+
+    QString type = cursor.valueStr(typeCol), direction = cursor.valueStr(directionCol);
+    segment.airwayType = type.isEmpty() ? 0 : static_cast<quint8>(type.at(0).toLatin1());
+    segment.direction = direction.isEmpty() ? 'N' : static_cast<quint8>(direction.at(0).toLatin1());
+    airways.append(segment);
+
+    bounds.append({cursor.valueFloat(leftCol), cursor.valueFloat(topCol), cursor.valueFloat(rightCol),
+                   cursor.valueFloat(bottomCol)});
+  }
+
+  // Call func for all tiles touched by the bounding rectangle of segment i
+  auto forEachTile = [&bounds](int i, auto func) {
+    const Bounds& b = bounds.at(i);
+    int south = tileIndex(0.f, b.bottom) / TILE_COLUMNS, north = tileIndex(0.f, b.top) / TILE_COLUMNS;
+    int west = tileIndex(b.left, 0.f) % TILE_COLUMNS, east = tileIndex(b.right, 0.f) % TILE_COLUMNS;
+
+    // Split at anti-meridian
+    QList<std::pair<int, int> > columns;
+    if(west <= east)
+      columns.append({west, east});
+    else
+    {
+      columns.append({west, TILE_COLUMNS - 1});
+      columns.append({0, east});
+    }
+
+    for(int row = south; row <= north; row++)
+    {
+      for(const std::pair<int, int>& cols : std::as_const(columns))
+      {
+        for(int col = cols.first; col <= cols.second; col++)
+          func(row * TILE_COLUMNS + col);
+      }
+    }
+  };
+
+  // Count, build start indexes and fill in two passes to avoid a list per tile
+  airwayTiles.fill(0, NUM_TILES + 1);
+  for(int i = 0; i < airways.size(); i++)
+    forEachTile(i, [this](int tile) {
+      airwayTiles[tile + 1]++;
+    });
+
+  for(int tile = 0; tile < NUM_TILES; tile++)
+    airwayTiles[tile + 1] += airwayTiles.at(tile);
+
+  QList<quint32> fillPos(airwayTiles.begin(), airwayTiles.end() - 1);
+  airwayTileIndex.fill(0, static_cast<int>(airwayTiles.constLast()));
+  for(int i = 0; i < airways.size(); i++)
+    forEachTile(i, [this, &fillPos, i](int tile) {
+      airwayTileIndex[fillPos[tile]++] = static_cast<quint32>(i);
+    });
+}
+
+template<typename TYPE>
+QList<quint32> NavSnapshotWriter::buildTiles(const QList<TYPE>& records) const
+{
+  // Records are sorted by tile
+  QList<quint32> tiles(NUM_TILES + 1, 0);
+  for(const TYPE& record : records)
+    tiles[tileIndex(record.lonx, record.laty) + 1]++;
+
+  for(int tile = 0; tile < NUM_TILES; tile++)
+    tiles[tile + 1] += tiles.at(tile);
+  return tiles;
+}
+
+template<typename TYPE>
+QList<quint32> NavSnapshotWriter::buildIdentIndex(const QList<TYPE>& records) const
+{
+  QList<quint32> index(records.size());
+  std::iota(index.begin(), index.end(), 0);
+
+  const char *str = strings.constData();
+  std::stable_sort(index.begin(), index.end(), [str, &records](quint32 i1, quint32 i2) -> bool {
+    return std::strcmp(str + records.at(i1).ident, str + records.at(i2).ident) < 0;
+  });
+  return index;
+}
+
+bool NavSnapshotWriter::writeToFile(const QString& filename)
+{
+#if Q_BYTE_ORDER != Q_LITTLE_ENDIAN
+  qWarning() << Q_FUNC_INFO << "Snapshot not supported on big endian systems";
+  return false;
+#endif
+
+  QElapsedTimer timer;
+  timer.start();
+
+  // Offset 0 is the empty string
+  strings.clear();
+  strings.append('\0');
+  stringOffsets.clear();
+  airports.clear();
+  runways.clear();
+  navaids.clear();
+  airways.clear();
+  procedures.clear();
+  airportIndexById.clear();
+  waypointIndexById.clear();
+
+  readAirports();
+  readRunways();
+  readProcedures();
+  readNavaids();
+  readAirways();
+
+  QList<quint32> airportTiles = buildTiles(airports), navaidTiles = buildTiles(navaids);
+  QList<quint32> airportIdentIndex = buildIdentIndex(airports), navaidIdentIndex = buildIdentIndex(navaids);
+
+  // Collect section data in the order of enum Section
+  QList<std::pair<const char *, qint64> > sections;
+  auto addSection = [&sections](const auto& list) {
+    sections.append({reinterpret_cast<const char *>(list.constData()), list.size()});
+  };
+  sections.append({strings.constData(), strings.size()});
+  addSection(airports);
+  addSection(runways);
+  addSection(navaids);
+  addSection(airways);
+  addSection(procedures);
+  addSection(airportTiles);
+  addSection(navaidTiles);
+  addSection(airwayTiles);
+  addSection(airwayTileIndex);
+  addSection(airportIdentIndex);
+  addSection(navaidIdentIndex);
+
+  const static qint64 RECORD_SIZES[NUM_SECTIONS] =
+  {
+    1, sizeof(Airport), sizeof(Runway), sizeof(Navaid), sizeof(AirwaySegment), sizeof(Procedure), 4, 4, 4, 4, 4, 4
+  };
+
+  // Build header with section table - sections are aligned to 8 bytes
+  QByteArray header(HEADER_SIZE, '\0');
+  uchar *headerData = reinterpret_cast<uchar *>(header.data());
+  qToLittleEndian<quint32>(MAGIC_NUMBER, headerData);
+  qToLittleEndian<quint32>(VERSION, headerData + 4);
+  qToLittleEndian<quint32>(BYTE_ORDER_MARK, headerData + 8);
+  qToLittleEndian<quint32>(NUM_SECTIONS, headerData + 12);
+
+  qint64 offset = (HEADER_SIZE + 7) & ~7LL;
+  QList<qint64> offsets;
+  for(int i = 0; i < NUM_SECTIONS; i++)
+  {
+    offsets.append(offset);
+    qToLittleEndian<quint32>(static_cast<quint32>(offset), headerData + 16 + i * 8);
+    qToLittleEndian<quint32>(static_cast<quint32>(sections.at(i).second), headerData + 20 + i * 8);
+    offset = (offset + sections.at(i).second * RECORD_SIZES[i] + 7) & ~7LL;
+  }
+
+  if(offset > std::numeric_limits<quint32>::max())
+  {
+    qWarning() << Q_FUNC_INFO << "Snapshot too large" << offset;
+    return false;
+  }
+
+  QSaveFile file(filename);
+  if(!file.open(QIODevice::WriteOnly))
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot open" << filename << file.errorString();
+    return false;
+  }
+
+  file.write(header);
+  for(int i = 0; i < NUM_SECTIONS; i++)
+  {
+    // Padding
+    if(file.pos() < offsets.at(i))
+      file.write(QByteArray(static_cast<int>(offsets.at(i) - file.pos()), '\0'));
+    file.write(sections.at(i).first, sections.at(i).second * RECORD_SIZES[i]);
+  }
+
+  if(!file.commit())
+  {
+    qWarning() << Q_FUNC_INFO << "Error writing" << filename << file.errorString();
+    return false;
+  }
+
+  qInfo() << Q_FUNC_INFO << filename << offset << "bytes" << "airports" << airports.size()
+          << "runways" << runways.size() << "navaids" << navaids.size() << "airways" << airways.size()
+          << "procedures" << procedures.size() << "strings" << strings.size() << "bytes"
+          << timer.elapsed() << "ms";
+  return true;
+}
+
+} // namespace db
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,89 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_DB_NAVSNAPSHOTWRITER_H
+#define ATOOLS_FS_DB_NAVSNAPSHOTWRITER_H
+
+#include "fs/common/navsnapshot.h"
+
+#include <QHash>
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+}
+
+namespace fs {
+namespace db {
+
+/*
+ * Writes airports, runways, navaids, airway segments and procedure headers of a compiled navigation database
+ * into the read only snapshot file format of atools::fs::common::NavSnapshot.
+ *
+ * Used as the last phase of the compilation after all ids and coordinates are final.
+ * Procedure legs are not included.
+ */
+class NavSnapshotWriter
+{
+public:
+  explicit NavSnapshotWriter(atools::sql::SqlDatabase& sqlDb);
+
+  /* Write snapshot to a temporary file and rename it to filename when done.
+   * Throws SqlException on query errors. Returns false and logs a warning if the file cannot be written. */
+  bool writeToFile(const QString& filename);
+
+private:
+  void readAirports();
+  void readRunways();
+  void readProcedures();
+  void readNavaids();
+  void readAirways();
+
+  /* Add string to table if not already present and return offset */
+  quint32 string(const QString& str);
+
+  /* Build tile start index array for records sorted by tile */
+  template<typename TYPE>
+  QList<quint32> buildTiles(const QList<TYPE>& records) const;
+
+  /* Build index array sorted by ident */
+  template<typename TYPE>
+  QList<quint32> buildIdentIndex(const QList<TYPE>& records) const;
+
+  atools::sql::SqlDatabase& db;
+
+  QByteArray strings;
+  QHash<QByteArray, quint32> stringOffsets;
+
+  QList<atools::fs::common::snapshot::Airport> airports;
+  QList<atools::fs::common::snapshot::Runway> runways;
+  QList<atools::fs::common::snapshot::Navaid> navaids;
+  QList<atools::fs::common::snapshot::AirwaySegment> airways;
+  QList<atools::fs::common::snapshot::Procedure> procedures;
+
+  /* Airway segments by tile in CSR format */
+  QList<quint32> airwayTiles, airwayTileIndex;
+
+  /* Database id to record index */
+  QHash<int, int> airportIndexById, waypointIndexById;
+};
+
+} // namespace db
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_DB_NAVSNAPSHOTWRITER_H
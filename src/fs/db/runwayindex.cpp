@@ -17,6 +17,8 @@
 
 #include "fs/db/runwayindex.h"
 
+#include "fs/util/fsutil.h"
+
 #include <QDebug>
 
 namespace atools {
@@ -29,7 +31,11 @@ using std::make_pair;
 
 void RunwayIndex::add(const QString& airportIdent, const QString& runwayName, int runwayEndId)
 {
-  runwayIndexMap[RunwayIndexKeyType(airportIdent, runwayName)] = runwayEndId;
+  quint16 packed = atools::fs::util::runwayPacked(runwayName, false /* normalize */);
+  if(packed == 0)
+    runwayIndexMap[RunwayIndexKeyType(airportIdent, runwayName)] = runwayEndId;
+  else
+    packedRunwayIndexMap[PackedKeyType(atools::util::Str<10>(airportIdent), packed)] = runwayEndId;
 }
 
 int RunwayIndex::getRunwayEndId(const QString& airportIdent, const QString& runwayName, const QString& sourceObject) const
@@ -37,11 +43,15 @@ int RunwayIndex::getRunwayEndId(const QString& airportIdent, const QString& runw
   if(runwayName == NO_RWY)
     return -1;
 
-  RunwayIndexKeyType key(airportIdent, runwayName);
+  int id = -1;
+  quint16 packed = atools::fs::util::runwayPacked(runwayName, false /* normalize */);
+  if(packed == 0)
+    id = runwayIndexMap.value(RunwayIndexKeyType(airportIdent, runwayName), -1);
+  else
+    id = packedRunwayIndexMap.value(PackedKeyType(atools::util::Str<10>(airportIdent), packed), -1);
 
-  auto it = runwayIndexMap.find(key);
-  if(it != runwayIndexMap.end())
-    return it.value();
+  if(id != -1)
+    return id;
   else
   {
     qWarning().nospace().noquote() << "Runway end ID for airport " << airportIdent << " and runway "
@@ -18,6 +18,8 @@
 #ifndef ATOOLS_FS_DB_RUNWAYINDEX_H
 #define ATOOLS_FS_DB_RUNWAYINDEX_H
 
+#include "util/str.h"
+
 #include <QHash>
 
 namespace atools {
@@ -57,6 +59,7 @@ public:
   void clear()
   {
     runwayIndexMap.clear();
+    packedRunwayIndexMap.clear();
   }
 
 private:
@@ -66,7 +69,13 @@ private:
   typedef QHash<atools::fs::db::RunwayIndex::RunwayIndexKeyType, int> RunwayIndexType;
   typedef atools::fs::db::RunwayIndex::RunwayIndexType::const_iterator RunwayIndexTypeConstIter;
 
+  /* Key of airport ident and runway name packed by atools::fs::util::runwayPacked(). Avoids string allocations. */
+  typedef std::pair<atools::util::Str<10>, quint16> PackedKeyType;
+
+  /* Used only for runway names which cannot be packed like "N" */
   atools::fs::db::RunwayIndex::RunwayIndexType runwayIndexMap;
+
+  QHash<PackedKeyType, int> packedRunwayIndexMap;
 };
 
 } // namespace writer
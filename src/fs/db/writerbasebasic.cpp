@@ -22,6 +22,8 @@
 #include "sql/sqlexception.h"
 
 #include <QDataStream>
+#include <QDebug>
+#include <QStringBuilder>
 
 namespace atools {
 namespace fs {
@@ -30,11 +32,14 @@ namespace db {
 using atools::sql::SqlUtil;
 using atools::sql::SqlQuery;
 
+/* Limit for bound variables per statement in older SQLite versions */
+const static int MAX_BATCH_VARIABLES = 999;
+
 WriterBaseBasic::WriterBaseBasic(atools::sql::SqlDatabase& sqlDb,
                                  DataWriter& writer,
                                  const QString& table,
                                  const QString& sqlParam)
-  : sqlQuery(sqlDb), tablename(table), db(sqlDb), dataWriter(writer)
+  : sqlQuery(sqlDb), tablename(table), batchQuery(sqlDb), db(sqlDb), dataWriter(writer)
 {
   if(sqlParam.isEmpty())
     sqlStatement = SqlUtil(&db).buildInsertStatement(tablename);
@@ -99,8 +104,75 @@ void WriterBaseBasic::bindNullString(const QString& placeholder)
   return sqlQuery.bindValue(placeholder, QVariant(QMetaType::fromType<QString>()));
 }
 
+void WriterBaseBasic::setBatchSize(int numRows)
+{
+  flush();
+
+  if(numRows > 1 && !tablename.isEmpty())
+  {
+    batchColumns = SqlUtil(&db).buildColumnList(tablename);
+
+    // Number of placeholders has to match the columns of the generated insert statement
+    if(sqlStatement != SqlUtil(&db).buildInsertStatement(tablename) || batchColumns.isEmpty())
+    {
+      qWarning() << Q_FUNC_INFO << "Batching not possible for custom statement in table" << tablename;
+      batchSize = 1;
+      return;
+    }
+
+    batchSize = std::max(1, std::min(numRows, MAX_BATCH_VARIABLES / static_cast<int>(batchColumns.size())));
+    batchValues.reserve(batchSize * batchColumns.size());
+    batchQuery.prepare(buildBatchStatement(batchSize));
+  }
+  else
+    batchSize = 1;
+}
+
+QString WriterBaseBasic::buildBatchStatement(int numRows) const
+{
+  QString row = "(" % QStringList(batchColumns.size(), QStringLiteral("?")).join(", ") % ")";
+  return "insert into " % tablename % " (" % batchColumns.join(", ") % ") values " %
+         QStringList(numRows, row).join(", ");
+}
+
+void WriterBaseBasic::flush()
+{
+  if(numBatchRows > 0)
+    executeBatch(numBatchRows);
+}
+
+void WriterBaseBasic::executeBatch(int numRows)
+{
+  SqlQuery remainderQuery(db);
+  SqlQuery& query = numRows == batchSize ? batchQuery : remainderQuery;
+  if(numRows != batchSize)
+    query.prepare(buildBatchStatement(numRows));
+
+  for(int i = 0; i < batchValues.size(); i++)
+    query.bindValue(i, batchValues.at(i));
+
+  query.exec();
+  if(query.numRowsAffected() != numRows)
+    throw atools::sql::SqlException(&query, "Not all rows of batch inserted");
+
+  batchValues.clear();
+  numBatchRows = 0;
+}
+
 void WriterBaseBasic::executeStatement()
 {
+  if(batchSize > 1)
+  {
+    // Collect values bound by the concrete writer in column order
+    batchValues.append(sqlQuery.boundValues());
+    numBatchRows++;
+    dataWriter.increaseNumObjects();
+
+    if(numBatchRows >= batchSize)
+      executeBatch(numBatchRows);
+    return;
+  }
+
   sqlQuery.exec();
   int numUpdated = sqlQuery.numRowsAffected();
   if(numUpdated == 0)
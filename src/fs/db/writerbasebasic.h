@@ -56,6 +56,16 @@ public:
 
   virtual ~WriterBaseBasic();
 
+  /*
+   * Collect up to numRows rows and insert them with a single multi row statement. Only for writers using the
+   * generated insert statement. Collected rows are not visible in the database before flush() is called.
+   * A value of 1 disables batching which is the default.
+   */
+  void setBatchSize(int numRows);
+
+  /* Insert all collected rows. Does nothing if batching is disabled. */
+  void flush();
+
 protected:
   atools::fs::db::DataWriter& getDataWriter()
   {
@@ -86,6 +96,67 @@ protected:
   /* Binds a null if string val is empty */
   void bindStrOrNull(const QString& placeholder, const QString& val);
 
+  /* Index of placeholder in the insert statement for the index based binding methods below.
+   * Resolve once in the constructor of derived classes to avoid name lookups per row. */
+  int placeholderIndex(const QString& placeholder) const
+  {
+    return sqlQuery.placeholderIndex(placeholder);
+  }
+
+  /* Typed binding by placeholder index */
+  void bindInt(int index, int val)
+  {
+    sqlQuery.bindInt(index, val);
+  }
+
+  void bindDouble(int index, double val)
+  {
+    sqlQuery.bindDouble(index, val);
+  }
+
+  void bindStr(int index, const QString& val)
+  {
+    sqlQuery.bindStr(index, val);
+  }
+
+  void bindBool(int index, bool val)
+  {
+    sqlQuery.bindInt(index, val ? 1 : 0);
+  }
+
+  void bindNullInt(int index)
+  {
+    sqlQuery.bindNull(index, QMetaType::fromType<int>());
+  }
+
+  void bindNullFloat(int index)
+  {
+    sqlQuery.bindNull(index, QMetaType::fromType<double>());
+  }
+
+  void bindNullString(int index)
+  {
+    sqlQuery.bindNull(index, QMetaType::fromType<QString>());
+  }
+
+  /* Binds a null if value == 0 */
+  void bindIntOrNull(int index, int val)
+  {
+    if(val == 0)
+      bindNullInt(index);
+    else
+      bindInt(index, val);
+  }
+
+  /* Binds a null if string val is empty */
+  void bindStrOrNull(int index, const QString& val)
+  {
+    if(val.isEmpty())
+      bindNullString(index);
+    else
+      bindStr(index, val);
+  }
+
   /* Bin a list of numbers in a byte array */
   template<typename TYPE>
   void bindNumberList(const QString& placeholder, const QList<TYPE>& list);
@@ -94,8 +165,19 @@ protected:
   void executeStatement();
 
 private:
+  /* Insert numRows rows from the start of batchValues */
+  void executeBatch(int numRows);
+
+  /* Multi row insert statement with positional bindings */
+  QString buildBatchStatement(int numRows) const;
+
   atools::sql::SqlQuery sqlQuery; // Either custom query or generated insert statement
   QString sqlStatement, tablename;
+
+  atools::sql::SqlQuery batchQuery; // Prepared for full batches
+  QStringList batchColumns;
+  QVariantList batchValues; // Bound values of all collected rows
+  int batchSize = 1, numBatchRows = 0;
   atools::sql::SqlDatabase& db;
   atools::fs::db::DataWriter& dataWriter;
 
@@ -21,6 +21,7 @@
 #include "fs/common/airportindex.h"
 #include "fs/common/binarygeometry.h"
 #include "fs/common/binarymsageometry.h"
+#include "fs/common/magdecgrid.h"
 #include "fs/common/magdecreader.h"
 #include "fs/common/metadatawriter.h"
 #include "fs/common/morareader.h"
@@ -30,6 +31,7 @@
 #include "fs/util/fsutil.h"
 #include "fs/util/tacanfrequencies.h"
 #include "geo/calculations.h"
+#include "sql/sqlcursor.h"
 #include "sql/sqldatabase.h"
 #include "sql/sqlquery.h"
 #include "sql/sqlscript.h"
@@ -39,10 +41,13 @@
 #include <QDataStream>
 #include <QDebug>
 #include <QFileInfo>
+#include <QThread>
+#include <QThreadPool>
 
 using atools::fs::common::MagDecReader;
 using atools::fs::common::MetadataWriter;
 using atools::sql::SqlQuery;
+using atools::sql::SqlCursor;
 using atools::sql::SqlUtil;
 using atools::sql::SqlScript;
 using atools::sql::SqlRecordList;
@@ -60,6 +65,23 @@ namespace ng {
 
 static const float RNV_FEATHER_WIDTH_DEG = 8.f;
 
+/* Number of airspaces collected before geometry is created and written */
+const static int AIRSPACE_BATCH_SIZE = 2000;
+
+/* Minimum number of airspaces per worker thread */
+const static int AIRSPACE_MIN_PER_THREAD = 50;
+
+/* Minimum number of ILS per worker thread when calculating feather geometry */
+const static int ILS_MIN_PER_THREAD = 500;
+
+/* ILS position and feather geometry calculated in updateIlsGeometry() */
+struct IlsGeometry
+{
+  int id;
+  atools::geo::Pos pos, p1, p2, pmid;
+  float heading, width;
+};
+
 /* Airspace segment containing information */
 struct AirspaceSegment
 {
@@ -89,12 +111,25 @@ struct AirspaceSegment
   float distance; /* Circle or arc radius in NM */
 };
 
+/* Airspace collected for geometry generation in worker threads */
+struct DfdAirspace
+{
+  /* Input */
+  QList<AirspaceSegment> segments;
+  QMap<QString, QVariant> boundValues;
+
+  /* Result */
+  QByteArray geometry;
+  Rect bounding;
+};
+
 DfdCompiler::DfdCompiler(sql::SqlDatabase& sqlDb, const NavDatabaseOptions& opts,
                          ProgressHandler *progressHandler)
   : options(opts), db(sqlDb), progress(progressHandler)
 {
   metadataWriter = new atools::fs::common::MetadataWriter(db);
   magDecReader = new atools::fs::common::MagDecReader();
+  magDecGrid = new atools::fs::common::MagDecGrid();
   airportIndex = new atools::fs::common::AirportIndex();
   procWriter = new atools::fs::common::ProcedureWriter(db, airportIndex);
 }
@@ -154,18 +189,23 @@ void DfdCompiler::writeAirports()
   airportWriteQuery->bindValue(":num_runway_end_ils", 0);
   airportWriteQuery->bindValue(":num_runways", 0);
 
-  // Read airports from source
-  airportQuery->exec();
-  while(airportQuery->next())
+  // Read airports from source - resolve column indexes once
+  SqlCursor cursor(*airportQuery);
+  const int lonxCol = cursor.column("airport_ref_longitude"), latyCol = cursor.column("airport_ref_latitude"),
+            elevationCol = cursor.column("elevation"), identCol = cursor.column("airport_identifier"),
+            iataCol = cursor.column("iata_ata_designator", false /* required */),
+            surfaceCol = cursor.column("longest_runway_surface_code"), nameCol = cursor.column("airport_name"),
+            areaCol = cursor.column("area_code"), icaoCol = cursor.column("icao_code"),
+            transAltCol = cursor.column("transition_altitude"), transLevelCol = cursor.column("transition_level");
+
+  while(cursor.next())
   {
-    Pos pos(airportQuery->valueFloat("airport_ref_longitude"),
-            airportQuery->valueFloat("airport_ref_latitude"),
-            airportQuery->valueFloat("elevation"));
+    Pos pos(cursor.valueFloat(lonxCol), cursor.valueFloat(latyCol), cursor.valueFloat(elevationCol));
 
-    QString ident = airportQuery->valueStr("airport_identifier");
+    QString ident = cursor.valueStr(identCol);
     QString iata;
-    if(airportQuery->hasField("iata_ata_designator"))
-      iata = airportQuery->valueStr("iata_ata_designator");
+    if(iataCol != -1)
+      iata = cursor.valueStr(iataCol);
 
     // Start with a minimum rectangle of about 100 meter which will be extended later
     Rect airportRect(pos);
@@ -174,7 +214,7 @@ void DfdCompiler::writeAirports()
     airportRectMap.insert(ident, airportRect);
 
     // Needed later for workaround for number or runways with certain surfaces
-    longestRunwaySurfaceMap.insert(ident, airportQuery->valueStr("longest_runway_surface_code"));
+    longestRunwaySurfaceMap.insert(ident, cursor.valueStr(surfaceCol));
 
     airportWriteQuery->bindValue(":airport_id", ++curAirportId);
 
@@ -190,10 +230,11 @@ void DfdCompiler::writeAirports()
     airportWriteQuery->bindNullStr(":faa");
     airportWriteQuery->bindNullStr(":local");
 
-    airportWriteQuery->bindValue(":name", utl::capAirportName(airportQuery->valueStr("airport_name")));
-    airportWriteQuery->bindValue(":country", airportQuery->valueStr("area_code"));
-    airportWriteQuery->bindValue(":region", airportQuery->valueStr("icao_code"));
-    airportWriteQuery->bindValue(":is_military", utl::isNameMilitary(airportQuery->valueStr("airport_name")));
+    QString name = cursor.valueStr(nameCol);
+    airportWriteQuery->bindValue(":name", utl::capAirportName(name));
+    airportWriteQuery->bindValue(":country", cursor.valueStr(areaCol));
+    airportWriteQuery->bindValue(":region", cursor.valueStr(icaoCol));
+    airportWriteQuery->bindValue(":is_military", utl::isNameMilitary(name));
 
     // Will be extended later when reading runways
     airportWriteQuery->bindValue(":left_lonx", airportRect.getTopLeft().getLonX());
@@ -201,9 +242,9 @@ void DfdCompiler::writeAirports()
     airportWriteQuery->bindValue(":right_lonx", airportRect.getBottomRight().getLonX());
     airportWriteQuery->bindValue(":bottom_laty", airportRect.getBottomRight().getLatY());
 
-    airportWriteQuery->bindValue(":mag_var", magDecReader->getMagVar(pos));
-    airportWriteQuery->bindValue(":transition_altitude", airportQuery->value("transition_altitude"));
-    airportWriteQuery->bindValue(":transition_level", airportQuery->value("transition_level"));
+    airportWriteQuery->bindValue(":mag_var", magDecGrid->getMagVar(pos));
+    airportWriteQuery->bindValue(":transition_altitude", cursor.value(transAltCol));
+    airportWriteQuery->bindValue(":transition_level", cursor.value(transLevelCol));
     airportWriteQuery->bindValue(":altitude", pos.getAltitude());
     airportWriteQuery->bindValue(":lonx", pos.getLonX());
     airportWriteQuery->bindValue(":laty", pos.getLatY());
@@ -596,7 +637,7 @@ void DfdCompiler::writePathpoints()
 
     insert.bindValue(":gs_pitch", select.valueFloat("glidepath_angle"));
 
-    insert.bindValue(":mag_var", magDecReader->getMagVar(Pos(thresholdLonX, thresholdLatY)));
+    insert.bindValue(":mag_var", magDecGrid->getMagVar(Pos(thresholdLonX, thresholdLatY)));
     insert.bindValue(":gs_lonx", thresholdLonX);
     insert.bindValue(":gs_laty", thresholdLatY);
 
@@ -871,6 +912,7 @@ void DfdCompiler::writeAirspace(atools::sql::SqlQuery& query, void (DfdCompiler:
     lastSeqNo = seqNo;
   }
   finishAirspace();
+  writePendingAirspaces();
 }
 
 void DfdCompiler::writeAirspaceGeometry(atools::sql::SqlQuery& query)
@@ -1082,226 +1124,196 @@ int DfdCompiler::airspaceAlt(const QString& altStr)
 
 void DfdCompiler::finishAirspace()
 {
-  // Related to full circle - 7.5° - number is checked in MapPainterAirspace::render()
-  const int CIRCLE_SEGMENTS = 48;
-
   // Do not write if type was not found
   if(!airspaceWriteQuery->boundValue(":type").isNull())
   {
-    // Create geometry
-    LineString curBoundary;
+    // Keep bound values and segments - geometry is created later in writePendingAirspaces()
+    DfdAirspace airspace;
+    airspace.segments = airspaceSegments;
+    airspace.boundValues = airspaceWriteQuery->boundPlaceholderAndValueMap();
+    pendingAirspaces.append(airspace);
+
+    if(pendingAirspaces.size() >= AIRSPACE_BATCH_SIZE)
+      writePendingAirspaces();
+  }
 
-    // Need to step over one iteration. Maybe need to generate rhumb line points for the last segment
-    for(int i = 0; i <= airspaceSegments.size(); i++)
-    {
-      // Last iteration is only for eventual rhumb line generation
-      bool rollover = i >= airspaceSegments.size();
+  airspaceWriteQuery->clearBoundValues();
+  airspaceSegments.clear();
+}
 
-      const AirspaceSegment& curSegment = atools::atRollConst(airspaceSegments, i);
-      const AirspaceSegment& prevSegment = atools::atRollConst(airspaceSegments, i - 1);
-      const Pos& nextPos = atools::atRollConst(airspaceSegments, i + 1).pos;
+void DfdCompiler::buildAirspaceGeometry(DfdAirspace& airspace, bool compactGeometry)
+{
+  // Related to full circle - 7.5° - number is checked in MapPainterAirspace::render()
+  const int CIRCLE_SEGMENTS = 48;
 
-      if(curSegment.pos.isNull() && !curSegment.center.isNull())
-      {
-        if(!rollover)
-          // Create a circular polygon
-          curBoundary.append(LineString(curSegment.center, ageo::nmToMeter(curSegment.distance), CIRCLE_SEGMENTS));
-      }
-      else
+  const QList<AirspaceSegment>& segments = airspace.segments;
+
+  // Create geometry
+  LineString curBoundary;
+
+  // Need to step over one iteration. Maybe need to generate rhumb line points for the last segment
+  for(int i = 0; i <= segments.size(); i++)
+  {
+    // Last iteration is only for eventual rhumb line generation
+    bool rollover = i >= segments.size();
+
+    const AirspaceSegment& curSegment = atools::atRollConst(segments, i);
+    const AirspaceSegment& prevSegment = atools::atRollConst(segments, i - 1);
+    const Pos& nextPos = atools::atRollConst(segments, i + 1).pos;
+
+    if(curSegment.pos.isNull() && !curSegment.center.isNull())
+    {
+      if(!rollover)
+        // Create a circular polygon
+        curBoundary.append(LineString(curSegment.center, ageo::nmToMeter(curSegment.distance), CIRCLE_SEGMENTS));
+    }
+    else
+    {
+      if(curSegment.center.isNull())
       {
-        if(curSegment.center.isNull())
+        float lat = std::abs(curSegment.pos.getLatY());
+
+        // Use different number of points per NM depending on latitude
+        // Use odd/prime numbers to ease debugging / detecting artifial points
+        float pointDistIntervalNm;
+        if(lat > 70.f)
+          pointDistIntervalNm = 20.f;
+        else if(lat > 60.f)
+          pointDistIntervalNm = 40.f;
+        else if(lat > 30.f)
+          pointDistIntervalNm = 70.f;
+        else if(lat > 10.f)
+          pointDistIntervalNm = 90.f;
+        else
+          pointDistIntervalNm = 250.f;
+
+        // Linear feature =============================
+        if(atools::charAt(prevSegment.via, 0) == 'H' && !curBoundary.isEmpty() &&
+           curBoundary.constLast().distanceMeterTo(curSegment.pos) > atools::geo::nmToMeter(pointDistIntervalNm))
         {
-          float lat = std::abs(curSegment.pos.getLatY());
-
-          // Use different number of points per NM depending on latitude
-          // Use odd/prime numbers to ease debugging / detecting artifial points
-          float pointDistIntervalNm;
-          if(lat > 70.f)
-            pointDistIntervalNm = 20.f;
-          else if(lat > 60.f)
-            pointDistIntervalNm = 40.f;
-          else if(lat > 30.f)
-            pointDistIntervalNm = 70.f;
-          else if(lat > 10.f)
-            pointDistIntervalNm = 90.f;
-          else
-            pointDistIntervalNm = 250.f;
-
-          // Linear feature =============================
-          if(atools::charAt(prevSegment.via, 0) == 'H' && !curBoundary.isEmpty() &&
-             curBoundary.constLast().distanceMeterTo(curSegment.pos) > atools::geo::nmToMeter(pointDistIntervalNm))
-          {
-            // Create a rhumb line using points ===============
-            const Pos& last = curBoundary.constLast();
-            float dist = last.distanceMeterTo(curSegment.pos);
-            int numPoints = atools::ceilToInt(dist / atools::geo::nmToMeter(pointDistIntervalNm));
-
-            LineString positions;
-            last.interpolatePointsRhumb(curSegment.pos, dist, numPoints, positions);
-
-            if(!positions.isEmpty())
-              positions.removeFirst();
-
-            curBoundary.append(positions);
-
-            if(!rollover)
-              // Add current position only if not rolling over. Do not close polygon
-              curBoundary.append(curSegment.pos);
-          }
-          else if(!rollover)
-            // Lines are already drawn using GC - no need for intermediate points
+          // Create a rhumb line using points ===============
+          const Pos& last = curBoundary.constLast();
+          float dist = last.distanceMeterTo(curSegment.pos);
+          int numPoints = atools::ceilToInt(dist / atools::geo::nmToMeter(pointDistIntervalNm));
+
+          LineString positions;
+          last.interpolatePointsRhumb(curSegment.pos, dist, numPoints, positions);
+
+          if(!positions.isEmpty())
+            positions.removeFirst();
+
+          curBoundary.append(positions);
+
+          if(!rollover)
+            // Add current position only if not rolling over. Do not close polygon
             curBoundary.append(curSegment.pos);
         }
         else if(!rollover)
-        {
-          // Create an arc =============================
-          bool clockwise = curSegment.via.isEmpty() ? true : curSegment.via.at(0) == QStringLiteral("R");
-          LineString arc(curSegment.center, curSegment.pos, nextPos, clockwise, CIRCLE_SEGMENTS);
-
-          if(!arc.isEmpty())
-            arc.removeLast();
-          curBoundary.append(arc);
-        }
+          // Lines are already drawn using GC - no need for intermediate points
+          curBoundary.append(curSegment.pos);
       }
-    }
+      else if(!rollover)
+      {
+        // Create an arc =============================
+        bool clockwise = curSegment.via.isEmpty() ? true : curSegment.via.at(0) == QStringLiteral("R");
+        LineString arc(curSegment.center, curSegment.pos, nextPos, clockwise, CIRCLE_SEGMENTS);
 
-    // Move points slightly away from the poles to avoid display artifacts
-    for(Pos& pos : curBoundary)
-    {
-      if(pos.getLatY() > 89.9f)
-        pos.setLatY(89.9f);
-      if(pos.getLatY() < -89.9f)
-        pos.setLatY(-89.9f);
+        if(!arc.isEmpty())
+          arc.removeLast();
+        curBoundary.append(arc);
+      }
     }
-    airspaceWriteQuery->bindValue(":file_id", FILE_ID);
-
-    Rect bounding = curBoundary.boundingRect();
-    airspaceWriteQuery->bindValue(":max_lonx", bounding.getEast());
-    airspaceWriteQuery->bindValue(":max_laty", bounding.getNorth());
-    airspaceWriteQuery->bindValue(":min_lonx", bounding.getWest());
-    airspaceWriteQuery->bindValue(":min_laty", bounding.getSouth());
+  }
 
-    atools::fs::common::BinaryGeometry geo(curBoundary);
-    airspaceWriteQuery->bindValue(":geometry", geo.writeToByteArray());
-    airspaceWriteQuery->exec();
+  // Move points slightly away from the poles to avoid display artifacts
+  for(Pos& pos : curBoundary)
+  {
+    if(pos.getLatY() > 89.9f)
+      pos.setLatY(89.9f);
+    if(pos.getLatY() < -89.9f)
+      pos.setLatY(-89.9f);
   }
 
-  airspaceWriteQuery->clearBoundValues();
-  airspaceSegments.clear();
+  airspace.bounding = curBoundary.boundingRect();
+  using atools::fs::common::BinaryGeometry;
+  airspace.geometry = BinaryGeometry(curBoundary).writeToByteArray(compactGeometry ? BinaryGeometry::DELTA_ZLIB :
+                                                                   BinaryGeometry::FLOAT);
 }
 
-void DfdCompiler::writeAirways()
+void DfdCompiler::writePendingAirspaces()
 {
-  progress->reportOther("Writing airways");
+  int num = static_cast<int>(pendingAirspaces.size());
+  if(num == 0)
+    return;
 
-  // Get airways joined with waypoints
-  QString query(
-    "select  a.route_identifier, a.seqno, a.flightlevel, a.waypoint_description_code, w.waypoint_id, "
-    "  a.direction_restriction, a.route_type, a.minimum_altitude1, a.minimum_altitude2, a.maximum_altitude, "
-    "  w.lonx, w.laty "
-    "from src.tbl_enroute_airways a "
-    "join waypoint w on "
-    "  a.waypoint_identifier = w.ident and a.icao_code = w.region and a.waypoint_longitude = w.lonx and "
-    "  a.waypoint_latitude = w.laty "
-    "order by route_identifier, seqno");
-  SqlQuery airways(query, db);
-
-  // Insert into airway and let SQLite autogenerate an ID
-  SqlQuery insert(db);
-  insert.prepare(SqlUtil(db).buildInsertStatement("airway", QStringLiteral(), {"airway_id"}));
-
-  SqlRecord lastRec;
-  QString lastName;
-  bool lastEndOfRoute = true;
-  airways.exec();
-  int sequenceNumber = 1, fragmentNumber = 1;
-  while(airways.next())
-  {
-    QString name = airways.valueStr("route_identifier");
-    QString code = airways.valueStr("waypoint_description_code");
-    bool nameChange = !lastName.isEmpty() && name != lastName;
+  int numThreads = options.getNumParserThreads() > 0 ? options.getNumParserThreads() : QThread::idealThreadCount();
+  numThreads = std::max(1, std::min(numThreads, num / AIRSPACE_MIN_PER_THREAD));
 
-    if(!lastName.isEmpty())
-    {
-      // Not the first iteration
+  // Get pointer before starting threads to avoid any detach
+  DfdAirspace *airspaces = pendingAirspaces.data();
+  bool compactGeometry = options.isCompactGeometry();
 
-      if(!nameChange && lastEndOfRoute)
-      {
-        // No name change but the last row indicated end of route - new fragment
-        fragmentNumber++;
-        sequenceNumber = 1;
-      }
+  if(numThreads > 1)
+  {
+    // Arc and rhumb line densification is heavy - spread geometry generation across threads
+    QThreadPool pool;
+    pool.setMaxThreadCount(numThreads);
+    int chunkSize = (num + numThreads - 1) / numThreads;
 
-      if(!lastEndOfRoute && !nameChange)
-      {
-        // Nothing has changed or ended - insert from/to pair
-
-        Pos fromPos(lastRec.valueFloat("lonx"), lastRec.valueFloat("laty"));
-        Pos toPos(airways.valueFloat("lonx"), airways.valueFloat("laty"));
-        Rect rect(fromPos);
-        rect.extend(toPos);
-
-        insert.bindValue(":airway_name", lastRec.valueStr("route_identifier"));
-
-        // -- V = victor, J = jet, B = both
-        // B = All Altitudes, H = High Level Airways, L = Low Level Airways
-        QString awType = lastRec.valueStr("flightlevel");
-        if(awType == "H")
-          insert.bindValue(":airway_type", "J");
-        else if(awType == "L")
-          insert.bindValue(":airway_type", "V");
-        else
-          insert.bindValue(":airway_type", "B");
-
-        insert.bindValue(":route_type", lastRec.valueStr("route_type"));
-
-        insert.bindValue(":airway_fragment_no", fragmentNumber);
-        insert.bindValue(":sequence_no", sequenceNumber++);
-        insert.bindValue(":from_waypoint_id", lastRec.valueInt("waypoint_id"));
-        insert.bindValue(":to_waypoint_id", airways.valueInt("waypoint_id"));
-
-        // -- N = none, B = backward, F = forward
-        // F =  One way in direction route is coded (Forward),
-        // B = One way in opposite direction route is coded (backwards)
-        // blank = // no restrictions on direction
-        QString dir = lastRec.valueStr("direction_restriction");
-        if(dir.isEmpty() || dir == " ")
-          dir = "N";
-
-        insert.bindValue(":direction", dir);
-
-        insert.bindValue(":minimum_altitude", lastRec.valueInt("minimum_altitude1"));
-        insert.bindValue(":maximum_altitude", lastRec.valueInt("maximum_altitude"));
-
-        insert.bindValue(":left_lonx", rect.getTopLeft().getLonX());
-        insert.bindValue(":top_laty", rect.getTopLeft().getLatY());
-        insert.bindValue(":right_lonx", rect.getBottomRight().getLonX());
-        insert.bindValue(":bottom_laty", rect.getBottomRight().getLatY());
-
-        insert.bindValue(":from_lonx", fromPos.getLonX());
-        insert.bindValue(":from_laty", fromPos.getLatY());
-        insert.bindValue(":to_lonx", toPos.getLonX());
-        insert.bindValue(":to_laty", toPos.getLatY());
-        insert.exec();
-      }
+    for(int start = 0; start < num; start += chunkSize)
+    {
+      int end = std::min(start + chunkSize, num);
+      pool.start([airspaces, start, end, compactGeometry]() -> void {
+        for(int i = start; i < end; i++)
+          buildAirspaceGeometry(airspaces[i], compactGeometry);
+      });
     }
+    pool.waitForDone();
+  }
+  else
+  {
+    for(int i = 0; i < num; i++)
+      buildAirspaceGeometry(airspaces[i], compactGeometry);
+  }
 
-    lastRec = airways.record();
-    lastName = name;
-    lastEndOfRoute = code.size() > 1 && code.at(1) == 'E';
-
-    if(nameChange)
+  // Write in original order on this thread
+  for(const DfdAirspace& airspace : std::as_const(pendingAirspaces))
+  {
+    for(auto it = airspace.boundValues.constBegin(); it != airspace.boundValues.constEnd(); ++it)
     {
-      // Name has changed - reset all
-      fragmentNumber = 1;
-      sequenceNumber = 1;
+      if(it.value().isValid())
+        airspaceWriteQuery->bindValue(it.key(), it.value());
     }
+
+    airspaceWriteQuery->bindValue(":file_id", FILE_ID);
+    airspaceWriteQuery->bindValue(":max_lonx", airspace.bounding.getEast());
+    airspaceWriteQuery->bindValue(":max_laty", airspace.bounding.getNorth());
+    airspaceWriteQuery->bindValue(":min_lonx", airspace.bounding.getWest());
+    airspaceWriteQuery->bindValue(":min_laty", airspace.bounding.getSouth());
+    airspaceWriteQuery->bindValue(":geometry", airspace.geometry);
+    airspaceWriteQuery->exec();
+    airspaceWriteQuery->clearBoundValues();
   }
+
+  pendingAirspaces.clear();
+}
+
+void DfdCompiler::writeAirways()
+{
+  progress->reportOther("Writing airways");
+
+  SqlScript script(db, true /*options->isVerbose()*/);
+
+  // Build airway segments and fragments from enroute airways joined with waypoints
+  script.executeScript(":/atools/resources/sql/fs/db/dfd/populate_airways.sql");
   db.commit();
 }
 
 void DfdCompiler::writeProcedures()
 {
+  // All airports are loaded - speed up lookups for procedure legs
+  airportIndex->freeze();
+
   progress->reportOther("Writing approaches and transitions");
   writeProcedure("src.tbl_iaps", "APPCH");
 
@@ -1478,6 +1490,9 @@ void DfdCompiler::close()
   delete magDecReader;
   magDecReader = nullptr;
 
+  delete magDecGrid;
+  magDecGrid = nullptr;
+
   delete metadataWriter;
   metadataWriter = nullptr;
 
@@ -1506,6 +1521,9 @@ void DfdCompiler::compileMagDeclBgl()
   magDecReader->readFromWmm();
   magDecReader->writeToTable(db);
   db.commit();
+
+  // Same values as reader but no range checks and exceptions in lookups
+  magDecGrid->build(*magDecReader);
 }
 
 void DfdCompiler::writeFileAndSceneryMetadata()
@@ -1519,10 +1537,10 @@ void DfdCompiler::updateMagvar()
 {
   progress->reportOther("Updating magnetic declination");
 
-  atools::fs::common::MagDecReader *magdec = magDecReader;
+  const atools::fs::common::MagDecGrid *magdec = magDecGrid;
   SqlUtil::UpdateColFuncType func =
     [magdec](const atools::sql::SqlQuery& from, atools::sql::SqlQuery& to) -> bool {
-      to.bindValue(":mag_var", magdec->getMagVar(Pos(from.valueFloat("lonx"), from.valueFloat("laty"))));
+      to.bindValue(":mag_var", magdec->getMagVar(from.valueFloat("lonx"), from.valueFloat("laty")));
       return true;
     };
 
@@ -1690,28 +1708,77 @@ void DfdCompiler::updateIlsGeometry()
 {
   progress->reportOther("Updating ILS geometry");
 
-  SqlUtil::UpdateColFuncType func =
-    [](const atools::sql::SqlQuery& from, atools::sql::SqlQuery& to) -> bool
-    {
-      QString type = from.valueStr("type");
+  // Read all ILS at once ================================================
+  QList<IlsGeometry> ilsList;
+  SqlQuery query("select ils_id, lonx, laty, loc_heading, loc_width, type from ils", db);
+  query.exec();
+  while(query.next())
+  {
+    QString type = query.valueStr("type");
+
+    IlsGeometry ils;
+    ils.id = query.valueInt("ils_id");
+    ils.pos = Pos(query.valueFloat("lonx"), query.valueFloat("laty"));
+    ils.heading = query.valueFloat("loc_heading");
+    ils.width = type == "G" || type == "T" ? RNV_FEATHER_WIDTH_DEG : query.valueFloat("loc_width");
+    ilsList.append(ils);
+  }
+  query.finish();
 
-      Pos p1, p2, pmid;
-      atools::fs::util::calculateIlsGeometry(Pos(from.valueFloat("lonx"), from.valueFloat("laty")), from.valueFloat("loc_heading"),
-                                             type == "G" || type == "T" ? RNV_FEATHER_WIDTH_DEG : from.valueFloat("loc_width"),
-                                             atools::fs::util::DEFAULT_FEATHER_LEN_NM, p1, p2, pmid);
-
-      to.bindValue(":end1_lonx", p1.getLonX());
-      to.bindValue(":end1_laty", p1.getLatY());
-      to.bindValue(":end_mid_lonx", pmid.getLonX());
-      to.bindValue(":end_mid_laty", pmid.getLatY());
-      to.bindValue(":end2_lonx", p2.getLonX());
-      to.bindValue(":end2_laty", p2.getLatY());
-      return true;
-    };
+  if(ilsList.isEmpty())
+    return;
+
+  // Calculate feather geometry in parallel ================================================
+  int num = static_cast<int>(ilsList.size());
+  int numThreads = options.getNumParserThreads() > 0 ? options.getNumParserThreads() : QThread::idealThreadCount();
+  numThreads = std::max(1, std::min(numThreads, num / ILS_MIN_PER_THREAD));
+
+  // Get pointer before starting threads to avoid any detach
+  IlsGeometry *ilsData = ilsList.data();
+  QThreadPool pool;
+  pool.setMaxThreadCount(numThreads);
+  int chunkSize = (num + numThreads - 1) / numThreads;
+
+  for(int start = 0; start < num; start += chunkSize)
+  {
+    int end = std::min(start + chunkSize, num);
+    pool.start([ilsData, start, end]() -> void {
+      for(int i = start; i < end; i++)
+      {
+        IlsGeometry& ils = ilsData[i];
+        atools::fs::util::calculateIlsGeometry(ils.pos, ils.heading, ils.width, atools::fs::util::DEFAULT_FEATHER_LEN_NM,
+                                               ils.p1, ils.p2, ils.pmid);
+      }
+    });
+  }
+  pool.waitForDone();
+
+  // Collect results in temporary table and update all ILS with one statement ================================
+  db.exec("create temp table if not exists ils_geometry (ils_id integer primary key, "
+          "end1_lonx double, end1_laty double, end_mid_lonx double, end_mid_laty double, end2_lonx double, end2_laty double)");
+  db.exec("delete from temp.ils_geometry");
+
+  SqlQuery insert(db);
+  insert.prepare("insert into temp.ils_geometry (ils_id, end1_lonx, end1_laty, end_mid_lonx, end_mid_laty, end2_lonx, end2_laty) "
+                 "values(:id, :end1_lonx, :end1_laty, :end_mid_lonx, :end_mid_laty, :end2_lonx, :end2_laty)");
+
+  for(const IlsGeometry& ils : std::as_const(ilsList))
+  {
+    insert.bindValue(":id", ils.id);
+    insert.bindValue(":end1_lonx", ils.p1.getLonX());
+    insert.bindValue(":end1_laty", ils.p1.getLatY());
+    insert.bindValue(":end_mid_lonx", ils.pmid.getLonX());
+    insert.bindValue(":end_mid_laty", ils.pmid.getLatY());
+    insert.bindValue(":end2_lonx", ils.p2.getLonX());
+    insert.bindValue(":end2_laty", ils.p2.getLatY());
+    insert.exec();
+  }
 
-  SqlUtil(db).updateColumnInTable("ils", "ils_id", {"lonx", "laty", "loc_heading", "loc_width", "type"},
-                                  {"end1_lonx", "end1_laty", "end_mid_lonx", "end_mid_laty", "end2_lonx", "end2_laty"},
-                                  func);
+  db.exec("update ils set (end1_lonx, end1_laty, end_mid_lonx, end_mid_laty, end2_lonx, end2_laty) = "
+          "(select g.end1_lonx, g.end1_laty, g.end_mid_lonx, g.end_mid_laty, g.end2_lonx, g.end2_laty "
+          "from temp.ils_geometry g where g.ils_id = ils.ils_id) "
+          "where ils_id in (select ils_id from temp.ils_geometry)");
+  db.exec("drop table if exists temp.ils_geometry");
   db.commit();
 }
 
@@ -1726,43 +1793,41 @@ void DfdCompiler::updateTreeLetterAirportCodes()
     return;
   }
 
-  QHash<QString, QString> codeMap;
-  SqlQuery codeQuery("select airport_identifier, airport_identifier_3letter "
-                     "from src.tbl_airports where airport_identifier_3letter is not null", db);
-  codeQuery.exec();
-  while(codeQuery.next())
-    codeMap.insert(codeQuery.valueStr("airport_identifier"), codeQuery.valueStr("airport_identifier_3letter"));
-  codeQuery.finish();
+  // Collect codes in a temporary table which is joined for each update
+  db.exec("create temp table if not exists airport_code3 (code4 varchar(10) primary key, code3 varchar(10) not null)");
+  db.exec("delete from temp.airport_code3");
+  db.exec("insert or replace into temp.airport_code3 (code4, code3) "
+          "select airport_identifier, airport_identifier_3letter "
+          "from src.tbl_airports where airport_identifier_3letter is not null");
 
-  updateTreeLetterAirportCodes(codeMap, "airport", "ident");
-  updateTreeLetterAirportCodes(codeMap, "airport_file", "ident");
-  updateTreeLetterAirportCodes(codeMap, "approach", "airport_ident");
+  updateTreeLetterAirportCodes("airport", "ident");
+  updateTreeLetterAirportCodes("airport_file", "ident");
+  updateTreeLetterAirportCodes("approach", "airport_ident");
 
   // Not used in DFD
-  // updateTreeLetterAirportCodes(codeMap, "approach", "fix_airport_ident");
-  // updateTreeLetterAirportCodes(codeMap, "approach_leg", "fix_airport_ident");
-  // updateTreeLetterAirportCodes(codeMap, "transition", "fix_airport_ident");
-  // updateTreeLetterAirportCodes(codeMap, "transition", "dme_airport_ident");
-  // updateTreeLetterAirportCodes(codeMap, "transition_leg", "fix_airport_ident");
-
-  updateTreeLetterAirportCodes(codeMap, "ils", "loc_airport_ident");
-  updateTreeLetterAirportCodes(codeMap, "tmp_airway_point", "next_airport_ident");
-  updateTreeLetterAirportCodes(codeMap, "tmp_airway_point", "previous_airport_ident");
+  // updateTreeLetterAirportCodes("approach", "fix_airport_ident");
+  // updateTreeLetterAirportCodes("approach_leg", "fix_airport_ident");
+  // updateTreeLetterAirportCodes("transition", "fix_airport_ident");
+  // updateTreeLetterAirportCodes("transition", "dme_airport_ident");
+  // updateTreeLetterAirportCodes("transition_leg", "fix_airport_ident");
+
+  updateTreeLetterAirportCodes("ils", "loc_airport_ident");
+  updateTreeLetterAirportCodes("tmp_airway_point", "next_airport_ident");
+  updateTreeLetterAirportCodes("tmp_airway_point", "previous_airport_ident");
+
+  db.exec("drop table if exists temp.airport_code3");
 }
 
-void DfdCompiler::updateTreeLetterAirportCodes(const QHash<QString, QString>& codeMap, const QString& table,
-                                               const QString& column)
+void DfdCompiler::updateTreeLetterAirportCodes(const QString& table, const QString& column)
 {
   qInfo() << "Updating three-letter codes in" << table << column;
-  SqlQuery update(db);
-  update.prepare("update " + table + " set " + column + " = :code3 where " + column + " = :code4");
 
-  for(auto it = codeMap.constBegin(); it != codeMap.constEnd(); ++it)
-  {
-    update.bindValue(":code4", it.key());
-    update.bindValue(":code3", it.value());
-    update.exec();
-  }
+  // One statement for all codes using the primary key of the temporary table
+  SqlQuery update(db);
+  update.exec("update " + table + " set " + column + " = "
+              "(select c.code3 from temp.airport_code3 c where c.code4 = " + table + "." + column + ") "
+              "where " + column + " in (select code4 from temp.airport_code3)");
+  qInfo() << "Updated" << update.numRowsAffected() << "rows";
 }
 
 void DfdCompiler::initQueries()
@@ -32,6 +32,7 @@ class SqlRecord;
 namespace fs {
 
 namespace common {
+class MagDecGrid;
 class MagDecReader;
 class MetadataWriter;
 class AirportIndex;
@@ -47,6 +48,7 @@ class ProgressHandler;
 namespace ng {
 
 struct AirspaceSegment;
+struct DfdAirspace;
 /*
  * Creates a Little Navmap scenery database from an extended DFD database.
  * Only for command line based compilation.
@@ -174,19 +176,27 @@ private:
   /* Reads all rows of source airspace table */
   void writeAirspace(atools::sql::SqlQuery& query, void (DfdCompiler::*beginFunc)(atools::sql::SqlQuery&));
 
-  /* Finalize and execute insert query */
+  /* Finalize airspace and add it to pendingAirspaces */
   void finishAirspace();
 
+  /* Create geometry for all pending airspaces in worker threads and write them in original order */
+  void writePendingAirspaces();
+
+  /* Build boundary from segments. Called in worker threads. */
+  static void buildAirspaceGeometry(DfdAirspace& airspace, bool compactGeometry);
+
   /* Get aispace altitude restriction which can start with FL and is converted into feet in this case */
   int airspaceAlt(const QString& altStr);
 
-  /* Update airport ident with three letter code for given table */
-  void updateTreeLetterAirportCodes(const QHash<QString, QString>& codeMap, const QString& table,
-                                    const QString& column);
+  /* Update airport ident with three letter code for given table using the temporary table airport_code3 */
+  void updateTreeLetterAirportCodes(const QString& table, const QString& column);
 
   /* Airspace segments containing information */
   QList<AirspaceSegment> airspaceSegments;
 
+  /* Finished airspaces waiting for geometry generation and writing */
+  QList<DfdAirspace> pendingAirspaces;
+
   /* Maps concatenated FIR and UIR airspace key columns to boundary_id in database */
   QHash<QString, int> airspaceIdentIdMap;
 
@@ -194,6 +204,9 @@ private:
   atools::sql::SqlDatabase& db;
   atools::fs::ProgressHandler *progress = nullptr;
   atools::fs::common::MagDecReader *magDecReader = nullptr;
+
+  /* Sampled from magDecReader for fast lookups */
+  atools::fs::common::MagDecGrid *magDecGrid = nullptr;
   atools::fs::common::AirportIndex *airportIndex = nullptr;
   atools::fs::common::ProcedureWriter *procWriter = nullptr;
   atools::fs::common::MetadataWriter *metadataWriter = nullptr;
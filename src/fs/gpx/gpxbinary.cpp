@@ -0,0 +1,321 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/gpx/gpxbinary.h"
+
+#include "exception.h"
+#include "fs/gpx/gpxio.h"
+#include "fs/gpx/gpxtypes.h"
+#include "zip/gzip.h"
+
+#include <QtEndian>
+
+#include <cmath>
+#include <cstring>
+
+namespace atools {
+namespace fs {
+namespace gpx {
+
+namespace trackbin {
+
+static const QByteArray MAGIC("ATRK");
+static const char VERSION = 1;
+
+/* Quantization factors */
+static const double COORD_FACTOR = 1000000.;
+static const double ALT_FACTOR = 10.;
+
+static void appendVarint(QByteArray& buffer, quint64 value)
+{
+  while(value >= 0x80)
+  {
+    buffer.append(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  buffer.append(static_cast<char>(value));
+}
+
+static void appendSigned(QByteArray& buffer, qint64 value)
+{
+  // Zigzag encode to keep small negative deltas short
+  appendVarint(buffer, (static_cast<quint64>(value) << 1) ^ static_cast<quint64>(value >> 63));
+}
+
+static void appendFloat(QByteArray& buffer, float value)
+{
+  float le = qToLittleEndian(value);
+  buffer.append(reinterpret_cast<const char *>(&le), sizeof(float));
+}
+
+/* Appends a column of delta encoded values */
+template<typename FUNC>
+static void appendColumn(QByteArray& buffer, const TrailPoints& points, FUNC value)
+{
+  qint64 last = 0;
+  for(const TrailPoint& point : points)
+  {
+    qint64 cur = value(point);
+    appendSigned(buffer, cur - last);
+    last = cur;
+  }
+}
+
+/* Reads from uncompressed payload and remembers errors */
+class Reader
+{
+public:
+  explicit Reader(const QByteArray& bytes)
+    : data(bytes.constData()), end(bytes.constData() + bytes.size())
+  {
+  }
+
+  bool isValid() const
+  {
+    return valid;
+  }
+
+  quint64 readVarint()
+  {
+    quint64 value = 0;
+    for(int shift = 0; shift < 64 && data < end; shift += 7)
+    {
+      quint8 byte = static_cast<quint8>(*data++);
+      value |= static_cast<quint64>(byte & 0x7f) << shift;
+      if((byte & 0x80) == 0)
+        return value;
+    }
+    valid = false;
+    return 0;
+  }
+
+  qint64 readSigned()
+  {
+    quint64 value = readVarint();
+    return static_cast<qint64>(value >> 1) ^ -static_cast<qint64>(value & 1);
+  }
+
+  float readFloat()
+  {
+    if(end - data < static_cast<qsizetype>(sizeof(float)))
+    {
+      valid = false;
+      return 0.f;
+    }
+    float value = qFromLittleEndian<float>(data);
+    data += sizeof(float);
+    return value;
+  }
+
+  QString readString()
+  {
+    quint64 size = readVarint();
+    if(!valid || size > static_cast<quint64>(end - data))
+    {
+      valid = false;
+      return QString();
+    }
+    QString str = QString::fromUtf8(data, static_cast<qsizetype>(size));
+    data += size;
+    return str;
+  }
+
+  /* Count which cannot exceed remaining bytes since each value needs at least one byte */
+  qsizetype readCount()
+  {
+    quint64 count = readVarint();
+    if(!valid || count > static_cast<quint64>(end - data))
+    {
+      valid = false;
+      return 0;
+    }
+    return static_cast<qsizetype>(count);
+  }
+
+private:
+  const char *data, *end;
+  bool valid = true;
+};
+
+} // namespace trackbin
+
+bool GpxBinary::isBinaryTrack(const QByteArray& bytes)
+{
+  return bytes.startsWith(trackbin::MAGIC);
+}
+
+QByteArray GpxBinary::encode(const GpxData& gpxData, int level)
+{
+  QByteArray payload;
+  payload.reserve(gpxData.getNumPoints() * 8 + gpxData.getFlightplan().size() * 24 + 16);
+
+  // Route ==================================
+  const atools::fs::pln::Flightplan& flightplan = gpxData.getFlightplan();
+  trackbin::appendVarint(payload, static_cast<quint64>(flightplan.size()));
+  for(const atools::fs::pln::FlightplanEntry& entry : flightplan)
+  {
+    QByteArray ident = entry.getIdent().toUtf8();
+    trackbin::appendVarint(payload, static_cast<quint64>(ident.size()));
+    payload.append(ident);
+
+    const atools::geo::Pos& pos = entry.getPosition();
+    trackbin::appendFloat(payload, pos.getLonX());
+    trackbin::appendFloat(payload, pos.getLatY());
+    trackbin::appendFloat(payload, pos.getAltitude());
+  }
+
+  // Track ==================================
+  const Trails& trails = gpxData.getTrails();
+  trackbin::appendVarint(payload, static_cast<quint64>(trails.size()));
+  for(const TrailPoints& points : trails)
+  {
+    trackbin::appendVarint(payload, static_cast<quint64>(points.size()));
+
+    // Columns compress better than interleaved values
+    trackbin::appendColumn(payload, points, [](const TrailPoint& point) -> qint64 {
+            return std::llround(point.pos.getLonX() * trackbin::COORD_FACTOR);
+          });
+    trackbin::appendColumn(payload, points, [](const TrailPoint& point) -> qint64 {
+            return std::llround(point.pos.getLatY() * trackbin::COORD_FACTOR);
+          });
+    trackbin::appendColumn(payload, points, [](const TrailPoint& point) -> qint64 {
+            return std::llround(point.pos.getAltitude() * trackbin::ALT_FACTOR);
+          });
+    trackbin::appendColumn(payload, points, [](const TrailPoint& point) -> qint64 {
+            return point.timestampMs;
+          });
+  }
+
+  QByteArray retval(trackbin::MAGIC);
+  retval.append(trackbin::VERSION);
+  retval.append(atools::zip::gzipCompress(payload, level));
+  return retval;
+}
+
+void GpxBinary::decode(GpxData& gpxData, const QByteArray& bytes)
+{
+  gpxData.clear();
+
+  if(!isBinaryTrack(bytes) || bytes.size() < trackbin::MAGIC.size() + 1)
+    throw Exception(tr("Not a binary track."));
+
+  if(bytes.at(trackbin::MAGIC.size()) != trackbin::VERSION)
+    throw Exception(tr("Unsupported binary track version %1.").arg(static_cast<int>(bytes.at(trackbin::MAGIC.size()))));
+
+  // Avoid copying the compressed data
+  const qsizetype headerSize = trackbin::MAGIC.size() + 1;
+  QByteArray payload;
+  if(!atools::zip::gzipDecompress(QByteArray::fromRawData(bytes.constData() + headerSize, bytes.size() - headerSize), payload))
+    throw Exception(tr("Cannot decompress binary track."));
+
+  trackbin::Reader reader(payload);
+
+  // Route ==================================
+  qsizetype numEntries = reader.readCount();
+  for(qsizetype i = 0; i < numEntries && reader.isValid(); i++)
+  {
+    atools::fs::pln::FlightplanEntry entry;
+    entry.setIdent(reader.readString());
+    float lonX = reader.readFloat();
+    float latY = reader.readFloat();
+    float alt = reader.readFloat();
+    entry.setPosition(atools::geo::Pos(lonX, latY, alt));
+
+    if(reader.isValid())
+      gpxData.appendFlightplanEntry(entry);
+  }
+
+  // Track ==================================
+  qsizetype numSegments = reader.readCount();
+  TrailPoints points;
+  for(qsizetype i = 0; i < numSegments && reader.isValid(); i++)
+  {
+    qsizetype numPoints = reader.readCount();
+    points.resize(numPoints);
+
+    qint64 value = 0;
+    for(TrailPoint& point : points)
+    {
+      value += reader.readSigned();
+      point.pos.setLonX(value / trackbin::COORD_FACTOR);
+    }
+
+    value = 0;
+    for(TrailPoint& point : points)
+    {
+      value += reader.readSigned();
+      point.pos.setLatY(value / trackbin::COORD_FACTOR);
+    }
+
+    value = 0;
+    for(TrailPoint& point : points)
+    {
+      value += reader.readSigned();
+      point.pos.setAltitude(value / trackbin::ALT_FACTOR);
+    }
+
+    value = 0;
+    for(TrailPoint& point : points)
+    {
+      value += reader.readSigned();
+      point.timestampMs = value;
+    }
+
+    if(reader.isValid())
+      gpxData.appendTrailPoints(points);
+  }
+
+  if(!reader.isValid())
+  {
+    gpxData.clear();
+    throw Exception(tr("Truncated or invalid binary track."));
+  }
+
+  gpxData.adjustDepartureAndDestinationFlightplan();
+}
+
+void GpxBinary::decodeAny(GpxData& gpxData, const QByteArray& bytes)
+{
+  if(isBinaryTrack(bytes))
+    decode(gpxData, bytes);
+  else
+    GpxIO().loadGpxGz(gpxData, bytes);
+}
+
+QByteArray GpxBinary::gpxGzToBinary(const QByteArray& bytes)
+{
+  if(bytes.isEmpty() || isBinaryTrack(bytes))
+    return bytes;
+
+  GpxData gpxData;
+  GpxIO().loadGpxGz(gpxData, bytes);
+  return encode(gpxData);
+}
+
+QByteArray GpxBinary::binaryToGpxGz(const QByteArray& bytes)
+{
+  if(!isBinaryTrack(bytes))
+    return bytes;
+
+  GpxData gpxData;
+  decode(gpxData, bytes);
+  return GpxIO().saveGpxGz(gpxData);
+}
+
+} // namespace gpx
+} // namespace fs
+} // namespace atools
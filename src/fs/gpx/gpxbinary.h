@@ -0,0 +1,65 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_GPXBINARY_H
+#define ATOOLS_GPXBINARY_H
+
+#include <QCoreApplication>
+
+namespace atools {
+namespace fs {
+namespace gpx {
+
+class GpxData;
+
+/*
+ * Compact binary encoding of GpxData as an alternative to Gzip compressed GPX XML for logbook track attachments.
+ *
+ * Layout is the magic number "ATRK", a version byte and a Gzip compressed payload. Route points are stored with
+ * ident and float coordinates. Track points are stored column wise per segment where each column contains
+ * zigzag varint encoded deltas of quantized values:
+ * longitude and latitude in 1e-6 degrees (same as written to GPX), altitude in 0.1 ft and time in milliseconds.
+ *
+ * Decoding needs no XML parsing and the blob is a fraction of the GPX size.
+ */
+class GpxBinary
+{
+  Q_DECLARE_TR_FUNCTIONS(GpxBinary)
+
+public:
+  /* true if bytes start with the binary track magic number */
+  static bool isBinaryTrack(const QByteArray& bytes);
+
+  /* Encode route and track. level is the compression level. */
+  static QByteArray encode(const atools::fs::gpx::GpxData& gpxData, int level = -1);
+
+  /* Decode into gpxData which is cleared before. Throws Exception if data is invalid or truncated. */
+  static void decode(atools::fs::gpx::GpxData& gpxData, const QByteArray& bytes);
+
+  /* Load either binary track or Gzip compressed GPX detected by magic number. Throws Exception on error. */
+  static void decodeAny(atools::fs::gpx::GpxData& gpxData, const QByteArray& bytes);
+
+  /* Convert a Gzip compressed GPX blob to binary and vice versa. Returns bytes unchanged if already in target format. */
+  static QByteArray gpxGzToBinary(const QByteArray& bytes);
+  static QByteArray binaryToGpxGz(const QByteArray& bytes);
+};
+
+} // namespace gpx
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_GPXBINARY_H
@@ -24,14 +24,17 @@
 #include "gpxtypes.h"
 #include "fs/pln/flightplan.h"
 #include "util/xmlstream.h"
-#include "zip/gzip.h"
+#include "zip/gzipdevice.h"
 
+#include <QBuffer>
 #include <QDateTime>
 #include <QFile>
 #include <QRegularExpression>
 #include <QTimeZone>
 #include <QXmlStreamReader>
 
+#include <algorithm>
+
 using atools::geo::Pos;
 using atools::geo::PosD;
 using atools::fs::pln::Flightplan;
@@ -61,13 +64,14 @@ bool GpxIO::isGpxFile(const QString& file)
           lines.at(2).startsWith("<gpx", Qt::CaseInsensitive));
 }
 
-void GpxIO::readPosGpx(atools::geo::PosD& pos, QString& name, atools::util::XmlStream& xmlStream, QDateTime *timestamp)
+void GpxIO::readPosGpx(atools::geo::PosD& pos, QString *name, atools::util::XmlStream& xmlStream, qint64 *timestampMs)
 {
   bool lonOk, latOk;
 
   QXmlStreamReader& reader = xmlStream.getReader();
-  double lon = reader.attributes().value("lon").toDouble(&lonOk);
-  double lat = reader.attributes().value("lat").toDouble(&latOk);
+  const QXmlStreamAttributes attributes = reader.attributes();
+  double lon = attributes.value("lon").toDouble(&lonOk);
+  double lat = attributes.value("lat").toDouble(&latOk);
 
   if(lonOk && latOk)
   {
@@ -88,23 +92,125 @@ void GpxIO::readPosGpx(atools::geo::PosD& pos, QString& name, atools::util::XmlS
   else
     throw Exception(tr("Invalid position in GPX file \"%1\".").arg(xmlStream.getFilename()));
 
+  if(timestampMs != nullptr)
+    *timestampMs = 0L;
+
   while(xmlStream.readNextStartElement())
   {
-    if(reader.name() == QLatin1String("name"))
-      name = reader.readElementText();
-    else if(reader.name() == QLatin1String("time"))
-    {
-      if(timestamp != nullptr)
-        // Reads with or without milliseconds and returns UTC without changed hour number
-        *timestamp = QDateTime::fromString(reader.readElementText(), Qt::ISODate);
-    }
+    if(reader.name() == QLatin1String("name") && name != nullptr)
+      *name = reader.readElementText();
+    else if(reader.name() == QLatin1String("time") && timestampMs != nullptr)
+      // Reads with or without milliseconds and returns UTC without changed hour number
+      *timestampMs = std::max(parseIsoTimestampMs(xmlStream.readElementTextView()), 0LL);
     else if(reader.name() == QLatin1String("ele")) // Elevation
-      pos.setAltitude(atools::geo::meterToFeet(reader.readElementText().toDouble()));
+      pos.setAltitude(atools::geo::meterToFeet(xmlStream.readElementTextView().toDouble()));
     else
       xmlStream.skipCurrentElement(false /* warn */);
   }
 }
 
+/* Value of num ASCII digits at pos or -1 if one of them is not a digit */
+static int isoDigits(QStringView str, qsizetype pos, int num)
+{
+  int value = 0;
+  for(qsizetype i = pos; i < pos + num; i++)
+  {
+    char16_t c = str.at(i).unicode();
+    if(c < u'0' || c > u'9')
+      return -1;
+    value = value * 10 + (c - u'0');
+  }
+  return value;
+}
+
+/* Days since 1970-01-01 for a date in the proleptic Gregorian calendar */
+static qint64 isoDaysFromCivil(int year, int month, int day)
+{
+  year -= month <= 2;
+  const qint64 era = (year >= 0 ? year : year - 399) / 400;
+  const int yearOfEra = static_cast<int>(year - era * 400);
+  const int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  const int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+  return era * 146097 + dayOfEra - 719468;
+}
+
+qint64 GpxIO::parseIsoTimestampMs(QStringView str)
+{
+  str = str.trimmed();
+  const qsizetype size = str.size();
+
+  // yyyy-MM-ddTHH:mm:ss
+  if(size < 19 || str.at(4) != QLatin1Char('-') || str.at(7) != QLatin1Char('-') ||
+     (str.at(10) != QLatin1Char('T') && str.at(10) != QLatin1Char('t') && str.at(10) != QLatin1Char(' ')) ||
+     str.at(13) != QLatin1Char(':') || str.at(16) != QLatin1Char(':'))
+    return -1L;
+
+  int year = isoDigits(str, 0, 4), month = isoDigits(str, 5, 2), day = isoDigits(str, 8, 2);
+  int hour = isoDigits(str, 11, 2), minute = isoDigits(str, 14, 2), second = isoDigits(str, 17, 2);
+
+  static const int DAYS_IN_MONTH[] = {31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+  if(year < 0 || month < 1 || month > 12 || day < 1 || day > DAYS_IN_MONTH[month - 1] || hour < 0 || hour > 23 ||
+     minute < 0 || minute > 59 || second < 0 || second > 59)
+    return -1L;
+
+  // Check February 29 in non-leap years
+  if(month == 2 && day == 29 && !(year % 4 == 0 && (year % 100 != 0 || year % 400 == 0)))
+    return -1L;
+
+  // Fraction of seconds - use milliseconds only
+  qsizetype pos = 19;
+  int millis = 0;
+  if(pos < size && (str.at(pos) == QLatin1Char('.') || str.at(pos) == QLatin1Char(',')))
+  {
+    qsizetype start = ++pos;
+    for(int scale = 100; pos < size && str.at(pos).unicode() >= u'0' && str.at(pos).unicode() <= u'9'; pos++, scale /= 10)
+      millis += (str.at(pos).unicode() - u'0') * scale;
+
+    if(pos == start)
+      return -1L;
+  }
+
+  int offsetMin = 0;
+  if(pos == size)
+  {
+    // No offset given which means local time - rare and left to Qt
+    QDateTime datetime = QDateTime::fromString(str.toString(), Qt::ISODateWithMs);
+    return datetime.isValid() ? datetime.toMSecsSinceEpoch() : -1L;
+  }
+  else if((str.at(pos) == QLatin1Char('Z') || str.at(pos) == QLatin1Char('z')) && pos + 1 == size)
+    offsetMin = 0;
+  else if(str.at(pos) == QLatin1Char('+') || str.at(pos) == QLatin1Char('-'))
+  {
+    // +HH:mm, +HHmm or +HH
+    int sign = str.at(pos) == QLatin1Char('-') ? -1 : 1;
+    QStringView offset = str.mid(pos + 1);
+    int offsetHour = -1, offsetMinute = 0;
+
+    if(offset.size() == 2)
+      offsetHour = isoDigits(offset, 0, 2);
+    else if(offset.size() == 4)
+    {
+      offsetHour = isoDigits(offset, 0, 2);
+      offsetMinute = isoDigits(offset, 2, 2);
+    }
+    else if(offset.size() == 5 && offset.at(2) == QLatin1Char(':'))
+    {
+      offsetHour = isoDigits(offset, 0, 2);
+      offsetMinute = isoDigits(offset, 3, 2);
+    }
+
+    if(offsetHour < 0 || offsetHour > 23 || offsetMinute < 0 || offsetMinute > 59)
+      return -1L;
+
+    offsetMin = sign * (offsetHour * 60 + offsetMinute);
+  }
+  else
+    return -1L;
+
+  qint64 seconds = isoDaysFromCivil(year, month, day) * 86400L + hour * 3600L + minute * 60L + second - offsetMin * 60L;
+  return seconds * 1000L + millis;
+}
+
 QString GpxIO::saveGpxStr(const atools::fs::gpx::GpxData& gpxData)
 {
   QString gpxString;
@@ -115,8 +221,18 @@ QString GpxIO::saveGpxStr(const atools::fs::gpx::GpxData& gpxData)
 
 QByteArray GpxIO::saveGpxGz(const atools::fs::gpx::GpxData& gpxData)
 {
+  // Compress while writing to avoid keeping the whole uncompressed XML in memory
   QByteArray retval;
-  atools::zip::gzipCompress(saveGpxStr(gpxData).toUtf8(), retval);
+  QBuffer buffer(&retval);
+  buffer.open(QIODevice::WriteOnly);
+
+  atools::zip::GzipDevice gzipDevice(&buffer);
+  gzipDevice.open(QIODevice::WriteOnly);
+
+  QXmlStreamWriter writer(&gzipDevice);
+  saveGpxInternal(writer, gpxData);
+
+  gzipDevice.close();
   return retval;
 }
 
@@ -134,6 +250,37 @@ void GpxIO::saveGpx(const QString& filename, const atools::fs::gpx::GpxData& gpx
 }
 
 void GpxIO::saveGpxInternal(QXmlStreamWriter& writer, const atools::fs::gpx::GpxData& gpxData)
+{
+  const Flightplan& flightplan = gpxData.getFlightplan();
+  writeGpxStart(writer, flightplan);
+
+  // Write track ========================================================
+  if(gpxData.hasTrails())
+  {
+    writer.writeStartElement("trk");
+
+    if(!flightplan.isEmpty())
+      writer.writeTextElement("name", QCoreApplication::applicationName() + tr(" - Track"));
+
+    for(const TrailPoints& track : gpxData.getTrails())
+    {
+      if(track.isEmpty())
+        continue;
+
+      writer.writeStartElement("trkseg");
+
+      for(const TrailPoint& pos : track)
+        writeTrailPoint(writer, pos);
+
+      writer.writeEndElement(); // trkseg
+    }
+    writer.writeEndElement(); // trk
+  }
+
+  writeGpxEnd(writer);
+}
+
+void GpxIO::writeGpxStart(QXmlStreamWriter& writer, const atools::fs::pln::Flightplan& flightplan)
 {
   writer.setAutoFormatting(true);
   writer.setAutoFormattingIndent(2);
@@ -171,7 +318,6 @@ void GpxIO::saveGpxInternal(QXmlStreamWriter& writer, const atools::fs::gpx::Gpx
   writer.writeEndElement(); // link
   writer.writeEndElement(); // metadata
 
-  const Flightplan& flightplan = gpxData.getFlightplan();
   if(!flightplan.isEmpty())
   {
     writer.writeStartElement("rte");
@@ -217,45 +363,29 @@ void GpxIO::saveGpxInternal(QXmlStreamWriter& writer, const atools::fs::gpx::Gpx
 
     writer.writeEndElement(); // rte
   }
+}
 
-  // Write track ========================================================
-  if(gpxData.hasTrails())
-  {
-    writer.writeStartElement("trk");
-
-    if(!flightplan.isEmpty())
-      writer.writeTextElement("name", QCoreApplication::applicationName() + tr(" - Track"));
-
-    for(const TrailPoints& track : gpxData.getTrails())
-    {
-      if(track.isEmpty())
-        continue;
-
-      writer.writeStartElement("trkseg");
-
-      for(const TrailPoint& pos : track)
-      {
-        writer.writeStartElement("trkpt");
-
-        writer.writeAttribute("lon", QString::number(pos.pos.getLonX(), 'f', 6));
-        writer.writeAttribute("lat", QString::number(pos.pos.getLatY(), 'f', 6));
-        writer.writeTextElement("ele", QString::number(atools::geo::feetToMeter(pos.pos.getAltitude())));
+void GpxIO::writeTrailPoint(QXmlStreamWriter& writer, const TrailPoint& point)
+{
+  writer.writeStartElement("trkpt");
 
-        if(pos.timestampMs > 0)
-        {
-          // (UTC/Zulu) in ISO 8601 format: "yyyy-mm-ddThh:mm:ssZ" or "yyyy-MM-ddTHH:mm:ss.zzzZ"
-          // <time>2011-01-16T23:59:01Z</time>
-          // Changes time number to local if Qt::UTC is omitted
-          writer.writeTextElement("time", QDateTime::fromMSecsSinceEpoch(pos.timestampMs, QTimeZone::UTC).toString(Qt::ISODateWithMs));
-        }
+  writer.writeAttribute("lon", QString::number(point.pos.getLonX(), 'f', 6));
+  writer.writeAttribute("lat", QString::number(point.pos.getLatY(), 'f', 6));
+  writer.writeTextElement("ele", QString::number(atools::geo::feetToMeter(point.pos.getAltitude())));
 
-        writer.writeEndElement(); // trkpt
-      }
-      writer.writeEndElement(); // trkseg
-    }
-    writer.writeEndElement(); // trk
+  if(point.timestampMs > 0)
+  {
+    // (UTC/Zulu) in ISO 8601 format: "yyyy-mm-ddThh:mm:ssZ" or "yyyy-MM-ddTHH:mm:ss.zzzZ"
+    // <time>2011-01-16T23:59:01Z</time>
+    // Changes time number to local if Qt::UTC is omitted
+    writer.writeTextElement("time", QDateTime::fromMSecsSinceEpoch(point.timestampMs, QTimeZone::UTC).toString(Qt::ISODateWithMs));
   }
 
+  writer.writeEndElement(); // trkpt
+}
+
+void GpxIO::writeGpxEnd(QXmlStreamWriter& writer)
+{
   writer.writeEndElement(); // gpx
   writer.writeEndDocument();
 }
@@ -272,7 +402,18 @@ void GpxIO::loadGpxStr(atools::fs::gpx::GpxData& gpxData, const QString& string)
 void GpxIO::loadGpxGz(atools::fs::gpx::GpxData& gpxData, const QByteArray& bytes)
 {
   if(!bytes.isEmpty())
-    loadGpxStr(gpxData, atools::zip::gzipDecompress(bytes));
+  {
+    // Decompress while parsing to avoid keeping the whole uncompressed XML in memory
+    QBuffer buffer;
+    buffer.setData(bytes);
+    buffer.open(QIODevice::ReadOnly);
+
+    atools::zip::GzipDevice gzipDevice(&buffer);
+    gzipDevice.open(QIODevice::ReadOnly);
+
+    atools::util::XmlStream xmlStream(&gzipDevice);
+    loadGpxInternal(gpxData, xmlStream);
+  }
 }
 
 void GpxIO::loadGpx(atools::fs::gpx::GpxData& gpxData, const QString& filename)
@@ -294,6 +435,7 @@ void GpxIO::loadGpxInternal(atools::fs::gpx::GpxData& gpxData, atools::util::Xml
   xmlStream.readUntilElement("gpx");
   PosD pos;
   QString name;
+  qint64 timestampMs;
   gpxData.clear();
 
   while(xmlStream.readNextStartElement())
@@ -305,7 +447,7 @@ void GpxIO::loadGpxInternal(atools::fs::gpx::GpxData& gpxData, atools::util::Xml
       {
         if(reader.name() == QLatin1String("rtept"))
         {
-          readPosGpx(pos, name, xmlStream);
+          readPosGpx(pos, &name, xmlStream);
           if(pos.isValidRange())
           {
             atools::fs::pln::FlightplanEntry entry;
@@ -331,10 +473,9 @@ void GpxIO::loadGpxInternal(atools::fs::gpx::GpxData& gpxData, atools::util::Xml
           {
             if(reader.name() == QLatin1String("trkpt"))
             {
-              QDateTime datetime;
-              readPosGpx(pos, name, xmlStream, &datetime);
+              readPosGpx(pos, nullptr, xmlStream, &timestampMs);
               if(pos.isValidRange())
-                line.append(atools::fs::gpx::TrailPoint(pos, datetime.toMSecsSinceEpoch()));
+                line.append(atools::fs::gpx::TrailPoint(pos, timestampMs));
             }
             else
               xmlStream.skipCurrentElement(false /* warn */);
@@ -353,6 +494,170 @@ void GpxIO::loadGpxInternal(atools::fs::gpx::GpxData& gpxData, atools::util::Xml
   gpxData.adjustDepartureAndDestinationFlightplan();
 }
 
+bool GpxIO::readTrack(atools::util::XmlStream& xmlStream, int& segment, const TrailPointReadCallback& trailCallback)
+{
+  QXmlStreamReader& reader = xmlStream.getReader();
+  PosD pos;
+  qint64 timestampMs;
+
+  while(xmlStream.readNextStartElement())
+  {
+    if(reader.name() == QLatin1String("trkseg"))
+    {
+      while(xmlStream.readNextStartElement())
+      {
+        if(reader.name() == QLatin1String("trkpt"))
+        {
+          readPosGpx(pos, nullptr, xmlStream, &timestampMs);
+          if(pos.isValidRange() && !trailCallback(segment, TrailPoint(pos, timestampMs)))
+            return false;
+        }
+        else
+          xmlStream.skipCurrentElement(false /* warn */);
+      }
+      segment++;
+    }
+    else
+      xmlStream.skipCurrentElement(false /* warn */);
+  }
+  return true;
+}
+
+void GpxIO::readGpxStream(QIODevice *device, const TrailPointReadCallback& trailCallback,
+                          const RouteEntryReadCallback& routeCallback)
+{
+  QFileDevice *fileDevice = dynamic_cast<QFileDevice *>(device);
+  QString filename = fileDevice != nullptr ? fileDevice->fileName() : QString();
+
+  // Decompress on the fly if data starts with Gzip magic number
+  atools::zip::GzipDevice gzipDevice(device);
+  QIODevice *input = device;
+  if(device->peek(2) == QByteArray("\x1f\x8b", 2))
+  {
+    if(!gzipDevice.open(QIODevice::ReadOnly))
+      throw Exception(errorMsg.arg(filename).arg(gzipDevice.errorString()));
+    input = &gzipDevice;
+  }
+
+  atools::util::XmlStream xmlStream(input, filename);
+  QXmlStreamReader& reader = xmlStream.getReader();
+  xmlStream.readUntilElement("gpx");
+  PosD pos;
+  QString name;
+  int segment = 0;
+
+  while(xmlStream.readNextStartElement())
+  {
+    if(reader.name() == QLatin1String("rte") && routeCallback)
+    {
+      while(xmlStream.readNextStartElement())
+      {
+        if(reader.name() == QLatin1String("rtept"))
+        {
+          readPosGpx(pos, &name, xmlStream);
+          if(pos.isValidRange())
+          {
+            atools::fs::pln::FlightplanEntry entry;
+            entry.setIdent(name);
+            entry.setPosition(pos.asPos());
+            routeCallback(entry);
+          }
+        }
+        else
+          xmlStream.skipCurrentElement(false /* warn */);
+      }
+    }
+    else if(reader.name() == QLatin1String("trk") && trailCallback)
+    {
+      if(!readTrack(xmlStream, segment, trailCallback))
+        // Stopped by callback
+        break;
+    }
+    else
+      xmlStream.skipCurrentElement(false /* warn */);
+  }
+}
+
+void GpxIO::readGpxStream(const QString& filename, const TrailPointReadCallback& trailCallback,
+                          const RouteEntryReadCallback& routeCallback)
+{
+  QFile gpxFile(filename);
+  if(gpxFile.open(QIODevice::ReadOnly))
+  {
+    readGpxStream(&gpxFile, trailCallback, routeCallback);
+    gpxFile.close();
+  }
+  else
+    throw Exception(errorMsg.arg(filename).arg(gpxFile.errorString()));
+}
+
+void GpxIO::writeGpxStream(QIODevice *device, const atools::fs::pln::Flightplan& flightplan,
+                           const TrailPointWriteCallback& trailCallback, bool compress)
+{
+  atools::zip::GzipDevice gzipDevice(device);
+  if(compress && !gzipDevice.open(QIODevice::WriteOnly))
+    throw Exception(errorMsg.arg(QString()).arg(gzipDevice.errorString()));
+
+  QXmlStreamWriter writer(compress ? static_cast<QIODevice *>(&gzipDevice) : device);
+  writeGpxStart(writer, flightplan);
+
+  // Write track ========================================================
+  TrailPoint point;
+  bool newSegment = false, trackOpen = false, segmentOpen = false;
+  while(trailCallback && trailCallback(point, newSegment))
+  {
+    if(!trackOpen)
+    {
+      writer.writeStartElement("trk");
+      if(!flightplan.isEmpty())
+        writer.writeTextElement("name", QCoreApplication::applicationName() + tr(" - Track"));
+      trackOpen = true;
+    }
+
+    if(newSegment && segmentOpen)
+    {
+      writer.writeEndElement(); // trkseg
+      segmentOpen = false;
+    }
+
+    if(!segmentOpen)
+    {
+      writer.writeStartElement("trkseg");
+      segmentOpen = true;
+    }
+
+    writeTrailPoint(writer, point);
+    newSegment = false;
+  }
+
+  if(segmentOpen)
+    writer.writeEndElement(); // trkseg
+  if(trackOpen)
+    writer.writeEndElement(); // trk
+
+  writeGpxEnd(writer);
+
+  if(compress)
+    // Write remaining data and trailer
+    gzipDevice.close();
+
+  if(writer.hasError())
+    throw Exception(errorMsg.arg(QString()).arg(compress ? gzipDevice.errorString() : device->errorString()));
+}
+
+void GpxIO::writeGpxStream(const QString& filename, const atools::fs::pln::Flightplan& flightplan,
+                           const TrailPointWriteCallback& trailCallback, bool compress)
+{
+  QFile gpxFile(filename);
+  if(gpxFile.open(QIODevice::WriteOnly))
+  {
+    writeGpxStream(&gpxFile, flightplan, trailCallback, compress);
+    gpxFile.close();
+  }
+  else
+    throw Exception(errorMsg.arg(filename).arg(gpxFile.errorString()));
+}
+
 } // namespace gpx
 } // namespace fs
 } // namespace atools
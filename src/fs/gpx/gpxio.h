@@ -20,13 +20,20 @@
 
 #include <QCoreApplication>
 
+#include <functional>
+
 class QXmlStreamReader;
 class QXmlStreamWriter;
 class QTextStream;
+class QIODevice;
 
 namespace atools {
 
 namespace fs {
+namespace pln {
+class Flightplan;
+class FlightplanEntry;
+}
 }
 namespace util {
 class XmlStream;
@@ -42,6 +49,18 @@ namespace fs {
 namespace gpx {
 
 class GpxData;
+struct TrailPoint;
+
+/* Called for each track point while reading a stream. segment is the index of the containing <trkseg>.
+ * Return false to stop reading. */
+typedef std::function<bool(int segment, const atools::fs::gpx::TrailPoint& point)> TrailPointReadCallback;
+
+/* Called for each route point while reading a stream */
+typedef std::function<void(const atools::fs::pln::FlightplanEntry& entry)> RouteEntryReadCallback;
+
+/* Called to get the next track point while writing a stream. Return false if there are no more points.
+ * Set newSegment to true to start a new <trkseg> with this point. */
+typedef std::function<bool(atools::fs::gpx::TrailPoint& point, bool& newSegment)> TrailPointWriteCallback;
 
 /*
  * Collects all save and load methods for GPX files.
@@ -73,10 +92,38 @@ public:
   void loadGpxGz(atools::fs::gpx::GpxData& gpxData, const QByteArray& bytes);
   void loadGpx(atools::fs::gpx::GpxData& gpxData, const QString& filename);
 
+  /* Streaming reader for large tracks. Plain or Gzip compressed data is detected automatically.
+   * Track and route points are passed to the callbacks one by one instead of collecting them in memory.
+   * Either callback can be null. Throws Exception on error. */
+  void readGpxStream(QIODevice *device, const TrailPointReadCallback& trailCallback,
+                     const RouteEntryReadCallback& routeCallback = nullptr);
+  void readGpxStream(const QString& filename, const TrailPointReadCallback& trailCallback,
+                     const RouteEntryReadCallback& routeCallback = nullptr);
+
+  /* Streaming writer for large tracks. Writes flight plan as route and then fetches track points one by one from
+   * the callback. Output is compressed incrementally if compress is true. Throws Exception on error. */
+  void writeGpxStream(QIODevice *device, const atools::fs::pln::Flightplan& flightplan,
+                      const TrailPointWriteCallback& trailCallback, bool compress);
+  void writeGpxStream(const QString& filename, const atools::fs::pln::Flightplan& flightplan,
+                      const TrailPointWriteCallback& trailCallback, bool compress);
+
+  /* Parses ISO 8601 timestamps like "2011-01-16T23:59:01Z", "2011-01-16T23:59:01.123Z" or with offset "+02:00".
+   * Returns milliseconds since epoch or -1 if the format is not valid. Does not allocate memory.
+   * Timestamps without offset are local time and are converted using QDateTime. */
+  static qint64 parseIsoTimestampMs(QStringView str);
+
 private:
   void saveGpxInternal(QXmlStreamWriter& writer, const atools::fs::gpx::GpxData& gpxData);
   void loadGpxInternal(atools::fs::gpx::GpxData& gpxData, util::XmlStream& xmlStream);
-  void readPosGpx(atools::geo::PosD& pos, QString& name, util::XmlStream& xmlStream, QDateTime *timestamp = nullptr);
+  void readPosGpx(atools::geo::PosD& pos, QString *name, util::XmlStream& xmlStream, qint64 *timestampMs = nullptr);
+
+  /* Write document start, metadata, route from flight plan and document end */
+  void writeGpxStart(QXmlStreamWriter& writer, const atools::fs::pln::Flightplan& flightplan);
+  void writeTrailPoint(QXmlStreamWriter& writer, const atools::fs::gpx::TrailPoint& point);
+  void writeGpxEnd(QXmlStreamWriter& writer);
+
+  /* Reads the content of <trk> and passes points to the callback. Returns false if stopped by callback. */
+  bool readTrack(util::XmlStream& xmlStream, int& segment, const TrailPointReadCallback& trailCallback);
 
   QString errorMsg;
 };
@@ -60,6 +60,15 @@ void GpxData::setFlightplan(const pln::Flightplan& value)
     flightplanRect.extend(entry.getPosition());
 }
 
+qint64 GpxData::getMemorySize() const
+{
+  // Entries contain several strings and property maps which are roughly covered by the constant
+  return static_cast<qint64>(sizeof(GpxData)) +
+         static_cast<qint64>(numPoints) * static_cast<qint64>(sizeof(TrailPoint)) +
+         static_cast<qint64>(trails.size()) * static_cast<qint64>(sizeof(TrailPoints)) +
+         static_cast<qint64>(flightplan.size()) * static_cast<qint64>(sizeof(atools::fs::pln::FlightplanEntry) + 256);
+}
+
 } // namespace gpx
 } // namespace fs
 } // namespace atools
@@ -89,6 +89,9 @@ public:
     return numPoints;
   }
 
+  /* Estimated size in bytes of the decoded data in memory. Used as cost for caches. */
+  qint64 getMemorySize() const;
+
   // Setters =========================================================
   void clear();
 
@@ -24,6 +24,7 @@
 #include "fs/db/countryupdater.h"
 #include "fs/db/databasemeta.h"
 #include "fs/db/datawriter.h"
+#include "fs/db/navsnapshotwriter.h"
 #include "fs/dfd/dfdcompiler.h"
 #include "fs/progresshandler.h"
 #include "fs/sc/db/simconnectloader.h"
@@ -36,19 +37,31 @@
 #include "fs/scenery/manifestjson.h"
 #include "fs/scenery/materiallib.h"
 #include "fs/scenery/scenerycfg.h"
+#include "fs/scenery/scenerychangedetector.h"
+#include "fs/scenery/sceneryfilecache.h"
 #include "fs/util/fsutil.h"
 #include "fs/xp/xpdatacompiler.h"
+#include "geo/rect.h"
 #include "sql/sqldatabase.h"
+#include "sql/sqlexception.h"
 #include "sql/sqlscript.h"
 #include "sql/sqltransaction.h"
 #include "sql/sqlutil.h"
+#include "util/memoryusage.h"
+#include "util/tracer.h"
 
+#include <QDateTime>
 #include <QDir>
 #include <QElapsedTimer>
+#include <QFile>
 #include <QProcessEnvironment>
 #include <QQueue>
 #include <QStandardPaths>
 #include <QStringBuilder>
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
 
 namespace atools {
 namespace fs {
@@ -71,6 +84,10 @@ static const int PROGRESS_NUM_RESOLVE_AIRWAY_STEPS = 1000;
 // createSchemaInternal()
 static const int PROGRESS_NUM_SCHEMA_STEPS = 8;
 
+// Minimum available physical memory to compile into a memory database. Twice the size of an existing database
+// file is required if larger.
+static const qint64 IN_MEMORY_MIN_AVAILABLE_BYTES = 4LL * 1024 * 1024 * 1024;
+
 using atools::sql::SqlScript;
 using atools::sql::SqlQuery;
 using atools::sql::SqlUtil;
@@ -88,24 +105,50 @@ NavDatabase::NavDatabase(const NavDatabaseOptions& readerOptions, sql::SqlDataba
                          const QString& revision)
   : db(sqlDb), errors(databaseErrors), options(readerOptions), gitRevision(revision)
 {
-
+  sceneryFileCache = new atools::fs::scenery::SceneryFileCache;
 }
 
 NavDatabase::~NavDatabase()
 {
   ATOOLS_DELETE_LOG(simconnectLoader);
+  ATOOLS_DELETE_LOG(sceneryFileCache);
 }
 
 atools::fs::ResultFlags NavDatabase::compileDatabase()
 {
   qDebug() << Q_FUNC_INFO << options;
 
-  QString sceneryCfgCodec;
+  // Switch to a memory database if requested and possible. Empty if compiling into the file.
+  QString memoryTargetFile = openMemoryDatabase();
+
+  // Autocommit does not use transactions which are needed to change the pragmas
+  bool bulkLoad = options.isBulkLoad() && !options.isAutocommit();
+  if(bulkLoad)
+  {
+    // Index creation in the post-load scripts cannot run on separate connections since the database is
+    // locked exclusively while loading. Let SQLite sort with worker threads instead. Number excludes calling thread.
+    int sorterThreads = options.getNumSorterThreads() > 0 ? options.getNumSorterThreads() : QThread::idealThreadCount();
+    db.beginBulkLoad(256 * 1024, sorterThreads - 1);
+  }
 
-  sceneryCfgCodec = (options.getSimulatorType() == FsPaths::P3D_V4 || options.getSimulatorType() == FsPaths::P3D_V5 ||
-                     options.getSimulatorType() == FsPaths::P3D_V6) ? "UTF-8" : QStringLiteral();
+  atools::fs::ResultFlags result = COMPILE_NONE;
+  try
+  {
+    result = createInternal(sceneryConfigCodec());
+  }
+  catch(...)
+  {
+    if(bulkLoad)
+    {
+      db.rollback();
+      db.endBulkLoad();
+    }
+
+    // Drop memory database and keep file untouched
+    closeMemoryDatabase(memoryTargetFile, false /* persist */);
+    throw;
+  }
 
-  atools::fs::ResultFlags result = createInternal(sceneryCfgCodec);
   if(aborted)
   {
     qDebug() << Q_FUNC_INFO << "COMPILE_CANCELED";
@@ -117,6 +160,12 @@ atools::fs::ResultFlags NavDatabase::compileDatabase()
   else
     createDatabaseReportShort();
 
+  if(bulkLoad)
+    db.endBulkLoad();
+
+  // Write memory database to file if not canceled
+  closeMemoryDatabase(memoryTargetFile, !aborted /* persist */);
+
   if(result.testFlag(atools::fs::COMPILE_BASIC_VALIDATION_ERROR))
   {
     qWarning() << Qt::endl;
@@ -197,6 +246,129 @@ void NavDatabase::createSimConnectLoader()
 #endif
 }
 
+bool NavDatabase::detectSceneryChanges(atools::sql::SqlDatabase& compiledDb, scenery::SceneryChanges& changes)
+{
+  FsPaths::SimulatorType sim = options.getSimulatorType();
+  if(FsPaths::isAnyXplane(sim) || sim == FsPaths::NAVIGRAPH || sim == FsPaths::MSFS_2024)
+  {
+    qInfo() << Q_FUNC_INFO << "Change detection not supported for" << FsPaths::typeToShortName(sim);
+    return false;
+  }
+
+  if(!SqlUtil(compiledDb).hasTableAndRows(QStringLiteral("bgl_file")))
+  {
+    qInfo() << Q_FUNC_INFO << "No files in database" << compiledDb.databaseName();
+    return false;
+  }
+
+  SceneryCfg sceneryCfg(sceneryConfigCodec());
+  if(sim == FsPaths::MSFS)
+    readSceneryConfigMsfs(sceneryCfg);
+  else
+    readSceneryConfigFsxP3d(sceneryCfg);
+  readSceneryConfigIncludePathsFsxP3dMsfs(sceneryCfg);
+
+  changes = scenery::SceneryChangeDetector(options, compiledDb).detect(sceneryCfg.getAreas());
+  return true;
+}
+
+QString NavDatabase::openMemoryDatabase()
+{
+  if(!options.isInMemory())
+    return QString();
+
+  QString targetFile = db.databaseName();
+  if(targetFile.isEmpty() || targetFile == QStringLiteral(":memory:"))
+    return QString();
+
+  // Use size of the last compiled database as estimate
+  qint64 required = std::max(IN_MEMORY_MIN_AVAILABLE_BYTES, QFileInfo(targetFile).size() * 2);
+  qint64 available = atools::util::MemoryUsage::getAvailablePhysicalBytes();
+  if(available < required)
+  {
+    qInfo() << Q_FUNC_INFO << "Not enough memory for in-memory compilation. Available" << available / 1024 / 1024
+            << "MB required" << required / 1024 / 1024 << "MB. Compiling into" << targetFile;
+    return QString();
+  }
+
+  qInfo() << Q_FUNC_INFO << "Compiling into memory database for" << targetFile << "available" << available / 1024 / 1024 << "MB";
+
+  // Use the same pragmas like page size for the memory database
+  const QStringList pragmas = db.getOpenPragmas();
+  db.close();
+  db.setDatabaseName(QStringLiteral(":memory:"));
+  db.open(pragmas);
+  return targetFile;
+}
+
+void NavDatabase::closeMemoryDatabase(const QString& targetFile, bool persist)
+{
+  if(targetFile.isEmpty())
+    return;
+
+  // Reopen the file database in any case
+  const QStringList pragmas = db.getOpenPragmas();
+  auto reopenFile = [this, &targetFile, &pragmas]() -> void {
+                      db.close();
+                      db.setDatabaseName(targetFile);
+                      db.open(pragmas);
+                    };
+
+  if(persist)
+  {
+    // Write into a temporary file in the same directory first to keep the old database if writing fails
+    QString tempFile = targetFile % QStringLiteral(".tmp");
+    try
+    {
+      // Write the whole database sequentially at once
+      QElapsedTimer timer;
+      timer.start();
+      db.vacuumInto(tempFile, options.getPageSize());
+
+      // Replace old database only after the copy was written successfully
+      if(QFile::exists(targetFile) && !QFile::remove(targetFile))
+        throw atools::Exception(tr("Cannot remove \"%1\". New database is kept in \"%2\".").arg(targetFile).arg(tempFile));
+
+      if(!QFile::rename(tempFile, targetFile))
+        throw atools::Exception(tr("Cannot rename \"%1\" to \"%2\".").arg(tempFile).arg(targetFile));
+
+      qInfo() << Q_FUNC_INFO << "Wrote memory database to" << targetFile << "in" << timer.elapsed() << "ms";
+    }
+    catch(const atools::sql::SqlException&)
+    {
+      // Writing failed - remove partial copy and keep the existing database
+      QFile::remove(tempFile);
+      reopenFile();
+      throw;
+    }
+    catch(...)
+    {
+      reopenFile();
+      throw;
+    }
+  }
+
+  reopenFile();
+}
+
+atools::fs::ResultFlags NavDatabase::compileDatabaseIfChanged(atools::sql::SqlDatabase& compiledDb)
+{
+  scenery::SceneryChanges changes;
+  if(detectSceneryChanges(compiledDb, changes) && changes.isEmpty())
+  {
+    qInfo() << Q_FUNC_INFO << "Scenery library unchanged - skipping compilation";
+    return COMPILE_UP_TO_DATE;
+  }
+
+  return compileDatabase();
+}
+
+QString NavDatabase::sceneryConfigCodec() const
+{
+  return (options.getSimulatorType() == FsPaths::P3D_V4 || options.getSimulatorType() == FsPaths::P3D_V5 ||
+          options.getSimulatorType() == FsPaths::P3D_V6) ? QStringLiteral("UTF-8") : QString();
+}
+
 bool NavDatabase::isSceneryConfigValid(const QString& filename, const QString& codec, QStringList& errors)
 {
   errors.append(atools::checkFileMsg(filename));
@@ -332,10 +504,16 @@ int NavDatabase::countXplaneSteps(ProgressHandler *progress)
   total += PROGRESS_NUM_TASK_STEPS; // "Collecting navaids for search"
   total += PROGRESS_NUM_TASK_STEPS; // "Creating indexes for airport"
   total += PROGRESS_NUM_TASK_STEPS; // "Creating indexes for search"
+  if(options.isFullTextSearch())
+    total += PROGRESS_NUM_TASK_STEPS; // "Creating full text search index"
   if(options.isVacuumDatabase())
     total += PROGRESS_NUM_TASK_STEPS; // "Vacuum Database"
   if(options.isAnalyzeDatabase())
     total += PROGRESS_NUM_TASK_STEPS; // "Analyze Database"
+  if(!options.getNavSnapshotFile().isEmpty())
+    total += PROGRESS_NUM_TASK_STEPS; // "Writing navigation snapshot"
+  if(!options.getCompactDatabaseFile().isEmpty())
+    total += PROGRESS_NUM_TASK_STEPS; // "Compacting Database"
 
   // Not used in production
   // if(options.isDatabaseReport())
@@ -441,6 +619,8 @@ int NavDatabase::countDfdSteps()
 
   total += PROGRESS_NUM_TASK_STEPS; // "Creating indexes for airport"
   total += PROGRESS_NUM_TASK_STEPS; // "Creating indexes for search"
+  if(options.isFullTextSearch())
+    total += PROGRESS_NUM_TASK_STEPS; // "Creating full text search index"
   total++; // "Creating indexes for route"
   if(options.isDatabaseReport())
     // "Basic Validation"
@@ -462,6 +642,14 @@ int NavDatabase::countDfdSteps()
   if(options.isAnalyzeDatabase())
     total += PROGRESS_NUM_TASK_STEPS;
 
+  // "Writing navigation snapshot"
+  if(!options.getNavSnapshotFile().isEmpty())
+    total += PROGRESS_NUM_TASK_STEPS;
+
+  // "Compacting Database"
+  if(!options.getCompactDatabaseFile().isEmpty())
+    total += PROGRESS_NUM_TASK_STEPS;
+
   total += 4; // Correction value
 
   return total;
@@ -576,6 +764,8 @@ int NavDatabase::countMsSimSteps()
   total += PROGRESS_NUM_TASK_STEPS; // "Creating indexes for airport"
   total += PROGRESS_NUM_TASK_STEPS; // "Clean up runways"
   total += PROGRESS_NUM_TASK_STEPS; // "Creating indexes for search"
+  if(options.isFullTextSearch())
+    total += PROGRESS_NUM_TASK_STEPS; // "Creating full text search index"
   total += PROGRESS_NUM_TASK_STEPS; // "Calculating airport rating"
 
   if(options.isVacuumDatabase())
@@ -583,6 +773,10 @@ int NavDatabase::countMsSimSteps()
 
   if(options.isAnalyzeDatabase())
     total += PROGRESS_NUM_TASK_STEPS; // "Analyze Database"
+  if(!options.getNavSnapshotFile().isEmpty())
+    total += PROGRESS_NUM_TASK_STEPS; // "Writing navigation snapshot"
+  if(!options.getCompactDatabaseFile().isEmpty())
+    total += PROGRESS_NUM_TASK_STEPS; // "Compacting Database"
 
   // Not used in production
   // if(options.isDatabaseReport())
@@ -592,6 +786,8 @@ int NavDatabase::countMsSimSteps()
 
 atools::fs::ResultFlags NavDatabase::createInternal(const QString& sceneryConfigCodec)
 {
+  ATOOLS_TRACE_SPAN("NavDatabase::createInternal");
+
   result = atools::fs::COMPILE_NONE;
   SceneryCfg sceneryCfg(sceneryConfigCodec);
 
@@ -600,7 +796,9 @@ atools::fs::ResultFlags NavDatabase::createInternal(const QString& sceneryConfig
 
   ProgressHandler progress;
   progress.setProgressCallback(options.getProgressCallback());
+  progress.setCancelToken(options.getCancelToken());
   progress.setCallDefaultCallback(options.isCallDefaultCallback());
+  progress.setAsyncInterval(options.getProgressIntervalMs());
 
   progress.setTotal(1000000000);
 
@@ -611,10 +809,14 @@ atools::fs::ResultFlags NavDatabase::createInternal(const QString& sceneryConfig
   if(options.getSimulatorType() == FsPaths::MSFS_2024)
     createSimConnectLoader();
 
+  // Directory listings are shared between counting and loading and reused from the last compilation
+  sceneryFileCache->load(options.getSceneryFileCacheFile());
+
   // ==============================================================================
   // Calculate the total number of progress steps
   FsPaths::SimulatorType sim = options.getSimulatorType();
   int total = 0;
+  progress.startPhase(tr("Scanning files"));
   if(FsPaths::isAnyXplane(sim))
     total = countXplaneSteps(&progress);
   else if(sim == FsPaths::NAVIGRAPH)
@@ -670,6 +872,7 @@ atools::fs::ResultFlags NavDatabase::createInternal(const QString& sceneryConfig
     readSceneryConfigIncludePathsFsxP3dMsfs(sceneryCfg);
     total = countFsxP3dSteps(&progress, sceneryCfg);
   }
+  progress.finishPhase();
 
   if(aborted)
     return result;
@@ -688,6 +891,7 @@ atools::fs::ResultFlags NavDatabase::createInternal(const QString& sceneryConfig
   // Pointers will be initialized on demand/compilation type and be delete on exit (like thrown exception)
   std::unique_ptr<atools::fs::db::DataWriter> fsDataWriter;
   std::unique_ptr<atools::fs::xp::XpDataCompiler> xpDataCompiler;
+  QList<atools::fs::db::AirwayPointRow> xpAirwayPoints;
   std::unique_ptr<atools::fs::ng::DfdCompiler> dfdCompiler;
 
   // MSFS indexes and libraries =========================================
@@ -722,6 +926,7 @@ atools::fs::ResultFlags NavDatabase::createInternal(const QString& sceneryConfig
     // Load X-Plane scenery database ======================================================
     xpDataCompiler.reset(new atools::fs::xp::XpDataCompiler(db, options, &progress, errors));
     loadXplane(&progress, xpDataCompiler.get(), area);
+    xpAirwayPoints = xpDataCompiler->takeAirwayPoints();
     xpDataCompiler->close();
   }
   else if(sim == FsPaths::MSFS || sim == FsPaths::MSFS_2024)
@@ -767,6 +972,7 @@ atools::fs::ResultFlags NavDatabase::createInternal(const QString& sceneryConfig
     }
 
     // Load all community and official scenery/BGL files  =====================================
+    fsDataWriter->setSceneryFileCache(sceneryFileCache);
     loadMsfs(&progress, fsDataWriter.get(), sceneryCfg);
     fsDataWriter->close();
   }
@@ -774,6 +980,7 @@ atools::fs::ResultFlags NavDatabase::createInternal(const QString& sceneryConfig
   {
     // Load FSX / P3D scenery database ======================================================
     fsDataWriter.reset(new atools::fs::db::DataWriter(db, options, &progress));
+    fsDataWriter->setSceneryFileCache(sceneryFileCache);
     loadFsxP3d(&progress, fsDataWriter.get(), sceneryCfg);
     fsDataWriter->close();
   }
@@ -781,6 +988,9 @@ atools::fs::ResultFlags NavDatabase::createInternal(const QString& sceneryConfig
   if(aborted)
     return result;
 
+  // All directories were read - keep listings for the next compilation
+  sceneryFileCache->save(options.getSceneryFileCacheFile());
+
   // ===========================================================================
   // Loading is done here - now continue with the post process steps
 
@@ -790,14 +1000,23 @@ atools::fs::ResultFlags NavDatabase::createInternal(const QString& sceneryConfig
     // Read tmp_airway_point table, connect all waypoints and write the ordered result into the airway table
     atools::fs::db::AirwayResolver resolver(db, progress);
 
+    if(FsPaths::isAnyXplane(sim))
+    {
+      // X-Plane airway points are passed in memory and not stored in tmp_airway_point
+      resolver.setAirwayPoints(xpAirwayPoints);
+      xpAirwayPoints.clear();
+    }
+
     if(sim != FsPaths::NAVIGRAPH && !FsPaths::isAnyXplane(sim))
       // Drop large segments only for the borked data of FSX/P3D/MSFS - default is 8000 nm
       resolver.setMaxAirwaySegmentLengthNm(800.f);
 
+    progress.startPhase(tr("Resolving airways"));
     resolver.assignWaypointIds();
 
     if((aborted = resolver.run(PROGRESS_NUM_RESOLVE_AIRWAY_STEPS)))
       return result;
+    progress.finishPhase(0, SqlUtil(db).rowCount("airway"));
   }
 
   if(!FsPaths::isAnyXplane(sim) && sim != FsPaths::NAVIGRAPH && sim != FsPaths::MSFS && sim != FsPaths::MSFS_2024)
@@ -864,9 +1083,20 @@ atools::fs::ResultFlags NavDatabase::createInternal(const QString& sceneryConfig
     if((aborted = progress.reportOther(tr("Calculating airport rating"))))
       return result;
 
+    progress.startPhase(tr("Calculating airport rating"));
     calculateRating(sim);
+    progress.finishPhase();
   }
 
+  // Cell ids for all simulators and navdata sources after all coordinates are final
+  if((aborted = progress.reportOtherMsg(tr("Calculating cell ids"))))
+    return result;
+
+  progress.startPhase(tr("Calculating cell ids"));
+  updateCellIds();
+  updateMinZoom();
+  progress.finishPhase();
+
   if((aborted = runScript(&progress, "fs/db/finish_airport_schema.sql", tr("Creating indexes for airport"))))
     return result;
 
@@ -881,6 +1111,12 @@ atools::fs::ResultFlags NavDatabase::createInternal(const QString& sceneryConfig
                            tr("Creating indexes for search"))))
     return result;
 
+  if(options.isFullTextSearch())
+  {
+    if((aborted = runScript(&progress, "fs/db/create_fts.sql", tr("Creating full text search index"))))
+      return result;
+  }
+
   if(sim == FsPaths::MSFS)
   {
     if((aborted = progress.reportOther(tr("Loading translations"))))
@@ -958,7 +1194,9 @@ atools::fs::ResultFlags NavDatabase::createInternal(const QString& sceneryConfig
     if((aborted = progress.reportOtherInc(tr("Vacuum Database"), PROGRESS_NUM_TASK_STEPS)))
       return result;
 
-    db.vacuum();
+    progress.startPhase(tr("Vacuum Database"));
+    db.vacuum(options.getPageSize());
+    progress.finishPhase();
   }
 
   if(options.isAnalyzeDatabase())
@@ -966,12 +1204,40 @@ atools::fs::ResultFlags NavDatabase::createInternal(const QString& sceneryConfig
     if((aborted = progress.reportOtherInc(tr("Analyze Database"), PROGRESS_NUM_TASK_STEPS)))
       return result;
 
+    progress.startPhase(tr("Analyze Database"));
     db.analyze();
+    progress.finishPhase();
+  }
+
+  if(options.isVacuumDatabase() || options.isAnalyzeDatabase() || !options.getCompactDatabaseFile().isEmpty())
+    updateDatabaseStatistics();
+
+  if(!options.getNavSnapshotFile().isEmpty())
+  {
+    if((aborted = progress.reportOtherInc(tr("Writing navigation snapshot"), PROGRESS_NUM_TASK_STEPS)))
+      return result;
+
+    // Failure is not fatal since the runtime falls back to the database
+    progress.startPhase(tr("Writing navigation snapshot"));
+    atools::fs::db::NavSnapshotWriter(db).writeToFile(options.getNavSnapshotFile());
+    progress.finishPhase();
+  }
+
+  if(!options.getCompactDatabaseFile().isEmpty())
+  {
+    if((aborted = progress.reportOtherInc(tr("Compacting Database"), PROGRESS_NUM_TASK_STEPS)))
+      return result;
+
+    // Writes a defragmented copy which also contains the statistics and metadata from above
+    progress.startPhase(tr("Compacting Database"));
+    db.vacuumInto(options.getCompactDatabaseFile(), options.getPageSize());
+    progress.finishPhase();
   }
 
   // Send the final progress report
   progress.reportFinish();
 
+  progress.logPhaseTimes();
   qDebug() << "Time" << timer.elapsed() / 1000 << "seconds";
 
   return result;
@@ -1515,6 +1781,34 @@ void NavDatabase::dropAllIndexes()
   db.commit();
 }
 
+void NavDatabase::updateDatabaseStatistics()
+{
+  auto pragma = [this](const QString& name) -> QString {
+    SqlQuery query("pragma " % name, db);
+    query.exec();
+    return query.next() ? query.valueStr(0) : QString();
+  };
+
+  atools::fs::db::DatabaseMeta databaseMetadata(db);
+  databaseMetadata.addProperty(atools::fs::db::PROPERTYNAME_DB_PAGE_SIZE, pragma("page_size"));
+  databaseMetadata.addProperty(atools::fs::db::PROPERTYNAME_DB_PAGE_COUNT, pragma("page_count"));
+  databaseMetadata.addProperty(atools::fs::db::PROPERTYNAME_DB_FREE_PAGES, pragma("freelist_count"));
+
+  if(options.getPageSize() > 0 && !options.getCompactDatabaseFile().isEmpty())
+    databaseMetadata.addProperty(atools::fs::db::PROPERTYNAME_DB_COMPACT_PAGE_SIZE, QString::number(options.getPageSize()));
+
+  if(options.isAnalyzeDatabase())
+    databaseMetadata.addProperty(atools::fs::db::PROPERTYNAME_DB_ANALYZE_TIMESTAMP,
+                                 QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+
+  // Commits
+  databaseMetadata.updateProperties();
+
+  qInfo() << Q_FUNC_INFO << "page size" << databaseMetadata.getPropertyValue(atools::fs::db::PROPERTYNAME_DB_PAGE_SIZE)
+          << "pages" << databaseMetadata.getPropertyValue(atools::fs::db::PROPERTYNAME_DB_PAGE_COUNT)
+          << "free pages" << databaseMetadata.getPropertyValue(atools::fs::db::PROPERTYNAME_DB_FREE_PAGES);
+}
+
 void NavDatabase::createDatabaseReportShort()
 {
   atools::sql::SqlUtil util(db);
@@ -1595,6 +1889,8 @@ bool NavDatabase::runScripts(ProgressHandler *progress, const QStringList& scrip
       return true;
   }
 
+  QElapsedTimer timer;
+  timer.start();
   for(const QString& scriptFile : scriptFiles)
   {
     if(!scriptFile.isEmpty())
@@ -1604,6 +1900,8 @@ bool NavDatabase::runScripts(ProgressHandler *progress, const QStringList& scrip
     }
   }
 
+  if(progress != nullptr)
+    progress->addPhaseTime(message, timer.elapsed());
   return false;
 }
 
@@ -1617,8 +1915,13 @@ bool NavDatabase::runScript(ProgressHandler *progress, const QString& scriptFile
       return true;
   }
 
+  QElapsedTimer timer;
+  timer.start();
   script.executeScript(":/atools/resources/sql/" % scriptFile);
   db.commit();
+
+  if(progress != nullptr)
+    progress->addPhaseTime(message, timer.elapsed());
   return false;
 }
 
@@ -1654,6 +1957,53 @@ void NavDatabase::calculateRating(FsPaths::SimulatorType sim)
   db.commit();
 }
 
+void NavDatabase::updateCellIds()
+{
+  SqlUtil::UpdateColFuncType func =
+    [](const atools::sql::SqlQuery& from, atools::sql::SqlQuery& to) -> bool {
+      to.bindValue(":cell_id", atools::geo::Rect::cellId(atools::geo::Pos(from.valueFloat("lonx"), from.valueFloat("laty"))));
+      return true;
+    };
+
+  SqlUtil util(db);
+  util.updateColumnInTable("airport", "airport_id", {"lonx", "laty"}, {"cell_id"}, func);
+  util.updateColumnInTable("waypoint", "waypoint_id", {"lonx", "laty"}, {"cell_id"}, func);
+  util.updateColumnInTable("vor", "vor_id", {"lonx", "laty"}, {"cell_id"}, func);
+  util.updateColumnInTable("ndb", "ndb_id", {"lonx", "laty"}, {"cell_id"}, func);
+  util.updateColumnInTable("ils", "ils_id", {"lonx", "laty"}, {"cell_id"}, func);
+  db.commit();
+}
+
+void NavDatabase::updateMinZoom()
+{
+  SqlScript script(db, options.isVerbose());
+  script.executeScript(QStringLiteral(":/atools/resources/sql/fs/db/update_min_zoom.sql"));
+  db.commit();
+}
+
+void NavDatabase::readMsfsPackage(MsfsPackage& package)
+{
+  // Resolve links and junctions
+  package.path = atools::canonicalFilePath(package.path);
+
+  // Read manifest to check type
+  scenery::ManifestJson manifest;
+  manifest.read(package.path % SEP % "manifest.json");
+
+  package.anyScenery = manifest.isAnyScenery();
+  if(package.anyScenery)
+  {
+    // Read BGL and material file locations from layout file
+    scenery::LayoutJson layout;
+    layout.read(package.path % SEP % "layout.json");
+
+    package.scenery = manifest.isScenery();
+    package.fsArchive = layout.hasFsArchive();
+    package.bgl = !layout.getBglPaths().isEmpty();
+    package.navigraphNavdata = isNavigraphNavdata(manifest);
+  }
+}
+
 void NavDatabase::readSceneryConfigMsfs(atools::fs::scenery::SceneryCfg& cfg)
 {
   // Force well known layer piority to avoid mess up due to not documented "Content.xml"
@@ -1744,105 +2094,88 @@ void NavDatabase::readSceneryConfigMsfs(atools::fs::scenery::SceneryCfg& cfg)
     cfg.appendArea(areaNav);
   }
 
-  scenery::LayoutJson layout;
-
-  // Read add-on packages in official ===============================
+  // Read add-on packages in official and community ===============================
   if(options.getSimulatorType() == FsPaths::MSFS)
   {
-    QString path = options.getMsfsOfficialPath();
-    const QDir dirOfficial(path, QStringLiteral(), QDir::Name | QDir::IgnoreCase,
+    // Collect packages first in directory order to read the JSON files in parallel
+    QList<MsfsPackage> packages;
+
+    // C:\Users\alex\AppData\Local\Packages\Microsoft.FlightSimulator_8wekyb3d8bbwe\LocalCache\Packages\Official\OneStore\ADDON
+    const QDir dirOfficial(options.getMsfsOfficialPath(), QStringLiteral(), QDir::Name | QDir::IgnoreCase,
                            QDir::Dirs | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot);
     QString baseName = dirOfficial.dirName();
     const QFileInfoList entriesOfficial = dirOfficial.entryInfoList();
-    for(QFileInfo fileinfo : entriesOfficial)
+    for(const QFileInfo& fileinfo : entriesOfficial)
     {
       QString name = fileinfo.fileName();
-      fileinfo.setFile(atools::canonicalFilePath(fileinfo));
-
-      if(contentXml.isDisabled(name))
-      {
-        // Entry is present in Content.xml and has has active="false"
-        qDebug() << Q_FUNC_INFO << "Skipping disabled" << name;
-        continue;
-      }
-
       if(name == "fs-base-nav" || name == "fs-base" || name == "fs-base-genericairports")
         // Already read before - do not touch name or priority
         continue;
 
-      // Read manifest to check type
-      manifest.clear();
-      manifest.read(fileinfo.filePath() % SEP % "manifest.json");
-
-      if(manifest.isAnyScenery())
-      {
-        // Read BGL and material file locations from layout file
-        layout.clear();
-        layout.read(fileinfo.filePath() % SEP % "layout.json");
-
-        SceneryArea addonArea(contentXml.getPriority(name, LAYER_NUM_DEFAULT), baseName, atools::canonicalFilePath(fileinfo));
-        if(manifest.isScenery() && layout.hasFsArchive() && errors != nullptr)
-          errors->appendSceneryErrors(
-            SceneryErrors(addonArea, tr("Encrypted add-on \"%1\" found. Add-on might not show up correctly.").arg(name),
-                          true /* isWarning */));
-
-        if(!layout.getBglPaths().isEmpty())
-        {
-          // Indicate add-on in official path
-          addonArea.setAddOn(true);
-
-          // Detect Navigraph navdata update packages for special handling
-          addonArea.setMsfsNavigraphNavdata(isNavigraphNavdata(manifest));
-
-          cfg.getAreas().append(addonArea);
-        }
-      }
+      MsfsPackage package;
+      package.name = name;
+      package.path = fileinfo.filePath();
+      packages.append(package);
     }
 
-    // Read community packages ===============================
-    if(options.getSimulatorType() == FsPaths::MSFS)
+    // C:\Users\alex\AppData\Local\Packages\Microsoft.FlightSimulator_8wekyb3d8bbwe\LocalCache\Packages\Community\ADDON
+    const QDir dirCommunity(options.getMsfsCommunityPath(), QStringLiteral(),
+                            QDir::Name | QDir::IgnoreCase, QDir::Dirs | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot);
+    const QFileInfoList entriesCommunity = dirCommunity.entryInfoList();
+    for(const QFileInfo& fileinfo : entriesCommunity)
     {
-      // C:\Users\alex\AppData\Local\Packages\Microsoft.FlightSimulator_8wekyb3d8bbwe\LocalCache\Packages\Community\ADDON
-      const QDir dirCommunity(options.getMsfsCommunityPath(), QStringLiteral(),
-                              QDir::Name | QDir::IgnoreCase, QDir::Dirs | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot);
+      MsfsPackage package;
+      package.name = fileinfo.fileName();
+      package.path = fileinfo.filePath();
+      package.community = true;
+      packages.append(package);
+    }
 
-      const QFileInfoList entriesCommunity = dirCommunity.entryInfoList();
-      for(QFileInfo fileinfo : entriesCommunity)
+    // Remove packages present in Content.xml having active="false"
+    packages.erase(std::remove_if(packages.begin(), packages.end(), [&contentXml](const MsfsPackage& package) -> bool {
+      if(contentXml.isDisabled(package.name))
       {
-        QString name = fileinfo.fileName();
-        fileinfo.setFile(atools::canonicalFilePath(fileinfo));
+        qDebug() << Q_FUNC_INFO << "Skipping disabled" << package.name;
+        return true;
+      }
+      return false;
+    }), packages.end());
+
+    // Read manifest and layout files in parallel - each task writes only into its own package
+    QElapsedTimer timer;
+    timer.start();
+    MsfsPackage *packageData = packages.data();
+    QThreadPool pool;
+    for(int i = 0; i < packages.size(); i++)
+      pool.start([this, packageData, i]() {
+        readMsfsPackage(packageData[i]);
+      });
+    pool.waitForDone();
+    qDebug() << Q_FUNC_INFO << "Read" << packages.size() << "packages in" << timer.elapsed() << "ms";
+
+    // Add areas in directory order ===============================
+    for(const MsfsPackage& package : std::as_const(packages))
+    {
+      if(!package.anyScenery)
+        continue;
 
-        if(contentXml.isDisabled(name))
-        {
-          // Entry is present in Content.xml and has has active="false"
-          qDebug() << Q_FUNC_INFO << "Skipping disabled" << name;
-          continue;
-        }
+      SceneryArea addonArea(contentXml.getPriority(package.name, LAYER_NUM_DEFAULT),
+                            package.community ? tr("Community") : baseName, package.path);
+      addonArea.setCommunity(package.community);
+      if(package.scenery && package.fsArchive && errors != nullptr)
+        errors->appendSceneryErrors(SceneryErrors(addonArea,
+                                                  tr("Encrypted add-on \"%1\" found. Add-on might not show up correctly.").
+                                                  arg(package.name), true /* isWarning */));
 
-        manifest.clear();
-        manifest.read(fileinfo.filePath() % SEP % "manifest.json");
+      if(package.bgl)
+      {
+        // Indicate add-on in official path
+        addonArea.setAddOn(!package.community);
 
-        if(manifest.isAnyScenery())
-        {
-          // Read BGL and material file locations from layout file
-          layout.clear();
-          layout.read(fileinfo.filePath() % SEP % "layout.json");
-
-          SceneryArea addonArea(contentXml.getPriority(name, LAYER_NUM_DEFAULT), tr("Community"), atools::canonicalFilePath(fileinfo));
-          addonArea.setCommunity(true);
-          if(manifest.isScenery() && layout.hasFsArchive() && errors != nullptr)
-            errors->appendSceneryErrors(SceneryErrors(addonArea,
-                                                      tr("Encrypted add-on \"%1\" found. Add-on might not show up correctly.").arg(name),
-                                                      true /* isWarning */));
-
-          if(!layout.getBglPaths().isEmpty())
-          {
-            // Detect Navigraph navdata update packages for special handling
-            addonArea.setMsfsNavigraphNavdata(isNavigraphNavdata(manifest));
+        // Detect Navigraph navdata update packages for special handling
+        addonArea.setMsfsNavigraphNavdata(package.navigraphNavdata);
 
-            cfg.getAreas().append(addonArea);
-          }
-        }
+        cfg.getAreas().append(addonArea);
       }
     }
   }
@@ -2247,6 +2580,7 @@ void NavDatabase::countFiles(ProgressHandler *progress, const QList<atools::fs::
 {
   qDebug() << Q_FUNC_INFO << "Entry";
   atools::fs::scenery::FileResolver resolver(options, true);
+  resolver.setCache(sceneryFileCache);
 
   for(const SceneryArea& area : areas)
   {
@@ -45,9 +45,11 @@ class NavDatabaseErrors;
 
 namespace scenery {
 class SceneryCfg;
+struct SceneryChanges;
 class AddOnComponent;
 class SceneryArea;
 class ManifestJson;
+class SceneryFileCache;
 }
 
 namespace db {
@@ -90,6 +92,15 @@ public:
    * @param codec Scenery.cfg codec only applies to FSX/P3D */
   atools::fs::ResultFlags compileDatabase();
 
+  /* Compares the scenery library with the files recorded in a previously compiled database.
+   * Only FSX, P3D and MSFS 2020. Returns false if detection is not possible for the simulator or database and a
+   * full compilation is needed. Database has to be compiled with the same options. */
+  bool detectSceneryChanges(atools::sql::SqlDatabase& compiledDb, atools::fs::scenery::SceneryChanges& changes);
+
+  /* Like compileDatabase() but skips compilation and returns COMPILE_UP_TO_DATE if detectSceneryChanges() finds
+   * no changes in compiledDb. Database given in constructor is not touched in this case. */
+  atools::fs::ResultFlags compileDatabaseIfChanged(atools::sql::SqlDatabase& compiledDb);
+
   /* Does not load anything and only creates the empty database schema.
    * Configuration is not used and can be null. atools::Exception is thrown in case of error.
    * Opens own transaction and commits if successfull */
@@ -133,18 +144,40 @@ public:
   }
 
 private:
+  /* Closes the database and reopens it as an in-memory database if option IN_MEMORY is set and enough physical
+   * memory is available. Returns the database file name or an empty string if compiling into the file. */
+  QString openMemoryDatabase();
+
+  /* Writes the memory database to targetFile if persist is true and reopens the file database.
+   * The copy is written to a temporary file which replaces targetFile only if writing succeeded.
+   * Does nothing if targetFile is empty. */
+  void closeMemoryDatabase(const QString& targetFile, bool persist);
+
   /* Creates database schema only */
   void createSchemaInternal(atools::fs::ProgressHandler *progress = nullptr);
 
   /* Internal creation of the full database */
   atools::fs::ResultFlags createInternal(const QString& sceneryConfigCodec);
 
+  /* Codec for scenery.cfg depending on simulator */
+  QString sceneryConfigCodec() const;
+
   /* Read FSX/P3D scenery configuration */
   void readSceneryConfigFsxP3d(atools::fs::scenery::SceneryCfg& cfg);
 
   /* Fill MSFS scenery configuration with the two default entries */
   void readSceneryConfigMsfs(scenery::SceneryCfg& cfg);
 
+  /* Manifest and layout information of an MSFS package in the official or community folder */
+  struct MsfsPackage
+  {
+    QString name, path;
+    bool community = false, anyScenery = false, scenery = false, fsArchive = false, bgl = false, navigraphNavdata = false;
+  };
+
+  /* Resolve path and read manifest and layout of a package. Thread safe. */
+  void readMsfsPackage(MsfsPackage& package);
+
   /* Read all included extra folders */
   void readSceneryConfigIncludePathsFsxP3dMsfs(atools::fs::scenery::SceneryCfg& cfg);
 
@@ -197,6 +230,9 @@ private:
   void createPreparationScript();
   void dropAllIndexes();
 
+  /* Save page size, page count, free pages and time of last analyze in the metadata properties */
+  void updateDatabaseStatistics();
+
   void readAddOnComponents(int& areaNum, atools::fs::scenery::SceneryCfg& cfg,
                            QList<scenery::AddOnComponent>& noLayerComponents,
                            QStringList& noLayerPaths, QSet<QString>& addonPaths, const QFileInfo& addonEntry);
@@ -213,10 +249,19 @@ private:
   void createSimConnectLoader();
   void calculateRating(atools::fs::FsPaths::SimulatorType sim);
 
+  /* Fill column cell_id in airport and navaid tables. See atools::geo::Rect::cellId(). */
+  void updateCellIds();
+
+  /* Fill column min_zoom in airport and navaid tables. Needs airport rating. */
+  void updateMinZoom();
+
   /* Detect Navigraph navdata update packages for special handling. */
   bool isNavigraphNavdata(atools::fs::scenery::ManifestJson& manifest);
 
   atools::fs::sc::db::SimConnectLoader *simconnectLoader = nullptr;
+
+  /* Shared by counting and loading of scenery files */
+  atools::fs::scenery::SceneryFileCache *sceneryFileCache = nullptr;
   const atools::win::ActivationContext *activationContext = nullptr;
   QString libraryName;
 
@@ -0,0 +1,236 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/navdatabasebenchmark.h"
+
+#include "atools.h"
+#include "fs/navdatabase.h"
+#include "fs/navdatabaseerrors.h"
+#include "fs/navdatabaseprogress.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace atools {
+namespace fs {
+
+/* Increment if the result format changes to avoid comparing different runs */
+static const int BENCHMARK_VERSION = 1;
+
+NavDatabaseBenchmark::NavDatabaseBenchmark(const NavDatabaseOptions& readerOptions)
+  : options(readerOptions), tempDirectory(atools::tempDir())
+{
+}
+
+NavDatabaseBenchmark::~NavDatabaseBenchmark()
+{
+}
+
+bool NavDatabaseBenchmark::run()
+{
+  qInfo() << Q_FUNC_INFO << "Running" << repetitions << "compilations for"
+          << FsPaths::typeToShortName(options.getSimulatorType()) << "in" << tempDirectory;
+
+  QJsonArray runs;
+  QList<qint64> wallTimes, cpuTimes;
+  bool aborted = false;
+  for(int i = 0; i < repetitions && !aborted; i++)
+  {
+    QJsonObject runObj = runOnce(i, aborted);
+    if(!aborted)
+    {
+      wallTimes.append(runObj.value("wall_ms").toInteger());
+      cpuTimes.append(runObj.value("cpu_ms").toInteger());
+      runs.append(runObj);
+    }
+  }
+
+  std::sort(wallTimes.begin(), wallTimes.end());
+  std::sort(cpuTimes.begin(), cpuTimes.end());
+
+  result = QJsonObject();
+  result.insert("version", BENCHMARK_VERSION);
+  result.insert("simulator", FsPaths::typeToShortName(options.getSimulatorType()));
+  result.insert("base_path", options.getBasepath());
+  result.insert("repetitions", static_cast<int>(runs.size()));
+  if(!wallTimes.isEmpty())
+  {
+    result.insert("wall_ms_min", wallTimes.constFirst());
+    result.insert("wall_ms_median", wallTimes.at(wallTimes.size() / 2));
+    result.insert("cpu_ms_min", cpuTimes.constFirst());
+    result.insert("cpu_ms_median", cpuTimes.at(cpuTimes.size() / 2));
+  }
+  result.insert("peak_rss_bytes", processPeakRssBytes());
+  result.insert("runs", runs);
+
+  qInfo() << Q_FUNC_INFO << "Done" << (aborted ? "aborted" : "");
+  return !aborted;
+}
+
+QJsonObject NavDatabaseBenchmark::runOnce(int repetition, bool& aborted)
+{
+  QString connectionName = QStringLiteral("atools_benchmark_%1").arg(repetition);
+  QString filename = QDir(tempDirectory).filePath(QStringLiteral("atools_benchmark_%1_%2.sqlite").
+                                                  arg(FsPaths::typeToShortName(options.getSimulatorType()).toLower()).
+                                                  arg(repetition));
+  QFile::remove(filename);
+
+  // Catch phase times from final progress report and pass all reports on
+  QList<NavDatabasePhaseTime> phaseTimes;
+  NavDatabaseOptions runOptions(options);
+  NavDatabaseOptions::ProgressCallbackType callback = options.getProgressCallback();
+  runOptions.setProgressCallback([&phaseTimes, callback](const NavDatabaseProgress& progress) -> bool {
+    if(progress.isLastCall())
+      phaseTimes = progress.getPhaseTimes();
+    return callback ? callback(progress) : false;
+  });
+
+  QJsonObject runObj;
+  {
+    atools::sql::SqlDatabase db = atools::sql::SqlDatabase::addDatabase("QSQLITE", connectionName);
+    db.setDatabaseName(filename);
+    db.open();
+
+    NavDatabaseErrors errors;
+    NavDatabase navDatabase(runOptions, db, &errors, QStringLiteral("benchmark"));
+
+    qint64 cpuStartMs = processCpuTimeMs();
+    QElapsedTimer timer;
+    timer.start();
+
+    ResultFlags resultFlags = navDatabase.compileDatabase();
+
+    runObj.insert("repetition", repetition);
+    runObj.insert("wall_ms", timer.elapsed());
+    runObj.insert("cpu_ms", processCpuTimeMs() - cpuStartMs);
+    runObj.insert("peak_rss_bytes", processPeakRssBytes());
+    runObj.insert("errors", errors.getTotalErrors());
+    aborted = resultFlags.testFlag(COMPILE_CANCELED);
+
+    if(!aborted)
+    {
+      // Phases in order of first appearance
+      QJsonArray phases;
+      for(const NavDatabasePhaseTime& phaseTime : std::as_const(phaseTimes))
+      {
+        QJsonObject phase;
+        phase.insert("name", phaseTime.name);
+        phase.insert("elapsed_ms", phaseTime.elapsedMs);
+        phase.insert("bytes", phaseTime.bytes);
+        phase.insert("rows", phaseTime.rows);
+        phase.insert("count", phaseTime.count);
+        phases.append(phase);
+      }
+      runObj.insert("phases", phases);
+
+      // Rows per table - keys are sorted by name in the document
+      QJsonObject tables;
+      for(const QString& table : db.tables())
+      {
+        atools::sql::SqlQuery query("select count(1) from " + table, db);
+        query.exec();
+        if(query.next())
+          tables.insert(table, query.value(0).toLongLong());
+      }
+      runObj.insert("tables", tables);
+
+      runObj.insert("page_size", db.pragmaValue("page_size").toLongLong());
+      runObj.insert("page_count", db.pragmaValue("page_count").toLongLong());
+      runObj.insert("freelist_count", db.pragmaValue("freelist_count").toLongLong());
+    }
+
+    db.close();
+  }
+  atools::sql::SqlDatabase::removeDatabase(connectionName);
+
+  runObj.insert("file_size_bytes", QFileInfo(filename).size());
+
+  if(!keepDatabases)
+    QFile::remove(filename);
+
+  return runObj;
+}
+
+bool NavDatabaseBenchmark::writeResult(const QString& filename) const
+{
+  QSaveFile file(filename);
+  if(file.open(QIODevice::WriteOnly))
+  {
+    file.write(QJsonDocument(result).toJson(QJsonDocument::Indented));
+    if(file.commit())
+      return true;
+  }
+
+  qWarning() << Q_FUNC_INFO << "Cannot write" << filename << file.errorString();
+  return false;
+}
+
+qint64 NavDatabaseBenchmark::processCpuTimeMs()
+{
+#if defined(Q_OS_WIN)
+  FILETIME creationTime, exitTime, kernelTime, userTime;
+  if(GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime))
+  {
+    // Units of 100 nanoseconds
+    quint64 kernel = (static_cast<quint64>(kernelTime.dwHighDateTime) << 32) | kernelTime.dwLowDateTime;
+    quint64 user = (static_cast<quint64>(userTime.dwHighDateTime) << 32) | userTime.dwLowDateTime;
+    return static_cast<qint64>((kernel + user) / 10000);
+  }
+  return 0L;
+#else
+  struct rusage usage;
+  if(getrusage(RUSAGE_SELF, &usage) == 0)
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000L + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000L;
+  return 0L;
+#endif
+}
+
+qint64 NavDatabaseBenchmark::processPeakRssBytes()
+{
+#if defined(Q_OS_WIN)
+  PROCESS_MEMORY_COUNTERS counters;
+  if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    return static_cast<qint64>(counters.PeakWorkingSetSize);
+  return 0L;
+#else
+  struct rusage usage;
+  if(getrusage(RUSAGE_SELF, &usage) == 0)
+#if defined(Q_OS_MACOS)
+    return usage.ru_maxrss; // Bytes on macOS
+#else
+    return usage.ru_maxrss * 1024L; // Kilobytes on Linux
+#endif
+  return 0L;
+#endif
+}
+
+} // namespace fs
+} // namespace atools
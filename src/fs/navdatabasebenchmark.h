@@ -0,0 +1,102 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_NAVDATABASEBENCHMARK_H
+#define ATOOLS_FS_NAVDATABASEBENCHMARK_H
+
+#include "fs/navdatabaseoptions.h"
+
+#include <QJsonObject>
+
+#include <algorithm>
+
+namespace atools {
+namespace fs {
+
+/*
+ * Compiles a scenery library repeatedly into temporary databases and collects timings for regression checks.
+ *
+ * Options define simulator, base path and scenery configuration like for a normal compilation. Each run uses a new
+ * database file in the temporary directory which is deleted afterwards unless keepDatabases is set.
+ *
+ * For each run wall and CPU time, the phase times reported by ProgressHandler, rows per table,
+ * SQLite page counts and the peak resident set size of the process are collected.
+ * Peak RSS is the maximum of the whole process lifetime and not reset between runs.
+ *
+ * The result is a JSON document with stable key order which can be compared between releases.
+ * atools::Exception is thrown if compilation fails.
+ */
+class NavDatabaseBenchmark
+{
+public:
+  NavDatabaseBenchmark(const atools::fs::NavDatabaseOptions& readerOptions);
+  virtual ~NavDatabaseBenchmark();
+
+  NavDatabaseBenchmark(const NavDatabaseBenchmark& other) = delete;
+  NavDatabaseBenchmark& operator=(const NavDatabaseBenchmark& other) = delete;
+
+  /* Compile repeatedly. Results of previous runs are discarded. Returns false if aborted by progress callback. */
+  bool run();
+
+  /* Results of last run() */
+  const QJsonObject& getResult() const
+  {
+    return result;
+  }
+
+  /* Write indented JSON. Returns false on error. */
+  bool writeResult(const QString& filename) const;
+
+  /* Number of compilations. Default is 3. */
+  void setRepetitions(int value)
+  {
+    repetitions = std::max(1, value);
+  }
+
+  /* Directory for database files. Default is atools::tempDir(). */
+  void setTempDirectory(const QString& value)
+  {
+    tempDirectory = value;
+  }
+
+  /* Do not delete database files after each run */
+  void setKeepDatabases(bool value)
+  {
+    keepDatabases = value;
+  }
+
+private:
+  /* Compile once and return run object */
+  QJsonObject runOnce(int repetition, bool& aborted);
+
+  /* Process CPU time in user and kernel mode in milliseconds */
+  static qint64 processCpuTimeMs();
+
+  /* Peak resident set size or peak working set of the process in bytes */
+  static qint64 processPeakRssBytes();
+
+  atools::fs::NavDatabaseOptions options;
+  QString tempDirectory;
+  int repetitions = 3;
+  bool keepDatabases = false;
+  QJsonObject result;
+};
+
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_NAVDATABASEBENCHMARK_H
@@ -33,6 +33,7 @@ enum ResultFlag : quint32
   COMPILE_MSFS_NAVIGRAPH_FOUND = 1 << 1, /* Found MSFS Navigraph installation during compilation */
   COMPILE_CANCELED = 1 << 2, /* User clicked cancel on progress */
   COMPILE_FAILED = 1 << 3, /* Caught exception */
+  COMPILE_UP_TO_DATE = 1 << 4, /* No scenery changes found and compilation was skipped */
 };
 
 ATOOLS_DECLARE_FLAGS_32(ResultFlags, atools::fs::ResultFlag)
@@ -256,12 +256,22 @@ void NavDatabaseOptions::loadFromSettings(QSettings& settings)
   setFlag(type::ANALYZE_DATABASE, settings.value("Options/AnalyzeDatabase", true).toBool());
   setFlag(type::DROP_INDEXES, settings.value("Options/DropAllIndexes", false).toBool());
   setFlag(type::DROP_TEMP_TABLES, settings.value("Options/DropTempTables", true).toBool());
+  setFlag(type::BULK_LOAD, settings.value("Options/BulkLoad", true).toBool());
+  setFlag(type::COMPACT_GEOMETRY, settings.value("Options/CompactGeometry", false).toBool());
+  setFlag(type::FULL_TEXT_SEARCH, settings.value("Options/FullTextSearch", false).toBool());
+  setFlag(type::BATCH_DELETES, settings.value("Options/BatchDeletes", true).toBool());
+  setFlag(type::IN_MEMORY, settings.value("Options/InMemory", false).toBool());
 
   setSimConnectAirportFetchDelay(settings.value("Options/SimConnectAirportFetchDelay", 100).toInt());
   setSimConnectNavaidFetchDelay(settings.value("Options/SimConnectNavaidFetchDelay", 50).toInt());
   setSimConnectBatchSize(settings.value("Options/SimConnectBatchSize", 2000).toInt());
   setSimConnectLoadDisconnected(settings.value("Options/SimConnectLoadDisconnected", true).toBool());
   setSimConnectLoadDisconnectedFile(settings.value("Options/SimConnectLoadDisconnectedFile", true).toBool());
+  setNumParserThreads(settings.value("Options/ParserThreads", 0).toInt());
+  setNumSorterThreads(settings.value("Options/SorterThreads", 0).toInt());
+  setInsertBatchSize(settings.value("Options/InsertBatchSize", 100).toInt());
+  setPageSize(settings.value("Options/PageSize", 0).toInt());
+  setProgressIntervalMs(settings.value("Options/ProgressInterval", 0).toInt());
 
   addToHighPriorityFiltersInc(settings.value("Filter/IncludeHighPriorityFilter").toStringList());
   addToFilenameFilterInclude(settings.value("Filter/IncludeFilenames").toStringList());
@@ -378,11 +388,19 @@ QDebug operator<<(QDebug out, const NavDatabaseOptions& opts)
   out << ", SimConnectBatchSize \"" << opts.simConnectBatchSize << "\"";
   out << ", SimConnectLoadDisconnected \"" << opts.simConnectLoadDisconnected << "\"";
   out << ", SimConnectLoadDisconnectedFile \"" << opts.simConnectLoadDisconnectedFile << "\"";
+  out << ", ParserThreads \"" << opts.numParserThreads << "\"";
+  out << ", SorterThreads \"" << opts.numSorterThreads << "\"";
+  out << ", InsertBatchSize \"" << opts.insertBatchSize << "\"";
+  out << ", PageSize \"" << opts.pageSize << "\"";
+  out << ", ProgressInterval \"" << opts.progressIntervalMs << "\"";
   out << ", sceneryFile \"" << opts.sceneryFile << "\"";
   out << ", basepath \"" << opts.basepath << "\"";
   out << ", msfsCommunityPath \"" << opts.msfsCommunityPath << "\"";
   out << ", msfsOfficialPath \"" << opts.msfsOfficialPath << "\"";
   out << ", sourceDatabase \"" << opts.sourceDatabase << "\"";
+  out << ", navSnapshotFile \"" << opts.navSnapshotFile << "\"";
+  out << ", compactDatabaseFile \"" << opts.compactDatabaseFile << "\"";
+  out << ", sceneryFileCacheFile \"" << opts.sceneryFileCacheFile << "\"";
   out << ", basicValidationTables \"" << opts.basicValidationTables << "\"";
   out << ", fileFiltersInc [" << patternStr(opts.fileFiltersInc) << "]";
   out << ", fileFiltersExcl [" << patternStr(opts.fileFiltersExcl) << "]";
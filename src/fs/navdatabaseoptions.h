@@ -19,6 +19,7 @@
 #define ATOOLS_FS_NAVDATABASEOPTIONS_H
 
 #include "fs/fspaths.h"
+#include "util/asynctask.h"
 #include "util/flags.h"
 
 #include <functional>
@@ -146,6 +147,24 @@ enum OptionFlag : quint32
 
   /* Remove temporary tables */
   DROP_TEMP_TABLES = 1 << 16,
+
+  /* Use fast but unsafe SQLite settings while compiling. See SqlDatabase::beginBulkLoad(). Default is true. */
+  BULK_LOAD = 1 << 17,
+
+  /* Store airspace boundary and apron geometry in the compact delta format of BinaryGeometry.
+   * Needs a client which can read the format. Default is false. */
+  COMPACT_GEOMETRY = 1 << 18,
+
+  /* Create FTS5 trigram full text search tables for airports and navaids. See create_fts.sql. Default is false. */
+  FULL_TEXT_SEARCH = 1 << 19,
+
+  /* Collect airport delete operations for a scenery area and apply them with set based statements.
+   * See DeleteProcessor::flush(). Default is true. */
+  BATCH_DELETES = 1 << 20,
+
+  /* Compile into an in-memory database and write it to the database file at once when finished.
+   * Falls back to compiling into the file if not enough physical memory is available. Default is false. */
+  IN_MEMORY = 1 << 21,
 };
 
 ATOOLS_DECLARE_FLAGS_32(OptionFlags, atools::fs::type::OptionFlag)
@@ -202,6 +221,33 @@ public:
     sourceDatabase = value;
   }
 
+  /*
+   * Write a read only navigation snapshot to this file at the end of the compilation.
+   * See atools::fs::common::NavSnapshot. Empty by default which means no snapshot is written.
+   */
+  void setNavSnapshotFile(const QString& value)
+  {
+    navSnapshotFile = value;
+  }
+
+  /*
+   * Keep directory listings of scenery areas in this file to avoid reading unchanged directories
+   * in the next compilation. Empty by default which means listings are cached only during one compilation.
+   */
+  void setSceneryFileCacheFile(const QString& value)
+  {
+    sceneryFileCacheFile = value;
+  }
+
+  /*
+   * Write a compacted and defragmented copy of the database to this file using "vacuum into" as the last step
+   * of the compilation. The copy uses getPageSize() if set. Empty by default which means no copy is written.
+   */
+  void setCompactDatabaseFile(const QString& value)
+  {
+    compactDatabaseFile = value;
+  }
+
   /*
    * Set verbose logging. This is only useful with small datasets. Default is false.
    */
@@ -293,6 +339,18 @@ public:
     progressCallback = func;
   }
 
+  /* Compilation stops at the next progress report if the token is canceled like a progress callback returning true.
+   * Use with atools::util::async::run() to cancel or set a deadline for compilation running in another thread. */
+  const atools::util::CancelToken& getCancelToken() const
+  {
+    return cancelToken;
+  }
+
+  void setCancelToken(const atools::util::CancelToken& value)
+  {
+    cancelToken = value;
+  }
+
   bool isCallDefaultCallback() const
   {
     return callDefaultCallback;
@@ -341,6 +399,21 @@ public:
     return sourceDatabase;
   }
 
+  const QString& getNavSnapshotFile() const
+  {
+    return navSnapshotFile;
+  }
+
+  const QString& getCompactDatabaseFile() const
+  {
+    return compactDatabaseFile;
+  }
+
+  const QString& getSceneryFileCacheFile() const
+  {
+    return sceneryFileCacheFile;
+  }
+
   bool isDeletes() const
   {
     return flags.testFlag(type::DELETES);
@@ -401,6 +474,31 @@ public:
     return flags.testFlag(type::DROP_TEMP_TABLES);
   }
 
+  bool isBulkLoad() const
+  {
+    return flags.testFlag(type::BULK_LOAD);
+  }
+
+  bool isCompactGeometry() const
+  {
+    return flags.testFlag(type::COMPACT_GEOMETRY);
+  }
+
+  bool isFullTextSearch() const
+  {
+    return flags.testFlag(type::FULL_TEXT_SEARCH);
+  }
+
+  bool isBatchDeletes() const
+  {
+    return flags.testFlag(type::BATCH_DELETES);
+  }
+
+  bool isInMemory() const
+  {
+    return flags.testFlag(type::IN_MEMORY);
+  }
+
   bool isBasicValidation() const
   {
     return flags.testFlag(type::BASIC_VALIDATION);
@@ -523,6 +621,67 @@ public:
     simConnectBatchSize = value;
   }
 
+  /* Number of threads parsing BGL files ahead of the database writer. 0 uses the ideal thread count and
+   * 1 parses in the writer thread. */
+  int getNumParserThreads() const
+  {
+    return numParserThreads;
+  }
+
+  void setNumParserThreads(int value)
+  {
+    numParserThreads = value;
+  }
+
+  /* Number of threads SQLite may use to sort while creating indexes in the post-load scripts.
+   * Needs bulk load mode. 0 uses the ideal thread count and 1 sorts in the calling thread only. */
+  int getNumSorterThreads() const
+  {
+    return numSorterThreads;
+  }
+
+  void setNumSorterThreads(int value)
+  {
+    numSorterThreads = value;
+  }
+
+  /* Page size in bytes used when vacuuming or compacting the database. Has to be a power of two between 512 and 65536.
+   * Larger pages give better read locality for the mostly read only navdata. 0 keeps the current page size. */
+  int getPageSize() const
+  {
+    return pageSize;
+  }
+
+  void setPageSize(int value)
+  {
+    pageSize = value;
+  }
+
+  /* Maximum number of rows collected for multi row inserts into tables like parking or approach legs.
+   * Limited by the number of columns. 1 disables batching. */
+  int getInsertBatchSize() const
+  {
+    return insertBatchSize;
+  }
+
+  void setInsertBatchSize(int value)
+  {
+    insertBatchSize = value;
+  }
+
+  /* Interval in milliseconds for reporting progress from a separate sampler thread. Compile threads only update
+   * counters then and the progress callback is called from the sampler thread.
+   * 0 calls the callback synchronously in the compile thread. See ProgressHandler::setAsyncInterval(). */
+  int getProgressIntervalMs() const
+  {
+    return progressIntervalMs;
+  }
+
+  void setProgressIntervalMs(int value)
+  {
+    progressIntervalMs = value;
+  }
+
   bool getSimConnectLoadDisconnected() const
   {
     return simConnectLoadDisconnected;
@@ -583,7 +742,7 @@ private:
 
   bool includedGui(const QFileInfo& path, const QList<QRegularExpression>& fileExclude, const QList<QRegularExpression>& dirExclude) const;
 
-  QString sceneryFile, basepath, msfsCommunityPath, msfsOfficialPath, sourceDatabase, language = QLatin1String("en-US");
+  QString sceneryFile, basepath, msfsCommunityPath, msfsOfficialPath, sourceDatabase, navSnapshotFile, compactDatabaseFile, sceneryFileCacheFile, language = QLatin1String("en-US");
 
   atools::fs::type::OptionFlags flags;
 
@@ -600,9 +759,11 @@ private:
   QSet<atools::fs::type::NavDbObjectType> navDbObjectTypeFiltersInc, navDbObjectTypeFiltersExcl;
 
   ProgressCallbackType progressCallback;
+  atools::util::CancelToken cancelToken;
   bool callDefaultCallback = true;
 
   int simConnectAirportFetchDelay = 100, simConnectNavaidFetchDelay = 50, simConnectBatchSize = 2000;
+  int numParserThreads = 0, numSorterThreads = 0, insertBatchSize = 100, pageSize = 0, progressIntervalMs = 0;
   bool simConnectLoadDisconnected = true, simConnectLoadDisconnectedFile = false;
 
   atools::fs::FsPaths::SimulatorType simulatorType = atools::fs::FsPaths::FSX;
@@ -18,6 +18,7 @@
 #include "fs/navdatabaseprogress.h"
 #include "fs/scenery/sceneryarea.h"
 
+#include <QDebug>
 #include <QFileInfo>
 
 namespace atools {
@@ -43,5 +44,20 @@ QString NavDatabaseProgress::getFileName() const
   return QFileInfo(filepath).fileName();
 }
 
+QDebug operator<<(QDebug out, const NavDatabasePhaseTime& phase)
+{
+  QDebugStateSaver saver(out);
+  out.noquote().nospace() << phase.name << ": " << phase.elapsedMs << " ms";
+
+  if(phase.count > 1)
+    out << " in " << phase.count << " parts";
+  if(phase.bytes > 0)
+    out << ", " << phase.bytes << " bytes, " << QString::number(phase.getBytesPerSecond() / 1024. / 1024., 'f', 2)
+        << " MB/s";
+  if(phase.rows > 0)
+    out << ", " << phase.rows << " rows, " << QString::number(phase.getRowsPerSecond(), 'f', 0) << " rows/s";
+  return out;
+}
+
 } // namespace fs
 } // namespace atools
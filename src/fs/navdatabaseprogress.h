@@ -18,6 +18,8 @@
 #ifndef ATOOLS_FS_NAVDATABASEPROGRESS_H
 #define ATOOLS_FS_NAVDATABASEPROGRESS_H
 
+#include <QDebug>
+#include <QList>
 #include <QString>
 
 namespace atools {
@@ -28,6 +30,36 @@ class SceneryArea;
 }
 class ProgressHandler;
 
+/*
+ * Time spent in a compilation phase like parsing, writing or running a script.
+ * Phases reported more than once with the same name are summed up.
+ */
+struct NavDatabasePhaseTime
+{
+  QString name;
+
+  /* Wall time. Can exceed total time for phases running in parallel threads like parsing. */
+  qint64 elapsedMs = 0;
+
+  /* Bytes read and database rows written if known or 0 */
+  qint64 bytes = 0, rows = 0;
+
+  /* Number of times this phase was reported */
+  int count = 0;
+
+  double getBytesPerSecond() const
+  {
+    return elapsedMs > 0 ? bytes * 1000. / elapsedMs : 0.;
+  }
+
+  double getRowsPerSecond() const
+  {
+    return elapsedMs > 0 ? rows * 1000. / elapsedMs : 0.;
+  }
+};
+
+QDebug operator<<(QDebug out, const atools::fs::NavDatabasePhaseTime& phase);
+
 /*
  * Progress information that is passed to the progress callback.
  */
@@ -209,6 +241,22 @@ public:
     return numObjectsWritten;
   }
 
+  /*
+   * @return number of BGL record bytes not read since the sections were not needed for the filter options
+   */
+  qint64 getNumBytesSkipped() const
+  {
+    return numBytesSkipped;
+  }
+
+  /*
+   * @return Timing for all phases finished so far in order of first appearance
+   */
+  const QList<atools::fs::NavDatabasePhaseTime>& getPhaseTimes() const
+  {
+    return phaseTimes;
+  }
+
   /*
    * @return total number of errors/exceptions during BGL loading
    */
@@ -222,6 +270,8 @@ private:
 
   int numFiles = 0, numAirports = 0, numNamelists = 0, numVors = 0, numIls = 0, numNdbs = 0, numMarker = 0,
       numBoundaries = 0, numWaypoints = 0, numObjectsWritten = 0, numErrors = 0;
+  qint64 numBytesSkipped = 0;
+  QList<atools::fs::NavDatabasePhaseTime> phaseTimes;
 
   int total = 0, current = 0, lastCurrent = 0;
   bool newFile = false, newSceneryArea = false, newOther = false, firstCall = true, lastCall = false;
@@ -0,0 +1,115 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/ns/aircrafteventpublisher.h"
+
+#include "fs/sc/datareaderthread.h"
+#include "fs/sc/simconnectdata.h"
+#include "httpserver/httpeventstreamcontroller.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace atools {
+namespace fs {
+namespace ns {
+
+AircraftEventPublisher::AircraftEventPublisher(stefanfrings::HttpEventStreamController *controllerParam, int minIntervalMsParam,
+                                               QObject *parent)
+  : QObject(parent), controller(controllerParam), minIntervalMs(minIntervalMsParam)
+{
+}
+
+AircraftEventPublisher::~AircraftEventPublisher()
+{
+  stop();
+}
+
+void AircraftEventPublisher::start(atools::fs::sc::DataReaderThread *dataReaderThread)
+{
+  dataReader = dataReaderThread;
+  lastPublished.invalidate();
+
+  // Convert in the data reader thread - publishing is thread safe
+  connect(dataReader, &atools::fs::sc::DataReaderThread::postSimConnectData, this, &AircraftEventPublisher::publishSimConnectData,
+          static_cast<Qt::ConnectionType>(Qt::DirectConnection | Qt::UniqueConnection));
+}
+
+void AircraftEventPublisher::stop()
+{
+  if(dataReader != nullptr)
+  {
+    disconnect(dataReader, &atools::fs::sc::DataReaderThread::postSimConnectData, this,
+               &AircraftEventPublisher::publishSimConnectData);
+    dataReader = nullptr;
+  }
+}
+
+void AircraftEventPublisher::publishSimConnectData(atools::fs::sc::SimConnectData dataPacket)
+{
+  // Weather replies do not contain aircraft
+  if(dataPacket.isEmptyReply())
+    return;
+
+  // Nothing to do without clients
+  if(controller->getNumClients() == 0)
+    return;
+
+  if(lastPublished.isValid() && lastPublished.elapsed() < minIntervalMs)
+    return;
+
+  lastPublished.start();
+  controller->publish(toJson(dataPacket), "aircraft");
+}
+
+QByteArray AircraftEventPublisher::toJson(const atools::fs::sc::SimConnectData& data)
+{
+  const atools::fs::sc::SimConnectUserAircraft& aircraft = data.getUserAircraftConst();
+
+  QJsonObject obj;
+  obj.insert("packetId", data.getPacketId());
+  obj.insert("timestamp", data.getPacketTimestamp().toString(Qt::ISODate));
+  obj.insert("valid", data.isUserAircraftValid());
+
+  if(data.isUserAircraftValid())
+  {
+    obj.insert("lat", aircraft.getPosition().getLatY());
+    obj.insert("lon", aircraft.getPosition().getLonX());
+    obj.insert("altitudeFt", aircraft.getActualAltitudeFt());
+    obj.insert("indicatedAltitudeFt", aircraft.getIndicatedAltitudeFt());
+    obj.insert("altitudeAboveGroundFt", aircraft.getAltitudeAboveGroundFt());
+    obj.insert("headingTrueDeg", aircraft.getHeadingDegTrue());
+    obj.insert("headingMagDeg", aircraft.getHeadingDegMag());
+    obj.insert("trackTrueDeg", aircraft.getTrackDegTrue());
+    obj.insert("groundSpeedKts", aircraft.getGroundSpeedKts());
+    obj.insert("indicatedSpeedKts", aircraft.getIndicatedSpeedKts());
+    obj.insert("trueAirspeedKts", aircraft.getTrueAirspeedKts());
+    obj.insert("verticalSpeedFtPerMin", aircraft.getVerticalSpeedFeetPerMin());
+    obj.insert("windDirectionDegTrue", aircraft.getWindDirectionDegT());
+    obj.insert("windSpeedKts", aircraft.getWindSpeedKts());
+    obj.insert("onGround", aircraft.isOnGround());
+    obj.insert("registration", aircraft.getAirplaneRegistration());
+    obj.insert("type", aircraft.getAirplaneType());
+    obj.insert("title", aircraft.getAirplaneTitle());
+  }
+
+  return QJsonDocument(obj).toJson(QJsonDocument::Compact);
+}
+
+} // namespace ns
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,80 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_NS_AIRCRAFTEVENTPUBLISHER_H
+#define ATOOLS_NS_AIRCRAFTEVENTPUBLISHER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+
+namespace stefanfrings {
+class HttpEventStreamController;
+}
+
+namespace atools {
+namespace fs {
+namespace sc {
+class DataReaderThread;
+class SimConnectData;
+}
+
+namespace ns {
+
+/*
+ * Pushes the user aircraft from the DataReaderThread as JSON server-sent events "aircraft" to all web clients
+ * of a HttpEventStreamController. Uses the same feed as NavServer.
+ *
+ * Packets are converted in the data reader thread and at most every minIntervalMs.
+ * The controller keeps only the latest event for each client.
+ */
+class AircraftEventPublisher :
+  public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit AircraftEventPublisher(stefanfrings::HttpEventStreamController *controllerParam, int minIntervalMsParam = 200,
+                                  QObject *parent = nullptr);
+  virtual ~AircraftEventPublisher() override;
+
+  AircraftEventPublisher(const AircraftEventPublisher& other) = delete;
+  AircraftEventPublisher& operator=(const AircraftEventPublisher& other) = delete;
+
+  /* Connect to the data reader. Does not take ownership. */
+  void start(atools::fs::sc::DataReaderThread *dataReaderThread);
+  void stop();
+
+  /* User aircraft as JSON object. "valid" is false if no aircraft is available. */
+  static QByteArray toJson(const atools::fs::sc::SimConnectData& data);
+
+private:
+  /* Called in the context of the data reader thread */
+  void publishSimConnectData(atools::fs::sc::SimConnectData dataPacket);
+
+  stefanfrings::HttpEventStreamController *controller;
+  atools::fs::sc::DataReaderThread *dataReader = nullptr;
+
+  /* Only used in the data reader thread */
+  QElapsedTimer lastPublished;
+  int minIntervalMs;
+};
+
+} // namespace ns
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_NS_AIRCRAFTEVENTPUBLISHER_H
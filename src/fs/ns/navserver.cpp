@@ -64,6 +64,11 @@ bool NavServer::startServer(atools::fs::sc::DataReaderThread *dataReaderThread)
   dataReader = dataReaderThread;
   qDebug() << "Navserver starting";
 
+  if(options.testFlag(FAN_OUT))
+    // Serialize in the data reader thread - slot does not use any server state
+    connect(dataReader, &atools::fs::sc::DataReaderThread::postSimConnectData, this, &NavServer::fanOutSimConnectData,
+            static_cast<Qt::ConnectionType>(Qt::DirectConnection | Qt::UniqueConnection));
+
   // hostname/ip/v6
   struct Host
   {
@@ -199,8 +204,11 @@ void NavServer::incomingConnection(qintptr socketDescriptor)
         });
 
   // Data reader will send simconnect packages through this connection
-  connect(dataReader, &atools::fs::sc::DataReaderThread::postSimConnectData, worker,
-          &NavServerWorker::postSimConnectData);
+  if(options.testFlag(FAN_OUT))
+    connect(this, &NavServer::postSharedSimConnectData, worker, &NavServerWorker::postSharedSimConnectData);
+  else
+    connect(dataReader, &atools::fs::sc::DataReaderThread::postSimConnectData, worker,
+            &NavServerWorker::postSimConnectData);
   connect(worker, &NavServerWorker::postWeatherRequest,
           dataReader, &atools::fs::sc::DataReaderThread::setWeatherRequest);
 
@@ -217,8 +225,11 @@ void NavServer::threadFinished(NavServerWorker *worker)
   // A thread has finished - lock the list so the thread can be removed from the list
   QMutexLocker locker(&threadsMutex);
 
-  disconnect(dataReader, &atools::fs::sc::DataReaderThread::postSimConnectData, worker,
-             &NavServerWorker::postSimConnectData);
+  if(options.testFlag(FAN_OUT))
+    disconnect(this, &NavServer::postSharedSimConnectData, worker, &NavServerWorker::postSharedSimConnectData);
+  else
+    disconnect(dataReader, &atools::fs::sc::DataReaderThread::postSimConnectData, worker,
+               &NavServerWorker::postSimConnectData);
 
   // TODO crashes when connected
   // disconnect(worker, &NavServerWorker::postCommand,
@@ -231,12 +242,35 @@ void NavServer::threadFinished(NavServerWorker *worker)
   worker->thread()->deleteLater();
 }
 
+void NavServer::fanOutSimConnectData(atools::fs::sc::SimConnectData dataPacket)
+{
+  // Bytes are implicitly shared and not modified by the workers
+  QByteArray block = dataPacket.writeToByteArray();
+  emit postSharedSimConnectData(dataPacket, block);
+}
+
 bool NavServer::hasConnections() const
 {
   QMutexLocker locker(&threadsMutex);
   return workers.size() > 0;
 }
 
+QJsonObject NavServer::getStatus() const
+{
+  QJsonObject status;
+  status.insert("port", port);
+  status.insert("listening", isListening());
+
+  {
+    QMutexLocker locker(&threadsMutex);
+    status.insert("connections", static_cast<qint64>(workers.size()));
+  }
+
+  if(dataReader != nullptr)
+    status.insert("dataReader", dataReader->getPhaseStatistics());
+  return status;
+}
+
 } // namespace ns
 } // namespace fs
 } // namespace atools
@@ -19,7 +19,9 @@
 #define LITTLENAVCONNECT_NAVSERVER_H
 
 #include "fs/ns/navservercommon.h"
+#include "fs/sc/simconnectdata.h"
 
+#include <QJsonObject>
 #include <QMutex>
 #include <QTcpServer>
 
@@ -27,7 +29,6 @@ namespace atools {
 namespace fs {
 namespace sc {
 
-class SimConnectData;
 class DataReaderThread;
 }
 
@@ -55,18 +56,29 @@ public:
   /* true if any workers are in the list */
   bool hasConnections() const;
 
+  /* Status with port, number of connections and phase statistics of the data reader as "dataReader".
+   * See DataReaderThread::getPhaseStatistics(). */
+  QJsonObject getStatus() const;
+
   /* Need a stop/start to use new port */
   void setPort(int value)
   {
     port = value;
   }
 
+signals:
+  /* Packet from the data reader and its serialization which is shared by all workers in FAN_OUT mode */
+  void postSharedSimConnectData(atools::fs::sc::SimConnectData dataPacket, QByteArray block);
+
 private:
+  /* Serializes the packet once and sends it to all workers. Called in the context of the data reader thread. */
+  void fanOutSimConnectData(atools::fs::sc::SimConnectData dataPacket);
+
   void incomingConnection(qintptr socketDescriptor) override;
   void threadFinished(NavServerWorker *worker);
 
   atools::fs::ns::NavServerOptions options = NONE;
-  atools::fs::sc::DataReaderThread *dataReader;
+  atools::fs::sc::DataReaderThread *dataReader = nullptr;
 
   QSet<NavServerWorker *> workers;
   // Needed to lock for any modifications of the workers set
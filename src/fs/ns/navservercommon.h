@@ -30,7 +30,8 @@ enum NavServerOption : quint32
 {
   NONE = 0x00,
   VERBOSE = 0x01,
-  HIDE_HOST = 0x02
+  HIDE_HOST = 0x02,
+  FAN_OUT = 0x04 /* Serialize each packet once for all clients and delay packets for slow clients */
 };
 
 ATOOLS_DECLARE_FLAGS_32(NavServerOptions, atools::fs::ns::NavServerOption)
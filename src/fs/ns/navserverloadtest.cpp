@@ -0,0 +1,321 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/ns/navserverloadtest.h"
+
+#include "fs/sc/simconnectdata.h"
+#include "fs/sc/simconnectdatadelta.h"
+#include "fs/sc/simconnectreply.h"
+#include "fs/sc/weatherrequest.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QJsonArray>
+#include <QTcpSocket>
+
+#include <algorithm>
+
+namespace atools {
+namespace fs {
+namespace ns {
+
+/* Stations used for random weather requests */
+static const QStringList WEATHER_STATIONS({"EDDF", "EDDM", "EGLL", "LFPG", "KJFK", "KLAX", "KSFO", "LOWW", "LSZH", "YSSY"});
+
+struct NavServerLoadTest::Client
+{
+  int index = 0;
+  QTcpSocket *socket = nullptr;
+
+  /* Partially read packet. Reset after each complete packet. */
+  atools::fs::sc::SimConnectData data;
+  atools::fs::sc::SimConnectDataDelta delta;
+  bool deltaRequested = false;
+
+  int lastPacketId = -1;
+  qint64 packets = 0, dropped = 0, weatherRequests = 0, weatherReplies = 0, errors = 0;
+
+  /* Delivery latency of data packets and time between weather request and reply */
+  QList<qint64> latenciesMs, weatherLatenciesMs;
+  QElapsedTimer weatherTimer;
+};
+
+/* Statistics for a list of latencies like DataReaderStats */
+static QJsonObject latencyJson(QList<qint64> sorted)
+{
+  std::sort(sorted.begin(), sorted.end());
+
+  QJsonObject json;
+  json.insert("count", static_cast<qint64>(sorted.size()));
+  if(!sorted.isEmpty())
+  {
+    qint64 sum = 0;
+    for(qint64 value : std::as_const(sorted))
+      sum += value;
+
+    json.insert("mean", sum / sorted.size());
+    json.insert("p50", sorted.at(sorted.size() * 50 / 100));
+    json.insert("p90", sorted.at(sorted.size() * 90 / 100));
+    json.insert("p99", sorted.at(sorted.size() * 99 / 100));
+    json.insert("max", sorted.constLast());
+  }
+  return json;
+}
+
+NavServerLoadTest::NavServerLoadTest(QObject *parent, const NavServerLoadTestOptions& loadTestOptions)
+  : QObject(parent), opts(loadTestOptions)
+{
+  connect(&weatherTimer, &QTimer::timeout, this, &NavServerLoadTest::sendWeatherRequests);
+}
+
+NavServerLoadTest::~NavServerLoadTest()
+{
+  stop();
+  clear();
+}
+
+void NavServerLoadTest::start()
+{
+  stop();
+  clear();
+
+  qInfo() << Q_FUNC_INFO << "Connecting" << opts.numClients << "clients to" << opts.host << opts.port
+          << "weather interval" << opts.weatherIntervalMs << "delta" << opts.deltaProtocol;
+
+  for(int i = 0; i < opts.numClients; i++)
+  {
+    Client *client = new Client;
+    client->index = i;
+    client->socket = new QTcpSocket(this);
+    clients.append(client);
+
+    connect(client->socket, &QTcpSocket::readyRead, this, [this, client]() {
+      readyRead(client);
+    });
+    connect(client->socket, &QTcpSocket::errorOccurred, this, [client](QAbstractSocket::SocketError error) {
+      client->errors++;
+      qWarning() << "NavServerLoadTest client" << client->index << "error" << error << client->socket->errorString();
+    });
+
+    client->socket->connectToHost(opts.host, static_cast<quint16>(opts.port));
+  }
+
+  runTimer.start();
+  if(opts.weatherIntervalMs > 0)
+    weatherTimer.start(opts.weatherIntervalMs);
+}
+
+void NavServerLoadTest::stop()
+{
+  weatherTimer.stop();
+
+  for(Client *client : std::as_const(clients))
+  {
+    if(client->socket != nullptr)
+    {
+      // Avoid error signals while closing
+      client->socket->disconnect(this);
+      client->socket->abort();
+    }
+  }
+}
+
+void NavServerLoadTest::clear()
+{
+  for(Client *client : std::as_const(clients))
+  {
+    delete client->socket;
+    delete client;
+  }
+  clients.clear();
+}
+
+void NavServerLoadTest::readyRead(Client *client)
+{
+  QTcpSocket *socket = client->socket;
+  while(socket->bytesAvailable())
+  {
+    bool complete;
+    atools::fs::sc::SimConnectStatus status;
+    if(opts.deltaProtocol)
+    {
+      complete = client->delta.read(socket, client->data);
+      status = client->delta.getStatus();
+    }
+    else
+    {
+      complete = client->data.read(socket);
+      status = client->data.getStatus();
+    }
+
+    if(!complete)
+    {
+      if(status != atools::fs::sc::OK)
+      {
+        client->errors++;
+        qWarning() << Q_FUNC_INFO << "Client" << client->index << "read error" << status << "closing connection";
+        socket->abort();
+      }
+      // else wait for more data
+      break;
+    }
+
+    handlePacket(client, client->data);
+    client->data = atools::fs::sc::SimConnectData();
+  }
+}
+
+void NavServerLoadTest::handlePacket(Client *client, const atools::fs::sc::SimConnectData& data)
+{
+  int id = data.getPacketId();
+  if(id > 0)
+  {
+    client->packets++;
+
+    // Server does not send new packets while replies are missing - gaps show skipped updates
+    if(client->lastPacketId > 0 && id > client->lastPacketId + 1)
+      client->dropped += id - client->lastPacketId - 1;
+    client->lastPacketId = id;
+
+    // LoadTestHandler sets the zulu time to the time of fetching
+    const QDateTime& zulu = data.getUserAircraftConst().getZuluTime();
+    if(zulu.isValid())
+      client->latenciesMs.append(zulu.msecsTo(QDateTime::currentDateTimeUtc()));
+
+    // Reply like a normal client to keep the server sending
+    atools::fs::sc::SimConnectReply reply;
+    reply.setPacketId(id);
+    if(opts.deltaProtocol && !client->deltaRequested)
+    {
+      reply.setCommand(atools::fs::sc::CMD_DELTA_PROTOCOL);
+      client->deltaRequested = true;
+    }
+
+    reply.write(client->socket);
+    if(reply.getStatus() != atools::fs::sc::OK)
+    {
+      client->errors++;
+      qWarning() << Q_FUNC_INFO << "Client" << client->index << "write error" << reply.getStatusText();
+    }
+    client->socket->flush();
+  }
+  else if(client->weatherTimer.isValid())
+  {
+    // Packet id 0 is a weather reply
+    client->weatherReplies++;
+    client->weatherLatenciesMs.append(client->weatherTimer.elapsed());
+    client->weatherTimer.invalidate();
+  }
+}
+
+void NavServerLoadTest::sendWeatherRequests()
+{
+  for(Client *client : std::as_const(clients))
+  {
+    // Send only one request at a time per client
+    if(client->socket->state() != QAbstractSocket::ConnectedState || client->weatherTimer.isValid())
+      continue;
+
+    atools::fs::sc::WeatherRequest request;
+    request.setStation(WEATHER_STATIONS.at((client->index + static_cast<int>(client->weatherRequests)) %
+                                           WEATHER_STATIONS.size()));
+
+    atools::fs::sc::SimConnectReply reply;
+    reply.setPacketId(0);
+    reply.setCommand(atools::fs::sc::CMD_WEATHER_REQUEST);
+    reply.setWeatherRequest(request);
+    reply.write(client->socket);
+    client->socket->flush();
+
+    client->weatherRequests++;
+    client->weatherTimer.start();
+  }
+}
+
+QJsonObject NavServerLoadTest::getStatistics() const
+{
+  QJsonArray clientArr;
+  qint64 packets = 0, dropped = 0, weatherRequests = 0, weatherReplies = 0, errors = 0;
+  int connected = 0;
+  QList<qint64> latencies, weatherLatencies;
+
+  for(const Client *client : std::as_const(clients))
+  {
+    bool isConnected = client->socket != nullptr && client->socket->state() == QAbstractSocket::ConnectedState;
+
+    QJsonObject json;
+    json.insert("index", client->index);
+    json.insert("connected", isConnected);
+    json.insert("packets", client->packets);
+    json.insert("dropped", client->dropped);
+    json.insert("weatherRequests", client->weatherRequests);
+    json.insert("weatherReplies", client->weatherReplies);
+    json.insert("errors", client->errors);
+    json.insert("latencyMs", latencyJson(client->latenciesMs));
+    json.insert("weatherLatencyMs", latencyJson(client->weatherLatenciesMs));
+    clientArr.append(json);
+
+    packets += client->packets;
+    dropped += client->dropped;
+    weatherRequests += client->weatherRequests;
+    weatherReplies += client->weatherReplies;
+    errors += client->errors;
+    if(isConnected)
+      connected++;
+    latencies.append(client->latenciesMs);
+    weatherLatencies.append(client->weatherLatenciesMs);
+  }
+
+  QJsonObject total;
+  total.insert("connected", connected);
+  total.insert("packets", packets);
+  total.insert("dropped", dropped);
+  total.insert("weatherRequests", weatherRequests);
+  total.insert("weatherReplies", weatherReplies);
+  total.insert("errors", errors);
+  total.insert("latencyMs", latencyJson(latencies));
+  total.insert("weatherLatencyMs", latencyJson(weatherLatencies));
+
+  QJsonObject json;
+  json.insert("runtimeMs", runTimer.isValid() ? runTimer.elapsed() : 0);
+  json.insert("total", total);
+  json.insert("clients", clientArr);
+  return json;
+}
+
+void NavServerLoadTest::logStatistics() const
+{
+  QJsonObject total = getStatistics().value("total").toObject();
+  QJsonObject latency = total.value("latencyMs").toObject();
+  QJsonObject weatherLatency = total.value("weatherLatencyMs").toObject();
+
+  qInfo().noquote().nospace() << "NavServerLoadTest connected " << total.value("connected").toInt() << "/" << clients.size()
+                              << " packets " << total.value("packets").toInteger()
+                              << " dropped " << total.value("dropped").toInteger()
+                              << " errors " << total.value("errors").toInteger()
+                              << " latency ms p50 " << latency.value("p50").toInteger()
+                              << " p99 " << latency.value("p99").toInteger()
+                              << " max " << latency.value("max").toInteger()
+                              << " weather " << total.value("weatherReplies").toInteger()
+                              << "/" << total.value("weatherRequests").toInteger()
+                              << " p50 " << weatherLatency.value("p50").toInteger()
+                              << " p99 " << weatherLatency.value("p99").toInteger();
+}
+
+} // namespace ns
+} // namespace fs
+} // namespace atools
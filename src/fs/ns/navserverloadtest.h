@@ -0,0 +1,103 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_NS_NAVSERVERLOADTEST_H
+#define ATOOLS_FS_NS_NAVSERVERLOADTEST_H
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QObject>
+#include <QTimer>
+
+namespace atools {
+namespace fs {
+namespace sc {
+class SimConnectData;
+}
+
+namespace ns {
+
+/* Configuration for NavServerLoadTest */
+struct NavServerLoadTestOptions
+{
+  QString host = QStringLiteral("localhost");
+  int port = 51968;
+
+  /* Number of simultaneous connections */
+  int numClients = 10;
+
+  /* Each client sends a weather request for a random airport every weatherIntervalMs. 0 disables requests. */
+  int weatherIntervalMs = 0;
+
+  /* Request the delta protocol with the first reply like Little Navmap */
+  bool deltaProtocol = false;
+};
+
+/*
+ * Multi client test harness to capacity plan NavServer.
+ *
+ * Opens the given number of connections in the calling thread which needs an event loop. Each client answers
+ * data packets like Little Navmap to keep the server sending and optionally sends weather requests.
+ *
+ * Collects per client delivery latency, weather reply latency and dropped packets. Dropped packets are detected
+ * by gaps in packet ids. Delivery latency needs the server to run atools::fs::sc::LoadTestHandler on the same
+ * machine since it is taken from the zulu time of the user aircraft which is set when fetching.
+ */
+class NavServerLoadTest :
+  public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit NavServerLoadTest(QObject *parent, const atools::fs::ns::NavServerLoadTestOptions& loadTestOptions);
+  virtual ~NavServerLoadTest() override;
+
+  NavServerLoadTest(const NavServerLoadTest& other) = delete;
+  NavServerLoadTest& operator=(const NavServerLoadTest& other) = delete;
+
+  /* Connect all clients. Clears statistics. */
+  void start();
+
+  /* Disconnect all clients. Statistics are kept. */
+  void stop();
+
+  /* Object with "runtimeMs", "total" and array "clients". Each has "packets", "dropped", "errors",
+   * "connected" and "latencyMs" and "weatherLatencyMs" objects with count, mean, p50, p90, p99 and max. */
+  QJsonObject getStatistics() const;
+
+  /* Print statistics to the log */
+  void logStatistics() const;
+
+private:
+  struct Client;
+
+  void readyRead(Client *client);
+  void handlePacket(Client *client, const atools::fs::sc::SimConnectData& data);
+  void sendWeatherRequests();
+  void clear();
+
+  atools::fs::ns::NavServerLoadTestOptions opts;
+  QList<Client *> clients;
+  QTimer weatherTimer;
+  QElapsedTimer runTimer;
+};
+
+} // namespace ns
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_NS_NAVSERVERLOADTEST_H
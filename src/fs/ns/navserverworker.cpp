@@ -49,6 +49,7 @@ void NavServerWorker::threadStarted()
     socket = new QTcpSocket();
     connect(socket, &QTcpSocket::disconnected, this, &NavServerWorker::socketDisconnected);
     connect(socket, &QTcpSocket::readyRead, this, &NavServerWorker::readyReadReplyFromSocket);
+    connect(socket, &QTcpSocket::bytesWritten, this, &NavServerWorker::sendPendingPacket);
   }
 
   if(!socket->setSocketDescriptor(socketDescr, QAbstractSocket::ConnectedState, QIODevice::ReadWrite))
@@ -104,7 +105,16 @@ void NavServerWorker::readyReadReplyFromSocket()
     if(options & VERBOSE)
       qDebug() << "NavServerWorker readyReadReply packet id" << reply.getPacketId();
 
-    if(reply.getCommand() == atools::fs::sc::CMD_WEATHER_REQUEST)
+    // Client can request the delta protocol with any reply
+    if(reply.getCommand().testFlag(atools::fs::sc::CMD_DELTA_PROTOCOL) && !deltaProtocol)
+    {
+      deltaProtocol = true;
+      dataDelta.reset();
+      dataDelta.setCompressed(reply.getCommand().testFlag(atools::fs::sc::CMD_DELTA_COMPRESSED));
+      qInfo() << "NavServerWorker using delta protocol for" << peerAddr << "compressed" << dataDelta.isCompressed();
+    }
+
+    if(reply.getCommand().testFlag(atools::fs::sc::CMD_WEATHER_REQUEST))
     {
       if(options & VERBOSE)
         qDebug() << "NavServerWorker::readyReadReply got weather request";
@@ -120,6 +130,7 @@ void NavServerWorker::readyReadReplyFromSocket()
 
       // Normal reply - remove id from sent list
       lastPacketIds.remove(reply.getPacketId());
+      sendPendingPacket();
     }
   }
   if(options & VERBOSE)
@@ -148,6 +159,53 @@ void NavServerWorker::postSimConnectData(atools::fs::sc::SimConnectData dataPack
     return;
   }
 
+  writePacket(dataPacket, QByteArray());
+}
+
+void NavServerWorker::postSharedSimConnectData(atools::fs::sc::SimConnectData dataPacket, QByteArray block)
+{
+  if(socket == nullptr)
+    return;
+
+  if(options & VERBOSE)
+    qDebug() << "NavServerWorker postSharedSimConnectData" << QThread::currentThread()->objectName()
+             << "last ids" << lastPacketIds << "bytes to write" << socket->bytesToWrite();
+
+  if(dataPacket.getPacketId() > 0 && isBackpressure())
+  {
+    // Client is slow - keep only the latest packet and send it once the client caught up
+    if((options & VERBOSE) && hasPendingPacket)
+      qDebug() << "NavServerWorker replacing pending packet" << pendingData.getPacketId();
+
+    pendingData = dataPacket;
+    pendingBlock = block;
+    hasPendingPacket = true;
+    return;
+  }
+
+  writePacket(dataPacket, block);
+}
+
+bool NavServerWorker::isBackpressure() const
+{
+  return lastPacketIds.size() > 1 || (socket != nullptr && socket->bytesToWrite() > MAX_BYTES_TO_WRITE);
+}
+
+void NavServerWorker::sendPendingPacket()
+{
+  if(hasPendingPacket && socket != nullptr && !isBackpressure() && !inPost)
+  {
+    hasPendingPacket = false;
+    atools::fs::sc::SimConnectData dataPacket = pendingData;
+    QByteArray block = pendingBlock;
+    pendingData = atools::fs::sc::SimConnectData();
+    pendingBlock.clear();
+    writePacket(dataPacket, block);
+  }
+}
+
+void NavServerWorker::writePacket(atools::fs::sc::SimConnectData& dataPacket, const QByteArray& block)
+{
   if(inPost)
     // We're already posting
     qCritical() << "Nested post";
@@ -159,9 +217,26 @@ void NavServerWorker::postSimConnectData(atools::fs::sc::SimConnectData dataPack
   inPost = true;
 
   int written;
-  written = dataPacket.write(socket);
-  if(dataPacket.getStatus() != atools::fs::sc::OK)
-    qWarning(gui).noquote().nospace() << tr("Error writing data: %1.").arg(dataPacket.getStatusText());
+  if(deltaProtocol)
+  {
+    // Encoding depends on the state of this connection - cannot use shared bytes
+    written = dataDelta.write(socket, dataPacket);
+    if(dataDelta.getStatus() != atools::fs::sc::OK)
+      qWarning(gui).noquote().nospace() << tr("Error writing data: %1.").arg(dataDelta.getStatusText());
+  }
+  else if(!block.isEmpty())
+  {
+    atools::fs::sc::SimConnectStatus status = atools::fs::sc::OK;
+    written = atools::fs::sc::SimConnectDataBase::writeBlock(socket, block, status);
+    if(status != atools::fs::sc::OK)
+      qWarning(gui).noquote().nospace() << tr("Error writing data: Incomplete write.");
+  }
+  else
+  {
+    written = dataPacket.write(socket);
+    if(dataPacket.getStatus() != atools::fs::sc::OK)
+      qWarning(gui).noquote().nospace() << tr("Error writing data: %1.").arg(dataPacket.getStatusText());
+  }
 
   if(!socket->flush())
     qWarning() << "NavServerWorker Reply to client not flushed";
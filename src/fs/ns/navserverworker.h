@@ -19,6 +19,7 @@
 #define ATOOLS_NS_NAVSERVERTHREAD_H
 
 #include "fs/sc/simconnectdata.h"
+#include "fs/sc/simconnectdatadelta.h"
 
 #include "fs/sc/simconnectreply.h"
 #include "fs/ns/navservercommon.h"
@@ -51,6 +52,10 @@ public:
   /* Receives sim connect data from DataReader thread and writes to socket. */
   void postSimConnectData(atools::fs::sc::SimConnectData dataPacket);
 
+  /* Writes the shared serialization from NavServer to the socket or encodes data for delta clients.
+   * Keeps only the latest packet if the client is slow instead of dropping packets. */
+  void postSharedSimConnectData(atools::fs::sc::SimConnectData dataPacket, QByteArray block);
+
   /* Signal posted by thread to indicate it has started . */
   void threadStarted();
 
@@ -68,7 +73,17 @@ private:
   /* Count dropped packages and write a message if too many accumulated. */
   void handleDroppedPackages(const QString& reason);
 
+  /* Write packet using block if not empty or delta encoding */
+  void writePacket(atools::fs::sc::SimConnectData& dataPacket, const QByteArray& block);
+
+  /* Send delayed packet if client caught up */
+  void sendPendingPacket();
+
+  /* true if replies are missing or the socket has too many unsent bytes */
+  bool isBackpressure() const;
+
   const int MAX_DROPPED_PACKAGES = 50;
+  const qint64 MAX_BYTES_TO_WRITE = 1024 * 1024;
 
   qintptr socketDescr;
   atools::fs::sc::SimConnectData data;
@@ -80,6 +95,15 @@ private:
   int droppedPackages = 0;
   bool inPost = false;
 
+  /* Encoder for clients which requested the delta protocol */
+  atools::fs::sc::SimConnectDataDelta dataDelta;
+  bool deltaProtocol = false;
+
+  /* Latest packet delayed by backpressure in FAN_OUT mode */
+  atools::fs::sc::SimConnectData pendingData;
+  QByteArray pendingBlock;
+  bool hasPendingPacket = false;
+
   /* Add packet id on send and remove when reply is received */
   QSet<int> lastPacketIds;
   QString peerAddr;
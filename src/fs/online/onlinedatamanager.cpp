@@ -17,6 +17,7 @@
 
 #include "fs/online/onlinedatamanager.h"
 
+#include "fs/online/onlinesnapshot.h"
 #include "fs/online/statustextparser.h"
 #include "fs/online/whazzuptextparser.h"
 
@@ -73,6 +74,23 @@ void OnlinedataManager::readFromTransceivers(const QString& transceiverTxt)
   whazzup->readTransceivers(transceiverTxt);
 }
 
+bool OnlinedataManager::readFromWhazzup(const QByteArray& whazzupData, Format format, const QDateTime& lastUpdate)
+{
+  SqlTransaction transaction(db);
+
+  bool retval = whazzup->read(whazzupData, format, lastUpdate);
+  if(retval)
+    transaction.commit();
+  else
+    transaction.rollback();
+  return retval;
+}
+
+void OnlinedataManager::readFromTransceivers(const QByteArray& transceiverData)
+{
+  whazzup->readTransceivers(transceiverData);
+}
+
 bool OnlinedataManager::readServersFromWhazzup(const QString& whazzupTxt, Format format, const QDateTime& lastUpdate)
 {
   SqlTransaction transaction(db);
@@ -121,7 +139,8 @@ bool OnlinedataManager::hasSchema()
 
 bool OnlinedataManager::hasData()
 {
-  return SqlUtil(db).hasTableAndRows(QStringLiteral("client")) || SqlUtil(db).hasTableAndRows(QStringLiteral("atc"));
+  return !whazzup->getSnapshot().isEmpty() ||
+         SqlUtil(db).hasTableAndRows(QStringLiteral("client")) || SqlUtil(db).hasTableAndRows(QStringLiteral("atc"));
 }
 
 void OnlinedataManager::createSchema()
@@ -142,6 +161,9 @@ void OnlinedataManager::clearData()
   for(const QString& table : tables)
     db->exec(QStringLiteral("delete from ") + table);
   transaction.commit();
+
+  whazzup->clearSnapshot();
+  whazzupServers->clearSnapshot();
 }
 
 void OnlinedataManager::dropSchema()
@@ -190,51 +212,96 @@ atools::fs::sc::SimConnectAircraft OnlinedataManager::getClientAircraft(const at
 
 sql::SqlRecord OnlinedataManager::getClientRecordById(int clientId)
 {
-  SqlQuery query(db);
-  query.prepare(QStringLiteral("select * from client where client_id = :id"));
-  query.bindValue(QStringLiteral(":id"), clientId);
-  query.exec();
-  SqlRecord rec;
-  if(query.next())
-    rec = query.record();
-  query.finish();
-  return rec;
+  const OnlineSnapshotTable& clients = whazzup->getSnapshot().clients;
+  int row = clients.rowById(clientId);
+  return row != -1 ? clients.record(row) : SqlRecord();
 }
 
 sql::SqlRecordList OnlinedataManager::getClientRecordsByCallsign(const QString& callsign)
 {
-  SqlQuery query(db);
-  query.prepare(QStringLiteral("select * from client where callsign = :callsign"));
-  query.bindValue(QStringLiteral(":callsign"), callsign);
-  query.exec();
+  const OnlineSnapshotTable& clients = whazzup->getSnapshot().clients;
+  QList<int> rows;
+  clients.rowsByCallsign(rows, callsign);
+
   sql::SqlRecordList recs;
-  while(query.next())
-    recs.append(query.record());
+  for(int row : std::as_const(rows))
+    recs.append(clients.record(row));
+  return recs;
+}
+
+sql::SqlRecordList OnlinedataManager::getAtcRecordsByCallsign(const QString& callsign)
+{
+  const OnlineSnapshotTable& atc = whazzup->getSnapshot().atc;
+  QList<int> rows;
+  atc.rowsByCallsign(rows, callsign);
+
+  sql::SqlRecordList recs;
+  for(int row : std::as_const(rows))
+    recs.append(atc.record(row));
   return recs;
 }
 
 QList<OnlineAircraft> OnlinedataManager::getClientCallsignAndPosMap()
 {
   QList<OnlineAircraft> clientMap;
-  SqlQuery query(QStringLiteral("select client_id, vid, callsign, groundspeed, heading, altitude, lonx, laty from client"), db);
-  query.exec();
-  while(query.next())
-    clientMap.append(OnlineAircraft(query.valueInt(QStringLiteral("client_id")),
-                                    query.valueStr(QStringLiteral("vid")),
-                                    query.valueStr(QStringLiteral("callsign")),
-                                    atools::fs::sc::SimConnectAircraft::airplaneRegistrationToKey(query.valueStr(QStringLiteral(
-                                                                                                                   "callsign"))),
-                                    query.valueFloat(QStringLiteral("groundspeed")),
-                                    query.valueFloat(QStringLiteral("heading")),
-                                    atools::geo::Pos(query.valueFloat(QStringLiteral("lonx")),
-                                                     query.valueFloat(QStringLiteral("laty")),
-                                                     query.valueFloat(QStringLiteral("altitude")))));
+  whazzup->getSnapshot().getClientAircraft(clientMap);
   return clientMap;
 }
 
+QList<OnlineAircraft> OnlinedataManager::getClientAircraftInRadius(const atools::geo::Pos& pos, float radiusMeter)
+{
+  const OnlineSnapshot& snapshot = whazzup->getSnapshot();
+  QList<int> rows;
+  snapshot.clients.rowsInRadius(rows, pos, radiusMeter);
+
+  QList<OnlineAircraft> aircraft;
+  for(int row : std::as_const(rows))
+    aircraft.append(snapshot.getClientAircraft(row));
+  return aircraft;
+}
+
+const OnlineSnapshot& OnlinedataManager::getSnapshot() const
+{
+  return whazzup->getSnapshot();
+}
+
+const OnlineSnapshotDiff& OnlinedataManager::getSnapshotDiff() const
+{
+  return whazzup->getSnapshotDiff();
+}
+
+QList<atools::fs::sc::SimConnectAircraft> OnlinedataManager::getClientAircraftByIds(const QList<int>& clientIds)
+{
+  const static atools::fs::sc::SimConnectAircraft EMPTY;
+  const OnlineSnapshotTable& clients = whazzup->getSnapshot().clients;
+
+  QList<atools::fs::sc::SimConnectAircraft> aircraftList;
+  for(int id : clientIds)
+  {
+    int row = clients.rowById(id);
+    if(row != -1)
+    {
+      atools::fs::sc::SimConnectAircraft aircraft;
+      fillFromClient(aircraft, clients.record(row), EMPTY);
+      aircraftList.append(aircraft);
+    }
+  }
+  return aircraftList;
+}
+
+void OnlinedataManager::setSqlExport(bool value)
+{
+  whazzup->setSqlExport(value);
+}
+
+bool OnlinedataManager::isSqlExport() const
+{
+  return whazzup->isSqlExport();
+}
+
 int OnlinedataManager::getNumClients() const
 {
-  return SqlUtil(db).rowCount(QStringLiteral("client"));
+  return whazzup->getSnapshot().clients.size();
 }
 
 void OnlinedataManager::setAtcSize(const atools::fs::online::AtcSizeMap& sizeMap)
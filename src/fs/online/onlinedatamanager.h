@@ -43,6 +43,8 @@ class SimConnectAircraft;
 
 namespace online {
 
+class OnlineSnapshot;
+struct OnlineSnapshotDiff;
 class StatusTextParser;
 class WhazzupTextParser;
 
@@ -50,7 +52,9 @@ class WhazzupTextParser;
  * Facade for online classes that parse whazzup.txt and status.txt files for IVAO, VATSIM or other muultiplayer
  * services.
  *
- * All content from whazzup.txt is written into the given database.
+ * Clients and ATC from whazzup.txt are kept in an in-memory snapshot which is used for all client lookups.
+ * The snapshot is additionally written into the given database if SQL export is enabled which is the default.
+ * Servers are always written into the database.
  *
  * Check for schema and create this before reading.
  */
@@ -67,12 +71,16 @@ public:
   /* Read status.txt and populate internal list of URLs and message. File content given in string. */
   void readFromStatus(const QString& statusTxt);
 
-  /* Read all from whazzup.txt or VATSIM JSON 3 file with file content in string and writes all into the database.
+  /* Read all from whazzup.txt or VATSIM JSON 3 file with file content in string into the snapshot and database.
    * Returns true if the file was read and is more recent than lastUpdate. */
   bool readFromWhazzup(const QString& whazzupTxt, Format format, const QDateTime& lastUpdate);
 
+  /* As above for the raw downloaded UTF-8 bytes. JSON formats are parsed as a stream which is faster. */
+  bool readFromWhazzup(const QByteArray& whazzupData, Format format, const QDateTime& lastUpdate);
+
   /* Read VATSIM transceivers-data.json and stores map in this object. Call before calling "readFromWhazzup" */
   void readFromTransceivers(const QString& transceiverTxt);
+  void readFromTransceivers(const QByteArray& transceiverData);
 
   /* Read all servers and voice_servers from whazzup.txt file with file content in string and writes all into the database */
   bool readServersFromWhazzup(const QString& whazzupTxt, Format format, const QDateTime& lastUpdate);
@@ -140,10 +148,31 @@ public:
   /* Get all rows for clients that match the callsign. Normally only one. */
   atools::sql::SqlRecordList getClientRecordsByCallsign(const QString& callsign);
 
+  /* Get all rows for ATC centers that match the callsign. */
+  atools::sql::SqlRecordList getAtcRecordsByCallsign(const QString& callsign);
+
   /* Fill the map with callsign as key and position as value. Used for online/simulator deduplication. */
   QList<atools::fs::online::OnlineAircraft> getClientCallsignAndPosMap();
 
-  /* Number of client aircraft in client table */
+  /* Get client aircraft within radius around pos using the spatial index. Prefiles are omitted. */
+  QList<atools::fs::online::OnlineAircraft> getClientAircraftInRadius(const atools::geo::Pos& pos, float radiusMeter);
+
+  /* In-memory snapshot of clients and ATC from the last whazzup file */
+  const atools::fs::online::OnlineSnapshot& getSnapshot() const;
+
+  /* Changes between the last two whazzup files. Clients and ATC are identified by callsign and vid.
+   * Allows to update map display and aircraft matching only for changed objects. Empty after clearData(). */
+  const atools::fs::online::OnlineSnapshotDiff& getSnapshotDiff() const;
+
+  /* Get aircraft for all client ids from the diff or other lists. Unknown ids are skipped. */
+  QList<atools::fs::sc::SimConnectAircraft> getClientAircraftByIds(const QList<int>& clientIds);
+
+  /* Write clients and ATC into the database tables too. Enabled by default.
+   * The tables are not filled and lookups only use the snapshot if disabled. */
+  void setSqlExport(bool value);
+  bool isSqlExport() const;
+
+  /* Number of client aircraft in snapshot */
   int getNumClients() const;
 
   /* Set default circle radii for certain ATC types where visual range is unusable */
@@ -0,0 +1,331 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/online/onlinesnapshot.h"
+
+#include "exception.h"
+#include "fs/sc/simconnectaircraft.h"
+#include "geo/rect.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+
+#include <QDebug>
+#include <QStringBuilder>
+
+namespace atools {
+namespace fs {
+namespace online {
+
+void OnlineSnapshotTable::init(const atools::sql::SqlRecord& schemaRecord, const QString& idColumnName)
+{
+  schema = schemaRecord;
+  schema.clearValues();
+
+  columns.clear();
+  columnIndexes.clear();
+  for(int i = 0; i < schema.count(); i++)
+  {
+    columnIndexes.insert(schema.fieldName(i), i);
+    columns.append(QList<QVariant>());
+  }
+
+  idColumn = columnIndex(idColumnName);
+  callsignColumn = columnIndex(QStringLiteral("callsign"));
+  vidColumn = columnIndex(QStringLiteral("vid"));
+  lonxColumn = columnIndex(QStringLiteral("lonx"));
+  latyColumn = columnIndex(QStringLiteral("laty"));
+
+  movementColumns.clear();
+  for(const QString& name : {QStringLiteral("lonx"), QStringLiteral("laty"), QStringLiteral("altitude"),
+                             QStringLiteral("heading")})
+  {
+    int index = columnIndex(name);
+    if(index != -1)
+      movementColumns.append(index);
+  }
+
+  if(idColumn == -1)
+    throw atools::Exception(QStringLiteral("Id column \"%1\" not found in online table").arg(idColumnName));
+
+  clear();
+}
+
+void OnlineSnapshotTable::clear()
+{
+  for(QList<QVariant>& column : columns)
+    column.clear();
+
+  boundValues.clear();
+  numRows = 0;
+  idIndex.clear();
+  callsignIndex.clear();
+  keyIndex.clear();
+  posIndex.clearIndex();
+}
+
+void OnlineSnapshotTable::clearBoundValues()
+{
+  boundValues.fill(QVariant(), columns.size());
+}
+
+void OnlineSnapshotTable::bindValue(const QString& placeholder, const QVariant& value)
+{
+  int index = columnIndex(placeholder.mid(1));
+  if(index == -1)
+    throw atools::Exception(QStringLiteral("Placeholder \"%1\" not found in online table").arg(placeholder));
+
+  if(boundValues.size() != columns.size())
+    boundValues.fill(QVariant(), columns.size());
+  boundValues[index] = value;
+}
+
+void OnlineSnapshotTable::bindNullFloat(const QString& placeholder)
+{
+  bindValue(placeholder, QVariant(QMetaType::fromType<double>()));
+}
+
+void OnlineSnapshotTable::bindNullBytes(const QString& placeholder)
+{
+  bindValue(placeholder, QVariant(QMetaType::fromType<QByteArray>()));
+}
+
+void OnlineSnapshotTable::exec()
+{
+  if(boundValues.size() != columns.size())
+    return;
+
+  int id = boundValues.at(idColumn).toInt();
+  int row = idIndex.value(id, -1);
+
+  if(row == -1)
+  {
+    // New row
+    for(int i = 0; i < columns.size(); i++)
+      columns[i].append(boundValues.at(i));
+    idIndex.insert(id, numRows++);
+  }
+  else
+  {
+    // Replace row with the same id
+    for(int i = 0; i < columns.size(); i++)
+      columns[i][row] = boundValues.at(i);
+  }
+}
+
+void OnlineSnapshotTable::buildIndex()
+{
+  callsignIndex.clear();
+  keyIndex.clear();
+  posIndex.clearIndex();
+
+  if(columns.isEmpty())
+    return;
+
+  callsignIndex.reserve(numRows);
+  keyIndex.reserve(numRows);
+  posIndex.reserve(numRows);
+  for(int row = 0; row < numRows; row++)
+  {
+    if(callsignColumn != -1)
+    {
+      QString callsign = value(row, callsignColumn).toString();
+      callsignIndex.insert(callsign, row);
+
+      if(vidColumn != -1)
+        keyIndex.insert(callsign % '|' % value(row, vidColumn).toString(), row);
+    }
+
+    if(lonxColumn != -1 && latyColumn != -1)
+    {
+      const QVariant& lonx = value(row, lonxColumn), & laty = value(row, latyColumn);
+      if(!lonx.isNull() && !laty.isNull())
+        posIndex.append({row, atools::geo::Pos(lonx.toFloat(), laty.toFloat())});
+    }
+  }
+  posIndex.updateIndex();
+}
+
+void OnlineSnapshotTable::diff(OnlineTableDiff& tableDiff, const OnlineSnapshotTable& previous) const
+{
+  tableDiff.clear();
+
+  if(columns.size() != previous.columns.size())
+  {
+    // Not comparable - report all as new
+    for(int row = 0; row < numRows; row++)
+      tableDiff.added.append(value(row, idColumn).toInt());
+    return;
+  }
+
+  for(auto it = keyIndex.constBegin(); it != keyIndex.constEnd(); ++it)
+  {
+    int row = it.value();
+    int id = value(row, idColumn).toInt();
+    int previousRow = previous.keyIndex.value(it.key(), -1);
+
+    if(previousRow == -1)
+    {
+      tableDiff.added.append(id);
+      continue;
+    }
+
+    bool moved = false;
+    for(int column : movementColumns)
+    {
+      if(value(row, column) != previous.value(previousRow, column))
+      {
+        moved = true;
+        break;
+      }
+    }
+
+    if(moved)
+      tableDiff.moved.append(id);
+    else
+    {
+      for(int column = 0; column < columns.size(); column++)
+      {
+        if(value(row, column) != previous.value(previousRow, column))
+        {
+          tableDiff.changed.append(id);
+          break;
+        }
+      }
+    }
+  }
+
+  for(auto it = previous.keyIndex.constBegin(); it != previous.keyIndex.constEnd(); ++it)
+  {
+    if(!keyIndex.contains(it.key()))
+      tableDiff.removed.append(previous.value(it.value(), previous.idColumn).toInt());
+  }
+
+  // Sort for reproducible order
+  std::sort(tableDiff.added.begin(), tableDiff.added.end());
+  std::sort(tableDiff.moved.begin(), tableDiff.moved.end());
+  std::sort(tableDiff.changed.begin(), tableDiff.changed.end());
+  std::sort(tableDiff.removed.begin(), tableDiff.removed.end());
+}
+
+void OnlineSnapshotTable::exportRows(atools::sql::SqlQuery& query) const
+{
+  QStringList placeholders;
+  for(int i = 0; i < schema.count(); i++)
+    placeholders.append(':' + schema.fieldName(i));
+
+  for(int row = 0; row < numRows; row++)
+  {
+    query.clearBoundValues();
+    for(int i = 0; i < columns.size(); i++)
+    {
+      const QVariant& val = value(row, i);
+      if(val.isValid())
+        query.bindValue(placeholders.at(i), val);
+    }
+    query.exec();
+  }
+}
+
+atools::sql::SqlRecord OnlineSnapshotTable::record(int row) const
+{
+  atools::sql::SqlRecord rec(schema);
+  for(int i = 0; i < columns.size(); i++)
+  {
+    const QVariant& val = value(row, i);
+    if(!val.isNull())
+      rec.setValue(i, val);
+  }
+  return rec;
+}
+
+void OnlineSnapshotTable::rowsByCallsign(QList<int>& rows, const QString& callsign) const
+{
+  rows.append(callsignIndex.values(callsign));
+
+  // Keep order of insertion
+  std::sort(rows.begin(), rows.end());
+}
+
+void OnlineSnapshotTable::rowsInRadius(QList<int>& rows, const atools::geo::Pos& pos, float radiusMeter) const
+{
+  QList<int> indexes;
+  posIndex.getRadiusIndexes(indexes, pos, radiusMeter);
+  for(int index : std::as_const(indexes))
+    rows.append(posIndex.at(index).row);
+}
+
+void OnlineSnapshotTable::rowsInRect(QList<int>& rows, const atools::geo::Rect& rect) const
+{
+  QList<int> indexes;
+  posIndex.getInRectIndexes(indexes, rect);
+  for(int index : std::as_const(indexes))
+    rows.append(posIndex.at(index).row);
+}
+
+// =========================================================================================
+
+void OnlineSnapshot::init(atools::sql::SqlDatabase *db)
+{
+  clients.init(db->record(QStringLiteral("client")), QStringLiteral("client_id"));
+  atc.init(db->record(QStringLiteral("atc")), QStringLiteral("atc_id"));
+}
+
+void OnlineSnapshot::clear()
+{
+  clients.clear();
+  atc.clear();
+}
+
+void OnlineSnapshot::buildIndex()
+{
+  clients.buildIndex();
+  atc.buildIndex();
+}
+
+void OnlineSnapshot::diff(OnlineSnapshotDiff& snapshotDiff, const OnlineSnapshot& previous) const
+{
+  clients.diff(snapshotDiff.clients, previous.clients);
+  atc.diff(snapshotDiff.atc, previous.atc);
+}
+
+OnlineAircraft OnlineSnapshot::getClientAircraft(int row) const
+{
+  auto val = [this, row](const QString& name) -> const QVariant& {
+               return clients.value(row, clients.columnIndex(name));
+             };
+
+  const QVariant& lonx = val(QStringLiteral("lonx")), & laty = val(QStringLiteral("laty"));
+  atools::geo::Pos pos;
+  if(!lonx.isNull() && !laty.isNull())
+    pos = atools::geo::Pos(lonx.toFloat(), laty.toFloat(), val(QStringLiteral("altitude")).toFloat());
+
+  QString callsign = val(QStringLiteral("callsign")).toString();
+  return OnlineAircraft(val(QStringLiteral("client_id")).toInt(), val(QStringLiteral("vid")).toString(), callsign,
+                        atools::fs::sc::SimConnectAircraft::airplaneRegistrationToKey(callsign),
+                        val(QStringLiteral("groundspeed")).toFloat(), val(QStringLiteral("heading")).toFloat(), pos);
+}
+
+void OnlineSnapshot::getClientAircraft(QList<OnlineAircraft>& aircraft) const
+{
+  aircraft.reserve(aircraft.size() + clients.size());
+  for(int row = 0; row < clients.size(); row++)
+    aircraft.append(getClientAircraft(row));
+}
+
+} // namespace online
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,264 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_ONLINE_ONLINESNAPSHOT_H
+#define ATOOLS_FS_ONLINE_ONLINESNAPSHOT_H
+
+#include "fs/online/onlinetypes.h"
+#include "geo/spatialindex.h"
+#include "sql/sqlrecord.h"
+
+#include <QHash>
+#include <QVariant>
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+class SqlQuery;
+}
+
+namespace fs {
+namespace online {
+
+/* Position of a row in the snapshot for the spatial index */
+struct OnlineSnapshotPos
+{
+  int row = -1;
+  atools::geo::Pos pos;
+
+  const atools::geo::Pos& getPosition() const
+  {
+    return pos;
+  }
+
+};
+
+/*
+ * Changes of one table between two consecutive snapshots.
+ * Rows are matched by callsign and vid. Values are row ids, i.e. client_id or atc_id, which are stable
+ * across reloads for the same callsign, facility and vid.
+ */
+struct OnlineTableDiff
+{
+  /* Ids of rows in the new snapshot. Moved rows changed position, altitude or heading.
+   * Changed rows have other modified values like flight plan but did not move. */
+  QList<int> added, moved, changed;
+
+  /* Ids of rows in the previous snapshot not present anymore */
+  QList<int> removed;
+
+  bool isEmpty() const
+  {
+    return added.isEmpty() && moved.isEmpty() && changed.isEmpty() && removed.isEmpty();
+  }
+
+  void clear()
+  {
+    added.clear();
+    moved.clear();
+    changed.clear();
+    removed.clear();
+  }
+
+};
+
+/* Changes for clients and ATC between last two snapshots */
+struct OnlineSnapshotDiff
+{
+  OnlineTableDiff clients, atc;
+
+  bool isEmpty() const
+  {
+    return clients.isEmpty() && atc.isEmpty();
+  }
+
+  void clear()
+  {
+    clients.clear();
+    atc.clear();
+  }
+
+};
+
+/*
+ * Column oriented in-memory copy of one online table having the same columns as the database table "client" or "atc".
+ *
+ * Rows are added with the same methods as used for an insert SqlQuery which allows the whazzup parser to fill
+ * this instead of the database. Rows having the same id replace existing ones like "insert or replace".
+ *
+ * Callsign, id and spatial lookups are available after buildIndex().
+ * Not thread safe while adding. Lookups are read only.
+ */
+class OnlineSnapshotTable
+{
+public:
+  OnlineSnapshotTable()
+  {
+  }
+
+  OnlineSnapshotTable(const OnlineSnapshotTable& other) = delete;
+  OnlineSnapshotTable& operator=(const OnlineSnapshotTable& other) = delete;
+
+  /* Take columns and types from the empty record of the database table. idColumnName is the primary key. */
+  void init(const atools::sql::SqlRecord& schemaRecord, const QString& idColumnName);
+
+  /* Remove all rows but keep columns */
+  void clear();
+
+  /* Start a new row. Methods below are compatible to SqlQuery. */
+  void clearBoundValues();
+
+  /* Placeholder is the column name prefixed with a colon. Throws an exception if the column does not exist. */
+  void bindValue(const QString& placeholder, const QVariant& value);
+  void bindNullFloat(const QString& placeholder);
+  void bindNullBytes(const QString& placeholder);
+
+  /* Add the bound values as a new row or replace the row with the same id */
+  void exec();
+
+  /* Build callsign hash and spatial index. Call after adding all rows and before lookups. */
+  void buildIndex();
+
+  /* Compare with previous snapshot and fill diff which is cleared before. Both tables need buildIndex(). */
+  void diff(atools::fs::online::OnlineTableDiff& tableDiff, const OnlineSnapshotTable& previous) const;
+
+  /* Write all rows into the prepared query which has to have named bindings for all columns */
+  void exportRows(atools::sql::SqlQuery& query) const;
+
+  /* True if init() was called */
+  bool isValid() const
+  {
+    return !columns.isEmpty();
+  }
+
+  int size() const
+  {
+    return numRows;
+  }
+
+  bool isEmpty() const
+  {
+    return numRows == 0;
+  }
+
+  /* Column index for name or -1 if not found */
+  int columnIndex(const QString& name) const
+  {
+    return columnIndexes.value(name, -1);
+  }
+
+  /* Value for row and column. Invalid variant for unbound values which are null. */
+  const QVariant& value(int row, int column) const
+  {
+    return columns.at(column).at(row);
+  }
+
+  /* Change value of an existing row. Does not update indexes. */
+  void setValue(int row, int column, const QVariant& value)
+  {
+    columns[column][row] = value;
+  }
+
+  /* Copy row into a record having the same layout as a query on the database table */
+  atools::sql::SqlRecord record(int row) const;
+
+  /* Row index for the id or -1 if not found */
+  int rowById(int id) const
+  {
+    return idIndex.value(id, -1);
+  }
+
+  /* Row indexes for all rows matching the callsign */
+  void rowsByCallsign(QList<int>& rows, const QString& callsign) const;
+
+  /* Row indexes for all rows with position in radius or in rectangle. Rows without position are omitted. */
+  void rowsInRadius(QList<int>& rows, const atools::geo::Pos& pos, float radiusMeter) const;
+  void rowsInRect(QList<int>& rows, const atools::geo::Rect& rect) const;
+
+private:
+  /* Empty record with the table layout */
+  atools::sql::SqlRecord schema;
+
+  /* Values by column and row. Vectors for all columns have the size numRows. */
+  QList<QList<QVariant> > columns;
+  QHash<QString, int> columnIndexes;
+
+  /* Values of the row built by bindValue() */
+  QList<QVariant> boundValues;
+
+  int numRows = 0, idColumn = -1, callsignColumn = -1, vidColumn = -1, lonxColumn = -1, latyColumn = -1;
+
+  /* Columns compared to detect movement */
+  QList<int> movementColumns;
+
+  QHash<int, int> idIndex;
+  QMultiHash<QString, int> callsignIndex;
+
+  /* Row index by callsign and vid for diff */
+  QHash<QString, int> keyIndex;
+  atools::geo::SpatialIndex<OnlineSnapshotPos> posIndex;
+};
+
+/*
+ * Snapshot of all clients or pilots and ATC centers from one whazzup file kept in memory.
+ * Filled by WhazzupTextParser and queried by OnlinedataManager.
+ */
+class OnlineSnapshot
+{
+public:
+  OnlineSnapshot()
+  {
+  }
+
+  OnlineSnapshot(const OnlineSnapshot& other) = delete;
+  OnlineSnapshot& operator=(const OnlineSnapshot& other) = delete;
+
+  /* Take table layout from database schema which has to exist */
+  void init(atools::sql::SqlDatabase *db);
+
+  /* Remove all rows */
+  void clear();
+
+  /* Build indexes for both tables */
+  void buildIndex();
+
+  /* Compare both tables with previous snapshot */
+  void diff(atools::fs::online::OnlineSnapshotDiff& snapshotDiff, const OnlineSnapshot& previous) const;
+
+  bool isEmpty() const
+  {
+    return clients.isEmpty() && atc.isEmpty();
+  }
+
+  /* Client aircraft with database id, callsign and position for the given row */
+  atools::fs::online::OnlineAircraft getClientAircraft(int row) const;
+
+  /* All client aircraft. Used for online/simulator deduplication. Prefiles have no valid position. */
+  void getClientAircraft(QList<atools::fs::online::OnlineAircraft>& aircraft) const;
+
+  /* Table "client" */
+  OnlineSnapshotTable clients;
+
+  /* Table "atc" */
+  OnlineSnapshotTable atc;
+};
+
+} // namespace online
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_ONLINE_ONLINESNAPSHOT_H
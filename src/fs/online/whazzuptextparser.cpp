@@ -24,11 +24,13 @@
 #include "sql/sqldatabase.h"
 #include "geo/linestring.h"
 #include "fs/common/binarygeometry.h"
+#include "util/jsonstreamreader.h"
 
 #include <QJsonArray>
-#include <QJsonDocument>
 #include <QJsonObject>
 #include <QIODevice>
+#include <QStringBuilder>
+#include <QThreadPool>
 #include <QJsonObject>
 #include <QTimeZone>
 
@@ -36,17 +38,27 @@
 #include <QtCore5Compat/QTextCodec>
 #endif
 
+#include <cctype>
+#include <cstring>
+
 using atools::sql::SqlDatabase;
 using atools::sql::SqlQuery;
 using atools::sql::SqlUtil;
 using atools::geo::Rect;
 using atools::geo::LineString;
 using atools::geo::Pos;
+using atools::util::JsonStreamReader;
 
 namespace atools {
 namespace fs {
 namespace online {
 
+/* Minimum number of new ATC geometries to use a separate thread */
+const static int MIN_ATC_GEOMETRIES_PER_THREAD = 50;
+
+/* Minimum number of client lines to split into columns in a separate thread */
+const static int MIN_CLIENT_LINES_PER_THREAD = 500;
+
 /* *INDENT-OFF* */
 
 namespace c {
@@ -145,31 +157,90 @@ WhazzupTextParser::WhazzupTextParser(sql::SqlDatabase *sqlDb, bool verboseErrorR
   // Prefix column array for both formats
   for(int i = 0; i < std::max(v::NUM_VATSIMCOLUMNS, i::NUM_IVAOCOLUMNS); i++)
     defaultColumns.append(QStringLiteral());
+
+  snapshot = new OnlineSnapshot;
+  nextSnapshot = new OnlineSnapshot;
 }
 
 WhazzupTextParser::~WhazzupTextParser()
 {
   deInitQueries();
+  delete snapshot;
+  delete nextSnapshot;
 }
 
 bool WhazzupTextParser::read(QString file, Format streamFormat, const QDateTime& lastUpdate)
 {
-  reset(); // Also resets format
+  return read(file.toUtf8(), streamFormat, lastUpdate);
+}
 
-  format = streamFormat;
+bool WhazzupTextParser::read(const QByteArray& data, Format streamFormat, const QDateTime& lastUpdate)
+{
+  startRead(streamFormat);
 
+  bool retval;
   if(streamFormat == VATSIM_JSON3 || streamFormat == IVAO_JSON2)
-    return readInternalJson(file, lastUpdate);
+    retval = readInternalJson(data, lastUpdate);
   else
+    retval = readInternalDelimited(data, lastUpdate);
+  return finishRead(retval);
+}
+
+void WhazzupTextParser::startRead(Format streamFormat)
+{
+  reset(); // Also resets format
+
+  format = streamFormat;
+
+  // Fill the next snapshot and keep the current one if the file is not more recent
+  nextSnapshot->clear();
+  nextAtcGeometryCache.clear();
+  atcGeometryJobs.clear();
+}
+
+bool WhazzupTextParser::finishRead(bool retval)
+{
+  if(retval)
   {
-    QTextStream stream(&file, QIODevice::ReadOnly | QIODevice::Text);
-    return readInternalDelimited(stream, lastUpdate);
+    createAtcGeometries();
+    nextSnapshot->buildIndex();
+    std::swap(snapshot, nextSnapshot);
+
+    // Compare with previous snapshot before dropping it
+    snapshot->diff(snapshotDiff, *nextSnapshot);
+    nextSnapshot->clear();
+
+    if(sqlExport)
+      exportSnapshot();
   }
+  return retval;
+}
+
+void WhazzupTextParser::exportSnapshot()
+{
+  if(clientInsertQuery != nullptr)
+    snapshot->clients.exportRows(*clientInsertQuery);
+
+  if(atcInsertQuery != nullptr)
+    snapshot->atc.exportRows(*atcInsertQuery);
+}
+
+void WhazzupTextParser::clearSnapshot()
+{
+  snapshot->clear();
+  nextSnapshot->clear();
+  snapshotDiff.clear();
+}
+
+bool WhazzupTextParser::readTransceivers(const QString& file)
+{
+  return readTransceivers(file.toUtf8());
 }
 
-void WhazzupTextParser::readTransceivers(const QString& file)
+bool WhazzupTextParser::readTransceivers(const QByteArray& data)
 {
-  transceiverMap.clear();
+  // Fill a new map which replaces the current one only if reading succeeds
+  QMultiHash<QString, Transceiver> newTransceiverMap;
 
   // [
   // {
@@ -186,74 +257,193 @@ void WhazzupTextParser::readTransceivers(const QString& file)
   // ]
   // },
 
-  // Open and check for errors
-  QJsonParseError jsonErr;
-  QJsonDocument doc = QJsonDocument::fromJson(file.toUtf8(), &jsonErr);
-  if(jsonErr.error != QJsonParseError::NoError)
-    qWarning() << Q_FUNC_INFO << "Error reading data" << jsonErr.errorString() << "at offset" << jsonErr.offset;
+  // Top level is an array or unnamed objects - read values directly from stream
+  JsonStreamReader reader(data);
+  if(reader.readNext() == JsonStreamReader::START_ARRAY)
+  {
+    QList<Transceiver> transceivers;
+    while(reader.readNextElement())
+    {
+      if(reader.getTokenType() != JsonStreamReader::START_OBJECT)
+      {
+        reader.skipValue();
+        continue;
+      }
+
+      // Callsign can appear after the transceivers
+      QString callsign;
+      transceivers.clear();
+      while(reader.readNextKey())
+      {
+        if(reader.isName("callsign"))
+          callsign = reader.getString();
+        else if(reader.isName("transceivers") && reader.getTokenType() == JsonStreamReader::START_ARRAY)
+        {
+          // Get all transceivers with coordinates and frequency for this callsign
+          while(reader.readNextElement())
+          {
+            if(reader.getTokenType() != JsonStreamReader::START_OBJECT)
+            {
+              reader.skipValue();
+              continue;
+            }
+
+            double frequencyHz = 0., lonX = 0., latY = 0.;
+            bool hasLonX = false, hasLatY = false;
+            while(reader.readNextKey())
+            {
+              if(reader.isName("frequency"))
+                frequencyHz = reader.getDouble();
+              else if(reader.isName("lonDeg"))
+              {
+                lonX = reader.getDouble();
+                hasLonX = reader.getTokenType() == JsonStreamReader::NUMBER;
+              }
+              else if(reader.isName("latDeg"))
+              {
+                latY = reader.getDouble();
+                hasLatY = reader.getTokenType() == JsonStreamReader::NUMBER;
+              }
+              else
+                reader.skipValue();
+            }
+
+            // Build and add object to multi hash with callsign as key
+            Transceiver transceiver;
+
+            // frequency in kHz
+            int frequency = atools::roundToInt(frequencyHz / 1000.f);
+            if(frequency < 100 && error)
+              qWarning() << Q_FUNC_INFO << "Invalid frequency" << frequencyHz << "for" << callsign;
+            else
+              transceiver.frequency.insert(frequency);
+
+            if(hasLonX && hasLatY)
+              transceiver.pos = Pos(lonX, latY);
+            transceivers.append(transceiver);
+          }
+        }
+        else
+          reader.skipValue();
+      } // while(reader.readNextKey())
+
+      for(const Transceiver& transceiver : std::as_const(transceivers))
+        newTransceiverMap.insert(callsign, transceiver);
+    } // while(reader.readNextElement())
+  }
 
-  // Top level is an array or unnamed objects
-  const QJsonArray transValues = doc.array();
-  for(const QJsonValue& transVal : transValues)
+  if(reader.hasError())
   {
-    QJsonObject transObj = transVal.toObject();
-    QString callsign = transObj.value(QStringLiteral("callsign")).toString();
+    qWarning() << Q_FUNC_INFO << "Error reading data" << reader.getErrorString() << "at offset" << reader.getOffset();
+    return false;
+  }
+
+  transceiverMap.swap(newTransceiverMap);
+  return true;
+}
 
-    // Get all transceivers with coordinates and frequency for this callsign
-    const QJsonArray transceiverValues = transObj.value(QStringLiteral("transceivers")).toArray();
-    for(const QJsonValue& transceiverVal : transceiverValues)
+bool WhazzupTextParser::readUpdateJson(const QByteArray& data, const QDateTime& lastUpdate)
+{
+  // Only look at the update time and skip all other top level values since these can appear in any order
+  QDateTime update;
+  JsonStreamReader reader(data);
+  if(reader.readNext() == JsonStreamReader::START_OBJECT)
+  {
+    while(reader.readNextKey())
     {
-      QJsonObject transceiverObj = transceiverVal.toObject();
-      Pos pos(transceiverObj.value(QStringLiteral("lonDeg")), transceiverObj.value(QStringLiteral("latDeg")));
+      if(format == VATSIM_JSON3 && reader.isName("general"))
+      {
+        // Read time from general section =============
+        // "general": {
+        // "version": 3,
+        // "reload": 1,
+        // "update": "20210314160704",
+        // "update_timestamp": "2021-03-14T16:07:04.9418979Z",
+        // "connected_clients": 1857,
+        // "unique_users": 1777
+        // },
+        QJsonObject generalObj = reader.readValue().toObject();
+
+        // Version and reload time in minutes
+        version = generalObj.value(QStringLiteral("version")).toInt();
+        reload = generalObj.value(QStringLiteral("reload")).toInt();
+        update = generalObj.value(QStringLiteral("update_timestamp")).toVariant().toDateTime();
+      }
+      else if(format == IVAO_JSON2 && reader.isName("updatedAt"))
+        // "updatedAt": "2021-06-20T21:09:19.642Z",
+        update = QVariant(reader.getString()).toDateTime();
+      else
+        reader.skipValue();
+    }
+  }
 
-      // Build and add object to multi hash with callsign as key
-      Transceiver transceiver;
+  if(reader.hasError())
+  {
+    qWarning() << Q_FUNC_INFO << "Error reading data" << reader.getErrorString() << "at offset" << reader.getOffset();
+    return false;
+  }
 
-      // frequency in kHz
-      int frequency = atools::roundToInt(transceiverObj.value(QStringLiteral("frequency")).toDouble() / 1000.f);
-      if(frequency < 100 && error)
-        qWarning() << Q_FUNC_INFO << "Invalid frequency" << transceiverObj.value("frequency").toInt() << "for" << callsign;
-      else
-        transceiver.frequency.insert(frequency);
-      transceiver.pos = Pos(transceiverObj.value(QStringLiteral("lonDeg")), transceiverObj.value(QStringLiteral("latDeg")));
-      transceiverMap.insert(callsign, transceiver);
-    } // for(QJsonValue transceiverVal : transObj.value("transceivers").toArray())
-  } // for(QJsonValue transVal : doc.array())
+  return checkUpdate(update, lastUpdate);
 }
 
-bool WhazzupTextParser::readInternalJson(const QString& file, const QDateTime& lastUpdate)
+bool WhazzupTextParser::readInternalJson(const QByteArray& data, const QDateTime& lastUpdate)
 {
-  // Open and check for errors =============
-  QJsonParseError jsonErr;
-  QJsonDocument doc = QJsonDocument::fromJson(file.toUtf8(), &jsonErr);
-  if(jsonErr.error != QJsonParseError::NoError)
-    qWarning() << Q_FUNC_INFO << "Error reading data" << jsonErr.errorString() << "at offset" << jsonErr.offset;
+  // Check update time and syntax before deleting any rows
+  if(!readUpdateJson(data, lastUpdate))
+    return false;
 
-  QDateTime update;
-  QJsonObject obj = doc.object();
-
-  if(format == VATSIM_JSON3)
+  // Read top level object from stream and pass only single clients, controllers or servers as objects =============
+  JsonStreamReader reader(data);
+  if(reader.readNext() == JsonStreamReader::START_OBJECT)
   {
-    // Read time from general section =============
-    // "general": {
-    // "version": 3,
-    // "reload": 1,
-    // "update": "20210314160704",
-    // "update_timestamp": "2021-03-14T16:07:04.9418979Z",
-    // "connected_clients": 1857,
-    // "unique_users": 1777
-    // },
-    QJsonObject generalObj = obj.value(QStringLiteral("general")).toObject();
-    update = generalObj.value(QStringLiteral("update_timestamp")).toVariant().toDateTime();
+    while(reader.readNextKey())
+    {
+      if(format == IVAO_JSON2 && reader.isName("clients") &&
+              reader.getTokenType() == JsonStreamReader::START_OBJECT)
+      {
+        // Clients/pilots, controllers/atcs and observers =================================
+        while(reader.readNextKey())
+        {
+          if(reader.isName("pilots"))
+            readClientsJson(reader, false /* atc */, false /* observer */);
+          else if(reader.isName("atcs"))
+            readClientsJson(reader, true /* atc */, false /* observer */);
+          else if(reader.isName("observers"))
+            readClientsJson(reader, true /* atc */, true /* observer */);
+          else
+            reader.skipValue();
+        }
+      }
+      else if(format == VATSIM_JSON3 && reader.isName("pilots"))
+        readClientsJson(reader, false /* atc */, false /* observer */);
+      else if(format == VATSIM_JSON3 && reader.isName("controllers"))
+        readClientsJson(reader, true /* atc */, false /* observer */);
+      else if(reader.isName("servers"))
+        readServersJson(reader, false /* voice */);
+      else if(format == IVAO_JSON2 && reader.isName("voiceServers"))
+        readServersJson(reader, true /* voice */);
+      else if(format == VATSIM_JSON3 && reader.isName("prefiles"))
+        // Prefiles - only VATSIM =================================
+        readPrefilesJson(reader);
+      else
+        // ATIS - only VATSIM =================================
+        // readAtisJson(obj); TODO Currently ignored since missing connection to controllers
+        reader.skipValue();
+    }
+  }
 
-    // Version and reload time in minutes
-    version = generalObj.value(QStringLiteral("version")).toInt();
-    reload = generalObj.value(QStringLiteral("reload")).toInt();
+  if(reader.hasError())
+  {
+    // Caller rolls back the transaction and the current snapshot is kept
+    qWarning() << Q_FUNC_INFO << "Error reading data" << reader.getErrorString() << "at offset" << reader.getOffset();
+    return false;
   }
-  else if(format == IVAO_JSON2)
-    // "updatedAt": "2021-06-20T21:09:19.642Z",
-    update = obj.value(QStringLiteral("updatedAt")).toVariant().toDateTime();
 
+  return true;
+}
+
+bool WhazzupTextParser::checkUpdate(QDateTime update, const QDateTime& lastUpdate)
+{
   if(update.isValid())
   {
     if(update <= lastUpdate)
@@ -263,43 +453,86 @@ bool WhazzupTextParser::readInternalJson(const QString& file, const QDateTime& l
     update.setTimeZone(QTimeZone::UTC);
     updateTimestamp = update;
   }
+  return true;
+}
+
+void WhazzupTextParser::readClientsJson(JsonStreamReader& reader, bool atc, bool observer)
+{
+  if(reader.getTokenType() != JsonStreamReader::START_ARRAY)
+  {
+    reader.skipValue();
+    return;
+  }
 
-  // Read other object arrays ==================================================================
-  // Clients/pilots =================================
-  QJsonObject clients = format == VATSIM_JSON3 ? obj : obj.value(QStringLiteral("clients")).toObject();
-  QJsonArray pilotsArr = clients.value(QStringLiteral("pilots")).toArray();
-  if(!pilotsArr.isEmpty())
-    db->exec(QStringLiteral("delete from client"));
+  bool first = true;
+  while(reader.readNextElement())
+  {
+    if(reader.getTokenType() != JsonStreamReader::START_OBJECT)
+    {
+      reader.skipValue();
+      continue;
+    }
 
-  readPilotsJson(pilotsArr);
+    if(first)
+    {
+      // Remove old rows only if there are new ones
+      if(!observer)
+        db->exec(atc ? QStringLiteral("delete from atc") : QStringLiteral("delete from client"));
+      first = false;
+    }
 
-  // Controllers/atcs and observers =================================
-  QJsonArray controllersArr = format == VATSIM_JSON3 ? obj.value(QStringLiteral("controllers")).toArray() :
-                              obj.value(QStringLiteral("clients")).toObject().value(QStringLiteral("atcs")).toArray();
-  if(!controllersArr.isEmpty())
-    db->exec(QStringLiteral("delete from atc"));
-  readControllersJson(controllersArr, false /* observer */);
+    // Only one client is kept in memory
+    if(atc)
+      readControllerJson(reader.readValue().toObject(), observer);
+    else
+      readPilotJson(reader.readValue().toObject());
+  }
+}
 
-  if(format == IVAO_JSON2)
-    readControllersJson(clients.value(QStringLiteral("observers")).toArray(), true /* observer */);
+void WhazzupTextParser::readServersJson(JsonStreamReader& reader, bool voice)
+{
+  if(reader.getTokenType() != JsonStreamReader::START_ARRAY)
+  {
+    reader.skipValue();
+    return;
+  }
 
-  // Servers =================================
-  QJsonArray serversArr = obj.value(QStringLiteral("servers")).toArray();
-  if(!serversArr.isEmpty())
-    db->exec(QStringLiteral("delete from server"));
-  readServersJson(serversArr, false /* voice */);
+  bool first = true;
+  while(reader.readNextElement())
+  {
+    if(reader.getTokenType() != JsonStreamReader::START_OBJECT)
+    {
+      reader.skipValue();
+      continue;
+    }
 
-  if(format == IVAO_JSON2)
-    readServersJson(obj.value(QStringLiteral("voiceServers")).toArray(), true /* voice */);
+    if(first)
+    {
+      // Remove old rows only if there are new ones
+      if(!voice)
+        db->exec(QStringLiteral("delete from server"));
+      first = false;
+    }
 
-  // Prefiles - only VATSIM =================================
-  if(format == VATSIM_JSON3)
-    readPrefilesJson(obj);
+    readServerJson(reader.readValue().toObject(), voice);
+  }
+}
 
-  // ATIS - only VATSIM =================================
-  // readAtisJson(obj); TODO Currently ignored since missing connection to controllers
+void WhazzupTextParser::readPrefilesJson(JsonStreamReader& reader)
+{
+  if(reader.getTokenType() != JsonStreamReader::START_ARRAY)
+  {
+    reader.skipValue();
+    return;
+  }
 
-  return true;
+  while(reader.readNextElement())
+  {
+    if(reader.getTokenType() == JsonStreamReader::START_OBJECT)
+      readPrefileJson(reader.readValue().toObject());
+    else
+      reader.skipValue();
+  }
 }
 
 // Currently ignored
@@ -346,372 +579,358 @@ void WhazzupTextParser::readAtisJson(const QJsonObject& obj)
   }
 }
 
-void WhazzupTextParser::readServersJson(const QJsonArray& serversArr, bool voice)
+void WhazzupTextParser::readServerJson(const QJsonObject& serverObj, bool voice)
 {
-  for(const QJsonValue& serverVal : serversArr)
-  {
-    QJsonObject serverObj = serverVal.toObject();
-
-    // Build a column list like the one fetched from the whazzup.txt
-    // ident:hostname_or_IP:location:name:clients_connection_allowed:
-    // CZECH:212.67.73.150:Czech Republic:CenterEast Europe Server - sponsored by VACC-CZ:1:
-    QStringList columns;
-
-    if(format == VATSIM_JSON3)
-    {
-      // "servers": [
-      // {
-      // "ident": "CANADA",
-      // "hostname_or_ip": "165.22.239.218",
-      // "location": "Toronto, Canada",
-      // "name": "ANONYM",
-      // "clients_connection_allowed": 1
-      // },
-      columns.append(serverObj.value(QStringLiteral("ident")).toVariant().toString());
-      columns.append(serverObj.value(QStringLiteral("hostname_or_ip")).toVariant().toString());
-      columns.append(serverObj.value(QStringLiteral("location")).toVariant().toString());
-      columns.append(serverObj.value(QStringLiteral("name")).toVariant().toString());
-      columns.append(QStringLiteral()); // client_connections_allowed
-      columns.append(QStringLiteral()); // allowed_connections
-      columns.append(QStringLiteral()); // voice_type
-    }
-    else if(format == IVAO_JSON2)
-    {
-      // "servers": [
-      // {
-      // "id": "SHARD1",
-      // "hostname": "shard1.net.ivao.aero",
-      // "ip": "146.59.200.142",
-      // "description": "IVAO SHARD1 - Network Server",
-      // "countryId": "FR",
-      // "currentConnections": 131,
-      // "maximumConnections": 750
-      // },
-      columns.append(serverObj.value(QStringLiteral("id")).toVariant().toString());
-      columns.append(serverObj.value(QStringLiteral("hostname")).toVariant().toString());
-      columns.append(serverObj.value(QStringLiteral("countryId")).toVariant().toString());
-      columns.append(serverObj.value(QStringLiteral("description")).toVariant().toString());
-      columns.append(QStringLiteral()); // client_connections_allowed
-      columns.append(QStringLiteral()); // allowed_connections
-      columns.append(voice ? QStringLiteral("T") : QStringLiteral()); // voice_type
-    }
+  // Build a column list like the one fetched from the whazzup.txt
+  // ident:hostname_or_IP:location:name:clients_connection_allowed:
+  // CZECH:212.67.73.150:Czech Republic:CenterEast Europe Server - sponsored by VACC-CZ:1:
+  QStringList columns;
 
-    parseServersSection(columns);
+  if(format == VATSIM_JSON3)
+  {
+    // "servers": [
+    // {
+    // "ident": "CANADA",
+    // "hostname_or_ip": "165.22.239.218",
+    // "location": "Toronto, Canada",
+    // "name": "ANONYM",
+    // "clients_connection_allowed": 1
+    // },
+    columns.append(serverObj.value(QStringLiteral("ident")).toVariant().toString());
+    columns.append(serverObj.value(QStringLiteral("hostname_or_ip")).toVariant().toString());
+    columns.append(serverObj.value(QStringLiteral("location")).toVariant().toString());
+    columns.append(serverObj.value(QStringLiteral("name")).toVariant().toString());
+    columns.append(QStringLiteral()); // client_connections_allowed
+    columns.append(QStringLiteral()); // allowed_connections
+    columns.append(QStringLiteral()); // voice_type
   }
+  else if(format == IVAO_JSON2)
+  {
+    // "servers": [
+    // {
+    // "id": "SHARD1",
+    // "hostname": "shard1.net.ivao.aero",
+    // "ip": "146.59.200.142",
+    // "description": "IVAO SHARD1 - Network Server",
+    // "countryId": "FR",
+    // "currentConnections": 131,
+    // "maximumConnections": 750
+    // },
+    columns.append(serverObj.value(QStringLiteral("id")).toVariant().toString());
+    columns.append(serverObj.value(QStringLiteral("hostname")).toVariant().toString());
+    columns.append(serverObj.value(QStringLiteral("countryId")).toVariant().toString());
+    columns.append(serverObj.value(QStringLiteral("description")).toVariant().toString());
+    columns.append(QStringLiteral()); // client_connections_allowed
+    columns.append(QStringLiteral()); // allowed_connections
+    columns.append(voice ? QStringLiteral("T") : QStringLiteral()); // voice_type
+  }
+
+  parseServersSection(columns);
 }
 
-void WhazzupTextParser::readControllersJson(const QJsonArray& controllersArr, bool observer)
+void WhazzupTextParser::readControllerJson(const QJsonObject& atcObj, bool observer)
 {
-  // Open and check for errors =========================================
   // Prefill with empty strings for pilots/clients delimited format
-  for(const QJsonValue& atcVal : controllersArr)
+  QStringList columns(defaultColumns);
+  QString callsign = atcObj.value(QStringLiteral("callsign")).toVariant().toString();
+  columns[c::CALLSIGN] = callsign;
+  columns[c::CLIENTTYPE] = QStringLiteral("ATC");
+
+  if(format == VATSIM_JSON3)
   {
-    QStringList columns(defaultColumns);
-    QJsonObject atcObj = atcVal.toObject();
-    QString callsign = atcObj.value(QStringLiteral("callsign")).toVariant().toString();
-    columns[c::CALLSIGN] = callsign;
-    columns[c::CLIENTTYPE] = QStringLiteral("ATC");
+    // "controllers": [
+    // {
+    // "cid": 813331,
+    // "name": "ANONYM",
+    // "callsign": "EFIN_D_CTR",
+    // "frequency": "121.300",
+    // "facility": 6,
+    // "rating": 5,
+    // "server": "UK-1",
+    // "visual_range": 300,
+    // "text_atis": [
+    // "HELSINKI CONTROL"
+    // ],
+    // "last_updated": "2021-03-14T16:07:00.8535377Z",
+    // "logon_time": "2021-03-14T08:10:47.665987Z"
+    // },
+    columns[c::CID] = atcObj.value(QStringLiteral("cid")).toVariant().toString();
+    columns[c::REALNAME] = atcObj.value(QStringLiteral("name")).toVariant().toString();
+
+    columns[c::FACILITYTYPE] = atcObj.value(QStringLiteral("facility")).toVariant().toString();
+    columns[c::SERVER] = atcObj.value(QStringLiteral("server")).toVariant().toString();
+    columns[c::VISUALRANGE] = atcObj.value(QStringLiteral("visual_range")).toVariant().toString();
 
-    if(format == VATSIM_JSON3)
+    // Read ATIS message array into linefeed separated string =========
+    QStringList atisStrList;
+    const QJsonArray atisArray = atcObj.value(QStringLiteral("text_atis")).toArray();
+    for(const QJsonValue& value : atisArray)
+      atisStrList.append(value.toString());
+    atisStrList.removeAll(QStringLiteral());
+    columns[v::ATIS_MESSAGE] = atisStrList.join('\n');
+    columns[v::TIME_LAST_ATIS_RECEIVED] = atcObj.value(QStringLiteral("last_updated")).toVariant().toString();
+    columns[v::TIME_LOGON] = atcObj.value(QStringLiteral("logon_time")).toVariant().toString();
+
+    // Get all transceivers with callsign =========
+    if(transceiverMap.contains(callsign))
     {
-      // "controllers": [
-      // {
-      // "cid": 813331,
-      // "name": "ANONYM",
-      // "callsign": "EFIN_D_CTR",
-      // "frequency": "121.300",
-      // "facility": 6,
-      // "rating": 5,
-      // "server": "UK-1",
-      // "visual_range": 300,
-      // "text_atis": [
-      // "HELSINKI CONTROL"
-      // ],
-      // "last_updated": "2021-03-14T16:07:00.8535377Z",
-      // "logon_time": "2021-03-14T08:10:47.665987Z"
-      // },
-      columns[c::CID] = atcObj.value(QStringLiteral("cid")).toVariant().toString();
-      columns[c::REALNAME] = atcObj.value(QStringLiteral("name")).toVariant().toString();
-
-      columns[c::FACILITYTYPE] = atcObj.value(QStringLiteral("facility")).toVariant().toString();
-      columns[c::SERVER] = atcObj.value(QStringLiteral("server")).toVariant().toString();
-      columns[c::VISUALRANGE] = atcObj.value(QStringLiteral("visual_range")).toVariant().toString();
-
-      // Read ATIS message array into linefeed separated string =========
-      QStringList atisStrList;
-      const QJsonArray atisArray = atcObj.value(QStringLiteral("text_atis")).toArray();
-      for(const QJsonValue& value : atisArray)
-        atisStrList.append(value.toString());
-      atisStrList.removeAll(QStringLiteral());
-      columns[v::ATIS_MESSAGE] = atisStrList.join('\n');
-      columns[v::TIME_LAST_ATIS_RECEIVED] = atcObj.value(QStringLiteral("last_updated")).toVariant().toString();
-      columns[v::TIME_LOGON] = atcObj.value(QStringLiteral("logon_time")).toVariant().toString();
-
-      // Get all transceivers with callsign =========
-      if(transceiverMap.contains(callsign))
+      Rect rect;
+      QSet<int> frequencies; // kHz
+      frequencies.insert(atools::roundToInt(atcObj.value(QStringLiteral("frequency")).toVariant().toDouble() * 1000.f));
+
+      // Read all frequencies and build a bounding rectangle from positions
+      const QList<Transceiver> transceivers = transceiverMap.values(callsign);
+      for(const Transceiver& transceiver : transceivers)
       {
-        Rect rect;
-        QSet<int> frequencies; // kHz
-        frequencies.insert(atools::roundToInt(atcObj.value(QStringLiteral("frequency")).toVariant().toDouble() * 1000.f));
+        frequencies.unite(transceiver.frequency);
+        rect.extend(transceiver.pos);
+      }
+      frequencies.remove(0);
 
-        // Read all frequencies and build a bounding rectangle from positions
-        const QList<Transceiver> transceivers = transceiverMap.values(callsign);
-        for(const Transceiver& transceiver : transceivers)
-        {
-          frequencies.unite(transceiver.frequency);
-          rect.extend(transceiver.pos);
-        }
-        frequencies.remove(0);
+      // Convert frequencies to mHz
+      QList<float> frequenciesMhz;
+      for(int f : frequencies)
+        frequenciesMhz.append(f / 1000.f);
 
-        // Convert frequencies to mHz
-        QList<float> frequenciesMhz;
-        for(int f : frequencies)
-          frequenciesMhz.append(f / 1000.f);
+      columns[c::FREQUENCY] = atools::floatVectorToStrList(frequenciesMhz).join('&');
 
-        columns[c::FREQUENCY] = atools::floatVectorToStrList(frequenciesMhz).join('&');
+      // Use center of bounding rectangle as position
+      columns[c::LONGITUDE] = QString::number(rect.getCenter().getLonX());
+      columns[c::LATITUDE] = QString::number(rect.getCenter().getLatY());
+    }
+    else
+    {
+      // Center has no geometry in the transceiever list ====================
+      columns[c::FREQUENCY] = QString::number(atcObj.value(QStringLiteral("frequency")).toVariant().toDouble());
 
-        // Use center of bounding rectangle as position
-        columns[c::LONGITUDE] = QString::number(rect.getCenter().getLonX());
-        columns[c::LATITUDE] = QString::number(rect.getCenter().getLatY());
-      }
-      else
+      if(atcObj.contains(QStringLiteral("latitude")) && atcObj.contains(QStringLiteral("longitude")))
       {
-        // Center has no geometry in the transceiever list ====================
-        columns[c::FREQUENCY] = QString::number(atcObj.value(QStringLiteral("frequency")).toVariant().toDouble());
-
-        if(atcObj.contains(QStringLiteral("latitude")) && atcObj.contains(QStringLiteral("longitude")))
-        {
-          columns[c::LATITUDE] = atcObj.value(QStringLiteral("latitude")).toVariant().toString();
-          columns[c::LONGITUDE] = atcObj.value(QStringLiteral("longitude")).toVariant().toString();
-        }
+        columns[c::LATITUDE] = atcObj.value(QStringLiteral("latitude")).toVariant().toString();
+        columns[c::LONGITUDE] = atcObj.value(QStringLiteral("longitude")).toVariant().toString();
       }
     }
-    else if(format == IVAO_JSON2)
-    {
-      // "atcs": [
-      // {
-      // "time": 22493,
-      // "id": 40650557,
-      // "userId": 646135,
-      // "callsign": "YBBN_CTR",
-      // "serverId": "SHARD2",
-      // "softwareTypeId": "aurora",
-      // "softwareVersion": "1.2.16b",
-      // "createdAt": "2021-06-20T14:54:25.000Z",
-      // "atcSession": {
-      // "frequency": 124.8,
-      // "position": "CTR"
-      // },
-      // "atis": {
-      // "lines": [
-      // "eu17.ts.ivao.aero/YBBN_CTR",
-      // "Brisbane Centre",
-      // "TRL FL110 / TA 10000ft",
-      // ""
-      // ],
-      // "revision": "O",
-      // "timestamp": "2021-06-20T20:50:03.891Z"
-      // },
-      // "lastTrack": {
-      // "distance": 1000,
-      // "latitude": -27.38417,
-      // "longitude": 153.1175,
-      // "time": 22474,
-      // "timestamp": "2021-06-20T21:08:59.133Z"
-      // }
-      // },
-      columns[c::CID] = atcObj.value(QStringLiteral("id")).toVariant().toString();
-      columns[c::REALNAME] = atcObj.value(QStringLiteral("name")).toVariant().toString();
-      columns[c::SERVER] = atcObj.value(QStringLiteral("serverId")).toVariant().toString();
-      columns[i::SOFTWARE_NAME] = atcObj.value(QStringLiteral("softwareTypeId")).toVariant().toString();
-      columns[i::SOFTWARE_VERSION] = atcObj.value(QStringLiteral("softwareVersion")).toVariant().toString();
-
-      // Read ATIS message array =========
-      QStringList atisList;
-      const QJsonArray atisArr = atcObj.value(QStringLiteral("atis")).toObject().value(QStringLiteral("lines")).toArray();
-      for(const QJsonValue& value : atisArr)
-        atisList.append(value.toString());
-      atisList.removeAll(QStringLiteral());
-      columns[i::ATIS] = atisList.join('\n');
-      columns[i::ATIS_TIME] = atcObj.value(QStringLiteral("atis")).toObject().value(QStringLiteral("timestamp")).toString();
-
-      columns[i::CONNECTION_TIME] = atcObj.value(QStringLiteral("createdAt")).toVariant().toString();
-
-      QJsonObject atcSession = atcObj.value(QStringLiteral("atcSession")).toObject();
-      columns[c::FREQUENCY] = atcSession.value(QStringLiteral("frequency")).toVariant().toString();
-
-      if(observer)
-        columns[c::FACILITYTYPE] = QString::number(fac::OBSERVER);
-      else
-        columns[c::FACILITYTYPE] = QString::number(textToFacilityType(atcSession.value(QStringLiteral("position")).toVariant().toString()));
+  }
+  else if(format == IVAO_JSON2)
+  {
+    // "atcs": [
+    // {
+    // "time": 22493,
+    // "id": 40650557,
+    // "userId": 646135,
+    // "callsign": "YBBN_CTR",
+    // "serverId": "SHARD2",
+    // "softwareTypeId": "aurora",
+    // "softwareVersion": "1.2.16b",
+    // "createdAt": "2021-06-20T14:54:25.000Z",
+    // "atcSession": {
+    // "frequency": 124.8,
+    // "position": "CTR"
+    // },
+    // "atis": {
+    // "lines": [
+    // "eu17.ts.ivao.aero/YBBN_CTR",
+    // "Brisbane Centre",
+    // "TRL FL110 / TA 10000ft",
+    // ""
+    // ],
+    // "revision": "O",
+    // "timestamp": "2021-06-20T20:50:03.891Z"
+    // },
+    // "lastTrack": {
+    // "distance": 1000,
+    // "latitude": -27.38417,
+    // "longitude": 153.1175,
+    // "time": 22474,
+    // "timestamp": "2021-06-20T21:08:59.133Z"
+    // }
+    // },
+    columns[c::CID] = atcObj.value(QStringLiteral("id")).toVariant().toString();
+    columns[c::REALNAME] = atcObj.value(QStringLiteral("name")).toVariant().toString();
+    columns[c::SERVER] = atcObj.value(QStringLiteral("serverId")).toVariant().toString();
+    columns[i::SOFTWARE_NAME] = atcObj.value(QStringLiteral("softwareTypeId")).toVariant().toString();
+    columns[i::SOFTWARE_VERSION] = atcObj.value(QStringLiteral("softwareVersion")).toVariant().toString();
 
-      QJsonObject lastTrack = atcObj.value(QStringLiteral("lastTrack")).toObject();
-      columns[c::VISUALRANGE] = lastTrack.value(QStringLiteral("distance")).toVariant().toString();
-      columns[c::LONGITUDE] = lastTrack.value(QStringLiteral("longitude")).toVariant().toString();
-      columns[c::LATITUDE] = lastTrack.value(QStringLiteral("latitude")).toVariant().toString();
-    }
+    // Read ATIS message array =========
+    QStringList atisList;
+    const QJsonArray atisArr = atcObj.value(QStringLiteral("atis")).toObject().value(QStringLiteral("lines")).toArray();
+    for(const QJsonValue& value : atisArr)
+      atisList.append(value.toString());
+    atisList.removeAll(QStringLiteral());
+    columns[i::ATIS] = atisList.join('\n');
+    columns[i::ATIS_TIME] = atcObj.value(QStringLiteral("atis")).toObject().value(QStringLiteral("timestamp")).toString();
+
+    columns[i::CONNECTION_TIME] = atcObj.value(QStringLiteral("createdAt")).toVariant().toString();
 
-    // Read line with method for delimited format
-    parseSection(columns, true /* isAtc */, false /* isPrefile */, true /* isJson */);
-  } // for(QJsonValue atcVal : controllersArr)
+    QJsonObject atcSession = atcObj.value(QStringLiteral("atcSession")).toObject();
+    columns[c::FREQUENCY] = atcSession.value(QStringLiteral("frequency")).toVariant().toString();
+
+    if(observer)
+      columns[c::FACILITYTYPE] = QString::number(fac::OBSERVER);
+    else
+      columns[c::FACILITYTYPE] = QString::number(textToFacilityType(atcSession.value(QStringLiteral("position")).toVariant().toString()));
+
+    QJsonObject lastTrack = atcObj.value(QStringLiteral("lastTrack")).toObject();
+    columns[c::VISUALRANGE] = lastTrack.value(QStringLiteral("distance")).toVariant().toString();
+    columns[c::LONGITUDE] = lastTrack.value(QStringLiteral("longitude")).toVariant().toString();
+    columns[c::LATITUDE] = lastTrack.value(QStringLiteral("latitude")).toVariant().toString();
+  }
+
+  // Read line with method for delimited format
+  parseSection(columns, true /* isAtc */, false /* isPrefile */, true /* isJson */);
 }
 
-void WhazzupTextParser::readPilotsJson(const QJsonArray& pilotsArr)
+void WhazzupTextParser::readPilotJson(const QJsonObject& pilotObj)
 {
   // Prefill with empty strings for pilots/clients delimited format
-  for(const QJsonValue& pilotVal : pilotsArr)
+  QStringList columns(defaultColumns);
+
+  columns[c::CALLSIGN] = pilotObj.value(QStringLiteral("callsign")).toString();
+  columns[c::CLIENTTYPE] = QStringLiteral("PILOT");
+
+  if(format == VATSIM_JSON3)
   {
-    QStringList columns(defaultColumns);
-    QJsonObject pilotObj = pilotVal.toObject();
+    // "pilots": [
+    // {
+    // "cid": 1474512,
+    // "name": "ANONYM",
+    // "callsign": "ABS9481",
+    // "server": "GERMANY-2",
+    // "pilot_rating": 0,
+    // "latitude": 33.68793,
+    // "longitude": -7.51442,
+    // "altitude": 2501,
+    // "groundspeed": 193,
+    // "transponder": "2000",
+    // "heading": 163,
+    // "qnh_i_hg": 30.13,
+    // "qnh_mb": 1020,
+    //
+    // "flight_plan": {
+    // "flight_rules": "I",
+    // "aircraft": "B77L/H-SDE1E2E3FGHIJ2J3J4J5M1RWXY/LB1D1",
+    // "aircraft_faa": "H/B77L/L",
+    // "aircraft_short": "B77L",
+    // "departure": "OMDB",
+    // "arrival": "SBGR",
+    // "alternate": "SBGL",
+    // "cruise_tas": "492",
+    // "altitude": "32000",
+    // "deptime": "2300",
+    // "enroute_time": "1442",
+    // "fuel_time": "1638",
+    // "remarks": "PBN/A1B1C1D1L1O1S2 DOF/210313 ... /V/",
+    // "route": "NABIX3G NABIX P699 OXARI M430 KIA ... UL327 SIDUR UZ10 ILMIG DCT TBE TBE2B"
+    // },
+    //
+    // "logon_time": "2021-03-13T22:38:09.826199Z",
+    // "last_updated": "2021-03-14T16:07:00.8565953Z"
+    // },
+    columns[c::CID] = pilotObj.value(QStringLiteral("cid")).toVariant().toString();
+    columns[c::REALNAME] = pilotObj.value(QStringLiteral("name")).toString();
+    columns[c::LATITUDE] = pilotObj.value(QStringLiteral("latitude")).toVariant().toString();
+    columns[c::LONGITUDE] = pilotObj.value(QStringLiteral("longitude")).toVariant().toString();
+    columns[c::ALTITUDE] = pilotObj.value(QStringLiteral("altitude")).toVariant().toString();
+    columns[c::GROUNDSPEED] = pilotObj.value(QStringLiteral("groundspeed")).toVariant().toString();
+    columns[c::SERVER] = pilotObj.value(QStringLiteral("server")).toVariant().toString();
+    columns[c::TRANSPONDER] = pilotObj.value(QStringLiteral("transponder")).toVariant().toString();
 
-    columns[c::CALLSIGN] = pilotObj.value(QStringLiteral("callsign")).toString();
-    columns[c::CLIENTTYPE] = QStringLiteral("PILOT");
+    // Insert values from flight plan object
+    assignFlightplan(columns, pilotObj.value(QStringLiteral("flight_plan")).toObject());
 
-    if(format == VATSIM_JSON3)
-    {
-      // "pilots": [
-      // {
-      // "cid": 1474512,
-      // "name": "ANONYM",
-      // "callsign": "ABS9481",
-      // "server": "GERMANY-2",
-      // "pilot_rating": 0,
-      // "latitude": 33.68793,
-      // "longitude": -7.51442,
-      // "altitude": 2501,
-      // "groundspeed": 193,
-      // "transponder": "2000",
-      // "heading": 163,
-      // "qnh_i_hg": 30.13,
-      // "qnh_mb": 1020,
-      //
-      // "flight_plan": {
-      // "flight_rules": "I",
-      // "aircraft": "B77L/H-SDE1E2E3FGHIJ2J3J4J5M1RWXY/LB1D1",
-      // "aircraft_faa": "H/B77L/L",
-      // "aircraft_short": "B77L",
-      // "departure": "OMDB",
-      // "arrival": "SBGR",
-      // "alternate": "SBGL",
-      // "cruise_tas": "492",
-      // "altitude": "32000",
-      // "deptime": "2300",
-      // "enroute_time": "1442",
-      // "fuel_time": "1638",
-      // "remarks": "PBN/A1B1C1D1L1O1S2 DOF/210313 ... /V/",
-      // "route": "NABIX3G NABIX P699 OXARI M430 KIA ... UL327 SIDUR UZ10 ILMIG DCT TBE TBE2B"
-      // },
-      //
-      // "logon_time": "2021-03-13T22:38:09.826199Z",
-      // "last_updated": "2021-03-14T16:07:00.8565953Z"
-      // },
-      columns[c::CID] = pilotObj.value(QStringLiteral("cid")).toVariant().toString();
-      columns[c::REALNAME] = pilotObj.value(QStringLiteral("name")).toString();
-      columns[c::LATITUDE] = pilotObj.value(QStringLiteral("latitude")).toVariant().toString();
-      columns[c::LONGITUDE] = pilotObj.value(QStringLiteral("longitude")).toVariant().toString();
-      columns[c::ALTITUDE] = pilotObj.value(QStringLiteral("altitude")).toVariant().toString();
-      columns[c::GROUNDSPEED] = pilotObj.value(QStringLiteral("groundspeed")).toVariant().toString();
-      columns[c::SERVER] = pilotObj.value(QStringLiteral("server")).toVariant().toString();
-      columns[c::TRANSPONDER] = pilotObj.value(QStringLiteral("transponder")).toVariant().toString();
-
-      // Insert values from flight plan object
-      assignFlightplan(columns, pilotObj.value(QStringLiteral("flight_plan")).toObject());
-
-      // IGNORED planned_depairport_lat
-      // IGNORED planned_depairport_lon
-      // IGNORED planned_destairport_lat
-      // IGNORED planned_destairport_lon
-      // atis_message
-      // time_last_atis_received
-      columns[v::TIME_LOGON] = pilotObj.value(QStringLiteral("logon_time")).toVariant().toString();
-      columns[v::HEADING] = pilotObj.value(QStringLiteral("heading")).toVariant().toString();
-    }
-    else if(format == IVAO_JSON2)
-    {
-      // "pilots": [
-      // {
-      // "time": 483139,
-      // "id": 40494681,
-      // "userId": 396659,
-      // "callsign": "ROT071",
-      // "serverId": "SHARD3",
-      // "softwareTypeId": "altitude",
-      // "softwareVersion": "1.10.4b",
-      // "createdAt": "2021-06-15T06:57:00.000Z",
-      // "flightPlan": {
-      // "revision": 0,
-      // "aircraftId": "SR22",
-      // "aircraftNumber": 1,
-      // "departureId": "TNCS",
-      // "arrivalId": "TFFJ",
-      // "alternativeId": "TNCE",
-      // "alternative2Id": null,
-      // "route": "WEST MODOR SOUTH",
-      // "remarks": "DOF/210615 RMK/WORLDTOUR",
-      // "speed": "K0120",
-      // "level": "VFR",
-      // "flightRules": "V",
-      // "flightType": "G",
-      // "eet": 900,
-      // "endurance": 360,
-      // "departureTime": 25500,
-      // "actualDepartureTime": 25500,
-      // "peopleOnBoard": 1,
-      // "createdAt": "2021-06-15T06:57:00.000Z",
-      // "updatedAt": "2021-06-15T06:57:00.000Z",
-      // "aircraftEquipments": "S",
-      // "aircraftTransponderTypes": "S"
-      // },
-      // "pilotSession": {
-      // "simulatorId": "MS2020"
-      // },
-      // "lastTrack": {
-      // "altitude": 128,
-      // "altitudeDifference": 0,
-      // "arrivalDistance": 26.597875703772427,
-      // "departureDistance": 0.046724870958816,
-      // "groundSpeed": 0,
-      // "heading": 205,
-      // "latitude": 17.644595,
-      // "longitude": -63.220497,
-      // "onGround": true,
-      // "state": "Boarding",
-      // "time": 140,
-      // "timestamp": "2021-06-15T06:59:20.538Z",
-      // "transponder": 2000,
-      // "transponderMode": "S"
-      // }
-
-      columns[c::CID] = pilotObj.value(QStringLiteral("userId")).toVariant().toString();
-
-      QJsonObject lastTrack = pilotObj.value(QStringLiteral("lastTrack")).toObject();
-      columns[c::LATITUDE] = lastTrack.value(QStringLiteral("latitude")).toVariant().toString();
-      columns[c::LONGITUDE] = lastTrack.value(QStringLiteral("longitude")).toVariant().toString();
-      columns[c::ALTITUDE] = lastTrack.value(QStringLiteral("altitude")).toVariant().toString();
-      columns[c::GROUNDSPEED] = lastTrack.value(QStringLiteral("groundSpeed")).toVariant().toString();
-
-      columns[c::SERVER] = pilotObj.value(QStringLiteral("serverId")).toVariant().toString();
-      columns[c::TRANSPONDER] = lastTrack.value(QStringLiteral("transponder")).toVariant().toString();
-
-      // Insert values from flight plan object
-      assignFlightplan(columns, pilotObj.value(QStringLiteral("flightPlan")).toObject());
-
-      columns[i::CONNECTION_TIME] = pilotObj.value(QStringLiteral("createdAt")).toVariant().toString();
-      columns[i::SOFTWARE_NAME] = pilotObj.value(QStringLiteral("softwareTypeId")).toVariant().toString();
-      columns[i::SOFTWARE_VERSION] = pilotObj.value(QStringLiteral("softwareVersion")).toVariant().toString();
-      columns[i::HEADING] = lastTrack.value(QStringLiteral("heading")).toVariant().toString();
-      columns[i::ON_GROUND] = lastTrack.value(QStringLiteral("onGround")).toVariant().toBool() ? QStringLiteral("1") : QStringLiteral("0");
-      columns[i::STATE] = lastTrack.value(QStringLiteral("state")).toVariant().toString();
-      columns[i::SIMULATOR] =
-        pilotObj.value(QStringLiteral("pilotSession")).toObject().value(QStringLiteral("simulatorId")).toVariant().toString();
-    }
+    // IGNORED planned_depairport_lat
+    // IGNORED planned_depairport_lon
+    // IGNORED planned_destairport_lat
+    // IGNORED planned_destairport_lon
+    // atis_message
+    // time_last_atis_received
+    columns[v::TIME_LOGON] = pilotObj.value(QStringLiteral("logon_time")).toVariant().toString();
+    columns[v::HEADING] = pilotObj.value(QStringLiteral("heading")).toVariant().toString();
+  }
+  else if(format == IVAO_JSON2)
+  {
+    // "pilots": [
+    // {
+    // "time": 483139,
+    // "id": 40494681,
+    // "userId": 396659,
+    // "callsign": "ROT071",
+    // "serverId": "SHARD3",
+    // "softwareTypeId": "altitude",
+    // "softwareVersion": "1.10.4b",
+    // "createdAt": "2021-06-15T06:57:00.000Z",
+    // "flightPlan": {
+    // "revision": 0,
+    // "aircraftId": "SR22",
+    // "aircraftNumber": 1,
+    // "departureId": "TNCS",
+    // "arrivalId": "TFFJ",
+    // "alternativeId": "TNCE",
+    // "alternative2Id": null,
+    // "route": "WEST MODOR SOUTH",
+    // "remarks": "DOF/210615 RMK/WORLDTOUR",
+    // "speed": "K0120",
+    // "level": "VFR",
+    // "flightRules": "V",
+    // "flightType": "G",
+    // "eet": 900,
+    // "endurance": 360,
+    // "departureTime": 25500,
+    // "actualDepartureTime": 25500,
+    // "peopleOnBoard": 1,
+    // "createdAt": "2021-06-15T06:57:00.000Z",
+    // "updatedAt": "2021-06-15T06:57:00.000Z",
+    // "aircraftEquipments": "S",
+    // "aircraftTransponderTypes": "S"
+    // },
+    // "pilotSession": {
+    // "simulatorId": "MS2020"
+    // },
+    // "lastTrack": {
+    // "altitude": 128,
+    // "altitudeDifference": 0,
+    // "arrivalDistance": 26.597875703772427,
+    // "departureDistance": 0.046724870958816,
+    // "groundSpeed": 0,
+    // "heading": 205,
+    // "latitude": 17.644595,
+    // "longitude": -63.220497,
+    // "onGround": true,
+    // "state": "Boarding",
+    // "time": 140,
+    // "timestamp": "2021-06-15T06:59:20.538Z",
+    // "transponder": 2000,
+    // "transponderMode": "S"
+    // }
+
+    columns[c::CID] = pilotObj.value(QStringLiteral("userId")).toVariant().toString();
+
+    QJsonObject lastTrack = pilotObj.value(QStringLiteral("lastTrack")).toObject();
+    columns[c::LATITUDE] = lastTrack.value(QStringLiteral("latitude")).toVariant().toString();
+    columns[c::LONGITUDE] = lastTrack.value(QStringLiteral("longitude")).toVariant().toString();
+    columns[c::ALTITUDE] = lastTrack.value(QStringLiteral("altitude")).toVariant().toString();
+    columns[c::GROUNDSPEED] = lastTrack.value(QStringLiteral("groundSpeed")).toVariant().toString();
+
+    columns[c::SERVER] = pilotObj.value(QStringLiteral("serverId")).toVariant().toString();
+    columns[c::TRANSPONDER] = lastTrack.value(QStringLiteral("transponder")).toVariant().toString();
 
-    // Read line with method for delimited format
-    parseSection(columns, false /* isAtc */, false /* isPrefile */, true /* isJson */);
+    // Insert values from flight plan object
+    assignFlightplan(columns, pilotObj.value(QStringLiteral("flightPlan")).toObject());
+
+    columns[i::CONNECTION_TIME] = pilotObj.value(QStringLiteral("createdAt")).toVariant().toString();
+    columns[i::SOFTWARE_NAME] = pilotObj.value(QStringLiteral("softwareTypeId")).toVariant().toString();
+    columns[i::SOFTWARE_VERSION] = pilotObj.value(QStringLiteral("softwareVersion")).toVariant().toString();
+    columns[i::HEADING] = lastTrack.value(QStringLiteral("heading")).toVariant().toString();
+    columns[i::ON_GROUND] = lastTrack.value(QStringLiteral("onGround")).toVariant().toBool() ? QStringLiteral("1") : QStringLiteral("0");
+    columns[i::STATE] = lastTrack.value(QStringLiteral("state")).toVariant().toString();
+    columns[i::SIMULATOR] =
+      pilotObj.value(QStringLiteral("pilotSession")).toObject().value(QStringLiteral("simulatorId")).toVariant().toString();
   }
+
+  // Read line with method for delimited format
+  parseSection(columns, false /* isAtc */, false /* isPrefile */, true /* isJson */);
 }
 
-void WhazzupTextParser::readPrefilesJson(const QJsonObject& obj)
+void WhazzupTextParser::readPrefileJson(const QJsonObject& pilotObj)
 {
   // "prefiles": [
   // {
@@ -737,23 +956,18 @@ void WhazzupTextParser::readPrefilesJson(const QJsonObject& obj)
   // "last_updated": "2021-03-14T13:19:23.9417633Z"
   // },
   // Prefill with empty strings for pilots/clients delimited format
-  const QJsonArray prefilesArr = obj.value(QStringLiteral("prefiles")).toArray();
-  for(const QJsonValue& prefileVal : prefilesArr)
-  {
-    QStringList columns(defaultColumns);
-    QJsonObject pilotObj = prefileVal.toObject();
+  QStringList columns(defaultColumns);
 
-    columns[c::CALLSIGN] = pilotObj.value(QStringLiteral("callsign")).toVariant().toString();
-    columns[c::CID] = pilotObj.value(QStringLiteral("cid")).toVariant().toString();
-    columns[c::REALNAME] = pilotObj.value(QStringLiteral("name")).toVariant().toString();
-    columns[c::CLIENTTYPE] = QStringLiteral("PILOT");
+  columns[c::CALLSIGN] = pilotObj.value(QStringLiteral("callsign")).toVariant().toString();
+  columns[c::CID] = pilotObj.value(QStringLiteral("cid")).toVariant().toString();
+  columns[c::REALNAME] = pilotObj.value(QStringLiteral("name")).toVariant().toString();
+  columns[c::CLIENTTYPE] = QStringLiteral("PILOT");
 
-    // Insert values from flight plan object
-    assignFlightplan(columns, pilotObj.value(QStringLiteral("flight_plan")).toObject());
+  // Insert values from flight plan object
+  assignFlightplan(columns, pilotObj.value(QStringLiteral("flight_plan")).toObject());
 
-    // Prefill with empty strings for pilots/clients delimited format
-    parseSection(columns, false /*ATC*/, true /* prefile */, true /* isJson */);
-  }
+  // Prefill with empty strings for pilots/clients delimited format
+  parseSection(columns, false /*ATC*/, true /* prefile */, true /* isJson */);
 }
 
 void WhazzupTextParser::assignFlightplan(QStringList& columns, const QJsonObject& flightplanObj)
@@ -889,17 +1103,76 @@ void WhazzupTextParser::assignFlightplan(QStringList& columns, const QJsonObject
   }
 }
 
-bool WhazzupTextParser::readInternalDelimited(QTextStream& stream, const QDateTime& lastUpdate)
+/* Line in a delimited file given by byte offsets excluding leading and trailing whitespace */
+struct DelimitedLine
+{
+  qsizetype start, end;
+  QString section;
+};
+
+/* Split line into columns at ':' by scanning the raw UTF-8 bytes once. Multibyte UTF-8 sequences never contain
+ * the separator which allows to convert each field separately without decoding the whole line first. */
+static QStringList splitColumns(const char *data, qsizetype start, qsizetype end)
+{
+  QStringList columns;
+  columns.reserve(48);
+
+  qsizetype pos = start;
+  while(true)
+  {
+    const char *sep = static_cast<const char *>(std::memchr(data + pos, ':', static_cast<size_t>(end - pos)));
+    qsizetype fieldEnd = sep != nullptr ? sep - data : end;
+    columns.append(QString::fromUtf8(data + pos, fieldEnd - pos));
+
+    if(sep == nullptr)
+      break;
+    pos = fieldEnd + 1;
+  }
+  return columns;
+}
+
+bool WhazzupTextParser::readInternalDelimited(const QByteArray& data, const QDateTime& lastUpdate)
 {
+  const char *bytes = data.constData();
+  const qsizetype size = data.size();
+
+  // Read through file once to get all sections and line offsets ===========================
   QSet<QString> sections;
+  QList<DelimitedLine> lines;
+  QList<int> clientLines; // Indexes into lines for client and prefile sections
+  QString section;
 
-  // Read through file to get all sections
-  while(!stream.atEnd())
+  for(qsizetype lineStart = 0; lineStart < size; )
   {
-    QString line = stream.readLine().trimmed();
-    if(line.startsWith(QStringLiteral("!")))
+    const char *newline =
+      static_cast<const char *>(std::memchr(bytes + lineStart, '\n', static_cast<size_t>(size - lineStart)));
+    qsizetype lineEnd = newline != nullptr ? newline - bytes : size;
+    qsizetype nextStart = lineEnd + 1;
+
+    // Trim whitespace including carriage return
+    qsizetype start = lineStart, end = lineEnd;
+    while(start < end && std::isspace(static_cast<unsigned char>(bytes[start])))
+      start++;
+    while(end > start && std::isspace(static_cast<unsigned char>(bytes[end - 1])))
+      end--;
+    lineStart = nextStart;
+
+    // Skip comments and empty lines
+    if(start == end || bytes[start] == ';' || bytes[start] == '#')
+      continue;
+
+    if(bytes[start] == '!')
+    {
       // Remember section
-      sections.insert(line.mid(1).toUpper().trimmed().replace(':', ""));
+      section = QString::fromUtf8(bytes + start + 1, end - start - 1).toUpper().trimmed().replace(':', "");
+      sections.insert(section);
+    }
+    else
+    {
+      if(section == QStringLiteral("CLIENTS") || section == QStringLiteral("PREFILE"))
+        clientLines.append(static_cast<int>(lines.size()));
+      lines.append({start, end, section});
+    }
   }
 
   // Delete tables for available sections and keep others
@@ -916,52 +1189,76 @@ bool WhazzupTextParser::readInternalDelimited(QTextStream& stream, const QDateTi
      sections.contains(QStringLiteral("VOICE SERVERS")))
     db->exec(QStringLiteral("delete from server where voice_type is not null"));
 
-  // Got back and read the whole file
-  stream.seek(0);
-
-  while(!stream.atEnd())
+  // Split client lines into columns in parallel chunks ===========================
+  // Column lists are stored in file order and inserted sequentially below since ids and geometry depend on order
+  int numClients = static_cast<int>(clientLines.size());
+  QList<QStringList> clientColumns(numClients);
+  QStringList *columnsData = clientColumns.data();
+  const DelimitedLine *linesData = lines.constData();
+  const int *clientLinesData = clientLines.constData();
+
+  auto splitRange = [bytes, columnsData, linesData, clientLinesData](int start, int end) -> void {
+                      for(int i = start; i < end; i++)
+                      {
+                        const DelimitedLine& line = linesData[clientLinesData[i]];
+                        columnsData[i] = splitColumns(bytes, line.start, line.end);
+                      }
+                    };
+
+  int numThreads = std::max(1, std::min(QThread::idealThreadCount(), numClients / MIN_CLIENT_LINES_PER_THREAD));
+  if(numThreads > 1)
   {
-    QString line = stream.readLine().trimmed();
+    QThreadPool pool;
+    pool.setMaxThreadCount(numThreads);
+    int chunkSize = (numClients + numThreads - 1) / numThreads;
+    for(int start = 0; start < numClients; start += chunkSize)
+    {
+      int end = std::min(start + chunkSize, numClients);
+      pool.start([&splitRange, start, end]() -> void {
+            splitRange(start, end);
+          });
+    }
+    pool.waitForDone();
+  }
+  else
+    splitRange(0, numClients);
 
-    // Skip comments and empty lines
-    if(line.isEmpty() || line.startsWith(QStringLiteral(";")) || line.startsWith(QStringLiteral("#")))
-      continue;
+  // Parse all lines in file order ===========================
+  int clientIndex = 0;
+  for(const DelimitedLine& line : std::as_const(lines))
+  {
+    curSection = line.section;
 
-    if(line.startsWith(QStringLiteral("!")))
-      // Remember section
-      curSection = line.mid(1).toUpper().trimmed().replace(':', "");
-    else
+    // Parse the section data  (CSV like with : separator
+    if(curSection == QStringLiteral("GENERAL"))
     {
-      // Parse the section data  (CSV like with : separator
-      if(curSection == QStringLiteral("GENERAL"))
-      {
-        QDateTime update = parseGeneralSection(line.split(QStringLiteral("=")));
+      QString general = QString::fromUtf8(bytes + line.start, line.end - line.start);
+      QDateTime update = parseGeneralSection(general.split(QStringLiteral("=")));
 
-        if(update.isValid())
-        {
-          if(update <= lastUpdate)
-            // This is older than the last update - bail out
-            return false;
-
-          update.setTimeZone(QTimeZone::UTC);
-          updateTimestamp = update;
-        }
-      }
-      else if(curSection == QStringLiteral("CLIENTS"))
+      if(update.isValid())
       {
-        QStringList columns = line.split(':');
+        if(update <= lastUpdate)
+          // This is older than the last update - bail out
+          return false;
 
-        // Check client type
-        parseSection(columns, at(columns, 3, error) == QStringLiteral("ATC") /*ATC*/, false /* prefile */, false /* isJson */);
+        update.setTimeZone(QTimeZone::UTC);
+        updateTimestamp = update;
       }
-      else if(curSection == QStringLiteral("PREFILE"))
-        parseSection(line.split(':'), false /*ATC*/, true /* prefile */, false /* isJson */);
-      else if(curSection == QStringLiteral("SERVERS"))
-        parseServersSection(line.split(':'));
-      else if(curSection == QStringLiteral("VOICE") || curSection == QStringLiteral("VOICE_SERVERS") ||
-              curSection == QStringLiteral("VOICE SERVERS") || curSection == QStringLiteral("AIRPORTS"))
-        parseVoiceSection(line.split(':'));
     }
+    else if(curSection == QStringLiteral("CLIENTS"))
+    {
+      const QStringList& columns = clientColumns.at(clientIndex++);
+
+      // Check client type
+      parseSection(columns, at(columns, 3, error) == QStringLiteral("ATC") /*ATC*/, false /* prefile */, false /* isJson */);
+    }
+    else if(curSection == QStringLiteral("PREFILE"))
+      parseSection(clientColumns.at(clientIndex++), false /*ATC*/, true /* prefile */, false /* isJson */);
+    else if(curSection == QStringLiteral("SERVERS"))
+      parseServersSection(splitColumns(bytes, line.start, line.end));
+    else if(curSection == QStringLiteral("VOICE") || curSection == QStringLiteral("VOICE_SERVERS") ||
+            curSection == QStringLiteral("VOICE SERVERS") || curSection == QStringLiteral("AIRPORTS"))
+      parseVoiceSection(splitColumns(bytes, line.start, line.end));
   }
 
   return true;
@@ -1048,21 +1345,22 @@ void WhazzupTextParser::parseSection(const QStringList& line, bool isAtc, bool p
   // .............................................. // 40 QNH_Mb
   // IVAO format .................................. // VATSIM format
 
-  atools::sql::SqlQuery *insertQuery = isAtc ? atcInsertQuery : clientInsertQuery;
+  // Add row to the in-memory snapshot which is exported to the database later if enabled
+  OnlineSnapshotTable *insertTable = isAtc ? &nextSnapshot->atc : &nextSnapshot->clients;
 
-  insertQuery->clearBoundValues();
+  insertTable->clearBoundValues();
 
   const QString callsign = at(line, c::CALLSIGN, error);
-  insertQuery->bindValue(QStringLiteral(":callsign"), callsign);
+  insertTable->bindValue(QStringLiteral(":callsign"), callsign);
 
   const QString vid = at(line, c::CID, error);
-  insertQuery->bindValue(QStringLiteral(":vid"), vid);
-  insertQuery->bindValue(QStringLiteral(":name"), convertName(at(line, c::REALNAME, error), isJson));
+  insertTable->bindValue(QStringLiteral(":vid"), vid);
+  insertTable->bindValue(QStringLiteral(":name"), convertName(at(line, c::REALNAME, error), isJson));
 
   // Get client type so we can check if it goes into a atc or client table
   QString clientType = at(line, c::CLIENTTYPE, error);
   bool atc = clientType == QStringLiteral("ATC");
-  insertQuery->bindValue(QStringLiteral(":client_type"), clientType);
+  insertTable->bindValue(QStringLiteral(":client_type"), clientType);
 
   if(atc)
   {
@@ -1079,7 +1377,7 @@ void WhazzupTextParser::parseSection(const QStringList& line, bool isAtc, bool p
       freqStrToBind.append(freqStr);
     }
     std::sort(freqStrToBind.begin(), freqStrToBind.end());
-    insertQuery->bindValue(QStringLiteral(":frequency"), freqStrToBind.join('&'));
+    insertTable->bindValue(QStringLiteral(":frequency"), freqStrToBind.join('&'));
   }
 
   // Coordinates ====================
@@ -1088,14 +1386,14 @@ void WhazzupTextParser::parseSection(const QStringList& line, bool isAtc, bool p
   if(!at(line, c::LATITUDE, error).isEmpty() && !at(line, c::LONGITUDE, error).isEmpty())
   {
     position = Pos(atFloat(line, c::LONGITUDE, error), atFloat(line, c::LATITUDE, error));
-    insertQuery->bindValue(QStringLiteral(":lonx"), position.getLonX());
-    insertQuery->bindValue(QStringLiteral(":laty"), position.getLatY());
+    insertTable->bindValue(QStringLiteral(":lonx"), position.getLonX());
+    insertTable->bindValue(QStringLiteral(":laty"), position.getLatY());
     hasCoordinates = true;
   }
   else
   {
-    insertQuery->bindNullFloat(QStringLiteral(":laty"));
-    insertQuery->bindNullFloat(QStringLiteral(":lonx"));
+    insertTable->bindNullFloat(QStringLiteral(":laty"));
+    insertTable->bindNullFloat(QStringLiteral(":lonx"));
     hasCoordinates = false;
   }
 
@@ -1105,33 +1403,34 @@ void WhazzupTextParser::parseSection(const QStringList& line, bool isAtc, bool p
     QString alt = at(line, c::ALTITUDE, error).trimmed();
     if(alt.startsWith(QStringLiteral("FL")))
       // Convert flight level FL to altitude
-      insertQuery->bindValue(QStringLiteral(":altitude"), alt.mid(2).toInt() * 100);
+      insertTable->bindValue(QStringLiteral(":altitude"), alt.mid(2).toInt() * 100);
     else if(alt.startsWith(QStringLiteral("F")))
       // Convert flight level with prefix QStringLiteral("F") to altitude
-      insertQuery->bindValue(QStringLiteral(":altitude"), alt.mid(1).toInt() * 100);
+      insertTable->bindValue(QStringLiteral(":altitude"), alt.mid(1).toInt() * 100);
     else
-      insertQuery->bindValue(QStringLiteral(":altitude"), alt.toInt());
-
-    insertQuery->bindValue(QStringLiteral(":groundspeed"), at(line, c::GROUNDSPEED, error));
-    insertQuery->bindValue(QStringLiteral(":flightplan_aircraft"), at(line, c::PLANNED_AIRCRAFT, error));
-    insertQuery->bindValue(QStringLiteral(":flightplan_cruising_speed"), at(line, c::PLANNED_TASCRUISE, error));
-    insertQuery->bindValue(QStringLiteral(":flightplan_departure_aerodrome"), at(line, c::PLANNED_DEPAIRPORT, error));
-    insertQuery->bindValue(QStringLiteral(":flightplan_cruising_level"), at(line, c::PLANNED_ALTITUDE, error));
-    insertQuery->bindValue(QStringLiteral(":flightplan_destination_aerodrome"), at(line, c::PLANNED_DESTAIRPORT, error));
-    insertQuery->bindValue(QStringLiteral(":transponder_code"), at(line, c::TRANSPONDER, error));
+      insertTable->bindValue(QStringLiteral(":altitude"), alt.toInt());
+
+    insertTable->bindValue(QStringLiteral(":groundspeed"), at(line, c::GROUNDSPEED, error));
+    insertTable->bindValue(QStringLiteral(":flightplan_aircraft"), at(line, c::PLANNED_AIRCRAFT, error));
+    insertTable->bindValue(QStringLiteral(":flightplan_cruising_speed"), at(line, c::PLANNED_TASCRUISE, error));
+    insertTable->bindValue(QStringLiteral(":flightplan_departure_aerodrome"), at(line, c::PLANNED_DEPAIRPORT, error));
+    insertTable->bindValue(QStringLiteral(":flightplan_cruising_level"), at(line, c::PLANNED_ALTITUDE, error));
+    insertTable->bindValue(QStringLiteral(":flightplan_destination_aerodrome"), at(line, c::PLANNED_DESTAIRPORT, error));
+    insertTable->bindValue(QStringLiteral(":transponder_code"), at(line, c::TRANSPONDER, error));
   }
 
-  insertQuery->bindValue(QStringLiteral(":server"), at(line, c::SERVER, error));
+  insertTable->bindValue(QStringLiteral(":server"), at(line, c::SERVER, error));
 
   int visualRange = atInt(line, c::VISUALRANGE, error);
 
   atools::fs::online::fac::FacilityType facilityType =
     static_cast<atools::fs::online::fac::FacilityType>(atInt(line, c::FACILITYTYPE, error));
   int circleRadius = 10;
+  bool geometryPending = false;
 
   if(atc)
   {
-    insertQuery->bindValue(QStringLiteral(":facility_type"), QString::number(facilityType));
+    insertTable->bindValue(QStringLiteral(":facility_type"), QString::number(facilityType));
 
     // Convert the facility type to database airspace types ==============
     QString boundaryType, comType;
@@ -1191,33 +1490,33 @@ void WhazzupTextParser::parseSection(const QStringList& line, bool isAtc, bool p
         circleRadius = value.second;
     }
 
-    insertQuery->bindValue(QStringLiteral(":type"), boundaryType);
-    insertQuery->bindValue(QStringLiteral(":com_type"), comType);
-    insertQuery->bindValue(QStringLiteral(":radius"), circleRadius);
-    insertQuery->bindValue(QStringLiteral(":visual_range"), visualRange);
+    insertTable->bindValue(QStringLiteral(":type"), boundaryType);
+    insertTable->bindValue(QStringLiteral(":com_type"), comType);
+    insertTable->bindValue(QStringLiteral(":radius"), circleRadius);
+    insertTable->bindValue(QStringLiteral(":visual_range"), visualRange);
   } // if(atc)
   else
   {
     // Not ATC - client ====================
-    insertQuery->bindValue(QStringLiteral(":flightplan_flight_rules"), at(line, c::PLANNED_FLIGHTTYPE, error));
+    insertTable->bindValue(QStringLiteral(":flightplan_flight_rules"), at(line, c::PLANNED_FLIGHTTYPE, error));
 
     QString departureTime = at(line, c::PLANNED_DEPTIME, error);
     if(!departureTime.isEmpty() && departureTime != QStringLiteral("0"))
-      insertQuery->bindValue(QStringLiteral(":flightplan_departure_time"), departureTime);
+      insertTable->bindValue(QStringLiteral(":flightplan_departure_time"), departureTime);
 
     QString actualDepartureTime = at(line, c::PLANNED_ACTDEPTIME, error);
     if(!actualDepartureTime.isEmpty() && actualDepartureTime != QStringLiteral("0"))
-      insertQuery->bindValue(QStringLiteral(":flightplan_actual_departure_time"), actualDepartureTime);
+      insertTable->bindValue(QStringLiteral(":flightplan_actual_departure_time"), actualDepartureTime);
 
     // Convert two fields to minutes
     int hoursEnroute = atInt(line, c::PLANNED_HRSENROUTE, error);
     int minsEnroute = atInt(line, c::PLANNED_MINENROUTE, error);
-    insertQuery->bindValue(QStringLiteral(":flightplan_enroute_minutes"), hoursEnroute * 60 + minsEnroute);
+    insertTable->bindValue(QStringLiteral(":flightplan_enroute_minutes"), hoursEnroute * 60 + minsEnroute);
 
     // Convert two fields to minutes
     int hoursEndurance = atInt(line, c::PLANNED_HRSFUEL, error);
     int minsEndurance = atInt(line, c::PLANNED_MINFUEL, error);
-    insertQuery->bindValue(QStringLiteral(":flightplan_endurance_minutes"), hoursEndurance * 60 + minsEndurance);
+    insertTable->bindValue(QStringLiteral(":flightplan_endurance_minutes"), hoursEndurance * 60 + minsEndurance);
 
     // Calculate estimated arrival time ================================
     QTime eta;
@@ -1235,56 +1534,56 @@ void WhazzupTextParser::parseSection(const QStringList& line, bool isAtc, bool p
           static_cast<int>(depTime.msecsSinceStartOfDay() + enrouteMin * 60. * 1000.));
 
       if(eta.isValid())
-        insertQuery->bindValue(QStringLiteral(":flightplan_estimated_arrival_time"), eta.toString(QStringLiteral("HHmm")));
+        insertTable->bindValue(QStringLiteral(":flightplan_estimated_arrival_time"), eta.toString(QStringLiteral("HHmm")));
     }
 
-    insertQuery->bindValue(QStringLiteral(":flightplan_alternate_aerodrome"), at(line, c::PLANNED_ALTAIRPORT, error));
-    insertQuery->bindValue(QStringLiteral(":flightplan_other_info"), at(line, c::PLANNED_REMARKS, error));
-    insertQuery->bindValue(QStringLiteral(":flightplan_route"), at(line, c::PLANNED_ROUTE, error));
+    insertTable->bindValue(QStringLiteral(":flightplan_alternate_aerodrome"), at(line, c::PLANNED_ALTAIRPORT, error));
+    insertTable->bindValue(QStringLiteral(":flightplan_other_info"), at(line, c::PLANNED_REMARKS, error));
+    insertTable->bindValue(QStringLiteral(":flightplan_route"), at(line, c::PLANNED_ROUTE, error));
   } // else if(atc)
 
   if(format == IVAO || format == IVAO_JSON2)
   {
-    insertQuery->bindValue(QStringLiteral(":connection_time"),
+    insertTable->bindValue(QStringLiteral(":connection_time"),
                            parseDateTime(line, i::CONNECTION_TIME, format == IVAO_JSON2 /* jsonFormat */));
 
     if(atc)
     {
-      insertQuery->bindValue(QStringLiteral(":atis"), convertAtisText(at(line, i::ATIS, error)));
-      insertQuery->bindValue(QStringLiteral(":atis_time"), parseDateTime(line, i::ATIS_TIME, format == IVAO_JSON2 /* jsonFormat */));
+      insertTable->bindValue(QStringLiteral(":atis"), convertAtisText(at(line, i::ATIS, error)));
+      insertTable->bindValue(QStringLiteral(":atis_time"), parseDateTime(line, i::ATIS_TIME, format == IVAO_JSON2 /* jsonFormat */));
     }
     else
     {
-      insertQuery->bindValue(QStringLiteral(":flightplan_2nd_alternate_aerodrome"), at(line, i::FLIGHTPLAN_2ND_ALTERNATE_AERODROME, error));
-      insertQuery->bindValue(QStringLiteral(":flightplan_type_of_flight"), at(line, i::FLIGHTPLAN_TYPE_OF_FLIGHT, error));
-      insertQuery->bindValue(QStringLiteral(":flightplan_persons_on_board"), atInt(line, i::FLIGHTPLAN_PERSONS_ON_BOARD, error));
-      insertQuery->bindValue(QStringLiteral(":heading"), atInt(line, i::HEADING, error));
-      insertQuery->bindValue(QStringLiteral(":on_ground"), atInt(line, i::ON_GROUND, error));
-      insertQuery->bindValue(QStringLiteral(":simulator"), at(line, i::SIMULATOR, error));
+      insertTable->bindValue(QStringLiteral(":flightplan_2nd_alternate_aerodrome"), at(line, i::FLIGHTPLAN_2ND_ALTERNATE_AERODROME, error));
+      insertTable->bindValue(QStringLiteral(":flightplan_type_of_flight"), at(line, i::FLIGHTPLAN_TYPE_OF_FLIGHT, error));
+      insertTable->bindValue(QStringLiteral(":flightplan_persons_on_board"), atInt(line, i::FLIGHTPLAN_PERSONS_ON_BOARD, error));
+      insertTable->bindValue(QStringLiteral(":heading"), atInt(line, i::HEADING, error));
+      insertTable->bindValue(QStringLiteral(":on_ground"), atInt(line, i::ON_GROUND, error));
+      insertTable->bindValue(QStringLiteral(":simulator"), at(line, i::SIMULATOR, error));
 
       if(format == IVAO_JSON2)
-        insertQuery->bindValue(QStringLiteral(":state"), at(line, i::STATE, error));
+        insertTable->bindValue(QStringLiteral(":state"), at(line, i::STATE, error));
     }
   }
   else if(format == VATSIM || format == VATSIM_JSON3)
   {
-    insertQuery->bindValue(QStringLiteral(":connection_time"), parseDateTime(line, v::TIME_LOGON, format == VATSIM_JSON3 /* jsonFormat */));
+    insertTable->bindValue(QStringLiteral(":connection_time"), parseDateTime(line, v::TIME_LOGON, format == VATSIM_JSON3 /* jsonFormat */));
 
     if(atc)
     {
-      insertQuery->bindValue(QStringLiteral(":atis"), convertAtisText(at(line, v::ATIS_MESSAGE, error)));
-      insertQuery->bindValue(QStringLiteral(":atis_time"),
+      insertTable->bindValue(QStringLiteral(":atis"), convertAtisText(at(line, v::ATIS_MESSAGE, error)));
+      insertTable->bindValue(QStringLiteral(":atis_time"),
                              parseDateTime(line, v::TIME_LAST_ATIS_RECEIVED, format == VATSIM_JSON3 /* jsonFormat */));
     }
     else
     {
       // On ground flag not available - determine roughly by ground speed ===============
-      insertQuery->bindValue(QStringLiteral(":heading"), atInt(line, v::HEADING, error));
+      insertTable->bindValue(QStringLiteral(":heading"), atInt(line, v::HEADING, error));
       // Use on ground if speed below 30 knots
       bool ok = false;
       float gs = at(line, c::GROUNDSPEED, error).toFloat(&ok);
-      insertQuery->bindValue(QStringLiteral(":on_ground"), (ok && gs < 30.f) || prefile); // Either slow or prefile
-      insertQuery->bindValue(QStringLiteral(":state"), prefile ? QStringLiteral("Prefile") : QStringLiteral());
+      insertTable->bindValue(QStringLiteral(":on_ground"), (ok && gs < 30.f) || prefile); // Either slow or prefile
+      insertTable->bindValue(QStringLiteral(":state"), prefile ? QStringLiteral("Prefile") : QStringLiteral());
     }
   }
 
@@ -1293,44 +1592,40 @@ void WhazzupTextParser::parseSection(const QStringList& line, bool isAtc, bool p
     if(hasCoordinates)
     {
       // Geometry for centers =============================================================================
-      LineString lineString;
-      if(geometryCallback)
-      {
-        // Try to get from callback (i.e. user airspace database)
-        const LineString *ls = geometryCallback(callsign, facilityType);
-        if(ls != nullptr && ls->isValidPolygon())
-          // Copy cache object if valid
-          lineString = *ls;
-      }
+      // Reuse geometry from last file if center did not change
+      QString geometryKey = callsign % '|' % QString::number(facilityType) % '|' % QString::number(circleRadius) %
+                            '|' % QString::number(position.getLonX()) % '|' % QString::number(position.getLatY());
 
-      if(lineString.isEmpty())
+      auto it = atcGeometryCache.constFind(geometryKey);
+      if(it != atcGeometryCache.constEnd())
       {
-        // Nothing found or no callback - create a circle shape
-        // Create a circular polygon with 10 degree segments
-
-        // at least 1/10 nm radius
-        lineString = LineString(position, atools::geo::nmToMeter(std::min(1000.f, std::max(1.f, static_cast<float>(circleRadius)))), 36);
+        bindAtcGeometry(insertTable, it.value());
+        nextAtcGeometryCache.insert(geometryKey, it.value());
       }
+      else
+      {
+        // Generate geometry after reading all centers
+        AtcGeometryJob job;
+        job.key = geometryKey;
+        job.position = position;
+        job.radiusNm = static_cast<float>(circleRadius);
 
-      // Add bounding rectangle
-      Rect bounding = lineString.boundingRect();
-      insertQuery->bindValue(QStringLiteral(":max_lonx"), bounding.getEast());
-      insertQuery->bindValue(QStringLiteral(":max_laty"), bounding.getNorth());
-      insertQuery->bindValue(QStringLiteral(":min_lonx"), bounding.getWest());
-      insertQuery->bindValue(QStringLiteral(":min_laty"), bounding.getSouth());
+        if(geometryCallback)
+        {
+          // Try to get from callback (i.e. user airspace database)
+          const LineString *ls = geometryCallback(callsign, facilityType);
+          if(ls != nullptr && ls->isValidPolygon())
+            // Copy cache object if valid
+            job.lineString = *ls;
+        }
+        atcGeometryJobs.append(job);
+        geometryPending = true;
 
-      // Store geometry in same format as boundaries
-      insertQuery->bindValue(QStringLiteral(":geometry"),
-                             atools::fs::common::BinaryGeometry(atools::fs::util::correctBoundary(lineString)).writeToByteArray());
+        bindAtcGeometry(insertTable, AtcGeometry());
+      }
     }
     else
-    {
-      insertQuery->bindNullFloat(QStringLiteral(":max_lonx"));
-      insertQuery->bindNullFloat(QStringLiteral(":max_laty"));
-      insertQuery->bindNullFloat(QStringLiteral(":min_lonx"));
-      insertQuery->bindNullFloat(QStringLiteral(":min_laty"));
-      insertQuery->bindNullBytes(QStringLiteral(":geometry"));
-    }
+      bindAtcGeometry(insertTable, AtcGeometry());
   }
 
   // =============================================================================
@@ -1343,9 +1638,111 @@ void WhazzupTextParser::parseSection(const QStringList& line, bool isAtc, bool p
   int id = semiPermanentId(isAtc ? atcIdMap : clientIdMap, isAtc ? curAtcId : curClientId, hashKey.join(QStringLiteral("|")));
 
   // qDebug() << hashKey << id;
-  insertQuery->bindValue(isAtc ? QStringLiteral(":atc_id") : QStringLiteral(":client_id"), id);
+  insertTable->bindValue(isAtc ? QStringLiteral(":atc_id") : QStringLiteral(":client_id"), id);
 
-  insertQuery->exec();
+  if(geometryPending)
+    atcGeometryJobs.last().id = id;
+
+  insertTable->exec();
+}
+
+void WhazzupTextParser::bindAtcGeometry(OnlineSnapshotTable *table, const AtcGeometry& geometry)
+{
+  if(geometry.bounding.isValid())
+  {
+    // Add bounding rectangle
+    table->bindValue(QStringLiteral(":max_lonx"), geometry.bounding.getEast());
+    table->bindValue(QStringLiteral(":max_laty"), geometry.bounding.getNorth());
+    table->bindValue(QStringLiteral(":min_lonx"), geometry.bounding.getWest());
+    table->bindValue(QStringLiteral(":min_laty"), geometry.bounding.getSouth());
+    table->bindValue(QStringLiteral(":geometry"), geometry.geometry);
+  }
+  else
+  {
+    table->bindNullFloat(QStringLiteral(":max_lonx"));
+    table->bindNullFloat(QStringLiteral(":max_laty"));
+    table->bindNullFloat(QStringLiteral(":min_lonx"));
+    table->bindNullFloat(QStringLiteral(":min_laty"));
+    table->bindNullBytes(QStringLiteral(":geometry"));
+  }
+}
+
+void WhazzupTextParser::createAtcGeometries()
+{
+  int num = static_cast<int>(atcGeometryJobs.size());
+  AtcGeometryJob *jobs = atcGeometryJobs.data();
+
+  auto createRange = [jobs](int start, int end) -> void {
+                       for(int i = start; i < end; i++)
+                       {
+                         AtcGeometryJob& job = jobs[i];
+                         if(job.lineString.isEmpty())
+                           // Nothing found or no callback - create a circular polygon with 10 degree segments
+                           // at least 1 nm radius
+                           job.lineString = LineString(job.position,
+                                                       atools::geo::nmToMeter(std::min(1000.f, std::max(1.f, job.radiusNm))),
+                                                       36);
+
+                         job.geometry.bounding = job.lineString.boundingRect();
+
+                         // Store geometry in same format as boundaries
+                         job.geometry.geometry =
+                           atools::fs::common::BinaryGeometry(atools::fs::util::correctBoundary(job.lineString)).writeToByteArray();
+                       }
+                     };
+
+  int numThreads = std::max(1, std::min(QThread::idealThreadCount(), num / MIN_ATC_GEOMETRIES_PER_THREAD));
+  if(numThreads > 1)
+  {
+    QThreadPool pool;
+    pool.setMaxThreadCount(numThreads);
+    int chunkSize = (num + numThreads - 1) / numThreads;
+    for(int start = 0; start < num; start += chunkSize)
+    {
+      int end = std::min(start + chunkSize, num);
+      pool.start([&createRange, start, end]() -> void {
+            createRange(start, end);
+          });
+    }
+    pool.waitForDone();
+  }
+  else
+    createRange(0, num);
+
+  // Fill generated geometry into snapshot rows =====================
+  OnlineSnapshotTable& atc = nextSnapshot->atc;
+  int maxLonXCol = atc.columnIndex(QStringLiteral("max_lonx")), maxLatYCol = atc.columnIndex(QStringLiteral("max_laty"));
+  int minLonXCol = atc.columnIndex(QStringLiteral("min_lonx")), minLatYCol = atc.columnIndex(QStringLiteral("min_laty"));
+  int geometryCol = atc.columnIndex(QStringLiteral("geometry"));
+
+  for(const AtcGeometryJob& job : std::as_const(atcGeometryJobs))
+  {
+    int row = atc.rowById(job.id);
+    if(row != -1)
+    {
+      atc.setValue(row, maxLonXCol, job.geometry.bounding.getEast());
+      atc.setValue(row, maxLatYCol, job.geometry.bounding.getNorth());
+      atc.setValue(row, minLonXCol, job.geometry.bounding.getWest());
+      atc.setValue(row, minLatYCol, job.geometry.bounding.getSouth());
+      atc.setValue(row, geometryCol, job.geometry.geometry);
+    }
+    nextAtcGeometryCache.insert(job.key, job.geometry);
+  }
+
+  if(error && num > 0)
+    qDebug() << Q_FUNC_INFO << "generated" << num << "cached" << nextAtcGeometryCache.size() - num;
+
+  // Keep only geometry used in this file
+  atcGeometryCache.swap(nextAtcGeometryCache);
+  nextAtcGeometryCache.clear();
+  atcGeometryJobs.clear();
+}
+
+void WhazzupTextParser::clearAtcGeometryCache()
+{
+  atcGeometryCache.clear();
+  nextAtcGeometryCache.clear();
+  atcGeometryJobs.clear();
 }
 
 int WhazzupTextParser::semiPermanentId(QHash<QString, int>& idMap, int& curId, const QString& key)
@@ -1438,6 +1835,10 @@ void WhazzupTextParser::initQueries()
 
   serverInsertQuery = new SqlQuery(db);
   serverInsertQuery->prepare(util.buildInsertStatement(QStringLiteral("server"), QStringLiteral(), {QStringLiteral("server_id")}));
+
+  // Snapshot uses the same columns as the tables
+  snapshot->init(db);
+  nextSnapshot->init(db);
 }
 
 void WhazzupTextParser::deInitQueries()
@@ -1457,6 +1858,7 @@ void WhazzupTextParser::resetForNewOptions()
   // Clear the id maps but do not reset the current ids to avoid overlaps
   atcIdMap.clear();
   clientIdMap.clear();
+  clearAtcGeometryCache();
   reset();
 }
 
@@ -18,15 +18,20 @@
 #ifndef ATOOLS_FS_WHAZZUPTEXTPARSER_H
 #define ATOOLS_FS_WHAZZUPTEXTPARSER_H
 
+#include "geo/linestring.h"
 #include "geo/pos.h"
+#include "geo/rect.h"
+#include "fs/online/onlinesnapshot.h"
 #include "fs/online/onlinetypes.h"
 
 #include <QDateTime>
 #include <QString>
 
-class QTextStream;
-
 namespace atools {
+namespace util {
+class JsonStreamReader;
+}
+
 namespace sql {
 class SqlDatabase;
 class SqlQuery;
@@ -36,8 +41,9 @@ namespace fs {
 namespace online {
 
 /*
- * Reads a "whazzup.txt" file and stores all found data in the database.
- * Schema has to be created before.
+ * Reads a "whazzup.txt" file and stores all found clients and ATC in an in-memory snapshot.
+ * The snapshot is exported into the database tables "client" and "atc" if SQL export is enabled which is the default.
+ * Servers are always written into the database. Schema has to be created before.
  *
  * Supported formats are the ones used by VATSIM and IVAO.
  *
@@ -52,15 +58,22 @@ public:
   WhazzupTextParser(const WhazzupTextParser& other) = delete;
   WhazzupTextParser& operator=(const WhazzupTextParser& other) = delete;
 
-  /* Read file content given in string and store results in database. Commit is executed when done.
+  /* Read file content given in string and store results in snapshot and database.
    * Reads either "whazzup.txt" format or VATSIM JSON format depending on "streamFormat".
-   * Returns true if the file was read and is more recent than lastUpdate. */
+   * Returns true if the file was read without errors and is more recent than lastUpdate.
+   * Call within a transaction which has to be rolled back if false is returned. The current snapshot is kept then. */
   bool read(QString file, atools::fs::online::Format streamFormat, const QDateTime& lastUpdate);
 
-  /* Read VATSIM transceivers-data.json and stores map in this object. Call before calling "read". */
-  void readTransceivers(const QString& file);
+  /* As above but for the raw downloaded UTF-8 bytes. JSON formats are parsed as a stream without
+   * building a document or converting to a string which saves memory and time for large files. */
+  bool read(const QByteArray& data, atools::fs::online::Format streamFormat, const QDateTime& lastUpdate);
 
-  /* Create all queries */
+  /* Read VATSIM transceivers-data.json and stores map in this object. Call before calling "read".
+   * Returns false and keeps the previously read transceivers if the data is malformed or truncated. */
+  bool readTransceivers(const QString& file);
+  bool readTransceivers(const QByteArray& data);
+
+  /* Create all queries and initialize the snapshot from the database schema */
   void initQueries();
 
   /* Delete all queries */
@@ -81,19 +94,52 @@ public:
   void reset();
   void resetForNewOptions();
 
+  /* Clients and ATC from the last successfully read file */
+  const atools::fs::online::OnlineSnapshot& getSnapshot() const
+  {
+    return *snapshot;
+  }
+
+  /* Added, removed, moved and changed clients and ATC between the last two successfully read files.
+   * All rows are reported as added after the first read or after clearSnapshot(). */
+  const atools::fs::online::OnlineSnapshotDiff& getSnapshotDiff() const
+  {
+    return snapshotDiff;
+  }
+
+  /* Remove all rows from the snapshot */
+  void clearSnapshot();
+
+  /* Write client and ATC rows into the database tables after reading. Enabled by default. */
+  void setSqlExport(bool value)
+  {
+    sqlExport = value;
+  }
+
+  bool isSqlExport() const
+  {
+    return sqlExport;
+  }
+
   /* Set default circle radii for certain ATC types where visual range is unusable */
   void setAtcSize(const AtcSizeMap& sizeMap)
   {
     atcSizeMap = sizeMap;
+    clearAtcGeometryCache();
   }
 
   /* Set a callback that tries to fetch geometry from the user airspace database.
-   * Default circle will be used if this returns an empty byte array. */
+   * Default circle will be used if this returns an empty byte array.
+   * Called only for centers which are new or changed position, facility or radius. */
   void setGeometryCallback(GeoCallbackType func)
   {
     geometryCallback = func;
+    clearAtcGeometryCache();
   }
 
+  /* Drop all cached ATC geometry. Needed if the source for the geometry callback changes. */
+  void clearAtcGeometryCache();
+
 private:
   /* Read time from general section */
   QDateTime parseGeneralSection(const QStringList& line);
@@ -117,17 +163,67 @@ private:
   QString convertName(QString name, bool utf8);
   int semiPermanentId(QHash<QString, int>& idMap, int& curId, const QString& key);
 
-  /* Read VATSIM JSON format and create a column list based on the whazzup.txt lists.
-   * This is read by the delimited methods. */
-  bool readInternalJson(const QString& file, const QDateTime& lastUpdate);
-  bool readInternalDelimited(QTextStream& stream, const QDateTime& lastUpdate);
-  void readPilotsJson(const QJsonArray& pilotsArr);
-  void readControllersJson(const QJsonArray& controllersArr, bool observer);
-  void readServersJson(const QJsonArray& serversArr, bool voice);
-  void readPrefilesJson(const QJsonObject& obj);
+  /* Reset state before reading and swap snapshot after reading. */
+  void startRead(atools::fs::online::Format streamFormat);
+  bool finishRead(bool retval);
+
+  /* Read VATSIM or IVAO JSON format from a stream and create a column list based on the whazzup.txt lists.
+   * This is read by the delimited methods. Only one object of the arrays is in memory at a time.
+   * Returns false on syntax errors after rows were changed. The caller has to roll back the transaction then. */
+  bool readInternalJson(const QByteArray& data, const QDateTime& lastUpdate);
+
+  /* Read version, reload time and update time before any table is changed. Returns false if the data is older
+   * than lastUpdate or has syntax errors. */
+  bool readUpdateJson(const QByteArray& data, const QDateTime& lastUpdate);
+
+  /* Read legacy colon separated format. Client lines are split into columns in parallel and inserted in file order. */
+  bool readInternalDelimited(const QByteArray& data, const QDateTime& lastUpdate);
+
+  /* Set update timestamp. Returns false if update is not more recent than lastUpdate. */
+  bool checkUpdate(QDateTime update, const QDateTime& lastUpdate);
+
+  /* Read arrays at current position of the reader */
+  void readClientsJson(atools::util::JsonStreamReader& reader, bool atc, bool observer);
+  void readServersJson(atools::util::JsonStreamReader& reader, bool voice);
+  void readPrefilesJson(atools::util::JsonStreamReader& reader);
+
+  /* Read single objects from arrays */
+  void readPilotJson(const QJsonObject& pilotObj);
+  void readControllerJson(const QJsonObject& atcObj, bool observer);
+  void readServerJson(const QJsonObject& serverObj, bool voice);
+  void readPrefileJson(const QJsonObject& pilotObj);
 
   void readAtisJson(const QJsonObject& obj);
 
+  /* Insert all snapshot rows into the database tables */
+  void exportSnapshot();
+
+  /* Generated geometry and bounding rectangle for an ATC center */
+  struct AtcGeometry
+  {
+    QByteArray geometry;
+    atools::geo::Rect bounding;
+  };
+
+  /* ATC center waiting for geometry generation after reading */
+  struct AtcGeometryJob
+  {
+    int id = -1;
+    QString key;
+
+    /* From callback or empty if a circle has to be created */
+    atools::geo::LineString lineString;
+    atools::geo::Pos position;
+    float radiusNm = 0.f;
+    AtcGeometry geometry;
+  };
+
+  /* Bind geometry or null values if invalid */
+  void bindAtcGeometry(atools::fs::online::OnlineSnapshotTable *table, const AtcGeometry& geometry);
+
+  /* Create circles and binary geometry for all jobs in parallel and fill into the snapshot rows */
+  void createAtcGeometries();
+
   /* Insert flight plan values into columns. Used for clients and prefile */
   void assignFlightplan(QStringList& columns, const QJsonObject& flightplanObj);
 
@@ -146,6 +242,16 @@ private:
   atools::sql::SqlDatabase *db;
   atools::sql::SqlQuery *clientInsertQuery = nullptr, *atcInsertQuery = nullptr, *serverInsertQuery = nullptr;
 
+  /* Snapshot of last file and the one filled while reading. Swapped if reading was successful. */
+  atools::fs::online::OnlineSnapshot *snapshot = nullptr, *nextSnapshot = nullptr;
+  atools::fs::online::OnlineSnapshotDiff snapshotDiff;
+
+  /* ATC geometry by callsign, facility, radius and position from the last file and the one filled while reading.
+   * Only geometry used in the last file is kept. */
+  QHash<QString, AtcGeometry> atcGeometryCache, nextAtcGeometryCache;
+  QList<AtcGeometryJob> atcGeometryJobs;
+  bool sqlExport = true;
+
   // Assign row ids manually
   int curClientId = 1, curAtcId = 1;
 
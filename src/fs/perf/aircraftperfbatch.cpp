@@ -0,0 +1,125 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/perf/aircraftperfbatch.h"
+
+#include "fs/perf/aircraftperf.h"
+#include "geo/calculations.h"
+#include "grib/windquery.h"
+
+namespace atools {
+namespace fs {
+namespace perf {
+
+namespace ageo = atools::geo;
+
+AircraftPerfBatch::AircraftPerfBatch(const AircraftPerf& aircraftPerf)
+  : perf(aircraftPerf)
+{
+}
+
+AircraftPerfTable AircraftPerfBatch::calculate(const AircraftPerfRoute& route, const QList<float>& cruiseAltitudesFt) const
+{
+  const int numAlt = static_cast<int>(cruiseAltitudesFt.size());
+  const int numLegs = std::max(0, static_cast<int>(route.route.size()) - 1);
+
+  AircraftPerfTable table;
+  table.altitudesFt = cruiseAltitudesFt;
+  table.valid.fill(false, numAlt);
+  table.climbDistNm.fill(0.f, numAlt);
+  table.descentDistNm.fill(0.f, numAlt);
+  table.climbTimeHours.fill(0.f, numAlt);
+  table.cruiseTimeHours.fill(0.f, numAlt);
+  table.descentTimeHours.fill(0.f, numAlt);
+  table.timeHours.fill(0.f, numAlt);
+  table.tripFuel.fill(0.f, numAlt);
+  table.blockFuel.fill(0.f, numAlt);
+
+  if(numAlt == 0 || numLegs == 0)
+    return table;
+
+  // Leg geometry once for all altitudes ==========================================
+  QList<float> legStartNm(numLegs + 1, 0.f), courseDeg(numLegs, 0.f);
+  for(int i = 0; i < numLegs; i++)
+  {
+    const ageo::Pos& pos1 = route.route.at(i), &pos2 = route.route.at(i + 1);
+    legStartNm[i + 1] = legStartNm.at(i) + ageo::meterToNm(pos1.distanceMeterTo(pos2));
+    courseDeg[i] = pos1.angleDegTo(pos2);
+  }
+  const float totalNm = legStartNm.at(numLegs);
+
+  // Head winds with legs in rows and altitudes in columns ==========================================
+  QList<float> headWinds(numLegs * numAlt, 0.f);
+  if(windQuery != nullptr && windQuery->hasWindData())
+  {
+    QList<atools::grib::Wind> winds;
+    for(int k = 0; k < numAlt; k++)
+    {
+      winds.clear();
+      windQuery->getWindAverageForLineStringLegs(winds, route.route.alt(cruiseAltitudesFt.at(k)));
+      for(int i = 0; i < numLegs && i < winds.size(); i++)
+        headWinds[i * numAlt + k] = ageo::headWindForCourse(winds.at(i).speed, winds.at(i).dir, courseDeg.at(i));
+    }
+  }
+
+  // Climb and descent for each altitude ==========================================
+  const bool perfValid = perf.isClimbValid() && perf.isDescentValid() && perf.isSpeedValid();
+  const float *firstLegWinds = headWinds.constData(), *lastLegWinds = headWinds.constData() + (numLegs - 1) * numAlt;
+  for(int k = 0; k < numAlt; k++)
+  {
+    float altFt = cruiseAltitudesFt.at(k);
+    table.climbTimeHours[k] = std::max(0.f, perf.getTimeToClimb(route.departureAltFt, altFt));
+    table.descentTimeHours[k] = std::max(0.f, perf.getTimeToDescent(route.destinationAltFt, altFt));
+    table.climbDistNm[k] = table.climbTimeHours.at(k) * (perf.getClimbSpeed() - firstLegWinds[k] / 2.f);
+    table.descentDistNm[k] = table.descentTimeHours.at(k) * (perf.getDescentSpeed() - lastLegWinds[k] / 2.f);
+    table.valid[k] = perfValid && table.climbDistNm.at(k) + table.descentDistNm.at(k) <= totalNm;
+  }
+
+  // Cruise time with altitudes in the inner loop ==========================================
+  const float cruiseSpeed = perf.getCruiseSpeed();
+  const float *climbDist = table.climbDistNm.constData(), *descentDist = table.descentDistNm.constData();
+  float *cruiseTime = table.cruiseTimeHours.data();
+  for(int i = 0; i < numLegs; i++)
+  {
+    const float legStart = legStartNm.at(i), legEnd = legStartNm.at(i + 1);
+    const float *legWinds = headWinds.constData() + i * numAlt;
+    for(int k = 0; k < numAlt; k++)
+    {
+      // Part of this leg between top of climb and top of descent
+      float cruiseNm = std::max(0.f, std::min(legEnd, totalNm - descentDist[k]) - std::max(legStart, climbDist[k]));
+      cruiseTime[k] += cruiseNm / std::max(cruiseSpeed - legWinds[k], 1.f);
+    }
+  }
+
+  // Sum up fuel ==========================================
+  const float fixedFuel = perf.getTaxiFuel() + perf.getReserveFuel() + perf.getExtraFuel();
+  const float contingencyFactor = perf.getContingencyFuelFactor();
+  for(int k = 0; k < numAlt; k++)
+  {
+    table.timeHours[k] = table.climbTimeHours.at(k) + table.cruiseTimeHours.at(k) + table.descentTimeHours.at(k);
+    table.tripFuel[k] = table.climbTimeHours.at(k) * perf.getClimbFuelFlow() +
+                        table.cruiseTimeHours.at(k) * perf.getCruiseFuelFlow() +
+                        table.descentTimeHours.at(k) * perf.getDescentFuelFlow();
+    table.blockFuel[k] = table.tripFuel.at(k) * contingencyFactor + fixedFuel;
+  }
+
+  return table;
+}
+
+} // namespace perf
+} // namespace fs
+} // namespace atools
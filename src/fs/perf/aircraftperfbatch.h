@@ -0,0 +1,90 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_PERF_AIRCRAFTPERFBATCH_H
+#define ATOOLS_FS_PERF_AIRCRAFTPERFBATCH_H
+
+#include "geo/linestring.h"
+
+#include <QList>
+
+namespace atools {
+namespace grib {
+class WindQuery;
+}
+namespace fs {
+namespace perf {
+
+class AircraftPerf;
+
+/* Route used for batch performance calculation */
+struct AircraftPerfRoute
+{
+  atools::geo::LineString route; /* Departure, waypoints and destination. Altitude is ignored. */
+  float departureAltFt = 0.f, destinationAltFt = 0.f;
+};
+
+/* Fuel and time table for a list of cruise altitudes. All lists have the same size and order as the altitudes.
+ * Fuel is in lbs or gallons as given by AircraftPerf::useFuelAsVolume(). */
+struct AircraftPerfTable
+{
+  QList<float> altitudesFt;
+  QList<bool> valid; /* false if altitude cannot be reached on the route */
+  QList<float> climbDistNm, descentDistNm;
+  QList<float> climbTimeHours, cruiseTimeHours, descentTimeHours, timeHours;
+  QList<float> tripFuel; /* Fuel for climb, cruise and descent */
+  QList<float> blockFuel; /* Trip fuel with contingency plus taxi, reserve and extra fuel */
+
+  int size() const
+  {
+    return static_cast<int>(altitudesFt.size());
+  }
+};
+
+/*
+ * Evaluates trip fuel and time for many cruise altitudes on the same route in one pass.
+ *
+ * Leg geometry is calculated once. Winds are fetched once per altitude for all legs if a wind query is set.
+ * The calculation then runs over flat arrays with the altitudes in the inner loop.
+ *
+ * Climb and descent use half of the head wind at cruise altitude on the first and last leg since
+ * wind is interpolated down to zero at the ground.
+ */
+class AircraftPerfBatch
+{
+public:
+  explicit AircraftPerfBatch(const AircraftPerf& aircraftPerf);
+
+  /* Use winds from the query if not null and wind data is available. Not owned. */
+  void setWindQuery(const atools::grib::WindQuery *value)
+  {
+    windQuery = value;
+  }
+
+  /* Calculate fuel and time for all cruise altitudes */
+  AircraftPerfTable calculate(const AircraftPerfRoute& route, const QList<float>& cruiseAltitudesFt) const;
+
+private:
+  const AircraftPerf& perf;
+  const atools::grib::WindQuery *windQuery = nullptr;
+};
+
+} // namespace perf
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_PERF_AIRCRAFTPERFBATCH_H
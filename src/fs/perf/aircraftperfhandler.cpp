@@ -34,8 +34,11 @@ using atools::fs::sc::SimConnectData;
 using atools::roundToInt;
 using atools::fs::perf::AircraftPerf;
 
+/* About two minutes at 60 samples per second before samples are dropped */
+static const int SAMPLE_BUFFER_SIZE = 8192;
+
 AircraftPerfHandler::AircraftPerfHandler(QObject *parent)
-  : QObject(parent)
+  : QObject(parent), samples(SAMPLE_BUFFER_SIZE)
 {
   perf = new AircraftPerf;
 
@@ -63,6 +66,11 @@ void AircraftPerfHandler::start()
 
   perf->setNull();
 
+  // Drop samples of previous collection
+  samples.clear();
+  droppedSamples = 0;
+  curSample = Sample();
+
   active = true;
   *curSimAircraft = SimConnectUserAircraft();
 }
@@ -92,31 +100,70 @@ void AircraftPerfHandler::saveCollected(const QString& filename) const
 void AircraftPerfHandler::simDataChanged(const sc::SimConnectData& simulatorData, const QString& simulator)
 {
   *curSimAircraft = simulatorData.getUserAircraftConst();
-  if(!active || !curSimAircraft->isFullyValid() || curSimAircraft->isSimPaused() || curSimAircraft->isSimReplay())
+
+  if(active && curSimAircraft->isFullyValid() && !curSimAircraft->isSimPaused() && !curSimAircraft->isSimReplay())
+  {
+    // Fill metadata if still empty
+    if(perf->getAircraftType().isEmpty())
+      perf->setAircraftType(curSimAircraft->getAirplaneModel());
+
+    if(perf->getName().isEmpty())
+      perf->setName(curSimAircraft->getAirplaneTitle());
+
+    if(perf->getSimulator().isEmpty())
+      perf->setSimulator(simulator);
+  }
+
+  if(!externalSampling)
+    addSample(*curSimAircraft);
+
+  // Aggregate all samples queued since the last call
+  samples.consume([this](const Sample& sample) {
+          if(active)
+            processSample(sample);
+        });
+
+  quint64 dropped = droppedSamples.exchange(0);
+  if(dropped > 0)
+    qWarning() << Q_FUNC_INFO << "Dropped" << dropped << "samples";
+}
+
+void AircraftPerfHandler::addSample(const sc::SimConnectUserAircraft& aircraft)
+{
+  if(!active.load(std::memory_order_relaxed) || !aircraft.isFullyValid() || aircraft.isSimPaused() || aircraft.isSimReplay())
     return;
 
+  Sample sample;
+  sample.zuluTimeMs = aircraft.getZuluTime().toMSecsSinceEpoch();
+  sample.trueAirspeedKts = aircraft.getTrueAirspeedKts();
+  sample.verticalSpeedFtPerMin = aircraft.getVerticalSpeedFeetPerMin();
+  sample.indicatedAltitudeFt = aircraft.getIndicatedAltitudeFt();
+  sample.fuelFlowPph = aircraft.getFuelFlowPPH();
+  sample.fuelTotalWeightLbs = aircraft.getFuelTotalWeightLbs();
+  sample.fuelTotalQuantityGal = aircraft.getFuelTotalQuantityGallons();
+  sample.hasFuelFlow = aircraft.hasFuelFlow();
+  sample.onGround = aircraft.isOnGround();
+  sample.flying = aircraft.isFlying();
+
+  if(!samples.push(sample))
+    droppedSamples.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AircraftPerfHandler::processSample(const Sample& sample)
+{
+  curSample = sample;
+
   aircraftClimb = isClimbing();
   aircraftDescent = isDescending();
   aircraftCruise = isAtCruise();
-  aircraftFuelFlow = curSimAircraft->hasFuelFlow();
-  aircraftGround = curSimAircraft->isOnGround();
-  aircraftFlying = curSimAircraft->isFlying();
-
-  // Fill metadata if still empty
-  if(perf->getAircraftType().isEmpty())
-    perf->setAircraftType(curSimAircraft->getAirplaneModel());
-
-  if(perf->getName().isEmpty())
-    perf->setName(curSimAircraft->getAirplaneTitle());
-
-  if(perf->getSimulator().isEmpty())
-    perf->setSimulator(simulator);
+  aircraftFuelFlow = curSample.hasFuelFlow;
+  aircraftGround = curSample.onGround;
+  aircraftFlying = curSample.flying;
 
   // Determine fuel type ========================================================
   if(atools::almostEqual(weightVolRatio, 0.f))
   {
-    bool jetfuel = atools::geo::isJetFuel(curSimAircraft->getFuelTotalWeightLbs(),
-                                          curSimAircraft->getFuelTotalQuantityGallons(), weightVolRatio);
+    bool jetfuel = atools::geo::isJetFuel(curSample.fuelTotalWeightLbs, curSample.fuelTotalQuantityGal, weightVolRatio);
 
     if(weightVolRatio > 0.f)
     {
@@ -131,86 +178,83 @@ void AircraftPerfHandler::simDataChanged(const sc::SimConnectData& simulatorData
   // in fuel amount before flight
   if(startFuel < 0.1f && aircraftFuelFlow)
   {
-    startFuel = curSimAircraft->getFuelTotalWeightLbs();
+    startFuel = curSample.fuelTotalWeightLbs;
     qDebug() << Q_FUNC_INFO << "startFuel" << startFuel;
   }
 
   if(aircraftFuelFlow)
-    totalFuelConsumed = startFuel - curSimAircraft->getFuelTotalWeightLbs();
+    totalFuelConsumed = startFuel - curSample.fuelTotalWeightLbs;
 
   // Determine current flight sement ================================================================
   FlightSegment flightSegment = currentFlightSegment;
-  if(curSimAircraft->isFullyValid())
+  switch(currentFlightSegment)
   {
-    switch(currentFlightSegment)
-    {
-      case INVALID:
-        break;
-
-      case NONE:
-        // Nothing sampled yet - start from scratch ==============
-        if(aircraftGround)
-          flightSegment = aircraftFuelFlow ? DEPARTURE_TAXI : DEPARTURE_PARKING;
-        else if(aircraftCruise >= 0)
-          flightSegment = CRUISE;
-        else if(isClimbing() && aircraftCruise == -1)
-          flightSegment = CLIMB;
-        else if(isDescending() && aircraftCruise == -1)
-          flightSegment = DESCENT;
-        break;
-
-      case DEPARTURE_PARKING:
-        if(aircraftFuelFlow)
-          flightSegment = DEPARTURE_TAXI;
-        if(aircraftFlying)
-          // Skip directly to climb if in the air
-          flightSegment = CLIMB;
-        break;
-
-      case DEPARTURE_TAXI:
-        if(aircraftFlying)
-          flightSegment = CLIMB;
-        break;
-
-      case CLIMB:
-        if(aircraftCruise >= 0)
-          // At cruise - 200 ft or above
-          flightSegment = CRUISE;
-        break;
-
-      case CRUISE:
-        if(aircraftCruise < 0)
-          // Below cruise - start descent
-          flightSegment = DESCENT;
-        break;
-
-      case DESCENT:
-        if(!aircraftFlying)
-          // Landed
-          flightSegment = DESTINATION_TAXI;
-
-        if(aircraftCruise >= 0)
-          // Momentary deviation  go back to cruise
-          flightSegment = CRUISE;
-        break;
-
-      case DESTINATION_TAXI:
-        if(!aircraftFuelFlow)
-          // Engine shutdown
-          flightSegment = DESTINATION_PARKING;
-        break;
-
-      case LOADED:
-      // Loaded from last session - no inactive
-      case DESTINATION_PARKING:
-        // Finish on engine shutdown - stop collecting
-        active = false;
-        break;
-    }
+    case INVALID:
+      break;
+
+    case NONE:
+      // Nothing sampled yet - start from scratch ==============
+      if(aircraftGround)
+        flightSegment = aircraftFuelFlow ? DEPARTURE_TAXI : DEPARTURE_PARKING;
+      else if(aircraftCruise >= 0)
+        flightSegment = CRUISE;
+      else if(isClimbing() && aircraftCruise == -1)
+        flightSegment = CLIMB;
+      else if(isDescending() && aircraftCruise == -1)
+        flightSegment = DESCENT;
+      break;
+
+    case DEPARTURE_PARKING:
+      if(aircraftFuelFlow)
+        flightSegment = DEPARTURE_TAXI;
+      if(aircraftFlying)
+        // Skip directly to climb if in the air
+        flightSegment = CLIMB;
+      break;
+
+    case DEPARTURE_TAXI:
+      if(aircraftFlying)
+        flightSegment = CLIMB;
+      break;
+
+    case CLIMB:
+      if(aircraftCruise >= 0)
+        // At cruise - 200 ft or above
+        flightSegment = CRUISE;
+      break;
+
+    case CRUISE:
+      if(aircraftCruise < 0)
+        // Below cruise - start descent
+        flightSegment = DESCENT;
+      break;
+
+    case DESCENT:
+      if(!aircraftFlying)
+        // Landed
+        flightSegment = DESTINATION_TAXI;
+
+      if(aircraftCruise >= 0)
+        // Momentary deviation  go back to cruise
+        flightSegment = CRUISE;
+      break;
+
+    case DESTINATION_TAXI:
+      if(!aircraftFuelFlow)
+        // Engine shutdown
+        flightSegment = DESTINATION_PARKING;
+      break;
+
+    case LOADED:
+    // Loaded from last session - no inactive
+    case DESTINATION_PARKING:
+      // Finish on engine shutdown - stop collecting
+      active = false;
+      break;
   }
 
   // Remember segment dependent sample time to allow averaging =============
-  qint64 aircraftZuluTime = simulatorData.getUserAircraftConst().getZuluTime().toMSecsSinceEpoch();
+  qint64 aircraftZuluTime = curSample.zuluTimeMs;
   if(flightSegment != currentFlightSegment)
   {
     if(flightSegment == CLIMB)
@@ -223,7 +267,7 @@ void AircraftPerfHandler::simDataChanged(const sc::SimConnectData& simulatorData
 
   // Sum up taxi fuel  ========================================================
   if(currentFlightSegment == DEPARTURE_TAXI && aircraftFuelFlow)
-    perf->setTaxiFuel(startFuel - curSimAircraft->getFuelTotalWeightLbs());
+    perf->setTaxiFuel(startFuel - curSample.fuelTotalWeightLbs);
 
   // Sample every 500 ms ========================================
   if(aircraftZuluTime > lastSampleTimeMs + SAMPLE_TIME_MS)
@@ -320,11 +364,11 @@ void AircraftPerfHandler::samplePhase(FlightSegment flightSegment, qint64 now, q
       {
         qint64 lastSampleDuration = now - lastClimbSampleTimeMs;
         perf->setClimbSpeed(sampleValue(lastSampleDuration, curSampleDuration, perf->getClimbSpeed(),
-                                        curSimAircraft->getTrueAirspeedKts()));
+                                        curSample.trueAirspeedKts));
         perf->setClimbVertSpeed(sampleValue(lastSampleDuration, curSampleDuration, perf->getClimbVertSpeed(),
-                                            curSimAircraft->getVerticalSpeedFeetPerMin()));
+                                            curSample.verticalSpeedFtPerMin));
         perf->setClimbFuelFlow(sampleValue(lastSampleDuration, curSampleDuration, perf->getClimbFuelFlow(),
-                                           curSimAircraft->getFuelFlowPPH()));
+                                           curSample.fuelFlowPph));
       }
       break;
 
@@ -332,9 +376,9 @@ void AircraftPerfHandler::samplePhase(FlightSegment flightSegment, qint64 now, q
       {
         qint64 lastSampleDuration = now - lastCruiseSampleTimeMs;
         perf->setCruiseSpeed(sampleValue(lastSampleDuration, curSampleDuration, perf->getCruiseSpeed(),
-                                         curSimAircraft->getTrueAirspeedKts()));
+                                         curSample.trueAirspeedKts));
         perf->setCruiseFuelFlow(sampleValue(lastSampleDuration, curSampleDuration, perf->getCruiseFuelFlow(),
-                                            curSimAircraft->getFuelFlowPPH()));
+                                            curSample.fuelFlowPph));
 
         // Use cruise as default for alternate - user can adjust manually
         perf->setAlternateFuelFlow(perf->getCruiseFuelFlow());
@@ -346,12 +390,12 @@ void AircraftPerfHandler::samplePhase(FlightSegment flightSegment, qint64 now, q
       {
         qint64 lastSampleDuration = now - lastDescentSampleTimeMs;
         perf->setDescentSpeed(sampleValue(lastSampleDuration, curSampleDuration, perf->getDescentSpeed(),
-                                          curSimAircraft->getTrueAirspeedKts()));
+                                          curSample.trueAirspeedKts));
         perf->setDescentVertSpeed(sampleValue(lastSampleDuration, curSampleDuration,
                                               perf->getDescentVertSpeed(),
-                                              std::abs(curSimAircraft->getVerticalSpeedFeetPerMin())));
+                                              std::abs(curSample.verticalSpeedFtPerMin)));
         perf->setDescentFuelFlow(sampleValue(lastSampleDuration, curSampleDuration, perf->getDescentFuelFlow(),
-                                             curSimAircraft->getFuelFlowPPH()));
+                                             curSample.fuelFlowPph));
       }
       break;
   }
@@ -359,28 +403,28 @@ void AircraftPerfHandler::samplePhase(FlightSegment flightSegment, qint64 now, q
 
 bool AircraftPerfHandler::isClimbing() const
 {
-  return curSimAircraft->getVerticalSpeedFeetPerMin() > 150.f;
+  return curSample.verticalSpeedFtPerMin > 150.f;
 }
 
 bool AircraftPerfHandler::isDescending() const
 {
-  return curSimAircraft->getVerticalSpeedFeetPerMin() < -150.f;
+  return curSample.verticalSpeedFtPerMin < -150.f;
 }
 
 int AircraftPerfHandler::isAtCruise() const
 {
   float buffer = std::max(cruiseAltitude * 0.01f, 200.f);
-  int result = !(curSimAircraft->getIndicatedAltitudeFt() > cruiseAltitude - buffer &&
-                 curSimAircraft->getIndicatedAltitudeFt() < cruiseAltitude + buffer);
+  int result = !(curSample.indicatedAltitudeFt > cruiseAltitude - buffer &&
+                 curSample.indicatedAltitudeFt < cruiseAltitude + buffer);
 
   if(result == 1)
   {
     // Use a larger buffer for deviations
     float buffer2 = std::max(cruiseAltitude * 0.02f, 200.f);
-    if(curSimAircraft->getIndicatedAltitudeFt() < cruiseAltitude - buffer2)
+    if(curSample.indicatedAltitudeFt < cruiseAltitude - buffer2)
       result = -1;
 
-    if(curSimAircraft->getIndicatedAltitudeFt() > cruiseAltitude + buffer2)
+    if(curSample.indicatedAltitudeFt > cruiseAltitude + buffer2)
       result = 1;
   }
   return result;
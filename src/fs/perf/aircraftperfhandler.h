@@ -21,6 +21,9 @@
 #include <QObject>
 
 #include "fs/perf/aircraftperfconstants.h"
+#include "util/spscringbuffer.h"
+
+#include <atomic>
 
 namespace atools {
 namespace fs {
@@ -44,6 +47,10 @@ class AircraftPerf;
  *
  * All fuel numbers collected are lbs.
  *
+ * Samples are passed through a lock free single producer single consumer ring buffer. The producer can be
+ * the data reader thread calling addSample() directly or simDataChanged() if no external producer is used.
+ * Aggregation is done in batches in simDataChanged() in the thread of this object.
+ *
  */
 class AircraftPerfHandler
   : public QObject
@@ -99,16 +106,27 @@ public:
     return totalFuelConsumed;
   }
 
-  /* Simulator event that trigger data collection */
+  /* Simulator event that trigger data collection. Aggregates all queued samples.
+   * Queues the user aircraft as sample too if external sampling is not enabled. */
   void simDataChanged(const atools::fs::sc::SimConnectData& simulatorData, const QString& simulator);
 
+  /* Queue a sample for aggregation. Lock free and can be called from one producer thread like the data reader.
+   * Samples are dropped if the buffer is full. */
+  void addSample(const atools::fs::sc::SimConnectUserAircraft& aircraft);
+
+  /* If true samples are only queued by calls to addSample() from another thread and not by simDataChanged(). */
+  void setExternalSampling(bool value)
+  {
+    externalSampling = value;
+  }
+
   /* Done after landing or engine shutdown */
   bool isFinished() const;
 
   /* Currently collecting */
   bool isActive() const
   {
-    return active;
+    return active.load(std::memory_order_relaxed);
   }
 
   /* Get latest updated performance. Fuel unit is always lbs. */
@@ -129,6 +147,18 @@ signals:
   void flightSegmentChanged(const atools::fs::perf::FlightSegment& flightSegment);
 
 private:
+  /* Values of the user aircraft needed for aggregation. Copied into the ring buffer. */
+  struct Sample
+  {
+    qint64 zuluTimeMs = 0L;
+    float trueAirspeedKts = 0.f, verticalSpeedFtPerMin = 0.f, indicatedAltitudeFt = 0.f, fuelFlowPph = 0.f,
+          fuelTotalWeightLbs = 0.f, fuelTotalQuantityGal = 0.f;
+    bool hasFuelFlow = false, onGround = false, flying = false;
+  };
+
+  /* Run segment detection and averaging for one sample */
+  void processSample(const Sample& sample);
+
   /* -1 if below, 0 if at and 1 if above flight plan cruise altitude. Uses a altitude dependent buffer to avoid jitters. */
   int isAtCruise() const;
 
@@ -156,8 +186,16 @@ private:
   /* Last detected aircraft status - aggregated and therefore never null */
   atools::fs::sc::SimConnectUserAircraft *curSimAircraft;
 
-  /* Collecting data if true. Set to false after landing. */
-  bool active = false;
+  /* Sample currently processed */
+  Sample curSample;
+
+  /* Filled by producer and drained by simDataChanged() */
+  atools::util::SpscRingBuffer<Sample> samples;
+  std::atomic<quint64> droppedSamples = 0;
+  bool externalSampling = false;
+
+  /* Collecting data if true. Set to false after landing. Read by producer thread. */
+  std::atomic_bool active = false;
 
   bool aircraftClimb = false, aircraftDescent = false, aircraftFuelFlow = false, aircraftGround = false,
        aircraftFlying = false;
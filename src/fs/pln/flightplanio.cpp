@@ -38,6 +38,13 @@
 #include <QXmlStreamReader>
 #include <QDir>
 #include <QStringBuilder>
+#include <QStringDecoder>
+#include <QStringTokenizer>
+#include <QMutex>
+#include <QThread>
+#include <QThreadPool>
+
+#include <optional>
 
 using atools::geo::Pos;
 using atools::geo::PosD;
@@ -180,87 +187,205 @@ atools::fs::pln::FileFormat FlightplanIO::load(atools::fs::pln::Flightplan& plan
   return format;
 }
 
+namespace detect {
+
+/* Bytes read for format detection. Covers the 40 lines used by the signatures in all known files. */
+static const qint64 PROBE_SIZE = 16 * 1024;
+static const int PROBE_LINES = 40;
+static const int PROBE_LINE_LENGTH = 256;
+
+/* Limit cache size for long running directory scans */
+static const int MAX_CACHE_SIZE = 10000;
+
+/* Cached result for a file which is valid as long as size and modification time match */
+struct CacheEntry
+{
+  QDateTime lastModified;
+  qint64 size;
+  FileFormat format;
+};
+
+static QHash<QString, CacheEntry> cache;
+static QMutex cacheMutex;
+
+/* Split the prefix into trimmed, simplified and lower case lines like probeFile() but without reading line by line.
+ * Always returns at least six lines to ease checking. */
+static QStringList probeLines(const QByteArray& prefix)
+{
+  // Use BOM to detect UTF-16 or UTF-32 like QTextStream - default is UTF-8
+  std::optional<QStringConverter::Encoding> encoding = QStringConverter::encodingForData(prefix);
+  QStringDecoder decoder(encoding.value_or(QStringConverter::Utf8), QStringConverter::Flag::Stateless);
+  QString text = decoder.decode(prefix);
+
+  QStringList lines;
+  int numLinesTotal = 0;
+  for(QStringView line : QStringTokenizer(text, u'\n'))
+  {
+    if(lines.size() >= PROBE_LINES || numLinesTotal++ >= PROBE_LINES * 2)
+      break;
+
+    line = line.left(PROBE_LINE_LENGTH).trimmed();
+    if(!line.isEmpty())
+      lines.append(line.toString().toLower().simplified());
+  }
+
+  // Fill missing entries with empty strings to ease checking.
+  for(qsizetype i = lines.size(); i < 6; i++)
+    lines.append(QStringLiteral());
+  return lines;
+}
+
+static bool startsWithDigit(const QString& line)
+{
+  return !line.isEmpty() && line.at(0).isDigit();
+}
+
+static bool isPln(const QStringList& lines)
+{
+  return lines.at(0).startsWith("<?xml version") &&
+         atools::strAnyStartsWith(lines, "<simbase.document") &&
+         atools::strAnyStartsWith(lines, "<flightplan.flightplan");
+}
+
+/* Signatures for all formats in order of detection. First match wins. */
+struct Signature
+{
+  FileFormat format;
+  bool (*matches)(const QStringList& lines);
+};
+
+static const Signature SIGNATURES[] =
+{
+  // FLP: [CoRte]
+  {FLP, [](const QStringList& lines) -> bool {
+     return lines.constFirst().startsWith("[corte]");
+   }},
+
+  // FSX PLN or MSFS PLN - Major version 12 is MSFS 2024, 11 is MSFS and 10 is FSX and P3D
+  {MSFS_PLN_2024, [](const QStringList& lines) -> bool {
+     return isPln(lines) && atools::strAnyStartsWith(lines, "<appversionmajor>12");
+   }},
+  {MSFS_PLN, [](const QStringList& lines) -> bool {
+     return isPln(lines) && atools::strAnyStartsWith(lines, "<appversionmajor>11");
+   }},
+  {FSX_PLN, [](const QStringList& lines) -> bool {
+     return isPln(lines);
+   }},
+
+  {LNM_PLN, [](const QStringList& lines) -> bool {
+     return lines.at(0).startsWith("<?xml version") && lines.at(1).startsWith("<littlenavmap") &&
+            lines.at(2).startsWith("<flightplan");
+   }},
+
+  // FS9 ini format
+  {FS9_PLN, [](const QStringList& lines) -> bool {
+     return lines.at(0).startsWith("[flightplan]") && FS9_MATCH.match(lines.at(1)).hasMatch();
+   }},
+
+  // FSC ini format
+  {FSC_PLN, [](const QStringList& lines) -> bool {
+     return lines.at(0).startsWith("[fscfp]");
+   }},
+
+  // Old format
+  // I
+  // 3 version
+  // 1
+  // 4
+  {FMS3, [](const QStringList& lines) -> bool {
+     return (lines.at(0) == "i" || lines.at(0) == "a") && lines.at(1).startsWith("3 version") &&
+            startsWithDigit(lines.at(2)) && startsWithDigit(lines.at(3));
+   }},
+
+  // New v11 format
+  // I
+  // 1100 Version
+  // CYCLE 1710
+  {FMS11, [](const QStringList& lines) -> bool {
+     return (lines.at(0) == "i" || lines.at(0) == "a") && lines.at(1).startsWith("1100 version") &&
+            lines.at(2).startsWith("cycle");
+   }},
+
+  // <?xml version="1.0" encoding="UTF-8"?>
+  // <PropertyList>
+  // <version type="int">1</version>
+  {FLIGHTGEAR, [](const QStringList& lines) -> bool {
+     return lines.at(0).startsWith("<?xml version") &&
+            (lines.at(1).startsWith("<propertylist") || lines.at(0).contains("<propertylist")) &&
+            (lines.at(2).startsWith("<version") || lines.at(0).contains("<version") ||
+             lines.at(2).startsWith("<departure") || lines.at(0).contains("<departure") ||
+             lines.at(2).startsWith("<source") || lines.at(0).contains("<source"));
+   }},
+
+  // <?xml version="1.0" encoding="utf-8"?>
+  // <flight-plan xmlns="http://www8.garmin.com/xmlschemas/FlightPlan/v1">
+  // <created>2010-11-20T20:54:34Z</created>
+  // <waypoint-table>
+  {GARMIN_FPL, [](const QStringList& lines) -> bool {
+     return ((lines.at(0).startsWith("<?xml version") && lines.at(1).startsWith("<flight-plan")) ||
+             lines.at(0).startsWith("<flight-plan")) && !lines.filter("<waypoint-table").isEmpty();
+   }},
+
+  // FPN/RI:F:BIKF:F:RIMUM:F:CELLO:F:6119N:F:BILTO:F:NETKI:F:AMDEP:F:UMLER:F:RIVAK:F:KORUL:F:MAVOS:F:LEAS
+  // FPN/RI:DA:KYKM:D:WENAS7.PERTT:R:09O:F:COBDI,N47072W120397:F:N47406W120509:F: ...
+  {GARMIN_GFP, [](const QStringList& lines) -> bool {
+     return lines.at(0).startsWith("fpn/ri:");
+   }}
+};
+
+} // namespace detect
+
 FileFormat FlightplanIO::detectFormat(const QString& file)
 {
-  // Get first 40 non empty lines in lower case - always returns a list of 40
-  QStringList lines = probeFile(file, 40 /* numLinesRead */);
-
-  if(lines.isEmpty())
-    throw Exception(tr("Cannot open empty flight plan file \"%1\".").arg(file));
-
-  if(lines.constFirst().startsWith("[corte]"))
-    // FLP: [CoRte]
-    return FLP;
-  else if(lines.at(0).startsWith("<?xml version") &&
-          atools::strAnyStartsWith(lines, "<simbase.document") &&
-          atools::strAnyStartsWith(lines, "<flightplan.flightplan"))
+  QFileInfo fileinfo(file);
+  QString path = fileinfo.absoluteFilePath();
+  QDateTime lastModified = fileinfo.lastModified();
+  qint64 size = fileinfo.size();
+
   {
-    // FSX PLN or MSFS PLN
-    if(atools::strAnyStartsWith(lines, "<appversionmajor>12"))
-      // Major version 12 is MSFS 2024
-      return MSFS_PLN_2024;
-    else if(atools::strAnyStartsWith(lines, "<appversionmajor>11"))
-      // Major version 11 is MSFS
-      return MSFS_PLN;
-    else
-      // Major version 10 is FSX and P3D
-      return FSX_PLN;
+    // Check cache first - avoids opening the file
+    QMutexLocker locker(&detect::cacheMutex);
+    auto it = detect::cache.constFind(path);
+    if(it != detect::cache.constEnd() && it->size == size && it->lastModified == lastModified)
+      return it->format;
+  }
+
+  // Read prefix with a single call
+  QByteArray prefix;
+  QFile testFile(file);
+  if(testFile.open(QIODevice::ReadOnly))
+  {
+    prefix = testFile.read(detect::PROBE_SIZE);
+    testFile.close();
   }
-  else if(lines.at(0).startsWith("<?xml version") &&
-          lines.at(1).startsWith("<littlenavmap") &&
-          lines.at(2).startsWith("<flightplan"))
-    return LNM_PLN;
-  else if(lines.at(0).startsWith("[flightplan]") && FS9_MATCH.match(lines.at(1)).hasMatch())
-    // FS9 ini format
-    return FS9_PLN;
-  else if(lines.at(0).startsWith("[fscfp]"))
-    // FSC ini format
-    return FSC_PLN;
-  else if((lines.at(0) == "i" || lines.at(0) == "a") &&
-          lines.at(1).startsWith("3 version") &&
-          lines.at(2).at(0).isDigit() &&
-          lines.at(3).at(0).isDigit())
-    // Old format
-    // I
-    // 3 version
-    // 1
-    // 4
-    return FMS3;
-  else if((lines.at(0) == "i" || lines.at(0) == "a") &&
-          lines.at(1).startsWith("1100 version") &&
-          lines.at(2).startsWith("cycle"))
-    // New v11 format
-    // I
-    // 1100 Version
-    // CYCLE 1710
-    return FMS11;
-  else if(lines.at(0).startsWith("<?xml version") &&
-          (lines.at(1).startsWith("<propertylist") || lines.at(0).contains("<propertylist")) &&
-          (lines.at(2).startsWith("<version") || lines.at(0).contains("<version") ||
-           lines.at(2).startsWith("<departure") || lines.at(0).contains("<departure") ||
-           lines.at(2).startsWith("<source") || lines.at(0).contains("<source"))
-          /* && lines.at(2).startsWith("<version type=\"int\">")*/)
-    // <?xml version="1.0" encoding="UTF-8"?>
-    // <PropertyList>
-    // <version type="int">1</version>
-    return FLIGHTGEAR;
-  else if((lines.at(0).startsWith("<?xml version") &&
-           (lines.at(1).startsWith("<flight-plan") &&
-            !lines.filter("<waypoint-table").isEmpty())) ||
-          (lines.at(0).startsWith("<flight-plan") &&
-           !lines.filter("<waypoint-table").isEmpty()))
-    // <?xml version="1.0" encoding="utf-8"?>
-    // <flight-plan xmlns="http://www8.garmin.com/xmlschemas/FlightPlan/v1">
-    // <created>2010-11-20T20:54:34Z</created>
-    // <waypoint-table>
-    return GARMIN_FPL;
-  else if(lines.at(0).startsWith("fpn/ri:"))
-    // FPN/RI:F:BIKF:F:RIMUM:F:CELLO:F:6119N:F:BILTO:F:NETKI:F:AMDEP:F:UMLER:F:RIVAK:F:KORUL:F:MAVOS:F:LEAS
-    // FPN/RI:DA:KYKM:D:WENAS7.PERTT:R:09O:F:COBDI,N47072W120397:F:N47406W120509:F: ...
-    // ... ROZSE,N48134W121018:F:DIABO,N48500W120562.J503.FOLDY,N49031W120427:AA:CYLW:A:PIGLU4.YDC(16O):AP:I16-Z.HUMEK
-    return GARMIN_GFP;
   else
-    return NONE;
+    throw Exception(tr("Error reading \"%1\": %2").arg(file).arg(testFile.errorString()));
+
+  // Get first 40 non empty lines in lower case - always returns at least six lines
+  const QStringList lines = detect::probeLines(prefix);
+
+  FileFormat format = NONE;
+  for(const detect::Signature& signature : detect::SIGNATURES)
+  {
+    if(signature.matches(lines))
+    {
+      format = signature.format;
+      break;
+    }
+  }
+
+  QMutexLocker locker(&detect::cacheMutex);
+  if(detect::cache.size() >= detect::MAX_CACHE_SIZE)
+    detect::cache.clear();
+  detect::cache.insert(path, {lastModified, size, format});
+
+  return format;
+}
+
+void FlightplanIO::clearDetectFormatCache()
+{
+  QMutexLocker locker(&detect::cacheMutex);
+  detect::cache.clear();
 }
 
 void FlightplanIO::loadFlp(atools::fs::pln::Flightplan& plan, const QString& filename) const
@@ -1003,9 +1128,12 @@ atools::geo::Pos FlightplanIO::readPosLnm(atools::util::XmlStream& xmlStream) co
 {
   bool lonOk, latOk, altOk;
   QXmlStreamReader& reader = xmlStream.getReader();
-  float lon = reader.attributes().value("Lon").toFloat(&lonOk);
-  float lat = reader.attributes().value("Lat").toFloat(&latOk);
-  float alt = reader.attributes().value("Alt").toFloat(&altOk);
+
+  // Copy attributes only once
+  const QXmlStreamAttributes attributes = reader.attributes();
+  float lon = attributes.value(QLatin1String("Lon")).toFloat(&lonOk);
+  float lat = attributes.value(QLatin1String("Lat")).toFloat(&latOk);
+  float alt = attributes.value(QLatin1String("Alt")).toFloat(&altOk);
 
   // Read only attributes
   reader.skipCurrentElement();
@@ -1050,30 +1178,48 @@ void FlightplanIO::readWaypointsLnm(atools::util::XmlStream& xmlStream, QList<Fl
       FlightplanEntry entry;
       while(xmlStream.readNextStartElement())
       {
-        if(reader.name() == QStringLiteral("Name"))
-          entry.setName(reader.readElementText());
-        else if(reader.name() == QStringLiteral("Ident"))
-          entry.setIdent(reader.readElementText());
-        else if(reader.name() == QStringLiteral("Region"))
-          entry.setRegion(reader.readElementText());
-        else if(reader.name() == QStringLiteral("Name"))
-          entry.setName(reader.readElementText());
-        else if(reader.name() == QStringLiteral("Airway"))
-          entry.setAirway(reader.readElementText());
-        else if(reader.name() == QStringLiteral("Track"))
+        // Compare names without creating strings - order has to match switch below
+        switch(xmlStream.nameIndex({QLatin1String("Name"), QLatin1String("Ident"), QLatin1String("Region"),
+                                    QLatin1String("Airway"), QLatin1String("Track"), QLatin1String("Type"),
+                                    QLatin1String("Comment"), QLatin1String("Pos")}))
         {
-          // NAT or PACOTS track
-          entry.setAirway(reader.readElementText());
-          entry.setFlag(atools::fs::pln::entry::TRACK);
+          case 0: // Name
+            entry.setName(reader.readElementText());
+            break;
+
+          case 1: // Ident
+            entry.setIdent(reader.readElementText());
+            break;
+
+          case 2: // Region
+            entry.setRegion(reader.readElementText());
+            break;
+
+          case 3: // Airway
+            entry.setAirway(reader.readElementText());
+            break;
+
+          case 4: // Track
+            // NAT or PACOTS track
+            entry.setAirway(reader.readElementText());
+            entry.setFlag(atools::fs::pln::entry::TRACK);
+            break;
+
+          case 5: // Type
+            entry.setWaypointTypeFromLnm(reader.readElementText());
+            break;
+
+          case 6: // Comment
+            entry.setComment(reader.readElementText());
+            break;
+
+          case 7: // Pos
+            entry.setPosition(readPosLnm(xmlStream));
+            break;
+
+          default:
+            xmlStream.skipCurrentElement(true /* warn */);
         }
-        else if(reader.name() == QStringLiteral("Type"))
-          entry.setWaypointTypeFromLnm(reader.readElementText());
-        else if(reader.name() == QStringLiteral("Comment"))
-          entry.setComment(reader.readElementText());
-        else if(reader.name() == QStringLiteral("Pos"))
-          entry.setPosition(readPosLnm(xmlStream));
-        else
-          xmlStream.skipCurrentElement(true /* warn */);
       }
       entries.append(entry);
     }
@@ -1890,6 +2036,158 @@ QString FlightplanIO::saveLnmStr(const Flightplan& plan) const
   return lnmString;
 }
 
+void FlightplanIO::saveBatch(const Flightplan& plan, const QList<SaveJob>& jobs, const SaveOptions& options,
+                             int numThreads) const
+{
+  QStringList errors;
+  QMutex errorMutex;
+
+  // Local pool to be independent of other tasks in the global pool
+  QThreadPool pool;
+  pool.setMaxThreadCount(numThreads > 0 ? numThreads : std::max(1, QThread::idealThreadCount()));
+
+  for(const SaveJob& job : jobs)
+  {
+    // Plan, options and this are not modified while saving and stay valid until waitForDone() returns
+    pool.start([this, &plan, &options, &errors, &errorMutex, job]() -> void {
+            try
+            {
+              save(plan, job, options);
+            }
+            catch(atools::Exception& e)
+            {
+              QMutexLocker locker(&errorMutex);
+              errors.append(QString::fromUtf8(e.what()));
+            }
+            catch(...)
+            {
+              QMutexLocker locker(&errorMutex);
+              errors.append(tr("Unknown error saving \"%1\".").arg(job.filename));
+            }
+          });
+  }
+
+  pool.waitForDone();
+
+  if(!errors.isEmpty())
+    throw Exception(errors.join('\n'));
+}
+
+void FlightplanIO::save(const Flightplan& plan, const SaveJob& job, const SaveOptions& options) const
+{
+  switch(job.format)
+  {
+    case SaveFormat::LNMPLN:
+      saveLnm(plan, job.filename);
+      break;
+
+    case SaveFormat::PLN:
+      savePln(plan, job.filename);
+      break;
+
+    case SaveFormat::PLN_MSFS:
+      savePlnMsfs(plan, job.filename);
+      break;
+
+    case SaveFormat::PLN_MSFS24:
+      savePlnMsfs24(plan, job.filename);
+      break;
+
+    case SaveFormat::PLN_MSFS_COMPAT:
+      savePlnMsfsCompat(plan, job.filename);
+      break;
+
+    case SaveFormat::PLN_ISG:
+      savePlnIsg(plan, job.filename);
+      break;
+
+    case SaveFormat::PLN_PMS50:
+      savePlnPms50(plan, job.filename);
+      break;
+
+    case SaveFormat::FLIGHTGEAR:
+      saveFlightGear(plan, job.filename);
+      break;
+
+    case SaveFormat::RTE:
+      saveRte(plan, job.filename);
+      break;
+
+    case SaveFormat::FLP:
+      saveFlp(plan, job.filename);
+      break;
+
+    case SaveFormat::CRJ_FLP:
+      saveCrjFlp(plan, job.filename);
+      break;
+
+    case SaveFormat::MSFS_CRJ_FLP:
+      saveMsfsCrjFlp(plan, job.filename);
+      break;
+
+    case SaveFormat::FMS3:
+      saveFms3(plan, job.filename);
+      break;
+
+    case SaveFormat::FMS11:
+      saveFms11(plan, job.filename);
+      break;
+
+    case SaveFormat::CIVA_FMS:
+      saveCivaFms(plan, job.filename);
+      break;
+
+    case SaveFormat::INIBUILDS_MSFS:
+      saveIniBuildsMsfs(plan, job.filename);
+      break;
+
+    case SaveFormat::GARMIN_FPL:
+      saveGarminFpl(plan, job.filename, options.garminUserWaypoints);
+      break;
+
+    case SaveFormat::FPR:
+      saveFpr(plan, job.filename);
+      break;
+
+    case SaveFormat::FLTPLAN:
+      saveFltplan(plan, job.filename);
+      break;
+
+    case SaveFormat::BBS_PLN:
+      saveBbsPln(plan, job.filename);
+      break;
+
+    case SaveFormat::FEELTHERE_FPL:
+      saveFeelthereFpl(plan, job.filename, options.feelthereGroundSpeed);
+      break;
+
+    case SaveFormat::LEVELD_RTE:
+      saveLeveldRte(plan, job.filename);
+      break;
+
+    case SaveFormat::EFBR:
+      saveEfbr(plan, job.filename, options.efbrRoute, options.efbrCycle, options.efbrDepartureRunway,
+               options.efbrDestinationRunway);
+      break;
+
+    case SaveFormat::QW_RTE:
+      saveQwRte(plan, job.filename);
+      break;
+
+    case SaveFormat::MDR:
+      saveMdr(plan, job.filename);
+      break;
+
+    case SaveFormat::TFDI:
+      saveTfdi(plan, job.filename, options.tfdiJetAirways);
+      break;
+
+    case SaveFormat::IFLY:
+      saveIfly(plan, job.filename);
+      break;
+  }
+}
+
 void FlightplanIO::saveLnm(const Flightplan& plan, const QString& filename) const
 {
   QFile xmlFile(filename);
@@ -4483,13 +4781,13 @@ void FlightplanIO::loadGarminFplInternal(atools::fs::pln::Flightplan& plan, atoo
             else if(reader.name() == QStringLiteral("country-code"))
               entry.setRegion(reader.readElementText());
             else if(reader.name() == QStringLiteral("lat"))
-              pos.setLatY(reader.readElementText().toFloat());
+              pos.setLatY(xmlStream.readElementTextView().toFloat());
             else if(reader.name() == QStringLiteral("lon"))
-              pos.setLonX(reader.readElementText().toFloat());
+              pos.setLonX(xmlStream.readElementTextView().toFloat());
             else if(reader.name() == QStringLiteral("comment"))
               entry.setComment(reader.readElementText());
             else if(reader.name() == QStringLiteral("elevation"))
-              pos.setAltitude(reader.readElementText().toFloat());
+              pos.setAltitude(xmlStream.readElementTextView().toFloat());
             else
               xmlStream.skipCurrentElement(false /* warn */);
           }
@@ -20,6 +20,7 @@
 
 #include "fs/pln/flightplanconstants.h"
 
+#include <QBitArray>
 #include <QCoreApplication>
 
 class QXmlStreamReader;
@@ -40,6 +41,54 @@ namespace pln {
 class Flightplan;
 class FlightplanEntry;
 
+/* Target formats for FlightplanIO::saveBatch(). Each value corresponds to one of the save methods. */
+enum class SaveFormat
+{
+  LNMPLN, /* saveLnm() */
+  PLN, /* savePln() */
+  PLN_MSFS, /* savePlnMsfs() */
+  PLN_MSFS24, /* savePlnMsfs24() */
+  PLN_MSFS_COMPAT, /* savePlnMsfsCompat() */
+  PLN_ISG, /* savePlnIsg() */
+  PLN_PMS50, /* savePlnPms50() */
+  FLIGHTGEAR, /* saveFlightGear() */
+  RTE, /* saveRte() */
+  FLP, /* saveFlp() */
+  CRJ_FLP, /* saveCrjFlp() */
+  MSFS_CRJ_FLP, /* saveMsfsCrjFlp() */
+  FMS3, /* saveFms3() */
+  FMS11, /* saveFms11() */
+  CIVA_FMS, /* saveCivaFms() */
+  INIBUILDS_MSFS, /* saveIniBuildsMsfs() */
+  GARMIN_FPL, /* saveGarminFpl() */
+  FPR, /* saveFpr() */
+  FLTPLAN, /* saveFltplan() */
+  BBS_PLN, /* saveBbsPln() */
+  FEELTHERE_FPL, /* saveFeelthereFpl() */
+  LEVELD_RTE, /* saveLeveldRte() */
+  EFBR, /* saveEfbr() */
+  QW_RTE, /* saveQwRte() */
+  MDR, /* saveMdr() */
+  TFDI, /* saveTfdi() */
+  IFLY /* saveIfly() */
+};
+
+/* One file to write in FlightplanIO::saveBatch() */
+struct SaveJob
+{
+  atools::fs::pln::SaveFormat format;
+  QString filename;
+};
+
+/* Additional parameters needed by some formats in FlightplanIO::saveBatch() */
+struct SaveOptions
+{
+  bool garminUserWaypoints = false; /* GARMIN_FPL */
+  int feelthereGroundSpeed = 0; /* FEELTHERE_FPL */
+  QString efbrRoute, efbrCycle, efbrDepartureRunway, efbrDestinationRunway; /* EFBR */
+  QBitArray tfdiJetAirways; /* TFDI */
+};
+
 /*
  * Collects all save and load methods of flight plan.
  * Stateless except filename for error reporting.
@@ -60,9 +109,14 @@ public:
    */
   FileFormat load(atools::fs::pln::Flightplan& plan, const QString& file) const;
 
-  /* Detect format by reading the first few lines */
+  /* Detect format by reading a small prefix of the file at once and matching it against a table of signatures.
+   * Results are cached by path, size and modification time which makes repeated scans of directories cheap.
+   * Thread safe. Throws an exception if the file cannot be read. */
   static atools::fs::pln::FileFormat detectFormat(const QString& file);
 
+  /* Clear cached results of detectFormat() */
+  static void clearDetectFormatCache();
+
   /* true for any supported flight plan file */
   static bool isFlightplanFile(const QString& file)
   {
@@ -178,6 +232,17 @@ public:
   /*  iFly Jets Advanced Series */
   void saveIfly(const Flightplan& plan, const QString& filename) const;
 
+  /* Save the plan in all given formats concurrently using a thread pool. The plan is shared between the
+   * threads and not copied except by methods which modify their own copy.
+   * All jobs are run even if some fail. Throws one Exception containing all error messages after all jobs are done.
+   * numThreads = 0 uses the number of cores. */
+  void saveBatch(const atools::fs::pln::Flightplan& plan, const QList<atools::fs::pln::SaveJob>& jobs,
+                 const atools::fs::pln::SaveOptions& options = SaveOptions(), int numThreads = 0) const;
+
+  /* Save the plan in one format by calling the related save method */
+  void save(const atools::fs::pln::Flightplan& plan, const atools::fs::pln::SaveJob& job,
+            const atools::fs::pln::SaveOptions& options = SaveOptions()) const;
+
   /* Version number to save into LNMPLN files */
   static const int LNMPLN_VERSION_MAJOR = 1;
   static const int LNMPLN_VERSION_MINOR = 2;
@@ -0,0 +1,402 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/pln/routestringparser.h"
+
+#include "fs/pln/flightplan.h"
+#include "fs/util/coordinates.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+
+#include <QDebug>
+#include <QRegularExpression>
+#include <QStringBuilder>
+
+namespace atools {
+namespace fs {
+namespace pln {
+
+using atools::sql::SqlQuery;
+using atools::geo::Pos;
+using atools::util::StringPool;
+
+/* Number of idents bound in one query. Each is bound four times and SQLite allows 999 parameters by default. */
+static const int MAX_IDENTS_PER_QUERY = 200;
+
+RouteStringParser::RouteStringParser(const atools::sql::SqlDatabase *sqlDb)
+  : db(sqlDb)
+{
+}
+
+RouteStringParser::~RouteStringParser()
+{
+}
+
+QStringList RouteStringParser::tokenize(const QString& routeString)
+{
+  // Speed and level like N0450F350, M082F370 or K0830S1130
+  static const QRegularExpression SPEED_LEVEL("^[NKM]\\d{3,4}([FAMS]\\d{3,4}|VFR)$");
+
+  QStringList tokens;
+  for(QString token : routeString.toUpper().split(QRegularExpression("\\s+"), Qt::SkipEmptyParts))
+  {
+    // Remove speed and altitude or runway suffix like NATOR/N0450F350 or EDDF/25C
+    int idx = token.indexOf('/');
+    if(idx > 0)
+      token.truncate(idx);
+
+    if(token.isEmpty() || token == QStringLiteral("DCT") || token == QStringLiteral("SID") ||
+       token == QStringLiteral("STAR") || SPEED_LEVEL.match(token).hasMatch())
+      continue;
+
+    tokens.append(token);
+  }
+  return tokens;
+}
+
+bool RouteStringParser::parse(Flightplan& flightplan, const QString& routeString, QStringList *messages)
+{
+  flightplan.clearAll();
+
+  const QStringList tokens = tokenize(routeString);
+  if(tokens.isEmpty())
+    return false;
+
+  // Detect all coordinates at once - invalid positions for idents
+  const QList<Pos> coords = atools::fs::util::fromAnyWaypointFormat(tokens);
+
+  if(!indexLoaded)
+  {
+    // Fetch all candidates for this route in one query each for navaids and airways
+    stringPool.clear();
+    navaids.clearIndex();
+    navaidsByIdent.clear();
+    airways.clear();
+
+    QStringList idents;
+    for(int i = 0; i < tokens.size(); i++)
+    {
+      if(!coords.at(i).isValid())
+        idents.append(tokens.at(i));
+    }
+    idents.removeDuplicates();
+
+    loadNavaids(idents);
+    loadAirways(idents);
+  }
+
+  // Position of the next coordinate or unique ident to resolve duplicates before the first fix
+  auto lookaheadPos = [&tokens, &coords, this](int start) -> Pos {
+                        for(int i = start + 1; i < tokens.size(); i++)
+                        {
+                          if(coords.at(i).isValid())
+                            return coords.at(i);
+
+                          QList<int> indexes = navaidsByIdent.values(stringPool.find(tokens.at(i)));
+                          if(indexes.size() == 1)
+                            return navaids.at(indexes.constFirst()).pos;
+                        }
+                        return Pos();
+                      };
+
+  QList<FlightplanEntry> entries;
+  for(int i = 0; i < tokens.size(); i++)
+  {
+    const QString& token = tokens.at(i);
+
+    if(coords.at(i).isValid())
+    {
+      FlightplanEntry entry;
+      entry.setIdent(token);
+      entry.setPosition(coords.at(i));
+      entry.setWaypointType(entry::USER);
+      entries.append(entry);
+      continue;
+    }
+
+    StringPool::Handle handle = stringPool.find(token);
+
+    // Airway needs a fix before and an ident after it
+    if(!entries.isEmpty() && i < tokens.size() - 1 && !coords.at(i + 1).isValid() && airways.contains(handle))
+    {
+      if(expandAirway(entries, token, entries.constLast(), tokens.at(i + 1)))
+        // Exit fix is already added
+        i++;
+      else if(messages != nullptr)
+        messages->append(tr("Airway %1 does not connect %2 and %3.").arg(token, entries.constLast().getIdent(), tokens.at(i + 1)));
+      continue;
+    }
+
+    int index = nearestNavaid(handle, entries.isEmpty() ? lookaheadPos(i) : entries.constLast().getPosition());
+    if(index != -1)
+      entries.append(navaidEntry(index));
+    else if(messages != nullptr)
+      messages->append(tr("%1 not found.").arg(token));
+  }
+
+  for(const FlightplanEntry& entry : std::as_const(entries))
+    flightplan.append(entry);
+
+  flightplan.adjustDepartureAndDestination(true /* force */);
+  return !entries.isEmpty();
+}
+
+int RouteStringParser::nearestNavaid(StringPool::Handle ident, const Pos& pos) const
+{
+  int nearest = -1;
+  if(ident == StringPool::INVALID)
+    return nearest;
+
+  // Compare euclidian distances of the precalculated points in the spatial index
+  atools::geo::Point3D point = pos.isValid() ? pos.toCartesian() : atools::geo::Point3D();
+  float minDist = std::numeric_limits<float>::max();
+  for(auto it = navaidsByIdent.constFind(ident); it != navaidsByIdent.constEnd() && it.key() == ident; ++it)
+  {
+    if(!point.isValid())
+      return it.value();
+
+    float dist = navaids.atPoint3D(it.value()).comparableDistance(point);
+    if(dist < minDist)
+    {
+      minDist = dist;
+      nearest = it.value();
+    }
+  }
+  return nearest;
+}
+
+bool RouteStringParser::expandAirway(QList<FlightplanEntry>& entries, const QString& airway,
+                                     const FlightplanEntry& entryWaypoint, const QString& exitIdent) const
+{
+  StringPool::Handle entryHandle = stringPool.find(entryWaypoint.getIdent()), exitHandle = stringPool.find(exitIdent);
+  if(entryHandle == StringPool::INVALID || exitHandle == StringPool::INVALID)
+    return false;
+
+  // Find fragment containing both entry and exit having the entry nearest to the last fix
+  const AirwayFragment *bestFragment = nullptr;
+  int bestEntry = -1, bestExit = -1;
+  float minDist = std::numeric_limits<float>::max();
+  for(const AirwayFragment& fragment : airways.value(stringPool.find(airway)))
+  {
+    const QList<AirwayPoint>& points = fragment.points;
+    for(int entryIdx = 0; entryIdx < points.size(); entryIdx++)
+    {
+      if(points.at(entryIdx).ident != entryHandle)
+        continue;
+
+      float dist = points.at(entryIdx).pos.distanceMeterTo(entryWaypoint.getPosition());
+      if(dist >= minDist)
+        continue;
+
+      // Nearest exit in sequence in both directions
+      int exitIdx = -1;
+      for(int offset = 1; offset < points.size() && exitIdx == -1; offset++)
+      {
+        if(entryIdx + offset < points.size() && points.at(entryIdx + offset).ident == exitHandle)
+          exitIdx = entryIdx + offset;
+        else if(entryIdx - offset >= 0 && points.at(entryIdx - offset).ident == exitHandle)
+          exitIdx = entryIdx - offset;
+      }
+
+      if(exitIdx != -1)
+      {
+        minDist = dist;
+        bestFragment = &fragment;
+        bestEntry = entryIdx;
+        bestExit = exitIdx;
+      }
+    }
+  }
+
+  if(bestFragment == nullptr)
+    return false;
+
+  // Add all waypoints after entry up to and including exit
+  int step = bestExit > bestEntry ? 1 : -1;
+  for(int i = bestEntry + step; i != bestExit + step; i += step)
+  {
+    const AirwayPoint& point = bestFragment->points.at(i);
+    FlightplanEntry entry;
+    entry.setIdent(stringPool.string(point.ident));
+    entry.setRegion(stringPool.string(point.region));
+    entry.setPosition(point.pos);
+    entry.setWaypointType(point.type);
+    entry.setAirway(airway);
+    entries.append(entry);
+  }
+  return true;
+}
+
+FlightplanEntry RouteStringParser::navaidEntry(int index) const
+{
+  const NavPoint& navPoint = navaids.at(index);
+  FlightplanEntry entry;
+  entry.setIdent(stringPool.string(navPoint.ident));
+  entry.setRegion(stringPool.string(navPoint.region));
+  entry.setPosition(navPoint.pos);
+  entry.setWaypointType(navPoint.type);
+  return entry;
+}
+
+void RouteStringParser::loadIndex()
+{
+  stringPool.clear();
+  navaids.clearIndex();
+  navaidsByIdent.clear();
+  airways.clear();
+
+  loadNavaids(QStringList());
+  loadAirways(QStringList());
+  indexLoaded = true;
+
+  qInfo() << Q_FUNC_INFO << "Loaded" << navaids.size() << "navaids and" << airways.size() << "airways";
+}
+
+void RouteStringParser::clearIndex()
+{
+  stringPool.clear();
+  navaids.clearIndex();
+  navaidsByIdent.clear();
+  airways.clear();
+  indexLoaded = false;
+}
+
+/* Placeholder list "?,?,?" for an in clause */
+static QString placeholders(int num)
+{
+  QString str;
+  for(int i = 0; i < num; i++)
+    str.append(i == 0 ? QStringLiteral("?") : QStringLiteral(",?"));
+  return str;
+}
+
+void RouteStringParser::loadNavaids(const QStringList& idents)
+{
+  enum {IDENT, REGION, TYPE, LONX, LATY};
+
+  // Artificial waypoints are duplicates of VOR and NDB
+  static const QString QUERY(
+    "select ident, region, " % QString::number(entry::AIRPORT) % " as type, lonx, laty from airport %1 "
+    "union all "
+    "select ident, region, " % QString::number(entry::WAYPOINT) % " as type, lonx, laty from waypoint "
+    "where artificial is null %2 "
+    "union all "
+    "select ident, region, " % QString::number(entry::VOR) % " as type, lonx, laty from vor %1 "
+    "union all "
+    "select ident, region, " % QString::number(entry::NDB) % " as type, lonx, laty from ndb %1");
+
+  for(int start = 0; start < std::max(static_cast<int>(idents.size()), 1); start += MAX_IDENTS_PER_QUERY)
+  {
+    QStringList chunk = idents.mid(start, MAX_IDENTS_PER_QUERY);
+    QString inClause = "ident in (" % placeholders(static_cast<int>(chunk.size())) % ")";
+
+    SqlQuery query(db);
+    if(chunk.isEmpty())
+      query.prepare(QUERY.arg(QString(), QString()));
+    else
+    {
+      query.prepare(QUERY.arg("where " % inClause, "and " % inClause));
+      for(int i = 0; i < 4; i++)
+      {
+        for(int j = 0; j < chunk.size(); j++)
+          query.bindValue(static_cast<int>(i * chunk.size() + j), chunk.at(j));
+      }
+    }
+
+    query.exec();
+    while(query.next())
+    {
+      NavPoint navPoint;
+      navPoint.ident = stringPool.intern(query.valueStr(IDENT));
+      navPoint.region = stringPool.intern(query.valueStr(REGION));
+      navPoint.type = static_cast<entry::WaypointType>(query.valueInt(TYPE));
+      navPoint.pos = Pos(query.valueFloat(LONX), query.valueFloat(LATY));
+
+      navaidsByIdent.insert(navPoint.ident, static_cast<int>(navaids.size()));
+      navaids.append(navPoint);
+    }
+  }
+
+  navaids.updateIndex();
+}
+
+void RouteStringParser::loadAirways(const QStringList& names)
+{
+  enum {NAME, FRAGMENT, FROM_IDENT, FROM_REGION, FROM_TYPE, FROM_LONX, FROM_LATY,
+        TO_IDENT, TO_REGION, TO_TYPE, TO_LONX, TO_LATY};
+
+  static const QString QUERY(
+    "select a.airway_name, a.airway_fragment_no, "
+    "f.ident, f.region, f.type, f.lonx, f.laty, t.ident, t.region, t.type, t.lonx, t.laty "
+    "from airway a join waypoint f on a.from_waypoint_id = f.waypoint_id "
+    "join waypoint t on a.to_waypoint_id = t.waypoint_id %1 "
+    "order by a.airway_name, a.airway_fragment_no, a.sequence_no");
+
+  // Airway direction is ignored since the route string defines it
+  auto airwayPoint = [this](const SqlQuery& query, int ident, int region, int type, int lonx, int laty) -> AirwayPoint {
+                       QString typeStr = query.valueStr(type);
+                       entry::WaypointType wpType = typeStr == QStringLiteral("V") ? entry::VOR :
+                                                    typeStr == QStringLiteral("N") ? entry::NDB : entry::WAYPOINT;
+                       return {stringPool.intern(query.valueStr(ident)), stringPool.intern(query.valueStr(region)), wpType,
+                               Pos(query.valueFloat(lonx), query.valueFloat(laty))};
+                     };
+
+  for(int start = 0; start < std::max(static_cast<int>(names.size()), 1); start += MAX_IDENTS_PER_QUERY)
+  {
+    QStringList chunk = names.mid(start, MAX_IDENTS_PER_QUERY);
+
+    SqlQuery query(db);
+    if(chunk.isEmpty())
+      query.prepare(QUERY.arg(QString()));
+    else
+    {
+      query.prepare(QUERY.arg("where a.airway_name in (" % placeholders(static_cast<int>(chunk.size())) % ")"));
+      for(int j = 0; j < chunk.size(); j++)
+        query.bindValue(j, chunk.at(j));
+    }
+
+    query.exec();
+    StringPool::Handle lastName = StringPool::INVALID;
+    int lastFragment = -1;
+    AirwayFragment *fragment = nullptr;
+    while(query.next())
+    {
+      StringPool::Handle name = stringPool.intern(query.valueStr(NAME));
+      int fragmentNo = query.valueInt(FRAGMENT);
+      AirwayPoint from = airwayPoint(query, FROM_IDENT, FROM_REGION, FROM_TYPE, FROM_LONX, FROM_LATY);
+
+      if(fragment == nullptr || name != lastName || fragmentNo != lastFragment)
+      {
+        QList<AirwayFragment>& fragments = airways[name];
+        fragments.append(AirwayFragment());
+        fragment = &fragments.last();
+        fragment->points.append(from);
+        lastName = name;
+        lastFragment = fragmentNo;
+      }
+      else if(fragment->points.constLast().ident != from.ident || fragment->points.constLast().region != from.region)
+        // Gap in sequence
+        fragment->points.append(from);
+
+      fragment->points.append(airwayPoint(query, TO_IDENT, TO_REGION, TO_TYPE, TO_LONX, TO_LATY));
+    }
+  }
+}
+
+} // namespace pln
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,144 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_PLN_ROUTESTRINGPARSER_H
+#define ATOOLS_FS_PLN_ROUTESTRINGPARSER_H
+
+#include "fs/pln/flightplanconstants.h"
+#include "geo/pos.h"
+#include "geo/spatialindex.h"
+#include "util/stringpool.h"
+
+#include <QCoreApplication>
+#include <QHash>
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+}
+namespace fs {
+namespace pln {
+
+class Flightplan;
+class FlightplanEntry;
+
+/*
+ * Converts ATS route strings like "EDDF ANEKI Y163 NATOR N850 DCT 5020N04000W LSZH" into flight plan entries.
+ *
+ * The whole string is tokenized first. All idents and airway names are then resolved in one query each
+ * against the navigation database. Alternatively loadIndex() reads all navaids, airports and airways once
+ * into memory which avoids all queries when parsing many routes.
+ *
+ * Duplicate idents are resolved by taking the candidate nearest to the previous fix. Airways are expanded into
+ * all waypoints between entry and exit. Speed and altitude suffixes like "/N0450F350", SID/STAR keywords and
+ * "DCT" are ignored. Procedures are not resolved.
+ */
+class RouteStringParser
+{
+  Q_DECLARE_TR_FUNCTIONS(RouteStringParser)
+
+public:
+  explicit RouteStringParser(const atools::sql::SqlDatabase *sqlDb);
+  ~RouteStringParser();
+
+  RouteStringParser(const RouteStringParser& other) = delete;
+  RouteStringParser& operator=(const RouteStringParser& other) = delete;
+
+  /* Parse route string into the flight plan which is cleared before. Airports as first and last token are used as
+   * departure and destination. Messages about unresolved or skipped tokens are appended to messages if not null.
+   * Returns false if no entries could be resolved. */
+  bool parse(atools::fs::pln::Flightplan& flightplan, const QString& routeString, QStringList *messages = nullptr);
+
+  /* Load all navaids, airports and airways into memory. parse() does not use the database afterwards. */
+  void loadIndex();
+
+  /* Drop in-memory index and fall back to batched queries */
+  void clearIndex();
+
+  bool isIndexLoaded() const
+  {
+    return indexLoaded;
+  }
+
+  /* Split route string into uppercase tokens. Removes speed and altitude suffixes, "DCT" and SID/STAR keywords. */
+  static QStringList tokenize(const QString& routeString);
+
+private:
+  /* Airport, VOR, NDB or waypoint from database */
+  struct NavPoint
+  {
+    atools::util::StringPool::Handle ident, region;
+    atools::fs::pln::entry::WaypointType type;
+    atools::geo::Pos pos;
+
+    const atools::geo::Pos& getPosition() const
+    {
+      return pos;
+    }
+  };
+
+  /* Waypoint of an airway fragment */
+  struct AirwayPoint
+  {
+    atools::util::StringPool::Handle ident, region;
+    atools::fs::pln::entry::WaypointType type;
+    atools::geo::Pos pos;
+  };
+
+  /* Waypoints of a connected airway fragment ordered by sequence number */
+  struct AirwayFragment
+  {
+    QList<AirwayPoint> points;
+  };
+
+  /* Load navaids and airports for the given idents or all if list is empty */
+  void loadNavaids(const QStringList& idents);
+
+  /* Load airways for the given names or all if list is empty */
+  void loadAirways(const QStringList& names);
+
+  /* Index of the candidate for ident nearest to the given position or -1 if not found.
+   * Takes the first if position is not valid. */
+  int nearestNavaid(atools::util::StringPool::Handle ident, const atools::geo::Pos& pos) const;
+
+  /* Append all waypoints of airway from entry to exit ident. Returns false if airway does not connect both. */
+  bool expandAirway(QList<FlightplanEntry>& entries, const QString& airway, const FlightplanEntry& entryWaypoint,
+                    const QString& exitIdent) const;
+
+  FlightplanEntry navaidEntry(int index) const;
+
+  const atools::sql::SqlDatabase *db;
+  bool indexLoaded = false;
+
+  /* Idents, regions and airway names */
+  atools::util::StringPool stringPool;
+
+  /* All loaded navaids and airports in a spatial index. Point3D of the index is used to disambiguate idents. */
+  atools::geo::SpatialIndex<NavPoint> navaids;
+
+  /* Ident to indexes in navaids */
+  QMultiHash<atools::util::StringPool::Handle, int> navaidsByIdent;
+
+  /* Airway name to fragments */
+  QHash<atools::util::StringPool::Handle, QList<AirwayFragment> > airways;
+};
+
+} // namespace pln
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_PLN_ROUTESTRINGPARSER_H
@@ -18,116 +18,259 @@
 #include "fs/progresshandler.h"
 #include "fs/navdatabaseoptions.h"
 #include "fs/scenery/sceneryarea.h"
+#include "util/tracer.h"
 
 #include <QDebug>
+#include <QThread>
 
 namespace atools {
 namespace fs {
 
+ProgressHandler::ProgressHandler()
+{
+
+}
+
+ProgressHandler::~ProgressHandler()
+{
+  stopSampler();
+}
+
+void ProgressHandler::setAsyncInterval(int intervalMs)
+{
+  stopSampler();
+
+  asyncIntervalMs = intervalMs;
+  if(intervalMs > 0)
+  {
+    samplerStop = false;
+    lastSampledCurrent = counters.current.load();
+    sampler = QThread::create([this]() {
+      runSampler();
+    });
+    sampler->setObjectName("ProgressSampler");
+    sampler->start(QThread::LowPriority);
+  }
+}
+
+void ProgressHandler::stopSampler()
+{
+  if(sampler != nullptr)
+  {
+    {
+      QMutexLocker locker(&samplerMutex);
+      samplerStop = true;
+      samplerCondition.wakeAll();
+    }
+    sampler->wait();
+    delete sampler;
+    sampler = nullptr;
+  }
+}
+
+void ProgressHandler::runSampler()
+{
+  QMutexLocker locker(&samplerMutex);
+  while(!samplerStop)
+  {
+    samplerCondition.wait(&samplerMutex, static_cast<unsigned long>(asyncIntervalMs));
+
+    if(!samplerStop && changed.exchange(false))
+    {
+      // Do not block stopSampler() while in callback
+      locker.unlock();
+      if(callHandler())
+        canceled = true;
+      locker.relock();
+    }
+  }
+}
+
 void ProgressHandler::increaseCurrent(int increase)
 {
-  info.current += increase;
+  counters.current += increase;
 }
 
 bool ProgressHandler::reportOtherMsg(const QString& otherAction)
 {
-  info.otherAction = otherAction;
-  info.newFile = false;
-  info.newSceneryArea = false;
-  info.newOther = true;
+  {
+    QMutexLocker locker(&infoMutex);
+    info.otherAction = otherAction;
+    info.newFile = false;
+    info.newSceneryArea = false;
+    info.newOther = true;
+  }
 
-  return callHandler();
+  return report();
 }
 
 bool ProgressHandler::reportOther(const QString& otherAction, int current, bool silent)
 {
-  info.lastCurrent = info.current;
-  if(current != -1)
-    info.current = current;
-  else
-    info.current++;
-  info.otherAction = otherAction;
-
-  info.newFile = false;
-  info.newSceneryArea = false;
-  info.newOther = true;
+  {
+    QMutexLocker locker(&infoMutex);
+    info.lastCurrent = counters.current;
+    if(current != -1)
+      counters.current = current;
+    else
+      counters.current++;
+    info.otherAction = otherAction;
+
+    info.newFile = false;
+    info.newSceneryArea = false;
+    info.newOther = true;
+  }
 
 #ifdef DEBUG_INFORMATION
   if(current != -1)
-    qDebug() << Q_FUNC_INFO << "=P=== Current reportOther" << info.current << "of" << info.total << otherAction;
+    qDebug() << Q_FUNC_INFO << "=P=== Current reportOther" << counters.current.load() << "of" << counters.total.load()
+             << otherAction;
 #endif
 
   if(silent)
     return false;
   else
-    return callHandler();
+    return report();
 }
 
 bool ProgressHandler::reportOtherInc(const QString& otherAction, int increment)
 {
-  info.lastCurrent = info.current;
-  info.current += increment;
-  info.otherAction = otherAction;
+  {
+    QMutexLocker locker(&infoMutex);
+    info.lastCurrent = counters.current.fetch_add(increment);
+    info.otherAction = otherAction;
 
-  info.newFile = false;
-  info.newSceneryArea = false;
-  info.newOther = true;
+    info.newFile = false;
+    info.newSceneryArea = false;
+    info.newOther = true;
+  }
 
 #ifdef DEBUG_INFORMATION
-  qDebug() << Q_FUNC_INFO << "=P=== Current reportOtherInc" << info.current << "of" << info.total << otherAction;
+  qDebug() << Q_FUNC_INFO << "=P=== Current reportOtherInc" << counters.current.load() << "of" << counters.total.load()
+           << otherAction;
 #endif
 
-  return callHandler();
+  return report();
 }
 
 void ProgressHandler::reportError()
 {
-  info.numErrors++;
+  counters.numErrors++;
 }
 
 void ProgressHandler::reportErrors(int num)
 {
-  info.numErrors += num;
+  counters.numErrors += num;
 }
 
 bool ProgressHandler::reportBglFile(const QString& bglFilepath)
 {
-  info.lastCurrent = info.current;
-  info.current++;
-  info.filepath = bglFilepath;
+  {
+    QMutexLocker locker(&infoMutex);
+    info.lastCurrent = counters.current++;
+    info.filepath = bglFilepath;
 
-  info.newFile = true;
-  info.newSceneryArea = false;
-  info.newOther = false;
+    info.newFile = true;
+    info.newSceneryArea = false;
+    info.newOther = false;
+  }
 
 #ifdef DEBUG_INFORMATION
-  qDebug() << Q_FUNC_INFO << "=P=== Current reportBglFile" << info.current << "of" << info.total << bglFilepath;
+  qDebug() << Q_FUNC_INFO << "=P=== Current reportBglFile" << counters.current.load() << "of" << counters.total.load()
+           << bglFilepath;
 #endif
 
-  return callHandler();
+  return report();
 }
 
 bool ProgressHandler::reportFinish()
 {
-  info.lastCall = true;
-  info.newFile = false;
-  info.newSceneryArea = false;
-  info.newOther = false;
+  // Last call is always done synchronously in the calling thread
+  stopSampler();
+
+  {
+    QMutexLocker locker(&infoMutex);
+    info.lastCall = true;
+    info.newFile = false;
+    info.newSceneryArea = false;
+    info.newOther = false;
+  }
+
+  qDebug() << Q_FUNC_INFO << "=P=== Current reportFinish" << counters.current.load() << "of" << counters.total.load();
+
+  return callHandler() || canceled;
+}
+
+void ProgressHandler::startPhase(const QString& name)
+{
+  finishPhase();
+  phaseName = name;
+  phaseTimer.start();
+  phaseTraceStartUs = atools::util::Tracer::isEnabled() ? atools::util::Tracer::timestampUs() : -1;
+}
 
-  qDebug() << Q_FUNC_INFO << "=P=== Current reportFinish" << info.current << "of" << info.total;
+void ProgressHandler::finishPhase(qint64 bytes, qint64 rows)
+{
+  if(phaseTimer.isValid())
+  {
+    addPhaseTime(phaseName, phaseTimer.elapsed(), bytes, rows);
+
+    if(phaseTraceStartUs >= 0)
+      atools::util::Tracer::addEvent("Phase", "navdatabase", phaseTraceStartUs,
+                                     atools::util::Tracer::timestampUs() - phaseTraceStartUs, phaseName);
+    phaseTraceStartUs = -1;
+    phaseTimer.invalidate();
+    phaseName.clear();
+  }
+}
 
-  return callHandler();
+void ProgressHandler::addPhaseTime(const QString& name, qint64 elapsedMs, qint64 bytes, qint64 rows)
+{
+  QMutexLocker locker(&infoMutex);
+  for(NavDatabasePhaseTime& phase : info.phaseTimes)
+  {
+    if(phase.name == name)
+    {
+      phase.elapsedMs += elapsedMs;
+      phase.bytes += bytes;
+      phase.rows += rows;
+      phase.count++;
+      return;
+    }
+  }
+
+  NavDatabasePhaseTime phase;
+  phase.name = name;
+  phase.elapsedMs = elapsedMs;
+  phase.bytes = bytes;
+  phase.rows = rows;
+  phase.count = 1;
+  info.phaseTimes.append(phase);
+}
+
+void ProgressHandler::logPhaseTimes() const
+{
+  QMutexLocker locker(&infoMutex);
+  qint64 totalMs = 0;
+  qInfo() << "Phase times ================================================";
+  for(const NavDatabasePhaseTime& phase : info.phaseTimes)
+  {
+    qInfo() << phase;
+    totalMs += phase.elapsedMs;
+  }
+  qInfo().nospace() << "Sum of phase times " << totalMs << " ms";
 }
 
 void ProgressHandler::setTotal(int total)
 {
-  info.total = total;
+  counters.total = total;
 }
 
 void ProgressHandler::reset()
 {
-  info.numErrors = 0;
-  info.current = 0;
+  QMutexLocker locker(&infoMutex);
+  counters.numErrors = 0;
+  counters.current = 0;
+  lastSampledCurrent = 0;
   info.lastCurrent = 0;
   info.sceneryArea = nullptr;
   info.filepath.clear();
@@ -140,58 +283,96 @@ void ProgressHandler::reset()
 
 bool ProgressHandler::reportSceneryArea(const scenery::SceneryArea *sceneryArea)
 {
-  info.lastCurrent = info.current;
-  info.current++;
-  info.sceneryArea = sceneryArea;
+  {
+    QMutexLocker locker(&infoMutex);
+    info.lastCurrent = counters.current++;
+    info.sceneryArea = sceneryArea;
 
-  info.newFile = false;
-  info.newSceneryArea = true;
-  info.newOther = false;
+    info.newFile = false;
+    info.newSceneryArea = true;
+    info.newOther = false;
+  }
 
 #ifdef DEBUG_INFORMATION
-  qDebug() << Q_FUNC_INFO << "=P=== Current reportSceneryArea" << info.current << "of" << info.total;
+  qDebug() << Q_FUNC_INFO << "=P=== Current reportSceneryArea" << counters.current.load() << "of" << counters.total.load();
 #endif
 
-  return callHandler();
+  return report();
+}
+
+bool ProgressHandler::report()
+{
+  if(sampler != nullptr)
+  {
+    // Sampler thread will pick up the changes
+    changed = true;
+    return canceled || cancelToken.isCanceled();
+  }
+  else
+    return callHandler();
 }
 
 bool ProgressHandler::callHandler()
 {
+  // Copy state to avoid holding the lock while in callbacks
+  NavDatabaseProgress progress;
+  {
+    QMutexLocker locker(&infoMutex);
+    progress = info;
+    info.firstCall = false;
+  }
+
+  progress.total = counters.total;
+  progress.current = counters.current;
+  progress.numErrors = counters.numErrors;
+  progress.numFiles = counters.numFiles;
+  progress.numAirports = counters.numAirports;
+  progress.numNamelists = counters.numNamelists;
+  progress.numVors = counters.numVors;
+  progress.numIls = counters.numIls;
+  progress.numNdbs = counters.numNdbs;
+  progress.numMarker = counters.numMarker;
+  progress.numBoundaries = counters.numBoundaries;
+  progress.numWaypoints = counters.numWaypoints;
+  progress.numObjectsWritten = counters.numObjectsWritten;
+  progress.numBytesSkipped = counters.numBytesSkipped;
+
+  // Show progress since last sample instead of last report
+  if(sampler != nullptr || (asyncIntervalMs > 0 && progress.lastCall))
+    progress.lastCurrent = lastSampledCurrent.exchange(progress.current);
+
   bool retval = false;
 
   // Alway call default handler - this one cannot call cancel
   if(callDefaultCallback)
-    defaultProgressCallback();
+    defaultProgressCallback(progress);
 
   if(progressCallback)
     // Call user handler
-    retval = progressCallback(info);
-
-  if(info.firstCall)
-    info.firstCall = false;
+    retval = progressCallback(progress);
 
-  return retval;
+  return retval || cancelToken.isCanceled();
 }
 
 /*
  * Default handler prints to console or log only
  */
-void ProgressHandler::defaultProgressCallback()
+void ProgressHandler::defaultProgressCallback(const NavDatabaseProgress& progress)
 {
   // Using "=P===" for easier recognition in the log file
 
-  if(info.isNewFile())
-    qInfo() << "=P===" << numbersAsString(info) << info.getFileName();
+  if(progress.isNewFile())
+    qInfo() << "=P===" << numbersAsString(progress) << progress.getFileName();
 
-  if(info.isNewSceneryArea())
+  if(progress.isNewSceneryArea())
   {
     qInfo() << "=P=====================================================================";
-    qInfo() << "=P===" << numbersAsString(info) << info.getSceneryTitle();
-    qInfo() << "=P===" << info.getSceneryPath();
+    qInfo() << "=P===" << numbersAsString(progress) << progress.getSceneryTitle();
+    qInfo() << "=P===" << progress.getSceneryPath();
   }
 
-  if(info.isNewOther())
-    qInfo() << "=P===" << numbersAsString(info) << info.getOtherAction();
+  if(progress.isNewOther())
+    qInfo() << "=P===" << numbersAsString(progress) << progress.getOtherAction();
 }
 
 QString ProgressHandler::numbersAsString(const atools::fs::NavDatabaseProgress& inf)
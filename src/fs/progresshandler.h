@@ -21,6 +21,14 @@
 #include "fs/navdatabaseprogress.h"
 #include "fs/navdatabaseoptions.h"
 
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QWaitCondition>
+
+#include <atomic>
+
+class QThread;
+
 namespace atools {
 namespace fs {
 namespace scenery {
@@ -29,10 +37,31 @@ class SceneryArea;
 
 /*
  * Progress handler. Fills the NavDatabaseProgress object with information and calls the progress callback.
+ *
+ * Calls the callback synchronously in the reporting thread by default.
+ * In asynchronous mode report methods only update atomic counters and the latest message. A sampler thread
+ * reports the state periodically and the report methods return the cancel state of the last callback call.
+ * Report methods can be called from parallel compile stages in this mode.
  */
 class ProgressHandler
 {
 public:
+  ProgressHandler();
+  ~ProgressHandler();
+
+  ProgressHandler(const ProgressHandler& other) = delete;
+  ProgressHandler& operator=(const ProgressHandler& other) = delete;
+
+  /* Start a sampler thread which calls the callbacks every intervalMs milliseconds if anything has changed.
+   * Callbacks are called from the sampler thread then. Intermediate messages are dropped.
+   * 0 stops the thread and calls callbacks synchronously again. reportFinish() always stops the thread. */
+  void setAsyncInterval(int intervalMs);
+
+  bool isAsync() const
+  {
+    return sampler != nullptr;
+  }
+
   void setProgressCallback(const atools::fs::NavDatabaseOptions::ProgressCallbackType& value)
   {
     progressCallback = value;
@@ -43,6 +72,12 @@ public:
     callDefaultCallback = value;
   }
 
+  /* Report cancel on next progress report if the token is canceled */
+  void setCancelToken(const atools::util::CancelToken& value)
+  {
+    cancelToken = value;
+  }
+
   /*
    * Increment progress by one and send message about new scenery area
    */
@@ -77,6 +112,23 @@ public:
   /* Only send message without incrementing progress */
   bool reportOtherMsg(const QString& otherAction);
 
+  /* Finish the current phase if any and start timing a new one */
+  void startPhase(const QString& name);
+
+  /* Finish the current phase and add its time with the given throughput numbers */
+  void finishPhase(qint64 bytes = 0, qint64 rows = 0);
+
+  /* Add time for a phase measured elsewhere, e.g. summed up in worker threads. */
+  void addPhaseTime(const QString& name, qint64 elapsedMs, qint64 bytes = 0, qint64 rows = 0);
+
+  const QList<atools::fs::NavDatabasePhaseTime>& getPhaseTimes() const
+  {
+    return info.phaseTimes;
+  }
+
+  /* Print all phases and total time to the log */
+  void logPhaseTimes() const;
+
   /* set total amount of progress steps */
   void setTotal(int total);
 
@@ -89,114 +141,162 @@ public:
   /* Set current number of BGL files */
   void setNumFiles(int value)
   {
-    info.numFiles = value;
+    counters.numFiles = value;
   }
 
   void setNumAirports(int value)
   {
-    info.numAirports = value;
+    counters.numAirports = value;
   }
 
   void setNumNamelists(int value)
   {
-    info.numNamelists = value;
+    counters.numNamelists = value;
   }
 
   void setNumVors(int value)
   {
-    info.numVors = value;
+    counters.numVors = value;
   }
 
   void setNumIls(int value)
   {
-    info.numIls = value;
+    counters.numIls = value;
   }
 
   void setNumNdbs(int value)
   {
-    info.numNdbs = value;
+    counters.numNdbs = value;
   }
 
   void setNumMarker(int value)
   {
-    info.numMarker = value;
+    counters.numMarker = value;
   }
 
   void setNumBoundaries(int value)
   {
-    info.numBoundaries = value;
+    counters.numBoundaries = value;
   }
 
   void setNumWaypoints(int value)
   {
-    info.numWaypoints = value;
+    counters.numWaypoints = value;
   }
 
   void setNumObjectsWritten(int value)
   {
-    info.numObjectsWritten = value;
+    counters.numObjectsWritten = value;
+  }
+
+  void setNumBytesSkipped(qint64 value)
+  {
+    counters.numBytesSkipped = value;
   }
 
   void incNumFiles(int value = 1)
   {
-    info.numFiles += value;
+    counters.numFiles += value;
   }
 
   void incNumAirports(int value = 1)
   {
-    info.numAirports += value;
+    counters.numAirports += value;
   }
 
   void incNumNamelists(int value = 1)
   {
-    info.numNamelists += value;
+    counters.numNamelists += value;
   }
 
   void incNumVors(int value = 1)
   {
-    info.numVors += value;
+    counters.numVors += value;
   }
 
   void incNumIls(int value = 1)
   {
-    info.numIls += value;
+    counters.numIls += value;
   }
 
   void incNumNdbs(int value = 1)
   {
-    info.numNdbs += value;
+    counters.numNdbs += value;
   }
 
   void incNumMarker(int value = 1)
   {
-    info.numMarker += value;
+    counters.numMarker += value;
   }
 
   void incNumBoundaries(int value = 1)
   {
-    info.numBoundaries += value;
+    counters.numBoundaries += value;
   }
 
   void incNumWaypoints(int value = 1)
   {
-    info.numWaypoints += value;
+    counters.numWaypoints += value;
   }
 
   void incNumObjectsWritten(int value = 1)
   {
-    info.numObjectsWritten += value;
+    counters.numObjectsWritten += value;
   }
 
 private:
+  /* Counters which can be updated from any thread */
+  struct Counters
+  {
+    std::atomic<int> total{0}, current{0}, numErrors{0}, numFiles{0}, numAirports{0}, numNamelists{0}, numVors{0},
+                     numIls{0}, numNdbs{0}, numMarker{0}, numBoundaries{0}, numWaypoints{0}, numObjectsWritten{0};
+    std::atomic<qint64> numBytesSkipped{0};
+  };
+
   bool callDefaultCallback = true;
-  void defaultProgressCallback();
+  void defaultProgressCallback(const atools::fs::NavDatabaseProgress& progress);
 
   atools::fs::NavDatabaseOptions::ProgressCallbackType progressCallback;
 
+  /* Messages, flags and phase times. Counters are copied from counters when calling the handler. Guarded by infoMutex. */
   atools::fs::NavDatabaseProgress info;
+  mutable QMutex infoMutex;
+
+  Counters counters;
 
+  /* Currently timed phase from startPhase() */
+  QString phaseName;
+  QElapsedTimer phaseTimer;
+  qint64 phaseTraceStartUs = -1; /* Start for atools::util::Tracer or -1 if not tracing */
+
+  /* Call handler directly or notify sampler in asynchronous mode. Returns true if canceled. */
+  bool report();
+
+  /* Call callbacks with a copy of the current state */
   bool callHandler();
 
+  /* Loop of the sampler thread */
+  void runSampler();
+  void stopSampler();
+
+  /* Sampler thread or null if synchronous */
+  QThread *sampler = nullptr;
+  int asyncIntervalMs = 0;
+  QMutex samplerMutex;
+  QWaitCondition samplerCondition;
+  bool samplerStop = false; /* Guarded by samplerMutex */
+
+  /* Something was reported since the last sample */
+  std::atomic_bool changed{false};
+
+  /* Last callback call returned true */
+  std::atomic_bool canceled{false};
+
+  atools::util::CancelToken cancelToken;
+
+  /* Current value of the last sample used as lastCurrent in asynchronous mode */
+  std::atomic<int> lastSampledCurrent{0};
+
   static QString numbersAsString(const atools::fs::NavDatabaseProgress& inf);
 
 };
@@ -0,0 +1,146 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/sc/datareaderstats.h"
+
+#include <QJsonArray>
+
+#include <algorithm>
+
+namespace atools {
+namespace fs {
+namespace sc {
+
+const qint64 DataReaderStats::BUCKET_LIMITS_US[NUM_BUCKETS] =
+{100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 1000000};
+
+DataReaderStats::DataReaderStats(int windowSize)
+  : size(std::max(1, windowSize))
+{
+}
+
+void DataReaderStats::add(DataReaderPhase phase, qint64 timeUs)
+{
+  QMutexLocker locker(&mutex);
+  Window& window = windows[phase];
+  if(window.samples.size() < size)
+    window.samples.append(timeUs);
+  else
+    window.samples[window.next] = timeUs;
+  window.next = (window.next + 1) % size;
+  window.total++;
+}
+
+void DataReaderStats::clear()
+{
+  QMutexLocker locker(&mutex);
+  for(Window& window : windows)
+  {
+    window.samples.clear();
+    window.next = 0;
+    window.total = 0;
+  }
+}
+
+QJsonObject DataReaderStats::toJson() const
+{
+  QJsonObject phases;
+  qint64 busyMeanUs = 0;
+
+  QMutexLocker locker(&mutex);
+  for(int i = 0; i < NUM_PHASES; i++)
+  {
+    const Window& window = windows[i];
+    QList<qint64> sorted(window.samples);
+    std::sort(sorted.begin(), sorted.end());
+
+    QJsonObject phase;
+    phase.insert("total", window.total);
+    phase.insert("count", static_cast<qint64>(sorted.size()));
+
+    if(!sorted.isEmpty())
+    {
+      qint64 sum = 0;
+      qint64 buckets[NUM_BUCKETS + 1] = {};
+      for(qint64 value : std::as_const(sorted))
+      {
+        sum += value;
+        int bucket = static_cast<int>(std::lower_bound(BUCKET_LIMITS_US, BUCKET_LIMITS_US + NUM_BUCKETS, value) -
+                                      BUCKET_LIMITS_US);
+        buckets[bucket]++;
+      }
+
+      qint64 meanUs = sum / sorted.size();
+      if(i == PHASE_BUSY)
+        busyMeanUs = meanUs;
+
+      phase.insert("meanUs", meanUs);
+      phase.insert("p50Us", sorted.at(sorted.size() * 50 / 100));
+      phase.insert("p90Us", sorted.at(sorted.size() * 90 / 100));
+      phase.insert("p99Us", sorted.at(sorted.size() * 99 / 100));
+      phase.insert("maxUs", sorted.constLast());
+
+      QJsonArray bucketArr;
+      for(int b = 0; b <= NUM_BUCKETS; b++)
+        bucketArr.append(QJsonObject({{"le", b < NUM_BUCKETS ? BUCKET_LIMITS_US[b] : -1}, {"count", buckets[b]}}));
+      phase.insert("buckets", bucketArr);
+    }
+    phases.insert(phaseName(static_cast<DataReaderPhase>(i)), phase);
+  }
+  locker.unlock();
+
+  QJsonObject json;
+  json.insert("windowSize", size);
+  json.insert("phases", phases);
+  json.insert("achievableRateHz", busyMeanUs > 0 ? 1000000. / static_cast<double>(busyMeanUs) : 0.);
+  return json;
+}
+
+QString DataReaderStats::phaseName(DataReaderPhase phase)
+{
+  switch(phase)
+  {
+    case PHASE_FETCH:
+      return QStringLiteral("fetch");
+
+    case PHASE_REPLAY_READ:
+      return QStringLiteral("replayRead");
+
+    case PHASE_WHAZZUP_WRITE:
+      return QStringLiteral("whazzupWrite");
+
+    case PHASE_PROCESS:
+      return QStringLiteral("process");
+
+    case PHASE_REPLAY_WRITE:
+      return QStringLiteral("replayWrite");
+
+    case PHASE_SLEEP:
+      return QStringLiteral("sleep");
+
+    case PHASE_BUSY:
+      return QStringLiteral("busy");
+
+    case NUM_PHASES:
+      break;
+  }
+  return QStringLiteral("unknown");
+}
+
+} // namespace sc
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,90 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_SC_DATAREADERSTATS_H
+#define ATOOLS_FS_SC_DATAREADERSTATS_H
+
+#include <QJsonObject>
+#include <QList>
+#include <QMutex>
+
+namespace atools {
+namespace fs {
+namespace sc {
+
+/* Timed parts of one DataReaderThread loop iteration */
+enum DataReaderPhase
+{
+  PHASE_FETCH, /* Fetch from simulator handler */
+  PHASE_REPLAY_READ, /* Read and skip blocks from replay file */
+  PHASE_WHAZZUP_WRITE, /* Debug whazzup file writing in replay mode */
+  PHASE_PROCESS, /* Level of detail, callback and emitting the packet */
+  PHASE_REPLAY_WRITE, /* Write packet to replay file */
+  PHASE_SLEEP, /* Wait for the next update */
+  PHASE_BUSY, /* Whole iteration without sleep */
+  NUM_PHASES
+};
+
+/*
+ * Rolling statistics of phase times in DataReaderThread.
+ *
+ * Keeps the last samples for each phase and calculates percentiles and a histogram with fixed buckets from these.
+ * This shows where time goes and the update rate which can be reached from the busy time.
+ * All methods are thread safe.
+ */
+class DataReaderStats
+{
+public:
+  /* windowSize is number of last samples kept for each phase */
+  explicit DataReaderStats(int windowSize = 600);
+
+  /* Add phase time in microseconds */
+  void add(atools::fs::sc::DataReaderPhase phase, qint64 timeUs);
+
+  void clear();
+
+  /* Phases by name each having count, mean, p50, p90, p99 and max in microseconds and the
+   * histogram "buckets" of {"le": limit in microseconds or -1 for the unlimited last bucket, "count": number}.
+   * "achievableRateHz" is the update rate reachable with the mean busy time. */
+  QJsonObject toJson() const;
+
+  /* Name used in JSON */
+  static QString phaseName(atools::fs::sc::DataReaderPhase phase);
+
+private:
+  /* Ring buffer of last samples */
+  struct Window
+  {
+    QList<qint64> samples;
+    int next = 0;
+    qint64 total = 0; /* Number of samples since clear */
+  };
+
+  /* Upper bounds of the histogram buckets in microseconds. The last bucket is unlimited. */
+  static const int NUM_BUCKETS = 12;
+  static const qint64 BUCKET_LIMITS_US[NUM_BUCKETS];
+
+  Window windows[NUM_PHASES];
+  int size;
+  mutable QMutex mutex;
+};
+
+} // namespace sc
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_SC_DATAREADERSTATS_H
@@ -20,13 +20,16 @@
 #include "fs/sc/simconnecthandler.h"
 #include "fs/sc/xpconnecthandler.h"
 #include "atools.h"
+#include "logging/loggingmacros.h"
 
+#include <QBuffer>
 #include <QDebug>
 #include <QDateTime>
 #include <QFile>
 #include <QDataStream>
 #include <QCoreApplication>
 #include <QDir>
+#include <QElapsedTimer>
 
 namespace atools {
 namespace fs {
@@ -250,6 +253,7 @@ void DataReaderThread::connectToSimulator()
     int counterSec = 0;
 
     reconnecting = true;
+    aiLastSent.clear();
     while(!terminate)
     {
       if((counterSec % rateSec) == 0)
@@ -322,21 +326,52 @@ void DataReaderThread::run()
   numErrors = 0;
   failedTerminally = false;
 
+  // Time of each phase in the loop ===============
+  QElapsedTimer phaseTimer, busyTimer;
+  auto lapUs = [&phaseTimer]() -> qint64 {
+                 qint64 us = phaseTimer.nsecsElapsed() / 1000;
+                 phaseTimer.start();
+                 return us;
+               };
+
   // Main loop  ============================================
   while(!terminate)
   {
     atools::fs::sc::SimConnectData data;
     atools::fs::sc::Options opts = options;
 
+    busyTimer.start();
+    phaseTimer.start();
+
     if(loadReplayFile != nullptr)
     {
       // Do replay ============================================
-      data.read(loadReplayFile);
+      int seekSeconds = replaySeekSeconds.exchange(-1);
+      if(seekSeconds >= 0)
+        seekReplayInternal(seekSeconds);
+
+      // Skip blocks without parsing if packets would be sent faster than the minimum sleep time
+      unsigned long speed = static_cast<unsigned long>(replaySpeed);
+      if(replayUpdateRateMs > 0 && replayUpdateRateMs / speed < REPLAY_MIN_SLEEP_MS)
+      {
+        int numSkip = static_cast<int>(REPLAY_MIN_SLEEP_MS * speed / replayUpdateRateMs) - 1;
+        for(int i = 0; i < numSkip; i++)
+        {
+          if(!skipReplayBlock())
+            break;
+        }
+      }
+
+      if(replayDevice->pos() >= replayDataEnd)
+        replayDevice->seek(REPLAY_FILE_DATA_START_OFFSET);
+
+      data.read(replayDevice);
+      phaseStats.add(PHASE_REPLAY_READ, lapUs());
 
       if(data.getStatus() == OK)
       {
-        if(loadReplayFile->atEnd())
-          loadReplayFile->seek(REPLAY_FILE_DATA_START_OFFSET);
+        if(replayDevice->pos() >= replayDataEnd)
+          replayDevice->seek(REPLAY_FILE_DATA_START_OFFSET);
 
         // Remove boat and ship traffic depending on settings for testing purposes
         QList<SimConnectAircraft>& aiAircraft = data.getAiAircraft();
@@ -351,7 +386,10 @@ void DataReaderThread::run()
                 }), aiAircraft.end());
 
         if(!replayWhazzupFile.isEmpty())
+        {
           debugWriteWhazzup(data);
+          phaseStats.add(PHASE_WHAZZUP_WRITE, lapUs());
+        }
 
 #ifdef DEBUG_CREATE_WHAZZUP_TEST_FILTER
 
@@ -361,7 +399,11 @@ void DataReaderThread::run()
               }), data.getAiAircraft().end());
 #endif
 
+        if(userAircraftCallback)
+          userAircraftCallback(data.getUserAircraftConst());
+
         emit postSimConnectData(data);
+        phaseStats.add(PHASE_PROCESS, lapUs());
       }
       else
       {
@@ -374,17 +416,36 @@ void DataReaderThread::run()
     else if(fetchData(data, aiFetchRadiusKm, opts))
     {
       // Data fetched from simconnect - send to client ============================================
+      phaseStats.add(PHASE_FETCH, lapUs());
+
       if(verbose && !data.getMetars().isEmpty())
-        qDebug() << "DataReaderThread::run() num metars" << data.getMetars().size();
+        ATOOLS_DEBUG() << "DataReaderThread::run() num metars" << data.getMetars().size();
+
+      if(aiLevelOfDetail && !data.isEmptyReply())
+        applyAiLevelOfDetail(data);
+
+      if(userAircraftCallback)
+        userAircraftCallback(data.getUserAircraftConst());
 
       emit postSimConnectData(data);
+      phaseStats.add(PHASE_PROCESS, lapUs());
 
       if(saveReplayFile != nullptr && saveReplayFile->isOpen() && data.getPacketId() > 0)
+      {
+        // Add index entry for the block start in intervals
+        quint32 timestamp = static_cast<quint32>(data.getPacketTimestamp().toSecsSinceEpoch());
+        if(replayIndex.isEmpty() || timestamp >= replayIndex.constLast().timestamp + REPLAY_INDEX_INTERVAL_SECONDS)
+          replayIndex.append({timestamp, saveReplayFile->pos()});
+
         // Save only simulator packets, not weather replays
         data.write(saveReplayFile);
+        phaseStats.add(PHASE_REPLAY_WRITE, lapUs());
+      }
     }
     else
     {
+      phaseStats.add(PHASE_FETCH, lapUs());
+
       if(handler->getState() != atools::fs::sc::STATEOK)
       {
         // Error fetching data from simconnect ============================================
@@ -440,14 +501,18 @@ void DataReaderThread::run()
 
     unsigned long sleepMs = 500;
     if(loadReplayFile != nullptr)
-      sleepMs = static_cast<unsigned long>(static_cast<float>(replayUpdateRateMs) /
-                                           static_cast<float>(replaySpeed));
+      sleepMs = std::max(REPLAY_MIN_SLEEP_MS, static_cast<unsigned long>(static_cast<float>(replayUpdateRateMs) /
+                                                                         static_cast<float>(replaySpeed)));
     else
       sleepMs = updateRate;
 
+    phaseStats.add(PHASE_BUSY, busyTimer.nsecsElapsed() / 1000);
+
+    phaseTimer.start();
     bool wakeUpSignalled = waitCondition.wait(&waitMutex, sleepMs);
+    phaseStats.add(PHASE_SLEEP, lapUs());
     if(wakeUpSignalled && verbose)
-      qDebug() << "DataReaderThread::run wakeUpSignalled";
+      ATOOLS_DEBUG() << "DataReaderThread::run wakeUpSignalled";
   }
 
   closeReplay();
@@ -470,7 +535,7 @@ void DataReaderThread::run()
 bool DataReaderThread::fetchData(atools::fs::sc::SimConnectData& data, int radiusKm, Options fetchOptions)
 {
   if(verbose)
-    qDebug() << Q_FUNC_INFO << "enter";
+    ATOOLS_DEBUG() << Q_FUNC_INFO << "enter";
 
   if(!handler->isLoaded())
     return true;
@@ -484,7 +549,7 @@ bool DataReaderThread::fetchData(atools::fs::sc::SimConnectData& data, int radiu
   if(weatherRequested)
   {
     if(verbose)
-      qDebug() << "DataReaderThread::fetchData weather";
+      ATOOLS_DEBUG() << "DataReaderThread::fetchData weather";
 
     handler->fetchWeatherData(data);
 
@@ -497,7 +562,7 @@ bool DataReaderThread::fetchData(atools::fs::sc::SimConnectData& data, int radiu
   else
   {
     if(verbose)
-      qDebug() << "DataReaderThread::fetchData nextPacketId" << nextPacketId;
+      ATOOLS_DEBUG() << "DataReaderThread::fetchData nextPacketId" << nextPacketId;
 
     retval = handler->fetchData(data, radiusKm, fetchOptions);
     data.setPacketId(nextPacketId++);
@@ -507,7 +572,7 @@ bool DataReaderThread::fetchData(atools::fs::sc::SimConnectData& data, int radiu
 
   if(verbose)
     if(weatherRequested && !data.getMetars().isEmpty())
-      qDebug() << "Weather requested and found";
+      ATOOLS_DEBUG() << "Weather requested and found";
 
   if(weatherRequested && data.getMetars().isEmpty())
     qWarning() << "Weather requested but noting found";
@@ -515,11 +580,58 @@ bool DataReaderThread::fetchData(atools::fs::sc::SimConnectData& data, int radiu
   handler->addWeatherRequest(WeatherRequest());
 
   if(verbose)
-    qDebug() << Q_FUNC_INFO << "leave";
+    ATOOLS_DEBUG() << Q_FUNC_INFO << "leave";
 
   return retval;
 }
 
+void DataReaderThread::applyAiLevelOfDetail(atools::fs::sc::SimConnectData& data)
+{
+  const atools::geo::Pos& userPos = data.getUserAircraftConst().getPosition();
+  QList<SimConnectAircraft>& aiAircraft = data.getAiAircraft();
+
+  if(!userPos.isValid() || aiAircraft.isEmpty())
+  {
+    aiLastSent.clear();
+    return;
+  }
+
+  qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+  // Rebuild state to drop aircraft which disappeared
+  QHash<int, AiLastSent> sent;
+  sent.reserve(aiAircraft.size());
+
+  int numRepeated = 0;
+  for(SimConnectAircraft& aircraft : aiAircraft)
+  {
+    int id = aircraft.getId();
+    float distanceKm = userPos.distanceMeterTo(aircraft.getPosition()) / 1000.f;
+
+    qint64 intervalMs = 0;
+    if(distanceKm > AI_LOD_FAR_KM)
+      intervalMs = AI_LOD_FAR_INTERVAL_MS;
+    else if(distanceKm > AI_LOD_NEAR_KM)
+      intervalMs = AI_LOD_MEDIUM_INTERVAL_MS;
+
+    auto it = aiLastSent.constFind(id);
+    if(intervalMs > 0 && it != aiLastSent.constEnd() && now - it->timestampMs < intervalMs)
+    {
+      // Not due yet - repeat last state
+      aircraft = it->aircraft;
+      sent.insert(id, it.value());
+      numRepeated++;
+    }
+    else
+      sent.insert(id, {now, aircraft});
+  }
+
+  aiLastSent.swap(sent);
+
+  if(verbose)
+    ATOOLS_DEBUG() << Q_FUNC_INFO << "AI aircraft" << aiAircraft.size() << "repeated" << numRepeated;
+}
+
 void DataReaderThread::setupReplay()
 {
   if(!loadReplayFilepath.isEmpty())
@@ -550,13 +662,15 @@ void DataReaderThread::setupReplay()
           closeReplay();
           return;
         }
-        if(version != REPLAY_FILE_VERSION)
+        if(version != REPLAY_FILE_VERSION && version != REPLAY_FILE_VERSION_NO_INDEX)
         {
           emit postLogMessage(tr("Cannot open \"%1\". Wrong version.").arg(loadReplayFilepath), false, true);
           closeReplay();
           return;
         }
 
+        setupReplayIndex(version);
+
         emit postLogMessage(tr("Replaying from \"%1\".").arg(loadReplayFilepath), false, false);
         emit connectedToSimulator();
       }
@@ -584,14 +698,127 @@ void DataReaderThread::setupReplay()
       // Save file header
       QDataStream out(saveReplayFile);
       out << REPLAY_FILE_MAGIC_NUMBER << REPLAY_FILE_VERSION << static_cast<quint32>(updateRate);
+      replayIndex.clear();
     }
   }
 }
 
+void DataReaderThread::setupReplayIndex(quint32 version)
+{
+  qint64 size = loadReplayFile->size();
+  replayIndex.clear();
+  replayDataEnd = size;
+
+  // Read from memory if possible
+  replayMap = loadReplayFile->map(0, size);
+  if(replayMap != nullptr)
+  {
+    replayBuffer = new QBuffer;
+    replayBuffer->setData(QByteArray::fromRawData(reinterpret_cast<const char *>(replayMap), size));
+    replayBuffer->open(QIODevice::ReadOnly);
+    replayDevice = replayBuffer;
+  }
+  else
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot map" << loadReplayFilepath << loadReplayFile->errorString();
+    replayDevice = loadReplayFile;
+  }
+
+  if(version == REPLAY_FILE_VERSION && size >= REPLAY_FILE_DATA_START_OFFSET + REPLAY_INDEX_TRAILER_SIZE)
+  {
+    replayDevice->seek(size - REPLAY_INDEX_TRAILER_SIZE);
+    QDataStream in(replayDevice);
+    in.setVersion(QDataStream::Qt_5_5);
+
+    quint32 numEntries, magicNumber;
+    qint64 indexOffset;
+    in >> numEntries >> indexOffset >> magicNumber;
+
+    const qint64 entrySize = sizeof(quint32) + sizeof(qint64);
+    if(magicNumber == REPLAY_INDEX_MAGIC_NUMBER && indexOffset >= REPLAY_FILE_DATA_START_OFFSET &&
+       indexOffset + numEntries * entrySize + REPLAY_INDEX_TRAILER_SIZE == size)
+    {
+      replayDevice->seek(indexOffset);
+      replayIndex.reserve(numEntries);
+      for(quint32 i = 0; i < numEntries; i++)
+      {
+        ReplayIndexEntry entry;
+        in >> entry.timestamp >> entry.offset;
+        replayIndex.append(entry);
+      }
+      replayDataEnd = indexOffset;
+    }
+    else
+      // File was not closed properly
+      qWarning() << Q_FUNC_INFO << "No valid index in" << loadReplayFilepath;
+  }
+
+  qDebug() << Q_FUNC_INFO << loadReplayFilepath << "index entries" << replayIndex.size() << "data end" << replayDataEnd
+           << (replayMap != nullptr ? "mapped" : "not mapped");
+
+  replayDevice->seek(REPLAY_FILE_DATA_START_OFFSET);
+}
+
+void DataReaderThread::writeReplayIndex()
+{
+  qint64 indexOffset = saveReplayFile->pos();
+
+  QDataStream out(saveReplayFile);
+  out.setVersion(QDataStream::Qt_5_5);
+  for(const ReplayIndexEntry& entry : std::as_const(replayIndex))
+    out << entry.timestamp << entry.offset;
+  out << static_cast<quint32>(replayIndex.size()) << indexOffset << REPLAY_INDEX_MAGIC_NUMBER;
+
+  replayIndex.clear();
+}
+
+void DataReaderThread::seekReplayInternal(int seconds)
+{
+  if(replayIndex.isEmpty())
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot seek. No index in" << loadReplayFilepath;
+    return;
+  }
+
+  // Find last entry before or at the time
+  quint32 timestamp = replayIndex.constFirst().timestamp + static_cast<quint32>(seconds);
+  auto it = std::upper_bound(replayIndex.constBegin(), replayIndex.constEnd(), timestamp,
+                             [](quint32 ts, const ReplayIndexEntry& entry) -> bool {
+          return ts < entry.timestamp;
+        });
+  replayDevice->seek((--it)->offset);
+}
+
+bool DataReaderThread::skipReplayBlock()
+{
+  const qint64 headerSize = sizeof(quint32) * 2;
+  if(replayDevice->pos() + headerSize > replayDataEnd)
+    return false;
+
+  // Block starts with magic number and size of the remaining block
+  QDataStream in(replayDevice);
+  in.setVersion(QDataStream::Qt_5_5);
+  quint32 magicNumber, size;
+  in >> magicNumber >> size;
+
+  qint64 next = replayDevice->pos() + size;
+  if(next > replayDataEnd)
+  {
+    // Truncated block
+    replayDevice->seek(replayDataEnd);
+    return false;
+  }
+
+  replayDevice->seek(next);
+  return next < replayDataEnd;
+}
+
 void DataReaderThread::closeReplay()
 {
   if(saveReplayFile != nullptr)
   {
+    if(saveReplayFile->isOpen())
+      writeReplayIndex();
     saveReplayFile->close();
     delete saveReplayFile;
     saveReplayFile = nullptr;
@@ -599,6 +826,19 @@ void DataReaderThread::closeReplay()
 
   if(loadReplayFile != nullptr)
   {
+    delete replayBuffer;
+    replayBuffer = nullptr;
+    replayDevice = nullptr;
+
+    if(replayMap != nullptr)
+    {
+      loadReplayFile->unmap(replayMap);
+      replayMap = nullptr;
+    }
+
+    replayIndex.clear();
+    replayDataEnd = 0;
+
     loadReplayFile->close();
     delete loadReplayFile;
     loadReplayFile = nullptr;
@@ -18,14 +18,19 @@
 #ifndef LITTLENAVCONNECT_DATAREADERTHREAD_H
 #define LITTLENAVCONNECT_DATAREADERTHREAD_H
 
+#include "fs/sc/datareaderstats.h"
 #include "fs/sc/simconnectdata.h"
 #include "fs/sc/simconnectreply.h"
 
+#include <QHash>
 #include <QMutex>
 #include <QThread>
 #include <QWaitCondition>
 
+#include <functional>
+
 class QFile;
+class QBuffer;
 
 namespace atools {
 namespace fs {
@@ -98,11 +103,19 @@ public:
     loadReplayFilepath = value;
   }
 
+  /* Blocks are skipped without parsing if speed is too high to send all packets */
   void setReplaySpeed(int value)
   {
     replaySpeed = std::max(1, value);
   }
 
+  /* Jump to the position in the replay file which is seconds after the first packet on the next iteration.
+   * Needs a replay file with index. Uses the closest index entry before the time. */
+  void seekReplay(int seconds)
+  {
+    replaySeekSeconds = std::max(0, seconds);
+  }
+
   /* Save and update whazzup file during replay only. */
   void setReplayWhazzupFile(const QString& filename)
   {
@@ -134,6 +147,25 @@ public:
     aiFetchRadiusKm = radiusKm;
   }
 
+  /* Send AI aircraft far away from the user aircraft less often. The last sent state is repeated in between which
+   * is sent as unchanged by the delta protocol. Aircraft are never dropped from packets. Disabled by default. */
+  void setAiLevelOfDetail(bool value)
+  {
+    aiLevelOfDetail = value;
+  }
+
+  /* Rolling time statistics of the phases in the main loop like fetching, replay and sleeping as JSON.
+   * See DataReaderStats::toJson(). Thread safe. */
+  QJsonObject getPhaseStatistics() const
+  {
+    return phaseStats.toJson();
+  }
+
+  void clearPhaseStatistics()
+  {
+    phaseStats.clear();
+  }
+
   /* What type of handler is set now */
   bool isSimConnectHandler();
   bool isXplaneHandler();
@@ -143,6 +175,14 @@ public:
     return handler;
   }
 
+  /* Called in this thread with the user aircraft of each data package before it is posted.
+   * Allows consumers like AircraftPerfHandler::addSample() to get all samples without a queued signal.
+   * Has to be set before the thread is started and must not block. */
+  void setUserAircraftCallback(const std::function<void(const atools::fs::sc::SimConnectUserAircraft&)>& callback)
+  {
+    userAircraftCallback = callback;
+  }
+
 signals:
   /* Send on each received data package from the simconnect interface */
   void postSimConnectData(atools::fs::sc::SimConnectData dataPacket);
@@ -163,13 +203,28 @@ private:
   void connectToSimulator();
   virtual void run() override;
   void setupReplay();
+
+  /* Map file into memory and read index from end of file if version has one */
+  void setupReplayIndex(quint32 version);
+  void writeReplayIndex();
+
+  /* Move replay device to index entry before seconds after start */
+  void seekReplayInternal(int seconds);
+
+  /* Skip the next data block without parsing. Returns false if end of data reached. */
+  bool skipReplayBlock();
   bool fetchData(atools::fs::sc::SimConnectData& data, int radiusKm, atools::fs::sc::Options fetchOptions);
 
+  /* Replace AI aircraft which are not due for an update depending on distance with the last sent state */
+  void applyAiLevelOfDetail(atools::fs::sc::SimConnectData& data);
+
   /* Updates whazzup.txt file in given folder during replay */
   void debugWriteWhazzup(const atools::fs::sc::SimConnectData& dataPacket);
 
   atools::fs::sc::ConnectHandler *handler = nullptr;
 
+  std::function<void(const atools::fs::sc::SimConnectUserAircraft&)> userAircraftCallback;
+
   /* Have to protect options since they will be modified from outside the thread */
   std::atomic<atools::fs::sc::Options> options;
 
@@ -178,19 +233,68 @@ private:
   * given and it exceeds the maximum allowed (200000 meters, or 200 Km). */
   int aiFetchRadiusKm = 200; // around 105 NM
 
+  /* Distance bands and minimum update intervals for AI level of detail. Full rate below near distance. */
+  const float AI_LOD_NEAR_KM = 30.f, AI_LOD_FAR_KM = 100.f;
+  const qint64 AI_LOD_MEDIUM_INTERVAL_MS = 2000, AI_LOD_FAR_INTERVAL_MS = 5000;
+
+  /* Last sent state and time in milliseconds since epoch for AI aircraft by object id */
+  struct AiLastSent
+  {
+    qint64 timestampMs;
+    atools::fs::sc::SimConnectAircraft aircraft;
+  };
+
+  QHash<int, AiLastSent> aiLastSent;
+  std::atomic_bool aiLevelOfDetail{false};
+
+  /* Phase times of the main loop */
+  atools::fs::sc::DataReaderStats phaseStats;
+
   int numErrors = 0;
   const int MAX_NUMBER_OF_ERRORS = 10;
 
   const quint32 REPLAY_FILE_MAGIC_NUMBER = 0XCACF4F27;
-  const quint32 REPLAY_FILE_VERSION = 1;
+
+  /* Version 2 adds an index at the end of the file */
+  const quint32 REPLAY_FILE_VERSION = 2;
+  const quint32 REPLAY_FILE_VERSION_NO_INDEX = 1;
   const int REPLAY_FILE_DATA_START_OFFSET = sizeof(REPLAY_FILE_MAGIC_NUMBER) + sizeof(REPLAY_FILE_VERSION) +
                                             sizeof(quint32);
 
+  /* Index trailer: entries, quint32 number of entries, qint64 index offset and magic number */
+  const quint32 REPLAY_INDEX_MAGIC_NUMBER = 0XCACF4F28;
+  const int REPLAY_INDEX_TRAILER_SIZE = sizeof(quint32) + sizeof(qint64) + sizeof(quint32);
+
+  /* Add index entry for this interval */
+  const int REPLAY_INDEX_INTERVAL_SECONDS = 10;
+
+  /* Do not sleep shorter than this for high replay speeds and skip blocks instead */
+  const unsigned long REPLAY_MIN_SLEEP_MS = 50;
+
+  /* Packet timestamp in seconds since epoch and file offset for the start of a data block */
+  struct ReplayIndexEntry
+  {
+    quint32 timestamp;
+    qint64 offset;
+  };
+
   QString saveReplayFilepath, loadReplayFilepath, replayWhazzupFile;
   int replaySpeed = 1, whazzupUpdateSeconds = 15;
   QFile *saveReplayFile = nullptr, *loadReplayFile = nullptr;
   quint32 replayUpdateRateMs = 500;
 
+  /* Data is read from this which is either a buffer on the mapped file or the file itself */
+  QIODevice *replayDevice = nullptr;
+  QBuffer *replayBuffer = nullptr;
+  uchar *replayMap = nullptr;
+
+  /* Index read or collected while saving */
+  QList<ReplayIndexEntry> replayIndex;
+
+  /* End of data blocks which is the start of the index if present */
+  qint64 replayDataEnd = 0;
+  std::atomic_int replaySeekSeconds{-1};
+
   bool terminate = false, verbose = false, failedTerminally = false;
   unsigned int updateRate = 500;
   int reconnectRateSec = 10;
@@ -35,9 +35,14 @@
 #include <QDebug>
 #include <QCoreApplication>
 #include <QThread>
+#include <QThreadPool>
+#include <QElapsedTimer>
 #include <QRegularExpression>
 #include <QFile>
 
+#include <atomic>
+#include <exception>
+
 namespace atools {
 namespace fs {
 namespace sc {
@@ -103,6 +108,86 @@ const static SIMCONNECT_DATA_REQUEST_ID FACILITY_DATA_WAYPOINT_REQUEST_ID = 4000
 // Do no send progress updates more often than this
 const static qint64 UPDATE_RATE_MS = 2000;
 
+// Minimum number of facility requests in flight
+const static int MIN_REQUESTS_IN_FLIGHT = 50;
+
+// Halve number of requests in flight if no response arrived within this time
+const static qint64 SLOW_RESPONSE_MS = 2000;
+
+// ====================================================================================================================
+// FetchThrottle ======================================================================================================
+// ====================================================================================================================
+/*
+ * Adaptive flow control for facility requests replacing a fixed delay between dispatch calls.
+ *
+ * Keeps up to getWindow() requests in flight. Dispatches again without delay while responses arrive and backs off
+ * exponentially up to the configured fetch delay if the simulator is idle. The window is halved on SimConnect
+ * exceptions or if responses take longer than SLOW_RESPONSE_MS and grows again slowly while the simulator keeps up.
+ */
+class FetchThrottle
+{
+public:
+  FetchThrottle(int maxWindowParam, unsigned long maxDelayMsParam)
+    : maxWindow(std::max(MIN_REQUESTS_IN_FLIGHT, maxWindowParam)), window(maxWindow), maxDelayMs(maxDelayMsParam)
+  {
+    timer.start();
+  }
+
+  /* Maximum number of requests to keep in flight */
+  int getWindow() const
+  {
+    return window;
+  }
+
+  /* Call after each dispatch with the total numbers of completed and failed requests. Sleeps if nothing arrived. */
+  void update(int completed, int exceptions)
+  {
+    if(exceptions > lastExceptions)
+    {
+      // Simulator is under pressure - reduce requests and wait longest
+      shrink();
+      delayMs = maxDelayMs;
+      lastExceptions = exceptions;
+    }
+
+    if(completed + exceptions > lastDone)
+    {
+      // Responses arrived - poll again immediately and grow slowly
+      lastDone = completed + exceptions;
+      delayMs = 0;
+      window = std::min(maxWindow, window + std::max(1, window / 16));
+      timer.start();
+    }
+    else
+    {
+      if(timer.elapsed() > SLOW_RESPONSE_MS)
+      {
+        shrink();
+        timer.start();
+      }
+
+      delayMs = delayMs == 0 ? 1 : std::min(maxDelayMs, delayMs * 2);
+      QThread::msleep(delayMs);
+    }
+  }
+
+  int getNumBackoff() const
+  {
+    return numBackoff;
+  }
+
+private:
+  void shrink()
+  {
+    window = std::max(MIN_REQUESTS_IN_FLIGHT, window / 2);
+    numBackoff++;
+  }
+
+  QElapsedTimer timer;
+  int maxWindow, window, lastDone = 0, lastExceptions = 0, numBackoff = 0;
+  unsigned long maxDelayMs, delayMs = 0;
+};
+
 // ====================================================================================================================
 // SimConnectLoaderPrivate ============================================================================================
 // Keeps SimConnect types out of the header file
@@ -122,10 +207,14 @@ public:
       throw atools::Exception("Error binding functions.");
     else
       writer = new SimConnectWriter(sqlDb, opts);
+
+    // One thread only to keep the order of writes
+    writerPool.setMaxThreadCount(1);
   }
 
   ~SimConnectLoaderPrivate()
   {
+    writerPool.waitForDone();
     ATOOLS_DELETE_LOG(writer);
     ATOOLS_DELETE_LOG(api);
   }
@@ -223,6 +312,13 @@ public:
   // Call writer and write all airports from the airportFacilities to the database. airportFacilities is not consumed
   bool writeAirportsToDatabase();
 
+  // Hand off all airports from airportFacilities to the writer thread which writes them to the database.
+  // Loading can continue while the writer is busy. airportFacilities is empty afterwards.
+  bool writeAirportsToDatabaseAsync();
+
+  // Wait until the writer thread is done and collect errors. Rethrows exceptions from the writer thread.
+  bool waitForWriter();
+
   // Write all waypointFacilities (and routes), vorFacilities (and ILS) and ndbFacilities to the database
   bool writeNavaidsToDatabase();
 
@@ -311,6 +407,14 @@ public:
   // Database writer - called after fetching all types
   atools::fs::sc::db::SimConnectWriter *writer = nullptr;
 
+  // Runs writer for airports in background. Only the writer thread accesses the database while writingAsync is true.
+  QThreadPool writerPool;
+  std::atomic_bool writingAsync = false;
+  std::exception_ptr writerException;
+
+  // Airports consumed by the writer thread
+  QHash<IcaoId, Airport> airportFacilitiesWriting;
+
   SimConnectLoaderProgressCallback progressCallback = nullptr;
   int progressCounter = 0; // Counter for dot animation
   QString lastMessage; // Repeat last message when calling  callProgressUpdate()
@@ -320,13 +424,15 @@ public:
   QElapsedTimer timer;
 
   bool verbose = false,
-       facilityListFetched = false, // used in requestAirportList() to detect end of call
-       aborted = false;
+       facilityListFetched = false; // used in requestAirportList() to detect end of call
+
+  // Read by the writer thread
+  std::atomic_bool aborted = false;
 
   // Currently loaded but not written yet features
   int airportsLoaded = 0, waypointsLoaded = 0, vorLoaded = 0, ilsLoaded = 0, ndbLoaded = 0;
 
-  int facilitiesFetchedBatch = 0, // Counter to detect end of batch
+  int facilitiesFetchedBatch = 0, // Counter of responses to detect number of requests in flight
       batchSize = 2000, fileId = 0, numException = 0;
 
   unsigned long airportFetchDelay = 50, navaidFetchDelay = 50;
@@ -653,12 +759,8 @@ bool SimConnectLoaderPrivate::loadAirports()
     return true;
 
   if(!aborted)
-  {
-    // Write all into the database - consumes records from airportFacilities
-    aborted = writer->writeAirportsToDatabase(airportFacilities, fileId);
-    errors.append(writer->getErrors());
-    airportFacilities.clear();
-  }
+    // Write all into the database in background while navaids are requested - consumes records from airportFacilities
+    aborted = writeAirportsToDatabaseAsync();
   return aborted;
 }
 
@@ -737,8 +839,61 @@ bool SimConnectLoaderPrivate::writeAirportsToDatabase()
   return aborted;
 }
 
+bool SimConnectLoaderPrivate::writeAirportsToDatabaseAsync()
+{
+  qDebug() << Q_FUNC_INFO << airportFacilities.size();
+
+  if(waitForWriter())
+    return true;
+
+  // Report progress step here since writer does not call the callback from its thread
+  if((aborted = callProgress(SimConnectLoader::tr("Writing airport facilities to database"))))
+    return true;
+
+  airportFacilitiesWriting = std::move(airportFacilities);
+  airportFacilities.clear();
+
+  writingAsync = true;
+  writerPool.start([this]() {
+        try
+        {
+          // Transaction for the whole batch is committed in the writer
+          writer->writeAirportsToDatabase(airportFacilitiesWriting, fileId);
+        }
+        catch(...)
+        {
+          writerException = std::current_exception();
+        }
+      });
+
+  return aborted;
+}
+
+bool SimConnectLoaderPrivate::waitForWriter()
+{
+  if(writingAsync)
+  {
+    writerPool.waitForDone();
+    writingAsync = false;
+    errors.append(writer->getErrors());
+    airportFacilitiesWriting.clear();
+
+    if(writerException)
+    {
+      std::exception_ptr exception = writerException;
+      writerException = nullptr;
+      std::rethrow_exception(exception);
+    }
+  }
+  return aborted;
+}
+
 bool SimConnectLoaderPrivate::writeNavaidsToDatabase()
 {
+  // Navaids need runway references from airports for ILS
+  if(waitForWriter())
+    return true;
+
   qDebug() << Q_FUNC_INFO << "Waypoints" << waypointFacilities.size() << "VOR" << vorFacilities.size() << "NDB"
            << ndbFacilities.size();
   if(!aborted)
@@ -856,6 +1011,10 @@ bool SimConnectLoaderPrivate::requestAirports(FacilityDataDefinitionId definitio
 
   currentFacilityDefinition = definitionId;
 
+  // Counts incremented by SIMCONNECT_RECV_ID_FACILITY_DATA_END or SIMCONNECT_RECV_ID_EXCEPTION
+  facilitiesFetchedBatch = numException = 0;
+  FetchThrottle throttle(batchSize, airportFetchDelay);
+
   int requested = 0;
   int size = airportIds.size();
   for(int i = 0; i < size && !aborted; i++)
@@ -923,33 +1082,25 @@ bool SimConnectLoaderPrivate::requestAirports(FacilityDataDefinitionId definitio
       requested++;
     }
 
-    // Keep calling RequestFacilityData facility data until batch size matches or last call is done
-    if(((i % batchSize) == 0 && i > 0) || i == size - 1)
+    // Keep calling RequestFacilityData until the window is full - wait for all responses after the last call
+    int maxInFlight = i == size - 1 ? 1 : throttle.getWindow();
+    while(requested - facilitiesFetchedBatch - numException >= maxInFlight && !aborted)
     {
-      // Fetch airport details now
-      // Counts incremented by SIMCONNECT_RECV_ID_FACILITY_DATA_END or SIMCONNECT_RECV_ID_EXCEPTION
-      facilitiesFetchedBatch = numException = 0;
-
-      while(facilitiesFetchedBatch + numException < requested && !aborted)
-      {
-        callProgressUpdate();
-        if(aborted)
-          return true;
+      callProgressUpdate();
+      if(aborted)
+        return true;
 
-        hr = api->CallDispatch(dispatchFunction, this);
-        if(hr != S_OK)
-          throw atools::Exception("Error in CallDispatch for airports");
+      hr = api->CallDispatch(dispatchFunction, this);
+      if(hr != S_OK)
+        throw atools::Exception("Error in CallDispatch for airports");
 
-        QThread::msleep(airportFetchDelay);
-      }
-      requested = 0;
-
-#ifdef DEBUG_INFORMATION
-      qDebug() << Q_FUNC_INFO << i << definitionId;
-#endif
+      throttle.update(facilitiesFetchedBatch, numException);
     }
   }
 
+  qDebug() << Q_FUNC_INFO << definitionId << "requested" << requested << "window" << throttle.getWindow()
+           << "backoff" << throttle.getNumBackoff();
+
   requests.clear();
 
   return aborted;
@@ -960,6 +1111,10 @@ bool SimConnectLoaderPrivate::requestNavaids(bool fetchRoutes)
   if(aborted)
     return true;
 
+  // Counts incremented by SIMCONNECT_RECV_ID_FACILITY_DATA_END or SIMCONNECT_RECV_ID_EXCEPTION
+  facilitiesFetchedBatch = numException = 0;
+  FetchThrottle throttle(batchSize, navaidFetchDelay);
+
   int requested = 0;
   int i = 0;
   while(!navaidIds.isEmpty() && !aborted)
@@ -1004,35 +1159,28 @@ bool SimConnectLoaderPrivate::requestNavaids(bool fetchRoutes)
     navaidIdsRequested.insert(id);
     requested++;
 
-    // Keep calling RequestFacilityData facility data until batch size matches or last call is done
-    if(((i % batchSize) == 0 && i > 0) || navaidIds.isEmpty())
+    // Keep calling RequestFacilityData until the window is full - wait for all responses if the queue is empty.
+    // Responses can add more navaids found on routes to the queue.
+    int maxInFlight = navaidIds.isEmpty() ? 1 : throttle.getWindow();
+    while(requested - facilitiesFetchedBatch - numException >= maxInFlight && !aborted)
     {
-      // Fetch airport details now
-      // Counts incremented by SIMCONNECT_RECV_ID_FACILITY_DATA_END or SIMCONNECT_RECV_ID_EXCEPTION
-      facilitiesFetchedBatch = numException = 0;
+      callProgressUpdate();
+      if(aborted)
+        return true;
 
-      while(facilitiesFetchedBatch + numException < requested && !aborted)
-      {
-        callProgressUpdate();
-        if(aborted)
-          return true;
+      HRESULT hr = api->CallDispatch(dispatchFunction, this);
+      if(hr != S_OK)
+        throw atools::Exception("Error in CallDispatch for navaids");
 
-        HRESULT hr = api->CallDispatch(dispatchFunction, this);
-        if(hr != S_OK)
-          throw atools::Exception("Error in CallDispatch for navaids");
-
-        QThread::msleep(navaidFetchDelay);
-      }
-      requested = 0;
-
-#ifdef DEBUG_INFORMATION
-      qDebug() << Q_FUNC_INFO << navaidIds.size();
-#endif
+      throttle.update(facilitiesFetchedBatch, numException);
     }
 
     i++;
   }
 
+  qDebug() << Q_FUNC_INFO << "requested" << requested << "window" << throttle.getWindow()
+           << "backoff" << throttle.getNumBackoff();
+
   requests.clear();
 
   return aborted;
@@ -1833,6 +1981,7 @@ bool SimConnectLoader::prepareLoading(bool loadFacilityDefinitions, bool initSql
 bool SimConnectLoader::finishLoading()
 {
 #if !defined(SIMCONNECT_BUILD_WIN32)
+  p->waitForWriter();
   p->writer->deInitQueries();
   p->clear();
   HRESULT hr = p->api->Close();
@@ -1872,6 +2021,7 @@ int SimConnectLoader::getNumSteps() const
 bool SimConnectLoader::isAborted() const
 {
 #if !defined(SIMCONNECT_BUILD_WIN32)
+  p->waitForWriter();
   return p->aborted;
 #else
   return false;
@@ -1891,6 +2041,8 @@ const QStringList& SimConnectLoader::getErrors() const
 {
   const static QStringList EMPTY;
 #if !defined(SIMCONNECT_BUILD_WIN32)
+  // Collect errors from writer thread
+  p->waitForWriter();
   return p->errors;
 #else
   return EMPTY;
@@ -1911,7 +2063,9 @@ void SimConnectLoader::setProgressCallback(const SimConnectLoaderProgressCallbac
 #if !defined(SIMCONNECT_BUILD_WIN32)
   p->progressCallback = callback;
   p->writer->setProgressCallback([ = ](const QString& message, bool incProgress)->bool {
-            p->aborted = p->callProgress(message, incProgress);
+            // Callback is not thread safe - only pass abort state if called from writer thread
+            if(!p->writingAsync)
+              p->aborted = p->callProgress(message, incProgress);
             return p->aborted;
           });
 #else
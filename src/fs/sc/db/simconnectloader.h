@@ -98,8 +98,8 @@ public:
   /* Progress callback returned true */
   bool isAborted() const;
 
-  /* Set batch size that is used to fetch facilities.
-   * The program reads until the batch size is exceeded and then calls the dispatch function until done. */
+  /* Set maximum number of facility requests in flight.
+   * The number is reduced automatically if the simulator responds slowly or with exceptions. */
   void setBatchSize(int value);
 
   /* Process failed and loading is probably incomplete if errors are returned. */
@@ -117,7 +117,8 @@ public:
   /* Progress callback called before writing a batch to the database. Return true to abort loading. */
   void setProgressCallback(const SimConnectLoaderProgressCallback& callback);
 
-  /* Delay in milliseconds between CallDispatch calls */
+  /* Maximum delay in milliseconds between CallDispatch calls if no responses arrive.
+   * There is no delay while the simulator keeps responding. */
   void setAirportFetchDelay(int delayMs);
   void setNavaidFetchDelay(int delayMs);
 
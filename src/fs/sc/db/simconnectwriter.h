@@ -78,6 +78,9 @@ typedef std::function<bool (const QString& message, bool incProgress)> SimConnec
  *
  * Note that methods have to be called in order writeAirportsToDatabase(), writeWaypointsAndAirwaysToDatabase(),
  * writeVorAndIlsToDatabase() and writeNdbToDatabase() to ensure correct runway/ILS matching.
+ *
+ * SimConnectLoader calls writeAirportsToDatabase() in a writer thread while it keeps requesting navaids.
+ * Calls are never concurrent and the database is not used by other threads while writing.
  */
 class SimConnectWriter
 {
@@ -0,0 +1,227 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/sc/loadtesthandler.h"
+
+#include "fs/sc/simconnectdata.h"
+#include "geo/calculations.h"
+
+#include <QDebug>
+
+#include <cmath>
+
+namespace atools {
+namespace fs {
+namespace sc {
+
+LoadTestHandler::LoadTestHandler(const LoadTestOptions& loadTestOptions)
+  : opts(loadTestOptions)
+{
+}
+
+LoadTestHandler::~LoadTestHandler()
+{
+}
+
+bool LoadTestHandler::connect()
+{
+  random.seed(opts.seed != 0 ? opts.seed : std::random_device()());
+
+  // User aircraft is first in list
+  flights.clear();
+  for(int i = 0; i <= opts.numAiAircraft; i++)
+  {
+    Flight flight;
+    flight.position = randomPos();
+    flight.registration = QStringLiteral("LT%1").arg(i, 5, 10, QChar('0'));
+    newDestination(flight);
+    flights.append(flight);
+  }
+
+  timer.start();
+  state = STATEOK;
+
+  qInfo() << Q_FUNC_INFO << "Load test with" << opts.numAiAircraft << "AI aircraft within" << opts.radiusNm << "NM of"
+          << opts.center.toString() << "seed" << opts.seed;
+  return true;
+}
+
+bool LoadTestHandler::fetchData(SimConnectData& data, int radiusKm, Options options)
+{
+  Q_UNUSED(radiusKm)
+
+  if(state != STATEOK || flights.isEmpty())
+    return false;
+
+  // Move all aircraft in real time
+  float seconds = timer.restart() / 1000.f;
+  for(Flight& flight : flights)
+    move(flight, seconds);
+
+  // Fetch time is used by clients to measure latency
+  QDateTime now = QDateTime::currentDateTimeUtc();
+  SimConnectUserAircraft& userAircraft = data.getUserAircraft();
+  fillAircraft(userAircraft, flights.constFirst(), 0);
+  userAircraft.flags |= IS_USER;
+  userAircraft.setDateTime(now.toLocalTime(), now);
+  userAircraft.windSpeedKts = 10.f;
+  userAircraft.windDirectionDegT = 270.f;
+  userAircraft.seaLevelPressureMbar = 1013.25f;
+  userAircraft.ambientTemperatureCelsius = 15.f - atools::geo::feetToMeter(flights.constFirst().altitudeFt) * 0.0065f;
+
+  data.clearAiAircraft();
+  if(options.testFlag(FETCH_AI_AIRCRAFT))
+  {
+    for(int i = 1; i < flights.size(); i++)
+    {
+      SimConnectAircraft aircraft;
+      fillAircraft(aircraft, flights.at(i), i);
+      data.aiAircraft.append(aircraft);
+    }
+  }
+  data.updateIndexesAndKeys();
+  return true;
+}
+
+bool LoadTestHandler::fetchWeatherData(SimConnectData& data)
+{
+  if(state != STATEOK)
+    return false;
+
+  if(opts.weather && weatherRequest.isValid())
+  {
+    weather::Metar metar(weatherRequest.getStation(), weatherRequest.getPosition());
+
+    // Vary wind a bit to get different replies
+    QString station = weatherRequest.getStation().isEmpty() ? QStringLiteral("XXXX") : weatherRequest.getStation();
+    QString metarText = QStringLiteral("%1 %2Z %3%4KT 9999 FEW030 15/08 Q1013").
+                        arg(station).arg(QDateTime::currentDateTimeUtc().toString("ddHHmm")).
+                        arg(static_cast<int>(randomFloat(0.f, 36.f)) * 10, 3, 10, QChar('0')).
+                        arg(static_cast<int>(randomFloat(0.f, 30.f)), 2, 10, QChar('0'));
+
+    if(!metar.getRequestIdent().isEmpty())
+      metar.setMetarForStation(metarText);
+    else
+      metar.setMetarForNearest(metarText);
+    data.metars.append(metar);
+  }
+  return true;
+}
+
+void LoadTestHandler::addWeatherRequest(const WeatherRequest& request)
+{
+  weatherRequest = request;
+}
+
+const WeatherRequest& LoadTestHandler::getWeatherRequest() const
+{
+  return weatherRequest;
+}
+
+bool LoadTestHandler::isLoaded() const
+{
+  return true;
+}
+
+bool LoadTestHandler::isSimRunning() const
+{
+  return state == STATEOK;
+}
+
+bool LoadTestHandler::isSimPaused() const
+{
+  return false;
+}
+
+bool LoadTestHandler::canFetchWeather() const
+{
+  return opts.weather;
+}
+
+State LoadTestHandler::getState() const
+{
+  return state;
+}
+
+QString LoadTestHandler::getName() const
+{
+  return QLatin1String("LoadTest");
+}
+
+float LoadTestHandler::randomFloat(float min, float max)
+{
+  return std::uniform_real_distribution<float>(min, max)(random);
+}
+
+atools::geo::Pos LoadTestHandler::randomPos()
+{
+  // Square root gives equal distribution over the area
+  float distanceNm = opts.radiusNm * std::sqrt(randomFloat(0.f, 1.f));
+  return opts.center.endpoint(atools::geo::nmToMeter(distanceNm), randomFloat(0.f, 360.f));
+}
+
+void LoadTestHandler::newDestination(Flight& flight)
+{
+  flight.destination = randomPos();
+  flight.speedKts = randomFloat(opts.minSpeedKts, opts.maxSpeedKts);
+  flight.altitudeFt = randomFloat(opts.minAltitudeFt, opts.maxAltitudeFt);
+  flight.headingDeg = atools::geo::normalizeCourse(flight.position.angleDegTo(flight.destination));
+}
+
+void LoadTestHandler::move(Flight& flight, float seconds)
+{
+  float distanceMeter = atools::geo::knotsToMeterPerSec(flight.speedKts) * seconds;
+  if(distanceMeter >= flight.position.distanceMeterTo(flight.destination))
+  {
+    // Arrived - continue to a new random point
+    flight.position = flight.destination;
+    newDestination(flight);
+  }
+  else
+  {
+    flight.headingDeg = atools::geo::normalizeCourse(flight.position.angleDegTo(flight.destination));
+    flight.position = flight.position.endpoint(distanceMeter, flight.headingDeg);
+  }
+  flight.position.setAltitude(flight.altitudeFt);
+}
+
+void LoadTestHandler::fillAircraft(SimConnectAircraft& aircraft, const Flight& flight, int index) const
+{
+  aircraft.position = flight.position;
+  aircraft.headingTrueDeg = aircraft.headingMagDeg = flight.headingDeg;
+  aircraft.groundSpeedKts = aircraft.trueAirspeedKts = flight.speedKts;
+  aircraft.indicatedSpeedKts = flight.speedKts * 0.8f;
+  aircraft.indicatedAltitudeFt = flight.altitudeFt;
+  aircraft.machSpeed = flight.speedKts / 600.f;
+
+  aircraft.airplaneTitle = QLatin1String("Load Test Boeing 737-800");
+  aircraft.airplaneType = aircraft.airplaneModel = QLatin1String("B738");
+  aircraft.airplaneAirline = QLatin1String("Load Test");
+  aircraft.airplaneFlightnumber = QString::number(index);
+  aircraft.setAirplaneRegistration(flight.registration);
+
+  aircraft.objectId = static_cast<quint32>(index + 1);
+  aircraft.category = AIRPLANE;
+  aircraft.engineType = JET;
+  aircraft.numberOfEngines = 2;
+  aircraft.wingSpanFt = 113;
+  aircraft.modelRadiusFt = 65;
+}
+
+} // namespace sc
+} // namespace fs
+} // namespace atools
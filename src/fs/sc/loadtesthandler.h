@@ -0,0 +1,128 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_SC_LOADTESTHANDLER_H
+#define ATOOLS_FS_SC_LOADTESTHANDLER_H
+
+#include "fs/sc/connecthandler.h"
+#include "fs/sc/weatherrequest.h"
+#include "geo/pos.h"
+
+#include <QElapsedTimer>
+#include <QList>
+
+#include <random>
+
+namespace atools {
+namespace fs {
+namespace sc {
+
+class SimConnectAircraft;
+
+/* Configuration for LoadTestHandler */
+struct LoadTestOptions
+{
+  /* Number of AI aircraft in each packet */
+  int numAiAircraft = 500;
+
+  /* Aircraft fly between random points within radiusNm around center */
+  atools::geo::Pos center = atools::geo::Pos(8.57f, 50.03f);
+  float radiusNm = 500.f;
+
+  float minSpeedKts = 120.f, maxSpeedKts = 480.f;
+  float minAltitudeFt = 3000.f, maxAltitudeFt = 39000.f;
+
+  /* Answer weather requests with generated METAR. Otherwise replies are empty. */
+  bool weather = true;
+
+  /* Seed for the random generator to get reproducible routes. 0 uses a random seed. */
+  quint32 seed = 0;
+};
+
+/*
+ * Simulator connection which generates traffic for load tests of NavServer without a simulator.
+ *
+ * Moves a user aircraft and a configurable number of AI aircraft along random routes in real time and answers
+ * weather requests with generated METAR. The update rate is set in DataReaderThread::setUpdateRate().
+ *
+ * The zulu time of the user aircraft is set to the time of the fetch with millisecond precision.
+ * Clients like atools::fs::ns::NavServerLoadTest use it to measure the delivery latency.
+ */
+class LoadTestHandler :
+  public atools::fs::sc::ConnectHandler
+{
+public:
+  explicit LoadTestHandler(const atools::fs::sc::LoadTestOptions& loadTestOptions = LoadTestOptions());
+  virtual ~LoadTestHandler() override;
+
+  LoadTestHandler(const LoadTestHandler& other) = delete;
+  LoadTestHandler& operator=(const LoadTestHandler& other) = delete;
+
+  /* Creates aircraft and starts the simulation. Always succeeds. */
+  virtual bool connect() override;
+
+  virtual bool isLoaded() const override;
+
+  /* Moves all aircraft according to the time passed since the last call and fills data */
+  virtual bool fetchData(atools::fs::sc::SimConnectData& data, int radiusKm, atools::fs::sc::Options options) override;
+
+  /* Adds a generated METAR for the last request */
+  virtual bool fetchWeatherData(atools::fs::sc::SimConnectData& data) override;
+
+  virtual void addWeatherRequest(const atools::fs::sc::WeatherRequest& request) override;
+  virtual const atools::fs::sc::WeatherRequest& getWeatherRequest() const override;
+
+  virtual bool isSimRunning() const override;
+  virtual bool isSimPaused() const override;
+  virtual bool canFetchWeather() const override;
+  virtual atools::fs::sc::State getState() const override;
+  virtual QString getName() const override;
+
+  const atools::fs::sc::LoadTestOptions& getOptions() const
+  {
+    return opts;
+  }
+
+private:
+  /* Simulated aircraft flying from position to destination */
+  struct Flight
+  {
+    atools::geo::Pos position, destination;
+    float speedKts, altitudeFt, headingDeg;
+    QString registration;
+  };
+
+  /* Random position within radius around center */
+  atools::geo::Pos randomPos();
+  void newDestination(Flight& flight);
+  void move(Flight& flight, float seconds);
+  void fillAircraft(atools::fs::sc::SimConnectAircraft& aircraft, const Flight& flight, int index) const;
+  float randomFloat(float min, float max);
+
+  atools::fs::sc::LoadTestOptions opts;
+  QList<Flight> flights; /* First is user aircraft */
+  atools::fs::sc::WeatherRequest weatherRequest;
+  atools::fs::sc::State state = DISCONNECTED;
+  QElapsedTimer timer;
+  std::mt19937 random;
+};
+
+} // namespace sc
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_SC_LOADTESTHANDLER_H
@@ -21,6 +21,7 @@
 #include <QDebug>
 #include <QDataStream>
 #include <QRegularExpression>
+#include <QVarLengthArray>
 
 namespace atools {
 namespace fs {
@@ -65,7 +66,23 @@ void SimConnectAircraft::read(QDataStream& in)
 
   in >> lonx >> laty >> altitude >> headingTrueDeg >> headingMagDeg >> groundSpeedKts >> indicatedSpeedKts
   >> verticalSpeedFeetPerMin >> indicatedAltitudeFt >> trueAirspeedKts >> machSpeed >> numberOfEngines
-  >> wingSpanFt >> modelRadiusFt >> deckHeight >> categoryByte >> engineTypeByte >> transponderCode >> properties;
+  >> wingSpanFt >> modelRadiusFt >> deckHeight >> categoryByte >> engineTypeByte >> transponderCode;
+
+  // Properties use the binary layout which is cheaper to unpack than QDataStream
+  quint32 propertiesSize;
+  in >> propertiesSize;
+  if(in.status() == QDataStream::Ok && propertiesSize <= in.device()->bytesAvailable())
+  {
+    QVarLengthArray<char, 1024> propertiesBytes(propertiesSize);
+    if(in.readRawData(propertiesBytes.data(), static_cast<int>(propertiesSize)) == static_cast<int>(propertiesSize))
+    {
+      properties.clear();
+      if(properties.readBinary(propertiesBytes.constData(), propertiesBytes.size()) == -1)
+        qWarning() << Q_FUNC_INFO << "Invalid properties";
+    }
+  }
+  else
+    in.setStatus(QDataStream::ReadCorruptData);
 
   position.setAltitude(altitude);
   position.setLonX(lonx);
@@ -126,7 +143,12 @@ void SimConnectAircraft::write(QDataStream& out) const
       << groundSpeedKts << indicatedSpeedKts << verticalSpeedFeetPerMin
       << indicatedAltitudeFt << trueAirspeedKts << machSpeed
       << numberOfEngines << wingSpanFt << modelRadiusFt << deckHeight
-      << static_cast<quint8>(category) << static_cast<quint8>(engineType) << transponderCode << properties;
+      << static_cast<quint8>(category) << static_cast<quint8>(engineType) << transponderCode;
+
+  QByteArray propertiesBytes;
+  properties.appendBinary(propertiesBytes);
+  out << static_cast<quint32>(propertiesBytes.size());
+  out.writeRawData(propertiesBytes.constData(), static_cast<int>(propertiesBytes.size()));
 }
 
 atools::geo::PosD SimConnectAircraft::getPositionD() const
@@ -43,6 +43,7 @@ namespace sc {
 class SimConnectHandler;
 class SimConnectHandlerPrivate;
 class SimConnectData;
+class LoadTestHandler;
 
 enum Category : quint8
 {
@@ -484,6 +485,7 @@ private:
   friend class atools::fs::sc::SimConnectHandler;
   friend class atools::fs::sc::SimConnectHandlerPrivate;
   friend class atools::fs::sc::SimConnectData;
+  friend class atools::fs::sc::LoadTestHandler;
   friend class xpc::XpConnect;
   friend class xpc::AircraftFileLoader;
   friend class atools::fs::online::OnlinedataManager;
@@ -0,0 +1,171 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/sc/simconnectaircraftstore.h"
+
+#include "fs/sc/simconnectdata.h"
+#include "geo/rect.h"
+
+namespace atools {
+namespace fs {
+namespace sc {
+
+void SimConnectAircraftStore::update(const SimConnectData& data)
+{
+  if(!data.isEmptyReply())
+    update(data.getAiAircraftConst());
+}
+
+void SimConnectAircraftStore::update(const QList<SimConnectAircraft>& aircraftList)
+{
+  generation++;
+  removedIds.clear();
+  slotSeen.fill(false, aircraft.size());
+  int numSeen = 0;
+
+  for(const SimConnectAircraft& ac : aircraftList)
+  {
+    auto it = slotIndex.constFind(ac.getId());
+    if(it == slotIndex.constEnd())
+    {
+      // New aircraft ==================================
+      int slot = aircraft.addObject(ac);
+      slotIndex.insert(ac.getId(), slot);
+      slotGenerations.append(generation);
+      slotSeen.append(true);
+      numSeen++;
+    }
+    else
+    {
+      // Known aircraft - replace in place ==================================
+      int slot = it.value();
+      const SimConnectAircraft& old = aircraft.at(slot);
+      if(old.getPosition() != ac.getPosition() || old.getHeadingDegTrue() != ac.getHeadingDegTrue())
+        slotGenerations[slot] = generation;
+
+      aircraft.updateObject(slot, ac);
+      if(!slotSeen.at(slot))
+      {
+        slotSeen[slot] = true;
+        numSeen++;
+      }
+    }
+  }
+
+  // Remove all not found in this update ==================================
+  if(slotIndex.size() > numSeen)
+  {
+    for(int slot = 0; slot < aircraft.size(); slot++)
+    {
+      if(!slotSeen.at(slot) && !aircraft.isRemoved(slot))
+      {
+        int id = aircraft.at(slot).getId();
+        removedIds.append(id);
+        slotIndex.remove(id);
+        aircraft.removeObject(slot);
+        numRemovedSlots++;
+      }
+    }
+  }
+
+  if(numRemovedSlots > MIN_REMOVED_FOR_COMPACT && numRemovedSlots > aircraft.size() / 2)
+    compact();
+}
+
+void SimConnectAircraftStore::compact()
+{
+  // Keep generations of remaining slots in the same order as updateIndex() does
+  QList<quint32> generations;
+  generations.reserve(aircraft.size() - numRemovedSlots);
+  for(int slot = 0; slot < aircraft.size(); slot++)
+  {
+    if(!aircraft.isRemoved(slot))
+      generations.append(slotGenerations.at(slot));
+  }
+  slotGenerations.swap(generations);
+
+  aircraft.updateIndex();
+  numRemovedSlots = 0;
+
+  slotIndex.clear();
+  slotIndex.reserve(aircraft.size());
+  for(int slot = 0; slot < aircraft.size(); slot++)
+    slotIndex.insert(aircraft.at(slot).getId(), slot);
+}
+
+void SimConnectAircraftStore::clear()
+{
+  aircraft.clearIndex();
+  slotGenerations.clear();
+  slotIndex.clear();
+  slotSeen.clear();
+  removedIds.clear();
+  numRemovedSlots = 0;
+  generation = 0;
+}
+
+const SimConnectAircraft *SimConnectAircraftStore::getById(int id) const
+{
+  auto it = slotIndex.constFind(id);
+  return it != slotIndex.constEnd() ? &aircraft.at(it.value()) : nullptr;
+}
+
+quint32 SimConnectAircraftStore::getGeneration(int id) const
+{
+  auto it = slotIndex.constFind(id);
+  return it != slotIndex.constEnd() ? slotGenerations.at(it.value()) : 0;
+}
+
+void SimConnectAircraftStore::getChangedIds(QList<int>& ids, quint32 sinceGeneration) const
+{
+  for(int slot = 0; slot < aircraft.size(); slot++)
+  {
+    if(slotGenerations.at(slot) > sinceGeneration && !aircraft.isRemoved(slot))
+      ids.append(aircraft.at(slot).getId());
+  }
+}
+
+void SimConnectAircraftStore::getAircraft(QList<const SimConnectAircraft *>& aircraftList) const
+{
+  aircraftList.reserve(aircraftList.size() + slotIndex.size());
+  for(int slot = 0; slot < aircraft.size(); slot++)
+  {
+    if(!aircraft.isRemoved(slot))
+      aircraftList.append(&aircraft.at(slot));
+  }
+}
+
+void SimConnectAircraftStore::getInRadius(QList<const SimConnectAircraft *>& aircraftList, const atools::geo::Pos& pos,
+                                          float radiusMeter) const
+{
+  QList<int> indexes;
+  aircraft.getRadiusIndexes(indexes, pos, radiusMeter);
+  for(int index : std::as_const(indexes))
+    aircraftList.append(&aircraft.at(index));
+}
+
+void SimConnectAircraftStore::getInRect(QList<const SimConnectAircraft *>& aircraftList, const atools::geo::Rect& rect) const
+{
+  QList<int> indexes;
+  aircraft.getInRectIndexes(indexes, rect);
+  for(int index : std::as_const(indexes))
+    aircraftList.append(&aircraft.at(index));
+}
+
+} // namespace sc
+} // namespace fs
+} // namespace atools
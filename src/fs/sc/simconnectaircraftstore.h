@@ -0,0 +1,140 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_SC_SIMCONNECTAIRCRAFTSTORE_H
+#define ATOOLS_FS_SC_SIMCONNECTAIRCRAFTSTORE_H
+
+#include "fs/sc/simconnectaircraft.h"
+#include "geo/spatialindex.h"
+
+#include <QHash>
+
+namespace atools {
+namespace geo {
+class Rect;
+}
+namespace fs {
+namespace sc {
+
+class SimConnectData;
+
+/*
+ * Pool of AI aircraft keyed by simulator object id which is kept across data packets.
+ *
+ * Each packet is merged into the pool by update(). Aircraft already known are replaced in place in their slot,
+ * new ones are appended and missing ones are marked as removed. The id hash and the spatial index are changed
+ * incrementally and slots are only compacted once many aircraft are removed.
+ *
+ * A generation counter is incremented for each update. Each aircraft remembers the generation when it was
+ * added or last changed position or heading which allows to find changed aircraft since any previous update.
+ *
+ * Pointers returned are valid until the next call of update() or clear(). Not thread safe.
+ */
+class SimConnectAircraftStore
+{
+public:
+  SimConnectAircraftStore()
+  {
+  }
+
+  SimConnectAircraftStore(const SimConnectAircraftStore& other) = delete;
+  SimConnectAircraftStore& operator=(const SimConnectAircraftStore& other) = delete;
+
+  /* Merge all aircraft of the packet. Empty replies like weather replies are ignored. */
+  void update(const atools::fs::sc::SimConnectData& data);
+
+  /* Merge aircraft list. Aircraft not in the list are removed. Increments generation. */
+  void update(const QList<atools::fs::sc::SimConnectAircraft>& aircraftList);
+
+  /* Remove all aircraft and reset generation */
+  void clear();
+
+  /* Get aircraft by object id or null if not found */
+  const atools::fs::sc::SimConnectAircraft *getById(int id) const;
+
+  bool contains(int id) const
+  {
+    return slotIndex.contains(id);
+  }
+
+  /* Number of aircraft in store */
+  int size() const
+  {
+    return static_cast<int>(slotIndex.size());
+  }
+
+  bool isEmpty() const
+  {
+    return slotIndex.isEmpty();
+  }
+
+  /* Generation of the last update */
+  quint32 getGeneration() const
+  {
+    return generation;
+  }
+
+  /* Generation when the aircraft was added or last changed position or heading. 0 if not found. */
+  quint32 getGeneration(int id) const;
+
+  /* Object ids of aircraft added or moved after the given generation, i.e. compared to the state as seen
+   * by a caller remembering getGeneration() at that time */
+  void getChangedIds(QList<int>& ids, quint32 sinceGeneration) const;
+
+  /* Object ids removed by the last update */
+  const QList<int>& getRemovedIds() const
+  {
+    return removedIds;
+  }
+
+  /* All aircraft in slot order */
+  void getAircraft(QList<const atools::fs::sc::SimConnectAircraft *>& aircraftList) const;
+
+  /* Aircraft near position or inside rectangle */
+  void getInRadius(QList<const atools::fs::sc::SimConnectAircraft *>& aircraftList, const atools::geo::Pos& pos,
+                   float radiusMeter) const;
+  void getInRect(QList<const atools::fs::sc::SimConnectAircraft *>& aircraftList, const atools::geo::Rect& rect) const;
+
+private:
+  /* Drop removed slots from the pool and rebuild the id hash if too many accumulated */
+  void compact();
+
+  /* Compact if more than this number of slots and half of them are removed */
+  const static int MIN_REMOVED_FOR_COMPACT = 64;
+
+  /* Slots of aircraft. Removed slots are kept until compact() to keep slot indexes stable. */
+  atools::geo::SpatialIndex<atools::fs::sc::SimConnectAircraft> aircraft;
+
+  /* Generation of last change for each slot */
+  QList<quint32> slotGenerations;
+
+  /* Slot index by object id */
+  QHash<int, int> slotIndex;
+
+  /* Slot indexes seen in the current update */
+  QList<bool> slotSeen;
+
+  QList<int> removedIds;
+  int numRemovedSlots = 0;
+  quint32 generation = 0;
+};
+
+} // namespace sc
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_SC_SIMCONNECTAIRCRAFTSTORE_H
@@ -103,6 +103,13 @@ bool SimConnectData::read(QIODevice *ioDevice)
     aiAircraft.append(ap);
   }
 
+  readMetars(in);
+
+  return true;
+}
+
+void SimConnectData::readMetars(QDataStream& in)
+{
   // Read METARs ==============================================
   quint16 numMetar = 0;
   in >> numMetar;
@@ -132,11 +139,15 @@ bool SimConnectData::read(QIODevice *ioDevice)
 
     metars.append(metar);
   }
-
-  return true;
 }
 
 int SimConnectData::write(QIODevice *ioDevice)
+{
+  QByteArray block = writeToByteArray();
+  return SimConnectDataBase::writeBlock(ioDevice, block, status);
+}
+
+QByteArray SimConnectData::writeToByteArray()
 {
   status = OK;
 
@@ -158,6 +169,18 @@ int SimConnectData::write(QIODevice *ioDevice)
   for(int i = 0; i < numAi; i++)
     aiAircraft.at(i).write(out);
 
+  writeMetars(out);
+
+  // Go back and update size
+  out.device()->seek(sizeof(MAGIC_NUMBER_DATA));
+  int size = block.size() - static_cast<int>(sizeof(packetSize)) - static_cast<int>(sizeof(MAGIC_NUMBER_DATA));
+  out << static_cast<quint32>(size);
+
+  return block;
+}
+
+void SimConnectData::writeMetars(QDataStream& out) const
+{
   // Write METARs ==============================================
   qsizetype numMetar = std::min(static_cast<qsizetype>(65535), static_cast<qsizetype>(metars.size()));
   out << static_cast<quint16>(numMetar);
@@ -172,29 +195,18 @@ int SimConnectData::write(QIODevice *ioDevice)
     writeLongString(out, metar.getNearestMetar());
     writeLongString(out, metar.getInterpolatedMetar());
   }
-
-  // Go back and update size
-  out.device()->seek(sizeof(MAGIC_NUMBER_DATA));
-  int size = block.size() - static_cast<int>(sizeof(packetSize)) - static_cast<int>(sizeof(MAGIC_NUMBER_DATA));
-  out << static_cast<quint32>(size);
-
-  return SimConnectDataBase::writeBlock(ioDevice, block, status);
 }
 
 SimConnectAircraft *SimConnectData::getAiAircraftById(int id)
 {
-  if(aiAircraftIndex.contains(id))
-    return &aiAircraft[aiAircraftIndex.value(id)];
-  else
-    return nullptr;
+  auto it = aiAircraftIndex.constFind(id);
+  return it != aiAircraftIndex.constEnd() ? &aiAircraft[it.value()] : nullptr;
 }
 
 const SimConnectAircraft *SimConnectData::getAiAircraftConstById(int id) const
 {
-  if(aiAircraftIndex.contains(id))
-    return &aiAircraft.at(aiAircraftIndex.value(id));
-  else
-    return nullptr;
+  auto it = aiAircraftIndex.constFind(id);
+  return it != aiAircraftIndex.constEnd() ? &aiAircraft.at(it.value()) : nullptr;
 }
 
 SimConnectData SimConnectData::buildDebugMovingAircraft(const geo::Pos& pos, const geo::Pos& lastPos, bool ground,
@@ -286,15 +298,27 @@ void SimConnectData::updateIndexesAndKeys()
 {
   userAircraft.updateAirplaneRegistrationKey();
 
-  aiAircraftIndex.clear();
+  // Keep the index if all aircraft are still at the same position in the list to avoid rehashing for each packet
+  bool indexValid = aiAircraftIndex.size() == aiAircraft.size();
   for(int i = 0; i < aiAircraft.size(); i++)
   {
     atools::fs::sc::SimConnectAircraft& aircraft = aiAircraft[i];
-
     aircraft.updateAirplaneRegistrationKey();
-    aiAircraftIndex.insert(aircraft.getId(), i);
+
+    if(indexValid)
+    {
+      auto it = aiAircraftIndex.constFind(aircraft.getId());
+      indexValid = it != aiAircraftIndex.constEnd() && it.value() == i;
+    }
   }
 
+  if(!indexValid)
+  {
+    aiAircraftIndex.clear();
+    aiAircraftIndex.reserve(aiAircraft.size());
+    for(int i = 0; i < aiAircraft.size(); i++)
+      aiAircraftIndex.insert(aiAircraft.at(i).getId(), i);
+  }
 }
 
 } // namespace sc
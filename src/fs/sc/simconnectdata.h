@@ -35,6 +35,8 @@ namespace fs {
 namespace sc {
 
 class SimConnectHandler;
+class SimConnectDataDelta;
+class LoadTestHandler;
 
 /*
  * Class that transfers flight simulator data read using the simconnect interface across the network to
@@ -59,6 +61,9 @@ public:
    */
   int write(QIODevice *ioDevice);
 
+  /* Serialize complete packet as written by write(). Allows to write the same bytes to several devices. */
+  QByteArray writeToByteArray();
+
   // metadata ----------------------------------------------------
   /* Serial number for data packet. */
   int getPacketId() const
@@ -144,15 +149,23 @@ public:
     return userAircraft.position.isValid();
   }
 
-  /* Update short registration keys which can be used for cross referencing */
+  /* Update short registration keys which can be used for cross referencing and the object id index.
+   * The index is only rebuilt if aircraft were added, removed or reordered.
+   * Use SimConnectAircraftStore to keep AI aircraft across packets. */
   void updateIndexesAndKeys();
 
 private:
   friend class atools::fs::sc::SimConnectHandler;
+  friend class atools::fs::sc::SimConnectDataDelta;
+  friend class atools::fs::sc::LoadTestHandler;
   friend class xpc::XpConnect;
 
+  /* Read and write METAR section of the packet */
+  void readMetars(QDataStream& in);
+  void writeMetars(QDataStream& out) const;
+
   const static quint32 MAGIC_NUMBER_DATA = 0xF75E0AF3;
-  const static quint32 DATA_VERSION = 11;
+  const static quint32 DATA_VERSION = 12;
 
   quint32 packetId = 0;
   QDateTime packetTs;
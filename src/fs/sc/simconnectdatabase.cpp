@@ -52,6 +52,9 @@ QString SimConnectDataBase::getStatusText() const
 
     case atools::fs::sc::WRITE_ERROR:
       return QObject::tr("Write error");
+
+    case atools::fs::sc::INVALID_DATA:
+      return QObject::tr("Invalid data");
   }
   return QObject::tr("Unknown Status");
 }
@@ -0,0 +1,395 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/sc/simconnectdatadelta.h"
+
+#include "fs/sc/simconnectdata.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QIODevice>
+#include <QTimeZone>
+#include <QtEndian>
+
+namespace atools {
+namespace fs {
+namespace sc {
+
+/* Serialize aircraft like done in SimConnectData::write() */
+template<typename TYPE>
+QByteArray serializeAircraft(const TYPE& aircraft)
+{
+  QByteArray bytes;
+  QDataStream out(&bytes, QIODevice::WriteOnly);
+  out.setVersion(QDataStream::Qt_5_5);
+  out.setFloatingPointPrecision(QDataStream::SinglePrecision);
+  aircraft.write(out);
+  return bytes;
+}
+
+template<typename TYPE>
+void deserializeAircraft(TYPE& aircraft, const QByteArray& bytes)
+{
+  QDataStream in(bytes);
+  in.setVersion(QDataStream::Qt_5_5);
+  in.setFloatingPointPrecision(QDataStream::SinglePrecision);
+  aircraft.read(in);
+}
+
+SimConnectDataDelta::SimConnectDataDelta()
+{
+
+}
+
+SimConnectDataDelta::~SimConnectDataDelta()
+{
+
+}
+
+void SimConnectDataDelta::reset()
+{
+  lastUserAircraft.clear();
+  lastAiAircraft.clear();
+  packetsSinceKeyframe = 0;
+  keyframeNeeded = true;
+  magicNumber = packetSize = 0;
+  normalPacket = false;
+}
+
+int SimConnectDataDelta::write(QIODevice *ioDevice, const SimConnectData& data)
+{
+  status = OK;
+
+  if(data.isEmptyReply())
+  {
+    // Pass weather and other empty replies through in normal format without touching the state
+    SimConnectData reply(data);
+    int written = reply.write(ioDevice);
+    status = reply.getStatus();
+    return written;
+  }
+
+  bool keyframe = keyframeNeeded || packetsSinceKeyframe >= keyframeInterval;
+  if(keyframe)
+  {
+    lastUserAircraft.clear();
+    lastAiAircraft.clear();
+    packetsSinceKeyframe = 0;
+    keyframeNeeded = false;
+  }
+  else
+    packetsSinceKeyframe++;
+
+  QByteArray payload;
+  QDataStream out(&payload, QIODevice::WriteOnly);
+  out.setVersion(QDataStream::Qt_5_5);
+  out.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+  out << data.packetId << static_cast<quint32>(data.packetTs.toSecsSinceEpoch());
+
+  // User aircraft ==============================================
+  if(data.userAircraft.getPosition().isValid())
+  {
+    QByteArray record = serializeAircraft(data.userAircraft);
+    writeRecord(out, record, lastUserAircraft.isEmpty() ? nullptr : &lastUserAircraft);
+    lastUserAircraft = record;
+  }
+  else
+  {
+    out << static_cast<quint8>(RECORD_NONE);
+    lastUserAircraft.clear();
+  }
+
+  // AI aircraft ==============================================
+  // Aircraft not in the list are removed on the receiving side
+  qsizetype numAi = std::min(static_cast<qsizetype>(65535), static_cast<qsizetype>(data.aiAircraft.size()));
+  out << static_cast<quint16>(numAi);
+
+  QHash<int, QByteArray> aiAircraft;
+  aiAircraft.reserve(numAi);
+  for(int i = 0; i < numAi; i++)
+  {
+    const SimConnectAircraft& aircraft = data.aiAircraft.at(i);
+    int id = aircraft.getId();
+    QByteArray record = serializeAircraft(aircraft);
+
+    out << static_cast<qint32>(id);
+    auto it = lastAiAircraft.constFind(id);
+    writeRecord(out, record, it != lastAiAircraft.constEnd() ? &it.value() : nullptr);
+    aiAircraft.insert(id, record);
+  }
+  lastAiAircraft.swap(aiAircraft);
+
+  data.writeMetars(out);
+
+  // Header and payload ==============================================
+  quint8 flags = PACKET_NONE;
+  if(keyframe)
+    flags |= PACKET_KEYFRAME;
+  if(compressed)
+  {
+    flags |= PACKET_COMPRESSED;
+    payload = qCompress(payload);
+  }
+
+  QByteArray block;
+  QDataStream blockOut(&block, QIODevice::WriteOnly);
+  blockOut.setVersion(QDataStream::Qt_5_5);
+
+  // Size counts all bytes following the size field
+  quint32 size = static_cast<quint32>(sizeof(DELTA_VERSION) + sizeof(flags) + static_cast<size_t>(payload.size()));
+  blockOut << MAGIC_NUMBER_DELTA << size << DELTA_VERSION << flags;
+  blockOut.writeRawData(payload.constData(), static_cast<int>(payload.size()));
+
+  return SimConnectDataBase::writeBlock(ioDevice, block, status);
+}
+
+void SimConnectDataDelta::writeRecord(QDataStream& out, const QByteArray& record, const QByteArray *last)
+{
+  if(last != nullptr && *last == record)
+  {
+    out << static_cast<quint8>(RECORD_UNCHANGED);
+    return;
+  }
+
+  if(last != nullptr && last->size() == record.size() && record.size() <= 65535)
+  {
+    // Collect runs of changed bytes. Runs separated by only a few equal bytes are merged.
+    QByteArray runs;
+    QDataStream runsOut(&runs, QIODevice::WriteOnly);
+    runsOut.setVersion(QDataStream::Qt_5_5);
+
+    const char *cur = record.constData(), *prev = last->constData();
+    int size = static_cast<int>(record.size()), numRuns = 0;
+    int i = 0;
+    while(i < size)
+    {
+      if(cur[i] == prev[i])
+      {
+        i++;
+        continue;
+      }
+
+      int start = i, end = i + 1;
+      for(int j = end; j < size && j - start < 255; j++)
+      {
+        if(cur[j] != prev[j])
+          end = j + 1;
+        else if(j - end >= MAX_RUN_GAP)
+          break;
+      }
+
+      runsOut << static_cast<quint16>(start) << static_cast<quint8>(end - start);
+      runsOut.writeRawData(cur + start, end - start);
+      numRuns++;
+      i = end;
+    }
+
+    if(runs.size() + 2 < record.size())
+    {
+      out << static_cast<quint8>(RECORD_DELTA) << static_cast<quint16>(numRuns);
+      out.writeRawData(runs.constData(), static_cast<int>(runs.size()));
+      return;
+    }
+  }
+
+  out << static_cast<quint8>(RECORD_FULL) << static_cast<quint32>(record.size());
+  out.writeRawData(record.constData(), static_cast<int>(record.size()));
+}
+
+bool SimConnectDataDelta::read(QIODevice *ioDevice, SimConnectData& data)
+{
+  status = OK;
+
+  if(magicNumber == 0 && !normalPacket)
+  {
+    if(ioDevice->bytesAvailable() < static_cast<qint64>(sizeof(magicNumber)))
+      return false;
+
+    // Look at magic number to detect packet format
+    QByteArray magic = ioDevice->peek(sizeof(magicNumber));
+    if(qFromBigEndian<quint32>(magic.constData()) == MAGIC_NUMBER_DELTA)
+    {
+      ioDevice->read(sizeof(magicNumber));
+      magicNumber = MAGIC_NUMBER_DELTA;
+    }
+    else
+      normalPacket = true;
+  }
+
+  if(normalPacket)
+  {
+    // Normal packet or weather reply
+    bool result = data.read(ioDevice);
+    status = data.getStatus();
+    if(result || status != OK)
+      normalPacket = false;
+    return result;
+  }
+
+  if(packetSize == 0)
+  {
+    if(ioDevice->bytesAvailable() < static_cast<qint64>(sizeof(packetSize)))
+      return false;
+
+    QDataStream in(ioDevice);
+    in.setVersion(QDataStream::Qt_5_5);
+    in >> packetSize;
+  }
+
+  // Wait until the whole packet is available
+  if(ioDevice->bytesAvailable() < packetSize)
+    return false;
+
+  QByteArray block = ioDevice->read(packetSize);
+  magicNumber = packetSize = 0;
+
+  QDataStream in(block);
+  in.setVersion(QDataStream::Qt_5_5);
+
+  quint32 version;
+  quint8 flags;
+  in >> version >> flags;
+  if(version != DELTA_VERSION)
+  {
+    qWarning() << Q_FUNC_INFO << "version mismatch" << version << "!=" << DELTA_VERSION;
+    status = VERSION_MISMATCH;
+    return false;
+  }
+
+  QByteArray payload = block.mid(sizeof(version) + sizeof(flags));
+  if(flags & PACKET_COMPRESSED)
+    payload = qUncompress(payload);
+
+  if(in.status() != QDataStream::Ok || payload.isEmpty() || !readPayload(payload, data, flags & PACKET_KEYFRAME))
+  {
+    qWarning() << Q_FUNC_INFO << "invalid delta packet";
+    status = INVALID_DATA;
+    reset();
+    return false;
+  }
+
+  return true;
+}
+
+bool SimConnectDataDelta::readPayload(const QByteArray& payload, SimConnectData& data, bool keyframe)
+{
+  QDataStream in(payload);
+  in.setVersion(QDataStream::Qt_5_5);
+  in.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+  // Build new state in copies to keep the old one in case of errors
+  QByteArray userAircraft = keyframe ? QByteArray() : lastUserAircraft;
+  const QHash<int, QByteArray> lastAi = keyframe ? QHash<int, QByteArray>() : lastAiAircraft;
+
+  quint32 ts;
+  in >> data.packetId >> ts;
+  data.packetTs = QDateTime::fromSecsSinceEpoch(ts, QTimeZone::UTC);
+
+  // User aircraft ==============================================
+  quint8 type = RECORD_NONE;
+  in >> type;
+  if(type == RECORD_NONE)
+    userAircraft.clear();
+  else
+  {
+    if(!readRecord(in, static_cast<RecordType>(type), userAircraft, !userAircraft.isEmpty()))
+      return false;
+    deserializeAircraft(data.userAircraft, userAircraft);
+  }
+
+  // AI aircraft ==============================================
+  quint16 numAi = 0;
+  in >> numAi;
+
+  QHash<int, QByteArray> aiAircraft;
+  aiAircraft.reserve(numAi);
+  for(quint16 i = 0; i < numAi; i++)
+  {
+    qint32 id;
+    in >> id >> type;
+
+    auto it = lastAi.constFind(id);
+    bool lastValid = it != lastAi.constEnd();
+    QByteArray record = lastValid ? it.value() : QByteArray();
+    if(!readRecord(in, static_cast<RecordType>(type), record, lastValid))
+      return false;
+
+    SimConnectAircraft aircraft;
+    deserializeAircraft(aircraft, record);
+    data.aiAircraft.append(aircraft);
+    aiAircraft.insert(id, record);
+  }
+
+  data.readMetars(in);
+
+  if(in.status() != QDataStream::Ok)
+    return false;
+
+  lastUserAircraft = userAircraft;
+  lastAiAircraft.swap(aiAircraft);
+  return true;
+}
+
+bool SimConnectDataDelta::readRecord(QDataStream& in, RecordType type, QByteArray& last, bool lastValid)
+{
+  switch(type)
+  {
+    case RECORD_UNCHANGED:
+      return lastValid;
+
+    case RECORD_FULL:
+      {
+        quint32 size = 0;
+        in >> size;
+        if(in.device()->bytesAvailable() < size)
+          return false;
+
+        last.resize(size);
+        in.readRawData(last.data(), static_cast<int>(size));
+        return in.status() == QDataStream::Ok;
+      }
+
+    case RECORD_DELTA:
+      {
+        if(!lastValid)
+          return false;
+
+        quint16 numRuns = 0;
+        in >> numRuns;
+        for(quint16 i = 0; i < numRuns; i++)
+        {
+          quint16 offset;
+          quint8 length;
+          in >> offset >> length;
+          if(in.status() != QDataStream::Ok || offset + length > last.size())
+            return false;
+
+          in.readRawData(last.data() + offset, length);
+        }
+        return in.status() == QDataStream::Ok;
+      }
+
+    case RECORD_NONE:
+      break;
+  }
+  return false;
+}
+
+} // namespace sc
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,149 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_SC_SIMCONNECTDATADELTA_H
+#define ATOOLS_FS_SC_SIMCONNECTDATADELTA_H
+
+#include "fs/sc/simconnectdatabase.h"
+
+#include <QByteArray>
+#include <QHash>
+
+class QIODevice;
+class QDataStream;
+
+namespace atools {
+namespace fs {
+namespace sc {
+
+class SimConnectData;
+
+/*
+ * Delta encoding of SimConnectData packets for the network protocol.
+ *
+ * Used by the navserver if the client requests it with CMD_DELTA_PROTOCOL in a reply. Each aircraft is
+ * serialized as usual and compared with the serialization sent in the last packet for the same object id.
+ * Unchanged aircraft are sent as id only and changed aircraft as a list of changed byte runs.
+ * A keyframe containing all aircraft completely is sent every few packets.
+ * The payload can be compressed using zlib if requested by CMD_DELTA_COMPRESSED.
+ *
+ * Sender and receiver keep one instance per connection which holds the state of the last packet.
+ * Empty replies like weather replies are passed through in the normal format without changing the state.
+ * read() accepts both formats.
+ */
+class SimConnectDataDelta :
+  public SimConnectDataBase
+{
+public:
+  SimConnectDataDelta();
+  virtual ~SimConnectDataDelta() override;
+
+  SimConnectDataDelta(const SimConnectDataDelta& other) = delete;
+  SimConnectDataDelta& operator=(const SimConnectDataDelta& other) = delete;
+
+  /*
+   * Encode data against the last written packet and write to IO device.
+   * @return number of bytes written
+   */
+  int write(QIODevice *ioDevice, const atools::fs::sc::SimConnectData& data);
+
+  /*
+   * Read a delta or normal packet from IO device into the empty data object and apply it to the state
+   * of the last packet. Call again with the same data object if false is returned and status is OK.
+   * @return true if it was fully read. False if not or an error occured.
+   */
+  bool read(QIODevice *ioDevice, atools::fs::sc::SimConnectData& data);
+
+  /* Clear state. Next written packet is a keyframe. */
+  void reset();
+
+  /* Compress payload with zlib */
+  void setCompressed(bool value)
+  {
+    compressed = value;
+  }
+
+  bool isCompressed() const
+  {
+    return compressed;
+  }
+
+  /* Send a keyframe each number of packets */
+  void setKeyframeInterval(int value)
+  {
+    keyframeInterval = value;
+  }
+
+  int getKeyframeInterval() const
+  {
+    return keyframeInterval;
+  }
+
+  static int getDeltaVersion()
+  {
+    return DELTA_VERSION;
+  }
+
+private:
+  /* Type of aircraft record */
+  enum RecordType : quint8
+  {
+    RECORD_NONE, /* No user aircraft */
+    RECORD_UNCHANGED, /* Same as in last packet */
+    RECORD_FULL, /* Complete serialization */
+    RECORD_DELTA /* Changed runs of bytes */
+  };
+
+  /* Flags in packet header */
+  enum PacketFlag : quint8
+  {
+    PACKET_NONE = 0,
+    PACKET_KEYFRAME = 1 << 0,
+    PACKET_COMPRESSED = 1 << 1
+  };
+
+  /* Write record type and content compared to the last serialization which can be null */
+  static void writeRecord(QDataStream& out, const QByteArray& record, const QByteArray *last);
+
+  /* Read record content for type into last. Returns false if malformed or last is missing. */
+  static bool readRecord(QDataStream& in, RecordType type, QByteArray& last, bool lastValid);
+
+  bool readPayload(const QByteArray& payload, atools::fs::sc::SimConnectData& data, bool keyframe);
+
+  const static quint32 MAGIC_NUMBER_DELTA = 0xF75E0AF4;
+  const static quint32 DELTA_VERSION = 1;
+
+  /* Equal bytes between changes which are still merged into one run */
+  const static int MAX_RUN_GAP = 4;
+
+  /* Serialization of the user aircraft and AI aircraft by object id from the last packet */
+  QByteArray lastUserAircraft;
+  QHash<int, QByteArray> lastAiAircraft;
+
+  int keyframeInterval = 100, packetsSinceKeyframe = 0;
+  bool compressed = false, keyframeNeeded = true;
+
+  /* State for partial reads */
+  quint32 magicNumber = 0, packetSize = 0;
+  bool normalPacket = false;
+};
+
+} // namespace sc
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_SC_SIMCONNECTDATADELTA_H
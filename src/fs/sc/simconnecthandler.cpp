@@ -185,17 +185,32 @@ public:
     : verbose(verboseLogging)
   {
     api = new SimConnectApi;
+
+#if defined(SIMCONNECT_BUILD_WIN32) || defined(SIMCONNECT_BUILD_WIN64)
+    // Auto reset event which is signaled by SimConnect when messages are waiting for dispatch
+    dispatchEvent = CreateEventW(nullptr, FALSE /* manual reset */, FALSE, nullptr);
+    if(dispatchEvent == nullptr)
+      qWarning() << Q_FUNC_INFO << "CreateEventW failed" << GetLastError() << "falling back to polling";
+#endif
   }
 
   ~SimConnectHandlerPrivate()
   {
     ATOOLS_DELETE_LOG(api);
+
+#if defined(SIMCONNECT_BUILD_WIN32) || defined(SIMCONNECT_BUILD_WIN64)
+    if(dispatchEvent != nullptr)
+      CloseHandle(dispatchEvent);
+#endif
   }
 
   atools::fs::sc::SimConnectApi *api = nullptr;
   atools::win::ActivationContext *activationContext = nullptr;
   QString libraryName;
 
+  /* Passed to SimConnect_Open. Used to wake up when data is ready instead of sleeping. Null if not available. */
+  HANDLE dispatchEvent = nullptr;
+
   /* Static method will pass call to object which is passed in pContext. */
   static void CALLBACK dispatchFunction(SIMCONNECT_RECV *pData, DWORD cbData, void *pContext);
 
@@ -582,6 +597,12 @@ bool SimConnectHandlerPrivate::callDispatch(bool& dataFetched, const QString& me
         qDebug() << Q_FUNC_INFO << "SimConnect_CallDispatch during " << message << ": Exception" << simconnectException;
     }
 
+    // Wait until SimConnect signals new messages - timeout keeps the same maximum wait time as polling
+#if defined(SIMCONNECT_BUILD_WIN32) || defined(SIMCONNECT_BUILD_WIN64)
+    if(dispatchEvent != nullptr)
+      WaitForSingleObject(dispatchEvent, 5);
+    else
+#endif
     QThread::msleep(5);
     dispatchCycles++;
   }
@@ -827,7 +848,7 @@ bool SimConnectHandler::connect()
   if(p->verbose)
     qDebug() << Q_FUNC_INFO << "Before open";
 
-  hr = p->api->Open(appName.constData(), nullptr, 0, nullptr, 0);
+  hr = p->api->Open(appName.constData(), nullptr, 0, p->dispatchEvent, 0);
   if(hr == S_OK)
   {
     if(p->verbose)
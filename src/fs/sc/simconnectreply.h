@@ -34,8 +34,10 @@ namespace sc {
 // quint16
 enum Command : quint32
 {
-  CMD_NONE,
-  CMD_WEATHER_REQUEST
+  CMD_NONE = 0,
+  CMD_WEATHER_REQUEST = 1 << 0,
+  CMD_DELTA_PROTOCOL = 1 << 1, /* Client can read delta packets written by SimConnectDataDelta. Sent with any reply. */
+  CMD_DELTA_COMPRESSED = 1 << 2 /* Client wants delta packets compressed. Needs CMD_DELTA_PROTOCOL. */
 };
 
 ATOOLS_DECLARE_FLAGS_32(Commands, atools::fs::sc::Command)
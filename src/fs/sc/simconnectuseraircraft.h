@@ -34,6 +34,7 @@ namespace fs {
 namespace sc {
 class SimConnectHandler;
 class SimConnectData;
+class LoadTestHandler;
 
 /*
  * User aircraft that is used to transfer across network links.
@@ -243,6 +244,7 @@ public:
 private:
   friend class atools::fs::sc::SimConnectHandler;
   friend class atools::fs::sc::SimConnectData;
+  friend class atools::fs::sc::LoadTestHandler;
   friend class xpc::XpConnect;
 
   float
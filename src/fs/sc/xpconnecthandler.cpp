@@ -20,6 +20,7 @@
 #include "fs/sc/weatherrequest.h"
 
 #include "fs/sc/simconnectdata.h"
+#include "fs/sc/xpsharedmemory.h"
 
 #include <QBuffer>
 #include <QDataStream>
@@ -75,6 +76,56 @@ bool XpConnectHandler::fetchData(fs::sc::SimConnectData& data, int radiusKm, fs:
     return false;
   }
 
+  bool dataRead = xpshm::isValid(sharedMemory.constData(), static_cast<int>(sharedMemory.size())) ?
+                  readSequenceLocked(data) : readLegacy(data);
+
+  if(dataRead && data.isUserAircraftValid() && data.getStatus() == OK)
+  {
+    if(!(options & atools::fs::sc::FETCH_AI_AIRCRAFT))
+      // Have to clear this here since the X-Plane plugin has no configuration option
+      data.clearAiAircraft();
+
+    return true;
+  }
+
+  return false;
+}
+
+bool XpConnectHandler::readSequenceLocked(SimConnectData& data)
+{
+  switch(xpshm::read(sharedMemory.constData(), static_cast<int>(sharedMemory.size()), payload, lastSequence))
+  {
+    case XP_SHM_OK:
+      {
+        QBuffer buffer(&payload);
+        buffer.open(QIODevice::ReadOnly);
+        lastData = SimConnectData();
+        lastData.read(&buffer);
+      }
+      break;
+
+    case XP_SHM_UNCHANGED:
+      // Plugin did not update since last fetch - avoid decoding again
+      break;
+
+    case XP_SHM_TERMINATE:
+      disconnect();
+      return false;
+
+    case XP_SHM_BUSY:
+      qInfo() << Q_FUNC_INFO << "Shared memory busy" << sharedMemory.key();
+      return false;
+
+    case XP_SHM_INVALID:
+      return false;
+  }
+
+  data = lastData;
+  return true;
+}
+
+bool XpConnectHandler::readLegacy(SimConnectData& data)
+{
   if(sharedMemory.lock())
   {
     quint32 size;
@@ -100,15 +151,7 @@ bool XpConnectHandler::fetchData(fs::sc::SimConnectData& data, int radiusKm, fs:
         disconnect();
         return false;
       }
-
-      if(data.isUserAircraftValid() && data.getStatus() == OK)
-      {
-        if(!(options & atools::fs::sc::FETCH_AI_AIRCRAFT))
-          // Have to clear this here since the X-Plane plugin has no configuration option
-          data.clearAiAircraft();
-
-        return true;
-      }
+      return true;
     }
     else
       sharedMemory.unlock();
@@ -164,6 +207,9 @@ QString XpConnectHandler::getName() const
 void XpConnectHandler::disconnect()
 {
   bool result = sharedMemory.detach();
+  payload.clear();
+  lastSequence = 0;
+  lastData = SimConnectData();
   qDebug() << Q_FUNC_INFO << "result" << result;
   state = DISCONNECTED;
 }
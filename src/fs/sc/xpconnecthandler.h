@@ -19,6 +19,7 @@
 #define ATOOLS_XPCONNECTHANDLER_H
 
 #include "fs/sc/connecthandler.h"
+#include "fs/sc/simconnectdata.h"
 
 #include <QSharedMemory>
 
@@ -50,7 +51,8 @@ public:
   /* Always loaded since X-Plane is always available */
   virtual bool isLoaded() const override;
 
-  /* Fetch data from the shared memory. */
+  /* Fetch data from the shared memory. Uses the sequence lock layout from xpsharedmemory.h if the plugin writes it
+   * and falls back to the locked legacy layout otherwise. */
   virtual bool fetchData(SimConnectData& data, int radiusKm, Options options) override;
 
   /* Not supported in X-Plane */
@@ -79,9 +81,20 @@ public:
 private:
   void disconnect();
 
+  /* Read from legacy layout with size and terminate prefix using lock */
+  bool readLegacy(SimConnectData& data);
+
+  /* Read from sequence locked layout without lock. Decodes only if plugin wrote new data. */
+  bool readSequenceLocked(SimConnectData& data);
+
   QSharedMemory sharedMemory;
   atools::fs::sc::State state = DISCONNECTED;
 
+  /* Last copied payload and decoded data for sequence locked layout */
+  QByteArray payload;
+  quint32 lastSequence = 0;
+  SimConnectData lastData;
+
 };
 
 } // namespace sc
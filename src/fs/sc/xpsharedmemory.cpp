@@ -0,0 +1,119 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/sc/xpsharedmemory.h"
+
+#include <QDebug>
+
+#include <algorithm>
+#include <cstring>
+
+namespace atools {
+namespace fs {
+namespace sc {
+namespace xpshm {
+
+/* Number of attempts to get a consistent copy while the writer is active */
+static const int READ_RETRIES = 100;
+
+bool isValid(const void *memory, int memorySize)
+{
+  if(memory == nullptr || memorySize < static_cast<int>(sizeof(XpSharedMemoryHeader)))
+    return false;
+
+  const XpSharedMemoryHeader *header = static_cast<const XpSharedMemoryHeader *>(memory);
+  return header->magicNumber == XP_SHARED_MEMORY_MAGIC_NUMBER && header->version == XP_SHARED_MEMORY_VERSION;
+}
+
+bool write(void *memory, int memorySize, const QByteArray& payload, bool terminate)
+{
+  if(memory == nullptr || memorySize < static_cast<int>(sizeof(XpSharedMemoryHeader)))
+    return false;
+
+  if(payload.size() > memorySize - static_cast<int>(sizeof(XpSharedMemoryHeader)))
+  {
+    qWarning() << Q_FUNC_INFO << "Payload too large" << payload.size() << "for" << memorySize;
+    return false;
+  }
+
+  XpSharedMemoryHeader *header = static_cast<XpSharedMemoryHeader *>(memory);
+  if(!isValid(memory, memorySize))
+  {
+    // First write - sequence starts even and magic number is written last
+    header->sequence.store(0, std::memory_order_relaxed);
+    header->version = XP_SHARED_MEMORY_VERSION;
+    header->terminate = 0;
+    header->size = 0;
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magicNumber = XP_SHARED_MEMORY_MAGIC_NUMBER;
+  }
+
+  // Odd sequence marks write in progress
+  quint32 sequence = header->sequence.load(std::memory_order_relaxed);
+  header->sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  header->terminate = terminate;
+  header->size = static_cast<quint32>(payload.size());
+  std::memcpy(static_cast<char *>(memory) + sizeof(XpSharedMemoryHeader), payload.constData(),
+              static_cast<size_t>(payload.size()));
+
+  header->sequence.store(sequence + 2, std::memory_order_release);
+  return true;
+}
+
+XpSharedMemoryResult read(const void *memory, int memorySize, QByteArray& payload, quint32& lastSequence)
+{
+  if(!isValid(memory, memorySize))
+    return XP_SHM_INVALID;
+
+  const XpSharedMemoryHeader *header = static_cast<const XpSharedMemoryHeader *>(memory);
+  const char *data = static_cast<const char *>(memory) + sizeof(XpSharedMemoryHeader);
+  int maxSize = memorySize - static_cast<int>(sizeof(XpSharedMemoryHeader));
+
+  for(int i = 0; i < READ_RETRIES; i++)
+  {
+    quint32 sequenceBefore = header->sequence.load(std::memory_order_acquire);
+    if(sequenceBefore & 1)
+      // Writer active
+      continue;
+
+    if(sequenceBefore == lastSequence && !payload.isEmpty())
+      return header->terminate ? XP_SHM_TERMINATE : XP_SHM_UNCHANGED;
+
+    bool terminate = header->terminate;
+    int size = std::min(static_cast<int>(header->size), maxSize);
+    payload.resize(size);
+    std::memcpy(payload.data(), data, static_cast<size_t>(size));
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if(header->sequence.load(std::memory_order_relaxed) == sequenceBefore)
+    {
+      // Consistent copy
+      lastSequence = sequenceBefore;
+      return terminate ? XP_SHM_TERMINATE : XP_SHM_OK;
+    }
+  }
+
+  payload.clear();
+  return XP_SHM_BUSY;
+}
+
+} // namespace xpshm
+} // namespace sc
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,85 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_SC_XPSHAREDMEMORY_H
+#define ATOOLS_FS_SC_XPSHAREDMEMORY_H
+
+#include <QByteArray>
+
+#include <atomic>
+
+namespace atools {
+namespace fs {
+namespace sc {
+
+/* Identifies the sequence lock layout. The legacy layout starts with a big endian size which is always smaller. */
+const static quint32 XP_SHARED_MEMORY_MAGIC_NUMBER = 0x58505348;
+const static quint16 XP_SHARED_MEMORY_VERSION = 1;
+
+/*
+ * Header at the start of the shared memory segment used between the Little Xpconnect plugin and XpConnectHandler.
+ * The serialized SimConnectData packet follows directly after the header.
+ *
+ * Access is synchronized by a sequence lock instead of QSharedMemory::lock() which needs a system semaphore:
+ * The single writer increments sequence to an odd value, copies the payload and increments it again to an even value.
+ * Readers copy the payload and retry if the sequence was odd or changed while copying.
+ */
+struct XpSharedMemoryHeader
+{
+  quint32 magicNumber;
+  quint16 version;
+  quint16 terminate; /* Writer is shutting down if not 0 */
+  std::atomic<quint32> sequence;
+  quint32 size; /* Size of payload following the header */
+};
+
+static_assert(std::atomic<quint32>::is_always_lock_free, "Shared memory sequence needs lock free atomics");
+
+/* Result of xpshm::read() */
+enum XpSharedMemoryResult
+{
+  XP_SHM_OK, /* New data copied */
+  XP_SHM_UNCHANGED, /* Sequence is the same as lastSequence - payload not copied */
+  XP_SHM_TERMINATE, /* Writer is shutting down */
+  XP_SHM_BUSY, /* Writer updated data during all retries */
+  XP_SHM_INVALID /* Not initialized, legacy layout or version mismatch */
+};
+
+/*
+ * Reads and writes the sequence locked layout in a shared memory segment. Not thread safe for more than one writer.
+ */
+namespace xpshm {
+
+/* true if the memory contains a header with the sequence lock layout and matching version */
+bool isValid(const void *memory, int memorySize);
+
+/* Copy payload into the memory. Initializes the header if needed. Returns false if payload is too large. */
+bool write(void *memory, int memorySize, const QByteArray& payload, bool terminate);
+
+/*
+ * Copy the current payload if the sequence differs from lastSequence which is updated on success.
+ * Payload is taken from a consistent snapshot or not at all.
+ */
+XpSharedMemoryResult read(const void *memory, int memorySize, QByteArray& payload, quint32& lastSequence);
+
+} // namespace xpshm
+
+} // namespace sc
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_SC_XPSHAREDMEMORY_H
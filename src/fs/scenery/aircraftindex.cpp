@@ -22,11 +22,18 @@
 #include "fs/scenery/layoutjson.h"
 #include "fs/util/fsutil.h"
 
+#include <QDataStream>
+#include <QDateTime>
 #include <QDir>
+#include <QSaveFile>
 #include <QTextStream>
 #include <QStringBuilder>
+#include <QThread>
+#include <QThreadPool>
 #include <QDebug>
 
+#include <algorithm>
+
 namespace atools {
 namespace fs {
 namespace scenery {
@@ -36,56 +43,266 @@ AircraftIndex::AircraftIndex(bool verboseParm) :
 {
 }
 
+AircraftIndex::~AircraftIndex()
+{
+  stopWarming();
+  saveCache();
+}
+
 void AircraftIndex::loadIndex(const QStringList& basePaths)
 {
   if(loadedBasePaths != basePaths || aircraftShortToFullPathMap.isEmpty())
   {
+    // Keep what was read so far for the next start
+    saveCache();
     clear();
     loadedBasePaths = basePaths;
 
     qDebug() << Q_FUNC_INFO << "Loading from" << basePaths << "...";
 
+    // Collect all addon folders first to allow parallel reading
+    QStringList addonPaths;
     for(const QString& path : basePaths)
     {
       // dir = .../Microsoft.FlightSimulator_8wekyb3d8bbwe/LocalCache/Packages/Official/OneStore
       QDir dir(path);
       const QFileInfoList entries = dir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot);
       for(const QFileInfo& addonDir : entries)
+        addonPaths.append(addonDir.filePath());
+    }
+
+    // Each task writes only into its own result list
+    QList<QList<CfgFile> > results(addonPaths.size());
+    QList<CfgFile> *resultData = results.data();
+
+    QThreadPool pool;
+    for(int i = 0; i < addonPaths.size(); i++)
+    {
+      const QString addonPath = addonPaths.at(i);
+      pool.start([resultData, i, addonPath]() {
+        resultData[i] = readAddon(addonPath);
+      });
+    }
+    pool.waitForDone();
+
+    // Merge in order of base paths and folders
+    QList<CfgFile> cfgFiles;
+    for(const QList<CfgFile>& result : std::as_const(results))
+    {
+      for(const CfgFile& cfgFile : result)
+      {
+        aircraftShortToFullPathMap.insert(cfgFile.shortPath, cfgFile.fullPath);
+        cfgFiles.append(cfgFile);
+      }
+    }
+
+    int numCached = loadCache(cfgFiles);
+    qDebug() << Q_FUNC_INFO << "loading done." << aircraftShortToFullPathMap.size() << "aircraft" << numCached << "cached";
+
+    if(verbose)
+      qDebug() << Q_FUNC_INFO << "aircraftShortToFullPathMap" << aircraftShortToFullPathMap;
+
+    // Read remaining aircraft.cfg files in background to avoid stalls on first lookups
+    warmCache();
+  }
+}
+
+QList<AircraftIndex::CfgFile> AircraftIndex::readAddon(const QString& addonPath)
+{
+  // addonPath = .../Microsoft.FlightSimulator_8wekyb3d8bbwe/LocalCache/Packages/Official/OneStore/asobo-aircraft-208b-grand-caravan-ex
+  QList<CfgFile> cfgFiles;
+
+  // Read manifest and check for aircraft
+  ManifestJson manifest;
+  manifest.read(addonPath + QDir::separator() + "manifest.json");
+  if(manifest.isValid() && manifest.isAircraft())
+  {
+    // Find aircraft.cfg relative location in manifest
+    LayoutJson layout;
+    layout.read(addonPath + QDir::separator() + "layout.json");
+    if(layout.isValid())
+    {
+      // There may be more than one aircraft.cfg, e.g. for wheeled and floats
+      for(QString layoutPath : layout.getAircraftCfgPaths())
       {
-        // addonDir = .../Microsoft.FlightSimulator_8wekyb3d8bbwe/LocalCache/Packages/Official/OneStore/asobo-aircraft-208b-grand-caravan-ex
+        // This is the hashmap key returned by SimConnect_RequestSystemState(EVENT_AIRCRAFT_LOADED, ...)
+        // SimObjects/Airplanes/Asobo_208B_GRAND_CARAVAN_EX/aircraft.cfg
+        QString cfgPathKey = layoutPath.replace('\\', '/').toLower(); // Clean path needs an existing path
+        QFileInfo fullCfgPathValue(addonPath + QDir::separator() + layoutPath);
 
-        // Read manifest and check for aircraft
-        ManifestJson manifest;
-        manifest.read(addonDir.filePath() + QDir::separator() + "manifest.json");
-        if(manifest.isValid() && manifest.isAircraft())
+        if(fullCfgPathValue.exists() && fullCfgPathValue.isFile())
         {
-          // Find aircraft.cfg relative location in manifest
-          LayoutJson layout;
-          layout.read(addonDir.filePath() + QDir::separator() + "layout.json");
-          if(layout.isValid())
-          {
-            // There may be more than one aircraft.cfg, e.g. for wheeled and floats
-            for(QString layoutPath : layout.getAircraftCfgPaths())
-            {
-              // This is the hashmap key returned by SimConnect_RequestSystemState(EVENT_AIRCRAFT_LOADED, ...)
-              // SimObjects/Airplanes/Asobo_208B_GRAND_CARAVAN_EX/aircraft.cfg
-              QString cfgPathKey = layoutPath.replace('\\', '/').toLower(); // Clean path needs an existing path
-              QFileInfo fullCfgPathValue(addonDir.filePath() + QDir::separator() + layoutPath);
-
-              if(fullCfgPathValue.exists() && fullCfgPathValue.isFile())
-                aircraftShortToFullPathMap.insert(cfgPathKey.toLower(), atools::cleanPath(fullCfgPathValue.canonicalFilePath()));
-            }
-          }
+          CfgFile cfgFile;
+          cfgFile.shortPath = cfgPathKey;
+          cfgFile.fullPath = atools::cleanPath(fullCfgPathValue.canonicalFilePath());
+          cfgFile.lastModified = fullCfgPathValue.lastModified().toMSecsSinceEpoch();
+          cfgFile.fileSize = fullCfgPathValue.size();
+          cfgFiles.append(cfgFile);
         }
       }
     }
-    qDebug() << Q_FUNC_INFO << "loading done.";
+  }
+  return cfgFiles;
+}
 
-    if(verbose)
-      qDebug() << Q_FUNC_INFO << "aircraftShortToFullPathMap" << aircraftShortToFullPathMap;
+int AircraftIndex::loadCache(const QList<CfgFile>& cfgFiles)
+{
+  if(cacheFile.isEmpty() || !QFile::exists(cacheFile))
+    return 0;
+
+  QFile file(cacheFile);
+  if(!file.open(QIODevice::ReadOnly))
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot open" << cacheFile << file.errorString();
+    return 0;
+  }
+
+  QDataStream in(&file);
+  in.setVersion(QDataStream::Qt_5_5);
+
+  quint32 magic;
+  quint16 version;
+  qint32 size;
+  in >> magic >> version >> size;
+
+  if(magic != CACHE_FILE_MAGIC_NUMBER || version != CACHE_FILE_VERSION || in.status() != QDataStream::Ok)
+  {
+    qWarning() << Q_FUNC_INFO << "Invalid cache file" << cacheFile;
+    return 0;
+  }
+
+  // Full path to properties
+  QHash<QString, AircraftProperties> cached;
+  cached.reserve(size);
+  for(qint32 i = 0; i < size && in.status() == QDataStream::Ok; i++)
+  {
+    QString fullPath;
+    AircraftProperties properties;
+    in >> fullPath >> properties.lastModified >> properties.fileSize >> properties.category >> properties.icaoTypeDesignator;
+    cached.insert(fullPath, properties);
+  }
+
+  if(in.status() != QDataStream::Ok)
+  {
+    qWarning() << Q_FUNC_INFO << "Error reading cache file" << cacheFile;
+    return 0;
+  }
+
+  // Use entries only if the file was not changed
+  int numCached = 0;
+  for(const CfgFile& cfgFile : cfgFiles)
+  {
+    auto it = cached.constFind(cfgFile.fullPath);
+    if(it != cached.constEnd() && it->lastModified == cfgFile.lastModified && it->fileSize == cfgFile.fileSize)
+    {
+      shortPathToPropertiesMap.insert(cfgFile.shortPath, it.value());
+      numCached++;
+    }
+  }
+
+  // Save again if files were removed or changed
+  cacheChanged = numCached != cached.size() || numCached != cfgFiles.size();
+  return numCached;
+}
+
+void AircraftIndex::saveCache()
+{
+  mergeWarmed();
+
+  if(cacheFile.isEmpty() || !cacheChanged)
+    return;
+
+  QSaveFile file(cacheFile);
+  if(file.open(QIODevice::WriteOnly))
+  {
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_5);
+
+    // Save only properties of existing files
+    QList<std::pair<QString, const AircraftProperties *> > entries;
+    for(auto it = shortPathToPropertiesMap.constBegin(); it != shortPathToPropertiesMap.constEnd(); ++it)
+    {
+      QString fullPath = aircraftShortToFullPathMap.value(it.key());
+      if(!fullPath.isEmpty() && it->lastModified != -1)
+        entries.append(std::make_pair(fullPath, &it.value()));
+    }
+
+    out << CACHE_FILE_MAGIC_NUMBER << CACHE_FILE_VERSION << static_cast<qint32>(entries.size());
+    for(const std::pair<QString, const AircraftProperties *>& entry : std::as_const(entries))
+      out << entry.first << entry.second->lastModified << entry.second->fileSize << entry.second->category
+          << entry.second->icaoTypeDesignator;
+
+    if(out.status() != QDataStream::Ok || !file.commit())
+      qWarning() << Q_FUNC_INFO << "Error writing cache file" << cacheFile << file.errorString();
+    else
+    {
+      qDebug() << Q_FUNC_INFO << "Saved" << entries.size() << "entries to" << cacheFile;
+      cacheChanged = false;
+    }
+  }
+  else
+    qWarning() << Q_FUNC_INFO << "Cannot open" << cacheFile << file.errorString();
+}
+
+void AircraftIndex::warmCache()
+{
+  stopWarming();
+
+  QList<std::pair<QString, QString> > missing;
+  for(auto it = aircraftShortToFullPathMap.constBegin(); it != aircraftShortToFullPathMap.constEnd(); ++it)
+  {
+    if(!shortPathToPropertiesMap.contains(it.key()))
+      missing.append(std::make_pair(it.key(), it.value()));
+  }
+
+  if(missing.isEmpty())
+    return;
+
+  qDebug() << Q_FUNC_INFO << "Reading" << missing.size() << "aircraft.cfg files in background";
+
+  // Leave some threads for the application
+  warmPool = new QThreadPool;
+  warmPool->setMaxThreadCount(std::max(QThread::idealThreadCount() / 2, 1));
+
+  for(const std::pair<QString, QString>& entry : std::as_const(missing))
+  {
+    warmPool->start([this, entry]() {
+      AircraftProperties properties = readAircraftCfg(entry.second);
+
+      QMutexLocker locker(&warmedMutex);
+      warmedPropertiesMap.insert(entry.first, properties);
+    });
   }
 }
 
+void AircraftIndex::stopWarming()
+{
+  if(warmPool != nullptr)
+  {
+    // Remove queued tasks and wait for running ones
+    warmPool->clear();
+    warmPool->waitForDone();
+    delete warmPool;
+    warmPool = nullptr;
+  }
+}
+
+void AircraftIndex::mergeWarmed()
+{
+  QMutexLocker locker(&warmedMutex);
+  if(warmedPropertiesMap.isEmpty())
+    return;
+
+  for(auto it = warmedPropertiesMap.constBegin(); it != warmedPropertiesMap.constEnd(); ++it)
+  {
+    // Keep entries read synchronously by fetchProperties() to keep returned references stable
+    if(!shortPathToPropertiesMap.contains(it.key()))
+      shortPathToPropertiesMap.insert(it.key(), it.value());
+  }
+  warmedPropertiesMap.clear();
+  cacheChanged = true;
+}
+
 const QString& AircraftIndex::getIcaoTypeDesignator(const QString& aircraftCfgFilepath)
 {
   return fetchProperties(aircraftCfgFilepath).icaoTypeDesignator;
@@ -102,6 +319,12 @@ const AircraftIndex::AircraftProperties& AircraftIndex::fetchProperties(const QS
   aircraftCfgKey = aircraftCfgKey.replace('\\', '/').toLower(); // Clean path needs an existing path
 
   auto it = shortPathToPropertiesMap.constFind(aircraftCfgKey);
+  if(it == shortPathToPropertiesMap.constEnd())
+  {
+    // Pick up results from background reading
+    mergeWarmed();
+    it = shortPathToPropertiesMap.constFind(aircraftCfgKey);
+  }
 
   if(it != shortPathToPropertiesMap.constEnd())
     // Already in index - either empty (indicator for nothing found) or not empty (found)
@@ -112,72 +335,85 @@ const AircraftIndex::AircraftProperties& AircraftIndex::fetchProperties(const QS
       qDebug() << Q_FUNC_INFO << "aircraftCfgKey" << aircraftCfgKey;
 
     // Nothing in index yet - read aircraft.cfg file
-    AircraftProperties properties;
-
-    // Get full filename for key
     QString aircraftCfgFullPath = aircraftShortToFullPathMap.value(aircraftCfgKey);
-    if(!aircraftCfgFullPath.isEmpty() && QFile::exists(aircraftCfgFullPath))
+    AircraftProperties properties = readAircraftCfg(aircraftCfgFullPath);
+    cacheChanged = true;
+
+    // Log only once after loading
+    qDebug() << Q_FUNC_INFO << "Loaded" << aircraftCfgFullPath << "found" << properties.icaoTypeDesignator << properties.category;
+
+    // Add designator to index or empty value in case of missing file to avoid re-reading
+    return shortPathToPropertiesMap.insert(aircraftCfgKey, properties).value();
+  }
+}
+
+AircraftIndex::AircraftProperties AircraftIndex::readAircraftCfg(const QString& aircraftCfgFullPath)
+{
+  AircraftProperties properties;
+
+  QFileInfo fileinfo(aircraftCfgFullPath);
+  if(!aircraftCfgFullPath.isEmpty() && fileinfo.exists())
+  {
+    // Read type designator from aircraft.cfg file
+    QFile file(aircraftCfgFullPath);
+    if(file.open(QIODevice::ReadOnly))
     {
-      // Read type designator from aircraft.cfg file
-      QFile file(aircraftCfgFullPath);
-      if(file.open(QIODevice::ReadOnly))
+      properties.lastModified = fileinfo.lastModified().toMSecsSinceEpoch();
+      properties.fileSize = fileinfo.size();
+
+      QTextStream stream(&file);
+      bool generalSection = false;
+      QString icaoTypeDesignator, icaoModel;
+
+      while(!stream.atEnd())
       {
-        QTextStream stream(&file);
-        bool generalSection = false;
-        QString icaoTypeDesignator, icaoModel;
+        QString line = stream.readLine().trimmed();
 
-        while(!stream.atEnd())
+        if(line.contains("[General]", Qt::CaseInsensitive))
         {
-          QString line = stream.readLine().trimmed();
-
-          if(line.contains("[General]", Qt::CaseInsensitive))
-          {
-            generalSection = true;
-            continue;
-          }
-
-          if(generalSection)
-          {
-            if(line.startsWith("icao_type_designator", Qt::CaseInsensitive)) // icao_type_designator = "A20N"
-              icaoTypeDesignator = line.section('=', 1).remove('"').trimmed();
-
-            if(line.startsWith("icao_model", Qt::CaseInsensitive)) // icao_model = "TBM-930"
-              icaoModel = line.section('=', 1).remove('"').trimmed();
-
-            if(line.startsWith("Category", Qt::CaseInsensitive)) // Category = "Helicopter"
-              properties.category = line.section('=', 1).remove('"').trimmed();
-
-            // Either all fields populated or next section after [General] - break out
-            if(line.startsWith('[') ||
-               (!icaoTypeDesignator.isEmpty() && !icaoModel.isEmpty() && !properties.category.isEmpty()))
-              break;
-          }
+          generalSection = true;
+          continue;
         }
 
-        file.close();
+        if(generalSection)
+        {
+          if(line.startsWith("icao_type_designator", Qt::CaseInsensitive)) // icao_type_designator = "A20N"
+            icaoTypeDesignator = line.section('=', 1).remove('"').trimmed();
+
+          if(line.startsWith("icao_model", Qt::CaseInsensitive)) // icao_model = "TBM-930"
+            icaoModel = line.section('=', 1).remove('"').trimmed();
+
+          if(line.startsWith("Category", Qt::CaseInsensitive)) // Category = "Helicopter"
+            properties.category = line.section('=', 1).remove('"').trimmed();
 
-        if(!atools::fs::util::isAircraftTypeDesignatorValid(icaoTypeDesignator) &&
-           atools::fs::util::isAircraftTypeDesignatorValid(icaoModel))
-          // ICAO type designator not valid but mode. Use model instead.
-          properties.icaoTypeDesignator = icaoModel;
-        else
-          properties.icaoTypeDesignator = icaoTypeDesignator;
+          // Either all fields populated or next section after [General] - break out
+          if(line.startsWith('[') ||
+             (!icaoTypeDesignator.isEmpty() && !icaoModel.isEmpty() && !properties.category.isEmpty()))
+            break;
+        }
       }
-    }
 
-    // Log only once after loading
-    qDebug() << Q_FUNC_INFO << "Loaded" << aircraftCfgFullPath << "found" << properties.icaoTypeDesignator << properties.category;
+      file.close();
 
-    // Add designator to index or empty value in case of missing file to avoid re-reading
-    return shortPathToPropertiesMap.insert(aircraftCfgKey, properties).value();
+      if(!atools::fs::util::isAircraftTypeDesignatorValid(icaoTypeDesignator) &&
+         atools::fs::util::isAircraftTypeDesignatorValid(icaoModel))
+        // ICAO type designator not valid but mode. Use model instead.
+        properties.icaoTypeDesignator = icaoModel;
+      else
+        properties.icaoTypeDesignator = icaoTypeDesignator;
+    }
   }
+  return properties;
 }
 
 void AircraftIndex::clear()
 {
+  stopWarming();
+  warmedPropertiesMap.clear();
   shortPathToPropertiesMap.clear();
   aircraftShortToFullPathMap.clear();
   loadedBasePaths.clear();
+  cacheChanged = false;
 }
 
 } // namespace scenery
@@ -19,14 +19,15 @@
 #define ATOOLS_AIRCRAFTINDEX_H
 
 #include <QHash>
+#include <QMutex>
 #include <QStringList>
 
+class QThreadPool;
+
 namespace atools {
 namespace fs {
 namespace scenery {
 
-struct AircraftProperties;
-
 /* .../Microsoft.FlightSimulator_8wekyb3d8bbwe/LocalCache/Packages/Official/OneStore/asobo-aircraft-208b-grand-caravan-ex/
  * .../Microsoft.FlightSimulator_8wekyb3d8bbwe/LocalCache/Packages/Community
  * "SimObjects/Airplanes/Asobo_B787_10/aircraft.cfg"
@@ -47,11 +48,30 @@ struct AircraftProperties;
  * icao_engine_count = 2
  * icao_WTC = "L"
  *
+ * Addon folders are scanned in parallel. Properties read from aircraft.cfg files are kept in an optional
+ * cache file and reused if modification time and size of the file did not change.
+ * All aircraft.cfg files not found in the cache are read in background after loading the index.
+ *
+ * Not thread safe. All methods have to be called from the same thread.
  */
 class AircraftIndex
 {
 public:
   explicit AircraftIndex(bool verboseParm);
+  ~AircraftIndex();
+
+  AircraftIndex(const AircraftIndex& other) = delete;
+  AircraftIndex& operator=(const AircraftIndex& other) = delete;
+
+  /* Set file used to persist properties read from aircraft.cfg files. Cache is not used if empty.
+   * Call before loadIndex(). */
+  void setCacheFile(const QString& filename)
+  {
+    cacheFile = filename;
+  }
+
+  /* Write all properties read so far to the cache file. Called by destructor. */
+  void saveCache();
 
   /* Load manifest and layout JSON and look for type AIRCRAFT in manifest and aircraft.cfg location in layout.
    * Store aircraft.cfg location in index but do not read aircraft.cfg.
@@ -59,6 +79,8 @@ public:
    * manifest.json   "content_type": "AIRCRAFT",
    *
    * Only for user aircraft.
+   *
+   * Reads properties from cache file and starts reading all remaining aircraft.cfg files in background.
    */
   void loadIndex(const QStringList& paths);
 
@@ -85,13 +107,54 @@ private:
   struct AircraftProperties
   {
     QString category, icaoTypeDesignator;
+
+    /* Modification time in ms since epoch and size of aircraft.cfg to validate cache entries */
+    qint64 lastModified = -1, fileSize = -1;
   };
 
   const AircraftProperties& fetchProperties(const QString& aircraftCfgFilepath);
 
+  /* Read aircraft.cfg from a full path. Thread safe. */
+  static AircraftProperties readAircraftCfg(const QString& aircraftCfgFullPath);
+
+  /* aircraft.cfg file found in an addon folder */
+  struct CfgFile
+  {
+    QString shortPath, fullPath;
+    qint64 lastModified = -1, fileSize = -1;
+  };
+
+  /* Read manifest and layout of an addon folder and return all aircraft.cfg files. Thread safe. */
+  static QList<CfgFile> readAddon(const QString& addonPath);
+
+  /* Load cache file and keep entries for the given files which are still valid. Returns number of entries used. */
+  int loadCache(const QList<CfgFile>& cfgFiles);
+
+  /* Start reading all aircraft.cfg files which are not in the index yet */
+  void warmCache();
+
+  /* Stop background reading and wait for completion */
+  void stopWarming();
+
+  /* Move all properties read in background to shortPathToPropertiesMap */
+  void mergeWarmed();
+
   /* Maps short path "SimObjects/Airplanes/Asobo_B787_10/aircraft.cfg" to aircraft type "B787" */
   QHash<QString, AircraftProperties> shortPathToPropertiesMap;
 
+  /* Properties read by background threads keyed by short path. Guarded by warmedMutex. */
+  QHash<QString, AircraftProperties> warmedPropertiesMap;
+  QMutex warmedMutex;
+  QThreadPool *warmPool = nullptr;
+
+  QString cacheFile;
+
+  /* Properties were read from files and cache needs to be saved */
+  bool cacheChanged = false;
+
+  const static quint32 CACHE_FILE_MAGIC_NUMBER = 0x6A1C3E94;
+  const static quint16 CACHE_FILE_VERSION = 1;
+
   /* Maps short path to full canonical path */
   QHash<QString, QString> aircraftShortToFullPathMap;
 
@@ -20,6 +20,7 @@
 #include "fs/scenery/fileresolver.h"
 #include "fs/scenery/layoutjson.h"
 #include "fs/scenery/sceneryarea.h"
+#include "fs/scenery/sceneryfilecache.h"
 
 #include <QtDebug>
 #include <QFile>
@@ -39,6 +40,33 @@ FileResolver::~FileResolver()
 {
 }
 
+QFileInfoList FileResolver::entryInfoList(const QString& dirPath, const QStringList& nameFilters, QDir::Filters filters) const
+{
+  if(cache != nullptr)
+  {
+    // Build file information from cached names - avoids enumerating unchanged directories
+    QFileInfoList entries;
+    const QStringList names = cache->entryList(dirPath, nameFilters, filters);
+    for(const QString& name : names)
+      entries.append(QFileInfo(dirPath + SEP + name));
+    return entries;
+  }
+  else
+    return QDir(dirPath).entryInfoList(nameFilters, filters, QDir::Name | QDir::IgnoreCase);
+}
+
+QStringList FileResolver::layoutBglPaths(const QString& layoutFilepath) const
+{
+  if(cache != nullptr)
+    return cache->layoutBglPaths(layoutFilepath);
+  else
+  {
+    scenery::LayoutJson layout;
+    layout.read(layoutFilepath);
+    return layout.getBglPaths();
+  }
+}
+
 int FileResolver::getFiles(const SceneryArea& area, QStringList *filepaths, QStringList *filenames)
 {
   if((!area.isActive() && !options.isReadInactive()) || !options.isIncludedLocalPath(area.getLocalPath()))
@@ -94,15 +122,14 @@ int FileResolver::getFiles(const SceneryArea& area, QStringList *filepaths, QStr
         // Get all scenery folders for FSX and P3D
         QDir sceneryAreaDir(sceneryArea.filePath());
 
-        sceneryDirs.append(sceneryAreaDir.entryInfoList({"scenery"}, QDir::Dirs | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot));
+        sceneryDirs.append(entryInfoList(sceneryAreaDir.path(), {"scenery"},
+                                         QDir::Dirs | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot));
 
         if(sceneryDirs.isEmpty() && sceneryAreaDir.dirName().toLower() == "scenery")
           // Special case where entry points to scenery directory which is allowed by P3D
           sceneryDirs.append(QFileInfo(sceneryAreaDir.path()));
       }
 
-      scenery::LayoutJson layout;
-
       // get all scenery directories - normally only one
       for(const QFileInfo& scenery : sceneryDirs)
       {
@@ -116,10 +143,8 @@ int FileResolver::getFiles(const SceneryArea& area, QStringList *filepaths, QStr
             if(options.getSimulatorType() == atools::fs::FsPaths::MSFS)
             {
               // Read MSFS layout file and add all BGL files ================
-              layout.clear();
-              layout.read(scenery.absoluteFilePath() + SEP + "layout.json");
-
-              for(const QString& path : layout.getBglPaths())
+              const QStringList bglPaths = layoutBglPaths(scenery.absoluteFilePath() + SEP + "layout.json");
+              for(const QString& path : bglPaths)
               {
                 // Fix paths with wrong case for testing on Linux
                 const static QRegularExpression SEPREGEXP("[\\/]");
@@ -134,25 +159,17 @@ int FileResolver::getFiles(const SceneryArea& area, QStringList *filepaths, QStr
             }
             else if(options.getSimulatorType() == atools::fs::FsPaths::MSFS_2024)
             {
-              QDir sceneryAreaDirObj(scenery.absoluteFilePath());
-              QFileInfoList dirs = sceneryAreaDirObj.entryInfoList(QDir::Dirs | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot,
-                                                                   QDir::Name | QDir::IgnoreCase);
-              for(const QFileInfo& dir : std::as_const(dirs))
-              {
-                QDir dirObj(dir.absoluteFilePath());
-                bglFiles.append(dirObj.entryInfoList({"*.bgl"},
-                                                     QDir::Files | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot,
-                                                     QDir::Name | QDir::IgnoreCase));
-
-              }
+              const QFileInfoList dirs = entryInfoList(scenery.absoluteFilePath(), QStringList(),
+                                                       QDir::Dirs | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot);
+              for(const QFileInfo& dir : dirs)
+                bglFiles.append(entryInfoList(dir.absoluteFilePath(), {"*.bgl"},
+                                              QDir::Files | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot));
             }
             else
             {
               // Read all BGL files from directory structure ==============
-              QDir sceneryAreaDirObj(scenery.absoluteFilePath());
-              bglFiles = sceneryAreaDirObj.entryInfoList({"*.bgl"},
-                                                         QDir::Files | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot,
-                                                         QDir::Name | QDir::IgnoreCase);
+              bglFiles = entryInfoList(scenery.absoluteFilePath(), {"*.bgl"},
+                                       QDir::Files | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot);
             }
 
             // Get all BGL files
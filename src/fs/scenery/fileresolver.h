@@ -21,6 +21,7 @@
 #include <QList>
 #include <QStringList>
 #include <QCoreApplication>
+#include <QDir>
 
 namespace atools {
 namespace fs {
@@ -28,6 +29,7 @@ class NavDatabaseOptions;
 namespace scenery {
 
 class SceneryArea;
+class SceneryFileCache;
 
 /*
  * Collects all BGL files for a scenery area considering include and exclude configuration options.
@@ -58,10 +60,24 @@ public:
     return errorMessages;
   }
 
+  /* Use cache for directory listings and layout files. Cache is not owned and can be shared between resolvers.
+   * Directories are read each time if null which is the default. */
+  void setCache(atools::fs::scenery::SceneryFileCache *value)
+  {
+    cache = value;
+  }
+
 private:
+  /* Get directory entries sorted by name ignoring case from cache or from file system */
+  QFileInfoList entryInfoList(const QString& dirPath, const QStringList& nameFilters, QDir::Filters filters) const;
+
+  /* Get BGL file paths from MSFS layout.json from cache or from file */
+  QStringList layoutBglPaths(const QString& layoutFilepath) const;
+
   QStringList errorMessages;
   const atools::fs::NavDatabaseOptions& options;
   bool quiet = false;
+  atools::fs::scenery::SceneryFileCache *cache = nullptr;
 };
 
 } // namespace scenery
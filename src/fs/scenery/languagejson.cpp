@@ -29,6 +29,8 @@
 #include <QJsonObject>
 #include <QDir>
 
+#include <cstring>
+
 namespace atools {
 namespace fs {
 namespace scenery {
@@ -38,6 +40,201 @@ const static QSet<QString> NO_NAMES = {
   "KEINE STADT", "KEIN BUNDESSTAAT", "NO CITY", "NO STATE", "SIN CIUDAD", "SIN ESTADO", "AUCUNE VILLE", "AUCUN ÉTAT",
   "NESSUNA CITTÀ", "NESSUNO STATO", "BRAK MIEJSCOWOŚCI", "BRAK STANU", "SEM CIDADE", "SEM ESTADO"};
 
+namespace locpak {
+
+/*
+ * Forward only reader for JSON in language files which works on the raw UTF-8 bytes.
+ * Strings are returned as raw byte ranges which allows to check keys before decoding them.
+ */
+class Reader
+{
+public:
+  explicit Reader(const QByteArray& bytes)
+    : pos(bytes.constData()), end(bytes.constData() + bytes.size())
+  {
+    // Skip UTF-8 BOM
+    if(end - pos >= 3 && memcmp(pos, "\xEF\xBB\xBF", 3) == 0)
+      pos += 3;
+  }
+
+  bool isValid() const
+  {
+    return valid;
+  }
+
+  /* Skip whitespace and return next character or 0 at end */
+  char peek()
+  {
+    while(pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\r' || *pos == '\n'))
+      pos++;
+    return pos < end ? *pos : '\0';
+  }
+
+  bool expect(char c)
+  {
+    if(peek() == c)
+    {
+      pos++;
+      return true;
+    }
+    valid = false;
+    return false;
+  }
+
+  /* Call after opening brace or after a member value. Returns true if another member follows.
+   * Consumes separating comma and closing brace. */
+  bool hasNextMember()
+  {
+    char c = peek();
+    if(c == ',')
+    {
+      pos++;
+      return true;
+    }
+    else if(c == '"')
+      return true;
+    else if(c == '}')
+      pos++;
+    else
+      valid = false;
+    return false;
+  }
+
+  /* Read string and get content without quotes. escaped is true if content contains escape sequences. */
+  bool readRawString(const char *& start, qsizetype& len, bool& escaped)
+  {
+    escaped = false;
+    if(!expect('"'))
+      return false;
+
+    start = pos;
+    while(pos < end && *pos != '"')
+    {
+      if(*pos == '\\')
+      {
+        escaped = true;
+        pos++;
+      }
+      pos++;
+    }
+
+    if(pos >= end)
+    {
+      valid = false;
+      return false;
+    }
+
+    len = pos - start;
+    pos++;
+    return true;
+  }
+
+  QString readString()
+  {
+    const char *start;
+    qsizetype len;
+    bool escaped;
+    if(readRawString(start, len, escaped))
+      return decode(start, len, escaped);
+    return QString();
+  }
+
+  /* Skip any value including nested objects and arrays */
+  void skipValue()
+  {
+    const char *start;
+    qsizetype len;
+    bool escaped;
+    int depth = 0;
+    do
+    {
+      char c = peek();
+      if(c == '"')
+        readRawString(start, len, escaped);
+      else if(c == '{' || c == '[')
+      {
+        depth++;
+        pos++;
+      }
+      else if(c == '}' || c == ']')
+      {
+        depth--;
+        pos++;
+      }
+      else if(c == ',' || c == ':')
+        pos++;
+      else if(c == '\0')
+        valid = false;
+      else
+      {
+        // Number or literal
+        while(pos < end && !strchr(",:{}[] \t\r\n\"", *pos))
+          pos++;
+      }
+    } while(depth > 0 && valid);
+  }
+
+  /* Convert raw string content to QString resolving escape sequences */
+  static QString decode(const char *start, qsizetype len, bool escaped)
+  {
+    if(!escaped)
+      return QString::fromUtf8(start, len);
+
+    QString str;
+    str.reserve(len);
+    const char *p = start, *stop = start + len, *segment = start;
+    while(p < stop)
+    {
+      if(*p == '\\' && p + 1 < stop)
+      {
+        str.append(QString::fromUtf8(segment, p - segment));
+        char c = p[1];
+        p += 2;
+        switch(c)
+        {
+          case 'b':
+            str.append('\b');
+            break;
+          case 'f':
+            str.append('\f');
+            break;
+          case 'n':
+            str.append('\n');
+            break;
+          case 'r':
+            str.append('\r');
+            break;
+          case 't':
+            str.append('\t');
+            break;
+          case 'u':
+            if(stop - p >= 4)
+            {
+              // Surrogate pairs are appended as two UTF-16 code units
+              str.append(QChar(static_cast<char16_t>(QByteArray(p, 4).toUShort(nullptr, 16))));
+              p += 4;
+            }
+            break;
+          default:
+            // Quote, backslash and slash
+            str.append(QLatin1Char(c));
+        }
+        segment = p;
+      }
+      else
+        p++;
+    }
+    str.append(QString::fromUtf8(segment, stop - segment));
+    return str;
+  }
+
+private:
+  const char *pos, *end;
+  bool valid = true;
+};
+
+} // namespace locpak
+
 /*
  *  {
  *  "LocalisationPackage": {
@@ -59,44 +256,152 @@ void LanguageJson::readFromFile(const QString& filename, const QStringList& keyP
     QFile file(filename);
     if(file.open(QIODevice::ReadOnly))
     {
-      QJsonParseError error;
-      QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
-      if(error.error != QJsonParseError::NoError)
-        qWarning() << Q_FUNC_INFO << "Error reading" << filename << error.errorString() << "at offset" << error.offset;
+      QByteArray bytes = file.readAll();
+      file.close();
+
+      if(!readStreaming(bytes, keyPrefixes))
+      {
+        // Fall back to the complete parser which also gives a better error message
+        qWarning() << Q_FUNC_INFO << "Streaming read failed for" << filename;
+        readDocument(bytes, filename, keyPrefixes);
+      }
+    }
+    else
+      qWarning() << Q_FUNC_INFO << "Cannot open file" << filename << file.errorString();
+  }
+}
+
+bool LanguageJson::readStreaming(const QByteArray& bytes, const QStringList& keyPrefixes)
+{
+  // Compare prefixes on raw bytes to avoid decoding all keys
+  QList<QByteArray> prefixes;
+  for(const QString& prefix : keyPrefixes)
+    prefixes.append(prefix.toUtf8());
+
+  locpak::Reader reader(bytes);
+  if(!reader.expect('{'))
+    return false;
+
+  while(reader.hasNextMember())
+  {
+    QString packageKey = reader.readString();
+    if(!reader.expect(':'))
+      return false;
+
+    if(packageKey != "LocalisationPackage")
+    {
+      reader.skipValue();
+      continue;
+    }
 
-      QJsonObject package = doc.object().value("LocalisationPackage").toObject();
+    if(!reader.expect('{'))
+      return false;
 
-      language = package.value("Language").toString();
-      adjustLanguage();
-      QJsonObject strings = package.value("Strings").toObject();
+    while(reader.hasNextMember())
+    {
+      QString memberKey = reader.readString();
+      if(!reader.expect(':'))
+        return false;
 
-      for(auto it = strings.constBegin(); it != strings.constEnd(); ++it)
+      if(memberKey == "Language")
       {
-        QString key = it.key();
-        if(keyPrefixes.isEmpty() || atools::strStartsWith(keyPrefixes, key))
+        language = reader.readString();
+        adjustLanguage();
+      }
+      else if(memberKey == "Strings")
+      {
+        if(!reader.expect('{'))
+          return false;
+
+        while(reader.hasNextMember())
         {
-          QString txt = it.value().toString();
+          const char *keyStart;
+          qsizetype keyLen;
+          bool keyEscaped;
+          if(!reader.readRawString(keyStart, keyLen, keyEscaped) || !reader.expect(':'))
+            return false;
 
-          if(!NO_NAMES.contains(txt))
-            names.insert(key, txt);
+          bool match = prefixes.isEmpty();
+          QString key;
+          if(keyEscaped)
+          {
+            key = locpak::Reader::decode(keyStart, keyLen, true);
+            match = match || atools::strStartsWith(keyPrefixes, key);
+          }
+          else
+          {
+            for(int i = 0; i < prefixes.size() && !match; i++)
+              match = keyLen >= prefixes.at(i).size() && memcmp(keyStart, prefixes.at(i).constData(),
+                                                                 static_cast<size_t>(prefixes.at(i).size())) == 0;
+          }
+
+          if(match && reader.peek() == '"')
+          {
+            if(key.isEmpty())
+              key = QString::fromUtf8(keyStart, keyLen);
+
+            QString txt = reader.readString();
+            if(!NO_NAMES.contains(txt))
+              names.insert(key, txt);
+          }
+          else
+            // Not needed - skip without decoding
+            reader.skipValue();
+
+          if(!reader.isValid())
+            return false;
         }
       }
-      file.close();
+      else
+        reader.skipValue();
+
+      if(!reader.isValid())
+        return false;
+    }
+  }
+
+  return reader.isValid();
+}
+
+void LanguageJson::readDocument(const QByteArray& bytes, const QString& filename, const QStringList& keyPrefixes)
+{
+  QJsonParseError error;
+  QJsonDocument doc = QJsonDocument::fromJson(bytes, &error);
+  if(error.error != QJsonParseError::NoError)
+    qWarning() << Q_FUNC_INFO << "Error reading" << filename << error.errorString() << "at offset" << error.offset;
+
+  QJsonObject package = doc.object().value("LocalisationPackage").toObject();
+
+  language = package.value("Language").toString();
+  adjustLanguage();
+  QJsonObject strings = package.value("Strings").toObject();
+
+  for(auto it = strings.constBegin(); it != strings.constEnd(); ++it)
+  {
+    QString key = it.key();
+    if(keyPrefixes.isEmpty() || atools::strStartsWith(keyPrefixes, key))
+    {
+      QString txt = it.value().toString();
+
+      if(!NO_NAMES.contains(txt))
+        names.insert(key, txt);
     }
-    else
-      qWarning() << Q_FUNC_INFO << "Cannot open file" << filename << file.errorString();
   }
 }
 
 void LanguageJson::readFromDirToDb(sql::SqlDatabase& db, const QString& dirname, const QString& fileFilter,
                                    const QStringList& keyPrefixes)
 {
+  // Write all languages in one transaction
   QDir dir(dirname);
   for(const QFileInfo& file: dir.entryInfoList({fileFilter}, QDir::Files))
   {
+    // Keep only translations of one file in memory
+    names.clear();
     readFromFile(file.filePath(), keyPrefixes);
-    writeToDb(db);
+    insertIntoDb(db);
   }
+  db.commit();
   clear();
 }
 
@@ -136,6 +441,12 @@ void LanguageJson::readFromDb(sql::SqlDatabase *db, const QString& languageParam
 }
 
 void LanguageJson::writeToDb(sql::SqlDatabase& db) const
+{
+  insertIntoDb(db);
+  db.commit();
+}
+
+void LanguageJson::insertIntoDb(sql::SqlDatabase& db) const
 {
   atools::sql::SqlQuery query(db);
   query.prepare("insert into translation (language, key, text) values(?, ?, ?)");
@@ -159,9 +470,7 @@ void LanguageJson::writeToDb(sql::SqlDatabase& db) const
       query.bindValue(1, key.replace("ATCCOM.AC_MODEL ", "ATCCOM.AC_MODEL_"));
       query.exec();
     }
-
   }
-  db.commit();
 }
 
 void LanguageJson::adjustLanguage()
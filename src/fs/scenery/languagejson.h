@@ -44,7 +44,7 @@ public:
   void readFromFile(const QString& filename, const QStringList& keyPrefixes = {});
 
   /* Read translations for all languages from directory using given file filter.
-   * Stores translations for all languages to database.
+   * Stores translations for all languages to database in one transaction.
    * Clears index after reading. */
   void readFromDirToDb(sql::SqlDatabase& db, const QString& dirname, const QString& fileFilter, const QStringList& keyPrefixes = {});
 
@@ -93,6 +93,16 @@ public:
 private:
   void adjustLanguage();
 
+  /* Read file content without building a document and decode only keys matching the prefixes.
+   * Returns false on syntax errors. */
+  bool readStreaming(const QByteArray& bytes, const QStringList& keyPrefixes);
+
+  /* Read file content using QJsonDocument */
+  void readDocument(const QByteArray& bytes, const QString& filename, const QStringList& keyPrefixes);
+
+  /* Insert index into translation table without commit */
+  void insertIntoDb(sql::SqlDatabase& db) const;
+
   /* Maps key like "TT:AIRPORTXX.MYNN.name" to text */
   QHash<QString, QString> names;
 
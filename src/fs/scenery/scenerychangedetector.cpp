@@ -0,0 +1,136 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/scenery/scenerychangedetector.h"
+
+#include "atools.h"
+#include "fs/bgl/bglfile.h"
+#include "fs/db/datawriter.h"
+#include "fs/navdatabaseoptions.h"
+#include "fs/scenery/fileresolver.h"
+#include "fs/scenery/sceneryarea.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QHash>
+
+namespace atools {
+namespace fs {
+namespace scenery {
+
+SceneryChangeDetector::SceneryChangeDetector(const NavDatabaseOptions& opts, sql::SqlDatabase& compiledDb)
+  : options(opts), db(compiledDb)
+{
+}
+
+SceneryChanges SceneryChangeDetector::detect(const QList<SceneryArea>& areas)
+{
+  struct StoredFile
+  {
+    QString filepath;
+    qint64 size, modificationTime;
+    bool found;
+  };
+
+  // Load all files from previous compilation ========================
+  QHash<QString, StoredFile> storedFiles;
+  atools::sql::SqlQuery query(db);
+  query.exec(QStringLiteral("select filepath, size, file_modification_time from bgl_file"));
+  while(query.next())
+  {
+    QString filepath = query.valueStr(QStringLiteral("filepath"));
+    storedFiles.insert(fileKey(filepath), {filepath, query.value(QStringLiteral("size")).toLongLong(),
+                                           query.value(QStringLiteral("file_modification_time")).toLongLong(), false});
+  }
+
+  // Compare with files in scenery library ========================
+  SceneryChanges changes;
+  FileResolver resolver(options, true /* noWarnings */);
+  for(const SceneryArea& area : areas)
+  {
+    if(area.isSimconnect())
+      continue;
+
+    QStringList filepaths;
+    resolver.getFiles(area, &filepaths);
+
+    bool areaChanged = false;
+    for(const QString& filepath : std::as_const(filepaths))
+    {
+      QString cleanFilepath = atools::nativeCleanPath(filepath);
+      auto it = storedFiles.find(fileKey(cleanFilepath));
+
+      if(it != storedFiles.end())
+      {
+        // Known file - compare size and time as written by BglFileWriter
+        it->found = true;
+        QFileInfo fileinfo(cleanFilepath);
+        if(fileinfo.size() != it->size || fileinfo.lastModified().toSecsSinceEpoch() != it->modificationTime)
+        {
+          changes.modifiedFiles.append(cleanFilepath);
+          areaChanged = true;
+        }
+      }
+      else if(hasSupportedSections(cleanFilepath))
+      {
+        changes.addedFiles.append(cleanFilepath);
+        areaChanged = true;
+      }
+    }
+
+    if(areaChanged)
+      changes.changedAreas.append(area.getTitle());
+  }
+
+  for(const StoredFile& file : std::as_const(storedFiles))
+  {
+    if(!file.found)
+      changes.removedFiles.append(file.filepath);
+  }
+
+  qDebug() << Q_FUNC_INFO << changes;
+  return changes;
+}
+
+QString SceneryChangeDetector::fileKey(const QString& filepath)
+{
+  return filepath.toLower();
+}
+
+bool SceneryChangeDetector::hasSupportedSections(const QString& filepath) const
+{
+  atools::fs::bgl::BglFile bglFile(&options);
+  bglFile.setSupportedSectionTypes(atools::fs::db::DataWriter::getSupportedSectionTypes());
+  bglFile.readFileSections(filepath);
+  return bglFile.isValid() && bglFile.hasSections();
+}
+
+QDebug operator<<(QDebug out, const SceneryChanges& changes)
+{
+  QDebugStateSaver saver(out);
+  out.noquote().nospace() << "SceneryChanges[added " << changes.addedFiles.size()
+                          << ", modified " << changes.modifiedFiles.size()
+                          << ", removed " << changes.removedFiles.size()
+                          << ", areas " << changes.changedAreas << "]";
+  return out;
+}
+
+} // namespace scenery
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,94 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_SCENERY_SCENERYCHANGEDETECTOR_H
+#define ATOOLS_SCENERY_SCENERYCHANGEDETECTOR_H
+
+#include <QDebug>
+#include <QStringList>
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+}
+
+namespace fs {
+class NavDatabaseOptions;
+namespace scenery {
+
+class SceneryArea;
+
+/* Result of SceneryChangeDetector::detect() */
+struct SceneryChanges
+{
+  /* Relevant BGL files which are not in the database yet */
+  QStringList addedFiles;
+
+  /* Files in database having a different size or modification time on disk */
+  QStringList modifiedFiles;
+
+  /* Files in database which are not found in the scenery library anymore */
+  QStringList removedFiles;
+
+  /* Titles of scenery areas containing added or modified files */
+  QStringList changedAreas;
+
+  bool isEmpty() const
+  {
+    return addedFiles.isEmpty() && modifiedFiles.isEmpty() && removedFiles.isEmpty();
+  }
+};
+
+QDebug operator<<(QDebug out, const atools::fs::scenery::SceneryChanges& changes);
+
+/*
+ * Compares the BGL files of the scenery library with the files recorded in table bgl_file of a
+ * previously compiled database by size and modification time.
+ *
+ * Only files which contributed data are stored in bgl_file. Therefore unknown files are only reported as
+ * added if their section table contains supported navdata sections.
+ *
+ * Only FSX, P3D and MSFS 2020 BGL based scenery libraries are supported.
+ */
+class SceneryChangeDetector
+{
+public:
+  /*
+   * @param opts Options which were used to compile the database
+   * @param compiledDb Previously compiled database having a bgl_file table
+   */
+  SceneryChangeDetector(const atools::fs::NavDatabaseOptions& opts, atools::sql::SqlDatabase& compiledDb);
+
+  /* Check all files of the active areas against the database */
+  atools::fs::scenery::SceneryChanges detect(const QList<atools::fs::scenery::SceneryArea>& areas);
+
+private:
+  /* Key for file lookup - database column is case insensitive */
+  static QString fileKey(const QString& filepath);
+
+  /* Reads only BGL header and section table */
+  bool hasSupportedSections(const QString& filepath) const;
+
+  const atools::fs::NavDatabaseOptions& options;
+  atools::sql::SqlDatabase& db;
+};
+
+} // namespace scenery
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_SCENERY_SCENERYCHANGEDETECTOR_H
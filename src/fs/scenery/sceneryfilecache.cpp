@@ -0,0 +1,193 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/scenery/sceneryfilecache.h"
+
+#include "fs/scenery/layoutjson.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStringBuilder>
+
+namespace atools {
+namespace fs {
+namespace scenery {
+
+SceneryFileCache::SceneryFileCache()
+{
+}
+
+SceneryFileCache::~SceneryFileCache()
+{
+}
+
+const SceneryFileCache::Entry *SceneryFileCache::findValid(const QString& key, qint64 lastModified, qint64 size)
+{
+  usedKeys.insert(key);
+
+  auto it = entries.constFind(key);
+  if(it != entries.constEnd() && it->lastModified == lastModified && it->size == size)
+  {
+    numHits++;
+    return &it.value();
+  }
+
+  numMisses++;
+  return nullptr;
+}
+
+QStringList SceneryFileCache::entryList(const QString& dirPath, const QStringList& nameFilters, QDir::Filters filters)
+{
+  QFileInfo dirInfo(dirPath);
+  if(!dirInfo.isDir())
+    return QStringList();
+
+  // Directory modification time changes if entries are added, removed or renamed
+  QString key = QStringLiteral("D|") % dirInfo.absoluteFilePath() % '|' % nameFilters.join(';') % '|' %
+                QString::number(static_cast<int>(filters));
+  qint64 lastModified = dirInfo.lastModified().toMSecsSinceEpoch();
+
+  const Entry *entry = findValid(key, lastModified, -1);
+  if(entry != nullptr)
+    return entry->names;
+
+  Entry newEntry;
+  newEntry.lastModified = lastModified;
+  newEntry.names = QDir(dirInfo.absoluteFilePath()).entryList(nameFilters, filters, QDir::Name | QDir::IgnoreCase);
+  changed = true;
+  return entries.insert(key, newEntry)->names;
+}
+
+QStringList SceneryFileCache::layoutBglPaths(const QString& layoutFilepath)
+{
+  QFileInfo fileInfo(layoutFilepath);
+  QString key = QStringLiteral("L|") % fileInfo.absoluteFilePath();
+  qint64 lastModified = fileInfo.exists() ? fileInfo.lastModified().toMSecsSinceEpoch() : -1;
+  qint64 size = fileInfo.exists() ? fileInfo.size() : -1;
+
+  const Entry *entry = findValid(key, lastModified, size);
+  if(entry != nullptr)
+    return entry->names;
+
+  LayoutJson layout;
+  layout.read(layoutFilepath);
+
+  Entry newEntry;
+  newEntry.lastModified = lastModified;
+  newEntry.size = size;
+  newEntry.names = layout.getBglPaths();
+  changed = true;
+  return entries.insert(key, newEntry)->names;
+}
+
+bool SceneryFileCache::load(const QString& filename)
+{
+  clear();
+
+  if(filename.isEmpty() || !QFile::exists(filename))
+    return false;
+
+  QFile file(filename);
+  if(!file.open(QIODevice::ReadOnly))
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot open" << filename << file.errorString();
+    return false;
+  }
+
+  QDataStream in(&file);
+  in.setVersion(QDataStream::Qt_5_5);
+
+  quint32 magic;
+  quint16 version;
+  qint32 size;
+  in >> magic >> version >> size;
+
+  if(magic != CACHE_FILE_MAGIC_NUMBER || version != CACHE_FILE_VERSION || in.status() != QDataStream::Ok)
+  {
+    qWarning() << Q_FUNC_INFO << "Invalid cache file" << filename;
+    return false;
+  }
+
+  entries.reserve(size);
+  for(qint32 i = 0; i < size && in.status() == QDataStream::Ok; i++)
+  {
+    QString key;
+    Entry entry;
+    in >> key >> entry.lastModified >> entry.size >> entry.names;
+    entries.insert(key, entry);
+  }
+
+  if(in.status() != QDataStream::Ok)
+  {
+    qWarning() << Q_FUNC_INFO << "Error reading cache file" << filename;
+    clear();
+    return false;
+  }
+
+  qDebug() << Q_FUNC_INFO << "Loaded" << entries.size() << "entries from" << filename;
+  return true;
+}
+
+bool SceneryFileCache::save(const QString& filename)
+{
+  // Also save if entries for removed directories or files can be dropped
+  if(filename.isEmpty() || (!changed && usedKeys.size() == entries.size()))
+    return true;
+
+  QSaveFile file(filename);
+  if(!file.open(QIODevice::WriteOnly))
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot open" << filename << file.errorString();
+    return false;
+  }
+
+  QDataStream out(&file);
+  out.setVersion(QDataStream::Qt_5_5);
+
+  // Write only entries used in this session
+  out << CACHE_FILE_MAGIC_NUMBER << CACHE_FILE_VERSION << static_cast<qint32>(usedKeys.size());
+  for(const QString& key : std::as_const(usedKeys))
+  {
+    const Entry& entry = entries[key];
+    out << key << entry.lastModified << entry.size << entry.names;
+  }
+
+  if(out.status() != QDataStream::Ok || !file.commit())
+  {
+    qWarning() << Q_FUNC_INFO << "Error writing cache file" << filename << file.errorString();
+    return false;
+  }
+
+  qDebug() << Q_FUNC_INFO << "Saved" << usedKeys.size() << "entries to" << filename << "hits" << numHits << "misses" << numMisses;
+  changed = false;
+  return true;
+}
+
+void SceneryFileCache::clear()
+{
+  entries.clear();
+  usedKeys.clear();
+  changed = false;
+  numHits = numMisses = 0;
+}
+
+} // namespace scenery
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,102 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_SCENERY_SCENERYFILECACHE_H
+#define ATOOLS_SCENERY_SCENERYFILECACHE_H
+
+#include <QDir>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+
+namespace atools {
+namespace fs {
+namespace scenery {
+
+/*
+ * Caches directory listings and BGL paths from MSFS layout.json files used by FileResolver.
+ *
+ * Directory listings are keyed by directory path and filters and are valid as long as the modification time
+ * of the directory does not change. Layout files are checked by modification time and size.
+ *
+ * Can be shared between counting and loading of files in one compilation and can be saved to
+ * a file to avoid enumerating unchanged directories in the next compilation.
+ *
+ * Not thread safe.
+ */
+class SceneryFileCache
+{
+public:
+  SceneryFileCache();
+  ~SceneryFileCache();
+
+  SceneryFileCache(const SceneryFileCache& other) = delete;
+  SceneryFileCache& operator=(const SceneryFileCache& other) = delete;
+
+  /* Get names of directory entries like QDir::entryList() sorted by name ignoring case.
+   * Returns an empty list if the directory does not exist. */
+  QStringList entryList(const QString& dirPath, const QStringList& nameFilters, QDir::Filters filters);
+
+  /* Get relative BGL file paths from an MSFS layout.json file. See LayoutJson::getBglPaths(). */
+  QStringList layoutBglPaths(const QString& layoutFilepath);
+
+  /* Load cache from file. Returns false if file does not exist or is not valid. */
+  bool load(const QString& filename);
+
+  /* Save cache to file if it was changed. Only entries used since loading are saved. Returns false on error. */
+  bool save(const QString& filename);
+
+  void clear();
+
+  int getNumHits() const
+  {
+    return numHits;
+  }
+
+  int getNumMisses() const
+  {
+    return numMisses;
+  }
+
+private:
+  struct Entry
+  {
+    qint64 lastModified = -1, size = -1;
+    QStringList names;
+  };
+
+  /* Returns entry for key if valid for given modification time and size. Otherwise null. */
+  const Entry *findValid(const QString& key, qint64 lastModified, qint64 size);
+
+  /* Keyed by directory path and filters or layout file path */
+  QHash<QString, Entry> entries;
+
+  /* Keys looked up since loading. Only these are saved. */
+  QSet<QString> usedKeys;
+
+  bool changed = false;
+  int numHits = 0, numMisses = 0;
+
+  const static quint32 CACHE_FILE_MAGIC_NUMBER = 0x52E4B1D7;
+  const static quint16 CACHE_FILE_VERSION = 1;
+};
+
+} // namespace scenery
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_SCENERY_SCENERYFILECACHE_H
@@ -20,13 +20,19 @@
 #include "geo/pos.h"
 #include "geo/rect.h"
 #include "geo/calculations.h"
+#include "geo/linestring.h"
+#include "fs/common/binarygeometry.h"
 #include "fs/util/coordinates.h"
+#include "fs/util/fsutil.h"
 #include "exception.h"
 #include "sql/sqlutil.h"
 #include "sql/sqlquery.h"
 
 #include <QFile>
 #include <QRegularExpression>
+#include <QThreadPool>
+
+#include <algorithm>
 
 using atools::sql::SqlQuery;
 using atools::sql::SqlUtil;
@@ -46,6 +52,7 @@ AirspaceReaderBase::AirspaceReaderBase(atools::sql::SqlDatabase *sqlDb)
   : db(sqlDb)
 {
   initQueries();
+  geometryPool = new QThreadPool;
 }
 
 void AirspaceReaderBase::readLine(const QStringList& line, int fileIdParam, const QString& filenameParam, int lineNumberParam)
@@ -66,6 +73,7 @@ void AirspaceReaderBase::finish()
 AirspaceReaderBase::~AirspaceReaderBase()
 {
   deInitQueries();
+  delete geometryPool;
 }
 
 void AirspaceReaderBase::reset()
@@ -102,6 +110,150 @@ AirspaceReaderBase::Format AirspaceReaderBase::detectFileFormat(const QString& f
   return UNKNOWN;
 }
 
+void AirspaceReaderBase::splitLine(QStringView line, QStringList& tokens)
+{
+  tokens.clear();
+
+  qsizetype start = -1;
+  for(qsizetype i = 0; i < line.size(); i++)
+  {
+    if(line.at(i).isSpace())
+    {
+      if(start != -1)
+        tokens.append(line.mid(start, i - start).toString());
+      start = -1;
+    }
+    else if(start == -1)
+      start = i;
+  }
+
+  if(start != -1)
+    tokens.append(line.mid(start).toString());
+
+  // Same as splitting an empty string
+  if(tokens.isEmpty())
+    tokens.append(QString());
+}
+
+void AirspaceReaderBase::addAirspace(const Airspace& airspace)
+{
+  pendingAirspaces.append(airspace);
+  if(pendingAirspaces.size() >= AIRSPACE_BATCH_SIZE)
+    flushAirspaces();
+}
+
+void AirspaceReaderBase::flushAirspaces()
+{
+  if(pendingAirspaces.isEmpty())
+    return;
+
+  // Each task writes only into its own airspace
+  Airspace *airspaceData = pendingAirspaces.data();
+  for(int i = 0; i < pendingAirspaces.size(); i++)
+    geometryPool->start([airspaceData, i]() {
+      buildGeometry(airspaceData[i]);
+    });
+  geometryPool->waitForDone();
+
+  // Insert in original order =========================
+  int savedLineNumber = lineNumber;
+  for(const Airspace& airspace : std::as_const(pendingAirspaces))
+  {
+    lineNumber = airspace.lineNumber;
+
+    if(airspace.invalidPointsRemoved && airspace.errorsToList)
+      errWarn(QStringLiteral("Found invalid coordinates in airspace"));
+
+    if(!airspace.error.isEmpty())
+    {
+      if(airspace.errorsToList)
+        errWarn(airspace.error);
+      else
+        qWarning() << Q_FUNC_INFO << airspace.error << airspace.context;
+      continue;
+    }
+
+    insertAirspaceQuery->bindValue(QStringLiteral(":boundary_id"), airspaceId++);
+    insertAirspaceQuery->bindValue(QStringLiteral(":file_id"), airspace.fileId);
+
+    for(const std::pair<QString, QVariant>& value : airspace.values)
+      insertAirspaceQuery->bindValue(value.first, value.second);
+
+    insertAirspaceQuery->bindValue(QStringLiteral(":max_lonx"), airspace.bounding.getEast());
+    insertAirspaceQuery->bindValue(QStringLiteral(":max_laty"), airspace.bounding.getNorth());
+    insertAirspaceQuery->bindValue(QStringLiteral(":min_lonx"), airspace.bounding.getWest());
+    insertAirspaceQuery->bindValue(QStringLiteral(":min_laty"), airspace.bounding.getSouth());
+    insertAirspaceQuery->bindValue(QStringLiteral(":geometry"), airspace.geometry);
+
+    insertAirspaceQuery->exec();
+    insertAirspaceQuery->clearBoundValues();
+    numAirspacesRead++;
+  }
+  lineNumber = savedLineNumber;
+
+  pendingAirspaces.clear();
+}
+
+void AirspaceReaderBase::buildGeometry(Airspace& airspace)
+{
+  // Densify arcs and circles ==================
+  LineString line;
+  for(const GeometryPart& part : std::as_const(airspace.parts))
+  {
+    switch(part.type)
+    {
+      case GeometryPart::POINT:
+        line.append(part.pos);
+        break;
+
+      case GeometryPart::ARC:
+        line.append(LineString(part.pos, part.start, part.end, part.clockwise, part.numSegments));
+        break;
+
+      case GeometryPart::CIRCLE:
+        line.append(LineString(part.pos, part.radiusMeter, part.numSegments));
+        break;
+    }
+  }
+
+  if(airspace.fallbackPos.isValid())
+  {
+    Rect bounding = line.boundingRect();
+    if(line.size() < 3 || bounding.isPoint() || !bounding.isValid())
+    {
+      // Replace invalid geometry
+      line.clear();
+      line.append(airspace.fallbackPos);
+    }
+  }
+
+  // Remove all remaining invalid points
+  qsizetype size = line.size();
+  if(airspace.removeOutOfRange)
+    line.erase(std::remove_if(line.begin(), line.end(), [](const Pos& pos) -> bool {
+      return !pos.isValidRange();
+    }), line.end());
+  else
+    line.removeInvalid();
+  airspace.invalidPointsRemoved = line.size() != size;
+
+  if(line.size() < airspace.minPoints)
+  {
+    airspace.error = line.isEmpty() ? QStringLiteral("No geometry found") : QStringLiteral("Airspace has not enough points");
+    return;
+  }
+
+  airspace.bounding = line.boundingRect();
+  if(airspace.requireArea && airspace.bounding.isPoint())
+  {
+    airspace.error = QStringLiteral("Found invalid bounding rectangle for airspace");
+    return;
+  }
+
+  // Create geometry blob
+  airspace.geometry = atools::fs::common::BinaryGeometry(atools::fs::util::correctBoundary(line)).writeToByteArray();
+}
+
 void AirspaceReaderBase::initQueries()
 {
   deInitQueries();
@@ -19,14 +19,17 @@
 #define ATOOLS_AIRSPACEREADER_BASE_H
 
 #include "fs/util/airportcoordtypes.h"
+#include "geo/rect.h"
 
 #include <QCoreApplication>
 #include <QList>
+#include <QVariant>
+
+class QThreadPool;
 
 namespace atools {
 namespace geo {
 class LineString;
-class Pos;
 }
 
 namespace sql {
@@ -39,6 +42,10 @@ namespace userdata {
 
 /*
  * Base class for reading airspace text formats. Provides SQL query and error collection methods.
+ *
+ * Readers collect airspaces including unresolved geometry like arcs and circles. These are queued and written in
+ * batches where geometry, bounding rectangles and blobs are calculated in worker threads before inserting
+ * all airspaces of a batch in the original order.
  */
 class AirspaceReaderBase
 {
@@ -124,7 +131,76 @@ public:
    * reader returns nothing for a not matching JSON schema */
   static Format detectFileFormat(const QString& file);
 
+  /* Split line at whitespace like line.simplified().split(' ') but reuses the list. */
+  static void splitLine(QStringView line, QStringList& tokens);
+
 protected:
+  /* Part of airspace geometry which is converted to points in a worker thread */
+  struct GeometryPart
+  {
+    enum Type
+    {
+      POINT, /* pos */
+      ARC, /* pos is center, start, end and clockwise */
+      CIRCLE /* pos is center and radiusMeter */
+    };
+
+    Type type = POINT;
+    atools::geo::Pos pos, start, end;
+    float radiusMeter = 0.f;
+    int numSegments = 48; /* Segments for full circle */
+    bool clockwise = true;
+  };
+
+  /* Airspace collected by readers which is written by flushAirspaces() */
+  struct Airspace
+  {
+    void bind(const QString& placeholder, const QVariant& value)
+    {
+      values.append(std::make_pair(placeholder, value));
+    }
+
+    void bindNullStr(const QString& placeholder)
+    {
+      bind(placeholder, QVariant(QMetaType::fromType<QString>()));
+    }
+
+    void addPoint(const atools::geo::Pos& pos)
+    {
+      GeometryPart part;
+      part.pos = pos;
+      parts.append(part);
+    }
+
+    /* Values for insert query except id, file id, bounding rectangle and geometry */
+    QList<std::pair<QString, QVariant> > values;
+    QList<GeometryPart> parts;
+
+    /* Replaces geometry if it has less than three points or no area. E.g. airport position */
+    atools::geo::Pos fallbackPos;
+
+    int minPoints = 1;
+    bool requireArea = false, /* Bounding rectangle must not be a point */
+         removeOutOfRange = false, /* Remove points not in valid range instead of invalid only */
+         errorsToList = false; /* Add errors to error list instead of logging only */
+
+    /* Context for messages */
+    int lineNumber = 0, fileId = 0;
+    QString context;
+
+    /* Results filled by worker thread */
+    QByteArray geometry;
+    atools::geo::Rect bounding;
+    QString error;
+    bool invalidPointsRemoved = false;
+  };
+
+  /* Queue airspace and write batch if full */
+  void addAirspace(const Airspace& airspace);
+
+  /* Build geometry for all queued airspaces in parallel and insert them in order */
+  void flushAirspaces();
+
   void initQueries();
   void deInitQueries();
 
@@ -144,6 +220,15 @@ protected:
   /* Callback to get airport coodinates by ICAO ident */
   atools::fs::util::AirportCoordFuncType fetchAirportCoordFunction = nullptr;
   void *fetchAirportCoordObject = nullptr;
+
+private:
+  /* Build points, bounding rectangle and geometry blob. Thread safe. */
+  static void buildGeometry(Airspace& airspace);
+
+  QList<Airspace> pendingAirspaces;
+  QThreadPool *geometryPool = nullptr;
+
+  const static int AIRSPACE_BATCH_SIZE = 256;
 };
 
 } // namespace userdata
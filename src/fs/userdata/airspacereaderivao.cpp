@@ -17,10 +17,8 @@
 
 #include "fs/userdata/airspacereaderivao.h"
 
-#include "fs/util/fsutil.h"
 #include "geo/calculations.h"
 #include "fs/util/coordinates.h"
-#include "fs/common/binarygeometry.h"
 #include "exception.h"
 #include "sql/sqlquery.h"
 #include "sql/sqlutil.h"
@@ -33,8 +31,6 @@
 using atools::sql::SqlQuery;
 using atools::sql::SqlUtil;
 using atools::geo::Pos;
-using atools::geo::Rect;
-using atools::geo::LineString;
 
 namespace atools {
 namespace fs {
@@ -147,76 +143,49 @@ bool AirspaceReaderIvao::readFile(const QString& filenameParam)
         QString middleIdent = obj.value(QStringLiteral("middle_identifier")).toString();
         QString name = obj.value(QStringLiteral("name")).toString();
 
-        // Fetch geometry ==================================================
-        LineString line;
-        QJsonArray coordinates = obj.value(QStringLiteral("map_region")).toArray();
-        for(int coordIdx = 0; coordIdx < coordinates.count(); coordIdx++)
-        {
-          QJsonObject coordObj = coordinates.at(coordIdx).toObject();
-          line.append(Pos(coordObj.value(QStringLiteral("lng")).toDouble(), coordObj.value(QStringLiteral("lat")).toDouble()));
-        }
-
         QString dbType = positionToDbType(position);
 
         if(!dbType.isEmpty() && !airportId.isEmpty())
         {
-          insertAirspaceQuery->bindValue(QStringLiteral(":boundary_id"), airspaceId++);
-          insertAirspaceQuery->bindValue(QStringLiteral(":file_id"), fileId);
-          insertAirspaceQuery->bindValue(QStringLiteral(":description"), name);
-          insertAirspaceQuery->bindValue(QStringLiteral(":type"), dbType);
+          Airspace airspace;
+          airspace.bind(QStringLiteral(":description"), name);
+          airspace.bind(QStringLiteral(":type"), dbType);
 
           // Unused fields here
-          insertAirspaceQuery->bindNullStr(QStringLiteral(":restrictive_designation"));
-          insertAirspaceQuery->bindNullStr(QStringLiteral(":restrictive_type"));
-          insertAirspaceQuery->bindNullStr(QStringLiteral(":multiple_code"));
-          insertAirspaceQuery->bindValue(QStringLiteral(":time_code"), QStringLiteral("U"));
+          airspace.bindNullStr(QStringLiteral(":restrictive_designation"));
+          airspace.bindNullStr(QStringLiteral(":restrictive_type"));
+          airspace.bindNullStr(QStringLiteral(":multiple_code"));
+          airspace.bind(QStringLiteral(":time_code"), QStringLiteral("U"));
 
           // Build ident string like "LEPA_S_TWR" as used in IVAO data JSON ==================
           QStringList ident({airportId, middleIdent, position});
           ident.removeAll(QStringLiteral());
-          insertAirspaceQuery->bindValue(QStringLiteral(":name"), ident.join('_'));
-
-          // Get airport position from callback ====================
-          Pos airportPos;
-          if(fetchAirportCoordFunction != nullptr)
-            airportPos = fetchAirportCoordFunction(airportId.toLatin1(), fetchAirportCoordObject);
+          airspace.bind(QStringLiteral(":name"), ident.join('_'));
 
-          Rect bounding = line.boundingRect();
-
-          if(airportPos.isValid() && (line.size() < 3 || bounding.isPoint() || !bounding.isValid()))
+          // Fetch geometry - bounding and blob are calculated in batch ======================
+          const QJsonArray coordinates = obj.value(QStringLiteral("map_region")).toArray();
+          for(const QJsonValue& coordValue : coordinates)
           {
-            // Replace invalid geometry with airport position
-            line.clear();
-            line.append(airportPos);
-            bounding = line.boundingRect();
+            QJsonObject coordObj = coordValue.toObject();
+            airspace.addPoint(Pos(coordObj.value(QStringLiteral("lng")).toDouble(), coordObj.value(QStringLiteral("lat")).toDouble()));
           }
 
-          line.removeInvalid();
-          bounding = line.boundingRect();
+          // Get airport position from callback to replace invalid geometry ====================
+          if(fetchAirportCoordFunction != nullptr)
+            airspace.fallbackPos = fetchAirportCoordFunction(airportId.toLatin1(), fetchAirportCoordObject);
 
-          if(!line.isEmpty())
-          {
-            insertAirspaceQuery->bindValue(QStringLiteral(":max_lonx"), bounding.getEast());
-            insertAirspaceQuery->bindValue(QStringLiteral(":max_laty"), bounding.getNorth());
-            insertAirspaceQuery->bindValue(QStringLiteral(":min_lonx"), bounding.getWest());
-            insertAirspaceQuery->bindValue(QStringLiteral(":min_laty"), bounding.getSouth());
-
-            // Create geometry blob
-            atools::fs::common::BinaryGeometry geo(atools::fs::util::correctBoundary(line));
-            insertAirspaceQuery->bindValue(QStringLiteral(":geometry"), geo.writeToByteArray());
-
-            insertAirspaceQuery->exec();
-            insertAirspaceQuery->clearBoundValues();
-            numAirspacesRead++;
-          }
-          else
-            qWarning() << Q_FUNC_INFO << "No geometry found" << airportId << middleIdent << position;
+          airspace.fileId = fileId;
+          airspace.context = ident.join('_');
+          addAirspace(airspace);
         }
         else
           qWarning() << Q_FUNC_INFO << "Invalid type" << airportId << middleIdent << position;
 
         reset();
       } // for(int i = 0; i < arr.count(); i++)
+
+      // Write remaining airspaces
+      flushAirspaces();
     } // if(error.error == QJsonParseError::NoError)
     else
       qWarning() << Q_FUNC_INFO << "Error reading" << filename << error.errorString() << "at offset" << error.offset;
@@ -20,7 +20,6 @@
 #include "fs/util/fsutil.h"
 #include "geo/calculations.h"
 #include "fs/util/coordinates.h"
-#include "fs/common/binarygeometry.h"
 #include "exception.h"
 #include "sql/sqlquery.h"
 
@@ -29,8 +28,6 @@
 
 using atools::sql::SqlQuery;
 using atools::geo::Pos;
-using atools::geo::Rect;
-using atools::geo::LineString;
 using atools::fs::util::fromOpenAirFormat;
 
 namespace atools {
@@ -62,19 +59,23 @@ bool AirspaceReaderOpenAir::readFile(const QString& filenameParam)
   {
     QTextStream stream(&file);
 
+    // Buffers are reused for all lines
+    QString line;
+    QStringList tokens;
     int lineNum = 0;
-    while(!stream.atEnd())
+    while(stream.readLineInto(&line))
     {
-      QString line = stream.readLine().trimmed();
+      QStringView lineView = QStringView(line).trimmed();
 
-      if(!line.startsWith("AN"))
+      if(!lineView.startsWith(QStringLiteral("AN")))
       {
         // Strip OpenAirport file comments except for airport names
-        int idx = line.indexOf("*");
+        qsizetype idx = lineView.indexOf('*');
         if(idx != -1)
-          line = line.left(line.indexOf("*"));
+          lineView = lineView.left(idx);
       }
-      readLine(line.simplified().split(" "), fileId, filename, lineNum);
+      splitLine(lineView, tokens);
+      readLine(tokens, fileId, filename, lineNum);
       lineNum++;
     }
     finish();
@@ -126,56 +127,26 @@ void AirspaceReaderOpenAir::readLine(const QStringList& line, int fileIdParam, c
 
 void AirspaceReaderOpenAir::writeBoundary()
 {
-  // insertAirspaceQuery->bindValue(":com_type", );
-  // insertAirspaceQuery->bindValue(":com_frequency", );
-  // insertAirspaceQuery->bindValue(":com_name", );
-  // insertAirspaceQuery->bindValue(":comment", );
+  // curAirspace.bind(":com_type", );
+  // curAirspace.bind(":com_frequency", );
+  // curAirspace.bind(":com_name", );
+  // curAirspace.bind(":comment", );
+
+  // Fields not used by X-Plane
+  curAirspace.bindNullStr(":restrictive_designation");
+  curAirspace.bindNullStr(":restrictive_type");
+  curAirspace.bindNullStr(":multiple_code");
+  curAirspace.bind(":time_code", "U");
+
+  // Geometry needs at least three points and an area - arcs and circles are calculated in batch
+  curAirspace.minPoints = 3;
+  curAirspace.requireArea = true;
+  curAirspace.removeOutOfRange = true;
+  curAirspace.errorsToList = true;
+  curAirspace.lineNumber = lineNumber;
+  curAirspace.fileId = fileId;
+  addAirspace(curAirspace);
 
-  insertAirspaceQuery->bindValue(":boundary_id", airspaceId++);
-  insertAirspaceQuery->bindValue(":file_id", fileId);
-
-  // Remove all remaining invalid points
-  auto it = std::remove_if(curLine.begin(), curLine.end(), [](const Pos& p) -> bool {
-          return !p.isValidRange();
-        });
-
-  if(it != curLine.end())
-  {
-    errWarn("Found invalid coordinates in airspace");
-    curLine.erase(it, curLine.end());
-  }
-
-  if(curLine.size() > 2)
-  {
-    // calculate bounding rectangle
-    Rect bounding = curLine.boundingRect();
-
-    if(!bounding.isPoint())
-    {
-      insertAirspaceQuery->bindValue(":max_lonx", bounding.getEast());
-      insertAirspaceQuery->bindValue(":max_laty", bounding.getNorth());
-      insertAirspaceQuery->bindValue(":min_lonx", bounding.getWest());
-      insertAirspaceQuery->bindValue(":min_laty", bounding.getSouth());
-
-      // Create geometry blob
-      atools::fs::common::BinaryGeometry geo(atools::fs::util::correctBoundary(curLine));
-      insertAirspaceQuery->bindValue(":geometry", geo.writeToByteArray());
-
-      // Fields not used by X-Plane
-      insertAirspaceQuery->bindNullStr(":restrictive_designation");
-      insertAirspaceQuery->bindNullStr(":restrictive_type");
-      insertAirspaceQuery->bindNullStr(":multiple_code");
-      insertAirspaceQuery->bindValue(":time_code", "U");
-
-      insertAirspaceQuery->exec();
-
-      numAirspacesRead++;
-    }
-    else
-      errWarn("Found invalid bounding rectangle for airspace");
-  }
-  else
-    errWarn("Airspace has not enough points");
   reset();
 }
 
@@ -191,7 +162,7 @@ void AirspaceReaderOpenAir::bindCoordinate(const QStringList& line)
     // DP coordinate - add polygon point
     Pos pos = fromOpenAirFormat(value);
     if(pos.isValidRange())
-      curLine.append(pos);
+      curAirspace.addPoint(pos);
     else
       errWarn("Found invalid coordinates in airspace record DP: \"" + value + "\"");
   }
@@ -208,7 +179,7 @@ void AirspaceReaderOpenAir::bindCoordinate(const QStringList& line)
       Pos pos1 = center.endpoint(atools::geo::nmToMeter(radius), angleStart);
       Pos pos2 = center.endpoint(atools::geo::nmToMeter(radius), angleEnd);
       if(pos1.isValid() && pos2.isValid() && center.isValidRange())
-        curLine.append(LineString(center, pos1, pos2, clockwise, CIRCLE_SEGMENTS));
+        addArc(pos1, pos2, CIRCLE_SEGMENTS);
       else
         errWarn("Found invalid coordinates in airspace record DA: \"" + value + "\"");
     }
@@ -221,7 +192,7 @@ void AirspaceReaderOpenAir::bindCoordinate(const QStringList& line)
     Pos pos2 = fromOpenAirFormat(value.section(',', 1, 1).trimmed());
 
     if(pos1.isValid() && pos2.isValid() && center.isValidRange())
-      curLine.append(LineString(center, pos1, pos2, clockwise, CIRCLE_SEGMENTS));
+      addArc(pos1, pos2, CIRCLE_SEGMENTS);
     else
       errWarn("Found invalid coordinates in airspace record DB: \"" + value + "\"");
     clockwise = true;
@@ -231,7 +202,14 @@ void AirspaceReaderOpenAir::bindCoordinate(const QStringList& line)
     // DC radius - draw a circle (center taken from the previous V X=... record, radius in nm
     float radius = value.toFloat();
     if(radius > 0.2f && center.isValidRange())
-      curLine.append(LineString(center, atools::geo::nmToMeter(radius), CIRCLE_SEGMENTS));
+    {
+      GeometryPart part;
+      part.type = GeometryPart::CIRCLE;
+      part.pos = center;
+      part.radiusMeter = atools::geo::nmToMeter(radius);
+      part.numSegments = CIRCLE_SEGMENTS;
+      curAirspace.parts.append(part);
+    }
     else
       // Small values are apparently used to define colors
       qWarning() << filename << ":" << lineNumber
@@ -264,9 +242,21 @@ void AirspaceReaderOpenAir::bindCoordinate(const QStringList& line)
   }
 }
 
+void AirspaceReaderOpenAir::addArc(const Pos& start, const Pos& end, int numSegments)
+{
+  GeometryPart part;
+  part.type = GeometryPart::ARC;
+  part.pos = center;
+  part.start = start;
+  part.end = end;
+  part.clockwise = clockwise;
+  part.numSegments = numSegments;
+  curAirspace.parts.append(part);
+}
+
 void AirspaceReaderOpenAir::bindName(const QString& name)
 {
-  insertAirspaceQuery->bindValue(":name", name);
+  curAirspace.bind(":name", name);
 }
 
 void AirspaceReaderOpenAir::bindClass(const QString& cls)
@@ -308,7 +298,7 @@ void AirspaceReaderOpenAir::bindClass(const QString& cls)
     qWarning() << filename << ":" << lineNumber << "Unknown airspace class" << cls;
     type = cls;
   }
-  insertAirspaceQuery->bindValue(":type", type);
+  curAirspace.bind(":type", type);
 }
 
 void AirspaceReaderOpenAir::bindAltitude(const QStringList& line, bool isMax)
@@ -385,20 +375,21 @@ void AirspaceReaderOpenAir::bindAltitude(const QStringList& line, bool isMax)
     }
   }
 
-  insertAirspaceQuery->bindValue(prefix + "_altitude_type", type);
-  insertAirspaceQuery->bindValue(prefix + "_altitude", altitude);
+  curAirspace.bind(prefix + "_altitude_type", type);
+  curAirspace.bind(prefix + "_altitude", altitude);
 }
 
 void AirspaceReaderOpenAir::finish()
 {
   writeBoundary();
+  flushAirspaces();
 }
 
 void AirspaceReaderOpenAir::reset()
 {
   AirspaceReaderBase::reset();
 
-  curLine.clear();
+  curAirspace = Airspace();
   clockwise = true;
   writingCoordinates = false;
   center = Pos();
@@ -58,14 +58,20 @@ public:
   virtual void reset() override;
 
 private:
+  /* Queue current airspace for writing */
   void writeBoundary();
   void bindAltitude(const QStringList& line, bool isMax);
   void bindClass(const QString& cls);
   void bindName(const QString& name);
   void bindCoordinate(const QStringList& line);
 
+  /* Add arc around center to current airspace */
+  void addArc(const atools::geo::Pos& start, const atools::geo::Pos& end, int numSegments);
+
   bool writingCoordinates = false;
-  atools::geo::LineString curLine;
+
+  /* Values and geometry of the airspace being read */
+  Airspace curAirspace;
   atools::geo::Pos center;
   bool clockwise = true;
 };
@@ -17,9 +17,7 @@
 
 #include "fs/userdata/airspacereadervatsim.h"
 
-#include "fs/common/binarygeometry.h"
 #include "exception.h"
-#include "fs/util/fsutil.h"
 #include "sql/sqlquery.h"
 #include "sql/sqlutil.h"
 
@@ -33,8 +31,6 @@
 using atools::sql::SqlQuery;
 using atools::sql::SqlUtil;
 using atools::geo::Pos;
-using atools::geo::Rect;
-using atools::geo::LineString;
 
 namespace atools {
 namespace fs {
@@ -197,98 +193,78 @@ bool AirspaceReaderVatsim::readFile(const QString& filenameParam)
               break;
             }
 
-            // Read coordinate pairs of a ring ===================
-            LineString line;
+            // Read coordinate pairs of a ring - bounding and blob are calculated in batch ===================
+            Airspace airspace;
             const QJsonArray ringArrays = ringArr.at(ringIndex).toArray();
             for(const QJsonValue& ringValue : ringArrays)
             {
               QJsonArray ringArray = ringValue.toArray();
               if(ringArray.size() == 2)
-                line.append(atools::geo::Pos(ringArray.at(0).toDouble(), ringArray.at(1).toDouble()));
+                airspace.addPoint(atools::geo::Pos(ringArray.at(0).toDouble(), ringArray.at(1).toDouble()));
               else
                 qWarning() << Q_FUNC_INFO << "Invalid number of ordinates" << ringArray.size()
                            << "id" << id << "region" << region << "division" << division;
             }
 
-            line.removeInvalid();
+            // Unused fields here
+            airspace.bindNullStr(QStringLiteral(":restrictive_designation"));
+            airspace.bindNullStr(QStringLiteral(":restrictive_type"));
+            airspace.bindNullStr(QStringLiteral(":multiple_code"));
+            airspace.bind(QStringLiteral(":time_code"), QStringLiteral("U"));
 
-            if(!line.isEmpty())
+            // Build boundary name
+            QStringList ident;
+            if(propertiesObj.contains(QStringLiteral("oceanic")))
             {
-              insertAirspaceQuery->bindValue(QStringLiteral(":boundary_id"), airspaceId++);
-              insertAirspaceQuery->bindValue(QStringLiteral(":file_id"), fileId);
-
-              // Unused fields here
-              insertAirspaceQuery->bindNullStr(QStringLiteral(":restrictive_designation"));
-              insertAirspaceQuery->bindNullStr(QStringLiteral(":restrictive_type"));
-              insertAirspaceQuery->bindNullStr(QStringLiteral(":multiple_code"));
-              insertAirspaceQuery->bindValue(QStringLiteral(":time_code"), QStringLiteral("U"));
+              // Center - only firboundaries.json
+              ident.append(id.replace('-', '_').replace(QStringLiteral("__"), QStringLiteral("_")) % QStringLiteral("_CTR"));
+              ident.removeAll(QStringLiteral());
+              airspace.bind(QStringLiteral(":type"), QStringLiteral("C"));
+              airspace.bind(QStringLiteral(":name"), ident.join('_'));
+              airspace.bind(QStringLiteral(":description"), QString(id.section(REGEXP_DESCR, 0, 0) % QStringLiteral(" Center")));
+            }
+            else
+            {
+              // TRACON: Departure or approach from traconboundaries.json
+              if(!prefixes.isEmpty())
+              {
+                for(const QString& prefix : prefixes)
+                {
+                  if(prefix != id)
+                    ident.append(prefix);
+                }
+              }
+              ident.append(id);
 
-              // Build boundary name
-              QStringList ident;
-              if(propertiesObj.contains(QStringLiteral("oceanic")))
+              // TRACON
+              QString suffix = propertiesObj.value(QStringLiteral("suffix")).toString();
+              if(suffix == QStringLiteral("DEP"))
               {
-                // Center - only firboundaries.json
-                ident.append(id.replace('-', '_').replace(QStringLiteral("__"), QStringLiteral("_")) % QStringLiteral("_CTR"));
-                ident.removeAll(QStringLiteral());
-                insertAirspaceQuery->bindValue(QStringLiteral(":type"), QStringLiteral("C"));
-                insertAirspaceQuery->bindValue(QStringLiteral(":name"), ident.join('_'));
-                insertAirspaceQuery->bindValue(QStringLiteral(":description"),
-                                               QString(id.section(REGEXP_DESCR, 0, 0) % QStringLiteral(" Center")));
+                // Departure
+                ident.append(QStringLiteral("DEP"));
+                airspace.bind(QStringLiteral(":type"), QStringLiteral("D"));
               }
               else
               {
-                // TRACON: Departure or approach from traconboundaries.json
-                if(!prefixes.isEmpty())
-                {
-                  for(const QString& prefix : prefixes)
-                  {
-                    if(prefix != id)
-                      ident.append(prefix);
-                  }
-                }
-                ident.append(id);
-
-                // TRACON
-                QString suffix = propertiesObj.value(QStringLiteral("suffix")).toString();
-                if(suffix == QStringLiteral("DEP"))
-                {
-                  // Departure
-                  ident.append(QStringLiteral("DEP"));
-                  insertAirspaceQuery->bindValue(QStringLiteral(":type"), QStringLiteral("D"));
-                }
-                else
-                {
-                  // Approach
-                  ident.append(QStringLiteral("APP"));
-                  insertAirspaceQuery->bindValue(QStringLiteral(":type"), QStringLiteral("A"));
-                }
-
-                ident.removeAll(QStringLiteral());
-                insertAirspaceQuery->bindValue(QStringLiteral(":name"), ident.join('_'));
-                insertAirspaceQuery->bindValue(QStringLiteral(":description"), propertiesObj.value(QStringLiteral("name")).toString());
+                // Approach
+                ident.append(QStringLiteral("APP"));
+                airspace.bind(QStringLiteral(":type"), QStringLiteral("A"));
               }
 
-              // Assign bounding rectangle
-              Rect bounding = line.boundingRect();
-              insertAirspaceQuery->bindValue(QStringLiteral(":max_lonx"), bounding.getEast());
-              insertAirspaceQuery->bindValue(QStringLiteral(":max_laty"), bounding.getNorth());
-              insertAirspaceQuery->bindValue(QStringLiteral(":min_lonx"), bounding.getWest());
-              insertAirspaceQuery->bindValue(QStringLiteral(":min_laty"), bounding.getSouth());
-
-              // Create geometry blob
-              atools::fs::common::BinaryGeometry geo(atools::fs::util::correctBoundary(line));
-              insertAirspaceQuery->bindValue(QStringLiteral(":geometry"), geo.writeToByteArray());
-
-              insertAirspaceQuery->exec();
-              insertAirspaceQuery->clearBoundValues();
-              numAirspacesRead++;
+              ident.removeAll(QStringLiteral());
+              airspace.bind(QStringLiteral(":name"), ident.join('_'));
+              airspace.bind(QStringLiteral(":description"), propertiesObj.value(QStringLiteral("name")).toString());
             }
-            else
-              qWarning() << Q_FUNC_INFO << "No geometry found"
-                         << "Ignoring all except first." << "id" << id << "region" << region << "division" << division;
+
+            airspace.fileId = fileId;
+            airspace.context = QStringLiteral("id %1 region %2 division %3").arg(id).arg(region).arg(division);
+            addAirspace(airspace);
           }
         }
       }
+
+      // Write remaining airspaces
+      flushAirspaces();
     } // if(error.error == QJsonParseError::NoError)
     else
       qWarning() << Q_FUNC_INFO << "Error reading" << filename << error.errorString() << "at offset" << error.offset;
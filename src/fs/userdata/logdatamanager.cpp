@@ -17,12 +17,15 @@
 
 #include "fs/userdata/logdatamanager.h"
 
+#include "fs/gpx/gpxbinary.h"
 #include "fs/gpx/gpxio.h"
+#include "fs/userdata/logstatistics.h"
 #include "sql/sqltransaction.h"
 #include "sql/sqlutil.h"
 #include "sql/sqlexport.h"
 #include "sql/sqldatabase.h"
 #include "util/csvreader.h"
+#include "util/memoryusage.h"
 #include "geo/pos.h"
 #include "zip/gzip.h"
 #include "geo/calculations.h"
@@ -32,6 +35,8 @@
 #include <QDateTime>
 #include <QDir>
 #include <QStringBuilder>
+#include <QThread>
+#include <QThreadPool>
 
 namespace atools {
 namespace fs {
@@ -148,14 +153,23 @@ LogdataManager::LogdataManager(sql::SqlDatabase *sqlDb)
   : DataManagerBase(sqlDb, "logbook", "logbook_id",
                     {":/atools/resources/sql/fs/logbook/create_logbook_schema.sql"},
                     ":/atools/resources/sql/fs/logbook/create_logbook_schema_undo.sql",
-                    ":/atools/resources/sql/fs/logbook/drop_logbook_schema.sql"), cache(MAX_CACHE_ENTRIES)
+                    ":/atools/resources/sql/fs/logbook/drop_logbook_schema.sql"), cache(DEFAULT_GPX_CACHE_MB * 1024)
 {
+  statistics = new LogStatistics(sqlDb, tableName, idColumnName);
 
+  // Leave threads for the caller
+  gpxThreadPool = new QThreadPool;
+  gpxThreadPool->setMaxThreadCount(std::max(1, QThread::idealThreadCount() / 2));
 }
 
 LogdataManager::~LogdataManager()
 {
+  // Wait for running decoding which accesses the cache
+  gpxThreadPool->clear();
+  gpxThreadPool->waitForDone();
+  delete gpxThreadPool;
 
+  delete statistics;
 }
 
 int LogdataManager::importCsv(const QString& filepath)
@@ -174,41 +188,32 @@ int LogdataManager::importCsv(const QString& filepath)
 
     atools::util::CsvReader reader;
 
-    QTextStream stream(&file);
+    // Read file at once and tokenize bytes without decoding whole lines
+    QByteArray data = atools::util::CsvReader::toUtf8(file.readAll());
+    qsizetype offset = 0;
+    bool first = true;
+    startImportCallback();
 
-    int lineNum = 1;
-    while(!stream.atEnd())
+    while(reader.readCsvRecord(data, offset))
     {
-      QString line = stream.readLine();
+      const QStringList& values = reader.getValues();
 
-      if(lineNum == 1)
+      if(first)
       {
-        QString header = QString(line).simplified().replace(' ', QStringLiteral()).replace('"', QStringLiteral()).toLower();
+        first = false;
+        QString header = values.join(',').simplified().replace(' ', QStringLiteral()).toLower();
         if(header.startsWith(csv::HEADER_LINE) || header.startsWith(csv::HEADER_LINE2))
-        {
-          lineNum++;
           // Ignore header
           continue;
-        }
       }
 
-      // Skip empty lines but add them if within an escaped field
-      if(line.isEmpty() && !reader.isInEscape())
-        continue;
-
-      reader.readCsvLine(line);
-      if(reader.isInEscape())
-        // Still in an escaped line so continue to read unchanged until " shows the end of the field
-        continue;
-
-      const QStringList& values = reader.getValues();
-
       if(values.size() < csv::MIN_NUM_COLS)
-        throw atools::Exception(tr("File contains invalid data.\n\"%1\"\nLine %2.").arg(line).arg(lineNum));
+        throw atools::Exception(tr("File contains invalid data.\n\"%1\"\nLine %2.").
+                                arg(reader.getRecordText()).arg(reader.getRecordLineNumber()));
 
       if(at(values, csv::DEPARTURE_IDENT).isEmpty() && at(values, csv::DESTINATION_IDENT).isEmpty())
-        throw atools::Exception(tr("File is not valid. Neither departure nor destination ident is set.\n\"%1\"\nLine %2.").arg(line).arg(
-                                  lineNum));
+        throw atools::Exception(tr("File is not valid. Neither departure nor destination ident is set.\n\"%1\"\nLine %2.").
+                                arg(reader.getRecordText()).arg(reader.getRecordLineNumber()));
 
       insertQuery.bindValue(idBinding, id++);
 
@@ -304,10 +309,12 @@ int LogdataManager::importCsv(const QString& filepath)
       // Reset unassigned fields to null
       insertQuery.clearBoundValues();
 
-      lineNum++;
       numImported++;
+      if(!invokeImportCallback(numImported))
+        break;
     }
 
+    invokeImportCallback(numImported, true /* force */);
     file.close();
     undoHandler.finish();
   } // if(file.open(QIODevice::ReadOnly | QIODevice::Text))
@@ -541,7 +548,7 @@ int LogdataManager::exportCsv(const QString& filepath, const QList<int>& ids, bo
                                 csv::COL_MAP.value(csv::FLIGHTPLAN).getDisplayName());
     sqlExport.addConversionFunc(exportPerf ? blobConversionFunction : blobConversionFunctionEmpty,
                                 csv::COL_MAP.value(csv::AIRCRAFT_PERF).getDisplayName());
-    sqlExport.addConversionFunc(exportGpx ? blobConversionFunction : blobConversionFunctionEmpty,
+    sqlExport.addConversionFunc(exportGpx ? trailConversionFunction : blobConversionFunctionEmpty,
                                 csv::COL_MAP.value(csv::AIRCRAFT_TRAIL).getDisplayName());
 
     bool first = true;
@@ -581,6 +588,77 @@ QString LogdataManager::blobConversionFunction(const QVariant& value)
   return QStringLiteral();
 }
 
+QString LogdataManager::trailConversionFunction(const QVariant& value)
+{
+  if(!atools::isVariantNull(value) && value.metaType() == QMetaType::fromType<QByteArray>())
+  {
+    QByteArray bytes = value.toByteArray();
+    if(atools::fs::gpx::GpxBinary::isBinaryTrack(bytes))
+    {
+      // Always export GPX text
+      try
+      {
+        atools::fs::gpx::GpxData gpxData;
+        atools::fs::gpx::GpxBinary::decode(gpxData, bytes);
+        return atools::fs::gpx::GpxIO().saveGpxStr(gpxData);
+      }
+      catch(atools::Exception& e)
+      {
+        qWarning() << Q_FUNC_INFO << "Error decoding binary track" << e.what();
+        return QStringLiteral();
+      }
+    }
+    else
+      return QString(atools::zip::gzipDecompress(bytes));
+  }
+
+  return QStringLiteral();
+}
+
+int LogdataManager::convertTrails(bool binary)
+{
+  QList<std::pair<int, QByteArray> > converted;
+
+  // Read all first to avoid modifying the table while iterating
+  SqlQuery query("select " % idColumnName % ", aircraft_trail from " % tableName % " where aircraft_trail is not null", db);
+  query.exec();
+  while(query.next())
+  {
+    QByteArray bytes = query.value(1).toByteArray();
+    if(bytes.isEmpty() || atools::fs::gpx::GpxBinary::isBinaryTrack(bytes) == binary)
+      continue;
+
+    try
+    {
+      converted.append(std::make_pair(query.valueInt(0), binary ? atools::fs::gpx::GpxBinary::gpxGzToBinary(bytes) :
+                                      atools::fs::gpx::GpxBinary::binaryToGpxGz(bytes)));
+    }
+    catch(atools::Exception& e)
+    {
+      // Keep entry unchanged
+      qWarning() << Q_FUNC_INFO << "Error converting track for id" << query.valueInt(0) << e.what();
+    }
+  }
+
+  if(!converted.isEmpty())
+  {
+    // Content does not change - no need for undo
+    SqlTransaction transaction(db);
+    SqlQuery update(db);
+    update.prepare("update " % tableName % " set aircraft_trail = :trail where " % idColumnName % " = :id");
+    for(const std::pair<int, QByteArray>& entry : std::as_const(converted))
+    {
+      update.bindValue(":trail", entry.second);
+      update.bindValue(":id", entry.first);
+      update.exec();
+    }
+    transaction.commit();
+  }
+
+  qDebug() << Q_FUNC_INFO << "Converted" << converted.size() << "tracks to" << (binary ? "binary" : "GPX");
+  return static_cast<int>(converted.size());
+}
+
 void LogdataManager::updateSchema()
 {
   addColumnIf("route_string", "varchar(1024)");
@@ -624,21 +702,68 @@ void LogdataManager::repairDateTime(const QString& column)
   if(num > 0)
     qDebug() << Q_FUNC_INFO << "Updated" << num << "rows with new date in logbook." << column << "using timezone" << offsetStr;
   transaction.commit();
+
+  if(num > 0)
+    tableChanged();
 }
 
 void LogdataManager::clearGeometryCache()
 {
+  QMutexLocker locker(&gpxMutex);
   cache.clear();
+  gpxPending.clear();
+  gpxGeneration++;
+}
+
+void LogdataManager::setGpxCacheSizeMb(int sizeMb)
+{
+  QMutexLocker locker(&gpxMutex);
+  cache.setMaxCost(std::max(1, sizeMb) * 1024);
+}
+
+void LogdataManager::getMemoryUsage(atools::util::MemoryUsage& usage) const
+{
+  // Cost is the decoded size in kB
+  QMutexLocker locker(&gpxMutex);
+  usage.add(QStringLiteral("LogdataManager/gpxCache"), static_cast<qint64>(cache.totalCost()) * 1024, cache.size());
 }
 
 void LogdataManager::preCleanup()
 {
   sql::DataManagerBase::preCleanup(CLEANUP_COLUMNS);
+
+  // Null and empty values are counted differently
+  tableChanged();
 }
 
 void LogdataManager::postCleanup()
 {
   sql::DataManagerBase::postCleanup(CLEANUP_COLUMNS);
+  tableChanged();
+}
+
+void LogdataManager::rowsChanged(const QSet<int>& ids)
+{
+  statistics->update(ids);
+
+  QMutexLocker locker(&gpxMutex);
+  for(int id : ids)
+  {
+    cache.remove(id);
+
+    if(gpxPending.contains(id))
+    {
+      // Drop all outdated results from queued decoding
+      gpxPending.clear();
+      gpxGeneration++;
+    }
+  }
+}
+
+void LogdataManager::tableChanged()
+{
+  statistics->invalidate();
+  clearGeometryCache();
 }
 
 QString LogdataManager::getCleanupPreview(bool departureAndDestEqual, bool departureOrDestEmpty, float minFlownDistance,
@@ -704,79 +829,116 @@ bool LogdataManager::hasTrackAttached(int id)
 
 const gpx::GpxData *LogdataManager::getGpxData(int id)
 {
-  loadGpx(id);
-  return cache.object(id);
+  lastGpxData = getGpxDataCached(id);
+
+  if(lastGpxData.isNull())
+  {
+    quint32 generation;
+    {
+      QMutexLocker locker(&gpxMutex);
+      generation = gpxGeneration;
+    }
+
+    QSharedPointer<gpx::GpxData> gpxData(new gpx::GpxData);
+    atools::fs::gpx::GpxBinary::decodeAny(*gpxData, getValue(id, "aircraft_trail").toByteArray());
+    lastGpxData = gpxData;
+    insertGpxData(id, lastGpxData, generation);
+  }
+
+  return lastGpxData.data();
+}
+
+GpxDataPtr LogdataManager::getGpxDataCached(int id)
+{
+  QMutexLocker locker(&gpxMutex);
+  GpxDataPtr *gpxData = cache.object(id);
+  return gpxData != nullptr ? *gpxData : GpxDataPtr();
 }
 
-void LogdataManager::loadGpx(int id)
+bool LogdataManager::insertGpxData(int id, const GpxDataPtr& gpxData, quint32 generation)
 {
-  if(!cache.contains(id))
+  QMutexLocker locker(&gpxMutex);
+  if(generation != gpxGeneration)
+    // Cache was cleared or entry changed after loading the BLOB
+    return false;
+
+  gpxPending.remove(id);
+
+  // Cost in kB
+  qsizetype cost = static_cast<qsizetype>(std::max<qint64>(1, gpxData->getMemorySize() / 1024));
+  return cache.insert(id, new GpxDataPtr(gpxData), cost);
+}
+
+void LogdataManager::prefetchGpxData(const QList<int>& ids)
+{
+  for(int id : ids)
   {
-    gpx::GpxData *entry = new gpx::GpxData;
-    atools::fs::gpx::GpxIO().loadGpxGz(*entry, getValue(id, "aircraft_trail").toByteArray());
-    cache.insert(id, entry);
+    quint32 generation;
+    {
+      QMutexLocker locker(&gpxMutex);
+      if(cache.contains(id) || gpxPending.contains(id))
+        continue;
+
+      gpxPending.insert(id);
+      generation = gpxGeneration;
+    }
+
+    // Read BLOB in this thread since database connections cannot be shared
+    QByteArray bytes = getValue(id, "aircraft_trail").toByteArray();
+
+    gpxThreadPool->start([this, id, bytes, generation]() -> void {
+            QSharedPointer<gpx::GpxData> gpxData(new gpx::GpxData);
+            try
+            {
+              atools::fs::gpx::GpxBinary::decodeAny(*gpxData, bytes);
+            }
+            catch(atools::Exception& e)
+            {
+              // Cache empty data to avoid repeated attempts
+              qWarning() << Q_FUNC_INFO << "Error decoding GPX for logbook id" << id << e.what();
+              gpxData->clear();
+            }
+            catch(...)
+            {
+              qWarning() << Q_FUNC_INFO << "Unknown error decoding GPX for logbook id" << id;
+              gpxData->clear();
+            }
+
+            if(insertGpxData(id, gpxData, generation))
+              emit gpxDataLoaded(id);
+          });
   }
 }
 
 void LogdataManager::getFlightStatsTime(QDateTime& earliest, QDateTime& latest, QDateTime& earliestSim,
                                         QDateTime& latestSim)
 {
-  SqlQuery query("select min(departure_time), max(departure_time), "
-                 "min(departure_time_sim), max(departure_time_sim) from " % tableName, db);
-  query.exec();
-  if(query.next())
-  {
-    earliest = query.valueDateTime(0);
-    latest = query.valueDateTime(1);
-    earliestSim = query.valueDateTime(2);
-    latestSim = query.valueDateTime(3);
-  }
+  statistics->load();
+  statistics->getTime(earliest, latest, earliestSim, latestSim);
 }
 
 void LogdataManager::getFlightStatsDistance(float& distTotal, float& distMax, float& distAverage)
 {
-  SqlQuery query("select sum(distance), max(distance), avg(distance) from " % tableName, db);
-  query.exec();
-  if(query.next())
-  {
-    distTotal = query.valueFloat(0);
-    distMax = query.valueFloat(1);
-    distAverage = query.valueFloat(2);
-  }
+  statistics->load();
+  statistics->getDistance(distTotal, distMax, distAverage);
 }
 
 void LogdataManager::getFlightStatsAirports(int& numDepartAirports, int& numDestAirports)
 {
-  SqlQuery query("select count(distinct departure_ident), count(distinct destination_ident) from " % tableName, db);
-  query.exec();
-  if(query.next())
-  {
-    numDepartAirports = query.valueInt(0);
-    numDestAirports = query.valueInt(1);
-  }
+  statistics->load();
+  statistics->getAirports(numDepartAirports, numDestAirports);
 }
 
 void LogdataManager::getFlightStatsAircraft(int& numTypes, int& numRegistrations, int& numNames, int& numSimulators)
 {
-  SqlQuery query("select count(distinct aircraft_type), count(distinct aircraft_registration), "
-                 "count(distinct aircraft_name), count(distinct simulator) "
-                 "from " % tableName, db);
-  query.exec();
-  if(query.next())
-  {
-    numTypes = query.valueInt(0);
-    numRegistrations = query.valueInt(1);
-    numNames = query.valueInt(2);
-    numSimulators = query.valueInt(3);
-  }
+  statistics->load();
+  statistics->getAircraft(numTypes, numRegistrations, numNames, numSimulators);
 }
 
 void LogdataManager::getFlightStatsSimulator(QList<std::pair<int, QString> >& numSimulators)
 {
-  SqlQuery query("select count(1), simulator from " % tableName % " group by simulator order by count(1) desc", db);
-  query.exec();
-  while(query.next())
-    numSimulators.append(std::make_pair(query.valueInt(0), query.valueStr(1)));
+  statistics->load();
+  statistics->getSimulator(numSimulators);
 }
 
 void LogdataManager::fixEmptyStrField(sql::SqlRecord& rec, const QString& name)
@@ -844,31 +1006,8 @@ void LogdataManager::fixEmptyFields(sql::SqlQuery& query)
 void LogdataManager::getFlightStatsTripTime(float& timeMaximum, float& timeAverage, float& timeTotal,
                                             float& timeMaximumSim, float& timeAverageSim, float& timeTotalSim)
 {
-  SqlQuery query(db);
-
-  query.exec("select max(time_real), avg(time_real), sum(time_real) "
-             "from (select strftime('%s', destination_time) - strftime('%s', departure_time) as time_real "
-             "from " % tableName % ") where time_real > 0");
-  if(query.next())
-  {
-    int idx = 0;
-    timeMaximum = query.valueFloat(idx++) / 3600.f;
-    timeAverage = query.valueFloat(idx++) / 3600.f;
-    timeTotal = query.valueFloat(idx++) / 3600.f;
-  }
-  query.finish();
-
-  query.exec("select max(time_sim), avg(time_sim), sum(time_sim) "
-             "from (select strftime('%s', destination_time_sim) - strftime('%s', departure_time_sim) as time_sim "
-             "from " % tableName % ") where time_sim > 0");
-  if(query.next())
-  {
-    int idx = 0;
-    timeMaximumSim = query.valueFloat(idx++) / 3600.f;
-    timeAverageSim = query.valueFloat(idx++) / 3600.f;
-    timeTotalSim = query.valueFloat(idx++) / 3600.f;
-  }
-  query.finish();
+  statistics->load();
+  statistics->getTripTime(timeMaximum, timeAverage, timeTotal, timeMaximumSim, timeAverageSim, timeTotalSim);
 }
 
 } // namespace userdata
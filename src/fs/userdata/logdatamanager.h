@@ -22,11 +22,19 @@
 #include "fs/gpx/gpxtypes.h"
 
 #include <QCache>
+#include <QMutex>
+#include <QSet>
+#include <QSharedPointer>
+
+class QThreadPool;
 
 namespace atools {
 namespace geo {
 class LineString;
 }
+namespace util {
+class MemoryUsage;
+}
 namespace sql {
 
 class SqlColumn;
@@ -36,6 +44,11 @@ class SqlDatabase;
 namespace fs {
 namespace userdata {
 
+class LogStatistics;
+
+/* Decoded GPX attachment of a logbook entry shared between cache and users */
+typedef QSharedPointer<const atools::fs::gpx::GpxData> GpxDataPtr;
+
 /*
  * Contains special functionality around the logbook database.
  */
@@ -65,10 +78,31 @@ public:
   virtual void updateSchema() override;
 
   /* Get flight plan and track and route points from GPX attachment or database BLOB. Request is cached.
-   *  Also includes route waypoint names. */
+   *  Also includes route waypoint names. Loads and decodes synchronously if not cached.
+   * Pointer is valid until the next call. Has to be called from the thread owning the database. */
   const atools::fs::gpx::GpxData *getGpxData(int id);
 
-  /* Clear cache used by getRouteGeometry and getTrackGeometry */
+  /* Get decoded GPX data from cache or null if not loaded yet. Does not access the database.
+   * Thread safe. Returned data stays valid even if evicted from the cache. */
+  atools::fs::userdata::GpxDataPtr getGpxDataCached(int id);
+
+  /* Read GPX BLOBs of the given logbook entries which are neither cached nor already queued and decode them in
+   * background threads. Signal gpxDataLoaded() is sent for each entry once it is available in the cache.
+   * Has to be called from the thread owning the database. */
+  void prefetchGpxData(const QList<int>& ids);
+
+  /* Memory budget for decoded GPX data in MB. Least recently used entries are evicted first. */
+  void setGpxCacheSizeMb(int sizeMb);
+
+  /* Add memory of decoded GPX data in the cache as estimated by GpxData::getMemorySize(). Thread safe. */
+  void getMemoryUsage(atools::util::MemoryUsage& usage) const;
+
+  /* Convert all track attachments to the compact binary format (GpxBinary) if binary is true or
+   * back to Gzip compressed GPX otherwise. Both formats are read transparently.
+   * Returns number of converted entries. Not recorded for undo since content does not change. */
+  int convertTrails(bool binary);
+
+  /* Clear cache used by getRouteGeometry and getTrackGeometry. Results of running background decoding are dropped. */
   void clearGeometryCache();
 
   /* Remove entries by criteria */
@@ -84,6 +118,9 @@ public:
   bool hasPerfAttached(int id);
   bool hasTrackAttached(int id);
 
+  /* Statistics below are loaded by one scan over the table on first call and kept up to date
+   * incrementally on changes. */
+
   /* Get various statistical information for departure times */
   void getFlightStatsTime(QDateTime& earliest, QDateTime& latest, QDateTime& earliestSim, QDateTime& latestSim);
 
@@ -105,7 +142,8 @@ public:
   static void fixEmptyFields(atools::sql::SqlRecord& rec);
   static void fixEmptyFields(atools::sql::SqlQuery& query);
 
-  static const int MAX_CACHE_ENTRIES = 100;
+  /* Default memory budget for decoded GPX data */
+  static const int DEFAULT_GPX_CACHE_MB = 256;
 
   /* Run this to replace null values with empty strings to allow queries in cleanupUserdata() and getCleanupPreview().
    * Clean up - set null string columns empty to allow join - hidden compatibility change, no need to undo */
@@ -115,6 +153,15 @@ public:
    * Clean up - set empty string columns back to null - no need to undo. */
   void postCleanup();
 
+signals:
+  /* Sent from a background thread after prefetchGpxData() decoded an entry */
+  void gpxDataLoaded(int id);
+
+protected:
+  /* Update or invalidate statistics and GPX cache */
+  virtual void rowsChanged(const QSet<int>& ids) override;
+  virtual void tableChanged() override;
+
 private:
   static void fixEmptyStrField(atools::sql::SqlRecord& rec, const QString& name);
   static void fixEmptyStrField(atools::sql::SqlQuery& query, const QString& name);
@@ -124,19 +171,35 @@ private:
   /* Convert Gzipped BLOB to text (file) */
   static QString blobConversionFunction(const QVariant& value);
 
+  /* Convert Gzipped GPX or binary track BLOB to GPX text */
+  static QString trailConversionFunction(const QVariant& value);
+
   /* Generate empty column if disabled in export options */
   static QString blobConversionFunctionEmpty(const QVariant&);
 
   /* Returns with "or" concatenated where clause for query */
   QString cleanupWhere(bool departureAndDestEqual, bool departureOrDestEmpty, float minFlownDistance);
 
-  /* Prime cache by loading the GpxCacheEntry */
-  void loadGpx(int id);
+  /* Add to cache if not cleared in the meantime. Returns true if inserted. Thread safe. */
+  bool insertGpxData(int id, const atools::fs::userdata::GpxDataPtr& gpxData, quint32 generation);
 
   void repairDateTime(const QString& column);
 
-  /* Cache to avoid reading BLOBs */
-  QCache<int, atools::fs::gpx::GpxData> cache;
+  /* Cache to avoid reading BLOBs. Cost is decoded size in kB. Guarded by gpxMutex. */
+  QCache<int, atools::fs::userdata::GpxDataPtr> cache;
+
+  /* Ids queued for decoding and generation incremented on cache clear to drop outdated results */
+  QSet<int> gpxPending;
+  quint32 gpxGeneration = 0;
+  mutable QMutex gpxMutex;
+
+  /* Returned by getGpxData() to keep the pointer valid if evicted */
+  atools::fs::userdata::GpxDataPtr lastGpxData;
+
+  QThreadPool *gpxThreadPool;
+
+  /* Statistics for the getFlightStats* methods */
+  atools::fs::userdata::LogStatistics *statistics;
 
 };
 
@@ -0,0 +1,307 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/userdata/logstatistics.h"
+
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QStringBuilder>
+
+namespace atools {
+namespace fs {
+namespace userdata {
+
+using atools::sql::SqlQuery;
+
+/* Column indexes in selectStatement() */
+namespace col {
+enum Index
+{
+  ID,
+  DEPARTURE_TIME,
+  DEPARTURE_TIME_SIM,
+  DESTINATION_TIME,
+  DESTINATION_TIME_SIM,
+  DISTANCE,
+  DEPARTURE_IDENT,
+  DESTINATION_IDENT,
+  AIRCRAFT_TYPE,
+  AIRCRAFT_REGISTRATION,
+  AIRCRAFT_NAME,
+  SIMULATOR
+};
+
+}
+
+void LogStatistics::Aggregate::change(float value, int direction)
+{
+  sum += value * direction;
+  count += direction;
+
+  if(direction > 0)
+    values[value] += direction;
+  else
+  {
+    auto it = values.find(value);
+    if(it != values.end() && (it.value() += direction) <= 0)
+      values.erase(it);
+  }
+
+  if(count <= 0)
+  {
+    // Avoid accumulated rounding errors
+    sum = 0.;
+    count = 0;
+  }
+}
+
+LogStatistics::LogStatistics(sql::SqlDatabase *sqlDb, const QString& tableNameParam, const QString& idColumnNameParam)
+  : db(sqlDb), tableName(tableNameParam), idColumnName(idColumnNameParam)
+{
+}
+
+QString LogStatistics::selectStatement() const
+{
+  // Order has to match col::Index - no BLOB columns
+  return "select " % idColumnName % ", departure_time, departure_time_sim, destination_time, destination_time_sim, "
+         "distance, departure_ident, destination_ident, aircraft_type, aircraft_registration, aircraft_name, simulator "
+         "from " % tableName;
+}
+
+void LogStatistics::load()
+{
+  if(loaded)
+    return;
+
+  QElapsedTimer timer;
+  timer.start();
+
+  invalidate();
+
+  SqlQuery query(selectStatement(), db);
+  query.exec();
+  while(query.next())
+  {
+    Entry entry = readEntry(query);
+    addEntry(entry, 1);
+    entries.insert(query.valueInt(col::ID), entry);
+  }
+  loaded = true;
+
+  qDebug() << Q_FUNC_INFO << tableName << entries.size() << "entries in" << timer.elapsed() << "ms";
+}
+
+void LogStatistics::invalidate()
+{
+  loaded = false;
+  entries.clear();
+  departureTimes.clear();
+  departureTimesSim.clear();
+  distances = Aggregate();
+  tripTimes = Aggregate();
+  tripTimesSim = Aggregate();
+  departureIdents.clear();
+  destinationIdents.clear();
+  aircraftTypes.clear();
+  aircraftRegistrations.clear();
+  aircraftNames.clear();
+  simulators.clear();
+  numNullSimulator = 0;
+}
+
+void LogStatistics::update(const QSet<int>& ids)
+{
+  if(!loaded || ids.isEmpty())
+    return;
+
+  // Remove old values of all changed rows
+  for(int id : ids)
+  {
+    auto it = entries.find(id);
+    if(it != entries.end())
+    {
+      addEntry(it.value(), -1);
+      entries.erase(it);
+    }
+  }
+
+  // Add current values of rows still existing
+  SqlQuery query(db);
+  query.prepare(selectStatement() % " where " % idColumnName % " = :id");
+  for(int id : ids)
+  {
+    query.bindValue(":id", id);
+    query.exec();
+    if(query.next())
+    {
+      Entry entry = readEntry(query);
+      addEntry(entry, 1);
+      entries.insert(id, entry);
+    }
+  }
+}
+
+LogStatistics::Entry LogStatistics::readEntry(const sql::SqlQuery& query) const
+{
+  // Keep null strings for null values to exclude these from distinct counts
+  auto str = [&query](int index) -> QString {
+               return query.isNull(index) ? QString() : query.valueStr(index);
+             };
+
+  Entry entry;
+  entry.departureTime = query.valueDateTime(col::DEPARTURE_TIME);
+  entry.departureTimeSim = query.valueDateTime(col::DEPARTURE_TIME_SIM);
+  entry.destinationTime = query.valueDateTime(col::DESTINATION_TIME);
+  entry.destinationTimeSim = query.valueDateTime(col::DESTINATION_TIME_SIM);
+  entry.distanceValid = !query.isNull(col::DISTANCE);
+  entry.distance = query.valueFloat(col::DISTANCE);
+  entry.departureIdent = str(col::DEPARTURE_IDENT);
+  entry.destinationIdent = str(col::DESTINATION_IDENT);
+  entry.aircraftType = str(col::AIRCRAFT_TYPE);
+  entry.aircraftRegistration = str(col::AIRCRAFT_REGISTRATION);
+  entry.aircraftName = str(col::AIRCRAFT_NAME);
+  entry.simulator = str(col::SIMULATOR);
+  return entry;
+}
+
+void LogStatistics::addEntry(const Entry& entry, int direction)
+{
+  countTime(departureTimes, entry.departureTime, direction);
+  countTime(departureTimesSim, entry.departureTimeSim, direction);
+
+  if(entry.distanceValid)
+    distances.change(entry.distance, direction);
+
+  // Trip times in seconds ignoring zero, negative and unknown times
+  if(entry.departureTime.isValid() && entry.destinationTime.isValid())
+  {
+    qint64 secs = entry.departureTime.secsTo(entry.destinationTime);
+    if(secs > 0)
+      tripTimes.change(static_cast<float>(secs), direction);
+  }
+
+  if(entry.departureTimeSim.isValid() && entry.destinationTimeSim.isValid())
+  {
+    qint64 secs = entry.departureTimeSim.secsTo(entry.destinationTimeSim);
+    if(secs > 0)
+      tripTimesSim.change(static_cast<float>(secs), direction);
+  }
+
+  countStr(departureIdents, entry.departureIdent, direction);
+  countStr(destinationIdents, entry.destinationIdent, direction);
+  countStr(aircraftTypes, entry.aircraftType, direction);
+  countStr(aircraftRegistrations, entry.aircraftRegistration, direction);
+  countStr(aircraftNames, entry.aircraftName, direction);
+
+  if(entry.simulator.isNull())
+    numNullSimulator += direction;
+  else
+    countStr(simulators, entry.simulator, direction);
+}
+
+void LogStatistics::countTime(QMap<QDateTime, int>& map, const QDateTime& value, int direction)
+{
+  if(!value.isValid())
+    return;
+
+  auto it = map.find(value);
+  if(it == map.end())
+  {
+    if(direction > 0)
+      map.insert(value, direction);
+  }
+  else if((it.value() += direction) <= 0)
+    map.erase(it);
+}
+
+void LogStatistics::countStr(QHash<QString, int>& hash, const QString& value, int direction)
+{
+  if(value.isNull())
+    return;
+
+  auto it = hash.find(value);
+  if(it == hash.end())
+  {
+    if(direction > 0)
+      hash.insert(value, direction);
+  }
+  else if((it.value() += direction) <= 0)
+    hash.erase(it);
+}
+
+void LogStatistics::getTime(QDateTime& earliest, QDateTime& latest, QDateTime& earliestSim,
+                            QDateTime& latestSim) const
+{
+  earliest = departureTimes.isEmpty() ? QDateTime() : departureTimes.firstKey();
+  latest = departureTimes.isEmpty() ? QDateTime() : departureTimes.lastKey();
+  earliestSim = departureTimesSim.isEmpty() ? QDateTime() : departureTimesSim.firstKey();
+  latestSim = departureTimesSim.isEmpty() ? QDateTime() : departureTimesSim.lastKey();
+}
+
+void LogStatistics::getDistance(float& distTotal, float& distMax, float& distAverage) const
+{
+  distTotal = static_cast<float>(distances.sum);
+  distMax = distances.max();
+  distAverage = distances.average();
+}
+
+void LogStatistics::getTripTime(float& timeMaximum, float& timeAverage, float& timeTotal, float& timeMaximumSim,
+                                float& timeAverageSim, float& timeTotalSim) const
+{
+  timeMaximum = tripTimes.max() / 3600.f;
+  timeAverage = tripTimes.average() / 3600.f;
+  timeTotal = static_cast<float>(tripTimes.sum) / 3600.f;
+  timeMaximumSim = tripTimesSim.max() / 3600.f;
+  timeAverageSim = tripTimesSim.average() / 3600.f;
+  timeTotalSim = static_cast<float>(tripTimesSim.sum) / 3600.f;
+}
+
+void LogStatistics::getAirports(int& numDepartAirports, int& numDestAirports) const
+{
+  numDepartAirports = static_cast<int>(departureIdents.size());
+  numDestAirports = static_cast<int>(destinationIdents.size());
+}
+
+void LogStatistics::getAircraft(int& numTypes, int& numRegistrations, int& numNames, int& numSimulators) const
+{
+  numTypes = static_cast<int>(aircraftTypes.size());
+  numRegistrations = static_cast<int>(aircraftRegistrations.size());
+  numNames = static_cast<int>(aircraftNames.size());
+  numSimulators = static_cast<int>(simulators.size());
+}
+
+void LogStatistics::getSimulator(QList<std::pair<int, QString> >& numSimulators) const
+{
+  for(auto it = simulators.constBegin(); it != simulators.constEnd(); ++it)
+    numSimulators.append(std::make_pair(it.value(), it.key()));
+
+  if(numNullSimulator > 0)
+    numSimulators.append(std::make_pair(numNullSimulator, QString()));
+
+  // Most used first and then by name for stable order
+  std::sort(numSimulators.begin(), numSimulators.end(),
+            [](const std::pair<int, QString>& p1, const std::pair<int, QString>& p2) -> bool {
+            return p1.first == p2.first ? p1.second < p2.second : p1.first > p2.first;
+          });
+}
+
+} // namespace userdata
+} // namespace fs
+} // namespace atools
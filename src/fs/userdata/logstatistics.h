@@ -0,0 +1,142 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_USERDATA_LOGSTATISTICS_H
+#define ATOOLS_FS_USERDATA_LOGSTATISTICS_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QMap>
+#include <QSet>
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+class SqlQuery;
+}
+
+namespace fs {
+namespace userdata {
+
+/*
+ * Statistics for the logbook table like time ranges, distances and number of distinct airports or aircraft.
+ *
+ * Loaded by one scan over the needed columns without reading BLOBs. Afterwards kept up to date by
+ * reloading only changed rows which are removed from and added to the aggregates.
+ * Minimum and maximum values are kept in sorted multisets to allow removal.
+ *
+ * Null values are ignored like in the SQL aggregate functions.
+ */
+class LogStatistics
+{
+public:
+  LogStatistics(atools::sql::SqlDatabase *sqlDb, const QString& tableNameParam, const QString& idColumnNameParam);
+
+  LogStatistics(const LogStatistics& other) = delete;
+  LogStatistics& operator=(const LogStatistics& other) = delete;
+
+  /* Load all rows if not done yet or after invalidate() */
+  void load();
+
+  /* Drop all statistics. Reloaded on next call to load(). */
+  void invalidate();
+
+  /* Reload the given rows if loaded. Missing rows are removed. */
+  void update(const QSet<int>& ids);
+
+  bool isLoaded() const
+  {
+    return loaded;
+  }
+
+  /* Times in UTC and simulator time. Invalid if table has no non-null values. */
+  void getTime(QDateTime& earliest, QDateTime& latest, QDateTime& earliestSim, QDateTime& latestSim) const;
+
+  /* Flight plan distance in NM */
+  void getDistance(float& distTotal, float& distMax, float& distAverage) const;
+
+  /* Trip time in hours. Only positive times are considered. */
+  void getTripTime(float& timeMaximum, float& timeAverage, float& timeTotal, float& timeMaximumSim,
+                   float& timeAverageSim, float& timeTotalSim) const;
+
+  void getAirports(int& numDepartAirports, int& numDestAirports) const;
+  void getAircraft(int& numTypes, int& numRegistrations, int& numNames, int& numSimulators) const;
+
+  /* Number of entries and simulator name sorted by number descending. Null simulator is returned as empty string. */
+  void getSimulator(QList<std::pair<int, QString> >& numSimulators) const;
+
+private:
+  /* Values of one logbook entry needed for statistics. Null strings are null values in the table. */
+  struct Entry
+  {
+    QDateTime departureTime, departureTimeSim, destinationTime, destinationTimeSim;
+    float distance = 0.f;
+    bool distanceValid = false;
+    QString departureIdent, destinationIdent, aircraftType, aircraftRegistration, aircraftName, simulator;
+  };
+
+  /* Sum, count and sorted values to allow removal of maximum */
+  struct Aggregate
+  {
+    double sum = 0.;
+    int count = 0;
+    QMap<float, int> values;
+
+    /* Add value if direction is 1 or remove if -1 */
+    void change(float value, int direction);
+
+    float max() const
+    {
+      return values.isEmpty() ? 0.f : values.lastKey();
+    }
+
+    float average() const
+    {
+      return count > 0 ? static_cast<float>(sum / count) : 0.f;
+    }
+
+  };
+
+  Entry readEntry(const atools::sql::SqlQuery& query) const;
+
+  /* Add entry to all aggregates if direction is 1 or remove if -1 */
+  void addEntry(const Entry& entry, int direction);
+
+  /* Add or remove value from multiset. Invalid and null values are ignored. */
+  static void countTime(QMap<QDateTime, int>& map, const QDateTime& value, int direction);
+  static void countStr(QHash<QString, int>& hash, const QString& value, int direction);
+
+  QString selectStatement() const;
+
+  atools::sql::SqlDatabase *db;
+  QString tableName, idColumnName;
+  bool loaded = false;
+
+  QHash<int, Entry> entries;
+
+  QMap<QDateTime, int> departureTimes, departureTimesSim;
+  Aggregate distances, tripTimes, tripTimesSim;
+  QHash<QString, int> departureIdents, destinationIdents, aircraftTypes, aircraftRegistrations, aircraftNames,
+                      simulators;
+  int numNullSimulator = 0;
+};
+
+} // namespace userdata
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_USERDATA_LOGSTATISTICS_H
@@ -207,9 +207,14 @@ int UserdataManager::importCsv(const QStringList& filepaths, atools::fs::userdat
 
   int id = getCurrentId() + 1;
   atools::sql::DataManagerUndoHandler undoHandler(this, id);
+  startImportCallback();
+  bool canceled = false;
 
   for(const QString& filepath : filepaths)
   {
+    if(canceled)
+      break;
+
     if(filepath.isEmpty())
       continue;
 
@@ -228,37 +233,27 @@ int UserdataManager::importCsv(const QStringList& filepaths, atools::fs::userdat
 
       atools::util::CsvReader reader(separator, escape, true /* trim */);
 
-      QTextStream stream(&file);
+      // Read file at once and tokenize bytes without decoding whole lines
+      QByteArray data = atools::util::CsvReader::toUtf8(file.readAll());
+      qsizetype offset = 0;
+      bool first = true;
 
-      int lineNum = 1;
-      while(!stream.atEnd())
+      while(reader.readCsvRecord(data, offset))
       {
-        QString line = stream.readLine();
+        const QStringList& values = reader.getValues();
+        int lineNum = reader.getRecordLineNumber();
 
-        if(lineNum == 1)
+        if(first)
         {
-          QString header = QString(line).simplified().replace(' ', QStringLiteral()).replace('"', QStringLiteral()).toLower();
+          first = false;
+          QString header = values.join(',').simplified().replace(' ', QStringLiteral()).toLower();
           if(flags & CSV_HEADER || header.startsWith("type,name,ident,latitude,longitude"))
-          {
-            lineNum++;
             // Ignore header
             continue;
-          }
         }
 
-        // Skip empty lines but add them if within an escaped field
-        if(line.isEmpty() && !reader.isInEscape())
-          continue;
-
-        reader.readCsvLine(line);
-        if(reader.isInEscape())
-          // Still in an escaped line so continue to read unchanged until " shows the end of the field
-          continue;
-
-        const QStringList& values = reader.getValues();
-
         if(values.size() < csv::MIN_NUM_COLS)
-          throw atools::Exception(tr("File contains invalid data.\n\"%1\"\nLine %2.").arg(line).arg(lineNum));
+          throw atools::Exception(tr("File contains invalid data.\n\"%1\"\nLine %2.").arg(reader.getRecordText()).arg(lineNum));
 
         insertQuery.bindValue(idBinding, id++);
         insertQuery.bindValue(":type", at(values, csv::TYPE));
@@ -295,15 +290,19 @@ int UserdataManager::importCsv(const QStringList& filepaths, atools::fs::userdat
 
         insertQuery.bindValue(":altitude", alt);
 
-        validateCoordinates(line, at(values, csv::LONX), at(values, csv::LATY), lineNum, false /* checkNull */);
+        validateCoordinates(reader.getRecordText(), at(values, csv::LONX), at(values, csv::LATY), lineNum, false /* checkNull */);
         insertQuery.bindValue(":lonx", at(values, csv::LONX, true));
         insertQuery.bindValue(":laty", at(values, csv::LATY, true));
 
         insertQuery.exec();
         undoHandler.inserted();
 
-        lineNum++;
         numImported++;
+        if(!invokeImportCallback(numImported))
+        {
+          canceled = true;
+          break;
+        }
       }
       file.close();
     }
@@ -312,6 +311,7 @@ int UserdataManager::importCsv(const QStringList& filepaths, atools::fs::userdat
 
   } // for(const QString& filepath : filepaths)
 
+  invokeImportCallback(numImported, true /* force */);
   undoHandler.finish();
 
   return numImported;
@@ -24,6 +24,7 @@
 #include <cmath>
 #include <QRegularExpression>
 #include <QLocale>
+#include <QStringView>
 
 using atools::geo::Pos;
 
@@ -50,17 +51,6 @@ const static QString COORDS_FLIGHTPLAN_FORMAT_DEG_MIN_SEC("%1%2%3%4%5%6%7%8");
 const static QRegularExpression LONG_FORMAT_REGEXP_DEG_MIN_SEC("^([0-9]{2})([0-9]{2})([0-9]{2})([NS])"
                                                                "([0-9]{3})([0-9]{2})([0-9]{2})([EW])$");
 
-// Pattern allows trailing garbage
-// 50:40:42 N 003:13:30 E
-// 31:30:00 N 086:44:59 W
-static QRegularExpression MATCH_COORD_OPENAIR_MIN_SEC("^([\\d]+):([\\d]+):([\\d\\.]+)\\s*([NS])\\s*"
-                                                      "([\\d]+):([\\d]+):([\\d\\.]+)\\s*([EW])");
-
-// Pattern allows trailing garbage
-// 39:06.2 N 121:35.5 W
-static QRegularExpression MATCH_COORD_OPENAIR_MIN("^([\\d]+):([\\d\\.]+)\\s*([NS])\\s*"
-                                                  "([\\d]+):([\\d\\.]+)\\s*([EW])");
-
 // ARINC full degreee waypoints
 // 57N30 5730N 5730E 57E30
 // 57W30 5730W 5730S 57S30
@@ -79,7 +69,278 @@ const static QRegularExpression LONG_FORMAT_REGEXP_PAIR_LAT("^([NS])([0-9]{2})([
 const static QRegularExpression LONG_FORMAT_REGEXP_PAIR_LON("^([EW])([0-9]{3})([0-9]{2})$");
 
 atools::geo::Pos degMinSecFormatFromCapture(const QStringList& captured);
-atools::geo::Pos degMinFormatFromCapture(const QStringList& captured);
+// ==================================================================================
+// Hand written parsers for the fixed width waypoint formats and OpenAir coordinates.
+// These work on string views and avoid the regular expression engine and any allocation.
+// Regular expressions are used as fallback if the input contains whitespace which needs simplification.
+
+/* true if simplified() would not change the trimmed string, i.e. only single blanks inside */
+static bool isSimple(QStringView str)
+{
+  for(qsizetype i = 0; i < str.size(); i++)
+  {
+    QChar c = str.at(i);
+    if(c.isSpace() && (c != QLatin1Char(' ') || (i > 0 && str.at(i - 1).isSpace())))
+      return false;
+  }
+  return true;
+}
+
+static bool isAsciiDigit(QChar c)
+{
+  return c >= QLatin1Char('0') && c <= QLatin1Char('9');
+}
+
+/* Value of num ASCII digits at pos or -1 if one of them is not a digit */
+static int digitsAt(QStringView str, qsizetype pos, int num)
+{
+  int value = 0;
+  for(qsizetype i = pos; i < pos + num; i++)
+  {
+    QChar c = str.at(i);
+    if(!isAsciiDigit(c))
+      return -1;
+    value = value * 10 + (c.unicode() - '0');
+  }
+  return value;
+}
+
+static char16_t upperAt(QStringView str, qsizetype pos)
+{
+  return str.at(pos).toUpper().unicode();
+}
+
+static bool isNs(char16_t c)
+{
+  return c == u'N' || c == u'S';
+}
+
+static bool isEw(char16_t c)
+{
+  return c == u'E' || c == u'W';
+}
+
+/* Degrees and minutes with range check. Negative values are parsing errors. */
+static Pos degMinPos(int lonXDeg, int lonXMin, char16_t ew, int latYDeg, int latYMin, char16_t ns)
+{
+  if(latYDeg >= 0 && latYMin >= 0 && lonXDeg >= 0 && lonXMin >= 0 && latYDeg <= 90 && lonXDeg <= 180)
+    return Pos(lonXDeg, lonXMin, 0.f, ew == u'W', latYDeg, latYMin, 0.f, ns == u'S');
+  else
+    return atools::geo::EMPTY_POS;
+}
+
+// N48194W123096
+static Pos gfpFormat(QStringView str)
+{
+  if(str.size() != 13 || !isNs(upperAt(str, 0)) || !isEw(upperAt(str, 6)))
+    return atools::geo::EMPTY_POS;
+
+  int latYDeg = digitsAt(str, 1, 2), latYMin10 = digitsAt(str, 3, 3);
+  int lonXDeg = digitsAt(str, 7, 3), lonXMin10 = digitsAt(str, 10, 3);
+  if(latYDeg < 0 || latYMin10 < 0 || lonXDeg < 0 || lonXMin10 < 0 || latYDeg > 90 || lonXDeg > 180)
+    return atools::geo::EMPTY_POS;
+
+  float latYMin = latYMin10 / 10.f;
+  float latYSec = (latYMin - std::floor(latYMin)) * 60.f;
+  float lonXMin = lonXMin10 / 10.f;
+  float lonXSec = (lonXMin - std::floor(lonXMin)) * 60.f;
+
+  return Pos(lonXDeg, static_cast<int>(lonXMin), lonXSec, upperAt(str, 6) == u'W',
+             latYDeg, static_cast<int>(latYMin), latYSec, upperAt(str, 0) == u'S');
+}
+
+// 46N078W
+static Pos degFormat(QStringView str)
+{
+  if(str.size() != 7 || !isNs(upperAt(str, 2)) || !isEw(upperAt(str, 6)))
+    return atools::geo::EMPTY_POS;
+
+  return degMinPos(digitsAt(str, 3, 3), 0, upperAt(str, 6), digitsAt(str, 0, 2), 0, upperAt(str, 2));
+}
+
+// 4510N06810W
+static Pos degMinFormat(QStringView str)
+{
+  if(str.size() != 11 || !isNs(upperAt(str, 4)) || !isEw(upperAt(str, 10)))
+    return atools::geo::EMPTY_POS;
+
+  return degMinPos(digitsAt(str, 5, 3), digitsAt(str, 8, 2), upperAt(str, 10),
+                   digitsAt(str, 0, 2), digitsAt(str, 2, 2), upperAt(str, 4));
+}
+
+// 481200N0112842E
+static Pos degMinSecFormat(QStringView str)
+{
+  if(str.size() != 15 || !isNs(upperAt(str, 6)) || !isEw(upperAt(str, 14)))
+    return atools::geo::EMPTY_POS;
+
+  int latYDeg = digitsAt(str, 0, 2), latYMin = digitsAt(str, 2, 2), latYSec = digitsAt(str, 4, 2);
+  int lonXDeg = digitsAt(str, 7, 3), lonXMin = digitsAt(str, 10, 2), lonXSec = digitsAt(str, 12, 2);
+  if(latYDeg < 0 || latYMin < 0 || latYSec < 0 || lonXDeg < 0 || lonXMin < 0 || lonXSec < 0 ||
+     latYDeg > 90 || lonXDeg > 180)
+    return atools::geo::EMPTY_POS;
+
+  return Pos(lonXDeg, lonXMin, static_cast<float>(lonXSec), upperAt(str, 14) == u'W',
+             latYDeg, latYMin, static_cast<float>(latYSec), upperAt(str, 6) == u'S');
+}
+
+// N6400 W07000 or N6400/W07000 or 6400N 07000W or 6400N/07000W
+static Pos degMinPairFormat(QStringView str)
+{
+  if(str.size() != 12 || (str.at(5) != QLatin1Char(' ') && str.at(5) != QLatin1Char('/')))
+    return atools::geo::EMPTY_POS;
+
+  if(isNs(upperAt(str, 0)) && isEw(upperAt(str, 6)))
+    return degMinPos(digitsAt(str, 7, 3), digitsAt(str, 10, 2), upperAt(str, 6),
+                     digitsAt(str, 1, 2), digitsAt(str, 3, 2), upperAt(str, 0));
+  else if(isNs(upperAt(str, 4)) && isEw(upperAt(str, 11)))
+    return degMinPos(digitsAt(str, 6, 3), digitsAt(str, 9, 2), upperAt(str, 11),
+                     digitsAt(str, 0, 2), digitsAt(str, 2, 2), upperAt(str, 4));
+  else
+    return atools::geo::EMPTY_POS;
+}
+
+/* Apply ARINC designator for full degree points. Negative values are parsing errors. */
+static Pos arincPos(int latYDeg, int lonXDeg, char16_t designator)
+{
+  if(latYDeg < 0 || lonXDeg < 0)
+    return atools::geo::EMPTY_POS;
+
+  if(designator == u'N')
+    lonXDeg = -lonXDeg;
+  else if(designator == u'W')
+  {
+    lonXDeg = -lonXDeg;
+    latYDeg = -latYDeg;
+  }
+  else if(designator == u'S')
+    latYDeg = -latYDeg;
+
+  Pos pos(static_cast<float>(lonXDeg), static_cast<float>(latYDeg));
+  return pos.isValidRange() ? pos : atools::geo::EMPTY_POS;
+}
+
+// 5730N 5730E 5730W 5730S or 57N30 57E30 57W30 57S30 with longitude + 100
+static Pos arincFormat(QStringView str)
+{
+  if(str.size() != 5)
+    return atools::geo::EMPTY_POS;
+
+  char16_t designator = upperAt(str, 4);
+  if(isNs(designator) || isEw(designator))
+  {
+    Pos pos = arincPos(digitsAt(str, 0, 2), digitsAt(str, 2, 2), designator);
+    if(pos.isValid())
+      return pos;
+  }
+
+  designator = upperAt(str, 2);
+  if(isNs(designator) || isEw(designator))
+  {
+    int lonXDeg = digitsAt(str, 3, 2);
+    return arincPos(digitsAt(str, 0, 2), lonXDeg < 0 ? -1 : lonXDeg + 100, designator);
+  }
+
+  return atools::geo::EMPTY_POS;
+}
+
+/* Move pos behind all ASCII digits and also decimal points if requested. Returns the skipped part. */
+static QStringView numberAt(QStringView str, qsizetype& pos, bool decimals)
+{
+  qsizetype start = pos;
+  while(pos < str.size() && (isAsciiDigit(str.at(pos)) || (decimals && str.at(pos) == QLatin1Char('.'))))
+    pos++;
+  return str.mid(start, pos - start);
+}
+
+static void skipSpace(QStringView str, qsizetype& pos)
+{
+  while(pos < str.size() && str.at(pos).isSpace())
+    pos++;
+}
+
+/* One OpenAir ordinate "50:40:42 N" if seconds is true or "39:06.2 N" otherwise.
+ * Returns false if the format does not match. */
+static bool openAirOrdinate(QStringView str, qsizetype& pos, bool seconds, bool latitude,
+                            QStringView& deg, QStringView& min, QStringView& sec, bool& negative)
+{
+  deg = numberAt(str, pos, false);
+  if(deg.isEmpty() || pos >= str.size() || str.at(pos) != QLatin1Char(':'))
+    return false;
+  pos++;
+
+  // Minutes have decimals if seconds are not given
+  min = numberAt(str, pos, !seconds);
+  if(min.isEmpty())
+    return false;
+
+  if(seconds)
+  {
+    if(pos >= str.size() || str.at(pos) != QLatin1Char(':'))
+      return false;
+    pos++;
+
+    sec = numberAt(str, pos, true);
+    if(sec.isEmpty())
+      return false;
+  }
+
+  skipSpace(str, pos);
+  if(pos >= str.size())
+    return false;
+
+  char16_t designator = upperAt(str, pos++);
+  if(latitude ? !isNs(designator) : !isEw(designator))
+    return false;
+
+  negative = designator == u'S' || designator == u'W';
+  return true;
+}
+
+/* OpenAir format with or without seconds. Allows trailing garbage.
+ * Returns false if format does not match. pos is empty if numbers are not valid. */
+static bool openAirFormat(QStringView str, bool seconds, Pos& pos)
+{
+  QStringView latDeg, latMin, latSec, lonDeg, lonMin, lonSec;
+  bool south = false, west = false;
+  qsizetype idx = 0;
+
+  if(!openAirOrdinate(str, idx, seconds, true /* latitude */, latDeg, latMin, latSec, south))
+    return false;
+
+  skipSpace(str, idx);
+
+  if(!openAirOrdinate(str, idx, seconds, false /* latitude */, lonDeg, lonMin, lonSec, west))
+    return false;
+
+  pos = atools::geo::EMPTY_POS;
+  bool latOk, lonOk, latMinOk, lonMinOk;
+  int latYDeg = latDeg.toInt(&latOk);
+  int lonXDeg = lonDeg.toInt(&lonOk);
+
+  if(seconds)
+  {
+    bool latSecOk, lonSecOk;
+    int latYMin = latMin.toInt(&latMinOk);
+    int lonXMin = lonMin.toInt(&lonMinOk);
+    float latYSec = latSec.toFloat(&latSecOk);
+    float lonXSec = lonSec.toFloat(&lonSecOk);
+
+    if(latOk && lonOk && latMinOk && lonMinOk && latSecOk && lonSecOk && latYDeg <= 90 && lonXDeg <= 180)
+      pos = Pos(lonXDeg, lonXMin, lonXSec, west, latYDeg, latYMin, latYSec, south);
+  }
+  else
+  {
+    float latYMin = latMin.toFloat(&latMinOk);
+    float lonXMin = lonMin.toFloat(&lonMinOk);
+
+    if(latOk && lonOk && latMinOk && lonMinOk && latYDeg <= 90 && lonXDeg <= 180)
+      pos = Pos((lonXDeg + lonXMin / 60.f) * (west ? -1.f : 1.f), (latYDeg + latYMin / 60.f) * (south ? -1.f : 1.f));
+  }
+  return true;
+}
+
+// ==================================================================================
 
 QString toGfpFormat(const atools::geo::Pos& pos)
 {
@@ -128,6 +389,10 @@ QString toDegMinSecFormat(const atools::geo::Pos& pos)
 // Garmin format N48194W123096
 atools::geo::Pos fromGfpFormat(const QString& str)
 {
+  QStringView view = QStringView(str).trimmed();
+  if(isSimple(view))
+    return gfpFormat(view);
+
   QRegularExpressionMatch match = LONG_FORMAT_REGEXP_GFP.match(str.simplified().toUpper());
 
   if(match.hasMatch())
@@ -160,6 +425,10 @@ atools::geo::Pos fromGfpFormat(const QString& str)
 // Degrees only 46N078W
 atools::geo::Pos fromDegFormat(const QString& str)
 {
+  QStringView view = QStringView(str).trimmed();
+  if(isSimple(view))
+    return degFormat(view);
+
   QRegularExpressionMatch match = LONG_FORMAT_REGEXP_DEG.match(str.simplified().toUpper());
 
   if(match.hasMatch())
@@ -188,6 +457,10 @@ atools::geo::Pos fromDegFormat(const QString& str)
 // Degrees and minutes 4510N06810W
 atools::geo::Pos fromDegMinFormat(const QString& str)
 {
+  QStringView view = QStringView(str).trimmed();
+  if(isSimple(view))
+    return degMinFormat(view);
+
   QRegularExpressionMatch match = LONG_FORMAT_REGEXP_DEG_MIN.match(str.simplified().toUpper());
 
   if(match.hasMatch())
@@ -219,6 +492,10 @@ atools::geo::Pos fromDegMinFormat(const QString& str)
 // Degrees, minutes and seconds 481200N0112842E
 atools::geo::Pos fromDegMinSecFormat(const QString& str)
 {
+  QStringView view = QStringView(str).trimmed();
+  if(isSimple(view))
+    return degMinSecFormat(view);
+
   QRegularExpressionMatch match = LONG_FORMAT_REGEXP_DEG_MIN_SEC.match(str.simplified().toUpper());
 
   if(match.hasMatch())
@@ -230,6 +507,10 @@ atools::geo::Pos fromDegMinSecFormat(const QString& str)
 // Degrees and minutes in pair N6400 W07000 or N6400/W07000
 atools::geo::Pos fromDegMinPairFormat(const QString& str)
 {
+  QStringView view = QStringView(str).trimmed();
+  if(isSimple(view))
+    return degMinPairFormat(view);
+
   QRegularExpressionMatch match = LONG_FORMAT_REGEXP_PAIR.match(str.simplified().toUpper());
 
   bool latOk = false, lonOk = false, latMinOk = false, lonMinOk = false;
@@ -280,6 +561,10 @@ atools::geo::Pos fromDegMinPairFormat(const QString& str)
 // 57N30 5730N 5730E 57E30 57W30 5730W 5730S 57S30
 atools::geo::Pos fromArincFormat(const QString& str)
 {
+  QStringView view = QStringView(str).trimmed();
+  if(isSimple(view))
+    return arincFormat(view);
+
   // 5730N 5730E 5730W 5730S
   QRegularExpressionMatch match = LONG_FORMAT_REGEXP_ARINC.match(str.simplified().toUpper());
 
@@ -373,40 +658,24 @@ atools::geo::Pos fromAnyWaypointFormat(const QString& str)
   return atools::geo::EMPTY_POS;
 }
 
-geo::Pos fromOpenAirFormat(const QString& coordStr)
+QList<atools::geo::Pos> fromAnyWaypointFormat(const QStringList& strings)
 {
-  QRegularExpressionMatch match = MATCH_COORD_OPENAIR_MIN_SEC.match(coordStr.toUpper());
-  if(match.hasMatch())
-    return degMinSecFormatFromCapture(match.capturedTexts());
-  else
-  {
-    match = MATCH_COORD_OPENAIR_MIN.match(coordStr);
-    if(match.hasMatch())
-      return degMinFormatFromCapture(match.capturedTexts());
-  }
-
-  return atools::geo::EMPTY_POS;
+  QList<atools::geo::Pos> positions;
+  positions.reserve(strings.size());
+  for(const QString& str : strings)
+    positions.append(fromAnyWaypointFormat(str));
+  return positions;
 }
 
-atools::geo::Pos degMinFormatFromCapture(const QStringList& captured)
+geo::Pos fromOpenAirFormat(const QString& coordStr)
 {
-  if(captured.size() == 7)
-  {
-    bool latOk, lonOk, latMinOk, lonMinOk;
-    int latYDeg = captured.at(1).toInt(&latOk);
-    float latYMin = captured.at(2).toFloat(&latMinOk);
-    QString ns = captured.at(3);
+  Pos pos;
+  if(openAirFormat(coordStr, true /* seconds */, pos))
+    return pos;
 
-    int lonXDeg = captured.at(4).toInt(&lonOk);
-    float lonXMin = captured.at(5).toFloat(&lonMinOk);
-    QString ew = captured.at(6);
+  if(openAirFormat(coordStr, false /* seconds */, pos))
+    return pos;
 
-    if(latOk && lonOk && latMinOk && lonMinOk &&
-       -90 <= latYDeg && latYDeg <= 90 &&
-       -180 <= lonXDeg && lonXDeg <= 180)
-      return atools::geo::Pos((lonXDeg + lonXMin / 60.f) * (ew == "W" ? -1.f : 1.f),
-                              (latYDeg + latYMin / 60.f) * (ns == "S" ? -1.f : 1.f));
-  }
   return atools::geo::EMPTY_POS;
 }
 
@@ -18,7 +18,7 @@
 #ifndef LITTLENAVMAP_COORDINATES_H
 #define LITTLENAVMAP_COORDINATES_H
 
-#include <QString>
+#include <QStringList>
 
 namespace atools {
 namespace geo {
@@ -59,8 +59,13 @@ QString toDegMinFormat(const atools::geo::Pos& pos);
 /* Skyvector 481050N0113157E */
 QString toDegMinSecFormat(const atools::geo::Pos& pos);
 
+/* Detects the waypoint format by string length. Fixed width formats are parsed without regular expressions
+ * and allocations if the string contains no tabs or multiple spaces. */
 atools::geo::Pos fromAnyWaypointFormat(const QString& str);
 
+/* Converts a batch of waypoint coordinates. Invalid entries result in EMPTY_POS at the same index. */
+QList<atools::geo::Pos> fromAnyWaypointFormat(const QStringList& strings);
+
 /* N44124W122451 or N14544W017479 or S31240E136502 */
 atools::geo::Pos fromGfpFormat(const QString& str);
 
@@ -434,6 +434,41 @@ QStringList normalizeRunways(QStringList names)
   return names;
 }
 
+quint16 runwayPacked(QStringView name, bool normalize)
+{
+  if(normalize)
+  {
+    // Same as runwayFlags()
+    if(name.startsWith(QLatin1String("RW")))
+      name = name.mid(2);
+
+    if(name.endsWith('T'))
+      name.chop(1);
+  }
+
+  int number = 0, numDigits = 0;
+  while(numDigits < name.size() && numDigits < 3 && name.at(numDigits) >= '0' && name.at(numDigits) <= '9')
+    number = number * 10 + (name.at(numDigits++).unicode() - '0');
+
+  if(!(numDigits == 2 || (normalize && numDigits == 1)))
+    return 0;
+
+  quint16 designator = 0;
+  if(name.size() == numDigits + 1)
+  {
+    QChar desig = normalize ? name.at(numDigits).toUpper() : name.at(numDigits);
+    int idx = QStringView(u"LRCWAB").indexOf(desig);
+    if(idx == -1)
+      return 0;
+    designator = static_cast<quint16>(idx + 1);
+  }
+  else if(name.size() > numDigits + 1)
+    return 0;
+
+  // Number plus one to avoid 0 for "00"
+  return static_cast<quint16>(((number + 1) << 3) | designator);
+}
+
 const QString& aircraftTypeForCode(const QString& code)
 {
   return atools::hashValue(NAME_CODE_MAP, code);
@@ -108,6 +108,13 @@ void sidStarMultiRunways(const QStringList& runwayNames, const QString& arincNam
 QString normalizeRunway(QString runway);
 QStringList normalizeRunways(QStringList names);
 
+/* Pack a runway name like "09L" into a small non-zero number for use in index keys.
+ * Number and designator (L, R, C, W, A or B) are encoded. Needs exactly two digits like "09" if normalize is false.
+ * normalize = true accepts "RW" prefix, "T" suffix and missing leading zero and gives the same number for
+ * names which are equal after normalizeRunway().
+ * Returns 0 if the name cannot be packed like for "N" or "H1". Use the string as key in this case. */
+quint16 runwayPacked(QStringView name, bool normalize);
+
 /* Converts decimals from transponder to integer.
  * Returns decimal 4095/ octal 07777 / hex 0xFFF for number 7777
  * -1 if number is not valid. */
@@ -24,12 +24,17 @@
 #include "geo/pos.h"
 #include "geo/spatialindex.h"
 #include "util/contextsaver.h"
+#include "util/memoryusage.h"
+#include "util/tracer.h"
 
 #include <QTimeZone>
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QFile>
+#include <QSet>
+#include <QThread>
+#include <QThreadPool>
 
 namespace atools {
 namespace fs {
@@ -54,7 +59,17 @@ public:
   }
 
   atools::geo::Pos pos;
-  int index; /* Index to "metarVector" or "metarInterpolatedVector" */
+  int index; /* Index to "metarEntries" or "metarInterpolatedVector" */
+};
+
+/* Raw METAR for a station as read from file. Parsed on demand into MetarIndex::metarVector. */
+struct MetarEntry
+{
+  QByteArray ident, metar;
+  QDateTime timestamp;
+  atools::geo::Pos pos;
+  int parsedIndex = -1; /* Index to "metarVector" or -1 if not parsed yet */
+  bool parsed = false; /* Slot at parsedIndex is outdated if false */
 };
 
 } // namespace weather
@@ -67,6 +82,38 @@ namespace atools {
 namespace fs {
 namespace weather {
 
+/* Number of nearest stations fetched for each grid cell in getMetarsInterpolated() relative to numInterpolation.
+ * Larger than one to get the nearest stations for all positions in a cell. */
+const static int BATCH_CANDIDATE_FACTOR = 2;
+
+/* Minimum number of METARs for each thread in getMetarsInterpolated() */
+const static int BATCH_MIN_PER_THREAD = 64;
+
+/* Run func(start, end) in chunks on a thread pool if there is enough work */
+template<typename FUNC>
+void runParallel(int num, const FUNC& func)
+{
+  int numThreads = std::max(1, std::min(QThread::idealThreadCount(), num / BATCH_MIN_PER_THREAD));
+
+  if(numThreads > 1)
+  {
+    QThreadPool pool;
+    pool.setMaxThreadCount(numThreads);
+    int chunkSize = (num + numThreads - 1) / numThreads;
+
+    for(int start = 0; start < num; start += chunkSize)
+    {
+      int end = std::min(start + chunkSize, num);
+      pool.start([&func, start, end]() -> void {
+            func(start, end);
+          });
+    }
+    pool.waitForDone();
+  }
+  else if(num > 0)
+    func(0, num);
+}
+
 inline bool isDigit(char c)
 {
   return c >= '0' && c <= '9';
@@ -87,6 +134,7 @@ MetarIndex::MetarIndex(MetarFormat formatParam, bool verboseLogging)
 
 MetarIndex::~MetarIndex()
 {
+  setDoubleBuffered(false);
   ATOOLS_DELETE_LOG(spatialIndex);
   ATOOLS_DELETE_LOG(spatialIndexInterpolated);
 }
@@ -107,8 +155,99 @@ int MetarIndex::read(const QString& filename, bool merge)
   return metarsRead;
 }
 
+void MetarIndex::setDoubleBuffered(bool value)
+{
+  if(value && backIndex == nullptr)
+  {
+    // Start back buffer with a copy of the current METARs to allow merging
+    backIndex = new MetarIndex(format, verbose);
+    backIndex->setFetchAirportCoords(airportCoordFunction, airportCoordObject);
+    copyEntriesTo(backIndex);
+
+    // One thread keeps reads in order
+    backgroundPool = new QThreadPool;
+    backgroundPool->setMaxThreadCount(1);
+  }
+  else if(!value && backIndex != nullptr)
+  {
+    backgroundPool->waitForDone();
+    adoptPublishedIndex();
+
+    ATOOLS_DELETE_LOG(backgroundPool);
+    ATOOLS_DELETE_LOG(backIndex);
+  }
+}
+
+void MetarIndex::readInBackground(const QByteArray& text, const QString& fileOrUrl, bool merge,
+                                  const std::function<void(int)>& finished)
+{
+  if(backIndex == nullptr)
+  {
+    QTextStream stream(text, QIODevice::ReadOnly | QIODevice::Text);
+    int numRead = read(stream, fileOrUrl, merge);
+    if(finished)
+      finished(numRead);
+    return;
+  }
+
+  backgroundReads++;
+  backgroundPool->start([this, text, fileOrUrl, merge, finished]() {
+          QTextStream stream(text, QIODevice::ReadOnly | QIODevice::Text);
+          int numRead = backIndex->read(stream, fileOrUrl, merge);
+
+          // Publish a copy since the back buffer is needed for following merges
+          MetarIndex *snapshot = new MetarIndex(format, verbose);
+          backIndex->copyEntriesTo(snapshot);
+
+          // Replace any index not taken over yet
+          delete publishedIndex.exchange(snapshot);
+
+          backgroundReads--;
+          if(finished)
+            finished(numRead);
+        });
+}
+
+bool MetarIndex::adoptPublishedIndex()
+{
+  MetarIndex *index = publishedIndex.exchange(nullptr);
+  if(index != nullptr)
+  {
+    // Swap only data and keep settings
+    std::swap(identIndexMap, index->identIndexMap);
+    std::swap(metarEntries, index->metarEntries);
+    std::swap(metarVector, index->metarVector);
+    std::swap(spatialIndex, index->spatialIndex);
+    clearCache();
+
+    // Old data is not used anymore by this thread
+    delete index;
+    return true;
+  }
+  return false;
+}
+
+void MetarIndex::copyEntriesTo(MetarIndex *index) const
+{
+  index->identIndexMap = identIndexMap;
+  index->metarEntries = metarEntries;
+
+  for(int i = 0; i < index->metarEntries.size(); i++)
+  {
+    MetarEntry& entry = index->metarEntries[i];
+    entry.parsedIndex = -1;
+    entry.parsed = false;
+
+    if(entry.pos.isValid())
+      index->spatialIndex->append(PosIndex(entry.pos, i));
+  }
+  index->updateIndex();
+}
+
 int MetarIndex::read(QTextStream& stream, const QString& fileOrUrl, bool merge)
 {
+  ATOOLS_TRACE_SPAN_DETAIL("MetarIndex::read", fileOrUrl);
+
   Q_ASSERT(format != UNKNOWN);
   Q_ASSERT(airportCoordFunction);
 
@@ -255,6 +394,7 @@ int MetarIndex::readNoaaXplane(QTextStream& stream, const QString& fileOrUrl, bo
     qDebug() << "spatialIndex->size()" << spatialIndex->size();
     qDebug() << "spatialIndexInterpolated->size()" << spatialIndexInterpolated->size();
     qDebug() << "identIndexMap.size()" << identIndexMap.size();
+    qDebug() << "metarEntries.size()" << metarEntries.size();
     qDebug() << "metars.size()" << metarVector.size();
     qDebug() << "metarsInterpolated.size()" << metarInterpolatedVector.size();
     qDebug() << "found " << found << "futureDates " << futureDates << "invalidDates" << invalidDates;
@@ -389,6 +529,7 @@ int MetarIndex::readFlat(QTextStream& stream, const QString& fileOrUrl, bool mer
     qDebug() << "spatialIndex->size()" << spatialIndex->size();
     qDebug() << "spatialIndexInterpolated->size()" << spatialIndexInterpolated->size();
     qDebug() << "identIndexMap.size()" << identIndexMap.size();
+    qDebug() << "metarEntries.size()" << metarEntries.size();
     qDebug() << "metars.size()" << metarVector.size();
     qDebug() << "metarsInterpolated.size()" << metarInterpolatedVector.size();
     qDebug() << "found " << found << "futureDates " << futureDates << "invalidDates" << invalidDates;
@@ -476,6 +617,7 @@ int MetarIndex::readJson(QTextStream& stream, const QString& fileOrUrl, bool mer
     qDebug() << "spatialIndex->size()" << spatialIndex->size();
     qDebug() << "spatialIndexInterpolated->size()" << spatialIndexInterpolated->size();
     qDebug() << "identIndexMap.size()" << identIndexMap.size();
+    qDebug() << "metarEntries.size()" << metarEntries.size();
     qDebug() << "metars.size()" << metarVector.size();
     qDebug() << "metarsInterpolated.size()" << metarInterpolatedVector.size();
     qDebug() << "found " << found << "futureDates " << futureDates << "invalidDates" << invalidDates;
@@ -489,43 +631,75 @@ int MetarIndex::readJson(QTextStream& stream, const QString& fileOrUrl, bool mer
 
 void MetarIndex::updateOrInsert(const QByteArray& metarString, const QByteArray& ident, const QDateTime& lastTimestamp)
 {
-  if(identIndexMap.contains(ident))
+  int idx = identIndexMap.value(ident, -1);
+  if(idx != -1)
   {
-    int idx = identIndexMap.value(ident, -1);
-    if(idx != -1)
+    // Already in list - get writeable reference to entry
+    MetarEntry& entry = metarEntries[idx];
+    if((!entry.timestamp.isValid() || entry.timestamp < lastTimestamp) && entry.metar != metarString)
     {
-      // Already in list - get writeable reference to entry
-      Metar& metar = metarVector[idx];
-      if((!metar.getTimestamp().isValid() || metar.getTimestamp() < lastTimestamp) && metar.getStationMetar() != metarString)
-      {
-        // This one is newer - update
-        metar.setMetarForStation(metarString);
-        metar.setTimestamp(lastTimestamp);
-        metar.parseAll(false /* useTimestamp */);
-      }
+      // This one is newer - update
+      entry.metar = metarString;
+      entry.timestamp = lastTimestamp;
+
+      // Parse again on next request and reuse slot in metarVector if any
+      entry.parsed = false;
     }
   }
   else
   {
-    // Insert new record
-    atools::geo::Pos pos = airportCoordFunction(ident, airportCoordObject);
+    // Insert new record without parsing
+    MetarEntry entry;
+    entry.ident = ident;
+    entry.metar = metarString;
+    entry.timestamp = lastTimestamp;
+    entry.pos = airportCoordFunction(ident, airportCoordObject);
 
-    Metar metar(ident, pos, lastTimestamp, metarString);
-    metar.parseAll(false /* useTimestamp */);
-
-    metarVector.append(metar);
-    identIndexMap.insert(ident, metarVector.size() - 1);
+    metarEntries.append(entry);
+    identIndexMap.insert(ident, metarEntries.size() - 1);
 
     // Add only valid positions to spatial index
-    if(pos.isValid())
-      spatialIndex->append(PosIndex(pos, metarVector.size() - 1));
+    if(entry.pos.isValid())
+      spatialIndex->append(PosIndex(entry.pos, metarEntries.size() - 1));
   }
 }
 
+const Metar& MetarIndex::parsedMetar(int index)
+{
+  MetarEntry& entry = metarEntries[index];
+
+  if(entry.parsed)
+    return metarVector.at(entry.parsedIndex);
+
+  Metar metar(QString::fromLatin1(entry.ident), entry.pos, entry.timestamp, QString::fromLatin1(entry.metar));
+  metar.parseAll(false /* useTimestamp */);
+
+  if(entry.parsedIndex == -1)
+  {
+    // First request - append to cache
+    metarVector.append(metar);
+    entry.parsedIndex = metarVector.size() - 1;
+  }
+  else
+    // Entry was updated after parsing - reuse slot
+    metarVector[entry.parsedIndex] = metar;
+
+  entry.parsed = true;
+  return metarVector.at(entry.parsedIndex);
+}
+
 void MetarIndex::clear()
 {
+  if(backIndex != nullptr)
+  {
+    backgroundPool->waitForDone();
+    delete publishedIndex.exchange(nullptr);
+    backIndex->clear();
+  }
+
   spatialIndex->clearIndex();
   identIndexMap.clear();
+  metarEntries.clear();
   metarVector.clear();
   clearCache();
 }
@@ -538,16 +712,44 @@ void MetarIndex::clearCache()
 
 bool MetarIndex::isEmpty() const
 {
-  return metarVector.isEmpty();
+  return metarEntries.isEmpty();
 }
 
 int MetarIndex::numStationMetars() const
 {
-  return metarVector.size();
+  return metarEntries.size();
+}
+
+void MetarIndex::getMemoryUsage(atools::util::MemoryUsage& usage) const
+{
+  using atools::util::MemoryUsage;
+
+  qint64 entryBytes = MemoryUsage::listBytes(metarEntries) + MemoryUsage::hashBytes(identIndexMap);
+  for(const MetarEntry& entry : metarEntries)
+    entryBytes += entry.ident.capacity() + entry.metar.capacity();
+  usage.add(QStringLiteral("MetarIndex/entries"), entryBytes, metarEntries.size());
+
+  // Parsed weather groups are not counted
+  qint64 parsedBytes = MemoryUsage::listBytes(metarVector);
+  for(const Metar& metar : metarVector)
+    parsedBytes += MemoryUsage::stringBytes(metar.getStationMetar());
+  usage.add(QStringLiteral("MetarIndex/parsed"), parsedBytes, metarVector.size());
+
+  qint64 interpolatedBytes = MemoryUsage::listBytes(metarInterpolatedVector);
+  for(const Metar& metar : metarInterpolatedVector)
+    interpolatedBytes += MemoryUsage::stringBytes(metar.getInterpolatedMetar());
+  usage.add(QStringLiteral("MetarIndex/interpolated"), interpolatedBytes, metarInterpolatedVector.size());
+
+  if(spatialIndex != nullptr)
+    spatialIndex->getMemoryUsage(usage, QStringLiteral("MetarIndex/index"));
+  if(spatialIndexInterpolated != nullptr)
+    spatialIndexInterpolated->getMemoryUsage(usage, QStringLiteral("MetarIndex/indexInterpolated"));
 }
 
 const atools::fs::weather::Metar& MetarIndex::getMetar(const QString& station, atools::geo::Pos pos)
 {
+  adoptPublishedIndex();
+
   if(!reading)
   {
     const QByteArray stationBytes = station.toLatin1();
@@ -576,10 +778,14 @@ const atools::fs::weather::Metar& MetarIndex::getMetar(const QString& station, a
         QList<PosIndex> posIndexes;
         spatialIndex->getNearest(posIndexes, pos, numInterpolation);
 
+        // Parse all first since this can add to metarVector and invalidate pointers ====================
+        for(const PosIndex& posIndex : std::as_const(posIndexes))
+          parsedMetar(posIndex.index);
+
         // Collect positions ====================
         atools::fs::weather::MetarPtrList metars;
         for(const PosIndex& posIndex : std::as_const(posIndexes))
-          metars.append(&metarVector.at(posIndex.index));
+          metars.append(&metarVector.at(metarEntries.at(posIndex.index).parsedIndex));
 
         // Sort by distance to request point ====================
         std::sort(metars.begin(), metars.end(), [&pos](const Metar *t1, const Metar *t2) -> bool {
@@ -613,19 +819,134 @@ const atools::fs::weather::Metar& MetarIndex::getMetar(const QString& station, a
   return Metar::EMPTY;
 }
 
+void MetarIndex::getMetarsInterpolated(QList<Metar>& metars, const QList<atools::geo::Pos>& positions, float gridSizeDeg)
+{
+  adoptPublishedIndex();
+
+  metars.clear();
+  metars.resize(positions.size());
+
+  if(reading || spatialIndex->isEmpty() || positions.isEmpty())
+    return;
+
+  // Assign positions to grid cells =====================================
+  QHash<qint64, int> cellIndexMap;
+  QList<atools::geo::Pos> cellCenters;
+  QList<int> positionCells(positions.size(), -1);
+  for(int i = 0; i < positions.size(); i++)
+  {
+    const atools::geo::Pos& pos = positions.at(i);
+    if(pos.isValid())
+    {
+      qint64 col = static_cast<qint64>(std::floor((pos.getLonX() + 180.f) / gridSizeDeg));
+      qint64 row = static_cast<qint64>(std::floor((pos.getLatY() + 90.f) / gridSizeDeg));
+      qint64 key = (row << 32) | col;
+
+      auto it = cellIndexMap.constFind(key);
+      if(it == cellIndexMap.constEnd())
+      {
+        it = cellIndexMap.insert(key, static_cast<int>(cellCenters.size()));
+        cellCenters.append(atools::geo::Pos((col + 0.5f) * gridSizeDeg - 180.f,
+                                            std::min((row + 0.5f) * gridSizeDeg - 90.f, 90.f)));
+      }
+      positionCells[i] = it.value();
+    }
+  }
+
+  // Nearest stations for each cell =====================================
+  atools::geo::SpatialIndexBatchResult nearest;
+  spatialIndex->getNearestIndexesBatch(nearest, cellCenters, numInterpolation * BATCH_CANDIDATE_FACTOR, true /* parallel */);
+
+  // Parse all stations not parsed yet in parallel and add them to the cache =====================================
+  QSet<int> unparsedSet;
+  for(int idx : std::as_const(nearest.indexes))
+  {
+    int entryIndex = spatialIndex->at(idx).index;
+    if(!metarEntries.at(entryIndex).parsed)
+      unparsedSet.insert(entryIndex);
+  }
+  const QList<int> unparsed(unparsedSet.constBegin(), unparsedSet.constEnd());
+
+  QList<Metar> parsedMetars(unparsed.size());
+  Metar *parsedData = parsedMetars.data();
+  const MetarEntry *entryData = metarEntries.constData();
+  const int *unparsedData = unparsed.constData();
+  runParallel(static_cast<int>(unparsed.size()), [parsedData, entryData, unparsedData](int start, int end) -> void {
+        for(int i = start; i < end; i++)
+        {
+          const MetarEntry& entry = entryData[unparsedData[i]];
+          parsedData[i] = Metar(QString::fromLatin1(entry.ident), entry.pos, entry.timestamp, QString::fromLatin1(entry.metar));
+          parsedData[i].parseAll(false /* useTimestamp */);
+        }
+      });
+
+  for(int i = 0; i < unparsed.size(); i++)
+  {
+    MetarEntry& entry = metarEntries[unparsed.at(i)];
+    if(entry.parsedIndex == -1)
+    {
+      metarVector.append(parsedMetars.at(i));
+      entry.parsedIndex = metarVector.size() - 1;
+    }
+    else
+      metarVector[entry.parsedIndex] = parsedMetars.at(i);
+    entry.parsed = true;
+  }
+
+  // Interpolate in parallel - no more changes to containers from here =====================================
+  const float maxDistanceMeter = atools::geo::nmToMeter(maxDistanceInterpolationNm);
+  const int maxNumMetars = numInterpolation;
+  const Metar *metarData = metarVector.constData();
+  const PosIndex *posIndexData = spatialIndex->constData();
+  const int *cellData = positionCells.constData();
+  const atools::geo::Pos *positionData = positions.constData();
+  Metar *resultData = metars.data();
+
+  runParallel(static_cast<int>(positions.size()), [=, &nearest](int start, int end) -> void {
+        atools::fs::weather::MetarPtrList candidates;
+        for(int i = start; i < end; i++)
+        {
+          int cell = cellData[i];
+          if(cell == -1)
+            continue;
+
+          const atools::geo::Pos& pos = positionData[i];
+          candidates.clear();
+          for(int k = nearest.begin(cell); k < nearest.end(cell); k++)
+            candidates.append(&metarData[entryData[posIndexData[nearest.indexes.at(k)].index].parsedIndex]);
+
+          // Sort by distance to request point and keep nearest like getMetar() ====================
+          std::sort(candidates.begin(), candidates.end(), [&pos](const Metar *t1, const Metar *t2) -> bool {
+                return t1->getPosition().distanceMeterTo(pos) < t2->getPosition().distanceMeterTo(pos);
+              });
+
+          if(candidates.size() > maxNumMetars)
+            candidates.resize(maxNumMetars);
+
+          candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [maxDistanceMeter, &pos](const Metar *m) -> bool {
+                return m->getPosition().distanceMeterTo(pos) > maxDistanceMeter || !m->hasStationMetar() ||
+                       m->getStation().hasErrors();
+              }), candidates.end());
+
+          resultData[i] = Metar(QString(), pos, candidates);
+          resultData[i].parseAll(false /* useTimestamp */);
+        }
+      });
+}
+
 void MetarIndex::updateIndex()
 {
   spatialIndex->updateIndex();
 }
 
-const Metar& MetarIndex::fetchMetar(const QByteArray& ident) const
+const Metar& MetarIndex::fetchMetar(const QByteArray& ident)
 {
   if(!ident.isEmpty())
   {
     int idx = identIndexMap.value(ident, -1);
 
     if(idx != -1)
-      return metarVector.at(idx);
+      return parsedMetar(idx);
   }
 
   return Metar::EMPTY;
@@ -23,7 +23,11 @@
 
 #include <QList>
 
+#include <atomic>
+#include <functional>
+
 class QTextStream;
+class QThreadPool;
 
 class QDateTime;
 
@@ -34,11 +38,16 @@ template<typename TYPE>
 class SpatialIndex;
 }
 
+namespace util {
+class MemoryUsage;
+}
+
 namespace fs {
 namespace weather {
 
 class PosIndex;
 class Metar;
+struct MetarEntry;
 
 /*
  * Reads, caches and indexes (by position) METAR reports in NOAA style as also used by X-Plane.
@@ -59,6 +68,13 @@ class Metar;
  *
  * KC99 100906Z AUTO 30022G42KT 10SM CLR M01/M04 A3035 RMK AO2
  * LCEN 100920Z 16004KT 090V230 CAVOK 31/10 Q1010 NOSIG
+ *
+ * Reading stores only the raw METAR string, timestamp and position for each station.
+ * Station METARs are parsed on first access by getMetar() and kept until the station is updated or the index is cleared.
+ *
+ * Double buffered mode builds a complete new index in a background thread and publishes it with an atomic pointer
+ * exchange. The thread using the index takes the new one over on the next lookup and never waits for reading.
+ * All methods except readInBackground() have to be called from the same thread.
  */
 class MetarIndex
 {
@@ -75,7 +91,31 @@ public:
   int read(QTextStream& stream, const QString& fileName, bool merge);
   int read(const QString& filename, bool merge);
 
-  /* Clears all lists */
+  /* Enable or disable double buffered mode. Waits for outstanding background reads when disabling.
+   * The airport coordinate callback is called from a background thread in this mode and has to be thread safe. */
+  void setDoubleBuffered(bool value);
+
+  bool isDoubleBuffered() const
+  {
+    return backIndex != nullptr;
+  }
+
+  /* Read METARs from text into the back buffer in a background thread and publish a copy when done.
+   * Reads are done in order of calls. finished is called in the background thread with the number of METARs read.
+   * Reads synchronously if not in double buffered mode. Do not mix with read() in double buffered mode. */
+  void readInBackground(const QByteArray& text, const QString& fileOrUrl, bool merge, const std::function<void(int)>& finished);
+
+  /* Take over an index published by a background read. Called by getMetar().
+   * Returns true if a new index was taken over. */
+  bool adoptPublishedIndex();
+
+  /* true while background reads are queued or running */
+  bool isReadingInBackground() const
+  {
+    return backgroundReads.load() > 0;
+  }
+
+  /* Clears all lists. Also waits for background reads and clears the back buffer if double buffered. */
   void clear();
   void clearCache();
 
@@ -85,6 +125,10 @@ public:
   /* Number of unique airport idents in index */
   int numStationMetars() const;
 
+  /* Add estimated memory of raw, parsed and interpolated METARs and spatial indexes.
+   * The back buffer used in double buffered mode is not included since it is changed by a background thread. */
+  void getMemoryUsage(atools::util::MemoryUsage& usage) const;
+
   /* Get METAR information for station, nearest or interpolated.
    * - Station will be saved as request ident if given. Only interpolated and/or nearest are returned if station is not given.
    * - Nearest is returned if no station can be found.
@@ -92,11 +136,22 @@ public:
    * Position and ident of original request are kept.*/
   const Metar& getMetar(const QString& station, atools::geo::Pos pos);
 
-  /* Set to a function that returns the coordinates for an airport ident. Needed to find the nearest if no position is given. */
+  /* Get interpolated METARs for many positions at once like getMetar() does for positions without station METAR.
+   * Nearest stations are searched once for each cell of a grid with gridSizeDeg and shared by all positions in the cell.
+   * Parsing and interpolation run on a thread pool. Results are in order of positions and empty for invalid positions.
+   * Does not use or fill the interpolation cache. */
+  void getMetarsInterpolated(QList<atools::fs::weather::Metar>& metars, const QList<atools::geo::Pos>& positions,
+                             float gridSizeDeg = 1.f);
+
+  /* Set to a function that returns the coordinates for an airport ident. Needed to find the nearest if no position is given.
+   * Set before reading in double buffered mode. */
   void setFetchAirportCoords(atools::fs::util::AirportCoordFuncType function, void *object)
   {
     airportCoordFunction = function;
     airportCoordObject = object;
+
+    if(backIndex != nullptr)
+      backIndex->setFetchAirportCoords(function, object);
   }
 
   /* Maximum number of nearest airports fetched for interpolation */
@@ -124,8 +179,11 @@ public:
   }
 
 private:
-  /* Get a METAR string. Empty if not available */
-  const atools::fs::weather::Metar& fetchMetar(const QByteArray& ident) const;
+  /* Get parsed METAR for station. Empty if not available */
+  const atools::fs::weather::Metar& fetchMetar(const QByteArray& ident);
+
+  /* Get parsed METAR for index in metarEntries. Parses and caches METAR on first call. */
+  const atools::fs::weather::Metar& parsedMetar(int index);
 
   /* Read NOAA or XPLANE format */
   int readNoaaXplane(QTextStream& stream, const QString& fileOrUrl, bool merge);
@@ -141,6 +199,9 @@ private:
    * a valid coordinate. */
   void updateIndex();
 
+  /* Copy raw METARs to another empty index and build its spatial index. Parsed METARs are not copied. */
+  void copyEntriesTo(MetarIndex *index) const;
+
   /* Update or insert a METAR entry */
   void updateOrInsert(const QByteArray& metarString, const QByteArray& ident, const QDateTime& lastTimestamp);
 
@@ -149,11 +210,17 @@ private:
   atools::fs::util::AirportCoordFuncType airportCoordFunction = nullptr;
   void *airportCoordObject = nullptr;
 
-  /* Map containing all loaded METARs airport idents mapped to the position in metarVector */
+  /* Map containing all loaded METARs airport idents mapped to the position in metarEntries */
   QHash<QByteArray, int> identIndexMap;
 
-  /* Index containing all stations which could be resolved to a coordinate. */
+  /* Index containing all stations which could be resolved to a coordinate.
+   * spatialIndex refers to metarEntries and spatialIndexInterpolated to metarInterpolatedVector. */
   atools::geo::SpatialIndex<PosIndex> *spatialIndex = nullptr, *spatialIndexInterpolated = nullptr;
+
+  /* Raw unparsed METARs for all stations */
+  QList<atools::fs::weather::MetarEntry> metarEntries;
+
+  /* Parsed station METARs referenced by MetarEntry::parsedIndex and interpolated METARs */
   QList<atools::fs::weather::Metar> metarVector, metarInterpolatedVector;
 
   int maxInterpolatedCacheSize = 40000;
@@ -167,6 +234,14 @@ private:
 
   // Block fetching METARs while reading files. Can happen if input events are processes while reading.
   bool reading = false;
+
+  /* Double buffered mode. Back buffer is only used by the single thread in backgroundPool. */
+  MetarIndex *backIndex = nullptr;
+  QThreadPool *backgroundPool = nullptr;
+
+  /* Copy of back buffer waiting to be taken over by adoptPublishedIndex() */
+  std::atomic<MetarIndex *> publishedIndex = nullptr;
+  std::atomic_int backgroundReads = 0;
 };
 
 } // namespace weather
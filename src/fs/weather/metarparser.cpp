@@ -719,14 +719,12 @@ void MetarParser::parse()
 
 void MetarParser::postProcessCloudCoverage()
 {
-  const QList<MetarCloud> clouds = getClouds();
-
   // The lowest "BKN" or "OVC" layer specifies the cloud ceiling.
   float lowestAltitudeMeter = INVALID_METAR_VALUE;
 
   // Calculate lowest and maximum coverage
   maxCoverageCloud = lowestCoverageCloud = MetarCloud(MetarCloud::COVERAGE_CLEAR, 0.f);
-  for(const MetarCloud& cloud : clouds)
+  for(const MetarCloud& cloud : _clouds)
   {
     MetarCloud::Coverage coverage = cloud.getCoverage();
 
@@ -787,7 +785,7 @@ float MetarParser::lowestCloudBase() const
   float minAltitudeMeter = INVALID_METAR_VALUE;
 
   // Calculate lowest and maximum coverage
-  for(const MetarCloud& cloud : getClouds())
+  for(const MetarCloud& cloud : _clouds)
   {
     // The lowest "BKN" or "OVC" layer specifies the cloud ceiling.
     MetarCloud::Coverage coverage = cloud.getCoverage();
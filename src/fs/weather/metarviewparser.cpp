@@ -0,0 +1,643 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/weather/metarviewparser.h"
+
+#include "atools.h"
+#include "geo/calculations.h"
+
+#include <QTimeZone>
+
+#include <algorithm>
+
+namespace atools {
+namespace fs {
+namespace weather {
+
+/* Same conversion factors as in MetarParser */
+const static double KT_TO_MPS = 0.5144444444444444444;
+const static double KMH_TO_MPS = 0.2777777777777777778;
+const static double SM_TO_METER = 1609.3412196;
+const static double FEET_TO_METER = 0.3048;
+const static double INHG_TO_MBAR = 33.86388640341;
+
+/* Two letter weather codes */
+const static char DESCRIPTIONS[][3] = {"SH", "TS", "BC", "BL", "DR", "FZ", "MI", "PR"};
+const static char PHENOMENA[][3] = {"DZ", "GR", "GS", "IC", "PE", "RA", "SG", "SN", "UP", "BR", "DU", "FG", "FU", "HZ",
+                                    "PY", "SA", "VA", "DS", "FC", "PO", "SQ", "SS"};
+
+static inline bool isSpaceChar(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static inline bool isDigitChar(char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+static inline bool isAlnumChar(char c)
+{
+  return isDigitChar(c) || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+}
+
+/* true if len characters starting at from are digits */
+static inline bool digitsAt(QByteArrayView str, qsizetype from, qsizetype len)
+{
+  if(from + len > str.size())
+    return false;
+
+  for(qsizetype i = from; i < from + len; i++)
+  {
+    if(!isDigitChar(str.at(i)))
+      return false;
+  }
+  return true;
+}
+
+/* Number of digits starting at from limited to max. Returns 0 if less than min. */
+static inline int numberLength(QByteArrayView str, qsizetype from, int min, int max)
+{
+  int len = 0;
+  while(len < max && from + len < str.size() && isDigitChar(str.at(from + len)))
+    len++;
+  return len < min ? 0 : len;
+}
+
+static inline int numberAt(QByteArrayView str, qsizetype from, qsizetype len)
+{
+  int value = 0;
+  for(qsizetype i = from; i < from + len; i++)
+    value = value * 10 + (str.at(i) - '0');
+  return value;
+}
+
+template<size_t SIZE>
+static inline bool isCode(QByteArrayView code, const char (&codes)[SIZE][3])
+{
+  for(size_t i = 0; i < SIZE; i++)
+  {
+    if(code.at(0) == codes[i][0] && code.at(1) == codes[i][1])
+      return true;
+  }
+  return false;
+}
+
+void MetarViewParser::reset()
+{
+  *this = MetarViewParser();
+}
+
+bool MetarViewParser::parse(QByteArrayView metarParam)
+{
+  reset();
+  metar = metarParam;
+
+  QByteArrayView group = nextGroup();
+
+  // NOAA preamble "2017/07/30 18:45" ==================
+  if(group.size() == 10 && digitsAt(group, 0, 4) && group.at(4) == '/' && digitsAt(group, 5, 2) && group.at(7) == '/' &&
+     digitsAt(group, 8, 2))
+  {
+    year = numberAt(group, 0, 4);
+    month = numberAt(group, 5, 2);
+    group = nextGroup();
+  }
+
+  if(group.size() == 5 && digitsAt(group, 0, 2) && group.at(2) == ':' && digitsAt(group, 3, 2))
+    group = nextGroup();
+
+  // Header ==================
+  if(group == "METAR" || group == "SPECI")
+  {
+    groupCount++;
+    group = nextGroup();
+  }
+
+  // [A-Z0-9]{1,4}
+  if(group.isEmpty() || group.size() > 4 || !std::all_of(group.begin(), group.end(), isAlnumChar))
+    return false;
+
+  ident = group;
+  groupCount++;
+
+  // \d{6}Z
+  group = nextGroup();
+  if(group.size() != 7 || !digitsAt(group, 0, 6) || group.at(6) != 'Z')
+    return false;
+
+  day = numberAt(group, 0, 2);
+  hour = numberAt(group, 2, 2);
+  minute = numberAt(group, 4, 2);
+  groupCount++;
+
+  // (NIL|AUTO|COR|CCA|RTD)
+  group = nextGroup();
+  if(group == "NIL")
+    return false;
+  else if(group == "AUTO" || group == "COR" || group == "CCA" || group == "RTD")
+  {
+    reportType = group == "AUTO" ? MetarParser::AUTO : (group == "RTD" ? MetarParser::RTD : MetarParser::COR);
+    groupCount++;
+    group = nextGroup();
+  }
+
+  // Base set in any order ==================
+  while(!group.isEmpty())
+  {
+    if(group == "RMK")
+    {
+      remark = metar.sliced(position).trimmed();
+      break;
+    }
+
+    if(group == "NOSIG" || group == "//")
+      // No significant change or sensor failure
+      groupCount++;
+    else if(group == "NSW")
+      // No significant weather
+      ;
+    else if(!scanWind(group) && !scanVariability(group) && !scanVisibility(group) && !scanRunway(group) &&
+            !scanSkyCondition(group) && !scanTemperature(group) && !scanPressure(group) && !scanWeather(group))
+    {
+      // Unknown group or trend like TEMPO - keep all up to remarks as unused
+      qsizetype start = group.data() - metar.data(), end = metar.size();
+      while(!(group = nextGroup()).isEmpty())
+      {
+        if(group == "RMK")
+        {
+          end = group.data() - metar.data();
+          remark = metar.sliced(position).trimmed();
+          break;
+        }
+      }
+      unusedData = metar.sliced(start, end - start).trimmed();
+      break;
+    }
+
+    group = nextGroup();
+  }
+
+  if(groupCount >= 4)
+  {
+    postProcess();
+    parsed = true;
+  }
+  return parsed;
+}
+
+QDateTime MetarViewParser::getTimestamp() const
+{
+  if(year != -1 && month != -1)
+    return QDateTime(QDate(year, month, day), QTime(hour, minute), QTimeZone::utc());
+  else
+    return atools::correctDate(day, hour, minute);
+}
+
+QByteArrayView MetarViewParser::nextGroup()
+{
+  while(position < metar.size() && isSpaceChar(metar.at(position)))
+    position++;
+
+  qsizetype start = position;
+  while(position < metar.size() && !isSpaceChar(metar.at(position)))
+    position++;
+
+  return metar.sliced(start, position - start);
+}
+
+QByteArrayView MetarViewParser::peekGroup() const
+{
+  qsizetype start = position;
+  while(start < metar.size() && isSpaceChar(metar.at(start)))
+    start++;
+
+  qsizetype end = start;
+  while(end < metar.size() && !isSpaceChar(metar.at(end)))
+    end++;
+
+  return metar.sliced(start, end - start);
+}
+
+// (\d{3}|VRB|///)(\d{2,3}|//)(G\d{2,3})?(KT|KMH|KPH|MPS)
+bool MetarViewParser::scanWind(QByteArrayView group)
+{
+  qsizetype i = 3;
+  int dir = -1;
+  if(digitsAt(group, 0, 3))
+    dir = numberAt(group, 0, 3);
+  else if(!group.startsWith("VRB") && !group.startsWith("///"))
+    return false;
+
+  float speed = INVALID_METAR_VALUE, gust = INVALID_METAR_VALUE;
+  if(group.sliced(i).startsWith("//"))
+    i += 2;
+  else
+  {
+    int len = numberLength(group, i, 2, 3);
+    if(len == 0)
+      return false;
+    speed = numberAt(group, i, len);
+    i += len;
+  }
+
+  if(i < group.size() && group.at(i) == 'G')
+  {
+    int len = numberLength(group, ++i, 2, 3);
+    if(len == 0)
+      return false;
+    gust = numberAt(group, i, len);
+    i += len;
+  }
+
+  double factor;
+  QByteArrayView unit = group.sliced(i);
+  if(unit == "KT")
+    factor = KT_TO_MPS;
+  else if(unit == "KMH" || unit == "KPH")
+    factor = KMH_TO_MPS;
+  else if(unit == "MPS")
+    factor = 1.;
+  else
+    return false;
+
+  windDir = dir;
+  if(speed < INVALID_METAR_VALUE)
+    windSpeedMs = static_cast<float>(speed * factor);
+  if(gust < INVALID_METAR_VALUE)
+    gustSpeedMs = static_cast<float>(gust * factor);
+  groupCount++;
+  return true;
+}
+
+// \d{3}V\d{3}
+bool MetarViewParser::scanVariability(QByteArrayView group)
+{
+  if(group == "///V///")
+  {
+    groupCount++;
+    return true;
+  }
+
+  if(group.size() != 7 || !digitsAt(group, 0, 3) || group.at(3) != 'V' || !digitsAt(group, 4, 3))
+    return false;
+
+  windRangeFrom = numberAt(group, 0, 3);
+  windRangeTo = numberAt(group, 4, 3);
+  groupCount++;
+  return true;
+}
+
+// \d{4}(N|NE|E|SE|S|SW|W|NW|NDV)? or [MP]?(\d{1,2}|\d{1,2}/\d{1,2}|\d{1,2} \d{1,2}/\d{1,2})(SM|KM)
+bool MetarViewParser::scanVisibility(QByteArrayView group)
+{
+  if(group == "////" || group == "////SM")
+  {
+    groupCount++;
+    return true;
+  }
+
+  if(digitsAt(group, 0, 4))
+  {
+    QByteArrayView dir = group.sliced(4);
+    bool directional = !dir.isEmpty() && dir != "NDV";
+    if(directional && dir != "N" && dir != "NE" && dir != "E" && dir != "SE" && dir != "S" && dir != "SW" &&
+       dir != "W" && dir != "NW")
+      return false;
+
+    if(!directional)
+    {
+      // Directional visibility is ignored
+      int distance = numberAt(group, 0, 4);
+      if(distance == 0)
+        setVisibility(50.f, MetarVisibility::LESS_THAN);
+      else if(distance == 9999)
+        setVisibility(10000.f, MetarVisibility::GREATER_THAN);
+      else
+        setVisibility(static_cast<float>(distance), MetarVisibility::EQUALS);
+    }
+    groupCount++;
+    return true;
+  }
+
+  qsizetype i = 0;
+  MetarVisibility::Modifier modifier = MetarVisibility::EQUALS;
+  if(group.startsWith('M'))
+    i++, modifier = MetarVisibility::LESS_THAN;
+  else if(group.startsWith('P'))
+    i++, modifier = MetarVisibility::GREATER_THAN;
+
+  int len = numberLength(group, i, 1, 2);
+  if(len == 0)
+    return false;
+
+  double distance = numberAt(group, i, len);
+  i += len;
+
+  if(i < group.size() && group.at(i) == '/')
+  {
+    // Fraction like 1/2SM
+    len = numberLength(group, ++i, 1, 2);
+    if(len == 0 || numberAt(group, i, len) == 0)
+      return false;
+    distance /= numberAt(group, i, len);
+    i += len;
+  }
+  else if(i == group.size())
+  {
+    // Whole number followed by fraction like "1 1/2SM"
+    QByteArrayView next = peekGroup();
+    int numLen = numberLength(next, 0, 1, 2);
+    if(numLen == 0 || numLen >= next.size() || next.at(numLen) != '/')
+      return false;
+
+    int denomLen = numberLength(next, numLen + 1, 1, 2);
+    if(denomLen == 0 || numberAt(next, numLen + 1, denomLen) == 0)
+      return false;
+
+    QByteArrayView unit = next.sliced(numLen + 1 + denomLen);
+    if(unit != "SM" && unit != "KM")
+      return false;
+
+    distance += static_cast<double>(numberAt(next, 0, numLen)) / numberAt(next, numLen + 1, denomLen);
+    nextGroup();
+    group = next;
+    i = numLen + 1 + denomLen;
+  }
+
+  QByteArrayView unit = group.sliced(i);
+  if(unit == "SM")
+    distance *= SM_TO_METER;
+  else if(unit == "KM")
+    distance *= 1000.;
+  else
+    return false;
+
+  setVisibility(static_cast<float>(distance), modifier);
+  groupCount++;
+  return true;
+}
+
+// R\d\d[LCR]?/... or \d\d(CLRD|[\d/]{4})(\d\d|//)
+bool MetarViewParser::scanRunway(QByteArrayView group)
+{
+  bool visualRange = group.size() > 4 && group.at(0) == 'R' && digitsAt(group, 1, 2) &&
+                     (group.at(3) == '/' || (group.size() > 5 && group.at(4) == '/'));
+
+  bool report = group.size() == 8 && digitsAt(group, 0, 2) &&
+                (group.sliced(2, 4) == "CLRD" ||
+                 std::all_of(group.begin() + 2, group.end(), [](char c) {
+            return isDigitChar(c) || c == '/';
+          }));
+
+  if(!visualRange && !report)
+    return false;
+
+  if(numRunways < MAX_RUNWAYS)
+    runways[numRunways++] = group;
+  groupCount++;
+  return true;
+}
+
+// (FEW|SCT|BKN|OVC|SKC|CLR|NCD|NSC|CAVOK|VV|///)([0-9]{2,3}|///)?[:cloud_type:]?(///)?
+bool MetarViewParser::scanSkyCondition(QByteArrayView group)
+{
+  if(group == "//////TCU" || group == "//////CB" || group == "///CB" || group == "/////////" || group == "//////" ||
+     group == "/////")
+    return true;
+
+  if(group == "CLR" || group == "SKC" || group == "NCD" || group == "NSC")
+  {
+    if(numClouds < MAX_CLOUDS)
+      clouds[numClouds++] = {MetarCloud::COVERAGE_CLEAR, INVALID_METAR_VALUE, QByteArrayView()};
+    return true;
+  }
+
+  if(group == "CAVOK")
+  {
+    cavok = true;
+    return true;
+  }
+
+  qsizetype i = 3;
+  MetarCloud::Coverage coverage = MetarCloud::COVERAGE_NIL;
+  bool vertical = false;
+  if(group.startsWith("VV"))
+    i = 2, vertical = true;
+  else if(group.startsWith("FEW"))
+    coverage = MetarCloud::COVERAGE_FEW;
+  else if(group.startsWith("SCT"))
+    coverage = MetarCloud::COVERAGE_SCATTERED;
+  else if(group.startsWith("BKN"))
+    coverage = MetarCloud::COVERAGE_BROKEN;
+  else if(group.startsWith("OVC"))
+    coverage = MetarCloud::COVERAGE_OVERCAST;
+  else if(!group.startsWith("///"))
+    return false;
+
+  if(i == group.size())
+    // Ignore single OVC/BKN/...
+    return true;
+
+  float altitudeMeter = INVALID_METAR_VALUE;
+  if(group.sliced(i).startsWith("///"))
+    // Altitude not measurable
+    i += 3;
+  else
+  {
+    int len = numberLength(group, i, 2, 3);
+    if(len > 0)
+      altitudeMeter = static_cast<float>(numberAt(group, i, len) * 100 * FEET_TO_METER);
+    i += len;
+  }
+
+  if(vertical)
+  {
+    if(i != group.size())
+      return false;
+
+    vertVisibilityMeter = altitudeMeter;
+    return true;
+  }
+
+  // Cloud type like CB or TCU and optional sensor failure indicator like in FEW045///
+  QByteArrayView type = group.sliced(i);
+  if(type.endsWith("///"))
+    type.chop(3);
+
+  if(!std::all_of(type.begin(), type.end(), [](char c) {
+          return c >= 'A' && c <= 'Z';
+        }))
+    return false;
+
+  if(numClouds < MAX_CLOUDS)
+    clouds[numClouds++] = {coverage, altitudeMeter, type};
+  groupCount++;
+  return true;
+}
+
+// M?[0-9]{2}/(M?[0-9]{2}|//|XX)?
+bool MetarViewParser::scanTemperature(QByteArrayView group)
+{
+  if(group == "XX/XX" || group == "/////")
+    return true;
+
+  qsizetype i = 0;
+  int sign = 1;
+  if(group.startsWith('M'))
+    i++, sign = -1;
+
+  if(!digitsAt(group, i, 2) || i + 2 >= group.size() || group.at(i + 2) != '/')
+    return false;
+
+  float temp = static_cast<float>(sign * numberAt(group, i, 2));
+  float dew = INVALID_METAR_VALUE;
+
+  QByteArrayView dewGroup = group.sliced(i + 3);
+  if(!dewGroup.isEmpty() && dewGroup != "//" && dewGroup != "XX")
+  {
+    i = 0;
+    sign = 1;
+    if(dewGroup.startsWith('M'))
+      i++, sign = -1;
+
+    if(dewGroup.size() != i + 2 || !digitsAt(dewGroup, i, 2))
+      return false;
+
+    dew = static_cast<float>(sign * numberAt(dewGroup, i, 2));
+  }
+
+  temperatureC = temp;
+  dewpointC = dew;
+  groupCount++;
+  return true;
+}
+
+// [AQ]\d{2}(\d{2}|//)
+bool MetarViewParser::scanPressure(QByteArrayView group)
+{
+  if(group.size() != 5 || (group.at(0) != 'A' && group.at(0) != 'Q') || !digitsAt(group, 1, 2))
+    return false;
+
+  int press = numberAt(group, 1, 2) * 100;
+  if(digitsAt(group, 3, 2))
+    press += numberAt(group, 3, 2);
+  else if(group.sliced(3) != "//")
+    return false;
+
+  pressureMbar = static_cast<float>(group.at(0) == 'A' ? press * INHG_TO_MBAR / 100. : press);
+  groupCount++;
+  return true;
+}
+
+// ([-+]|VC)?(SH|TS|...){0,3}(DZ|RA|...){0,3}
+bool MetarViewParser::scanWeather(QByteArrayView group)
+{
+  qsizetype i = 0;
+  MetarParser::Intensity intensity = MetarParser::MODERATE;
+  bool vincinity = false;
+  if(group.startsWith('-'))
+    i = 1, intensity = MetarParser::LIGHT;
+  else if(group.startsWith('+'))
+    i = 1, intensity = MetarParser::HEAVY;
+  else if(group.startsWith("VC"))
+    i = 2, intensity = MetarParser::NIL, vincinity = true;
+
+  int numCodes = 0;
+  for(int num = 0; num < 3 && i + 2 <= group.size() && isCode(group.sliced(i, 2), DESCRIPTIONS); num++)
+    i += 2, numCodes++;
+
+  for(int num = 0; num < 3 && i + 2 <= group.size() && isCode(group.sliced(i, 2), PHENOMENA); num++)
+  {
+    QByteArrayView code = group.sliced(i, 2);
+    if(code == "RA")
+      rain = intensity;
+    else if(code == "GR")
+      hail = intensity;
+    else if(code == "SN")
+      snow = intensity;
+    i += 2, numCodes++;
+  }
+
+  if(numCodes == 0 || i != group.size())
+    return false;
+
+  if(numWeather < MAX_WEATHER)
+    weather[numWeather++] = {intensity, vincinity, group};
+  groupCount++;
+  return true;
+}
+
+void MetarViewParser::setVisibility(float distanceMeter, MetarVisibility::Modifier modifier)
+{
+  if(!(minVisibilityMeter < INVALID_METAR_VALUE))
+  {
+    minVisibilityMeter = distanceMeter;
+    minVisibilityModifier = modifier;
+  }
+  else
+    maxVisibilityMeter = distanceMeter;
+}
+
+void MetarViewParser::postProcess()
+{
+  // Cloud coverage and ceiling - same as MetarParser::postProcessCloudCoverage() and lowestCloudBase()
+  float lowestAltitudeMeter = INVALID_METAR_VALUE, ceilingMeter = INVALID_METAR_VALUE;
+  maxCoverage = lowestCoverage = MetarCloud::COVERAGE_CLEAR;
+  for(int i = 0; i < numClouds; i++)
+  {
+    const Cloud& cloud = clouds[i];
+    if(cloud.coverage > maxCoverage)
+      maxCoverage = cloud.coverage;
+
+    if(cloud.altitudeMeter < lowestAltitudeMeter)
+    {
+      lowestAltitudeMeter = cloud.altitudeMeter;
+      lowestCoverage = cloud.coverage;
+    }
+
+    if((cloud.coverage == MetarCloud::COVERAGE_BROKEN || cloud.coverage == MetarCloud::COVERAGE_OVERCAST) &&
+       cloud.altitudeMeter < ceilingMeter)
+      ceilingMeter = cloud.altitudeMeter;
+  }
+
+  // Flight rules - same as MetarParser::postProcessFlightRules()
+  float ceilingFt = atools::geo::meterToFeet(ceilingMeter);
+  float visibilityMi = atools::geo::meterToMi(minVisibilityMeter);
+
+  if(visibilityMi < 1.f || ceilingFt < 500.f)
+    flightRules = MetarParser::LIFR;
+  else if(visibilityMi < 3.f || ceilingFt < 1000.f)
+    flightRules = MetarParser::IFR;
+  else if(visibilityMi <= 5.f || ceilingFt <= 3000.f)
+    flightRules = MetarParser::MVFR;
+  else
+    flightRules = MetarParser::VFR;
+
+  // Prevailing wind - same as MetarParser::postProcessPrevailingWind()
+  if(windDir >= 0)
+    prevailingWindDir = windDir;
+  else if(windRangeFrom != -1 && windRangeTo != -1)
+  {
+    int to = windRangeFrom < windRangeTo ? windRangeTo : windRangeTo + 360;
+    prevailingWindDir = atools::roundToInt(atools::geo::normalizeCourse(windRangeFrom + (to - windRangeFrom) / 2.));
+  }
+}
+
+} // namespace weather
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,315 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_METARVIEWPARSER_H
+#define ATOOLS_METARVIEWPARSER_H
+
+#include "fs/weather/metarparser.h"
+
+#include <QByteArrayView>
+
+namespace atools {
+namespace fs {
+namespace weather {
+
+/*
+ * Fast METAR parser for bulk use like map overlays. Reads the raw text without copying or heap allocations.
+ *
+ * Decodes the base groups ident, date, wind, variability, visibility, runway visual range, weather, clouds,
+ * temperature and pressure and calculates flight rules, cloud coverage and prevailing wind like MetarParser.
+ * Groups are kept in fixed size arrays and all text values are views into the parsed METAR, which has to stay
+ * valid while the parser is used.
+ *
+ * Use MetarParser for translated texts, runway reports, trends and interpolation.
+ */
+class MetarViewParser
+{
+public:
+  /* Additional groups are ignored */
+  const static int MAX_CLOUDS = 8;
+  const static int MAX_WEATHER = 8;
+  const static int MAX_RUNWAYS = 8;
+
+  struct Cloud
+  {
+    MetarCloud::Coverage coverage;
+    float altitudeMeter;
+    QByteArrayView type; /* Cloud type like "CB" or empty */
+  };
+
+  struct Weather
+  {
+    MetarParser::Intensity intensity;
+    bool vincinity;
+    QByteArrayView group; /* Full group like "-SHRA" */
+  };
+
+  MetarViewParser()
+  {
+  }
+
+  explicit MetarViewParser(QByteArrayView metarParam)
+  {
+    parse(metarParam);
+  }
+
+  /* Reset all values and parse METAR text. Returns true if successfully parsed.
+   * Accepts optional NOAA preamble lines with date and time. */
+  bool parse(QByteArrayView metarParam);
+
+  void reset();
+
+  bool isParsed() const
+  {
+    return parsed;
+  }
+
+  /* Text as passed to parse() */
+  QByteArrayView getMetar() const
+  {
+    return metar;
+  }
+
+  QByteArrayView getId() const
+  {
+    return ident;
+  }
+
+  int getDay() const
+  {
+    return day;
+  }
+
+  int getHour() const
+  {
+    return hour;
+  }
+
+  int getMinute() const
+  {
+    return minute;
+  }
+
+  /* Uses year and month from preamble if given or the current month otherwise */
+  QDateTime getTimestamp() const;
+
+  MetarParser::ReportType getReportType() const
+  {
+    return reportType;
+  }
+
+  int getWindDir() const
+  {
+    return windDir;
+  }
+
+  float getWindSpeedMeterPerSec() const
+  {
+    return windSpeedMs;
+  }
+
+  float getGustSpeedMeterPerSec() const
+  {
+    return gustSpeedMs;
+  }
+
+  int getWindRangeFrom() const
+  {
+    return windRangeFrom;
+  }
+
+  int getWindRangeTo() const
+  {
+    return windRangeTo;
+  }
+
+  /* Direction might be average of variable wind */
+  int getPrevailingWindDir() const
+  {
+    return prevailingWindDir;
+  }
+
+  float getMinVisibilityMeter() const
+  {
+    return minVisibilityMeter;
+  }
+
+  MetarVisibility::Modifier getMinVisibilityModifier() const
+  {
+    return minVisibilityModifier;
+  }
+
+  float getMaxVisibilityMeter() const
+  {
+    return maxVisibilityMeter;
+  }
+
+  float getVertVisibilityMeter() const
+  {
+    return vertVisibilityMeter;
+  }
+
+  float getTemperatureC() const
+  {
+    return temperatureC;
+  }
+
+  float getDewpointDegC() const
+  {
+    return dewpointC;
+  }
+
+  float getPressureMbar() const
+  {
+    return pressureMbar;
+  }
+
+  int getRain() const
+  {
+    return rain;
+  }
+
+  int getHail() const
+  {
+    return hail;
+  }
+
+  int getSnow() const
+  {
+    return snow;
+  }
+
+  bool getCavok() const
+  {
+    return cavok;
+  }
+
+  int getNumClouds() const
+  {
+    return numClouds;
+  }
+
+  const Cloud& getCloud(int index) const
+  {
+    return clouds[index];
+  }
+
+  int getNumWeather() const
+  {
+    return numWeather;
+  }
+
+  const Weather& getWeather(int index) const
+  {
+    return weather[index];
+  }
+
+  /* Runway visual range and runway state groups like "R27L/1200U" */
+  int getNumRunways() const
+  {
+    return numRunways;
+  }
+
+  QByteArrayView getRunway(int index) const
+  {
+    return runways[index];
+  }
+
+  MetarParser::FlightRules getFlightRules() const
+  {
+    return flightRules;
+  }
+
+  /* Thickest cloud coverage */
+  MetarCloud::Coverage getMaxCoverage() const
+  {
+    return maxCoverage;
+  }
+
+  /* Coverage of lowest cloud layer */
+  MetarCloud::Coverage getLowestCoverage() const
+  {
+    return lowestCoverage;
+  }
+
+  /* Text after "RMK" */
+  QByteArrayView getRemark() const
+  {
+    return remark;
+  }
+
+  /* Groups which were not recognized excluding remarks. This includes trends. */
+  QByteArrayView getUnusedData() const
+  {
+    return unusedData;
+  }
+
+private:
+  /* Get next space separated group or empty if at end */
+  QByteArrayView nextGroup();
+
+  /* Return group following the current one without consuming it */
+  QByteArrayView peekGroup() const;
+
+  bool scanWind(QByteArrayView group);
+  bool scanVariability(QByteArrayView group);
+  bool scanVisibility(QByteArrayView group);
+  bool scanRunway(QByteArrayView group);
+  bool scanWeather(QByteArrayView group);
+  bool scanSkyCondition(QByteArrayView group);
+  bool scanTemperature(QByteArrayView group);
+  bool scanPressure(QByteArrayView group);
+
+  void setVisibility(float distanceMeter, MetarVisibility::Modifier modifier);
+  void postProcess();
+
+  QByteArrayView metar, ident, remark, unusedData;
+  qsizetype position = 0;
+
+  bool parsed = false, cavok = false;
+  int groupCount = 0;
+  int year = -1, month = -1, day = -1, hour = -1, minute = -1;
+  MetarParser::ReportType reportType = MetarParser::NONE;
+
+  int windDir = -1, windRangeFrom = -1, windRangeTo = -1, prevailingWindDir = -1;
+  float windSpeedMs = INVALID_METAR_VALUE, gustSpeedMs = INVALID_METAR_VALUE;
+
+  float minVisibilityMeter = INVALID_METAR_VALUE, maxVisibilityMeter = INVALID_METAR_VALUE,
+        vertVisibilityMeter = INVALID_METAR_VALUE;
+  MetarVisibility::Modifier minVisibilityModifier = MetarVisibility::EQUALS;
+
+  float temperatureC = INVALID_METAR_VALUE, dewpointC = INVALID_METAR_VALUE, pressureMbar = INVALID_METAR_VALUE;
+  int rain = 0, hail = 0, snow = 0;
+
+  Cloud clouds[MAX_CLOUDS];
+  int numClouds = 0;
+
+  Weather weather[MAX_WEATHER];
+  int numWeather = 0;
+
+  QByteArrayView runways[MAX_RUNWAYS];
+  int numRunways = 0;
+
+  MetarParser::FlightRules flightRules = MetarParser::UNKNOWN;
+  MetarCloud::Coverage maxCoverage = MetarCloud::COVERAGE_NIL, lowestCoverage = MetarCloud::COVERAGE_NIL;
+};
+
+} // namespace weather
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_METARVIEWPARSER_H
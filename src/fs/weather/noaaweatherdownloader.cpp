@@ -34,6 +34,7 @@ NoaaWeatherDownloader::NoaaWeatherDownloader(QObject *parent, bool verbose)
 {
   connect(downloader, &HttpDownloader::downloadFinished, this, &NoaaWeatherDownloader::downloadFinished);
   connect(downloader, &HttpDownloader::downloadFailed, this, &NoaaWeatherDownloader::downloadFailed);
+  connect(downloader, &HttpDownloader::downloadUnchanged, this, &NoaaWeatherDownloader::downloadUnchanged);
 
   // Use own timer for recurring updates since the one in HttpDownloader cannot be used here
   updateTimer.setSingleShot(true);
@@ -106,7 +107,18 @@ void NoaaWeatherDownloader::downloadFinished(const QByteArray& data, QString url
   // Reset error state which avoids triggering downloads
   setErrorStateTimer(false);
 
-  if(read(data, url) && downloadQueue.isEmpty())
+  if(metarIndex->isDoubleBuffered())
+    // Merge in background and notify in this thread once the new index is published
+    metarIndex->readInBackground(atools::zip::gzipDecompressIf(data, Q_FUNC_INFO), url, true /* merge */, [this](int numRead) {
+            QMetaObject::invokeMethod(this, [this, numRead]() {
+              metarIndex->adoptPublishedIndex();
+
+              if(numRead > 0 && downloadQueue.isEmpty())
+                // Notification only if no outstanding downloads
+                emit weatherUpdated();
+            }, Qt::QueuedConnection);
+          });
+  else if(read(data, url) && downloadQueue.isEmpty())
     // Notification only if no outstanding downloads
     emit weatherUpdated();
 
@@ -118,6 +130,20 @@ void NoaaWeatherDownloader::downloadFinished(const QByteArray& data, QString url
   QTimer::singleShot(0, this, &NoaaWeatherDownloader::download);
 }
 
+void NoaaWeatherDownloader::downloadUnchanged(QString url)
+{
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << "url" << url << "unchanged" << "downloadQueue" << downloadQueue;
+
+  setErrorStateTimer(false);
+
+  if(downloadQueue.isEmpty())
+    // All files downloaded - wait for next timeout which will call startDownload()
+    startTimer();
+
+  QTimer::singleShot(0, this, &NoaaWeatherDownloader::download);
+}
+
 void NoaaWeatherDownloader::downloadFailed(const QString& error, int errorCode, QString url)
 {
   if(verbose)
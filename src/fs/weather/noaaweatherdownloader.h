@@ -60,6 +60,9 @@ private:
   void downloadFinished(const QByteArray& data, QString url);
   void downloadFailed(const QString& error, int errorCode, QString url);
 
+  /* File content is the same as last time - skip merging and continue with the next file */
+  void downloadUnchanged(QString url);
+
   /* Read downloaded METAR file contents */
   bool read(const QByteArray& data, const QString& url);
 
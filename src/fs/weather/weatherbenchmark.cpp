@@ -0,0 +1,313 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "fs/weather/weatherbenchmark.h"
+
+#include "atools.h"
+#include "exception.h"
+#include "fs/weather/metar.h"
+#include "fs/weather/metarindex.h"
+#include "fs/weather/metarparser.h"
+#include "geo/linestring.h"
+#include "grib/gribreader.h"
+#include "grib/windquery.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QScopedPointer>
+#include <QStringBuilder>
+#include <QTextStream>
+
+#include <random>
+
+namespace atools {
+namespace fs {
+namespace weather {
+
+namespace weatherbench {
+
+/* Increment if the result format changes to avoid comparing different runs */
+static const int BENCHMARK_VERSION = 1;
+
+/* Fixed seed to get the same positions in all runs */
+static const quint32 SEED_POSITIONS = 0x3B4C5D6E;
+
+/* Number of routes and points per route for wind queries */
+static const int NUM_ROUTES = 1000, NUM_ROUTE_POINTS = 20;
+
+static QString formatName(MetarFormat format)
+{
+  switch(format)
+  {
+    case NOAA:
+      return QStringLiteral("NOAA");
+
+    case XPLANE:
+      return QStringLiteral("XPLANE");
+
+    case FLAT:
+      return QStringLiteral("FLAT");
+
+    case JSON:
+      return QStringLiteral("JSON");
+
+    case UNKNOWN:
+      break;
+  }
+  return QStringLiteral("UNKNOWN");
+}
+
+/* Random positions between 60 S and 75 N with altitude in ft */
+static void randomPositions(QList<atools::geo::Pos>& positions, int number, float altitudeFt)
+{
+  // Use only generator output and no distributions since these differ between standard libraries
+  std::mt19937 generator(SEED_POSITIONS);
+  positions.clear();
+  positions.reserve(number);
+  for(int i = 0; i < number; i++)
+  {
+    float lonX = static_cast<float>(generator() % 360000) / 1000.f - 180.f;
+    float latY = static_cast<float>(generator() % 135000) / 1000.f - 60.f;
+    positions.append(atools::geo::Pos(lonX, latY, altitudeFt));
+  }
+}
+
+/* Read file into text */
+static QByteArray readFile(const QString& filename)
+{
+  QFile file(filename);
+  if(!file.open(QIODevice::ReadOnly))
+    throw atools::Exception(QStringLiteral("Cannot open \"%1\": %2").arg(filename).arg(file.errorString()));
+  return file.readAll();
+}
+
+} // namespace weatherbench
+
+WeatherBenchmark::WeatherBenchmark()
+{
+}
+
+WeatherBenchmark::~WeatherBenchmark()
+{
+}
+
+void WeatherBenchmark::addCase(const QString& name, qint64 items, QList<qint64> timesNs)
+{
+  std::sort(timesNs.begin(), timesNs.end());
+  qint64 medianNs = timesNs.at(timesNs.size() / 2);
+
+  QJsonObject obj;
+  obj.insert("name", name);
+  obj.insert("items", items);
+  obj.insert("repetitions", static_cast<int>(timesNs.size()));
+  obj.insert("median_ms", static_cast<double>(medianNs) / 1.E6);
+  obj.insert("min_ms", static_cast<double>(timesNs.constFirst()) / 1.E6);
+  obj.insert("items_per_second", medianNs > 0 ? static_cast<double>(items) * 1.E9 / static_cast<double>(medianNs) : 0.);
+  cases.append(obj);
+
+  qInfo().nospace().noquote() << name << ": " << QString::number(static_cast<double>(medianNs) / 1.E6, 'f', 2)
+                              << " ms, " << items << " items";
+}
+
+void WeatherBenchmark::run()
+{
+  cases = QJsonArray();
+
+  runMetarCases();
+  runGribCases();
+
+  result = QJsonObject();
+  result.insert("version", weatherbench::BENCHMARK_VERSION);
+  result.insert("num_queries", numQueries);
+  result.insert("cases", cases);
+}
+
+void WeatherBenchmark::runMetarCases()
+{
+  // Lines starting with an ident in NOAA, X-Plane and flat files are METARs
+  static const QRegularExpression METAR_LINE("^[A-Z0-9]{3,4} \\S");
+
+  QList<atools::geo::Pos> positions;
+  weatherbench::randomPositions(positions, numQueries, 0.f);
+
+  QScopedPointer<MetarIndex> lastIndex;
+  for(const std::pair<QString, MetarFormat>& metarFile : std::as_const(metarFiles))
+  {
+    const QByteArray text = weatherbench::readFile(metarFile.first);
+    QString suffix = weatherbench::formatName(metarFile.second) % '/' % QFileInfo(metarFile.first).fileName();
+
+    // Read into index ======================================================
+    QList<qint64> timesNs;
+    int numRead = 0;
+    for(int i = 0; i < repetitions; i++)
+    {
+      lastIndex.reset(new MetarIndex(metarFile.second));
+      lastIndex->setFetchAirportCoords(airportCoordFunction, airportCoordObject);
+
+      QTextStream stream(text);
+      QElapsedTimer timer;
+      timer.start();
+      numRead = lastIndex->read(stream, metarFile.first, false /* merge */);
+      timesNs.append(timer.nsecsElapsed());
+    }
+    addCase("MetarIndex::read/" % suffix, numRead, timesNs);
+
+    // Parse all METAR lines ======================================================
+    if(metarFile.second != JSON)
+    {
+      QStringList metars;
+      for(const QString& line : QString::fromUtf8(text).split('\n'))
+      {
+        QString metar = line.trimmed();
+        if(METAR_LINE.match(metar).hasMatch())
+          metars.append(metar);
+      }
+
+      timesNs.clear();
+      for(int i = 0; i < repetitions; i++)
+      {
+        int numParsed = 0;
+        QElapsedTimer timer;
+        timer.start();
+        for(const QString& metar : std::as_const(metars))
+        {
+          MetarParser parser(metar);
+          parser.parse();
+          numParsed += parser.isParsed();
+        }
+        timesNs.append(timer.nsecsElapsed());
+
+        if(i == 0)
+          qInfo() << Q_FUNC_INFO << "Parsed" << numParsed << "of" << metars.size();
+      }
+      addCase("MetarParser::parse/" % suffix, metars.size(), timesNs);
+    }
+  }
+
+  if(lastIndex.isNull())
+    return;
+
+  if(airportCoordFunction == nullptr)
+  {
+    qWarning() << Q_FUNC_INFO << "No airport coordinate function. Skipping METAR queries.";
+    return;
+  }
+
+  // Query interpolated METARs ======================================================
+  QList<qint64> timesNs;
+  for(int i = 0; i < repetitions; i++)
+  {
+    lastIndex->clearCache();
+    QElapsedTimer timer;
+    timer.start();
+    for(const atools::geo::Pos& pos : std::as_const(positions))
+      lastIndex->getMetar(QString(), pos);
+    timesNs.append(timer.nsecsElapsed());
+  }
+  addCase("MetarIndex::getMetar/interpolated", positions.size(), timesNs);
+
+  timesNs.clear();
+  for(int i = 0; i < repetitions; i++)
+  {
+    QList<Metar> metars;
+    QElapsedTimer timer;
+    timer.start();
+    lastIndex->getMetarsInterpolated(metars, positions);
+    timesNs.append(timer.nsecsElapsed());
+  }
+  addCase("MetarIndex::getMetarsInterpolated", positions.size(), timesNs);
+}
+
+void WeatherBenchmark::runGribCases()
+{
+  // Routes at cruise altitude from random positions
+  QList<atools::geo::Pos> positions;
+  weatherbench::randomPositions(positions, weatherbench::NUM_ROUTES * 2, 35000.f);
+
+  QList<atools::geo::LineString> routes;
+  for(int i = 0; i < weatherbench::NUM_ROUTES; i++)
+  {
+    const atools::geo::Pos& from = positions.at(i * 2), & to = positions.at(i * 2 + 1);
+    atools::geo::LineString route;
+    from.interpolatePoints(to, from.distanceMeterTo(to), weatherbench::NUM_ROUTE_POINTS, route);
+    for(atools::geo::Pos& pos : route)
+      pos.setAltitude(35000.f);
+    routes.append(route);
+  }
+
+  for(const QString& gribFile : std::as_const(gribFiles))
+  {
+    const QByteArray data = weatherbench::readFile(gribFile);
+    QString suffix = QFileInfo(gribFile).fileName();
+
+    // Decode ======================================================
+    QList<qint64> timesNs;
+    for(int i = 0; i < repetitions; i++)
+    {
+      atools::grib::GribReader reader;
+      QElapsedTimer timer;
+      timer.start();
+      reader.readData(data);
+      timesNs.append(timer.nsecsElapsed());
+    }
+    addCase("GribReader::readData/" % suffix, data.size(), timesNs);
+
+    // Wind along routes ======================================================
+    atools::grib::WindQuery windQuery(nullptr, false);
+    windQuery.initFromPath(gribFile, WEATHER_XP11);
+
+    timesNs.clear();
+    for(int i = 0; i < repetitions; i++)
+    {
+      double sum = 0.;
+      QElapsedTimer timer;
+      timer.start();
+      for(const atools::geo::LineString& route : std::as_const(routes))
+        sum += windQuery.getWindAverageForLineString(route).speed;
+      timesNs.append(timer.nsecsElapsed());
+
+      if(i == 0)
+        qInfo() << Q_FUNC_INFO << "Average wind speed" << sum / routes.size();
+    }
+    addCase("WindQuery::getWindAverageForLineString/" % suffix, routes.size(), timesNs);
+
+    windQuery.deinit();
+  }
+}
+
+bool WeatherBenchmark::writeResult(const QString& filename) const
+{
+  QSaveFile file(filename);
+  if(file.open(QIODevice::WriteOnly))
+  {
+    file.write(QJsonDocument(result).toJson(QJsonDocument::Indented));
+    if(file.commit())
+      return true;
+  }
+
+  qWarning() << Q_FUNC_INFO << "Cannot write" << filename << file.errorString();
+  return false;
+}
+
+} // namespace weather
+} // namespace fs
+} // namespace atools
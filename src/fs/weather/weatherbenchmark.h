@@ -0,0 +1,116 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_FS_WEATHER_WEATHERBENCHMARK_H
+#define ATOOLS_FS_WEATHER_WEATHERBENCHMARK_H
+
+#include "fs/weather/weathertypes.h"
+#include "fs/util/airportcoordtypes.h"
+
+#include <QJsonArray>
+#include <QJsonObject>
+
+#include <algorithm>
+
+namespace atools {
+namespace fs {
+namespace weather {
+
+/*
+ * Benchmarks the weather pipeline using captured weather files given by the caller.
+ *
+ * Cases are METAR reading by MetarIndex for each added file, METAR parsing throughput,
+ * interpolated METAR queries for random positions and GRIB decoding and wind averaging along routes for each
+ * added GRIB file.
+ *
+ * Each case is repeated and reports median and minimum time as well as items per second.
+ * Random positions use a fixed seed. The result is a JSON document which can be compared between releases.
+ */
+class WeatherBenchmark
+{
+public:
+  WeatherBenchmark();
+  virtual ~WeatherBenchmark();
+
+  WeatherBenchmark(const WeatherBenchmark& other) = delete;
+  WeatherBenchmark& operator=(const WeatherBenchmark& other) = delete;
+
+  /* Add a captured METAR feed. METAR position queries use the last added file. */
+  void addMetarFile(const QString& filename, atools::fs::weather::MetarFormat format)
+  {
+    metarFiles.append(std::make_pair(filename, format));
+  }
+
+  /* Add a GRIB2 wind file as downloaded from NOAA or written by X-Plane */
+  void addGribFile(const QString& filename)
+  {
+    gribFiles.append(filename);
+  }
+
+  /* Needed to get station positions for METAR queries. Same as in MetarIndex. */
+  void setFetchAirportCoords(atools::fs::util::AirportCoordFuncType function, void *object)
+  {
+    airportCoordFunction = function;
+    airportCoordObject = object;
+  }
+
+  /* Number of times each case is run. Default is 5. */
+  void setRepetitions(int value)
+  {
+    repetitions = std::max(1, value);
+  }
+
+  /* Number of random positions for queries. Default is 10000. */
+  void setNumQueries(int value)
+  {
+    numQueries = std::max(1, value);
+  }
+
+  /* Run all cases. atools::Exception is thrown if a file cannot be read. */
+  void run();
+
+  /* Results of last run() */
+  const QJsonObject& getResult() const
+  {
+    return result;
+  }
+
+  /* Write indented JSON. Returns false on error. */
+  bool writeResult(const QString& filename) const;
+
+private:
+  void runMetarCases();
+  void runGribCases();
+
+  /* Add result entry for a case from the times of all repetitions */
+  void addCase(const QString& name, qint64 items, QList<qint64> timesNs);
+
+  QList<std::pair<QString, atools::fs::weather::MetarFormat> > metarFiles;
+  QStringList gribFiles;
+  atools::fs::util::AirportCoordFuncType airportCoordFunction = nullptr;
+  void *airportCoordObject = nullptr;
+  int repetitions = 5, numQueries = 10000;
+
+  QJsonArray cases;
+  QJsonObject result;
+};
+
+} // namespace weather
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_WEATHER_WEATHERBENCHMARK_H
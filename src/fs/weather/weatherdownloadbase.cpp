@@ -33,6 +33,9 @@ WeatherDownloadBase::WeatherDownloadBase(QObject *parent, MetarFormat format, bo
   downloader = new atools::util::HttpDownloader(parent, verboseLogging);
   downloader->setAcceptEncoding("gzip");
 
+  // Skip parsing if files did not change since last download
+  downloader->setDetectUnchanged(true);
+
   connect(downloader, &atools::util::HttpDownloader::downloadSslErrors, this, &WeatherDownloadBase::weatherDownloadSslErrors);
   connect(downloader, &atools::util::HttpDownloader::downloadProgress, this, &WeatherDownloadBase::weatherDownloadProgress);
 
@@ -48,10 +51,13 @@ WeatherDownloadBase::~WeatherDownloadBase()
 
 const Metar& WeatherDownloadBase::getMetar(const QString& airportIcao, const geo::Pos& pos)
 {
+  // Take over index from background read if any
+  metarIndex->adoptPublishedIndex();
+
   // Trigger download only if the error grace period is not active and the index is empty
   if(!isErrorState() && metarIndex->isEmpty())
   {
-    if(!isDownloading())
+    if(!isDownloading() && !metarIndex->isReadingInBackground())
       startDownload();
     // else already downloading - message will be sent for update once done
   }
@@ -85,6 +91,11 @@ void WeatherDownloadBase::setFetchAirportCoords(atools::fs::util::AirportCoordFu
   metarIndex->setFetchAirportCoords(function, object);
 }
 
+void WeatherDownloadBase::setReadInBackground(bool value)
+{
+  metarIndex->setDoubleBuffered(value);
+}
+
 int WeatherDownloadBase::size() const
 {
   return metarIndex->numStationMetars();
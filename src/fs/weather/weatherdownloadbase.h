@@ -73,6 +73,10 @@ public:
   /* Set to a function that returns the coordinates for an airport ident. Needed to find the nearest. */
   virtual void setFetchAirportCoords(atools::fs::util::AirportCoordFuncType function, void *object);
 
+  /* Read downloaded METARs in a background thread and publish the new index when done.
+   * Lookups continue on the old index while reading. Airport coordinate callback has to be thread safe if enabled. */
+  void setReadInBackground(bool value);
+
   /* Number of unique METAR entries in the list */
   virtual int size() const;
 
@@ -32,6 +32,7 @@ WeatherNetDownload::WeatherNetDownload(QObject *parent, atools::fs::weather::Met
 {
   connect(downloader, &atools::util::HttpDownloader::downloadFinished, this, &WeatherNetDownload::downloadFinished);
   connect(downloader, &atools::util::HttpDownloader::downloadFailed, this, &WeatherNetDownload::downloadFailed);
+  connect(downloader, &atools::util::HttpDownloader::downloadUnchanged, this, &WeatherNetDownload::downloadUnchanged);
 }
 
 WeatherNetDownload::~WeatherNetDownload()
@@ -50,6 +51,19 @@ void WeatherNetDownload::downloadFinished(const QByteArray& data, QString url)
   // AGGH 161200Z 14002KT 9999 FEW016 25/24 Q1010
   // AYNZ 160800Z 09005G10KT 9999 SCT030 BKN ABV050 27/24 Q1007 RMK
   // AYPY 160700Z 28010KT 9999 SCT025 OVC050 28/23 Q1008 RMK/ BUILD UPS TO S/W
+  if(metarIndex->isDoubleBuffered())
+  {
+    // Decode in background and send signals in this thread once the new index is published
+    metarIndex->readInBackground(atools::zip::gzipDecompressIf(data, Q_FUNC_INFO), downloader->getUrl(), false /* merge */,
+                                 [this, url](int) {
+            QMetaObject::invokeMethod(this, [this, url]() {
+              metarIndex->adoptPublishedIndex();
+              readFinished(url);
+            }, Qt::QueuedConnection);
+          });
+    return;
+  }
+
 #ifdef DEBUG_INFORMATION
   QElapsedTimer timer;
   timer.start();
@@ -60,9 +74,13 @@ void WeatherNetDownload::downloadFinished(const QByteArray& data, QString url)
   qDebug() << Q_FUNC_INFO << "METAR decoding took" << timer.elapsed() << "ms";
 #endif
 
+  readFinished(url);
+}
+
+void WeatherNetDownload::readFinished(const QString& url)
+{
   if(verbose)
-    qDebug() << Q_FUNC_INFO << "Loaded" << data.size() << "bytes and" << metarIndex->numStationMetars()
-             << "metars from" << downloader->getUrl();
+    qDebug() << Q_FUNC_INFO << "Loaded" << metarIndex->numStationMetars() << "metars from" << url;
 
   if(metarIndex->isEmpty())
     emit weatherDownloadFailed(tr("No METARs found in download."), 0, url);
@@ -70,6 +88,18 @@ void WeatherNetDownload::downloadFinished(const QByteArray& data, QString url)
     emit weatherUpdated();
 }
 
+void WeatherNetDownload::downloadUnchanged(QString url)
+{
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << "url" << url << "unchanged";
+
+  setErrorStateTimer(false);
+
+  if(metarIndex->isEmpty())
+    // Last download did not give any results - parse again next time
+    downloader->clearContentStates();
+}
+
 void WeatherNetDownload::downloadFailed(const QString& error, int errorCode, QString url)
 {
   qWarning() << Q_FUNC_INFO << "Error downloading from" << url << ":" << error << errorCode;
@@ -46,6 +46,12 @@ private:
   void downloadFinished(const QByteArray& data, QString url);
   void downloadFailed(const QString& error, int errorCode, QString url);
 
+  /* Server content is the same as last time - keep index */
+  void downloadUnchanged(QString url);
+
+  /* Send signals after reading */
+  void readFinished(const QString& url);
+
 };
 
 } // namespace weather
@@ -28,6 +28,7 @@
 #include <QFileInfo>
 #include <QMap>
 #include <QDebug>
+#include <QTextStream>
 
 namespace atools {
 namespace fs {
@@ -35,6 +36,15 @@ namespace weather {
 
 using atools::util::FileSystemWatcher;
 
+/* Number of bytes at the start of a file compared to detect replaced files */
+static const qint64 HEAD_SIZE = 256;
+
+/* Line like "2017/10/29 11:45" which applies to all following METARs */
+static bool isDateLine(const QByteArray& line)
+{
+  return line.size() > 15 && line.at(0) == '2' && line.at(4) == '/' && line.at(7) == '/' && line.at(10) == ' ';
+}
+
 XpWeatherReader::XpWeatherReader(QObject *parent, bool verboseLogging)
   : QObject(parent), verbose(verboseLogging)
 {
@@ -64,6 +74,7 @@ void XpWeatherReader::load()
   if(fileWatcher == nullptr && !weatherPath.isEmpty())
   {
     metarIndex->clear();
+    fileStates.clear();
     currentMetarFiles = collectWeatherFiles();
 
     if(verbose)
@@ -89,6 +100,7 @@ void XpWeatherReader::clear()
   metarIndex->clear();
   weatherPath.clear();
   currentMetarFiles.clear();
+  fileStates.clear();
 }
 
 void XpWeatherReader::setFetchAirportCoords(atools::fs::util::AirportCoordFuncType function, void *object)
@@ -98,24 +110,90 @@ void XpWeatherReader::setFetchAirportCoords(atools::fs::util::AirportCoordFuncTy
 
 bool XpWeatherReader::read(const QStringList& filenames)
 {
-  // Read and merge all changed filenames into the METAR index
+  // Read and merge new records of all changed filenames into the METAR index
+  int metarsRead = 0;
   for(const QString& filename : filenames)
+    metarsRead += readFile(filename);
+  return metarsRead > 0;
+}
+
+int XpWeatherReader::readFile(const QString& filename)
+{
+  QFile file(filename);
+  if(!file.open(QIODevice::ReadOnly))
   {
-    QFile file(filename);
-    if(file.open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-      if(verbose)
-        qDebug() << Q_FUNC_INFO << filename;
-      QTextStream stream(&file);
+    qWarning() << "cannot open" << file.fileName() << "reason" << file.errorString();
+    return 0;
+  }
 
-      // Read and merge into current METAR entries
-      metarIndex->read(stream, filename, true /* merge */);
-      file.close();
+  FileState& state = fileStates[filename];
+  qint64 size = file.size();
+  bool append = false;
+
+  if(state.offset > 0 && size >= state.offset)
+  {
+    // Appended if start of file is unchanged and last read ended at a line end
+    QByteArray head = file.read(std::min(HEAD_SIZE, state.offset));
+    append = head == state.head && file.seek(state.offset - 1) && file.read(1) == "\n";
+  }
+
+  if(!append)
+  {
+    // First read, truncated or replaced - read all
+    if(verbose && state.offset > 0)
+      qDebug() << Q_FUNC_INFO << "Full reload" << filename << "size" << size << "offset" << state.offset;
+
+    state = FileState();
+    file.seek(0);
+  }
+  else if(size == state.offset)
+  {
+    if(verbose)
+      qDebug() << Q_FUNC_INFO << "Not changed" << filename;
+    return 0;
+  }
+
+  // Read only complete lines and leave a partially written line for the next update
+  QByteArray text = file.readAll();
+  qsizetype lineEnd = text.lastIndexOf('\n');
+  if(lineEnd == -1)
+  {
+    file.close();
+    return 0;
+  }
+  text.truncate(lineEnd + 1);
+  file.close();
+
+  // Head contains the first bytes up to the read offset
+  if(state.head.size() < HEAD_SIZE)
+    state.head = state.offset == 0 ? text.left(HEAD_SIZE) : (state.head + text).left(HEAD_SIZE);
+
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << filename << (append ? "append from" : "full from") << state.offset << "bytes" << text.size();
+
+  // Appended METARs refer to the last date line read before
+  QByteArray prefix = append ? state.lastDateLine + '\n' : QByteArray();
+
+  // Remember last date line for the next append
+  for(qsizetype end = text.size() - 1; end > 0; )
+  {
+    qsizetype start = text.lastIndexOf('\n', end - 1) + 1;
+    QByteArray line = text.sliced(start, end - start).trimmed();
+    if(isDateLine(line))
+    {
+      state.lastDateLine = line;
+      break;
     }
-    else
-      qWarning() << "cannot open" << file.fileName() << "reason" << file.errorString();
+    end = start - 1;
   }
-  return !metarIndex->isEmpty();
+
+  state.offset += text.size();
+
+  QByteArray input = prefix + text;
+  QTextStream stream(&input, QIODevice::ReadOnly);
+
+  // Read and merge into current METAR entries
+  return metarIndex->read(stream, filename, true /* merge */);
 }
 
 void XpWeatherReader::dirUpdated(const QString& dir)
@@ -128,6 +206,15 @@ void XpWeatherReader::dirUpdated(const QString& dir)
   if(metarFiles != currentMetarFiles)
   {
     currentMetarFiles = metarFiles;
+
+    // Forget read positions of files which are not used anymore
+    for(auto it = fileStates.begin(); it != fileStates.end();)
+    {
+      if(currentMetarFiles.contains(it.key()))
+        ++it;
+      else
+        it = fileStates.erase(it);
+    }
     createFsWatcher();
   }
 }
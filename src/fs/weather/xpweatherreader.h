@@ -21,6 +21,7 @@
 #include "fs/util/airportcoordtypes.h"
 #include "fs/weather/weathertypes.h"
 
+#include <QHash>
 #include <QObject>
 
 namespace atools {
@@ -39,6 +40,9 @@ class MetarIndex;
 
 /*
  * Reads the X-Plane 11 METAR.rwx or X-Plane 12 folder and watches the files/folder for changes.
+ *
+ * Changed files are read incrementally. Only records appended since the last read are parsed and merged
+ * into the index. A file is read completely if it was truncated or replaced.
  */
 class XpWeatherReader
   : public QObject
@@ -88,10 +92,23 @@ signals:
   void weatherUpdated();
 
 private:
+  /* Read position in a file for incremental loading */
+  struct FileState
+  {
+    qint64 offset = 0; /* End of the last complete line read */
+    QByteArray head; /* First bytes of file to detect replaced files */
+    QByteArray lastDateLine; /* Last date line read which applies to appended METARs */
+  };
+
   void deleteFsWatcher();
   void createFsWatcher();
+
+  /* Read new records of all files. Returns true if METARs were read. */
   bool read(const QStringList& filenames);
 
+  /* Read file from the last offset or completely if truncated or replaced. Returns number of METARs read. */
+  int readFile(const QString& filename);
+
   /* Called from fsWatcher */
   void filesUpdated(const QStringList& filenames);
   void dirUpdated(const QString& dir);
@@ -104,6 +121,7 @@ private:
 
   QString weatherPath; // Folder or file depending on simulator
   QStringList currentMetarFiles; // Set file or collected files from folder
+  QHash<QString, FileState> fileStates; // Incremental read state by file name
 
   bool verbose;
 
@@ -17,15 +17,15 @@
 
 #include "fs/xp/xpairwaypostprocess.h"
 
+#include "fs/db/airwayresolver.h"
 #include "sql/sqldatabase.h"
 #include "sql/sqlquery.h"
-#include "sql/sqlutil.h"
 #include "atools.h"
 
 #include <QDebug>
 
 using atools::sql::SqlQuery;
-using atools::sql::SqlUtil;
+using atools::fs::db::AirwayPointRow;
 
 namespace atools {
 namespace fs {
@@ -176,16 +176,12 @@ XpAirwayPostProcess::~XpAirwayPostProcess()
 {
 }
 
-bool XpAirwayPostProcess::postProcessEarthAirway()
+bool XpAirwayPostProcess::postProcessEarthAirway(QList<AirwayPointRow>& points)
 {
   SqlQuery airwayTempQuery("select name, type, direction, minimum_altitude, maximum_altitude, "
                            "previous_type, previous_ident, previous_region, "
                            "next_type, next_ident, next_region from tmp_airway order by name", db); // where name = 'Y655'
 
-  SqlQuery insertTmpAirwayPoint(db);
-  insertTmpAirwayPoint.prepare(SqlUtil(db).buildInsertStatement("tmp_airway_point", QStringLiteral(),
-                                                                {"airway_point_id", "next_airport_ident", "previous_airport_ident"}));
-
   QString currentAirway;
   AirwayType currentAirwayType = NONE;
   QList<AirwaySegment> segments;
@@ -207,7 +203,7 @@ bool XpAirwayPostProcess::postProcessEarthAirway()
     if(currentAirway != airway && !segments.isEmpty())
     {
       // Airway name or type has changed - order and write all its segments
-      writeSegments(segments, insertTmpAirwayPoint, currentAirway, currentAirwayType);
+      writeSegments(points, segments, currentAirway, currentAirwayType);
 
       segments.clear();
       currentAirway = airway;
@@ -231,47 +227,50 @@ bool XpAirwayPostProcess::postProcessEarthAirway()
 
   // Write the last airway
   if(!segments.isEmpty())
-    writeSegments(segments, insertTmpAirwayPoint, currentAirway, currentAirwayType);
+    writeSegments(points, segments, currentAirway, currentAirwayType);
 
   return false;
 }
 
-void XpAirwayPostProcess::writeSegments(QList<AirwaySegment>& segments, SqlQuery& insertTmpAirwayPoint, const QString& name,
+void XpAirwayPostProcess::writeSegments(QList<AirwayPointRow>& points, const QList<AirwaySegment>& segments, const QString& name,
                                         AirwayType type)
 {
   // W66: NUKTI/ZW > GOVSA/ZL > JNQ/ZL > GOBIN/ZL > ATBUG/ZL > DKO/ZB
   // if(name != "W66")
   // return;
 
-  // Create a list ordered by next waypoint id
-  QList<AirwaySegment> segsByNext(segments);
-  std::sort(segsByNext.begin(), segsByNext.end(), nextOrderFunc);
-
-  // Create a list ordered by previous waypoint id
-  QList<AirwaySegment> segsByPrev(segments);
-  std::sort(segsByPrev.begin(), segsByPrev.end(), prevOrderFunc);
+  // Map previous and next waypoint to segment index for constant time lookup
+  QMultiHash<AirwayPoint, int> segsByNext, segsByPrev;
+  segsByNext.reserve(segments.size());
+  segsByPrev.reserve(segments.size());
+  for(int i = 0; i < segments.size(); i++)
+  {
+    segsByNext.insert(segments.at(i).next, i);
+    segsByPrev.insert(segments.at(i).prev, i);
+  }
 
   // List of finished segments with original and reversed from/to
   QSet<AirwaySegment> finishedSegments;
 
 #ifdef DEBUG_INFORMATION_LOAD_XP_AIRWAYS
-  qDebug() << Q_FUNC_INFO << "BYNEXT" << segsByNext;
-  qDebug() << Q_FUNC_INFO << "BYPREV" << segsByPrev;
+  qDebug() << Q_FUNC_INFO << "SEGMENTS" << segments;
 #endif
 
-  // Iterate over all segments of this airway
-  while(!segments.isEmpty())
+  // Iterate over all segments of this airway - each unfinished one starts a new fragment
+  for(const AirwaySegment& start : segments)
   {
+    if(finishedSegments.contains(start))
+      continue;
+
     // Create an airway fragment
     QList<AirwaySegment> sortedSegments;
 
     // Insert start segment
-    sortedSegments.append(segments.constFirst());
+    sortedSegments.append(start);
 
     // Start segment is finished here - add from/to and to/from to simplify search
-    finishedSegments.insert(segments.constFirst());
-    finishedSegments.insert(segments.constFirst().reversed());
-    segments.removeFirst();
+    finishedSegments.insert(start);
+    finishedSegments.insert(start.reversed());
 
     bool foundPrev = true, foundNext = true;
     while(foundNext || foundPrev)
@@ -279,17 +278,15 @@ void XpAirwayPostProcess::writeSegments(QList<AirwaySegment>& segments, SqlQuery
       // Find next for last segment
       QList<AirwaySegment> foundSegments;
       const AirwaySegment& last = sortedSegments.constLast();
-      if(findSegment(foundSegments, finishedSegments, segsByPrev, last.next, last.prev, true))
+      if(findSegment(foundSegments, finishedSegments, segments, segsByPrev, last.next, last.prev, true))
       {
         // Found segment is in correct order
-        segments.removeOne(foundSegments.constFirst());
         sortedSegments.append(foundSegments.constFirst());
         foundNext = true;
       }
-      else if(findSegment(foundSegments, finishedSegments, segsByNext, last.next, last.prev, false))
+      else if(findSegment(foundSegments, finishedSegments, segments, segsByNext, last.next, last.prev, false))
       {
         // Found segment is in reversed order
-        segments.removeOne(foundSegments.constFirst());
         sortedSegments.append(foundSegments.constFirst().reversed());
         foundNext = true;
       }
@@ -298,17 +295,15 @@ void XpAirwayPostProcess::writeSegments(QList<AirwaySegment>& segments, SqlQuery
 
       // Find previous for first segment
       const AirwaySegment& first = sortedSegments.constFirst();
-      if(findSegment(foundSegments, finishedSegments, segsByNext, first.prev, first.next, false))
+      if(findSegment(foundSegments, finishedSegments, segments, segsByNext, first.prev, first.next, false))
       {
         // Found segment is in correct order
-        segments.removeOne(foundSegments.constFirst());
         sortedSegments.prepend(foundSegments.constFirst());
         foundPrev = true;
       }
-      else if(findSegment(foundSegments, finishedSegments, segsByPrev, first.prev, first.next, true))
+      else if(findSegment(foundSegments, finishedSegments, segments, segsByPrev, first.prev, first.next, true))
       {
         // Found segment is in reversed order
-        segments.removeOne(foundSegments.constFirst());
         sortedSegments.prepend(foundSegments.constFirst().reversed());
         foundPrev = true;
       }
@@ -342,111 +337,64 @@ void XpAirwayPostProcess::writeSegments(QList<AirwaySegment>& segments, SqlQuery
       qDebug() << Q_FUNC_INFO << name << mid23 << next34;
 #endif
 
-      writeSegment(insertTmpAirwayPoint, name, type, mid23, next34);
+      writeSegment(points, name, type, mid23, next34);
     }
   }
 }
 
-void XpAirwayPostProcess::writeSegment(SqlQuery& insertTmpAirwayPoint, const QString& name, AirwayType type,
+void XpAirwayPostProcess::writeSegment(QList<AirwayPointRow>& points, const QString& name, AirwayType type,
                                        const AirwaySegment& prevSeg, const AirwaySegment& nextSeg)
 {
-  insertTmpAirwayPoint.clearBoundValues();
-
   if(prevSeg.next.ident.isEmpty())
     qWarning() << Q_FUNC_INFO << "Airway" << name << "Empty mid ident";
 
   if(nextSeg.next.ident.isEmpty() && prevSeg.prev.ident.isEmpty())
     qWarning() << Q_FUNC_INFO << "Airway" << name << "Empty prev and next ident";
 
-  insertTmpAirwayPoint.bindValue(QStringLiteral(":name"), name);
-  insertTmpAirwayPoint.bindValue(QStringLiteral(":type"), convertAirwayType(type));
-  insertTmpAirwayPoint.bindValue(QStringLiteral(":mid_type"), convertType(prevSeg.next.type));
-  insertTmpAirwayPoint.bindValue(QStringLiteral(":mid_ident"), prevSeg.next.ident);
-  insertTmpAirwayPoint.bindValue(QStringLiteral(":mid_region"), prevSeg.next.region);
+  AirwayPointRow point;
+  point.name = name;
+  point.type = convertAirwayType(type);
+  point.midType = convertType(prevSeg.next.type);
+  point.midIdent = prevSeg.next.ident;
+  point.midRegion = prevSeg.next.region;
 
   if(!prevSeg.prev.ident.isEmpty())
   {
-    insertTmpAirwayPoint.bindValue(QStringLiteral(":previous_type"), convertType(prevSeg.prev.type));
-    insertTmpAirwayPoint.bindValue(QStringLiteral(":previous_ident"), prevSeg.prev.ident);
-    insertTmpAirwayPoint.bindValue(QStringLiteral(":previous_region"), prevSeg.prev.region);
-    insertTmpAirwayPoint.bindValue(QStringLiteral(":previous_minimum_altitude"), prevSeg.minAlt * 100);
-    insertTmpAirwayPoint.bindValue(QStringLiteral(":previous_maximum_altitude"), prevSeg.maxAlt * 100);
-    insertTmpAirwayPoint.bindValue(QStringLiteral(":previous_direction"), atools::charToStr(prevSeg.dir));
+    point.previousType = convertType(prevSeg.prev.type);
+    point.previousIdent = prevSeg.prev.ident;
+    point.previousRegion = prevSeg.prev.region;
+    point.previousMinAlt = prevSeg.minAlt * 100;
+    point.previousMaxAlt = prevSeg.maxAlt * 100;
+    point.previousDir = prevSeg.dir;
   }
 
   if(!nextSeg.next.ident.isEmpty())
   {
-    insertTmpAirwayPoint.bindValue(QStringLiteral(":next_type"), convertType(nextSeg.next.type));
-    insertTmpAirwayPoint.bindValue(QStringLiteral(":next_ident"), nextSeg.next.ident);
-    insertTmpAirwayPoint.bindValue(QStringLiteral(":next_region"), nextSeg.next.region);
-    insertTmpAirwayPoint.bindValue(QStringLiteral(":next_minimum_altitude"), nextSeg.minAlt * 100);
-    insertTmpAirwayPoint.bindValue(QStringLiteral(":next_maximum_altitude"), nextSeg.maxAlt * 100);
-    insertTmpAirwayPoint.bindValue(QStringLiteral(":next_direction"), atools::charToStr(nextSeg.dir));
-  }
-
-  insertTmpAirwayPoint.exec();
-}
-
-bool XpAirwayPostProcess::nextOrderFunc(const AirwaySegment& s1, const AirwaySegment& s2)
-{
-  if(s1.next.ident == s2.next.ident)
-  {
-    if(s1.next.region == s2.next.region)
-      return s1.next.type < s2.next.type;
-    else
-      return s1.next.region < s2.next.region;
+    point.nextType = convertType(nextSeg.next.type);
+    point.nextIdent = nextSeg.next.ident;
+    point.nextRegion = nextSeg.next.region;
+    point.nextMinAlt = nextSeg.minAlt * 100;
+    point.nextMaxAlt = nextSeg.maxAlt * 100;
+    point.nextDir = nextSeg.dir;
   }
-  else
-    return s1.next.ident < s2.next.ident;
-}
 
-bool XpAirwayPostProcess::prevOrderFunc(const AirwaySegment& s1, const AirwaySegment& s2)
-{
-  if(s1.prev.ident == s2.prev.ident)
-  {
-    if(s1.prev.region == s2.prev.region)
-      return s1.prev.type < s2.prev.type;
-    else
-      return s1.prev.region < s2.prev.region;
-  }
-  else
-    return s1.prev.ident < s2.prev.ident;
+  points.append(point);
 }
 
 bool XpAirwayPostProcess::findSegment(QList<AirwaySegment>& foundSegments, QSet<AirwaySegment>& finshedSegments,
-                                      const QList<AirwaySegment>& segments, AirwayPoint airwayPoint, AirwayPoint excludePoint,
-                                      bool searchPrevious)
+                                      const QList<AirwaySegment>& segments, const QMultiHash<AirwayPoint, int>& index,
+                                      const AirwayPoint& airwayPoint, const AirwayPoint& excludePoint, bool searchPrevious)
 {
   foundSegments.clear();
 
-  AirwaySegment segment;
-  if(searchPrevious)
-    segment.prev = airwayPoint;
-  else
-    segment.next = airwayPoint;
-
-  auto lower = std::lower_bound(segments.constBegin(), segments.constEnd(), segment, searchPrevious ? prevOrderFunc : nextOrderFunc);
-  auto upper = std::upper_bound(segments.constBegin(), segments.constEnd(), segment, searchPrevious ? prevOrderFunc : nextOrderFunc);
-
-  for(auto it = lower; it < upper; ++it)
+  for(auto it = index.constFind(airwayPoint); it != index.constEnd() && it.key() == airwayPoint; ++it)
   {
-    if(searchPrevious)
+    const AirwaySegment& segment = segments.at(it.value());
+    if((searchPrevious ? segment.next : segment.prev) != excludePoint && !finshedSegments.contains(segment))
     {
-      if(it->next != excludePoint && !finshedSegments.contains(*it))
-      {
-        foundSegments.append(*it);
-        finshedSegments.insert(*it);
-        finshedSegments.insert((*it).reversed());
-      }
-    }
-    else
-    {
-      if(it->prev != excludePoint && !finshedSegments.contains(*it))
-      {
-        foundSegments.append(*it);
-        finshedSegments.insert(*it);
-        finshedSegments.insert((*it).reversed());
-      }
+      foundSegments.append(segment);
+      finshedSegments.insert(segment);
+      finshedSegments.insert(segment.reversed());
     }
   }
 
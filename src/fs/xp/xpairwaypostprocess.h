@@ -19,6 +19,7 @@
 #define ATOOLS_XP_POSTPROCESS_H
 
 #include <QString>
+#include <QMultiHash>
 
 namespace atools {
 
@@ -32,6 +33,10 @@ namespace fs {
 class NavDatabaseOptions;
 class ProgressHandler;
 
+namespace db {
+struct AirwayPointRow;
+}
+
 namespace xp {
 
 struct AirwaySegment;
@@ -48,7 +53,8 @@ enum AirwayType
 
 /*
  * Takes the unordered from/to and to/from lists from X-Plane and converts them into an ordered list with from/via/to rows.
- * Reads from table tmp_airway and inserts into tmp_airway_point
+ * Reads from table tmp_airway and returns rows as they would be stored in table tmp_airway_point.
+ * The rows can be passed to AirwayResolver directly without using the database.
  */
 class XpAirwayPostProcess
 {
@@ -56,28 +62,24 @@ public:
   XpAirwayPostProcess(atools::sql::SqlDatabase& sqlDb);
   virtual ~XpAirwayPostProcess();
 
-  /* Reads all from/to and to/from segments of all airways and creates from/via/to segments. */
-  bool postProcessEarthAirway();
+  /* Reads all from/to and to/from segments of all airways and creates from/via/to segments which are appended to points.
+   * Points are grouped by airway name. */
+  bool postProcessEarthAirway(QList<atools::fs::db::AirwayPointRow>& points);
 
 private:
-  /* Sort and write out all segments of an airway. This also includes multiple fragments of the same airway name.
-   * The list segments is emptied during this process. */
-  void writeSegments(QList<AirwaySegment>& segments, sql::SqlQuery& insertTmpAirwayPoint, const QString& name, AirwayType type);
+  /* Sort and write out all segments of an airway. This also includes multiple fragments of the same airway name. */
+  void writeSegments(QList<atools::fs::db::AirwayPointRow>& points, const QList<AirwaySegment>& segments, const QString& name,
+                     AirwayType type);
 
-  /* Finds an airway segment starting or ending with airwayPoint in the list segments which can sorted by next or prev ids.*/
+  /* Finds an airway segment starting or ending with airwayPoint. index maps the previous or next point to indexes in segments. */
   bool findSegment(QList<AirwaySegment>& foundSegments, QSet<AirwaySegment>& finshedSegments, const QList<AirwaySegment>& segments,
-                   AirwayPoint airwayPoint, AirwayPoint excludePoint, bool searchPrevious);
+                   const QMultiHash<AirwayPoint, int>& index, const AirwayPoint& airwayPoint, const AirwayPoint& excludePoint,
+                   bool searchPrevious);
 
-  /* Write a from/via/to (prev/mid/next) triplet into the database */
-  void writeSegment(atools::sql::SqlQuery& insertTmpAirwayPoint, const QString& name, AirwayType type,
+  /* Add a from/via/to (prev/mid/next) triplet to points */
+  void writeSegment(QList<atools::fs::db::AirwayPointRow>& points, const QString& name, AirwayType type,
                     const AirwaySegment& prevSeg, const AirwaySegment& nextSeg);
 
-  /* Used for sorting and binary search in the ordered segment lists. Sorts by next/to */
-  static bool nextOrderFunc(const AirwaySegment& s1, const AirwaySegment& s2);
-
-  /* Used for sorting and binary search in the ordered segment lists. Sorts by previous/from */
-  static bool prevOrderFunc(const AirwaySegment& s1, const AirwaySegment& s2);
-
   atools::sql::SqlDatabase& db;
 };
 
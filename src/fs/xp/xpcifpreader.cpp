@@ -83,46 +83,71 @@ XpCifpReader::~XpCifpReader()
   delete procWriter;
 }
 
+/* Throws exception if index is out of bounds like XpReader::at() */
+static const QString& fieldAt(const QStringList& line, int index, const XpReaderContext& context)
+{
+  if(index < line.size())
+    return line.at(index);
+  else
+    // Have to stop reading the file since the rest can be corrupted
+    throw atools::Exception(context.messagePrefix() +
+                            QStringLiteral(": Index out of bounds: Index: %1, size: %2").arg(index).arg(line.size()));
+}
+
 void XpCifpReader::read(const QStringList& line, const XpReaderContext& context)
 {
   ctx = &context;
+
+  atools::fs::common::ProcedureInput procInput;
+  if(readProcedureInput(procInput, line, context))
+    procWriter->write(procInput);
+}
+
+void XpCifpReader::write(const atools::fs::common::ProcedureInput& procInput)
+{
+  procWriter->write(procInput);
+}
+
+bool XpCifpReader::readProcedureInput(atools::fs::common::ProcedureInput& procInput, const QStringList& line,
+                                      const XpReaderContext& context)
+{
   if(line.isEmpty())
-    return;
+    return false;
 
   QString rowCode = line.at(PROC_ROW_CODE);
   if(!(rowCode == QStringLiteral("SID") || rowCode == QStringLiteral("STAR") || rowCode == QStringLiteral("APPCH")))
     // Skip all unknown row codes
-    return;
-
-  atools::fs::common::ProcedureInput procInput;
+    return false;
 
   procInput.context = context.messagePrefix();
   procInput.airportIdent = context.cifpAirportIdent;
   procInput.airportId = context.cifpAirportId;
 
-  procInput.rowCode = at(line, PROC_ROW_CODE).trimmed();
-  procInput.seqNr = at(line, SEQ_NR).toInt();
-  procInput.routeType = atools::strToChar(at(line, RT_TYPE));
-  procInput.sidStarAppIdent = at(line, SID_STAR_APP_IDENT).trimmed();
-  procInput.transIdent = at(line, TRANS_IDENT).trimmed();
-  procInput.fixIdent = at(line, FIX_IDENT).trimmed();
-  procInput.region = at(line, ICAO_CODE).trimmed();
-  procInput.secCode = at(line, SEC_CODE);
-  procInput.subCode = at(line, SUB_CODE);
-  procInput.descCode = at(line, DESC_CODE);
+  procInput.rowCode = fieldAt(line, PROC_ROW_CODE, context).trimmed();
+  procInput.seqNr = fieldAt(line, SEQ_NR, context).toInt();
+  procInput.routeType = atools::strToChar(fieldAt(line, RT_TYPE, context));
+  procInput.sidStarAppIdent = fieldAt(line, SID_STAR_APP_IDENT, context).trimmed();
+  procInput.transIdent = fieldAt(line, TRANS_IDENT, context).trimmed();
+  procInput.fixIdent = fieldAt(line, FIX_IDENT, context).trimmed();
+  procInput.region = fieldAt(line, ICAO_CODE, context).trimmed();
+  procInput.secCode = fieldAt(line, SEC_CODE, context);
+  procInput.subCode = fieldAt(line, SUB_CODE, context);
+  procInput.descCode = fieldAt(line, DESC_CODE, context);
   // procInput.aircraftCategory
-  procInput.turnDir = at(line, TURN_DIR).trimmed();
-  procInput.pathTerm = at(line, PATH_TERM).trimmed();
-  procInput.recdNavaid = at(line, RECD_NAVAID).trimmed();
-  procInput.recdRegion = at(line, RECD_ICAO_CODE).trimmed();
-  procInput.recdSecCode = at(line, RECD_SEC_CODE);
-  procInput.recdSubCode = at(line, RECD_SUB_CODE);
-
-  procInput.theta = at(line, THETA).simplified().isEmpty() ? atools::fs::common::INVALID_FLOAT : at(line, THETA).toFloat() / 10.f;
-  procInput.rho = at(line, RHO).simplified().isEmpty() ? atools::fs::common::INVALID_FLOAT : at(line, RHO).toFloat() / 10.f;
-  procInput.magCourse = at(line, MAG_CRS).toFloat() / 10.f;
-
-  QString rnpStr = at(line, RNP).simplified();
+  procInput.turnDir = fieldAt(line, TURN_DIR, context).trimmed();
+  procInput.pathTerm = fieldAt(line, PATH_TERM, context).trimmed();
+  procInput.recdNavaid = fieldAt(line, RECD_NAVAID, context).trimmed();
+  procInput.recdRegion = fieldAt(line, RECD_ICAO_CODE, context).trimmed();
+  procInput.recdSecCode = fieldAt(line, RECD_SEC_CODE, context);
+  procInput.recdSubCode = fieldAt(line, RECD_SUB_CODE, context);
+
+  procInput.theta = fieldAt(line, THETA, context).simplified().isEmpty() ?
+                    atools::fs::common::INVALID_FLOAT : fieldAt(line, THETA, context).toFloat() / 10.f;
+  procInput.rho = fieldAt(line, RHO, context).simplified().isEmpty() ?
+                  atools::fs::common::INVALID_FLOAT : fieldAt(line, RHO, context).toFloat() / 10.f;
+  procInput.magCourse = fieldAt(line, MAG_CRS, context).toFloat() / 10.f;
+
+  QString rnpStr = fieldAt(line, RNP, context).simplified();
   if(rnpStr.isEmpty())
     procInput.rnp = atools::fs::common::INVALID_FLOAT;
   else
@@ -139,7 +164,7 @@ void XpCifpReader::read(const QStringList& line, const XpReaderContext& context)
   }
 
   procInput.rteHoldTime = procInput.rteHoldDist = 0.f;
-  QString distTime = at(line, RTE_DIST_HOLD_DIST_TIME).trimmed();
+  QString distTime = fieldAt(line, RTE_DIST_HOLD_DIST_TIME, context).trimmed();
   if(distTime.startsWith(QStringLiteral("T")))
     // time minutes/10
     procInput.rteHoldTime = distTime.mid(1).toFloat() / 10.f;
@@ -147,21 +172,22 @@ void XpCifpReader::read(const QStringList& line, const XpReaderContext& context)
     // distance nm/10
     procInput.rteHoldDist = distTime.toFloat() / 10.f;
 
-  procInput.altDescr = at(line, ALT_DESCR).trimmed();
-  procInput.altitude = at(line, ALTITUDE).trimmed();
-  procInput.altitude2 = at(line, ALTITUDE2).trimmed();
-  procInput.transAlt = at(line, TRANS_ALT).trimmed();
-  procInput.speedLimitDescr = at(line, SPD_LIMIT_DESCR).trimmed();
-  procInput.speedLimit = at(line, SPEED_LIMIT).toInt();
+  procInput.altDescr = fieldAt(line, ALT_DESCR, context).trimmed();
+  procInput.altitude = fieldAt(line, ALTITUDE, context).trimmed();
+  procInput.altitude2 = fieldAt(line, ALTITUDE2, context).trimmed();
+  procInput.transAlt = fieldAt(line, TRANS_ALT, context).trimmed();
+  procInput.speedLimitDescr = fieldAt(line, SPD_LIMIT_DESCR, context).trimmed();
+  procInput.speedLimit = fieldAt(line, SPEED_LIMIT, context).toInt();
   procInput.verticalAngle =
-    at(line, VERT_ANGLE).simplified().isEmpty() ? QVariant(QMetaType::fromType<double>()) : at(line, VERT_ANGLE).toDouble() / 100.;
-  procInput.centerFixOrTaaPt = at(line, CENTER_FIX_OR_TAA_PT).trimmed();
-  procInput.centerIcaoCode = at(line, CENTER_ICAO_CODE).trimmed();
-  procInput.centerSecCode = at(line, CENTER_SEC_CODE);
-  procInput.centerSubCode = at(line, CENTER_SUB_CODE);
-  procInput.gnssFmsIndicator = at(line, GNSS_FMS_IND);
-
-  procWriter->write(procInput);
+    fieldAt(line, VERT_ANGLE, context).simplified().isEmpty() ?
+    QVariant(QMetaType::fromType<double>()) : fieldAt(line, VERT_ANGLE, context).toDouble() / 100.;
+  procInput.centerFixOrTaaPt = fieldAt(line, CENTER_FIX_OR_TAA_PT, context).trimmed();
+  procInput.centerIcaoCode = fieldAt(line, CENTER_ICAO_CODE, context).trimmed();
+  procInput.centerSecCode = fieldAt(line, CENTER_SEC_CODE, context);
+  procInput.centerSubCode = fieldAt(line, CENTER_SUB_CODE, context);
+  procInput.gnssFmsIndicator = fieldAt(line, GNSS_FMS_IND, context);
+
+  return true;
 }
 
 void XpCifpReader::finish(const XpReaderContext& context)
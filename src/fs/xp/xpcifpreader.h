@@ -37,6 +37,7 @@ class ProgressHandler;
 namespace common {
 class AirportIndex;
 class ProcedureWriter;
+struct ProcedureInput;
 }
 
 namespace xp {
@@ -60,6 +61,14 @@ public:
   virtual void finish(const XpReaderContext& context) override;
   virtual void reset() override;
 
+  /* Fill procedure input from a CIFP line and return false for rows which are not SID, STAR or APPCH.
+   * Does not access the database and can be called from worker threads. Throws an exception on error. */
+  static bool readProcedureInput(atools::fs::common::ProcedureInput& procInput, const QStringList& line,
+                                 const atools::fs::xp::XpReaderContext& context);
+
+  /* Write procedure input read before by readProcedureInput(). Airport id has to be set. */
+  void write(const atools::fs::common::ProcedureInput& procInput);
+
 private:
   atools::fs::common::ProcedureWriter *procWriter = nullptr;
 };
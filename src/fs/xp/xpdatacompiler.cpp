@@ -27,6 +27,7 @@
 #include "fs/xp/xpairwayreader.h"
 #include "fs/xp/xpairportreader.h"
 #include "fs/xp/xpcifpreader.h"
+#include "fs/xp/xpdattokenizer.h"
 #include "fs/xp/xpairspacereader.h"
 #include "fs/xp/scenerypacks.h"
 #include "fs/common/magdecreader.h"
@@ -40,7 +41,9 @@
 #include "atools.h"
 #include "fs/common/airportindex.h"
 #include "fs/common/metadatawriter.h"
+#include "fs/common/procedurewriter.h"
 #include "fs/navdatabaseerrors.h"
+#include "util/tracer.h"
 
 #include <QFileInfo>
 #include <QDir>
@@ -50,6 +53,11 @@
 #include <QRegularExpression>
 #include <QStandardPaths>
 #include <QQueue>
+#include <QFile>
+#include <QMutex>
+#include <QThread>
+#include <QThreadPool>
+#include <QWaitCondition>
 
 using atools::sql::SqlQuery;
 using atools::sql::SqlUtil;
@@ -208,7 +216,8 @@ bool XpDataCompiler::postProcessEarthAirway()
   if(progress->reportOther(tr("Post processing Airways")))
     return true;
 
-  if(airwayPostProcess->postProcessEarthAirway())
+  airwayPoints.clear();
+  if(airwayPostProcess->postProcessEarthAirway(airwayPoints))
     return true;
 
   db.commit();
@@ -236,12 +245,9 @@ bool XpDataCompiler::compileCustomApt()
   // X-Plane 11/Custom Scenery/LFPG Paris - Charles de Gaulle/Earth Nav data/apt.dat
   const QStringList aptDatFiles = findCustomAptDatFiles(buildPathNoCase({options.getBasepath(), "Custom Scenery"}),
                                                         options, errors, progress, true /* verbose */, false /* userInclude */);
-  for(const QString& aptdat : aptDatFiles)
-  {
-    // Only one progress report per file
-    if(readDataFile(aptdat, 1, airportReader, IS_ADDON | READ_SHORT_REPORT, 1))
-      return true;
-  }
+  if(readCustomAptDatFiles(aptDatFiles))
+    return true;
+
   db.commit();
   return false;
 }
@@ -252,12 +258,8 @@ bool XpDataCompiler::compileUserIncludeApt()
   {
     // Find all apt.dat in the included folder
     const QStringList aptDatFiles = findCustomAptDatFiles(path, options, errors, progress, true /* verbose */, true /* userInclude */);
-    for(const QString& aptdat : aptDatFiles)
-    {
-      // Only one progress report per file
-      if(readDataFile(aptdat, 1, airportReader, IS_ADDON | READ_SHORT_REPORT, 1))
-        return true;
-    }
+    if(readCustomAptDatFiles(aptDatFiles))
+      return true;
   }
   db.commit();
   return false;
@@ -313,27 +315,57 @@ bool XpDataCompiler::compileDefaultApt()
 
 bool XpDataCompiler::compileCifp()
 {
+  // All airports, runway ends and ILS are loaded - speed up lookups for procedure legs
+  airportIndex->freeze();
+
   QStringList cifpFiles = findCifpFiles(options);
   cifpFiles.sort();
 
   int rowsPerStep = static_cast<int>(std::ceil(static_cast<float>(cifpFiles.size()) / static_cast<float>(NUM_REPORT_STEPS_CIFP)));
   int row = 0, steps = 0;
 
+  QStringList files;
   for(const QString& file : std::as_const(cifpFiles))
   {
     if(options.isIncludedFilename(file))
+      files.append(file);
+  }
+
+  auto reportProgress = [this, rowsPerStep, &row, &steps](const QString& file) -> bool {
+    if((row++ % rowsPerStep) == 0)
     {
-      if(readDataFile(file, 1, cifpReader, READ_CIFP | READ_SHORT_REPORT, 0))
+      if(progress->reportOther(tr("Reading: %1").arg(atools::nativeCleanPath(file))))
         return true;
 
-      if((row % rowsPerStep) == 0)
-      {
-        if(progress->reportOther(tr("Reading: %1").arg(atools::nativeCleanPath(file))))
-          return true;
+      steps++;
+    }
+    return false;
+  };
 
-        steps++;
-      }
-      row++;
+  int numFiles = static_cast<int>(files.size());
+  int numThreads = numParserThreads(numFiles);
+  if(numThreads > 1)
+  {
+    // Parse files on worker threads and write procedures in file order on this thread
+    bool aborted = runOrdered<XpCifpFile>(numFiles, numThreads, [&files](int index, XpCifpFile& cifpFile) -> void {
+      parseCifpFile(cifpFile, files.at(index));
+    }, [this, &files, &reportProgress](int index, XpCifpFile& cifpFile) -> bool {
+      writeCifpFile(files.at(index), cifpFile);
+      return reportProgress(files.at(index));
+    });
+
+    if(aborted)
+      return true;
+  }
+  else
+  {
+    for(const QString& file : std::as_const(files))
+    {
+      if(readDataFile(file, 1, cifpReader, READ_CIFP | READ_SHORT_REPORT, 0))
+        return true;
+
+      if(reportProgress(file))
+        return true;
     }
   }
 
@@ -417,11 +449,238 @@ bool XpDataCompiler::compileMagDeclBgl()
   return false;
 }
 
+/* Calls load(index, result) for all indexes on a thread pool ahead of the consumer and consume(index, result)
+ * in index order on the calling thread. Limits the number of results waiting in memory.
+ * Stops and returns true if consume() returns true. */
+template<typename RESULT, typename LOAD, typename CONSUME>
+static bool runOrdered(int num, int numThreads, const LOAD& load, const CONSUME& consume)
+{
+  struct Entry
+  {
+    RESULT result;
+    bool done = false;
+  };
+
+  int maxAhead = numThreads * 2;
+  QList<Entry> entries(num);
+
+  // Get pointer before starting threads to avoid any detach
+  Entry *entryData = entries.data();
+
+  QMutex mutex;
+  QWaitCondition doneCondition;
+  QAtomicInt cancel(0);
+  QThreadPool pool;
+  pool.setMaxThreadCount(numThreads);
+
+  bool aborted = false;
+  int next = 0;
+  for(int i = 0; i < num && !aborted; i++)
+  {
+    // Keep workers busy
+    for(; next < num && next <= i + maxAhead; next++)
+    {
+      pool.start([&mutex, &doneCondition, &cancel, &load, entryData, index = next]() -> void {
+        RESULT result;
+        if(cancel.loadRelaxed() == 0)
+          load(index, result);
+
+        QMutexLocker locker(&mutex);
+        entryData[index].result = std::move(result);
+        entryData[index].done = true;
+        doneCondition.wakeAll();
+      });
+    }
+
+    RESULT result;
+    {
+      QMutexLocker locker(&mutex);
+      while(!entryData[i].done)
+        doneCondition.wait(&mutex);
+      result = std::move(entryData[i].result);
+    }
+
+    aborted = consume(i, result);
+  }
+
+  // Stop workers before releasing results
+  cancel.storeRelaxed(1);
+  pool.waitForDone();
+  return aborted;
+}
+
+int XpDataCompiler::numParserThreads(int numFiles) const
+{
+  int numThreads = options.getNumParserThreads() > 0 ? options.getNumParserThreads() : QThread::idealThreadCount();
+  return std::max(1, std::min(numThreads, numFiles));
+}
+
+bool XpDataCompiler::readCustomAptDatFiles(const QStringList& aptDatFiles)
+{
+  int numFiles = static_cast<int>(aptDatFiles.size());
+  int numThreads = numParserThreads(numFiles);
+
+  if(numThreads == 1)
+  {
+    for(const QString& aptdat : aptDatFiles)
+    {
+      // Only one progress report per file
+      if(readDataFile(aptdat, 1, airportReader, IS_ADDON | READ_SHORT_REPORT, 1))
+        return true;
+    }
+    return false;
+  }
+
+  return runOrdered<QByteArray>(numFiles, numThreads, [&aptDatFiles](int index, QByteArray& bytes) -> void {
+    // Errors are reported when reading the file again in readDataFile()
+    QFile file(aptDatFiles.at(index));
+    if(file.open(QIODevice::ReadOnly))
+      bytes = file.readAll();
+  }, [this, &aptDatFiles](int index, QByteArray& bytes) -> bool {
+    // Only one progress report per file
+    return readDataFile(aptDatFiles.at(index), 1, airportReader, IS_ADDON | READ_SHORT_REPORT, 1,
+                        bytes.isEmpty() ? nullptr : &bytes);
+  });
+}
+
+/* CIFP file parsed by a worker thread */
+struct XpCifpFile
+{
+  QList<atools::fs::common::ProcedureInput> procInputs;
+  QString errorMessage;
+  int errorLineNum = 0;
+  bool error = false, opened = false; /* opened is false if the file could not be opened or read */
+};
+
+/* Parse all procedure lines of a CIFP file without accessing the database */
+static void parseCifpFile(XpCifpFile& cifpFile, const QString& filepath)
+{
+  QFileInfo fileinfo(filepath);
+  XpReaderContext context;
+  context.fileName = fileinfo.fileName();
+  context.filePath = fileinfo.filePath();
+  context.cifpAirportIdent = fileinfo.baseName().toUpper();
+  context.flags = READ_CIFP;
+
+  int lineNum = 1;
+  try
+  {
+    XpDatTokenizer tokenizer;
+    tokenizer.open(filepath);
+    cifpFile.opened = true;
+
+    QList<QByteArrayView> fields;
+    QStringList line;
+    while(!tokenizer.atEnd())
+    {
+      QByteArrayView lineView = tokenizer.readLine();
+      if(lineView == "99")
+        break;
+
+      if(!lineView.isEmpty())
+      {
+        XpDatTokenizer::split(fields, lineView, ',');
+        XpDatTokenizer::splitRowCode(fields);
+
+        line.resize(fields.size());
+        for(int i = 0; i < fields.size(); i++)
+          line[i] = QString::fromUtf8(fields.at(i));
+
+        context.lineNumber = lineNum;
+        atools::fs::common::ProcedureInput procInput;
+        if(XpCifpReader::readProcedureInput(procInput, line, context))
+          cifpFile.procInputs.append(procInput);
+      }
+      lineNum++;
+    }
+  }
+  catch(std::exception& e)
+  {
+    cifpFile.error = true;
+    cifpFile.errorMessage = e.what();
+    cifpFile.errorLineNum = lineNum;
+  }
+}
+
+void XpDataCompiler::writeCifpFile(const QString& filepath, const XpCifpFile& cifpFile)
+{
+  QFileInfo fileinfo(filepath);
+  if(!includeFile(fileinfo))
+    return;
+
+  int lineNum = cifpFile.errorLineNum;
+
+  if(!cifpFile.opened)
+  {
+    // Skip file without metadata like the sequential reading in readDataFile()
+    readFileError(cifpReader, fileinfo, lineNum, cifpFile.errorMessage);
+    cifpReader->reset();
+    return;
+  }
+
+  try
+  {
+    metadataWriter->writeFile(filepath, QStringLiteral(), curSceneryId, ++curFileId);
+    progress->incNumFiles();
+
+    XpReaderContext context;
+    context.curFileId = curFileId;
+    context.fileName = fileinfo.fileName();
+    context.filePath = fileinfo.filePath();
+    context.localPath = atools::nativeCleanPath(QDir(options.getBasepath()).relativeFilePath(fileinfo.path()));
+    context.flags = READ_CIFP | READ_SHORT_REPORT | flagsFromOptions();
+    context.magDecReader = magDecReader;
+    context.countryUpdater = countryUpdater;
+    context.cifpAirportIdent = fileinfo.baseName().toUpper();
+
+    if(!CIFP_MATCH.match(context.cifpAirportIdent).hasMatch())
+    {
+      qWarning() << Q_FUNC_INFO << "CIFP file" << filepath << "has no valid name which should match airport ident";
+      return;
+    }
+    context.cifpAirportId = airportIndex->getAirportId(context.cifpAirportIdent, true /* allIdents */);
+
+    for(atools::fs::common::ProcedureInput procInput : cifpFile.procInputs)
+    {
+      procInput.airportId = context.cifpAirportId;
+      cifpReader->write(procInput);
+    }
+
+    if(cifpFile.error)
+      throw atools::Exception(cifpFile.errorMessage);
+
+    cifpReader->finish(context);
+  }
+  catch(std::exception& e)
+  {
+    readFileError(cifpReader, fileinfo, lineNum, e.what());
+  }
+  cifpReader->reset();
+}
+
+void XpDataCompiler::readFileError(XpReader *reader, const QFileInfo& fileinfo, int lineNum, const QString& message)
+{
+  if(errors != nullptr)
+  {
+    progress->reportError();
+    errors->getSceneryErrors().first().appendFileError(SceneryFileError(fileinfo.filePath(), message, lineNum));
+    qWarning() << Q_FUNC_INFO << "Error in file" << fileinfo.filePath() << "line" << lineNum << ":" << message;
+  }
+  else
+  {
+    reader->reset();
+    // Enrich error message and rethrow a new one
+    throw atools::Exception(QStringLiteral("Caught exception in file \"%1\" in line %2. Message: %3").
+                            arg(fileinfo.filePath()).arg(lineNum).arg(message));
+  }
+}
+
 bool XpDataCompiler::readDataFile(const QString& filepath, int minColumns, XpReader *reader, atools::fs::xp::ContextFlags flags,
-                                  int numReportSteps)
+                                  int numReportSteps, const QByteArray *fileData)
 {
-  QFile file;
-  QTextStream stream;
+  ATOOLS_TRACE_SPAN_DETAIL("XpDataCompiler::readDataFile", filepath);
+
+  XpDatTokenizer tokenizer;
   bool aborted = false;
 
   QString progressMsg = tr("Reading: %1").arg(atools::nativeCleanPath(filepath));
@@ -438,8 +697,14 @@ bool XpDataCompiler::readDataFile(const QString& filepath, int minColumns, XpRea
 
   try
   {
-    // Open file and read header - throws exception on error
-    if(openFile(stream, file, filepath, flags, lineNum, totalNumLines, fileVersion))
+    // Use content loaded before or open file - throws exception on error
+    if(fileData != nullptr)
+      tokenizer.setData(*fileData);
+    else
+      tokenizer.open(filepath);
+
+    // Read header - throws exception on error
+    if(openFile(tokenizer, filepath, flags, lineNum, totalNumLines, fileVersion))
     {
       XpReaderContext context;
       context.curFileId = curFileId;
@@ -479,8 +744,8 @@ bool XpDataCompiler::readDataFile(const QString& filepath, int minColumns, XpRea
         context.cifpAirportId = airportIndex->getAirportId(context.cifpAirportIdent, true /* allIdents */);
       }
 
-      QString line;
-      QStringList fields;
+      QByteArrayView line;
+      QList<QByteArrayView> fields;
 
       QElapsedTimer timer;
       timer.start();
@@ -494,9 +759,9 @@ bool XpDataCompiler::readDataFile(const QString& filepath, int minColumns, XpRea
       int row = 0, steps = 0;
 
       // Read lines
-      while(!stream.atEnd() && line != "99")
+      while(!tokenizer.atEnd() && line != "99")
       {
-        line = stream.readLine().trimmed();
+        line = tokenizer.readLine();
 
         if(!flags.testFlag(READ_SHORT_REPORT) && numReportSteps > 0)
         {
@@ -514,44 +779,36 @@ bool XpDataCompiler::readDataFile(const QString& filepath, int minColumns, XpRea
           }
         }
 
-        if(flags.testFlag(READ_AIRSPACE) && !line.startsWith(QStringLiteral("AN")))
+        if(flags.testFlag(READ_AIRSPACE) && !line.startsWith("AN"))
         {
           // Strip OpenAirport file comments except for airport names
-          int idx = line.indexOf(QStringLiteral("*"));
+          qsizetype idx = line.indexOf('*');
           if(idx != -1)
-            line = line.left(line.indexOf(QStringLiteral("*")));
+            line = line.first(idx).trimmed();
         }
         else if(!flags.testFlag(READ_CIFP))
         {
           // Strip dat-file comments
-          if(line.startsWith(QStringLiteral("#")))
-            line.clear();
+          if(line.startsWith('#'))
+            line = QByteArrayView();
         }
 
         if(!line.isEmpty())
         {
           if(flags.testFlag(READ_CIFP))
-            fields = line.split(QStringLiteral(","));
+            XpDatTokenizer::split(fields, line, ',');
           else
-            fields = line.simplified().split(QStringLiteral(" "));
+            XpDatTokenizer::splitSpace(fields, line);
 
           if(fields.size() >= minColumns)
           {
             if(flags.testFlag(READ_CIFP))
-            {
               // Extract colon separated row code
-              QString first = fields.takeFirst();
-              QStringList rowCode = first.split(QStringLiteral(":"));
-              if(rowCode.size() == 2)
-              {
-                fields.prepend(rowCode.at(1));
-                fields.prepend(rowCode.at(0));
-              }
-            }
+              XpDatTokenizer::splitRowCode(fields);
             context.lineNumber = lineNum;
 
             // Call writer
-            reader->read(fields, context);
+            reader->readFields(fields, context);
           }
         }
         lineNum++;
@@ -559,7 +816,7 @@ bool XpDataCompiler::readDataFile(const QString& filepath, int minColumns, XpRea
       if(!aborted)
         reader->finish(context);
 
-      file.close();
+      tokenizer.close();
 
       if(!flags.testFlag(READ_SHORT_REPORT) && numReportSteps > 0)
         // Eat up any remaining progress steps
@@ -568,105 +825,76 @@ bool XpDataCompiler::readDataFile(const QString& filepath, int minColumns, XpRea
   }
   catch(std::exception& e)
   {
-    if(errors != nullptr)
-    {
-      progress->reportError();
-      errors->getSceneryErrors().first().appendFileError(SceneryFileError(fileinfo.filePath(), e.what(), lineNum));
-      qWarning() << Q_FUNC_INFO << "Error in file" << fileinfo.filePath() << "line" << lineNum << ":" << e.what();
-    }
-    else
-    {
-      reader->reset();
-      // Enrich error message and rethrow a new one
-      throw atools::Exception(QStringLiteral("Caught exception in file \"%1\" in line %2. Message: %3").
-                              arg(fileinfo.filePath()).arg(lineNum).arg(e.what()));
-    }
+    readFileError(reader, fileinfo, lineNum, e.what());
   }
   reader->reset();
   return aborted;
 }
 
-bool XpDataCompiler::openFile(QTextStream& stream, QFile& filepath, const QString& filename, atools::fs::xp::ContextFlags flags,
+bool XpDataCompiler::openFile(XpDatTokenizer& tokenizer, const QString& filename, atools::fs::xp::ContextFlags flags,
                               int& lineNum, int& totalNumLines, int& fileVersion)
 {
   bool retval = false;
 
-  filepath.setFileName(filename);
   lineNum = 1;
 
-  if(filepath.open(QIODevice::ReadOnly | QIODevice::Text))
+  if(!(flags & READ_CIFP) && !(flags & READ_AIRSPACE))
   {
-    stream.setDevice(&filepath);
-
-    if(!(flags & READ_CIFP) && !(flags & READ_AIRSPACE))
+    // Read file header =============================
+    // Skip empty lines which can appear in some malformed add-on airport files
+    // Byte order identifier ===========
+    QString line;
+    do
     {
-      // Read file header =============================
-      // Skip empty lines which can appear in some malformed add-on airport files
-      // Byte order identifier ===========
-      QString line;
-      do
-      {
-        line = stream.readLine().simplified();
-        lineNum++;
-      } while(line.isEmpty() && !stream.atEnd() && line != QStringLiteral("99"));
-      qInfo() << Q_FUNC_INFO << line;
+      line = QString::fromUtf8(tokenizer.readLine()).simplified();
+      lineNum++;
+    } while(line.isEmpty() && !tokenizer.atEnd() && line != QStringLiteral("99"));
+    qInfo() << Q_FUNC_INFO << line;
 
-      // Metadata and copyright ===========
-      do
-      {
-        line = stream.readLine().simplified();
-        lineNum++;
-      } while(line.isEmpty() && !stream.atEnd() && line != QStringLiteral("99"));
-      qInfo() << Q_FUNC_INFO << line;
+    // Metadata and copyright ===========
+    do
+    {
+      line = QString::fromUtf8(tokenizer.readLine()).simplified();
+      lineNum++;
+    } while(line.isEmpty() && !tokenizer.atEnd() && line != QStringLiteral("99"));
+    qInfo() << Q_FUNC_INFO << line;
 
-      QStringList fields = line.simplified().split(QStringLiteral(" "));
-      if(!fields.isEmpty())
-        fileVersion = fields.constFirst().toInt();
+    QStringList fields = line.simplified().split(QStringLiteral(" "));
+    if(!fields.isEmpty())
+      fileVersion = fields.constFirst().toInt();
 
-      if(!fields.isEmpty() && fileVersion < minFileVersion)
-      {
-        qWarning() << "Version of" << filename << "is" << fields.constFirst() << "but expected a minimum of" << minFileVersion;
-        throw atools::Exception(QStringLiteral("Found file version %1. Minimum supported is %2.").arg(fields.constFirst()).arg(
-                                  minFileVersion));
-      }
-
-      metadataWriter->writeFile(filename, QStringLiteral(), curSceneryId, ++curFileId);
-      progress->incNumFiles();
-      retval = true;
+    if(!fields.isEmpty() && fileVersion < minFileVersion)
+    {
+      qWarning() << "Version of" << filename << "is" << fields.constFirst() << "but expected a minimum of" << minFileVersion;
+      throw atools::Exception(QStringLiteral("Found file version %1. Minimum supported is %2.").arg(fields.constFirst()).arg(
+                                minFileVersion));
+    }
 
-      if(flags & UPDATE_CYCLE)
-        updateAiracCycleFromHeader(line, filename, lineNum);
+    metadataWriter->writeFile(filename, QStringLiteral(), curSceneryId, ++curFileId);
+    progress->incNumFiles();
+    retval = true;
 
-      qInfo() << Q_FUNC_INFO << "Counting lines for" << filename;
-      qint64 pos = stream.pos();
-      int lines = 0;
-      while(!stream.atEnd())
-      {
-        line = stream.readLine();
-        if(line == QStringLiteral("99"))
-          break;
-        lines++;
-      }
+    if(flags & UPDATE_CYCLE)
+      updateAiracCycleFromHeader(line, filename, lineNum);
 
-      if(lines == 0)
-      {
-        qWarning() << Q_FUNC_INFO << "Empty file" << filepath.fileName();
-        retval = false;
-      }
+    // Count on the mapping which is also used for reading - approximation for progress only
+    int lines = tokenizer.countRemainingLines();
 
-      totalNumLines = lines;
-      stream.seek(pos);
-      qInfo() << Q_FUNC_INFO << "Num lines" << lines;
-    }
-    else
+    if(lines == 0)
     {
-      metadataWriter->writeFile(filename, QStringLiteral(), curSceneryId, ++curFileId);
-      progress->incNumFiles();
-      retval = true;
+      qWarning() << Q_FUNC_INFO << "Empty file" << filename;
+      retval = false;
     }
+
+    totalNumLines = lines;
+    qInfo() << Q_FUNC_INFO << "Num lines" << lines;
   }
   else
-    throw atools::Exception("Cannot open file. Reason: " + filepath.errorString() + ".");
+  {
+    metadataWriter->writeFile(filename, QStringLiteral(), curSceneryId, ++curFileId);
+    progress->incNumFiles();
+    retval = true;
+  }
 
   return retval;
 }
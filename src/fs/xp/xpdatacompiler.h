@@ -19,11 +19,10 @@
 #define ATOOLS_XP_DATAREADER_h
 
 #include "fs/xp/xpconstants.h"
+#include "fs/db/airwayresolver.h"
 
 #include <QCoreApplication>
 
-class QTextStream;
-class QFile;
 class QFileInfo;
 
 namespace atools {
@@ -58,6 +57,8 @@ class XpCifpReader;
 class XpAirspaceReader;
 class XpReader;
 class XpAirwayPostProcess;
+class XpDatTokenizer;
+struct XpCifpFile;
 
 /*
  * Provides methods to read X-Plane data from text files into the database.
@@ -151,9 +152,16 @@ public:
 
   /*
    * Reads all from/to and to/from segments of all airways and creates from/via/to segments.
+   * The result is kept in memory and can be fetched using takeAirwayPoints().
    */
   bool postProcessEarthAirway();
 
+  /* Airway points created by postProcessEarthAirway() to be passed to AirwayResolver. Clears the list in this object. */
+  QList<atools::fs::db::AirwayPointRow> takeAirwayPoints()
+  {
+    return std::move(airwayPoints);
+  }
+
   /*
    * Read earth_awy.dat from either default or custom scenery depending which one exists.
    * @return true if the  process was aborted
@@ -246,13 +254,26 @@ private:
   void initQueries();
   void deInitQueries();
 
-  /* Open file and read header */
-  bool openFile(QTextStream& stream, QFile& filepath, const QString& filename, ContextFlags flags,
+  /* Read header from opened file */
+  bool openFile(atools::fs::xp::XpDatTokenizer& tokenizer, const QString& filename, ContextFlags flags,
                 int& lineNum, int& totalNumLines, int& fileVersion);
 
-  /* Read file line by line and call reader for each one */
+  /* Read file line by line and call reader for each one. Uses fileData instead of reading the file if not null. */
   bool readDataFile(const QString& filepath, int minColumns, atools::fs::xp::XpReader *reader,
-                    atools::fs::xp::ContextFlags flags, int numReportSteps);
+                    atools::fs::xp::ContextFlags flags, int numReportSteps, const QByteArray *fileData = nullptr);
+
+  /* Read add-on apt.dat files in the given priority order. Files are loaded into memory by worker threads
+   * ahead of the reader which writes them on this thread. */
+  bool readCustomAptDatFiles(const QStringList& aptDatFiles);
+
+  /* Write CIFP file parsed before on a worker thread */
+  void writeCifpFile(const QString& filepath, const atools::fs::xp::XpCifpFile& cifpFile);
+
+  /* Report error in file or throw exception if no error list is available */
+  void readFileError(atools::fs::xp::XpReader *reader, const QFileInfo& fileinfo, int lineNum, const QString& message);
+
+  /* Number of worker threads for parsing numFiles files */
+  int numParserThreads(int numFiles) const;
   static QString buildBasePath(const NavDatabaseOptions& opts, const QString& filename);
 
   /* FInd custom apt.dat like X-Plane 11/Custom Scenery/LFPG Paris - Charles de Gaulle/Earth Nav data/apt.dat */
@@ -311,6 +332,8 @@ private:
   atools::fs::NavDatabaseErrors *errors = nullptr;
   QString airacCycle;
 
+  /* Result of airway post processing */
+  QList<atools::fs::db::AirwayPointRow> airwayPoints;
 };
 
 } // namespace xp
@@ -0,0 +1,219 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+
+#include "fs/xp/xpdattokenizer.h"
+
+#include "exception.h"
+
+#include <QDebug>
+
+#include <cstring>
+
+namespace atools {
+namespace fs {
+namespace xp {
+
+/* Whitespace as used by QString::simplified() for ASCII */
+inline bool isSpace(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+XpDatTokenizer::XpDatTokenizer()
+{
+}
+
+XpDatTokenizer::~XpDatTokenizer()
+{
+  close();
+}
+
+void XpDatTokenizer::open(const QString& filename)
+{
+  close();
+
+  file.setFileName(filename);
+  if(!file.open(QIODevice::ReadOnly))
+    throw atools::Exception("Cannot open file. Reason: " + file.errorString() + ".");
+
+  size = file.size();
+  if(size > 0)
+  {
+    data = reinterpret_cast<const char *>(file.map(0, size));
+    mapped = data != nullptr;
+
+    if(!mapped)
+    {
+      qWarning() << Q_FUNC_INFO << "Cannot map" << filename << file.errorString();
+      buffer = file.readAll();
+      data = buffer.constData();
+      size = buffer.size();
+    }
+  }
+
+  skipByteOrderMark();
+}
+
+void XpDatTokenizer::setData(const QByteArray& bytes)
+{
+  close();
+
+  buffer = bytes;
+  data = buffer.constData();
+  size = buffer.size();
+
+  skipByteOrderMark();
+}
+
+void XpDatTokenizer::skipByteOrderMark()
+{
+  if(size >= 3 && std::memcmp(data, "\xEF\xBB\xBF", 3) == 0)
+    pos = 3;
+}
+
+void XpDatTokenizer::close()
+{
+  if(mapped && file.isOpen())
+    file.unmap(reinterpret_cast<uchar *>(const_cast<char *>(data)));
+
+  file.close();
+  buffer.clear();
+  data = nullptr;
+  size = pos = 0;
+  mapped = false;
+}
+
+QByteArrayView XpDatTokenizer::readLine()
+{
+  if(atEnd())
+    return QByteArrayView();
+
+  const char *start = data + pos;
+  const char *end = static_cast<const char *>(std::memchr(start, '\n', static_cast<size_t>(size - pos)));
+
+  if(end == nullptr)
+  {
+    end = data + size;
+    pos = size;
+  }
+  else
+    pos = end - data + 1;
+
+  // Trim including carriage return
+  while(start < end && isSpace(*start))
+    start++;
+  while(end > start && isSpace(*(end - 1)))
+    end--;
+
+  return QByteArrayView(start, end - start);
+}
+
+int XpDatTokenizer::countRemainingLines() const
+{
+  if(atEnd())
+    return 0;
+
+  int lines = 0;
+  const char *cur = data + pos, *end = data + size;
+  while(cur < end)
+  {
+    const char *lineFeed = static_cast<const char *>(std::memchr(cur, '\n', static_cast<size_t>(end - cur)));
+    if(lineFeed == nullptr)
+      break;
+
+    lines++;
+    cur = lineFeed + 1;
+  }
+
+  // Last line without line feed
+  if(cur < end)
+    lines++;
+
+  // Do not count end marker
+  const char *last = end;
+  while(last > data + pos && isSpace(*(last - 1)))
+    last--;
+
+  if(last - (data + pos) >= 2 && last[-1] == '9' && last[-2] == '9' &&
+     (last - (data + pos) == 2 || isSpace(last[-3])))
+    lines--;
+
+  return lines;
+}
+
+void XpDatTokenizer::splitSpace(QList<QByteArrayView>& fields, QByteArrayView line)
+{
+  fields.clear();
+
+  const char *cur = line.constData(), *end = line.constData() + line.size();
+  while(cur < end)
+  {
+    while(cur < end && isSpace(*cur))
+      cur++;
+
+    const char *start = cur;
+    while(cur < end && !isSpace(*cur))
+      cur++;
+
+    if(cur > start)
+      fields.append(QByteArrayView(start, cur - start));
+  }
+}
+
+void XpDatTokenizer::split(QList<QByteArrayView>& fields, QByteArrayView line, char separator)
+{
+  fields.clear();
+
+  if(line.isEmpty())
+  {
+    fields.append(line);
+    return;
+  }
+
+  const char *start = line.constData(), *end = line.constData() + line.size();
+  while(true)
+  {
+    const char *sep = static_cast<const char *>(std::memchr(start, separator, static_cast<size_t>(end - start)));
+    if(sep == nullptr)
+    {
+      fields.append(QByteArrayView(start, end - start));
+      break;
+    }
+
+    fields.append(QByteArrayView(start, sep - start));
+    start = sep + 1;
+  }
+}
+
+void XpDatTokenizer::splitRowCode(QList<QByteArrayView>& fields)
+{
+  if(fields.isEmpty())
+    return;
+
+  QByteArrayView first = fields.constFirst();
+  qsizetype idx = first.indexOf(':');
+  if(idx != -1 && first.indexOf(':', idx + 1) == -1)
+  {
+    fields[0] = first.sliced(idx + 1);
+    fields.prepend(first.first(idx));
+  }
+}
+
+} // namespace xp
+} // namespace fs
+} // namespace atools
@@ -0,0 +1,107 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+
+#ifndef ATOOLS_FS_XP_DATTOKENIZER_H
+#define ATOOLS_FS_XP_DATTOKENIZER_H
+
+#include <QByteArrayView>
+#include <QFile>
+#include <QList>
+
+#include <algorithm>
+
+namespace atools {
+namespace fs {
+namespace xp {
+
+/*
+ * Reads X-Plane dat files line by line from a memory mapped file without decoding or copying.
+ * Lines and fields are views into the mapping which are valid until close() is called or the object is destroyed.
+ *
+ * Falls back to reading the whole file into memory if it cannot be mapped. A UTF-8 byte order mark is skipped.
+ */
+class XpDatTokenizer
+{
+public:
+  XpDatTokenizer();
+  ~XpDatTokenizer();
+
+  XpDatTokenizer(const XpDatTokenizer& other) = delete;
+  XpDatTokenizer& operator=(const XpDatTokenizer& other) = delete;
+
+  /* Open and map file. Throws an exception if the file cannot be opened. */
+  void open(const QString& filename);
+
+  /* Use file content read before, e.g. in a worker thread. Takes a shallow copy of bytes. */
+  void setData(const QByteArray& bytes);
+
+  void close();
+
+  bool atEnd() const
+  {
+    return pos >= size;
+  }
+
+  /* Next line without line end and leading or trailing whitespace */
+  QByteArrayView readLine();
+
+  /* Position from start of file in bytes */
+  qint64 getPos() const
+  {
+    return pos;
+  }
+
+  void seek(qint64 position)
+  {
+    pos = std::clamp(position, static_cast<qint64>(0), size);
+  }
+
+  qint64 getSize() const
+  {
+    return size;
+  }
+
+  /* Number of lines from the current position to the end excluding a last line "99" which marks the end
+   * of dat files. Counts line feeds using memchr() and does not change the position. */
+  int countRemainingLines() const;
+
+  /* Split at whitespace and ignore consecutive whitespace like QString::simplified().split(' ').
+   * Fields are cleared before. */
+  static void splitSpace(QList<QByteArrayView>& fields, QByteArrayView line);
+
+  /* Split at separator keeping empty fields like QString::split(separator). Fields are cleared before. */
+  static void split(QList<QByteArrayView>& fields, QByteArrayView line, char separator);
+
+  /* Split first field of CIFP lines like "APPCH:010" at a single colon into row code and sequence number */
+  static void splitRowCode(QList<QByteArrayView>& fields);
+
+private:
+  void skipByteOrderMark();
+
+  QFile file;
+  QByteArray buffer; /* Used if file cannot be mapped */
+  const char *data = nullptr;
+  qint64 size = 0, pos = 0;
+  bool mapped = false;
+};
+
+} // namespace xp
+} // namespace fs
+} // namespace atools
+
+#endif // ATOOLS_FS_XP_DATTOKENIZER_H
@@ -39,6 +39,15 @@ XpReader::~XpReader()
 
 }
 
+void XpReader::readFields(const QList<QByteArrayView>& fields, const XpReaderContext& context)
+{
+  lineFields.resize(fields.size());
+  for(int i = 0; i < fields.size(); i++)
+    lineFields[i] = QString::fromUtf8(fields.at(i));
+
+  read(lineFields, context);
+}
+
 const QString& XpReader::at(const QStringList& line, int index)
 {
   if(index < line.size())
@@ -21,6 +21,7 @@
 #include "exception.h"
 #include "fs/xp/xpconstants.h"
 
+#include <QByteArrayView>
 #include <QStringList>
 
 namespace atools {
@@ -56,6 +57,10 @@ public:
   /* Called for each line read from a dat file */
   virtual void read(const QStringList& line, const atools::fs::xp::XpReaderContext& context) = 0;
 
+  /* Called for each line with fields as views into the file data which are valid only during the call.
+   * Override to avoid string conversion. Default implementation converts fields and calls read() */
+  virtual void readFields(const QList<QByteArrayView>& fields, const atools::fs::xp::XpReaderContext& context);
+
   /* Called when finished with reading a dat file */
   virtual void finish(const atools::fs::xp::XpReaderContext& context) = 0;
 
@@ -98,6 +103,9 @@ private:
                    atools::geo::Pos& pos, QString *vorType = nullptr, bool *dmeOnly = nullptr, bool *hasDme = nullptr);
 
   atools::sql::SqlQuery *waypointQuery = nullptr, *ndbQuery = nullptr, *vorQuery = nullptr, *ilsQuery = nullptr;
+
+  /* Reused by readFields() to avoid allocating a new list for each line */
+  QStringList lineFields;
 };
 
 } // namespace xp
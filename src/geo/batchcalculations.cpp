@@ -0,0 +1,236 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "geo/batchcalculations.h"
+
+#include "atools.h"
+#include "geo/calculations.h"
+#include "geo/linestring.h"
+#include "geo/pos.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace atools {
+namespace geo {
+
+/* Number of points which are prepared at once on the stack for segment calculations */
+const static int CHUNK_SIZE = 256;
+
+const static double DEG_TO_RAD = 0.017453292519943295769236907684886;
+const static double RAD_TO_DEG = 1. / DEG_TO_RAD;
+
+/* Sine and cosine of latitude and longitude for a range of points */
+struct SinCos
+{
+  double sinLat[CHUNK_SIZE + 1], cosLat[CHUNK_SIZE + 1], sinLon[CHUNK_SIZE + 1], cosLon[CHUNK_SIZE + 1];
+
+  void calculate(const float *lonX, const float *latY, int num)
+  {
+    for(int i = 0; i < num; i++)
+    {
+      double lat = static_cast<double>(latY[i]) * DEG_TO_RAD, lon = static_cast<double>(lonX[i]) * DEG_TO_RAD;
+      sinLat[i] = std::sin(lat);
+      cosLat[i] = std::cos(lat);
+      sinLon[i] = std::sin(lon);
+      cosLon[i] = std::cos(lon);
+    }
+  }
+};
+
+/* Normalize course in degree to 0 to 360 without branches */
+inline double normalizeCourseDeg(double course)
+{
+  return course - std::floor(course / 360.) * 360.;
+}
+
+void toArrays(const LineString& line, QList<float>& lonX, QList<float>& latY)
+{
+  lonX.resize(line.size());
+  latY.resize(line.size());
+  for(int i = 0; i < line.size(); i++)
+  {
+    lonX[i] = line.at(i).getLonX();
+    latY[i] = line.at(i).getLatY();
+  }
+}
+
+void distanceMeterBatch(const float *lonX1, const float *latY1, const float *lonX2, const float *latY2,
+                        float *distanceMeter, int num)
+{
+  for(int i = 0; i < num; i++)
+  {
+    // Haversine like Pos::distanceRad()
+    double lat1 = static_cast<double>(latY1[i]) * DEG_TO_RAD, lat2 = static_cast<double>(latY2[i]) * DEG_TO_RAD;
+    double l1 = std::sin((lat1 - lat2) / 2.);
+    double l2 = std::sin((static_cast<double>(lonX1[i]) - static_cast<double>(lonX2[i])) * DEG_TO_RAD / 2.);
+    double dist = 2. * std::asin(std::sqrt(l1 * l1 + std::cos(lat1) * std::cos(lat2) * l2 * l2));
+    distanceMeter[i] = static_cast<float>(dist * Pos::EARTH_RADIUS_METER_DOUBLE);
+  }
+}
+
+void initialBearingBatch(const float *lonX1, const float *latY1, const float *lonX2, const float *latY2,
+                         float *bearingDeg, int num)
+{
+  for(int i = 0; i < num; i++)
+  {
+    double lat1 = static_cast<double>(latY1[i]) * DEG_TO_RAD, lat2 = static_cast<double>(latY2[i]) * DEG_TO_RAD;
+    double delta = (static_cast<double>(lonX2[i]) - static_cast<double>(lonX1[i])) * DEG_TO_RAD;
+    double cosLat2 = std::cos(lat2);
+    double bearing = std::atan2(std::sin(delta) * cosLat2,
+                                std::cos(lat1) * std::sin(lat2) - std::sin(lat1) * cosLat2 * std::cos(delta));
+    bearingDeg[i] = static_cast<float>(normalizeCourseDeg(bearing * RAD_TO_DEG));
+  }
+}
+
+void segmentsBatch(const float *lonX, const float *latY, float *distanceMeter, float *bearingDeg, int num)
+{
+  SinCos sc;
+
+  // Process in chunks overlapping by one point
+  for(int start = 0; start < num - 1; start += CHUNK_SIZE)
+  {
+    int numPoints = std::min(CHUNK_SIZE + 1, num - start);
+    sc.calculate(lonX + start, latY + start, numPoints);
+
+    if(distanceMeter != nullptr)
+    {
+      for(int i = 0; i < numPoints - 1; i++)
+      {
+        // Chord length between unit vectors converted to great circle distance
+        double dx = sc.cosLat[i + 1] * sc.cosLon[i + 1] - sc.cosLat[i] * sc.cosLon[i];
+        double dy = sc.cosLat[i + 1] * sc.sinLon[i + 1] - sc.cosLat[i] * sc.sinLon[i];
+        double dz = sc.sinLat[i + 1] - sc.sinLat[i];
+        double chord = std::sqrt(dx * dx + dy * dy + dz * dz);
+        distanceMeter[start + i] =
+          static_cast<float>(2. * std::asin(std::min(chord / 2., 1.)) * Pos::EARTH_RADIUS_METER_DOUBLE);
+      }
+    }
+
+    if(bearingDeg != nullptr)
+    {
+      for(int i = 0; i < numPoints - 1; i++)
+      {
+        // Project next point on east and north vectors at the current point
+        double cosDeltaLon = sc.cosLon[i + 1] * sc.cosLon[i] + sc.sinLon[i + 1] * sc.sinLon[i];
+        double sinDeltaLon = sc.sinLon[i + 1] * sc.cosLon[i] - sc.cosLon[i + 1] * sc.sinLon[i];
+        double east = sc.cosLat[i + 1] * sinDeltaLon;
+        double north = sc.cosLat[i] * sc.sinLat[i + 1] - sc.sinLat[i] * sc.cosLat[i + 1] * cosDeltaLon;
+        bearingDeg[start + i] = static_cast<float>(normalizeCourseDeg(std::atan2(east, north) * RAD_TO_DEG));
+      }
+    }
+  }
+}
+
+double lengthMeterBatch(const float *lonX, const float *latY, int num)
+{
+  float distances[CHUNK_SIZE];
+  double length = 0.;
+
+  for(int start = 0; start < num - 1; start += CHUNK_SIZE)
+  {
+    int numPoints = std::min(CHUNK_SIZE + 1, num - start);
+    segmentsBatch(lonX + start, latY + start, distances, nullptr, numPoints);
+
+    for(int i = 0; i < numPoints - 1; i++)
+      length += static_cast<double>(distances[i]);
+  }
+  return length;
+}
+
+void endpointBatch(const float *lonX, const float *latY, const float *distanceMeter, const float *angleDeg,
+                   float *endLonX, float *endLatY, int num)
+{
+  for(int i = 0; i < num; i++)
+  {
+    // Same as endpointRad() in pos.cpp
+    double lon = static_cast<double>(lonX[i]) * DEG_TO_RAD, lat = static_cast<double>(latY[i]) * DEG_TO_RAD;
+    double distance = atools::geo::meterToRad(static_cast<double>(distanceMeter[i]));
+    double angle = (360. - static_cast<double>(angleDeg[i])) * DEG_TO_RAD;
+
+    double sinLat = std::sin(lat), cosLat = std::cos(lat), sinDist = std::sin(distance), cosDist = std::cos(distance);
+    double endLat = std::asin(sinLat * cosDist + cosLat * sinDist * std::cos(angle));
+    double dlon = std::atan2(std::sin(angle) * sinDist * cosLat, cosDist - sinLat * std::sin(endLat));
+
+    endLonX[i] = static_cast<float>((std::remainder(lon - dlon + M_PI, 2. * M_PI) - M_PI) * RAD_TO_DEG);
+    endLatY[i] = static_cast<float>(endLat * RAD_TO_DEG);
+  }
+}
+
+void interpolateBatch(const Pos& from, const Pos& to, const float *fraction, float *lonX, float *latY, int num)
+{
+  float lonXArr[2] = {from.getLonX(), to.getLonX()}, latYArr[2] = {from.getLatY(), to.getLatY()};
+
+  // All points on the same segment
+  std::vector<int> segment(static_cast<size_t>(std::max(num, 0)), 0);
+  interpolateSegmentsBatch(lonXArr, latYArr, segment.data(), fraction, lonX, latY, num);
+}
+
+void interpolateSegmentsBatch(const float *lonX, const float *latY, const int *segment, const float *fraction,
+                              float *resultLonX, float *resultLatY, int num)
+{
+  // Unit vectors for all segment points needed - cache the last segment since fractions are usually ordered
+  int lastSegment = -1;
+  double x1 = 0., y1 = 0., z1 = 0., x2 = 0., y2 = 0., z2 = 0., invSinDist = 0., dist = 0.;
+
+  for(int i = 0; i < num; i++)
+  {
+    int seg = segment[i];
+    if(seg != lastSegment)
+    {
+      SinCos sc;
+      sc.calculate(lonX + seg, latY + seg, 2);
+      x1 = sc.cosLat[0] * sc.cosLon[0];
+      y1 = sc.cosLat[0] * sc.sinLon[0];
+      z1 = sc.sinLat[0];
+      x2 = sc.cosLat[1] * sc.cosLon[1];
+      y2 = sc.cosLat[1] * sc.sinLon[1];
+      z2 = sc.sinLat[1];
+
+      double dx = x2 - x1, dy = y2 - y1, dz = z2 - z1;
+      dist = 2. * std::asin(std::min(std::sqrt(dx * dx + dy * dy + dz * dz) / 2., 1.));
+      invSinDist = atools::almostEqual(dist, 0.) ? 0. : 1. / std::sin(dist);
+      lastSegment = seg;
+    }
+
+    // Same as Pos::interpolate() - return start for zero length segments and end points for fractions outside 0 to 1
+    double f = static_cast<double>(fraction[i]);
+    if(f <= 0. || atools::almostEqual(dist, 0.))
+    {
+      resultLonX[i] = lonX[seg];
+      resultLatY[i] = latY[seg];
+      continue;
+    }
+    else if(f >= 1.)
+    {
+      resultLonX[i] = lonX[seg + 1];
+      resultLatY[i] = latY[seg + 1];
+      continue;
+    }
+
+    double a = std::sin((1. - f) * dist) * invSinDist;
+    double b = std::sin(f * dist) * invSinDist;
+    double x = a * x1 + b * x2, y = a * y1 + b * y2, z = a * z1 + b * z2;
+
+    resultLatY[i] = static_cast<float>(std::atan2(z, std::sqrt(x * x + y * y)) * RAD_TO_DEG);
+    resultLonX[i] = static_cast<float>(std::atan2(y, x) * RAD_TO_DEG);
+  }
+}
+
+} // namespace geo
+} // namespace atools
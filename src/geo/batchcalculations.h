@@ -0,0 +1,76 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_GEO_BATCHCALCULATIONS_H
+#define ATOOLS_GEO_BATCHCALCULATIONS_H
+
+#include <QList>
+
+namespace atools {
+namespace geo {
+
+class LineString;
+class Pos;
+
+/*
+ * Great circle calculations for many positions at once.
+ *
+ * All functions take structure of arrays buffers with coordinates in degree and write into caller owned
+ * buffers which have to be large enough. Calculation is done in double precision like in Pos.
+ * Loops contain no branches and trigonometric values are calculated only once per point for
+ * consecutive segments.
+ *
+ * Positions have to be valid since there is no check for invalid coordinates.
+ */
+
+/* Copy positions of a line string into separate longitude and latitude arrays */
+void toArrays(const atools::geo::LineString& line, QList<float>& lonX, QList<float>& latY);
+
+/* Distance in meter between pairs of positions 1[i] and 2[i]. Same as Pos::distanceMeterTo(). */
+void distanceMeterBatch(const float *lonX1, const float *latY1, const float *lonX2, const float *latY2,
+                        float *distanceMeter, int num);
+
+/* Initial bearing in degree 0 to 360 between pairs of positions 1[i] and 2[i].
+ * Same as Pos::initialBearing(). */
+void initialBearingBatch(const float *lonX1, const float *latY1, const float *lonX2, const float *latY2,
+                         float *bearingDeg, int num);
+
+/* Distances and initial bearings for all segments of a line with num points.
+ * Writes num - 1 values for segment i from point i to i + 1. Either result pointer can be null. */
+void segmentsBatch(const float *lonX, const float *latY, float *distanceMeter, float *bearingDeg, int num);
+
+/* Total length of a line in meter. Same as LineString::lengthMeter(). */
+double lengthMeterBatch(const float *lonX, const float *latY, int num);
+
+/* Endpoint for each position given by distance and course. Same as Pos::endpoint(). */
+void endpointBatch(const float *lonX, const float *latY, const float *distanceMeter, const float *angleDeg,
+                   float *endLonX, float *endLatY, int num);
+
+/* Intermediate points on great circle from "from" to "to" at given fractions 0 to 1.
+ * Same as Pos::interpolate(). Fractions are clamped to 0 to 1. Points must not be antipodal. */
+void interpolateBatch(const atools::geo::Pos& from, const atools::geo::Pos& to, const float *fraction,
+                      float *lonX, float *latY, int num);
+
+/* Intermediate points at fractions for each segment of a line. Segment for point i is given by segment[i]
+ * which is the index of the segment start in lonX and latY. Returns the segment start for zero length segments. */
+void interpolateSegmentsBatch(const float *lonX, const float *latY, const int *segment, const float *fraction,
+                              float *resultLonX, float *resultLatY, int num);
+
+} // namespace geo
+} // namespace atools
+
+#endif // ATOOLS_GEO_BATCHCALCULATIONS_H
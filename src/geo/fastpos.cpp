@@ -0,0 +1,70 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "geo/fastpos.h"
+
+namespace atools {
+namespace geo {
+
+void insideRadius(QList<int>& indexes, const QList<FastPos>& positions, const FastPos& center, float radiusMeter)
+{
+  if(!center.isValid())
+    return;
+
+  ChordDistance distance(radiusMeter);
+  for(int i = 0; i < positions.size(); i++)
+  {
+    const FastPos& pos = positions.at(i);
+    if(pos.isValid() && center.isWithin(pos, distance))
+      indexes.append(i);
+  }
+}
+
+int nearestIndex(const QList<FastPos>& positions, const FastPos& center, float maxDistanceMeter)
+{
+  if(!center.isValid())
+    return -1;
+
+  float minDist = ChordDistance(maxDistanceMeter).getComparable();
+  int index = -1;
+  for(int i = 0; i < positions.size(); i++)
+  {
+    const FastPos& pos = positions.at(i);
+    if(pos.isValid())
+    {
+      float dist = center.comparableDistance(pos);
+      if(dist <= minDist)
+      {
+        minDist = dist;
+        index = i;
+      }
+    }
+  }
+  return index;
+}
+
+QList<FastPos> toFastPos(const QList<Pos>& positions)
+{
+  QList<FastPos> fastPositions;
+  fastPositions.reserve(positions.size());
+  for(const Pos& pos : positions)
+    fastPositions.append(FastPos(pos));
+  return fastPositions;
+}
+
+} // namespace geo
+} // namespace atools
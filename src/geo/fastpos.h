@@ -0,0 +1,143 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_GEO_FASTPOS_H
+#define ATOOLS_GEO_FASTPOS_H
+
+#include "geo/pos.h"
+#include "geo/point3d.h"
+
+#include <QList>
+
+namespace atools {
+namespace geo {
+
+/*
+ * Distance threshold for FastPos which is converted once to a squared chord length.
+ * Comparisons need only multiplications and no trigonometric functions.
+ */
+class ChordDistance
+{
+public:
+  ChordDistance()
+  {
+  }
+
+  explicit ChordDistance(float distanceMeterParam)
+    : distanceMeter(distanceMeterParam), comparable(Point3D::comparableDistanceForMeter(distanceMeterParam))
+  {
+  }
+
+  float getDistanceMeter() const
+  {
+    return distanceMeter;
+  }
+
+  /* Squared chord length comparable with Point3D::comparableDistance() */
+  float getComparable() const
+  {
+    return comparable;
+  }
+
+private:
+  float distanceMeter = 0.f, comparable = 0.f;
+};
+
+/*
+ * Position carrying a cached cartesian representation for bulk filtering.
+ * Conversion is done once on construction. Distance checks use the chord length and are
+ * accurate to about a meter because of float precision.
+ */
+class FastPos
+{
+public:
+  FastPos()
+  {
+  }
+
+  explicit FastPos(const atools::geo::Pos& posParam)
+    : pos(posParam), point(posParam.isValid() ? posParam.toCartesian() : Point3D())
+  {
+  }
+
+  explicit FastPos(float lonX, float latY, float altitude = 0.f)
+    : FastPos(Pos(lonX, latY, altitude))
+  {
+  }
+
+  const atools::geo::Pos& getPos() const
+  {
+    return pos;
+  }
+
+  const atools::geo::Point3D& getPoint3D() const
+  {
+    return point;
+  }
+
+  bool isValid() const
+  {
+    return pos.isValid();
+  }
+
+  /* true if other is within distance. No trigonometric functions used. */
+  bool isWithin(const FastPos& other, const ChordDistance& distance) const
+  {
+    return point.isWithinComparableDistance(other.point, distance.getComparable());
+  }
+
+  /* Value for sorting and comparing distances. Not a distance in meter. */
+  float comparableDistance(const FastPos& other) const
+  {
+    return point.comparableDistance(other.point);
+  }
+
+  /* Chord (tunnel) distance in meter. Slightly lower than great circle distance. */
+  float chordDistanceMeter(const FastPos& other) const
+  {
+    return point.directDistanceMeter(other.point);
+  }
+
+  /* Great circle distance in meter using one square root and one arcsine */
+  float distanceMeterTo(const FastPos& other) const
+  {
+    return point.gcDistanceMeter(other.point);
+  }
+
+private:
+  atools::geo::Pos pos;
+  atools::geo::Point3D point;
+};
+
+/* Indexes of all valid positions within radius of center */
+void insideRadius(QList<int>& indexes, const QList<atools::geo::FastPos>& positions,
+                  const atools::geo::FastPos& center, float radiusMeter);
+
+/* Index of the nearest valid position to center or -1 if none within maxDistanceMeter */
+int nearestIndex(const QList<atools::geo::FastPos>& positions, const atools::geo::FastPos& center,
+                 float maxDistanceMeter = std::numeric_limits<float>::max());
+
+/* Convert a list of positions */
+QList<atools::geo::FastPos> toFastPos(const QList<atools::geo::Pos>& positions);
+
+} // namespace geo
+} // namespace atools
+
+Q_DECLARE_TYPEINFO(atools::geo::FastPos, Q_RELOCATABLE_TYPE);
+Q_DECLARE_TYPEINFO(atools::geo::ChordDistance, Q_PRIMITIVE_TYPE);
+
+#endif // ATOOLS_GEO_FASTPOS_H
@@ -0,0 +1,327 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "geo/geobenchmark.h"
+
+#include "geo/calculations.h"
+#include "geo/linestring.h"
+#include "geo/rect.h"
+#include "geo/spatialindex.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QThread>
+
+#include <random>
+
+namespace atools {
+namespace geo {
+
+namespace geobench {
+
+/* Fixed seeds to get the same data sets in all runs */
+static const quint32 SEED_AIRPORTS = 0x4A1B2C3D, SEED_WAYPOINTS = 0x5E6F7A8B, SEED_QUERIES = 0x1C2D3E4F;
+
+/* Number of query positions and routes used by the cases */
+static const int NUM_QUERIES = 1000, NUM_ROUTES = 1000, NUM_ROUTE_POINTS = 20;
+
+/* Object for SpatialIndex */
+struct Point
+{
+  atools::geo::Pos pos;
+
+  const atools::geo::Pos& getPosition() const
+  {
+    return pos;
+  }
+};
+
+} // namespace geobench
+
+GeoBenchmark::GeoBenchmark()
+{
+}
+
+GeoBenchmark::~GeoBenchmark()
+{
+}
+
+void GeoBenchmark::randomPositions(QList<Pos>& positions, int number, quint32 seed)
+{
+  // Use only generator output and no distributions since these differ between standard libraries
+  std::mt19937 generator(seed);
+  auto random = [&generator]() -> double {
+                  return static_cast<double>(generator()) / static_cast<double>(std::mt19937::max());
+                };
+
+  // Uniform on sphere between 60 S and 75 N
+  const double minSin = std::sin(toRadians(-60.)), maxSin = std::sin(toRadians(75.));
+
+  positions.clear();
+  positions.reserve(number);
+  for(int i = 0; i < number; i++)
+  {
+    double lonX = random() * 360. - 180.;
+    double latY = toDegree(std::asin(minSin + random() * (maxSin - minSin)));
+    positions.append(Pos(lonX, latY));
+  }
+}
+
+void GeoBenchmark::runCase(const QString& name, qint64 itemsPerIteration, const CaseFunctionType& func)
+{
+  if(filter.isValid() && !filter.pattern().isEmpty() && !filter.match(name).hasMatch())
+    return;
+
+  // Warm up caches and lazy initialization
+  double checksum = func();
+
+  qint64 iterations = 0L;
+  QElapsedTimer timer;
+  timer.start();
+  while(timer.elapsed() < minTimeMs || iterations == 0)
+  {
+    checksum += func();
+    iterations++;
+  }
+  qint64 elapsedNs = timer.nsecsElapsed();
+
+  double items = static_cast<double>(iterations * itemsPerIteration);
+  double nsPerItem = static_cast<double>(elapsedNs) / items;
+
+  QJsonObject benchmark;
+  benchmark.insert("name", name);
+  benchmark.insert("run_type", "iteration");
+  benchmark.insert("iterations", iterations);
+  benchmark.insert("real_time", nsPerItem);
+  benchmark.insert("time_unit", "ns");
+  benchmark.insert("items_per_second", items * 1.E9 / static_cast<double>(elapsedNs));
+  benchmark.insert("checksum", checksum / static_cast<double>(iterations + 1));
+  benchmarks.append(benchmark);
+
+  qInfo().nospace().noquote() << name << ": " << QString::number(nsPerItem, 'f', 2) << " ns, "
+                              << iterations << " iterations";
+}
+
+void GeoBenchmark::run()
+{
+  using geobench::Point;
+
+  benchmarks = QJsonArray();
+
+  QList<Pos> airports, waypoints, queries;
+  randomPositions(airports, numAirports, geobench::SEED_AIRPORTS);
+  randomPositions(waypoints, numWaypoints, geobench::SEED_WAYPOINTS);
+  randomPositions(queries, geobench::NUM_QUERIES, geobench::SEED_QUERIES);
+
+  qInfo() << Q_FUNC_INFO << "airports" << airports.size() << "waypoints" << waypoints.size();
+
+  // Pairs of neighboring waypoints in list which are random pairs on the globe
+  qint64 numPairs = waypoints.size() - 1;
+
+  // Pos kernels ================================================================
+  runCase("Pos::distanceMeterTo", numPairs, [&waypoints]() -> double {
+    double sum = 0.;
+    for(int i = 0; i < waypoints.size() - 1; i++)
+      sum += waypoints.at(i).distanceMeterTo(waypoints.at(i + 1));
+    return sum;
+  });
+
+  runCase("Pos::initialBearing", numPairs, [&waypoints]() -> double {
+    double sum = 0.;
+    for(int i = 0; i < waypoints.size() - 1; i++)
+      sum += waypoints.at(i).initialBearing(waypoints.at(i + 1));
+    return sum;
+  });
+
+  runCase("Pos::angleDegTo", numPairs, [&waypoints]() -> double {
+    double sum = 0.;
+    for(int i = 0; i < waypoints.size() - 1; i++)
+      sum += waypoints.at(i).angleDegTo(waypoints.at(i + 1));
+    return sum;
+  });
+
+  runCase("Pos::endpoint", waypoints.size(), [&waypoints]() -> double {
+    double sum = 0.;
+    for(int i = 0; i < waypoints.size(); i++)
+      sum += waypoints.at(i).endpoint(100000.f, static_cast<float>(i % 360)).getLatY();
+    return sum;
+  });
+
+  runCase("Pos::interpolate", numPairs, [&waypoints]() -> double {
+    double sum = 0.;
+    for(int i = 0; i < waypoints.size() - 1; i++)
+      sum += waypoints.at(i).interpolate(waypoints.at(i + 1), 0.3f).getLonX();
+    return sum;
+  });
+
+  // LineString ================================================================
+  // Routes built from consecutive waypoints between random airports
+  QList<LineString> routes;
+  QList<float> routeLengths;
+  for(int i = 0; i < geobench::NUM_ROUTES; i++)
+  {
+    const Pos& from = airports.at(i % airports.size());
+    const Pos& to = airports.at((i * 7 + 1) % airports.size());
+    LineString route;
+    from.interpolatePoints(to, from.distanceMeterTo(to), geobench::NUM_ROUTE_POINTS, route);
+    routes.append(route);
+    routeLengths.append(route.lengthMeter());
+  }
+
+  runCase("LineString::interpolate", geobench::NUM_ROUTES * 10, [&routes, &routeLengths]() -> double {
+    double sum = 0.;
+    for(int i = 0; i < routes.size(); i++)
+    {
+      for(int j = 0; j < 10; j++)
+        sum += routes.at(i).interpolate(routeLengths.at(i), j / 10.f).getLatY();
+    }
+    return sum;
+  });
+
+  runCase("LineString::distanceMeterToLineString", geobench::NUM_ROUTES, [&routes, &queries]() -> double {
+    double sum = 0.;
+    LineDistance result;
+    for(int i = 0; i < routes.size(); i++)
+    {
+      routes.at(i).distanceMeterToLineString(queries.at(i % queries.size()), result);
+      sum += result.distance;
+    }
+    return sum;
+  });
+
+  // Rect ================================================================
+  QList<Rect> airportRects;
+  airportRects.reserve(airports.size());
+  for(const Pos& pos : std::as_const(airports))
+    airportRects.append(Rect(pos, 5000.f, true /* fast */));
+
+  const Rect viewRect(-10.f, 60.f, 30.f, 35.f); // Europe
+  runCase("Rect::overlaps", airportRects.size(), [&airportRects, &viewRect]() -> double {
+    double sum = 0.;
+    for(const Rect& rect : airportRects)
+      sum += rect.overlaps(viewRect);
+    return sum;
+  });
+
+  runCase("Rect::contains", waypoints.size(), [&waypoints, &viewRect]() -> double {
+    double sum = 0.;
+    for(const Pos& pos : waypoints)
+      sum += viewRect.contains(pos);
+    return sum;
+  });
+
+  // SpatialIndex ================================================================
+  QList<Point> airportPoints, waypointPoints;
+  for(const Pos& pos : std::as_const(airports))
+    airportPoints.append({pos});
+  for(const Pos& pos : std::as_const(waypoints))
+    waypointPoints.append({pos});
+
+  runCase("SpatialIndex::updateIndex/airports", airportPoints.size(), [&airportPoints]() -> double {
+    SpatialIndex<Point> index;
+    index.append(airportPoints);
+    index.updateIndex();
+    return index.size();
+  });
+
+  runCase("SpatialIndex::updateIndex/waypoints", waypointPoints.size(), [&waypointPoints]() -> double {
+    SpatialIndex<Point> index;
+    index.append(waypointPoints);
+    index.updateIndex();
+    return index.size();
+  });
+
+  SpatialIndex<Point> waypointIndex;
+  waypointIndex.append(waypointPoints);
+  waypointIndex.updateIndex();
+
+  runCase("SpatialIndex::getNearestIndexes/10", queries.size(), [&waypointIndex, &queries]() -> double {
+    double sum = 0.;
+    QList<int> indexes;
+    for(const Pos& pos : queries)
+    {
+      waypointIndex.getNearestIndexes(indexes, pos, 10);
+      sum += indexes.isEmpty() ? 0 : indexes.constFirst();
+    }
+    return sum;
+  });
+
+  runCase("SpatialIndex::getRadiusIndexes/100km", queries.size(), [&waypointIndex, &queries]() -> double {
+    double sum = 0.;
+    QList<int> indexes;
+    for(const Pos& pos : queries)
+    {
+      waypointIndex.getRadiusIndexes(indexes, pos, 100000.f);
+      sum += indexes.size();
+    }
+    return sum;
+  });
+
+  runCase("SpatialIndex::getInRectIndexes", queries.size(), [&waypointIndex, &queries]() -> double {
+    double sum = 0.;
+    QList<int> indexes;
+    for(const Pos& pos : queries)
+    {
+      waypointIndex.getInRectIndexes(indexes, Rect(pos, 200000.f, true /* fast */));
+      sum += indexes.size();
+    }
+    return sum;
+  });
+
+  runCase("SpatialIndex::getRadiusIndexesBatch/100km", queries.size(), [&waypointIndex, &queries]() -> double {
+    SpatialIndexBatchResult batchResult;
+    waypointIndex.getRadiusIndexesBatch(batchResult, queries, 100000.f);
+    return batchResult.size();
+  });
+
+  QJsonObject context;
+  context.insert("date", QDateTime::currentDateTime().toString(Qt::ISODate));
+  context.insert("num_cpus", QThread::idealThreadCount());
+  context.insert("num_airports", numAirports);
+  context.insert("num_waypoints", numWaypoints);
+  context.insert("library_build_type",
+#ifdef QT_NO_DEBUG
+                 "release"
+#else
+                 "debug"
+#endif
+                 );
+
+  result = QJsonObject();
+  result.insert("context", context);
+  result.insert("benchmarks", benchmarks);
+}
+
+bool GeoBenchmark::writeResult(const QString& filename) const
+{
+  QSaveFile file(filename);
+  if(file.open(QIODevice::WriteOnly))
+  {
+    file.write(QJsonDocument(result).toJson(QJsonDocument::Indented));
+    if(file.commit())
+      return true;
+  }
+
+  qWarning() << Q_FUNC_INFO << "Cannot write" << filename << file.errorString();
+  return false;
+}
+
+} // namespace geo
+} // namespace atools
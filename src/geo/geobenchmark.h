@@ -0,0 +1,106 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_GEO_GEOBENCHMARK_H
+#define ATOOLS_GEO_GEOBENCHMARK_H
+
+#include "geo/pos.h"
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QRegularExpression>
+
+#include <functional>
+
+namespace atools {
+namespace geo {
+
+class LineString;
+
+/*
+ * Microbenchmarks for geometry kernels and the spatial index on synthetic but reproducible data sets.
+ *
+ * Data sets use a fixed random seed and default to 50000 airports and 300000 waypoints spread over the
+ * inhabited latitudes. Each case is repeated until the minimum time is reached like done by Google Benchmark and
+ * reports nanoseconds and items per second. A checksum of all results keeps the compiler from dropping work and
+ * must not change between runs.
+ *
+ * The result uses the Google Benchmark JSON layout to allow using its comparison tools.
+ */
+class GeoBenchmark
+{
+public:
+  GeoBenchmark();
+  virtual ~GeoBenchmark();
+
+  GeoBenchmark(const GeoBenchmark& other) = delete;
+  GeoBenchmark& operator=(const GeoBenchmark& other) = delete;
+
+  /* Create data sets and run all cases matching the filter */
+  void run();
+
+  /* Results of last run() */
+  const QJsonObject& getResult() const
+  {
+    return result;
+  }
+
+  /* Write indented JSON. Returns false on error. */
+  bool writeResult(const QString& filename) const;
+
+  void setNumAirports(int value)
+  {
+    numAirports = value;
+  }
+
+  void setNumWaypoints(int value)
+  {
+    numWaypoints = value;
+  }
+
+  /* Minimum time for each case. Default is 500 ms. */
+  void setMinTimeMs(int value)
+  {
+    minTimeMs = value;
+  }
+
+  /* Run only cases with names matching the expression */
+  void setFilter(const QRegularExpression& value)
+  {
+    filter = value;
+  }
+
+private:
+  /* Function runs one iteration and returns a checksum */
+  typedef std::function<double ()> CaseFunctionType;
+
+  /* Run function repeatedly and add an entry to benchmarks. itemsPerIteration is the number of kernel calls. */
+  void runCase(const QString& name, qint64 itemsPerIteration, const CaseFunctionType& func);
+
+  /* Random positions which are uniformly distributed on the sphere between latitudes */
+  static void randomPositions(QList<atools::geo::Pos>& positions, int number, quint32 seed);
+
+  int numAirports = 50000, numWaypoints = 300000, minTimeMs = 500;
+  QRegularExpression filter;
+  QJsonArray benchmarks;
+  QJsonObject result;
+};
+
+} // namespace geo
+} // namespace atools
+
+#endif // ATOOLS_GEO_GEOBENCHMARK_H
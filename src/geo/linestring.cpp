@@ -22,6 +22,9 @@
 
 #include <QDataStream>
 #include <cmath>
+#include <limits>
+#include <queue>
+#include <tuple>
 
 namespace atools {
 namespace geo {
@@ -419,6 +422,266 @@ QDataStream& operator<<(QDataStream& out, const LineString& obj)
   return out;
 }
 
+/* Unit vector on the sphere used for simplification */
+struct UnitVector
+{
+  double x, y, z;
+};
+
+inline UnitVector toUnitVector(const Pos& pos)
+{
+  double lon = toRadians(static_cast<double>(pos.getLonX())), lat = toRadians(static_cast<double>(pos.getLatY()));
+  return {std::cos(lat) * std::cos(lon), std::cos(lat) * std::sin(lon), std::sin(lat)};
+}
+
+inline UnitVector unitCross(const UnitVector& a, const UnitVector& b)
+{
+  return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+
+inline double unitDot(const UnitVector& a, const UnitVector& b)
+{
+  return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+inline double unitLength(const UnitVector& a)
+{
+  return std::sqrt(unitDot(a, a));
+}
+
+/* Great circle distance in radians between two unit vectors */
+inline double angleRad(const UnitVector& a, const UnitVector& b)
+{
+  return 2. * std::asin(std::min(unitLength({b.x - a.x, b.y - a.y, b.z - a.z}) / 2., 1.));
+}
+
+/* Distance in radians from p to the great circle segment from a to b having the normal n of length nLen */
+inline double segmentDistanceRad(const UnitVector& p, const UnitVector& a, const UnitVector& b,
+                                 const UnitVector& n, double nLen)
+{
+  // Degenerated segment
+  if(nLen < 1.E-12)
+    return angleRad(p, a);
+
+  // Nearest point is start or end if p is outside of the planes through a and b perpendicular to the segment
+  if(unitDot(unitCross(a, p), n) < 0.)
+    return angleRad(p, a);
+  if(unitDot(unitCross(p, b), n) < 0.)
+    return angleRad(p, b);
+
+  // Cross track distance
+  return std::abs(std::asin(std::max(-1., std::min(unitDot(p, n) / nLen, 1.))));
+}
+
+const LineString LineString::simplifiedDouglasPeucker(float toleranceMeter) const
+{
+  if(size() < 3)
+    return *this;
+
+  QList<UnitVector> vectors;
+  vectors.reserve(size());
+  for(const Pos& pos : *this)
+    vectors.append(toUnitVector(pos));
+
+  QList<bool> keep(size(), false);
+  keep[0] = keep[size() - 1] = true;
+  double toleranceRad = static_cast<double>(toleranceMeter) / Pos::EARTH_RADIUS_METER_DOUBLE;
+
+  // Iterative to avoid recursion depth problems for large tracks
+  QList<std::pair<int, int> > stack;
+  stack.append(std::make_pair(0, static_cast<int>(size()) - 1));
+  while(!stack.isEmpty())
+  {
+    std::pair<int, int> range = stack.takeLast();
+    const UnitVector& a = vectors.at(range.first), & b = vectors.at(range.second);
+    UnitVector n = unitCross(a, b);
+    double nLen = unitLength(n);
+
+    double maxDist = -1.;
+    int maxIndex = -1;
+    for(int i = range.first + 1; i < range.second; i++)
+    {
+      double dist = segmentDistanceRad(vectors.at(i), a, b, n, nLen);
+      if(dist > maxDist)
+      {
+        maxDist = dist;
+        maxIndex = i;
+      }
+    }
+
+    if(maxIndex != -1 && maxDist > toleranceRad)
+    {
+      keep[maxIndex] = true;
+      stack.append(std::make_pair(range.first, maxIndex));
+      stack.append(std::make_pair(maxIndex, range.second));
+    }
+  }
+
+  LineString line;
+  for(int i = 0; i < size(); i++)
+  {
+    if(keep.at(i))
+      line.append(at(i));
+  }
+  return line;
+}
+
+const LineString LineString::simplifiedVisvalingam(float minAreaSqMeter) const
+{
+  if(size() < 3)
+    return *this;
+
+  int num = static_cast<int>(size());
+  QList<UnitVector> vectors;
+  vectors.reserve(num);
+  for(const Pos& pos : *this)
+    vectors.append(toUnitVector(pos));
+
+  // Doubly linked list of remaining points
+  QList<int> prev(num), next(num), version(num, 0);
+  for(int i = 0; i < num; i++)
+  {
+    prev[i] = i - 1;
+    next[i] = i + 1;
+  }
+
+  // Area of triangle spanned by the chords scaled to square meter
+  double scale = Pos::EARTH_RADIUS_METER_DOUBLE * Pos::EARTH_RADIUS_METER_DOUBLE / 2.;
+  auto area = [&vectors, &prev, &next, scale](int i) -> double {
+                const UnitVector& a = vectors.at(prev.at(i)), & b = vectors.at(i), & c = vectors.at(next.at(i));
+                UnitVector ab = {b.x - a.x, b.y - a.y, b.z - a.z}, ac = {c.x - a.x, c.y - a.y, c.z - a.z};
+                return unitLength(unitCross(ab, ac)) * scale;
+              };
+
+  // Area, index and version - lazy removal of outdated entries
+  typedef std::tuple<double, int, int> Entry;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > queue;
+  for(int i = 1; i < num - 1; i++)
+    queue.push(Entry(area(i), i, 0));
+
+  QList<bool> keep(num, true);
+  double minArea = static_cast<double>(minAreaSqMeter);
+  while(!queue.empty())
+  {
+    Entry entry = queue.top();
+    if(std::get<0>(entry) >= minArea)
+      break;
+
+    queue.pop();
+    int idx = std::get<1>(entry);
+    if(!keep.at(idx) || std::get<2>(entry) != version.at(idx))
+      continue;
+
+    // Unlink point
+    keep[idx] = false;
+    int p = prev.at(idx), n = next.at(idx);
+    next[p] = n;
+    prev[n] = p;
+
+    // Update neighbors - area never gets smaller than the one of the removed point
+    if(p > 0)
+      queue.push(Entry(std::max(area(p), std::get<0>(entry)), p, ++version[p]));
+    if(n < num - 1)
+      queue.push(Entry(std::max(area(n), std::get<0>(entry)), n, ++version[n]));
+  }
+
+  LineString line;
+  for(int i = 0; i < num; i++)
+  {
+    if(keep.at(i))
+      line.append(at(i));
+  }
+  return line;
+}
+
+QList<int> LineString::triangulated() const
+{
+  QList<int> triangles;
+
+  // Ignore closing point
+  int num = static_cast<int>(size());
+  if(num > 1 && constFirst() == constLast())
+    num--;
+
+  if(num < 3)
+    return triangles;
+
+  // Project into plane - polygons are small enough to ignore distortion
+  double cosLat = std::cos(toRadians(static_cast<double>(constFirst().getLatY())));
+  QList<double> xs, ys;
+  for(int i = 0; i < num; i++)
+  {
+    xs.append(static_cast<double>(at(i).getLonX()) * cosLat);
+    ys.append(static_cast<double>(at(i).getLatY()));
+  }
+
+  // Cross product of ab and ac - positive if c is left of ab
+  auto cross = [&xs, &ys](int a, int b, int c) -> double {
+                 return (xs.at(b) - xs.at(a)) * (ys.at(c) - ys.at(a)) - (ys.at(b) - ys.at(a)) * (xs.at(c) - xs.at(a));
+               };
+
+  // Get winding order from signed area
+  double area = 0.;
+  for(int i = 0, j = num - 1; i < num; j = i++)
+    area += xs.at(j) * ys.at(i) - xs.at(i) * ys.at(j);
+  double sign = area > 0. ? 1. : -1.;
+
+  QList<int> remaining;
+  for(int i = 0; i < num; i++)
+    remaining.append(i);
+
+  int pos = 0, failed = 0;
+  while(remaining.size() > 3)
+  {
+    int n = static_cast<int>(remaining.size());
+    if(failed >= n)
+      // Self intersecting or otherwise broken polygon
+      return QList<int>();
+
+    int prev = remaining.at((pos + n - 1) % n), cur = remaining.at(pos), next = remaining.at((pos + 1) % n);
+    double c = cross(prev, cur, next) * sign;
+
+    bool remove = false;
+    if(std::abs(c) < std::numeric_limits<double>::epsilon())
+      // Collinear - drop point without adding a triangle
+      remove = true;
+    else if(c > 0.)
+    {
+      // Convex corner - ear if no other point is inside or on triangle
+      remove = true;
+      for(int idx : std::as_const(remaining))
+      {
+        if(idx != prev && idx != cur && idx != next &&
+           cross(prev, cur, idx) * sign >= 0. && cross(cur, next, idx) * sign >= 0. && cross(next, prev, idx) * sign >= 0.)
+        {
+          remove = false;
+          break;
+        }
+      }
+
+      if(remove)
+        triangles << prev << cur << next;
+    }
+
+    if(remove)
+    {
+      remaining.removeAt(pos);
+      pos = pos % static_cast<int>(remaining.size());
+      failed = 0;
+    }
+    else
+    {
+      pos = (pos + 1) % n;
+      failed++;
+    }
+  }
+
+  if(std::abs(cross(remaining.at(0), remaining.at(1), remaining.at(2))) >= std::numeric_limits<double>::epsilon())
+    triangles << remaining.at(0) << remaining.at(1) << remaining.at(2);
+
+  return triangles;
+}
+
 QDataStream& operator>>(QDataStream& in, LineString& obj)
 {
   quint32 size;
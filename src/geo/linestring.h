@@ -220,6 +220,20 @@ public:
   /* Course from last to second last point or INVALID_VALUE if isPoint() == true */
   float getEndCourse() const;
 
+  /* Simplify using Douglas-Peucker with cross track distance to great circle segments.
+   * toleranceMeter is the maximum distance of removed points to the simplified line.
+   * First and last point are always kept. Invalid points have to be removed before. */
+  const atools::geo::LineString simplifiedDouglasPeucker(float toleranceMeter) const;
+
+  /* Simplify using Visvalingam-Whyatt by removing points with the smallest triangle area
+   * until all remaining triangles are larger than minAreaSqMeter. */
+  const atools::geo::LineString simplifiedVisvalingam(float minAreaSqMeter) const;
+
+  /* Triangulate the polygon described by this line using ear clipping in a plane with longitude scaled by latitude.
+   * Line can be closed or open and in any winding order. Holes and self intersections are not supported.
+   * Returns three vertex indexes per triangle or an empty list if triangulation failed. */
+  QList<int> triangulated() const;
+
 private:
   friend QDebug operator<<(QDebug out, const atools::geo::LineString& record);
   friend QDataStream& operator<<(QDataStream& out, const atools::geo::LineString& obj);
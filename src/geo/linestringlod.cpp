@@ -0,0 +1,113 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "geo/linestringlod.h"
+
+#include <QMutexLocker>
+
+#include <cmath>
+
+namespace atools {
+namespace geo {
+
+LineStringLod::LineStringLod(const LineString& line, float baseToleranceMeterParam, int numLevelsParam)
+  : original(line), baseToleranceMeter(baseToleranceMeterParam), numLevels(std::max(numLevelsParam, 1))
+{
+  levels.resize(numLevels);
+  levelsValid.fill(false, numLevels);
+}
+
+float LineStringLod::getToleranceMeter(int level) const
+{
+  return baseToleranceMeter * static_cast<float>(1 << level);
+}
+
+const LineString& LineStringLod::getLineString(float toleranceMeter) const
+{
+  if(numLevels == 0 || toleranceMeter < baseToleranceMeter || original.size() < 3)
+    return original;
+
+  // Largest level with tolerance below or equal to requested one
+  int level = static_cast<int>(std::floor(std::log2(toleranceMeter / baseToleranceMeter)));
+  return getLevel(std::min(level, numLevels - 1));
+}
+
+const LineString& LineStringLod::getLevel(int level) const
+{
+  if(level < 0 || level >= numLevels)
+    return original;
+
+  QMutexLocker locker(&mutex);
+  if(!levelsValid.at(level))
+  {
+    // Simplify from original to avoid accumulated errors
+    levels[level] = original.simplifiedDouglasPeucker(getToleranceMeter(level));
+    levelsValid[level] = true;
+  }
+  return levels.at(level);
+}
+
+int LineStringLod::getNumPoints() const
+{
+  QMutexLocker locker(&mutex);
+  int num = static_cast<int>(original.size());
+  for(const LineString& line : std::as_const(levels))
+    num += static_cast<int>(line.size());
+  return num;
+}
+
+// ===================================================================================
+LineStringLodCache::LineStringLodCache(int maxPoints, float baseToleranceMeterParam)
+  : cache(maxPoints), baseToleranceMeter(baseToleranceMeterParam)
+{
+}
+
+LineString LineStringLodCache::getLineString(qint64 id, float toleranceMeter) const
+{
+  QMutexLocker locker(&mutex);
+  const LineStringLod *lod = cache.object(id);
+  return lod != nullptr ? lod->getLineString(toleranceMeter) : LineString();
+}
+
+void LineStringLodCache::insert(qint64 id, const LineString& line)
+{
+  QMutexLocker locker(&mutex);
+
+  // Cost is twice the original size to account for the simplified levels
+  cache.insert(id, new LineStringLod(line, baseToleranceMeter), std::max(static_cast<int>(line.size()) * 2, 1));
+}
+
+bool LineStringLodCache::contains(qint64 id) const
+{
+  QMutexLocker locker(&mutex);
+  return cache.contains(id);
+}
+
+void LineStringLodCache::remove(qint64 id)
+{
+  QMutexLocker locker(&mutex);
+  cache.remove(id);
+}
+
+void LineStringLodCache::clear()
+{
+  QMutexLocker locker(&mutex);
+  cache.clear();
+}
+
+} // namespace geo
+} // namespace atools
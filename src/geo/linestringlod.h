@@ -0,0 +1,116 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_GEO_LINESTRINGLOD_H
+#define ATOOLS_GEO_LINESTRINGLOD_H
+
+#include "geo/linestring.h"
+
+#include <QCache>
+#include <QMutex>
+
+namespace atools {
+namespace geo {
+
+/*
+ * Level of detail pyramid for a line string. Level n is simplified using Douglas-Peucker with a tolerance of
+ * baseToleranceMeter * 2^n. Levels are calculated on first access from the original line.
+ *
+ * Thread safe.
+ */
+class LineStringLod
+{
+public:
+  LineStringLod()
+  {
+  }
+
+  explicit LineStringLod(const atools::geo::LineString& line, float baseToleranceMeterParam = 10.f,
+                         int numLevelsParam = 16);
+
+  LineStringLod(const LineStringLod& other) = delete;
+  LineStringLod& operator=(const LineStringLod& other) = delete;
+
+  /* Get the most simplified line having a tolerance equal or below toleranceMeter.
+   * Returns the original line if toleranceMeter is below the base tolerance. */
+  const atools::geo::LineString& getLineString(float toleranceMeter) const;
+
+  /* Get line for a level 0 to getNumLevels() - 1 */
+  const atools::geo::LineString& getLevel(int level) const;
+
+  const atools::geo::LineString& getOriginal() const
+  {
+    return original;
+  }
+
+  int getNumLevels() const
+  {
+    return numLevels;
+  }
+
+  /* Tolerance for level */
+  float getToleranceMeter(int level) const;
+
+  /* Number of points in original and all calculated levels */
+  int getNumPoints() const;
+
+private:
+  atools::geo::LineString original;
+  float baseToleranceMeter = 10.f;
+  int numLevels = 0;
+
+  /* Calculated levels. Index is level. */
+  mutable QList<atools::geo::LineString> levels;
+  mutable QList<bool> levelsValid;
+  mutable QMutex mutex;
+};
+
+/*
+ * Cache for level of detail pyramids keyed by an id like airspace or logbook id.
+ * Least recently used pyramids are removed if the number of original points exceeds maxPoints.
+ *
+ * Thread safe.
+ */
+class LineStringLodCache
+{
+public:
+  explicit LineStringLodCache(int maxPoints = 10000000, float baseToleranceMeterParam = 10.f);
+
+  LineStringLodCache(const LineStringLodCache& other) = delete;
+  LineStringLodCache& operator=(const LineStringLodCache& other) = delete;
+
+  /* Get simplified line string for id and tolerance from cache.
+   * Returns an empty line if id is not in cache. */
+  atools::geo::LineString getLineString(qint64 id, float toleranceMeter) const;
+
+  /* Adds line to cache replacing any previous entry for the id */
+  void insert(qint64 id, const atools::geo::LineString& line);
+
+  bool contains(qint64 id) const;
+  void remove(qint64 id);
+  void clear();
+
+private:
+  mutable QCache<qint64, LineStringLod> cache;
+  float baseToleranceMeter;
+  mutable QMutex mutex;
+};
+
+} // namespace geo
+} // namespace atools
+
+#endif // ATOOLS_GEO_LINESTRINGLOD_H
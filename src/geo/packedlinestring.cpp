@@ -0,0 +1,166 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "geo/packedlinestring.h"
+
+#include "geo/batchcalculations.h"
+#include "geo/calculations.h"
+#include "geo/linestring.h"
+
+namespace atools {
+namespace geo {
+
+PackedLineString::PackedLineString(const LineString& line, bool quantizedParam)
+{
+  fromLineString(line);
+  setQuantized(quantizedParam);
+}
+
+void PackedLineString::clear()
+{
+  lonX.clear();
+  latY.clear();
+  alt.clear();
+  lonXInt.clear();
+  latYInt.clear();
+}
+
+void PackedLineString::reserve(int size)
+{
+  if(quantized)
+  {
+    lonXInt.reserve(size);
+    latYInt.reserve(size);
+  }
+  else
+  {
+    lonX.reserve(size);
+    latY.reserve(size);
+  }
+}
+
+void PackedLineString::append(float lonXParam, float latYParam, float altParam)
+{
+  if(altParam != 0.f && alt.isEmpty())
+    // Create missing altitude values for previous positions
+    alt.fill(0.f, size());
+
+  if(quantized)
+  {
+    lonXInt.append(static_cast<qint32>(std::round(lonXParam * TO_QUANTIZED)));
+    latYInt.append(static_cast<qint32>(std::round(latYParam * TO_QUANTIZED)));
+  }
+  else
+  {
+    lonX.append(lonXParam);
+    latY.append(latYParam);
+  }
+
+  if(!alt.isEmpty())
+    alt.append(altParam);
+}
+
+void PackedLineString::setQuantized(bool value)
+{
+  if(value == quantized)
+    return;
+
+  if(value)
+  {
+    lonXInt.resize(lonX.size());
+    latYInt.resize(latY.size());
+    for(int i = 0; i < lonX.size(); i++)
+    {
+      lonXInt[i] = static_cast<qint32>(std::round(lonX.at(i) * TO_QUANTIZED));
+      latYInt[i] = static_cast<qint32>(std::round(latY.at(i) * TO_QUANTIZED));
+    }
+    lonX.clear();
+    latY.clear();
+  }
+  else
+  {
+    lonX.resize(lonXInt.size());
+    latY.resize(latYInt.size());
+    for(int i = 0; i < lonXInt.size(); i++)
+    {
+      lonX[i] = static_cast<float>(lonXInt.at(i) * FROM_QUANTIZED);
+      latY[i] = static_cast<float>(latYInt.at(i) * FROM_QUANTIZED);
+    }
+    lonXInt.clear();
+    latYInt.clear();
+  }
+  quantized = value;
+}
+
+void PackedLineString::resizeFloat(int size)
+{
+  alt.clear();
+  lonXInt.clear();
+  latYInt.clear();
+  quantized = false;
+  lonX.resize(size);
+  latY.resize(size);
+}
+
+LineString PackedLineString::toLineString() const
+{
+  LineString line;
+  line.reserve(size());
+  for(int i = 0; i < size(); i++)
+    line.append(at(i));
+  return line;
+}
+
+void PackedLineString::fromLineString(const LineString& line)
+{
+  clear();
+  reserve(static_cast<int>(line.size()));
+  for(const Pos& pos : line)
+    append(pos);
+}
+
+float PackedLineString::lengthMeter() const
+{
+  if(size() < 2)
+    return 0.f;
+
+  if(quantized)
+  {
+    PackedLineString copy(*this);
+    copy.setQuantized(false);
+    return copy.lengthMeter();
+  }
+  else
+    return static_cast<float>(lengthMeterBatch(lonX.constData(), latY.constData(), size()));
+}
+
+Rect PackedLineString::boundingRect() const
+{
+  if(!isValid())
+    return Rect();
+
+  return atools::geo::bounding(toLineString());
+}
+
+qint64 PackedLineString::memorySize() const
+{
+  return static_cast<qint64>(sizeof(float)) * (lonX.capacity() + latY.capacity() + alt.capacity()) +
+         static_cast<qint64>(sizeof(qint32)) * (lonXInt.capacity() + latYInt.capacity());
+}
+
+} // namespace geo
+} // namespace atools
@@ -0,0 +1,306 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_GEO_PACKEDLINESTRING_H
+#define ATOOLS_GEO_PACKEDLINESTRING_H
+
+#include "geo/pos.h"
+
+#include <QList>
+
+#include <iterator>
+
+namespace atools {
+namespace geo {
+
+class LineString;
+class Rect;
+
+/*
+ * Compact line string for large geometries like airspace boundaries or tracks keeping longitude, latitude and
+ * altitude in separate arrays. Altitude is optional and not stored if all values are zero.
+ *
+ * Coordinates can be quantized to 32 bit integers with a resolution of 1E-7 degree (about 1 cm)
+ * which allows smaller deltas when compressing or storing. Quantized values are converted when accessing.
+ *
+ * Positions are returned by value. The iterators allow to use std algorithms and range based for loops
+ * like for LineString.
+ */
+class PackedLineString
+{
+public:
+  PackedLineString()
+  {
+  }
+
+  explicit PackedLineString(const atools::geo::LineString& line, bool quantizedParam = false);
+
+  /* Random access iterator returning positions by value */
+  class const_iterator
+  {
+public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef atools::geo::Pos value_type;
+    typedef int difference_type;
+    typedef const atools::geo::Pos *pointer;
+    typedef atools::geo::Pos reference;
+
+    const_iterator()
+    {
+    }
+
+    const_iterator(const PackedLineString *lineParam, int indexParam)
+      : line(lineParam), index(indexParam)
+    {
+    }
+
+    atools::geo::Pos operator*() const
+    {
+      return line->at(index);
+    }
+
+    atools::geo::Pos operator[](int offset) const
+    {
+      return line->at(index + offset);
+    }
+
+    const_iterator& operator++()
+    {
+      index++;
+      return *this;
+    }
+
+    const_iterator operator++(int)
+    {
+      return const_iterator(line, index++);
+    }
+
+    const_iterator& operator--()
+    {
+      index--;
+      return *this;
+    }
+
+    const_iterator operator--(int)
+    {
+      return const_iterator(line, index--);
+    }
+
+    const_iterator& operator+=(int offset)
+    {
+      index += offset;
+      return *this;
+    }
+
+    const_iterator& operator-=(int offset)
+    {
+      index -= offset;
+      return *this;
+    }
+
+    const_iterator operator+(int offset) const
+    {
+      return const_iterator(line, index + offset);
+    }
+
+    const_iterator operator-(int offset) const
+    {
+      return const_iterator(line, index - offset);
+    }
+
+    int operator-(const const_iterator& other) const
+    {
+      return index - other.index;
+    }
+
+    bool operator==(const const_iterator& other) const
+    {
+      return index == other.index && line == other.line;
+    }
+
+    bool operator!=(const const_iterator& other) const
+    {
+      return !(*this == other);
+    }
+
+    bool operator<(const const_iterator& other) const
+    {
+      return index < other.index;
+    }
+
+    bool operator>(const const_iterator& other) const
+    {
+      return index > other.index;
+    }
+
+    bool operator<=(const const_iterator& other) const
+    {
+      return index <= other.index;
+    }
+
+    bool operator>=(const const_iterator& other) const
+    {
+      return index >= other.index;
+    }
+
+private:
+    const PackedLineString *line = nullptr;
+    int index = 0;
+  };
+
+  const_iterator begin() const
+  {
+    return const_iterator(this, 0);
+  }
+
+  const_iterator end() const
+  {
+    return const_iterator(this, size());
+  }
+
+  int size() const
+  {
+    return static_cast<int>(quantized ? lonXInt.size() : lonX.size());
+  }
+
+  bool isEmpty() const
+  {
+    return size() == 0;
+  }
+
+  bool isValid() const
+  {
+    return !isEmpty();
+  }
+
+  bool isQuantized() const
+  {
+    return quantized;
+  }
+
+  bool hasAltitude() const
+  {
+    return !alt.isEmpty();
+  }
+
+  float getLonX(int index) const
+  {
+    return quantized ? static_cast<float>(lonXInt.at(index) * FROM_QUANTIZED) : lonX.at(index);
+  }
+
+  float getLatY(int index) const
+  {
+    return quantized ? static_cast<float>(latYInt.at(index) * FROM_QUANTIZED) : latY.at(index);
+  }
+
+  float getAltitude(int index) const
+  {
+    return alt.isEmpty() ? 0.f : alt.at(index);
+  }
+
+  atools::geo::Pos at(int index) const
+  {
+    return atools::geo::Pos(getLonX(index), getLatY(index), getAltitude(index));
+  }
+
+  atools::geo::Pos constFirst() const
+  {
+    return at(0);
+  }
+
+  atools::geo::Pos constLast() const
+  {
+    return at(size() - 1);
+  }
+
+  void clear();
+  void reserve(int size);
+
+  /* Add position. Altitude array is only created when the first non zero altitude is added. */
+  void append(float lonXParam, float latYParam, float altParam = 0.f);
+
+  void append(const atools::geo::Pos& pos)
+  {
+    append(pos.getLonX(), pos.getLatY(), pos.getAltitude());
+  }
+
+  /* Convert between float and quantized integer storage */
+  void setQuantized(bool value);
+
+  /* Float coordinate arrays for the batch functions in batchcalculations.h. Empty if quantized. */
+  const QList<float>& getLonXArray() const
+  {
+    return lonX;
+  }
+
+  const QList<float>& getLatYArray() const
+  {
+    return latY;
+  }
+
+  /* Quantized coordinate arrays. Empty if not quantized. */
+  const QList<qint32>& getLonXQuantized() const
+  {
+    return lonXInt;
+  }
+
+  const QList<qint32>& getLatYQuantized() const
+  {
+    return latYInt;
+  }
+
+  /* Resize float coordinate arrays and clear altitude and quantized values.
+   * Used by readers which decode directly into lonXData() and latYData() without creating positions. */
+  void resizeFloat(int size);
+
+  float *lonXData()
+  {
+    return lonX.data();
+  }
+
+  float *latYData()
+  {
+    return latY.data();
+  }
+
+  /* Convert to and from the regular line string */
+  atools::geo::LineString toLineString() const;
+  void fromLineString(const atools::geo::LineString& line);
+
+  /* Length in meter of all segments */
+  float lengthMeter() const;
+
+  /* Calculate bounding rectangle of all positions considering date boundary. Expensive. */
+  atools::geo::Rect boundingRect() const;
+
+  /* Approximate memory used by the arrays in bytes */
+  qint64 memorySize() const;
+
+  /* Resolution of quantized integers */
+  constexpr static double TO_QUANTIZED = 1.E7;
+  constexpr static double FROM_QUANTIZED = 1.E-7;
+
+private:
+  QList<float> lonX, latY, alt;
+  QList<qint32> lonXInt, latYInt;
+  bool quantized = false;
+};
+
+} // namespace geo
+} // namespace atools
+
+#endif // ATOOLS_GEO_PACKEDLINESTRING_H
@@ -99,6 +99,24 @@ public:
     return RADIUS2 * std::asin(std::min(1.f, std::sqrt(comparableDistance(p1, p2)) * INV_RADIUS2));
   }
 
+  /* Converts a great circle distance in meter to a value comparable with comparableDistance() which is the
+   * squared chord length. Allows to check many points against a radius without trigonometric functions. */
+  static float comparableDistanceForMeter(float gcDistanceMeter)
+  {
+    if(gcDistanceMeter >= RADIUS2 * static_cast<float>(M_PI_2))
+      // Covers the whole sphere
+      return RADIUS2 * RADIUS2;
+
+    float chord = RADIUS2 * std::sin(gcDistanceMeter / RADIUS2);
+    return chord * chord;
+  }
+
+  /* true if p2 is inside a great circle distance given by comparableDistanceForMeter() */
+  bool isWithinComparableDistance(const Point3D& p2, float comparableDist) const
+  {
+    return comparableDistance(p2) <= comparableDist;
+  }
+
   float getX() const
   {
     return x;
@@ -0,0 +1,323 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "geo/preparedpolygon.h"
+
+#include "geo/calculations.h"
+#include "geo/linestring.h"
+#include "geo/packedlinestring.h"
+#include "geo/pos.h"
+#include "geo/rect.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace atools {
+namespace geo {
+
+/* Maximum number of latitude bands */
+const static int MAX_BANDS = 1024;
+
+/* Average number of edges per band */
+const static int EDGES_PER_BAND = 4;
+
+/* Orientation of c relative to line a to b. Positive if left. */
+inline float orientation(float ax, float ay, float bx, float by, float cx, float cy)
+{
+  return (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+}
+
+/* true if segments a-b and c-d touch or cross */
+inline bool segmentsIntersect(float ax, float ay, float bx, float by, float cx, float cy, float dx, float dy)
+{
+  // Bounding boxes have to overlap - also needed for collinear segments
+  if(std::max(ax, bx) < std::min(cx, dx) || std::max(cx, dx) < std::min(ax, bx) ||
+     std::max(ay, by) < std::min(cy, dy) || std::max(cy, dy) < std::min(ay, by))
+    return false;
+
+  return orientation(cx, cy, dx, dy, ax, ay) * orientation(cx, cy, dx, dy, bx, by) <= 0.f &&
+         orientation(ax, ay, bx, by, cx, cy) * orientation(ax, ay, bx, by, dx, dy) <= 0.f;
+}
+
+PreparedPolygon::PreparedPolygon(const LineString& polygon)
+{
+  QList<float> lonX, latY;
+  lonX.reserve(polygon.size());
+  latY.reserve(polygon.size());
+  for(const Pos& pos : polygon)
+  {
+    if(pos.isValid())
+    {
+      lonX.append(pos.getLonX());
+      latY.append(pos.getLatY());
+    }
+  }
+  build(static_cast<int>(lonX.size()), lonX.constData(), latY.constData());
+}
+
+PreparedPolygon::PreparedPolygon(const PackedLineString& polygon)
+{
+  QList<float> lonX, latY;
+  lonX.reserve(polygon.size());
+  latY.reserve(polygon.size());
+  for(int i = 0; i < polygon.size(); i++)
+  {
+    lonX.append(polygon.getLonX(i));
+    latY.append(polygon.getLatY(i));
+  }
+  build(static_cast<int>(lonX.size()), lonX.constData(), latY.constData());
+}
+
+void PreparedPolygon::build(int numPoints, const float *lonX, const float *latY)
+{
+  // Remove closing point
+  if(numPoints > 1 && lonX[0] == lonX[numPoints - 1] && latY[0] == latY[numPoints - 1])
+    numPoints--;
+
+  if(numPoints < 3)
+    return;
+
+  for(int i = 0; i < numPoints && !shiftLon; i++)
+    shiftLon = atools::geo::crossesAntiMeridian(lonX[i], lonX[(i + 1) % numPoints]);
+
+  // Edges and bounding rectangle ======================
+  x1.resize(numPoints);
+  y1.resize(numPoints);
+  x2.resize(numPoints);
+  y2.resize(numPoints);
+  minLon = minLat = std::numeric_limits<float>::max();
+  maxLon = maxLat = std::numeric_limits<float>::lowest();
+
+  for(int i = 0; i < numPoints; i++)
+  {
+    int next = (i + 1) % numPoints;
+    x1[i] = adjustLon(lonX[i]);
+    y1[i] = latY[i];
+    x2[i] = adjustLon(lonX[next]);
+    y2[i] = latY[next];
+
+    minLon = std::min(minLon, x1.at(i));
+    maxLon = std::max(maxLon, x1.at(i));
+    minLat = std::min(minLat, y1.at(i));
+    maxLat = std::max(maxLat, y1.at(i));
+  }
+
+  // Sort edges into latitude bands ======================
+  numBands = std::max(1, std::min(numPoints / EDGES_PER_BAND, MAX_BANDS));
+  bandHeight = (maxLat - minLat) / numBands;
+  if(!(bandHeight > 0.f))
+    bandHeight = 1.f;
+
+  // Count edges per band
+  bandOffsets.fill(0, numBands + 1);
+  for(int i = 0; i < numPoints; i++)
+  {
+    for(int band = bandIndex(std::min(y1.at(i), y2.at(i))); band <= bandIndex(std::max(y1.at(i), y2.at(i))); band++)
+      bandOffsets[band + 1]++;
+  }
+
+  for(int band = 0; band < numBands; band++)
+    bandOffsets[band + 1] += bandOffsets.at(band);
+
+  // Fill edge indexes
+  bandEdges.resize(bandOffsets.constLast());
+  QList<int> fill = bandOffsets.mid(0, numBands);
+  for(int i = 0; i < numPoints; i++)
+  {
+    for(int band = bandIndex(std::min(y1.at(i), y2.at(i))); band <= bandIndex(std::max(y1.at(i), y2.at(i))); band++)
+      bandEdges[fill[band]++] = i;
+  }
+}
+
+int PreparedPolygon::bandIndex(float latY) const
+{
+  return std::max(0, std::min(static_cast<int>((latY - minLat) / bandHeight), numBands - 1));
+}
+
+Rect PreparedPolygon::getBoundingRect() const
+{
+  if(!isValid())
+    return Rect();
+
+  return Rect(minLon > 180.f ? minLon - 360.f : minLon, maxLat, maxLon > 180.f ? maxLon - 360.f : maxLon, minLat);
+}
+
+bool PreparedPolygon::contains(const Pos& pos) const
+{
+  return pos.isValid() && contains(pos.getLonX(), pos.getLatY());
+}
+
+bool PreparedPolygon::contains(float lonX, float latY) const
+{
+  return containsAdjusted(adjustLon(lonX), latY);
+}
+
+bool PreparedPolygon::containsAdjusted(float x, float y) const
+{
+  if(!isValid() || x < minLon || x > maxLon || y < minLat || y > maxLat)
+    return false;
+
+  // Crossing number test for all edges crossing the horizontal line at y which are all in the same band
+  int band = bandIndex(y);
+  bool inside = false;
+  for(int i = bandOffsets.at(band); i < bandOffsets.at(band + 1); i++)
+  {
+    int edge = bandEdges.at(i);
+    float ey1 = y1.at(edge), ey2 = y2.at(edge);
+    if((ey1 > y) != (ey2 > y) && x < (x2.at(edge) - x1.at(edge)) * (y - ey1) / (ey2 - ey1) + x1.at(edge))
+      inside = !inside;
+  }
+  return inside;
+}
+
+bool PreparedPolygon::intersectsEdges(float ax, float ay, float bx, float by) const
+{
+  int lastBand = bandIndex(std::max(ay, by));
+  for(int band = bandIndex(std::min(ay, by)); band <= lastBand; band++)
+  {
+    for(int i = bandOffsets.at(band); i < bandOffsets.at(band + 1); i++)
+    {
+      int edge = bandEdges.at(i);
+      if(segmentsIntersect(ax, ay, bx, by, x1.at(edge), y1.at(edge), x2.at(edge), y2.at(edge)))
+        return true;
+    }
+  }
+  return false;
+}
+
+bool PreparedPolygon::intersectsRectPart(float west, float south, float east, float north) const
+{
+  if(east < minLon || west > maxLon || north < minLat || south > maxLat)
+    return false;
+
+  // Rectangle inside polygon or polygon vertex inside rectangle
+  if(containsAdjusted((west + east) / 2.f, (north + south) / 2.f))
+    return true;
+
+  int lastBand = bandIndex(north);
+  for(int band = bandIndex(south); band <= lastBand; band++)
+  {
+    for(int i = bandOffsets.at(band); i < bandOffsets.at(band + 1); i++)
+    {
+      int edge = bandEdges.at(i);
+      if(x1.at(edge) >= west && x1.at(edge) <= east && y1.at(edge) >= south && y1.at(edge) <= north)
+        return true;
+    }
+  }
+
+  // Edges crossing rectangle borders
+  return intersectsEdges(west, south, east, south) || intersectsEdges(west, north, east, north) ||
+         intersectsEdges(west, south, west, north) || intersectsEdges(east, south, east, north);
+}
+
+bool PreparedPolygon::intersects(const Rect& rect) const
+{
+  if(!isValid() || !rect.isValid())
+    return false;
+
+  for(const Rect& part : rect.splitAtAntiMeridian())
+  {
+    float west = part.getWest(), east = part.getEast(), south = part.getSouth(), north = part.getNorth();
+
+    if(shiftLon && west < 0.f)
+    {
+      if(east <= 0.f)
+      {
+        // Whole part is shifted east
+        if(intersectsRectPart(west + 360.f, south, east + 360.f, north))
+          return true;
+      }
+      else
+      {
+        // Part crosses the zero meridian - west half is shifted and east half remains
+        if(intersectsRectPart(west + 360.f, south, 360.f, north) || intersectsRectPart(0.f, south, east, north))
+          return true;
+      }
+    }
+    else if(intersectsRectPart(west, south, east, north))
+      return true;
+  }
+  return false;
+}
+
+bool PreparedPolygon::intersects(const Pos& pos1, const Pos& pos2) const
+{
+  if(!isValid() || !pos1.isValid() || !pos2.isValid())
+    return false;
+
+  float ax, ay, bx, by;
+  adjustLine(ax, ay, bx, by, pos1, pos2);
+  return containsAdjusted(ax, ay) || containsAdjusted(bx, by) || intersectsEdges(ax, ay, bx, by);
+}
+
+void PreparedPolygon::getCrossingFractions(QList<float>& fractions, const Pos& pos1, const Pos& pos2) const
+{
+  if(!isValid() || !pos1.isValid() || !pos2.isValid())
+    return;
+
+  float ax, ay, bx, by;
+  adjustLine(ax, ay, bx, by, pos1, pos2);
+
+  if(std::max(ax, bx) < minLon || std::min(ax, bx) > maxLon || std::max(ay, by) < minLat || std::min(ay, by) > maxLat)
+    return;
+
+  // Fraction and edge index - edges can appear in more than one band
+  QList<std::pair<float, int> > crossings;
+  float dx = bx - ax, dy = by - ay;
+  int lastBand = bandIndex(std::max(ay, by));
+  for(int band = bandIndex(std::min(ay, by)); band <= lastBand; band++)
+  {
+    for(int i = bandOffsets.at(band); i < bandOffsets.at(band + 1); i++)
+    {
+      int edge = bandEdges.at(i);
+      float ex = x2.at(edge) - x1.at(edge), ey = y2.at(edge) - y1.at(edge);
+      float denom = dx * ey - dy * ex;
+      if(denom == 0.f)
+        // Parallel
+        continue;
+
+      float qx = x1.at(edge) - ax, qy = y1.at(edge) - ay;
+      float t = (qx * ey - qy * ex) / denom; // Along line
+      float u = (qx * dy - qy * dx) / denom; // Along edge - exclude end to count shared vertices only once
+      if(t >= 0.f && t <= 1.f && u >= 0.f && u < 1.f)
+        crossings.append(std::make_pair(t, edge));
+    }
+  }
+
+  std::sort(crossings.begin(), crossings.end());
+  crossings.erase(std::unique(crossings.begin(), crossings.end()), crossings.end());
+
+  for(const std::pair<float, int>& crossing : std::as_const(crossings))
+    fractions.append(crossing.first);
+}
+
+void PreparedPolygon::adjustLine(float& ax, float& ay, float& bx, float& by, const Pos& pos1, const Pos& pos2) const
+{
+  ax = adjustLon(pos1.getLonX());
+  ay = pos1.getLatY();
+  bx = adjustLon(pos2.getLonX());
+  by = pos2.getLatY();
+
+  // Line crossing the anti-meridian
+  if(ax - bx > 180.f)
+    bx += 360.f;
+  else if(bx - ax > 180.f)
+    ax += 360.f;
+}
+
+} // namespace geo
+} // namespace atools
@@ -0,0 +1,115 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_GEO_PREPAREDPOLYGON_H
+#define ATOOLS_GEO_PREPAREDPOLYGON_H
+
+#include <QList>
+
+namespace atools {
+namespace geo {
+
+class LineString;
+class PackedLineString;
+class Pos;
+class Rect;
+
+/*
+ * Polygon prepared once for many fast containment and intersection tests, for example for airspace boundaries.
+ *
+ * Edges are straight lines in degree coordinates like used when drawing airspaces. Polygons crossing the
+ * anti-meridian are shifted east. Polygon is closed automatically.
+ *
+ * Edges are sorted into latitude bands so a test only looks at the few edges overlapping the band of the
+ * position. Edge coordinates are stored in separate arrays.
+ */
+class PreparedPolygon
+{
+public:
+  PreparedPolygon()
+  {
+  }
+
+  explicit PreparedPolygon(const atools::geo::LineString& polygon);
+
+  /* Build from decoded geometry, e.g. from BinaryGeometry::readFromByteArray() */
+  explicit PreparedPolygon(const atools::geo::PackedLineString& polygon);
+
+  /* true if position is inside polygon. Uses crossing number. */
+  bool contains(const atools::geo::Pos& pos) const;
+  bool contains(float lonX, float latY) const;
+
+  /* true if rectangle and polygon overlap or one contains the other */
+  bool intersects(const atools::geo::Rect& rect) const;
+
+  /* true if line from pos1 to pos2 touches or crosses the polygon. Line is straight in degree coordinates. */
+  bool intersects(const atools::geo::Pos& pos1, const atools::geo::Pos& pos2) const;
+
+  /* Fractions from 0 to 1 along the straight line from pos1 to pos2 where it crosses polygon edges.
+   * Fractions are sorted ascending and appended to the list. */
+  void getCrossingFractions(QList<float>& fractions, const atools::geo::Pos& pos1, const atools::geo::Pos& pos2) const;
+
+  /* Bounding rectangle in normal coordinates. West is larger than east if polygon crosses the anti-meridian. */
+  atools::geo::Rect getBoundingRect() const;
+
+  bool isValid() const
+  {
+    return !x1.isEmpty();
+  }
+
+  int getNumEdges() const
+  {
+    return static_cast<int>(x1.size());
+  }
+
+private:
+  void build(int numPoints, const float *lonX, const float *latY);
+
+  /* Range of bands overlapping the latitude range */
+  int bandIndex(float latY) const;
+
+  /* Shift longitude east if polygon crosses the anti-meridian */
+  float adjustLon(float lonX) const
+  {
+    return shiftLon && lonX < 0.f ? lonX + 360.f : lonX;
+  }
+
+  /* true if segment crosses any edge in the bands overlapping its latitude range */
+  bool intersectsEdges(float ax, float ay, float bx, float by) const;
+
+  /* Line coordinates adjusted for the anti-meridian */
+  void adjustLine(float& ax, float& ay, float& bx, float& by, const atools::geo::Pos& pos1,
+                  const atools::geo::Pos& pos2) const;
+
+  bool containsAdjusted(float x, float y) const;
+  bool intersectsRectPart(float west, float south, float east, float north) const;
+
+  /* Edge start and end coordinates */
+  QList<float> x1, y1, x2, y2;
+
+  /* Edge indexes for each band. Edges of band i are at bandEdges from bandOffsets[i] to bandOffsets[i + 1] */
+  QList<int> bandOffsets, bandEdges;
+
+  float minLon = 0.f, maxLon = 0.f, minLat = 0.f, maxLat = 0.f, bandHeight = 1.f;
+  int numBands = 0;
+  bool shiftLon = false;
+};
+
+} // namespace geo
+} // namespace atools
+
+#endif // ATOOLS_GEO_PREPAREDPOLYGON_H
@@ -22,6 +22,8 @@
 
 #include <QDataStream>
 
+#include <algorithm>
+
 namespace atools {
 namespace geo {
 
@@ -373,6 +375,76 @@ const QList<Rect> Rect::splitAtAntiMeridian() const
     return QList<Rect>();
 }
 
+/* Spread lower 16 bits of value to even bit positions */
+inline quint64 spreadBits(quint64 value)
+{
+  value &= 0xffff;
+  value = (value | (value << 8)) & 0x00ff00ff;
+  value = (value | (value << 4)) & 0x0f0f0f0f;
+  value = (value | (value << 2)) & 0x33333333;
+  value = (value | (value << 1)) & 0x55555555;
+  return value;
+}
+
+/* Quantize longitude or latitude to cell coordinates at level Rect::CELL_ID_LEVEL */
+inline int cellCoordinate(float value, float min, float range)
+{
+  const int numCells = 1 << Rect::CELL_ID_LEVEL;
+  return std::max(0, std::min(static_cast<int>((value - min) / range * numCells), numCells - 1));
+}
+
+inline qint64 mortonCode(int x, int y)
+{
+  return static_cast<qint64>(spreadBits(static_cast<quint64>(x)) | (spreadBits(static_cast<quint64>(y)) << 1));
+}
+
+qint64 Rect::cellId(const Pos& pos)
+{
+  if(!pos.isValid())
+    return -1;
+
+  return mortonCode(cellCoordinate(pos.getLonX(), -180.f, 360.f), cellCoordinate(pos.getLatY(), -90.f, 180.f));
+}
+
+const QList<std::pair<qint64, qint64> > Rect::getCellIdRanges(int maxRanges) const
+{
+  QList<std::pair<qint64, qint64> > ranges;
+
+  for(const Rect& rect : splitAtAntiMeridian())
+  {
+    int x0 = cellCoordinate(rect.getWest(), -180.f, 360.f), x1 = cellCoordinate(rect.getEast(), -180.f, 360.f);
+    int y0 = cellCoordinate(rect.getSouth(), -90.f, 180.f), y1 = cellCoordinate(rect.getNorth(), -90.f, 180.f);
+
+    // Go up in the hierarchy until the number of covering cells is small enough
+    int shift = 0;
+    while(shift < CELL_ID_LEVEL &&
+          static_cast<qint64>((x1 >> shift) - (x0 >> shift) + 1) * ((y1 >> shift) - (y0 >> shift) + 1) > maxRanges)
+      shift++;
+
+    // Each cell at the coarser level covers a consecutive range at the base level
+    for(int y = y0 >> shift; y <= y1 >> shift; y++)
+    {
+      for(int x = x0 >> shift; x <= x1 >> shift; x++)
+      {
+        qint64 start = mortonCode(x << shift, y << shift);
+        ranges.append(std::make_pair(start, start + (Q_INT64_C(1) << (2 * shift)) - 1));
+      }
+    }
+  }
+
+  // Sort and join adjacent ranges
+  std::sort(ranges.begin(), ranges.end());
+  QList<std::pair<qint64, qint64> > joined;
+  for(const std::pair<qint64, qint64>& range : std::as_const(ranges))
+  {
+    if(!joined.isEmpty() && joined.last().second + 1 >= range.first)
+      joined.last().second = std::max(joined.last().second, range.second);
+    else
+      joined.append(range);
+  }
+  return joined;
+}
+
 void Rect::swap(Rect& other)
 {
   topLeft.swap(other.topLeft);
@@ -181,6 +181,19 @@ public:
    * Correct east/west order is required for this to be reliable. */
   const QList<atools::geo::Rect> splitAtAntiMeridian() const;
 
+  /* Hierarchical cell id for a position using a quad tree on longitude and latitude numbered along a Z-order curve.
+   * Level CELL_ID_LEVEL has 2^CELL_ID_LEVEL cells in each direction which is about 600 meter at the equator.
+   * All cells inside a larger cell have consecutive ids which allows covering a rectangle by a few id ranges.
+   * Returns -1 for invalid positions. */
+  static qint64 cellId(const atools::geo::Pos& pos);
+
+  /* Get sorted and inclusive cell id ranges covering this rectangle.
+   * Larger cells are used to limit the number of ranges to maxRanges per part if crossing the anti meridian.
+   * Ranges can cover more area than the rectangle and results should be filtered by coordinates. */
+  const QList<std::pair<qint64, qint64> > getCellIdRanges(int maxRanges = 8) const;
+
+  static constexpr int CELL_ID_LEVEL = 16;
+
   /* True if this crosses the anti meridian.
    * Correct east/west order is required for this to be reliable. */
   bool crossesAntiMeridian() const;
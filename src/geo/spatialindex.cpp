@@ -18,15 +18,71 @@
 #include "geo/spatialindex.h"
 #include "geo/nanoflann.h"
 #include "geo/pos.h"
+#include "geo/rect.h"
+#include "geo/linestring.h"
+
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <cmath>
 
 using namespace std;
 using namespace nanoflann;
 using atools::geo::Pos;
+using atools::geo::Rect;
+using atools::geo::LineString;
 
 namespace atools {
 namespace geo {
 namespace internal {
 
+/* Number of sampled points for each rectangle edge when calculating the enclosing sphere */
+const static int RECT_EDGE_SAMPLES = 16;
+
+/* Flags for each point in dynamic mode */
+enum PointState : quint8
+{
+  POINT_VALID = 0,
+  POINT_STALE = 1 << 0, /* Tree entry is invalid since point was moved or removed */
+  POINT_REMOVED = 1 << 1 /* Removed from index */
+};
+
+/* Wraps a nanoflann result set and drops all results which are not valid anymore in the tree */
+template<typename RESULTSET>
+class ValidResults
+{
+public:
+  ValidResults(RESULTSET& resultSet, const std::vector<quint8>& pointStates)
+    : results(resultSet), states(pointStates)
+  {
+  }
+
+  size_t size() const
+  {
+    return static_cast<size_t>(results.size());
+  }
+
+  bool full() const
+  {
+    return results.full();
+  }
+
+  bool addPoint(float dist, int index)
+  {
+    return states[static_cast<size_t>(index)] & POINT_STALE ? true : results.addPoint(dist, index);
+  }
+
+  float worstDist() const
+  {
+    return results.worstDist();
+  }
+
+private:
+  RESULTSET& results;
+  const std::vector<quint8>& states;
+};
+
 /* Private wrapper to keep nanoflann structures out of the header */
 struct DataSource
 {
@@ -49,22 +105,69 @@ struct DataSource
 
     if(size > 0)
     {
-      points = new Point3D[static_cast<size_t>(size)];
-      pointsSize = size;
+      points.resize(static_cast<size_t>(size));
+      states.assign(static_cast<size_t>(size), POINT_VALID);
     }
   }
 
   void free()
   {
-    delete[] points;
-    points = nullptr;
-    pointsSize = 0;
+    points.clear();
+    states.clear();
+    pending.clear();
+    treeSize = numStale = numRemoved = 0;
+  }
+
+  /* Build tree for all points including removed or moved ones */
+  void build()
+  {
+    treeSize = static_cast<int>(points.size());
+    index.buildIndex();
+
+    // Moved and inserted points are now valid in tree - removed stay stale
+    pending.clear();
+    for(quint8& state : states)
+    {
+      if(!(state & POINT_REMOVED))
+        state = POINT_VALID;
+    }
+    numStale = numRemoved;
+  }
+
+  /* Rebuild tree if too many points have to be searched linearly. Removed points stay in the tree until
+   * the index is filled again since their indexes have to remain stable. */
+  void checkRebuild()
+  {
+    if(static_cast<int>(pending.size()) > std::max(MIN_PENDING_REBUILD, treeSize / 8))
+      build();
+  }
+
+  /* Run nanoflann search and add points inserted or moved after building the tree */
+  template<typename RESULTSET>
+  void search(RESULTSET& resultSet, const float *pt, const nanoflann::SearchParams& params) const
+  {
+    if(numStale == 0)
+      index.findNeighbors(resultSet, pt, params);
+    else
+    {
+      ValidResults<RESULTSET> validResults(resultSet, states);
+      index.findNeighbors(validResults, pt, params);
+    }
+
+    for(int idx : pending)
+    {
+      // Same manhattan distance as used by the tree
+      const Point3D& point = points[static_cast<size_t>(idx)];
+      float dist = std::abs(pt[0] - point.getX()) + std::abs(pt[1] - point.getY()) + std::abs(pt[2] - point.getZ());
+      if(dist < resultSet.worstDist())
+        resultSet.addPoint(dist, idx);
+    }
   }
 
   // Must return the number of data points
   size_t kdtree_get_point_count() const
   {
-    return static_cast<size_t>(pointsSize);
+    return static_cast<size_t>(treeSize);
   }
 
   // Returns the dim'th component of the idx'th point in the class:
@@ -92,8 +195,19 @@ struct DataSource
   constexpr static int DIMENSIONS = 3;
   constexpr static int MAX_LEAF_SIZE = 20;
 
-  int pointsSize = 0;
-  Point3D *points = nullptr; // Must be initialized before the index
+  /* Minimum number of pending changes before the tree is rebuilt */
+  constexpr static int MIN_PENDING_REBUILD = 256;
+
+  std::vector<Point3D> points; // Must be initialized before the index
+  std::vector<quint8> states; // PointState for each point
+
+  /* Points inserted or moved after the tree was built which are searched linearly */
+  std::vector<int> pending;
+
+  int treeSize = 0, /* Number of points at the time the tree was built */
+      numStale = 0, /* Points having POINT_STALE set */
+      numRemoved = 0; /* Points having POINT_REMOVED set */
+
   KDTreeSingleIndexAdaptor<L1_Adaptor<float, DataSource>, DataSource, DIMENSIONS, int> index;
 };
 
@@ -106,9 +220,11 @@ int SpatialIndexPrivate::nearestPoint(const Pos& pos) const
 
   int resultIndex;
   float resultSqDist;
-  size_t num = p->index.knnSearch(pt, 1, &resultIndex, &resultSqDist);
+  nanoflann::KNNResultSet<float, int> resultSet(1);
+  resultSet.init(&resultIndex, &resultSqDist);
+  p->search(resultSet, pt, nanoflann::SearchParams());
 
-  return num == 1 ? static_cast<int>(resultIndex) : -1;
+  return resultSet.size() == 1 ? static_cast<int>(resultIndex) : -1;
 }
 
 void SpatialIndexPrivate::nearestPoints(QList<int>& indexes, const Pos& pos, int number) const
@@ -119,8 +235,10 @@ void SpatialIndexPrivate::nearestPoints(QList<int>& indexes, const Pos& pos, int
   QList<float> resultSqDist(number);
   indexes.clear();
   indexes.fill(0, number);
-  size_t numFound = p->index.knnSearch(pt, static_cast<size_t>(number), indexes.data(), resultSqDist.data());
-  indexes.resize(static_cast<int>(numFound));
+  nanoflann::KNNResultSet<float, int> resultSet(static_cast<size_t>(number));
+  resultSet.init(indexes.data(), resultSqDist.data());
+  p->search(resultSet, pt, nanoflann::SearchParams());
+  indexes.resize(static_cast<int>(resultSet.size()));
 }
 
 struct IndexEntry
@@ -187,20 +305,283 @@ void SpatialIndexPrivate::pointsInRadius(QList<int>& indexes, const Pos& origin,
   nanoflann::SearchParams params;
   params.sorted = false;
 
-  int num = static_cast<int>(p->index.radiusSearchCustomCallback(originPtArr, resultCallback, params));
+  p->search(resultCallback, originPtArr, params);
+  int num = static_cast<int>(resultCallback.size());
 
   for(int i = 0; i < num; i++)
     indexes.append(indicesDists.at(i).index);
 }
 
+void SpatialIndexPrivate::pointsNearRect(QList<int>& indexes, const Rect& rect) const
+{
+  if(!rect.isValid())
+    return;
+
+  // Find maximum chord distance from center to the rectangle boundary by sampling edges
+  Point3D center = rect.getCenter().toCartesian();
+  float west = rect.getWest(), east = rect.getEast(), north = rect.getNorth(), south = rect.getSouth();
+  float width = rect.crossesAntiMeridian() ? east + 360.f - west : east - west;
+  float maxDist = 0.f;
+  for(int i = 0; i <= RECT_EDGE_SAMPLES; i++)
+  {
+    float fraction = static_cast<float>(i) / RECT_EDGE_SAMPLES;
+    float lonX = west + width * fraction, latY = south + (north - south) * fraction;
+    maxDist = std::max(maxDist, center.directDistanceMeter(Pos(lonX, north).normalize().toCartesian()));
+    maxDist = std::max(maxDist, center.directDistanceMeter(Pos(lonX, south).normalize().toCartesian()));
+    maxDist = std::max(maxDist, center.directDistanceMeter(Pos(west, latY).toCartesian()));
+    maxDist = std::max(maxDist, center.directDistanceMeter(Pos(east, latY).toCartesian()));
+  }
+
+  // Sampling does not find the farthest point if the rectangle covers the antipode - search all points then
+  float radius;
+  if(width >= 180.f || maxDist > static_cast<float>(Pos::EARTH_RADIUS_METER_DOUBLE))
+    radius = std::numeric_limits<float>::max();
+  else
+    // Manhattan distance is at most sqrt(3) times euclidian distance - add margin for sampling error
+    radius = maxDist * 1.7320508f * 1.02f + 1.f;
+
+  pointsInRadius(indexes, rect.getCenter(), radius, RadiusCallbackType());
+}
+
+void SpatialIndexPrivate::pointsNearPolygon(QList<int>& indexes, const LineString& polygon) const
+{
+  if(polygon.isValidPolygon())
+    pointsNearRect(indexes, polygon.boundingRect());
+}
+
+RectTest::RectTest(const Rect& rect)
+{
+  if(rect.isValid())
+  {
+    for(const Rect& part : rect.splitAtAntiMeridian())
+      bounds << part.getWest() << part.getEast() << part.getNorth() << part.getSouth();
+  }
+}
+
+bool RectTest::contains(const Pos& pos) const
+{
+  if(pos.isValid())
+  {
+    float lonX = pos.getLonX(), latY = pos.getLatY();
+    for(int i = 0; i < bounds.size(); i += 4)
+    {
+      if(bounds.at(i) <= lonX && lonX <= bounds.at(i + 1) && bounds.at(i + 2) >= latY && latY >= bounds.at(i + 3))
+        return true;
+    }
+  }
+  return false;
+}
+
+/* Callback for batch radius searches appending directly to the flat result list */
+class BatchRadiusResults
+{
+public:
+  BatchRadiusResults(QList<int>& resultParam, float radiusMaxParam, int queryParam,
+                     SpatialIndexPrivate::BatchCallbackFunc callbackParam, const void *contextParam)
+    : radiusMax(radiusMaxParam), query(queryParam), start(static_cast<int>(resultParam.size())), result(resultParam),
+    callback(callbackParam), context(contextParam)
+  {
+  }
+
+  size_t size() const
+  {
+    return static_cast<size_t>(result.size() - start);
+  }
+
+  bool full() const
+  {
+    return true;
+  }
+
+  bool addPoint(float dist, int index)
+  {
+    if(dist < radiusMax && (callback == nullptr || callback(context, query, dist, index)))
+      result.append(index);
+
+    // keep adding points
+    return true;
+  }
+
+  float worstDist() const
+  {
+    return radiusMax;
+  }
+
+private:
+  float radiusMax;
+  int query, start;
+  QList<int>& result;
+  SpatialIndexPrivate::BatchCallbackFunc callback;
+  const void *context;
+};
+
+/* Runs query for all positions and writes results in query order to result.
+ * query is called with the index list to append to and the position number. */
+template<typename QUERY>
+void runBatch(SpatialIndexBatchResult& result, int numPositions, bool parallel, const QUERY& query)
+{
+  result.clear();
+  result.offsets.reserve(numPositions + 1);
+  result.offsets.append(0);
+
+  if(numPositions <= 0)
+    return;
+
+  int numThreads = parallel ? std::min(QThread::idealThreadCount(), numPositions / 64 + 1) : 1;
+
+  if(numThreads <= 1)
+  {
+    for(int i = 0; i < numPositions; i++)
+    {
+      query(result.indexes, i);
+      result.offsets.append(static_cast<int>(result.indexes.size()));
+    }
+  }
+  else
+  {
+    // Split into one chunk per thread and join results in query order afterwards
+    QList<SpatialIndexBatchResult> chunks(numThreads);
+    int chunkSize = (numPositions + numThreads - 1) / numThreads;
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(numThreads);
+    for(int t = 0; t < numThreads; t++)
+    {
+      SpatialIndexBatchResult *chunk = &chunks[t];
+      int from = t * chunkSize, to = std::min(from + chunkSize, numPositions);
+      pool.start([chunk, from, to, &query]() -> void {
+        for(int i = from; i < to; i++)
+        {
+          query(chunk->indexes, i);
+          chunk->offsets.append(static_cast<int>(chunk->indexes.size()));
+        }
+      });
+    }
+    pool.waitForDone();
+
+    for(const SpatialIndexBatchResult& chunk : std::as_const(chunks))
+    {
+      int base = static_cast<int>(result.indexes.size());
+      result.indexes.append(chunk.indexes);
+      for(int offset : chunk.offsets)
+        result.offsets.append(base + offset);
+    }
+  }
+}
+
+void SpatialIndexPrivate::nearestPointsBatch(SpatialIndexBatchResult& result, const Pos *positions, int numPositions,
+                                             int number, bool parallel) const
+{
+  runBatch(result, numPositions, parallel, [this, positions, number](QList<int>& indexes, int i) -> void {
+    float pt[3];
+    positions[i].toCartesian(pt[0], pt[1], pt[2]);
+
+    int start = static_cast<int>(indexes.size());
+    indexes.resize(start + number);
+
+    // Distance buffer on stack for usual small numbers
+    float distStack[64];
+    QList<float> distHeap;
+    float *dist = distStack;
+    if(number > 64)
+    {
+      distHeap.resize(number);
+      dist = distHeap.data();
+    }
+
+    nanoflann::KNNResultSet<float, int> resultSet(static_cast<size_t>(number));
+    resultSet.init(indexes.data() + start, dist);
+    p->search(resultSet, pt, nanoflann::SearchParams());
+    indexes.resize(start + static_cast<int>(resultSet.size()));
+  });
+}
+
+void SpatialIndexPrivate::pointsInRadiusBatch(SpatialIndexBatchResult& result, const Pos *positions, int numPositions,
+                                              float radiusMaxMeter, BatchCallbackFunc callback, const void *context,
+                                              bool parallel) const
+{
+  runBatch(result, numPositions, parallel,
+           [this, positions, radiusMaxMeter, callback, context](QList<int>& indexes, int i) -> void {
+    float pt[3];
+    positions[i].toCartesian(pt[0], pt[1], pt[2]);
+
+    BatchRadiusResults resultCallback(indexes, radiusMaxMeter, i, callback, context);
+    nanoflann::SearchParams params;
+    params.sorted = false;
+    p->search(resultCallback, pt, params);
+  });
+}
+
 void SpatialIndexPrivate::buildIndex()
 {
-  p->index.buildIndex();
+  p->build();
 }
 
 void SpatialIndexPrivate::set(const Point3D& point, int index)
 {
-  p->points[index] = point;
+  p->points[static_cast<size_t>(index)] = point;
+}
+
+void SpatialIndexPrivate::add(const Point3D& point)
+{
+  p->points.push_back(point);
+  p->states.push_back(POINT_VALID);
+  p->pending.push_back(static_cast<int>(p->points.size()) - 1);
+  p->checkRebuild();
+}
+
+void SpatialIndexPrivate::move(int index, const Point3D& point)
+{
+  size_t idx = static_cast<size_t>(index);
+  if(p->states.at(idx) & POINT_REMOVED)
+    return;
+
+  p->points[idx] = point;
+
+  if(index < p->treeSize && !(p->states.at(idx) & POINT_STALE))
+  {
+    // Invalidate tree entry and search linearly until next rebuild
+    p->states[idx] |= POINT_STALE;
+    p->numStale++;
+    p->pending.push_back(index);
+    p->checkRebuild();
+  }
+  // else already in pending list
+}
+
+void SpatialIndexPrivate::remove(int index)
+{
+  size_t idx = static_cast<size_t>(index);
+  quint8& state = p->states.at(idx);
+  if(state & POINT_REMOVED)
+    return;
+
+  if(!(state & POINT_STALE))
+    p->numStale++;
+  state |= POINT_STALE | POINT_REMOVED;
+  p->numRemoved++;
+
+  // Remove from linear search list if inserted or moved
+  auto it = std::find(p->pending.begin(), p->pending.end(), index);
+  if(it != p->pending.end())
+    p->pending.erase(it);
+}
+
+bool SpatialIndexPrivate::isRemoved(int index) const
+{
+  // Objects might have been added to the vector directly without index update
+  size_t idx = static_cast<size_t>(index);
+  return idx < p->states.size() && p->states.at(idx) & POINT_REMOVED;
+}
+
+bool SpatialIndexPrivate::hasRemoved() const
+{
+  return p->numRemoved > 0;
+}
+
+int SpatialIndexPrivate::numPending() const
+{
+  return static_cast<int>(p->pending.size());
 }
 
 void SpatialIndexPrivate::clear()
@@ -215,7 +596,15 @@ void SpatialIndexPrivate::reserve(int size)
 
 const atools::geo::Point3D *SpatialIndexPrivate::points3D()
 {
-  return p->points;
+  return p->points.data();
+}
+
+qint64 SpatialIndexPrivate::memorySize() const
+{
+  // Tree nodes are allocated from the pool and vind contains one index for each point
+  return atools::util::MemoryUsage::vectorBytes(p->points) + atools::util::MemoryUsage::vectorBytes(p->states) +
+         atools::util::MemoryUsage::vectorBytes(p->pending) + atools::util::MemoryUsage::vectorBytes(p->index.vind) +
+         static_cast<qint64>(p->index.pool.usedMemory + p->index.pool.wastedMemory);
 }
 
 SpatialIndexPrivate::SpatialIndexPrivate()
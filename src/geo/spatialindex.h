@@ -19,6 +19,8 @@
 #define ATOOLS_GEO_SPATIALINDEX_H
 
 #include "geo/point3d.h"
+#include "geo/preparedpolygon.h"
+#include "util/memoryusage.h"
 
 #include <QList>
 #include <functional>
@@ -27,6 +29,8 @@ namespace atools {
 namespace geo {
 
 class Pos;
+class Rect;
+class LineString;
 template<typename T>
 class SpatialIndex;
 
@@ -34,12 +38,66 @@ class SpatialIndex;
  * after filtering by manhattan distance to origin. */
 typedef std::function<bool (float, int)> RadiusCallbackType;
 
+/* Flat result buffer for batch queries. Owned by the caller and can be reused to avoid allocations.
+ * Indexes for query number i are stored in indexes at begin(i) until end(i) - 1 */
+struct SpatialIndexBatchResult
+{
+  /* Index of first result for each query. Contains size() + 1 entries. */
+  QList<int> offsets;
+
+  /* Object indexes for all queries */
+  QList<int> indexes;
+
+  /* Remove results but keep memory */
+  void clear()
+  {
+    offsets.clear();
+    indexes.clear();
+  }
+
+  /* Number of queries */
+  int size() const
+  {
+    return offsets.isEmpty() ? 0 : static_cast<int>(offsets.size()) - 1;
+  }
+
+  int begin(int query) const
+  {
+    return offsets.at(query);
+  }
+
+  int end(int query) const
+  {
+    return offsets.at(query + 1);
+  }
+
+  /* Number of results for a query */
+  int size(int query) const
+  {
+    return end(query) - begin(query);
+  }
+};
+
 /* Private parts *************************************************************************************/
 
 namespace internal {
 
 struct DataSource;
 
+/* Exact containment test for rectangles which is prepared once for many positions.
+ * Rectangles crossing the anti-meridian are split. */
+class RectTest
+{
+public:
+  explicit RectTest(const atools::geo::Rect& rect);
+
+  bool contains(const atools::geo::Pos& pos) const;
+
+private:
+  /* West, east, north and south for each part */
+  QList<float> bounds;
+};
+
 /* Wraps nanoflann structures and detaches functionality from template class. */
 class SpatialIndexPrivate
 {
@@ -53,12 +111,38 @@ class SpatialIndexPrivate
   void nearestPoints(QList<int>& indexes, const atools::geo::Pos& pos, int number) const;
   void pointsInRadius(QList<int>& indexes, const atools::geo::Pos& origin, float radiusMaxMeter,
                       const RadiusCallbackType& callback) const;
+  /* Indexes of all points inside a sphere enclosing the rectangle or the bounding rectangle of the polygon.
+   * Positions have to be checked exactly afterwards. */
+  void pointsNearRect(QList<int>& indexes, const atools::geo::Rect& rect) const;
+  void pointsNearPolygon(QList<int>& indexes, const atools::geo::LineString& polygon) const;
+
+  /* Function and context pointer used to pass template callbacks from the header */
+  typedef bool (*BatchCallbackFunc)(const void *context, int query, float dist, int index);
+
+  void nearestPointsBatch(SpatialIndexBatchResult& result, const atools::geo::Pos *positions, int numPositions,
+                          int number, bool parallel) const;
+  void pointsInRadiusBatch(SpatialIndexBatchResult& result, const atools::geo::Pos *positions, int numPositions,
+                           float radiusMaxMeter, BatchCallbackFunc callback, const void *context, bool parallel) const;
+
   void set(const Point3D& point, int index);
+
+  /* Dynamic changes after buildIndex(). Points are searched linearly until the tree is rebuilt
+   * automatically after a number of changes. */
+  void add(const Point3D& point);
+  void move(int index, const Point3D& point);
+  void remove(int index);
+  bool isRemoved(int index) const;
+  bool hasRemoved() const;
+  int numPending() const;
+
   void buildIndex();
   void clear();
   void reserve(int size);
   const Point3D *points3D();
 
+  /* Bytes used by 3D points, states and KD-tree nodes */
+  qint64 memorySize() const;
+
   /* Data source containing nanoflann structures. */
   DataSource *p = nullptr;
 
@@ -71,6 +155,9 @@ class SpatialIndexPrivate
  * Spatial index wrapping the nanoflann library which uses KD-tree for nearest neighbor search.
  *
  * Changing the underlying vector needs a call of updateIndex() afterwards.
+ * Alternatively single objects can be added, updated or removed using addObject(), updateObject() and
+ * removeObject() which keep the index valid without a full rebuild. These must not be called while
+ * queries are running in other threads.
  *
  * Note that squared distance is used internally for lookup and resulting distances are therefore not accurate.
  *
@@ -130,9 +217,94 @@ public:
     p->pointsInRadius(indexes, pos, radiusMaxMeter, RadiusCallbackType());
   }
 
-  /* Rebuild the KD-tree and Point3D vector. Call this after changing the base class vector. */
+  /* Get all objects or indexes inside the rectangle. Rectangles crossing the anti-meridian are supported.
+   * Prunes by a sphere around the rectangle center before checking positions exactly. */
+  void getInRect(QList<T>& objects, const atools::geo::Rect& rect) const;
+  void getInRectIndexes(QList<int>& indexes, const atools::geo::Rect& rect) const;
+
+  /* Get all objects or indexes inside the polygon. Polygon is closed automatically and edges are straight
+   * lines in degree coordinates. Prunes by the bounding rectangle of the polygon. */
+  void getInPolygon(QList<T>& objects, const atools::geo::LineString& polygon) const;
+  void getInPolygonIndexes(QList<int>& indexes, const atools::geo::LineString& polygon) const;
+
+  /* Batch queries for many positions at once writing into a flat caller owned buffer which is cleared before.
+   * Results for positions[i] are at result.begin(i) until result.end(i) - 1.
+   * Queries are distributed on a thread pool if parallel is true. */
+
+  /* Get number nearest indexes for each position. */
+  void getNearestIndexesBatch(SpatialIndexBatchResult& result, const atools::geo::Pos *positions, int numPositions,
+                              int number, bool parallel = false) const
+  {
+    p->nearestPointsBatch(result, positions, numPositions, number, parallel);
+  }
+
+  void getNearestIndexesBatch(SpatialIndexBatchResult& result, const QList<atools::geo::Pos>& positions,
+                              int number, bool parallel = false) const
+  {
+    p->nearestPointsBatch(result, positions.constData(), static_cast<int>(positions.size()), number, parallel);
+  }
+
+  /* Get all indexes within radius for each position. The callback is a secondary filter stage like in
+   * getRadiusIndexes() with the signature bool callback(int query, float dist, int index) where query is
+   * the position number. Callback has to be thread safe if parallel is true. */
+  template<typename FILTERFUNC>
+  void getRadiusIndexesBatch(SpatialIndexBatchResult& result, const atools::geo::Pos *positions, int numPositions,
+                             float radiusMaxMeter, const FILTERFUNC& callback, bool parallel = false) const
+  {
+    p->pointsInRadiusBatch(result, positions, numPositions, radiusMaxMeter, &callbackFunc<FILTERFUNC>, &callback,
+                           parallel);
+  }
+
+  void getRadiusIndexesBatch(SpatialIndexBatchResult& result, const atools::geo::Pos *positions, int numPositions,
+                             float radiusMaxMeter, bool parallel = false) const
+  {
+    p->pointsInRadiusBatch(result, positions, numPositions, radiusMaxMeter, nullptr, nullptr, parallel);
+  }
+
+  void getRadiusIndexesBatch(SpatialIndexBatchResult& result, const QList<atools::geo::Pos>& positions,
+                             float radiusMaxMeter, bool parallel = false) const
+  {
+    p->pointsInRadiusBatch(result, positions.constData(), static_cast<int>(positions.size()), radiusMaxMeter,
+                           nullptr, nullptr, parallel);
+  }
+
+  /* Rebuild the KD-tree and Point3D vector. Call this after changing the base class vector.
+   * Objects marked by removeObject() are deleted from the vector before which changes indexes. */
   void updateIndex();
 
+  /* Append object to vector and index. Returns index of the new object. */
+  int addObject(const T& obj)
+  {
+    QList<T>::append(obj);
+    p->add(obj.getPosition().toCartesian());
+    return static_cast<int>(QList<T>::size()) - 1;
+  }
+
+  /* Replace object at index and update its position in the index */
+  void updateObject(int index, const T& obj)
+  {
+    QList<T>::replace(index, obj);
+    p->move(index, obj.getPosition().toCartesian());
+  }
+
+  /* Remove object from index. Object stays in the vector to keep indexes stable until the next call of
+   * updateIndex() and is not returned by queries anymore. */
+  void removeObject(int index)
+  {
+    p->remove(index);
+  }
+
+  bool isRemoved(int index) const
+  {
+    return p->isRemoved(index);
+  }
+
+  /* Number of changes not yet included in the KD-tree */
+  int getNumPendingChanges() const
+  {
+    return p->numPending();
+  }
+
   /* Get points converted to 3D euclidian space from base vector.
    * Size is the same as in the underlying parent QList. */
   const Point3D *getPoints3D() const
@@ -145,6 +317,13 @@ public:
     return p->points3D()[index];
   }
 
+  /* Add memory used by objects and index as components "name/objects" and "name/index" */
+  void getMemoryUsage(atools::util::MemoryUsage& usage, const QString& name = QStringLiteral("SpatialIndex")) const
+  {
+    usage.add(name + QStringLiteral("/objects"), atools::util::MemoryUsage::listBytes<T>(*this), QList<T>::size());
+    usage.add(name + QStringLiteral("/index"), p->memorySize(), QList<T>::size());
+  }
+
   /* Clears vector and updates index to clear it */
   void clearIndex()
   {
@@ -155,6 +334,13 @@ public:
 private:
   using QList<T>::clear;
 
+  /* Calls the template callback given as context */
+  template<typename FILTERFUNC>
+  static bool callbackFunc(const void *context, int query, float dist, int index)
+  {
+    return (*static_cast<const FILTERFUNC *>(context))(query, dist, index);
+  }
+
   /* Copy objects from base vector to result set. */
   void copyData(QList<T>& objects, QList<int>& indexes) const
   {
@@ -207,9 +393,66 @@ void SpatialIndex<T>::getRadius(QList<T>& objects, const Pos& pos, float radiusM
   copyData(objects, indexes);
 }
 
+template<typename T>
+void SpatialIndex<T>::getInRect(QList<T>& objects, const Rect& rect) const
+{
+  QList<int> indexes;
+  getInRectIndexes(indexes, rect);
+  copyData(objects, indexes);
+}
+
+template<typename T>
+void SpatialIndex<T>::getInRectIndexes(QList<int>& indexes, const Rect& rect) const
+{
+  QList<int> candidates;
+  p->pointsNearRect(candidates, rect);
+
+  atools::geo::internal::RectTest test(rect);
+  for(int idx : candidates)
+  {
+    if(test.contains(this->at(idx).getPosition()))
+      indexes.append(idx);
+  }
+}
+
+template<typename T>
+void SpatialIndex<T>::getInPolygon(QList<T>& objects, const LineString& polygon) const
+{
+  QList<int> indexes;
+  getInPolygonIndexes(indexes, polygon);
+  copyData(objects, indexes);
+}
+
+template<typename T>
+void SpatialIndex<T>::getInPolygonIndexes(QList<int>& indexes, const LineString& polygon) const
+{
+  QList<int> candidates;
+  p->pointsNearPolygon(candidates, polygon);
+
+  atools::geo::PreparedPolygon test(polygon);
+  for(int idx : candidates)
+  {
+    if(test.contains(this->at(idx).getPosition()))
+      indexes.append(idx);
+  }
+}
+
 template<typename T>
 void SpatialIndex<T>::updateIndex()
 {
+  if(p->hasRemoved())
+  {
+    // Drop objects marked as removed
+    QList<T> objects;
+    objects.reserve(QList<T>::size());
+    for(int i = 0; i < QList<T>::size(); i++)
+    {
+      if(!p->isRemoved(i))
+        objects.append(QList<T>::at(i));
+    }
+    QList<T>::swap(objects);
+  }
+
   p->reserve(QList<T>::size());
 
   for(int i = 0; i < QList<T>::size(); i++)
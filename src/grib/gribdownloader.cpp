@@ -40,7 +40,11 @@ GribDownloader::GribDownloader(QObject *parent, bool logVerbose = false)
 {
   downloader = new HttpDownloader(parent, verbose);
   downloader->setAcceptEncoding("gzip");
+  downloader->setStreamData(true);
+  downloader->setDetectUnchanged(true);
   connect(downloader, &HttpDownloader::downloadFinished, this, &GribDownloader::downloadFinished);
+  connect(downloader, &HttpDownloader::downloadDataAvailable, this, &GribDownloader::downloadDataAvailable);
+  connect(downloader, &HttpDownloader::downloadUnchanged, this, &GribDownloader::downloadUnchanged);
   connect(downloader, &HttpDownloader::downloadFailed, this, &GribDownloader::downloadFailed);
   connect(downloader, &HttpDownloader::downloadSslErrors, this, &GribDownloader::gribDownloadSslErrors);
   connect(downloader, &HttpDownloader::downloadProgress, this, &GribDownloader::gribDownloadProgress);
@@ -50,6 +54,7 @@ GribDownloader::~GribDownloader()
 {
   stopDownload();
   delete downloader;
+  delete streamReader;
 }
 
 void GribDownloader::startDownload(const QDateTime& timestamp, const QString& baseUrlParam)
@@ -78,6 +83,10 @@ void GribDownloader::stopDownload()
   retries = 0;
   datetime = QDateTime();
   datasets.clear();
+  resetStream();
+
+  // Datasets are gone - do not skip the next download
+  downloader->clearContentStates();
 }
 
 void GribDownloader::startDownloadInternal()
@@ -128,12 +137,57 @@ void GribDownloader::startDownloadInternal()
 
   qDebug() << Q_FUNC_INFO << "Starting" << url;
 
+  resetStream();
+
   downloader->startDownload();
 }
 
+void GribDownloader::downloadDataAvailable(const QByteArray& chunk, QString downloadUrl)
+{
+  if(!streamError.isEmpty())
+    // Ignore rest of data after error
+    return;
+
+  if(!streamStarted)
+  {
+    // Check first chunk for compression
+    streamStarted = true;
+    streamCompressed = atools::zip::isGzipCompressed(chunk);
+
+    if(!streamCompressed)
+    {
+      if(streamReader == nullptr)
+        streamReader = new GribReader(verbose);
+      streamReader->beginData();
+    }
+
+    if(verbose)
+      qDebug() << Q_FUNC_INFO << "compressed" << streamCompressed << downloadUrl;
+  }
+
+  if(streamCompressed)
+    compressedData.append(chunk);
+  else
+  {
+    try
+    {
+      // Decodes all messages which are complete
+      streamReader->appendData(chunk);
+    }
+    catch(atools::Exception& e)
+    {
+      streamError = e.what();
+    }
+    catch(...)
+    {
+      streamError = tr("Unknown error.");
+    }
+  }
+}
+
 void GribDownloader::downloadFinished(const QByteArray& data, QString downloadUrl)
 {
-  qDebug() << Q_FUNC_INFO << data.size() << downloadUrl;
+  qDebug() << Q_FUNC_INFO << data.size() << compressedData.size() << downloadUrl;
 
   retries = 0;
 
@@ -146,32 +200,68 @@ void GribDownloader::downloadFinished(const QByteArray& data, QString downloadUr
     timer.start();
 #endif
 
-    GribReader reader(verbose);
-    reader.readData(atools::zip::gzipDecompressIf(data, Q_FUNC_INFO));
+    if(!streamError.isEmpty())
+      throw atools::Exception(streamError);
+
+    if(!data.isEmpty() || streamCompressed || !streamStarted)
+    {
+      // Local file, cached, compressed or empty response - decode all at once
+      GribReader reader(verbose);
+      reader.readData(atools::zip::gzipDecompressIf(data.isEmpty() ? compressedData : data, Q_FUNC_INFO));
+      datasets = reader.getDatasets();
+    }
+    else
+    {
+      // Decode remaining messages
+      streamReader->finishData();
+      datasets = streamReader->getDatasets();
+      streamReader->clear();
+    }
 
 #ifdef DEBUG_INFORMATION
     qDebug() << Q_FUNC_INFO << "GRIB decoding took" << timer.elapsed() << "ms";
 #endif
-
-    datasets = reader.getDatasets();
   }
   catch(atools::Exception& e)
   {
+    resetStream();
     emit gribDownloadFailed(e.what(), 0, downloadUrl);
     return;
   }
   catch(...)
   {
+    resetStream();
     emit gribDownloadFailed(tr("Unknown error."), 0, downloadUrl);
     return;
   }
 
+  resetStream();
   emit gribDownloadFinished(datasets, downloadUrl);
 }
 
+void GribDownloader::downloadUnchanged(QString downloadUrl)
+{
+  qDebug() << Q_FUNC_INFO << "Unchanged" << downloadUrl;
+
+  // Drop datasets decoded while streaming and keep the current ones
+  retries = 0;
+  resetStream();
+}
+
+void GribDownloader::resetStream()
+{
+  compressedData.clear();
+  streamStarted = streamCompressed = false;
+  streamError.clear();
+  if(streamReader != nullptr)
+    streamReader->clear();
+}
+
 void GribDownloader::downloadFailed(const QString& error, int errorCode, QString downloadUrl)
 {
   qDebug() << Q_FUNC_INFO << errorCode << error << "retries" << retries;
+  resetStream();
+
   if(++retries < MAX_RETRIES)
   {
     // Download failed - try an earlier dataset 6 hours ago
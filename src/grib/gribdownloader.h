@@ -31,6 +31,8 @@ class HttpDownloader;
 }
 namespace grib {
 
+class GribReader;
+
 /*
  * Downloads and decodes GRIB2 files from base URL https://nomads.ncep.noaa.gov/cgi-bin/filter_gfs_1p00.pl
  *
@@ -40,6 +42,8 @@ namespace grib {
  *
  * Only U/V wind components, full earth bounding rectangle and one-degree raster supported.
  *
+ * GRIB messages are decoded while downloading as soon as each message is complete.
+ * Responses compressed by the server are collected and decoded after the download.
  */
 class GribDownloader :
   public QObject
@@ -120,6 +124,13 @@ signals:
 
 private:
   void downloadFinished(const QByteArray& data, QString downloadUrl);
+  void downloadDataAvailable(const QByteArray& chunk, QString downloadUrl);
+
+  /* Same file as last time - keep datasets */
+  void downloadUnchanged(QString downloadUrl);
+
+  /* Clear decoder state for next download */
+  void resetStream();
   void downloadFailed(const QString& error, int errorCode, QString downloadUrl);
   void startDownloadInternal();
 
@@ -132,6 +143,16 @@ private:
 
   atools::util::HttpDownloader *downloader = nullptr;
 
+  /* Decodes messages while downloading */
+  atools::grib::GribReader *streamReader = nullptr;
+
+  /* Collected response if compressed by the server */
+  QByteArray compressedData;
+
+  /* Error message from decoding a chunk. Reported when download is finished. */
+  QString streamError;
+  bool streamStarted = false, streamCompressed = false;
+
   QList<int> surfaces;
   QStringList parameters;
   QDateTime datetime;
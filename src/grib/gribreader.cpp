@@ -17,7 +17,6 @@
 
 #include "grib/gribreader.h"
 #include "geo/calculations.h"
-#include "io/tempfile.h"
 #include "exception.h"
 
 extern "C" {
@@ -29,11 +28,21 @@ extern "C" {
 #include <QDebug>
 #include <QDir>
 #include <QFile>
+#include <QScopeGuard>
+#include <QThread>
+#include <QThreadPool>
+#include <QtEndian>
 #include <QTimeZone>
 
 namespace atools {
 namespace grib {
 
+/* Size of GRIB2 indicator section containing marker, edition and message length */
+const static int SECTION0_SIZE = 16;
+
+/* Messages larger than this are considered corrupt */
+const static quint64 MAX_MESSAGE_SIZE = 256ULL * 1024ULL * 1024ULL;
+
 /* Print an int array for debug output */
 void printArrInt(const QString& name, g2int *arr, g2int num)
 {
@@ -99,373 +108,349 @@ GribReader::GribReader(bool verboseParam)
 
 }
 
-void GribReader::readFile(const QString& filename)
+int GribReader::messageFields(unsigned char *cgrib) const
 {
-  if(QFileInfo(filename).size() == 0)
-    // Print only a warning since X-Plane seems to download zero length files from time to time
-    qWarning() << Q_FUNC_INFO << "GRIB file" << filename << "is empty";
+  g2int listSection0[3], listSection1[13], numlocal, numfields;
 
-  if(!validateGribFile(filename))
-    throw atools::Exception(tr("Not a valid GRIB file: \"%1\"").arg(filename));
+  g2int ierr = g2_info(cgrib, listSection0, listSection1, &numfields, &numlocal);
+  if(ierr != g2int(0))
+    return -1;
 
-  unsigned char *cgrib;
-  g2int listSection0[3], listSection1[13], numlocal, numfields;
-  long skipBytes, numGribBytes, seekBytes = 0L;
-  g2int expand = 1, unpack = 1, ret, ierr;
+  if(verbose)
+  {
+    qDebug() << Q_FUNC_INFO << "numfields" << numfields << "numlocal" << numlocal;
+    printArrInt(QString(Q_FUNC_INFO) + " Section 0: ", listSection0, 3);
+    printArrInt(QString(Q_FUNC_INFO) + " Section 1: ", listSection1, 13);
+  }
+
+  return static_cast<int>(numfields);
+}
 
-#if defined(Q_OS_WIN32)
-  // Windows fopen uses local charset for filename - convert UTF-8 to UTF-16 and use wfopen
-  wchar_t *path = new wchar_t[static_cast<unsigned int>(filename.size()) + 1];
-  filename.toWCharArray(path);
-  path[filename.size()] = L'\0';
+bool GribReader::decodeField(GribDataset& dataset, unsigned char *cgrib, int fieldNum) const
+{
+  g2int expand = 1, unpack = 1;
 
-  FILE *fptr = _wfopen(path, L"rb");
-#else
-  FILE *fptr = fopen(filename.toUtf8().constData(), "rb");
-#endif
+  // Field is always allocated and has to be freed also on error
+  gribfield *gribField = nullptr;
+  g2int ierr = g2_getfld(cgrib, fieldNum, unpack, expand, &gribField);
+  auto freeField = qScopeGuard([gribField]() {
+        g2_free(gribField);
+      });
 
-  if(fptr != nullptr)
+  if(ierr != g2int(0))
   {
-    while(true)
-    {
-      if(verbose)
-        qDebug() << "======================================================================";
-
-      // Search for next/first GRIB message ========================================
-      seekgb(fptr, seekBytes, 128000, &skipBytes, &numGribBytes);
-      if(numGribBytes == 0)
-        break; // end loop at EOF or problem
-
-      cgrib = new unsigned char[static_cast<size_t>(numGribBytes)];
-      ret = fseek(fptr, skipBytes, SEEK_SET);
-      if(ret != g2int(0))
-        throw atools::Exception(tr("Cannot seek in file %1").arg(filename));
-
-      // Read message ========================================
-      size_t lengrib = fread(cgrib, sizeof(unsigned char), static_cast<size_t>(numGribBytes), fptr);
-      if(lengrib <= 0)
-        throw atools::Exception(tr("Cannot read file %1").arg(filename));
-
-      seekBytes = skipBytes + numGribBytes;
-      ierr = g2_info(cgrib, listSection0, listSection1, &numfields, &numlocal);
-      if(ierr != g2int(0))
-        throw atools::Exception(tr("Cannot read file %1").arg(filename));
-
-      if(verbose)
-      {
-        qDebug() << Q_FUNC_INFO << "numfields" << numfields << "numlocal" << numlocal;
-        printArrInt(QString(Q_FUNC_INFO) + " Section 0: ", listSection0, 3);
-        printArrInt(QString(Q_FUNC_INFO) + " Section 1: ", listSection1, 13);
-      }
+    // Error 14 is returned for packing templates which are not compiled in like JPEG2000 (5.40) or PNG (5.41)
+    qWarning() << Q_FUNC_INFO << "Cannot unpack field" << fieldNum << "error" << ierr;
+    return false;
+  }
 
-      // Read datasets / GRIB messages ========================================
-      for(long n = 0; n < numfields; n++)
-      {
-        GribDataset dataset;
-
-        gribfield *gribField;
-        ierr = g2_getfld(cgrib, n + 1, unpack, expand, &gribField);
-
-        if(verbose)
-        {
-          // gfld->version = GRIB edition number ( currently 2 )
-          // gfld->discipline = Message Discipline ( see Code Table 0.0 )
-          qDebug() << Q_FUNC_INFO << "===================================";
-          qDebug() << Q_FUNC_INFO << "field" << n << "version" << gribField->version << "discipline" << gribField->discipline;
-        }
-
-        // ID section ====================================================================================
-        // gfld->idsect = Contains the entries in the Identification
-        // Section ( Section 1 )
-        // This element is a pointer to an array
-        // that holds the data.
-        // gfld->idsect[0]  = Identification of originating Centre
-        // ( see Common Code Table C-1 )
-        // 7 - US National Weather Service
-        // gfld->idsect[1]  = Identification of originating Sub-centre
-        // gfld->idsect[2]  = GRIB Master Tables Version Number
-        // ( see Code Table 1.0 )
-        // 0 - Experimental
-        // 1 - Initial operational version number
-        // gfld->idsect[3]  = GRIB Local Tables Version Number
-        // ( see Code Table 1.1 )
-        // 0     - Local tables not used
-        // 1-254 - Number of local tables version used
-        // gfld->idsect[4]  = Significance of Reference Time (Code Table 1.2)
-        // 0 - Analysis
-        // 1 - Start of forecast
-        // 2 - Verifying time of forecast
-        // 3 - Observation time
-        // gfld->idsect[5]  = Year ( 4 digits )
-        // gfld->idsect[6]  = Month
-        // gfld->idsect[7)  = Day
-        // gfld->idsect[8]  = Hour
-        // gfld->idsect[9]  = Minute
-        // gfld->idsect[10]  = Second
-        // gfld->idsect[11]  = Production status of processed data
-        // ( see Code Table 1.3 )
-        // 0 - Operational products
-        // 1 - Operational test products
-        // 2 - Research products
-        // 3 - Re-analysis products
-        // gfld->idsect[12]  = Type of processed data ( see Code Table 1.4 )
-        // 0  - Analysis products
-        // 1  - Forecast products
-        // 2  - Analysis and forecast products
-        // 3  - Control forecast products
-        // 4  - Perturbed forecast products
-        // 5  - Control and perturbed forecast products
-        // 6  - Processed satellite observations
-        // 7  - Processed radar observations
-        if(verbose)
-          printArrInt("idsect", gribField->idsect, gribField->idsectlen);
-
-        if(gribField->idsectlen > 11)
-        {
-          // Read timestamp  ========================================
-          dataset.datetime = QDateTime(QDate(static_cast<int>(gribField->idsect[5]),
-                                             static_cast<int>(gribField->idsect[6]),
-                                             static_cast<int>(gribField->idsect[7])),
-                                       QTime(static_cast<int>(gribField->idsect[8]),
-                                             static_cast<int>(gribField->idsect[9]),
-                                             static_cast<int>(gribField->idsect[10])), QTimeZone::UTC);
-        }
-        if(!checkValue("Datetime is not valid", dataset.datetime.isValid(), true))
-          continue;
-
-        // gfld->ifldnum = field number within GRIB message
-        if(verbose)
-          qDebug() << "ifldnum" << gribField->ifldnum;
-
-        // Grid definition ====================================================================================
-        // gfld->griddef = Source of grid definition (see Code Table 3.0)
-        // 0 - Specified in Code table 3.1
-        // 1 - Predetermined grid Defined by originating centre
-        // https://www.nco.ncep.noaa.gov/pmb/docs/grib2/grib2_doc/grib2_table3-0.shtml
-        if(verbose)
-          qDebug() << Q_FUNC_INFO << "griddef" << gribField->griddef;
-        if(!checkValue("Grid definition", gribField->griddef, g2int(0)))
-          continue;
-
-        // gfld->igdtnum = Grid Definition Template Number (Code Table 3.1)
-        // Latitude/Longitude (See Template 3.0)
-        // https://www.nco.ncep.noaa.gov/pmb/docs/grib2/grib2_doc/grib2_table3-1.shtml
-        if(verbose)
-          qDebug() << Q_FUNC_INFO << "igdtnum" << gribField->igdtnum;
-        if(!checkValue("Grid Definition Template Number", gribField->igdtnum, g2int(0)))
-          continue;
-
-        // gfld->igdtmpl  = Contains the data values for the specified Grid
-        // Definition Template ( NN=gfld->igdtnum ).  Each
-        // element of this integer array contains an entry (in
-        // the order specified) of Grid Defintion Template 3.NN
-        // This element is a pointer to an array
-        // that holds the data.
-        // https://www.nco.ncep.noaa.gov/pmb/docs/grib2/grib2_doc/grib2_temp3-0.shtml
-
-        // 0  /  15 Shape of the Earth (See Code Table 3.2)
-        // 1  /  16 Scale Factor of radius of spherical Earth
-        // 2  /  17-20  Scale value of radius of spherical Earth
-        // 3  /  21 Scale factor of major axis of oblate spheroid Earth
-        // 4  /  22-25  Scaled value of major axis of oblate spheroid Earth
-        // 5  /  26 Scale factor of minor axis of oblate spheroid Earth
-        // 6  /  27-30  Scaled value of minor axis of oblate spheroid Earth
-        // 7  /  31-34  Ni — number of points along a parallel
-        // 8  /  35-38  Nj — number of points along a meridian
-        // 9  /  39-42  Basic angle of the initial production domain (see Note 1)
-        // 10 /  43-46  Subdivisions of basic angle used to define extreme longitudes and latitudes, and direction increments (see Note 1)
-        // 11 /  47-50  La1 — latitude of first grid point (see Note 1)
-        // 12 /  51-54  Lo1 — longitude of first grid point (see Note 1)
-        // 13 /  55 Resolution and component flags (see Flag Table 3.3)
-        // 14 /  56-59  La2 — latitude of last grid point (see Note 1)
-        // 15 /  60-63  Lo2 — longitude of last grid point (see Note 1)
-        // 16 /  64-67  Di — i direction increment (see Notes 1 and 5)
-        // 17 /  68-71  Dj — j direction increment (see Note 1 and 5)
-        // 18 /  72 Scanning mode (flags — see Flag Table 3.4 and Note 6)
-        // List of number of points along each meridian or parallel
-        // (These octets are only present for quasi-regular grids as described in notes 2 and 3)
-
-        if(verbose)
-          // -      [0, 1, 2, 3, 4, 5, 6,   7,   8, 9,         10,       11,12, 13,        14,        15,      16,      17,18]
-          // igdtmpl[6, 0, 0, 0, 0, 0, 0, 360, 181, 0, 4294967295, 90000000, 0, 48, -90000000, 359000000, 1000000, 1000000, 0]
-          printArrInt("igdtmpl", gribField->igdtmpl, gribField->igdtlen);
-
-        if(!checkValue("shape of earth", gribField->igdtmpl[0], g2int(6)))
-          continue;
-        if(!checkValue("radius scale factor", gribField->igdtmpl[1], g2int(0)))
-          continue;
-        if(!checkValue("scale value", gribField->igdtmpl[2], g2int(0)))
-          continue;
-        if(!checkValue("scale factor of major axis", gribField->igdtmpl[3], g2int(0)))
-          continue;
-        if(!checkValue("scale value of major axis", gribField->igdtmpl[4], g2int(0)))
-          continue;
-        if(!checkValue("scale factor of minor axis", gribField->igdtmpl[5], g2int(0)))
-          continue;
-        if(!checkValue("scale value of minor axis", gribField->igdtmpl[6], g2int(0)))
-          continue;
-        if(!checkValue("Ni", gribField->igdtmpl[7], g2int(360)))
-          continue;
-        if(!checkValue("Nj", gribField->igdtmpl[8], g2int(181)))
-          continue;
-        if(!checkValue("Basic angle", gribField->igdtmpl[9], g2int(0)))
-          continue;
-        if(!checkValue("resolution component flags", gribField->igdtmpl[13], g2int(48)))
-          continue;
-        if(!checkValue("scanning mode flags", gribField->igdtmpl[18], g2int(0)))
-          continue;
-
-        // if(!checkValue("i increment", gfld->igdtmpl[16], g2int(1))) continue;
-        // if(!checkValue("j increment", gfld->igdtmpl[17], g2int(1))) continue;
-
-        // g2int di = gfld->igdtmpl[16], dj = gfld->igdtmpl[17];
-        // dataset.firstLatY = gfld->igdtmpl[11] / dj;
-        // dataset.firstLonX = gfld->igdtmpl[12] / di;
-        // dataset.lastLatY = gfld->igdtmpl[14] / dj;
-        // dataset.lastLonX = gfld->igdtmpl[15] / di;
-
-        // Product definition ====================================================================================
-        // gfdl->ipdtnum = Product Definition Template Number(see Code Table 4.0)
-        // Analysis or forecast at a horizontal level or in a horizontal layer at a point in time.
-        if(verbose)
-          qDebug() << "ipdtnum" << gribField->ipdtnum;
-
-        // gfld->ipdtmpl  = Contains the data values for the specified Product
-        // Definition Template ( N=gfdl->ipdtnum ). Each element
-        // of this integer array contains an entry (in the
-        // order specified) of Product Defintion Template 4.N.
-        // This element is a pointer to an array
-        // that holds the data.
-        // https://www.nco.ncep.noaa.gov/pmb/docs/grib2/grib2_doc/grib2_temp4-0.shtml
-        // https://www.nco.ncep.noaa.gov/pmb/docs/grib2/grib2_doc/grib2_table4-2-0-2.shtml
-        // 0  / 10 Parameter category (see Code table 4.1)
-        // 1  / 11 Parameter number (see Code table 4.2)
-        // 2  / 12 Type of generating process (see Code table 4.3)
-        // 3  / 13 Background generating process identifier (defined by originating centre)
-        // 4  / 14 Analysis or forecast generating process identified (see Code ON388 Table A)
-        // 5  / 15-16 Hours of observational data cutoff after reference time (see Note)
-        // 6  / 17 Minutes of observational data cutoff after reference time (see Note)
-        // 7  / 18 Indicator of unit of time range (see Code table 4.4)
-        // 8  / 19-22 Forecast time in units defined by octet 18
-        // 9  / 23 Type of first fixed surface (see Code table 4.5)
-        // 10 / 24 Scale factor of first fixed surface
-        // 11 / 25-28 Scaled value of first fixed surface
-        // 12 / 29 Type of second fixed surfaced (see Code table 4.5)
-        // 13 / 30 Scale factor of second fixed surface
-        // 14 / 31-34 Scaled value of second fixed surfaces
-        // -          [0, 1, 2, 3,  4, 5, 6, 7, 8,   9,10,    11,  12,13,14
-        // ipdtmpl(15)[2, 2, 0, 0, 81, 0, 0, 1, 0, 100, 0, 20000, 255, 0, 0]
-        if(verbose)
-          printArrInt("ipdtmpl", gribField->ipdtmpl, gribField->ipdtlen);
-
-        if(!checkValue("Parameter category", gribField->ipdtmpl[0], g2int(2)))
-          continue;
-        if(!checkValue("Parameter number", gribField->ipdtmpl[1], {g2int(2), g2int(3)}))
-          continue;
-        if(gribField->ipdtmpl[1] == 2)
-          dataset.parameterType = U_WIND;
-        else if(gribField->ipdtmpl[1] == 3)
-          dataset.parameterType = V_WIND;
-
-        if(!checkValue("Time range", gribField->ipdtmpl[7], g2int(1)))
-          continue;
-        if(!checkValue("Surface type", gribField->ipdtmpl[9], {g2int(100), g2int(103)}))
-          continue;
-        if(gribField->ipdtmpl[9] == 100)
-        {
-          dataset.surfaceType = MBAR;
-          dataset.surface =
-            (gribField->ipdtmpl[11] / (gribField->ipdtmpl[10] > 0 ? gribField->ipdtmpl[10] : 1.f)) / 100.f;
-          dataset.altFeetCalculated = atools::geo::meterToFeet(atools::geo::altMeterForPressureMbar(dataset.surface));
-          // Round altitude to the next 2000 feet
-          dataset.altFeetRounded = std::round(dataset.altFeetCalculated / 2000.f) * 2000.f;
-        }
-        else if(gribField->ipdtmpl[9] == 103)
-        {
-          dataset.surfaceType = METER_AGL;
-          dataset.surface = gribField->ipdtmpl[11] / (gribField->ipdtmpl[10] > 0 ? gribField->ipdtmpl[10] : 1.f);
-          dataset.altFeetCalculated = atools::geo::meterToFeet(dataset.surface);
-          // Round altitude to the next 2000 feet
-          dataset.altFeetRounded = std::round(dataset.altFeetCalculated / 10.f) * 10.f;
-        }
-
-        if(!checkValue("Second surface scale factor", gribField->ipdtmpl[13], g2int(0)))
-          continue;
-        if(!checkValue("Second surface value", gribField->ipdtmpl[14], g2int(0)))
-          continue;
-
-        if(verbose)
-          qDebug() << "Calculated altitude" << dataset.altFeetCalculated
-                   << "rounded altitude" << dataset.altFeetRounded;
-
-        // Pack/unpack flags (ignored) ====================================================================================
-        // gfld->unpacked = logical value indicating whether the bitmap and
-        // data values were unpacked.  If false,
-        if(!checkValue("Unpacked", gribField->unpacked, g2int(1)))
-          continue;
-        // gfld->bmap and gfld->fld pointers are nullified.
-        // gfld->expanded = Logical value indicating whether the data field
-        // was expanded to the grid in the case where a
-        // bit-map is present.  If true, the data points in
-        // gfld->fld match the grid points and zeros were
-        // inserted at grid points where data was bit-mapped
-        // out.  If false, the data values in gfld->fld were
-        // not expanded to the grid and are just a consecutive
-        // array of data points corresponding to each value of
-        // "1" in gfld->bmap.
-        if(!checkValue("Unpacked", gribField->expanded, g2int(1)))
-          continue;
-        // https://www.nco.ncep.noaa.gov/pmb/docs/grib2/grib2_doc/grib2_table3-3.shtml
-
-        // Data ====================================================================================
-        // gfld->fld  = Array of gfld->ndpts unpacked data points.
-        if(verbose)
-          printArrFloat("fld", gribField->fld, std::min(gribField->ndpts, g2int(100)));
-
-        if(verbose)
-          qDebug() << Q_FUNC_INFO
-                   << "param type" << dataset.parameterType
-                   << "surface" << dataset.surface
-                   << "surface type" << dataset.surfaceType
-                   << "alt calculated" << dataset.altFeetCalculated
-                   << "alt rounded" << dataset.altFeetRounded;
-
-        // Copy data as is
-        for(int i = 0; i < gribField->ndpts; i++)
-          dataset.data.append(gribField->fld[i]);
-
-        datasets.append(dataset);
-
-        // checkValue("Number of values", g2int(dataset.data.size()),
-        // g2int(std::abs(dataset.lastLonX - dataset.firstLonX + 1) *
-        // std::abs(dataset.firstLatY - dataset.lastLatY + 1)));
+  if(verbose)
+  {
+    // gfld->version = GRIB edition number ( currently 2 )
+    // gfld->discipline = Message Discipline ( see Code Table 0.0 )
+    qDebug() << Q_FUNC_INFO << "===================================";
+    qDebug() << Q_FUNC_INFO << "field" << fieldNum << "version" << gribField->version << "discipline" << gribField->discipline;
+  }
 
-        g2_free(gribField);
-      }
-      delete[] cgrib;
-    }
+  // ID section ====================================================================================
+  // gfld->idsect = Contains the entries in the Identification
+  // Section ( Section 1 )
+  // This element is a pointer to an array
+  // that holds the data.
+  // gfld->idsect[0]  = Identification of originating Centre
+  // ( see Common Code Table C-1 )
+  // 7 - US National Weather Service
+  // gfld->idsect[1]  = Identification of originating Sub-centre
+  // gfld->idsect[2]  = GRIB Master Tables Version Number
+  // ( see Code Table 1.0 )
+  // 0 - Experimental
+  // 1 - Initial operational version number
+  // gfld->idsect[3]  = GRIB Local Tables Version Number
+  // ( see Code Table 1.1 )
+  // 0     - Local tables not used
+  // 1-254 - Number of local tables version used
+  // gfld->idsect[4]  = Significance of Reference Time (Code Table 1.2)
+  // 0 - Analysis
+  // 1 - Start of forecast
+  // 2 - Verifying time of forecast
+  // 3 - Observation time
+  // gfld->idsect[5]  = Year ( 4 digits )
+  // gfld->idsect[6]  = Month
+  // gfld->idsect[7)  = Day
+  // gfld->idsect[8]  = Hour
+  // gfld->idsect[9]  = Minute
+  // gfld->idsect[10]  = Second
+  // gfld->idsect[11]  = Production status of processed data
+  // ( see Code Table 1.3 )
+  // 0 - Operational products
+  // 1 - Operational test products
+  // 2 - Research products
+  // 3 - Re-analysis products
+  // gfld->idsect[12]  = Type of processed data ( see Code Table 1.4 )
+  // 0  - Analysis products
+  // 1  - Forecast products
+  // 2  - Analysis and forecast products
+  // 3  - Control forecast products
+  // 4  - Perturbed forecast products
+  // 5  - Control and perturbed forecast products
+  // 6  - Processed satellite observations
+  // 7  - Processed radar observations
+  if(verbose)
+    printArrInt("idsect", gribField->idsect, gribField->idsectlen);
 
-    // Sort first by altitude from low to high and second by parameter type from U to V
-    std::sort(datasets.begin(), datasets.end(),
-              [](const atools::grib::GribDataset& d1, const atools::grib::GribDataset& d2) -> bool
-        {
-          if(atools::almostEqual(d1.altFeetCalculated, d2.altFeetCalculated))
-            return d1.parameterType < d2.parameterType;
-          else
-            return d1.altFeetCalculated < d2.altFeetCalculated;
-        });
-
-    fclose(fptr);
+  if(gribField->idsectlen > 11)
+  {
+    // Read timestamp  ========================================
+    dataset.datetime = QDateTime(QDate(static_cast<int>(gribField->idsect[5]),
+                                       static_cast<int>(gribField->idsect[6]),
+                                       static_cast<int>(gribField->idsect[7])),
+                                 QTime(static_cast<int>(gribField->idsect[8]),
+                                       static_cast<int>(gribField->idsect[9]),
+                                       static_cast<int>(gribField->idsect[10])), QTimeZone::UTC);
   }
-  else
-    throw atools::Exception(tr("Cannot open file %1").arg(filename));
+  if(!checkValue("Datetime is not valid", dataset.datetime.isValid(), true))
+    return false;
 
-#if defined(Q_OS_WIN32)
-  delete[] path;
-#endif
+  // gfld->ifldnum = field number within GRIB message
+  if(verbose)
+    qDebug() << "ifldnum" << gribField->ifldnum;
 
-  if(datasets.isEmpty())
-    throw atools::Exception(tr("Wrong GRIB file type"));
+  // Grid definition ====================================================================================
+  // gfld->griddef = Source of grid definition (see Code Table 3.0)
+  // 0 - Specified in Code table 3.1
+  // 1 - Predetermined grid Defined by originating centre
+  // https://www.nco.ncep.noaa.gov/pmb/docs/grib2/grib2_doc/grib2_table3-0.shtml
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << "griddef" << gribField->griddef;
+  if(!checkValue("Grid definition", gribField->griddef, g2int(0)))
+    return false;
+
+  // gfld->igdtnum = Grid Definition Template Number (Code Table 3.1)
+  // Latitude/Longitude (See Template 3.0)
+  // https://www.nco.ncep.noaa.gov/pmb/docs/grib2/grib2_doc/grib2_table3-1.shtml
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << "igdtnum" << gribField->igdtnum;
+  if(!checkValue("Grid Definition Template Number", gribField->igdtnum, g2int(0)))
+    return false;
+
+  // gfld->igdtmpl  = Contains the data values for the specified Grid
+  // Definition Template ( NN=gfld->igdtnum ).  Each
+  // element of this integer array contains an entry (in
+  // the order specified) of Grid Defintion Template 3.NN
+  // This element is a pointer to an array
+  // that holds the data.
+  // https://www.nco.ncep.noaa.gov/pmb/docs/grib2/grib2_doc/grib2_temp3-0.shtml
+
+  // 0  /  15 Shape of the Earth (See Code Table 3.2)
+  // 1  /  16 Scale Factor of radius of spherical Earth
+  // 2  /  17-20  Scale value of radius of spherical Earth
+  // 3  /  21 Scale factor of major axis of oblate spheroid Earth
+  // 4  /  22-25  Scaled value of major axis of oblate spheroid Earth
+  // 5  /  26 Scale factor of minor axis of oblate spheroid Earth
+  // 6  /  27-30  Scaled value of minor axis of oblate spheroid Earth
+  // 7  /  31-34  Ni — number of points along a parallel
+  // 8  /  35-38  Nj — number of points along a meridian
+  // 9  /  39-42  Basic angle of the initial production domain (see Note 1)
+  // 10 /  43-46  Subdivisions of basic angle used to define extreme longitudes and latitudes, and direction increments (see Note 1)
+  // 11 /  47-50  La1 — latitude of first grid point (see Note 1)
+  // 12 /  51-54  Lo1 — longitude of first grid point (see Note 1)
+  // 13 /  55 Resolution and component flags (see Flag Table 3.3)
+  // 14 /  56-59  La2 — latitude of last grid point (see Note 1)
+  // 15 /  60-63  Lo2 — longitude of last grid point (see Note 1)
+  // 16 /  64-67  Di — i direction increment (see Notes 1 and 5)
+  // 17 /  68-71  Dj — j direction increment (see Note 1 and 5)
+  // 18 /  72 Scanning mode (flags — see Flag Table 3.4 and Note 6)
+  // List of number of points along each meridian or parallel
+  // (These octets are only present for quasi-regular grids as described in notes 2 and 3)
+
+  if(verbose)
+    // -      [0, 1, 2, 3, 4, 5, 6,   7,   8, 9,         10,       11,12, 13,        14,        15,      16,      17,18]
+    // igdtmpl[6, 0, 0, 0, 0, 0, 0, 360, 181, 0, 4294967295, 90000000, 0, 48, -90000000, 359000000, 1000000, 1000000, 0]
+    printArrInt("igdtmpl", gribField->igdtmpl, gribField->igdtlen);
+
+  if(!checkValue("shape of earth", gribField->igdtmpl[0], g2int(6)))
+    return false;
+  if(!checkValue("radius scale factor", gribField->igdtmpl[1], g2int(0)))
+    return false;
+  if(!checkValue("scale value", gribField->igdtmpl[2], g2int(0)))
+    return false;
+  if(!checkValue("scale factor of major axis", gribField->igdtmpl[3], g2int(0)))
+    return false;
+  if(!checkValue("scale value of major axis", gribField->igdtmpl[4], g2int(0)))
+    return false;
+  if(!checkValue("scale factor of minor axis", gribField->igdtmpl[5], g2int(0)))
+    return false;
+  if(!checkValue("scale value of minor axis", gribField->igdtmpl[6], g2int(0)))
+    return false;
+  if(!checkValue("Ni", gribField->igdtmpl[7], g2int(360)))
+    return false;
+  if(!checkValue("Nj", gribField->igdtmpl[8], g2int(181)))
+    return false;
+  if(!checkValue("Basic angle", gribField->igdtmpl[9], g2int(0)))
+    return false;
+  if(!checkValue("resolution component flags", gribField->igdtmpl[13], g2int(48)))
+    return false;
+  if(!checkValue("scanning mode flags", gribField->igdtmpl[18], g2int(0)))
+    return false;
+
+  // if(!checkValue("i increment", gfld->igdtmpl[16], g2int(1))) continue;
+  // if(!checkValue("j increment", gfld->igdtmpl[17], g2int(1))) continue;
+
+  // g2int di = gfld->igdtmpl[16], dj = gfld->igdtmpl[17];
+  // dataset.firstLatY = gfld->igdtmpl[11] / dj;
+  // dataset.firstLonX = gfld->igdtmpl[12] / di;
+  // dataset.lastLatY = gfld->igdtmpl[14] / dj;
+  // dataset.lastLonX = gfld->igdtmpl[15] / di;
+
+  // Product definition ====================================================================================
+  // gfdl->ipdtnum = Product Definition Template Number(see Code Table 4.0)
+  // Analysis or forecast at a horizontal level or in a horizontal layer at a point in time.
+  if(verbose)
+    qDebug() << "ipdtnum" << gribField->ipdtnum;
+
+  // gfld->ipdtmpl  = Contains the data values for the specified Product
+  // Definition Template ( N=gfdl->ipdtnum ). Each element
+  // of this integer array contains an entry (in the
+  // order specified) of Product Defintion Template 4.N.
+  // This element is a pointer to an array
+  // that holds the data.
+  // https://www.nco.ncep.noaa.gov/pmb/docs/grib2/grib2_doc/grib2_temp4-0.shtml
+  // https://www.nco.ncep.noaa.gov/pmb/docs/grib2/grib2_doc/grib2_table4-2-0-2.shtml
+  // 0  / 10 Parameter category (see Code table 4.1)
+  // 1  / 11 Parameter number (see Code table 4.2)
+  // 2  / 12 Type of generating process (see Code table 4.3)
+  // 3  / 13 Background generating process identifier (defined by originating centre)
+  // 4  / 14 Analysis or forecast generating process identified (see Code ON388 Table A)
+  // 5  / 15-16 Hours of observational data cutoff after reference time (see Note)
+  // 6  / 17 Minutes of observational data cutoff after reference time (see Note)
+  // 7  / 18 Indicator of unit of time range (see Code table 4.4)
+  // 8  / 19-22 Forecast time in units defined by octet 18
+  // 9  / 23 Type of first fixed surface (see Code table 4.5)
+  // 10 / 24 Scale factor of first fixed surface
+  // 11 / 25-28 Scaled value of first fixed surface
+  // 12 / 29 Type of second fixed surfaced (see Code table 4.5)
+  // 13 / 30 Scale factor of second fixed surface
+  // 14 / 31-34 Scaled value of second fixed surfaces
+  // -          [0, 1, 2, 3,  4, 5, 6, 7, 8,   9,10,    11,  12,13,14
+  // ipdtmpl(15)[2, 2, 0, 0, 81, 0, 0, 1, 0, 100, 0, 20000, 255, 0, 0]
+  if(verbose)
+    printArrInt("ipdtmpl", gribField->ipdtmpl, gribField->ipdtlen);
+
+  if(!checkValue("Parameter category", gribField->ipdtmpl[0], g2int(2)))
+    return false;
+  if(!checkValue("Parameter number", gribField->ipdtmpl[1], {g2int(2), g2int(3)}))
+    return false;
+  if(gribField->ipdtmpl[1] == 2)
+    dataset.parameterType = U_WIND;
+  else if(gribField->ipdtmpl[1] == 3)
+    dataset.parameterType = V_WIND;
+
+  if(!checkValue("Time range", gribField->ipdtmpl[7], g2int(1)))
+    return false;
+  if(!checkValue("Surface type", gribField->ipdtmpl[9], {g2int(100), g2int(103)}))
+    return false;
+  if(gribField->ipdtmpl[9] == 100)
+  {
+    dataset.surfaceType = MBAR;
+    dataset.surface =
+      (gribField->ipdtmpl[11] / (gribField->ipdtmpl[10] > 0 ? gribField->ipdtmpl[10] : 1.f)) / 100.f;
+    dataset.altFeetCalculated = atools::geo::meterToFeet(atools::geo::altMeterForPressureMbar(dataset.surface));
+    // Round altitude to the next 2000 feet
+    dataset.altFeetRounded = std::round(dataset.altFeetCalculated / 2000.f) * 2000.f;
+  }
+  else if(gribField->ipdtmpl[9] == 103)
+  {
+    dataset.surfaceType = METER_AGL;
+    dataset.surface = gribField->ipdtmpl[11] / (gribField->ipdtmpl[10] > 0 ? gribField->ipdtmpl[10] : 1.f);
+    dataset.altFeetCalculated = atools::geo::meterToFeet(dataset.surface);
+    // Round altitude to the next 2000 feet
+    dataset.altFeetRounded = std::round(dataset.altFeetCalculated / 10.f) * 10.f;
+  }
+
+  if(!checkValue("Second surface scale factor", gribField->ipdtmpl[13], g2int(0)))
+    return false;
+  if(!checkValue("Second surface value", gribField->ipdtmpl[14], g2int(0)))
+    return false;
+
+  if(verbose)
+    qDebug() << "Calculated altitude" << dataset.altFeetCalculated
+             << "rounded altitude" << dataset.altFeetRounded;
+
+  // Pack/unpack flags (ignored) ====================================================================================
+  // gfld->unpacked = logical value indicating whether the bitmap and
+  // data values were unpacked.  If false,
+  if(!checkValue("Unpacked", gribField->unpacked, g2int(1)))
+    return false;
+  // gfld->bmap and gfld->fld pointers are nullified.
+  // gfld->expanded = Logical value indicating whether the data field
+  // was expanded to the grid in the case where a
+  // bit-map is present.  If true, the data points in
+  // gfld->fld match the grid points and zeros were
+  // inserted at grid points where data was bit-mapped
+  // out.  If false, the data values in gfld->fld were
+  // not expanded to the grid and are just a consecutive
+  // array of data points corresponding to each value of
+  // "1" in gfld->bmap.
+  if(!checkValue("Unpacked", gribField->expanded, g2int(1)))
+    return false;
+  // https://www.nco.ncep.noaa.gov/pmb/docs/grib2/grib2_doc/grib2_table3-3.shtml
+
+  // Data ====================================================================================
+  // gfld->fld  = Array of gfld->ndpts unpacked data points.
+  if(verbose)
+    printArrFloat("fld", gribField->fld, std::min(gribField->ndpts, g2int(100)));
+
+  if(verbose)
+    qDebug() << Q_FUNC_INFO
+             << "param type" << dataset.parameterType
+             << "surface" << dataset.surface
+             << "surface type" << dataset.surfaceType
+             << "alt calculated" << dataset.altFeetCalculated
+             << "alt rounded" << dataset.altFeetRounded;
+
+  // Copy data as is
+  dataset.data.reserve(gribField->ndpts);
+  for(int i = 0; i < gribField->ndpts; i++)
+    dataset.data.append(gribField->fld[i]);
+
+  // checkValue("Number of values", g2int(dataset.data.size()),
+  // g2int(std::abs(dataset.lastLonX - dataset.firstLonX + 1) *
+  // std::abs(dataset.firstLatY - dataset.lastLatY + 1)));
+
+  return true;
+}
+
+void GribReader::sortDatasets()
+{
+  // Sort first by altitude from low to high and second by parameter type from U to V
+  std::sort(datasets.begin(), datasets.end(),
+            [](const atools::grib::GribDataset& d1, const atools::grib::GribDataset& d2) -> bool
+      {
+        if(atools::almostEqual(d1.altFeetCalculated, d2.altFeetCalculated))
+          return d1.parameterType < d2.parameterType;
+        else
+          return d1.altFeetCalculated < d2.altFeetCalculated;
+      });
+}
+
+void GribReader::readFile(const QString& filename)
+{
+  if(QFileInfo(filename).size() == 0)
+    // Print only a warning since X-Plane seems to download zero length files from time to time
+    qWarning() << Q_FUNC_INFO << "GRIB file" << filename << "is empty";
+
+  if(!validateGribFile(filename))
+    throw atools::Exception(tr("Not a valid GRIB file: \"%1\"").arg(filename));
+
+  QFile file(filename);
+  if(!file.open(QIODevice::ReadOnly))
+    throw atools::Exception(tr("Cannot open file %1").arg(filename));
+
+  // Read all messages at once to decode them in parallel
+  beginData();
+  buffer = file.readAll();
+  file.close();
+  finishData();
 }
 
 void GribReader::readData(const QByteArray& data)
@@ -476,23 +461,161 @@ void GribReader::readData(const QByteArray& data)
   if(!validateGribData(data))
     throw atools::Exception(tr("Not a GRIB file"));
 
-  // Create a temporary file since the GRIB reader can only deal with files
-  atools::io::TempFile temp(data, ".grib");
+  // Decode messages directly from memory
+  beginData();
+  appendData(data);
+  finishData();
+}
 
+void GribReader::beginData()
+{
   datasets.clear();
-  readFile(temp.getFilePath());
+  buffer.clear();
+  numMessages = 0;
+}
+
+void GribReader::appendData(const QByteArray& data)
+{
+  buffer.append(data);
+  decodeBuffer();
+}
+
+void GribReader::finishData()
+{
+  decodeBuffer();
+
+  if(!buffer.isEmpty())
+    qWarning() << Q_FUNC_INFO << "Incomplete GRIB message ignored" << buffer.size() << "bytes";
+  buffer.clear();
+  buffer.squeeze();
+
+  sortDatasets();
 
   if(verbose)
   {
-    qDebug() << Q_FUNC_INFO << "Datasets ============================================================";
+    qDebug() << Q_FUNC_INFO << "Messages" << numMessages
+             << "Datasets ============================================================";
     for(const GribDataset& dataset : std::as_const(datasets))
       qDebug() << dataset;
   }
+
+  if(datasets.isEmpty())
+    throw atools::Exception(tr("Wrong GRIB file type"));
+}
+
+void GribReader::decodeBuffer()
+{
+  // Offset and length of complete messages
+  QList<std::pair<qsizetype, qsizetype> > messages;
+  qsizetype pos = 0;
+  while(true)
+  {
+    qsizetype start = buffer.indexOf("GRIB", pos);
+    if(start == -1)
+    {
+      // Keep a partial marker at the end
+      pos = std::max(pos, buffer.size() - 3);
+      break;
+    }
+
+    // Need section 0 to get the message length
+    if(buffer.size() - start < SECTION0_SIZE)
+    {
+      pos = start;
+      break;
+    }
+
+    // Section 0: "GRIB", two reserved bytes, discipline, edition and eight bytes of total message length
+    const uchar *section0 = reinterpret_cast<const uchar *>(buffer.constData() + start);
+    quint64 length = qFromBigEndian<quint64>(section0 + 8);
+    if(section0[7] != 2 || length < SECTION0_SIZE + 4 || length > MAX_MESSAGE_SIZE)
+    {
+      // Not a GRIB2 message or garbage - look for next marker
+      pos = start + 4;
+      continue;
+    }
+
+    // Wait for more data
+    if(static_cast<quint64>(buffer.size() - start) < length)
+    {
+      pos = start;
+      break;
+    }
+
+    if(buffer.mid(start + static_cast<qsizetype>(length) - 4, 4) != "7777")
+    {
+      qWarning() << Q_FUNC_INFO << "GRIB end marker missing at" << start;
+      pos = start + 4;
+      continue;
+    }
+
+    messages.append(std::make_pair(start, static_cast<qsizetype>(length)));
+    pos = start + static_cast<qsizetype>(length);
+  }
+
+  if(!messages.isEmpty())
+  {
+    uchar *data = reinterpret_cast<uchar *>(buffer.data());
+
+    // Get number of fields for all messages and build a list of message and field number to decode ==========
+    QList<std::pair<uchar *, int> > fields;
+    for(const std::pair<qsizetype, qsizetype>& message : std::as_const(messages))
+    {
+      uchar *cgrib = data + message.first;
+      int numFields = messageFields(cgrib);
+      if(numFields < 0)
+        throw atools::Exception(tr("Cannot decode GRIB message"));
+
+      for(int fieldNum = 1; fieldNum <= numFields; fieldNum++)
+        fields.append(std::make_pair(cgrib, fieldNum));
+    }
+
+    // Unpacking is independent for each field - decode into separate datasets to keep the order ==========
+    int numFields = static_cast<int>(fields.size());
+    GribDatasetList results(numFields);
+    QList<char> valid(numFields, false);
+    GribDataset *resultData = results.data();
+    char *validData = valid.data();
+    const std::pair<uchar *, int> *fieldData = fields.constData();
+
+    int numThreads = std::max(1, std::min(QThread::idealThreadCount(), numFields));
+    if(numThreads > 1)
+    {
+      QThreadPool pool;
+      pool.setMaxThreadCount(numThreads);
+      for(int i = 0; i < numFields; i++)
+      {
+        pool.start([this, resultData, validData, fieldData, i]() -> void {
+              validData[i] = decodeField(resultData[i], fieldData[i].first, fieldData[i].second);
+            });
+      }
+      pool.waitForDone();
+    }
+    else
+    {
+      for(int i = 0; i < numFields; i++)
+        validData[i] = decodeField(resultData[i], fieldData[i].first, fieldData[i].second);
+    }
+
+    // Fields which are not wind or do not match the grid are skipped
+    for(int i = 0; i < numFields; i++)
+    {
+      if(valid.at(i))
+        datasets.append(results.at(i));
+    }
+    numMessages += static_cast<int>(messages.size());
+  }
+
+  // Drop consumed messages
+  if(pos > 0)
+    buffer.remove(0, std::min(pos, buffer.size()));
 }
 
 void GribReader::clear()
 {
   datasets.clear();
+  buffer.clear();
+  numMessages = 0;
 }
 
 bool GribReader::validateGribFile(const QString& path)
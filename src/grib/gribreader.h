@@ -28,6 +28,7 @@ namespace grib {
 
 /*
  * Reads and decodes a GRIB2 data file into a GribDatasetVector.
+ * All fields of all messages are unpacked in parallel.
  * Only U/V wind, full earth bounding rectangle and one-degree raster supported.
  * Throws atools::Exception if parameters are not correct.
  *
@@ -46,6 +47,21 @@ public:
   void readFile(const QString& filename);
   void readData(const QByteArray& data);
 
+  /* Incremental decoding of a GRIB2 stream, e.g. while downloading. Call beginData() first and then appendData()
+   * for each received chunk. Each message is decoded as soon as it is complete and its bytes are dropped
+   * so only one message is kept in memory.
+   * finishData() sorts the datasets and throws atools::Exception if nothing was found.
+   * appendData() throws atools::Exception if a complete message cannot be decoded. */
+  void beginData();
+  void appendData(const QByteArray& data);
+  void finishData();
+
+  /* Number of messages decoded from the stream */
+  int getNumMessages() const
+  {
+    return numMessages;
+  }
+
   /* Clear dataset for reuse */
   void clear();
 
@@ -60,7 +76,24 @@ public:
   static bool validateGribData(QByteArray bytes);
 
 private:
+  /* Number of fields in a GRIB2 message in memory or -1 if the message is invalid */
+  int messageFields(unsigned char *cgrib) const;
+
+  /* Decode field number fieldNum (starting at 1) of a GRIB2 message in memory.
+   * false if field cannot be unpacked or is not a supported wind field. Thread safe. */
+  bool decodeField(atools::grib::GribDataset& dataset, unsigned char *cgrib, int fieldNum) const;
+
+  /* Decode all fields of all complete messages in buffer in parallel and remove them */
+  void decodeBuffer();
+
+  /* Sort by altitude and parameter */
+  void sortDatasets();
+
   atools::grib::GribDatasetList datasets;
+
+  /* Incomplete message for incremental decoding */
+  QByteArray buffer;
+  int numMessages = 0;
   bool verbose = false;
 };
 
@@ -26,9 +26,16 @@
 #include "grib/gribdownloader.h"
 #include "grib/gribreader.h"
 #include "util/filesystemwatcher.h"
+#include "util/memoryusage.h"
+#include "util/tracer.h"
 #include "fs/util/fsutil.h"
 
 #include <QDir>
+#include <QMutex>
+#include <QThread>
+#include <QThreadPool>
+
+#include <limits>
 
 using atools::grib::GribDownloader;
 using atools::geo::Rect;
@@ -78,7 +85,16 @@ struct WindData
 struct WindAltLayer
 {
   int altitude = 0;
+
+  /* Full precision wind grid. Empty if compact storage is used. */
   QList<WindData> winds;
+
+  /* Quantized U and V components interleaved if compact storage is used. The array is shared by all layers
+   * of a dataset which are stored one after the other in altitude order each having GRID_SIZE points. */
+  QList<qint16> compactWinds;
+
+  /* Offset into compactWinds if compact storage is used or -1 */
+  int compactOffset = -1;
   float surface;
 
   bool operator<(const WindAltLayer& l) const
@@ -96,9 +112,10 @@ struct WindAltLayer
     return !(*this == l);
   }
 
+  /* A layer without data returns zero wind */
   bool isValid() const
   {
-    return !winds.isEmpty();
+    return !winds.isEmpty() || compactOffset >= 0;
   }
 
   /* Allowed altitude inaccuracy when comparing layer altitudes. */
@@ -107,6 +124,22 @@ struct WindAltLayer
 
 const static atools::grib::WindData EMPTY_WIND_DATA = {0.f, 0.f};
 
+/* Number of points in the one degree grid having 360 columns and 181 rows */
+const static int GRID_SIZE = 360 * 181;
+
+/* Minimum number of line samples per thread for batched evaluation */
+const static int MIN_SAMPLES_PER_THREAD = 512;
+
+/* Compact storage keeps wind components in 1/100 knots which allows up to 327 knots */
+const static float COMPACT_SCALE = 100.f;
+const static float COMPACT_INV_SCALE = 1.f / COMPACT_SCALE;
+
+/* Quantize wind component in knots */
+inline qint16 compactValue(float knots)
+{
+  return static_cast<qint16>(std::max(-32767.f, std::min(std::round(knots * COMPACT_SCALE), 32767.f)));
+}
+
 /* One grid cell with all wind values at the corners for interpolation. top left corresponds to queried position. */
 struct WindRect
 {
@@ -135,10 +168,26 @@ QDebug operator<<(QDebug out, const Wind& wind)
 }
 
 // Private structure to hide above structs =======================================================================
+/* Wind layers for one forecast time. Loaded on first use if filename is set. */
+struct WindForecast
+{
+  QString filename;
+  QMap<int, WindAltLayer> windLayers;
+  bool loaded = false;
+};
+
 struct WindQueryPrivate
 {
   /* Maps rounded altitude to wind layer data. Sorted by altitude. */
   QMap<int, WindAltLayer> windLayers;
+
+  /* Additional datasets for time interpolation sorted by valid time */
+  QMap<QDateTime, WindForecast> forecasts;
+
+  /* Protects lazy loading of forecasts */
+  QMutex forecastMutex;
+
+  bool compactStorage = false;
 };
 
 /* Column number in grid */
@@ -321,6 +370,7 @@ void WindQuery::deinit()
 {
   analyisTime = QDateTime();
   p->windLayers.clear();
+  clearForecasts();
   downloader->stopDownload();
   fileWatcher->stopWatching();
   weatherPath.clear();
@@ -336,6 +386,45 @@ Wind WindQuery::getWindForPos(atools::geo::Pos pos, bool interpolateValue) const
     qWarning() << Q_FUNC_INFO << "invalid pos";
     return EMPTY_WIND;
   }
+
+  return windForPos(pos, p->windLayers, interpolateValue).toWind();
+}
+
+Wind WindQuery::getWindForPos(atools::geo::Pos pos, const QDateTime& time, bool interpolateValue) const
+{
+  if(p->forecasts.isEmpty() || !time.isValid())
+    return getWindForPos(pos, interpolateValue);
+
+  pos.normalize();
+
+  if(!pos.isValid())
+  {
+    qWarning() << Q_FUNC_INFO << "invalid pos";
+    return EMPTY_WIND;
+  }
+
+  // Find datasets before and after time
+  const QMap<int, WindAltLayer> *layers0 = nullptr, *layers1 = nullptr;
+  QDateTime time0, time1;
+  layersByTime(layers0, layers1, time0, time1, time);
+
+  if(layers0 == nullptr && layers1 == nullptr)
+    return getWindForPos(pos, interpolateValue);
+  else if(layers0 == nullptr || layers1 == nullptr || layers0 == layers1)
+    // Only one dataset or time outside of range
+    return windForPos(pos, layers0 != nullptr ? *layers0 : *layers1, interpolateValue).toWind();
+  else
+  {
+    // Interpolate U and V components linearly by time
+    WindData w0 = windForPos(pos, *layers0, interpolateValue);
+    WindData w1 = windForPos(pos, *layers1, interpolateValue);
+    return interpolateWind(w0, w1, 0.f, static_cast<float>(time0.secsTo(time1)),
+                           static_cast<float>(time0.secsTo(time))).toWind();
+  }
+}
+
+WindData WindQuery::windForPos(const geo::Pos& pos, const QMap<int, WindAltLayer>& windLayers, bool interpolateValue) const
+{
   // Calculate grid position
   QPoint gPos = gridPos(pos);
 
@@ -344,7 +433,7 @@ Wind WindQuery::getWindForPos(atools::geo::Pos pos, bool interpolateValue) const
 
   // Get next layers below and above altitude
   WindAltLayer lower, upper;
-  layersByAlt(lower, upper, pos.getAltitude());
+  layersByAlt(lower, upper, pos.getAltitude(), windLayers);
 
   if(!interpolateValue || pos.nearGrid(1.f, atools::geo::Pos::POS_EPSILON_500M))
   {
@@ -355,34 +444,118 @@ Wind WindQuery::getWindForPos(atools::geo::Pos pos, bool interpolateValue) const
     {
       WindData uW = windForLayer(upper, gPos);
       // Interpolate between upper and lower layer
-      return interpolateWind(lW, uW, lower.altitude, upper.altitude, pos.getAltitude()).toWind();
+      return interpolateWind(lW, uW, lower.altitude, upper.altitude, pos.getAltitude());
     }
     else
-      return lW.toWind();
+      return lW;
   }
   else
+    return windForSample(pos, lower, upper);
+}
+
+void WindQuery::addForecast(const QDateTime& validTime, const QString& filename)
+{
+  if(!validTime.isValid() || filename.isEmpty())
+  {
+    qWarning() << Q_FUNC_INFO << "Invalid forecast" << validTime << filename;
+    return;
+  }
+
+  WindForecast forecast;
+  forecast.filename = filename;
+  p->forecasts.insert(validTime, forecast);
+}
+
+void WindQuery::addForecast(const QDateTime& validTime, const GribDatasetList& datasets)
+{
+  if(!validTime.isValid())
   {
-    Rect global = globalRect(pos);
-    GridRect grid = gridRect(global);
+    qWarning() << Q_FUNC_INFO << "Invalid forecast time";
+    return;
+  }
 
-    // Interpolate wind within a grid rectangle for the lower layer
-    WindRect windRectLower;
-    windRectForLayer(windRectLower, lower, grid);
-    WindData lWind = interpolateRect(windRectLower, global, pos);
+  WindForecast forecast;
+  convertDataset(forecast.windLayers, datasets);
+  forecast.loaded = true;
+  p->forecasts.insert(validTime, forecast);
+}
 
-    if(upper != lower)
-    {
-      // Interpolate wind within a grid rectangle for the upper layer if layers differ
-      WindRect windRectUpper;
-      windRectForLayer(windRectUpper, upper, grid);
-      WindData uWind = interpolateRect(windRectUpper, global, pos);
+void WindQuery::clearForecasts()
+{
+  p->forecasts.clear();
+}
+
+QList<QDateTime> WindQuery::getForecastTimes() const
+{
+  return p->forecasts.keys();
+}
+
+const QMap<int, WindAltLayer>& WindQuery::forecastLayers(WindForecast& forecast) const
+{
+  QMutexLocker locker(&p->forecastMutex);
 
-      // Interpolate between upper and lower wind
-      return interpolateWind(lWind, uWind, lower.altitude, upper.altitude, pos.getAltitude()).toWind();
+  if(!forecast.loaded)
+  {
+    // Try only once
+    forecast.loaded = true;
+
+    try
+    {
+      GribReader reader(verbose);
+      reader.readFile(forecast.filename);
+      convertDataset(forecast.windLayers, reader.getDatasets());
     }
-    else
-      return lWind.toWind();
+    catch(atools::Exception& e)
+    {
+      qWarning() << Q_FUNC_INFO << "Error loading" << forecast.filename << e.what();
+    }
+    catch(...)
+    {
+      qWarning() << Q_FUNC_INFO << "Unknown error loading" << forecast.filename;
+    }
+  }
+  return forecast.windLayers;
+}
+
+void WindQuery::layersByTime(const QMap<int, WindAltLayer> *& layers0, const QMap<int, WindAltLayer> *& layers1,
+                             QDateTime& time0, QDateTime& time1, const QDateTime& time) const
+{
+  // Current dataset at analysis time is used like a forecast if not replaced by one
+  bool useCurrent = !p->windLayers.isEmpty() && analyisTime.isValid() && !p->forecasts.contains(analyisTime);
+
+  // Latest dataset at or before time
+  auto it = p->forecasts.upperBound(time);
+  if(it != p->forecasts.begin())
+  {
+    auto prev = std::prev(it);
+    time0 = prev.key();
+    layers0 = &forecastLayers(prev.value());
+  }
+
+  if(useCurrent && analyisTime <= time && (layers0 == nullptr || analyisTime > time0))
+  {
+    time0 = analyisTime;
+    layers0 = &p->windLayers;
+  }
+
+  // First dataset after time
+  if(it != p->forecasts.end())
+  {
+    time1 = it.key();
+    layers1 = &forecastLayers(it.value());
+  }
+
+  if(useCurrent && analyisTime > time && (layers1 == nullptr || analyisTime < time1))
+  {
+    time1 = analyisTime;
+    layers1 = &p->windLayers;
   }
+
+  // Ignore datasets which failed to load
+  if(layers0 != nullptr && layers0->isEmpty())
+    layers0 = nullptr;
+  if(layers1 != nullptr && layers1->isEmpty())
+    layers1 = nullptr;
 }
 
 WindPosList WindQuery::getWindForRect(const atools::geo::Rect& rect, float altFeet) const
@@ -411,7 +584,7 @@ void WindQuery::getWindForRect(WindPosList& result, atools::geo::Rect rect, floa
   {
     // Get next layers below and above altitude
     WindAltLayer lower, upper;
-    layersByAlt(lower, upper, altFeet);
+    layersByAlt(lower, upper, altFeet, p->windLayers);
 
     // Split rectangle if it crosses the anti-meridian (date line)
     for(const atools::geo::Rect& splitRect : rect.splitAtAntiMeridian())
@@ -455,11 +628,13 @@ Wind WindQuery::getWindAverageForLineString(const geo::LineString& linestring) c
     return getWindAverageForLine(linestring.toLine());
   else
   {
+    QList<WindData> legWinds;
+    windAverageForLegs(legWinds, linestring);
+
     WindData windData = EMPTY_WIND_DATA;
     // Sum up values
-    for(int i = 0; i < linestring.size() - 1; i++)
+    for(const WindData& wd : std::as_const(legWinds))
     {
-      WindData wd = windAverageForLine(linestring.at(i), linestring.at(i + 1));
       windData.u += wd.u;
       windData.v += wd.v;
     }
@@ -472,6 +647,16 @@ Wind WindQuery::getWindAverageForLineString(const geo::LineString& linestring) c
   }
 }
 
+void WindQuery::getWindAverageForLineStringLegs(QList<Wind>& winds, const geo::LineString& linestring) const
+{
+  QList<WindData> legWinds;
+  windAverageForLegs(legWinds, linestring);
+
+  winds.reserve(winds.size() + legWinds.size());
+  for(const WindData& wd : std::as_const(legWinds))
+    winds.append(wd.toWind());
+}
+
 bool WindQuery::hasWindData() const
 {
   return !p->windLayers.isEmpty();
@@ -500,6 +685,55 @@ QString WindQuery::getDebug(const geo::Pos& pos) const
   return retval;
 }
 
+void WindQuery::setCompactStorage(bool value)
+{
+  p->compactStorage = value;
+}
+
+bool WindQuery::isCompactStorage() const
+{
+  return p->compactStorage;
+}
+
+/* Size of wind grids for all layers of one dataset */
+static qsizetype layersMemorySize(const QMap<int, WindAltLayer>& windLayers)
+{
+  qsizetype size = 0;
+  const WindAltLayer *compactLayer = nullptr;
+  for(const WindAltLayer& layer : windLayers)
+  {
+    size += layer.winds.size() * static_cast<qsizetype>(sizeof(WindData));
+
+    // Count shared array only once
+    if(compactLayer == nullptr && layer.compactOffset >= 0)
+    {
+      compactLayer = &layer;
+      size += layer.compactWinds.size() * static_cast<qsizetype>(sizeof(qint16));
+    }
+  }
+  return size;
+}
+
+qsizetype WindQuery::getMemorySize() const
+{
+  return layersMemorySize(p->windLayers);
+}
+
+void WindQuery::getMemoryUsage(atools::util::MemoryUsage& usage) const
+{
+  usage.add(QStringLiteral("WindQuery/layers"), getMemorySize(), p->windLayers.size());
+
+  // Forecasts are loaded lazily from other threads
+  QMutexLocker locker(&p->forecastMutex);
+  qint64 forecastBytes = 0, numLayers = 0;
+  for(const WindForecast& forecast : std::as_const(p->forecasts))
+  {
+    forecastBytes += layersMemorySize(forecast.windLayers);
+    numLayers += forecast.windLayers.size();
+  }
+  usage.add(QStringLiteral("WindQuery/forecasts"), forecastBytes, numLayers);
+}
+
 void WindQuery::setIgnoreSslErrors(bool value)
 {
   downloader->setIgnoreSslErrors(value);
@@ -519,7 +753,15 @@ void WindQuery::debugDumpContainerSizes() const
 
 WindData WindQuery::windForLayer(const WindAltLayer& layer, const QPoint& point) const
 {
-  return layer.isValid() ? layer.winds.at(point.x() + point.y() * 360) : EMPTY_WIND_DATA;
+  int index = point.x() + point.y() * 360;
+  if(layer.compactOffset >= 0)
+  {
+    // Both components are next to each other
+    const qint16 *wind = layer.compactWinds.constData() + layer.compactOffset + index * 2;
+    return {wind[0] * COMPACT_INV_SCALE, wind[1] * COMPACT_INV_SCALE};
+  }
+  else
+    return layer.winds.isEmpty() ? EMPTY_WIND_DATA : layer.winds.at(index);
 }
 
 Wind WindQuery::getWindAverageForLine(const Line& line) const
@@ -532,22 +774,8 @@ Wind WindQuery::getWindAverageForLine(const Pos& pos1, const Pos& pos2) const
   return windAverageForLine(pos1, pos2).toWind();
 }
 
-WindData WindQuery::windAverageForLine(geo::Pos pos1, geo::Pos pos2) const
+void WindQuery::samplePositions(LineString& positions, geo::Pos pos1, geo::Pos pos2) const
 {
-  WindData windData = EMPTY_WIND_DATA;
-
-  if(!pos1.isValid())
-  {
-    qWarning() << Q_FUNC_INFO << "invalid pos1";
-    return windData;
-  }
-
-  if(!pos2.isValid())
-  {
-    qWarning() << Q_FUNC_INFO << "invalid pos2";
-    return windData;
-  }
-
   pos1.normalize();
   pos2.normalize();
 
@@ -557,8 +785,6 @@ WindData WindQuery::windAverageForLine(geo::Pos pos1, geo::Pos pos2) const
   float meterPerSample = meterPerDeg / samplesPerDegree;
   int numPoints = atools::roundToInt(distanceMeter / meterPerSample);
 
-  LineString positions;
-
   if(numPoints > 1)
   {
     // Calculate number of points - will include origin but not pos2
@@ -568,35 +794,75 @@ WindData WindQuery::windAverageForLine(geo::Pos pos1, geo::Pos pos2) const
   else
     // Only start and end needed
     positions << pos1 << pos2;
+}
 
-  WindRect windRectLower, windRectUpper;
+WindData WindQuery::windForSample(const geo::Pos& pos, const WindAltLayer& lower, const WindAltLayer& upper) const
+{
+  Rect global = globalRect(pos);
+  GridRect grid = gridRect(global);
 
-  for(const atools::geo::Pos& pos : std::as_const(positions))
+  // Get interpolated wind in grid cell at lower layer
+  WindRect windRect;
+  windRectForLayer(windRect, lower, grid);
+  WindData lW = interpolateRect(windRect, global, pos);
+
+  if(upper != lower)
   {
-    Rect global = globalRect(pos);
-    GridRect grid = gridRect(global);
+    // Get interpolated wind in grid cell at upper layer
+    windRectForLayer(windRect, upper, grid);
 
-    // Get next layers below and above altitude
-    WindAltLayer lower, upper;
-    layersByAlt(lower, upper, pos.getAltitude());
+    // Interpolate at altitude between layers
+    return interpolateWind(lW, interpolateRect(windRect, global, pos), lower.altitude, upper.altitude, pos.getAltitude());
+  }
+  else
+    return lW;
+}
 
-    // Get interpolated wind in grid cell at lower layer
-    windRectForLayer(windRectLower, lower, grid);
-    WindData lW = interpolateRect(windRectLower, global, pos);
+void WindQuery::windForSamples(WindData *winds, const geo::Pos *positions, int num) const
+{
+  WindAltLayer lower, upper;
+  int lastAltitude = std::numeric_limits<int>::min();
 
-    WindData w;
-    if(upper != lower)
-    {
-      // Get interpolated wind in grid cell at upper layer
-      windRectForLayer(windRectUpper, upper, grid);
+  for(int i = 0; i < num; i++)
+  {
+    const Pos& pos = positions[i];
 
-      // Interpolate at altitude between layers
-      w = interpolateWind(lW, interpolateRect(windRectUpper, global, pos),
-                          lower.altitude, upper.altitude, pos.getAltitude());
+    // Get next layers below and above altitude only if altitude changes
+    int altitude = atools::roundToInt(pos.getAltitude());
+    if(altitude != lastAltitude)
+    {
+      layersByAlt(lower, upper, pos.getAltitude(), p->windLayers);
+      lastAltitude = altitude;
     }
-    else
-      w = lW;
 
+    winds[i] = windForSample(pos, lower, upper);
+  }
+}
+
+WindData WindQuery::windAverageForLine(geo::Pos pos1, geo::Pos pos2) const
+{
+  WindData windData = EMPTY_WIND_DATA;
+
+  if(!pos1.isValid())
+  {
+    qWarning() << Q_FUNC_INFO << "invalid pos1";
+    return windData;
+  }
+
+  if(!pos2.isValid())
+  {
+    qWarning() << Q_FUNC_INFO << "invalid pos2";
+    return windData;
+  }
+
+  LineString positions;
+  samplePositions(positions, pos1, pos2);
+
+  QList<WindData> winds(positions.size());
+  windForSamples(winds.data(), positions.constData(), static_cast<int>(positions.size()));
+
+  for(const WindData& w : std::as_const(winds))
+  {
     windData.u += w.u;
     windData.v += w.v;
   }
@@ -606,28 +872,97 @@ WindData WindQuery::windAverageForLine(geo::Pos pos1, geo::Pos pos2) const
   return windData;
 }
 
-void WindQuery::layersByAlt(WindAltLayer& lower, WindAltLayer& upper, float altitude) const
+void WindQuery::windAverageForLegs(QList<WindData>& legWinds, const geo::LineString& linestring) const
 {
-  if(p->windLayers.size() == 1)
+  int numLegs = std::max(0, static_cast<int>(linestring.size()) - 1);
+  legWinds.fill(EMPTY_WIND_DATA, numLegs);
+
+  if(numLegs == 0)
+    return;
+
+  // Generate all sample positions up front. Samples of leg i are at offsets[i] to offsets[i + 1].
+  LineString positions;
+  QList<int> offsets;
+  offsets.reserve(numLegs + 1);
+  for(int i = 0; i < numLegs; i++)
+  {
+    offsets.append(static_cast<int>(positions.size()));
+
+    const Pos& pos1 = linestring.at(i), &pos2 = linestring.at(i + 1);
+    if(pos1.isValid() && pos2.isValid())
+      samplePositions(positions, pos1, pos2);
+    else
+      qWarning() << Q_FUNC_INFO << "invalid position in leg" << i;
+  }
+  offsets.append(static_cast<int>(positions.size()));
+
+  // Evaluate all samples - split into chunks for long routes
+  int num = static_cast<int>(positions.size());
+  QList<WindData> winds(num);
+  WindData *windData = winds.data();
+  const Pos *posData = positions.constData();
+
+  int numThreads = std::max(1, std::min(QThread::idealThreadCount(), num / MIN_SAMPLES_PER_THREAD));
+  if(numThreads > 1)
+  {
+    QThreadPool pool;
+    pool.setMaxThreadCount(numThreads);
+    int chunkSize = (num + numThreads - 1) / numThreads;
+    for(int start = 0; start < num; start += chunkSize)
+    {
+      int end = std::min(start + chunkSize, num);
+      pool.start([this, windData, posData, start, end]() -> void {
+            windForSamples(windData + start, posData + start, end - start);
+          });
+    }
+    pool.waitForDone();
+  }
+  else
+    windForSamples(windData, posData, num);
+
+  // Average per leg
+  for(int i = 0; i < numLegs; i++)
+  {
+    int numSamples = offsets.at(i + 1) - offsets.at(i);
+    if(numSamples > 0)
+    {
+      WindData& legWind = legWinds[i];
+      for(int j = offsets.at(i); j < offsets.at(i + 1); j++)
+      {
+        legWind.u += windData[j].u;
+        legWind.v += windData[j].v;
+      }
+      legWind.u /= numSamples;
+      legWind.v /= numSamples;
+    }
+  }
+}
+
+void WindQuery::layersByAlt(WindAltLayer& lower, WindAltLayer& upper, float altitude,
+                            const QMap<int, WindAltLayer>& windLayers) const
+{
+  // Map is passed as const reference to avoid detaching since this can be called from several threads
+  if(windLayers.size() == 1)
     // Only one wind layer
-    lower = upper = p->windLayers.first();
-  else if(p->windLayers.size() > 1)
+    lower = upper = windLayers.first();
+  else if(windLayers.size() > 1)
   {
     // Returns an iterator pointing to the first item with key key in the map.
     // If the map contains no item with key key, the function returns an iterator to the nearest item with a greater key.
-    QMap<int, WindAltLayer>::const_iterator it = p->windLayers.lowerBound(atools::roundToInt(altitude));
-    if(it != p->windLayers.end())
+    QMap<int, WindAltLayer>::const_iterator it = windLayers.lowerBound(atools::roundToInt(altitude));
+    if(it != windLayers.end())
     {
       if(atools::almostEqual(it->altitude, atools::roundToInt(altitude), WindAltLayer::ALTITUDE_EPSILON))
         // Layer is at requested altitude - no need to interpolate
         lower = upper = *it;
-      else if(it == p->windLayers.begin())
+      else if(it == windLayers.begin())
       {
         // First layer - add a zero wind layer for interpolation between layer and ground
         upper = *it;
 
+        // Layer has no data which results in zero wind
+        lower = WindAltLayer();
         lower.altitude = 0.f;
-        lower.winds.fill(EMPTY_WIND_DATA, 360 * 181);
       }
       else
       {
@@ -636,7 +971,7 @@ void WindQuery::layersByAlt(WindAltLayer& lower, WindAltLayer& upper, float alti
       }
     }
     else
-      lower = upper = p->windLayers.last();
+      lower = upper = windLayers.last();
   }
 }
 
@@ -665,7 +1000,9 @@ void WindQuery::gribDownloadFinished(const GribDatasetList& datasets, QString do
   qDebug() << Q_FUNC_INFO << downloadUrl;
 
   // Download finished - update coordinates
-  convertDataset(datasets);
+  QDateTime time = convertDataset(p->windLayers, datasets);
+  if(time.isValid())
+    analyisTime = time;
   emit windDataUpdated();
 }
 
@@ -702,7 +1039,9 @@ void WindQuery::gribFileUpdated(const QStringList& filenames)
     {
       GribReader reader(verbose);
       reader.readFile(filename);
-      convertDataset(reader.getDatasets());
+      QDateTime time = convertDataset(p->windLayers, reader.getDatasets());
+      if(time.isValid())
+        analyisTime = time;
     }
     catch(atools::Exception& e)
     {
@@ -740,43 +1079,96 @@ void WindQuery::gribFileUpdated(const QStringList& filenames)
 // j direction - south to north along a meridian, or bottom to top along a y-axis.
 // V component of wind; northward_wind;
 // U component of wind; eastward_wind;
-void WindQuery::convertDataset(const GribDatasetList& datasets)
+QDateTime WindQuery::convertDataset(QMap<int, WindAltLayer>& windLayers, const GribDatasetList& datasets) const
 {
-  p->windLayers.clear();
+  ATOOLS_TRACE_SPAN("WindQuery::convertDataset");
+
+  windLayers.clear();
+  QDateTime time;
+  bool compact = p->compactStorage;
 
-  for(int dsidx = 0; dsidx < datasets.size(); dsidx += 2)
+  // Check order and collect layer properties first
+  int numLayers = static_cast<int>(datasets.size() / 2);
+  QList<WindAltLayer> layers(numLayers);
+  for(int layerIdx = 0; layerIdx < numLayers; layerIdx++)
   {
-    const GribDataset& datasetUWind = datasets.at(dsidx);
-    const GribDataset& datasetVWind = datasets.at(dsidx + 1);
+    const GribDataset& datasetUWind = datasets.at(layerIdx * 2);
+    const GribDataset& datasetVWind = datasets.at(layerIdx * 2 + 1);
 
     // Need parametes ordered by U and V
-    if(datasetUWind.getParameterType() == atools::grib::U_WIND &&
-       datasetVWind.getParameterType() == atools::grib::V_WIND)
-    {
-      if(datasetUWind.getDatetime().isValid())
-        analyisTime = datasetUWind.getDatetime();
+    if(datasetUWind.getParameterType() != atools::grib::U_WIND ||
+       datasetVWind.getParameterType() != atools::grib::V_WIND ||
+       datasetUWind.getData().size() < GRID_SIZE || datasetVWind.getData().size() < GRID_SIZE)
+      throw atools::Exception("Invalid dataset order for  U and V wind component");
 
-      const QList<float>& dataU = datasetUWind.getData();
-      const QList<float>& dataV = datasetVWind.getData();
-      WindAltLayer layer;
-      layer.altitude = roundToInt(datasetUWind.getAltFeetRounded());
-      layer.surface = datasetUWind.getSurface();
+    if(datasetUWind.getDatetime().isValid())
+      time = datasetUWind.getDatetime();
 
-      for(int j = 0; j < 181; j++) // y
-      {
-        for(int i = 0; i < 360; i++) // x
+    WindAltLayer& layer = layers[layerIdx];
+    layer.altitude = roundToInt(datasetUWind.getAltFeetRounded());
+    layer.surface = datasetUWind.getSurface();
+
+    if(compact)
+      layer.compactOffset = layerIdx * GRID_SIZE * 2;
+    else
+      layer.winds.resize(GRID_SIZE);
+  }
+
+  QList<qint16> compactWinds;
+  if(compact)
+    compactWinds.resize(static_cast<qsizetype>(numLayers) * GRID_SIZE * 2);
+
+  // Convert layers concurrently - each task writes only into its own layer
+  WindAltLayer *layerData = layers.data();
+  const GribDataset *datasetData = datasets.constData();
+  qint16 *compactData = compactWinds.data();
+  auto convertLayer = [layerData, datasetData, compactData](int layerIdx) -> void {
+        const float *dataU = datasetData[layerIdx * 2].getData().constData();
+        const float *dataV = datasetData[layerIdx * 2 + 1].getData().constData();
+        WindAltLayer& layer = layerData[layerIdx];
+
+        if(layer.compactOffset >= 0)
         {
-          WindData wind;
-          wind.u = atools::geo::meterPerSecToKnots(dataU.at(i + j * 360));
-          wind.v = atools::geo::meterPerSecToKnots(dataV.at(i + j * 360));
-          layer.winds.append(wind);
+          qint16 *winds = compactData + layer.compactOffset;
+          for(int i = 0; i < GRID_SIZE; i++)
+          {
+            winds[i * 2] = compactValue(atools::geo::meterPerSecToKnots(dataU[i]));
+            winds[i * 2 + 1] = compactValue(atools::geo::meterPerSecToKnots(dataV[i]));
+          }
         }
-      }
-      p->windLayers.insert(atools::roundToInt(layer.altitude), layer);
-    }
-    else
-      throw atools::Exception("Invalid dataset order for  U and V wind component");
+        else
+        {
+          WindData *winds = layer.winds.data();
+          for(int i = 0; i < GRID_SIZE; i++)
+          {
+            winds[i].u = atools::geo::meterPerSecToKnots(dataU[i]);
+            winds[i].v = atools::geo::meterPerSecToKnots(dataV[i]);
+          }
+        }
+      };
+
+  int numThreads = std::max(1, std::min(QThread::idealThreadCount(), numLayers));
+  if(numThreads > 1)
+  {
+    QThreadPool pool;
+    pool.setMaxThreadCount(numThreads);
+    for(int layerIdx = 0; layerIdx < numLayers; layerIdx++)
+      pool.start([&convertLayer, layerIdx]() -> void {
+            convertLayer(layerIdx);
+          });
+    pool.waitForDone();
+  }
+  else if(numLayers > 0)
+    convertLayer(0);
+
+  for(WindAltLayer& layer : layers)
+  {
+    if(compact)
+      // Shares the array with all other layers
+      layer.compactWinds = compactWinds;
+    windLayers.insert(atools::roundToInt(layer.altitude), layer);
   }
+  return time;
 }
 
 /* Interpolate wind speed and direction between two altitude layers */
@@ -30,6 +30,7 @@ class QObject;
 namespace atools {
 namespace util {
 class FileSystemWatcher;
+class MemoryUsage;
 }
 
 namespace geo {
@@ -47,6 +48,7 @@ struct GridRect;
 struct WindData;
 struct WindAltLayer;
 struct WindQueryPrivate;
+struct WindForecast;
 
 /*
  * Takes care for downloading/reading and decoding of GRIB2 wind files. Provides a query API to calculate and interpolate
@@ -108,6 +110,23 @@ public:
   /* Get interpolated wind data for single position. Altitude in feet is used from position. */
   Wind getWindForPos(atools::geo::Pos pos, bool interpolateValue = true) const;
 
+  /* Get wind at position and time interpolated between the two forecasts around time. The dataset from download or
+   * file is used as a forecast at its analysis time. Uses the nearest dataset if time is outside of all forecasts.
+   * Same as getWindForPos(pos) if no forecasts are added. Loads forecast files on first use. */
+  Wind getWindForPos(atools::geo::Pos pos, const QDateTime& time, bool interpolateValue = true) const;
+
+  /* Add wind data valid at the given time for time interpolation. File is decoded on first query and kept in memory.
+   * Replaces forecast for the same time. Forecasts remain until clearForecasts() or deinit() is called. */
+  void addForecast(const QDateTime& validTime, const QString& filename);
+
+  /* As above but converts already decoded data immediately */
+  void addForecast(const QDateTime& validTime, const atools::grib::GribDatasetList& datasets);
+
+  void clearForecasts();
+
+  /* Valid times of all added forecasts sorted ascending */
+  QList<QDateTime> getForecastTimes() const;
+
   /* Get an array of wind data for the given rectangle at the given altitude from the data grid.
    * Data is only interpolated between layers. Result is sorted by y and x coordinates. */
   void getWindForRect(atools::grib::WindPosList& result, atools::geo::Rect rect, float altFeet, int gridSpacing) const;
@@ -120,6 +139,11 @@ public:
   Wind getWindAverageForLine(const atools::geo::Line& line) const;
   Wind getWindAverageForLineString(const atools::geo::LineString& linestring) const;
 
+  /* Average wind for each leg of the line string appended to winds. Same as calling getWindAverageForLine()
+   * for each leg but generates all samples up front and evaluates them in one batch.
+   * Long routes are evaluated in parallel. Legs with invalid positions get zero wind. */
+  void getWindAverageForLineStringLegs(QList<atools::grib::Wind>& winds, const atools::geo::LineString& linestring) const;
+
   bool hasWindData() const;
 
   /* Samples per degree for wind interpolation along lines and line strings */
@@ -128,6 +152,18 @@ public:
     samplesPerDegree = value;
   }
 
+  /* Store wind components quantized to 1/100 knots in 16 bit integers for all layers in one array.
+   * Halves memory usage and improves cache usage for large queries. Precision is better than 0.01 knots.
+   * Takes effect with the next data update. Fixed models always use full precision. */
+  void setCompactStorage(bool value);
+  bool isCompactStorage() const;
+
+  /* Approximate memory size of wind grids in bytes */
+  qsizetype getMemorySize() const;
+
+  /* Add memory of current wind grids and loaded forecast grids. Thread safe. */
+  void getMemoryUsage(atools::util::MemoryUsage& usage) const;
+
   QString getDebug(const atools::geo::Pos& pos) const;
 
   /* Set to true to ignore any certificate validation or other SSL errors.
@@ -163,7 +199,18 @@ private:
   WindData windForLayer(const WindAltLayer& layer, const QPoint& point) const;
 
   /* Get layer above and below (or at) altitude */
-  void layersByAlt(WindAltLayer& lower, WindAltLayer& upper, float altitude) const;
+  void layersByAlt(WindAltLayer& lower, WindAltLayer& upper, float altitude,
+                   const QMap<int, WindAltLayer>& windLayers) const;
+
+  /* Wind for normalized and valid position from the given layers */
+  WindData windForPos(const atools::geo::Pos& pos, const QMap<int, WindAltLayer>& windLayers, bool interpolateValue) const;
+
+  /* Get datasets before (or at) and after time. Pointers are null if not available. */
+  void layersByTime(const QMap<int, WindAltLayer> *& layers0, const QMap<int, WindAltLayer> *& layers1,
+                    QDateTime& time0, QDateTime& time1, const QDateTime& time) const;
+
+  /* Load forecast file if not done yet. Thread safe. */
+  const QMap<int, WindAltLayer>& forecastLayers(WindForecast& forecast) const;
 
   /* Fill cell rectangle with wind values at corners */
   void windRectForLayer(WindRect& windRect, const WindAltLayer& layer, const atools::grib::GridRect& rect) const;
@@ -171,8 +218,8 @@ private:
   /* Quadratic interpolation- Returns wind for position in the grid cell */
   WindData interpolateRect(const WindRect& windRect, const geo::Rect& rect, const geo::Pos& pos) const;
 
-  /* Convert data from U/V components to speed/heading */
-  void convertDataset(const atools::grib::GribDatasetList& datasets);
+  /* Convert data from U/V components to speed/heading and return analysis time */
+  QDateTime convertDataset(QMap<int, WindAltLayer>& windLayers, const atools::grib::GribDatasetList& datasets) const;
 
   void gribDownloadFinished(const atools::grib::GribDatasetList& datasets, QString downloadUrl);
   void gribDownloadFailed(const QString& error, int errorCode, QString downloadUrl);
@@ -188,6 +235,18 @@ private:
    *  Normalizes positions to avoid overflow on grid access */
   WindData windAverageForLine(atools::geo::Pos pos1, atools::geo::Pos pos2) const;
 
+  /* Average wind for each leg of the line string in legWinds */
+  void windAverageForLegs(QList<WindData>& legWinds, const atools::geo::LineString& linestring) const;
+
+  /* Append sample positions along great circle line including both ends */
+  void samplePositions(atools::geo::LineString& positions, atools::geo::Pos pos1, atools::geo::Pos pos2) const;
+
+  /* Wind interpolated in grid cell and between layers */
+  WindData windForSample(const atools::geo::Pos& pos, const WindAltLayer& lower, const WindAltLayer& upper) const;
+
+  /* Evaluate num positions into winds. Layers are looked up only if altitude changes. Thread safe. */
+  void windForSamples(WindData *winds, const atools::geo::Pos *positions, int num) const;
+
   QString collectGribFiles();
 
   /* Surfaces to download from NOAA. Negative value denotes AGL in ft and positive is millibar level.
@@ -5,8 +5,11 @@
 
 #include "httpconnectionhandler.h"
 #include "httpresponse.h"
+#include "httpservermetrics.h"
+#include "util/tracer.h"
 
 #include <QCoreApplication>
+#include <QElapsedTimer>
 
 using namespace stefanfrings;
 
@@ -85,7 +88,7 @@ void HttpConnectionHandler::createSocket()
 void HttpConnectionHandler::handleConnection(tSocketDescriptor socketDescriptor)
 {
   qDebug("HttpConnectionHandler (%p): handle new connection", static_cast<void *>(this));
-  busy = true;
+  setBusy();
   Q_ASSERT(socket->isOpen() == false); // if not, then the handler is already busy
 
   // UGLY workaround - we need to clear writebuffer before reusing this socket
@@ -124,6 +127,10 @@ bool HttpConnectionHandler::isBusy()
 
 void HttpConnectionHandler::setBusy()
 {
+  if(!busy)
+  {
+    HttpServerMetrics::instance().addBusyHandlers(1);
+  }
   this->busy = true;
 }
 
@@ -148,6 +155,10 @@ void HttpConnectionHandler::disconnected()
   qDebug("HttpConnectionHandler (%p): disconnected", static_cast<void *>(this));
   socket->close();
   readTimer.stop();
+  if(busy)
+  {
+    HttpServerMetrics::instance().addBusyHandlers(-1);
+  }
   busy = false;
 }
 
@@ -172,7 +183,9 @@ void HttpConnectionHandler::read()
           currentRequest->getStatus() != HttpRequest::abort_size &&
           currentRequest->getStatus() != HttpRequest::abort_broken)
     {
+      qint64 available = socket->bytesAvailable();
       currentRequest->readFromSocket(socket);
+      HttpServerMetrics::instance().addBytesIn(available - socket->bytesAvailable());
       if(currentRequest->getStatus() == HttpRequest::waitForBody)
       {
         // Restart timer for read timeout, otherwise it would
@@ -217,28 +230,19 @@ void HttpConnectionHandler::read()
       qDebug("HttpConnectionHandler (%p): received request", static_cast<void *>(this));
       #endif
 
-      // Copy the Connection:close header to the response
-      HttpResponse response(socket);
-      bool closeConnection = QString::compare(currentRequest->getHeader("Connection"), "close", Qt::CaseInsensitive) == 0;
-      if(closeConnection)
-      {
-        response.setHeader("Connection", "close");
-      }
-      // In case of HTTP 1.0 protocol add the Connection:close header.
+      // Copy the Connection:close header to the response or keep HTTP 1.0 connections alive if requested.
       // This ensures that the HttpResponse does not activate chunked mode, which is not spported by HTTP 1.0.
-      else
-      {
-        bool http1_0 = QString::compare(currentRequest->getVersion(), "HTTP/1.0", Qt::CaseInsensitive) == 0;
-        if(http1_0)
-        {
-          closeConnection = true;
-          response.setHeader("Connection", "close");
-        }
-      }
+      HttpResponse response(socket);
+      bool closeConnection = !response.setConnectionHeaders(*currentRequest);
 
       // Call the request mapper
+      HttpServerMetrics& metrics = HttpServerMetrics::instance();
+      metrics.addActiveRequests(1);
+      QElapsedTimer serviceTimer;
+      serviceTimer.start();
       try
       {
+        ATOOLS_TRACE_SPAN_DETAIL("HttpConnectionHandler::service", QString::fromUtf8(currentRequest->getPath()));
         requestHandler->service(*currentRequest, response);
       }
       catch(...)
@@ -252,33 +256,17 @@ void HttpConnectionHandler::read()
       {
         response.write(QByteArray(), true);
       }
+      metrics.addActiveRequests(-1);
+      metrics.recordRequest(currentRequest->getPath(), serviceTimer.nsecsElapsed() / 1000, response.getBytesWritten());
       #ifdef DEBUG_INFORMATION_HTTP
       qDebug("HttpConnectionHandler (%p): finished request", static_cast<void *>(this));
       #endif
 
-      // Find out whether the connection must be closed
-      if(!closeConnection)
+      // Find out whether the connection must be closed. Maybe the request handler or mapper added a
+      // Connection:close header in the meantime or the client can not detect the end of the response.
+      if(!closeConnection && !response.isKeepAlive())
       {
-        // Maybe the request handler or mapper added a Connection:close header in the meantime
-        bool closeResponse = QString::compare(response.getHeaders().value("Connection"), "close", Qt::CaseInsensitive) == 0;
-        if(closeResponse == true)
-        {
-          closeConnection = true;
-        }
-        else
-        {
-          // If we have no Content-Length header and did not use chunked mode, then we have to close the
-          // connection to tell the HTTP client that the end of the response has been reached.
-          bool hasContentLength = response.getHeaders().contains("Content-Length");
-          if(!hasContentLength)
-          {
-            bool hasChunkedMode = QString::compare(response.getHeaders().value("Transfer-Encoding"), "chunked", Qt::CaseInsensitive) == 0;
-            if(!hasChunkedMode)
-            {
-              closeConnection = true;
-            }
-          }
-        }
+        closeConnection = true;
       }
 
       // Close the connection or prepare for the next request on the same connection.
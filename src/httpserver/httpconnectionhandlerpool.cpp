@@ -7,6 +7,7 @@
 #endif
 #include <QDir>
 #include "httpconnectionhandlerpool.h"
+#include "httpservermetrics.h"
 
 using namespace stefanfrings;
 
@@ -15,8 +16,7 @@ HttpConnectionHandlerPool::HttpConnectionHandlerPool(const QHash<QString, QVaria
 {
   this->settings = settings;
   this->requestHandler = requestHandler;
-  this->sslConfiguration = nullptr;
-  loadSslConfig();
+  this->sslConfiguration = loadSslConfig(settings);
   cleanupTimer.start(settings.value("cleanupInterval", 1000).toInt());
   connect(&cleanupTimer, SIGNAL(timeout()), SLOT(cleanup()));
 }
@@ -28,6 +28,7 @@ HttpConnectionHandlerPool::~HttpConnectionHandlerPool()
   {
     delete handler;
   }
+  HttpServerMetrics::instance().addHandlers(-static_cast<int>(pool.size()));
   delete sslConfiguration;
   qDebug("HttpConnectionHandlerPool (%p): destroyed", static_cast<void *>(this));
 }
@@ -55,6 +56,7 @@ HttpConnectionHandler *HttpConnectionHandlerPool::getConnectionHandler()
       freeHandler = new HttpConnectionHandler(settings, requestHandler, sslConfiguration);
       freeHandler->setBusy();
       pool.append(freeHandler);
+      HttpServerMetrics::instance().addHandlers(1);
     }
   }
   mutex.unlock();
@@ -74,6 +76,7 @@ void HttpConnectionHandlerPool::cleanup()
       {
         delete handler;
         pool.removeOne(handler);
+        HttpServerMetrics::instance().addHandlers(-1);
       #ifdef DEBUG_INFORMATION_HTTP
         qDebug("HttpConnectionHandlerPool: Removed connection handler (%p), pool size is now %li", handler, (long int)pool.size());
       #endif
@@ -84,8 +87,10 @@ void HttpConnectionHandlerPool::cleanup()
   mutex.unlock();
 }
 
-void HttpConnectionHandlerPool::loadSslConfig()
+QSslConfiguration *HttpConnectionHandlerPool::loadSslConfig(const QHash<QString, QVariant>& settings)
 {
+  QSslConfiguration *sslConfiguration = nullptr;
+
   // If certificate and key files are configured, then load them
   QString sslKeyFileName = settings.value("sslKeyFile", "").toString();
   QString sslCertFileName = settings.value("sslCertFile", "").toString();
@@ -110,7 +115,7 @@ void HttpConnectionHandlerPool::loadSslConfig()
     if(!certFile.open(QIODevice::ReadOnly))
     {
       qCritical("HttpConnectionHandlerPool: cannot open sslCertFile %s", qPrintable(sslCertFileName));
-      return;
+      return sslConfiguration;
     }
     QSslCertificate certificate(&certFile, QSsl::Pem);
     certFile.close();
@@ -120,7 +125,7 @@ void HttpConnectionHandlerPool::loadSslConfig()
     if(!keyFile.open(QIODevice::ReadOnly))
     {
       qCritical("HttpConnectionHandlerPool: cannot open sslKeyFile %s", qPrintable(sslKeyFileName));
-      return;
+      return sslConfiguration;
     }
     QSslKey sslKey(&keyFile, QSsl::Rsa, QSsl::Pem);
     keyFile.close();
@@ -145,7 +150,7 @@ void HttpConnectionHandlerPool::loadSslConfig()
       if(!caCertFile.open(QIODevice::ReadOnly))
       {
         qCritical("HttpConnectionHandlerPool: cannot open caCertFile %s", qPrintable(caCertFileName));
-        return;
+        return sslConfiguration;
       }
       QSslCertificate caCertificate(&caCertFile, QSsl::Pem);
       caCertFile.close();
@@ -166,4 +171,5 @@ void HttpConnectionHandlerPool::loadSslConfig()
 
     qDebug("HttpConnectionHandlerPool: SSL settings loaded");
   }
+  return sslConfiguration;
 }
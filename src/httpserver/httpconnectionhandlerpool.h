@@ -26,6 +26,7 @@ namespace stefanfrings {
  *  </pre></code>
  *  <p>
  *  The readTimeout value defines the maximum time to wait for a complete HTTP request.
+ *  It is also the idle time after which a persistent (keep-alive) connection is closed.
  *  <p>
  *  MaxRequestSize is the maximum size of a HTTP request. In case of
  *  multipart/form-data requests (also known as file-upload), the maximum
@@ -101,6 +102,12 @@ public:
   /** Get a free connection handler, or 0 if not available. */
   HttpConnectionHandler *getConnectionHandler();
 
+  /**
+   *  Load SSL configuration from the settings sslKeyFile, sslCertFile, caCertFile and verifyPeer.
+   *  @return Configuration owned by the caller or nullptr if SSL is not configured or files cannot be read.
+   */
+  static QSslConfiguration *loadSslConfig(const QHash<QString, QVariant>& settings);
+
 private:
   /** Settings for this pool */
   QHash<QString, QVariant> settings;
@@ -120,9 +127,6 @@ private:
   /** The SSL configuration (certificate, key and other settings) */
   QSslConfiguration *sslConfiguration;
 
-  /** Load SSL configuration */
-  void loadSslConfig();
-
 private slots:
   /** Received from the clean-up timer.  */
   void cleanup();
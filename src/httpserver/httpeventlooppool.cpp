@@ -0,0 +1,357 @@
+/**
+ *  @file
+ *  Event driven connection handling for HttpListener.
+ */
+
+#include "httpeventlooppool.h"
+#include "httpconnectionhandlerpool.h"
+#include "httpresponse.h"
+#include "httpservermetrics.h"
+
+#ifndef QT_NO_SSL
+    #include <QSslSocket>
+#endif
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTcpSocket>
+#include <QThread>
+
+using namespace stefanfrings;
+
+// HttpEventConnection ==========================================================================
+
+HttpEventConnection::HttpEventConnection(const QHash<QString, QVariant>& settings, HttpRequestHandler *requestHandler,
+                                         QThreadPool *workerPool, const QSslConfiguration *sslConfiguration,
+                                         QAtomicInt *connectionCounter, QObject *parent)
+  : QObject(parent)
+{
+  this->settings = settings;
+  this->requestHandler = requestHandler;
+  this->workerPool = workerPool;
+  this->sslConfiguration = sslConfiguration;
+  this->connectionCounter = connectionCounter;
+  HttpServerMetrics::instance().addEventConnections(1);
+
+  readTimer.setSingleShot(true);
+  connect(&readTimer, SIGNAL(timeout()), SLOT(readTimeout()));
+}
+
+HttpEventConnection::~HttpEventConnection()
+{
+  delete currentRequest;
+  connectionCounter->fetchAndSubOrdered(1);
+  HttpServerMetrics::instance().addEventConnections(-1);
+}
+
+bool HttpEventConnection::start(tSocketDescriptor socketDescriptor)
+{
+  // Create TCP or SSL socket
+#ifndef QT_NO_SSL
+  if(sslConfiguration)
+  {
+    QSslSocket *sslSocket = new QSslSocket(this);
+    sslSocket->setSslConfiguration(*sslConfiguration);
+    socket = sslSocket;
+  }
+  else
+#endif
+  socket = new QTcpSocket(this);
+
+  if(!socket->setSocketDescriptor(socketDescriptor))
+  {
+    qCritical("HttpEventConnection (%p): cannot initialize socket: %s",
+              static_cast<void *>(this), qPrintable(socket->errorString()));
+    return false;
+  }
+
+  connect(socket, SIGNAL(readyRead()), SLOT(read()));
+  connect(socket, SIGNAL(disconnected()), SLOT(disconnected()));
+
+#ifndef QT_NO_SSL
+  // Switch on encryption, if SSL is configured
+  if(sslConfiguration)
+  {
+    (static_cast<QSslSocket *>(socket))->startServerEncryption();
+  }
+#endif
+
+  // Start timer for read timeout
+  readTimer.start(settings.value("readTimeout", 10000).toInt());
+  return true;
+}
+
+void HttpEventConnection::readTimeout()
+{
+#ifdef DEBUG_INFORMATION_HTTP
+  qDebug("HttpEventConnection (%p): read timeout occurred", static_cast<void *>(this));
+#endif
+
+  socket->disconnectFromHost();
+  delete currentRequest;
+  currentRequest = nullptr;
+}
+
+void HttpEventConnection::disconnected()
+{
+  readTimer.stop();
+
+  // Worker still needs this object to return the response
+  if(busy)
+  {
+    disconnectedWhileBusy = true;
+  }
+  else
+  {
+    deleteLater();
+  }
+}
+
+void HttpEventConnection::abort(const QByteArray& message)
+{
+  // Pending data is sent before the connection is closed
+  socket->write(message);
+  socket->disconnectFromHost();
+  delete currentRequest;
+  currentRequest = nullptr;
+}
+
+void HttpEventConnection::read()
+{
+  // Next pipelined request is read when the response is sent
+  if(busy || disconnectedWhileBusy)
+  {
+    return;
+  }
+
+  while(socket->bytesAvailable())
+  {
+    // Create new HttpRequest object if necessary
+    if(!currentRequest)
+    {
+      currentRequest = new HttpRequest(settings);
+    }
+
+    // Collect data for the request object
+    while(socket->bytesAvailable() &&
+          currentRequest->getStatus() != HttpRequest::complete &&
+          currentRequest->getStatus() != HttpRequest::abort_size &&
+          currentRequest->getStatus() != HttpRequest::abort_broken)
+    {
+      qint64 available = socket->bytesAvailable();
+      currentRequest->readFromSocket(socket);
+      HttpServerMetrics::instance().addBytesIn(available - socket->bytesAvailable());
+      if(currentRequest->getStatus() == HttpRequest::waitForBody)
+      {
+        // Restart timer for read timeout, otherwise it would
+        // expire during large file uploads.
+        readTimer.start(settings.value("readTimeout", 10000).toInt());
+      }
+    }
+
+    if(currentRequest->getStatus() == HttpRequest::abort_size)
+    {
+      abort("HTTP/1.1 413 entity too large\r\nConnection: close\r\n\r\n413 Entity too large\r\n");
+      return;
+    }
+    else if(currentRequest->getStatus() == HttpRequest::abort_broken)
+    {
+      abort("HTTP/1.1 400 bad request\r\nConnection: close\r\n\r\n400 Bad request\r\n");
+      return;
+    }
+    else if(currentRequest->getStatus() == HttpRequest::complete)
+    {
+      readTimer.stop();
+      dispatch();
+      return;
+    }
+  }
+}
+
+void HttpEventConnection::dispatch()
+{
+  HttpRequest *request = currentRequest;
+  currentRequest = nullptr;
+  busy = true;
+
+  HttpServerMetrics::instance().addQueuedRequests(1);
+
+  // Run request handler in worker thread and return the response to this thread
+  workerPool->start(QRunnable::create([this, request]() {
+    HttpServerMetrics& metrics = HttpServerMetrics::instance();
+    metrics.addQueuedRequests(-1);
+    metrics.addActiveRequests(1);
+    QElapsedTimer serviceTimer;
+    serviceTimer.start();
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    bool closeConnection;
+
+    {
+      HttpResponse response(&buffer);
+      closeConnection = !response.setConnectionHeaders(*request);
+
+      try
+      {
+        requestHandler->service(*request, response);
+      }
+      catch(...)
+      {
+        qCritical("HttpEventConnection (%p): An uncatched exception occurred in the request handler",
+                  static_cast<void *>(this));
+      }
+
+      // Finalize the response if not already done
+      if(!response.hasSentLastPart())
+      {
+        response.write(QByteArray(), true);
+      }
+
+      closeConnection = closeConnection || !response.isKeepAlive();
+    }
+    metrics.addActiveRequests(-1);
+    metrics.recordRequest(request->getPath(), serviceTimer.nsecsElapsed() / 1000, buffer.size());
+    delete request;
+
+    QByteArray data = buffer.data();
+    QMetaObject::invokeMethod(this, [this, data, closeConnection]() {
+      responseReady(data, closeConnection);
+    }, Qt::QueuedConnection);
+  }));
+}
+
+void HttpEventConnection::responseReady(const QByteArray& data, bool closeConnection)
+{
+  busy = false;
+
+  if(disconnectedWhileBusy)
+  {
+    deleteLater();
+    return;
+  }
+
+  socket->write(data);
+
+  if(closeConnection)
+  {
+    // Pending data is sent before the connection is closed
+    socket->disconnectFromHost();
+  }
+  else
+  {
+    // Start timer for next request and process already received pipelined requests
+    readTimer.start(settings.value("readTimeout", 10000).toInt());
+    if(socket->bytesAvailable())
+    {
+      read();
+    }
+  }
+}
+
+// HttpEventLoop ==========================================================================
+
+HttpEventLoop::HttpEventLoop(const QHash<QString, QVariant>& settings, HttpRequestHandler *requestHandler,
+                             QThreadPool *workerPool, const QSslConfiguration *sslConfiguration,
+                             QAtomicInt *connectionCounter)
+  : QObject()
+{
+  this->settings = settings;
+  this->requestHandler = requestHandler;
+  this->workerPool = workerPool;
+  this->sslConfiguration = sslConfiguration;
+  this->connectionCounter = connectionCounter;
+}
+
+void HttpEventLoop::handleConnection(tSocketDescriptor socketDescriptor)
+{
+  // Connection is owned by this event loop and deletes itself on disconnect
+  HttpEventConnection *connection =
+    new HttpEventConnection(settings, requestHandler, workerPool, sslConfiguration, connectionCounter, this);
+  if(!connection->start(socketDescriptor))
+  {
+    delete connection;
+  }
+}
+
+// HttpEventLoopPool ==========================================================================
+
+HttpEventLoopPool::HttpEventLoopPool(const QHash<QString, QVariant>& settings, HttpRequestHandler *requestHandler)
+  : QObject()
+{
+  Q_ASSERT(requestHandler != nullptr);
+  this->settings = settings;
+  sslConfiguration = HttpConnectionHandlerPool::loadSslConfig(settings);
+  maxConnections = settings.value("maxConnections", 1000).toInt();
+
+  int numEventThreads = settings.value("eventThreads", 0).toInt();
+  if(numEventThreads <= 0)
+  {
+    numEventThreads = QThread::idealThreadCount();
+  }
+
+  int numWorkerThreads = settings.value("workerThreads", 0).toInt();
+  if(numWorkerThreads <= 0)
+  {
+    numWorkerThreads = QThread::idealThreadCount();
+  }
+  workerPool.setMaxThreadCount(numWorkerThreads);
+
+  for(int i = 0; i < numEventThreads; i++)
+  {
+    QThread *thread = new QThread();
+    thread->setObjectName(QStringLiteral("HttpEventLoop %1").arg(i));
+
+    HttpEventLoop *eventLoop = new HttpEventLoop(settings, requestHandler, &workerPool, sslConfiguration, &connectionCounter);
+    eventLoop->moveToThread(thread);
+
+    // Deletes the event loop and all its connections in the event loop thread
+    connect(thread, SIGNAL(finished()), eventLoop, SLOT(deleteLater()));
+    thread->start();
+
+    threads.append(thread);
+    eventLoops.append(eventLoop);
+  }
+
+  qDebug("HttpEventLoopPool (%p): %i event loops, %i workers", static_cast<void *>(this), numEventThreads, numWorkerThreads);
+}
+
+HttpEventLoopPool::~HttpEventLoopPool()
+{
+  // Process main events while waiting to avoid deadlocks if handlers require functions
+  // from main threads through blocking queued connections
+  while(!workerPool.waitForDone(1))
+  {
+    QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+  }
+
+  for(QThread *thread : std::as_const(threads))
+  {
+    thread->quit();
+  }
+
+  for(QThread *thread : std::as_const(threads))
+  {
+    thread->wait();
+    delete thread;
+  }
+
+  delete sslConfiguration;
+  qDebug("HttpEventLoopPool (%p): destroyed", static_cast<void *>(this));
+}
+
+bool HttpEventLoopPool::handleConnection(tSocketDescriptor socketDescriptor)
+{
+  if(eventLoops.isEmpty() || connectionCounter.loadAcquire() >= maxConnections)
+  {
+    return false;
+  }
+
+  connectionCounter.fetchAndAddOrdered(1);
+
+  // The descriptor is passed via event queue because the event loop lives in another thread
+  HttpEventLoop *eventLoop = eventLoops.at(nextEventLoop);
+  nextEventLoop = (nextEventLoop + 1) % eventLoops.size();
+  QMetaObject::invokeMethod(eventLoop, "handleConnection", Qt::QueuedConnection, Q_ARG(tSocketDescriptor, socketDescriptor));
+  return true;
+}
@@ -0,0 +1,212 @@
+/**
+ *  @file
+ *  Event driven connection handling for HttpListener.
+ */
+
+#ifndef HTTPEVENTLOOPPOOL_H
+#define HTTPEVENTLOOPPOOL_H
+
+#ifndef QT_NO_SSL
+   #include <QSslConfiguration>
+#endif
+#include <QAtomicInt>
+#include <QList>
+#include <QObject>
+#include <QThreadPool>
+#include <QTimer>
+#include "httpglobal.h"
+#include "httpconnectionhandler.h"
+#include "httprequest.h"
+#include "httprequesthandler.h"
+
+class QTcpSocket;
+class QThread;
+
+namespace stefanfrings {
+
+class HttpResponse;
+
+/**
+ *  A single client connection handled by HttpEventLoop. Lives in the thread of the event loop and
+ *  is deleted when the client disconnects.
+ *  <p>
+ *  Complete requests are passed to the worker pool. The response is written into a buffer there and
+ *  sent by the event loop thread afterwards. Pipelined requests are processed one after the other.
+ */
+class DECLSPEC HttpEventConnection :
+  public QObject
+{
+  Q_OBJECT
+  Q_DISABLE_COPY(HttpEventConnection)
+
+public:
+  /**
+   *  Constructor.
+   *  @param settings Configuration settings of the HTTP webserver
+   *  @param requestHandler Handler that will process each incoming HTTP request in the worker pool
+   *  @param workerPool Pool that runs the request handler
+   *  @param sslConfiguration SSL (HTTPS) will be used if not NULL
+   *  @param connectionCounter Decremented when this object is destroyed
+   *  @param parent Event loop owning this connection
+   */
+  HttpEventConnection(const QHash<QString, QVariant>& settings, HttpRequestHandler *requestHandler,
+                      QThreadPool *workerPool, const QSslConfiguration *sslConfiguration,
+                      QAtomicInt *connectionCounter, QObject *parent);
+
+  /** Destructor */
+  virtual ~HttpEventConnection();
+
+  /** Take over the accepted connection. Returns false if the socket cannot be initialized. */
+  bool start(tSocketDescriptor socketDescriptor);
+
+private:
+  /** Pass the complete request to the worker pool */
+  void dispatch();
+
+  /** Called in the event loop thread when the worker has finished the response */
+  void responseReady(const QByteArray& data, bool closeConnection);
+
+  /** Send error message and close the connection */
+  void abort(const QByteArray& message);
+
+  /** Configuration settings */
+  QHash<QString, QVariant> settings;
+
+  /** Dispatches received requests to services */
+  HttpRequestHandler *requestHandler;
+
+  /** Runs the request handler */
+  QThreadPool *workerPool;
+
+  /** Configuration for SSL */
+  const QSslConfiguration *sslConfiguration;
+
+  /** Number of open connections of the pool */
+  QAtomicInt *connectionCounter;
+
+  /** TCP socket of this connection */
+  QTcpSocket *socket = nullptr;
+
+  /** Time for read timeout detection */
+  QTimer readTimer;
+
+  /** Storage for the current incoming HTTP request */
+  HttpRequest *currentRequest = nullptr;
+
+  /** A request is processed in the worker pool */
+  bool busy = false;
+
+  /** Client disconnected while busy. Object is deleted once the response arrives. */
+  bool disconnectedWhileBusy = false;
+
+private slots:
+  /** Received from the socket when incoming data can be read */
+  void read();
+
+  /** Received from the socket when a read-timeout occured */
+  void readTimeout();
+
+  /** Received from the socket when a connection has been closed */
+  void disconnected();
+
+};
+
+/**
+ *  Event loop running in its own thread which serves many connections.
+ */
+class DECLSPEC HttpEventLoop :
+  public QObject
+{
+  Q_OBJECT
+  Q_DISABLE_COPY(HttpEventLoop)
+
+public:
+  HttpEventLoop(const QHash<QString, QVariant>& settings, HttpRequestHandler *requestHandler, QThreadPool *workerPool,
+                const QSslConfiguration *sslConfiguration, QAtomicInt *connectionCounter);
+
+public slots:
+  /**
+   *  Received from the pool when a new connection shall be handled by this event loop.
+   *  @param socketDescriptor references the accepted connection.
+   */
+  void handleConnection(const tSocketDescriptor socketDescriptor);
+
+private:
+  QHash<QString, QVariant> settings;
+  HttpRequestHandler *requestHandler;
+  QThreadPool *workerPool;
+  const QSslConfiguration *sslConfiguration;
+  QAtomicInt *connectionCounter;
+};
+
+/**
+ *  Alternative to HttpConnectionHandlerPool which multiplexes all connections on a small fixed
+ *  number of event loop threads instead of using one thread per connection. Request handlers are
+ *  run in a separate worker thread pool. This avoids one thread per client and scales to many
+ *  concurrent clients like map tile or AJAX requests.
+ *  <p>
+ *  Example for the configuration settings:
+ *  <code><pre>
+ *  engine=eventloop
+ *  eventThreads=0
+ *  workerThreads=0
+ *  maxConnections=1000
+ *  readTimeout=60000
+ *  maxRequestSize=16000
+ *  maxMultiPartSize=1000000
+ *  </pre></code>
+ *  <p>
+ *  eventThreads and workerThreads default to 0 which means the number of CPU cores.
+ *  New connections are refused if maxConnections are open.
+ *  The SSL settings are the same as for HttpConnectionHandlerPool.
+ *  <p>
+ *  Responses are built in memory by the worker and sent afterwards.
+ */
+class DECLSPEC HttpEventLoopPool :
+  public QObject
+{
+  Q_OBJECT
+  Q_DISABLE_COPY(HttpEventLoopPool)
+
+public:
+  /**
+   *  Constructor. Starts all event loop threads.
+   *  @param settings Configuration settings for the HTTP server.
+   *  @param requestHandler The handler that will process each received HTTP request.
+   */
+  HttpEventLoopPool(const QHash<QString, QVariant>& settings, HttpRequestHandler *requestHandler);
+
+  /** Destructor. Waits for running requests and stops all threads. */
+  virtual ~HttpEventLoopPool();
+
+  /**
+   *  Pass the connection to the next event loop.
+   *  @return false if the maximum number of connections is reached. The caller has to reject the connection.
+   */
+  bool handleConnection(tSocketDescriptor socketDescriptor);
+
+private:
+  /** Settings for this pool */
+  QHash<QString, QVariant> settings;
+
+  /** Runs the request handlers */
+  QThreadPool workerPool;
+
+  /** Threads and event loops with same index */
+  QList<QThread *> threads;
+  QList<HttpEventLoop *> eventLoops;
+
+  /** Round robin index into eventLoops */
+  int nextEventLoop = 0;
+
+  /** Number of open connections */
+  QAtomicInt connectionCounter;
+  int maxConnections;
+
+  /** The SSL configuration (certificate, key and other settings) */
+  QSslConfiguration *sslConfiguration;
+};
+
+} // end of namespace
+
+#endif // HTTPEVENTLOOPPOOL_H
@@ -0,0 +1,137 @@
+/**
+ *  @file
+ *  Server-sent events pushed to many web clients.
+ */
+
+#include "httpeventstreamcontroller.h"
+
+using namespace stefanfrings;
+
+HttpEventStreamController::HttpEventStreamController(const QHash<QString, QVariant>& settings, QObject *parent)
+  : HttpRequestHandler(parent)
+{
+  keepAliveInterval = settings.value("keepAliveInterval", 15000).toInt();
+  maxClients = settings.value("maxClients", 500).toInt();
+  retry = settings.value("retry", 3000).toInt();
+  qDebug("HttpEventStreamController: keepAliveInterval=%i, maxClients=%i", keepAliveInterval, maxClients);
+}
+
+HttpEventStreamController::~HttpEventStreamController()
+{
+  stop();
+
+  // Client threads still use this object
+  mutex.lock();
+  while(numClients > 0)
+  {
+    condition.wait(&mutex);
+  }
+  mutex.unlock();
+}
+
+void HttpEventStreamController::service(HttpRequest& request, HttpResponse& response)
+{
+  Q_UNUSED(request)
+
+  if(response.isBuffered())
+  {
+    qWarning("HttpEventStreamController: streaming is not supported by the connection engine");
+    response.setStatus(501, "not implemented");
+    response.write("501 not implemented", true);
+    return;
+  }
+
+  mutex.lock();
+  if(stopped || numClients >= maxClients)
+  {
+    mutex.unlock();
+    response.setStatus(503, "service unavailable");
+    response.write("503 service unavailable", true);
+    return;
+  }
+  numClients++;
+  mutex.unlock();
+
+  response.setHeader("Content-Type", "text/event-stream");
+  response.setHeader("Cache-Control", "no-cache");
+  bool connected = response.writeChunk("retry: " + QByteArray::number(retry) + "\n\n");
+
+  // Send the latest event right after connecting
+  qint64 lastEventId = 0;
+  while(connected)
+  {
+    QByteArray message;
+    mutex.lock();
+    if(!stopped && eventId == lastEventId)
+    {
+      condition.wait(&mutex, static_cast<unsigned long>(keepAliveInterval));
+    }
+
+    if(stopped)
+    {
+      mutex.unlock();
+      break;
+    }
+
+    // Skip all events published in the meantime
+    if(eventId != lastEventId)
+    {
+      message = eventMessage;
+      lastEventId = eventId;
+    }
+    mutex.unlock();
+
+    // Comment line if nothing was published
+    connected = response.writeChunk(message.isEmpty() ? QByteArray(":\n\n") : message);
+  }
+
+  if(connected)
+  {
+    response.write(QByteArray(), true);
+  }
+
+  mutex.lock();
+  numClients--;
+  condition.wakeAll();
+  mutex.unlock();
+}
+
+void HttpEventStreamController::publish(const QByteArray& data, const QByteArray& event)
+{
+  // Format once for all clients
+  QByteArray message;
+  message.reserve(data.size() + event.size() + 32);
+
+  if(!event.isEmpty())
+  {
+    message.append("event: ").append(event).append('\n');
+  }
+
+  for(const QByteArray& line : data.split('\n'))
+  {
+    message.append("data: ").append(line).append('\n');
+  }
+  message.append('\n');
+
+  mutex.lock();
+  eventId++;
+  eventMessage = "id: " + QByteArray::number(eventId) + '\n' + message;
+  condition.wakeAll();
+  mutex.unlock();
+}
+
+void HttpEventStreamController::stop()
+{
+  mutex.lock();
+  stopped = true;
+  condition.wakeAll();
+  mutex.unlock();
+}
+
+int HttpEventStreamController::getNumClients() const
+{
+  mutex.lock();
+  int num = numClients;
+  mutex.unlock();
+  return num;
+}
@@ -0,0 +1,97 @@
+/**
+ *  @file
+ *  Server-sent events pushed to many web clients.
+ */
+
+#ifndef HTTPEVENTSTREAMCONTROLLER_H
+#define HTTPEVENTSTREAMCONTROLLER_H
+
+#include <QMutex>
+#include <QWaitCondition>
+#include "httpglobal.h"
+#include "httprequest.h"
+#include "httpresponse.h"
+#include "httprequesthandler.h"
+
+namespace stefanfrings {
+
+/**
+ *  Pushes events to web clients using server-sent events (content type text/event-stream).
+ *  Browsers connect with <code>new EventSource(url)</code> and receive each published event
+ *  without polling.
+ *  <p>
+ *  Each client gets only the latest event. Events published while a slow client is still
+ *  busy with the previous one are coalesced, so slow clients never queue up outdated data.
+ *  The data is formatted only once for all clients.
+ *  <p>
+ *  The following settings are used:
+ *  <code><pre>
+ *  keepAliveInterval=15000
+ *  maxClients=500
+ *  retry=3000
+ *  </pre></code>
+ *  A comment line is sent after keepAliveInterval milliseconds without events to keep the
+ *  connection open and to detect lost clients. Further clients get a 503 response if maxClients
+ *  are connected. Retry is the reconnect time in milliseconds sent to the browser.
+ *  <p>
+ *  service() blocks while the client is connected. It needs the default engine of HttpListener
+ *  which uses one thread per connection. maxThreads has to be larger than maxClients.
+ *  <p>
+ *  Create one instance during start-up and pass requests for the stream path to it.
+ */
+class DECLSPEC HttpEventStreamController :
+  public HttpRequestHandler
+{
+  Q_OBJECT
+  Q_DISABLE_COPY(HttpEventStreamController)
+
+public:
+  /**
+   *  Constructor.
+   *  @param settings Configuration settings
+   *  @param parent Parent object
+   */
+  HttpEventStreamController(const QHash<QString, QVariant>& settings, QObject *parent = nullptr);
+
+  /** Destructor. Ends all streams and waits until all clients are released. */
+  virtual ~HttpEventStreamController() override;
+
+  /** Send events to the client until it disconnects or stop() is called */
+  void service(HttpRequest& request, HttpResponse& response) override;
+
+  /**
+   *  Publish an event to all clients. Replaces the previous event for clients which did not get it yet.
+   *  This method is thread safe.
+   *  @param data Event data. Can contain line breaks.
+   *  @param event Optional event type which can be used with addEventListener() in the browser
+   */
+  void publish(const QByteArray& data, const QByteArray& event = QByteArray());
+
+  /** End all streams. Further requests are rejected. */
+  void stop();
+
+  /** Number of connected clients */
+  int getNumClients() const;
+
+private:
+  /** Latest formatted event */
+  QByteArray eventMessage;
+
+  /** Incremented for each published event. Zero if nothing was published. */
+  qint64 eventId = 0;
+
+  bool stopped = false;
+  int numClients = 0;
+
+  int keepAliveInterval, maxClients, retry;
+
+  /** Used to protect all fields above */
+  mutable QMutex mutex;
+
+  /** Signalled on new events, stop and when a client leaves */
+  QWaitCondition condition;
+};
+
+} // end of namespace
+
+#endif // HTTPEVENTSTREAMCONTROLLER_H
@@ -6,6 +6,7 @@
 #include "httplistener.h"
 #include "httpconnectionhandler.h"
 #include "httpconnectionhandlerpool.h"
+#include "httpservermetrics.h"
 #include <QCoreApplication>
 
 using namespace stefanfrings;
@@ -15,6 +16,7 @@ HttpListener::HttpListener(const QHash<QString, QVariant>& settings, HttpRequest
 {
   Q_ASSERT(requestHandler != nullptr);
   pool = nullptr;
+  eventLoopPool = nullptr;
   this->settings = settings;
   this->requestHandler = requestHandler;
   // Reqister type of socketDescriptor for signal/slot handling
@@ -31,7 +33,14 @@ HttpListener::~HttpListener()
 
 void HttpListener::listen()
 {
-  if(!pool)
+  if(QString::compare(settings.value("engine").toString(), "eventloop", Qt::CaseInsensitive) == 0)
+  {
+    if(!eventLoopPool)
+    {
+      eventLoopPool = new HttpEventLoopPool(settings, requestHandler);
+    }
+  }
+  else if(!pool)
   {
     pool = new HttpConnectionHandlerPool(settings, requestHandler);
   }
@@ -57,6 +66,11 @@ void HttpListener::close()
     delete pool;
     pool = nullptr;
   }
+  if(eventLoopPool)
+  {
+    delete eventLoopPool;
+    eventLoopPool = nullptr;
+  }
 }
 
 void HttpListener::incomingConnection(tSocketDescriptor socketDescriptor)
@@ -65,6 +79,19 @@ void HttpListener::incomingConnection(tSocketDescriptor socketDescriptor)
   qDebug("HttpListener: New connection");
 #endif
 
+  if(eventLoopPool)
+  {
+    if(eventLoopPool->handleConnection(socketDescriptor))
+    {
+      HttpServerMetrics::instance().countConnection(true);
+    }
+    else
+    {
+      rejectConnection(socketDescriptor);
+    }
+    return;
+  }
+
   HttpConnectionHandler *freeHandler = nullptr;
   if(pool)
   {
@@ -74,17 +101,24 @@ void HttpListener::incomingConnection(tSocketDescriptor socketDescriptor)
   // Let the handler process the new connection.
   if(freeHandler)
   {
+    HttpServerMetrics::instance().countConnection(true);
+
     // The descriptor is passed via event queue because the handler lives in another thread
     QMetaObject::invokeMethod(freeHandler, "handleConnection", Qt::QueuedConnection, Q_ARG(tSocketDescriptor, socketDescriptor));
   }
   else
   {
-    // Reject the connection
-    qDebug("HttpListener: Too many incoming connections");
-    QTcpSocket *socket = new QTcpSocket(this);
-    socket->setSocketDescriptor(socketDescriptor);
-    connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
-    socket->write("HTTP/1.1 503 too many connections\r\nConnection: close\r\n\r\nToo many connections\r\n");
-    socket->disconnectFromHost();
+    rejectConnection(socketDescriptor);
   }
 }
+
+void HttpListener::rejectConnection(tSocketDescriptor socketDescriptor)
+{
+  qDebug("HttpListener: Too many incoming connections");
+  HttpServerMetrics::instance().countConnection(false);
+  QTcpSocket *socket = new QTcpSocket(this);
+  socket->setSocketDescriptor(socketDescriptor);
+  connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+  socket->write("HTTP/1.1 503 too many connections\r\nConnection: close\r\n\r\nToo many connections\r\n");
+  socket->disconnectFromHost();
+}
@@ -11,6 +11,7 @@
 #include "httpglobal.h"
 #include "httpconnectionhandler.h"
 #include "httpconnectionhandlerpool.h"
+#include "httpeventlooppool.h"
 #include "httprequesthandler.h"
 
 namespace stefanfrings {
@@ -41,6 +42,7 @@ namespace stefanfrings {
  *  otherwise the server accepts connections from any network interface on the given port.
  *  <p>
  *  The readTimeout value defines the maximum time to wait for a complete HTTP request.
+ *  It is also the idle time after which a persistent (keep-alive) connection is closed.
  *  <p>
  *  MaxRequestSize is the maximum size of a HTTP request. In case of
  *  multipart/form-data requests (also known as file-upload), the maximum
@@ -50,6 +52,10 @@ namespace stefanfrings {
  *  are started on demand when requests come in. The cleanup timer reduces
  *  the number of idle threads slowly by closing one thread in each interval.
  *  But the configured minimum number of threads are kept running.
+ *  <p>
+ *  With engine=eventloop all connections are served by a fixed number of event loop threads
+ *  instead and requests are processed in a worker pool. The thread settings above are not used then.
+ *  @see HttpEventLoopPool for the settings of this engine
  *  @see HttpConnectionHandlerPool for description of the optional ssl settings
  */
 
@@ -103,6 +109,12 @@ private:
   /** Pool of connection handlers */
   HttpConnectionHandlerPool *pool;
 
+  /** Event loops used instead of pool if engine=eventloop */
+  HttpEventLoopPool *eventLoopPool;
+
+  /** Reject connection with error 503 */
+  void rejectConnection(tSocketDescriptor socketDescriptor);
+
 signals:
   /**
    *  Sent to the connection handler to process a new incoming connection.
@@ -0,0 +1,30 @@
+/**
+ *  @file
+ *  Machine readable load counters of the HTTP server.
+ */
+
+#include "httpmetricscontroller.h"
+#include "httpservermetrics.h"
+#include <QJsonDocument>
+
+using namespace stefanfrings;
+
+HttpMetricsController::HttpMetricsController(QObject *parent)
+  : HttpRequestHandler(parent)
+{
+
+}
+
+void HttpMetricsController::service(HttpRequest& request, HttpResponse& response)
+{
+  HttpServerMetrics& metrics = HttpServerMetrics::instance();
+
+  response.setHeader("Content-Type", "application/json");
+  response.setHeader("Cache-Control", "no-store");
+  response.write(QJsonDocument(metrics.toJson()).toJson(QJsonDocument::Compact), true);
+
+  if(request.getParameter("reset") == "true")
+  {
+    metrics.reset();
+  }
+}
@@ -0,0 +1,57 @@
+/**
+ *  @file
+ *  Machine readable load counters of the HTTP server.
+ */
+
+#ifndef HTTPMETRICSCONTROLLER_H
+#define HTTPMETRICSCONTROLLER_H
+
+#include "httpglobal.h"
+#include "httprequest.h"
+#include "httpresponse.h"
+#include "httprequesthandler.h"
+
+namespace stefanfrings {
+
+/**
+ *  Sends the values of HttpServerMetrics as JSON document. Example:
+ *  <code><pre>
+ *  {
+ *    "uptimeMs": 60000,
+ *    "connections": {"accepted": 120, "rejected": 0, "open": 3},
+ *    "handlers": {"total": 8, "busy": 3, "idle": 5},
+ *    "requests": {"total": 950, "active": 1, "queued": 0, "bytesIn": 310000, "bytesOut": 5400000},
+ *    "bucketLimitsMs": [1, 2, 5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000],
+ *    "paths": {"/index.html": {"count": 40, "avgMs": 0.8, "maxMs": 3.1, "bytesOut": 90000,
+ *                              "buckets": [30, 8, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0]}},
+ *    "caches": {"staticfile": {"hits": 700, "misses": 12, "hitRate": 0.98}}
+ *  }
+ *  </pre></code>
+ *  Buckets contain the number of requests up to the respective limit in bucketLimitsMs. The
+ *  last bucket counts all slower requests. Handlers are only used by the default engine of
+ *  HttpListener while queued requests are only used by the event loop engine.
+ *  <p>
+ *  The request parameter "reset=true" resets all counters except the gauges after sending.
+ *  <p>
+ *  The endpoint should not be reachable from public networks.
+ */
+class DECLSPEC HttpMetricsController :
+  public HttpRequestHandler
+{
+  Q_OBJECT
+  Q_DISABLE_COPY(HttpMetricsController)
+
+public:
+  /**
+   *  Constructor.
+   *  @param parent Parent object
+   */
+  HttpMetricsController(QObject *parent = nullptr);
+
+  /** Send the metrics */
+  void service(HttpRequest& request, HttpResponse& response) override;
+};
+
+} // end of namespace
+
+#endif // HTTPMETRICSCONTROLLER_H
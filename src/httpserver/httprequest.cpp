@@ -8,6 +8,8 @@
 #include <QDir>
 #include "httpcookie.h"
 
+#include <algorithm>
+
 using namespace stefanfrings;
 
 HttpRequest::HttpRequest(const QHash<QString, QVariant>& settings)
@@ -17,7 +19,7 @@ HttpRequest::HttpRequest(const QHash<QString, QVariant>& settings)
   expectedBodySize = 0;
   maxSize = settings.value("maxRequestSize", "16000").toInt();
   maxMultiPartSize = settings.value("maxMultiPartSize", "1000000").toInt();
-  tempFile = nullptr;
+  uploadDirectory = settings.value("uploadDirectory").toString();
 }
 
 void HttpRequest::readRequest(QTcpSocket *socket)
@@ -125,7 +127,22 @@ void HttpRequest::readHeader(QTcpSocket *socket)
     {
       expectedBodySize = contentLength.toInt();
     }
-    if(expectedBodySize == 0)
+    chunkedBody = headers.value("transfer-encoding").toLower().contains("chunked");
+    if(chunkedBody)
+    {
+      // Content-Length has to be ignored if chunked
+      expectedBodySize = 0;
+      if(!boundary.isEmpty())
+      {
+        qWarning("HttpRequest: chunked multipart body is not supported");
+        status = abort_broken;
+      }
+      else
+      {
+        status = waitForBody;
+      }
+    }
+    else if(expectedBodySize == 0)
     {
             #ifdef SUPERVERBOSE
       qDebug("HttpRequest: expect no body");
@@ -154,8 +171,12 @@ void HttpRequest::readHeader(QTcpSocket *socket)
 
 void HttpRequest::readBody(QTcpSocket *socket)
 {
-  Q_ASSERT(expectedBodySize != 0);
-  if(boundary.isEmpty())
+  Q_ASSERT(expectedBodySize != 0 || chunkedBody);
+  if(chunkedBody)
+  {
+    readChunkedBody(socket);
+  }
+  else if(boundary.isEmpty())
   {
     // normal body, no multipart
         #ifdef SUPERVERBOSE
@@ -172,49 +193,114 @@ void HttpRequest::readBody(QTcpSocket *socket)
   }
   else
   {
-    // multipart body, store into temp file
+    // multipart body, split into parts while receiving
         #ifdef SUPERVERBOSE
     qDebug("HttpRequest: receiving multipart body");
         #endif
-    // Create an object for the temporary file, if not already present
-    if(tempFile == nullptr)
-    {
-      tempFile = new QTemporaryFile;
-    }
-    if(!tempFile->isOpen())
-    {
-      static_cast<void>(tempFile->open());
-    }
     // Transfer data in 64kb blocks
-    qint64 fileSize = tempFile->size();
-    qint64 toRead = expectedBodySize - fileSize;
+    qint64 toRead = expectedBodySize - multiPartReceived;
     if(toRead > 65536)
     {
       toRead = 65536;
     }
-    fileSize += tempFile->write(socket->read(toRead));
-    if(fileSize >= maxMultiPartSize)
+    QByteArray newData = socket->read(toRead);
+    multiPartReceived += newData.size();
+    multiPartBuffer.append(newData);
+    if(multiPartReceived >= maxMultiPartSize)
     {
       qWarning("HttpRequest: received too many multipart bytes");
       status = abort_size;
+      return;
     }
-    else if(fileSize >= expectedBodySize)
+
+    parseMultiPartData();
+
+    if(status != abort_broken && multiPartReceived >= expectedBodySize)
     {
         #ifdef SUPERVERBOSE
       qDebug("HttpRequest: received whole multipart body");
         #endif
-      tempFile->flush();
-      if(tempFile->error())
+      if(multiPartState != multiPartDone)
       {
-        qCritical("HttpRequest: Error writing temp file for multipart body");
+        qWarning("HttpRequest: format error, unexpected end of multipart data");
       }
-      parseMultiPartFile();
-      tempFile->close();
+      multiPartBuffer.clear();
       status = complete;
     }
   }
 }
 
+void HttpRequest::readChunkedBody(QTcpSocket *socket)
+{
+  if(chunkState == chunkData)
+  {
+    QByteArray newData = socket->read(chunkRemaining);
+    currentSize += newData.size();
+    bodyData.append(newData);
+    chunkRemaining -= newData.size();
+    if(chunkRemaining == 0)
+    {
+      chunkState = chunkDataEnd;
+    }
+    return;
+  }
+
+  // Read chunk size, line break after chunk data or trailer line
+  int toRead = maxSize - currentSize + 1; // allow one byte more to be able to detect overflow
+  QByteArray dataRead = socket->readLine(toRead);
+  currentSize += dataRead.size();
+  lineBuffer.append(dataRead);
+  if(!lineBuffer.contains("\r\n"))
+  {
+    return;
+  }
+  QByteArray line = lineBuffer.trimmed();
+  lineBuffer.clear();
+
+  if(chunkState == chunkSize)
+  {
+    // Ignore chunk extensions after semicolon
+    bool ok;
+    chunkRemaining = line.split(';').constFirst().trimmed().toInt(&ok, 16);
+    if(!ok || chunkRemaining < 0)
+    {
+      qWarning("HttpRequest: received broken chunk size");
+      status = abort_broken;
+    }
+    else if(chunkRemaining == 0)
+    {
+      chunkState = chunkTrailer;
+    }
+    else if(currentSize + chunkRemaining > maxSize)
+    {
+      qWarning("HttpRequest: expected chunk is too large");
+      status = abort_size;
+    }
+    else
+    {
+      chunkState = chunkData;
+    }
+  }
+  else if(chunkState == chunkDataEnd)
+  {
+    if(line.isEmpty())
+    {
+      chunkState = chunkSize;
+    }
+    else
+    {
+      qWarning("HttpRequest: missing line break after chunk");
+      status = abort_broken;
+    }
+  }
+  else if(line.isEmpty())
+  {
+    // Empty line after optional trailer headers which are ignored
+    expectedBodySize = bodyData.size();
+    status = complete;
+  }
+}
+
 void HttpRequest::decodeRequestParams()
 {
     #ifdef SUPERVERBOSE
@@ -352,6 +438,31 @@ QByteArray HttpRequest::getHeader(const QByteArray& name) const
   return headers.value(name.toLower());
 }
 
+bool HttpRequest::isKeepAlive() const
+{
+  bool close = false, keepAlive = false;
+  for(const QByteArray& header : headers.values("connection"))
+  {
+    for(const QByteArray& token : header.split(','))
+    {
+      QByteArray value = token.trimmed().toLower();
+      close |= value == "close";
+      keepAlive |= value == "keep-alive";
+    }
+  }
+
+  if(close)
+  {
+    return false;
+  }
+  return isHttp10() ? keepAlive : true;
+}
+
+bool HttpRequest::isHttp10() const
+{
+  return QString::compare(version, "HTTP/1.0", Qt::CaseInsensitive) == 0;
+}
+
 QList<QByteArray> HttpRequest::getHeaders(const QByteArray& name) const
 {
   return headers.values(name.toLower());
@@ -401,39 +512,97 @@ QByteArray HttpRequest::urlDecode(const QByteArray source)
   return buffer;
 }
 
-void HttpRequest::parseMultiPartFile()
+void HttpRequest::parseMultiPartData()
 {
-  qDebug("HttpRequest: parsing multipart temp file");
-  tempFile->seek(0);
-  bool finished = false;
-  while(!tempFile->atEnd() && !finished && !tempFile->error())
+  QByteArray delimiter = "--" + boundary;
+  QByteArray dataDelimiter = "\r\n" + delimiter;
+  qsizetype pos = 0;
+
+  while(multiPartState != multiPartDone)
   {
-        #ifdef SUPERVERBOSE
-    qDebug("HttpRequest: reading multpart headers");
-        #endif
-    QByteArray fieldName;
-    QByteArray fileName;
-    while(!tempFile->atEnd() && !finished && !tempFile->error())
+    if(multiPartState == multiPartPreamble)
     {
-      QByteArray line = tempFile->readLine(65536).trimmed();
-      if(line.startsWith("Content-Disposition:"))
+      // Skip everything before the first boundary
+      qsizetype found = multiPartBuffer.indexOf(delimiter, pos);
+      if(found < 0)
+      {
+        pos = std::max(pos, multiPartBuffer.size() - delimiter.size() + 1);
+        break;
+      }
+      pos = found + delimiter.size();
+      multiPartState = multiPartBoundary;
+    }
+    else if(multiPartState == multiPartBoundary)
+    {
+      // Boundary is followed by "--" for the end or a line break
+      if(multiPartBuffer.size() - pos < 2)
+      {
+        break;
+      }
+      if(multiPartBuffer.mid(pos, 2) == "--")
+      {
+        multiPartState = multiPartDone;
+        pos = multiPartBuffer.size();
+        break;
+      }
+      qsizetype lineEnd = multiPartBuffer.indexOf("\r\n", pos);
+      if(lineEnd < 0)
+      {
+        break;
+      }
+      pos = lineEnd + 2;
+      partFieldName.clear();
+      partFileName.clear();
+      partValue.clear();
+      multiPartState = multiPartHeader;
+    }
+    else if(multiPartState == multiPartHeader)
+    {
+      qsizetype lineEnd = multiPartBuffer.indexOf("\r\n", pos);
+      if(lineEnd < 0)
+      {
+        if(multiPartBuffer.size() - pos > 65536)
+        {
+          qWarning("HttpRequest: multipart header line too long");
+          status = abort_broken;
+        }
+        break;
+      }
+      QByteArray line = multiPartBuffer.mid(pos, lineEnd - pos).trimmed();
+      pos = lineEnd + 2;
+
+      if(line.isEmpty())
+      {
+        // End of part headers
+        if(!partFileName.isEmpty() && !partFieldName.isEmpty())
+        {
+          partFile = uploadDirectory.isEmpty() ? new QTemporaryFile() :
+                     new QTemporaryFile(uploadDirectory + "/upload_XXXXXX");
+          if(!partFile->open())
+          {
+            qCritical("HttpRequest: cannot create file for upload, %s", qPrintable(partFile->errorString()));
+          }
+        }
+        multiPartState = multiPartData;
+      }
+      else if(line.toLower().startsWith("content-disposition:"))
       {
         if(line.contains("form-data"))
         {
-          int start = line.indexOf(" name=\"");
-          int end = line.indexOf("\"", start + 7);
+          qsizetype start = line.indexOf(" name=\"");
+          qsizetype end = line.indexOf("\"", start + 7);
           if(start >= 0 && end >= start)
           {
-            fieldName = line.mid(start + 7, end - start - 7);
+            partFieldName = line.mid(start + 7, end - start - 7);
           }
           start = line.indexOf(" filename=\"");
           end = line.indexOf("\"", start + 11);
           if(start >= 0 && end >= start)
           {
-            fileName = line.mid(start + 11, end - start - 11);
+            partFileName = line.mid(start + 11, end - start - 11);
           }
                     #ifdef SUPERVERBOSE
-          qDebug("HttpRequest: multipart field=%s, filename=%s", fieldName.data(), fileName.data());
+          qDebug("HttpRequest: multipart field=%s, filename=%s", partFieldName.data(), partFileName.data());
                     #endif
         }
         else
@@ -441,91 +610,81 @@ void HttpRequest::parseMultiPartFile()
           qDebug("HttpRequest: ignoring unsupported content part %s", line.data());
         }
       }
-      else if(line.isEmpty())
-      {
-        break;
-      }
     }
-
-        #ifdef SUPERVERBOSE
-    qDebug("HttpRequest: reading multpart data");
-        #endif
-    QTemporaryFile *uploadedFile = nullptr;
-    QByteArray fieldValue;
-    while(!tempFile->atEnd() && !finished && !tempFile->error())
+    else if(multiPartState == multiPartData)
     {
-      QByteArray line = tempFile->readLine(65536);
-      if(line.startsWith("--" + boundary))
+      qsizetype found = multiPartBuffer.indexOf(dataDelimiter, pos);
+      if(found < 0)
       {
-        // Boundary found. Until now we have collected 2 bytes too much,
-        // so remove them from the last result
-        if(fileName.isEmpty() && !fieldName.isEmpty())
-        {
-          // last field was a form field
-          fieldValue.remove(fieldValue.size() - 2, 2);
-          parameters.insert(fieldName, fieldValue);
-          qDebug("HttpRequest: set parameter %s=%s", fieldName.data(), fieldValue.data());
-        }
-        else if(!fileName.isEmpty() && !fieldName.isEmpty())
-        {
-          // last field was a file
-          if(uploadedFile)
-          {
-                        #ifdef SUPERVERBOSE
-            qDebug("HttpRequest: finishing writing to uploaded file");
-                        #endif
-            uploadedFile->resize(uploadedFile->size() - 2);
-            uploadedFile->flush();
-            uploadedFile->seek(0);
-            parameters.insert(fieldName, fileName);
-            qDebug("HttpRequest: set parameter %s=%s", fieldName.data(), fileName.data());
-            uploadedFiles.insert(fieldName, uploadedFile);
-            long int fileSize = (long int)uploadedFile->size();
-            qDebug("HttpRequest: uploaded file size is %li", fileSize);
-          }
-          else
-          {
-            qWarning("HttpRequest: format error, unexpected end of file data");
-          }
-        }
-        if(line.contains(boundary + "--"))
+        // Pass all data which cannot be the start of a boundary
+        qsizetype safeEnd = multiPartBuffer.size() - dataDelimiter.size() + 1;
+        if(safeEnd > pos)
         {
-          finished = true;
+          appendPartData(multiPartBuffer.constData() + pos, safeEnd - pos);
+          pos = safeEnd;
         }
         break;
       }
-      else
-      {
-        if(fileName.isEmpty() && !fieldName.isEmpty())
-        {
-          // this is a form field.
-          currentSize += line.size();
-          fieldValue.append(line);
-        }
-        else if(!fileName.isEmpty() && !fieldName.isEmpty())
-        {
-          // this is a file
-          if(!uploadedFile)
-          {
-            uploadedFile = new QTemporaryFile();
-            static_cast<void>(uploadedFile->open());
-          }
-          uploadedFile->write(line);
-          if(uploadedFile->error())
-          {
-            qCritical("HttpRequest: error writing temp file, %s", qPrintable(uploadedFile->errorString()));
-          }
-        }
-      }
+      appendPartData(multiPartBuffer.constData() + pos, found - pos);
+      finishPart();
+      pos = found + dataDelimiter.size();
+      multiPartState = multiPartBoundary;
     }
   }
-  if(tempFile->error())
+
+  // Remove parsed bytes once per call
+  multiPartBuffer.remove(0, pos);
+}
+
+void HttpRequest::appendPartData(const char *data, qint64 size)
+{
+  if(size <= 0 || partFieldName.isEmpty())
   {
-    qCritical("HttpRequest: cannot read temp file, %s", qPrintable(tempFile->errorString()));
+    return;
+  }
+
+  if(partFile != nullptr)
+  {
+    partFile->write(data, size);
+    if(partFile->error())
+    {
+      qCritical("HttpRequest: error writing temp file, %s", qPrintable(partFile->errorString()));
+    }
+  }
+  else if(partFileName.isEmpty())
+  {
+    // this is a form field.
+    currentSize += static_cast<int>(size);
+    partValue.append(data, size);
   }
-    #ifdef SUPERVERBOSE
-  qDebug("HttpRequest: finished parsing multipart temp file");
-    #endif
+}
+
+void HttpRequest::finishPart()
+{
+  if(partFileName.isEmpty() && !partFieldName.isEmpty())
+  {
+    // last field was a form field
+    parameters.insert(partFieldName, partValue);
+    qDebug("HttpRequest: set parameter %s=%s", partFieldName.data(), partValue.data());
+  }
+  else if(partFile != nullptr)
+  {
+        #ifdef SUPERVERBOSE
+    qDebug("HttpRequest: finishing writing to uploaded file");
+        #endif
+    partFile->flush();
+    partFile->seek(0);
+    parameters.insert(partFieldName, partFileName);
+    qDebug("HttpRequest: set parameter %s=%s", partFieldName.data(), partFileName.data());
+
+    // Replace file from a previous part with the same name
+    delete uploadedFiles.value(partFieldName);
+    uploadedFiles.insert(partFieldName, partFile);
+    long int fileSize = (long int)partFile->size();
+    qDebug("HttpRequest: uploaded file size is %li", fileSize);
+  }
+  partFile = nullptr;
+  partValue.clear();
 }
 
 HttpRequest::~HttpRequest()
@@ -539,14 +698,8 @@ HttpRequest::~HttpRequest()
     }
     delete file;
   }
-  if(tempFile != nullptr)
-  {
-    if(tempFile->isOpen())
-    {
-      tempFile->close();
-    }
-    delete tempFile;
-  }
+  // File of an incomplete part
+  delete partFile;
 }
 
 QTemporaryFile *HttpRequest::getUploadedFile(const QByteArray fieldName) const
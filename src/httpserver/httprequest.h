@@ -26,11 +26,21 @@ namespace stefanfrings {
  *  <code><pre>
  *  maxRequestSize=16000
  *  maxMultiPartSize=1000000
+ *  ;uploadDirectory=/tmp
  *  </pre></code>
  *  <p>
  *  MaxRequestSize is the maximum size of a HTTP request. In case of
  *  multipart/form-data requests (also known as file-upload), the maximum
  *  size of the body must not exceed maxMultiPartSize.
+ *  <p>
+ *  Multipart bodies are split into parts while the bytes arrive. Uploaded files are written
+ *  directly into temporary files in uploadDirectory which defaults to the system temp directory.
+ *  Use a directory on the same file system as the final destination to move uploaded files
+ *  with QFile::rename() instead of copying them.
+ *  <p>
+ *  Only the bytes of one request are read from the socket, so pipelined requests
+ *  remain in the socket for the next HttpRequest object. Request bodies may use
+ *  Content-Length or chunked transfer encoding.
  */
 
 class DECLSPEC HttpRequest
@@ -82,6 +92,16 @@ public:
   /** Get the version of the HTPP request (e.g. "HTTP/1.1") */
   const QByteArray& getVersion() const;
 
+  /**
+   *  True if the connection can be kept open for further requests after the response.
+   *  HTTP 1.1 connections are persistent unless the client sends Connection:close.
+   *  HTTP 1.0 connections are persistent only if the client sends Connection:keep-alive.
+   */
+  bool isKeepAlive() const;
+
+  /** True if the request uses the HTTP 1.0 protocol */
+  bool isHttp10() const;
+
   /**
    *  Get the value of a HTTP request header.
    *  @param name Name of the header, not case-senitive.
@@ -202,17 +222,59 @@ private:
   /** Expected size of body */
   int expectedBodySize;
 
+  /** States for reading a body with chunked transfer encoding */
+  enum ChunkState
+  {
+    chunkSize, chunkData, chunkDataEnd, chunkTrailer
+  };
+
+  /** Body uses chunked transfer encoding */
+  bool chunkedBody = false;
+
+  /** Current state while reading a chunked body */
+  ChunkState chunkState = chunkSize;
+
+  /** Remaining bytes of the current chunk */
+  int chunkRemaining = 0;
+
   /** Name of the current header, or empty if no header is being processed */
   QByteArray currentHeader;
 
   /** Boundary of multipart/form-data body. Empty if there is no such header */
   QByteArray boundary;
 
-  /** Temp file, that is used to store the multipart/form-data body */
-  QTemporaryFile *tempFile;
+  /** States for parsing a multipart/form-data body */
+  enum MultiPartState
+  {
+    multiPartPreamble, multiPartBoundary, multiPartHeader, multiPartData, multiPartDone
+  };
+
+  /** Current state of the multipart parser */
+  MultiPartState multiPartState = multiPartPreamble;
+
+  /** Received bytes which are not parsed yet */
+  QByteArray multiPartBuffer;
+
+  /** Number of received multipart body bytes */
+  qint64 multiPartReceived = 0;
+
+  /** Field name, file name and value of the current part */
+  QByteArray partFieldName, partFileName, partValue;
 
-  /** Parse the multipart body, that has been stored in the temp file. */
-  void parseMultiPartFile();
+  /** File of the current part or null if the part is a form field */
+  QTemporaryFile *partFile = nullptr;
+
+  /** Directory for uploaded files. Empty for system temp directory. */
+  QString uploadDirectory;
+
+  /** Split the received multipart data into parts and write file parts into their files. */
+  void parseMultiPartData();
+
+  /** Add data to the current part */
+  void appendPartData(const char *data, qint64 size);
+
+  /** Store the current part as parameter and uploaded file */
+  void finishPart();
 
   /** Sub-procedure of readFromSocket(), read the first line of a request. */
   void readRequest(QTcpSocket *socket);
@@ -223,6 +285,9 @@ private:
   /** Sub-procedure of readFromSocket(), read the request body. */
   void readBody(QTcpSocket *socket);
 
+  /** Sub-procedure of readBody(), read a body with chunked transfer encoding. */
+  void readChunkedBody(QTcpSocket *socket);
+
   /** Sub-procedure of readFromSocket(), extract and decode request parameters. */
   void decodeRequestParams();
 
@@ -7,7 +7,7 @@
 
 using namespace stefanfrings;
 
-HttpResponse::HttpResponse(QTcpSocket *socket)
+HttpResponse::HttpResponse(QIODevice *socket)
 {
   this->socket = socket;
   statusCode = 200;
@@ -17,6 +17,56 @@ HttpResponse::HttpResponse(QTcpSocket *socket)
   chunkedMode = false;
 }
 
+bool HttpResponse::setConnectionHeaders(const HttpRequest& request)
+{
+  if(!request.isKeepAlive())
+  {
+    setHeader("Connection", "close");
+    return false;
+  }
+  else if(request.isHttp10())
+  {
+    // HTTP 1.0 connections are closed by default and do not support chunked mode
+    setHeader("Connection", "keep-alive");
+    chunkedModeAllowed = false;
+  }
+  return true;
+}
+
+bool HttpResponse::isKeepAlive() const
+{
+  if(isConnectionClose())
+  {
+    return false;
+  }
+
+  // Without Content-Length header and chunked mode the client detects the end of the response by closing
+  return headers.contains("Content-Length") ||
+         QString::compare(headers.value("Transfer-Encoding"), "chunked", Qt::CaseInsensitive) == 0;
+}
+
+bool HttpResponse::isConnectionClose() const
+{
+  QByteArray connectionValue = headers.value("Connection", headers.value("connection"));
+  return QString::compare(connectionValue, "close", Qt::CaseInsensitive) == 0;
+}
+
+void HttpResponse::selectChunkedMode()
+{
+  if(!isConnectionClose() && !headers.contains("Content-Length"))
+  {
+    if(chunkedModeAllowed)
+    {
+      headers.insert("Transfer-Encoding", "chunked");
+      chunkedMode = true;
+    }
+    else
+    {
+      headers.insert("Connection", "close");
+    }
+  }
+}
+
 void HttpResponse::setHeader(QByteArray name, QByteArray value)
 {
   Q_ASSERT(sentHeaders == false);
@@ -45,6 +95,11 @@ int HttpResponse::getStatusCode() const
   return this->statusCode;
 }
 
+const QByteArray& HttpResponse::getStatusText() const
+{
+  return statusText;
+}
+
 void HttpResponse::writeHeaders()
 {
   Q_ASSERT(sentHeaders == false);
@@ -69,7 +124,7 @@ void HttpResponse::writeHeaders()
   }
   buffer.append("\r\n");
   writeToSocket(buffer);
-  socket->flush();
+  flushSocket();
   sentHeaders = true;
 }
 
@@ -92,6 +147,7 @@ bool HttpResponse::writeToSocket(QByteArray data)
     }
     ptr += written;
     remaining -= written;
+    bytesWritten += written;
   }
   return true;
 }
@@ -114,13 +170,7 @@ void HttpResponse::write(QByteArray data, bool lastPart)
     // then we must use the chunked mode.
     else
     {
-      QByteArray connectionValue = headers.value("Connection", headers.value("connection"));
-      bool connectionClose = QString::compare(connectionValue, "close", Qt::CaseInsensitive) == 0;
-      if(!connectionClose && !headers.contains("Content-Length"))
-      {
-        headers.insert("Transfer-Encoding", "chunked");
-        chunkedMode = true;
-      }
+      selectChunkedMode();
     }
 
     writeHeaders();
@@ -153,11 +203,40 @@ void HttpResponse::write(QByteArray data, bool lastPart)
     {
       writeToSocket("0\r\n\r\n");
     }
-    socket->flush();
+    flushSocket();
     sentLastPart = true;
   }
 }
 
+void HttpResponse::beginChunked()
+{
+  Q_ASSERT(sentHeaders == false);
+  headers.remove("Content-Length");
+  selectChunkedMode();
+  writeHeaders();
+}
+
+bool HttpResponse::writeChunk(const QByteArray& data)
+{
+  Q_ASSERT(sentLastPart == false);
+  if(sentHeaders == false)
+  {
+    beginChunked();
+  }
+
+  if(!data.isEmpty())
+  {
+    write(data);
+    flushSocket();
+  }
+  return isConnected();
+}
+
+qint64 HttpResponse::getBytesWritten() const
+{
+  return bytesWritten;
+}
+
 bool HttpResponse::hasSentLastPart() const
 {
   return sentLastPart;
@@ -186,10 +265,29 @@ void HttpResponse::redirect(const QByteArray& url)
 
 void HttpResponse::flush()
 {
-  socket->flush();
+  flushSocket();
+}
+
+void HttpResponse::flushSocket()
+{
+  QAbstractSocket *abstractSocket = qobject_cast<QAbstractSocket *>(socket);
+  if(abstractSocket != nullptr)
+  {
+    abstractSocket->flush();
+  }
 }
 
 bool HttpResponse::isConnected() const
 {
+  QAbstractSocket *abstractSocket = qobject_cast<QAbstractSocket *>(socket);
+  if(abstractSocket != nullptr)
+  {
+    return abstractSocket->isOpen() && abstractSocket->state() == QAbstractSocket::ConnectedState;
+  }
   return socket->isOpen();
 }
+
+bool HttpResponse::isBuffered() const
+{
+  return qobject_cast<QAbstractSocket *>(socket) == nullptr;
+}
@@ -11,6 +11,7 @@
 #include <QTcpSocket>
 #include "httpglobal.h"
 #include "httpcookie.h"
+#include "httprequest.h"
 
 namespace stefanfrings {
 
@@ -31,6 +32,15 @@ namespace stefanfrings {
  *  <p>
  *  In case of large responses (e.g. file downloads), a Content-Length header should be set
  *  before calling write(). Web Browsers use that information to display a progress bar.
+ *  <p>
+ *  Streams of unknown length like map images or JSON updates can be sent with
+ *  beginChunked() and writeChunk(). Each chunk is sent to the client immediately:
+ *  <code><pre>
+ *   response.beginChunked();
+ *   while(hasMoreData && response.writeChunk(nextData()))
+ *     ;
+ *   response.write(QByteArray(), true);
+ *  </pre></code>
  */
 
 class DECLSPEC HttpResponse
@@ -40,9 +50,24 @@ class DECLSPEC HttpResponse
 public:
   /**
    *  Constructor.
-   *  @param socket used to write the response
+   *  @param socket used to write the response. Can also be a QBuffer to build the
+   *  response in another thread than the one owning the socket.
+   */
+  HttpResponse(QIODevice *socket);
+
+  /**
+   *  Set the Connection header depending on the request and disable chunked mode for HTTP 1.0 clients.
+   *  Called by the connection handler before the request handler.
+   *  @return true if the client wants to keep the connection open after the response
+   */
+  bool setConnectionHeaders(const HttpRequest& request);
+
+  /**
+   *  True if the connection can be kept open after this response was sent, i.e. there is
+   *  no Connection:close header and the client can detect the end of the body by the
+   *  Content-Length header or chunked mode.
    */
-  HttpResponse(QTcpSocket *socket);
+  bool isKeepAlive() const;
 
   /**
    *  Set a HTTP response header.
@@ -75,6 +100,9 @@ public:
   /** Return the status code. */
   int getStatusCode() const;
 
+  /** Return the status description. */
+  const QByteArray& getStatusText() const;
+
   /**
    *  Write body data to the socket.
    *  <p>
@@ -90,6 +118,22 @@ public:
    */
   void write(const QByteArray data, const bool lastPart = false);
 
+  /**
+   *  Start a streaming response of unknown length. Sends the status line and headers immediately
+   *  using chunked mode. A Content-Length header is removed. Clients which do not support chunked
+   *  mode get a Connection:close header instead.
+   *  Finish the response by calling write() with lastPart=true.
+   */
+  void beginChunked();
+
+  /**
+   *  Send a part of a streaming response and flush it to the client. Calls beginChunked() if not done yet.
+   *  Empty data is ignored since an empty chunk terminates the body.
+   *  @param data Data bytes of the chunk
+   *  @return false if the connection to the client was lost and producing more data is pointless
+   */
+  bool writeChunk(const QByteArray& data);
+
   /**
    *  Indicates whether the body has been sent completely (write() has been called with lastPart=true).
    */
@@ -121,12 +165,21 @@ public:
    */
   bool isConnected() const;
 
+  /**
+   *  True if the response is written into a buffer and sent after the request handler returned.
+   *  Streaming to the client is not possible in this case.
+   */
+  bool isBuffered() const;
+
+  /** Number of bytes written including headers and chunk markers */
+  qint64 getBytesWritten() const;
+
 private:
   /** Request headers */
   QMap<QByteArray, QByteArray> headers;
 
-  /** Socket for writing output */
-  QTcpSocket *socket;
+  /** Socket or buffer for writing output */
+  QIODevice *socket;
 
   /** HTTP status code*/
   int statusCode;
@@ -143,6 +196,12 @@ private:
   /** Whether the response is sent in chunked mode */
   bool chunkedMode;
 
+  /** Number of bytes passed to the socket */
+  qint64 bytesWritten = 0;
+
+  /** False for HTTP 1.0 clients which do not support chunked mode */
+  bool chunkedModeAllowed = true;
+
   /** Cookies */
   QMap<QByteArray, HttpCookie> cookies;
 
@@ -156,6 +215,18 @@ private:
    */
   void writeHeaders();
 
+  /** Flush the socket. Does nothing if writing to a buffer. */
+  void flushSocket();
+
+  /** True if a Connection:close header is set */
+  bool isConnectionClose() const;
+
+  /**
+   *  Use chunked mode if the length is unknown and the client supports it.
+   *  Otherwise the end of the body is signalled by closing the connection.
+   */
+  void selectChunkedMode();
+
 };
 
 } // end of namespace
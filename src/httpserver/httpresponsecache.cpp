@@ -0,0 +1,200 @@
+/**
+ *  @file
+ *  Caching wrapper for request handlers.
+ */
+
+#include "httpresponsecache.h"
+#include "zip/gzip.h"
+#include <QBuffer>
+#include <QDateTime>
+
+using namespace stefanfrings;
+
+HttpResponseCache::HttpResponseCache(const QHash<QString, QVariant>& settings, HttpRequestHandler *requestHandler,
+                                     QObject *parent)
+  : HttpRequestHandler(parent)
+{
+  Q_ASSERT(requestHandler != nullptr);
+  this->requestHandler = requestHandler;
+  cache.setMaxCost(static_cast<qsizetype>(settings.value("cacheSize", "4000000").toLongLong()));
+  maxCachedResponseSize = settings.value("maxCachedResponseSize", "262144").toLongLong();
+  cacheTimeout = settings.value("cacheTime", "0").toInt();
+  compressMinSize = settings.value("compressMinSize", "1024").toInt();
+  cacheCounters = HttpServerMetrics::instance().getCacheCounters("response");
+  qDebug("HttpResponseCache: cache timeout=%i, size=%lli", cacheTimeout, static_cast<long long>(cache.maxCost()));
+}
+
+HttpResponseCache::~HttpResponseCache()
+{
+
+}
+
+void HttpResponseCache::incrementGeneration()
+{
+  mutex.lock();
+  generation++;
+  cache.clear();
+  mutex.unlock();
+}
+
+quint64 HttpResponseCache::getGeneration() const
+{
+  mutex.lock();
+  quint64 value = generation;
+  mutex.unlock();
+  return value;
+}
+
+void HttpResponseCache::service(HttpRequest& request, HttpResponse& response)
+{
+  if(request.getMethod() != "GET")
+  {
+    requestHandler->service(request, response);
+    return;
+  }
+
+  QByteArray key = request.getRawPath();
+  bool acceptGzip = request.getHeader("Accept-Encoding").toLower().contains("gzip");
+  qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+  mutex.lock();
+  quint64 startGeneration = generation;
+  CacheEntry *entry = cache.object(key);
+  if(entry && (cacheTimeout == 0 || entry->created > now - cacheTimeout))
+  {
+    // Copy the entry, because other threads may destroy the cached entry immediately after mutex unlock.
+    CacheEntry cached = *entry;
+    mutex.unlock();
+    cacheCounters->count(true);
+    sendEntry(cached, acceptGzip, response);
+    return;
+  }
+  mutex.unlock();
+  cacheCounters->count(false);
+
+  // Let the handler write into a buffer
+  QBuffer buffer;
+  buffer.open(QIODevice::WriteOnly);
+  HttpResponse innerResponse(&buffer);
+  requestHandler->service(request, innerResponse);
+  if(!innerResponse.hasSentLastPart())
+  {
+    innerResponse.write(QByteArray(), true);
+  }
+
+  QMap<QByteArray, QByteArray>& innerHeaders = innerResponse.getHeaders();
+  bool chunked = QString::compare(innerHeaders.value("Transfer-Encoding"), "chunked", Qt::CaseInsensitive) == 0;
+
+  CacheEntry result;
+  result.statusCode = innerResponse.getStatusCode();
+  result.statusText = innerResponse.getStatusText();
+  result.body = extractBody(buffer.data(), chunked);
+  result.created = now;
+
+  // Connection and size headers belong to the response sent to the client
+  for(auto it = innerHeaders.constBegin(); it != innerHeaders.constEnd(); ++it)
+  {
+    QByteArray name = it.key().toLower();
+    if(name != "content-length" && name != "transfer-encoding" && name != "connection")
+    {
+      result.headers.insert(it.key(), it.value());
+    }
+  }
+
+  if(isCacheable(innerResponse, result.body))
+  {
+    if(result.body.size() >= compressMinSize && !result.headers.contains("Content-Encoding"))
+    {
+      QByteArray compressed = atools::zip::gzipCompress(result.body);
+      if(!compressed.isEmpty() && compressed.size() < result.body.size())
+      {
+        result.gzipBody = compressed;
+      }
+    }
+
+    mutex.lock();
+    // Do not store responses created from outdated data
+    if(startGeneration == generation)
+    {
+      cache.insert(key, new CacheEntry(result), result.body.size() + result.gzipBody.size() + key.size());
+    }
+    mutex.unlock();
+    sendEntry(result, acceptGzip, response);
+  }
+  else
+  {
+    // Pass through including cookies
+    for(const HttpCookie& cookie : std::as_const(innerResponse.getCookies()))
+    {
+      response.setCookie(cookie);
+    }
+    sendEntry(result, false, response);
+  }
+}
+
+bool HttpResponseCache::isCacheable(HttpResponse& innerResponse, const QByteArray& body) const
+{
+  QByteArray cacheControl = innerResponse.getHeaders().value("Cache-Control").toLower();
+  return innerResponse.getStatusCode() == 200 &&
+         innerResponse.getCookies().isEmpty() &&
+         !cacheControl.contains("no-store") && !cacheControl.contains("private") &&
+         body.size() <= maxCachedResponseSize;
+}
+
+void HttpResponseCache::sendEntry(const CacheEntry& entry, bool acceptGzip, HttpResponse& response)
+{
+  response.setStatus(entry.statusCode, entry.statusText);
+  for(auto it = entry.headers.constBegin(); it != entry.headers.constEnd(); ++it)
+  {
+    response.setHeader(it.key(), it.value());
+  }
+
+  if(!entry.gzipBody.isEmpty())
+  {
+    response.setHeader("Vary", "Accept-Encoding");
+    if(acceptGzip)
+    {
+      response.setHeader("Content-Encoding", "gzip");
+      response.write(entry.gzipBody, true);
+      return;
+    }
+  }
+  response.write(entry.body, true);
+}
+
+QByteArray HttpResponseCache::extractBody(const QByteArray& rawResponse, bool chunked)
+{
+  qsizetype pos = rawResponse.indexOf("\r\n\r\n");
+  if(pos < 0)
+  {
+    return QByteArray();
+  }
+  pos += 4;
+
+  if(!chunked)
+  {
+    return rawResponse.mid(pos);
+  }
+
+  // Decode chunks as written by HttpResponse
+  QByteArray body;
+  while(pos < rawResponse.size())
+  {
+    qsizetype lineEnd = rawResponse.indexOf("\r\n", pos);
+    if(lineEnd < 0)
+    {
+      break;
+    }
+
+    bool ok;
+    qsizetype size = rawResponse.mid(pos, lineEnd - pos).toLongLong(&ok, 16);
+    if(!ok || size == 0)
+    {
+      break;
+    }
+
+    body.append(rawResponse.mid(lineEnd + 2, size));
+    pos = lineEnd + 2 + size + 2;
+  }
+  return body;
+}
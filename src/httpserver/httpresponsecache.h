@@ -0,0 +1,109 @@
+/**
+ *  @file
+ *  Caching wrapper for request handlers.
+ */
+
+#ifndef HTTPRESPONSECACHE_H
+#define HTTPRESPONSECACHE_H
+
+#include <QCache>
+#include <QMutex>
+#include "httpglobal.h"
+#include "httprequest.h"
+#include "httpresponse.h"
+#include "httprequesthandler.h"
+#include "httpservermetrics.h"
+
+namespace stefanfrings {
+
+/**
+ *  Request handler which caches the responses of another handler in memory. Used for
+ *  endpoints which render the same pages for many clients like airport or route information.
+ *  <p>
+ *  Responses are cached by path including query. All cached responses are dropped when
+ *  the data generation is incremented by incrementGeneration() which has to be called
+ *  whenever the underlying data like database or simulator state changes.
+ *  <p>
+ *  Only GET requests with status 200 responses are cached. Responses which set cookies,
+ *  have a "Cache-Control: no-store" or "private" header or exceed maxCachedResponseSize
+ *  are passed through. Cached bodies are also stored gzip compressed and sent compressed
+ *  to clients accepting it.
+ *  <p>
+ *  The following settings are used:
+ *  <code><pre>
+ *  cacheSize=4000000
+ *  maxCachedResponseSize=262144
+ *  cacheTime=0
+ *  compressMinSize=1024
+ *  </pre></code>
+ *  The cache is limited by the size of all plain and compressed bodies in bytes and drops least
+ *  recently used responses first. Responses are cached until the generation changes when cacheTime=0.
+ *  <p>
+ *  The wrapped handler writes into a buffer so it cannot stream responses.
+ */
+class DECLSPEC HttpResponseCache :
+  public HttpRequestHandler
+{
+  Q_OBJECT
+  Q_DISABLE_COPY(HttpResponseCache)
+
+public:
+  /**
+   *  Constructor.
+   *  @param settings Configuration settings
+   *  @param requestHandler Handler which creates the responses. Not owned by this object.
+   *  @param parent Parent object
+   */
+  HttpResponseCache(const QHash<QString, QVariant>& settings, HttpRequestHandler *requestHandler,
+                    QObject *parent = nullptr);
+  virtual ~HttpResponseCache() override;
+
+  /** Send cached response or call the wrapped handler */
+  void service(HttpRequest& request, HttpResponse& response) override;
+
+  /** Drop all cached responses. Thread safe. */
+  void incrementGeneration();
+
+  /** Current data generation */
+  quint64 getGeneration() const;
+
+private:
+  struct CacheEntry
+  {
+    int statusCode;
+    QByteArray statusText;
+    QMap<QByteArray, QByteArray> headers;
+    QByteArray body, gzipBody;
+    qint64 created;
+  };
+
+  /** Send the entry using the compressed body if accepted */
+  static void sendEntry(const CacheEntry& entry, bool acceptGzip, HttpResponse& response);
+
+  /** Get the body from the raw response written by HttpResponse. Decodes chunked mode. */
+  static QByteArray extractBody(const QByteArray& rawResponse, bool chunked);
+
+  /** True if the response of the wrapped handler can be cached */
+  bool isCacheable(HttpResponse& innerResponse, const QByteArray& body) const;
+
+  HttpRequestHandler *requestHandler;
+
+  int cacheTimeout, compressMinSize;
+  qint64 maxCachedResponseSize;
+
+  /** Incremented on data changes */
+  quint64 generation = 0;
+
+  /** Cache storage by path */
+  QCache<QByteArray, CacheEntry> cache;
+
+  /** Used to synchronize cache and generation access for threads */
+  mutable QMutex mutex;
+
+  /** Hit and miss counters shared by all instances */
+  HttpServerMetrics::CacheCounters *cacheCounters;
+};
+
+} // end of namespace
+
+#endif // HTTPRESPONSECACHE_H
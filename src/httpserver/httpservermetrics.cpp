@@ -0,0 +1,201 @@
+/**
+ *  @file
+ *  Load counters of the HTTP server.
+ */
+
+#include "httpservermetrics.h"
+#include <QJsonArray>
+#include <algorithm>
+
+using namespace stefanfrings;
+
+const qint64 HttpServerMetrics::BUCKET_LIMITS_MS[NUM_BUCKETS] = {1, 2, 5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000};
+
+HttpServerMetrics::HttpServerMetrics()
+{
+  timer.start();
+}
+
+HttpServerMetrics::~HttpServerMetrics()
+{
+  qDeleteAll(caches);
+}
+
+HttpServerMetrics& HttpServerMetrics::instance()
+{
+  static HttpServerMetrics metrics;
+  return metrics;
+}
+
+HttpServerMetrics::CacheCounters *HttpServerMetrics::getCacheCounters(const QString& name)
+{
+  QMutexLocker locker(&mutex);
+  CacheCounters *& counters = caches[name];
+  if(counters == nullptr)
+  {
+    counters = new CacheCounters;
+  }
+  return counters;
+}
+
+void HttpServerMetrics::countConnection(bool accepted)
+{
+  (accepted ? connectionsAccepted : connectionsRejected).fetchAndAddRelaxed(1);
+}
+
+void HttpServerMetrics::addEventConnections(int num)
+{
+  eventConnections.fetchAndAddRelaxed(num);
+}
+
+void HttpServerMetrics::addHandlers(int num)
+{
+  handlers.fetchAndAddRelaxed(num);
+}
+
+void HttpServerMetrics::addBusyHandlers(int num)
+{
+  busyHandlers.fetchAndAddRelaxed(num);
+}
+
+void HttpServerMetrics::addQueuedRequests(int num)
+{
+  queuedRequests.fetchAndAddRelaxed(num);
+}
+
+void HttpServerMetrics::addActiveRequests(int num)
+{
+  activeRequests.fetchAndAddRelaxed(num);
+}
+
+void HttpServerMetrics::addBytesIn(qint64 bytes)
+{
+  bytesIn.fetchAndAddRelaxed(bytes);
+}
+
+void HttpServerMetrics::recordRequest(const QByteArray& path, qint64 latencyUs, qint64 bytes)
+{
+  requests.fetchAndAddRelaxed(1);
+  bytesOut.fetchAndAddRelaxed(bytes);
+
+  int bucket = 0;
+  while(bucket < NUM_BUCKETS && latencyUs > BUCKET_LIMITS_MS[bucket] * 1000)
+  {
+    bucket++;
+  }
+
+  QMutexLocker locker(&mutex);
+  auto it = histograms.find(path);
+  if(it == histograms.end())
+  {
+    // Limit memory usage if clients request many different paths
+    QByteArray key = histograms.size() < maxPaths ? path : QByteArray("*");
+    it = histograms.find(key);
+    if(it == histograms.end())
+    {
+      it = histograms.insert(key, Histogram());
+    }
+  }
+
+  Histogram& histogram = it.value();
+  histogram.count++;
+  histogram.totalUs += latencyUs;
+  histogram.maxUs = std::max(histogram.maxUs, latencyUs);
+  histogram.bytesOut += bytes;
+  histogram.buckets[bucket]++;
+}
+
+void HttpServerMetrics::setMaxPaths(int value)
+{
+  QMutexLocker locker(&mutex);
+  maxPaths = value;
+}
+
+void HttpServerMetrics::reset()
+{
+  connectionsAccepted.storeRelaxed(0);
+  connectionsRejected.storeRelaxed(0);
+  requests.storeRelaxed(0);
+  bytesIn.storeRelaxed(0);
+  bytesOut.storeRelaxed(0);
+
+  QMutexLocker locker(&mutex);
+  histograms.clear();
+  for(CacheCounters *counters : std::as_const(caches))
+  {
+    counters->hits.storeRelaxed(0);
+    counters->misses.storeRelaxed(0);
+  }
+  timer.restart();
+}
+
+QJsonObject HttpServerMetrics::toJson() const
+{
+  qint64 numHandlers = handlers.loadRelaxed(), numBusy = busyHandlers.loadRelaxed();
+
+  QJsonObject connections;
+  connections.insert("accepted", connectionsAccepted.loadRelaxed());
+  connections.insert("rejected", connectionsRejected.loadRelaxed());
+  connections.insert("open", numBusy + eventConnections.loadRelaxed());
+
+  QJsonObject handlerPool;
+  handlerPool.insert("total", numHandlers);
+  handlerPool.insert("busy", numBusy);
+  handlerPool.insert("idle", std::max(numHandlers - numBusy, qint64(0)));
+
+  QJsonObject requestCounts;
+  requestCounts.insert("total", requests.loadRelaxed());
+  requestCounts.insert("active", activeRequests.loadRelaxed());
+  requestCounts.insert("queued", queuedRequests.loadRelaxed());
+  requestCounts.insert("bytesIn", bytesIn.loadRelaxed());
+  requestCounts.insert("bytesOut", bytesOut.loadRelaxed());
+
+  QJsonArray limits;
+  for(qint64 limit : BUCKET_LIMITS_MS)
+  {
+    limits.append(limit);
+  }
+
+  QJsonObject root;
+  root.insert("connections", connections);
+  root.insert("handlers", handlerPool);
+  root.insert("requests", requestCounts);
+  root.insert("bucketLimitsMs", limits);
+
+  QMutexLocker locker(&mutex);
+  root.insert("uptimeMs", timer.elapsed());
+
+  QJsonObject paths;
+  for(auto it = histograms.constBegin(); it != histograms.constEnd(); ++it)
+  {
+    const Histogram& histogram = it.value();
+    QJsonArray buckets;
+    for(qint64 count : histogram.buckets)
+    {
+      buckets.append(count);
+    }
+
+    QJsonObject path;
+    path.insert("count", histogram.count);
+    path.insert("avgMs", histogram.count > 0 ? histogram.totalUs / 1000. / histogram.count : 0.);
+    path.insert("maxMs", histogram.maxUs / 1000.);
+    path.insert("bytesOut", histogram.bytesOut);
+    path.insert("buckets", buckets);
+    paths.insert(QString::fromUtf8(it.key()), path);
+  }
+  root.insert("paths", paths);
+
+  QJsonObject cacheCounts;
+  for(auto it = caches.constBegin(); it != caches.constEnd(); ++it)
+  {
+    qint64 hits = it.value()->hits.loadRelaxed(), misses = it.value()->misses.loadRelaxed();
+    QJsonObject cache;
+    cache.insert("hits", hits);
+    cache.insert("misses", misses);
+    cache.insert("hitRate", hits + misses > 0 ? static_cast<double>(hits) / (hits + misses) : 0.);
+    cacheCounts.insert(it.key(), cache);
+  }
+  root.insert("caches", cacheCounts);
+
+  return root;
+}
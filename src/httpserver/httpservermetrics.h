@@ -0,0 +1,130 @@
+/**
+ *  @file
+ *  Load counters of the HTTP server.
+ */
+
+#ifndef HTTPSERVERMETRICS_H
+#define HTTPSERVERMETRICS_H
+
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
+#include <QMutex>
+#include "httpglobal.h"
+
+namespace stefanfrings {
+
+/**
+ *  Process wide load counters of all listeners, connection handlers and caches.
+ *  Use HttpMetricsController to publish them as JSON. The values help to size maxThreads,
+ *  workerThreads and the cache sizes from real load.
+ *  <p>
+ *  Counters are atomic and cheap. Request latencies are collected in a histogram
+ *  per decoded path without query. The number of paths is limited by setMaxPaths()
+ *  and further paths are summed up in the entry "*".
+ *  <p>
+ *  All methods are thread safe.
+ */
+class DECLSPEC HttpServerMetrics
+{
+  Q_DISABLE_COPY(HttpServerMetrics)
+
+public:
+  /** Hit and miss counters of a cache */
+  struct CacheCounters
+  {
+    QAtomicInteger<qint64> hits, misses;
+
+    void count(bool hit)
+    {
+      (hit ? hits : misses).fetchAndAddRelaxed(1);
+    }
+  };
+
+  /** Get the instance */
+  static HttpServerMetrics& instance();
+
+  /**
+   *  Get the counters of a cache. Caches of the same type share the counters.
+   *  @param name Cache name like "staticfile" or "template"
+   *  @return Counters which are valid until program end
+   */
+  CacheCounters *getCacheCounters(const QString& name);
+
+  /** Called by the listener for accepted and rejected connections */
+  void countConnection(bool accepted);
+
+  /** Called when a connection of the event loop engine is opened or closed */
+  void addEventConnections(int num);
+
+  /** Called when the size of the connection handler pool changes */
+  void addHandlers(int num);
+
+  /** Called when a connection handler is started or finished */
+  void addBusyHandlers(int num);
+
+  /** Called when a request is waiting for a free worker thread or was picked up */
+  void addQueuedRequests(int num);
+
+  /** Called when a request handler starts or finishes */
+  void addActiveRequests(int num);
+
+  /** Count bytes read from the clients */
+  void addBytesIn(qint64 bytes);
+
+  /**
+   *  Count a finished request.
+   *  @param path Decoded path without query
+   *  @param latencyUs Time for the request handler in microseconds
+   *  @param bytesOut Bytes of the response including headers
+   */
+  void recordRequest(const QByteArray& path, qint64 latencyUs, qint64 bytesOut);
+
+  /** Maximum number of paths having an own histogram. Default is 200. */
+  void setMaxPaths(int value);
+
+  /** Drop histograms and reset all counters which are not gauges */
+  void reset();
+
+  /** Get all values as JSON object */
+  QJsonObject toJson() const;
+
+private:
+  HttpServerMetrics();
+  ~HttpServerMetrics();
+
+  /** Upper bounds of the latency buckets in milliseconds. The last bucket is unlimited. */
+  static const int NUM_BUCKETS = 12;
+  static const qint64 BUCKET_LIMITS_MS[NUM_BUCKETS];
+
+  /** Latency histogram of a path */
+  struct Histogram
+  {
+    qint64 count = 0, totalUs = 0, maxUs = 0, bytesOut = 0;
+    qint64 buckets[NUM_BUCKETS + 1] = {};
+  };
+
+  /** Gauges */
+  QAtomicInteger<qint64> eventConnections, handlers, busyHandlers, queuedRequests, activeRequests;
+
+  /** Totals since start or reset */
+  QAtomicInteger<qint64> connectionsAccepted, connectionsRejected, requests, bytesIn, bytesOut;
+
+  /** Histograms by path */
+  QHash<QByteArray, Histogram> histograms;
+  int maxPaths = 200;
+
+  /** Cache counters by name */
+  QHash<QString, CacheCounters *> caches;
+
+  /** Running since start or reset */
+  QElapsedTimer timer;
+
+  /** Used to synchronize histogram and cache map access */
+  mutable QMutex mutex;
+};
+
+} // end of namespace
+
+#endif // HTTPSERVERMETRICS_H
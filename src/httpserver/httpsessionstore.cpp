@@ -7,16 +7,19 @@
 #include <QDateTime>
 #include <QUuid>
 
+#include <algorithm>
+
 using namespace stefanfrings;
 
 HttpSessionStore::HttpSessionStore(const QHash<QString, QVariant>& settings, QObject *parent)
   : QObject(parent)
 {
   this->settings = settings;
-  connect(&cleanupTimer, SIGNAL(timeout()), this, SLOT(sessionTimerEvent()));
-  cleanupTimer.start(60000);
   cookieName = settings.value("cookieName", "sessionid").toByteArray();
   expirationTime = settings.value("expirationTime", 3600000).toInt();
+  cleanupInterval = std::max(settings.value("cleanupInterval", 60000).toInt(), 1000);
+  connect(&cleanupTimer, SIGNAL(timeout()), this, SLOT(sessionTimerEvent()));
+  cleanupTimer.start(cleanupInterval);
   qDebug("HttpSessionStore: Sessions expire after %i milliseconds", expirationTime);
 }
 
@@ -25,10 +28,57 @@ HttpSessionStore::~HttpSessionStore()
   cleanupTimer.stop();
 }
 
+HttpSessionStore::Stripe& HttpSessionStore::stripe(const QByteArray& sessionId)
+{
+  return stripes[qHash(sessionId) % NUM_STRIPES];
+}
+
+bool HttpSessionStore::isExpired(const HttpSession& session, qint64 now) const
+{
+  return now - session.getLastAccess() > expirationTime;
+}
+
+void HttpSessionStore::scheduleExpiration(const QByteArray& sessionId, qint64 lastAccess)
+{
+  // Round up to the next slot to avoid checking too early
+  qint64 slot = (lastAccess + expirationTime) / cleanupInterval + 1;
+  slotMutex.lock();
+  expirationSlots[slot].append(sessionId);
+  slotMutex.unlock();
+}
+
+HttpSession HttpSessionStore::findSession(Stripe& stripe, const QByteArray& sessionId, bool& expired)
+{
+  expired = false;
+  auto it = stripe.sessions.constFind(sessionId);
+  if(it == stripe.sessions.constEnd())
+  {
+    return HttpSession();
+  }
+
+  // Remove expired session immediately - the timing wheel will find it gone
+  if(isExpired(it.value(), QDateTime::currentMSecsSinceEpoch()))
+  {
+    qDebug("HttpSessionStore: session %s expired", sessionId.data());
+    stripe.sessions.erase(it);
+    expired = true;
+    return HttpSession();
+  }
+  return it.value();
+}
+
+void HttpSessionStore::setSessionCookie(const HttpSession& session, HttpResponse& response) const
+{
+  QByteArray cookiePath = settings.value("cookiePath").toByteArray();
+  QByteArray cookieComment = settings.value("cookieComment").toByteArray();
+  QByteArray cookieDomain = settings.value("cookieDomain").toByteArray();
+  response.setCookie(HttpCookie(cookieName, session.getId(), expirationTime / 1000,
+                                cookiePath, cookieComment, cookieDomain, false, false, "Lax"));
+}
+
 QByteArray HttpSessionStore::getSessionId(HttpRequest& request, HttpResponse& response)
 {
   // The session ID in the response has priority because this one will be used in the next request.
-  mutex.lock();
   // Get the session ID from the response cookie
   QByteArray sessionId = response.getCookies().value(cookieName).getValue();
   if(sessionId.isEmpty())
@@ -39,92 +89,138 @@ QByteArray HttpSessionStore::getSessionId(HttpRequest& request, HttpResponse& re
   // Clear the session ID if there is no such session in the storage.
   if(!sessionId.isEmpty())
   {
-    if(!sessions.contains(sessionId))
+    Stripe& s = stripe(sessionId);
+    bool expired;
+    s.mutex.lock();
+    HttpSession session = findSession(s, sessionId, expired);
+    s.mutex.unlock();
+
+    if(expired)
+    {
+      emit sessionDeleted(sessionId);
+    }
+
+    if(session.isNull())
     {
       qDebug("HttpSessionStore: received invalid session cookie with ID %s", sessionId.data());
       sessionId.clear();
     }
   }
-  mutex.unlock();
   return sessionId;
 }
 
 HttpSession HttpSessionStore::getSession(HttpRequest& request, HttpResponse& response, bool allowCreate)
 {
   QByteArray sessionId = getSessionId(request, response);
-  mutex.lock();
   if(!sessionId.isEmpty())
   {
-    HttpSession session = sessions.value(sessionId);
+    Stripe& s = stripe(sessionId);
+    bool expired;
+    s.mutex.lock();
+    HttpSession session = findSession(s, sessionId, expired);
     if(!session.isNull())
     {
-      mutex.unlock();
-      // Refresh the session cookie
-      QByteArray cookieName = settings.value("cookieName", "sessionid").toByteArray();
-      QByteArray cookiePath = settings.value("cookiePath").toByteArray();
-      QByteArray cookieComment = settings.value("cookieComment").toByteArray();
-      QByteArray cookieDomain = settings.value("cookieDomain").toByteArray();
-      response.setCookie(HttpCookie(cookieName, session.getId(), expirationTime / 1000,
-                                    cookiePath, cookieComment, cookieDomain, false, false, "Lax"));
+      // Update while locked to avoid removal by the timer
       session.setLastAccess();
+    }
+    s.mutex.unlock();
+
+    if(expired)
+    {
+      emit sessionDeleted(sessionId);
+    }
+
+    if(!session.isNull())
+    {
+      // Refresh the session cookie
+      setSessionCookie(session, response);
       return session;
     }
   }
   // Need to create a new session
   if(allowCreate)
   {
-    QByteArray cookieName = settings.value("cookieName", "sessionid").toByteArray();
-    QByteArray cookiePath = settings.value("cookiePath").toByteArray();
-    QByteArray cookieComment = settings.value("cookieComment").toByteArray();
-    QByteArray cookieDomain = settings.value("cookieDomain").toByteArray();
     HttpSession session(true);
     qDebug("HttpSessionStore: create new session with ID %s", session.getId().data());
-    sessions.insert(session.getId(), session);
-    response.setCookie(HttpCookie(cookieName, session.getId(), expirationTime / 1000,
-                                  cookiePath, cookieComment, cookieDomain, false, false, "Lax"));
-    mutex.unlock();
+    Stripe& s = stripe(session.getId());
+    s.mutex.lock();
+    s.sessions.insert(session.getId(), session);
+    s.mutex.unlock();
+    scheduleExpiration(session.getId(), session.getLastAccess());
+    setSessionCookie(session, response);
     return session;
   }
   // Return a null session
-  mutex.unlock();
   return HttpSession();
 }
 
 HttpSession HttpSessionStore::getSession(const QByteArray id)
 {
-  mutex.lock();
-  HttpSession session = sessions.value(id);
-  mutex.unlock();
+  Stripe& s = stripe(id);
+  bool expired;
+  s.mutex.lock();
+  HttpSession session = findSession(s, id, expired);
   session.setLastAccess();
+  s.mutex.unlock();
+
+  if(expired)
+  {
+    emit sessionDeleted(id);
+  }
   return session;
 }
 
 void HttpSessionStore::sessionTimerEvent()
 {
-  mutex.lock();
   qint64 now = QDateTime::currentMSecsSinceEpoch();
-  QMap<QByteArray, HttpSession>::iterator i = sessions.begin();
-  while(i != sessions.end())
+  qint64 currentSlot = now / cleanupInterval;
+
+  // Take all due slots out of the timing wheel
+  QList<QByteArray> dueIds;
+  slotMutex.lock();
+  while(!expirationSlots.isEmpty() && expirationSlots.firstKey() <= currentSlot)
+  {
+    dueIds.append(expirationSlots.take(expirationSlots.firstKey()));
+  }
+  slotMutex.unlock();
+
+  for(const QByteArray& sessionId : std::as_const(dueIds))
   {
-    QMap<QByteArray, HttpSession>::iterator prev = i;
-    ++i;
-    HttpSession session = prev.value();
-    qint64 lastAccess = session.getLastAccess();
-    if(now - lastAccess > expirationTime)
+    Stripe& s = stripe(sessionId);
+    s.mutex.lock();
+    auto it = s.sessions.constFind(sessionId);
+    if(it == s.sessions.constEnd())
+    {
+      // Already removed
+      s.mutex.unlock();
+    }
+    else if(isExpired(it.value(), now))
+    {
+      qDebug("HttpSessionStore: session %s expired", sessionId.data());
+      s.sessions.erase(it);
+      s.mutex.unlock();
+      emit sessionDeleted(sessionId);
+    }
+    else
     {
-      qDebug("HttpSessionStore: session %s expired", session.getId().data());
-      emit sessionDeleted(session.getId());
-      sessions.erase(prev);
+      // Session was used in the meantime - check again when it would expire
+      qint64 lastAccess = it.value().getLastAccess();
+      s.mutex.unlock();
+      scheduleExpiration(sessionId, lastAccess);
     }
   }
-  mutex.unlock();
 }
 
 /** Delete a session */
 void HttpSessionStore::removeSession(HttpSession session)
 {
-  mutex.lock();
-  emit sessionDeleted(session.getId());
-  sessions.remove(session.getId());
-  mutex.unlock();
+  Stripe& s = stripe(session.getId());
+  s.mutex.lock();
+  bool removed = s.sessions.remove(session.getId()) > 0;
+  s.mutex.unlock();
+
+  if(removed)
+  {
+    emit sessionDeleted(session.getId());
+  }
 }
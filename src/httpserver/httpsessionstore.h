@@ -7,6 +7,7 @@
 #define HTTPSESSIONSTORE_H
 
 #include <QObject>
+#include <QHash>
 #include <QMap>
 #include <QTimer>
 #include <QMutex>
@@ -29,7 +30,15 @@ namespace stefanfrings {
  *  cookiePath=/
  *  cookieComment=Session ID
  *  ;cookieDomain=stefanfrings.de
+ *  cleanupInterval=60000
  *  </pre></code>
+ *  <p>
+ *  Sessions are distributed over several maps with separate locks by their ID, so requests
+ *  of different sessions do not block each other.
+ *  <p>
+ *  Expired sessions are removed when they are accessed. Other sessions are removed by a
+ *  timing wheel which is checked every cleanupInterval milliseconds. Each check looks only
+ *  at sessions scheduled to expire up to now instead of scanning all sessions.
  */
 
 class DECLSPEC HttpSessionStore :
@@ -89,11 +98,47 @@ public:
   /** Delete a session */
   void removeSession(const HttpSession session);
 
-protected:
+private:
+  /** Number of session maps with own lock */
+  static const int NUM_STRIPES = 16;
+
+  /** Part of the session storage with own lock */
+  struct Stripe
+  {
+    QHash<QByteArray, HttpSession> sessions;
+    QMutex mutex;
+  };
+
   /** Storage for the sessions */
-  QMap<QByteArray, HttpSession> sessions;
+  Stripe stripes[NUM_STRIPES];
+
+  /** Timing wheel. Session IDs by slot number where the slot is the expiration time divided by cleanupInterval. */
+  QMap<qint64, QList<QByteArray> > expirationSlots;
+
+  /** Used to synchronize access to expirationSlots */
+  QMutex slotMutex;
+
+  /** Interval of the cleanup timer in ms */
+  int cleanupInterval;
+
+  /** Get stripe for session ID */
+  Stripe& stripe(const QByteArray& sessionId);
+
+  /** True if the session was not used for the expiration time */
+  bool isExpired(const HttpSession& session, qint64 now) const;
+
+  /** Add session ID to the timing wheel slot for the expiration time */
+  void scheduleExpiration(const QByteArray& sessionId, qint64 lastAccess);
+
+  /**
+   *  Find session and remove it if expired. Caller has to lock the stripe.
+   *  @param expired Set to true if the session was removed
+   */
+  HttpSession findSession(Stripe& stripe, const QByteArray& sessionId, bool& expired);
+
+  /** Set the session cookie in the response */
+  void setSessionCookie(const HttpSession& session, HttpResponse& response) const;
 
-private:
   /** Configuration settings */
   QHash<QString, QVariant> settings;
 
@@ -106,11 +151,8 @@ private:
   /** Time when sessions expire (in ms)*/
   int expirationTime;
 
-  /** Used to synchronize threads */
-  QMutex mutex;
-
 private slots:
-  /** Called every minute to cleanup expired sessions. */
+  /** Called every cleanupInterval to remove expired sessions from the timing wheel. */
   void sessionTimerEvent();
 
 signals:
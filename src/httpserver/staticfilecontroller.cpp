@@ -10,6 +10,8 @@
 #include <QThread>
 #include <QCoreApplication>
 
+#include <algorithm>
+
 using namespace stefanfrings;
 
 StaticFileController::StaticFileController(const QHash<QString, QVariant>& settings, QObject *parent)
@@ -30,11 +32,14 @@ StaticFileController::StaticFileController(const QHash<QString, QVariant>& setti
   }
 
   qDebug("StaticFileController: docroot=%s, encoding=%s, maxAge=%i", qPrintable(docroot), qPrintable(encoding), maxAge);
-  maxCachedFileSize = settings.value("maxCachedFileSize", "65536").toInt();
-  cache.setMaxCost(settings.value("cacheSize", "1000000").toInt());
+  maxCachedFileSize = settings.value("maxCachedFileSize", "65536").toLongLong();
+  precompressed = settings.value("precompressed", true).toBool();
+  // Cost is the size of the cached documents in bytes
+  cache.setMaxCost(static_cast<qsizetype>(settings.value("cacheSize", "1000000").toLongLong()));
+  cacheCounters = HttpServerMetrics::instance().getCacheCounters("staticfile");
   cacheTimeout = settings.value("cacheTime", "60000").toInt();
-  long int cacheMaxCost = (long int)cache.maxCost();
-  qDebug("StaticFileController: cache timeout=%i, size=%li", cacheTimeout, cacheMaxCost);
+  long long cacheMaxCost = static_cast<long long>(cache.maxCost());
+  qDebug("StaticFileController: cache timeout=%i, size=%lli, precompressed=%d", cacheTimeout, cacheMaxCost, precompressed);
 }
 
 StaticFileController::~StaticFileController()
@@ -45,25 +50,42 @@ StaticFileController::~StaticFileController()
 void StaticFileController::service(HttpRequest& request, HttpResponse& response)
 {
   QByteArray path = request.getPath();
+  QByteArray accepted = acceptedEncoding(request);
+
+  // Compressed and plain variants are cached separately
+  QString cacheKey = accepted.isEmpty() ? QString(path) : QString(path + '|' + accepted);
+
   // Check if we have the file in cache
   qint64 now = QDateTime::currentMSecsSinceEpoch();
   mutex.lock();
-  CacheEntry *entry = cache.object(path);
+  CacheEntry *entry = cache.object(cacheKey);
   if(entry && (cacheTimeout == 0 || entry->created > now - cacheTimeout))
   {
-    QByteArray document = entry->document; // copy the cached document, because other threads may destroy the cached entry immediately after mutex unlock.
+    // Copy the cached document, because other threads may destroy the cached entry immediately after mutex unlock.
+    QByteArray document = entry->document;
     QByteArray filename = entry->filename;
+    QByteArray etag = entry->etag;
+    QByteArray contentEncoding = entry->contentEncoding;
     mutex.unlock();
     qDebug("StaticFileController: Cache hit for %s", path.data());
-    setContentType(filename, response);
-    response.setHeader("Cache-Control", "max-age=" + QByteArray::number(maxAge / 1000));
-    response.write(document, true);
+    cacheCounters->count(true);
+
+    if(isNotModified(request, etag))
+    {
+      sendNotModified(etag, response);
+    }
+    else
+    {
+      setHeaders(filename, etag, contentEncoding, response);
+      response.write(document, true);
+    }
   }
   else
   {
     mutex.unlock();
     // The file is not in cache.
     qDebug("StaticFileController: Cache miss for %s", path.data());
+    cacheCounters->count(false);
     // Forbid access to files outside the docroot directory
     if(path.contains("/.."))
     {
@@ -77,36 +99,39 @@ void StaticFileController::service(HttpRequest& request, HttpResponse& response)
     {
       path += "/index.html";
     }
-    // Try to open the file
-    QFile file(docroot + path);
+    // Try to open the file or its compressed variant
+    QByteArray contentEncoding;
+    QFile file(findFile(path, accepted, contentEncoding));
     qDebug("StaticFileController: Open file %s", qPrintable(file.fileName()));
     if(file.open(QIODevice::ReadOnly))
     {
-      setContentType(path, response);
-      response.setHeader("Cache-Control", "max-age=" + QByteArray::number(maxAge / 1000));
-      response.setHeader("Content-Length", QByteArray::number(file.size()));
-      if(file.size() <= maxCachedFileSize)
+      QByteArray etag = entityTag(QFileInfo(file), contentEncoding);
+      if(isNotModified(request, etag))
       {
-        // Return the file content and store it also in the cache
-        entry = new CacheEntry();
-        while(!file.atEnd() && !file.error())
-        {
-          QByteArray buffer = file.read(65536);
-          response.write(buffer);
-          entry->document.append(buffer);
-        }
-        entry->created = now;
-        entry->filename = path;
-        mutex.lock();
-        cache.insert(request.getPath(), entry, entry->document.size());
-        mutex.unlock();
+        sendNotModified(etag, response);
       }
       else
       {
-        // Return the file content, do not store in cache
-        while(!file.atEnd() && !file.error())
+        setHeaders(path, etag, contentEncoding, response);
+        response.setHeader("Content-Length", QByteArray::number(file.size()));
+        if(file.size() <= maxCachedFileSize)
         {
-          response.write(file.read(65536));
+          // Return the file content and store it also in the cache
+          entry = new CacheEntry();
+          entry->document = file.readAll();
+          entry->created = now;
+          entry->filename = path;
+          entry->etag = etag;
+          entry->contentEncoding = contentEncoding;
+          response.write(entry->document);
+          mutex.lock();
+          cache.insert(cacheKey, entry, entry->document.size() + entry->filename.size() + entry->etag.size());
+          mutex.unlock();
+        }
+        else
+        {
+          // Return the file content, do not store in cache
+          sendFile(file, response);
         }
       }
       file.close();
@@ -128,6 +153,157 @@ void StaticFileController::service(HttpRequest& request, HttpResponse& response)
   }
 }
 
+QByteArray StaticFileController::acceptedEncoding(const HttpRequest& request) const
+{
+  if(!precompressed)
+  {
+    return QByteArray();
+  }
+
+  bool brotli = false, gzip = false;
+  for(const QByteArray& header : request.getHeaders("Accept-Encoding"))
+  {
+    for(const QByteArray& value : header.split(','))
+    {
+      // Ignore quality values except explicit refusal "q=0"
+      QList<QByteArray> parts = value.split(';');
+      QByteArray name = parts.constFirst().trimmed().toLower();
+      bool refused = parts.size() > 1 && parts.at(1).trimmed().replace(" ", "") == "q=0";
+      if(!refused)
+      {
+        if(name == "br")
+        {
+          brotli = true;
+        }
+        else if(name == "gzip")
+        {
+          gzip = true;
+        }
+      }
+    }
+  }
+
+  if(brotli && gzip)
+  {
+    // Both accepted - the file decides which one is served
+    return "br,gzip";
+  }
+  else if(brotli)
+  {
+    return "br";
+  }
+  else if(gzip)
+  {
+    return "gzip";
+  }
+  return QByteArray();
+}
+
+QString StaticFileController::findFile(const QByteArray& path, const QByteArray& accepted, QByteArray& contentEncoding) const
+{
+  contentEncoding.clear();
+  QString filename = docroot + path;
+
+  if(accepted.contains("br") && QFileInfo::exists(filename + ".br"))
+  {
+    contentEncoding = "br";
+    return filename + ".br";
+  }
+  else if(accepted.contains("gzip") && QFileInfo::exists(filename + ".gz"))
+  {
+    contentEncoding = "gzip";
+    return filename + ".gz";
+  }
+  return filename;
+}
+
+QByteArray StaticFileController::entityTag(const QFileInfo& fileInfo, const QByteArray& contentEncoding)
+{
+  QByteArray etag = '"' + QByteArray::number(fileInfo.size(), 16) + '-' +
+                    QByteArray::number(fileInfo.lastModified().toMSecsSinceEpoch(), 16);
+  if(!contentEncoding.isEmpty())
+  {
+    etag += '-' + contentEncoding;
+  }
+  return etag + '"';
+}
+
+bool StaticFileController::isNotModified(const HttpRequest& request, const QByteArray& etag)
+{
+  QByteArray ifNoneMatch = request.getHeader("If-None-Match");
+  if(ifNoneMatch.isEmpty())
+  {
+    return false;
+  }
+
+  for(QByteArray tag : ifNoneMatch.split(','))
+  {
+    tag = tag.trimmed();
+
+    // Weak comparison
+    if(tag.startsWith("W/"))
+    {
+      tag = tag.mid(2);
+    }
+
+    if(tag == "*" || tag == etag)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+void StaticFileController::setHeaders(const QString filename, const QByteArray& etag, const QByteArray& contentEncoding,
+                                      HttpResponse& response) const
+{
+  setContentType(filename, response);
+  response.setHeader("Cache-Control", "max-age=" + QByteArray::number(maxAge / 1000));
+  response.setHeader("ETag", etag);
+
+  if(precompressed)
+  {
+    // Tell proxies that the content depends on the accepted encoding
+    response.setHeader("Vary", "Accept-Encoding");
+  }
+
+  if(!contentEncoding.isEmpty())
+  {
+    response.setHeader("Content-Encoding", contentEncoding);
+  }
+}
+
+void StaticFileController::sendNotModified(const QByteArray& etag, HttpResponse& response)
+{
+  response.setStatus(304, "not modified");
+  response.setHeader("ETag", etag);
+  response.write(QByteArray(), true);
+}
+
+void StaticFileController::sendFile(QFile& file, HttpResponse& response)
+{
+  // Map large files into memory to avoid copying into read buffers - fails for resources
+  qint64 size = file.size();
+  uchar *data = size > 0 ? file.map(0, size) : nullptr;
+  if(data != nullptr)
+  {
+    const qint64 CHUNK_SIZE = 1024 * 1024;
+    for(qint64 offset = 0; offset < size; offset += CHUNK_SIZE)
+    {
+      qint64 length = std::min(CHUNK_SIZE, size - offset);
+      response.write(QByteArray::fromRawData(reinterpret_cast<const char *>(data + offset), static_cast<qsizetype>(length)));
+    }
+    file.unmap(data);
+  }
+  else
+  {
+    while(!file.atEnd() && !file.error())
+    {
+      response.write(file.read(65536));
+    }
+  }
+}
+
 void StaticFileController::setContentType(const QString fileName, HttpResponse& response) const
 {
   if(fileName.endsWith(".png"))
@@ -7,11 +7,13 @@
 #define STATICFILECONTROLLER_H
 
 #include <QCache>
+#include <QFileInfo>
 #include <QMutex>
 #include "httpglobal.h"
 #include "httprequest.h"
 #include "httpresponse.h"
 #include "httprequesthandler.h"
+#include "httpservermetrics.h"
 
 namespace stefanfrings {
 
@@ -27,6 +29,7 @@ namespace stefanfrings {
  *  cacheTime=60000
  *  cacheSize=1000000
  *  maxCachedFileSize=65536
+ *  precompressed=true
  *  </pre></code>
  *  The path is relative to the directory of the config file. In case of windows, if the
  *  settings are in the registry, the path is relative to the current working directory.
@@ -36,6 +39,16 @@ namespace stefanfrings {
  *  The cache improves performance of small files when loaded from a network
  *  drive. Large files are not cached. Files are cached as long as possible,
  *  when cacheTime=0. The maxAge value (in msec!) controls the remote browsers cache.
+ *  The cache is limited by the total size of all cached files in bytes and drops the least
+ *  recently used files first.
+ *  <p>
+ *  If precompressed is true and the browser accepts it, a compressed variant of the file
+ *  like "script.js.br" or "script.js.gz" is sent instead of "script.js" if it exists.
+ *  Brotli is preferred over gzip.
+ *  <p>
+ *  Each response has an ETag built from size and modification time of the file. Requests
+ *  with a matching If-None-Match header get a 304 response without content.
+ *  Large files which are not cached are memory mapped and sent without copying into a buffer.
  *  <p>
  *  Do not instantiate this class in each request, because this would make the file cache
  *  useless. Better create one instance during start-up and call it when the application
@@ -80,13 +93,18 @@ private:
     QByteArray document;
     qint64 created;
     QByteArray filename;
+    QByteArray etag;
+    QByteArray contentEncoding;
   };
 
   /** Timeout for each cached file */
   int cacheTimeout;
 
   /** Maximum size of files in cache, larger files are not cached */
-  int maxCachedFileSize;
+  qint64 maxCachedFileSize;
+
+  /** Look for pre-compressed variants of files */
+  bool precompressed;
 
   /** Cache storage */
   QCache<QString, CacheEntry> cache;
@@ -94,9 +112,37 @@ private:
   /** Used to synchronize cache access for threads */
   QMutex mutex;
 
+  /** Hit and miss counters shared by all instances */
+  HttpServerMetrics::CacheCounters *cacheCounters;
+
   /** Set a content-type header in the response depending on the ending of the filename */
   void setContentType(const QString file, HttpResponse& response) const;
 
+  /** Best encoding accepted by the browser which can be served. "br", "gzip" or empty for none. */
+  QByteArray acceptedEncoding(const HttpRequest& request) const;
+
+  /**
+   *  Get the file to send for the path. Returns a compressed variant if accepted and available.
+   *  @param contentEncoding Set to the encoding of the returned file or empty if not compressed
+   */
+  QString findFile(const QByteArray& path, const QByteArray& accepted, QByteArray& contentEncoding) const;
+
+  /** Entity tag for the file from size and modification time */
+  static QByteArray entityTag(const QFileInfo& fileInfo, const QByteArray& contentEncoding);
+
+  /** True if the browser already has the file with the given entity tag */
+  static bool isNotModified(const HttpRequest& request, const QByteArray& etag);
+
+  /** Set content type, cache, entity tag and encoding headers */
+  void setHeaders(const QString filename, const QByteArray& etag, const QByteArray& contentEncoding,
+                  HttpResponse& response) const;
+
+  /** Send a 304 not modified response */
+  static void sendNotModified(const QByteArray& etag, HttpResponse& response);
+
+  /** Send file content using memory mapping if possible */
+  static void sendFile(QFile& file, HttpResponse& response);
+
 };
 
 } // end of namespace
@@ -21,8 +21,11 @@
 #include <QDebug>
 #include <QUuid>
 #include <QFileInfo>
+#include <QtEndian>
 #include "exception.h"
 
+#include <cstring>
+
 namespace atools {
 namespace io {
 
@@ -30,45 +33,104 @@ namespace io {
  * Big endian 1A2B3C4D = 1A 2B 3C 4D in mem
  * Little endian 1A2B3C4D =  4D 3C 2B 1A in mem
  */
-BinaryStream::BinaryStream(QFile *binaryFile, QDataStream::ByteOrder order)
-  : is(binaryFile), filename(binaryFile->fileName()), filesize(binaryFile->size())
+BinaryStream::BinaryStream(QFile *binaryFile, QDataStream::ByteOrder order, bool memoryMap)
+  : filename(binaryFile->fileName()), filesize(binaryFile->size())
 {
-  is.setByteOrder(order);
-  checkStream("constructor");
+  if(memoryMap && filesize > 0)
+  {
+    data = reinterpret_cast<const char *>(binaryFile->map(0, filesize));
+    if(data != nullptr)
+    {
+      mappedFile = binaryFile;
+      bigEndian = order == QDataStream::BigEndian;
+    }
+    else
+      qWarning() << Q_FUNC_INFO << "Cannot map" << filename << binaryFile->errorString();
+  }
+
+  if(data == nullptr)
+  {
+    // Fall back to stream
+    is.setDevice(binaryFile);
+    is.setByteOrder(order);
+    checkStream("constructor");
+  }
 }
 
-quint32 BinaryStream::readUInt()
+BinaryStream::~BinaryStream()
+{
+  if(mappedFile != nullptr && mappedFile->isOpen())
+    mappedFile->unmap(reinterpret_cast<uchar *>(const_cast<char *>(data)));
+}
+
+template<typename TYPE>
+TYPE BinaryStream::readValue(const char *what)
 {
-  quint32 retval;
-  is >> retval;
+  if(data != nullptr)
+  {
+    checkMapped(static_cast<qint64>(sizeof(TYPE)), what);
+    TYPE retval = bigEndian ? qFromBigEndian<TYPE>(data + position) : qFromLittleEndian<TYPE>(data + position);
+    position += static_cast<qint64>(sizeof(TYPE));
+    return retval;
+  }
+  else
+  {
+    TYPE retval;
+    is >> retval;
 
-  checkStream("readInt");
+    checkStream(what);
 
-  return retval;
+    return retval;
+  }
 }
 
-quint64 BinaryStream::readULong()
+quint32 BinaryStream::readUInt()
 {
-  quint64 retval;
-  is >> retval;
-
-  checkStream("readLong");
+  return readValue<quint32>("readInt");
+}
 
-  return retval;
+quint64 BinaryStream::readULong()
+{
+  return readValue<quint64>("readLong");
 }
 
 int BinaryStream::readBytes(char bytes[], int size)
 {
-  int numRead = is.readRawData(bytes, size);
-  checkStream("readBytes");
-  return numRead;
+  if(data != nullptr)
+  {
+    checkMapped(size, "readBytes");
+    std::memcpy(bytes, data + position, static_cast<size_t>(size));
+    position += size;
+    return size;
+  }
+  else
+  {
+    int numRead = is.readRawData(bytes, size);
+    checkStream("readBytes");
+    return numRead;
+  }
 }
 
 int BinaryStream::readUBytes(unsigned char bytes[], int size)
 {
-  int numRead = is.readRawData(reinterpret_cast<char *>(bytes), size);
-  checkStream("readBytes");
-  return numRead;
+  return readBytes(reinterpret_cast<char *>(bytes), size);
+}
+
+QByteArrayView BinaryStream::readBytesView(int size)
+{
+  if(data != nullptr)
+  {
+    checkMapped(size, "readBytes");
+    QByteArrayView view(data + position, size);
+    position += size;
+    return view;
+  }
+  else
+  {
+    buffer.resize(size);
+    int numRead = readBytes(buffer.data(), size);
+    return QByteArrayView(buffer.constData(), numRead);
+  }
 }
 
 QUuid BinaryStream::readUuid()
@@ -85,21 +147,34 @@ QUuid BinaryStream::readUuid()
 
 qint64 BinaryStream::tellg() const
 {
+  if(data != nullptr)
+    return position;
+
   checkStream("tellg");
   return is.device()->pos();
 }
 
 void BinaryStream::skip(qint64 bytes)
 {
-  checkStream("skip");
-  if(bytes != 0)
-    is.device()->seek(tellg() + bytes);
+  if(data != nullptr)
+    position += bytes;
+  else
+  {
+    checkStream("skip");
+    if(bytes != 0)
+      is.device()->seek(tellg() + bytes);
+  }
 }
 
 void BinaryStream::seekg(qint64 pos)
 {
-  checkStream("seekg");
-  is.device()->seek(pos);
+  if(data != nullptr)
+    position = pos;
+  else
+  {
+    checkStream("seekg");
+    is.device()->seek(pos);
+  }
 }
 
 QString BinaryStream::getFilename() const
@@ -118,69 +193,37 @@ float BinaryStream::readFloat()
 
   u.intValue = readUInt();
 
-  checkStream("readFloat");
-
   return u.floatValue;
 }
 
 quint16 BinaryStream::readUShort()
 {
-  quint16 retval;
-  is >> retval;
-
-  checkStream("readShort");
-
-  return retval;
+  return readValue<quint16>("readShort");
 }
 
 quint8 BinaryStream::readUByte()
 {
-  quint8 retval;
-  is >> retval;
-
-  checkStream("readByte");
-
-  return retval;
+  return readValue<quint8>("readByte");
 }
 
 qint16 BinaryStream::readShort()
 {
-  qint16 retval;
-  is >> retval;
-
-  checkStream("readShort");
-
-  return retval;
+  return readValue<qint16>("readShort");
 }
 
 qint32 BinaryStream::readInt()
 {
-  qint32 retval;
-  is >> retval;
-
-  checkStream("readInt");
-
-  return retval;
+  return readValue<qint32>("readInt");
 }
 
 qint64 BinaryStream::readLong()
 {
-  qint64 retval;
-  is >> retval;
-
-  checkStream("readLong");
-
-  return retval;
+  return readValue<qint64>("readLong");
 }
 
 qint8 BinaryStream::readByte()
 {
-  qint8 retval;
-  is >> retval;
-
-  checkStream("readByte");
-
-  return retval;
+  return readValue<qint8>("readByte");
 }
 
 QChar BinaryStream::readChar()
@@ -191,17 +234,32 @@ QChar BinaryStream::readChar()
 QString BinaryStream::readString(Encoding encoding)
 {
   QByteArray retval;
-  char c = 0;
-  do
+  if(data != nullptr)
+  {
+    // Find terminating NUL in mapping
+    checkMapped(1, "readString");
+    const char *start = data + position;
+    const char *end = static_cast<const char *>(std::memchr(start, '\0', static_cast<size_t>(filesize - position)));
+    if(end == nullptr)
+      throwError("readString", tr("Read past file end"), QDataStream::ReadPastEnd, filesize);
+
+    retval = QByteArray(start, end - start);
+    position += end - start + 1;
+  }
+  else
   {
-    c = readByte();
-    if(c == '\0')
-      break;
+    char c = 0;
+    do
+    {
+      c = readByte();
+      if(c == '\0')
+        break;
 
-    retval.append(c);
-  } while(c != '\0');
+      retval.append(c);
+    } while(c != '\0');
 
-  checkStream("readString");
+    checkStream("readString");
+  }
 
   if(encoding == UTF8)
     return QString::fromUtf8(retval);
@@ -213,29 +271,28 @@ QString BinaryStream::readString(Encoding encoding)
 
 QString BinaryStream::readString(int length, Encoding encoding)
 {
-  // Read the whole length into memory
-  char *buf = new char[static_cast<size_t>(length)];
-  readBytes(buf, length);
-
-  // QByteArray always appends null terminator
-  QByteArray retval;
-  for(int i = 0; i < length; i++)
-  {
-    if(buf[i] == '\0')
-      break;
+  // Read the whole length into memory or use mapping
+  QByteArrayView bytes = readBytesView(length);
 
-    retval.append(buf[i]);
-  }
-  delete[] buf;
+  // Stop at NUL
+  const char *end = static_cast<const char *>(std::memchr(bytes.data(), '\0', static_cast<size_t>(bytes.size())));
+  if(end != nullptr)
+    bytes = bytes.first(end - bytes.data());
 
-  if(retval.isEmpty())
+  if(bytes.isEmpty())
     return QStringLiteral();
   else if(encoding == UTF8)
-    return QString::fromUtf8(retval);
+    return QString::fromUtf8(bytes);
   else if(encoding == LATIN1)
-    return QString::fromLatin1(retval);
+    return QString::fromLatin1(bytes);
   else
-    return QString::fromLocal8Bit(retval);
+    return QString::fromLocal8Bit(bytes);
+}
+
+void BinaryStream::checkMapped(qint64 size, const QString& what) const
+{
+  if(position < 0 || size < 0 || position + size > filesize)
+    throwError(what, tr("Read past file end"), QDataStream::ReadPastEnd, position);
 }
 
 void BinaryStream::checkStream(const QString& what) const
@@ -268,12 +325,17 @@ void BinaryStream::checkStream(const QString& what) const
 #endif
     }
 
-    QString msg = tr("%1 for file \"%2\" failed. Reason: %3 (%4).").arg(what).arg(getFilepath()).arg(statusText).arg(is.status());
-
-    qWarning() << msg << "Position" << Qt::hex << "0x" << is.device()->pos() << Qt::dec << is.device()->pos();
-    throw Exception(msg);
+    throwError(what, statusText, is.status(), is.device()->pos());
   }
 }
 
+void BinaryStream::throwError(const QString& what, const QString& statusText, int status, qint64 pos) const
+{
+  QString msg = tr("%1 for file \"%2\" failed. Reason: %3 (%4).").arg(what).arg(getFilepath()).arg(statusText).arg(status);
+
+  qWarning() << msg << "Position" << Qt::hex << "0x" << pos << Qt::dec << pos;
+  throw Exception(msg);
+}
+
 } /* namespace io */
 } // namespace atools
@@ -18,6 +18,7 @@
 #ifndef ATOOLS_IO_BINARYSTREAM_H
 #define ATOOLS_IO_BINARYSTREAM_H
 
+#include <QByteArrayView>
 #include <QDataStream>
 #include <QCoreApplication>
 
@@ -36,13 +37,19 @@ enum Encoding
  * Simple wrapper for binary file reading around QDataStream
  * that will throw an Exception in case of
  * errors.
+ *
+ * Can optionally map the whole file into memory and read directly from the mapping using bounds checked
+ * pointer access. This avoids the buffered device calls for each value and makes seeking free.
+ * Falls back to QDataStream if the file cannot be mapped.
  */
 class BinaryStream
 {
   Q_DECLARE_TR_FUNCTIONS(BinaryStream)
 
 public:
-  BinaryStream(QFile *binaryFile, QDataStream::ByteOrder order = QDataStream::LittleEndian);
+  /* File has to be open and has to stay open while the stream is used */
+  BinaryStream(QFile *binaryFile, QDataStream::ByteOrder order = QDataStream::LittleEndian, bool memoryMap = false);
+  ~BinaryStream();
 
   BinaryStream(const BinaryStream& other) = delete;
   BinaryStream& operator=(const BinaryStream& other) = delete;
@@ -71,6 +78,10 @@ public:
   int readBytes(char bytes[], int size);
   int readUBytes(unsigned char bytes[], int size);
 
+  /* Read size bytes without copying if memory mapped. Otherwise data is read into an internal buffer.
+   * The view is valid until the next call or until the stream is destroyed. */
+  QByteArrayView readBytesView(int size);
+
   /* Reads 16 bytes like 38EA37B0-F8ED-E54A-B41B-2CA423ADA3EF into UUID
    *  {B037EA38-EDF8-4AE5-B41B-2CA423ADA3EF} */
   QUuid readUuid();
@@ -93,12 +104,35 @@ public:
   /* Returns file name without path */
   QString getFilename() const;
 
+  /* true if file is memory mapped */
+  bool isMemoryMapped() const
+  {
+    return data != nullptr;
+  }
+
 private:
+  template<typename TYPE>
+  TYPE readValue(const char *what);
+
   void checkStream(const QString& what) const;
 
+  /* Throws exception if size bytes cannot be read from the mapped position */
+  void checkMapped(qint64 size, const QString& what) const;
+
+  [[noreturn]] void throwError(const QString& what, const QString& statusText, int status, qint64 pos) const;
+
   QDataStream is;
   QString filename;
   qint64 filesize;
+
+  /* Memory mapped file data, position and byte order if mapped */
+  QFile *mappedFile = nullptr;
+  const char *data = nullptr;
+  qint64 position = 0;
+  bool bigEndian = false;
+
+  /* Used by readBytesView() if not mapped */
+  QByteArray buffer;
 };
 
 } /* namespace io */
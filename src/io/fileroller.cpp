@@ -16,15 +16,30 @@
 *****************************************************************************/
 
 #include "io/fileroller.h"
+#include "zip/gzip.h"
 
+#include <QDateTime>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
 #include <QStringList>
+#include <QThreadPool>
 
 namespace atools {
 namespace io {
 
+/* Suffix for renamed files waiting for compression */
+const static QLatin1String PENDING_SUFFIX(".pending");
+
+/* Single thread to avoid concurrent renaming of the same files */
+static QThreadPool *rollerPool()
+{
+  static QThreadPool pool;
+  static const bool initialized = (pool.setMaxThreadCount(1), true);
+  Q_UNUSED(initialized)
+  return &pool;
+}
+
 FileRoller::FileRoller(int maxNumFiles, const QString& filePattern, bool keepOriginalFileParam)
   : maxFiles(maxNumFiles), keepOriginalFile(keepOriginalFileParam), pattern(filePattern)
 {
@@ -39,6 +54,19 @@ void FileRoller::rollFiles(const QStringList& filenames)
 
 void FileRoller::rollFile(const QString& filename)
 {
+  if(compress && maxFiles > 0)
+  {
+    // Free the filename immediately by renaming to a unique name with timestamp which keeps the order
+    QString pendingFile = filename + '.' + QString::number(QDateTime::currentMSecsSinceEpoch()) + PENDING_SUFFIX;
+    renameSafe(filename, pendingFile, true /* originalFile */);
+
+    FileRoller roller(*this);
+    rollerPool()->start([roller, filename]() {
+      roller.rollCompressed(filename);
+    });
+    return;
+  }
+
   for(int i = maxFiles; i >= 1; --i)
   {
     QFile oldFile(buildFilename(filename, i));
@@ -59,6 +87,65 @@ void FileRoller::rollFile(const QString& filename)
     renameSafe(filename, buildFilename(filename, 1), true /* originalFile */);
 }
 
+void FileRoller::rollCompressed(const QString& filename) const
+{
+  // Get all renamed files including the ones left over from a previous crash - oldest first
+  QFileInfo fileinfo(filename);
+  QFileInfoList pendingFiles = QDir(fileinfo.path()).entryInfoList({fileinfo.fileName() + ".*" + PENDING_SUFFIX},
+                                                                    QDir::Files, QDir::Name);
+
+  for(const QFileInfo& pending : std::as_const(pendingFiles))
+  {
+    // Shift backups - consider uncompressed backups from previous runs too
+    for(int i = maxFiles; i >= 1; --i)
+    {
+      for(const QString& suffix : {QString(".gz"), QString()})
+      {
+        QFile oldFile(buildFilename(filename, i) + suffix);
+        if(oldFile.exists())
+        {
+          if(i == maxFiles)
+            oldFile.remove();
+          else
+            renameSafe(oldFile.fileName(), buildFilename(filename, i + 1) + suffix, false /* originalFile */);
+        }
+      }
+    }
+
+    // Compress into first backup
+    QFile in(pending.absoluteFilePath());
+    if(in.open(QIODevice::ReadOnly))
+    {
+      // Stream to avoid loading large log files into memory
+      QFile out(buildFilename(filename, 1) + ".gz");
+      bool ok = out.open(QIODevice::WriteOnly) && atools::zip::gzipCompress(&in, &out);
+      in.close();
+
+      if(ok)
+      {
+        out.close();
+        in.remove();
+      }
+      else
+      {
+        // Keep uncompressed backup on error
+        out.remove();
+        renameSafe(in.fileName(), buildFilename(filename, 1), false /* originalFile */);
+      }
+    }
+  }
+}
+
+bool FileRoller::waitForBackgroundJobs(int msecs)
+{
+  return rollerPool()->waitForDone(msecs);
+}
+
+QString FileRoller::getBackupFilename(const QString& filename, int num) const
+{
+  return compress ? buildFilename(filename, num) + ".gz" : buildFilename(filename, num);
+}
+
 QString FileRoller::buildFilename(const QString& filename, int num) const
 {
   // ${base}: Complete basename, ${num}: Counting number, ${ext}: File extension.
@@ -27,6 +27,10 @@ namespace io {
 
 /*
  * Creates numbered backups from e.g. log files.
+ *
+ * Backups can optionally be gzip compressed. The original file is renamed immediately in this case
+ * while shifting and compressing of backups is done in a background thread. Jobs are executed one after
+ * the other. Renamed files which could not be compressed due to a crash are picked up by the next job.
  */
 class FileRoller
 {
@@ -55,12 +59,28 @@ public:
    */
   void rollFiles(const QStringList& filenames);
 
+  /* Compress backups into files like "file.log.1.gz" in background. Default is false. */
+  void setCompress(bool value)
+  {
+    compress = value;
+  }
+
+  /* Name of a backup file with the given number including ".gz" suffix if compressed */
+  QString getBackupFilename(const QString& filename, int num) const;
+
+  /* Wait until all background compression jobs are finished. Waits forever if msecs is negative.
+   * Returns false on timeout. */
+  static bool waitForBackgroundJobs(int msecs = -1);
+
 private:
+  /* Shift backups and compress renamed files. Called in background thread. */
+  void rollCompressed(const QString& filename) const;
+
   void renameSafe(const QString& fromFile, const QString& toFile, bool originalFile) const;
   QString buildFilename(const QString& filename, int num) const;
 
   int maxFiles = 0;
-  bool keepOriginalFile = false;
+  bool keepOriginalFile = false, compress = false;
 
   // Default ${base}.${ext}.${num}
   QString pattern;
@@ -0,0 +1,364 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "logging/loggingbinary.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QTextStream>
+#include <QThread>
+
+#include <algorithm>
+
+namespace atools {
+namespace logging {
+
+namespace binlog {
+
+static const QByteArray MAGIC("ATLOG");
+static const char VERSION = 1;
+
+enum Tag : quint8
+{
+  STRING = 1,
+  THREAD = 2,
+  MESSAGE = 3
+};
+
+static void appendVarint(QByteArray& buffer, quint64 value)
+{
+  while(value >= 0x80)
+  {
+    buffer.append(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  buffer.append(static_cast<char>(value));
+}
+
+static void appendString(QByteArray& buffer, const QByteArray& str)
+{
+  appendVarint(buffer, static_cast<quint64>(str.size()));
+  buffer.append(str);
+}
+
+/* Reads from a byte array and remembers errors */
+class Reader
+{
+public:
+  explicit Reader(const QByteArray& bytes)
+    : data(bytes)
+  {
+  }
+
+  bool atEnd() const
+  {
+    return pos >= data.size();
+  }
+
+  bool isValid() const
+  {
+    return valid;
+  }
+
+  qsizetype position() const
+  {
+    return pos;
+  }
+
+  void stepBack()
+  {
+    if(pos > 0)
+      pos--;
+  }
+
+  quint8 readByte()
+  {
+    if(pos >= data.size())
+    {
+      valid = false;
+      return 0;
+    }
+    return static_cast<quint8>(data.at(pos++));
+  }
+
+  quint64 readVarint()
+  {
+    quint64 value = 0;
+    for(int shift = 0; shift < 64 && valid; shift += 7)
+    {
+      quint8 byte = readByte();
+      value |= static_cast<quint64>(byte & 0x7f) << shift;
+      if((byte & 0x80) == 0)
+        return value;
+    }
+    valid = false;
+    return 0;
+  }
+
+  QByteArray readString()
+  {
+    quint64 size = readVarint();
+    if(!valid || size > static_cast<quint64>(data.size() - pos))
+    {
+      valid = false;
+      return QByteArray();
+    }
+    QByteArray str = data.mid(pos, static_cast<qsizetype>(size));
+    pos += static_cast<qsizetype>(size);
+    return str;
+  }
+
+  bool readMagic()
+  {
+    if(data.mid(pos, MAGIC.size()) != MAGIC)
+      return false;
+    pos += MAGIC.size();
+    return readByte() == VERSION;
+  }
+
+private:
+  const QByteArray& data;
+  qsizetype pos = 0;
+  bool valid = true;
+};
+
+static QLatin1String levelText(quint8 type)
+{
+  switch(type)
+  {
+    case QtDebugMsg:
+      return QLatin1String("DEBUG");
+
+    case QtInfoMsg:
+      return QLatin1String("INFO ");
+
+    case QtWarningMsg:
+      return QLatin1String("WARN ");
+
+    case QtCriticalMsg:
+      return QLatin1String("CRIT ");
+
+    case QtFatalMsg:
+      return QLatin1String("FATAL");
+  }
+  return QLatin1String("?????");
+}
+
+} // namespace binlog
+
+bool LoggingBinaryDecoder::decode(QIODevice *device, QTextStream& out, QString *errorMessage)
+{
+  // Log files are small enough to be read at once
+  const QByteArray bytes = device->readAll();
+  binlog::Reader reader(bytes);
+
+  if(!reader.readMagic())
+  {
+    if(errorMessage != nullptr)
+      *errorMessage = QStringLiteral("Not a binary log file");
+    return false;
+  }
+
+  QHash<quint64, QString> strings, threads;
+  qint64 timestamp = 0;
+
+  while(!reader.atEnd() && reader.isValid())
+  {
+    quint8 tag = reader.readByte();
+    if(tag == static_cast<quint8>(binlog::MAGIC.at(0)))
+    {
+      // New session appended to file - ids are reused
+      reader.stepBack();
+      if(!reader.readMagic())
+      {
+        if(errorMessage != nullptr)
+          *errorMessage = QStringLiteral("Invalid session header at offset %1").arg(reader.position());
+        return false;
+      }
+      strings.clear();
+      threads.clear();
+      timestamp = 0;
+      continue;
+    }
+
+    switch(tag)
+    {
+      case binlog::STRING:
+        {
+          quint64 id = reader.readVarint();
+          strings.insert(id, QString::fromUtf8(reader.readString()));
+        }
+        break;
+
+      case binlog::THREAD:
+        {
+          quint64 id = reader.readVarint();
+          threads.insert(id, QString::fromUtf8(reader.readString()));
+        }
+        break;
+
+      case binlog::MESSAGE:
+        {
+          // Zigzag decode time delta
+          quint64 delta = reader.readVarint();
+          timestamp += static_cast<qint64>(delta >> 1) ^ -static_cast<qint64>(delta & 1);
+
+          quint8 type = reader.readByte();
+          quint64 category = reader.readVarint();
+          quint64 thread = reader.readVarint();
+          quint64 function = reader.readVarint();
+          quint64 file = reader.readVarint();
+          quint64 line = reader.readVarint();
+          QString message = QString::fromUtf8(reader.readString());
+
+          if(reader.isValid())
+          {
+            out << '[' << QDateTime::fromMSecsSinceEpoch(timestamp).toString("yyyy-MM-dd h:mm:ss.zzz") << ' '
+                << strings.value(category) << ' ' << binlog::levelText(type) << "] "
+                << threads.value(thread) << ' ';
+
+            if(line > 0)
+              out << strings.value(file) << ':' << line << ' ';
+
+            out << strings.value(function) << ": " << message << '\n';
+          }
+        }
+        break;
+
+      default:
+        if(errorMessage != nullptr)
+          *errorMessage = QStringLiteral("Invalid record type %1 at offset %2").arg(tag).arg(reader.position() - 1);
+        return false;
+    }
+  }
+
+  if(!reader.isValid())
+  {
+    if(errorMessage != nullptr)
+      *errorMessage = QStringLiteral("Truncated record at offset %1").arg(reader.position());
+    return false;
+  }
+
+  return true;
+}
+
+bool LoggingBinaryDecoder::decodeFile(const QString& binaryFilename, const QString& textFilename, QString *errorMessage)
+{
+  QFile in(binaryFilename);
+  if(!in.open(QIODevice::ReadOnly))
+  {
+    if(errorMessage != nullptr)
+      *errorMessage = in.errorString();
+    return false;
+  }
+
+  QFile outFile(textFilename);
+  if(!outFile.open(QIODevice::WriteOnly | QIODevice::Text))
+  {
+    if(errorMessage != nullptr)
+      *errorMessage = outFile.errorString();
+    return false;
+  }
+
+  QTextStream out(&outFile);
+  out.setLocale(QLocale::C);
+  return decode(&in, out, errorMessage);
+}
+
+namespace internal {
+
+void BinaryLogEncoder::reset(QIODevice *device)
+{
+  strings.clear();
+  threads.clear();
+  lastTimestamp = 0;
+
+  record.clear();
+  record.append(binlog::MAGIC);
+  record.append(binlog::VERSION);
+  device->write(record);
+}
+
+quint32 BinaryLogEncoder::stringId(const char *str)
+{
+  QByteArray key = QByteArray::fromRawData(str != nullptr ? str : "", str != nullptr ? static_cast<qsizetype>(qstrlen(str)) : 0);
+  auto it = strings.constFind(key);
+  if(it != strings.constEnd())
+    return it.value();
+
+  // Deep copy since context strings of the narrow handler are temporary
+  quint32 id = static_cast<quint32>(strings.size());
+  QByteArray copy(key.constData(), key.size());
+  strings.insert(copy, id);
+
+  record.append(static_cast<char>(binlog::STRING));
+  binlog::appendVarint(record, id);
+  binlog::appendString(record, copy);
+  return id;
+}
+
+quint32 BinaryLogEncoder::threadId()
+{
+  quintptr handle = reinterpret_cast<quintptr>(QThread::currentThreadId());
+  auto it = threads.constFind(handle);
+  if(it != threads.constEnd())
+    return it.value();
+
+  quint32 id = static_cast<quint32>(threads.size());
+  threads.insert(handle, id);
+
+  QString name = QThread::currentThread()->objectName();
+  if(name.isEmpty())
+    name = QStringLiteral("0x%1").arg(handle, 0, 16);
+
+  record.append(static_cast<char>(binlog::THREAD));
+  binlog::appendVarint(record, id);
+  binlog::appendString(record, name.toUtf8());
+  return id;
+}
+
+void BinaryLogEncoder::write(QIODevice *device, QtMsgType type, const QMessageLogContext& context, const QString& msg)
+{
+  record.clear();
+
+  // Definitions are appended to the record before the message
+  quint32 categoryId = stringId(context.category != nullptr ? context.category : "default");
+  quint32 thread = threadId();
+  quint32 functionId = stringId(context.function);
+  quint32 fileId = stringId(context.file);
+
+  qint64 timestamp = QDateTime::currentMSecsSinceEpoch();
+  qint64 delta = timestamp - lastTimestamp;
+  lastTimestamp = timestamp;
+
+  record.append(static_cast<char>(binlog::MESSAGE));
+  binlog::appendVarint(record, static_cast<quint64>((delta << 1) ^ (delta >> 63)));
+  record.append(static_cast<char>(type));
+  binlog::appendVarint(record, categoryId);
+  binlog::appendVarint(record, thread);
+  binlog::appendVarint(record, functionId);
+  binlog::appendVarint(record, fileId);
+  binlog::appendVarint(record, static_cast<quint64>(std::max(context.line, 0)));
+  binlog::appendString(record, msg.toUtf8());
+
+  device->write(record);
+}
+
+} // namespace internal
+} // namespace logging
+} // namespace atools
@@ -0,0 +1,89 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_LOGGING_LOGGINGBINARY_H
+#define ATOOLS_LOGGING_LOGGINGBINARY_H
+
+#include <QHash>
+#include <QString>
+
+class QIODevice;
+class QTextStream;
+class QMessageLogContext;
+
+namespace atools {
+namespace logging {
+
+/*
+ * Converts binary log files written by channels of type "binary:" back to text.
+ *
+ * Binary log format. All numbers are unsigned LEB128 varints unless noted otherwise:
+ *
+ * Header:     "ATLOG" u8 version - starts a new session and clears all ids
+ * String:     u8 1, id, length, UTF-8 bytes - defines a category, file or function name
+ * Thread:     u8 2, id, length, UTF-8 bytes - defines a thread by name or address
+ * Message:    u8 3, zigzag time delta in ms since previous message, u8 QtMsgType, category id,
+ *             thread id, function id, file id, line, length, UTF-8 message bytes
+ *
+ * Strings and threads are defined once per session before their first use.
+ */
+class LoggingBinaryDecoder
+{
+public:
+  /*
+   * Decode the binary log from device and write one text line per message to out.
+   * @return false if the data is not a binary log or is truncated. Messages up to the error are written.
+   */
+  static bool decode(QIODevice *device, QTextStream& out, QString *errorMessage = nullptr);
+
+  /* Decode binary log file into a text file */
+  static bool decodeFile(const QString& binaryFilename, const QString& textFilename, QString *errorMessage = nullptr);
+};
+
+namespace internal {
+
+/*
+ * Encodes log messages for one binary channel. Not thread safe - has to be called within logging mutex.
+ * Message texts are stored unformatted. Repeated strings like category, file and function are stored once per session.
+ */
+class BinaryLogEncoder
+{
+public:
+  /* Start a new session by writing the header. Has to be called for each new file. */
+  void reset(QIODevice *device);
+
+  /* Encode message and write it to the device */
+  void write(QIODevice *device, QtMsgType type, const QMessageLogContext& context, const QString& msg);
+
+private:
+  /* Get id for string and append definition to record buffer if new */
+  quint32 stringId(const char *str);
+  quint32 threadId();
+
+  QHash<QByteArray, quint32> strings;
+  QHash<quintptr, quint32> threads;
+  qint64 lastTimestamp = 0;
+
+  /* Reused buffer for encoding */
+  QByteArray record;
+};
+
+} // namespace internal
+} // namespace logging
+} // namespace atools
+
+#endif // ATOOLS_LOGGING_LOGGINGBINARY_H
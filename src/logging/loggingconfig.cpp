@@ -19,6 +19,7 @@
 #include "atools.h"
 #include "settings/settings.h"
 #include "io/fileroller.h"
+#include "logging/loggingbinary.h"
 
 #include <QDebug>
 #include <QDir>
@@ -27,6 +28,8 @@
 #include <QDateTime>
 #include <QStringBuilder>
 
+#include <algorithm>
+
 namespace atools {
 namespace logging {
 namespace internal {
@@ -115,6 +118,9 @@ void LoggingConfig::closeStreams(QSet<Channel *>& channels, const ChannelList& c
       channel->file = nullptr;
     }
 
+    delete channel->encoder;
+    channel->encoder = nullptr;
+
     // Remember object for later deletion
     channels.insert(channel);
   }
@@ -145,10 +151,16 @@ QStringList LoggingConfig::getLogFiles(bool includeBackups) const
 
     if(includeBackups)
     {
+      // Consider compressed and uncompressed backups from previous runs
+      io::FileRoller roller(maximumBackupFiles);
       for(int i = 1; i <= maximumBackupFiles; i++)
       {
-        if(QFile::exists(filename % ".1"))
-          filenameList.append(filename % ".1");
+        QString backup = roller.getBackupFilename(filename, i);
+        for(const QString& backupFile : {backup, backup + ".gz"})
+        {
+          if(QFile::exists(backupFile))
+            filenameList.append(backupFile);
+        }
       }
     }
   }
@@ -181,10 +193,17 @@ void LoggingConfig::collectFileNames(QSet<QString>& filenames, const ChannelList
 void LoggingConfig::checkStreamSize(Channel *channel)
 {
   // This needs to be called withing mutex lock
-  if(maximumFileSizeBytes > 0 && channel->file != nullptr && channel->file->size() > maximumFileSizeBytes)
+  if(channel->file == nullptr)
+    return;
+
+  bool sizeExceeded = maximumFileSizeBytes > 0 && channel->file->size() > maximumFileSizeBytes;
+  bool ageExceeded = maximumFileAgeMs > 0 && QDateTime::currentMSecsSinceEpoch() - channel->openedMs > maximumFileAgeMs;
+
+  if(sizeExceeded || ageExceeded)
   {
-    // Maximum size is active and exceeded
-    channel->stream->setDevice(nullptr);
+    // Maximum size or age is active and exceeded
+    if(channel->stream != nullptr)
+      channel->stream->setDevice(nullptr);
 
     // Remember filename
     QString filename = channel->file->fileName();
@@ -194,21 +213,47 @@ void LoggingConfig::checkStreamSize(Channel *channel)
     channel->file = nullptr;
 
     // Backup and delete original log
-    io::FileRoller(maximumBackupFiles).rollFile(filename);
+    rollFile(filename);
 
     // Create new log file
+    QIODevice::OpenMode mode = fileOpenMode;
+    if(channel->encoder != nullptr)
+      mode.setFlag(QIODevice::Text, false);
+
     QFile *file = new QFile(filename);
-    if(file->open(fileOpenMode))
+    if(file->open(mode))
     {
-      // Put log file into stream
       channel->file = file;
-      channel->stream->setDevice(channel->file);
-
-      channel->stream->setLocale(QLocale::C);
+      channel->openedMs = QDateTime::currentMSecsSinceEpoch();
+      if(channel->encoder != nullptr)
+        // Binary files have to be self-contained
+        channel->encoder->reset(channel->file);
+      else
+      {
+        // Put log file into stream
+        channel->stream->setDevice(channel->file);
+        channel->stream->setLocale(QLocale::C);
+      }
     }
   }
 }
 
+void LoggingConfig::rollFile(const QString& filename) const
+{
+  // Renames the file immediately and compresses in background if enabled
+  io::FileRoller roller(maximumBackupFiles);
+  roller.setCompress(compress);
+  roller.rollFile(filename);
+}
+
+bool LoggingConfig::hasChannels(QtMsgType type, const QString& category)
+{
+  if(category == QLatin1String("default"))
+    return !getStream(type).isEmpty();
+  else
+    return !getCatStream(type).value(category).isEmpty();
+}
+
 ChannelList& LoggingConfig::getStream(QtMsgType type)
 {
   switch(type)
@@ -320,6 +365,10 @@ void LoggingConfig::readConfigurationSection(QSettings *settings)
     fileOpenMode = QIODevice::WriteOnly | QIODevice::Text;
   }
 
+  // Roll by age in minutes
+  maximumFileAgeMs = settings->value("configuration/maxage").toLongLong() * 60000LL;
+  compress = settings->value("configuration/compress", false).toBool();
+
   // Always append if rolling by size - rolling is done in the logging function
   if(maximumFileSizeBytes > 0)
     fileOpenMode = QIODevice::Append | QIODevice::Text;
@@ -327,6 +376,10 @@ void LoggingConfig::readConfigurationSection(QSettings *settings)
   rolling = settings->value("configuration/files").toString() == "roll";
   maximumBackupFiles = settings->value("configuration/maxfiles").toInt();
 
+  async = settings->value("configuration/async", false).toBool();
+  asyncBufferSize = std::max(settings->value("configuration/asyncbuffer", 8192).toInt(), 16);
+  asyncFlushMs = std::max(settings->value("configuration/asyncflush", 500).toInt(), 10);
+
   QString abortOn = settings->value("configuration/abort", QVariant("fatal")).toString();
   if(abortOn == "warning")
     abortType = QtWarningMsg;
@@ -361,6 +414,11 @@ void LoggingConfig::readChannels(QSettings *settings, QHash<QString, Channel *>&
     }
     else
     {
+      // Binary channels write compact records instead of formatted text
+      bool binaryChannel = channelName.startsWith("binary:");
+      if(binaryChannel)
+        channelName = channelName.mid(7);
+
       // Create a stream for the channel
       QString filename = channelName;
       if(filename.isEmpty())
@@ -375,7 +433,12 @@ void LoggingConfig::readChannels(QSettings *settings, QHash<QString, Channel *>&
       else if(!logPrefix.isEmpty())
         filename = logPrefix + filename;
 
-      if(!filename.endsWith(".log", Qt::CaseInsensitive))
+      if(binaryChannel)
+      {
+        if(!filename.endsWith(".blog", Qt::CaseInsensitive))
+          filename += ".blog";
+      }
+      else if(!filename.endsWith(".log", Qt::CaseInsensitive))
         filename += ".log";
 
       if(!logDir.isEmpty())
@@ -383,14 +446,31 @@ void LoggingConfig::readChannels(QSettings *settings, QHash<QString, Channel *>&
 
       if(rolling && maximumFileSizeBytes <= 0)
         // Create log file backups
-        io::FileRoller(maximumBackupFiles).rollFile(filename);
+        rollFile(filename);
 
       QFile *file = new QFile(filename);
-      if(file->open(fileOpenMode))
+      if(binaryChannel)
+      {
+        QIODevice::OpenMode mode = fileOpenMode;
+        mode.setFlag(QIODevice::Text, false);
+        if(file->open(mode))
+        {
+          Channel *channel = new Channel({nullptr, file});
+          channel->openedMs = QDateTime::currentMSecsSinceEpoch();
+          channel->encoder = new BinaryLogEncoder;
+          channel->encoder->reset(file);
+          channelMap.insert(key, channel);
+          binaryChannels.append(channel);
+          binary = true;
+        }
+      }
+      else if(file->open(fileOpenMode))
       {
         QTextStream *stream = new QTextStream(file);
         stream->setLocale(QLocale::C);
-        channelMap.insert(key, new Channel({stream, file}));
+        Channel *channel = new Channel({stream, file});
+        channel->openedMs = QDateTime::currentMSecsSinceEpoch();
+        channelMap.insert(key, channel);
       }
     }
   }
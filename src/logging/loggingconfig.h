@@ -31,6 +31,7 @@ namespace atools {
 namespace logging {
 class LoggingHandler;
 namespace internal {
+class LoggingWriter;
 
 /* Internal logging class that reads the configuration and sets up all the
  * streams. */
@@ -45,6 +46,7 @@ public:
 
 private:
   friend class atools::logging::LoggingHandler;
+  friend class atools::logging::internal::LoggingWriter;
 
   /* get a list of log files (excluding stdout and stderr) */
   QStringList getLogFiles(bool includeBackups) const;
@@ -67,6 +69,9 @@ private:
   /* get all categorized streams for the given level */
   ChannelMap& getCatStream(QtMsgType type);
 
+  /* true if messages of the given level and category are written to any channel */
+  bool hasChannels(QtMsgType type, const QString& category);
+
   void addDefaultChannels(const QStringList& channelsForLevel, const QHash<QString, Channel *>& channelMap,
                           ChannelList& channelList);
 
@@ -79,6 +84,7 @@ private:
    * console = stdio
    * console-err = stderr
    * log = littlelogbook.log
+   * trace = binary:littlelogbook-trace.blog
    */
   void readChannels(QSettings *settings, QHash<QString, Channel *>& channelMap);
 
@@ -106,9 +112,12 @@ private:
   void collectFileNames(QSet<QString>& filenames, const ChannelList& channelVector) const;
   void collectFileNames(QSet<QString>& filenames, const ChannelMap& channelMap) const;
 
-  /* Check if file size exceeds limit. Rolls files, creates a new one and replaces device in text stream */
+  /* Check if file size or age exceeds limit. Rolls files, creates a new one and replaces device in text stream */
   void checkStreamSize(Channel *channel);
 
+  /* Roll log file backups in background if compression is enabled */
+  void rollFile(const QString& filename) const;
+
   // Will be assigned later
   QIODevice::OpenMode fileOpenMode = QIODevice::NotOpen;
   bool rolling = false;
@@ -117,9 +126,25 @@ private:
   /* 0 of -1 if not used */
   qint64 maximumFileSizeBytes = 0;
 
+  /* Maximum age of a log file before rolling in milliseconds. 0 if not used. */
+  qint64 maximumFileAgeMs = 0;
+
+  /* Compress backups with gzip in a background thread */
+  bool compress = false;
+
   /* Shorten file and method names if true. */
   bool narrow = false;
 
+  /* At least one channel uses the binary format */
+  bool binary = false;
+
+  /* All binary channels for flushing */
+  ChannelList binaryChannels;
+
+  /* Write messages in a separate thread. Buffer size is number of messages and flush interval in milliseconds. */
+  bool async = false;
+  int asyncBufferSize = 8192, asyncFlushMs = 500;
+
   QString logConfig, logDir, logPrefix;
 
   // Messages of this type or worse cause a call to abort()
@@ -17,17 +17,22 @@
 
 #include "logging/logginghandler.h"
 #include "logging/loggingconfig.h"
+#include "logging/loggingwriter.h"
 
 #include <QDebug>
 #include <QDir>
 #include <QCoreApplication>
 #include <QThread>
 
+#include <cstdlib>
+
 namespace atools {
 namespace logging {
 
 using internal::LoggingConfig;
 using internal::Channel;
+using internal::ChannelList;
+using internal::LoggingWriter;
 
 LoggingHandler *LoggingHandler::instance = nullptr;
 LoggingHandler::LogFunctionType LoggingHandler::logFunc;
@@ -37,9 +42,24 @@ QWidget *LoggingHandler::parentWidget = nullptr;
 LoggingHandler::LoggingHandler(const QString& logConfiguration,
                                const QString& logDirectory,
                                const QString& logFilePrefix)
+  : writer(nullptr)
 {
   logConfig = new LoggingConfig(logConfiguration, logDirectory, logFilePrefix);
 
+  // Category filter needs the configuration while being installed
+  instance = this;
+
+  if(logConfig->async)
+  {
+    LoggingWriter *asyncWriter = new LoggingWriter(logConfig, &mutex, logConfig->asyncBufferSize, logConfig->asyncFlushMs);
+    asyncWriter->start(QThread::LowPriority);
+    writer.store(asyncWriter);
+  }
+
+  // Instance is never deleted - write all pending messages on exit
+  if(logConfig->async || logConfig->binary)
+    std::atexit(atExit);
+
   // Override category filter since some systems disable debug logging in the qtlogging.ini
   oldCategoryFilter = QLoggingCategory::installFilter(categoryFilter);
 
@@ -87,6 +107,15 @@ void LoggingHandler::initializeForTemp(const QString& logConfiguration)
     qWarning() << "LoggingHandler::initializeForTemp called more than once";
 }
 
+void LoggingHandler::setLogFunction(LogFunctionType loggingFunction)
+{
+  logFunc = loggingFunction;
+
+  // Update enabled levels of all categories
+  if(instance != nullptr)
+    QLoggingCategory::installFilter(categoryFilter);
+}
+
 QString LoggingHandler::prefix()
 {
   return QCoreApplication::organizationName().replace(" ", "_").toLower() + "-" +
@@ -101,26 +130,80 @@ const QStringList LoggingHandler::getLogFiles(bool includeBackups)
     return QStringList();
 }
 
-void LoggingHandler::logToCatChannels(internal::ChannelMap& streamListCat,
-                                      internal::ChannelList& streamList, const QString& message, const QString& category)
+void LoggingHandler::atExit()
 {
-  QMutexLocker locker(&instance->mutex);
+  if(instance != nullptr)
+  {
+    // Further messages are written synchronously
+    LoggingWriter *asyncWriter = instance->writer.exchange(nullptr);
+    if(asyncWriter != nullptr)
+      asyncWriter->stop();
+
+    // Do not delete writer since other threads might still use it
+
+    instance->flushBinaryChannels();
+  }
+}
 
-  if(category.isEmpty())
+void LoggingHandler::flushBinaryChannels()
+{
+  QMutexLocker locker(&mutex);
+  for(Channel *channel : std::as_const(logConfig->binaryChannels))
   {
-    for(Channel *channel : streamList)
-    {
-      (*channel->stream) << message << Qt::endl << Qt::flush;
-      instance->logConfig->checkStreamSize(channel);
-    }
+    if(channel->file != nullptr)
+      channel->file->flush();
   }
-  else if(streamListCat.contains(category))
+}
+
+void LoggingHandler::logToCatChannels(QtMsgType type, const QMessageLogContext& context, const QString& msg,
+                                      internal::ChannelMap& streamListCat, internal::ChannelList& streamList,
+                                      const QString& category)
+{
+  // Ignore unknown categories
+  ChannelList channels = category.isEmpty() ? streamList : streamListCat.value(category);
+  if(channels.isEmpty())
+    return;
+
+  if(logConfig->binary)
   {
-    for(Channel *channel : std::as_const(streamListCat[category]))
+    // Write binary records from unformatted message and keep only text channels
+    ChannelList textChannels;
+    QMutexLocker locker(&mutex);
+    for(Channel *channel : std::as_const(channels))
     {
-      (*channel->stream) << message << Qt::endl << Qt::flush;
-      instance->logConfig->checkStreamSize(channel);
+      if(channel->encoder != nullptr)
+      {
+        if(channel->file != nullptr)
+        {
+          channel->encoder->write(channel->file, type, context, msg);
+          if(type == QtWarningMsg || type == QtCriticalMsg || type == QtFatalMsg)
+            channel->file->flush();
+          logConfig->checkStreamSize(channel);
+        }
+      }
+      else
+        textChannels.append(channel);
     }
+    locker.unlock();
+
+    if(textChannels.isEmpty())
+      return;
+    channels = textChannels;
+  }
+
+  // Format only if needed by a text channel
+  QString message = qFormatLogMessage(type, context, msg);
+
+  LoggingWriter *asyncWriter = writer.load();
+  if(asyncWriter != nullptr && asyncWriter->append(type, message, channels))
+    return;
+  // Write synchronously if async is not used or the writer was stopped
+
+  QMutexLocker locker(&mutex);
+  for(Channel *channel : std::as_const(channels))
+  {
+    (*channel->stream) << message << Qt::endl << Qt::flush;
+    logConfig->checkStreamSize(channel);
   }
 }
 
@@ -147,6 +230,17 @@ void LoggingHandler::checkAbortType(QtMsgType type, const QMessageLogContext& co
       break;
   }
 
+  // Write all pending messages before the program ends
+  LoggingWriter *asyncWriter = writer.load();
+  if(doAbort || type == QtFatalMsg)
+  {
+    if(asyncWriter != nullptr)
+      asyncWriter->flush();
+
+    if(logConfig->binary)
+      flushBinaryChannels();
+  }
+
   if(doAbort)
   {
     if(abortFunc)
@@ -167,8 +261,8 @@ void LoggingHandler::messageHandler(QtMsgType type, const QMessageLogContext& co
   if(category == DEFAULT)
     category.clear();
 
-  instance->logToCatChannels(instance->logConfig->getCatStream(type), instance->logConfig->getStream(type),
-                             qFormatLogMessage(type, context, msg), category);
+  instance->logToCatChannels(type, context, msg, instance->logConfig->getCatStream(type),
+                             instance->logConfig->getStream(type), category);
 
   instance->checkAbortType(type, context, msg);
 }
@@ -255,8 +349,8 @@ void LoggingHandler::messageHandlerNarrow(QtMsgType type, const QMessageLogConte
   if(category == DEFAULT)
     category.clear();
 
-  instance->logToCatChannels(instance->logConfig->getCatStream(type), instance->logConfig->getStream(type),
-                             qFormatLogMessage(type, ctx, message), category);
+  instance->logToCatChannels(type, ctx, message, instance->logConfig->getCatStream(type),
+                             instance->logConfig->getStream(type), category);
 
   instance->checkAbortType(type, ctx, message);
 
@@ -268,13 +362,26 @@ void LoggingHandler::messageHandlerNarrow(QtMsgType type, const QMessageLogConte
 
 void LoggingHandler::categoryFilter(QLoggingCategory *category)
 {
-  // Enable all - we do our own category filtering
+  // Override Qt rules - we do our own category filtering
   if(category != nullptr)
   {
-    category->setEnabled(QtDebugMsg, true);
+    // Always pass warnings and worse to allow abort handling
     category->setEnabled(QtCriticalMsg, true);
-    category->setEnabled(QtInfoMsg, true);
     category->setEnabled(QtWarningMsg, true);
+
+    if(instance == nullptr || logFunc)
+    {
+      // Configuration not loaded yet or log function wants all messages
+      category->setEnabled(QtDebugMsg, true);
+      category->setEnabled(QtInfoMsg, true);
+    }
+    else
+    {
+      // Disable levels without channels to allow skipping messages early
+      QString name = QString::fromLatin1(category->categoryName());
+      category->setEnabled(QtDebugMsg, instance->logConfig->hasChannels(QtDebugMsg, name));
+      category->setEnabled(QtInfoMsg, instance->logConfig->hasChannels(QtInfoMsg, name));
+    }
   }
 }
 
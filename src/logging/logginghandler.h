@@ -24,6 +24,7 @@
 #include <QMutex>
 #include <QObject>
 #include <QStringList>
+#include <atomic>
 #include <functional>
 
 class QTextStream;
@@ -34,6 +35,7 @@ namespace atools {
 namespace logging {
 namespace internal {
 class LoggingConfig;
+class LoggingWriter;
 }
 
 class LoggingGuiAbortHandler;
@@ -67,6 +69,35 @@ class LoggingGuiAbortHandler;
  * critical.default = console-err,log
  * fatal.default    = console-err,log
  *
+ * Optional asynchronous writing in [configuration]:
+ *
+ * async = true
+ * asyncbuffer = 8192
+ * asyncflush = 500
+ *
+ * Messages are passed to a writer thread through a lock free buffer of asyncbuffer messages which
+ * avoids serializing threads on verbose logging. Streams are flushed every asyncflush milliseconds and
+ * immediately on warnings or worse. All messages are written before an abort and on program exit.
+ *
+ * Debug and info levels of a category are disabled if no channels are configured for them. Messages
+ * logged with the macros in loggingmacros.h are skipped without evaluating any arguments in this case.
+ *
+ * Channels can use a compact binary format by prefixing the file name with "binary:". Messages
+ * for binary channels are not formatted which saves CPU and disk space on high rate debug logging.
+ * Use LoggingBinaryDecoder to convert these files to text.
+ *
+ * [channels]
+ * trace = binary:myapplication-trace.blog
+ *
+ * Log files can be rolled by size in bytes and/or age in minutes while running. Backups are gzip
+ * compressed in a background thread if compress is true which keeps rolling off the logging path:
+ *
+ * [configuration]
+ * files = roll
+ * maxfiles = 5
+ * maxsize = 10000000
+ * maxage = 1440
+ * compress = true
  */
 class LoggingHandler :
   public QObject
@@ -107,11 +138,8 @@ public:
   static const QStringList getLogFiles(bool includeBackups);
 
   typedef std::function<void (QtMsgType type, const QMessageLogContext& context, const QString& msg)> LogFunctionType;
-  /* Function will be called on the calling thread context */
-  static void setLogFunction(LogFunctionType loggingFunction)
-  {
-    logFunc = loggingFunction;
-  }
+  /* Function will be called on the calling thread context. Enables all categories and levels. */
+  static void setLogFunction(LogFunctionType loggingFunction);
 
   typedef std::function<void (QtMsgType type, const QMessageLogContext& context, const QString& msg)> AbortFunctionType;
 
@@ -140,8 +168,13 @@ private:
   LoggingHandler(const LoggingHandler& other) = delete;
   LoggingHandler& operator=(const LoggingHandler& other) = delete;
 
-  void logToCatChannels(atools::logging::internal::ChannelMap& streamListCat, atools::logging::internal::ChannelList& streamList,
-                        const QString& message, const QString& category = QString());
+  /* Writes binary records and formats the message only if text channels are used */
+  void logToCatChannels(QtMsgType type, const QMessageLogContext& context, const QString& msg,
+                        atools::logging::internal::ChannelMap& streamListCat,
+                        atools::logging::internal::ChannelList& streamList, const QString& category = QString());
+
+  /* Write buffered binary records to files */
+  void flushBinaryChannels();
 
   void checkAbortType(QtMsgType type, const QMessageLogContext& context, const QString& msg);
 
@@ -150,9 +183,16 @@ private:
   static void categoryFilter(QLoggingCategory *category);
   static QString prefix();
 
+  /* Write pending messages of the asynchronous writer and switch to synchronous writing.
+   * Flushes binary channels. Called on exit. */
+  static void atExit();
+
   static LoggingHandler *instance;
 
   atools::logging::internal::LoggingConfig *logConfig;
+
+  /* Null if async mode is not used or stopped */
+  std::atomic<atools::logging::internal::LoggingWriter *> writer;
   QtMessageHandler oldMessageHandler = nullptr;
   QLoggingCategory::CategoryFilter oldCategoryFilter = nullptr;
 
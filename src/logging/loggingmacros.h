@@ -0,0 +1,79 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_LOGGING_LOGGINGMACROS_H
+#define ATOOLS_LOGGING_LOGGINGMACROS_H
+
+#include <QLoggingCategory>
+
+/*
+ * Logging macros which skip evaluation of all streamed arguments if the message would be discarded.
+ *
+ * Plain qDebug() << ... builds the whole message before the category level is checked.
+ * These macros check the level first which is a single atomic load. LoggingHandler enables
+ * debug and info levels of a category only if the configuration has channels for them.
+ *
+ * Usage:
+ * ATOOLS_DEBUG() << Q_FUNC_INFO << "default category" << value;
+ * ATOOLS_CDEBUG(gui) << "category declared by Q_DECLARE_LOGGING_CATEGORY(gui)";
+ *
+ * Define ATOOLS_LOG_MIN_LEVEL to remove messages at compile time:
+ * 0 = keep all (default), 1 = remove debug, 2 = remove debug and info, 3 = also remove warnings.
+ * Arguments of removed messages are still compiled but never evaluated.
+ */
+#ifndef ATOOLS_LOG_MIN_LEVEL
+#define ATOOLS_LOG_MIN_LEVEL 0
+#endif
+
+namespace atools {
+namespace logging {
+
+/* Category used by qDebug(), qInfo(), etc. for use with the category macros below */
+inline const QLoggingCategory& defaultCategory()
+{
+  return *QLoggingCategory::defaultCategory();
+}
+
+} // namespace logging
+} // namespace atools
+
+#if ATOOLS_LOG_MIN_LEVEL > 0
+#define ATOOLS_CDEBUG(category) while(false) qCDebug(category)
+#else
+#define ATOOLS_CDEBUG(category) qCDebug(category)
+#endif
+
+#if ATOOLS_LOG_MIN_LEVEL > 1
+#define ATOOLS_CINFO(category) while(false) qCInfo(category)
+#else
+#define ATOOLS_CINFO(category) qCInfo(category)
+#endif
+
+#if ATOOLS_LOG_MIN_LEVEL > 2
+#define ATOOLS_CWARNING(category) while(false) qCWarning(category)
+#else
+#define ATOOLS_CWARNING(category) qCWarning(category)
+#endif
+
+#define ATOOLS_DEBUG() ATOOLS_CDEBUG(atools::logging::defaultCategory)
+#define ATOOLS_INFO() ATOOLS_CINFO(atools::logging::defaultCategory)
+#define ATOOLS_WARNING() ATOOLS_CWARNING(atools::logging::defaultCategory)
+
+/* True if debug messages of the default category are written. Use to guard expensive preparation of messages. */
+#define ATOOLS_DEBUG_ENABLED() (ATOOLS_LOG_MIN_LEVEL < 1 && atools::logging::defaultCategory().isDebugEnabled())
+
+#endif // ATOOLS_LOGGING_LOGGINGMACROS_H
@@ -27,6 +27,8 @@ namespace atools {
 namespace logging {
 namespace internal {
 
+class BinaryLogEncoder;
+
 /* Common internal types for logging */
 
 /* Combines the file and use text stream which allows to exchange the file during logging. */
@@ -34,6 +36,8 @@ struct Channel
 {
   QTextStream *stream = nullptr;
   QFile *file = nullptr; /* Null if this channel is stdout or stderr */
+  BinaryLogEncoder *encoder = nullptr; /* Not null for binary file channels. Stream is null in this case. */
+  qint64 openedMs = 0; /* Time when file was opened in milliseconds since epoch for rolling by age */
 };
 
 typedef  QList<Channel *> ChannelList;
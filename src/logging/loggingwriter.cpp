@@ -0,0 +1,215 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "logging/loggingwriter.h"
+#include "logging/loggingconfig.h"
+
+#include <QTextStream>
+
+namespace atools {
+namespace logging {
+namespace internal {
+
+LoggingWriter::LoggingWriter(LoggingConfig *config, QMutex *streamMutex, int bufferSize, int flushIntervalMs)
+  : logConfig(config), mutex(streamMutex), flushInterval(flushIntervalMs), enqueuePos(0), writtenPos(0), stopped(false),
+  wakePending(false)
+{
+  setObjectName("LoggingWriter");
+
+  // Round up to power of two to allow masking instead of modulo
+  quint64 capacity = 1;
+  while(capacity < static_cast<quint64>(bufferSize))
+    capacity <<= 1;
+  mask = capacity - 1;
+
+  ring = new Slot[capacity];
+  for(quint64 i = 0; i < capacity; i++)
+    ring[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+LoggingWriter::~LoggingWriter()
+{
+  stop();
+  delete[] ring;
+}
+
+bool LoggingWriter::append(QtMsgType type, const QString& message, const ChannelList& channels)
+{
+  if(stopped.load(std::memory_order_acquire))
+    return false;
+
+  quint64 pos = enqueuePos.load(std::memory_order_relaxed);
+  while(true)
+  {
+    Slot& slot = ring[pos & mask];
+    qint64 diff = static_cast<qint64>(slot.sequence.load(std::memory_order_acquire)) - static_cast<qint64>(pos);
+
+    if(diff == 0)
+    {
+      // Slot is free - try to claim it
+      if(enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        break;
+    }
+    else if(diff < 0)
+    {
+      // Buffer is full - messages from the writer itself cannot wait for the writer
+      if(QThread::currentThread() == this)
+        return true;
+
+      wake();
+      QThread::yieldCurrentThread();
+
+      if(stopped.load(std::memory_order_acquire))
+        return false;
+      pos = enqueuePos.load(std::memory_order_relaxed);
+    }
+    else
+      // Claimed by another producer in the meantime
+      pos = enqueuePos.load(std::memory_order_relaxed);
+  }
+
+  Slot& slot = ring[pos & mask];
+  slot.message = message;
+  slot.channels = channels;
+
+  // Publish to writer thread
+  slot.sequence.store(pos + 1, std::memory_order_release);
+
+  // Write important messages immediately and avoid blocking producers on a full buffer
+  qint64 pending = static_cast<qint64>(pos + 1 - writtenPos.load(std::memory_order_relaxed));
+  if(type == QtWarningMsg || type == QtCriticalMsg || type == QtFatalMsg || pending > static_cast<qint64>(mask / 2))
+    wake();
+
+  return true;
+}
+
+void LoggingWriter::flush()
+{
+  if(QThread::currentThread() == this || !isRunning())
+    return;
+
+  quint64 target = enqueuePos.load(std::memory_order_acquire);
+  wake();
+
+  QMutexLocker locker(&wakeMutex);
+  while(writtenPos.load(std::memory_order_acquire) < target && isRunning())
+  {
+    // Wake up periodically in case a producer published its slot late
+    wakePending.store(true);
+    wakeCondition.wakeOne();
+    flushedCondition.wait(&wakeMutex, 100);
+  }
+}
+
+void LoggingWriter::stop()
+{
+  stopped.store(true, std::memory_order_release);
+  wake();
+
+  if(QThread::currentThread() != this)
+  {
+    wait();
+
+    // Catch messages of producers which passed the stopped check just before
+    writeBatch();
+  }
+}
+
+void LoggingWriter::wake()
+{
+  // Lock only if not already woken
+  if(!wakePending.exchange(true))
+  {
+    QMutexLocker locker(&wakeMutex);
+    wakeCondition.wakeOne();
+  }
+}
+
+void LoggingWriter::run()
+{
+  while(true)
+  {
+    {
+      QMutexLocker locker(&wakeMutex);
+      if(!wakePending.load() && !stopped.load())
+        wakeCondition.wait(&wakeMutex, static_cast<unsigned long>(flushInterval));
+      wakePending.store(false);
+    }
+
+    writeBatch();
+
+    if(stopped.load(std::memory_order_acquire))
+    {
+      // Write everything left over
+      while(writeBatch() > 0)
+        ;
+      break;
+    }
+  }
+}
+
+int LoggingWriter::writeBatch()
+{
+  ChannelList touched;
+  int num = 0;
+
+  {
+    QMutexLocker locker(mutex);
+
+    // Limit batch size to the buffer size to flush regularly on heavy load
+    while(static_cast<quint64>(num) <= mask)
+    {
+      Slot& slot = ring[dequeuePos & mask];
+      if(slot.sequence.load(std::memory_order_acquire) != dequeuePos + 1)
+        break;
+
+      for(Channel *channel : std::as_const(slot.channels))
+      {
+        (*channel->stream) << slot.message << '\n';
+        if(!touched.contains(channel))
+          touched.append(channel);
+      }
+
+      // Release memory and give slot back to producers
+      slot.message.clear();
+      slot.channels.clear();
+      slot.sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+      dequeuePos++;
+      num++;
+    }
+
+    // Flush and check file size once per batch instead of once per message
+    for(Channel *channel : std::as_const(touched))
+    {
+      channel->stream->flush();
+      logConfig->checkStreamSize(channel);
+    }
+
+    writtenPos.store(dequeuePos, std::memory_order_release);
+  }
+
+  if(num > 0)
+  {
+    QMutexLocker locker(&wakeMutex);
+    flushedCondition.wakeAll();
+  }
+  return num;
+}
+
+} // namespace internal
+} // namespace logging
+} // namespace atools
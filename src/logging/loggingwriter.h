@@ -0,0 +1,115 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_LOGGING_LOGGINGWRITER_H
+#define ATOOLS_LOGGING_LOGGINGWRITER_H
+
+#include "logging/loggingtypes.h"
+
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <atomic>
+
+namespace atools {
+namespace logging {
+namespace internal {
+
+class LoggingConfig;
+
+/*
+ * Writes log messages to the channels in a separate thread.
+ *
+ * Message handlers of all threads append messages to a bounded lock free ring buffer.
+ * The writer thread drains the buffer in batches and flushes the touched streams once per batch.
+ * This is done after the flush interval or earlier if a warning or worse arrives or the buffer gets half full.
+ *
+ * Producers wait for free space if the buffer is full. No messages are dropped except for messages created
+ * by the writer thread itself while the buffer is full.
+ */
+class LoggingWriter :
+  public QThread
+{
+public:
+  /*
+   * @param config Configuration providing checkStreamSize()
+   * @param streamMutex Locked while writing to the streams
+   * @param bufferSize Number of messages in ring buffer. Rounded up to power of two.
+   * @param flushIntervalMs Maximum time before messages are written to the streams
+   */
+  LoggingWriter(LoggingConfig *config, QMutex *streamMutex, int bufferSize, int flushIntervalMs);
+  virtual ~LoggingWriter() override;
+
+  LoggingWriter(const LoggingWriter& other) = delete;
+  LoggingWriter& operator=(const LoggingWriter& other) = delete;
+
+  /* Append message for writing to given channels. Thread safe and lock free unless buffer is full.
+   * Returns false if the writer is stopped and the caller has to write the message itself. */
+  bool append(QtMsgType type, const QString& message, const ChannelList& channels);
+
+  /* Wait until all messages appended before are written and flushed */
+  void flush();
+
+  /* Write all pending messages and stop the thread. Further append() calls return false. */
+  void stop();
+
+private:
+  /* One entry in the ring buffer. The sequence number synchronizes producers and writer thread. */
+  struct Slot
+  {
+    std::atomic<quint64> sequence;
+    QString message;
+    ChannelList channels;
+  };
+
+  virtual void run() override;
+
+  /* Write all available messages and flush streams. Returns number of messages written. Writer thread only. */
+  int writeBatch();
+
+  /* Wake up writer thread if it sleeps */
+  void wake();
+
+  LoggingConfig *logConfig;
+  QMutex *mutex;
+  int flushInterval;
+
+  Slot *ring;
+  quint64 mask;
+
+  /* Next position for producers */
+  std::atomic<quint64> enqueuePos;
+
+  /* Next position to read by writer thread */
+  quint64 dequeuePos = 0;
+
+  /* Number of messages written and flushed */
+  std::atomic<quint64> writtenPos;
+
+  std::atomic_bool stopped, wakePending;
+
+  /* Used for sleeping writer and waiting flush() callers only */
+  QMutex wakeMutex;
+  QWaitCondition wakeCondition, flushedCondition;
+};
+
+} // namespace internal
+} // namespace logging
+} // namespace atools
+
+#endif // ATOOLS_LOGGING_LOGGINGWRITER_H
@@ -21,6 +21,8 @@
 #include "routing/routenetworkloader.h"
 #include "atools.h"
 #include "geo/calculations.h"
+#include "logging/loggingmacros.h"
+#include "util/tracer.h"
 
 #include <QDateTime>
 #include <QElapsedTimer>
@@ -30,17 +32,22 @@ using atools::geo::Pos;
 namespace atools {
 namespace routing {
 
-template<typename TYPE>
-inline TYPE& at(TYPE *arr, int index)
+/* Convert node index to key for the heap and back */
+inline int toKey(int index)
 {
-  // Relies on RouteNetwork::DEPARTURE_NODE_INDEX and RouteNetwork::DESTINATION_NODE_INDEX
-  return arr[index + 3];
+  return index + 3;
+}
+
+inline int fromKey(int key)
+{
+  return key - 3;
 }
 
 RouteFinder::RouteFinder(RouteNetwork *routeNetwork)
-  : network(routeNetwork), openNodesHeap(10000)
+  : network(routeNetwork), openNodesHeap(10000), openNodesHeapBwd(10000)
 {
   successors.reserve(500);
+  touchedIndexes.reserve(10000);
 }
 
 RouteFinder::~RouteFinder()
@@ -51,37 +58,75 @@ RouteFinder::~RouteFinder()
 bool RouteFinder::calculateRoute(const atools::geo::Pos& from, const atools::geo::Pos& to, int flownAltitude,
                                  atools::routing::Modes mode)
 {
-  qDebug() << Q_FUNC_INFO << "from" << from << "to" << to << "altitude" << flownAltitude << "mode" << mode;
+  return calculateRouteInternal(from, to, flownAltitude, mode, nullptr);
+}
 
-  allocArrays();
+bool RouteFinder::calculateRouteInternal(const atools::geo::Pos& from, const atools::geo::Pos& to, int flownAltitude,
+                                         atools::routing::Modes mode, const atools::util::CancelToken *taskToken)
+{
+  // Task token is only valid while this search runs - reset it on return and on exceptions
+  struct TaskTokenGuard
+  {
+    ~TaskTokenGuard()
+    {
+      token = nullptr;
+    }
+
+    const atools::util::CancelToken *& token;
+  } taskTokenGuard{searchTaskToken};
+  searchTaskToken = taskToken;
+
+  ATOOLS_TRACE_SPAN("RouteFinder::calculateRoute");
+  ATOOLS_DEBUG() << Q_FUNC_INFO << "from" << from << "to" << to << "altitude" << flownAltitude << "mode" << mode;
 
   QElapsedTimer timer;
   timer.start();
 
+  statistics = RouteFinderStatistics();
+  bidirectional = mode.testFlag(MODE_BIDIRECTIONAL);
+  allocArrays();
+
   altitude = flownAltitude;
   network->setParameters(from, to, altitude, mode);
   startNode = network->getDepartureNode();
   destNode = network->getDestinationNode();
   totalDist = atools::roundToInt(network->getDirectDistanceMeter(startNode, destNode));
-  lastDist = totalDist;
+  lastDist = lastDistBwd = totalDist;
 
-  openNodesHeap.pushData(startNode.index, 0);
+  touch(startNode.index);
+  openNodesHeap.pushData(toKey(startNode.index), 0);
   at(nodeAltRangeMaxArr, startNode.index) = std::numeric_limits<quint16>::max();
 
   time = QDateTime::currentSecsSinceEpoch();
 
+  bool destinationFound = bidirectional ? searchBidirectional() : searchForward();
+
+  statistics.found = destinationFound;
+  statistics.totalTimeNs = timer.nsecsElapsed();
+  ATOOLS_DEBUG() << Q_FUNC_INFO << statistics;
+
+  return destinationFound;
+}
+
+QFuture<bool> RouteFinder::calculateRouteAsync(const atools::geo::Pos& from, const atools::geo::Pos& to, int flownAltitude,
+                                               atools::routing::Modes mode, const atools::util::CancelToken& token)
+{
+  auto task = [this, from, to, flownAltitude, mode](QPromise<bool>& promise, const atools::util::CancelToken& taskToken) -> void {
+    promise.addResult(calculateRouteInternal(from, to, flownAltitude, mode, &taskToken));
+  };
+  return atools::util::async::run<bool>(task, token);
+}
+
+bool RouteFinder::searchForward()
+{
   Node currentNode;
-  bool destinationFound = false;
   while(!openNodesHeap.isEmpty())
   {
     // Contains known nodes
-    int currentIndex = openNodesHeap.popData();
+    int currentIndex = fromKey(openNodesHeap.popData());
 
     if(currentIndex == destNode.index)
-    {
-      destinationFound = true;
-      break;
-    }
+      return true;
 
     currentNode = network->getNode(currentIndex);
 
@@ -91,32 +136,132 @@ bool RouteFinder::calculateRoute(const atools::geo::Pos& from, const atools::geo
 
     // Contains nodes with known shortest path
     at(closedNodes, currentNode.index) = true;
+    statistics.nodesExpanded++;
 
     // Work on successors
     if(!expandNode(currentNode, at(edgePredecessorArr, currentNode.index)))
       break;
   }
+  return false;
+}
 
-  qDebug() << Q_FUNC_INFO << "found" << destinationFound << "heap size" << openNodesHeap.size()
-           << timer.restart() << "ms";
+bool RouteFinder::searchBidirectional()
+{
+  touch(destNode.index);
+  openNodesHeapBwd.pushData(toKey(destNode.index), 0);
+  at(nodeAltRangeMaxBwdArr, destNode.index) = std::numeric_limits<quint16>::max();
+  meetIndex = -1;
+  meetCosts = std::numeric_limits<int>::max();
 
-  return destinationFound;
+  Node currentNode;
+  bool canceled = false;
+  while(!openNodesHeap.isEmpty() && !openNodesHeapBwd.isEmpty())
+  {
+    // Stop if the best path found so far cannot be improved by any of the searches
+    // since costs in heaps are a lower bound for all paths through the open nodes
+    if(openNodesHeap.topCost() >= meetCosts || openNodesHeapBwd.topCost() >= meetCosts)
+      break;
+
+    // Advance the search with the smaller open set to keep both balanced
+    bool reverse = openNodesHeapBwd.size() < openNodesHeap.size();
+    int currentIndex = fromKey(reverse ? openNodesHeapBwd.popData() : openNodesHeap.popData());
+    currentNode = network->getNode(currentIndex);
+
+    // Invoke user callback if set
+    if(!invokeCallback(currentNode, reverse))
+    {
+      canceled = true;
+      break;
+    }
+
+    statistics.nodesExpanded++;
+    if(reverse)
+    {
+      at(closedNodesBwd, currentIndex) = true;
+      canceled = !expandNodeReverse(currentNode, at(edgeSuccessorArr, currentIndex));
+    }
+    else
+    {
+      at(closedNodes, currentIndex) = true;
+      canceled = !expandNode(currentNode, at(edgePredecessorArr, currentIndex));
+    }
+
+    if(canceled)
+      break;
+  }
+
+  if(canceled || meetIndex == -1)
+    return false;
+
+  // Collect forward path to detect loops when joining
+  QSet<int> forwardPath;
+  for(int index = meetIndex; index != -1; index = at(nodePredecessorArr, index))
+    forwardPath.insert(index);
+
+  // Join both paths by copying the backward path from the meeting point into the forward predecessor arrays
+  // which allows to use extractLegs() unchanged
+  int index = meetIndex;
+  while(index != destNode.index)
+  {
+    int next = at(nodeSuccessorArr, index);
+    if(next == -1 || forwardPath.contains(next))
+    {
+      qWarning() << Q_FUNC_INFO << "Cannot join paths at" << meetIndex;
+      return false;
+    }
+
+    at(nodePredecessorArr, next) = index;
+    at(edgePredecessorArr, next) = at(edgeSuccessorArr, index);
+    index = next;
+  }
+  return true;
+}
+
+void RouteFinder::updateMeetingNode(int index)
+{
+  bool forwardReached = index == startNode.index || at(nodePredecessorArr, index) != -1;
+  bool backwardReached = index == destNode.index || at(nodeSuccessorArr, index) != -1;
+
+  if(forwardReached && backwardReached)
+  {
+    int costs = at(nodeCostArr, index) + at(nodeCostBwdArr, index);
+    if(costs < meetCosts)
+    {
+      // Both paths have to allow a common altitude
+      quint16 altRangeMin = at(nodeAltRangeMinArr, index);
+      quint16 altRangeMax = at(nodeAltRangeMaxArr, index);
+      if(combineRanges(altRangeMin, altRangeMax, at(nodeAltRangeMinBwdArr, index), at(nodeAltRangeMaxBwdArr, index)))
+      {
+        meetCosts = costs;
+        meetIndex = index;
+      }
+    }
+  }
 }
 
-bool RouteFinder::invokeCallback(const atools::routing::Node& currentNode)
+bool RouteFinder::invokeCallback(const atools::routing::Node& currentNode, bool reverse)
 {
+  if(cancelToken.isCanceled() || (searchTaskToken != nullptr && searchTaskToken->isCanceled()))
+    return false;
+
   if(callback)
   {
     qint64 now = QDateTime::currentMSecsSinceEpoch();
     // Check every half second
     if(now > time + 500)
     {
-      int dist = atools::roundToInt(network->getDirectDistanceMeter(currentNode, destNode));
-      if(dist < lastDist)
-        lastDist = dist;
+      int dist = atools::roundToInt(network->getDirectDistanceMeter(currentNode, reverse ? startNode : destNode));
+      if(reverse)
+        lastDistBwd = std::min(dist, lastDistBwd);
+      else
+        lastDist = std::min(dist, lastDist);
       time = now;
 
-      return callback(totalDist, lastDist);
+      if(bidirectional)
+        // Remaining distance is the gap between both search fronts
+        return callback(totalDist, std::max(lastDist + lastDistBwd - totalDist, 0));
+      else
+        return callback(totalDist, lastDist);
     }
   }
   return true;
@@ -124,9 +269,17 @@ bool RouteFinder::invokeCallback(const atools::routing::Node& currentNode)
 
 bool RouteFinder::expandNode(const atools::routing::Node& currentNode, const atools::routing::Edge& prevEdge)
 {
+  QElapsedTimer timer;
+  if(collectTimings)
+    timer.start();
+
   successors.clear();
   network->getNeighbours(successors, currentNode, &prevEdge);
 
+  if(collectTimings)
+    statistics.neighboursTimeNs += timer.nsecsElapsed();
+  statistics.edgesScanned += successors.size();
+
   quint32 currentEdgeAirwayHash = 0;
   if(network->isAirwayRouting())
     currentEdgeAirwayHash = at(edgeNameHashArr, currentNode.index);
@@ -146,13 +299,17 @@ bool RouteFinder::expandNode(const atools::routing::Node& currentNode, const ato
     if(!invokeCallback(successor))
       return false;
 
+    if(collectTimings)
+      timer.start();
     int successorEdgeCosts = calculateEdgeCost(currentNode, successor, edge, currentEdgeAirwayHash);
+    if(collectTimings)
+      statistics.costTimeNs += timer.nsecsElapsed();
 
     int successorNodeCosts = at(nodeCostArr, currentNode.index) + successorEdgeCosts;
     bool contains = true;
     if(successorNodeCosts >= at(nodeCostArr, successorIndex))
     {
-      contains = openNodesHeap.contains(successorIndex);
+      contains = openNodesHeap.contains(toKey(successorIndex));
       if(contains)
         // New path is not cheaper
         continue;
@@ -165,6 +322,7 @@ bool RouteFinder::expandNode(const atools::routing::Node& currentNode, const ato
       continue;
 
     // New path is cheaper - update node
+    touch(successorIndex);
     at(edgePredecessorArr, successorIndex) = successors.edges.at(i);
     if(network->isAirwayRouting())
       at(edgeNameHashArr, successorIndex) = successors.edges.at(i).airwayHash;
@@ -173,15 +331,121 @@ bool RouteFinder::expandNode(const atools::routing::Node& currentNode, const ato
     at(nodeAltRangeMinArr, successorIndex) = successorNodeAltRangeMin;
     at(nodeAltRangeMaxArr, successorIndex) = successorNodeAltRangeMax;
 
+    if(bidirectional)
+      updateMeetingNode(successorIndex);
+
     // Costs from start to successor + estimate to destination = sort order in heap
-    int totalCost = successorNodeCosts + static_cast<int>(network->getGcDistanceMeter(successor, destNode));
+    if(collectTimings)
+      timer.start();
+    int totalCost = successorNodeCosts +
+                    static_cast<int>(network->getHeuristicDistanceMeter(successor, false /* reverse */));
+    if(collectTimings)
+      statistics.costTimeNs += timer.nsecsElapsed();
+    statistics.edgesRelaxed++;
+
+    int key = toKey(successorIndex);
+    if(contains && openNodesHeap.contains(key))
+    {
+      // Update node and resort heap
+      openNodesHeap.change(key, totalCost);
+      statistics.decreaseKeys++;
+    }
+    else
+      openNodesHeap.push(key, totalCost);
+  }
+
+  statistics.maxOpenNodes = std::max(statistics.maxOpenNodes, openNodesHeap.size() + openNodesHeapBwd.size());
+  return true;
+}
+
+bool RouteFinder::expandNodeReverse(const atools::routing::Node& currentNode, const atools::routing::Edge& nextEdge)
+{
+  QElapsedTimer timer;
+  if(collectTimings)
+    timer.start();
+
+  successors.clear();
+  network->getNeighboursReverse(successors, currentNode, &nextEdge);
+
+  if(collectTimings)
+    statistics.neighboursTimeNs += timer.nsecsElapsed();
+  statistics.edgesScanned += successors.size();
+
+  quint32 currentEdgeAirwayHash = 0;
+  if(network->isAirwayRouting())
+    currentEdgeAirwayHash = at(edgeNameHashBwdArr, currentNode.index);
+
+  for(int i = 0; i < successors.nodes.size(); i++)
+  {
+    // Predecessor in flight direction
+    int predecessorIndex = successors.nodes.at(i);
+
+    if(at(closedNodesBwd, predecessorIndex))
+      // Already has a shortest path to destination
+      continue;
+
+    const Node& predecessor = network->getNode(predecessorIndex);
+    const Edge& edge = successors.edges.at(i);
+
+    // Invoke user callback if set
+    if(!invokeCallback(predecessor, true /* reverse */))
+      return false;
+
+    // Edge runs from predecessor to current node in flight direction
+    if(collectTimings)
+      timer.start();
+    int predecessorEdgeCosts = calculateEdgeCost(predecessor, currentNode, edge, currentEdgeAirwayHash);
+    if(collectTimings)
+      statistics.costTimeNs += timer.nsecsElapsed();
+
+    int predecessorNodeCosts = at(nodeCostBwdArr, currentNode.index) + predecessorEdgeCosts;
+    bool contains = true;
+    if(predecessorNodeCosts >= at(nodeCostBwdArr, predecessorIndex))
+    {
+      contains = openNodesHeapBwd.contains(toKey(predecessorIndex));
+      if(contains)
+        // New path is not cheaper
+        continue;
+    }
+
+    quint16 predecessorNodeAltRangeMin = at(nodeAltRangeMinBwdArr, currentNode.index);
+    quint16 predecessorNodeAltRangeMax = at(nodeAltRangeMaxBwdArr, currentNode.index);
 
-    if(contains)
-      // Update node and resort heap or add node if not exists
-      openNodesHeap.changeOrPush(successorIndex, totalCost);
+    if(!combineRanges(predecessorNodeAltRangeMin, predecessorNodeAltRangeMax, edge.minAltFt, edge.maxAltFt))
+      continue;
+
+    // New path is cheaper - update node
+    touch(predecessorIndex);
+    at(edgeSuccessorArr, predecessorIndex) = edge;
+    if(network->isAirwayRouting())
+      at(edgeNameHashBwdArr, predecessorIndex) = edge.airwayHash;
+    at(nodeSuccessorArr, predecessorIndex) = currentNode.index;
+    at(nodeCostBwdArr, predecessorIndex) = predecessorNodeCosts;
+    at(nodeAltRangeMinBwdArr, predecessorIndex) = predecessorNodeAltRangeMin;
+    at(nodeAltRangeMaxBwdArr, predecessorIndex) = predecessorNodeAltRangeMax;
+
+    updateMeetingNode(predecessorIndex);
+
+    // Costs from predecessor to destination + estimate to departure = sort order in heap
+    if(collectTimings)
+      timer.start();
+    int totalCost = predecessorNodeCosts +
+                    static_cast<int>(network->getHeuristicDistanceMeter(predecessor, true /* reverse */));
+    if(collectTimings)
+      statistics.costTimeNs += timer.nsecsElapsed();
+    statistics.edgesRelaxed++;
+
+    int key = toKey(predecessorIndex);
+    if(contains && openNodesHeapBwd.contains(key))
+    {
+      openNodesHeapBwd.change(key, totalCost);
+      statistics.decreaseKeys++;
+    }
     else
-      openNodesHeap.push(successorIndex, totalCost);
+      openNodesHeapBwd.push(key, totalCost);
   }
+
+  statistics.maxOpenNodes = std::max(statistics.maxOpenNodes, openNodesHeap.size() + openNodesHeapBwd.size());
   return true;
 }
 
@@ -277,18 +541,85 @@ void RouteFinder::extractLegs(QList<RouteLeg>& routeLegs, float& distanceMeter)
 
 void RouteFinder::allocArrays()
 {
-  freeArrays();
   // Reserve space at beginning for start and destination node
   // Relies on RouteNetwork::DEPARTURE_NODE_INDEX and RouteNetwork::DESTINATION_NODE_INDEX
-  int num = network->getNodes().size() + 3;
-
-  edgeNameHashArr = atools::allocArray<quint32>(num);
-  nodeCostArr = atools::allocArray<int>(num);
-  nodeAltRangeMinArr = atools::allocArray<quint16>(num);
-  nodeAltRangeMaxArr = atools::allocArray<quint16>(num);
-  nodePredecessorArr = atools::allocArray<int>(num, -1);
-  edgePredecessorArr = atools::allocArray<Edge>(num, Edge());
-  closedNodes = atools::allocArray<bool>(num);
+  int num = network->getNumNodes() + 3;
+
+  if(num != numArrayNodes)
+  {
+    // Network changed or first call - allocate arrays for all nodes
+    freeArrays();
+    numArrayNodes = num;
+
+    edgeNameHashArr = atools::allocArray<quint32>(num);
+    nodeCostArr = atools::allocArray<int>(num);
+    nodeAltRangeMinArr = atools::allocArray<quint16>(num);
+    nodeAltRangeMaxArr = atools::allocArray<quint16>(num);
+    nodePredecessorArr = atools::allocArray<int>(num, -1);
+    edgePredecessorArr = atools::allocArray<Edge>(num, Edge());
+    closedNodes = atools::allocArray<bool>(num);
+    nodeGenerationArr = atools::allocArray<quint32>(num);
+    generation = 1;
+  }
+  else
+    // Reuse arrays from last search and reset only entries which were changed
+    resetArrays();
+
+  // Allocate backward arrays on first use and keep them
+  if(bidirectional && nodeCostBwdArr == nullptr)
+  {
+    edgeNameHashBwdArr = atools::allocArray<quint32>(num);
+    nodeCostBwdArr = atools::allocArray<int>(num);
+    nodeAltRangeMinBwdArr = atools::allocArray<quint16>(num);
+    nodeAltRangeMaxBwdArr = atools::allocArray<quint16>(num);
+    nodeSuccessorArr = atools::allocArray<int>(num, -1);
+    edgeSuccessorArr = atools::allocArray<Edge>(num, Edge());
+    closedNodesBwd = atools::allocArray<bool>(num);
+  }
+
+  openNodesHeap.clear(num);
+
+  // Clear also if not used to get correct size in logging
+  openNodesHeapBwd.clear(nodeCostBwdArr != nullptr ? num : 0);
+
+  // Name hash, costs, altitude range, predecessor, edge, closed flag and heap key to slot map
+  qint64 bytesPerNode = sizeof(quint32) + sizeof(int) + 2 * sizeof(quint16) + sizeof(int) + sizeof(Edge) +
+                        sizeof(bool) + sizeof(int);
+  statistics.arrayMemoryBytes = num * (bytesPerNode * (nodeCostBwdArr != nullptr ? 2 : 1) + sizeof(quint32));
+}
+
+void RouteFinder::resetArrays()
+{
+  for(int index : std::as_const(touchedIndexes))
+  {
+    at(edgeNameHashArr, index) = 0;
+    at(nodeCostArr, index) = 0;
+    at(nodeAltRangeMinArr, index) = 0;
+    at(nodeAltRangeMaxArr, index) = 0;
+    at(nodePredecessorArr, index) = -1;
+    at(edgePredecessorArr, index) = Edge();
+    at(closedNodes, index) = false;
+
+    if(nodeCostBwdArr != nullptr)
+    {
+      at(edgeNameHashBwdArr, index) = 0;
+      at(nodeCostBwdArr, index) = 0;
+      at(nodeAltRangeMinBwdArr, index) = 0;
+      at(nodeAltRangeMaxBwdArr, index) = 0;
+      at(nodeSuccessorArr, index) = -1;
+      at(edgeSuccessorArr, index) = Edge();
+      at(closedNodesBwd, index) = false;
+    }
+  }
+  touchedIndexes.clear();
+
+  // Start new generation and clear generation array on overflow
+  generation++;
+  if(generation == 0)
+  {
+    memset(nodeGenerationArr, 0, sizeof(nodeGenerationArr[0]) * static_cast<size_t>(numArrayNodes));
+    generation = 1;
+  }
 }
 
 void RouteFinder::freeArrays()
@@ -300,6 +631,37 @@ void RouteFinder::freeArrays()
   atools::freeArray(nodePredecessorArr);
   atools::freeArray(edgePredecessorArr);
   atools::freeArray(closedNodes);
+  atools::freeArray(nodeGenerationArr);
+
+  atools::freeArray(edgeNameHashBwdArr);
+  atools::freeArray(nodeCostBwdArr);
+  atools::freeArray(nodeAltRangeMinBwdArr);
+  atools::freeArray(nodeAltRangeMaxBwdArr);
+  atools::freeArray(nodeSuccessorArr);
+  atools::freeArray(edgeSuccessorArr);
+  atools::freeArray(closedNodesBwd);
+
+  touchedIndexes.clear();
+  numArrayNodes = 0;
+}
+
+QDebug operator<<(QDebug out, const RouteFinderStatistics& obj)
+{
+  QDebugStateSaver saver(out);
+
+  out.nospace().noquote() << "RouteFinderStatistics("
+                          << "found " << obj.found
+                          << ", nodes expanded " << obj.nodesExpanded
+                          << ", edges scanned " << obj.edgesScanned
+                          << ", edges relaxed " << obj.edgesRelaxed
+                          << ", decrease keys " << obj.decreaseKeys
+                          << ", max open nodes " << obj.maxOpenNodes
+                          << ", total " << obj.totalTimeNs / 1000000.f << " ms"
+                          << ", neighbours " << obj.neighboursTimeNs / 1000000.f << " ms"
+                          << ", costs " << obj.costTimeNs / 1000000.f << " ms"
+                          << ", array memory " << obj.arrayMemoryBytes / 1024 << " kB"
+                          << ")";
+  return out;
 }
 
 QDebug operator<<(QDebug out, const RouteLeg& obj)
@@ -18,7 +18,8 @@
 #ifndef ATOOLS_ROUTEFINDER_H
 #define ATOOLS_ROUTEFINDER_H
 
-#include "util/heap.h"
+#include "util/asynctask.h"
+#include "util/indexedheap.h"
 #include "routing/routenetworktypes.h"
 
 namespace atools {
@@ -37,10 +38,33 @@ struct RouteLeg
 
 };
 
+/* Counters and timings collected for each call of RouteFinder::calculateRoute() */
+struct RouteFinderStatistics
+{
+  bool found = false; /* Route found */
+  int nodesExpanded = 0, /* Nodes taken from open set for both directions */
+      edgesScanned = 0, /* Edges returned by the network for expanded nodes */
+      edgesRelaxed = 0, /* Edges which resulted in a cheaper path to a node */
+      decreaseKeys = 0, /* Cost updates of nodes already in the open set */
+      maxOpenNodes = 0; /* Maximum size of open set summed up for both directions */
+
+  /* Detailed timings are only collected if enabled by RouteFinder::setCollectTimings() and are 0 otherwise */
+  qint64 totalTimeNs = 0L, /* Whole search including setup. Always collected. */
+         neighboursTimeNs = 0L, /* Time spent in RouteNetwork::getNeighbours() */
+         costTimeNs = 0L; /* Time spent in edge cost and heuristic calculation */
+
+  qint64 arrayMemoryBytes = 0L; /* Memory used by per search arrays and heaps */
+
+  friend QDebug operator<<(QDebug out, const atools::routing::RouteFinderStatistics& obj);
+};
+
 /*
  * Calculates flight plans within a route network which can be an airway or radio navaid network.
  * Uses A* algorithm and several cost factor adjustments to get reasonable routes.
  *
+ * A bidirectional A* searching from departure and destination at the same time is used if
+ * mode MODE_BIDIRECTIONAL is set.
+ *
  * The class has a state (i.e. start and destination) and is not re-entrant.
  */
 class RouteFinder
@@ -56,10 +80,17 @@ public:
    * @param from departure position
    * @param to destination position
    * @param flownAltitude create a flight plan using airways for the given altitude. Set to 0 to ignore.
+   * @param mode network filter. Add MODE_BIDIRECTIONAL to search from both ends.
    * @return true if a route was found and callback did not cancel
    */
   bool calculateRoute(const atools::geo::Pos& from, const atools::geo::Pos& to, int flownAltitude, Modes mode);
 
+  /* Runs calculateRoute() on the shared thread pool of atools::util::async and returns its result in the future.
+   * Canceling the future or token stops the search as does the token set by setCancelToken().
+   * Do not use this object until the future is finished. */
+  QFuture<bool> calculateRouteAsync(const atools::geo::Pos& from, const atools::geo::Pos& to, int flownAltitude, Modes mode,
+                                    const atools::util::CancelToken& token = atools::util::CancelToken());
+
   /* Extract legs of shortest route and distance not including departure and destination. */
   void extractLegs(QList<RouteLeg>& routeLegs, float& distanceMeter) const;
 
@@ -68,6 +99,19 @@ public:
     return network;
   }
 
+  /* Statistics of the last calculateRoute() call */
+  const atools::routing::RouteFinderStatistics& getStatistics() const
+  {
+    return statistics;
+  }
+
+  /* Measure time spent in neighbour search and cost calculation for each node and edge in statistics.
+   * Off by default since it adds clock reads to the inner search loop. */
+  void setCollectTimings(bool value)
+  {
+    collectTimings = value;
+  }
+
   /* Callback for progress reporting. distToDest is the direct euclidian distance in 3D space between
    * departure and destination. curDistToDest is the direct euclidian distance in 3D space of
    * the current node processed to the destination.
@@ -79,15 +123,38 @@ public:
     callback = progressCallback;
   }
 
+  /* Search stops and calculateRoute() returns false once the token is canceled. Checked for each expanded node. */
+  void setCancelToken(const atools::util::CancelToken& token)
+  {
+    cancelToken = token;
+  }
+
   void setCostFactorForceAirways(float value)
   {
     costFactorForceAirways = value;
   }
 
 private:
+  /* Implements calculateRoute(). The search is also stopped if the optional taskToken is canceled. */
+  bool calculateRouteInternal(const atools::geo::Pos& from, const atools::geo::Pos& to, int flownAltitude, Modes mode,
+                              const atools::util::CancelToken *taskToken);
+
+  /* Run forward search from departure to destination */
+  bool searchForward();
+
+  /* Run forward and backward search simultaneously and fill predecessor arrays
+   * of forward search from meeting point */
+  bool searchBidirectional();
+
   /* Expands a node by investigating all successors */
   bool expandNode(const atools::routing::Node& node, const Edge& prevEdge);
 
+  /* Expands a node in backward search by investigating all predecessors. nextEdge leads to destination. */
+  bool expandNodeReverse(const atools::routing::Node& node, const Edge& nextEdge);
+
+  /* Check if node is reached by both searches and remember it as meeting node if path costs are lower */
+  void updateMeetingNode(int index);
+
   /* Calculates the costs to travel from current to successor. Base is the distance between the nodes in meter that
    * will have several factors applied to get reasonable routes */
   int calculateEdgeCost(const atools::routing::Node& node, const atools::routing::Node& successorNode,
@@ -103,9 +170,33 @@ private:
     return true;
   }
 
+  /* Arrays are kept between searches and only reallocated if the number of network nodes changes */
   void freeArrays();
   void allocArrays();
-  bool invokeCallback(const Node& currentNode);
+
+  /* Reset all array entries changed in the last search to defaults */
+  void resetArrays();
+
+  /* Remember node index as changed for resetArrays(). Call before writing any array entry. */
+  void touch(int index)
+  {
+    quint32& gen = at(nodeGenerationArr, index);
+    if(gen != generation)
+    {
+      gen = generation;
+      touchedIndexes.append(index);
+    }
+  }
+
+  template<typename TYPE>
+  static TYPE& at(TYPE *arr, int index)
+  {
+    // Relies on RouteNetwork::DEPARTURE_NODE_INDEX and RouteNetwork::DESTINATION_NODE_INDEX
+    return arr[index + 3];
+  }
+
+  /* reverse is true if node is from backward search */
+  bool invokeCallback(const Node& currentNode, bool reverse = false);
 
   /* Avoid direct waypoint connections when using airways */
   float costFactorForceAirways = 1.3f;
@@ -140,8 +231,9 @@ private:
   atools::routing::RouteNetwork *network;
 
   /* Heap structure storing the index of open nodes. Costs are based on meters plus factors as integer.
-   * Sort order is defined by costs from start to node + estimate to destination */
-  atools::util::Heap<int, int> openNodesHeap;
+   * Sort order is defined by costs from start to node + estimate to destination.
+   * Keys are node indexes shifted by three like the arrays below. */
+  atools::util::IndexedHeap<int> openNodesHeap;
 
   /* Using plain arrays below to speed up access compared to hash tables
    * Positions 0 and 1 are reserved for departure and destination. 2 is invalid.
@@ -167,16 +259,53 @@ private:
   /* Airway name hash value for edge at index */
   quint32 *edgeNameHashArr = nullptr;
 
+  /* Search generation which touched the node last */
+  quint32 *nodeGenerationArr = nullptr;
+  quint32 generation = 1;
+
+  /* Node indexes changed in the current search */
+  QList<int> touchedIndexes;
+
+  /* Size of all arrays or 0 if not allocated */
+  int numArrayNodes = 0;
+
+  /* Same as above for backward search. Only allocated in bidirectional mode. ================== */
+  atools::util::IndexedHeap<int> openNodesHeapBwd;
+  bool *closedNodesBwd = nullptr;
+
+  /* Costs from node to destination */
+  int *nodeCostBwdArr = nullptr;
+  quint16 *nodeAltRangeMinBwdArr = nullptr;
+  quint16 *nodeAltRangeMaxBwdArr = nullptr;
+
+  /* Maps node index to successor node id towards destination */
+  int *nodeSuccessorArr = nullptr;
+
+  /* Maps node index to edge leading to successor */
+  atools::routing::Edge *edgeSuccessorArr = nullptr;
+  quint32 *edgeNameHashBwdArr = nullptr;
+
+  /* Node where both searches met with lowest total costs or -1 */
+  int meetIndex = -1;
+  int meetCosts = std::numeric_limits<int>::max();
+
   atools::routing::Node startNode, destNode;
 
   /* For RouteNetwork::getNeighbours to avoid instantiations */
   atools::routing::Result successors;
 
   RouteFinderCallbackType callback;
+  atools::util::CancelToken cancelToken;
+
+  /* Token of the asynchronous task running the current search or null. Only set during a search. */
+  const atools::util::CancelToken *searchTaskToken = nullptr;
   int totalDist = 0;
-  int lastDist = 0;
+  int lastDist = 0, lastDistBwd = 0;
+  bool bidirectional = false, collectTimings = false;
   qint64 time = 0L;
 
+  atools::routing::RouteFinderStatistics statistics;
+
 };
 
 } // namespace route
@@ -0,0 +1,88 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "routing/routefinderbatch.h"
+
+#include "routing/routenetwork.h"
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QThreadPool>
+
+namespace atools {
+namespace routing {
+
+RouteFinderBatch::RouteFinderBatch(const RouteNetwork *routeNetwork, int numThreads)
+  : network(routeNetwork), numThreads(numThreads > 0 ? numThreads : QThread::idealThreadCount())
+{
+}
+
+RouteFinderBatch::~RouteFinderBatch()
+{
+}
+
+QList<RouteFinderResult> RouteFinderBatch::calculateRoutes(const QList<RouteFinderJob>& jobs)
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  QList<RouteFinderResult> results(jobs.size());
+  if(jobs.isEmpty())
+    return results;
+
+  // Get pointer before starting threads to avoid any detach
+  RouteFinderResult *resultData = results.data();
+
+  // Index of the next job to take
+  QAtomicInt nextJob(0);
+
+  QThreadPool pool;
+  int threads = std::min(numThreads, static_cast<int>(jobs.size()));
+  pool.setMaxThreadCount(threads);
+
+  for(int t = 0; t < threads; t++)
+  {
+    pool.start([this, &jobs, &nextJob, resultData]() -> void {
+      // Per thread state - network with own query parameters and finder with own arrays
+      QScopedPointer<RouteNetwork> queryNetwork(network->createQueryNetwork());
+      RouteFinder finder(queryNetwork.data());
+      finder.setCostFactorForceAirways(costFactorForceAirways);
+
+      int index;
+      while((index = nextJob.fetchAndAddRelaxed(1)) < jobs.size())
+      {
+        const RouteFinderJob& job = jobs.at(index);
+        RouteFinderResult& result = resultData[index];
+
+        result.found = finder.calculateRoute(job.from, job.to, job.flownAltitude, job.mode);
+        if(result.found)
+          finder.extractLegs(result.legs, result.distanceMeter);
+        result.statistics = finder.getStatistics();
+      }
+    });
+  }
+
+  pool.waitForDone();
+
+  qDebug() << Q_FUNC_INFO << "jobs" << jobs.size() << "threads" << threads << timer.elapsed() << "ms";
+
+  return results;
+}
+
+} // namespace routing
+} // namespace atools
@@ -0,0 +1,82 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_ROUTEFINDERBATCH_H
+#define ATOOLS_ROUTEFINDERBATCH_H
+
+#include "routing/routefinder.h"
+
+namespace atools {
+namespace routing {
+
+/* Single route calculation job as used by RouteFinderBatch */
+struct RouteFinderJob
+{
+  atools::geo::Pos from, to;
+  int flownAltitude = 0; /* Altitude in ft or 0 to ignore */
+  atools::routing::Modes mode = atools::routing::MODE_ALL;
+};
+
+/* Result for a RouteFinderJob */
+struct RouteFinderResult
+{
+  bool found = false; /* true if a route was found */
+  QList<atools::routing::RouteLeg> legs; /* Legs not including departure and destination */
+  float distanceMeter = 0.f;
+  atools::routing::RouteFinderStatistics statistics;
+};
+
+/*
+ * Calculates a list of routes concurrently using a thread pool.
+ *
+ * Each thread uses its own RouteFinder and a query copy of the network which shares the loaded data.
+ * The network must not be changed or reloaded while calculateRoutes() is running.
+ */
+class RouteFinderBatch
+{
+public:
+  /* Uses a thread count as given by QThread::idealThreadCount() if numThreads is <= 0 */
+  RouteFinderBatch(const RouteNetwork *routeNetwork, int numThreads = 0);
+  virtual ~RouteFinderBatch();
+
+  RouteFinderBatch(const RouteFinderBatch& other) = delete;
+  RouteFinderBatch& operator=(const RouteFinderBatch& other) = delete;
+
+  /* Calculate all routes and return results in the same order as jobs. Blocks until all jobs are done. */
+  QList<atools::routing::RouteFinderResult> calculateRoutes(const QList<atools::routing::RouteFinderJob>& jobs);
+
+  /* Passed to each RouteFinder */
+  void setCostFactorForceAirways(float value)
+  {
+    costFactorForceAirways = value;
+  }
+
+  int getNumThreads() const
+  {
+    return numThreads;
+  }
+
+private:
+  const atools::routing::RouteNetwork *network;
+  int numThreads;
+  float costFactorForceAirways = 1.3f;
+};
+
+} // namespace routing
+} // namespace atools
+
+#endif // ATOOLS_ROUTEFINDERBATCH_H
@@ -0,0 +1,230 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "routing/routefinderbenchmark.h"
+
+#include "routing/routefinder.h"
+#include "routing/routenetwork.h"
+#include "geo/calculations.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QScopedPointer>
+#include <QStringList>
+
+#include <algorithm>
+#include <cmath>
+
+namespace atools {
+namespace routing {
+
+/* Increment if the catalog or result format changes to avoid comparing different runs */
+static const int BENCHMARK_VERSION = 1;
+
+/* Mode as text like "VICTOR|JET|WAYPOINT" */
+static QString modeName(Modes mode)
+{
+  static const QList<std::pair<Mode, QString> > NAMES = {
+    {MODE_RADIONAV_VOR, "VOR"}, {MODE_RADIONAV_NDB, "NDB"}, {MODE_WAYPOINT, "WAYPOINT"}, {MODE_VICTOR, "VICTOR"},
+    {MODE_JET, "JET"}, {MODE_NO_RNAV, "NO_RNAV"}, {MODE_TRACK, "TRACK"}, {MODE_BIDIRECTIONAL, "BIDIRECTIONAL"}
+  };
+
+  QStringList names;
+  for(const std::pair<Mode, QString>& name : NAMES)
+  {
+    if(mode.testFlag(name.first))
+      names.append(name.second);
+  }
+  return names.join('|');
+}
+
+RouteFinderBenchmark::RouteFinderBenchmark(const RouteNetwork *routeNetwork)
+  : network(routeNetwork)
+{
+}
+
+RouteFinderBenchmark::~RouteFinderBenchmark()
+{
+}
+
+const QList<RouteBenchmarkPair>& RouteFinderBenchmark::getDefaultPairs()
+{
+  // Airport reference points. Short, medium, long and oceanic routes on all continents.
+  static const QList<RouteBenchmarkPair> PAIRS = {
+    {"EDDM-LOWW", atools::geo::Pos(11.7861f, 48.3538f), atools::geo::Pos(16.5697f, 48.1103f)},
+    {"LFPG-EGLL", atools::geo::Pos(2.5479f, 49.0097f), atools::geo::Pos(-0.4614f, 51.4775f)},
+    {"EDDF-LEMD", atools::geo::Pos(8.5706f, 50.0333f), atools::geo::Pos(-3.5676f, 40.4719f)},
+    {"ESSA-LIRF", atools::geo::Pos(17.9186f, 59.6519f), atools::geo::Pos(12.2389f, 41.8003f)},
+    {"KORD-CYYZ", atools::geo::Pos(-87.9048f, 41.9786f), atools::geo::Pos(-79.6306f, 43.6772f)},
+    {"KJFK-KLAX", atools::geo::Pos(-73.7789f, 40.6398f), atools::geo::Pos(-118.4085f, 33.9425f)},
+    {"KSEA-KMIA", atools::geo::Pos(-122.3088f, 47.4502f), atools::geo::Pos(-80.2906f, 25.7932f)},
+    {"EGLL-KJFK", atools::geo::Pos(-0.4614f, 51.4775f), atools::geo::Pos(-73.7789f, 40.6398f)},
+    {"RJTT-RKSI", atools::geo::Pos(139.7811f, 35.5533f), atools::geo::Pos(126.4505f, 37.4691f)},
+    {"ZBAA-ZSPD", atools::geo::Pos(116.5975f, 40.0725f), atools::geo::Pos(121.8052f, 31.1434f)},
+    {"OMDB-VIDP", atools::geo::Pos(55.3644f, 25.2528f), atools::geo::Pos(77.1031f, 28.5665f)},
+    {"YSSY-YMML", atools::geo::Pos(151.1772f, -33.9461f), atools::geo::Pos(144.8433f, -37.6733f)},
+    {"SBGR-SCEL", atools::geo::Pos(-46.4731f, -23.4356f), atools::geo::Pos(-70.7858f, -33.3930f)}
+  };
+  return PAIRS;
+}
+
+QList<Modes> RouteFinderBenchmark::getModes(DataSource source)
+{
+  QList<Modes> baseModes;
+  if(source == SOURCE_RADIO)
+    baseModes = {MODE_RADIONAV_VOR, MODE_RADIONAV};
+  else if(source == SOURCE_AIRWAY)
+    baseModes = {MODE_VICTOR, MODE_JET, MODE_AIRWAY, MODE_WAYPOINT, MODE_AIRWAY_WAYPOINT, MODE_AIRWAY_TRACK,
+                 MODE_AIRWAY_WAYPOINT_TRACK, MODE_AIRWAY | MODE_NO_RNAV};
+
+  QList<Modes> modes;
+  for(Modes mode : std::as_const(baseModes))
+    modes << mode << (mode | MODE_BIDIRECTIONAL);
+  return modes;
+}
+
+double RouteFinderBenchmark::percentile(const QList<double>& sortedValues, double percent)
+{
+  if(sortedValues.isEmpty())
+    return 0.;
+
+  int index = static_cast<int>(std::ceil(percent / 100. * static_cast<double>(sortedValues.size()))) - 1;
+  return sortedValues.at(std::clamp(index, 0, static_cast<int>(sortedValues.size()) - 1));
+}
+
+QJsonObject RouteFinderBenchmark::latencyObject(QList<double> latenciesMs)
+{
+  std::sort(latenciesMs.begin(), latenciesMs.end());
+
+  QJsonObject obj;
+  obj.insert("p50_ms", percentile(latenciesMs, 50.));
+  obj.insert("p90_ms", percentile(latenciesMs, 90.));
+  obj.insert("p99_ms", percentile(latenciesMs, 99.));
+  obj.insert("max_ms", latenciesMs.isEmpty() ? 0. : latenciesMs.constLast());
+  return obj;
+}
+
+void RouteFinderBenchmark::run()
+{
+  DataSource source = network->isAirwayRouting() ? SOURCE_AIRWAY : (network->isRadionavRouting() ? SOURCE_RADIO : SOURCE_NONE);
+  const QList<Modes> modes = getModes(source);
+  const QList<RouteBenchmarkPair>& pairs = getDefaultPairs();
+
+  qInfo() << Q_FUNC_INFO << "Running" << pairs.size() * modes.size() * altitudes.size() << "queries with"
+          << repetitions << "repetitions";
+
+  QElapsedTimer totalTimer;
+  totalTimer.start();
+
+  // Query network keeps the loaded network unchanged
+  QScopedPointer<RouteNetwork> queryNetwork(network->createQueryNetwork());
+  RouteFinder finder(queryNetwork.data());
+
+  QJsonArray queries;
+  QList<QList<double> > modeLatencies(modes.size());
+  QList<double> allLatencies;
+  qint64 maxArrayMemory = 0L;
+
+  for(const RouteBenchmarkPair& pair : pairs)
+  {
+    for(int modeIndex = 0; modeIndex < modes.size(); modeIndex++)
+    {
+      Modes mode = modes.at(modeIndex);
+      for(int altitude : std::as_const(altitudes))
+      {
+        QList<double> latencies;
+        bool found = false;
+        RouteFinderStatistics statistics;
+
+        for(int i = 0; i < repetitions; i++)
+        {
+          QElapsedTimer timer;
+          timer.start();
+          found = finder.calculateRoute(pair.from, pair.to, altitude, mode);
+          latencies.append(static_cast<double>(timer.nsecsElapsed()) / 1000000.);
+          statistics = finder.getStatistics();
+        }
+
+        QList<RouteLeg> legs;
+        float distanceMeter = 0.f;
+        if(found)
+          finder.extractLegs(legs, distanceMeter);
+
+        QJsonObject query;
+        query.insert("pair", pair.name);
+        query.insert("mode", modeName(mode));
+        query.insert("altitude_ft", altitude);
+        query.insert("found", found);
+        query.insert("legs", static_cast<int>(legs.size()));
+        query.insert("distance_nm", std::round(atools::geo::meterToNm(distanceMeter) * 10.f) / 10.);
+        query.insert("nodes_expanded", statistics.nodesExpanded);
+        query.insert("edges_scanned", statistics.edgesScanned);
+        query.insert("edges_relaxed", statistics.edgesRelaxed);
+        query.insert("max_open_nodes", statistics.maxOpenNodes);
+        query.insert("array_memory_bytes", statistics.arrayMemoryBytes);
+        query.insert("latency", latencyObject(latencies));
+        queries.append(query);
+
+        modeLatencies[modeIndex].append(latencies);
+        allLatencies.append(latencies);
+        maxArrayMemory = std::max(maxArrayMemory, statistics.arrayMemoryBytes);
+      }
+    }
+  }
+
+  QJsonArray modeSummaries;
+  for(int modeIndex = 0; modeIndex < modes.size(); modeIndex++)
+  {
+    QJsonObject summary;
+    summary.insert("mode", modeName(modes.at(modeIndex)));
+    summary.insert("latency", latencyObject(modeLatencies.at(modeIndex)));
+    modeSummaries.append(summary);
+  }
+
+  result = QJsonObject();
+  result.insert("version", BENCHMARK_VERSION);
+  result.insert("source", source == SOURCE_AIRWAY ? "AIRWAY" : (source == SOURCE_RADIO ? "RADIO" : "NONE"));
+  result.insert("nodes", network->getNumNodes());
+  result.insert("repetitions", repetitions);
+  result.insert("max_array_memory_bytes", maxArrayMemory);
+  result.insert("total_time_ms", static_cast<double>(totalTimer.elapsed()));
+  result.insert("latency", latencyObject(allLatencies));
+  result.insert("modes", modeSummaries);
+  result.insert("queries", queries);
+
+  qInfo() << Q_FUNC_INFO << "Done in" << totalTimer.elapsed() << "ms";
+}
+
+bool RouteFinderBenchmark::writeResult(const QString& filename) const
+{
+  QSaveFile file(filename);
+  if(file.open(QIODevice::WriteOnly))
+  {
+    file.write(QJsonDocument(result).toJson(QJsonDocument::Indented));
+    if(file.commit())
+      return true;
+  }
+
+  qWarning() << Q_FUNC_INFO << "Cannot write" << filename << file.errorString();
+  return false;
+}
+
+} // namespace routing
+} // namespace atools
@@ -0,0 +1,103 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_ROUTEFINDERBENCHMARK_H
+#define ATOOLS_ROUTEFINDERBENCHMARK_H
+
+#include "routing/routenetworktypes.h"
+
+#include <QJsonObject>
+
+#include <algorithm>
+
+namespace atools {
+namespace routing {
+
+class RouteNetwork;
+
+/* Named departure and destination for the benchmark catalog */
+struct RouteBenchmarkPair
+{
+  QString name;
+  atools::geo::Pos from, to;
+};
+
+/*
+ * Runs a fixed catalog of city pairs with all modes suitable for the network and a set of altitudes.
+ *
+ * Each query is repeated and latency percentiles, expanded nodes, scanned edges and array memory as collected by
+ * RouteFinderStatistics are reported. The result is a JSON document with stable key order which can be compared
+ * between releases. Only the loaded network is used and no database access is needed.
+ *
+ * Queries run sequentially in the calling thread to get reproducible timings.
+ */
+class RouteFinderBenchmark
+{
+public:
+  RouteFinderBenchmark(const RouteNetwork *routeNetwork);
+  virtual ~RouteFinderBenchmark();
+
+  RouteFinderBenchmark(const RouteFinderBenchmark& other) = delete;
+  RouteFinderBenchmark& operator=(const RouteFinderBenchmark& other) = delete;
+
+  /* Run all queries. Results from previous runs are discarded. */
+  void run();
+
+  /* Results of last run() */
+  const QJsonObject& getResult() const
+  {
+    return result;
+  }
+
+  /* Write indented JSON. Returns false on error. */
+  bool writeResult(const QString& filename) const;
+
+  /* Number of times each query is run. Default is 5. */
+  void setRepetitions(int value)
+  {
+    repetitions = std::max(1, value);
+  }
+
+  /* Altitudes in ft. 0 ignores altitude restrictions. */
+  void setAltitudes(const QList<int>& value)
+  {
+    altitudes = value;
+  }
+
+  /* City pairs used by default */
+  static const QList<atools::routing::RouteBenchmarkPair>& getDefaultPairs();
+
+  /* Modes used for the network type. Each is run with and without MODE_BIDIRECTIONAL. */
+  static QList<atools::routing::Modes> getModes(atools::routing::DataSource source);
+
+private:
+  /* Percentile from sorted values using nearest rank */
+  static double percentile(const QList<double>& sortedValues, double percent);
+
+  /* Latency percentiles in milliseconds */
+  static QJsonObject latencyObject(QList<double> latenciesMs);
+
+  const RouteNetwork *network;
+  int repetitions = 5;
+  QList<int> altitudes = {0, 10000, 35000};
+  QJsonObject result;
+};
+
+} // namespace routing
+} // namespace atools
+
+#endif // ATOOLS_ROUTEFINDERBENCHMARK_H
@@ -26,7 +26,7 @@ namespace atools {
 namespace routing {
 
 RouteNetwork::RouteNetwork(atools::routing::DataSource dataSource)
-  : source(dataSource)
+  : data(new RouteNetworkData), source(dataSource)
 {
   // Default values
   nearestDepartureDistanceM = nmToMeter(500.f);
@@ -47,84 +47,106 @@ RouteNetwork::~RouteNetwork()
 {
 }
 
-void RouteNetwork::getNeighbours(Result& result, const Node& origin, const Edge *prevEdge) const
+RouteNetwork *RouteNetwork::createQueryNetwork() const
+{
+  RouteNetwork *network = new RouteNetwork(source);
+
+  // Share loaded data and tracks
+  network->data = data;
+  network->tracks = tracks;
+
+  network->minNearestDistanceRadioM = minNearestDistanceRadioM;
+  network->maxNearestDistanceRadioM = maxNearestDistanceRadioM;
+  network->minNearestDistanceWpM = minNearestDistanceWpM;
+  network->maxNearestDistanceWpM = maxNearestDistanceWpM;
+  network->nearestDepartureDistanceM = nearestDepartureDistanceM;
+  network->nearestDestDistanceM = nearestDestDistanceM;
+
+  network->directDistanceFactorRadio = directDistanceFactorRadio;
+  network->directDistanceFactorWp = directDistanceFactorWp;
+  network->directDistanceFactorAirway = directDistanceFactorAirway;
+  return network;
+}
+
+void RouteNetwork::neighbours(Result& result, const Node& origin, const Edge *adjacentEdge, bool reverse) const
 {
   Q_ASSERT(destinationNode.isValid());
   Q_ASSERT(departureNode.isValid());
 
+  // Target is destination for forward search and departure for backward search
+  const Node& targetNode = reverse ? departureNode : destinationNode;
+  const Point3D& targetPoint = reverse ? departurePoint : destinationPoint;
+
+  // Search start - departure node for forward search
+  bool originIsStart = reverse ? origin.isDestination() : origin.isDeparture();
+
   // Node might be also departure or destination
   Point3D originPoint = point3D(origin.index);
-  float originToDestDist = originPoint.directDistanceMeter(destinationPoint);
+  float originToDestDist = originPoint.directDistanceMeter(targetPoint);
 
   // Check for track/non-track or non-track/track transition if true
   // Limits neighbors if origin is in the middle of a track and not an endpoint
+  // adjacentEdge is the previous edge in forward and the next edge in reverse mode
   bool originNotTrackEnd = source == SOURCE_AIRWAY && mode & MODE_TRACK &&
-                           prevEdge != nullptr && !origin.isTrackStartEnd();
+                           adjacentEdge != nullptr && !origin.isTrackStartEnd();
 
   if(source == SOURCE_AIRWAY)
   {
+    // Use incoming edges for backward search
+    const EdgeTable& originEdges = reverse ? data->edgesReverse : data->edges;
+
+    // Departure, destination and track only nodes have no base airway edges
+    bool baseNode = origin.index >= 0 && origin.index < originEdges.numNodes();
+    int edgesBegin = baseNode ? originEdges.begin(origin.index) : 0;
+    int edgesEnd = baseNode ? originEdges.end(origin.index) : 0;
+
     // Add airway edges =======================================
-    result.nodes.reserve(origin.edges.size());
-    result.edges.reserve(origin.edges.size());
+    result.nodes.reserve(edgesEnd - edgesBegin);
+    result.edges.reserve(edgesEnd - edgesBegin);
 
     // Avoid duplicates with direct neighbor search
     QSet<int> nodeIndexes;
 
     if(mode & MODE_AIRWAY)
     {
-      // Look at all node edges/airways
-      for(const Edge& edge : origin.edges)
+      // Look at all node edges/airways - these are stored contiguous
+      for(int pos = edgesBegin; pos < edgesEnd; pos++)
       {
-        // Check if edge type matches criteria (altitude, RNAV and airway type)
-        if(!matchEdge(edge))
-          continue;
-
-        const Node& node = nodeIndex.at(edge.toIndex);
-        // Check if node type matches like airway type
-        if(!matchNode(node))
+        // Skip edges not allowing the altitude without copying them
+        if(!originEdges.matchAltitudeBand(pos, altitudeBandBit))
           continue;
 
-        // Avoid track transitions at the wrong points
-        if(originNotTrackEnd &&
-           // Do not traverse between track and airway
-           (prevEdge->isTrack() != edge.isTrack() ||
-            // and not between different tracks
-            (prevEdge->isTrack() && edge.isTrack() && prevEdge->airwayHash != edge.airwayHash)))
-          continue;
-
-        // Edge can have only another node - not departure or destination
-        Point3D curPoint = nodeIndex.atPoint3D(edge.toIndex);
-        float curToDestDist = curPoint.directDistanceMeter(destinationPoint);
+        addAirwayNeighbour(result, nodeIndexes, originEdges.edge(pos), originPoint, targetPoint, originToDestDist,
+                           adjacentEdge, originNotTrackEnd);
+      }
 
-        // Add only nodes/edges that are ahead of the current node and lead towards the destination
-        if(curToDestDist < originToDestDist)
+      // Add track edges from overlay
+      if(mode & MODE_TRACK && !tracks.isNull() && origin.index >= 0)
+      {
+        const QHash<int, QList<Edge> >& trackEdges = reverse ? tracks->edgesReverse : tracks->edges;
+        auto it = trackEdges.constFind(origin.index);
+        if(it != trackEdges.constEnd())
         {
-          float curToOriginDist = curPoint.directDistanceMeter(originPoint);
-          if(curToDestDist + curToOriginDist < originToDestDist * directDistanceFactorAirway)
-          {
-            result.nodes.append(edge.toIndex);
-            result.edges.append(edge);
-
-            if(mode & MODE_WAYPOINT)
-              nodeIndexes.insert(edge.toIndex);
-          }
+          for(const Edge& edge : it.value())
+            addAirwayNeighbour(result, nodeIndexes, edge, originPoint, targetPoint, originToDestDist,
+                               adjacentEdge, originNotTrackEnd);
         }
       }
     }
 
     // Additionally search for direct waypoint connections if result is limited
-    if((mode & MODE_WAYPOINT && result.size() < 2) || origin.isDeparture())
+    if((mode & MODE_WAYPOINT && result.size() < 2) || originIsStart)
     {
       // Use nearest of underlying waypoint if calculating for selected route legs or looking for
       // nearest airway point
-      float minDist = origin.isDeparture() &&
+      float minDist = originIsStart &&
                       (mode.testFlag(MODE_POINT_TO_POINT) || mode & MODE_AIRWAY) ? 0.f : minNearestDistanceWpM;
 
-      int found = searchNearest(result, origin, minDist, maxNearestDistanceWpM, &nodeIndexes);
+      int found = searchNearest(result, origin, minDist, maxNearestDistanceWpM, reverse, &nodeIndexes);
 
       if(found < 6)
         // Not enough results - try with larger search radius
-        searchNearest(result, origin, minDist * 2, maxNearestDistanceWpM * 5, &nodeIndexes);
+        searchNearest(result, origin, minDist * 2, maxNearestDistanceWpM * 5, reverse, &nodeIndexes);
 
       // Check for track transitions and remove any edges/nodes beginning from the end of the list
       if(originNotTrackEnd)
@@ -132,7 +154,7 @@ void RouteNetwork::getNeighbours(Result& result, const Node& origin, const Edge
         int size = result.edges.size();
         for(int i = size - 1; i >= 0; i--)
         {
-          if(prevEdge->isTrack() != result.edges.at(i).isTrack())
+          if(adjacentEdge->isTrack() != result.edges.at(i).isTrack())
           {
             result.nodes.removeAt(i);
             result.edges.removeAt(i);
@@ -143,22 +165,62 @@ void RouteNetwork::getNeighbours(Result& result, const Node& origin, const Edge
   }
   else
     // Find nearest navaids =======================================
-    searchNearest(result, origin, minNearestDistanceRadioM, maxNearestDistanceRadioM);
+    searchNearest(result, origin, minNearestDistanceRadioM, maxNearestDistanceRadioM, reverse);
 
   // Add destination node and calculate edges to it if in range ==========================================
-  if(originToDestDist < nearestDestDistanceM)
+  // Add departure node for backward search
+  if(originToDestDist < (reverse ? nearestDepartureDistanceM : nearestDestDistanceM))
   {
     // Avoid jumping directly into a track
-    if(!(originNotTrackEnd && prevEdge->isTrack()))
+    if(!(originNotTrackEnd && adjacentEdge->isTrack()))
+    {
+      result.nodes.append(targetNode.index);
+      result.edges.append(Edge(targetNode.index, originPoint.gcDistanceMeter(targetPoint)));
+    }
+  }
+}
+
+void RouteNetwork::addAirwayNeighbour(Result& result, QSet<int>& nodeIndexes, const Edge& edge,
+                                      const Point3D& originPoint, const Point3D& targetPoint, float originToDestDist,
+                                      const Edge *adjacentEdge, bool originNotTrackEnd) const
+{
+  // Check if edge type matches criteria (altitude, RNAV and airway type)
+  if(!matchEdge(edge))
+    return;
+
+  // Check if node type matches like airway type
+  if(!matchNode(getNode(edge.toIndex)))
+    return;
+
+  // Avoid track transitions at the wrong points
+  if(originNotTrackEnd &&
+     // Do not traverse between track and airway
+     (adjacentEdge->isTrack() != edge.isTrack() ||
+      // and not between different tracks
+      (adjacentEdge->isTrack() && edge.isTrack() && adjacentEdge->airwayHash != edge.airwayHash)))
+    return;
+
+  // Edge can have only another node - not departure or destination
+  const Point3D& curPoint = point3D(edge.toIndex);
+  float curToDestDist = curPoint.directDistanceMeter(targetPoint);
+
+  // Add only nodes/edges that are ahead of the current node and lead towards the destination
+  if(curToDestDist < originToDestDist)
+  {
+    float curToOriginDist = curPoint.directDistanceMeter(originPoint);
+    if(curToDestDist + curToOriginDist < originToDestDist * directDistanceFactorAirway)
     {
-      result.nodes.append(destinationNode.index);
-      result.edges.append(Edge(Node::DESTINATION_INDEX, originPoint.gcDistanceMeter(destinationPoint)));
+      result.nodes.append(edge.toIndex);
+      result.edges.append(edge);
+
+      if(mode & MODE_WAYPOINT)
+        nodeIndexes.insert(edge.toIndex);
     }
   }
 }
 
-int RouteNetwork::searchNearest(Result& result, const Node& origin,
-                                float minDistanceMeter, float maxDistanceMeter, const QSet<int> *excludeIndexes) const
+int RouteNetwork::searchNearest(Result& result, const Node& origin, float minDistanceMeter, float maxDistanceMeter,
+                                bool reverse, const QSet<int> *excludeIndexes) const
 {
   /* Callback class used for secondary stage filtering in radius searches.
    * Mainly used to keep all local variables accessible for the callback method. */
@@ -175,7 +237,7 @@ int RouteNetwork::searchNearest(Result& result, const Node& origin,
 
       // Do not use nodes in the exclude list
       if(excludeIndexes != nullptr)
-        ok &= !excludeIndexes->contains(index);
+        ok &= !excludeIndexes->contains(index + indexOffset);
 
       const Point3D& curPt = points[index];
 
@@ -224,23 +286,25 @@ int RouteNetwork::searchNearest(Result& result, const Node& origin,
     const Point3D *points;
     bool radionav = false, originDeparture = false;
     const QSet<int> *excludeIndexes = nullptr;
+    int indexOffset = 0; /* Added to index to get the node index for track overlay searches */
   };
 
   // Prepare callback with data =========================
   RadiusCallback callbackObj;
   callbackObj.origin = nodeToCartesian(origin);
-  callbackObj.points = nodeIndex.getPoints3D();
+  callbackObj.points = data->nodeIndex.getPoints3D();
   callbackObj.excludeIndexes = (excludeIndexes == nullptr || excludeIndexes->isEmpty()) ? nullptr : excludeIndexes;
   callbackObj.radionav = isRadionavRouting();
-  callbackObj.originDeparture = origin.isDeparture();
+  // Search start - departure node for forward search and destination for reverse search
+  callbackObj.originDeparture = reverse ? origin.isDestination() : origin.isDeparture();
 
   callbackObj.directDistFactor = isAirwayRouting() ? directDistanceFactorWp : directDistanceFactorRadio;
-  callbackObj.originToDestDist = getDirectDistanceMeter(origin, destinationNode);
-  callbackObj.dest = destinationPoint;
+  callbackObj.originToDestDist = getDirectDistanceMeter(origin, reverse ? departureNode : destinationNode);
+  callbackObj.dest = reverse ? departurePoint : destinationPoint;
 
   if(callbackObj.radionav)
   {
-    if(origin.isDeparture())
+    if(callbackObj.originDeparture)
       // Allow all points close to departure
       callbackObj.radiusMin = 0.f;
     else
@@ -249,7 +313,7 @@ int RouteNetwork::searchNearest(Result& result, const Node& origin,
   }
   else
   {
-    if(origin.isDeparture())
+    if(callbackObj.originDeparture)
       // Lower minimum distance for departure
       callbackObj.radiusMin = minDistanceMeter / 5.f;
     else
@@ -267,7 +331,7 @@ int RouteNetwork::searchNearest(Result& result, const Node& origin,
                                                    return callbackObj.callback(dist, index);
                                                  };
   QList<int> indexes;
-  nodeIndex.getRadiusIndexes(indexes, origin.pos, maxDistanceMeter, callbackFunc);
+  data->nodeIndex.getRadiusIndexes(indexes, origin.pos, maxDistanceMeter, callbackFunc);
 
   result.nodes.reserve(indexes.size());
   result.edges.reserve(indexes.size());
@@ -277,23 +341,65 @@ int RouteNetwork::searchNearest(Result& result, const Node& origin,
   Point3D originPoint = nodeToCartesian(origin);
   for(int idx : std::as_const(indexes))
   {
-    if(matchNode(nodeIndex.at(idx)))
+    if(matchNode(getNode(idx)))
     {
       // Add node and edge leading to it
       result.nodes.append(idx);
-      result.edges.append(Edge(idx, originPoint.gcDistanceMeter(nodeIndex.atPoint3D(idx))));
+      result.edges.append(Edge(idx, originPoint.gcDistanceMeter(data->nodeIndex.atPoint3D(idx))));
       numFound++;
     }
   }
+
+  // Search track only nodes in overlay ======================
+  if(!tracks.isNull() && !tracks->nodeIndex.isEmpty())
+  {
+    const atools::geo::SpatialIndex<Node>& trackIndex = tracks->nodeIndex;
+    callbackObj.points = trackIndex.getPoints3D();
+    callbackObj.indexOffset = static_cast<int>(data->nodeIndex.size());
+
+    indexes.clear();
+    trackIndex.getRadiusIndexes(indexes, origin.pos, maxDistanceMeter, callbackFunc);
+
+    for(int idx : std::as_const(indexes))
+    {
+      const Node& node = trackIndex.at(idx);
+      if(matchNode(node))
+      {
+        result.nodes.append(node.index);
+        result.edges.append(Edge(node.index, originPoint.gcDistanceMeter(trackIndex.atPoint3D(idx))));
+        numFound++;
+      }
+    }
+  }
   return numFound;
 }
 
+const Node& RouteNetwork::getNearestNode(const geo::Pos& pos) const
+{
+  int index = data->nodeIndex.getNearestIndex(pos);
+
+  if(!tracks.isNull() && !tracks->nodeIndex.isEmpty())
+  {
+    // Use track only node if closer than the nearest base node
+    int trackIndex = tracks->nodeIndex.getNearestIndex(pos);
+    if(trackIndex >= 0)
+    {
+      Point3D point = pos.toCartesian();
+      if(index < 0 || point.directDistanceMeter(tracks->nodeIndex.atPoint3D(trackIndex)) <
+         point.directDistanceMeter(data->nodeIndex.atPoint3D(index)))
+        return tracks->nodeIndex.at(trackIndex);
+    }
+  }
+  return getNode(index);
+}
+
 void RouteNetwork::setParameters(const geo::Pos& departurePos, const geo::Pos& destinationPos, int altitudeParam,
                                  Modes modeParam)
 {
   clearParameters();
 
   altitude = altitudeParam;
+  altitudeBandBit = EdgeTable::altitudeBandBit(altitude);
   mode = modeParam;
 
   if(departurePos.isValid())
@@ -325,11 +431,123 @@ void RouteNetwork::setParameters(const geo::Pos& departurePos, const geo::Pos& d
       routeGcDistance = getGcDistanceMeter(departureNode, destinationNode);
     }
   }
+
+  // Landmark tables do not contain direct waypoint connections and tracks
+  landmarkHeuristic = data->numLandmarks > 0 && isAirwayRouting() && !(mode & MODE_WAYPOINT) &&
+                      !(mode & MODE_TRACK) && departurePos.isValid() && destinationPos.isValid();
+
+  if(landmarkHeuristic)
+    updateLandmarkBounds();
+}
+
+void RouteNetwork::updateLandmarkBounds()
+{
+  const float INVALID = -std::numeric_limits<float>::infinity();
+  const float MAX = std::numeric_limits<float>::max();
+  const int num = data->numLandmarks;
+  const QList<float>& distFrom = data->landmarkDistFrom, & distTo = data->landmarkDistTo;
+
+  landmarkDestFrom.fill(MAX, num);
+  landmarkDestTo.fill(MAX, num);
+  landmarkDepartFrom.fill(MAX, num);
+  landmarkDepartTo.fill(MAX, num);
+
+  // Destination can only be reached by a direct connection from nodes within this distance - see neighbours()
+  // Use the larger radius of forward and backward search which uses a nearest search at the destination
+  QList<int> entries;
+  data->nodeIndex.getRadiusIndexes(entries, destinationNode.pos,
+                                   std::max(maxNearestDistanceWpM * 5.f, nearestDestDistanceM));
+
+  // Same for departure which connects to nodes using nearest search in forward mode and by distance in backward search
+  QList<int> exits;
+  data->nodeIndex.getRadiusIndexes(exits, departureNode.pos,
+                                   std::max(maxNearestDistanceWpM * 5.f, nearestDepartureDistanceM));
+
+  for(int l = 0; l < num; l++)
+  {
+    // Lower bounds for node to destination ==================
+    // d(node, dest) >= min(d(L, entry) + d(entry, dest)) - d(L, node)
+    // d(node, dest) >= d(node, L) + min(d(entry, dest) - d(entry, L))
+    for(int idx : std::as_const(entries))
+    {
+      float gcDist = destinationPoint.gcDistanceMeter(data->nodeIndex.atPoint3D(idx));
+      float from = distFrom.at(idx * num + l), to = distTo.at(idx * num + l);
+
+      if(from >= 0.f)
+        landmarkDestFrom[l] = std::min(landmarkDestFrom.at(l), from + gcDist);
+
+      if(to >= 0.f)
+        landmarkDestTo[l] = std::min(landmarkDestTo.at(l), gcDist - to);
+      else
+        // Entry cannot reach landmark - bound not usable
+        landmarkDestTo[l] = INVALID;
+    }
+
+    // Lower bounds for departure to node ==================
+    // d(depart, node) >= d(L, node) + min(d(depart, exit) - d(L, exit))
+    // d(depart, node) >= min(d(depart, exit) + d(exit, L)) - d(node, L)
+    for(int idx : std::as_const(exits))
+    {
+      float gcDist = departurePoint.gcDistanceMeter(data->nodeIndex.atPoint3D(idx));
+      float from = distFrom.at(idx * num + l), to = distTo.at(idx * num + l);
+
+      if(from >= 0.f)
+        landmarkDepartFrom[l] = std::min(landmarkDepartFrom.at(l), gcDist - from);
+      else
+        landmarkDepartFrom[l] = INVALID;
+
+      if(to >= 0.f)
+        landmarkDepartTo[l] = std::min(landmarkDepartTo.at(l), gcDist + to);
+    }
+
+    // Nothing found or not reachable
+    if(landmarkDestFrom.at(l) >= MAX || entries.isEmpty())
+      landmarkDestFrom[l] = INVALID;
+    if(landmarkDestTo.at(l) >= MAX || entries.isEmpty())
+      landmarkDestTo[l] = INVALID;
+    if(landmarkDepartFrom.at(l) >= MAX || exits.isEmpty())
+      landmarkDepartFrom[l] = INVALID;
+    if(landmarkDepartTo.at(l) >= MAX || exits.isEmpty())
+      landmarkDepartTo[l] = INVALID;
+  }
+}
+
+float RouteNetwork::getHeuristicDistanceMeter(const Node& node, bool reverse) const
+{
+  float dist = getGcDistanceMeter(node, reverse ? departureNode : destinationNode);
+
+  // No landmark distances for track only nodes
+  if(landmarkHeuristic && node.index >= 0 && node.index < data->nodeIndex.size())
+  {
+    // Use the best lower bound of all landmarks
+    int offset = node.index * data->numLandmarks;
+    for(int l = 0; l < data->numLandmarks; l++)
+    {
+      float from = data->landmarkDistFrom.at(offset + l), to = data->landmarkDistTo.at(offset + l);
+
+      if(reverse)
+      {
+        if(from >= 0.f)
+          dist = std::max(dist, from + landmarkDepartFrom.at(l));
+        if(to >= 0.f)
+          dist = std::max(dist, landmarkDepartTo.at(l) - to);
+      }
+      else
+      {
+        if(from >= 0.f)
+          dist = std::max(dist, landmarkDestFrom.at(l) - from);
+        if(to >= 0.f)
+          dist = std::max(dist, to + landmarkDestTo.at(l));
+      }
+    }
+  }
+  return dist;
 }
 
 void RouteNetwork::clearParameters()
 {
   altitude = 0;
+  altitudeBandBit = ~0ULL;
   mode = MODE_ALL;
   departureNode = Node();
   departurePoint = Point3D();
@@ -337,6 +555,7 @@ void RouteNetwork::clearParameters()
   destinationNode = Node();
   destinationPoint = Point3D();
   routeDirectDistance = routeGcDistance = 0.f;
+  landmarkHeuristic = false;
 }
 
 const Node& RouteNetwork::getNode(int index) const
@@ -344,7 +563,20 @@ const Node& RouteNetwork::getNode(int index) const
   const static atools::routing::Node INVALID;
 
   if(index >= 0)
-    return nodeIndex.at(index);
+  {
+    if(tracks.isNull())
+      return data->nodeIndex.at(index);
+
+    // Track only node or base node with changed connection flags
+    int numBase = static_cast<int>(data->nodeIndex.size());
+    if(index >= numBase)
+      return tracks->nodeIndex.at(index - numBase);
+
+    if(tracks->changedNodeBits.testBit(index))
+      return *tracks->changedNodes.constFind(index);
+
+    return data->nodeIndex.at(index);
+  }
   else if(index == Node::DEPARTURE_INDEX)
     return departureNode;
   else if(index == Node::DESTINATION_INDEX)
@@ -388,7 +620,10 @@ const geo::Point3D& RouteNetwork::point3D(int index) const
   const static Point3D INVALID;
 
   if(index >= 0)
-    return nodeIndex.atPoint3D(index);
+  {
+    int numBase = static_cast<int>(data->nodeIndex.size());
+    return index < numBase ? data->nodeIndex.atPoint3D(index) : tracks->nodeIndex.atPoint3D(index - numBase);
+  }
   else if(index == Node::DEPARTURE_INDEX)
     return departurePoint;
   else if(index == Node::DESTINATION_INDEX)
@@ -461,14 +696,14 @@ bool RouteNetwork::matchEdge(const Edge& edge) const
           (edge.isTrack() && mode.testFlag(MODE_TRACK));
 
   // Test altitude levels if attached - independent of direction
-  if(ok && altitude > 0 && edge.hasAltLevels)
+  if(ok && altitude > 0 && edge.hasAltLevels && !tracks.isNull())
   {
     int level = altitude / 100;
 
-    if(altLevelsEast.contains(edge.id))
-      ok &= altLevelsEast.value(edge.id).contains(static_cast<quint16>(level));
-    if(altLevelsWest.contains(edge.id))
-      ok &= altLevelsWest.value(edge.id).contains(static_cast<quint16>(level));
+    if(tracks->altLevelsEast.contains(edge.id))
+      ok &= tracks->altLevelsEast.value(edge.id).contains(static_cast<quint16>(level));
+    if(tracks->altLevelsWest.contains(edge.id))
+      ok &= tracks->altLevelsWest.value(edge.id).contains(static_cast<quint16>(level));
   }
 
   return ok;
@@ -477,14 +712,53 @@ bool RouteNetwork::matchEdge(const Edge& edge) const
 void RouteNetwork::clear()
 {
   clearParameters();
-  nodeIndex.clearIndex();
-  altLevelsEast.clear();
-  altLevelsWest.clear();
+
+  // Replace data instead of clearing it since it might be still used by query copies
+  data.reset(new RouteNetworkData);
+  tracks.reset();
+}
+
+void RouteNetwork::clearTracks()
+{
+  tracks.reset();
+}
+
+bool RouteNetwork::hasTracks() const
+{
+  return !tracks.isNull() && !tracks->edges.isEmpty();
 }
 
 bool RouteNetwork::isLoaded() const
 {
-  return !nodeIndex.isEmpty();
+  return !data->nodeIndex.isEmpty();
+}
+
+void RouteNetwork::getMemoryUsage(atools::util::MemoryUsage& usage) const
+{
+  using atools::util::MemoryUsage;
+
+  data->nodeIndex.getMemoryUsage(usage, QStringLiteral("RouteNetwork/nodes"));
+  usage.add(QStringLiteral("RouteNetwork/edges"), data->edges.memorySize() + data->edgesReverse.memorySize(),
+            data->edges.size());
+  usage.add(QStringLiteral("RouteNetwork/landmarks"),
+            MemoryUsage::listBytes(data->landmarkDistFrom) + MemoryUsage::listBytes(data->landmarkDistTo), data->numLandmarks);
+
+  if(!tracks.isNull())
+  {
+    tracks->nodeIndex.getMemoryUsage(usage, QStringLiteral("RouteNetwork/tracks/nodes"));
+
+    // Edge lists in hashes are counted by their elements
+    qint64 bytes = MemoryUsage::hashBytes(tracks->changedNodes) + tracks->changedNodeBits.size() / 8 +
+                   MemoryUsage::hashBytes(tracks->edges) +
+                   MemoryUsage::hashBytes(tracks->edgesReverse) + MemoryUsage::hashBytes(tracks->altLevelsEast) +
+                   MemoryUsage::hashBytes(tracks->altLevelsWest);
+    for(const QList<Edge>& edges : std::as_const(tracks->edges))
+      bytes += MemoryUsage::listBytes(edges);
+    for(const QList<Edge>& edges : std::as_const(tracks->edgesReverse))
+      bytes += MemoryUsage::listBytes(edges);
+
+    usage.add(QStringLiteral("RouteNetwork/tracks"), bytes, tracks->edges.size());
+  }
 }
 
 } // namespace route
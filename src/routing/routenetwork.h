@@ -21,11 +21,52 @@
 #include "geo/spatialindex.h"
 #include "routing/routenetworktypes.h"
 
+#include <QBitArray>
+#include <QSharedPointer>
+
 namespace atools {
 namespace routing {
 
 class RouteNetworkLoader;
 
+/* Loaded network data. Read-only after loading and shared by all network instances created by
+ * RouteNetwork::createQueryNetwork(). */
+struct RouteNetworkData
+{
+  /* Spatial index for nearest neighbor search using KD-tree internally */
+  atools::geo::SpatialIndex<Node> nodeIndex;
+
+  /* Outgoing and incoming airway and track edges for each node in CSR layout. Empty for radio networks. */
+  atools::routing::EdgeTable edges, edgesReverse;
+
+  /* Landmark (ALT) distance tables in meter filled by RouteNetworkLoader.
+   * Layout is node index * numLandmarks + landmark.
+   * Distances are calculated on airways without tracks. -1 if not reachable. */
+  int numLandmarks = 0;
+  QList<float> landmarkDistFrom /* Landmark to node */, landmarkDistTo /* Node to landmark */;
+};
+
+/* NAT or PACOTS tracks which are added on top of the loaded base network. Read-only after loading
+ * by RouteNetworkLoader::loadTracks() and replaced as a whole when tracks change. */
+struct RouteNetworkTracks
+{
+  /* Track only waypoints with spatial index for nearest search. Node::index starts at the number of base
+   * network nodes while positions in this index start at 0. */
+  atools::geo::SpatialIndex<atools::routing::Node> nodeIndex;
+
+  /* Copies of base nodes having track connection flags added. Keyed by node index. */
+  QHash<int, atools::routing::Node> changedNodes;
+
+  /* Bit set for each base node index having an entry in changedNodes */
+  QBitArray changedNodeBits;
+
+  /* Outgoing and incoming track edges keyed by node index */
+  QHash<int, QList<atools::routing::Edge> > edges, edgesReverse;
+
+  /* Map database track.track_id to altitude levels if existing */
+  QHash<int, QList<quint16> > altLevelsEast, altLevelsWest;
+};
+
 /*
  * Network forming a directed graph by navaid nodes and airway edges or generated edges by neares neighbor search.
  * The class already applies various filtering mechanisms (e.g. distance to destination) when looking for nearest nodes.
@@ -36,6 +77,10 @@ class RouteNetworkLoader;
  * Several optimizations limit the number of returned neighbors.
  *
  * The class has a state (i.e. start and destination) and is not re-entrant.
+ * Use createQueryNetwork() to get separate instances for concurrent searches which share the loaded data.
+ *
+ * Tracks are kept in a separate overlay which can be replaced by RouteNetworkLoader::loadTracks() without
+ * reloading the network. Query copies keep the tracks which were present when they were created.
  *
  * A call to setParameters with valid departure and destination is required before using any other methods.
  */
@@ -46,18 +91,45 @@ public:
   RouteNetwork(atools::routing::DataSource dataSource);
   virtual ~RouteNetwork();
 
+  RouteNetwork(const RouteNetwork& other) = delete;
+  RouteNetwork& operator=(const RouteNetwork& other) = delete;
+
+  /* Creates a new network sharing the loaded read-only data and copying all settings but having its
+   * own query state as set by setParameters(). Caller takes ownership.
+   * This network must not be reloaded or cleared while copies are in use. */
+  RouteNetwork *createQueryNetwork() const;
+
   /* true if network is loaded. */
   bool isLoaded() const;
 
   /* Remove departure and destination nodes */
   void clear();
 
+  /* Remove the track overlay. Existing query copies are not affected. */
+  void clearTracks();
+
+  /* true if a track overlay with edges is present */
+  bool hasTracks() const;
+
   /* Get all adjacent nodes and attached edges for the given node. Edges might be different than Node::edges.
    * Adjacent objects are filtered based on distance and type criteria like airway types.
    * Edges may be airways or generated edges by nearest neighbor search.
    * Nodes/edges having a longer distance to the destination than the origin are filtered out .*/
   void getNeighbours(atools::routing::Result& result, const atools::routing::Node& origin,
-                     const Edge *prevEdge = nullptr) const;
+                     const Edge *prevEdge = nullptr) const
+  {
+    neighbours(result, origin, prevEdge, false /* reverse */);
+  }
+
+  /* Same as above but for backward search from the destination. Returns all adjacent nodes which have an edge
+   * leading to origin. Edge::toIndex in result refers to the adjacent node too.
+   * Nodes/edges having a longer distance to the departure than the origin are filtered out.
+   * nextEdge is the edge leaving origin towards the destination. */
+  void getNeighboursReverse(atools::routing::Result& result, const atools::routing::Node& origin,
+                            const Edge *nextEdge = nullptr) const
+  {
+    neighbours(result, origin, nextEdge, true /* reverse */);
+  }
 
   /* Same as above but uses a the nearest node for the position. */
   void getNeighbours(atools::routing::Result& result, const atools::geo::Pos& origin,
@@ -81,6 +153,17 @@ public:
     return nodeToCartesian(node1).directDistanceMeter(nodeToCartesian(node2));
   }
 
+  /* Lower bound for the distance from node to destination or from departure to node if reverse is true.
+   * Uses landmark (ALT) distance tables if loaded and usable for the current mode. Falls back to
+   * great circle distance otherwise. */
+  float getHeuristicDistanceMeter(const atools::routing::Node& node, bool reverse) const;
+
+  /* true if landmark tables are loaded and used for the current parameters */
+  bool isLandmarkHeuristic() const
+  {
+    return landmarkHeuristic;
+  }
+
   /* Integrate departure and destination positions into the network as virtual nodes/edges.
    * Altitude is used to filter airway edges if > 0. Modes provides and additional neighbour filter. */
   void setParameters(const atools::geo::Pos& departurePos, const atools::geo::Pos& destinationPos,
@@ -104,16 +187,20 @@ public:
   /* Get a node by routing network node index. If index is -1 an invalid node with id -1 is returned */
   const atools::routing::Node& getNode(int index) const;
 
-  /* Get a single nearest node to the position. */
-  const atools::routing::Node& getNearestNode(const atools::geo::Pos& pos) const
+  /* Get a single nearest node to the position. Includes track only nodes. */
+  const atools::routing::Node& getNearestNode(const atools::geo::Pos& pos) const;
+
+  /* Get nodes vector of the base network without track only nodes.
+   * The index parameter can be used to access nodes fast.*/
+  const QList<atools::routing::Node>& getNodes() const
   {
-    return nodeIndex.getNearest(pos);
+    return data->nodeIndex;
   }
 
-  /* Get nodes vector. The index parameter can be used to access nodes fast.*/
-  const QList<atools::routing::Node>& getNodes() const
+  /* Number of nodes including track only nodes. Node indexes are in the range 0 to getNumNodes() - 1. */
+  int getNumNodes() const
   {
-    return nodeIndex;
+    return static_cast<int>(data->nodeIndex.size()) + (tracks.isNull() ? 0 : static_cast<int>(tracks->nodeIndex.size()));
   }
 
   /* true if airways and other navaids are used as data source. */
@@ -169,14 +256,17 @@ public:
   /* Altitude levels as assigned to NAT tracks. trackId is database track.track_id. */
   const QList<quint16> getAltitudeLevelsEast(int trackId) const
   {
-    return altLevelsEast.value(trackId);
+    return tracks.isNull() ? QList<quint16>() : tracks->altLevelsEast.value(trackId);
   }
 
   QList<quint16> getAltitudeLevelsWest(int trackId) const
   {
-    return altLevelsWest.value(trackId);
+    return tracks.isNull() ? QList<quint16>() : tracks->altLevelsWest.value(trackId);
   }
 
+  /* Add estimated memory of loaded data and track overlay. Shared data is counted for each network instance. */
+  void getMemoryUsage(atools::util::MemoryUsage& usage) const;
+
   /* Mode that defines which features are used for edge filtering (airways, tracks, direct connections, etc.) */
   atools::routing::Modes getMode() const
   {
@@ -186,24 +276,38 @@ public:
 private:
   friend class atools::routing::RouteNetworkLoader;
 
-  /* Get nearest nodes and edges */
+  /* Get neighbours in flight direction or against it if reverse is true. In reverse mode
+   * departure is used as target instead of destination. */
+  void neighbours(atools::routing::Result& result, const atools::routing::Node& origin,
+                  const Edge *adjacentEdge, bool reverse) const;
+
+  /* Get nearest nodes and edges from base network and track overlay.
+   * Destination is the target if reverse is false, otherwise departure. */
   int searchNearest(atools::routing::Result& result, const Node& origin, float minDistanceMeter,
-                    float maxDistanceMeter, const QSet<int> *excludeIndexes = nullptr) const;
+                    float maxDistanceMeter, bool reverse, const QSet<int> *excludeIndexes = nullptr) const;
 
   /* Check node filter based on mode. */
   bool matchNode(const Node& node) const;
 
   atools::geo::Point3D nodeToCartesian(const atools::routing::Node& node) const
   {
-    return node.index >= 0 ? nodeIndex.atPoint3D(node.index) : node.pos.toCartesian();
+    return node.index >= 0 ? point3D(node.index) : node.pos.toCartesian();
   }
 
+  /* Add edge to result if it passes all filters. Used for base and track overlay edges. */
+  void addAirwayNeighbour(atools::routing::Result& result, QSet<int>& nodeIndexes, const atools::routing::Edge& edge,
+                          const atools::geo::Point3D& originPoint, const atools::geo::Point3D& targetPoint,
+                          float originToDestDist, const Edge *adjacentEdge, bool originNotTrackEnd) const;
+
   /* Check if altitude, RNAV constraints and more allow to use this edge */
   bool matchEdge(const atools::routing::Edge& edge) const;
 
   /* Get point in 3D space. Returns destination or departure for appropriate indexes. */
   const atools::geo::Point3D& point3D(int index) const;
 
+  /* Calculate per query landmark bounds for destination and departure entry nodes */
+  void updateLandmarkBounds();
+
   /* All distances in meter */
   float minNearestDistanceRadioM, maxNearestDistanceRadioM,
         minNearestDistanceWpM, maxNearestDistanceWpM,
@@ -214,6 +318,9 @@ private:
   /* Used to filter airway edges by altitude restrictions. */
   int altitude = 0;
 
+  /* Band bit for altitude used to skip edges in EdgeTable before checking them. All bits set if altitude is 0. */
+  quint64 altitudeBandBit = ~0ULL;
+
   /* Filter for getNeighbours */
   atools::routing::Modes mode = atools::routing::MODE_ALL;
 
@@ -221,13 +328,17 @@ private:
   atools::geo::Point3D departurePoint, destinationPoint;
   float routeDirectDistance = 0.f, routeGcDistance = 0.f;
 
-  /* Spatial index for nearest neighbor search using KD-tree internally */
-  atools::geo::SpatialIndex<Node> nodeIndex;
+  /* Loaded data which is shared between query copies */
+  QSharedPointer<atools::routing::RouteNetworkData> data;
 
-  /* Map database track.track_id to altitude levels if existing */
-  QHash<int, QList<quint16> > altLevelsEast, altLevelsWest;
+  /* Track overlay or null if no tracks are loaded. Shared between query copies. */
+  QSharedPointer<const atools::routing::RouteNetworkTracks> tracks;
 
   atools::routing::DataSource source = atools::routing::SOURCE_NONE;
+
+  /* Per query lower bounds for each landmark calculated in setParameters. -infinity if not usable. */
+  QList<float> landmarkDestFrom, landmarkDestTo, landmarkDepartFrom, landmarkDepartTo;
+  bool landmarkHeuristic = false;
 };
 
 } // namespace routing
@@ -20,18 +20,35 @@
 #include "geo/calculations.h"
 #include "io/binaryutil.h"
 #include "routing/routenetwork.h"
+#include "sql/sqlconnectionpool.h"
+#include "sql/sqlcursor.h"
 #include "sql/sqldatabase.h"
 #include "sql/sqlquery.h"
 #include "sql/sqlrecord.h"
 #include "sql/sqlutil.h"
 #include "track/tracktypes.h"
+#include "util/indexedheap.h"
 
+#include <QDataStream>
+#include <QDateTime>
 #include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QSemaphore>
+#include <QSysInfo>
+#include <QThreadPool>
+
+#include <exception>
+#include <functional>
 
 using atools::sql::SqlUtil;
 using atools::sql::SqlQuery;
+using atools::sql::SqlCursor;
+using atools::sql::SqlDatabase;
 using atools::geo::nmToMeter;
 using atools::geo::Point3D;
+using atools::geo::SpatialIndex;
 using atools::charAt;
 
 // Calculate hash for airway name for quick comparison in routing algorithm
@@ -46,9 +63,110 @@ inline size_t trackHash(const QString& name, const QString& type)
   return (qHash(name, 7963) ^ (qHash(type, 7963) << 8) ^ 0x55555555) + 1; // Avoid null and add pattern to difference for airway
 }
 
+// Write list content as a raw memory block in native byte order
+template<typename TYPE>
+void writeRawArray(QDataStream& out, const QList<TYPE>& list)
+{
+  out.writeRawData(reinterpret_cast<const char *>(list.constData()), static_cast<int>(list.size() * sizeof(TYPE)));
+}
+
+// Read a raw memory block written by writeRawArray()
+template<typename TYPE>
+bool readRawArray(QDataStream& in, QList<TYPE>& list, int size)
+{
+  if(size < 0)
+    return false;
+
+  list.resize(size);
+  int bytes = static_cast<int>(size * sizeof(TYPE));
+  return in.readRawData(reinterpret_cast<char *>(list.data()), bytes) == bytes;
+}
+
+// Check that offsets are ascending and cover all edges and that all edges point to existing nodes
+bool validEdgeTable(const atools::routing::EdgeTable& edges, int numNodes)
+{
+  if(edges.offsets.size() != numNodes + 1 || edges.offsets.constFirst() != 0 || edges.offsets.constLast() != edges.toIndex.size())
+    return false;
+
+  for(int i = 1; i < edges.offsets.size(); i++)
+  {
+    if(edges.offsets.at(i) < edges.offsets.at(i - 1))
+      return false;
+  }
+
+  for(int toIndex : edges.toIndex)
+  {
+    if(toIndex < 0 || toIndex >= numNodes)
+      return false;
+  }
+  return true;
+}
+
 namespace atools {
 namespace routing {
 
+/*
+ * Runs independent read tasks concurrently. Each worker thread uses its own read only connection from the pool
+ * since connections cannot be shared between threads.
+ * Tasks are run in the calling thread on the given database if the pool is null.
+ */
+class RouteNetworkReadTasks
+{
+public:
+  RouteNetworkReadTasks(atools::sql::SqlConnectionPool *connectionPoolParam, SqlDatabase *dbParam)
+    : connectionPool(connectionPoolParam), db(dbParam)
+  {
+  }
+
+  ~RouteNetworkReadTasks()
+  {
+    // Tasks refer to data of the caller
+    threadPool.waitForDone();
+  }
+
+  /* Start task which releases one resource of done when finished, also on exception */
+  void start(QSemaphore& done, const std::function<void(SqlDatabase *db)>& task)
+  {
+    if(connectionPool == nullptr)
+    {
+      task(db);
+      done.release();
+    }
+    else
+      threadPool.start([this, &done, task]() -> void {
+        try
+        {
+          atools::sql::SqlConnectionHandle handle = connectionPool->acquire();
+          task(handle.getDatabase());
+        }
+        catch(...)
+        {
+          QMutexLocker locker(&mutex);
+          if(!exception)
+            exception = std::current_exception();
+        }
+        done.release();
+      });
+  }
+
+  /* Wait for number of tasks using done and rethrow the first exception of any task */
+  void wait(QSemaphore& done, int numTasks)
+  {
+    done.acquire(numTasks);
+
+    QMutexLocker locker(&mutex);
+    if(exception)
+      std::rethrow_exception(exception);
+  }
+
+private:
+  atools::sql::SqlConnectionPool *connectionPool;
+  SqlDatabase *db;
+  QThreadPool threadPool;
+  QMutex mutex;
+  std::exception_ptr exception;
+};
+
 RouteNetworkLoader::RouteNetworkLoader(atools::sql::SqlDatabase *sqlDbNav, atools::sql::SqlDatabase *sqlDbTrack)
   : dbNav(sqlDbNav), dbTrack(sqlDbTrack)
 {
@@ -69,15 +187,89 @@ void RouteNetworkLoader::load(atools::routing::RouteNetwork *networkParam)
   bool hasTracks = dbTrack != nullptr && SqlUtil(dbTrack).hasTableAndRows("track");
   bool hasNav = dbNav != nullptr && SqlUtil(dbNav).hasTableAndRows("waypoint");
 
+  // Snapshot contains the base network without tracks
+  QString snapshotFile, airacCycle;
+  qint64 dbTimestamp = 0, dbSize = 0;
+  if(useSnapshot && hasNav)
+  {
+    QFileInfo dbFileInfo(dbNav->databaseName());
+    if(dbFileInfo.exists())
+    {
+      snapshotFile = dbFileInfo.absoluteFilePath() +
+                     (network->source == SOURCE_RADIO ? ".radionetwork" : ".airwaynetwork");
+      dbTimestamp = dbFileInfo.lastModified().toMSecsSinceEpoch();
+      dbSize = dbFileInfo.size();
+
+      SqlUtil util(dbNav);
+      if(util.hasTableAndColumn("metadata", "airac_cycle"))
+        airacCycle = util.getValueStr("select airac_cycle from metadata");
+    }
+  }
+
+  if(snapshotFile.isEmpty() || !readSnapshot(snapshotFile, dbTimestamp, dbSize, airacCycle))
+  {
+    loadDatabase(hasNav);
+
+    if(!snapshotFile.isEmpty())
+      writeSnapshot(snapshotFile, dbTimestamp, dbSize, airacCycle);
+  }
+
+  // Build or read landmark tables for heuristic
+  if(network->source == SOURCE_AIRWAY && hasNav)
+    loadLandmarks();
+
+  // Add tracks as overlay which can be replaced later
+  if(network->source == SOURCE_AIRWAY && hasTracks)
+    loadTracks(network);
+
+  qDebug() << Q_FUNC_INFO << timer.restart() << "ms" << "nodes" << network->getNodes().size()
+           << "edges" << network->data->edges.size()
+           << "edge memory" << (network->data->edges.memorySize() +
+                           network->data->edgesReverse.memorySize()) / 1024 << "kB";
+}
+
+void RouteNetworkLoader::loadDatabase(bool hasNav)
+{
+  // Run independent queries concurrently on separate read only connections if the database is a file
+  // Has to be declared first to outlive the worker threads of readTasks
+  QScopedPointer<atools::sql::SqlConnectionPool> connectionPool;
+  if(dbNav != nullptr && QFileInfo::exists(dbNav->databaseName()))
+    connectionPool.reset(new atools::sql::SqlConnectionPool(dbNav->databaseName(), "routenetworkloader_" +
+                                                            QString::number(reinterpret_cast<quintptr>(this), 16)));
+
   if(network->source == SOURCE_RADIO && dbNav != nullptr)
   {
+    QList<Node> vorNodes, ndbNodes;
+    QSemaphore nodesDone;
+    RouteNetworkReadTasks readTasks(connectionPool.data(), dbNav);
+
     // Load VOR, VORDME and VORTAC. No DME and no TACAN. ==========================================
-    readNodesRadio("select v.vor_id, v.lonx, v.laty, v.range, "
-                   "case when v.dme_altitude is null then 0 else 1 end as has_dme "
-                   "from vor v where type <> 'TC' and dme_only = 0", true);
+    readTasks.start(nodesDone, [this, &vorNodes](SqlDatabase *db) -> void {
+      readNodesRadio(vorNodes, db, "select v.vor_id, v.lonx, v.laty, v.range, "
+                                   "case when v.dme_altitude is null then 0 else 1 end as has_dme "
+                                   "from vor v where type <> 'TC' and dme_only = 0", true);
+    });
 
     // Load all NDB =================================================
-    readNodesRadio("select n.ndb_id, n.lonx, n.laty, n.range, null as has_dme from ndb n", false);
+    readTasks.start(nodesDone, [this, &ndbNodes](SqlDatabase *db) -> void {
+      readNodesRadio(ndbNodes, db, "select n.ndb_id, n.lonx, n.laty, n.range, null as has_dme from ndb n", false);
+    });
+
+    readTasks.wait(nodesDone, 2);
+
+    SpatialIndex<Node>& nodeIndex = network->data->nodeIndex;
+    nodeIndex.reserve(static_cast<int>(vorNodes.size() + ndbNodes.size()));
+    for(const QList<Node> *nodes : {&vorNodes, &ndbNodes})
+    {
+      for(Node node : *nodes)
+      {
+        node.index = static_cast<int>(nodeIndex.size());
+        nodeIndex.append(node);
+      }
+    }
+
+    // Update spatial index
+    nodeIndex.updateIndex();
   }
   else if(network->source == SOURCE_AIRWAY)
   {
@@ -88,105 +280,138 @@ void RouteNetworkLoader::load(atools::routing::RouteNetwork *networkParam)
     QMultiHash<int, Edge> nodeEdgeMap;
     nodeEdgeMap.reserve(200000);
 
+    // One list for each node query below which are merged in query order
+    QList<Node> nodeLists[4];
+
+    // Ids of waypoints belonging to procedures
+    QSet<int> procNodeIds;
+
+    // Declared after all data used by tasks to wait for tasks before data is destroyed
+    QSemaphore nodesDone, edgesDone;
+    RouteNetworkReadTasks readTasks(connectionPool.data(), dbNav);
+    int numNodeTasks = 0;
+
     // Read navdata edges ==========================================
+    // Track edges are added later to the overlay
+    if(hasNav)
+      readTasks.start(edgesDone, [this, &nodeEdgeMap](SqlDatabase *db) -> void {
+        readEdgesAirway(nodeEdgeMap, nullptr, db);
+      });
+
     if(hasNav)
-      readEdgesAirway(nodeEdgeMap, false);
+    {
+      // Column order is important in the queries
+
+      // Waypoints which are part of procedures ====================
+      readTasks.start(nodesDone, [this, &procNodeIds](SqlDatabase *db) -> void {
+        readProcNodeIds(procNodeIds, db);
+      });
+
+      // Read navaids ====================
+      // Filter - waypoints from procedures are omitted when merging
+      // Named and unnamed waypoints without airways as well as degree confluence waypoints
+      // RNAV and OA appear only in MSFS
+      readTasks.start(nodesDone, [this, &nodeLists](SqlDatabase *db) -> void {
+        readNodesAirway(nodeLists[0], db,
+                        "select w.waypoint_id, w.ident, w.type, w.lonx, w.laty "
+                        "from waypoint w "
+                        "where w.type in ('WN', 'WU', 'RNAV', 'OA') and w.airport_id is null and "
+                        "w.num_jet_airway = 0 and w.num_victor_airway = 0",
+                        false, false, true /* filterGrid */);
+      });
+
+      // Airway waypoints ====================
+      // No filter - all waypoints are taken
+      // RNAV appears only in MSFS
+      readTasks.start(nodesDone, [this, &nodeLists](SqlDatabase *db) -> void {
+        readNodesAirway(nodeLists[1], db,
+                        "select w.waypoint_id, w.ident, w.type, w.lonx, w.laty, w.num_jet_airway, w.num_victor_airway "
+                        "from waypoint w "
+                        "where w.type in ('WN', 'WU', 'RNAV') and (w.num_jet_airway > 0 or w.num_victor_airway > 0)",
+                        false, false, false);
+      });
+
+      // Airway VOR waypoints ====================
+      readTasks.start(nodesDone, [this, &nodeLists](SqlDatabase *db) -> void {
+        readNodesAirway(nodeLists[2], db,
+                        "select w.waypoint_id, w.ident, w.type, w.lonx, w.laty, w.num_jet_airway, w.num_victor_airway, "
+                        "v.range, v.type as radiotype, v.dme_altitude,  v.dme_only "
+                        "from waypoint w join vor v on w.nav_id = v.vor_id "
+                        "where w.type = 'V' and (w.num_jet_airway > 0 or w.num_victor_airway > 0)",
+                        true /* VOR */, false, false);
+      });
+
+      // Airway NDB waypoints ====================
+      readTasks.start(nodesDone, [this, &nodeLists](SqlDatabase *db) -> void {
+        readNodesAirway(nodeLists[3], db,
+                        "select w.waypoint_id, w.ident, w.type, w.lonx, w.laty, w.num_jet_airway, w.num_victor_airway, "
+                        "n.range "
+                        "from waypoint w join ndb n on w.nav_id = n.ndb_id "
+                        "where w.type = 'N' and (w.num_jet_airway > 0 or w.num_victor_airway > 0)",
+                        false, true /* NDB */, false);
+      });
+      numNodeTasks = 5;
+    }
 
-    // Read track edges ==========================================
-    if(hasTracks)
-      readEdgesAirway(nodeEdgeMap, true /* track */);
+    readTasks.wait(nodesDone, numNodeTasks);
 
+    // Merge nodes in query order and assign final indexes ========================
     // Maps the database node id to index position in vector
     QHash<int, int> nodeIdIndexMap;
     nodeIdIndexMap.reserve(300000);
 
-    // List of created nodes
-    QList<Node> nodeVector;
-    nodeVector.reserve(300000);
-
-    // Column order is important in the queries
-
-    // Read navaids into nodeIdIndexMap and into nodesTemp ====================
-    // Filter - waypoints from procedures are omitted
-    // Named and unnamed waypoints without airways as well as degree confluence waypoints
-    // RNAV and OA appear only in MSFS
-    if(hasNav)
-      readNodesAirway(nodeVector, nodeIdIndexMap,
-                      "select w.waypoint_id, w.ident, w.type, w.lonx, w.laty "
-                      "from waypoint w "
-                      "where w.type in ('WN', 'WU', 'RNAV', 'OA') and w.airport_id is null and "
-                      "w.num_jet_airway = 0 and w.num_victor_airway = 0",
-                      false, false, false, true /* filterProc */);
-
-    // Airway waypoints ====================
-    // No filter - all waypoints are taken
-    // RNAV appears only in MSFS
-    if(hasNav)
-      readNodesAirway(nodeVector, nodeIdIndexMap,
-                      "select w.waypoint_id, w.ident, w.type, w.lonx, w.laty, w.num_jet_airway, w.num_victor_airway "
-                      "from waypoint w "
-                      "where w.type in ('WN', 'WU', 'RNAV') and (w.num_jet_airway > 0 or w.num_victor_airway > 0)",
-                      false, false, false, false);
-
-    // Track waypoints ====================
-    // No filter - all waypoints are taken
-    if(hasTracks)
+    SpatialIndex<Node>& nodeIndex = network->data->nodeIndex;
+    nodeIndex.reserve(300000);
+    for(int i = 0; i < 4; i++)
     {
-      QString where = hasNav ?
-                      (" where w.trackpoint_id >= " + QString::number(atools::track::TRACKPOINT_ID_OFFSET)) :
-                      QStringLiteral();
-
-      readNodesAirway(nodeVector,
-                      nodeIdIndexMap,
-                      "select w.trackpoint_id, w.ident, w.type, w.lonx, w.laty, w.num_jet_airway, w.num_victor_airway "
-                      "from trackpoint w " + where,
-                      false, false, true /* track */, false);
+      for(Node node : std::as_const(nodeLists[i]))
+      {
+        // Not part of an airway but part of a procedure or part of an airport (terminal waypoint) - ignore
+        if(i == 0 && procNodeIds.contains(node.id))
+          continue;
+
+        node.index = static_cast<int>(nodeIndex.size());
+        nodeIndex.append(node);
+        nodeIdIndexMap.insert(node.id, node.index);
+      }
+      nodeLists[i].clear();
     }
 
-    // Airway VOR waypoints ====================
-    if(hasNav)
-      readNodesAirway(nodeVector, nodeIdIndexMap,
-                      "select w.waypoint_id, w.ident, w.type, w.lonx, w.laty, w.num_jet_airway, w.num_victor_airway, "
-                      "v.range, v.type as radiotype, v.dme_altitude,  v.dme_only "
-                      "from waypoint w join vor v on w.nav_id = v.vor_id "
-                      "where w.type = 'V' and (w.num_jet_airway > 0 or w.num_victor_airway > 0)",
-                      true /* VOR */, false, false, false);
-
-    // Airway NDB waypoints ====================
-    if(hasNav)
-      readNodesAirway(nodeVector, nodeIdIndexMap,
-                      "select w.waypoint_id, w.ident, w.type, w.lonx, w.laty, w.num_jet_airway, w.num_victor_airway, "
-                      "n.range "
-                      "from waypoint w join ndb n on w.nav_id = n.ndb_id "
-                      "where w.type = 'N' and (w.num_jet_airway > 0 or w.num_victor_airway > 0)",
-                      false, true /* NDB */, false, false);
-
-    // Insert outgoing edges to each node and copy node to the index ========================
-    network->nodeIndex.reserve(nodeVector.size());
-    for(Node& node : nodeVector)
-    {
-      for(auto it = nodeEdgeMap.find(node.id); it != nodeEdgeMap.end() && it.key() == node.id; ++it)
-        node.edges.append(it.value());
+    // Update spatial index while edges are still loading
+    nodeIndex.updateIndex();
 
-      // Replace database ids in Edge::toIndex with array indexes
-      for(Edge& edge : node.edges)
-        edge.toIndex = nodeIdIndexMap.value(edge.toIndex);
+    readTasks.wait(edgesDone, hasNav ? 1 : 0);
 
-      network->nodeIndex.append(node);
+    // Insert outgoing edges to CSR table in node order ========================
+    EdgeTable& edges = network->data->edges;
+    edges.reserve(nodeIndex.size(), nodeEdgeMap.size());
+    for(const Node& node : std::as_const(nodeIndex))
+    {
+      for(auto it = nodeEdgeMap.constFind(node.id); it != nodeEdgeMap.constEnd() && it.key() == node.id; ++it)
+      {
+        // Replace database ids in Edge::toIndex with array indexes
+        Edge edge = it.value();
+        edge.toIndex = nodeIdIndexMap.value(edge.toIndex);
+        edges.append(edge);
+      }
+      edges.endNode();
     }
   } // else if(network->source == SOURCE_AIRWAY)
 
-  // Update spatial index
-  network->nodeIndex.updateIndex();
-
   // Calculate distance for all edges of all nodes and set node connection flags ================
-  for(Node& node : network->nodeIndex)
+  EdgeTable& edges = network->data->edges;
+  for(Node& node : network->data->nodeIndex)
   {
+    // No edges for radio network
+    if(node.index >= edges.numNodes())
+      break;
+
     atools::routing::NodeConnections connections = CONNECTION_NONE;
-    for(Edge& edge : node.edges)
+    const Point3D& nodePoint = network->data->nodeIndex.atPoint3D(node.index);
+    for(int pos = edges.begin(node.index); pos < edges.end(node.index); pos++)
     {
       // Fill connection flags based on outgoing edges
-      switch(edge.type)
+      switch(edges.type.at(pos))
       {
         case atools::routing::EDGE_NONE:
           break;
@@ -209,50 +434,496 @@ void RouteNetworkLoader::load(atools::routing::RouteNetwork *networkParam)
       }
 
       // Calculate great circle distance for all edges ====================
-      edge.lengthMeter = atools::roundToInt(network->nodeIndex.atPoint3D(node.index).
-                                            gcDistanceMeter(network->nodeIndex.atPoint3D(edge.toIndex)));
+      edges.lengthMeter[pos] = atools::roundToInt(nodePoint.gcDistanceMeter(
+                                                    network->data->nodeIndex.atPoint3D(edges.toIndex.at(pos))));
     }
 
     node.setConnections(connections);
   }
 
-  // Assign CONNECTION_TRACK_START_END to all nodes which are track end or start points
-  if(hasTracks)
-    readTrackStartEndPoints();
+  // Collect incoming edges for backward search ================
+  edges.buildReverse(network->data->edgesReverse);
+}
+
+bool RouteNetworkLoader::readSnapshot(const QString& filename, qint64 dbTimestamp, qint64 dbSize,
+                                      const QString& airacCycle)
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  QFile file(filename);
+  if(!file.exists())
+    return false;
+
+  if(!file.open(QIODevice::ReadOnly))
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot read network snapshot" << file.fileName() << ":" << file.errorString();
+    return false;
+  }
+
+  QDataStream in(&file);
+  in.setVersion(QDataStream::Qt_5_5);
+  in.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+  quint32 magic;
+  quint16 version;
+  quint8 byteOrder, source;
+  qint64 timestamp, size;
+  QString cycle;
+  qint32 numNodes, numOffsets, numEdges;
+  in >> magic >> version >> byteOrder >> source >> timestamp >> size >> cycle >> numNodes >> numOffsets >> numEdges;
+
+  if(magic != SNAPSHOT_FILE_MAGIC_NUMBER || version != SNAPSHOT_FILE_VERSION ||
+     byteOrder != static_cast<quint8>(QSysInfo::ByteOrder) || source != static_cast<quint8>(network->source) ||
+     timestamp != dbTimestamp || size != dbSize || cycle != airacCycle || in.status() != QDataStream::Ok ||
+     numNodes < 0 || numEdges < 0 || numOffsets != numNodes + 1)
+  {
+    qInfo() << Q_FUNC_INFO << "Network snapshot outdated" << file.fileName();
+    return false;
+  }
+
+  // Read nodes ==========================================
+  SpatialIndex<Node>& nodeIndex = network->data->nodeIndex;
+  nodeIndex.reserve(numNodes);
+  for(int i = 0; i < numNodes && in.status() == QDataStream::Ok; i++)
+  {
+    Node node;
+    quint8 type, subtype, con;
+    in >> node.id >> node.range >> node.pos >> type >> subtype >> con;
+
+    node.index = i;
+    node.type = static_cast<NodeType>(type);
+    node.subtype = static_cast<NodeType>(subtype);
+    node.con = static_cast<NodeConnection>(con);
+    nodeIndex.append(node);
+  }
+
+  // Read edge arrays which are stored as raw blocks in native byte order ==========================
+  EdgeTable& edges = network->data->edges;
+  bool ok = in.status() == QDataStream::Ok;
+  ok = ok && readRawArray(in, edges.offsets, numOffsets);
+  ok = ok && readRawArray(in, edges.toIndex, numEdges);
+  ok = ok && readRawArray(in, edges.lengthMeter, numEdges);
+  ok = ok && readRawArray(in, edges.id, numEdges);
+  ok = ok && readRawArray(in, edges.airwayHash, numEdges);
+  ok = ok && readRawArray(in, edges.minAltFt, numEdges);
+  ok = ok && readRawArray(in, edges.maxAltFt, numEdges);
+  ok = ok && readRawArray(in, edges.type, numEdges);
+  ok = ok && readRawArray(in, edges.routeType, numEdges);
+  ok = ok && readRawArray(in, edges.hasAltLevels, numEdges);
+  ok = ok && validEdgeTable(edges, numNodes);
+
+  if(!ok || in.status() != QDataStream::Ok)
+  {
+    qWarning() << Q_FUNC_INFO << "Error reading network snapshot" << file.fileName();
+    network->clear();
+    return false;
+  }
+
+  nodeIndex.updateIndex();
+  edges.updateAltitudeBands();
+  edges.buildReverse(network->data->edgesReverse);
 
-  qDebug() << Q_FUNC_INFO << timer.restart() << "ms" << "nodes" << network->getNodes().size();
+  qDebug() << Q_FUNC_INFO << timer.restart() << "ms" << file.fileName();
+  return true;
 }
 
-void RouteNetworkLoader::readTrackStartEndPoints() const
+void RouteNetworkLoader::writeSnapshot(const QString& filename, qint64 dbTimestamp, qint64 dbSize,
+                                       const QString& airacCycle) const
 {
+  const QList<Node>& nodes = network->data->nodeIndex;
+  const EdgeTable& edges = network->data->edges;
+
+  QFile file(filename);
+  if(file.open(QIODevice::WriteOnly))
+  {
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_5);
+    out.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    out << SNAPSHOT_FILE_MAGIC_NUMBER << SNAPSHOT_FILE_VERSION << static_cast<quint8>(QSysInfo::ByteOrder)
+        << static_cast<quint8>(network->source) << dbTimestamp << dbSize << airacCycle
+        << static_cast<qint32>(nodes.size()) << static_cast<qint32>(edges.offsets.size())
+        << static_cast<qint32>(edges.size());
+
+    for(const Node& node : nodes)
+      out << node.id << node.range << node.pos << static_cast<quint8>(node.type) << static_cast<quint8>(node.subtype)
+          << static_cast<quint8>(node.con);
+
+    writeRawArray(out, edges.offsets);
+    writeRawArray(out, edges.toIndex);
+    writeRawArray(out, edges.lengthMeter);
+    writeRawArray(out, edges.id);
+    writeRawArray(out, edges.airwayHash);
+    writeRawArray(out, edges.minAltFt);
+    writeRawArray(out, edges.maxAltFt);
+    writeRawArray(out, edges.type);
+    writeRawArray(out, edges.routeType);
+    writeRawArray(out, edges.hasAltLevels);
+
+    if(out.status() != QDataStream::Ok)
+      qWarning() << Q_FUNC_INFO << "Error writing network snapshot" << file.fileName();
+    file.close();
+  }
+  else
+    qWarning() << Q_FUNC_INFO << "Cannot write network snapshot" << file.fileName() << ":" << file.errorString();
+}
+
+void RouteNetworkLoader::loadLandmarks()
+{
+  if(numLandmarks <= 0 || network->data->nodeIndex.isEmpty())
+    return;
+
+  QElapsedTimer timer;
+  timer.start();
+
+  QFileInfo dbFileInfo(dbNav->databaseName());
+  QString filename = dbFileInfo.absoluteFilePath() + ".landmarks";
+  qint64 dbTimestamp = dbFileInfo.lastModified().toMSecsSinceEpoch(), dbSize = dbFileInfo.size();
+
+  if(!readLandmarkCache(filename, dbTimestamp, dbSize))
+  {
+    calculateLandmarks();
+
+    if(dbFileInfo.exists())
+      writeLandmarkCache(filename, dbTimestamp, dbSize);
+  }
+
+  qDebug() << Q_FUNC_INFO << timer.restart() << "ms" << "landmarks" << network->data->numLandmarks;
+}
+
+void RouteNetworkLoader::calculateLandmarks()
+{
+  const QList<Node>& nodes = network->data->nodeIndex;
+  int numNodes = nodes.size();
+
+  // Select landmarks from nodes which are connected to airways ================
+  // Use farthest point selection which puts landmarks at the border of the network
+  QList<int> landmarks;
+  QList<float> minDist(numNodes, std::numeric_limits<float>::max());
+
+  int first = -1;
+  for(int i = 0; i < numNodes && first == -1; i++)
+  {
+    if(nodes.at(i).hasAnyAirway())
+      first = i;
+  }
+
+  if(first == -1)
+    return;
+
+  int next = first;
+  for(int l = 0; l <= numLandmarks; l++)
+  {
+    // First round uses an arbitrary node to find a start at the border
+    if(l > 0)
+      landmarks.append(next);
+
+    const Point3D& lastPoint = network->data->nodeIndex.atPoint3D(next);
+    float maxDist = -1.f;
+    for(int i = 0; i < numNodes; i++)
+    {
+      if(!nodes.at(i).hasAnyAirway())
+        continue;
+
+      float dist = lastPoint.directDistanceMeter(network->data->nodeIndex.atPoint3D(i));
+      if(l == 0)
+        minDist[i] = dist;
+      else
+        minDist[i] = std::min(minDist.at(i), dist);
+
+      if(minDist.at(i) > maxDist)
+      {
+        maxDist = minDist.at(i);
+        next = i;
+      }
+    }
+  }
+
+  // Calculate distances from and to each landmark ================
+  network->data->numLandmarks = landmarks.size();
+  network->data->landmarkDistFrom.fill(-1.f, numNodes * network->data->numLandmarks);
+  network->data->landmarkDistTo.fill(-1.f, numNodes * network->data->numLandmarks);
+
+  for(int l = 0; l < landmarks.size(); l++)
+  {
+    calculateLandmarkDistances(network->data->landmarkDistFrom, l, landmarks.at(l), false /* reverse */);
+    calculateLandmarkDistances(network->data->landmarkDistTo, l, landmarks.at(l), true /* reverse */);
+  }
+}
+
+void RouteNetworkLoader::calculateLandmarkDistances(QList<float>& distances, int landmark, int landmarkIndex,
+                                                    bool reverse) const
+{
+  const EdgeTable& edges = reverse ? network->data->edgesReverse : network->data->edges;
+  int num = network->data->numLandmarks;
+
+  atools::util::IndexedHeap<float> heap(10000);
+  heap.clear(network->data->nodeIndex.size());
+
+  distances[landmarkIndex * num + landmark] = 0.f;
+  heap.pushData(landmarkIndex, 0.f);
+
+  while(!heap.isEmpty())
+  {
+    int index;
+    float dist = heap.pop(index);
+
+    for(int pos = edges.begin(index); pos < edges.end(index); pos++)
+    {
+      // Track edges change often - do not include them in tables
+      if(edges.isTrack(pos))
+        continue;
+
+      int toIndex = edges.toIndex.at(pos);
+      float successorDist = dist + edges.lengthMeter.at(pos);
+      float& curDist = distances[toIndex * num + landmark];
+      if(curDist < 0.f || successorDist < curDist)
+      {
+        curDist = successorDist;
+        heap.changeOrPush(toIndex, successorDist);
+      }
+    }
+  }
+}
+
+bool RouteNetworkLoader::readLandmarkCache(const QString& filename, qint64 dbTimestamp, qint64 dbSize)
+{
+  QFile file(filename);
+  if(!file.exists())
+    return false;
+
+  if(!file.open(QIODevice::ReadOnly))
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot read landmarks" << file.fileName() << ":" << file.errorString();
+    return false;
+  }
+
+  QDataStream in(&file);
+  in.setVersion(QDataStream::Qt_5_5);
+  in.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+  quint32 magic;
+  quint16 version;
+  qint64 timestamp, size;
+  qint32 num, numEntries;
+  in >> magic >> version >> timestamp >> size >> num >> numEntries;
+
+  if(magic != LANDMARK_FILE_MAGIC_NUMBER || version != LANDMARK_FILE_VERSION ||
+     timestamp != dbTimestamp || size != dbSize || num != numLandmarks || in.status() != QDataStream::Ok)
+  {
+    qInfo() << Q_FUNC_INFO << "Landmarks outdated" << file.fileName();
+    return false;
+  }
+
+  // Nodes are stored by database id since track points can change the order
+  QHash<int, int> nodeIdIndexMap;
+  for(const Node& node : std::as_const(network->data->nodeIndex))
+    nodeIdIndexMap.insert(node.id, node.index);
+
+  QList<float>& distFrom = network->data->landmarkDistFrom, & distTo = network->data->landmarkDistTo;
+  distFrom.fill(-1.f, network->data->nodeIndex.size() * num);
+  distTo.fill(-1.f, network->data->nodeIndex.size() * num);
+
+  for(int i = 0; i < numEntries && in.status() == QDataStream::Ok; i++)
+  {
+    qint32 id;
+    in >> id;
+    int index = nodeIdIndexMap.value(id, -1);
+
+    float from, to;
+    for(int l = 0; l < num; l++)
+    {
+      in >> from >> to;
+      if(index != -1)
+      {
+        distFrom[index * num + l] = from;
+        distTo[index * num + l] = to;
+      }
+    }
+  }
+
+  if(in.status() != QDataStream::Ok)
+  {
+    qWarning() << Q_FUNC_INFO << "Error reading landmarks" << file.fileName();
+    distFrom.clear();
+    distTo.clear();
+    return false;
+  }
+
+  network->data->numLandmarks = num;
+  return true;
+}
+
+void RouteNetworkLoader::writeLandmarkCache(const QString& filename, qint64 dbTimestamp, qint64 dbSize) const
+{
+  int num = network->data->numLandmarks;
+  if(num == 0)
+    return;
+
+  const QList<float>& distFrom = network->data->landmarkDistFrom, & distTo = network->data->landmarkDistTo;
+  const QList<Node>& nodes = network->data->nodeIndex;
+
+  // Write only nodes which are reachable at all
+  QList<int> indexes;
+  for(int i = 0; i < nodes.size(); i++)
+  {
+    for(int l = 0; l < num; l++)
+    {
+      if(distFrom.at(i * num + l) >= 0.f || distTo.at(i * num + l) >= 0.f)
+      {
+        indexes.append(i);
+        break;
+      }
+    }
+  }
+
+  QFile file(filename);
+  if(file.open(QIODevice::WriteOnly))
+  {
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_5);
+    out.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    out << LANDMARK_FILE_MAGIC_NUMBER << LANDMARK_FILE_VERSION << dbTimestamp << dbSize
+        << static_cast<qint32>(num) << static_cast<qint32>(indexes.size());
+
+    for(int index : std::as_const(indexes))
+    {
+      out << static_cast<qint32>(nodes.at(index).id);
+      for(int l = 0; l < num; l++)
+        out << distFrom.at(index * num + l) << distTo.at(index * num + l);
+    }
+    file.close();
+  }
+  else
+    qWarning() << Q_FUNC_INFO << "Cannot write landmarks" << file.fileName() << ":" << file.errorString();
+}
+
+void RouteNetworkLoader::loadTracks(atools::routing::RouteNetwork *networkParam)
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  network = networkParam;
+  network->clearTracks();
+
+  if(network->source != SOURCE_AIRWAY || dbTrack == nullptr || !SqlUtil(dbTrack).hasTableAndRows("track"))
+    return;
+
+  const SpatialIndex<Node>& nodeIndex = network->data->nodeIndex;
+  int numBase = static_cast<int>(nodeIndex.size());
+  QSharedPointer<RouteNetworkTracks> tracks(new RouteNetworkTracks);
+
+  // Build a temporary index mapping id to array index for base and track nodes
+  QHash<int, int> nodeIdIndexMap;
+  nodeIdIndexMap.reserve(numBase + 1000);
+  for(const Node& node : nodeIndex)
+    nodeIdIndexMap.insert(node.id, node.index);
+
+  // Track waypoints ====================
+  // No filter - all waypoints are taken
+  // Points below the offset refer to navdata waypoints which are already in the base network
+  QString where = numBase > 0 ?
+                  (" where w.trackpoint_id >= " + QString::number(atools::track::TRACKPOINT_ID_OFFSET)) :
+                  QStringLiteral();
+
+  SpatialIndex<Node>& trackIndex = tracks->nodeIndex;
+  readNodesAirway(trackIndex, dbTrack,
+                  "select w.trackpoint_id, w.ident, w.type, w.lonx, w.laty, w.num_jet_airway, w.num_victor_airway "
+                  "from trackpoint w " + where,
+                  false, false, false, numBase /* indexOffset */);
+  trackIndex.updateIndex();
+
+  for(const Node& node : std::as_const(trackIndex))
+    nodeIdIndexMap.insert(node.id, node.index);
+
+  tracks->changedNodeBits.resize(numBase);
+
+  // Get mutable node for index which is either a track node or a copy of a base node
+  // Changing flags does not move the nodes so the spatial index stays valid
+  auto changeNode = [&tracks, &trackIndex, &nodeIndex, numBase](int index) -> Node& {
+                      if(index >= numBase)
+                        return trackIndex[index - numBase];
+
+                      auto it = tracks->changedNodes.find(index);
+                      if(it == tracks->changedNodes.end())
+                      {
+                        it = tracks->changedNodes.insert(index, nodeIndex.at(index));
+                        tracks->changedNodeBits.setBit(index);
+                      }
+                      return it.value();
+                    };
+
+  // Point for base or track node
+  auto point = [&trackIndex, &nodeIndex, numBase](int index) -> const Point3D& {
+                 return index < numBase ? nodeIndex.atPoint3D(index) : trackIndex.atPoint3D(index - numBase);
+               };
+
+  // Read track edges ==========================================
+  // Edge::toIndex gets database id temporarily
+  QMultiHash<int, Edge> nodeEdgeMap;
+  readEdgesAirway(nodeEdgeMap, tracks.data(), dbTrack);
+
+  for(auto it = nodeEdgeMap.constBegin(); it != nodeEdgeMap.constEnd(); ++it)
+  {
+    int fromIndex = nodeIdIndexMap.value(it.key(), -1);
+    int toIndex = nodeIdIndexMap.value(it.value().toIndex, -1);
+
+    if(fromIndex == -1 || toIndex == -1)
+    {
+      qWarning() << Q_FUNC_INFO << "Track point not found for track id" << it.value().id;
+      continue;
+    }
+
+    Edge edge = it.value();
+    edge.toIndex = toIndex;
+    edge.lengthMeter = atools::roundToInt(point(fromIndex).gcDistanceMeter(point(toIndex)));
+    tracks->edges[fromIndex].append(edge);
+
+    // Point back to the start of the edge
+    edge.toIndex = fromIndex;
+    tracks->edgesReverse[toIndex].append(edge);
+
+    // Fill connection flags based on outgoing edges
+    changeNode(fromIndex).addConnection(CONNECTION_TRACK);
+  }
+
+  // Assign CONNECTION_TRACK_START_END to all nodes which are track end or start points ===============
   enum
   {
     STARTPOINT_ID,
     ENDPOINT_ID
   };
 
-  // Build a temporary index mapping id to array index
-  QHash<int, int> nodeIdIndexMap;
-  for(const Node& node : network->getNodes())
-    nodeIdIndexMap.insert(node.id, node.index);
-
-  SqlQuery query("select startpoint_id, endpoint_id from trackmeta", dbTrack);
-  query.exec();
+  SqlCursor query("select startpoint_id, endpoint_id from trackmeta", dbTrack);
   while(query.next())
   {
-    network->nodeIndex[nodeIdIndexMap.value(query.valueInt(STARTPOINT_ID))].addConnection(CONNECTION_TRACK_START_END);
-    network->nodeIndex[nodeIdIndexMap.value(query.valueInt(ENDPOINT_ID))].addConnection(CONNECTION_TRACK_START_END);
+    int startIndex = nodeIdIndexMap.value(query.valueInt(STARTPOINT_ID), -1);
+    int endIndex = nodeIdIndexMap.value(query.valueInt(ENDPOINT_ID), -1);
+
+    if(startIndex != -1)
+      changeNode(startIndex).addConnection(CONNECTION_TRACK_START_END);
+    if(endIndex != -1)
+      changeNode(endIndex).addConnection(CONNECTION_TRACK_START_END);
   }
+
+  // Replace overlay - query copies keep the old one
+  network->tracks = tracks;
+
+  qDebug() << Q_FUNC_INFO << timer.restart() << "ms" << "track nodes" << trackIndex.size()
+           << "track edges" << nodeEdgeMap.size();
 }
 
-void RouteNetworkLoader::readEdgesAirway(QMultiHash<int, Edge>& nodeEdgeMap, bool track) const
+void RouteNetworkLoader::readEdgesAirway(QMultiHash<int, Edge>& nodeEdgeMap, RouteNetworkTracks *tracks, SqlDatabase *db) const
 {
+  bool track = tracks != nullptr;
   atools::sql::SqlRecord rec;
   QString queryTxt;
 
   if(track)
   {
-    rec = dbTrack->record("track");
+    rec = db->record("track");
     queryTxt = "select track_id, from_waypoint_id, to_waypoint_id, airway_minimum_altitude, airway_maximum_altitude, "
                "track_name, 'T' as route_type, null as airway_type, 'F' as direction, "
                "altitude_levels_east, altitude_levels_west, track_type "
@@ -260,7 +931,7 @@ void RouteNetworkLoader::readEdgesAirway(QMultiHash<int, Edge>& nodeEdgeMap, boo
   }
   else
   {
-    rec = dbNav->record("airway");
+    rec = db->record("airway");
     if(rec.contains("route_type"))
       queryTxt = "select airway_id, from_waypoint_id, to_waypoint_id, minimum_altitude, maximum_altitude, airway_name, "
                  "route_type, airway_type, direction from airway";
@@ -286,8 +957,7 @@ void RouteNetworkLoader::readEdgesAirway(QMultiHash<int, Edge>& nodeEdgeMap, boo
     TRACK_TYPE
   };
 
-  SqlQuery query(queryTxt, track ? dbTrack : dbNav);
-  query.exec();
+  SqlCursor query(queryTxt, db);
   while(query.next())
   {
     Edge edge;
@@ -370,17 +1040,15 @@ void RouteNetworkLoader::readEdgesAirway(QMultiHash<int, Edge>& nodeEdgeMap, boo
       if(!query.isNull(ALT_LEVELS_EAST))
       {
         edge.hasAltLevels = true;
-        network->altLevelsEast.insert(edge.id,
-                                      atools::io::readVector<quint16, quint16>(
-                                        query.value(ALT_LEVELS_EAST).toByteArray()));
+        tracks->altLevelsEast.insert(edge.id, atools::io::readVector<quint16, quint16>(
+                                       query.valueBytes(ALT_LEVELS_EAST)));
       }
 
       if(!query.isNull(ALT_LEVELS_WEST))
       {
         edge.hasAltLevels = true;
-        network->altLevelsWest.insert(edge.id,
-                                      atools::io::readVector<quint16, quint16>(
-                                        query.value(ALT_LEVELS_WEST).toByteArray()));
+        tracks->altLevelsWest.insert(edge.id, atools::io::readVector<quint16, quint16>(
+                                       query.valueBytes(ALT_LEVELS_WEST)));
       }
 
       // Forward only track is always running from/to
@@ -392,9 +1060,8 @@ void RouteNetworkLoader::readEdgesAirway(QMultiHash<int, Edge>& nodeEdgeMap, boo
   } // while(query.next())
 }
 
-void RouteNetworkLoader::readNodesAirway(QList<Node>& nodes, QHash<int, int>& nodeIdIndexMap,
-                                         const QString& queryStr, bool vor, bool ndb,
-                                         bool track, bool filterProc)
+void RouteNetworkLoader::readNodesAirway(QList<Node>& nodes, SqlDatabase *db, const QString& queryStr, bool vor, bool ndb,
+                                         bool filterGrid, int indexOffset) const
 {
   // Column indexes
   // -> Required                          <- ->       if airway             <-  -> Optional
@@ -418,37 +1085,13 @@ void RouteNetworkLoader::readNodesAirway(QList<Node>& nodes, QHash<int, int>& no
     DME_ONLY
   };
 
-  QSet<int> procNodeIds;
-  if(filterProc && dbNav != nullptr && !track)
-  {
-    // Ignore non airway waypoints which belong to an airport and/or are part of a procedure
-    // Collect ids here and filter out later to avoid costly join
-    SqlQuery procWpQuery(dbNav);
-    if(SqlUtil(dbNav).hasTable("approach_leg") && SqlUtil(dbNav).hasTable("transition_leg"))
-    {
-      procWpQuery.exec("select waypoint_id from waypoint w join "
-                       " (select fix_ident, fix_region from approach_leg where fix_type in ('TW', 'W') union "
-                       "  select fix_ident, fix_region from transition_leg where fix_type in ('TW', 'W')) as sub "
-                       " on w.ident = sub.fix_ident and w.region = sub.fix_region "
-                       " where w.num_jet_airway = 0 and w.num_victor_airway = 0 and w.airport_id is null");
-      while(procWpQuery.next())
-        procNodeIds.insert(procWpQuery.valueInt(0));
-    }
-  }
-
-  SqlQuery query(queryStr, track ? dbTrack : dbNav);
-  query.exec();
+  SqlCursor query(queryStr, db);
   while(query.next())
   {
-    int nodeId = query.valueInt(ID);
-    if(procNodeIds.contains(nodeId))
-      // Not part of an airway but part of a procedure or part of an airport (terminal waypoint) - ignore
-      continue;
-
     atools::geo::Pos pos(query.valueFloat(LONX), query.valueFloat(LATY));
 
     // No name and grid filter for NDB and VOR waypoints
-    if(!ndb && !vor && filterProc)
+    if(!ndb && !vor && filterGrid)
     {
       // Include all one degree grid confluence points
       // Ignore half degee points
@@ -465,8 +1108,8 @@ void RouteNetworkLoader::readNodesAirway(QList<Node>& nodes, QHash<int, int>& no
     } // if(!ndb && !vor)
 
     Node node;
-    node.index = nodes.size();
-    node.id = nodeId;
+    node.index = indexOffset + static_cast<int>(nodes.size());
+    node.id = query.valueInt(ID);
     node.pos = pos;
     node.type = NODE_WAYPOINT;
 
@@ -493,14 +1136,31 @@ void RouteNetworkLoader::readNodesAirway(QList<Node>& nodes, QHash<int, int>& no
     // Connection flags are populated later by analyzing edges
 
     if(node.type == NODE_NONE)
-      qWarning() << Q_FUNC_INFO << "No node type" << query.record();
+      qWarning() << Q_FUNC_INFO << "No node type" << query.getQuery().record();
 
     nodes.append(node);
-    nodeIdIndexMap.insert(node.id, node.index);
   } // while(query.next())
 }
 
-void RouteNetworkLoader::readNodesRadio(const QString& queryStr, bool vor)
+void RouteNetworkLoader::readProcNodeIds(QSet<int>& procNodeIds, SqlDatabase *db) const
+{
+  // Ignore non airway waypoints which belong to an airport and/or are part of a procedure
+  // Collect ids here and filter out later to avoid costly join
+  SqlUtil util(db);
+  if(util.hasTable("approach_leg") && util.hasTable("transition_leg"))
+  {
+    SqlQuery procWpQuery(db);
+    procWpQuery.exec("select waypoint_id from waypoint w join "
+                     " (select fix_ident, fix_region from approach_leg where fix_type in ('TW', 'W') union "
+                     "  select fix_ident, fix_region from transition_leg where fix_type in ('TW', 'W')) as sub "
+                     " on w.ident = sub.fix_ident and w.region = sub.fix_region "
+                     " where w.num_jet_airway = 0 and w.num_victor_airway = 0 and w.airport_id is null");
+    while(procWpQuery.next())
+      procNodeIds.insert(procWpQuery.valueInt(0));
+  }
+}
+
+void RouteNetworkLoader::readNodesRadio(QList<Node>& nodes, SqlDatabase *db, const QString& queryStr, bool vor) const
 {
   // Column indexes
   // id, lonx, laty, range, has_dme
@@ -513,12 +1173,11 @@ void RouteNetworkLoader::readNodesRadio(const QString& queryStr, bool vor)
     HAS_DME
   };
 
-  SqlQuery query(queryStr, dbNav);
-  query.exec();
+  SqlCursor query(queryStr, db);
   while(query.next())
   {
+    // Index is assigned when merging
     Node node;
-    node.index = network->nodeIndex.size();
     node.id = query.valueInt(ID);
     node.pos.setLonX(query.valueFloat(LONX));
     node.pos.setLatY(query.valueFloat(LATY));
@@ -529,7 +1188,7 @@ void RouteNetworkLoader::readNodesRadio(const QString& queryStr, bool vor)
     else
       node.type = NODE_NDB;
 
-    network->nodeIndex.append(node);
+    nodes.append(node);
   }
 }
 
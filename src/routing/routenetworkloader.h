@@ -20,6 +20,8 @@
 
 #include "routing/routenetworktypes.h"
 
+#include <QSet>
+
 namespace atools {
 namespace sql {
 class SqlDatabase;
@@ -28,6 +30,7 @@ class SqlDatabase;
 namespace routing {
 
 class RouteNetwork;
+struct RouteNetworkTracks;
 
 /*
  * Loader for routing network forming a directed graph by navaid nodes and airway/track edges
@@ -47,23 +50,75 @@ public:
    * Not reentrant. */
   void load(atools::routing::RouteNetwork *networkParam);
 
+  /* Reads tracks from the track database and replaces the track overlay of an already loaded network.
+   * The base network is not reloaded. Query copies created before keep the previous tracks.
+   * Called by load() too. Not reentrant. */
+  void loadTracks(atools::routing::RouteNetwork *networkParam);
+
+  /* Build landmark (ALT) distance tables for a tighter A* heuristic if value is > 0. Only used for airway networks.
+   * Tables are cached in a file next to the navigation database and are rebuilt if the database changes.
+   * Default is 0 which disables landmarks. */
+  void setNumLandmarks(int value)
+  {
+    numLandmarks = value;
+  }
+
+  /* Save the loaded network to a binary snapshot file next to the navigation database and load it from there
+   * on the next call of load() instead of querying the database. The snapshot is rebuilt if the database file
+   * or its AIRAC cycle changes. Tracks are not included. Default is false. */
+  void setUseSnapshot(bool value)
+  {
+    useSnapshot = value;
+  }
+
 private:
-  /* Read VOR and NDB into index */
-  void readNodesRadio(const QString& queryStr, bool vor);
+  /* Query nodes and edges from databases. Independent queries run in parallel on separate read only
+   * connections if the navigation database is a file. */
+  void loadDatabase(bool hasNav);
 
-  /* Read waypoints and airways into index */
-  void readNodesAirway(QList<Node>& nodes, QHash<int, int>& nodeIdIndexMap, const QString& queryStr,
-                       bool vor, bool ndb, bool track, bool filterProc);
+  /* Read network snapshot if it exists and matches the database. Returns false on error or if outdated. */
+  bool readSnapshot(const QString& filename, qint64 dbTimestamp, qint64 dbSize, const QString& airacCycle);
+  void writeSnapshot(const QString& filename, qint64 dbTimestamp, qint64 dbSize, const QString& airacCycle) const;
 
-  /* Read edges from tables airway or track.
-   * nodeEdgeMap receiives a list of node ids mapped to a list of edges. */
-  void readEdgesAirway(QMultiHash<int, Edge>& nodeEdgeMap, bool track) const;
+  /* Read landmark tables from cache or calculate and write them */
+  void loadLandmarks();
+
+  /* Select landmarks far apart from each other and run a Dijkstra search for each */
+  void calculateLandmarks();
+
+  /* Dijkstra on airways without tracks from landmark node to all nodes or all nodes to landmark if reverse is true.
+   * Fills column landmark in distances. */
+  void calculateLandmarkDistances(QList<float>& distances, int landmark, int landmarkIndex, bool reverse) const;
 
-  /* Reads metadata and adds CONNECTION_TRACK_START_END flag to nodes if they are a start or end of a track. */
-  void readTrackStartEndPoints() const;
+  bool readLandmarkCache(const QString& filename, qint64 dbTimestamp, qint64 dbSize);
+  void writeLandmarkCache(const QString& filename, qint64 dbTimestamp, qint64 dbSize) const;
+
+  /* Read VOR and NDB into list. Node::index is not set. */
+  void readNodesRadio(QList<Node>& nodes, atools::sql::SqlDatabase *db, const QString& queryStr, bool vor) const;
+
+  /* Read waypoints and airways into list. Node::index is counted from indexOffset.
+   * Numbered points which are not near a one degree grid are omitted if filterGrid is true. */
+  void readNodesAirway(QList<Node>& nodes, atools::sql::SqlDatabase *db, const QString& queryStr,
+                       bool vor, bool ndb, bool filterGrid, int indexOffset = 0) const;
+
+  /* Read ids of waypoints not on airways which are used by procedures */
+  void readProcNodeIds(QSet<int>& procNodeIds, atools::sql::SqlDatabase *db) const;
+
+  /* Read edges from tables airway or track if tracks is not null. Track altitude levels are added to tracks.
+   * nodeEdgeMap receiives a list of node ids mapped to a list of edges. */
+  void readEdgesAirway(QMultiHash<int, Edge>& nodeEdgeMap, atools::routing::RouteNetworkTracks *tracks,
+                       atools::sql::SqlDatabase *db) const;
 
   atools::routing::RouteNetwork *network = nullptr;
   atools::sql::SqlDatabase *dbNav = nullptr, *dbTrack = nullptr;
+  int numLandmarks = 0;
+  bool useSnapshot = false;
+
+  const static quint32 LANDMARK_FILE_MAGIC_NUMBER = 0x7A31C64E;
+  const static quint16 LANDMARK_FILE_VERSION = 1;
+
+  const static quint32 SNAPSHOT_FILE_MAGIC_NUMBER = 0x3C9E52B7;
+  const static quint16 SNAPSHOT_FILE_VERSION = 1;
 };
 
 } // namespace routing
@@ -31,7 +31,6 @@ QDebug operator<<(QDebug out, const Node& obj)
                           << ", type " << nodeTypeToStr(obj.type)
                           << ", subtype " << nodeTypeToStr(obj.subtype)
                           << ", connections " << nodeConnectionsToStr(obj.con)
-                          << ", num edges " << obj.edges.size()
                           << ")";
   return out;
 
@@ -49,6 +48,147 @@ QDebug operator<<(QDebug out, const Edge& obj)
   return out;
 }
 
+void EdgeTable::clear()
+{
+  offsets.clear();
+  offsets.append(0);
+
+  toIndex.clear();
+  lengthMeter.clear();
+  id.clear();
+  airwayHash.clear();
+  minAltFt.clear();
+  maxAltFt.clear();
+  type.clear();
+  routeType.clear();
+  hasAltLevels.clear();
+  altBands.clear();
+}
+
+void EdgeTable::reserve(int numNodes, int numEdges)
+{
+  offsets.reserve(numNodes + 1);
+
+  toIndex.reserve(numEdges);
+  lengthMeter.reserve(numEdges);
+  id.reserve(numEdges);
+  airwayHash.reserve(numEdges);
+  minAltFt.reserve(numEdges);
+  maxAltFt.reserve(numEdges);
+  type.reserve(numEdges);
+  routeType.reserve(numEdges);
+  hasAltLevels.reserve(numEdges);
+  altBands.reserve(numEdges);
+}
+
+void EdgeTable::append(const Edge& edge)
+{
+  toIndex.append(edge.toIndex);
+  lengthMeter.append(edge.lengthMeter);
+  id.append(edge.id);
+  airwayHash.append(edge.airwayHash);
+  minAltFt.append(edge.minAltFt);
+  maxAltFt.append(edge.maxAltFt);
+  type.append(edge.type);
+  routeType.append(edge.routeType);
+  hasAltLevels.append(edge.hasAltLevels);
+  altBands.append(altitudeBands(edge.minAltFt, edge.maxAltFt));
+}
+
+Edge EdgeTable::edge(int pos) const
+{
+  Edge edge;
+  edge.toIndex = toIndex.at(pos);
+  edge.lengthMeter = lengthMeter.at(pos);
+  edge.id = id.at(pos);
+  edge.airwayHash = airwayHash.at(pos);
+  edge.minAltFt = minAltFt.at(pos);
+  edge.maxAltFt = maxAltFt.at(pos);
+  edge.type = type.at(pos);
+  edge.routeType = routeType.at(pos);
+  edge.hasAltLevels = hasAltLevels.at(pos);
+  return edge;
+}
+
+void EdgeTable::buildReverse(EdgeTable& reverse) const
+{
+  int num = numNodes();
+
+  // Count incoming edges per node ===================
+  QList<int> counts(num, 0);
+  for(int to : toIndex)
+    counts[to]++;
+
+  // Calculate offsets ===================
+  reverse.clear();
+  reverse.reserve(num, size());
+  for(int i = 0; i < num; i++)
+    reverse.offsets.append(reverse.offsets.constLast() + counts.at(i));
+
+  // Resize all fields and fill by moving insert position ===================
+  reverse.toIndex.resize(size());
+  reverse.lengthMeter.resize(size());
+  reverse.id.resize(size());
+  reverse.airwayHash.resize(size());
+  reverse.minAltFt.resize(size());
+  reverse.maxAltFt.resize(size());
+  reverse.type.resize(size());
+  reverse.routeType.resize(size());
+  reverse.hasAltLevels.resize(size());
+  reverse.altBands.resize(size());
+
+  QList<int> insertPos(reverse.offsets.mid(0, num));
+  for(int from = 0; from < num; from++)
+  {
+    for(int pos = begin(from); pos < end(from); pos++)
+    {
+      int rpos = insertPos[toIndex.at(pos)]++;
+
+      // Point back to the start of the edge
+      reverse.toIndex[rpos] = from;
+      reverse.lengthMeter[rpos] = lengthMeter.at(pos);
+      reverse.id[rpos] = id.at(pos);
+      reverse.airwayHash[rpos] = airwayHash.at(pos);
+      reverse.minAltFt[rpos] = minAltFt.at(pos);
+      reverse.maxAltFt[rpos] = maxAltFt.at(pos);
+      reverse.type[rpos] = type.at(pos);
+      reverse.routeType[rpos] = routeType.at(pos);
+      reverse.hasAltLevels[rpos] = hasAltLevels.at(pos);
+      reverse.altBands[rpos] = altBands.at(pos);
+    }
+  }
+}
+
+quint64 EdgeTable::altitudeBands(int minAltitudeFt, int maxAltitudeFt)
+{
+  int first = std::min(std::max(minAltitudeFt, 0) / ALTITUDE_BAND_FT, NUM_ALTITUDE_BANDS - 1);
+  int last = std::min(std::max(maxAltitudeFt, 0) / ALTITUDE_BAND_FT, NUM_ALTITUDE_BANDS - 1);
+
+  quint64 bands = 0;
+  for(int band = first; band <= last; band++)
+    bands |= 1ULL << band;
+  return bands;
+}
+
+void EdgeTable::updateAltitudeBands()
+{
+  altBands.resize(size());
+  for(int pos = 0; pos < size(); pos++)
+    altBands[pos] = altitudeBands(minAltFt.at(pos), maxAltFt.at(pos));
+}
+
+qint64 EdgeTable::memorySize() const
+{
+  return offsets.capacity() * static_cast<qint64>(sizeof(int)) +
+         (toIndex.capacity() + lengthMeter.capacity() + id.capacity()) * static_cast<qint64>(sizeof(int)) +
+         airwayHash.capacity() * static_cast<qint64>(sizeof(quint32)) +
+         (minAltFt.capacity() + maxAltFt.capacity()) * static_cast<qint64>(sizeof(quint16)) +
+         type.capacity() * static_cast<qint64>(sizeof(EdgeType)) +
+         routeType.capacity() * static_cast<qint64>(sizeof(RouteType)) +
+         hasAltLevels.capacity() * static_cast<qint64>(sizeof(bool)) +
+         altBands.capacity() * static_cast<qint64>(sizeof(quint64));
+}
+
 QString nodeTypeToStr(atools::routing::NodeType type)
 {
   if(type == atools::routing::NODE_NONE)
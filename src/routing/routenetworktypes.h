@@ -33,7 +33,7 @@ enum DataSource
 };
 
 /* Network mode. Changes which edges and nodes are returned as neighbours. */
-enum Mode : quint8
+enum Mode : quint16
 {
   MODE_NONE = 0,
   MODE_RADIONAV_VOR = 1 << 0, /* VOR/NDB to VOR/NDB */
@@ -49,6 +49,9 @@ enum Mode : quint8
                                 * instead of airport to airport.
                                 * Sets minimum distance at departure to zero. */
 
+  MODE_BIDIRECTIONAL = 1 << 8, /* Search from departure and destination simultaneously
+                                * meeting in the middle. Not a filter. */
+
   MODE_AIRWAY = MODE_VICTOR | MODE_JET,
   MODE_AIRWAY_WAYPOINT = MODE_VICTOR | MODE_JET | MODE_WAYPOINT,
   MODE_AIRWAY_TRACK = MODE_AIRWAY | MODE_TRACK,
@@ -62,7 +65,7 @@ enum Mode : quint8
   MODE_ALL = MODE_AIRWAY | MODE_NAVAID,
 };
 
-ATOOLS_DECLARE_FLAGS_8(Modes, Mode)
+ATOOLS_DECLARE_FLAGS_16(Modes, Mode)
 ATOOLS_DECLARE_OPERATORS_FOR_FLAGS(atools::routing::Modes)
 
 /* Type and subtype of a node */
@@ -199,8 +202,7 @@ struct Node
                             subtype /* VOR, VORDME, NDB, ... for airway network if type is one of WAYPOINT_* */;
   atools::routing::NodeConnection con; /* Flags indicating all connected airways and tracks */
 
-  QList<Edge> edges; /* Attached outgoing edges on airway only.
-                        * Do not use this since edges are already filtered by the RouteNetwork. */
+  /* Airway and track edges are kept in RouteNetwork in an EdgeTable indexed by Node::index */
 
   /* Default unitialized */
   constexpr static int INVALID_INDEX = -1;
@@ -295,6 +297,112 @@ inline size_t qHash(const atools::routing::Node& node, size_t)
   return static_cast<size_t>(node.index);
 }
 
+/*
+ * Compressed sparse row (CSR) storage for all airway and track edges of a network.
+ * Edges of node with index n are stored at positions begin(n) until end(n) - 1.
+ * Edge fields are kept in separate arrays (structure of arrays) which avoids padding and
+ * a list allocation per node and allows a linear scan when expanding nodes.
+ *
+ * Fill by calling append() for all edges of a node followed by endNode() for each node in index order.
+ */
+struct EdgeTable
+{
+  EdgeTable()
+  {
+    offsets.append(0);
+  }
+
+  void clear();
+
+  /* Reserve space for number of nodes and edges */
+  void reserve(int numNodes, int numEdges);
+
+  /* Add an outgoing or incoming edge to the current node */
+  void append(const atools::routing::Edge& edge);
+
+  /* Close edge list for current node and start the next one */
+  void endNode()
+  {
+    offsets.append(static_cast<int>(toIndex.size()));
+  }
+
+  /* First edge position for node index */
+  int begin(int nodeIndex) const
+  {
+    return offsets.at(nodeIndex);
+  }
+
+  /* Position after last edge for node index */
+  int end(int nodeIndex) const
+  {
+    return offsets.at(nodeIndex + 1);
+  }
+
+  /* Number of nodes added */
+  int numNodes() const
+  {
+    return static_cast<int>(offsets.size()) - 1;
+  }
+
+  /* Number of edges for all nodes */
+  int size() const
+  {
+    return static_cast<int>(toIndex.size());
+  }
+
+  bool isTrack(int pos) const
+  {
+    return type.at(pos) == EDGE_TRACK;
+  }
+
+  /* Quick pre-filter for altitude restrictions. bandBit is from altitudeBandBit().
+   * false if the edge cannot be used at the altitude. true needs an exact check of minimum and maximum altitude. */
+  bool matchAltitudeBand(int pos, quint64 bandBit) const
+  {
+    return (altBands.at(pos) & bandBit) != 0;
+  }
+
+  /* Bit for the band containing the altitude. All bits are set if altitude is 0 which matches all edges. */
+  static quint64 altitudeBandBit(int altitudeFt)
+  {
+    if(altitudeFt <= 0)
+      return ~0ULL;
+    return 1ULL << std::min(altitudeFt / ALTITUDE_BAND_FT, NUM_ALTITUDE_BANDS - 1);
+  }
+
+  /* Bits for all bands overlapping the altitude range */
+  static quint64 altitudeBands(int minAltitudeFt, int maxAltitudeFt);
+
+  /* Calculate altBands from minAltFt and maxAltFt. Needed after filling these arrays directly. */
+  void updateAltitudeBands();
+
+  /* Width of one altitude band in feet. The last band contains all altitudes above too. */
+  constexpr static int ALTITUDE_BAND_FT = 1000;
+  constexpr static int NUM_ALTITUDE_BANDS = 64;
+
+  /* Get edge at position between begin() and end() */
+  atools::routing::Edge edge(int pos) const;
+
+  /* Build a table of incoming edges where Edge::toIndex is the start node of the edge in this table */
+  void buildReverse(atools::routing::EdgeTable& reverse) const;
+
+  /* Memory used in bytes */
+  qint64 memorySize() const;
+
+  QList<int> offsets; /* Edge start positions per node index. Contains numNodes() + 1 entries. */
+
+  /* Edge fields - see Edge */
+  QList<int> toIndex, lengthMeter, id;
+  QList<quint32> airwayHash;
+  QList<quint16> minAltFt, maxAltFt;
+  QList<atools::routing::EdgeType> type;
+  QList<atools::routing::RouteType> routeType;
+  QList<bool> hasAltLevels;
+
+  /* Bit mask of altitude bands overlapping minAltFt to maxAltFt. Derived and not saved in snapshots. */
+  QList<quint64> altBands;
+};
+
 struct Result
 {
   QList<int> nodes;
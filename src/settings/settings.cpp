@@ -23,11 +23,36 @@
 #include <QFileInfo>
 #include <QDir>
 #include <QDateTime>
-#include <QCoreApplication>
+#include <QTimer>
+#include <QThreadPool>
 
 namespace atools {
 namespace settings {
 
+/* Delay for coalescing changes before writing */
+const static int SYNC_DELAY_MS = 1000;
+
+/* Suppresses the synchronous write which QSettings does in the event loop after changes and
+ * schedules a background write instead */
+class WriteBehindSettings
+  : public QSettings
+{
+public:
+  using QSettings::QSettings;
+
+protected:
+  virtual bool event(QEvent *event) override
+  {
+    if(event->type() == QEvent::UpdateRequest)
+    {
+      Settings::syncSettings();
+      return true;
+    }
+    return QSettings::event(event);
+  }
+
+};
+
 Settings *Settings::settingsInstance = nullptr;
 QString Settings::overridePath;
 QString Settings::organizationName;
@@ -42,10 +67,10 @@ Settings::Settings()
 
   if(!overridePath.isEmpty())
     // qSettings object is used to determine paths
-    qSettings = new QSettings(overridePath + QDir::separator() + appNameForFiles() + ".ini", QSettings::IniFormat);
+    qSettings = new WriteBehindSettings(overridePath + QDir::separator() + appNameForFiles() + ".ini", QSettings::IniFormat);
   else
     // Default settings path in roaming or other well known paths
-    qSettings = new QSettings(QSettings::IniFormat, QSettings::UserScope, orgNameForDirs(), appNameForFiles());
+    qSettings = new WriteBehindSettings(QSettings::IniFormat, QSettings::UserScope, orgNameForDirs(), appNameForFiles());
 
   QString path = QFileInfo(qSettings->fileName()).path();
   if(!QFileInfo::exists(path))
@@ -65,13 +90,59 @@ Settings::Settings()
     errorMessages.append(QStringLiteral("Settings file \"%1\" not writeable").arg(qSettings->fileName()));
 
   infoMessages.append(QStringLiteral("Using settings file \"%1\"").arg(qSettings->fileName()));
+
+  if(QCoreApplication::instance() != nullptr)
+  {
+    syncPool = new QThreadPool;
+    syncPool->setMaxThreadCount(1);
+
+    syncTimer = new QTimer;
+    syncTimer->setSingleShot(true);
+    syncTimer->setInterval(SYNC_DELAY_MS);
+    QObject::connect(syncTimer, &QTimer::timeout, syncTimer, [this]() {
+      syncBackground();
+    });
+  }
 }
 
 Settings::~Settings()
 {
+  delete syncTimer;
+  syncTimer = nullptr;
+
+  // Wait for background write before the final synchronous write in the destructor
+  if(syncPool != nullptr)
+    syncPool->waitForDone();
+  delete syncPool;
   delete qSettings;
 }
 
+void Settings::scheduleSync()
+{
+  // No application - writing is done on explicit call of syncSettings() or in destructor
+  if(syncTimer == nullptr)
+    return;
+
+  // Post timer start only once until the timer fires
+  if(!syncScheduled.exchange(true))
+    QMetaObject::invokeMethod(syncTimer, qOverload<>(&QTimer::start), Qt::QueuedConnection);
+}
+
+void Settings::syncBackground()
+{
+  syncScheduled.store(false);
+
+  QString filename = qSettings->fileName();
+  syncPool->start([filename]() {
+    // Changes are visible in all QSettings objects of the same file in the process
+    QSettings settings(filename, QSettings::IniFormat);
+    settings.sync();
+
+    if(settings.status() != QSettings::NoError)
+      qWarning() << Q_FUNC_INFO << "Error writing to settings file" << filename << "reason" << settings.status();
+  });
+}
+
 void Settings::createOverridePath()
 {
   if(!overridePath.isEmpty())
@@ -137,7 +208,7 @@ void Settings::clearAndShutdown()
   qDebug() << Q_FUNC_INFO;
 
   // Write current settings
-  syncSettings();
+  flushSettings();
 
   // Create a backup
   QFileInfo file(getFilename());
@@ -227,13 +298,29 @@ QVariant Settings::getAndStoreValue(const QString& key, const QVariant& defaultV
   else
   {
     settings->setValue(key, defaultValue);
+    settingsInstance->scheduleSync();
     return defaultValue;
   }
 }
 
 void Settings::syncSettings()
 {
-  QSettings *qs = getQSettings();
+  Settings& settings = instance();
+  if(settings.syncTimer != nullptr)
+    settings.scheduleSync();
+  else
+    // No application - write synchronously
+    flushSettings();
+}
+
+void Settings::flushSettings()
+{
+  Settings& settings = instance();
+
+  if(settings.syncPool != nullptr)
+    settings.syncPool->waitForDone();
+
+  QSettings *qs = settings.qSettings;
   qs->sync();
 
   if(qs->status() != QSettings::NoError)
@@ -258,6 +345,7 @@ bool Settings::contains(const QString& key) const
 void Settings::remove(const QString& key)
 {
   qSettings->remove(key);
+  scheduleSync();
 }
 
 QStringList Settings::valueStrList(const QString& key, const QStringList& defaultValue) const
@@ -314,41 +402,49 @@ void Settings::setValue(const QString& key, const QStringList& value)
     qSettings->setValue(key, QStringLiteral());
   else
     qSettings->setValue(key, value);
+  scheduleSync();
 }
 
 void Settings::setValue(const QString& key, const QString& value)
 {
   qSettings->setValue(key, value);
+  scheduleSync();
 }
 
 void Settings::setValue(const QString& key, bool value)
 {
   qSettings->setValue(key, value);
+  scheduleSync();
 }
 
 void Settings::setValue(const QString& key, int value)
 {
   qSettings->setValue(key, QString::number(value));
+  scheduleSync();
 }
 
 void Settings::setValue(const QString& key, long long value)
 {
   qSettings->setValue(key, QString::number(value));
+  scheduleSync();
 }
 
 void Settings::setValue(const QString& key, float value)
 {
   qSettings->setValue(key, QString::number(value, 'f', 10));
+  scheduleSync();
 }
 
 void Settings::setValue(const QString& key, double value)
 {
   qSettings->setValue(key, QString::number(value, 'f', 18));
+  scheduleSync();
 }
 
 void Settings::setValueVar(const QString& key, const QVariant& value)
 {
   qSettings->setValue(key, value);
+  scheduleSync();
 }
 
 QStringList Settings::childGroups() const
@@ -21,7 +21,11 @@
 #include <QString>
 #include <QVariant>
 
+#include <atomic>
+
 class QSettings;
+class QTimer;
+class QThreadPool;
 
 namespace atools {
 namespace settings {
@@ -34,6 +38,11 @@ namespace settings {
  * QCoreApplication::applicationName() in lowercase with
  * spaces replaced by underscrores.
  * If an error occurs sets error messsages.
+ *
+ * Changes are kept in memory by QSettings and written to the file in a background thread with a delay.
+ * This coalesces the many changes done by widget state savers into one write. The automatic
+ * synchronous write of QSettings in the event loop is suppressed.
+ * Background writing needs an application object. Otherwise all writes are synchronous.
  */
 class Settings
 {
@@ -121,9 +130,13 @@ public:
    * if not already present. Call syncSettings afterwards to write all defaults to the file. */
   QVariant getAndStoreValue(const QString& key, const QVariant& defaultValue = QVariant()) const;
 
-  /* Write settings to file and reload all changes in settings file */
+  /* Write settings to file and reload all changes in settings file.
+   * Writing is done with a delay in a background thread to coalesce changes. */
   static void syncSettings();
 
+  /* Waits for background writing and writes all pending changes synchronously. */
+  static void flushSettings();
+
   /* Remove all key/value pairs */
   static void clearSettings();
 
@@ -182,8 +195,21 @@ private:
   Settings();
   ~Settings();
 
+  /* Start delayed background write if not already scheduled. Thread safe. */
+  void scheduleSync();
+
+  /* Called by timer. Writes changes in background thread. */
+  void syncBackground();
+
   QSettings *qSettings;
 
+  /* Delays writing to coalesce changes. Null if there was no application object on creation. */
+  QTimer *syncTimer = nullptr;
+
+  /* Single thread for writing */
+  QThreadPool *syncPool = nullptr;
+  std::atomic_bool syncScheduled = false;
+
   /* Create dirs relative to app dir or based on absolute path */
   static void createOverridePath();
 
@@ -21,6 +21,7 @@
 #include "exception.h"
 #include "sql/sqlrecord.h"
 #include "geo/pos.h"
+#include "sql/sqlcachedquery.h"
 #include "sql/sqldatabase.h"
 #include "sql/sqlscript.h"
 #include "sql/sqltransaction.h"
@@ -92,6 +93,7 @@ void DataManagerBase::createSchema(bool verboseLogging)
   transaction.commit();
 
   updateUndoRedoActions();
+  tableChanged();
 }
 
 void DataManagerBase::updateSchema()
@@ -99,6 +101,16 @@ void DataManagerBase::updateSchema()
   // No-op
 }
 
+void DataManagerBase::rowsChanged(const QSet<int>&)
+{
+  // No-op
+}
+
+void DataManagerBase::tableChanged()
+{
+  // No-op
+}
+
 void DataManagerBase::updateUndoSchema()
 {
   if(!hasUndoSchema() && !createUndoScript.isEmpty())
@@ -126,6 +138,7 @@ void DataManagerBase::dropSchema()
   SqlScript script(db, true);
   script.executeScript(dropScript);
   transaction.commit();
+  tableChanged();
 }
 
 void DataManagerBase::initCurrentId()
@@ -198,6 +211,7 @@ void DataManagerBase::insertOneRecord(SqlRecord record, int id)
 
   queryInsertRecords->bindAndExecRecord(record, ":");
   postUndo();
+  rowsChanged({id});
 }
 
 void DataManagerBase::insertRecords(sql::SqlRecordList records)
@@ -205,12 +219,18 @@ void DataManagerBase::insertRecords(sql::SqlRecordList records)
   initCurrentId();
 
   // Insert id in records if id column is 0 or missing
+  QSet<int> ids;
   for(SqlRecord& record : records)
-    updateIdColumn(record, getNextId());
+  {
+    int id = getNextId();
+    updateIdColumn(record, id);
+    ids.insert(id);
+  }
 
   preUndoInsert(records);
   queryInsertRecords->bindAndExecRecords(records, ":");
   postUndo();
+  rowsChanged(ids);
 }
 
 void DataManagerBase::insertRecords(const SqlRecordList& records, const QString& table)
@@ -221,6 +241,9 @@ void DataManagerBase::insertRecords(const SqlRecordList& records, const QString&
   SqlQuery insert(db);
   insert.prepare(util->buildInsertStatement(table));
   insert.bindAndExecRecords(records, ":");
+
+  if(table == tableName)
+    tableChanged();
 }
 
 void DataManagerBase::updateField(const QString& column, const QSet<int>& ids, const QVariant& value)
@@ -229,18 +252,33 @@ void DataManagerBase::updateField(const QString& column, const QSet<int>& ids, c
   {
     preUndoUpdate(ids);
     SqlQuery query(db);
-    query.prepare("update " + tableName + " set " + column + " = ? where " + idColumnName + " = ?");
 
-    for(int id : ids)
+    if(isSetBased(ids))
     {
-      // Update field for all rows with the given id
+      // Update all rows in one statement
+      fillIdTable(ids);
+      query.prepare("update " % tableName % " set " % column % " = ? where " % idColumnName % " in " % idTableSelect());
       query.bindValue(0, value);
-      query.bindValue(1, id);
       query.exec();
-      if(query.numRowsAffected() != 1)
-        qWarning() << Q_FUNC_INFO << "query.numRowsAffected() != 1";
+      if(query.numRowsAffected() != ids.size())
+        qWarning() << Q_FUNC_INFO << "query.numRowsAffected() != ids.size()";
+    }
+    else
+    {
+      query.prepare("update " + tableName + " set " + column + " = ? where " + idColumnName + " = ?");
+
+      for(int id : ids)
+      {
+        // Update field for all rows with the given id
+        query.bindValue(0, value);
+        query.bindValue(1, id);
+        query.exec();
+        if(query.numRowsAffected() != 1)
+          qWarning() << Q_FUNC_INFO << "query.numRowsAffected() != 1";
+      }
     }
     postUndo();
+    rowsChanged(ids);
   }
 }
 
@@ -260,6 +298,7 @@ void DataManagerBase::updateRecords(const sql::SqlRecord& record, const QSet<int
     preUndoUpdate(ids);
     updateRecordsInternal(record, ids);
     postUndo();
+    rowsChanged(ids);
   }
 }
 
@@ -277,6 +316,19 @@ void DataManagerBase::updateRecordsInternal(sql::SqlRecord record, const QSet<in
       binds.append(field % " = :" % field);
 
     SqlQuery query(db);
+
+    if(isSetBased(ids))
+    {
+      // Update all rows in one statement
+      fillIdTable(ids);
+      query.prepare("update " % tableName % " set " % binds.join(", ") % " where " % idColumnName % " in " % idTableSelect());
+      query.bindRecord(record, ":");
+      query.exec();
+      if(query.numRowsAffected() != ids.size())
+        qWarning() << Q_FUNC_INFO << "query.numRowsAffected() != ids.size()";
+      return;
+    }
+
     query.prepare("update " % tableName % " set " % binds.join(", ") % " where " % idColumnName % " = :id");
 
     // Bind all record values
@@ -298,6 +350,7 @@ void DataManagerBase::deleteAllRows()
   preUndoDeleteAll();
   SqlQuery("delete from " % tableName, db).exec();
   postUndo();
+  tableChanged();
 }
 
 void DataManagerBase::deleteOneRow(int id)
@@ -305,6 +358,7 @@ void DataManagerBase::deleteOneRow(int id)
   preUndoDelete({id});
   deleteRowsInternal({id});
   postUndo();
+  rowsChanged({id});
 }
 
 void DataManagerBase::deleteRows(const QSet<int>& ids)
@@ -314,6 +368,7 @@ void DataManagerBase::deleteRows(const QSet<int>& ids)
     preUndoDelete(ids);
     deleteRowsInternal(ids);
     postUndo();
+    rowsChanged(ids);
   }
 }
 
@@ -322,10 +377,24 @@ void DataManagerBase::deleteAllRows(const QString& table)
   // Undo not supported for this method
   checkUndoTable(table);
   SqlQuery("delete from " % table, db).exec();
+
+  if(table == tableName)
+    tableChanged();
 }
 
 void DataManagerBase::deleteRowsInternal(const QSet<int>& ids)
 {
+  if(isSetBased(ids))
+  {
+    // Delete all rows in one statement
+    fillIdTable(ids);
+    SqlQuery query(db);
+    query.exec("delete from " % tableName % " where " % idColumnName % " in " % idTableSelect());
+    if(query.numRowsAffected() != ids.size())
+      qWarning() << Q_FUNC_INFO << "query.numRowsAffected() != ids.size()";
+    return;
+  }
+
   for(int id : ids)
   {
     queryDeleteRowById->bindValue(0, id);
@@ -359,6 +428,9 @@ void DataManagerBase::deleteRows(const QString& table, const QString& column, co
   query.prepare("delete from " + table + " where " + column + " = ?");
   query.bindValue(0, value);
   query.exec();
+
+  if(table == tableName)
+    tableChanged();
 }
 
 void DataManagerBase::getValues(QVariantList& values, const QSet<int>& ids, const QString& colName) const
@@ -551,23 +623,22 @@ void DataManagerBase::postUndoBulkInsert()
     initCurrentId();
     db->analyze(); // Avoid long running queries
 
-    // Fetch all ids that were inserted in the bulk import
-    SqlQuery select(db);
-    select.prepare("select * from " % tableName % " where " % idColumnName % " between ? and ?");
-    select.bindValue(0, preBulkInsertId);
-    select.bindValue(1, currentId);
-    select.exec();
+    // Copy all rows inserted in the bulk import to the undo table in one statement - this is one undo group
+    // Undo ids are derived from the unique row ids
+    QString columns = db->record(tableName).fieldNames().join(", ");
+    SqlQuery insert(db);
+    insert.prepare("insert into undo_data (undo_data_id, undo_group_id, undo_type, " % columns % ") "
+                   "select :undoid + " % idColumnName % " - :offsetid + 1, :groupid, :type, " % columns %
+                   " from " % tableName % " where " % idColumnName % " between :fromid and :toid");
+    insert.bindValue(":undoid", currentUndoId);
+    insert.bindValue(":offsetid", preBulkInsertId);
+    insert.bindValue(":fromid", preBulkInsertId);
+    insert.bindValue(":toid", currentId);
+    insert.bindValue(":groupid", currentUndoGroupId);
+    insert.bindValue(":type", atools::charToStr(UNDO_INSERT));
+    insert.exec();
 
-    // Add all  records to the undo table - this is one undo group
-    while(select.next())
-    {
-      SqlRecord rec = select.record();
-      rec.insertFieldAndValue(0, "undo_data_id", ++currentUndoId);
-      rec.insertFieldAndValue(1, "undo_group_id", currentUndoGroupId);
-      rec.insertFieldAndValue(2, "undo_type", atools::charToStr(UNDO_INSERT));
-      queryInsertUndoData->bindRecord(rec, ":");
-      queryInsertUndoData->exec();
-    }
+    currentUndoId = util->getMaxId("undo_data", "undo_data_id");
 
     // Update current id
     preBulkInsertId = -1;
@@ -579,6 +650,7 @@ void DataManagerBase::postUndoBulkInsert()
 
   // get current (max) id from table
   initCurrentId();
+  tableChanged();
 }
 
 void DataManagerBase::preUndoDeleteAll()
@@ -591,9 +663,12 @@ void DataManagerBase::preUndoDeleteAll()
     // Add all records to delete to the undo table
     SqlQuery selectQuery("select * from " % tableName, db);
     selectQuery.exec();
+
+    // Columns of "select *" are in table order - resolve placeholders once
+    const QList<int> indexes = SqlUtil::copyRowIndexes(db->record(tableName), *queryInsertUndoData);
     while(selectQuery.next())
     {
-      SqlUtil::copyRowValues(selectQuery, *queryInsertUndoData);
+      SqlUtil::copyRowValues(selectQuery, *queryInsertUndoData, indexes);
 
       queryInsertUndoData->bindValue(":undo_data_id", ++currentUndoId);
       queryInsertUndoData->bindValue(":undo_group_id", currentUndoGroupId);
@@ -620,11 +695,31 @@ void DataManagerBase::preUndoCopyInternal(const QSet<int>& ids, UndoAction actio
     truncateUndoIf();
     currentUndoGroupId++;
 
+    if(isSetBased(ids))
+    {
+      // Copy all rows into the undo table in one statement - undo ids are numbered consecutively
+      fillIdTable(ids);
+      QString columns = db->record(tableName).fieldNames().join(", ");
+      SqlQuery insert(db);
+      insert.prepare("insert into undo_data (undo_data_id, undo_group_id, undo_type, " % columns % ") "
+                     "select :undoid + row_number() over (order by " % idColumnName % "), :groupid, :type, " % columns %
+                     " from " % tableName % " where " % idColumnName % " in " % idTableSelect());
+      insert.bindValue(":undoid", currentUndoId);
+      insert.bindValue(":groupid", currentUndoGroupId);
+      insert.bindValue(":type", atools::charToStr(action));
+      insert.exec();
+      currentUndoId += insert.numRowsAffected();
+      return;
+    }
+
     QueryWrapper wrapped("select * from " % tableName, db, ids, idColumnName);
     wrapped.exec();
+
+    // Columns of "select *" are in table order - resolve placeholders once
+    const QList<int> indexes = SqlUtil::copyRowIndexes(db->record(tableName), *queryInsertUndoData);
     while(wrapped.next())
     {
-      SqlUtil::copyRowValues(wrapped.query, *queryInsertUndoData);
+      SqlUtil::copyRowValues(wrapped.query, *queryInsertUndoData, indexes);
 
       queryInsertUndoData->bindValue(":undo_data_id", ++currentUndoId);
       queryInsertUndoData->bindValue(":undo_group_id", currentUndoGroupId);
@@ -654,6 +749,7 @@ void DataManagerBase::undoRedo(bool undo)
 {
   bool canceled = false;
   int undoGroupId = currentUndoGroupId;
+  QSet<int> changedIds;
 
   if(undoActive)
   {
@@ -661,76 +757,84 @@ void DataManagerBase::undoRedo(bool undo)
       // Increment before for redo
       undoGroupId++;
 
-    int total = undoRedoStepCount(undo, nullptr), current = 0;
-
-    // Get all records from the undo table for the current step to undo/redo
-    selectUndoByGroup->bindValue(":id", undoGroupId);
-    selectUndoByGroup->exec();
+    UndoAction groupAction = UNDO_INVALID;
+    int total = undoRedoStepCount(undo, &groupAction), current = 0;
 
-    while(selectUndoByGroup->next())
+    if(total >= MIN_IDS_SET_BASED && (groupAction == UNDO_INSERT || groupAction == UNDO_DELETE))
+      // Inserts and deletes of large groups are reverted or repeated with one statement
+      undoRedoSetBased(undoGroupId, undo == (groupAction == UNDO_DELETE) /* insert */, changedIds);
+    else
     {
-      SqlRecord undoRec = selectUndoByGroup->record();
-
-      // Get all undo table values before removing the fields
-      UndoAction action = static_cast<UndoAction>(atools::strToChar(undoRec.valueStr("undo_type")));
-      int id = undoRec.valueInt(idColumnName);
-      int undoDataId = undoRec.valueInt("undo_data_id");
-
-      // Get rid if fields except the ones from the main table
-      undoRec.remove({"undo_data_id", "undo_group_id", "undo_type"});
+      // Get all records from the undo table for the current step to undo/redo
+      selectUndoByGroup->bindValue(":id", undoGroupId);
+      selectUndoByGroup->exec();
 
-      switch(action)
+      while(selectUndoByGroup->next())
       {
-        case atools::sql::DataManagerBase::UNDO_INSERT:
-          if(undo)
-            // Revert insert - delete value and keep copy in undo table for redo
-            deleteRowsInternal({id});
-          else
-          {
-            // Insert again - keep copy in undo table for undo
-            updateIdColumn(undoRec, id);
-            queryInsertRecords->bindAndExecRecord(undoRec, ":");
-          }
-          break;
-
-        case atools::sql::DataManagerBase::UNDO_UPDATE:
-          {
-            // Undo: Revert update - swap values
-            // Redo: Apply update again - swap values
-
-            // Get temporary values from main table
-            SqlRecord tempRecord = getRecord(id);
-
-            // Copy from undo table back to original table
-            updateRecordsInternal(undoRec, {id});
-
-            // Update undo table with temp value from original table
-            updateUndoById->bindRecord(tempRecord, ":");
-            updateUndoById->bindValue(":id", undoDataId);
-            updateUndoById->exec();
-          }
-          break;
-
-        case atools::sql::DataManagerBase::UNDO_DELETE:
-          if(undo)
-          {
-            // Revert delete - insert values from undo table and keep copy in undo table for redo
-            updateIdColumn(undoRec, id);
-            queryInsertRecords->bindAndExecRecord(undoRec, ":");
-          }
-          else
-            // Delete again - keep copy in undo table for undo
-            deleteRowsInternal({id});
-          break;
-
-        case atools::sql::DataManagerBase::UNDO_INVALID:
+        SqlRecord undoRec = selectUndoByGroup->record();
+
+        // Get all undo table values before removing the fields
+        UndoAction action = static_cast<UndoAction>(atools::strToChar(undoRec.valueStr("undo_type")));
+        int id = undoRec.valueInt(idColumnName);
+        int undoDataId = undoRec.valueInt("undo_data_id");
+
+        // Get rid if fields except the ones from the main table
+        undoRec.remove({"undo_data_id", "undo_group_id", "undo_type"});
+        changedIds.insert(id);
+
+        switch(action)
+        {
+          case atools::sql::DataManagerBase::UNDO_INSERT:
+            if(undo)
+              // Revert insert - delete value and keep copy in undo table for redo
+              deleteRowsInternal({id});
+            else
+            {
+              // Insert again - keep copy in undo table for undo
+              updateIdColumn(undoRec, id);
+              queryInsertRecords->bindAndExecRecord(undoRec, ":");
+            }
+            break;
+
+          case atools::sql::DataManagerBase::UNDO_UPDATE:
+            {
+              // Undo: Revert update - swap values
+              // Redo: Apply update again - swap values
+
+              // Get temporary values from main table
+              SqlRecord tempRecord = getRecord(id);
+
+              // Copy from undo table back to original table
+              updateRecordsInternal(undoRec, {id});
+
+              // Update undo table with temp value from original table
+              updateUndoById->bindRecord(tempRecord, ":");
+              updateUndoById->bindValue(":id", undoDataId);
+              updateUndoById->exec();
+            }
+            break;
+
+          case atools::sql::DataManagerBase::UNDO_DELETE:
+            if(undo)
+            {
+              // Revert delete - insert values from undo table and keep copy in undo table for redo
+              updateIdColumn(undoRec, id);
+              queryInsertRecords->bindAndExecRecord(undoRec, ":");
+            }
+            else
+              // Delete again - keep copy in undo table for undo
+              deleteRowsInternal({id});
+            break;
+
+          case atools::sql::DataManagerBase::UNDO_INVALID:
+            break;
+        }
+
+        if(!invokeCallback(total, current++))
+        {
+          canceled = true;
           break;
-      }
-
-      if(!invokeCallback(total, current++))
-      {
-        canceled = true;
-        break;
+        }
       }
     }
 
@@ -744,9 +848,36 @@ void DataManagerBase::undoRedo(bool undo)
       syncCurrentUndoGroupToDb();
       updateUndoRedoActions();
     }
+
+    rowsChanged(changedIds);
   }
 }
 
+void DataManagerBase::undoRedoSetBased(int undoGroupId, bool insert, QSet<int>& changedIds)
+{
+  SqlQuery query(db);
+  query.prepare("select " % idColumnName % " from undo_data where undo_group_id = ?");
+  query.bindValue(0, undoGroupId);
+  query.exec();
+  while(query.next())
+    changedIds.insert(query.valueInt(0));
+
+  if(insert)
+  {
+    // Insert rows again from undo table - keep copy in undo table
+    QString columns = db->record(tableName).fieldNames().join(", ");
+    query.prepare("insert into " % tableName % " (" % columns % ") select " % columns %
+                  " from undo_data where undo_group_id = ?");
+  }
+  else
+    // Delete rows - keep copy in undo table
+    query.prepare("delete from " % tableName % " where " % idColumnName %
+                  " in (select " % idColumnName % " from undo_data where undo_group_id = ?)");
+
+  query.bindValue(0, undoGroupId);
+  query.exec();
+}
+
 void DataManagerBase::updateUndoRedoActions()
 {
   if(undoAction != nullptr || redoAction != nullptr)
@@ -1008,6 +1139,59 @@ void DataManagerBase::deInitQueries()
 
   delete querySelectById;
   querySelectById = nullptr;
+
+  delete queryInsertTempId;
+  queryInsertTempId = nullptr;
+}
+
+bool DataManagerBase::isSetBased(const QSet<int>& ids) const
+{
+  return ids.size() >= MIN_IDS_SET_BASED;
+}
+
+QString DataManagerBase::idTableSelect() const
+{
+  return "(select id from temp." % tableName % "_ids)";
+}
+
+void DataManagerBase::fillIdTable(const QSet<int>& ids)
+{
+  if(queryInsertTempId == nullptr)
+  {
+    // Temporary table is private to the connection and dropped on close
+    SqlQuery("create temp table if not exists " % tableName % "_ids (id integer primary key)", db).exec();
+
+    queryInsertTempId = new SqlQuery(db);
+    queryInsertTempId->prepare("insert into temp." % tableName % "_ids (id) values(?)");
+  }
+
+  SqlCachedQuery("delete from temp." % tableName % "_ids", db)->exec();
+  for(int id : ids)
+  {
+    queryInsertTempId->bindValue(0, id);
+    queryInsertTempId->exec();
+  }
+}
+
+void DataManagerBase::startImportCallback()
+{
+  importStartTime = importCallbackTime = QDateTime::currentMSecsSinceEpoch();
+}
+
+bool DataManagerBase::invokeImportCallback(int numRows, bool force)
+{
+  if(importCallback)
+  {
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    // Check every 0.25 seconds
+    if(force || now > importCallbackTime + 250)
+    {
+      importCallbackTime = now;
+      float rowsPerSecond = now > importStartTime ? numRows * 1000.f / static_cast<float>(now - importStartTime) : 0.f;
+      return importCallback(numRows, rowsPerSecond);
+    }
+  }
+  return true;
 }
 
 bool DataManagerBase::invokeCallback(int totalNumber, int currentNumber)
@@ -260,6 +260,15 @@ public:
     callback = progressCallback;
   }
 
+  /* Called during file imports with rows imported so far and the current import rate.
+   * return false to stop import. Rows imported until then are kept. */
+  typedef std::function<bool (int numRows, float rowsPerSecond)> ImportCallbackType;
+
+  void setImportCallback(ImportCallbackType importCallbackParam)
+  {
+    importCallback = importCallbackParam;
+  }
+
 protected:
   /*
    * Simple SqlQuery wrapper which can be used to export all rows or a list of rows by id
@@ -323,6 +332,29 @@ private:
    * Clean up - set empty string columns back to null - no need to undo. */
   void postCleanup(const QStringList& columns);
 
+  /* Called after rows of the main table were inserted, updated or deleted including undo and redo.
+   * Default implementation does nothing. */
+  virtual void rowsChanged(const QSet<int>& ids);
+
+  /* Called after an unknown number of rows in the main table was changed, e.g. by deleting all or by a bulk
+   * insert. Subclasses modifying the table directly have to call this too. Default implementation does nothing. */
+  virtual void tableChanged();
+
+  /* True if ids are enough to use statements on the temporary id table instead of one statement per id */
+  bool isSetBased(const QSet<int>& ids) const;
+
+  /* Fill temporary table with ids. Creates the table on first use. */
+  void fillIdTable(const QSet<int>& ids);
+
+  /* Sub-select for the temporary id table for "where id in" */
+  QString idTableSelect() const;
+
+  /* Start measuring import rate for invokeImportCallback() */
+  void startImportCallback();
+
+  /* Call import callback at most every 0.25 seconds or always if force is true. Returns false if import should stop. */
+  bool invokeImportCallback(int numRows, bool force = false);
+
   /* Prints a warning of colummn does not exist */
   QString at(const QStringList& line, int index, bool nowarn = false);
 
@@ -360,6 +392,9 @@ private:
 
   void undoRedo(bool undo);
 
+  /* Revert or repeat a whole group of inserts or deletes using one statement. Adds affected ids to changedIds. */
+  void undoRedoSetBased(int undoGroupId, bool insert, QSet<int>& changedIds);
+
   QString undoRedoStepName(bool undo) const;
 
   /* Check if user tries to modify main table bypassing undo with undo system enabled. Throws exception. */
@@ -395,10 +430,16 @@ private:
   atools::sql::SqlQuery *queryUndoCurrent = nullptr, *queryTruncateUndoData = nullptr, *selectMinMax = nullptr,
                         *queryTruncateUndoDataCurrent = nullptr, *querySelectUndoByGroup = nullptr, *updateUndoById = nullptr,
                         *selectUndoByGroup = nullptr, *queryInsertUndoData = nullptr, *queryDeleteRowById = nullptr,
-                        *queryInsertRecords = nullptr, *querySelectById = nullptr;
+                        *queryInsertRecords = nullptr, *querySelectById = nullptr, *queryInsertTempId = nullptr;
+
+  /* Minimum number of ids to use set based statements for updates, deletes and undo copies */
+  const static int MIN_IDS_SET_BASED = 16;
 
   UndoRedoCallbackType callback;
   qint64 callbackTime = 0L;
+
+  ImportCallbackType importCallback;
+  qint64 importStartTime = 0L, importCallbackTime = 0L;
 };
 
 /* Creates bulk before insert. Aborts bulk insert in destructor. */
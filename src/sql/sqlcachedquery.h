@@ -0,0 +1,65 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_SQL_SQLCACHEDQUERY_H
+#define ATOOLS_SQL_SQLCACHEDQUERY_H
+
+class QString;
+
+namespace atools {
+namespace sql {
+
+class SqlDatabase;
+class SqlQuery;
+
+/*
+ * Helper class which takes a prepared query from the statement cache of the database connection on
+ * instantiation and gives it back on destruction. Saves the statement compilation for repeatedly used SQL.
+ *
+ * The query is finished and bound values are cleared when given back.
+ */
+class SqlCachedQuery
+{
+public:
+  SqlCachedQuery(const QString& queryString, const atools::sql::SqlDatabase& sqlDb);
+  SqlCachedQuery(const QString& queryString, const atools::sql::SqlDatabase *sqlDb);
+
+  /* Gives query back to the cache */
+  ~SqlCachedQuery();
+
+  SqlCachedQuery(const SqlCachedQuery& other) = delete;
+  SqlCachedQuery& operator=(const SqlCachedQuery& other) = delete;
+
+  atools::sql::SqlQuery *operator->() const
+  {
+    return query;
+  }
+
+  atools::sql::SqlQuery& operator*() const
+  {
+    return *query;
+  }
+
+private:
+  const atools::sql::SqlDatabase *db;
+  atools::sql::SqlQuery *query;
+};
+
+} // namespace sql
+} // namespace atools
+
+#endif // ATOOLS_SQL_SQLCACHEDQUERY_H
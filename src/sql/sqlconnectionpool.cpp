@@ -0,0 +1,198 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "sql/sqlconnectionpool.h"
+
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+
+#include <QDebug>
+#include <QStringBuilder>
+#include <QThread>
+
+namespace atools {
+namespace sql {
+
+using atools::sql::pool::Connection;
+
+// ====================================================================================================
+SqlConnectionHandle::SqlConnectionHandle(Connection *connectionParam)
+  : connection(connectionParam)
+{
+  connection->useCount++;
+}
+
+SqlConnectionHandle::SqlConnectionHandle(SqlConnectionHandle&& other)
+  : connection(other.connection)
+{
+  other.connection = nullptr;
+}
+
+SqlConnectionHandle::~SqlConnectionHandle()
+{
+  // Only accessed by owning thread - no locking needed
+  if(connection != nullptr && --connection->useCount == 0)
+  {
+    // Reset all queries to release read locks
+    for(SqlQuery *query : std::as_const(connection->usedQueries))
+      query->finish();
+    connection->usedQueries.clear();
+  }
+}
+
+SqlQuery& SqlConnectionHandle::query(const QString& queryString)
+{
+  SqlQuery *query = connection->queries.value(queryString, nullptr);
+  if(query == nullptr)
+  {
+    query = new SqlQuery(connection->db);
+    query->prepare(queryString);
+    connection->queries.insert(queryString, query);
+  }
+
+  if(!connection->usedQueries.contains(query))
+    connection->usedQueries.append(query);
+  return *query;
+}
+
+// ====================================================================================================
+SqlConnectionPool::SqlConnectionPool(const QString& filenameParam, const QString& connectionPrefixParam,
+                                     const QStringList& pragmasParam, bool walModeParam, qint64 mmapSizeParam)
+  : filename(filenameParam), connectionPrefix(connectionPrefixParam), pragmas(pragmasParam), walMode(walModeParam),
+  mmapSize(mmapSizeParam)
+{
+}
+
+SqlConnectionPool::~SqlConnectionPool()
+{
+  QMutexLocker locker(&mutex);
+
+  if(!connections.isEmpty())
+    qDebug() << Q_FUNC_INFO << "Closing" << connections.size() << "connections for" << filename;
+
+  // Connections of threads still running are closed from this thread which is safe for SQLite if unused
+  const QList<Connection *> conns = connections.values();
+  for(Connection *connection : conns)
+  {
+    if(connection->useCount > 0)
+      qWarning() << Q_FUNC_INFO << "Connection in use" << connection->db->connectionName();
+    closeConnection(connection);
+  }
+}
+
+SqlConnectionHandle SqlConnectionPool::acquire()
+{
+  QThread *thread = QThread::currentThread();
+
+  QMutexLocker locker(&mutex);
+  Connection *connection = connections.value(thread, nullptr);
+  if(connection == nullptr)
+  {
+    connection = openConnection(thread);
+    connections.insert(thread, connection);
+  }
+  return SqlConnectionHandle(connection);
+}
+
+void SqlConnectionPool::releaseThread()
+{
+  QMutexLocker locker(&mutex);
+  Connection *connection = connections.value(QThread::currentThread(), nullptr);
+  if(connection != nullptr)
+  {
+    if(connection->useCount > 0)
+      qWarning() << Q_FUNC_INFO << "Connection in use" << connection->db->connectionName();
+    else
+      closeConnection(connection);
+  }
+}
+
+int SqlConnectionPool::size() const
+{
+  QMutexLocker locker(&mutex);
+  return static_cast<int>(connections.size());
+}
+
+Connection *SqlConnectionPool::openConnection(QThread *thread)
+{
+  QString name = connectionPrefix % "_" % QString::number(++connectionCounter);
+
+  QStringList allPragmas;
+  if(walMode)
+    // Needs a writeable connection - query_only prevents changes
+    allPragmas.append("PRAGMA journal_mode=WAL");
+  allPragmas.append("PRAGMA mmap_size=" % QString::number(mmapSize));
+  allPragmas.append("PRAGMA query_only=ON");
+  allPragmas.append(pragmas);
+
+  SqlDatabase *db = new SqlDatabase(SqlDatabase::addDatabase("QSQLITE", name));
+  try
+  {
+    db->setDatabaseName(filename);
+    db->setAutomaticTransactions(false);
+    db->setProfiler(profiler);
+    db->open(allPragmas, !walMode /* readonly */);
+  }
+  catch(...)
+  {
+    delete db;
+    SqlDatabase::removeDatabase(name);
+    throw;
+  }
+
+  Connection *connection = new Connection;
+  connection->thread = thread;
+  connection->db = db;
+
+  // Close connection in the finishing thread which owns it
+  connection->finishedConnection = QObject::connect(thread, &QThread::finished, thread, [this, thread]() {
+          threadFinished(thread);
+        }, Qt::DirectConnection);
+
+  qDebug() << Q_FUNC_INFO << "Opened" << name << "for thread" << thread->objectName() << filename;
+  return connection;
+}
+
+void SqlConnectionPool::closeConnection(Connection *connection)
+{
+  QObject::disconnect(connection->finishedConnection);
+
+  // Delete queries first since these keep references to the database
+  qDeleteAll(connection->queries);
+  connection->queries.clear();
+  connection->usedQueries.clear();
+
+  QString name = connection->db->connectionName();
+  if(connection->db->isOpen())
+    connection->db->close();
+  delete connection->db;
+  SqlDatabase::removeDatabase(name);
+
+  connections.remove(connection->thread);
+  delete connection;
+}
+
+void SqlConnectionPool::threadFinished(QThread *thread)
+{
+  QMutexLocker locker(&mutex);
+  Connection *connection = connections.value(thread, nullptr);
+  if(connection != nullptr)
+    closeConnection(connection);
+}
+
+} // namespace sql
+} // namespace atools
@@ -0,0 +1,174 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_SQL_SQLCONNECTIONPOOL_H
+#define ATOOLS_SQL_SQLCONNECTIONPOOL_H
+
+#include <QHash>
+#include <QMetaObject>
+#include <QMutex>
+#include <QStringList>
+
+class QThread;
+
+namespace atools {
+namespace sql {
+
+class SqlDatabase;
+class SqlQuery;
+class SqlProfiler;
+class SqlConnectionPool;
+
+namespace pool {
+
+/* One connection owned by a thread. The connection and queries are only used by this thread. */
+struct Connection
+{
+  QThread *thread = nullptr;
+  atools::sql::SqlDatabase *db = nullptr;
+
+  /* Prepared queries by SQL text */
+  QHash<QString, atools::sql::SqlQuery *> queries;
+
+  /* Queries used by the current handles which are reset when the last handle is released */
+  QList<atools::sql::SqlQuery *> usedQueries;
+
+  /* Number of handles alive in the thread */
+  int useCount = 0;
+
+  /* Thread finished signal connection */
+  QMetaObject::Connection finishedConnection;
+};
+
+}
+
+/*
+ * Access to a pooled connection for the calling thread. Releases the connection back to the pool when destroyed.
+ * Must not be passed to other threads. Movable but not copyable.
+ */
+class SqlConnectionHandle
+{
+public:
+  SqlConnectionHandle(SqlConnectionHandle&& other);
+  ~SqlConnectionHandle();
+
+  SqlConnectionHandle(const SqlConnectionHandle& other) = delete;
+  SqlConnectionHandle& operator=(const SqlConnectionHandle& other) = delete;
+
+  /* Open read only database for the current thread */
+  atools::sql::SqlDatabase *getDatabase() const
+  {
+    return connection->db;
+  }
+
+  atools::sql::SqlDatabase *operator->() const
+  {
+    return connection->db;
+  }
+
+  /* Get a query prepared for the SQL text. Queries are kept by the connection and prepared only once.
+   * Bound values are kept and the query is finished when the last handle of this thread is released. */
+  atools::sql::SqlQuery& query(const QString& queryString);
+
+private:
+  friend class atools::sql::SqlConnectionPool;
+
+  explicit SqlConnectionHandle(atools::sql::pool::Connection *connectionParam);
+
+  atools::sql::pool::Connection *connection = nullptr;
+};
+
+/*
+ * Pool of read only SQLite connections on the same database file. Opens one connection lazily for each
+ * thread calling acquire() since QSqlDatabase connections cannot be shared between threads.
+ *
+ * Connections are opened with "query_only" and a memory mapped I/O size which allows the operating system to
+ * share pages between all connections. Optionally switches the database file into WAL journal mode which lets
+ * readers run concurrently with a writer.
+ *
+ * A connection is closed automatically when its thread finishes or by calling releaseThread() from the thread.
+ * Remaining connections are closed when the pool is deleted which should happen after all threads using
+ * it are finished.
+ *
+ * acquire() is thread safe.
+ */
+class SqlConnectionPool
+{
+public:
+  /* filename is the SQLite database file. connectionPrefix is used to build unique connection names.
+   * Pragmas are executed after the default pragmas for each new connection. */
+  SqlConnectionPool(const QString& filenameParam, const QString& connectionPrefixParam,
+                    const QStringList& pragmasParam = QStringList(), bool walModeParam = false,
+                    qint64 mmapSizeParam = DEFAULT_MMAP_SIZE);
+  ~SqlConnectionPool();
+
+  SqlConnectionPool(const SqlConnectionPool& other) = delete;
+  SqlConnectionPool& operator=(const SqlConnectionPool& other) = delete;
+
+  /* Get a handle to the connection of the calling thread. Opens the connection if needed.
+   * Throws SqlException if the database cannot be opened. */
+  atools::sql::SqlConnectionHandle acquire();
+
+  /* Close the connection of the calling thread if there are no handles alive anymore */
+  void releaseThread();
+
+  /* Number of open connections */
+  int size() const;
+
+  /* Profiler which is attached to all connections opened afterwards. Not owned. */
+  void setProfiler(atools::sql::SqlProfiler *value)
+  {
+    profiler = value;
+  }
+
+  const QString& getFilename() const
+  {
+    return filename;
+  }
+
+  /* Default size for pragma mmap_size */
+  const static qint64 DEFAULT_MMAP_SIZE = 256LL * 1024LL * 1024LL;
+
+private:
+  atools::sql::pool::Connection *openConnection(QThread *thread);
+
+  /* Close and remove connection. Has to be called with locked mutex. */
+  void closeConnection(atools::sql::pool::Connection *connection);
+
+  /* Called by thread finished signal in the finishing thread */
+  void threadFinished(QThread *thread);
+
+  QString filename, connectionPrefix;
+  QStringList pragmas;
+  bool walMode;
+  qint64 mmapSize;
+
+  atools::sql::SqlProfiler *profiler = nullptr;
+
+  /* Connections by owning thread */
+  QHash<QThread *, atools::sql::pool::Connection *> connections;
+
+  /* Used to build unique connection names */
+  int connectionCounter = 0;
+
+  mutable QMutex mutex;
+};
+
+} // namespace sql
+} // namespace atools
+
+#endif // ATOOLS_SQL_SQLCONNECTIONPOOL_H
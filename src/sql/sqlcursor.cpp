@@ -0,0 +1,78 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "sql/sqlcursor.h"
+
+#include "sql/sqlexception.h"
+
+#include <QSqlRecord>
+#include <QStringBuilder>
+
+namespace atools {
+namespace sql {
+
+SqlCursor::SqlCursor(const QString& queryString, const SqlDatabase *db)
+  : query(new SqlQuery(db)), ownQuery(true)
+{
+  raw = &query->query;
+  try
+  {
+    query->prepare(queryString);
+    execute();
+  }
+  catch(...)
+  {
+    delete query;
+    throw;
+  }
+}
+
+SqlCursor::SqlCursor(SqlQuery& sqlQuery)
+  : query(&sqlQuery), ownQuery(false)
+{
+  raw = &query->query;
+  execute();
+}
+
+SqlCursor::~SqlCursor()
+{
+  if(ownQuery)
+    delete query;
+  else
+    query->finish();
+}
+
+void SqlCursor::execute()
+{
+  query->setForwardOnly(true);
+  query->exec();
+
+  if(!query->isSelect())
+    throw SqlException(query, QLatin1String(Q_FUNC_INFO) % ": Query is not a select");
+}
+
+int SqlCursor::column(const QString& name, bool required) const
+{
+  int index = raw->record().indexOf(name);
+  if(index == -1 && required)
+    throw SqlException(query, QLatin1String(Q_FUNC_INFO) % ": Column \"" % name % "\" does not exist in query \"" %
+                       query->getQueryString() % "\"");
+  return index;
+}
+
+} // namespace sql
+} // namespace atools
@@ -0,0 +1,130 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_SQL_SQLCURSOR_H
+#define ATOOLS_SQL_SQLCURSOR_H
+
+#include "sql/sqlquery.h"
+
+namespace atools {
+namespace sql {
+
+class SqlDatabase;
+
+/*
+ * Forward only typed read cursor for bulk reading of large result sets.
+ *
+ * Column names are resolved once to indexes by column() before the loop. The typed getters read the current
+ * row directly from the driver without the validity checks, name lookups and error handling of SqlQuery::value()
+ * which are done once when executing. The query is set to forward only which avoids caching of passed rows
+ * in the driver.
+ *
+ * Strings and byte arrays are implicitly shared with the driver result and are not converted again.
+ * An invalid column index or calling getters while not positioned on a row results in undefined values.
+ */
+class SqlCursor
+{
+public:
+  /* Prepare and execute query on database. Query is owned by the cursor. */
+  SqlCursor(const QString& queryString, const atools::sql::SqlDatabase *db);
+
+  /* Execute the prepared query which is not owned. Bound values have to be set before. */
+  explicit SqlCursor(atools::sql::SqlQuery& sqlQuery);
+  ~SqlCursor();
+
+  SqlCursor(const SqlCursor& other) = delete;
+  SqlCursor& operator=(const SqlCursor& other) = delete;
+
+  /* Move to next row. Returns false if at end. */
+  bool next()
+  {
+    return query->next();
+  }
+
+  /* Column index for name. Throws SqlException if not found and required. Otherwise -1 for not found. */
+  int column(const QString& name, bool required = true) const;
+
+  bool hasColumn(const QString& name) const
+  {
+    return column(name, false) != -1;
+  }
+
+  bool isNull(int index) const
+  {
+    return raw->isNull(index);
+  }
+
+  int valueInt(int index) const
+  {
+    return raw->value(index).toInt();
+  }
+
+  qint64 valueLongLong(int index) const
+  {
+    return raw->value(index).toLongLong();
+  }
+
+  float valueFloat(int index) const
+  {
+    return raw->value(index).toFloat();
+  }
+
+  double valueDouble(int index) const
+  {
+    return raw->value(index).toDouble();
+  }
+
+  bool valueBool(int index) const
+  {
+    return raw->value(index).toBool();
+  }
+
+  /* Shared with the row data */
+  QString valueStr(int index) const
+  {
+    return raw->value(index).toString();
+  }
+
+  /* Shared with the row data. Empty for null. */
+  QByteArray valueBytes(int index) const
+  {
+    return raw->value(index).toByteArray();
+  }
+
+  /* Variant for values needed as bind values */
+  QVariant value(int index) const
+  {
+    return raw->value(index);
+  }
+
+  atools::sql::SqlQuery& getQuery() const
+  {
+    return *query;
+  }
+
+private:
+  void execute();
+
+  atools::sql::SqlQuery *query;
+  QSqlQuery *raw;
+  bool ownQuery;
+};
+
+} // namespace sql
+} // namespace atools
+
+#endif // ATOOLS_SQL_SQLCURSOR_H
@@ -17,12 +17,16 @@
 
 #include "sql/sqldatabase.h"
 #include "sql/sqlexception.h"
+#include "sql/sqlfunctions.h"
 #include "sql/sqlquery.h"
 #include "sql/sqlrecord.h"
 
+#include <QCache>
 #include <QSettings>
 #include <QDebug>
+#include <QFile>
 #include <QFileInfo>
+#include <QMutex>
 #include <QSqlIndex>
 #include <QSqlDriver>
 #include <QSqlError>
@@ -31,6 +35,13 @@ namespace atools {
 
 namespace sql {
 
+typedef QCache<QString, SqlQuery> QueryCache;
+
+/* LRU cache of prepared statements for each connection by connection name. Statements are only used by the thread
+ * owning the connection but the hash is shared by all threads. */
+static QMutex queryCacheMutex;
+static QHash<QString, QueryCache *> queryCaches;
+
 SqlDatabase::SqlDatabase()
 {
 }
@@ -47,6 +58,8 @@ SqlDatabase::SqlDatabase(const SqlDatabase& other)
   readonly = other.readonly;
   automaticTransactions = other.automaticTransactions;
   name = other.name;
+  openPragmas = other.openPragmas;
+  profiler = other.profiler;
 }
 
 SqlDatabase::SqlDatabase(const QString& connectionName)
@@ -84,12 +97,15 @@ SqlDatabase& SqlDatabase::operator=(const SqlDatabase& other)
   readonly = other.readonly;
   automaticTransactions = other.automaticTransactions;
   name = other.name;
+  openPragmas = other.openPragmas;
+  profiler = other.profiler;
   return *this;
 }
 
 void SqlDatabase::open(const QStringList& pragmas, bool readonlyParam)
 {
   readonly = readonlyParam;
+  openPragmas = pragmas;
 
   checkError(!isOpen(), "Opening a database that is already open");
 
@@ -106,6 +122,9 @@ void SqlDatabase::open(const QStringList& pragmas, bool readonlyParam)
     // Clear option set above
     db.setConnectOptions();
 
+  // Register geo functions like geo_distance_meter() if supported by build
+  SqlFunctions::registerFunctions(db);
+
   for(const QString& pragma : pragmas)
   {
     QSqlQuery(db).exec(pragma);
@@ -139,10 +158,14 @@ void SqlDatabase::close()
   if(!readonly && automaticTransactions)
     rollback();
 
+  // Statements have to be finalized before closing
+  clearQueryCache();
+
   if(readonly && isFileModified())
     qWarning() << Q_FUNC_INFO << "Readonly database modified when closed" << databaseName();
 
   db.close();
+  bulkLoadRestorePragmas.clear();
 
   qInfo() << Q_FUNC_INFO << "Closed database" << databaseName();
 
@@ -201,9 +224,74 @@ void SqlDatabase::executePragmas(const QStringList& pragmas)
   checkError(db.transaction(), "SqlDatabase::pragma() error");
 }
 
+void SqlDatabase::executePragmasCommit(const QStringList& pragmas)
+{
+  // Journal mode cannot be changed within a transaction
+  if(automaticTransactions)
+    checkError(db.commit(), "SqlDatabase::executePragmasCommit() error");
+
+  for(const QString& pragma : pragmas)
+  {
+    QSqlQuery(db).exec(pragma);
+    checkError(isValid(), "Database not valid after \"" + pragma + "\"");
+  }
+
+  if(automaticTransactions)
+    transactionInternal();
+}
+
+QString SqlDatabase::pragmaValue(const QString& pragma) const
+{
+  QSqlQuery query(db);
+  checkError(query.exec("pragma " + pragma), "SqlDatabase::pragmaValue() error for " + pragma);
+  return query.next() ? query.value(0).toString() : QString();
+}
+
+void SqlDatabase::beginBulkLoad(int cacheSizeKiB, int sorterThreads)
+{
+  checkError(!readonly, "SqlDatabase::beginBulkLoad() on read only database");
+  checkError(isOpen(), "SqlDatabase::beginBulkLoad() on closed database");
+
+  if(isBulkLoad())
+    return;
+
+  // Remember current settings - order matters since locking mode has to be reset before journal mode
+  for(const QString& pragma : {QStringLiteral("locking_mode"), QStringLiteral("synchronous"),
+                               QStringLiteral("cache_size"), QStringLiteral("temp_store"),
+                               QStringLiteral("journal_mode"), QStringLiteral("threads")})
+    bulkLoadRestorePragmas.append(QStringLiteral("pragma %1 = %2").arg(pragma).arg(pragmaValue(pragma)));
+
+  // Journal mode "off" would break rollback which is used when canceling
+  // Worker threads are limited by SQLITE_MAX_WORKER_THREADS which is 8 by default
+  executePragmasCommit({QStringLiteral("pragma journal_mode = memory"),
+                        QStringLiteral("pragma synchronous = off"),
+                        QStringLiteral("pragma cache_size = %1").arg(-cacheSizeKiB),
+                        QStringLiteral("pragma temp_store = memory"),
+                        QStringLiteral("pragma locking_mode = exclusive"),
+                        QStringLiteral("pragma threads = %1").arg(std::max(sorterThreads, 0))});
+
+  qInfo() << Q_FUNC_INFO << databaseName() << "restore" << bulkLoadRestorePragmas;
+}
+
+void SqlDatabase::endBulkLoad()
+{
+  if(!isBulkLoad())
+    return;
+
+  QStringList pragmas;
+  pragmas.swap(bulkLoadRestorePragmas);
+  executePragmasCommit(pragmas);
+
+  // Exclusive lock is released with the next access after changing the locking mode
+  QSqlQuery(db).exec(QStringLiteral("select count(1) from sqlite_master"));
+
+  qInfo() << Q_FUNC_INFO << databaseName();
+}
+
 void SqlDatabase::attachDatabase(const QString& file, const QString& dbName)
 {
   checkError(db.rollback(), "SqlDatabase::attachDatabase() error");
+  clearQueryCache();
 
   SqlQuery query(this);
   query.prepare("attach database :db as :name");
@@ -217,6 +305,7 @@ void SqlDatabase::attachDatabase(const QString& file, const QString& dbName)
 void SqlDatabase::detachDatabase(const QString& dbName)
 {
   checkError(db.rollback(), "SqlDatabase::detachDatabase() error");
+  clearQueryCache();
 
   SqlQuery query(this);
   query.prepare("detach database :name");
@@ -226,13 +315,34 @@ void SqlDatabase::detachDatabase(const QString& dbName)
   checkError(db.transaction(), "SqlDatabase::detachDatabase() error");
 }
 
-void SqlDatabase::vacuum()
+void SqlDatabase::vacuum(int pageSize)
 {
   checkError(db.rollback(), "SqlDatabase::detachDatabase() error");
+  clearQueryCache();
+  if(pageSize > 0)
+    exec(QStringLiteral("pragma page_size = %1").arg(pageSize));
   exec("vacuum");
   checkError(db.transaction(), "SqlDatabase::detachDatabase() error");
 }
 
+void SqlDatabase::vacuumInto(const QString& filename, int pageSize)
+{
+  checkError(db.rollback(), "SqlDatabase::vacuumInto() error");
+  clearQueryCache();
+
+  // Target has to be empty or not existing
+  if(QFile::exists(filename) && !QFile::remove(filename))
+    throw SqlException(this, QStringLiteral("Cannot remove \"%1\" for vacuum into").arg(filename));
+
+  // Page size is used for the next vacuum only
+  if(pageSize > 0)
+    exec(QStringLiteral("pragma page_size = %1").arg(pageSize));
+
+  QString file(filename);
+  exec(QStringLiteral("vacuum into '%1'").arg(file.replace('\'', QStringLiteral("''"))));
+  checkError(db.transaction(), "SqlDatabase::vacuumInto() error");
+}
+
 void SqlDatabase::analyze()
 {
   exec("analyze");
@@ -401,9 +511,86 @@ SqlDatabase SqlDatabase::database(const QString& connectionName, bool open)
 
 void SqlDatabase::removeDatabase(const QString& connectionName)
 {
+  {
+    QMutexLocker locker(&queryCacheMutex);
+    delete queryCaches.take(connectionName);
+  }
   QSqlDatabase::removeDatabase(connectionName);
 }
 
+SqlQuery *SqlDatabase::acquireQuery(const QString& queryString) const
+{
+  SqlQuery *query = nullptr;
+  {
+    QMutexLocker locker(&queryCacheMutex);
+    QueryCache *queryCache = queryCaches.value(connectionName(), nullptr);
+    if(queryCache != nullptr)
+      query = queryCache->take(queryString);
+  }
+
+  if(query == nullptr)
+  {
+    query = new SqlQuery(this);
+    try
+    {
+      query->prepare(queryString);
+    }
+    catch(...)
+    {
+      delete query;
+      throw;
+    }
+  }
+  return query;
+}
+
+void SqlDatabase::releaseQuery(SqlQuery *query) const
+{
+  if(query == nullptr)
+    return;
+
+  if(!isOpen())
+  {
+    // Connection was closed while query was in use
+    delete query;
+    return;
+  }
+
+  // Reset statement to release locks
+  query->finish();
+  query->clearBoundValues();
+
+  QMutexLocker locker(&queryCacheMutex);
+  QueryCache *& queryCache = queryCaches[connectionName()];
+  if(queryCache == nullptr)
+    queryCache = new QueryCache(DEFAULT_QUERY_CACHE_SIZE);
+
+  if(queryCache->contains(query->getQueryString()))
+    // Same statement was used nested - keep the one in the cache
+    delete query;
+  else
+    // Takes ownership and deletes least recently used queries or the query itself if the cache size is 0
+    queryCache->insert(query->getQueryString(), query);
+}
+
+void SqlDatabase::clearQueryCache() const
+{
+  QMutexLocker locker(&queryCacheMutex);
+  QueryCache *queryCache = queryCaches.value(connectionName(), nullptr);
+  if(queryCache != nullptr)
+    queryCache->clear();
+}
+
+void SqlDatabase::setQueryCacheSize(int size) const
+{
+  QMutexLocker locker(&queryCacheMutex);
+  QueryCache *& queryCache = queryCaches[connectionName()];
+  if(queryCache == nullptr)
+    queryCache = new QueryCache(size);
+  else
+    queryCache->setMaxCost(size);
+}
+
 bool SqlDatabase::contains(const QString& connectionName)
 {
   return QSqlDatabase::contains(connectionName);
@@ -30,6 +30,7 @@ namespace sql {
 class SqlTransaction;
 class SqlQuery;
 class SqlRecord;
+class SqlProfiler;
 
 /*
  * Wrapper around QSqlDatabase that adds exceptions to avoid plenty of
@@ -72,6 +73,13 @@ public:
 
   void close();
   bool isOpen() const;
+
+  /* Pragmas given to the last call of open() */
+  const QStringList& getOpenPragmas() const
+  {
+    return openPragmas;
+  }
+
   QStringList tables(QSql::TableType type = QSql::Tables) const;
   QSqlIndex primaryIndex(const QString& tablename) const;
 
@@ -152,8 +160,28 @@ public:
   void attachDatabase(const QString& file, const QString& dbName);
   void detachDatabase(const QString& dbName);
 
-  /* Sqlite only. Compresses the database */
-  void vacuum();
+  /* Sqlite only. Commits and sets pragmas for fast loading of large amounts of data like a scenery database compilation.
+   * Journal is kept in memory, no sync to disk, large cache and exclusive lock. Rollback still works but
+   * database can be corrupted by a crash or power loss until endBulkLoad() is called.
+   * Indexes should be created after loading. cacheSizeKiB is the page cache size.
+   * sorterThreads is the number of auxiliary threads SQLite may use for large sorts like in "create index".
+   * 0 keeps the sorter single threaded. */
+  void beginBulkLoad(int cacheSizeKiB = 256 * 1024, int sorterThreads = 0);
+
+  /* Commits and restores pragmas which were active before calling beginBulkLoad(). Releases exclusive lock. */
+  void endBulkLoad();
+
+  bool isBulkLoad() const
+  {
+    return !bulkLoadRestorePragmas.isEmpty();
+  }
+
+  /* Sqlite only. Compresses the database. Changes the page size if pageSize is > 0 and journal mode is not WAL. */
+  void vacuum(int pageSize = 0);
+
+  /* Sqlite only. Writes a compressed and defragmented copy of the database to filename.
+   * Uses pageSize for the copy if > 0. An existing file is overwritten. */
+  void vacuumInto(const QString& filename, int pageSize = 0);
 
   /* Sqlite only. Gather schema statistics for query optimization. */
   void analyze();
@@ -173,6 +201,33 @@ public:
     return name;
   }
 
+  /* Attach profiler collecting statistics for all queries created on this database or copies of it afterwards.
+   * Profiler is not owned and has to outlive all queries. Null disables profiling. */
+  void setProfiler(atools::sql::SqlProfiler *value)
+  {
+    profiler = value;
+  }
+
+  atools::sql::SqlProfiler *getProfiler() const
+  {
+    return profiler;
+  }
+
+  /* Get a prepared query from the statement cache of this connection or create and prepare a new one if not found.
+   * The query is removed from the cache while in use and has to be given back by releaseQuery().
+   * Use SqlCachedQuery for automatic release. Throws SqlException if the statement cannot be prepared. */
+  atools::sql::SqlQuery *acquireQuery(const QString& queryString) const;
+
+  /* Finish query, clear bound values and put it back into the cache of this connection.
+   * Deletes the least recently used queries if the cache is full. */
+  void releaseQuery(atools::sql::SqlQuery *query) const;
+
+  /* Delete all cached queries of this connection. Done automatically on close, attach, detach and vacuum. */
+  void clearQueryCache() const;
+
+  /* Maximum number of cached prepared statements per connection. 0 disables the cache. */
+  void setQueryCacheSize(int size) const;
+
 private:
   friend class atools::sql::SqlTransaction;
 
@@ -182,12 +237,27 @@ private:
   void checkError(bool retval = true, const QString& msg = QString()) const;
   void transactionInternal();
 
+  /* Commit and execute pragmas outside of a transaction */
+  void executePragmasCommit(const QStringList& pragmas);
+
+  /* Get current value of a pragma like "journal_mode" */
+  QString pragmaValue(const QString& pragma) const;
+
+  /* Default for setQueryCacheSize() */
+  const static int DEFAULT_QUERY_CACHE_SIZE = 100;
+
   QSqlDatabase db;
   bool autocommit = false, readonly = false, automaticTransactions = true;
   QString name;
+  QStringList openPragmas;
+
+  /* Pragmas to reset settings after bulk loading. Empty if not in bulk load mode. */
+  QStringList bulkLoadRestorePragmas;
 
   qint64 fileSize = 0L;
   QDateTime fileModificationTime;
+
+  atools::sql::SqlProfiler *profiler = nullptr;
 };
 
 } // namespace sql
@@ -0,0 +1,128 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "sql/sqlfulltextsearch.h"
+
+#include "sql/sqlquery.h"
+#include "sql/sqlutil.h"
+
+#include <QStringBuilder>
+
+namespace atools {
+namespace sql {
+
+/* Name of bind variable or prefix for numbered variables in like clauses */
+const static QLatin1String BIND_NAME(":fts_text");
+
+/* Trigram tokenizer needs at least three characters */
+const static int MIN_INDEX_TEXT_LENGTH = 3;
+
+SqlFullTextSearch::SqlFullTextSearch(const SqlDatabase *sqlDb, const QString& tableParam, const QString& idColumnParam,
+                                     const QString& ftsTableParam, const QStringList& columnsParam)
+  : db(sqlDb), table(tableParam), idColumn(idColumnParam), ftsTable(ftsTableParam), columns(columnsParam)
+{
+  indexAvailable = SqlUtil(db).hasTable(ftsTable);
+}
+
+bool SqlFullTextSearch::useIndex(const QString& text) const
+{
+  return indexAvailable && text.size() >= MIN_INDEX_TEXT_LENGTH;
+}
+
+QString SqlFullTextSearch::phrase(const QString& text)
+{
+  return '"' % QString(text).replace('"', QStringLiteral("\"\"")) % '"';
+}
+
+QString SqlFullTextSearch::likeEscape(const QString& text)
+{
+  QString escaped(text);
+  escaped.replace('\\', QStringLiteral("\\\\")).replace('%', QStringLiteral("\\%")).replace('_', QStringLiteral("\\_"));
+  return escaped;
+}
+
+QString SqlFullTextSearch::whereClause(const QString& text) const
+{
+  if(useIndex(text))
+    return idColumn % " in (select rowid from " % ftsTable % " where " % ftsTable % " match " % BIND_NAME % ")";
+  else
+  {
+    // Use one bind variable per column since repeated named variables are not supported by all drivers
+    QStringList likes;
+    for(int i = 0; i < columns.size(); i++)
+      likes.append(columns.at(i) % " like " % BIND_NAME % QString::number(i) % " escape '\\'");
+    return "(" % likes.join(QStringLiteral(" or ")) % ")";
+  }
+}
+
+QList<std::pair<QString, QVariant> > SqlFullTextSearch::bindValues(const QString& text) const
+{
+  QList<std::pair<QString, QVariant> > binds;
+  if(useIndex(text))
+    binds.append(std::make_pair(QString(BIND_NAME), QVariant(phrase(text))));
+  else
+  {
+    QString like = '%' % likeEscape(text) % '%';
+    for(int i = 0; i < columns.size(); i++)
+      binds.append(std::make_pair(QString(BIND_NAME % QString::number(i)), QVariant(like)));
+  }
+  return binds;
+}
+
+QList<int> SqlFullTextSearch::search(const QString& text, int limit) const
+{
+  if(text.isEmpty())
+    return QList<int>();
+
+  if(useIndex(text))
+    return query("select rowid from " % ftsTable % " where " % ftsTable % " match " % BIND_NAME %
+                 " order by rank limit " % QString::number(limit), bindValues(text));
+  else
+    return query("select " % idColumn % " from " % table % " where " % whereClause(text) %
+                 " limit " % QString::number(limit), bindValues(text));
+}
+
+QList<int> SqlFullTextSearch::searchColumn(const QString& column, const QString& text, int limit) const
+{
+  if(text.isEmpty())
+    return QList<int>();
+
+  if(useIndex(text))
+    // Column filter like: ident : "ABC"
+    return query("select rowid from " % ftsTable % " where " % ftsTable % " match " % BIND_NAME %
+                 " order by rank limit " % QString::number(limit),
+                 {std::make_pair(QString(BIND_NAME), QVariant(QString(column % " : " % phrase(text))))});
+  else
+    return query("select " % idColumn % " from " % table % " where " % column % " like " % BIND_NAME %
+                 " escape '\\' limit " % QString::number(limit),
+                 {std::make_pair(QString(BIND_NAME), QVariant(QString('%' % likeEscape(text) % '%')))});
+}
+
+QList<int> SqlFullTextSearch::query(const QString& sql, const QList<std::pair<QString, QVariant> >& binds) const
+{
+  QList<int> ids;
+  SqlQuery sqlQuery(db);
+  sqlQuery.prepare(sql);
+  sqlQuery.bindValues(binds);
+  sqlQuery.exec();
+  while(sqlQuery.next())
+    ids.append(sqlQuery.valueInt(0));
+  return ids;
+}
+
+} // namespace sql
+} // namespace atools
@@ -0,0 +1,90 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_SQL_SQLFULLTEXTSEARCH_H
+#define ATOOLS_SQL_SQLFULLTEXTSEARCH_H
+
+#include <QStringList>
+#include <QVariant>
+
+namespace atools {
+namespace sql {
+
+class SqlDatabase;
+
+/*
+ * Infix text search on a table using an FTS5 external content table with the trigram tokenizer
+ * like airport_fts or nav_search_fts which are created by resources/sql/fs/db/create_fts.sql.
+ *
+ * The row id of the FTS table has to be the id of the content table.
+ * Search texts shorter than three characters cannot use the trigram index and fall back to "like"
+ * on the content table. This is also used if the FTS table does not exist.
+ *
+ * Search is case insensitive.
+ */
+class SqlFullTextSearch
+{
+public:
+  /*
+   * @param table Content table like "airport"
+   * @param idColumn Id column of the content table like "airport_id"
+   * @param ftsTable FTS5 table like "airport_fts"
+   * @param columns Columns to search in. Have to exist in both tables.
+   */
+  SqlFullTextSearch(const atools::sql::SqlDatabase *sqlDb, const QString& tableParam, const QString& idColumnParam,
+                    const QString& ftsTableParam, const QStringList& columnsParam);
+
+  /* True if the FTS table exists */
+  bool isIndexAvailable() const
+  {
+    return indexAvailable;
+  }
+
+  /* Ids of all rows where any of the columns contains text. Returns at most limit ids ordered by relevance
+   * if the index is used. */
+  QList<int> search(const QString& text, int limit = 1000) const;
+
+  /* Ids of all rows where the column contains text */
+  QList<int> searchColumn(const QString& column, const QString& text, int limit = 1000) const;
+
+  /* Where clause for the content table with named bind variables which have to be bound to bindValues().
+   * E.g. "airport_id in (select rowid from airport_fts where airport_fts match :fts_text)" */
+  QString whereClause(const QString& text) const;
+
+  /* Bind values for whereClause(). Can be passed to SqlQuery::bindValues(). */
+  QList<std::pair<QString, QVariant> > bindValues(const QString& text) const;
+
+  /* Build a FTS5 phrase which matches the text literally. Quotes are escaped. */
+  static QString phrase(const QString& text);
+
+  /* Escape "%", "_" and "\" for "like" with escape character "\" */
+  static QString likeEscape(const QString& text);
+
+private:
+  bool useIndex(const QString& text) const;
+  QList<int> query(const QString& sql, const QList<std::pair<QString, QVariant> >& binds) const;
+
+  const atools::sql::SqlDatabase *db;
+  QString table, idColumn, ftsTable;
+  QStringList columns;
+  bool indexAvailable = false;
+};
+
+} // namespace sql
+} // namespace atools
+
+#endif // ATOOLS_SQL_SQLFULLTEXTSEARCH_H
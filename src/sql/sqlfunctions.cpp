@@ -0,0 +1,210 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+
+#include "sql/sqlfunctions.h"
+
+#include "geo/calculations.h"
+#include "geo/packedlinestring.h"
+#include "geo/pos.h"
+#include "geo/preparedpolygon.h"
+
+#include <QDebug>
+#include <QSqlDatabase>
+#include <QSqlDriver>
+#include <QVariant>
+
+#include <atomic>
+
+#ifdef ATOOLS_SQLITE_FUNCTIONS
+#include <sqlite3.h>
+#endif
+
+namespace atools {
+namespace sql {
+
+static std::atomic<SqlFunctions::GeometryDecoderFunc> geometryDecoder(nullptr);
+
+#ifdef ATOOLS_SQLITE_FUNCTIONS
+
+/* Read all arguments as double. Returns false and sets result to NULL if any argument is NULL. */
+static bool readDoubles(sqlite3_context *context, int argc, sqlite3_value **argv, double *values)
+{
+  for(int i = 0; i < argc; i++)
+  {
+    if(sqlite3_value_type(argv[i]) == SQLITE_NULL)
+    {
+      sqlite3_result_null(context);
+      return false;
+    }
+    values[i] = sqlite3_value_double(argv[i]);
+  }
+  return true;
+}
+
+static void geoDistanceMeter(sqlite3_context *context, int argc, sqlite3_value **argv)
+{
+  double v[4];
+  if(readDoubles(context, argc, argv, v))
+  {
+    using atools::geo::toRadians;
+    sqlite3_result_double(context, atools::geo::Pos::distanceRad(toRadians(v[0]), toRadians(v[1]), toRadians(v[2]),
+                                                                 toRadians(v[3])) * atools::geo::Pos::EARTH_RADIUS_METER_DOUBLE);
+  }
+}
+
+static void geoCourseDeg(sqlite3_context *context, int argc, sqlite3_value **argv)
+{
+  double v[4];
+  if(readDoubles(context, argc, argv, v))
+  {
+    if(v[0] == v[2] && v[1] == v[3])
+      // No course for equal positions
+      sqlite3_result_null(context);
+    else
+    {
+      using atools::geo::toRadians;
+      double course = atools::geo::Pos::courseRad(toRadians(v[0]), toRadians(v[1]), toRadians(v[2]), toRadians(v[3]));
+      sqlite3_result_double(context, atools::geo::normalizeCourse(atools::geo::toDegree(course)));
+    }
+  }
+}
+
+static void geoRectContains(sqlite3_context *context, int argc, sqlite3_value **argv)
+{
+  // west, north, east, south, lonx, laty
+  double v[6];
+  if(readDoubles(context, argc, argv, v))
+  {
+    bool lat = v[3] <= v[5] && v[5] <= v[1];
+
+    // Rectangle crosses the anti-meridian if west is east of east
+    bool lon = v[0] <= v[2] ? (v[0] <= v[4] && v[4] <= v[2]) : (v[4] >= v[0] || v[4] <= v[2]);
+    sqlite3_result_int(context, lat && lon);
+  }
+}
+
+static void deletePolygon(void *polygon)
+{
+  delete static_cast<atools::geo::PreparedPolygon *>(polygon);
+}
+
+static void geoPolygonContains(sqlite3_context *context, int, sqlite3_value **argv)
+{
+  if(sqlite3_value_type(argv[0]) != SQLITE_BLOB || sqlite3_value_type(argv[1]) == SQLITE_NULL ||
+     sqlite3_value_type(argv[2]) == SQLITE_NULL)
+  {
+    sqlite3_result_null(context);
+    return;
+  }
+
+  // Cached by SQLite as long as the geometry argument does not change, i.e. for bound values
+  atools::geo::PreparedPolygon *polygon = static_cast<atools::geo::PreparedPolygon *>(sqlite3_get_auxdata(context, 0));
+  if(polygon == nullptr)
+  {
+    SqlFunctions::GeometryDecoderFunc decoder = geometryDecoder.load();
+    if(decoder == nullptr)
+    {
+      sqlite3_result_error(context, "geo_polygon_contains: no geometry decoder set", -1);
+      return;
+    }
+
+    // Avoid copying the BLOB
+    const QByteArray bytes = QByteArray::fromRawData(static_cast<const char *>(sqlite3_value_blob(argv[0])),
+                                                     sqlite3_value_bytes(argv[0]));
+    atools::geo::PackedLineString packed;
+    if(!decoder(bytes, packed))
+    {
+      sqlite3_result_null(context);
+      return;
+    }
+
+    polygon = new atools::geo::PreparedPolygon(packed);
+
+    // Deletes polygon immediately if caching fails - get again to check
+    sqlite3_set_auxdata(context, 0, polygon, deletePolygon);
+    polygon = static_cast<atools::geo::PreparedPolygon *>(sqlite3_get_auxdata(context, 0));
+
+    if(polygon == nullptr)
+    {
+      // Out of memory
+      sqlite3_result_error_nomem(context);
+      return;
+    }
+  }
+
+  sqlite3_result_int(context, polygon->contains(static_cast<float>(sqlite3_value_double(argv[1])),
+                                                static_cast<float>(sqlite3_value_double(argv[2]))));
+}
+
+#endif
+
+bool SqlFunctions::registerFunctions(const QSqlDatabase& db)
+{
+#ifdef ATOOLS_SQLITE_FUNCTIONS
+  QVariant handleVar = db.driver()->handle();
+  if(!handleVar.isValid() || qstrcmp(handleVar.typeName(), "sqlite3*") != 0)
+    return false;
+
+  sqlite3 *handle = *static_cast<sqlite3 *const *>(handleVar.constData());
+  if(handle == nullptr)
+    return false;
+
+  int flags = SQLITE_UTF8 | SQLITE_DETERMINISTIC;
+#ifdef SQLITE_INNOCUOUS
+  flags |= SQLITE_INNOCUOUS;
+#endif
+
+  bool ok = true;
+  ok &= sqlite3_create_function_v2(handle, "geo_distance_meter", 4, flags, nullptr, geoDistanceMeter,
+                                   nullptr, nullptr, nullptr) == SQLITE_OK;
+  ok &= sqlite3_create_function_v2(handle, "geo_course_deg", 4, flags, nullptr, geoCourseDeg,
+                                   nullptr, nullptr, nullptr) == SQLITE_OK;
+  ok &= sqlite3_create_function_v2(handle, "geo_rect_contains", 6, flags, nullptr, geoRectContains,
+                                   nullptr, nullptr, nullptr) == SQLITE_OK;
+  ok &= sqlite3_create_function_v2(handle, "geo_polygon_contains", 3, flags, nullptr, geoPolygonContains,
+                                   nullptr, nullptr, nullptr) == SQLITE_OK;
+
+  if(!ok)
+    qWarning() << Q_FUNC_INFO << "Error registering functions" << sqlite3_errmsg(handle);
+  return ok;
+
+#else
+  Q_UNUSED(db)
+  return false;
+
+#endif
+}
+
+void SqlFunctions::setGeometryDecoder(GeometryDecoderFunc decoder)
+{
+  geometryDecoder.store(decoder);
+}
+
+bool SqlFunctions::isAvailable()
+{
+#ifdef ATOOLS_SQLITE_FUNCTIONS
+  return true;
+
+#else
+  return false;
+
+#endif
+}
+
+} // namespace sql
+} // namespace atools
@@ -0,0 +1,68 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+
+#ifndef ATOOLS_SQL_SQLFUNCTIONS_H
+#define ATOOLS_SQL_SQLFUNCTIONS_H
+
+class QByteArray;
+class QSqlDatabase;
+
+namespace atools {
+namespace geo {
+class PackedLineString;
+}
+
+namespace sql {
+
+/*
+ * Native SQLite scalar functions which allow to filter and order by real distance inside SQLite instead of
+ * fetching all rows of a bounding rectangle. All coordinates are in degrees. Functions return NULL if any
+ * argument is NULL.
+ *
+ * geo_distance_meter(lonx1, laty1, lonx2, laty2)  Great circle distance in meter.
+ * geo_course_deg(lonx1, laty1, lonx2, laty2)      Initial true course from first to second position 0-360.
+ * geo_rect_contains(west, north, east, south, lonx, laty)
+ *                                                 1 if position is inside. Rectangle can cross the anti-meridian.
+ * geo_polygon_contains(geometry, lonx, laty)      1 if position is inside the BinaryGeometry polygon BLOB.
+ *                                                 Needs a decoder. The polygon is prepared only once per statement
+ *                                                 if geometry is a bound value.
+ *
+ * Registration needs the sqlite3 API and is only done if compiled with ATOOLS_SQLITE_FUNCTIONS.
+ * Qt has to use the same SQLite library, i.e. has to be built with -system-sqlite.
+ */
+class SqlFunctions
+{
+public:
+  /* Same signature as static atools::fs::common::BinaryGeometry::readFromByteArray() */
+  typedef bool (*GeometryDecoderFunc)(const QByteArray& bytes, atools::geo::PackedLineString& packed);
+
+  /* Called by SqlDatabase::open(). Returns false if not supported by build or driver. */
+  static bool registerFunctions(const QSqlDatabase& db);
+
+  /* Set decoder for geo_polygon_contains() once on startup before opening databases.
+   * Needed since the SQL module does not depend on the flight simulator module. */
+  static void setGeometryDecoder(GeometryDecoderFunc decoder);
+
+  /* true if compiled with ATOOLS_SQLITE_FUNCTIONS */
+  static bool isAvailable();
+};
+
+} // namespace sql
+} // namespace atools
+
+#endif // ATOOLS_SQL_SQLFUNCTIONS_H
@@ -0,0 +1,174 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "sql/sqlprofiler.h"
+
+#include "sql/sqldatabase.h"
+
+#include <QDebug>
+#include <QRandomGenerator>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringBuilder>
+#include <QTextStream>
+
+namespace atools {
+namespace sql {
+
+qint64 SqlProfilerStatement::execPercentileNs(float percent) const
+{
+  if(execSamples.isEmpty())
+    return 0L;
+
+  QList<qint64> sorted(execSamples);
+  std::sort(sorted.begin(), sorted.end());
+  qsizetype index = static_cast<qsizetype>(percent / 100.f * static_cast<float>(sorted.size() - 1) + 0.5f);
+  return sorted.at(std::clamp<qsizetype>(index, 0, sorted.size() - 1));
+}
+
+SqlProfilerStatement& SqlProfiler::statement(const QString& queryString)
+{
+  auto it = statements.find(queryString);
+  if(it == statements.end())
+  {
+    it = statements.insert(queryString, SqlProfilerStatement());
+    it->queryString = queryString;
+  }
+  return it.value();
+}
+
+void SqlProfiler::addPrepare(const QString& queryString, qint64 nanoseconds)
+{
+  QMutexLocker locker(&mutex);
+  SqlProfilerStatement& stmt = statement(queryString);
+  stmt.numPrepare++;
+  stmt.prepareNs += nanoseconds;
+}
+
+void SqlProfiler::addExec(const QString& queryString, qint64 nanoseconds)
+{
+  QMutexLocker locker(&mutex);
+  SqlProfilerStatement& stmt = statement(queryString);
+  stmt.numExec++;
+  stmt.execNs += nanoseconds;
+
+  // Reservoir sampling to keep a uniform sample of all calls
+  if(stmt.execSamples.size() < MAX_SAMPLES)
+    stmt.execSamples.append(nanoseconds);
+  else
+  {
+    qint64 index = QRandomGenerator::global()->bounded(stmt.numExec);
+    if(index < MAX_SAMPLES)
+      stmt.execSamples[index] = nanoseconds;
+  }
+}
+
+void SqlProfiler::addFetch(const QString& queryString, qint64 numRows, qint64 nanoseconds)
+{
+  QMutexLocker locker(&mutex);
+  SqlProfilerStatement& stmt = statement(queryString);
+  stmt.numRows += numRows;
+  stmt.fetchNs += nanoseconds;
+}
+
+void SqlProfiler::clear()
+{
+  QMutexLocker locker(&mutex);
+  statements.clear();
+}
+
+QList<SqlProfilerStatement> SqlProfiler::getStatements() const
+{
+  QList<SqlProfilerStatement> retval;
+  {
+    QMutexLocker locker(&mutex);
+    retval = statements.values();
+  }
+
+  std::sort(retval.begin(), retval.end(), [](const SqlProfilerStatement& s1, const SqlProfilerStatement& s2) -> bool {
+          return s1.totalNs() > s2.totalNs();
+        });
+  return retval;
+}
+
+QString SqlProfiler::getReport(int maxStatements, int maxPlans, const SqlDatabase *db) const
+{
+  auto ms = [](qint64 nanoseconds) -> QString {
+              return QString::number(static_cast<double>(nanoseconds) / 1000000., 'f', 3);
+            };
+
+  const QList<SqlProfilerStatement> stmts = getStatements();
+
+  qint64 totalNs = 0L;
+  for(const SqlProfilerStatement& stmt : stmts)
+    totalNs += stmt.totalNs();
+
+  QString report;
+  QTextStream stream(&report);
+  stream << "SQL profile: " << stmts.size() << " statements, total " << ms(totalNs) << " ms" << Qt::endl;
+
+  for(int i = 0; i < stmts.size() && i < maxStatements; i++)
+  {
+    const SqlProfilerStatement& stmt = stmts.at(i);
+    stream << "#" << (i + 1) << " total " << ms(stmt.totalNs()) << " ms"
+           << ", prepare " << stmt.numPrepare << "x " << ms(stmt.prepareNs) << " ms"
+           << ", exec " << stmt.numExec << "x " << ms(stmt.execNs) << " ms"
+           << " (p50 " << ms(stmt.execPercentileNs(50.f)) << ", p90 " << ms(stmt.execPercentileNs(90.f))
+           << ", p99 " << ms(stmt.execPercentileNs(99.f)) << ")"
+           << ", rows " << stmt.numRows << " " << ms(stmt.fetchNs) << " ms" << Qt::endl;
+    stream << "  " << stmt.queryString.simplified() << Qt::endl;
+
+    if(db != nullptr && i < maxPlans)
+      stream << queryPlan(db, stmt.queryString);
+  }
+
+  stream.flush();
+  return report;
+}
+
+void SqlProfiler::logReport(int maxStatements, int maxPlans, const SqlDatabase *db) const
+{
+  qInfo().noquote().nospace() << Q_FUNC_INFO << Qt::endl << getReport(maxStatements, maxPlans, db);
+}
+
+QString SqlProfiler::queryPlan(const SqlDatabase *db, const QString& queryString)
+{
+  // Only statements accessing tables can be explained
+  QString start = queryString.trimmed().section(' ', 0, 0).toLower();
+  if(start != "select" && start != "with" && start != "insert" && start != "update" && start != "delete" &&
+     start != "replace")
+    return QString();
+
+  // Use plain query to avoid exceptions and profiling. Unbound values are null.
+  QSqlQuery query(db->getQSqlDatabase());
+  if(!query.prepare("explain query plan " % queryString) || !query.exec())
+    return "    Error: " % query.lastError().text() % "\n";
+
+  // Columns are id, parent, notused and detail - indent children below parents
+  QHash<int, int> depths;
+  QString plan;
+  while(query.next())
+  {
+    int depth = depths.value(query.value(1).toInt(), 0) + 1;
+    depths.insert(query.value(0).toInt(), depth);
+    plan.append(QString(depth * 2 + 2, ' ') % query.value(3).toString() % "\n");
+  }
+  return plan;
+}
+
+} // namespace sql
+} // namespace atools
@@ -0,0 +1,109 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_SQL_SQLPROFILER_H
+#define ATOOLS_SQL_SQLPROFILER_H
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+
+namespace atools {
+namespace sql {
+
+class SqlDatabase;
+
+/* Aggregated runtime values for one SQL statement text. Times are in nanoseconds. */
+struct SqlProfilerStatement
+{
+  QString queryString;
+
+  /* Number of calls to prepare(), exec() and rows fetched by next() */
+  qint64 numPrepare = 0, numExec = 0, numRows = 0;
+
+  /* Total time spent in prepare(), exec() and next() */
+  qint64 prepareNs = 0, execNs = 0, fetchNs = 0;
+
+  /* Random sample of exec() times limited in size. Used for percentiles. */
+  QList<qint64> execSamples;
+
+  /* Sum of all times */
+  qint64 totalNs() const
+  {
+    return prepareNs + execNs + fetchNs;
+  }
+
+  /* Percentile of exec() time for percent 0-100. 0 if no samples. */
+  qint64 execPercentileNs(float percent) const;
+
+};
+
+/*
+ * Opt-in profiler collecting counts and latency per SQL statement text for all queries running on a
+ * database having the profiler attached by SqlDatabase::setProfiler().
+ *
+ * Can print a report of the most expensive statements including the query plan as given by
+ * "explain query plan" to find missing indexes.
+ *
+ * Thread safe. Not owned by the database.
+ */
+class SqlProfiler
+{
+public:
+  SqlProfiler()
+  {
+  }
+
+  SqlProfiler(const SqlProfiler& other) = delete;
+  SqlProfiler& operator=(const SqlProfiler& other) = delete;
+
+  /* Called by SqlQuery */
+  void addPrepare(const QString& queryString, qint64 nanoseconds);
+  void addExec(const QString& queryString, qint64 nanoseconds);
+  void addFetch(const QString& queryString, qint64 numRows, qint64 nanoseconds);
+
+  /* Remove all collected values */
+  void clear();
+
+  /* Copy of all statements sorted by total time descending */
+  QList<atools::sql::SqlProfilerStatement> getStatements() const;
+
+  /* Get report for the maxStatements most expensive statements. Adds the query plan for the slowest
+   * maxPlans statements if db is not null. db has to be the attached database or one on the same file. */
+  QString getReport(int maxStatements = 20, int maxPlans = 5, const atools::sql::SqlDatabase *db = nullptr) const;
+
+  /* Print report to log */
+  void logReport(int maxStatements = 20, int maxPlans = 5, const atools::sql::SqlDatabase *db = nullptr) const;
+
+  /* Run "explain query plan" without bound values and return the indented plan or an error message. */
+  static QString queryPlan(const atools::sql::SqlDatabase *db, const QString& queryString);
+
+private:
+  /* Get or create entry. Mutex has to be locked */
+  SqlProfilerStatement& statement(const QString& queryString);
+
+  /* Maximum number of exec() samples kept per statement */
+  const static int MAX_SAMPLES = 1000;
+
+  QHash<QString, SqlProfilerStatement> statements;
+  mutable QMutex mutex;
+};
+
+} // namespace sql
+} // namespace atools
+
+#endif // ATOOLS_SQL_SQLPROFILER_H
@@ -19,11 +19,13 @@
 #include "atools.h"
 #include "sql/sqlexception.h"
 #include "sql/sqldatabase.h"
+#include "sql/sqlprofiler.h"
 
 #include "sql/sqlrecord.h"
 
 #include <QSqlError>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QStringBuilder>
 
 namespace atools {
@@ -39,16 +41,25 @@ SqlQuery::SqlQuery(QSqlResult *r)
 
 SqlQuery::SqlQuery(const QString& queryStr, const SqlDatabase& sqlDb)
 {
-  query = QSqlQuery(queryStr, sqlDb.getQSqlDatabase());
-  queryString = queryStr;
   db = new SqlDatabase(sqlDb);
+  queryString = queryStr;
+
+  // Query is executed by constructor
+  QElapsedTimer timer;
+  startProfile(timer);
+  query = QSqlQuery(queryStr, sqlDb.getQSqlDatabase());
+  endProfileExec(timer);
 }
 
 SqlQuery::SqlQuery(const QString& queryStr, const SqlDatabase *sqlDb)
 {
-  query = QSqlQuery(queryStr, sqlDb->getQSqlDatabase());
-  queryString = queryStr;
   db = new SqlDatabase(*sqlDb);
+  queryString = queryStr;
+
+  QElapsedTimer timer;
+  startProfile(timer);
+  query = QSqlQuery(queryStr, sqlDb->getQSqlDatabase());
+  endProfileExec(timer);
 }
 
 SqlQuery::SqlQuery(const SqlDatabase *sqlDb)
@@ -67,9 +78,36 @@ SqlQuery::SqlQuery(const SqlDatabase& sqlDb)
 
 SqlQuery::~SqlQuery()
 {
+  flushProfileFetch();
   delete db;
 }
 
+void SqlQuery::startProfile(QElapsedTimer& timer)
+{
+  if(db->getProfiler() != nullptr)
+  {
+    // Assign rows of the last execution to the previous query string
+    flushProfileFetch();
+    timer.start();
+  }
+}
+
+void SqlQuery::endProfileExec(const QElapsedTimer& timer)
+{
+  if(timer.isValid())
+    db->getProfiler()->addExec(queryString, timer.nsecsElapsed());
+}
+
+void SqlQuery::flushProfileFetch()
+{
+  if(profileFetchNs > 0L || profileFetchRows > 0L)
+  {
+    if(db->getProfiler() != nullptr)
+      db->getProfiler()->addFetch(queryString, profileFetchRows, profileFetchNs);
+    profileFetchNs = profileFetchRows = 0L;
+  }
+}
+
 bool SqlQuery::isValid() const
 {
   return query.isValid();
@@ -156,8 +194,13 @@ void SqlQuery::setForwardOnly(bool forward)
 
 void SqlQuery::exec(const QString& queryStr)
 {
+  QElapsedTimer timer;
+  startProfile(timer);
+
   queryString = queryStr;
-  checkError(query.exec(queryStr), QLatin1String(Q_FUNC_INFO) % ": Error executing query");
+  bool ok = query.exec(queryStr);
+  endProfileExec(timer);
+  checkError(ok, QLatin1String(Q_FUNC_INFO) % ": Error executing query");
 
   if(db->isAutocommit())
     db->commit();
@@ -212,7 +255,21 @@ bool SqlQuery::next()
 {
   checkError(isSelect(), QLatin1String(Q_FUNC_INFO) % " on query which is not a select");
   checkError(isActive(), QLatin1String(Q_FUNC_INFO) % " on inactive query");
-  return query.next();
+
+  if(db->getProfiler() == nullptr)
+    return query.next();
+
+  // Sum up locally and pass to profiler when done to avoid locking for each row
+  QElapsedTimer timer;
+  timer.start();
+  bool retval = query.next();
+  profileFetchNs += timer.nsecsElapsed();
+
+  if(retval)
+    profileFetchRows++;
+  else
+    flushProfileFetch();
+  return retval;
 }
 
 bool SqlQuery::previous()
@@ -274,14 +331,22 @@ void SqlQuery::exec()
   qDebug() << Q_FUNC_INFO << boundValuesAsString();
 #endif
 
-  checkError(query.exec(), QLatin1String(Q_FUNC_INFO) % ": Error executing query");
+  QElapsedTimer timer;
+  startProfile(timer);
+  bool ok = query.exec();
+  endProfileExec(timer);
+  checkError(ok, QLatin1String(Q_FUNC_INFO) % ": Error executing query");
   if(db->isAutocommit())
     db->commit();
 }
 
 void SqlQuery::execBatch(QSqlQuery::BatchExecutionMode mode)
 {
-  checkError(query.execBatch(mode), QLatin1String(Q_FUNC_INFO) % ": Error executing query batch");
+  QElapsedTimer timer;
+  startProfile(timer);
+  bool ok = query.execBatch(mode);
+  endProfileExec(timer);
+  checkError(ok, QLatin1String(Q_FUNC_INFO) % ": Error executing query batch");
 
   if(db->isAutocommit())
     db->commit();
@@ -289,13 +354,48 @@ void SqlQuery::execBatch(QSqlQuery::BatchExecutionMode mode)
 
 void SqlQuery::prepare(const QString& queryStr)
 {
+  QElapsedTimer timer;
+  startProfile(timer);
+
   queryString = queryStr;
-  checkError(query.prepare(queryStr), QLatin1String(Q_FUNC_INFO) % ": Error executing prepare");
+  bool ok = query.prepare(queryStr);
+  if(timer.isValid())
+    db->getProfiler()->addPrepare(queryString, timer.nsecsElapsed());
+  checkError(ok, QLatin1String(Q_FUNC_INFO) % ": Error executing prepare");
 
   // Extract named or positional bindings
   placeholderList = extractPlaceholders(queryString, positionalPlaceholders);
 
   placeholderSet = QSet<QString>(placeholderList.begin(), placeholderList.end());
+
+  placeholderIndexes.clear();
+  if(!positionalPlaceholders)
+  {
+    for(int i = 0; i < placeholderList.size(); i++)
+    {
+      if(placeholderIndexes.contains(placeholderList.at(i)))
+        placeholderIndexes.insert(placeholderList.at(i), -1);
+      else
+        placeholderIndexes.insert(placeholderList.at(i), i);
+    }
+  }
+}
+
+int SqlQuery::placeholderIndex(const QString& placeholder) const
+{
+  checkPlaceholder(Q_FUNC_INFO, placeholder);
+
+  int index = placeholderIndexes.value(placeholder, -1);
+  if(index == -1)
+    throw SqlException(this, QLatin1String(Q_FUNC_INFO) % ": Placeholder \"" % placeholder %
+                       "\" used more than once in query \"" % queryString % "\"");
+  return index;
+}
+
+void SqlQuery::throwIndexError(int index) const
+{
+  throw SqlException(this, QLatin1String(Q_FUNC_INFO) % ": Index " % QString::number(index) %
+                     " out of range for query \"" % queryString % "\"");
 }
 
 void SqlQuery::bindValue(const QString& placeholder, const QVariant& val, QSql::ParamType type)
@@ -536,6 +636,7 @@ QVariant SqlQuery::lastInsertId() const
 
 void SqlQuery::finish()
 {
+  flushProfileFetch();
   query.finish();
 }
 
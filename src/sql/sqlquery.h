@@ -22,11 +22,13 @@
 #include "sql/sqltypes.h"
 
 #include <QDateTime>
+#include <QHash>
 #include <QSet>
 #include <QSqlQuery>
 #include <QVariant>
 
 class QSqlResult;
+class QElapsedTimer;
 
 namespace atools {
 namespace sql {
@@ -40,6 +42,8 @@ class SqlRecord;
  * is thrown.
  * Exception is also thrown if a bind() or value() receive an invalid
  * name or index.
+ *
+ * Times for prepare(), exec() and next() are reported to the SqlProfiler if one is attached to the database.
  */
 class SqlQuery
 {
@@ -233,6 +237,43 @@ public:
   void bindNullBytes(const QString& placeholder);
   void bindNullBytes(int pos);
 
+  /* Index of a named placeholder for the typed binding methods below. Resolved once in prepare().
+   * Throws an exception if the placeholder is not found or appears more than once in the statement. */
+  int placeholderIndex(const QString& placeholder) const;
+
+  /* Typed binding by index for hot insert loops. Avoids placeholder name lookups and checks.
+   * Index is from placeholderIndex() or the position for "?" bindings. */
+  void bindInt(int index, int val)
+  {
+    bindIndex(index, QVariant(val));
+  }
+
+  void bindInt64(int index, qint64 val)
+  {
+    bindIndex(index, QVariant(val));
+  }
+
+  void bindDouble(int index, double val)
+  {
+    bindIndex(index, QVariant(val));
+  }
+
+  void bindStr(int index, const QString& val)
+  {
+    bindIndex(index, QVariant(val));
+  }
+
+  void bindBytes(int index, const QByteArray& val)
+  {
+    bindIndex(index, QVariant(val));
+  }
+
+  /* Bind a typed null value like QMetaType::fromType<int>() */
+  void bindNull(int index, QMetaType metaType)
+  {
+    bindIndex(index, QVariant(metaType));
+  }
+
   void bindRecord(const atools::sql::SqlRecord& record, const QString& bindPrefix = QString());
 
   void bindAndExecRecords(const atools::sql::SqlRecordList& records, const QString& bindPrefix = QString());
@@ -284,19 +325,42 @@ public:
 
 private:
   friend class SqlDatabase;
+  friend class SqlCursor;
 
   void checkError(bool retval = true, const QString& msg = QString()) const;
   void checkPlaceholder(const QString& funcInfo, const QString& placeholder) const;
   void checkPos(const QString& funcInfo, int pos) const;
   void checkValues(const QString& funcInfo, const QVariantList& values) const;
 
+  void bindIndex(int index, const QVariant& val)
+  {
+    if(index < 0 || index >= placeholderList.size())
+      throwIndexError(index);
+    query.bindValue(index, val);
+  }
+
+  [[noreturn]] void throwIndexError(int index) const;
+
+  /* Start timer if profiler is attached. Timer is left invalid otherwise. */
+  void startProfile(QElapsedTimer& timer);
+  void endProfileExec(const QElapsedTimer& timer);
+
+  /* Pass collected fetch time and rows from next() to profiler */
+  void flushProfileFetch();
+
   QSqlQuery query;
   QString queryString;
   QStringList placeholderList;
   QSet<QString> placeholderSet;
+
+  /* Named placeholder to index. -1 if the placeholder appears more than once. */
+  QHash<QString, int> placeholderIndexes;
   bool positionalPlaceholders = false;
 
   atools::sql::SqlDatabase *db = nullptr;
+
+  /* Collected by next() if profiling */
+  qint64 profileFetchNs = 0L, profileFetchRows = 0L;
 };
 
 } // namespace sql
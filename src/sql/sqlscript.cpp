@@ -17,12 +17,15 @@
 
 #include "sql/sqlscript.h"
 
+#include "sql/sqldatabase.h"
 #include "sql/sqlexception.h"
 #include "sql/sqlquery.h"
 #include "sql/sqlrecord.h"
 
 #include <QDebug>
 #include <QFile>
+#include <QSqlQuery>
+#include <QStringBuilder>
 #include <QTextStream>
 
 namespace atools {
@@ -40,90 +43,186 @@ SqlScript::SqlScript(SqlDatabase& sqlDb, bool verboseLogging)
 
 }
 
+QHash<QString, QList<SqlScript::ScriptCmd> > SqlScript::scriptCache;
+QMutex SqlScript::scriptCacheMutex;
+
+/* Used to wrap DML statements if no transaction is kept open */
+const static QLatin1String SAVEPOINT_NAME("sqlscript_dml");
+
+/* True if statement changes data */
+static bool isDml(const QString& sql)
+{
+  const static QLatin1String DML[] = {QLatin1String("insert "), QLatin1String("update "), QLatin1String("delete "),
+                                      QLatin1String("replace ")};
+  for(const QLatin1String& keyword : DML)
+  {
+    if(sql.startsWith(keyword, Qt::CaseInsensitive))
+      return true;
+  }
+  return false;
+}
+
 void SqlScript::executeScript(const QString& filename)
 {
-  QFile scriptFile(filename);
-  if(scriptFile.open(QIODevice::Text | QIODevice::ReadOnly))
+  QList<ScriptCmd> statements = readScript(filename, db);
+
+  if(verbose)
   {
-    QTextStream scriptStream(&scriptFile);
+    qDebug() << "-- Running script ------------------------------------------";
+    qDebug() << "--" << filename << "--";
+  }
 
-    if(verbose)
-    {
-      qDebug() << "-- Running script ------------------------------------------";
-      qDebug() << "--" << filename << "--";
-    }
+  executeStatements(statements);
 
-    executeScript(scriptStream);
+  if(verbose)
+    qDebug() << "-- Done ----------------------------------------------------";
+}
 
-    if(verbose)
-      qDebug() << "-- Done ----------------------------------------------------";
+void SqlScript::executeScript(QTextStream& script)
+{
+  QList<ScriptCmd> statements;
+  parseSqlScript(script, statements);
+  executeStatements(statements);
+}
+
+void SqlScript::preloadScripts(const QStringList& filenames)
+{
+  for(const QString& filename : filenames)
+    readScript(filename, nullptr);
+}
+
+void SqlScript::clearCache()
+{
+  QMutexLocker locker(&scriptCacheMutex);
+  scriptCache.clear();
+}
+
+QList<SqlScript::ScriptCmd> SqlScript::readScript(const QString& filename, const SqlDatabase *db)
+{
+  // Only resources cannot change while running
+  bool resource = filename.startsWith(QStringLiteral(":/"));
+  if(resource)
+  {
+    QMutexLocker locker(&scriptCacheMutex);
+    auto it = scriptCache.constFind(filename);
+    if(it != scriptCache.constEnd())
+      return it.value();
+  }
+
+  QList<ScriptCmd> statements;
+  QFile scriptFile(filename);
+  if(scriptFile.open(QIODevice::Text | QIODevice::ReadOnly))
+  {
+    QTextStream scriptStream(&scriptFile);
+    parseSqlScript(scriptStream, statements);
+    scriptFile.close();
   }
   else
     throw SqlException(db,
                        QStringLiteral("Cannot open script file \"%1\". Reason: %2.").arg(scriptFile.fileName()).arg(
                          scriptFile.errorString()));
-  scriptFile.close();
+
+  if(resource)
+  {
+    QMutexLocker locker(&scriptCacheMutex);
+    scriptCache.insert(filename, statements);
+  }
+  return statements;
 }
 
-void SqlScript::executeScript(QTextStream& script)
+void SqlScript::executeStatements(const QList<ScriptCmd>& statements)
 {
-  QList<ScriptCmd> statements;
-  parseSqlScript(script, statements);
+  // Statements run in an open transaction anyway if transactions are automatic
+  bool batchDml = !db->isAutomaticTransactions() && !db->isAutocommit();
+  bool inSavepoint = false;
 
   SqlQuery query(db);
-  for(const ScriptCmd& cmd : std::as_const(statements))
+  try
   {
-    if(verbose)
-      qDebug().nospace() << cmd.lineNumber << ": " << QString(cmd.sql).replace('\n', ' ');
-
-    query.exec(cmd.sql);
-
-    if(verbose)
+    for(int i = 0; i < statements.size(); i++)
     {
-      // Print affected rows if any ==============
-      if(query.numRowsAffected() > 0)
-        qDebug().nospace() << "[" << query.numRowsAffected() << "]";
+      const ScriptCmd& cmd = statements.at(i);
 
-      // Print query results ==============
-      if(query.isSelect())
+      // Start savepoint for a run of at least two DML statements - also works inside a transaction
+      if(batchDml && !inSavepoint && cmd.dml && i + 1 < statements.size() && statements.at(i + 1).dml)
       {
-        int row = 0;
-        while(query.next())
-        {
-          QStringList rowValues, rowHeader;
-          SqlRecord rec = query.record();
+        query.exec(QStringLiteral("savepoint ") % SAVEPOINT_NAME);
+        inSavepoint = true;
+      }
 
-          if(row == 0)
-          {
-            for(int i = 0; i < rec.count(); i++)
-              rowHeader += rec.fieldName(i);
-            qDebug().noquote().nospace() << rowHeader.join(";");
-          }
+      if(verbose)
+        qDebug().nospace() << cmd.lineNumber << ": " << QString(cmd.sql).replace('\n', ' ');
 
-          for(int i = 0; i < rec.count(); i++)
-          {
-            QVariant val = rec.value(i);
-            if(val.metaType() == QMetaType::fromType<QString>())
-              rowValues += "\"" + val.toString() + "\"";
-            else
-              rowValues += val.toString();
-          }
+      query.exec(cmd.sql);
 
-          qDebug().noquote().nospace() << rowValues.join(";");
-          row++;
+      if(verbose)
+        printResult(query);
 
-          if(row > 500)
-          {
-            qDebug() << "more ...";
-            break;
-          }
-        }
+      // End of DML run
+      if(inSavepoint && (i + 1 == statements.size() || !statements.at(i + 1).dml))
+      {
+        query.exec(QStringLiteral("release ") % SAVEPOINT_NAME);
+        inSavepoint = false;
       }
     }
   }
+  catch(...)
+  {
+    if(inSavepoint)
+    {
+      // Undo the partial run and remove the savepoint - ignore errors to keep the original exception
+      QSqlQuery rollbackQuery(db->getQSqlDatabase());
+      rollbackQuery.exec(QStringLiteral("rollback to ") % SAVEPOINT_NAME);
+      rollbackQuery.exec(QStringLiteral("release ") % SAVEPOINT_NAME);
+    }
+    throw;
+  }
   query.finish();
 }
 
+void SqlScript::printResult(SqlQuery& query)
+{
+  // Print affected rows if any ==============
+  if(query.numRowsAffected() > 0)
+    qDebug().nospace() << "[" << query.numRowsAffected() << "]";
+
+  // Print query results ==============
+  if(query.isSelect())
+  {
+    int row = 0;
+    while(query.next())
+    {
+      QStringList rowValues, rowHeader;
+      SqlRecord rec = query.record();
+
+      if(row == 0)
+      {
+        for(int i = 0; i < rec.count(); i++)
+          rowHeader += rec.fieldName(i);
+        qDebug().noquote().nospace() << rowHeader.join(";");
+      }
+
+      for(int i = 0; i < rec.count(); i++)
+      {
+        QVariant val = rec.value(i);
+        if(val.metaType() == QMetaType::fromType<QString>())
+          rowValues += "\"" + val.toString() + "\"";
+        else
+          rowValues += val.toString();
+      }
+
+      qDebug().noquote().nospace() << rowValues.join(";");
+      row++;
+
+      if(row > 500)
+      {
+        qDebug() << "more ...";
+        break;
+      }
+    }
+  }
+}
+
 void SqlScript::parseSqlScript(QTextStream& script, QList<ScriptCmd>& statements)
 {
   QString line;
@@ -207,7 +306,7 @@ void SqlScript::parseSqlScript(QTextStream& script, QList<ScriptCmd>& statements
           if(!isBlockComment)
           {
             // End of statement - reset all values
-            statements.append(ScriptCmd({currentStatement, currentLine}));
+            statements.append(ScriptCmd({currentStatement, currentLine, isDml(currentStatement)}));
             currentStatement.clear();
             isSingleString = false;
             isDoubleString = false;
@@ -18,7 +18,9 @@
 #ifndef ATOOLS_SQL_SQLSCRIPT_H
 #define ATOOLS_SQL_SQLSCRIPT_H
 
-#include <QString>
+#include <QHash>
+#include <QMutex>
+#include <QStringList>
 
 class QTextStream;
 
@@ -26,6 +28,7 @@ namespace atools {
 namespace sql {
 
 class SqlDatabase;
+class SqlQuery;
 
 /*
  * Runs full SQL scripts. Allows SQL line comments "--" and C block comments
@@ -36,6 +39,11 @@ class SqlDatabase;
  * The script commands and results are logged in the qInfo channel. SqlException
  * is thrown in case of error.
  *
+ * Scripts from Qt resources are parsed only once and kept in a static cache shared by all instances.
+ *
+ * Consecutive insert, update, delete and replace statements are wrapped in a savepoint if no transaction
+ * is kept open automatically by the database. This avoids one implicit transaction per statement.
+ *
  * Complex SQL as Oracle PL/SQL is not supported.
  */
 class SqlScript
@@ -53,15 +61,32 @@ public:
   /* Read script from stream and execute it */
   void executeScript(QTextStream& script);
 
+  /* Parse Qt resource scripts ahead and put them into the cache. Throws SqlException if a file cannot be read. */
+  static void preloadScripts(const QStringList& filenames);
+
+  /* Remove all parsed scripts from the cache */
+  static void clearCache();
+
 private:
   struct ScriptCmd
   {
     QString sql;
     int lineNumber;
+    bool dml; /* insert, update, delete or replace */
   };
 
+  /* Get statements from cache or read and parse file */
+  static QList<ScriptCmd> readScript(const QString& filename, const atools::sql::SqlDatabase *db);
+
   /* Extract line number / SQL statement pairs from the script */
-  void parseSqlScript(QTextStream& script, QList<ScriptCmd>& statements);
+  static void parseSqlScript(QTextStream& script, QList<ScriptCmd>& statements);
+
+  void executeStatements(const QList<ScriptCmd>& statements);
+  void printResult(atools::sql::SqlQuery& query);
+
+  /* Parsed scripts from Qt resources by filename */
+  static QHash<QString, QList<ScriptCmd> > scriptCache;
+  static QMutex scriptCacheMutex;
 
   SqlDatabase *db;
   bool verbose = true;
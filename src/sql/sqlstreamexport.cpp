@@ -0,0 +1,294 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "sql/sqlstreamexport.h"
+
+#include "exception.h"
+#include "sql/sqlcursor.h"
+#include "sql/sqlrecord.h"
+
+#include <QFile>
+
+namespace atools {
+namespace sql {
+
+SqlStreamExport::SqlStreamExport(Format formatParam, int bufferSizeParam)
+  : format(formatParam), bufferSize(bufferSizeParam)
+{
+}
+
+int SqlStreamExport::exportQuery(SqlQuery& query, QIODevice& device)
+{
+  SqlCursor cursor(query);
+  return exportCursor(cursor, device);
+}
+
+int SqlStreamExport::exportQuery(const QString& queryString, const SqlDatabase *db, QIODevice& device)
+{
+  SqlCursor cursor(queryString, db);
+  return exportCursor(cursor, device);
+}
+
+int SqlStreamExport::exportQuery(const QString& queryString, const SqlDatabase *db, const QString& filename)
+{
+  QFile file(filename);
+  if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    throw Exception(QStringLiteral("Cannot open file \"%1\". Reason: %2").arg(filename).arg(file.errorString()));
+
+  int rows = exportQuery(queryString, db, file);
+  file.close();
+  return rows;
+}
+
+int SqlStreamExport::exportCursor(SqlCursor& cursor, QIODevice& device)
+{
+  // Resolve column names and JSON keys once
+  SqlRecord record = cursor.getQuery().record();
+  QStringList columns;
+  for(int i = 0; i < record.count(); i++)
+    columns.append(record.fieldName(i));
+  int numCols = columns.size();
+
+  QList<QByteArray> jsonKeys;
+  if(format == JSON_LINES)
+  {
+    for(int i = 0; i < numCols; i++)
+    {
+      QByteArray key;
+      key.append(i == 0 ? '{' : ',');
+      buffer.clear();
+      writeJsonString(columns.at(i).toUtf8());
+      key.append(buffer).append(':');
+      jsonKeys.append(key);
+    }
+  }
+
+  buffer.clear();
+  buffer.reserve(bufferSize + bufferSize / 4);
+
+  if(format == CSV && header)
+    writeCsvHeader(columns);
+
+  int rows = 0;
+  while((maxRows == -1 || rows < maxRows) && cursor.next())
+  {
+    if(format == CSV)
+    {
+      for(int i = 0; i < numCols; i++)
+      {
+        if(i > 0)
+          buffer.append(separator);
+        writeCsvValue(cursor, i);
+      }
+    }
+    else
+    {
+      for(int i = 0; i < numCols; i++)
+      {
+        buffer.append(jsonKeys.at(i));
+        writeJsonValue(cursor, i);
+      }
+      buffer.append(numCols > 0 ? "}" : "{}");
+    }
+    buffer.append('\n');
+    rows++;
+
+    flush(device, false);
+  }
+  flush(device, true);
+  return rows;
+}
+
+void SqlStreamExport::flush(QIODevice& device, bool force)
+{
+  if(buffer.size() >= bufferSize || (force && !buffer.isEmpty()))
+  {
+    if(device.write(buffer) != buffer.size())
+      throw Exception(QStringLiteral("Error writing export. Reason: %1").arg(device.errorString()));
+
+    // Keeps capacity
+    buffer.resize(0);
+  }
+}
+
+void SqlStreamExport::writeCsvHeader(const QStringList& columns)
+{
+  for(int i = 0; i < columns.size(); i++)
+  {
+    if(i > 0)
+      buffer.append(separator);
+    writeCsvString(columns.at(i).toUtf8());
+  }
+  buffer.append('\n');
+}
+
+void SqlStreamExport::writeCsvValue(SqlCursor& cursor, int index)
+{
+  QVariant value = cursor.value(index);
+
+  if(value.isNull())
+    buffer.append(nullValue);
+  else
+  {
+    switch(value.typeId())
+    {
+      case QMetaType::Int:
+      case QMetaType::UInt:
+      case QMetaType::LongLong:
+      case QMetaType::ULongLong:
+        buffer.append(QByteArray::number(value.toLongLong()));
+        break;
+
+      case QMetaType::Double:
+      case QMetaType::Float:
+        buffer.append(QByteArray::number(value.toDouble(), 'f', numberPrecision));
+        break;
+
+      case QMetaType::QByteArray:
+        buffer.append(value.toByteArray().toBase64());
+        break;
+
+      default:
+        writeCsvString(value.toString().toUtf8());
+        break;
+    }
+  }
+}
+
+void SqlStreamExport::writeCsvString(const QByteArray& utf8)
+{
+  // Check for special characters and whitespace only values like SqlExport::buildString()
+  bool quote = false, whitespace = !utf8.isEmpty();
+  for(char c : utf8)
+  {
+    if(c == separator || c == escape || c == '\n' || c == '\r')
+    {
+      quote = true;
+      break;
+    }
+    if(whitespace && c != ' ' && c != '\t' && c != '\f' && c != '\v')
+      whitespace = false;
+  }
+
+  if(quote || whitespace)
+  {
+    buffer.append(escape);
+    for(char c : utf8)
+    {
+      // Escape escapes by doubling
+      if(c == escape)
+        buffer.append(escape);
+      buffer.append(c);
+    }
+    buffer.append(escape);
+  }
+  else
+    buffer.append(utf8);
+}
+
+void SqlStreamExport::writeJsonValue(SqlCursor& cursor, int index)
+{
+  QVariant value = cursor.value(index);
+
+  if(value.isNull())
+    buffer.append("null");
+  else
+  {
+    switch(value.typeId())
+    {
+      case QMetaType::Bool:
+        buffer.append(value.toBool() ? "true" : "false");
+        break;
+
+      case QMetaType::Int:
+      case QMetaType::UInt:
+      case QMetaType::LongLong:
+      case QMetaType::ULongLong:
+        buffer.append(QByteArray::number(value.toLongLong()));
+        break;
+
+      case QMetaType::Double:
+      case QMetaType::Float:
+        {
+          double d = value.toDouble();
+          if(qIsFinite(d))
+            buffer.append(QByteArray::number(d, 'f', numberPrecision));
+          else
+            // NaN and infinity are not allowed in JSON
+            buffer.append("null");
+        }
+        break;
+
+      case QMetaType::QByteArray:
+        buffer.append('"').append(value.toByteArray().toBase64()).append('"');
+        break;
+
+      default:
+        writeJsonString(value.toString().toUtf8());
+        break;
+    }
+  }
+}
+
+void SqlStreamExport::writeJsonString(const QByteArray& utf8)
+{
+  static const char HEX[] = "0123456789abcdef";
+
+  buffer.append('"');
+  for(char c : utf8)
+  {
+    switch(c)
+    {
+      case '"':
+        buffer.append("\\\"");
+        break;
+
+      case '\\':
+        buffer.append("\\\\");
+        break;
+
+      case '\n':
+        buffer.append("\\n");
+        break;
+
+      case '\r':
+        buffer.append("\\r");
+        break;
+
+      case '\t':
+        buffer.append("\\t");
+        break;
+
+      default:
+        if(static_cast<unsigned char>(c) < 0x20)
+        {
+          // Other control characters
+          buffer.append("\\u00");
+          buffer.append(HEX[(c >> 4) & 0x0f]);
+          buffer.append(HEX[c & 0x0f]);
+        }
+        else
+          // Multi byte UTF-8 sequences are copied unchanged
+          buffer.append(c);
+        break;
+    }
+  }
+  buffer.append('"');
+}
+
+} // namespace sql
+} // namespace atools
@@ -0,0 +1,127 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_SQL_SQLSTREAMEXPORT_H
+#define ATOOLS_SQL_SQLSTREAMEXPORT_H
+
+#include <QByteArray>
+#include <QStringList>
+
+class QIODevice;
+
+namespace atools {
+namespace sql {
+
+class SqlDatabase;
+class SqlQuery;
+class SqlCursor;
+
+/*
+ * Streaming export of large result sets like full tables into CSV or JSON Lines files.
+ *
+ * Other than SqlExport no records, variant lists or strings are built per row. Values are read from a forward only
+ * SqlCursor and written as UTF-8 directly into a large buffer which is flushed to the device when full.
+ *
+ * CSV follows RFC 4180 like SqlExport. JSON Lines writes one object per row using the column names as keys.
+ * Byte arrays are written Base64 encoded in both formats.
+ *
+ * Throws SqlException on query errors and Exception on write errors.
+ */
+class SqlStreamExport
+{
+public:
+  enum Format
+  {
+    CSV,
+    JSON_LINES
+  };
+
+  explicit SqlStreamExport(Format formatParam = CSV, int bufferSizeParam = DEFAULT_BUFFER_SIZE);
+
+  /* Write all rows of the prepared query to the device which has to be open for writing.
+   * Bound values have to be set before. Returns number of rows written. */
+  int exportQuery(atools::sql::SqlQuery& query, QIODevice& device);
+
+  /* Prepare and execute the query and write all rows to the device. Returns number of rows written. */
+  int exportQuery(const QString& queryString, const atools::sql::SqlDatabase *db, QIODevice& device);
+
+  /* Write all rows of the query into a new or truncated file. Returns number of rows written. */
+  int exportQuery(const QString& queryString, const atools::sql::SqlDatabase *db, const QString& filename);
+
+  /* Write a header containing the column names for CSV or not */
+  void setHeader(bool value)
+  {
+    header = value;
+  }
+
+  /* Write only this amount of rows. Default is -1 which means write all rows. */
+  void setMaxRows(int value)
+  {
+    maxRows = value;
+  }
+
+  /* CSV field separator character. Has to be ASCII. */
+  void setSeparatorChar(char value)
+  {
+    separator = value;
+  }
+
+  /* CSV character used to wrap fields containing special characters. Has to be ASCII. */
+  void setEscapeChar(char value)
+  {
+    escape = value;
+  }
+
+  /* String used for null values in CSV. Empty string by default. JSON always uses null. */
+  void setNullValue(const QString& value)
+  {
+    nullValue = value.toUtf8();
+  }
+
+  /* Number of decimals for floating point values */
+  void setNumberPrecision(int value)
+  {
+    numberPrecision = value;
+  }
+
+  /* Default output buffer size in bytes */
+  const static int DEFAULT_BUFFER_SIZE = 4 * 1024 * 1024;
+
+private:
+  int exportCursor(atools::sql::SqlCursor& cursor, QIODevice& device);
+
+  void writeCsvHeader(const QStringList& columns);
+  void writeCsvValue(atools::sql::SqlCursor& cursor, int index);
+  void writeCsvString(const QByteArray& utf8);
+
+  void writeJsonValue(atools::sql::SqlCursor& cursor, int index);
+  void writeJsonString(const QByteArray& utf8);
+
+  /* Write buffer to device if full or force */
+  void flush(QIODevice& device, bool force);
+
+  Format format;
+  int bufferSize, maxRows = -1, numberPrecision = 6;
+  bool header = true;
+  char separator = ',', escape = '"';
+  QByteArray nullValue, buffer;
+};
+
+} // namespace sql
+} // namespace atools
+
+#endif // ATOOLS_SQL_SQLSTREAMEXPORT_H
@@ -16,6 +16,7 @@
 *****************************************************************************/
 
 #include "sql/sqlutil.h"
+#include "sql/sqlcachedquery.h"
 #include "sql/sqldatabase.h"
 #include "sql/sqlrecord.h"
 #include "sql/sqlquery.h"
@@ -184,31 +185,61 @@ bool SqlUtil::hasRows(const QString& tablename, const QString& criteria) const
 
 void SqlUtil::copyRowValues(const SqlQuery& from, SqlQuery& to)
 {
-  copyRowValuesInternal(from, to, from.record(), to.boundPlaceholderAndValueMap());
+  copyRowValuesInternal(from, to, copyRowIndexes(from.record(), to));
 }
 
-void SqlUtil::copyRowValuesInternal(const SqlQuery& from, SqlQuery& to, const SqlRecord& fromRec, const QMap<QString, QVariant>& bound)
+void SqlUtil::copyRowValues(const SqlQuery& from, SqlQuery& to, const QList<int>& indexes)
 {
+  copyRowValuesInternal(from, to, indexes);
+}
+
+QList<int> SqlUtil::copyRowIndexes(const SqlRecord& fromRec, const SqlQuery& to)
+{
+  const QStringList& placeholders = to.getPlaceholderList();
+
+  QList<int> indexes;
+  indexes.reserve(fromRec.count());
   for(int i = 0; i < fromRec.count(); i++)
   {
     QString bind = ":" % fromRec.fieldName(i);
-    if(bound.contains(bind))
-      to.bindValue(bind, from.value(i));
+    int index = placeholders.indexOf(bind);
+
+    // Binding by position covers only one occurrence - bind by name if placeholder is used more than once
+    if(index != -1 && placeholders.lastIndexOf(bind) != index)
+      index = COPY_BY_NAME;
+    indexes.append(index);
+  }
+  return indexes;
+}
+
+void SqlUtil::copyRowValuesInternal(const SqlQuery& from, SqlQuery& to, const QList<int>& indexes)
+{
+  for(int i = 0; i < indexes.size(); i++)
+  {
+    int index = indexes.at(i);
+    if(index >= 0)
+      to.bindValue(index, from.value(i));
+    else if(index == COPY_BY_NAME)
+      to.bindValue(":" % from.record().fieldName(i), from.value(i));
   }
 }
 
 int SqlUtil::copyResultValues(SqlQuery& from, SqlQuery& to, std::function<bool(SqlQuery&, SqlQuery&)> func)
 {
   int copied = 0;
-  SqlRecord fromRec;
-  QMap<QString, QVariant> bound = to.boundPlaceholderAndValueMap();
+  QList<int> indexes;
+  bool first = true;
 
   while(from.next())
   {
-    if(fromRec.isEmpty())
-      fromRec = from.record();
+    // Resolve placeholders once per result set
+    if(first)
+    {
+      indexes = copyRowIndexes(from.record(), to);
+      first = false;
+    }
 
-    copyRowValuesInternal(from, to, fromRec, bound);
+    copyRowValuesInternal(from, to, indexes);
 
     if(func(from, to))
     {
@@ -224,14 +255,19 @@ int SqlUtil::copyResultValues(SqlQuery& from, SqlQuery& to, std::function<bool(S
 int SqlUtil::copyResultValues(SqlQuery& from, SqlQuery& to)
 {
   int copied = 0;
-  SqlRecord fromRec;
-  QMap<QString, QVariant> bound = to.boundPlaceholderAndValueMap();
+  QList<int> indexes;
+  bool first = true;
+
   while(from.next())
   {
-    if(fromRec.isEmpty())
-      fromRec = from.record();
+    // Resolve placeholders once per result set
+    if(first)
+    {
+      indexes = copyRowIndexes(from.record(), to);
+      first = false;
+    }
 
-    copyRowValuesInternal(from, to, fromRec, bound);
+    copyRowValuesInternal(from, to, indexes);
     to.exec();
     if(to.numRowsAffected() != 1)
       throw SqlException(&to, QLatin1String(Q_FUNC_INFO) % "Number of inserted rows not 1.");
@@ -240,6 +276,28 @@ int SqlUtil::copyResultValues(SqlQuery& from, SqlQuery& to)
   return copied;
 }
 
+int SqlUtil::copyTable(const QString& fromTable, const QString& toTable, const QString& whereClause) const
+{
+  // Copy only columns existing in both tables
+  const SqlRecord toRec = db->record(toTable);
+  QStringList columns;
+  for(const QString& column : db->record(fromTable).fieldNames())
+  {
+    if(toRec.contains(column))
+      columns.append(column);
+  }
+
+  if(columns.isEmpty())
+    return 0;
+
+  // Let the database copy all rows in one statement without transferring values
+  const QString cols = columns.join(", ");
+  SqlQuery query(db);
+  query.exec("insert into " % toTable % " (" % cols % ") select " % cols % " from " % fromTable %
+             (whereClause.isEmpty() ? QStringLiteral() : " where " % whereClause));
+  return query.numRowsAffected();
+}
+
 void SqlUtil::updateColumnInTable(const QString& table, const QString& idColum, const QStringList& queryColumns,
                                   const QStringList& insertcolumns, UpdateColFuncType func)
 {
@@ -524,13 +582,12 @@ bool SqlUtil::addColumnIf(const QString& table, const QString& column, const QSt
 int SqlUtil::getMaxId(const QString& table, const QString& idColumn)
 {
   int id = 0;
-  SqlQuery query("select max(" % (idColumn.isEmpty() ? "rowid" : idColumn) % ") from " % table, db);
-  query.exec();
-  if(query.next())
-    id = query.valueInt(0);
+  SqlCachedQuery query("select max(" % (idColumn.isEmpty() ? "rowid" : idColumn) % ") from " % table, db);
+  query->exec();
+  if(query->next())
+    id = query->valueInt(0);
   else
     qWarning() << Q_FUNC_INFO << "Nothing found in" << table << idColumn;
-  query.finish();
   return id;
 }
 
@@ -568,13 +625,12 @@ QString SqlUtil::getValueStr(const QString& queryStr, const QString& defaultValu
 QVariant SqlUtil::getValueVar(const QString& queryStr, const QVariant& defaultValue)
 {
   QVariant var;
-  SqlQuery query(queryStr, db);
-  query.exec(queryStr);
-  if(query.next())
-    var = query.value(0);
+  SqlCachedQuery query(queryStr, db);
+  query->exec();
+  if(query->next())
+    var = query->value(0);
   else
     var = defaultValue;
-  query.finish();
   return var;
 }
 
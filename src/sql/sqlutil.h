@@ -98,6 +98,7 @@ public:
    * @param func Function that acts a filter. If return value is true the row is
    * inserted. Will be called after all variables are bound.
    * @return number of rows copied
+   * Placeholders are resolved once per result set. Use copyTable() if both tables are in the same database.
    */
   static int copyResultValues(atools::sql::SqlQuery& from, atools::sql::SqlQuery& to,
                               std::function<bool(atools::sql::SqlQuery& from, atools::sql::SqlQuery& to)> func);
@@ -111,6 +112,19 @@ public:
    */
   static void copyRowValues(const atools::sql::SqlQuery& from, atools::sql::SqlQuery& to);
 
+  /* As above but uses indexes from copyRowIndexes() to avoid resolving placeholders for each row */
+  static void copyRowValues(const atools::sql::SqlQuery& from, atools::sql::SqlQuery& to, const QList<int>& indexes);
+
+  /* Get placeholder index in query "to" for each column in record "fromRec". Resolve once per result set
+   * and pass to copyRowValues(). Columns without a placeholder ":columnname" are skipped when copying. */
+  static QList<int> copyRowIndexes(const atools::sql::SqlRecord& fromRec, const atools::sql::SqlQuery& to);
+
+  /* Copy all columns existing in both tables using "insert ... select" on this database.
+   * Much faster than copyResultValues() since values are not transferred.
+   * @param whereClause optional filter for the source table without "where" keyword
+   * @return number of rows copied */
+  int copyTable(const QString& fromTable, const QString& toTable, const QString& whereClause = QString()) const;
+
   void reportRangeViolations(QDebug& out, const QString& table, const QStringList& reportCols, const QString& column,
                              const QVariant& minValue, const QVariant& maxValue) const;
 
@@ -152,8 +166,10 @@ private:
   const QStringList buildTableList(const QStringList& tables) const;
   const QStringList buildResultList(atools::sql::SqlQuery& query) const;
 
-  static void copyRowValuesInternal(const atools::sql::SqlQuery& from, atools::sql::SqlQuery& to,
-                                    const atools::sql::SqlRecord& fromRec, const QMap<QString, QVariant>& bound);
+  /* Placeholder in copy indexes is used more than once and has to be bound by name */
+  static const int COPY_BY_NAME = -2;
+
+  static void copyRowValuesInternal(const atools::sql::SqlQuery& from, atools::sql::SqlQuery& to, const QList<int>& indexes);
 
 };
 
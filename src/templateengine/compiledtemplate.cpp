@@ -0,0 +1,309 @@
+/**
+ *  @file
+ *  Parsed representation of a template.
+ */
+
+#include "compiledtemplate.h"
+#include <QStringList>
+
+using namespace stefanfrings;
+
+CompiledTemplate::CompiledTemplate(const QString& source, const QString& sourceName)
+{
+  this->sourceName = sourceName;
+  sourceSize = static_cast<int>(source.size());
+  parse(source);
+}
+
+void CompiledTemplate::appendLiteral(std::vector<Node>& nodes, const QString& text)
+{
+  if(!nodes.empty() && nodes.back().type == LITERAL)
+  {
+    nodes.back().text.append(text);
+  }
+  else
+  {
+    nodes.push_back(Node{LITERAL, text, {}, {}, false});
+  }
+}
+
+void CompiledTemplate::parse(const QString& source)
+{
+  // Stack of open blocks - nodes are moved into the parent when the block is closed
+  std::vector<Node> stack;
+  std::vector<Node> root;
+
+  // Get the list to append to depending on innermost open block
+  auto current = [&stack, &root]() -> std::vector<Node>& {
+    if(stack.empty())
+    {
+      return root;
+    }
+    return stack.back().hasElse ? stack.back().elseChildren : stack.back().children;
+  };
+
+  // Find innermost open block with name
+  auto findOpen = [&stack](const QString& name) -> int {
+    for(int i = static_cast<int>(stack.size()) - 1; i >= 0; i--)
+    {
+      if(stack.at(static_cast<size_t>(i)).text == name)
+      {
+        return i;
+      }
+    }
+    return -1;
+  };
+
+  // Close all blocks down to index
+  auto closeTo = [&stack, &current](int index) {
+    while(static_cast<int>(stack.size()) > index)
+    {
+      Node node = std::move(stack.back());
+      stack.pop_back();
+      current().push_back(std::move(node));
+    }
+  };
+
+  qsizetype pos = 0, size = source.size();
+  while(pos < size)
+  {
+    qsizetype open = source.indexOf('{', pos);
+    if(open < 0)
+    {
+      appendLiteral(current(), source.mid(pos));
+      break;
+    }
+
+    qsizetype close = source.indexOf('}', open + 1);
+    if(close < 0)
+    {
+      appendLiteral(current(), source.mid(pos));
+      break;
+    }
+
+    // Text before the brace
+    if(open > pos)
+    {
+      appendLiteral(current(), source.mid(pos, open - pos));
+    }
+
+    QString tag = source.mid(open + 1, close - open - 1);
+    if(tag.isEmpty() || tag.contains('{') || tag.contains('\n'))
+    {
+      // Not a tag - keep brace and continue after it
+      appendLiteral(current(), QStringLiteral("{"));
+      pos = open + 1;
+      continue;
+    }
+
+    QString keyword = tag.section(' ', 0, 0), name = tag.section(' ', 1);
+    if(keyword == QLatin1String("if") && !name.isEmpty())
+    {
+      stack.push_back(Node{CONDITION, name, {}, {}, false});
+      conditionCounts[name]++;
+    }
+    else if(keyword == QLatin1String("ifnot") && !name.isEmpty())
+    {
+      stack.push_back(Node{CONDITION_NOT, name, {}, {}, false});
+      conditionCounts[name]++;
+    }
+    else if(keyword == QLatin1String("loop") && !name.isEmpty())
+    {
+      stack.push_back(Node{LOOP, name, {}, {}, false});
+      loopCounts[name]++;
+    }
+    else if(keyword == QLatin1String("else") && !name.isEmpty() && findOpen(name) >= 0)
+    {
+      int index = findOpen(name);
+      closeTo(index + 1);
+      stack.back().hasElse = true;
+    }
+    else if(keyword == QLatin1String("end") && !name.isEmpty() && findOpen(name) >= 0)
+    {
+      closeTo(findOpen(name));
+    }
+    else if(!tag.contains(' ') && !tag.contains('\t') && !tag.contains('\r'))
+    {
+      current().push_back(Node{VARIABLE, tag, {}, {}, false});
+      variableCounts[tag]++;
+    }
+    else
+    {
+      // Unknown or unmatched tag - keep text
+      appendLiteral(current(), source.mid(open, close - open + 1));
+    }
+    pos = close + 1;
+  }
+
+  if(!stack.empty())
+  {
+    qWarning("CompiledTemplate: missing end %s in %s", qPrintable(stack.back().text), qPrintable(sourceName));
+    closeTo(0);
+  }
+
+  nodes = std::move(root);
+}
+
+QString CompiledTemplate::render(const TemplateValues& values) const
+{
+  // Reserve space for source and all values to avoid reallocation
+  qsizetype reserve = sourceSize;
+  for(auto it = values.variables.constBegin(); it != values.variables.constEnd(); ++it)
+  {
+    reserve += it.value().size();
+  }
+
+  QString out;
+  out.reserve(reserve);
+
+  Prefixes prefixes;
+  renderNodes(out, nodes, values, prefixes);
+  return out;
+}
+
+void CompiledTemplate::renderNodes(QString& out, const std::vector<Node>& nodeList, const TemplateValues& values,
+                                   Prefixes& prefixes) const
+{
+  for(const Node& node : nodeList)
+  {
+    if(node.type == LITERAL)
+    {
+      out.append(node.text);
+      continue;
+    }
+
+    QString name = resolve(node.text, prefixes);
+    switch(node.type)
+    {
+      case LITERAL:
+        break;
+
+      case VARIABLE:
+      {
+        auto it = values.variables.constFind(name);
+        if(it != values.variables.constEnd())
+        {
+          out.append(it.value());
+        }
+        else
+        {
+          out.append('{').append(name).append('}');
+        }
+        break;
+      }
+
+      case CONDITION:
+      case CONDITION_NOT:
+      {
+        auto it = values.conditions.constFind(name);
+        if(it != values.conditions.constEnd())
+        {
+          bool value = node.type == CONDITION ? it.value() : !it.value();
+          renderNodes(out, value ? node.children : node.elseChildren, values, prefixes);
+        }
+        else
+        {
+          // Not set - keep tags
+          out.append(node.type == CONDITION ? QLatin1String("{if ") : QLatin1String("{ifnot ")).append(name).append('}');
+          renderNodes(out, node.children, values, prefixes);
+          if(node.hasElse)
+          {
+            out.append(QLatin1String("{else ")).append(name).append('}');
+            renderNodes(out, node.elseChildren, values, prefixes);
+          }
+          out.append(QLatin1String("{end ")).append(name).append('}');
+        }
+        break;
+      }
+
+      case LOOP:
+      {
+        auto it = values.loops.constFind(name);
+        if(it != values.loops.constEnd())
+        {
+          if(it.value() > 0)
+          {
+            // Number variables, conditions and sub-loops within the loop
+            for(int i = 0; i < it.value(); i++)
+            {
+              prefixes.push_back(std::make_pair(name + '.', name + QString::number(i) + '.'));
+              renderNodes(out, node.children, values, prefixes);
+              prefixes.pop_back();
+            }
+          }
+          else
+          {
+            renderNodes(out, node.elseChildren, values, prefixes);
+          }
+        }
+        else
+        {
+          // Not set - keep tags
+          out.append(QLatin1String("{loop ")).append(name).append('}');
+          renderNodes(out, node.children, values, prefixes);
+          if(node.hasElse)
+          {
+            out.append(QLatin1String("{else ")).append(name).append('}');
+            renderNodes(out, node.elseChildren, values, prefixes);
+          }
+          out.append(QLatin1String("{end ")).append(name).append('}');
+        }
+        break;
+      }
+    }
+  }
+}
+
+QString CompiledTemplate::resolve(const QString& name, const Prefixes& prefixes)
+{
+  QString resolved = name;
+  for(const std::pair<QString, QString>& prefix : prefixes)
+  {
+    if(resolved.startsWith(prefix.first))
+    {
+      resolved.replace(0, prefix.first.size(), prefix.second);
+    }
+  }
+  return resolved;
+}
+
+QString CompiledTemplate::normalize(const QString& name) const
+{
+  // Strip numbers from all parts which follow a loop name like "row0.column1.value" -> "row.column.value"
+  QStringList parts = name.split('.');
+  QString path;
+  for(int i = 0; i < parts.size(); i++)
+  {
+    QString part = parts.at(i);
+    if(i < parts.size() - 1)
+    {
+      QString stripped = part;
+      while(!stripped.isEmpty() && stripped.back().isDigit())
+      {
+        stripped.chop(1);
+      }
+
+      if(loopCounts.contains(path.isEmpty() ? stripped : path + '.' + stripped))
+      {
+        part = stripped;
+      }
+    }
+    path = path.isEmpty() ? part : path + '.' + part;
+  }
+  return path;
+}
+
+int CompiledTemplate::countVariable(const QString& name) const
+{
+  return variableCounts.value(normalize(name));
+}
+
+int CompiledTemplate::countCondition(const QString& name) const
+{
+  return conditionCounts.value(normalize(name));
+}
+
+int CompiledTemplate::countLoop(const QString& name) const
+{
+  return loopCounts.value(normalize(name));
+}
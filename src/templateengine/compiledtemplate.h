@@ -0,0 +1,113 @@
+/**
+ *  @file
+ *  Parsed representation of a template.
+ */
+
+#ifndef COMPILEDTEMPLATE_H
+#define COMPILEDTEMPLATE_H
+
+#include <QHash>
+#include <QString>
+#include <vector>
+#include "templateglobal.h"
+
+namespace stefanfrings {
+
+/**
+ *  Values for rendering a CompiledTemplate. Names are the same as used
+ *  for Template::setVariable(), Template::setCondition() and Template::loop(),
+ *  i.e. variables inside loops are numbered like "row0.column1.value".
+ */
+struct DECLSPEC TemplateValues
+{
+  QHash<QString, QString> variables;
+  QHash<QString, bool> conditions;
+  QHash<QString, int> loops;
+};
+
+/**
+ *  Template which is parsed once into a tree of literals, variables, conditions and loops.
+ *  Rendering walks the tree and appends to a single pre-sized string instead of searching and
+ *  replacing in the whole text for each value like Template does.
+ *  <p>
+ *  The syntax and the output are the same as for Template. Tags without a value are kept
+ *  as they are. Values are inserted literally and are not parsed for tags again.
+ *  <p>
+ *  Objects are immutable after construction and can be shared between threads.
+ *  @see Template
+ *  @see TemplateCache
+ */
+class DECLSPEC CompiledTemplate
+{
+public:
+  /**
+   *  Parse the template.
+   *  @param source The template source text
+   *  @param sourceName Name of the source file, used for logging
+   */
+  CompiledTemplate(const QString& source, const QString& sourceName);
+
+  /** Create the output text for the given values */
+  QString render(const TemplateValues& values) const;
+
+  /**
+   *  Number of tags for the variable, condition or loop. Numbered names inside loops
+   *  like "user0.name" count the tags of "user.name".
+   */
+  int countVariable(const QString& name) const;
+  int countCondition(const QString& name) const;
+  int countLoop(const QString& name) const;
+
+  const QString& getSourceName() const
+  {
+    return sourceName;
+  }
+
+  /** Length of the source text */
+  int getSourceSize() const
+  {
+    return sourceSize;
+  }
+
+private:
+  enum NodeType
+  {
+    LITERAL,
+    VARIABLE,
+    CONDITION, /* {if name} */
+    CONDITION_NOT, /* {ifnot name} */
+    LOOP
+  };
+
+  struct Node
+  {
+    NodeType type;
+    QString text; /* Literal text or name */
+    std::vector<Node> children, elseChildren;
+    bool hasElse;
+  };
+
+  /** Loop name replacements like "row." to "row0." from outer to inner loop */
+  typedef std::vector<std::pair<QString, QString> > Prefixes;
+
+  void parse(const QString& source);
+  void renderNodes(QString& out, const std::vector<Node>& nodes, const TemplateValues& values, Prefixes& prefixes) const;
+
+  /** Apply loop numbering to the name */
+  static QString resolve(const QString& name, const Prefixes& prefixes);
+
+  /** Remove loop numbers from name */
+  QString normalize(const QString& name) const;
+
+  /** Add text to the last node if it is a literal or create a new literal */
+  static void appendLiteral(std::vector<Node>& nodes, const QString& text);
+
+  std::vector<Node> nodes;
+  QHash<QString, int> variableCounts, conditionCounts, loopCounts;
+  QString sourceName;
+  int sourceSize = 0;
+};
+
+} // end of namespace
+
+#endif // COMPILEDTEMPLATE_H
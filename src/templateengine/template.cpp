@@ -36,8 +36,26 @@ Template::Template(QFile& file, const QStringConverter::Encoding encoding)
   }
 }
 
+Template::Template(QSharedPointer<const CompiledTemplate> compiledTemplate)
+  : compiled(compiledTemplate)
+{
+  this->sourceName = compiled->getSourceName();
+  this->warnings = false;
+}
+
 int Template::setVariable(const QString name, const QString value)
 {
+  if(compiled)
+  {
+    int count = compiled->countVariable(name);
+    values.variables.insert(name, value);
+    if(count == 0 && warnings)
+    {
+      qWarning("Template: missing variable {%s} in %s", qPrintable(name), qPrintable(sourceName));
+    }
+    return count;
+  }
+
   int count = 0;
   QString variable = "{" + name + "}";
   int start = indexOf(variable);
@@ -56,6 +74,18 @@ int Template::setVariable(const QString name, const QString value)
 
 int Template::setCondition(const QString name, const bool value)
 {
+  if(compiled)
+  {
+    int count = compiled->countCondition(name);
+    values.conditions.insert(name, value);
+    if(count == 0 && warnings)
+    {
+      qWarning("Template: missing condition {if %s} or {ifnot %s} in %s", qPrintable(name), qPrintable(name),
+               qPrintable(sourceName));
+    }
+    return count;
+  }
+
   int count = 0;
   QString startTag = QStringLiteral("{if %1}").arg(name);
   QString elseTag = QStringLiteral("{else %1}").arg(name);
@@ -156,6 +186,17 @@ int Template::setCondition(const QString name, const bool value)
 int Template::loop(const QString name, const int repetitions)
 {
   Q_ASSERT(repetitions >= 0);
+  if(compiled)
+  {
+    int count = compiled->countLoop(name);
+    values.loops.insert(name, repetitions);
+    if(count == 0 && warnings)
+    {
+      qWarning("Template: missing loop {loop %s} in %s", qPrintable(name), qPrintable(sourceName));
+    }
+    return count;
+  }
+
   int count = 0;
   QString startTag = "{loop " + name + "}";
   QString elseTag = "{else " + name + "}";
@@ -241,3 +282,12 @@ void Template::enableWarnings(const bool enable)
 {
   warnings = enable;
 }
+
+const QString& Template::render()
+{
+  if(compiled)
+  {
+    QString::operator=(compiled->render(values));
+  }
+  return *this;
+}
@@ -11,7 +11,9 @@
 #include <QIODevice>
 #include <QFile>
 #include <QString>
+#include <QSharedPointer>
 #include "templateglobal.h"
+#include "compiledtemplate.h"
 
 namespace stefanfrings {
 
@@ -84,8 +86,12 @@ namespace stefanfrings {
  *  t.setVariable("row2.column2.value","k");
  *  t.setVariable("row2.column3.value","l");
  *  </pre></code></p>
+ *  <p>
+ *  A template created from a CompiledTemplate only records the values. Call render()
+ *  after setting all values to get the output text. The string itself is empty until then.
  *  @see TemplateLoader
  *  @see TemplateCache
+ *  @see CompiledTemplate
  */
 
 class DECLSPEC Template :
@@ -110,6 +116,13 @@ public:
    */
   Template(QFile& file, const QStringConverter::Encoding encoding);
 
+  /**
+   *  Constructor that uses a parsed template which can be shared between many instances.
+   *  Values are collected and inserted in one pass by render().
+   *  @param compiledTemplate Parsed template
+   */
+  Template(QSharedPointer<const CompiledTemplate> compiledTemplate);
+
   /**
    *  Replace a variable by the given value.
    *  Affects tags with the syntax
@@ -158,7 +171,26 @@ public:
    */
   void enableWarnings(const bool enable = true);
 
+  /**
+   *  Create the output text from the compiled template and all values set before.
+   *  Does nothing if the template was not created from a CompiledTemplate.
+   *  @return This string containing the output text
+   */
+  const QString& render();
+
+  /** True if created from a CompiledTemplate */
+  bool isCompiled() const
+  {
+    return !compiled.isNull();
+  }
+
 private:
+  /** Parsed template or null if the string is processed directly */
+  QSharedPointer<const CompiledTemplate> compiled;
+
+  /** Values collected for the compiled template */
+  TemplateValues values;
+
   /** Name of the source file */
   QString sourceName;
 
@@ -11,6 +11,7 @@ TemplateCache::TemplateCache(const QHash<QString, QVariant>& settings, QObject *
 {
   cache.setMaxCost(settings.value("cacheSize", "1000000").toInt());
   cacheTimeout = settings.value("cacheTime", "60000").toInt();
+  cacheCounters = HttpServerMetrics::instance().getCacheCounters("template");
   qDebug("TemplateCache: timeout=%i, size=%lli", cacheTimeout, cache.maxCost());
 }
 
@@ -28,9 +29,11 @@ QString TemplateCache::tryFile(const QString localizedName)
   CacheEntry *entry = cache.object(localizedName);
   if(entry && (cacheTimeout == 0 || entry->created > now - cacheTimeout))
   {
+    cacheCounters->count(true);
     mutex.unlock();
     return entry->document;
   }
+  cacheCounters->count(false);
   // search on filesystem
   entry = new CacheEntry();
   entry->created = now;
@@ -40,3 +43,39 @@ QString TemplateCache::tryFile(const QString localizedName)
   mutex.unlock();
   return entry->document;
 }
+
+QSharedPointer<const CompiledTemplate> TemplateCache::tryCompiledFile(const QString localizedName)
+{
+  qint64 now = QDateTime::currentMSecsSinceEpoch();
+  mutex.lock();
+  // search in cache
+  qDebug("TemplateCache: trying cached compiled %s", qPrintable(localizedName));
+  CacheEntry *entry = cache.object(localizedName);
+  if(entry && (cacheTimeout == 0 || entry->created > now - cacheTimeout))
+  {
+    cacheCounters->count(true);
+    if(entry->compiledTemplate.isNull() && !entry->document.isEmpty())
+    {
+      // Loaded by tryFile() before - parse once
+      entry->compiledTemplate.reset(new CompiledTemplate(entry->document, localizedName));
+    }
+    QSharedPointer<const CompiledTemplate> compiledTemplate = entry->compiledTemplate;
+    mutex.unlock();
+    return compiledTemplate;
+  }
+  cacheCounters->count(false);
+  // search on filesystem
+  entry = new CacheEntry();
+  entry->created = now;
+  entry->document = TemplateLoader::tryFile(localizedName);
+  if(!entry->document.isEmpty())
+  {
+    entry->compiledTemplate.reset(new CompiledTemplate(entry->document, localizedName));
+  }
+  // Copy before insert since the cache may delete the entry
+  QSharedPointer<const CompiledTemplate> compiledTemplate = entry->compiledTemplate;
+  // Store in cache even when the file did not exist, to remember that there is no such file
+  cache.insert(localizedName, entry, entry->document.size());
+  mutex.unlock();
+  return compiledTemplate;
+}
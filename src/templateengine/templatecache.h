@@ -4,6 +4,7 @@
 #include <QCache>
 #include "templateglobal.h"
 #include "templateloader.h"
+#include "httpserver/httpservermetrics.h"
 
 namespace stefanfrings {
 
@@ -33,11 +34,14 @@ namespace stefanfrings {
  *  encoding=UTF-8
  *  cacheSize=1000000
  *  cacheTime=60000
+ *  compiled=false
  *  </pre></code>
  *  The path is relative to the directory of the config file. In case of windows, if the
  *  settings are in the registry, the path is relative to the current working directory.
  *  <p>
  *  Files are cached as long as possible, when cacheTime=0.
+ *  <p>
+ *  If compiled is true, the parsed templates are cached too and shared by all requests.
  *  @see TemplateLoader
  */
 
@@ -69,10 +73,18 @@ protected:
    */
   virtual QString tryFile(const QString localizedName) override;
 
+  /**
+   *  Try to get a parsed file from cache or filesystem. Parses the file only once.
+   *  @param localizedName Name of the template with locale to find
+   *  @return The parsed template, or null if not found
+   */
+  virtual QSharedPointer<const CompiledTemplate> tryCompiledFile(const QString localizedName) override;
+
 private:
   struct CacheEntry
   {
     QString document;
+    QSharedPointer<const CompiledTemplate> compiledTemplate;
     qint64 created;
   };
 
@@ -84,6 +96,9 @@ private:
 
   /** Used to synchronize threads */
   QMutex mutex;
+
+  /** Hit and miss counters shared by all instances */
+  stefanfrings::HttpServerMetrics::CacheCounters *cacheCounters;
 };
 
 } // end of namespace
@@ -25,7 +25,8 @@ TemplateLoader::TemplateLoader(QHash<QString, QVariant> settings, QObject *paren
     templatePath = QFileInfo(QCoreApplication::applicationDirPath(), templatePath).absoluteFilePath();
   }
   fileNameSuffix = settings.value("suffix", ".tpl").toString();
-  qDebug("TemplateLoader: path=%s", qPrintable(templatePath));
+  compiled = settings.value("compiled", false).toBool();
+  qDebug("TemplateLoader: path=%s, compiled=%d", qPrintable(templatePath), compiled);
 }
 
 TemplateLoader::~TemplateLoader()
@@ -56,6 +57,37 @@ QString TemplateLoader::tryFile(QString localizedName)
   return "";
 }
 
+QSharedPointer<const CompiledTemplate> TemplateLoader::tryCompiledFile(const QString localizedName)
+{
+  QString document = tryFile(localizedName);
+  if(document.isEmpty())
+  {
+    return QSharedPointer<const CompiledTemplate>();
+  }
+  return QSharedPointer<const CompiledTemplate>(new CompiledTemplate(document, localizedName));
+}
+
+Template TemplateLoader::tryTemplate(const QString localizedName)
+{
+  if(compiled)
+  {
+    QSharedPointer<const CompiledTemplate> compiledTemplate = tryCompiledFile(localizedName);
+    if(compiledTemplate)
+    {
+      return Template(compiledTemplate);
+    }
+  }
+  else
+  {
+    QString document = tryFile(localizedName);
+    if(!document.isEmpty())
+    {
+      return Template(document, localizedName);
+    }
+  }
+  return Template("", localizedName);
+}
+
 Template TemplateLoader::getTemplate(QString templateName, QString locales)
 {
   QSet<QString> tried; // used to suppress duplicate attempts
@@ -70,10 +102,10 @@ Template TemplateLoader::getTemplate(QString templateName, QString locales)
     QString localizedName = templateName + "-" + loc.trimmed();
     if(!tried.contains(localizedName))
     {
-      QString document = tryFile(localizedName);
-      if(!document.isEmpty())
+      Template document = tryTemplate(localizedName);
+      if(document.isCompiled() || !document.isEmpty())
       {
-        return Template(document, localizedName);
+        return document;
       }
       tried.insert(localizedName);
     }
@@ -86,20 +118,20 @@ Template TemplateLoader::getTemplate(QString templateName, QString locales)
     QString localizedName = templateName + "-" + loc.trimmed();
     if(!tried.contains(localizedName))
     {
-      QString document = tryFile(localizedName);
-      if(!document.isEmpty())
+      Template document = tryTemplate(localizedName);
+      if(document.isCompiled() || !document.isEmpty())
       {
-        return Template(document, localizedName);
+        return document;
       }
       tried.insert(localizedName);
     }
   }
 
   // Search for default file
-  QString document = tryFile(templateName);
-  if(!document.isEmpty())
+  Template document = tryTemplate(templateName);
+  if(document.isCompiled() || !document.isEmpty())
   {
-    return Template(document, templateName);
+    return document;
   }
 
   qCritical("TemplateCache: cannot find template %s", qPrintable(templateName));
@@ -10,6 +10,7 @@
 #include <QMutex>
 #include "templateglobal.h"
 #include "template.h"
+#include "compiledtemplate.h"
 
 namespace stefanfrings {
 
@@ -29,7 +30,11 @@ namespace stefanfrings {
  *  path=../templates
  *  suffix=.tpl
  *  encoding=UTF-8
+ *  compiled=false
  *  </pre></code>
+ *  If compiled is true, templates are parsed into a CompiledTemplate and returned templates
+ *  have to be finished by calling Template::render() after setting the values.
+ *  <p>
  *  The path is relative to the directory of the config file. In case of windows, if the
  *  settings are in the registry, the path is relative to the current working directory.
  *  @see TemplateCache
@@ -69,11 +74,25 @@ protected:
    */
   virtual QString tryFile(const QString localizedName);
 
+  /**
+   *  Try to get a parsed file from cache or filesystem. Used if compiled is enabled.
+   *  @param localizedName Name of the template with locale to find
+   *  @return The parsed template, or null if not found
+   */
+  virtual QSharedPointer<const CompiledTemplate> tryCompiledFile(const QString localizedName);
+
   /** Directory where the templates are searched */
   QString templatePath;
 
   /** Suffix to the filenames */
   QString fileNameSuffix;
+
+  /** Return templates based on CompiledTemplate */
+  bool compiled;
+
+private:
+  /** Load plain or compiled template. Returns an empty template if not found */
+  Template tryTemplate(const QString localizedName);
 };
 
 } // end of namespace
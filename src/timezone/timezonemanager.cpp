@@ -24,15 +24,29 @@
 
 #include <QElapsedTimer>
 #include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QThreadPool>
 #include <QTimeZone>
 
 namespace atools {
 namespace timezone {
 
+/* Minimum number of positions per thread for batch lookups */
+const static int MIN_POSITIONS_PER_THREAD = 64;
+
 class TimeZonePrivate
 {
 public:
   ZoneDetect *timezoneDb = nullptr;
+
+  /* File mapped into memory. Pages are loaded on demand by the lookups. */
+  QFile *mappedFile = nullptr;
+  uchar *mapped = nullptr;
+
+  /* Copy of the file content if it cannot be mapped like compressed resources */
   QByteArray library;
 
   static void onError(int errZD, int errNative)
@@ -60,21 +74,47 @@ void TimeZoneManager::readFile(const QString& filename)
 {
   ZDSetErrorHandler(TimeZonePrivate::onError);
 
-  // Read file here and open library from memory since it cannot deal with UTF-8 paths
-  QFile file(filename);
-  if(file.open(QIODevice::ReadOnly))
+  // Open file here and open library from memory since it cannot deal with UTF-8 paths
+  QFile *file = new QFile(filename);
+  if(file->open(QIODevice::ReadOnly))
   {
-    p->library = file.readAll();
+    // Map file to avoid reading the whole database since lookups access only a few pages of the indexed file
+    void *buffer = nullptr;
+    size_t size = 0;
+    uchar *mapped = file->size() > 0 ? file->map(0, file->size()) : nullptr;
+    if(mapped != nullptr)
+    {
+      p->mappedFile = file;
+      p->mapped = mapped;
+      buffer = mapped;
+      size = static_cast<size_t>(file->size());
+    }
+    else
+    {
+      // Not mappable - read into memory
+      p->library = file->readAll();
+
+      if(file->error() != QFile::NoError)
+      {
+        QString error = file->errorString();
+        delete file;
+        throw atools::Exception(tr("Cannot read %1: %2").arg(filename).arg(error));
+      }
+      delete file;
 
-    if(file.error() != QFile::NoError)
-      throw atools::Exception(tr("Cannot read %1: %2").arg(filename).arg(file.errorString()));
+      buffer = p->library.data();
+      size = static_cast<size_t>(p->library.size());
+    }
 
-    p->timezoneDb = ZDOpenDatabaseFromMemory(p->library.data(), p->library.size());
+    p->timezoneDb = ZDOpenDatabaseFromMemory(buffer, size);
     if(!p->timezoneDb)
       throw atools::Exception(tr("Cannot read %1.").arg(filename));
   }
+  else
+    delete file;
 
-  qDebug() << Q_FUNC_INFO << "Opened" << filename << QString(ZDGetNotice(p->timezoneDb));
+  qDebug() << Q_FUNC_INFO << "Opened" << filename << (p->mapped != nullptr ? "mapped" : "in memory")
+           << QString(ZDGetNotice(p->timezoneDb));
 }
 
 void TimeZoneManager::clear()
@@ -82,6 +122,14 @@ void TimeZoneManager::clear()
   ZDCloseDatabase(p->timezoneDb);
   p->timezoneDb = nullptr;
   p->library.clear();
+
+  if(p->mappedFile != nullptr)
+  {
+    p->mappedFile->unmap(p->mapped);
+    delete p->mappedFile;
+    p->mappedFile = nullptr;
+    p->mapped = nullptr;
+  }
   qDebug() << Q_FUNC_INFO << "Closed timezone database";
 }
 
@@ -118,6 +166,126 @@ QTimeZone TimeZoneManager::getTimezone(float lonX, float latY) const
   return zone;
 }
 
+QByteArray TimeZoneManager::getTimezoneId(float lonX, float latY, float *safezoneDeg) const
+{
+  QByteArray id;
+  if(p->timezoneDb == nullptr)
+    return id;
+
+  // Same as ZDHelperSimpleLookupString() but returns the safe zone too
+  ZoneDetectResult *results = ZDLookup(p->timezoneDb, latY, lonX, safezoneDeg);
+  if(results != nullptr)
+  {
+    if(results[0].lookupResult != ZD_LOOKUP_END)
+    {
+      bool timezoneTable = ZDGetTableType(p->timezoneDb) == 'T';
+      QByteArray prefix, name;
+      for(unsigned int i = 0; i < results[0].numFields; i++)
+      {
+        const char *field = results[0].fieldNames[i], *data = results[0].data[i];
+        if(field != nullptr && data != nullptr)
+        {
+          if(timezoneTable)
+          {
+            if(qstrcmp(field, "TimezoneIdPrefix") == 0)
+              prefix = data;
+            else if(qstrcmp(field, "TimezoneId") == 0)
+              name = data;
+          }
+          else if(qstrcmp(field, "Name") == 0)
+            prefix = data;
+        }
+      }
+      id = prefix + name;
+    }
+    ZDFreeResults(results);
+  }
+  return id;
+}
+
+void TimeZoneManager::getTimezoneIds(QList<QByteArray>& ids, const QList<atools::geo::Pos>& positions,
+                                     QList<float> *safezonesDeg) const
+{
+  int num = static_cast<int>(positions.size());
+  ids.resize(num);
+  if(safezonesDeg != nullptr)
+    safezonesDeg->fill(0.f, num);
+
+  if(num == 0 || p->timezoneDb == nullptr)
+    return;
+
+  // Write into preallocated lists using raw pointers to avoid detaching from worker threads
+  QByteArray *idData = ids.data();
+  float *safezoneData = safezonesDeg != nullptr ? safezonesDeg->data() : nullptr;
+  const atools::geo::Pos *posData = positions.constData();
+
+  // Error handler throws exceptions which must not leave the worker threads
+  QMutex errorMutex;
+  QString errorMessage;
+
+  auto lookupRange = [this, idData, safezoneData, posData, &errorMutex, &errorMessage](int start, int end) -> void {
+        try
+        {
+          for(int i = start; i < end; i++)
+          {
+            const atools::geo::Pos& pos = posData[i];
+            if(pos.isValid())
+              idData[i] = getTimezoneId(pos.getLonX(), pos.getLatY(),
+                                        safezoneData != nullptr ? safezoneData + i : nullptr);
+          }
+        }
+        catch(atools::Exception& e)
+        {
+          QMutexLocker locker(&errorMutex);
+          errorMessage = e.what();
+        }
+      };
+
+  int numThreads = std::max(1, std::min(QThread::idealThreadCount(), num / MIN_POSITIONS_PER_THREAD));
+  if(numThreads > 1)
+  {
+    QThreadPool pool;
+    pool.setMaxThreadCount(numThreads);
+    int chunkSize = (num + numThreads - 1) / numThreads;
+    for(int start = 0; start < num; start += chunkSize)
+    {
+      int end = std::min(start + chunkSize, num);
+      pool.start([&lookupRange, start, end]() -> void {
+            lookupRange(start, end);
+          });
+    }
+    pool.waitForDone();
+  }
+  else
+    lookupRange(0, num);
+
+  if(!errorMessage.isEmpty())
+    throw atools::Exception(errorMessage);
+}
+
+void TimeZoneManager::getTimezones(QList<QTimeZone>& zones, const QList<atools::geo::Pos>& positions) const
+{
+  QList<QByteArray> ids;
+  getTimezoneIds(ids, positions);
+
+  // Create each zone only once since there are usually many positions in the same zone
+  QHash<QByteArray, QTimeZone> zoneCache;
+  zones.clear();
+  zones.reserve(ids.size());
+  for(const QByteArray& id : std::as_const(ids))
+  {
+    if(id.isEmpty())
+      zones.append(QTimeZone());
+    else
+    {
+      auto it = zoneCache.constFind(id);
+      if(it == zoneCache.constEnd())
+        it = zoneCache.insert(id, QTimeZone(id));
+      zones.append(it.value());
+    }
+  }
+}
+
 void TimeZoneManager::correctDateLocal(QDateTime& localDateTime, QDateTime& utcDateTime, int dayOfYearLocal, float secondsOfDayLocal,
                                        float secondsOfDayUtc, float lonX, float latY) const
 {
@@ -38,6 +38,9 @@ class TimeZonePrivate;
  * Loads a timezone file using code from https://github.com/BertoldVdb/ZoneDetect.
  * Files are generated from https://github.com/evansiroky/timezone-boundary-builder and
  * https://naciscdn.org/naturalearth/10m/cultural.
+ *
+ * Lookups are read only and can be called concurrently from several threads once the file is read.
+ * readFile() and clear() must not run concurrently with lookups.
  */
 class TimeZoneManager
 {
@@ -47,7 +50,8 @@ public:
   explicit TimeZoneManager(bool verboseParam = false);
   ~TimeZoneManager();
 
-  /* Reads time zone file into memory to prepare lookup. Throws exception in case of error. */
+  /* Maps time zone file into memory to prepare lookup. Reads the whole file if it cannot be mapped.
+   * Throws exception in case of error. */
   void readFile(const QString& filename);
 
   /* Clears the read file from memory */
@@ -57,6 +61,19 @@ public:
   QTimeZone getTimezone(const atools::geo::Pos& position) const;
   QTimeZone getTimezone(float lonX, float latY) const;
 
+  /* Time zone id like "Europe/Berlin" or empty if not found. Does not create a QTimeZone object.
+   * safezoneDeg receives the distance in degrees to the nearest zone border if not null.
+   * All positions closer than this distance are in the same zone. */
+  QByteArray getTimezoneId(float lonX, float latY, float *safezoneDeg = nullptr) const;
+
+  /* Batch lookup for many positions using all cores. ids gets one entry for each position which is empty
+   * for invalid positions or if not found. safezonesDeg receives the safe zone distances if not null. */
+  void getTimezoneIds(QList<QByteArray>& ids, const QList<atools::geo::Pos>& positions,
+                      QList<float> *safezonesDeg = nullptr) const;
+
+  /* As above but returns time zones which are invalid if not found */
+  void getTimezones(QList<QTimeZone>& zones, const QList<atools::geo::Pos>& positions) const;
+
   /* Determines timezone offset by seconds of day and creates localDateTime time from incomplete values based on current year.
    * Time can be converted to UTC which might also roll over the date.
    * Used to create a complete timedata from the cumbersome X-Plane time and date datarefs.
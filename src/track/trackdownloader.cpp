@@ -23,6 +23,8 @@
 #include "exception.h"
 
 #include <QFile>
+#include <QNetworkAccessManager>
+#include <QThreadPool>
 
 using atools::util::HttpDownloader;
 
@@ -43,6 +45,8 @@ const QHash<atools::track::TrackType, QString> TrackDownloader::URL =
   {PACOTS, "https://www.notams.faa.gov/dinsQueryWeb/advancedNotamMapAction.do"},
 };
 
+static const int DEFAULT_TIMEOUT_MS = 30000;
+
 const QHash<atools::track::TrackType, QStringList> TrackDownloader::PARAM =
 {
   {NAT, {}
@@ -55,11 +59,19 @@ const QHash<atools::track::TrackType, QStringList> TrackDownloader::PARAM =
 TrackDownloader::TrackDownloader(QObject *parent, bool logVerbose)
   : QObject(parent), verbose(logVerbose)
 {
+  networkManager = new QNetworkAccessManager(this);
+
+  // One thread for each track type
+  parserPool = new QThreadPool(this);
+  parserPool->setMaxThreadCount(2);
+
   // Initialize NAT downloader ============================================================
   HttpDownloader *natDownloader = new HttpDownloader(parent, verbose);
   natDownloader->setUrl(URL.value(NAT));
   natDownloader->setPostParameters(PARAM.value(NAT));
   natDownloader->setAcceptEncoding("gzip");
+  natDownloader->setNetworkManager(networkManager);
+  natDownloader->setTimeoutMs(DEFAULT_TIMEOUT_MS);
   connect(natDownloader, &HttpDownloader::downloadFinished, this, &TrackDownloader::natDownloadFinished);
   connect(natDownloader, &HttpDownloader::downloadFailed, this, &TrackDownloader::natDownloadFailed);
   connect(natDownloader, &HttpDownloader::downloadSslErrors, this, &TrackDownloader::trackDownloadSslErrors);
@@ -71,6 +83,8 @@ TrackDownloader::TrackDownloader(QObject *parent, bool logVerbose)
   pacotsDownloader->setUrl(URL.value(PACOTS));
   pacotsDownloader->setPostParameters(PARAM.value(PACOTS));
   pacotsDownloader->setAcceptEncoding("gzip");
+  pacotsDownloader->setNetworkManager(networkManager);
+  pacotsDownloader->setTimeoutMs(DEFAULT_TIMEOUT_MS);
   connect(pacotsDownloader, &HttpDownloader::downloadFinished, this, &TrackDownloader::pacotsDownloadFinished);
   connect(pacotsDownloader, &HttpDownloader::downloadFailed, this, &TrackDownloader::pacotsDownloadFailed);
   connect(pacotsDownloader, &HttpDownloader::downloadSslErrors, this, &TrackDownloader::trackDownloadSslErrors);
@@ -80,59 +94,73 @@ TrackDownloader::TrackDownloader(QObject *parent, bool logVerbose)
 
 TrackDownloader::~TrackDownloader()
 {
+  // Downloaders use the network manager
   qDeleteAll(downloaders);
+
+  // Queued results are dropped when this object is deleted
+  parserPool->waitForDone();
 }
 
 void TrackDownloader::natDownloadFinished(const QByteArray& data, QString downloadUrl)
 {
-  try
-  {
-#ifdef DEBUG_TRACK_TEST_SAVE
-    QFile file("/tmp/NAT.txt");
-    if(file.open(QIODevice::WriteOnly | QIODevice::Text))
-    {
-      file.write(data);
-      file.close();
-    }
-#endif
-
-    TrackReader reader;
-    reader.readTracks(atools::zip::gzipDecompressIf(data, Q_FUNC_INFO), NAT);
-    trackList[NAT] = reader.getTracks();
-
-    emit trackDownloadFinished(trackList.value(NAT), NAT);
-  }
-  catch(atools::Exception& e)
-  {
-    qWarning() << Q_FUNC_INFO << e.what() << downloadUrl;
-    emit trackDownloadFailed(e.what(), 0, downloadUrl, NAT);
-  }
+  parseInBackground(data, downloadUrl, NAT);
 }
 
 void TrackDownloader::pacotsDownloadFinished(const QByteArray& data, QString downloadUrl)
 {
-  try
-  {
+  parseInBackground(data, downloadUrl, PACOTS);
+}
+
+void TrackDownloader::parseInBackground(const QByteArray& data, const QString& downloadUrl, TrackType type)
+{
 #ifdef DEBUG_TRACK_TEST_SAVE
-    QFile file("/tmp/PACOTS.txt");
-    if(file.open(QIODevice::WriteOnly | QIODevice::Text))
-    {
-      file.write(data);
-      file.close();
-    }
+  QFile file("/tmp/" + typeToString(type) + ".txt");
+  if(file.open(QIODevice::WriteOnly | QIODevice::Text))
+  {
+    file.write(data);
+    file.close();
+  }
 #endif
 
-    TrackReader reader;
-    reader.readTracks(atools::zip::gzipDecompressIf(data, Q_FUNC_INFO), PACOTS);
-    trackList[PACOTS] = reader.getTracks();
+  // Do not wait for other downloads and parse as soon as the page arrives
+  quint32 parseGeneration = generation;
+  parserPool->start([this, data, downloadUrl, type, parseGeneration]() {
+          TrackListType tracks;
+          QString error;
+          try
+          {
+            TrackReader reader;
+            reader.readTracks(atools::zip::gzipDecompressIf(data, Q_FUNC_INFO), type);
+            tracks = reader.getTracks();
+          }
+          catch(atools::Exception& e)
+          {
+            qWarning() << Q_FUNC_INFO << e.what() << downloadUrl;
+            error = e.what();
+          }
+
+          QMetaObject::invokeMethod(this, [this, tracks, error, downloadUrl, type, parseGeneration]() {
+            parseFinished(tracks, error, downloadUrl, type, parseGeneration);
+          }, Qt::QueuedConnection);
+        });
+}
 
-    emit trackDownloadFinished(trackList.value(PACOTS), PACOTS);
+void TrackDownloader::parseFinished(const TrackListType& tracks, const QString& error, const QString& downloadUrl,
+                                    TrackType type, quint32 parseGeneration)
+{
+  if(parseGeneration != generation)
+  {
+    qDebug() << Q_FUNC_INFO << "Ignoring result of cancelled download" << downloadUrl;
+    return;
   }
-  catch(atools::Exception& e)
+
+  if(error.isEmpty())
   {
-    qWarning() << Q_FUNC_INFO << e.what() << downloadUrl;
-    emit trackDownloadFailed(e.what(), 0, downloadUrl, PACOTS);
+    trackList[type] = tracks;
+    emit trackDownloadFinished(trackList.value(type), type);
   }
+  else
+    emit trackDownloadFailed(error, 0, downloadUrl, type);
 }
 
 void TrackDownloader::natDownloadFailed(const QString& error, int errorCode, QString downloadUrl)
@@ -175,6 +203,7 @@ void TrackDownloader::startDownload(TrackType type)
 
 void TrackDownloader::cancelAllDownloads()
 {
+  generation++;
   for(HttpDownloader *downloader : std::as_const(downloaders))
     downloader->cancelDownload();
 }
@@ -217,5 +246,11 @@ void TrackDownloader::setIgnoreSslErrors(bool value)
     downloader->setIgnoreSslErrors(value);
 }
 
+void TrackDownloader::setTimeoutMs(int value)
+{
+  for(HttpDownloader *downloader : std::as_const(downloaders))
+    downloader->setTimeoutMs(value);
+}
+
 } // namespace track
 } // namespace atools
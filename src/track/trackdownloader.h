@@ -22,6 +22,9 @@
 
 #include <QObject>
 
+class QNetworkAccessManager;
+class QThreadPool;
+
 namespace atools {
 namespace util {
 class HttpDownloader;
@@ -32,6 +35,9 @@ namespace track {
  * Downloads HTML pages asynchronously from various services for NAT fills a list
  * of Track objects.
  *
+ * All sources are downloaded concurrently using a shared network manager. Each page is parsed in a
+ * background thread as soon as it arrives and the result is emitted in the thread of this object.
+ *
  * Default URLs are:
  * NAT: https://notams.aim.faa.gov/nat.html
  * PACOTS: The DINS Query page is no longer publicly available.
@@ -82,6 +88,9 @@ public:
    * Sets value to all downloaders. */
   void setIgnoreSslErrors(bool value);
 
+  /* Abort downloads if no data was received for the given time. 0 disables timeout. Default is 30 seconds. */
+  void setTimeoutMs(int value);
+
 signals:
   /* Emitted when HTML page was downloaded and parsed */
   void trackDownloadFinished(const atools::track::TrackListType& tracks, atools::track::TrackType type);
@@ -99,12 +108,28 @@ private:
   void natDownloadFailed(const QString& error, int errorCode, QString downloadUrl);
   void pacotsDownloadFailed(const QString& error, int errorCode, QString downloadUrl);
 
+  /* Parse downloaded data in background and emit trackDownloadFinished or trackDownloadFailed when done */
+  void parseInBackground(const QByteArray& data, const QString& downloadUrl, atools::track::TrackType type);
+
+  /* Called in the thread of this object once background parsing is done */
+  void parseFinished(const atools::track::TrackListType& tracks, const QString& error, const QString& downloadUrl,
+                     atools::track::TrackType type, quint32 parseGeneration);
+
   /* Download classes */
   QHash<atools::track::TrackType, atools::util::HttpDownloader *> downloaders;
 
   /* List of tracks for each type */
   QHash<atools::track::TrackType, atools::track::TrackListType> trackList;
 
+  /* Shared by all downloaders to reuse connections */
+  QNetworkAccessManager *networkManager = nullptr;
+
+  /* Parses downloaded pages */
+  QThreadPool *parserPool = nullptr;
+
+  /* Incremented on cancel to drop results of parsers still running */
+  quint32 generation = 0;
+
   bool verbose = false;
 };
 
@@ -30,6 +30,106 @@ namespace track {
 
 const static std::initializer_list<char> INVALID_CHARS = {'/', '-', ';', ':', '<', '>', '=', '(', ')'};
 
+// Patterns are compiled once ===================================================
+
+// TRACK 1.
+static const QRegularExpression PACOTS_TRACK_REGEXP("^TRACK (\\d+).$");
+
+// ... 07 MAR 07:00 2020 UNTIL 07 MAR 21:00 2020. CREATED: 06 MAR 18:47 2020 ...
+static const QRegularExpression PACOTS_DATE_REGEXP("(\\d\\d) ([A-Z]+) (\\d\\d):(\\d\\d) (\\d\\d\\d\\d) UNTIL "
+                                                   "(\\d\\d) ([A-Z]+) (\\d\\d):(\\d\\d) (\\d\\d\\d\\d)");
+
+// (TDM TRK K 200307050001
+static const QRegularExpression PACOTS_NAME_REGEXP("^\\(TDM TRK (\\S+)");
+
+// 2003070500 2003072100
+static const QRegularExpression PACOTS_VALID_REGEXP("(\\d\\d)(\\d\\d)(\\d\\d)(\\d\\d)(\\d\\d) "
+                                                    "(\\d\\d)(\\d\\d)(\\d\\d)(\\d\\d)(\\d\\d)");
+
+// MAR 08/0100Z TO MAR 08/0800Z
+static const QRegularExpression NAT_DATE_REGEXP("^([A-Z]+) (\\d+)/(\\d\\d)(\\d\\d)Z TO "
+                                                "([A-Z]+) (\\d+)/(\\d\\d)(\\d\\d)Z");
+
+/* Extracts the text between begin and end marker line by line. Markers are included. */
+struct Section
+{
+  Section(const QString& beginParam, const QString& endParam)
+    : begin(beginParam), end(endParam)
+  {
+  }
+
+  /* Returns the part of the line inside the section or an empty string if outside */
+  QString line(const QString& line)
+  {
+    int beginIndex = line.indexOf(begin, Qt::CaseInsensitive), endIndex = line.indexOf(end, Qt::CaseInsensitive);
+
+    if(inSection)
+    {
+      if(beginIndex == -1)
+      {
+        if(endIndex >= 0)
+        {
+          inSection = false;
+          return line.left(endIndex + end.size());
+        }
+        else
+          return line;
+      }
+      else
+        qWarning() << Q_FUNC_INFO << "Error reading track data. Found begin marker" << begin
+                   << "outside of section." << "line" << line;
+    }
+    else
+    {
+      if(endIndex == -1)
+      {
+        if(beginIndex >= 0)
+        {
+          inSection = true;
+          firstFound = true;
+          return line.mid(beginIndex);
+        }
+      }
+      else if(firstFound)
+        qWarning() << Q_FUNC_INFO << "Error reading track data. Found end marker" << end
+                   << "outside of section." << "line" << line;
+    }
+    return QString();
+  }
+
+  const QString begin, end;
+  bool inSection = false, firstFound = false;
+};
+
+struct TrackReader::ParserState
+{
+  explicit ParserState(TrackType trackType)
+    : type(trackType)
+  {
+  }
+
+  TrackType type;
+
+  // NAT - <PRE> is not reliable since the HTML is not valid
+  Section natSection = Section("(NAT-", ")");
+  QDateTime natFrom, natTo;
+  int year = QDateTime::currentDateTimeUtc().date().year();
+
+  // PACOTS - all lines of <PRE> elements containing track and flex track messages
+  Section preSection = Section("<PRE>", "</PRE>"), pacotsSection = Section("(TDM TRK ", "). ");
+  int numAfterStart = 0;
+  bool inRecord = false;
+
+  // PACOTS flex tracks
+  bool inFlexRecord = false, inRemark = false;
+  QString remark;
+  QDateTime flexFrom, flexTo;
+  TrackListType flexTemp, flexTracks;
+
+  // Tracks of current type
+  TrackListType temp;
+};
+
 TrackReader::TrackReader()
 {
 
@@ -55,43 +155,108 @@ void TrackReader::readTracks(const QString& filename, TrackType type)
 
 void TrackReader::readTracks(const QByteArray& data, TrackType type)
 {
-  QTextStream stream(data);
-  readTracks(stream, type);
+  if(type == atools::track::UNKNOWN)
+  {
+    qWarning() << Q_FUNC_INFO << "Track type" << static_cast<int>(type) << "not valid";
+    return;
+  }
+
+  ParserState state(type);
+
+  // Split lines directly in the downloaded buffer - skip UTF-8 BOM
+  qsizetype start = data.startsWith("\xEF\xBB\xBF") ? 3 : 0;
+  while(start < data.size())
+  {
+    qsizetype end = data.indexOf('\n', start);
+    if(end == -1)
+      end = data.size();
+
+    QString line = QString::fromUtf8(data.constData() + start, end - start).simplified();
+    if(!line.isEmpty())
+      parseLine(state, line);
+    start = end + 1;
+  }
+
+  finishParsing(state);
 }
 
 void TrackReader::readTracks(QTextStream& stream, TrackType type)
 {
-  QStringList lines = readLines(stream);
+  if(type == atools::track::UNKNOWN)
+  {
+    qWarning() << Q_FUNC_INFO << "Track type" << static_cast<int>(type) << "not valid";
+    return;
+  }
 
-  switch(type)
+  ParserState state(type);
+  while(!stream.atEnd())
+  {
+    QString line = stream.readLine().simplified();
+    if(!line.isEmpty())
+      parseLine(state, line);
+  }
+
+  finishParsing(state);
+}
+
+void TrackReader::parseLine(ParserState& state, const QString& line)
+{
+  switch(state.type)
   {
     case atools::track::UNKNOWN:
-      qWarning() << Q_FUNC_INFO << "Track type" << static_cast<int>(type) << "not valid";
       break;
 
     case atools::track::NAT:
-      // Read NAT - <PRE> is not reliable since the HTML is not valid
-      extractNatTracks(extractSections(lines, "(NAT-", ")"));
+      {
+        QString natLine = state.natSection.line(line);
+        if(!natLine.isEmpty())
+          parseNatLine(state, natLine);
+      }
       break;
 
     case atools::track::PACOTS:
       {
-        // Get all lines of <PRE> elements.
-        QStringList sections = extractSections(lines, "<PRE>", "</PRE>");
-
-        // Get tracks
-        // A0766/21 - (TDM TRK E 210222190001
-        // ...
-        // RMK/0). 22 FEB 19:00 2021 UNTIL 23 FEB 08:00 2021. CREATED: 22 FEB 00:45 2021
-        extractPacotsTracks(extractSections(sections, "(TDM TRK ", "). "));
-
-        // Get flex tracks
-        extractPacotsTracksFlex(sections);
+        QString preLine = state.preSection.line(line);
+        if(!preLine.isEmpty())
+        {
+          // Get tracks
+          // A0766/21 - (TDM TRK E 210222190001
+          // ...
+          // RMK/0). 22 FEB 19:00 2021 UNTIL 23 FEB 08:00 2021. CREATED: 22 FEB 00:45 2021
+          QString pacotsLine = state.pacotsSection.line(preLine);
+          if(!pacotsLine.isEmpty())
+            parsePacotsLine(state, pacotsLine);
+
+          // Get flex tracks
+          parsePacotsFlexLine(state, preLine);
+        }
       }
       break;
   }
 }
 
+void TrackReader::finishParsing(ParserState& state)
+{
+  if(state.type == NAT)
+  {
+    // Update direction based on levels ==========================
+    for(Track& track : state.temp)
+    {
+      if(!track.westLevels.isEmpty() && !track.eastLevels.isEmpty())
+        track.direction = BOTH;
+      else if(!track.westLevels.isEmpty())
+        track.direction = WEST;
+      else if(!track.eastLevels.isEmpty())
+        track.direction = EAST;
+    }
+  }
+
+  tracks.append(state.temp);
+  tracks.append(state.flexTracks);
+  state.temp.clear();
+  state.flexTracks.clear();
+}
+
 int TrackReader::removeInvalid()
 {
   return TrackReader::removeInvalid(tracks);
@@ -112,15 +277,8 @@ int TrackReader::removeInvalid(TrackListType& trackVector)
   return num;
 }
 
-void TrackReader::extractPacotsTracksFlex(const QStringList& lines)
+void TrackReader::parsePacotsFlexLine(ParserState& state, const QString& line)
 {
-  // TRACK 1.
-  static const QRegularExpression PACOTS_TRACK_REGEXP("^TRACK (\\d+).$");
-
-  // ... 07 MAR 07:00 2020 UNTIL 07 MAR 21:00 2020. CREATED: 06 MAR 18:47 2020 ...
-  static const QRegularExpression PACOTS_DATE_REGEXP("(\\d\\d) ([A-Z]+) (\\d\\d):(\\d\\d) (\\d\\d\\d\\d) UNTIL "
-                                                     "(\\d\\d) ([A-Z]+) (\\d\\d):(\\d\\d) (\\d\\d\\d\\d)");
-
   // More than one track for each element. Validity date at end.
   // <PRE><b>Q0328/20</b> - EASTBOUND PACOTS TRACKS BETWEEN JAPAN AND NORTH AMERICA,
   // TRACK 1.
@@ -146,103 +304,91 @@ void TrackReader::extractPacotsTracksFlex(const QStringList& lines)
   // 21:00 2020. CREATED: 06 MAR 18:43 2020
   // </PRE>
 
-  atools::track::TrackListType temp;
-  bool inRecord = false, inRemark = false;
-  QString remark;
-  QDateTime from, to;
-  for(const QString& line : lines)
+  bool endOfPre = line.contains("</PRE>", Qt::CaseInsensitive);
+
+  // Avoid regexp for most lines
+  QRegularExpressionMatch trackMatch;
+  if(line.startsWith("TRACK "))
+    trackMatch = PACOTS_TRACK_REGEXP.match(line);
+
+  // Reading remark =======================================
+  if(state.inRemark)
   {
-    // Reading remark =======================================
-    if(inRemark)
+    // End of remark - parse date =======================================
+    if(endOfPre || trackMatch.hasMatch())
     {
-      // End of remark - parse date =======================================
-      if(line.contains("</PRE>", Qt::CaseInsensitive) || PACOTS_TRACK_REGEXP.match(line).hasMatch())
+      // ____________________________________ 1  2   3  4  5          6  7   8  9  10
+      // RMK : ATM CENTER TEL:81-92-608-8870. 07 MAR 07:00 2020 UNTIL 07 MAR 21:00 2020. CREATED: 06 MAR 18:43 2020
+      QRegularExpressionMatch match = PACOTS_DATE_REGEXP.match(state.remark);
+      if(match.hasMatch())
       {
-        // ____________________________________ 1  2   3  4  5          6  7   8  9  10
-        // RMK : ATM CENTER TEL:81-92-608-8870. 07 MAR 07:00 2020 UNTIL 07 MAR 21:00 2020. CREATED: 06 MAR 18:43 2020
-        QRegularExpressionMatch match = PACOTS_DATE_REGEXP.match(remark);
-        if(match.hasMatch())
-        {
-          from =
-            QDateTime(QDate(match.captured(5).toInt(), monthFromStr(match.captured(2)), match.captured(1).toInt()),
-                      QTime(match.captured(3).toInt(), match.captured(4).toInt()), QTimeZone::UTC);
-          to =
-            QDateTime(QDate(match.captured(10).toInt(), monthFromStr(match.captured(7)), match.captured(6).toInt()),
-                      QTime(match.captured(8).toInt(), match.captured(9).toInt()), QTimeZone::UTC);
+        state.flexFrom =
+          QDateTime(QDate(match.captured(5).toInt(), monthFromStr(match.captured(2)), match.captured(1).toInt()),
+                    QTime(match.captured(3).toInt(), match.captured(4).toInt()), QTimeZone::UTC);
+        state.flexTo =
+          QDateTime(QDate(match.captured(10).toInt(), monthFromStr(match.captured(7)), match.captured(6).toInt()),
+                    QTime(match.captured(8).toInt(), match.captured(9).toInt()), QTimeZone::UTC);
 
-        }
-        inRemark = false;
       }
-      else
-        // Accumulate remark text
-        remark += " " + line;
+      state.inRemark = false;
     }
+    else
+      // Accumulate remark text
+      state.remark += " " + line;
+  }
 
-    // End of section - one track per PRE element. =======================================
-    if(line.contains("</PRE>", Qt::CaseInsensitive))
+  // End of section - one track per PRE element. =======================================
+  if(endOfPre)
+  {
+    // Add validity to all previously collected tracks
+    for(Track& t : state.flexTemp)
     {
-      // Add validity to all previously collected tracks
-      for(Track& t : temp)
-      {
-        t.validFrom = from;
-        t.validTo = to;
-      }
+      t.validFrom = state.flexFrom;
+      t.validTo = state.flexTo;
+    }
 
-      // Append list
-      tracks.append(temp);
+    // Append list
+    state.flexTracks.append(state.flexTemp);
 
-      temp.clear();
-      remark.clear();
-    }
+    state.flexTemp.clear();
+    state.remark.clear();
+  }
 
-    // Beginning of track - "TRACK 1." - more than one per PRE element =======================================
-    QRegularExpressionMatch match = PACOTS_TRACK_REGEXP.match(line);
-    if(match.hasMatch())
-    {
-      inRecord = true;
-      Track track;
-      track.name = match.captured(1);
-      track.type = PACOTS;
+  // Beginning of track - "TRACK 1." - more than one per PRE element =======================================
+  if(trackMatch.hasMatch())
+  {
+    state.inFlexRecord = true;
+    Track track;
+    track.name = trackMatch.captured(1);
+    track.type = PACOTS;
 
-      temp.append(track);
-    }
-    else if(inRecord)
+    state.flexTemp.append(track);
+  }
+  else if(state.inFlexRecord)
+  {
+    if(line.startsWith("FLEX ROUTE :"))
+      // Start of flex path =======================================
+      state.flexTemp.last().route.append(line.split(' ').mid(3));
+    else
     {
-      if(line.startsWith("FLEX ROUTE :"))
-        // Start of flex path =======================================
-        temp.last().route.append(line.split(' ').mid(3));
+      if(atools::strContains(line, INVALID_CHARS))
+        // Any invalid characters for a route terminate
+        state.inFlexRecord = false;
       else
-      {
-        if(atools::strContains(line, INVALID_CHARS))
-          // Any invalid characters for a route terminate
-          inRecord = false;
-        else
-          // Append more of the path
-          temp.last().route.append(line.split(' '));
-      }
-    }
-    else if(line.startsWith("RMK :"))
-    {
-      // Start of remark section =======================================
-      inRemark = true;
-      remark = line;
+        // Append more of the path
+        state.flexTemp.last().route.append(line.split(' '));
     }
   }
+  else if(line.startsWith("RMK :"))
+  {
+    // Start of remark section =======================================
+    state.inRemark = true;
+    state.remark = line;
+  }
 }
 
-void TrackReader::extractPacotsTracks(const QStringList& lines)
-{
-  static const QRegularExpression PACOT_NAME_REGEXP("^\\(TDM TRK (\\S+)");
-  extractTracks(lines, PACOT_NAME_REGEXP, PACOTS, false /* removeEmpty */);
-}
-
-void TrackReader::extractTracks(const QStringList& lines, const QRegularExpression& nameRegexp, TrackType type,
-                                bool removeEmpty)
+void TrackReader::parsePacotsLine(ParserState& state, const QString& line)
 {
-  // 2003070500 2003072100
-  static const QRegularExpression DATE_REGEXP("(\\d\\d)(\\d\\d)(\\d\\d)(\\d\\d)(\\d\\d) "
-                                              "(\\d\\d)(\\d\\d)(\\d\\d)(\\d\\d)(\\d\\d)");
-
   // One track for each element. Validity date in second line.
   // (TDM TRK K 200307050001
   // 2003070500 2003072100
@@ -254,84 +400,66 @@ void TrackReader::extractTracks(const QStringList& lines, const QRegularExpressi
   // ALTITUDE MAY BE RESTRICTED WHILE CROSSING ATS ROUTES
   // )
 
-  int numAfterStart = 0;
-  bool inRecord = false;
-  atools::track::TrackListType temp;
-  for(const QString& line : lines)
+  // Match and extract name =======================================
+  QRegularExpressionMatch matchName = PACOTS_NAME_REGEXP.match(line);
+  if(matchName.hasMatch())
   {
-    // Match and extract name =======================================
-    QRegularExpressionMatch matchName = nameRegexp.match(line);
-    if(matchName.hasMatch())
-    {
-      // (TDM TRK K 200307050001
-      numAfterStart = 0;
-      inRecord = true;
-      Track track;
-      track.name = matchName.captured(1);
-      track.type = type;
-
-      temp.append(track);
-    }
-    else if(inRecord)
+    // (TDM TRK K 200307050001
+    state.numAfterStart = 0;
+    state.inRecord = true;
+    Track track;
+    track.name = matchName.captured(1);
+    track.type = PACOTS;
+
+    state.temp.append(track);
+  }
+  else if(state.inRecord)
+  {
+    // Second line - extract validity =======================================
+    if(state.numAfterStart == 1)
     {
-      // Second line - extract validity =======================================
-      if(numAfterStart == 1)
+      // 2003070500 2003072100
+      QRegularExpressionMatch matchDate = PACOTS_VALID_REGEXP.match(line);
+      if(matchDate.hasMatch())
       {
-        // 2003070500 2003072100
-        QRegularExpressionMatch matchDate = DATE_REGEXP.match(line);
-        if(matchDate.hasMatch())
-        {
-          temp.last().validFrom = QDateTime(QDate(matchDate.captured(1).toInt() + 2000,
-                                                  matchDate.captured(2).toInt(),
-                                                  matchDate.captured(3).toInt()),
-                                            QTime(matchDate.captured(4).toInt(),
-                                                  matchDate.captured(5).toInt()), QTimeZone::UTC);
-
-          temp.last().validTo = QDateTime(QDate(matchDate.captured(6).toInt() + 2000,
-                                                matchDate.captured(7).toInt(),
-                                                matchDate.captured(8).toInt()),
-                                          QTime(matchDate.captured(9).toInt(),
-                                                matchDate.captured(10).toInt()), QTimeZone::UTC);
-        }
-      }
-      else if(numAfterStart >= 2)
-      {
-        // At and after third line - get route =======================================
-        // AUDIA 36N130W 36N140W 36N150W 36N160W 37N170W 38N180E 39N170E
-        // 40N160E EMRON
-        // RTS/KLAX AUDIA
-
-        if(atools::strContains(line, INVALID_CHARS))
-          // Any invalid character terminates route
-          inRecord = false;
-        else
-          // Add route elements
-          temp.last().route.append(line.split(' '));
+        state.temp.last().validFrom = QDateTime(QDate(matchDate.captured(1).toInt() + 2000,
+                                                      matchDate.captured(2).toInt(),
+                                                      matchDate.captured(3).toInt()),
+                                                QTime(matchDate.captured(4).toInt(),
+                                                      matchDate.captured(5).toInt()), QTimeZone::UTC);
+
+        state.temp.last().validTo = QDateTime(QDate(matchDate.captured(6).toInt() + 2000,
+                                                    matchDate.captured(7).toInt(),
+                                                    matchDate.captured(8).toInt()),
+                                              QTime(matchDate.captured(9).toInt(),
+                                                    matchDate.captured(10).toInt()), QTimeZone::UTC);
       }
     }
-    numAfterStart++;
+    else if(state.numAfterStart >= 2)
+    {
+      // At and after third line - get route =======================================
+      // AUDIA 36N130W 36N140W 36N150W 36N160W 37N170W 38N180E 39N170E
+      // 40N160E EMRON
+      // RTS/KLAX AUDIA
+
+      if(atools::strContains(line, INVALID_CHARS))
+        // Any invalid character terminates route
+        state.inRecord = false;
+      else
+        // Add route elements
+        state.temp.last().route.append(line.split(' '));
+    }
   }
-
-  // Remove elements without waypoints =======================================
-  if(removeEmpty)
-    temp.erase(std::remove_if(temp.begin(), temp.end(), [](const Track& t) -> bool {
-          return t.route.isEmpty();
-        }), temp.end());
-
-  tracks.append(temp);
+  state.numAfterStart++;
 }
 
-void TrackReader::extractNatTracks(const QStringList& lines)
+void TrackReader::parseNatLine(ParserState& state, const QString& line)
 {
-  // MAR 08/0100Z TO MAR 08/0800Z
-  static const QRegularExpression NAT_DATE_REGEXP("^([A-Z]+) (\\d+)/(\\d\\d)(\\d\\d)Z TO "
-                                                  "([A-Z]+) (\\d+)/(\\d\\d)(\\d\\d)Z");
-
   // More than one track for each element. Validity date at the beginning.
   // <pre>
   // <font color="#000099">
   // 061932 EGGXZOZX
-  // (NAT-1/3 TRACKS FLS 310/390 INCLUSIVE
+  // (NAT-1/3 TRACKS FLS 310/390 INCLUSIVE
   // MAR 07/1130Z TO MAR 07/1900Z</font>
   // PART ONE OF THREE PARTS-
   // A SUNOT 58/20 59/30 59/40 58/50 DORYY
@@ -346,23 +474,17 @@ void TrackReader::extractNatTracks(const QStringList& lines)
   // NAR -
   // END OF PART ONE OF THREE PARTS)
 
-  QDateTime from, to;
-  int year = QDateTime::currentDateTimeUtc().date().year();
-
-  atools::track::TrackListType temp;
-  for(const QString& line : lines)
+  // Get name and list of waypoints ============================================
+  // C ETARI 5630/20 5730/30 5730/40 5630/50 IRLOK
+  // Skip lines like
+  // 3.PBCS OTS LEVELS 350-390. PBCS TRACKS AS FOLLOWS
+  // V W X
+  // END OF PBCS OTS.
+  // Single name upper case character - check before splitting
+  if(line.size() > 2 && line.at(1) == ' ' && line.at(0).isUpper())
   {
-    // Get name and list of waypoints ============================================
-    // C ETARI 5630/20 5730/30 5730/40 5630/50 IRLOK
-    // Skip lines like
-    // 3.PBCS OTS LEVELS 350-390. PBCS TRACKS AS FOLLOWS
-    // V W X
-    // END OF PBCS OTS.
     QStringList split = line.split(' ');
-
-    if(split.size() >= 3 && // At least name and two waypoints
-       split.at(0).size() == 1 && atools::charAt(split.at(0), 0).isUpper() && // Single name upper case character
-       split.at(1).size() > 2 && split.at(2).size() > 2) // Two waypoint names
+    if(split.size() >= 3 && split.at(1).size() > 2 && split.at(2).size() > 2) // At least name and two waypoints
     {
       Track track;
       track.name = split.takeFirst();
@@ -371,63 +493,52 @@ void TrackReader::extractNatTracks(const QStringList& lines)
       track.route = toNatWaypoints(split);
 
       track.type = NAT;
-      track.validFrom = from;
-      track.validTo = to;
-      temp.append(track);
+      track.validFrom = state.natFrom;
+      track.validTo = state.natTo;
+      state.temp.append(track);
+      return;
     }
-    // Get levels ============================================
-    else if(line.startsWith("EAST LVLS"))
+  }
+
+  // Get levels ============================================
+  if(line.startsWith("EAST LVLS"))
+  {
+    // EAST LVLS NIL
+    const QStringList levels = line.split(' ').mid(2);
+    for(const QString& level : levels)
     {
-      // EAST LVLS NIL
-      const QStringList levels = line.split(' ').mid(2);
-      for(const QString& level : levels)
-      {
-        if(level != "NIL" && !temp.isEmpty())
-          temp.last().eastLevels.append(level.toUShort());
-      }
+      if(level != "NIL" && !state.temp.isEmpty())
+        state.temp.last().eastLevels.append(level.toUShort());
     }
-    else if(line.startsWith("WEST LVLS"))
+  }
+  else if(line.startsWith("WEST LVLS"))
+  {
+    // WEST LVLS 310 320 330 340 350 360 370 380 390
+    const QStringList levels = line.split(' ').mid(2);
+    for(const QString& level : levels)
     {
-      // WEST LVLS 310 320 330 340 350 360 370 380 390
-      const QStringList levels = line.split(' ').mid(2);
-      for(const QString& level : levels)
-      {
-        if(level != "NIL" && !temp.isEmpty())
-          temp.last().westLevels.append(level.toUShort());
-      }
-    }
-    // Read validity ============================================
-    else
-    {
-      // MAR 08/0100Z TO MAR 08/0800Z
-      QRegularExpressionMatch match = NAT_DATE_REGEXP.match(line);
-      if(match.hasMatch())
-      {
-        QDateTime f = QDateTime(QDate(year, monthFromStr(match.captured(1)), match.captured(2).toInt()),
-                                QTime(match.captured(3).toInt(), match.captured(4).toInt()), QTimeZone::UTC);
-        if(f.isValid())
-          from = f;
-
-        QDateTime t = QDateTime(QDate(year, monthFromStr(match.captured(5)), match.captured(6).toInt()),
-                                QTime(match.captured(7).toInt(), match.captured(8).toInt()), QTimeZone::UTC);
-        if(t.isValid())
-          to = t;
-      }
+      if(level != "NIL" && !state.temp.isEmpty())
+        state.temp.last().westLevels.append(level.toUShort());
     }
   }
-
-  // Update direction based on levels ==========================
-  for(Track& track : temp)
+  // Read validity ============================================
+  else
   {
-    if(!track.westLevels.isEmpty() && !track.eastLevels.isEmpty())
-      track.direction = BOTH;
-    else if(!track.westLevels.isEmpty())
-      track.direction = WEST;
-    else if(!track.eastLevels.isEmpty())
-      track.direction = EAST;
+    // MAR 08/0100Z TO MAR 08/0800Z
+    QRegularExpressionMatch match = NAT_DATE_REGEXP.match(line);
+    if(match.hasMatch())
+    {
+      QDateTime f = QDateTime(QDate(state.year, monthFromStr(match.captured(1)), match.captured(2).toInt()),
+                              QTime(match.captured(3).toInt(), match.captured(4).toInt()), QTimeZone::UTC);
+      if(f.isValid())
+        state.natFrom = f;
+
+      QDateTime t = QDateTime(QDate(state.year, monthFromStr(match.captured(5)), match.captured(6).toInt()),
+                              QTime(match.captured(7).toInt(), match.captured(8).toInt()), QTimeZone::UTC);
+      if(t.isValid())
+        state.natTo = t;
+    }
   }
-
-  tracks.append(temp);
 }
 
 int TrackReader::monthFromStr(const QString& str)
@@ -461,64 +572,6 @@ int TrackReader::monthFromStr(const QString& str)
     return -1;
 }
 
-QStringList TrackReader::extractSections(const QStringList& lines, const QString& begin, const QString& end)
-{
-  // Return lines between begin and end including begin and end
-  QStringList sections;
-  bool inSection = false, firstFound = false;
-
-  for(const QString& line : lines)
-  {
-    int beginIndex = line.indexOf(begin, Qt::CaseInsensitive), endIndex = line.indexOf(end, Qt::CaseInsensitive);
-
-    if(inSection)
-    {
-      if(beginIndex == -1)
-      {
-        if(endIndex >= 0)
-        {
-          sections.append(line.left(endIndex + end.size()));
-          inSection = false;
-        }
-        else
-          sections.append(line);
-      }
-      else
-        qWarning() << Q_FUNC_INFO << "Error reading track data. Found begin marker" << begin
-                   << "outside of section." << "line" << line;
-    }
-    else
-    {
-      if(endIndex == -1)
-      {
-        if(beginIndex >= 0)
-        {
-          sections.append(line.mid(beginIndex));
-          inSection = true;
-          firstFound = true;
-        }
-      }
-      else if(firstFound)
-        qWarning() << Q_FUNC_INFO << "Error reading track data. Found end marker" << end
-                   << "outside of section." << "line" << line;
-    }
-  }
-  sections.removeAll("");
-  return sections;
-}
-
-QStringList TrackReader::readLines(QTextStream& stream)
-{
-  QStringList sections;
-  while(!stream.atEnd())
-  {
-    QString line = stream.readLine().simplified();
-    if(!line.isEmpty())
-      sections.append(line);
-  }
-  return sections;
-}
-
 QStringList TrackReader::toNatWaypoints(const QStringList& str)
 {
   // "58/20" to "5820N"
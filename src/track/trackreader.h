@@ -32,6 +32,9 @@ namespace track {
  * Parses HTML pages from the various services for NAT and PACOTS and returns a list
  * of Track objects.
  *
+ * Text is parsed in a single pass line by line using a state machine for each track type.
+ * No intermediate line lists are built.
+ *
  * NAT: https://notams.aim.faa.gov/nat.html
  * PACOTS:  https://www.notams.faa.gov/dinsQueryWeb/advancedNotamMapAction.do
  */
@@ -66,12 +69,14 @@ public:
   static int removeInvalid(atools::track::TrackListType& trackVector);
 
 private:
-  /* Read all lines from stream into a list. Lines are simplified and empty ones are dropped. */
-  QStringList readLines(QTextStream& stream);
+  /* State of the single pass parser for one call of readTracks(). Defined in source file. */
+  struct ParserState;
+
+  /* Feed one simplified and not empty line into the state machine for the track type */
+  void parseLine(ParserState& state, const QString& line);
 
-  /* Extract all sections between begin and end. begin and end are included.
-   * Returns a list of lines with all text between sections cleared. */
-  QStringList extractSections(const QStringList& lines, const QString& begin, const QString& end);
+  /* Add all tracks collected in state to the list */
+  void finishParsing(ParserState& state);
 
   /* Convert month acronyms of full names into month numbers. */
   int monthFromStr(const QString& str);
@@ -79,21 +84,16 @@ private:
   /* Convert e.g. "58/20" to "5820N" and "5530/20" to "H5530". */
   QStringList toNatWaypoints(const QStringList& str);
 
-  /* Extract all tracks into the track vector that begin with nameRegexp and end with a ")".
-   * nameRegexp needs to have a group returning the name. */
-  void extractTracks(const QStringList& lines, const QRegularExpression& nameRegexp, TrackType type, bool removeEmpty);
+  /* Parse a line of a NAT message section. */
+  void parseNatLine(ParserState& state, const QString& line);
 
-  /* Extract NAT tracks into the track vector. */
-  void extractNatTracks(const QStringList& lines);
+  /* Parse a line of a PACOTS "(TDM TRK" section. */
+  void parsePacotsLine(ParserState& state, const QString& line);
 
-  /* Extract PACOTS tracks into the track vector. */
-  void extractPacotsTracks(const QStringList& lines);
-
-  /* Extract the PACOTS flex tracks into the track vector. */
-  void extractPacotsTracksFlex(const QStringList& text);
+  /* Parse a line of a PACOTS PRE element containing flex tracks. */
+  void parsePacotsFlexLine(ParserState& state, const QString& line);
 
   atools::track::TrackListType tracks;
-
 };
 
 } // namespace track
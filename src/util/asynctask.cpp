@@ -0,0 +1,103 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "util/asynctask.h"
+
+#include <QDeadlineTimer>
+
+#include <algorithm>
+
+namespace atools {
+namespace util {
+
+struct CancelToken::State
+{
+  std::atomic_bool canceled = false;
+
+  /* Deadline in milliseconds of the steady clock used by QDeadlineTimer or -1 if none */
+  std::atomic<qint64> deadlineMs = -1;
+
+  /* Set once on creation and not changed afterwards */
+  std::shared_ptr<const State> parent;
+  std::function<bool()> canceledFunc;
+
+  bool isCanceled() const
+  {
+    if(canceled.load(std::memory_order_relaxed))
+      return true;
+
+    qint64 deadline = deadlineMs.load(std::memory_order_relaxed);
+    if(deadline != -1 && QDeadlineTimer::current().deadline() >= deadline)
+      return true;
+
+    if(canceledFunc && canceledFunc())
+      return true;
+
+    return parent != nullptr && parent->isCanceled();
+  }
+
+};
+
+CancelToken::CancelToken()
+  : state(std::make_shared<State>())
+{
+}
+
+void CancelToken::cancel()
+{
+  state->canceled.store(true);
+}
+
+bool CancelToken::isCanceled() const
+{
+  return state->isCanceled();
+}
+
+void CancelToken::setTimeoutMs(qint64 timeoutMs)
+{
+  state->deadlineMs.store(timeoutMs < 0 ? -1 : QDeadlineTimer(timeoutMs).deadline());
+}
+
+qint64 CancelToken::getRemainingMs() const
+{
+  qint64 deadline = state->deadlineMs.load();
+  if(deadline == -1)
+    return -1;
+
+  return std::max(deadline - QDeadlineTimer::current().deadline(), static_cast<qint64>(0));
+}
+
+CancelToken CancelToken::linked(const std::function<bool()>& canceledFunc) const
+{
+  CancelToken token;
+  token.state->parent = state;
+  token.state->canceledFunc = canceledFunc;
+  return token;
+}
+
+namespace async {
+
+Q_GLOBAL_STATIC(QThreadPool, asyncThreadPool)
+
+QThreadPool *threadPool()
+{
+  return asyncThreadPool();
+}
+
+} // namespace async
+} // namespace util
+} // namespace atools
@@ -0,0 +1,138 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_UTIL_ASYNCTASK_H
+#define ATOOLS_UTIL_ASYNCTASK_H
+
+#include <QDebug>
+#include <QFuture>
+#include <QPromise>
+#include <QThreadPool>
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+
+namespace atools {
+namespace util {
+
+class CancelToken;
+
+namespace async {
+template<typename RESULT, typename FUNC>
+QFuture<RESULT> run(FUNC func, const atools::util::CancelToken& token);
+}
+
+/*
+ * Cancellation flag which is checked by long running operations in their inner loops.
+ *
+ * Copies share the same state. cancel() on any copy cancels all of them. A timeout sets a deadline after which
+ * the token counts as canceled. Tokens passed into tasks by async::run() are also canceled when the returned
+ * future is canceled.
+ *
+ * All methods are thread safe. A default constructed token is never canceled unless cancel() is called.
+ */
+class CancelToken
+{
+public:
+  CancelToken();
+
+  /* Request cancellation. Cannot be undone. */
+  void cancel();
+
+  /* true if cancel() was called, the deadline passed or the linked future was canceled */
+  bool isCanceled() const;
+
+  /* Cancel automatically after the given time from now. -1 removes the deadline. */
+  void setTimeoutMs(qint64 timeoutMs);
+
+  /* Milliseconds until the deadline, 0 if passed or -1 if none */
+  qint64 getRemainingMs() const;
+
+private:
+  template<typename RESULT, typename FUNC>
+  friend QFuture<RESULT> async::run(FUNC func, const atools::util::CancelToken& token);
+
+  struct State;
+
+  /* Token which is also canceled if this one is canceled or canceledFunc returns true */
+  CancelToken linked(const std::function<bool()>& canceledFunc) const;
+
+  std::shared_ptr<State> state;
+};
+
+namespace async {
+
+/* Thread pool shared by all asynchronous library tasks. Uses all cores by default. */
+QThreadPool *threadPool();
+
+/*
+ * Run func(QPromise<RESULT>& promise, const CancelToken& token) on the shared thread pool.
+ *
+ * The function should check token.isCanceled() in its inner loops and return early if set.
+ * Partial results can be reported with promise.addResult() and are available from the future while the
+ * task is running. Progress can be reported with promise.setProgressValue().
+ *
+ * Cancelling the returned future or the token stops the task at the next check. The future is marked as
+ * canceled if the token was canceled when the function returned. Exceptions are passed to the future and
+ * thrown again on access to the results.
+ */
+template<typename RESULT, typename FUNC>
+QFuture<RESULT> run(FUNC func, const atools::util::CancelToken& token = atools::util::CancelToken())
+{
+  std::shared_ptr<QPromise<RESULT> > promise = std::make_shared<QPromise<RESULT> >();
+  QFuture<RESULT> future = promise->future();
+
+  // Task token is canceled by the caller token or the future
+  CancelToken taskToken = token.linked([promise]() -> bool {
+    return promise->isCanceled();
+  });
+
+  promise->start();
+  threadPool()->start([promise, taskToken, func]() mutable -> void {
+    if(!taskToken.isCanceled())
+    {
+      try
+      {
+        func(*promise, taskToken);
+      }
+      catch(std::exception& e)
+      {
+        qWarning() << Q_FUNC_INFO << "Caught exception" << e.what();
+        promise->setException(std::current_exception());
+      }
+      catch(...)
+      {
+        qWarning() << Q_FUNC_INFO << "Caught unknown exception";
+        promise->setException(std::current_exception());
+      }
+    }
+
+    if(taskToken.isCanceled())
+      promise->future().cancel();
+    promise->finish();
+  });
+
+  return future;
+}
+
+} // namespace async
+} // namespace util
+} // namespace atools
+
+#endif // ATOOLS_UTIL_ASYNCTASK_H
@@ -17,6 +17,8 @@
 
 #include "util/csvreader.h"
 
+#include <QStringDecoder>
+
 namespace atools {
 namespace util {
 
@@ -95,6 +97,128 @@ void CsvReader::readCsvLine(const QString& line)
   }
 }
 
+bool CsvReader::readCsvRecord(const QByteArray& data, qsizetype& offset)
+{
+  const char *pos = data.constData() + offset, *end = data.constData() + data.size();
+
+  if(offset == 0)
+  {
+    lineNumber = 0;
+
+    // Skip UTF-8 BOM
+    if(data.startsWith("\xEF\xBB\xBF"))
+      pos += 3;
+  }
+
+  reset();
+  record = QByteArrayView();
+
+  // Skip empty lines
+  while(pos < end && (*pos == '\n' || *pos == '\r'))
+  {
+    if(*pos == '\n' || (*pos == '\r' && (pos + 1 >= end || pos[1] != '\n')))
+      lineNumber++;
+    pos++;
+  }
+
+  if(pos >= end)
+  {
+    offset = data.size();
+    return false;
+  }
+
+  const char separatorByte = separator.toLatin1(), escapeByte = escape.toLatin1();
+  const char *recordStart = pos;
+  recordLineNumber = ++lineNumber;
+  char lastByte = '\0';
+  curBytes.clear();
+
+  // Same state machine as in readCsvLine() but on bytes ================================
+  while(pos < end)
+  {
+    char c = *pos;
+
+    if(c == escapeByte)
+    {
+      curValueEscaped = true;
+      if(inEscape)
+        inEscape = false;
+      else
+      {
+        if(lastByte == escapeByte)
+          // Escape char itself doubled
+          curBytes.append(c);
+        inEscape = true;
+      }
+      lastByte = c;
+      pos++;
+      continue;
+    }
+
+    if(!inEscape)
+    {
+      if(c == separatorByte)
+      {
+        QString value = QString::fromUtf8(curBytes);
+        values.append((trim && !curValueEscaped) ? value.trimmed() : value);
+        curBytes.clear();
+        curValueEscaped = false;
+        lastByte = c;
+        pos++;
+        continue;
+      }
+
+      if(c == '\n' || c == '\r')
+        // End of record
+        break;
+    }
+    else if(c == '\r' || c == '\n')
+    {
+      // Linefeed in escaped text - store as single "\n" like readCsvLine()
+      if(c == '\r' && pos + 1 < end && pos[1] == '\n')
+        pos++;
+      lineNumber++;
+      curBytes.append('\n');
+      pos++;
+      continue;
+    }
+
+    // Regular character
+    curBytes.append(c);
+    lastByte = c;
+    pos++;
+  }
+
+  record = QByteArrayView(recordStart, pos - recordStart);
+
+  // Finish record - also if unterminated escape at end of data
+  QString value = QString::fromUtf8(curBytes);
+  values.append((trim && !curValueEscaped) ? value.trimmed() : value);
+  curBytes.clear();
+  curValueEscaped = false;
+
+  // Skip line end
+  if(pos < end && *pos == '\r')
+    pos++;
+  if(pos < end && *pos == '\n')
+    pos++;
+
+  offset = pos - data.constData();
+  return true;
+}
+
+QByteArray CsvReader::toUtf8(const QByteArray& data)
+{
+  std::optional<QStringConverter::Encoding> encoding = QStringConverter::encodingForData(data);
+  if(encoding.has_value() && encoding.value() != QStringConverter::Utf8)
+  {
+    // Decoder removes BOM
+    QStringDecoder decoder(encoding.value());
+    return QString(decoder.decode(data)).toUtf8();
+  }
+  return data;
+}
+
 void CsvReader::reset()
 {
   values.clear();
@@ -18,6 +18,7 @@
 #ifndef ATOOLS_UTIL_CSVREADER_H
 #define ATOOLS_UTIL_CSVREADER_H
 
+#include <QByteArrayView>
 #include <QStringList>
 
 namespace atools {
@@ -38,6 +39,29 @@ public:
    * Example: value1,"value2 with , separator",value3,"value4 with "" escaped",value4*/
   void readCsvLine(const QString& line);
 
+  /* Read the next complete record from UTF-8 encoded bytes starting at offset which is moved behind the record.
+   * Escaped fields can span lines. Empty lines and a leading BOM are skipped. Records end with "\n" or "\r\n".
+   * This avoids decoding whole lines into strings first and is faster for large files than readCsvLine().
+   * Separator and escape have to be ASCII characters.
+   * Call with offset 0 first and do not mix with readCsvLine().
+   * @return false if the end of data was reached and no record was read. */
+  bool readCsvRecord(const QByteArray& data, qsizetype& offset);
+
+  /* Convert file content to UTF-8 for readCsvRecord() if a UTF-16 or UTF-32 BOM is found. Otherwise returns data. */
+  static QByteArray toUtf8(const QByteArray& data);
+
+  /* Line number of the first line of last record read by readCsvRecord(). Starts with 1. */
+  int getRecordLineNumber() const
+  {
+    return recordLineNumber;
+  }
+
+  /* Raw text of the last record read by readCsvRecord() for error messages */
+  QString getRecordText() const
+  {
+    return QString::fromUtf8(record);
+  }
+
   /* Get values after calling readCsvLine once or more */
   const QStringList& getValues() const
   {
@@ -67,6 +91,11 @@ private:
 
   QChar lastChar = '\0', curChar = '\0';
 
+  /* State for readCsvRecord() */
+  QByteArray curBytes;
+  QByteArrayView record;
+  int lineNumber = 0, recordLineNumber = 0;
+
   /* Configuration */
   QChar separator = ',', escape = '"';
   bool trim = true;
@@ -18,7 +18,9 @@
 #include "util/filesystemwatcher.h"
 
 #include "atools.h"
+#include "util/nativefilewatcher.h"
 
+#include <QDir>
 #include <QFileInfo>
 #include <QFileSystemWatcher>
 
@@ -56,7 +58,7 @@ void FileSystemWatcher::stopWatching()
 
 void FileSystemWatcher::pathChanged()
 {
-  if(verbose)
+  if(verbose && fsWatcher != nullptr)
   {
     qDebug() << Q_FUNC_INFO << "directories" << fsWatcher->directories();
     qDebug() << Q_FUNC_INFO << "files" << fsWatcher->files();
@@ -67,72 +69,114 @@ void FileSystemWatcher::pathChanged()
   delayTimer.stop();
 
   for(int i = 0; i < paths.size(); i++)
+    checkPath(i);
+
+  startTimers();
+
+  setPathsToFsWatcher(true);
+}
+
+void FileSystemWatcher::nativePathsChanged(const QStringList& changedPaths)
+{
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << changedPaths;
+
+  // Check only watched paths from the batch and ignore other files in the same directory
+  bool found = false;
+  for(int i = 0; i < paths.size(); i++)
+  {
+    if(changedPaths.contains(QDir::cleanPath(paths.at(i).path)))
+    {
+      checkPath(i);
+      found = true;
+    }
+  }
+
+  if(found)
   {
-    const PathInfo& info = paths.at(i);
+    // Extend delay if already running
+    delayTimer.stop();
+    startTimers();
+  }
 
+  // Directory might have been removed and created again - watch again if needed
+  for(const PathInfo& info : std::as_const(paths))
+  {
     QFileInfo fileinfo(info.path);
-    if(fileinfo.exists())
+    if(fileinfo.isDir() && !nativeWatcher->getDirectories().contains(QDir::cleanPath(info.path)))
+      nativeWatcher->addDirectory(info.path);
+  }
+}
+
+void FileSystemWatcher::checkPath(int index)
+{
+  const PathInfo& info = paths.at(index);
+
+  QFileInfo fileinfo(info.path);
+  if(fileinfo.exists())
+  {
+    if(verbose)
+      qDebug() << Q_FUNC_INFO << "Path" << info.path
+               << "file" << fileinfo.isFile()
+               << "exists" << fileinfo.exists()
+               << "size" << fileinfo.size()
+               << "last modified" << fileinfo.lastModified().toString(Qt::ISODateWithMs);
+
+    if(fileinfo.isFile())
     {
-      if(verbose)
-        qDebug() << Q_FUNC_INFO << "Path" << info.path
-                 << "file" << fileinfo.isFile()
-                 << "exists" << fileinfo.exists()
-                 << "size" << fileinfo.size()
-                 << "last modified" << fileinfo.lastModified().toString(Qt::ISODateWithMs);
-
-      if(fileinfo.isFile())
-      {
-        if(fileinfo.size() > minFileSize)
-        {
-          // File exists - first call or older than one second or file differs
-          if(!info.timestampLastRead.isValid() || std::abs(fileinfo.lastModified().msecsTo(info.timestampLastRead)) > 1000L ||
-             info.sizeLastRead != fileinfo.size())
-          {
-            // Timestamp of file has changed
-            if(verbose)
-              qDebug() << Q_FUNC_INFO << "=== File changed" << info.path;
-
-            // Start or extend the delayed notification
-            changedPathIndexes.insert(i);
-          }
-          else
-          {
-            if(verbose)
-              qDebug() << Q_FUNC_INFO << "File not changed" << info.path;
-          }
-        } // if(fileinfo.size() > minFileSize)
-        else
-        {
-          // File is being updated - keep current file
-          if(warn())
-            qWarning() << Q_FUNC_INFO << "File" << info.path << "smaller than" << minFileSize << "bytes";
-        }
-      } // if(fileinfo.isFile())
-      else if(fileinfo.isDir())
+      if(fileinfo.size() > minFileSize)
       {
-        // Notification on dir change - keep current file
-        if(!info.timestampLastRead.isValid() || std::abs(fileinfo.lastModified().msecsTo(info.timestampLastRead)) > 1000L)
+        // File exists - first call or older than one second or file differs
+        if(!info.timestampLastRead.isValid() || std::abs(fileinfo.lastModified().msecsTo(info.timestampLastRead)) > 1000L ||
+           info.sizeLastRead != fileinfo.size())
         {
+          // Timestamp of file has changed
           if(verbose)
-            qDebug() << Q_FUNC_INFO << "=== Dir changed" << info.path;
+            qDebug() << Q_FUNC_INFO << "=== File changed" << info.path;
+
           // Start or extend the delayed notification
-          changedPathIndexes.insert(i);
+          changedPathIndexes.insert(index);
         }
         else
         {
           if(verbose)
-            qDebug() << Q_FUNC_INFO << "Dir not changed" << info.path;
+            qDebug() << Q_FUNC_INFO << "File not changed" << info.path;
         }
+      } // if(fileinfo.size() > minFileSize)
+      else
+      {
+        // File is being updated - keep current file
+        if(warn())
+          qWarning() << Q_FUNC_INFO << "File" << info.path << "smaller than" << minFileSize << "bytes";
       }
-    } // if(fileinfo.exists())
-    else
+    } // if(fileinfo.isFile())
+    else if(fileinfo.isDir())
     {
-      // File was deleted - keep current file and do not send a notification
-      if(warn())
-        qWarning() << Q_FUNC_INFO << "File" << info.path << "does not exist";
+      // Notification on dir change - keep current file
+      if(!info.timestampLastRead.isValid() || std::abs(fileinfo.lastModified().msecsTo(info.timestampLastRead)) > 1000L)
+      {
+        if(verbose)
+          qDebug() << Q_FUNC_INFO << "=== Dir changed" << info.path;
+        // Start or extend the delayed notification
+        changedPathIndexes.insert(index);
+      }
+      else
+      {
+        if(verbose)
+          qDebug() << Q_FUNC_INFO << "Dir not changed" << info.path;
+      }
     }
-  } // for(int i = 0; i < paths.size(); i++)
+  } // if(fileinfo.exists())
+  else
+  {
+    // File was deleted - keep current file and do not send a notification
+    if(warn())
+      qWarning() << Q_FUNC_INFO << "File" << info.path << "does not exist";
+  }
+}
 
+void FileSystemWatcher::startTimers()
+{
   if(!changedPathIndexes.isEmpty())
   {
     if(verbose)
@@ -141,16 +185,14 @@ void FileSystemWatcher::pathChanged()
     // Start or extend the delayed notification to pathUpdatedDelayed()
     delayTimer.start(delayMs);
   }
-  else
+  else if(nativeWatcher == nullptr)
   {
     if(verbose)
       qDebug() << Q_FUNC_INFO << "No update - starting timer";
 
-    // Start timer to check periodically pathChanged()
+    // Start timer to check periodically pathChanged() - not needed for reliable native notifications
     periodicCheckTimer.start(checkMs);
   }
-
-  setPathsToFsWatcher(true);
 }
 
 void FileSystemWatcher::pathUpdatedDelayed()
@@ -212,7 +254,8 @@ void FileSystemWatcher::pathUpdatedDelayed()
   }
 
   // pathChanged()
-  periodicCheckTimer.start(checkMs);
+  if(nativeWatcher == nullptr)
+    periodicCheckTimer.start(checkMs);
 }
 
 void FileSystemWatcher::setFilenameAndStart(const QString& path)
@@ -265,6 +308,42 @@ void FileSystemWatcher::deleteFsWatcher()
     fsWatcher->deleteLater();
     fsWatcher = nullptr;
   }
+
+  if(nativeWatcher != nullptr)
+  {
+    NativeFileWatcher::disconnect(nativeWatcher, &NativeFileWatcher::pathsChanged, this, &FileSystemWatcher::nativePathsChanged);
+    nativeWatcher->deleteLater();
+    nativeWatcher = nullptr;
+  }
+}
+
+bool FileSystemWatcher::createNativeWatcher()
+{
+  nativeWatcher = new NativeFileWatcher(this);
+  bool ok = nativeWatcher->isValid();
+
+  // Watch parent directory of all files which also catches replaced files
+  for(const PathInfo& info : std::as_const(paths))
+  {
+    QFileInfo fileinfo(info.path);
+    QString dir = fileinfo.isDir() ? fileinfo.filePath() : fileinfo.path();
+    if(ok && !info.path.isEmpty())
+      ok = nativeWatcher->addDirectory(dir);
+  }
+
+  if(ok)
+    NativeFileWatcher::connect(nativeWatcher, &NativeFileWatcher::pathsChanged, this, &FileSystemWatcher::nativePathsChanged);
+  else
+  {
+    qWarning() << Q_FUNC_INFO << "Native watcher not available - using polling";
+    delete nativeWatcher;
+    nativeWatcher = nullptr;
+  }
+
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << "native" << ok;
+
+  return ok;
 }
 
 void FileSystemWatcher::createFsWatcher()
@@ -272,15 +351,21 @@ void FileSystemWatcher::createFsWatcher()
   if(verbose)
     qDebug() << Q_FUNC_INFO << paths;
 
-  if(fsWatcher == nullptr)
+  if(useNative && nativeWatcher == nullptr && fsWatcher == nullptr)
+    createNativeWatcher();
+
+  if(nativeWatcher == nullptr)
   {
-    // Watch file for changes and directory too to catch file deletions
-    fsWatcher = new QFileSystemWatcher(this);
-    QFileSystemWatcher::connect(fsWatcher, &QFileSystemWatcher::fileChanged, this, &FileSystemWatcher::pathChanged);
-    QFileSystemWatcher::connect(fsWatcher, &QFileSystemWatcher::directoryChanged, this, &FileSystemWatcher::pathChanged);
-  }
+    if(fsWatcher == nullptr)
+    {
+      // Watch file for changes and directory too to catch file deletions
+      fsWatcher = new QFileSystemWatcher(this);
+      QFileSystemWatcher::connect(fsWatcher, &QFileSystemWatcher::fileChanged, this, &FileSystemWatcher::pathChanged);
+      QFileSystemWatcher::connect(fsWatcher, &QFileSystemWatcher::directoryChanged, this, &FileSystemWatcher::pathChanged);
+    }
 
-  setPathsToFsWatcher(false);
+    setPathsToFsWatcher(false);
+  }
 
   // Initialize size and timestamp which will omit the first update signal - user has to do the initial load
   for(PathInfo& info : paths)
@@ -293,19 +378,22 @@ void FileSystemWatcher::createFsWatcher()
     }
   }
 
-  // Check every ten seconds since the watcher is unreliable
-  QTimer::connect(&periodicCheckTimer, &QTimer::timeout, this, &FileSystemWatcher::pathChanged);
-  periodicCheckTimer.start(checkMs);
+  // Check every ten seconds since the watcher is unreliable - native notifications do not need polling
+  if(nativeWatcher == nullptr)
+  {
+    QTimer::connect(&periodicCheckTimer, &QTimer::timeout, this, &FileSystemWatcher::pathChanged);
+    periodicCheckTimer.start(checkMs);
+  }
 }
 
 void FileSystemWatcher::setPathsToFsWatcher(bool update)
 {
-  if(verbose)
-    qDebug() << Q_FUNC_INFO << paths << "files" << fsWatcher->files() << "dirs" << fsWatcher->directories();
-
   if(fsWatcher == nullptr)
     return;
 
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << paths << "files" << fsWatcher->files() << "dirs" << fsWatcher->directories();
+
   QStringList files = fsWatcher->files();
   QStringList directories = fsWatcher->directories();
   for(const PathInfo& info : std::as_const(paths))
@@ -28,11 +28,17 @@ class QFileSystemWatcher;
 namespace atools {
 namespace util {
 
+class NativeFileWatcher;
+
 /*
  * A better file system watch class which works around for files which are removed, deleted and renamed in
  * the process by checking size and timestamp.
  *
  * Notifications are sent with a delay to catch intermediate changes.
+ *
+ * Uses NativeFileWatcher on Linux and Windows which watches the parent directory and reports batches of changed
+ * paths. Only reported paths are checked and periodic polling is disabled in this case.
+ * Falls back to QFileSystemWatcher with periodic checks on other systems or if the native watcher fails.
  */
 class FileSystemWatcher
   : public QObject
@@ -78,6 +84,18 @@ public:
     delayMs = value;
   }
 
+  /* Use native operating system notifications if available. Default is true. Has to be set before starting. */
+  void setUseNativeWatcher(bool value)
+  {
+    useNative = value;
+  }
+
+  /* true if the native watcher is active */
+  bool isNativeWatcherActive() const
+  {
+    return nativeWatcher != nullptr;
+  }
+
 signals:
   /* Emitted once files are updated */
   void filesUpdated(const QStringList& filenames);
@@ -92,6 +110,18 @@ private:
   /* Called on directory or file change and periodicCheckTimer event */
   void pathChanged();
 
+  /* Called by native watcher with a batch of changed paths. Checks only affected paths. */
+  void nativePathsChanged(const QStringList& changedPaths);
+
+  /* Check size and timestamp of path at index and add to changedPathIndexes if changed */
+  void checkPath(int index);
+
+  /* Start delay timer if paths were changed or periodic check timer otherwise */
+  void startTimers();
+
+  /* Create native watcher for the parent directory. Returns false if not possible. */
+  bool createNativeWatcher();
+
   /* Called by delayTimer event */
   void pathUpdatedDelayed();
 
@@ -126,6 +156,10 @@ private:
   /* Calls pathChanged() on folder and file changes */
   QFileSystemWatcher *fsWatcher = nullptr;
 
+  /* Calls nativePathsChanged() and replaces fsWatcher if not null */
+  NativeFileWatcher *nativeWatcher = nullptr;
+  bool useNative = true;
+
   QTimer periodicCheckTimer, // Calls pathChanged()
          delayTimer; // pathUpdatedDelayed()
 
@@ -0,0 +1,154 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+
+#ifndef ATOOLS_UTIL_FLATHASH_H
+#define ATOOLS_UTIL_FLATHASH_H
+
+#include <QHash>
+#include <QList>
+
+namespace atools {
+namespace util {
+
+/*
+ * Read only hash map using open addressing with linear probing in one flat array.
+ * Built once from a QHash and intended for many lookups of small fixed size keys like atools::util::Str.
+ *
+ * Lookups do not modify the object and are safe to call concurrently from several threads.
+ */
+template<typename KEY, typename VALUE>
+class FlatHash
+{
+public:
+  /* Build from hash. Previous content is removed. */
+  void build(const QHash<KEY, VALUE>& hash);
+
+  void clear()
+  {
+    entries.clear();
+    mask = 0;
+    numEntries = 0;
+  }
+
+  /* Pointer to value or null if not found */
+  const VALUE *find(const KEY& key) const;
+
+  VALUE value(const KEY& key, const VALUE& defaultValue) const
+  {
+    const VALUE *val = find(key);
+    return val != nullptr ? *val : defaultValue;
+  }
+
+  bool contains(const KEY& key) const
+  {
+    return find(key) != nullptr;
+  }
+
+  qsizetype size() const
+  {
+    return numEntries;
+  }
+
+  bool isEmpty() const
+  {
+    return numEntries == 0;
+  }
+
+  /* Bytes used by the flat array */
+  qint64 getMemorySize() const
+  {
+    return static_cast<qint64>(entries.capacity()) * static_cast<qint64>(sizeof(Entry));
+  }
+
+private:
+  struct Entry
+  {
+    size_t hash = 0;
+    KEY key;
+    VALUE value;
+    bool used = false;
+  };
+
+  static size_t hashKey(const KEY& key)
+  {
+    // Use global functions like for std::pair and the ones found by ADL
+    using ::qHash;
+    return qHash(key, size_t(0));
+  }
+
+  QList<Entry> entries;
+  size_t mask = 0;
+  qsizetype numEntries = 0;
+};
+
+template<typename KEY, typename VALUE>
+void FlatHash<KEY, VALUE>::build(const QHash<KEY, VALUE>& hash)
+{
+  clear();
+
+  if(hash.isEmpty())
+    return;
+
+  // Power of two capacity giving a load factor of less than 0.5
+  qsizetype capacity = 16;
+  while(capacity < hash.size() * 2)
+    capacity *= 2;
+
+  entries.resize(capacity);
+  mask = static_cast<size_t>(capacity - 1);
+
+  Entry *data = entries.data();
+  for(auto it = hash.constBegin(); it != hash.constEnd(); ++it)
+  {
+    size_t hashVal = hashKey(it.key());
+    size_t index = hashVal & mask;
+    while(data[index].used)
+      index = (index + 1) & mask;
+
+    Entry& entry = data[index];
+    entry.hash = hashVal;
+    entry.key = it.key();
+    entry.value = it.value();
+    entry.used = true;
+  }
+  numEntries = hash.size();
+}
+
+template<typename KEY, typename VALUE>
+const VALUE *FlatHash<KEY, VALUE>::find(const KEY& key) const
+{
+  if(numEntries == 0)
+    return nullptr;
+
+  size_t hashVal = hashKey(key);
+  const Entry *data = entries.constData();
+  for(size_t index = hashVal & mask;; index = (index + 1) & mask)
+  {
+    const Entry& entry = data[index];
+    if(!entry.used)
+      return nullptr;
+
+    if(entry.hash == hashVal && entry.key == key)
+      return &entry.value;
+  }
+}
+
+} // namespace util
+} // namespace atools
+
+#endif // ATOOLS_UTIL_FLATHASH_H
@@ -94,15 +94,30 @@ HtmlBuilder& HtmlBuilder::operator=(const atools::util::HtmlBuilder& other)
 
 QString HtmlBuilder::joinBr(std::initializer_list<HtmlBuilder> builders)
 {
-  QStringList texts;
+  // Append directly into a pre-sized string without intermediate list - trim and skip empty texts like strJoin()
+  qsizetype size = 0;
   for(const HtmlBuilder& builder : builders)
-    texts.append(builder.getHtml());
-  return joinBr(texts);
+    size += builder.getHtml().size() + 5;
+
+  QString text;
+  text.reserve(size);
+  for(const HtmlBuilder& builder : builders)
+  {
+    QString str = builder.getHtml().trimmed();
+    if(str.isEmpty())
+      continue;
+
+    if(!text.isEmpty())
+      text.append(QStringLiteral("<br/>"));
+    text.append(str);
+  }
+  return text;
 }
 
 QString HtmlBuilder::joinP(std::initializer_list<HtmlBuilder> builders)
 {
   QStringList texts;
+  texts.reserve(static_cast<qsizetype>(builders.size()));
   for(const HtmlBuilder& builder : builders)
     texts.append(builder.getHtml());
   return joinP(texts);
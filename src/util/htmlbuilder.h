@@ -52,12 +52,29 @@ public:
 
   HtmlBuilder(const atools::util::HtmlBuilder& other);
 
+  /* Move to avoid copying settings and the text, e.g. when returning builders from functions */
+  HtmlBuilder(atools::util::HtmlBuilder&& other) = default;
+
   const QString& getHtml() const
   {
     return htmlText;
   }
 
+  /* HTML text converted to UTF-8 as needed for the web server response body */
+  QByteArray getHtmlUtf8() const
+  {
+    return htmlText.toUtf8();
+  }
+
   HtmlBuilder& operator=(const atools::util::HtmlBuilder& other);
+  HtmlBuilder& operator=(atools::util::HtmlBuilder&& other) = default;
+
+  /* Reserve space for size characters to avoid reallocations when building large tables or reports */
+  HtmlBuilder& reserve(qsizetype size)
+  {
+    htmlText.reserve(size);
+    return *this;
+  }
 
   /* Joins the list of builders using <br> or <p> */
   static QString joinBr(std::initializer_list<atools::util::HtmlBuilder> builders);
@@ -20,9 +20,12 @@
 
 #include <QCoreApplication>
 #include <QFileInfo>
+#include <QNetworkDiskCache>
 #include <QNetworkReply>
 #include <QUrlQuery>
 
+#include <algorithm>
+
 namespace atools {
 namespace util {
 
@@ -103,22 +106,14 @@ void HttpDownloader::startDownload()
       {
         cancelDownload();
 
-        QNetworkRequest request(downloadUrl);
-
-        if(!userAgent.isEmpty())
-          request.setHeader(QNetworkRequest::UserAgentHeader, userAgent);
-
-        // curl -H "Accept-Encoding: gzip" https://data.vatsim.net/v3/vatsim-data.json --output vatsim-data.json.gz
-        if(!acceptEncoding.isEmpty())
-          request.setRawHeader(QByteArray("Accept-Encoding"), acceptEncoding.toUtf8());
-
-        // Add arbitrary headers ===================
-        for(auto it = headerParameters.begin(); it != headerParameters.end(); ++it)
-          request.setRawHeader(it.key().toUtf8(), it.value().toUtf8());
+        // Key for validators and hash used to detect unchanged content ===================
+        contentKey = QUrl(downloadUrl).toString();
+        contentHash.reset();
 
+        QNetworkRequest request = createRequest(true /* addValidators */);
         if(!postParameters.isEmpty())
           // Post raw data ============================
-          reply = networkManager.post(request, postParameters);
+          reply = manager().post(request, postParameters);
         else if(!postParametersQuery.isEmpty())
         {
           // Post form data ============================
@@ -128,21 +123,19 @@ void HttpDownloader::startDownload()
           for(auto it = postParametersQuery.begin(); it != postParametersQuery.end(); ++it)
             params.addQueryItem(it.key(), it.value());
 
-          reply = networkManager.post(request, params.query().toUtf8());
+          reply = manager().post(request, params.query().toUtf8());
         }
-        else
-          // Get request ============================
-          reply = networkManager.get(request);
-
-        if(reply != nullptr)
+        else if(rangeConnections > 1 && !streamData && !isDiskCached())
         {
-          connect(reply, &QNetworkReply::finished, this, &HttpDownloader::httpFinished);
-          connect(reply, &QNetworkReply::readyRead, this, &HttpDownloader::readyRead);
-          connect(reply, &QNetworkReply::downloadProgress, this, &HttpDownloader::downloadProgressInternal);
-          connect(reply, &QNetworkReply::sslErrors, this, &HttpDownloader::sslErrors);
+          // Head request to get size and range support ============================
+          rangeProbe = true;
+          reply = manager().head(request);
         }
         else
-          qWarning() << Q_FUNC_INFO << "Reply is null" << downloadUrl;
+          // Get request ============================
+          reply = manager().get(request);
+
+        connectReply();
       }
       else
         // is already downloading and waiting for finished required (restartRequest = false)
@@ -151,6 +144,257 @@ void HttpDownloader::startDownload()
   }
 }
 
+QNetworkRequest HttpDownloader::createRequest(bool addValidators)
+{
+  QNetworkRequest request(downloadUrl);
+
+  if(timeoutMs > 0)
+    request.setTransferTimeout(timeoutMs);
+
+  if(!userAgent.isEmpty())
+    request.setHeader(QNetworkRequest::UserAgentHeader, userAgent);
+
+  // curl -H "Accept-Encoding: gzip" https://data.vatsim.net/v3/vatsim-data.json --output vatsim-data.json.gz
+  if(!acceptEncoding.isEmpty())
+    request.setRawHeader(QByteArray("Accept-Encoding"), acceptEncoding.toUtf8());
+
+  // Add arbitrary headers ===================
+  for(auto it = headerParameters.begin(); it != headerParameters.end(); ++it)
+    request.setRawHeader(it.key().toUtf8(), it.value().toUtf8());
+
+  if(detectUnchanged && addValidators)
+  {
+    auto it = contentStates.constFind(contentKey);
+    if(it != contentStates.constEnd())
+    {
+      if(!it->etag.isEmpty())
+        request.setRawHeader(QByteArray("If-None-Match"), it->etag);
+      if(!it->lastModified.isEmpty())
+        request.setRawHeader(QByteArray("If-Modified-Since"), it->lastModified);
+    }
+  }
+  return request;
+}
+
+QNetworkAccessManager& HttpDownloader::manager()
+{
+  return sharedNetworkManager != nullptr ? *sharedNetworkManager : networkManager;
+}
+
+void HttpDownloader::connectReply()
+{
+  if(reply != nullptr)
+  {
+    connect(reply, &QNetworkReply::finished, this, &HttpDownloader::httpFinished);
+    connect(reply, &QNetworkReply::readyRead, this, &HttpDownloader::readyRead);
+    connect(reply, &QNetworkReply::downloadProgress, this, &HttpDownloader::downloadProgressInternal);
+    connect(reply, &QNetworkReply::sslErrors, this, &HttpDownloader::sslErrors);
+  }
+  else
+    qWarning() << Q_FUNC_INFO << "Reply is null" << downloadUrl;
+}
+
+bool HttpDownloader::isDiskCached()
+{
+  // Range replies are not cached - let the network manager load or revalidate an existing entry
+  QAbstractNetworkCache *cache = manager().cache();
+  return cache != nullptr && cache->metaData(QUrl(downloadUrl)).isValid();
+}
+
+void HttpDownloader::startGet()
+{
+  reply = manager().get(createRequest(true /* addValidators */));
+  connectReply();
+}
+
+void HttpDownloader::rangeProbeFinished()
+{
+  rangeProbe = false;
+
+  if(reply->error() == QNetworkReply::NoError)
+  {
+    int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if(status == 304 && detectUnchanged && isContentUnchanged())
+    {
+      if(verbose)
+        qDebug() << Q_FUNC_INFO << "Unchanged" << curUrl();
+
+      emit downloadUnchanged(reply->url().toString());
+      deleteReply();
+      startTimer();
+      return;
+    }
+
+    qint64 size = reply->header(QNetworkRequest::ContentLengthHeader).toLongLong();
+    bool acceptRanges = reply->rawHeader("Accept-Ranges").trimmed().toLower() == "bytes";
+    bool encoded = !reply->rawHeader("Content-Encoding").isEmpty();
+
+    if(verbose)
+      qDebug() << Q_FUNC_INFO << curUrl() << "status" << status << "size" << size << "ranges" << acceptRanges
+               << "encoded" << encoded;
+
+    // Keep finished head reply for headers and URL
+    if(status == 200 && acceptRanges && !encoded && size >= rangeMinSize && startRanges(size))
+      return;
+  }
+  else if(verbose)
+    qDebug() << Q_FUNC_INFO << "HEAD failed" << curUrl() << reply->error();
+
+  // Download in one piece
+  deleteReply();
+  startGet();
+}
+
+bool HttpDownloader::startRanges(qint64 size)
+{
+  QByteArray etag = reply->rawHeader("ETag");
+  QByteArray lastModified = reply->rawHeader("Last-Modified");
+  int num = static_cast<int>(std::min(static_cast<qint64>(rangeConnections), size));
+
+  rangeTotal = size;
+  for(int i = 0; i < num; i++)
+  {
+    qint64 start = size * i / num, end = size * (i + 1) / num - 1;
+
+    QNetworkRequest request = createRequest(false /* addValidators */);
+
+    // Avoid compressed ranges which cannot be concatenated
+    request.setRawHeader(QByteArray("Accept-Encoding"), QByteArray("identity"));
+    request.setRawHeader(QByteArray("Range"), QStringLiteral("bytes=%1-%2").arg(start).arg(end).toLatin1());
+
+    // Server sends the whole file instead of a range if it changed in the meantime
+    if(!etag.isEmpty())
+      request.setRawHeader(QByteArray("If-Range"), etag);
+    else if(!lastModified.isEmpty())
+      request.setRawHeader(QByteArray("If-Range"), lastModified);
+
+    QNetworkReply *rangeReply = manager().get(request);
+    if(rangeReply == nullptr)
+    {
+      deleteRangeReplies();
+      return false;
+    }
+
+    rangeReplies.append(rangeReply);
+    rangeData.append(QByteArray());
+    rangeDone.append(false);
+
+    connect(rangeReply, &QNetworkReply::readyRead, this, [this, i]() {
+      rangeReadyRead(i);
+    });
+    connect(rangeReply, &QNetworkReply::finished, this, [this, i]() {
+      rangeFinished(i);
+    });
+    connect(rangeReply, &QNetworkReply::sslErrors, this, [this, rangeReply](const QList<QSslError>& errors) {
+      // Let user decide on first error
+      if(!ignoreSslErrors)
+        sslErrors(errors);
+
+      if(ignoreSslErrors)
+        rangeReply->ignoreSslErrors();
+    });
+  }
+
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << curUrl() << "size" << size << "ranges" << num;
+  return true;
+}
+
+void HttpDownloader::rangeReadyRead(int index)
+{
+  QNetworkReply *rangeReply = rangeReplies.at(index);
+  rangeData[index].append(rangeReply->readAll());
+
+  qint64 received = 0;
+  for(const QByteArray& range : std::as_const(rangeData))
+    received += range.size();
+  emit downloadProgress(received, rangeTotal, curUrl());
+}
+
+void HttpDownloader::rangeFinished(int index)
+{
+  QNetworkReply *rangeReply = rangeReplies.at(index);
+  if(rangeReply->error() != QNetworkReply::NoError)
+  {
+    rangeFallback(rangeReply->errorString());
+    return;
+  }
+
+  // 200 means the server ignored the range or the file changed
+  int status = rangeReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+  if(status != 206)
+  {
+    rangeFallback(QStringLiteral("Status %1").arg(status));
+    return;
+  }
+
+  rangeData[index].append(rangeReply->readAll());
+  rangeDone[index] = true;
+
+  if(!rangeDone.contains(false))
+  {
+    for(const QByteArray& range : std::as_const(rangeData))
+      data.append(range);
+
+    if(data.size() != rangeTotal)
+    {
+      data.clear();
+      rangeFallback(QStringLiteral("Size mismatch"));
+      return;
+    }
+
+    deleteRangeReplies();
+    downloadSucceeded();
+  }
+}
+
+void HttpDownloader::rangeFallback(const QString& reason)
+{
+  qWarning() << Q_FUNC_INFO << "Range download failed for" << curUrl() << reason << "Downloading in one piece.";
+  deleteRangeReplies();
+  deleteReply();
+  startGet();
+}
+
+void HttpDownloader::deleteRangeReplies()
+{
+  for(QNetworkReply *rangeReply : std::as_const(rangeReplies))
+  {
+    rangeReply->disconnect(this);
+    rangeReply->abort();
+    rangeReply->deleteLater();
+  }
+  rangeReplies.clear();
+  rangeData.clear();
+  rangeDone.clear();
+  rangeTotal = 0;
+}
+
+void HttpDownloader::setDiskCache(const QString& directory, qint64 maxSizeBytes)
+{
+  if(directory.isEmpty())
+    // Deletes the old cache
+    networkManager.setCache(nullptr);
+  else
+  {
+    QNetworkDiskCache *cache = new QNetworkDiskCache(&networkManager);
+    cache->setCacheDirectory(directory);
+    cache->setMaximumCacheSize(maxSizeBytes);
+    networkManager.setCache(cache);
+  }
+}
+
+QNetworkAccessManager *HttpDownloader::createCachingNetworkManager(QObject *parent, const QString& directory,
+                                                                   qint64 maxSizeBytes)
+{
+  QNetworkAccessManager *manager = new QNetworkAccessManager(parent);
+  QNetworkDiskCache *cache = new QNetworkDiskCache(manager);
+  cache->setCacheDirectory(directory);
+  cache->setMaximumCacheSize(maxSizeBytes);
+  manager->setCache(cache);
+  return manager;
+}
+
 void HttpDownloader::sslErrors(const QList<QSslError>& errors)
 {
   if(reply != nullptr)
@@ -186,6 +430,30 @@ void HttpDownloader::cancelDownload()
   data.clear();
 }
 
+bool HttpDownloader::isContentUnchanged()
+{
+  ContentState& state = contentStates[contentKey];
+
+  // 304 - server says not modified and sends no content
+  if(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 304)
+    return !state.hash.isEmpty();
+
+  // Remember validators for next request
+  state.etag = reply->rawHeader("ETag");
+  state.lastModified = reply->rawHeader("Last-Modified");
+
+  // Server does not support validators or content was replaced with the same - compare hash
+  QByteArray hash = streamData ? contentHash.result() : QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+  bool unchanged = state.hash == hash;
+  state.hash = hash;
+  return unchanged;
+}
+
+void HttpDownloader::clearContentStates()
+{
+  contentStates.clear();
+}
+
 void HttpDownloader::setPostParameters(const QStringList& parameters)
 {
   postParameters.clear();
@@ -250,10 +518,14 @@ void HttpDownloader::debugDumpContainerSizes() const
 {
   if(dataCache != nullptr)
     qDebug() << Q_FUNC_INFO << "dataCache->size()" << dataCache->size();
+  qDebug() << Q_FUNC_INFO << "contentStates.size()" << contentStates.size();
 }
 
 void HttpDownloader::deleteReply()
 {
+  deleteRangeReplies();
+  rangeProbe = false;
+
   if(reply != nullptr)
   {
     if(verbose)
@@ -289,17 +561,27 @@ void HttpDownloader::httpFinished()
     if(verbose)
       qDebug() << Q_FUNC_INFO << "URL" << curUrl() << "error" << reply->error() << reply->rawHeaderPairs();
 
-    data.append(reply->readAll());
-
-    if(reply->error() == QNetworkReply::NoError)
+    if(rangeProbe)
     {
-      if(dataCache != nullptr)
-        dataCache->insert(reply->url().toString(), data);
+      rangeProbeFinished();
+      return;
+    }
 
-      emit downloadFinished(data, reply->url().toString());
-      deleteReply();
-      startTimer();
+    if(streamData)
+    {
+      QByteArray chunk = reply->readAll();
+      if(!chunk.isEmpty() && reply->error() == QNetworkReply::NoError)
+      {
+        if(detectUnchanged)
+          contentHash.addData(chunk);
+        emit downloadDataAvailable(chunk, curUrl());
+      }
     }
+    else
+      data.append(reply->readAll());
+
+    if(reply->error() == QNetworkReply::NoError)
+      downloadSucceeded();
     else
     {
       qWarning() << Q_FUNC_INFO << "URL" << curUrl() << "error" << reply->error();
@@ -312,6 +594,31 @@ void HttpDownloader::httpFinished()
     qWarning() << Q_FUNC_INFO << "No reply";
 }
 
+void HttpDownloader::downloadSucceeded()
+{
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << "URL" << curUrl() << "from cache"
+             << reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool();
+
+  if(detectUnchanged && isContentUnchanged())
+  {
+    if(verbose)
+      qDebug() << Q_FUNC_INFO << "Unchanged" << curUrl();
+
+    emit downloadUnchanged(reply->url().toString());
+    deleteReply();
+    startTimer();
+    return;
+  }
+
+  if(dataCache != nullptr && !streamData)
+    dataCache->insert(reply->url().toString(), data);
+
+  emit downloadFinished(data, reply->url().toString());
+  deleteReply();
+  startTimer();
+}
+
 void HttpDownloader::readyRead()
 {
   if(reply != nullptr)
@@ -327,7 +634,15 @@ void HttpDownloader::readyRead()
     {
       if(verbose)
         qDebug() << Q_FUNC_INFO << "reply->bytesAvailable()" << reply->bytesAvailable() << "URL" << curUrl();
-      data.append(reply->read(reply->bytesAvailable()));
+      if(streamData)
+      {
+        QByteArray chunk = reply->read(reply->bytesAvailable());
+        if(detectUnchanged)
+          contentHash.addData(chunk);
+        emit downloadDataAvailable(chunk, curUrl());
+      }
+      else
+        data.append(reply->read(reply->bytesAvailable()));
     }
   }
 }
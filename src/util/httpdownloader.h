@@ -18,6 +18,7 @@
 #ifndef ATOOLS_HTTPDOWNLOADER_H
 #define ATOOLS_HTTPDOWNLOADER_H
 
+#include <QCryptographicHash>
 #include <QNetworkAccessManager>
 #include <QTimer>
 
@@ -32,6 +33,8 @@ class TimedCache;
 /*
  * Simple async HTTP download tool that reads files from web addresses.
  * Has a timer to do recurring downloads and can use a timed cache.
+ *
+ * Can use a disk cache following HTTP caching headers and download large files using parallel range requests.
  */
 class HttpDownloader :
   public QObject
@@ -171,6 +174,35 @@ public:
     acceptEncoding = value;
   }
 
+  /* If true emits downloadDataAvailable for each received chunk instead of collecting the data.
+   * downloadFinished is sent with empty data then. Local files and cached data are still sent
+   * with downloadFinished. */
+  void setStreamData(bool value)
+  {
+    streamData = value;
+  }
+
+  bool isStreamData() const
+  {
+    return streamData;
+  }
+
+  /* If true sends If-None-Match and If-Modified-Since with validators from the last download of the same URL
+   * and compares a hash of the content. Emits downloadUnchanged instead of downloadFinished if the server replies
+   * with 304 or the content did not change. */
+  void setDetectUnchanged(bool value)
+  {
+    detectUnchanged = value;
+  }
+
+  bool isDetectUnchanged() const
+  {
+    return detectUnchanged;
+  }
+
+  /* Forget validators and hashes. Call if the receiver dropped its data to get a full downloadFinished next time. */
+  void clearContentStates();
+
   /* HTTP header parameters */
   const QHash<QString, QString>& getHeaderParameters() const
   {
@@ -182,15 +214,66 @@ public:
     headerParameters = value;
   }
 
+  /* Use a network manager shared with other downloaders instead of the internal one. This allows to
+   * reuse connections and caches. Manager is not owned and has to outlive this object. Pass null to reset. */
+  void setNetworkManager(QNetworkAccessManager *manager)
+  {
+    sharedNetworkManager = manager;
+  }
+
+  /* Abort download with an error if no data was transferred for the given time. 0 disables the timeout. */
+  void setTimeoutMs(int value)
+  {
+    timeoutMs = value;
+  }
+
+  int getTimeoutMs() const
+  {
+    return timeoutMs;
+  }
+
+  /* Use a disk cache in directory for the internal network manager. Fresh responses are taken from the cache
+   * according to HTTP caching headers, also after restarts. Empty directory disables the cache. */
+  void setDiskCache(const QString& directory, qint64 maxSizeBytes = DEFAULT_DISK_CACHE_SIZE);
+
+  /* Create a network manager with a disk cache. Pass it to setNetworkManager() of several downloaders to share
+   * connections and cache. Owned by parent. */
+  static QNetworkAccessManager *createCachingNetworkManager(QObject *parent, const QString& directory,
+                                                            qint64 maxSizeBytes = DEFAULT_DISK_CACHE_SIZE);
+
+  /* Download files of at least minSizeBytes using numConnections parallel HTTP range requests.
+   * Size and range support are checked with a HEAD request first. Falls back to a single GET request if the
+   * server does not support ranges or a range request fails. Not used for POST requests, streamed data and URLs
+   * already in the disk cache since range replies are not cached. Disabled if numConnections is less than two. */
+  void setParallelRanges(int numConnections, qint64 minSizeBytes = DEFAULT_MIN_RANGE_SIZE)
+  {
+    rangeConnections = numConnections;
+    rangeMinSize = minSizeBytes;
+  }
+
+  int getParallelRangeConnections() const
+  {
+    return rangeConnections;
+  }
+
   /* Print the size of all container classes to detect overflow or memory leak conditions */
   void debugDumpContainerSizes() const;
 
+  static const qint64 DEFAULT_DISK_CACHE_SIZE = 100LL * 1024 * 1024;
+  static const qint64 DEFAULT_MIN_RANGE_SIZE = 4LL * 1024 * 1024;
+
 signals:
   /* Emitted when file was downloaded and udpated */
   void downloadFinished(const QByteArray& data, QString downloadUrl);
   void downloadFailed(const QString& error, int errorCode, QString downloadUrl);
   void downloadProgress(qint64 bytesReceived, qint64 bytesTotal, QString downloadUrl);
 
+  /* Emitted instead of downloadFinished if detectUnchanged is set and the content did not change */
+  void downloadUnchanged(QString downloadUrl);
+
+  /* Emitted for each received chunk if streamData is enabled */
+  void downloadDataAvailable(const QByteArray& chunk, QString downloadUrl);
+
   /* Emitted on SSL errors. Call setIgnoreSslErrors to ignore future errors and continue.  */
   void downloadSslErrors(const QStringList& errors, const QString& downloadUrl);
 
@@ -208,11 +291,49 @@ private:
 
   void sslErrors(const QList<QSslError>& errors);
 
-  bool restartRequest = true, ignoreSslErrors = false, sslErrorLogged = false;
+  /* Update state for current URL from finished reply and return true if content is the same as last time */
+  bool isContentUnchanged();
+
+  /* Create request with all headers. Adds validators for detectUnchanged if addValidators is true. */
+  QNetworkRequest createRequest(bool addValidators);
+  QNetworkAccessManager& manager();
+  void connectReply();
+
+  /* true if the network manager has a disk cache entry for the current URL */
+  bool isDiskCached();
+
+  /* Send plain GET request for the current URL */
+  void startGet();
+
+  /* Data in reply or collected ranges is complete. Emit signals and restart timer. */
+  void downloadSucceeded();
+
+  /* HEAD request is finished. Start range requests if possible or fall back to GET. */
+  void rangeProbeFinished();
+  bool startRanges(qint64 size);
+  void rangeReadyRead(int index);
+  void rangeFinished(int index);
+
+  /* Abort range requests and download the whole file with a GET request */
+  void rangeFallback(const QString& reason);
+  void deleteRangeReplies();
+
+  /* Validators and hash of last download for an URL */
+  struct ContentState
+  {
+    QByteArray etag, lastModified, hash;
+  };
+
+  bool restartRequest = true, ignoreSslErrors = false, sslErrorLogged = false, streamData = false,
+       detectUnchanged = false;
 
   QString curUrl();
 
   QNetworkAccessManager networkManager;
+
+  /* Not owned. Used instead of networkManager if not null. */
+  QNetworkAccessManager *sharedNetworkManager = nullptr;
+  int timeoutMs = 0;
   QTimer updateTimer;
   QString downloadUrl, userAgent, acceptEncoding;
 
@@ -224,9 +345,24 @@ private:
   QByteArray data;
   bool verbose;
 
+  /* Maps URL to validators and content hash if detectUnchanged is set */
+  QHash<QString, ContentState> contentStates;
+  QString contentKey;
+
+  /* Hash of streamed chunks */
+  QCryptographicHash contentHash{QCryptographicHash::Sha1};
+
   /* Maps URL to result */
   atools::util::TimedCache<QString, QByteArray> *dataCache = nullptr;
 
+  /* Parallel range downloads. reply holds the finished HEAD request while ranges are downloaded. */
+  int rangeConnections = 0;
+  qint64 rangeMinSize = DEFAULT_MIN_RANGE_SIZE, rangeTotal = 0;
+  bool rangeProbe = false;
+  QList<QNetworkReply *> rangeReplies;
+  QList<QByteArray> rangeData;
+  QList<bool> rangeDone;
+
 };
 
 } // namespace util
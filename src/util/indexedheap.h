@@ -0,0 +1,223 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_UTIL_INDEXEDHEAP_H
+#define ATOOLS_UTIL_INDEXEDHEAP_H
+
+#include <cstddef>
+#include <vector>
+
+namespace atools {
+namespace util {
+
+/*
+ * Binary min heap for integer keys in the range 0 to keyRange - 1 like array indexes.
+ *
+ * Keeps a key to heap slot map which allows contains() in O(1) and
+ * change() (decrease or increase key) and pop() in O(log n).
+ *
+ * Use this instead of Heap if keys are dense array indexes and costs change often like in A*.
+ */
+template<typename COST>
+class IndexedHeap
+{
+public:
+  IndexedHeap(int reserve)
+  {
+    heap.reserve(static_cast<size_t>(reserve));
+  }
+
+  /* Remove all elements and prepare for keys 0 to keyRange - 1. Does not free memory. */
+  void clear(int keyRange)
+  {
+    for(const HeapNode& node : heap)
+      slots[static_cast<size_t>(node.key)] = INVALID_SLOT;
+    heap.clear();
+    slots.resize(static_cast<size_t>(keyRange), INVALID_SLOT);
+  }
+
+  /* Take key with the lowest cost from the top of the heap */
+  int popData();
+
+  /* Take key with the lowest cost from the top of the heap and return its cost */
+  COST pop(int& key)
+  {
+    COST cost = heap.front().cost;
+    key = popData();
+    return cost;
+  }
+
+  /* Key with the lowest cost without removing it */
+  int topData() const
+  {
+    return heap.front().key;
+  }
+
+  /* Lowest cost in heap without removing it */
+  COST topCost() const
+  {
+    return heap.front().cost;
+  }
+
+  /* Add key to the heap. Key must not be contained already. */
+  void pushData(int key, COST cost)
+  {
+    slots[static_cast<size_t>(key)] = static_cast<int>(heap.size());
+    heap.push_back({key, cost});
+    siftUp(heap.size() - 1);
+  }
+
+  void push(int key, COST cost)
+  {
+    pushData(key, cost);
+  }
+
+  /* true if key is in heap. O(1). */
+  bool contains(int key) const
+  {
+    return slots.at(static_cast<size_t>(key)) != INVALID_SLOT;
+  }
+
+  /* Cost of the given key. Key must be contained. */
+  COST cost(int key) const
+  {
+    return heap.at(static_cast<size_t>(slots.at(static_cast<size_t>(key)))).cost;
+  }
+
+  /* Update the costs of a contained key. Does nothing if key is not in heap. O(log n). */
+  void change(int key, COST cost);
+
+  /* Update the costs of a key or add it if not contained. O(log n). */
+  void changeOrPush(int key, COST cost)
+  {
+    if(contains(key))
+      change(key, cost);
+    else
+      pushData(key, cost);
+  }
+
+  bool isEmpty() const
+  {
+    return heap.empty();
+  }
+
+  int size() const
+  {
+    return static_cast<int>(heap.size());
+  }
+
+private:
+  static constexpr int INVALID_SLOT = -1;
+
+  struct HeapNode
+  {
+    int key;
+    COST cost;
+  };
+
+  void siftUp(size_t pos);
+  void siftDown(size_t pos);
+
+  void place(size_t pos, const HeapNode& node)
+  {
+    heap[pos] = node;
+    slots[static_cast<size_t>(node.key)] = static_cast<int>(pos);
+  }
+
+  std::vector<HeapNode> heap;
+
+  /* Maps key to position in heap or INVALID_SLOT */
+  std::vector<int> slots;
+};
+
+template<typename COST>
+int IndexedHeap<COST>::popData()
+{
+  int key = heap.front().key;
+  slots[static_cast<size_t>(key)] = INVALID_SLOT;
+
+  HeapNode last = heap.back();
+  heap.pop_back();
+  if(!heap.empty())
+  {
+    place(0, last);
+    siftDown(0);
+  }
+  return key;
+}
+
+template<typename COST>
+void IndexedHeap<COST>::change(int key, COST cost)
+{
+  int slot = slots.at(static_cast<size_t>(key));
+  if(slot != INVALID_SLOT)
+  {
+    size_t pos = static_cast<size_t>(slot);
+    COST oldCost = heap[pos].cost;
+    heap[pos].cost = cost;
+
+    if(cost < oldCost)
+      siftUp(pos);
+    else if(oldCost < cost)
+      siftDown(pos);
+  }
+}
+
+template<typename COST>
+void IndexedHeap<COST>::siftUp(size_t pos)
+{
+  HeapNode node = heap[pos];
+  while(pos > 0)
+  {
+    size_t parent = (pos - 1) / 2;
+    if(!(node.cost < heap[parent].cost))
+      break;
+
+    place(pos, heap[parent]);
+    pos = parent;
+  }
+  place(pos, node);
+}
+
+template<typename COST>
+void IndexedHeap<COST>::siftDown(size_t pos)
+{
+  HeapNode node = heap[pos];
+  size_t num = heap.size();
+  while(true)
+  {
+    size_t child = 2 * pos + 1;
+    if(child >= num)
+      break;
+
+    // Use smaller of both children
+    if(child + 1 < num && heap[child + 1].cost < heap[child].cost)
+      child++;
+
+    if(!(heap[child].cost < node.cost))
+      break;
+
+    place(pos, heap[child]);
+    pos = child;
+  }
+  place(pos, node);
+}
+
+} // namespace util
+} // namespace atools
+
+#endif // ATOOLS_UTIL_INDEXEDHEAP_H
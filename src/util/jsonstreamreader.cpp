@@ -0,0 +1,443 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "util/jsonstreamreader.h"
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QLocale>
+
+#include <cstring>
+
+namespace atools {
+namespace util {
+
+JsonStreamReader::JsonStreamReader(const QByteArray& dataParam)
+  : data(dataParam)
+{
+  pos = data.constData();
+  end = pos + data.size();
+
+  // Skip UTF-8 BOM
+  if(data.startsWith("\xEF\xBB\xBF"))
+    pos += 3;
+}
+
+JsonStreamReader::TokenType JsonStreamReader::setError(const QString& message)
+{
+  errorString = message;
+  tokenType = ERROR;
+  return tokenType;
+}
+
+void JsonStreamReader::skipWhitespace()
+{
+  while(pos < end && (*pos == ' ' || *pos == '\n' || *pos == '\r' || *pos == '\t'))
+    pos++;
+}
+
+JsonStreamReader::TokenType JsonStreamReader::readNext()
+{
+  if(tokenType == ERROR || tokenType == END)
+    return tokenType;
+
+  skipWhitespace();
+
+  if(pos >= end)
+  {
+    if(stack.isEmpty() && needSeparator)
+      tokenType = END;
+    else
+      setError(QStringLiteral("Unexpected end of data"));
+    return tokenType;
+  }
+
+  char c = *pos;
+  if(afterName)
+  {
+    // Member value follows name ===================
+    if(c != ':')
+      return setError(QStringLiteral("Expected colon"));
+
+    pos++;
+    afterName = false;
+    skipWhitespace();
+    return readValueToken();
+  }
+
+  if(c == '}' || c == ']')
+  {
+    // End of object or array ===================
+    if(stack.isEmpty() || stack.last() != (c == '}' ? '{' : '['))
+      return setError(QStringLiteral("Unexpected %1").arg(c));
+
+    pos++;
+    stack.removeLast();
+    needSeparator = true;
+    tokenType = c == '}' ? END_OBJECT : END_ARRAY;
+    return tokenType;
+  }
+
+  if(needSeparator)
+  {
+    if(stack.isEmpty())
+      return setError(QStringLiteral("Unexpected data after end"));
+
+    if(c != ',')
+      return setError(QStringLiteral("Expected comma"));
+
+    pos++;
+    needSeparator = false;
+    skipWhitespace();
+  }
+
+  if(!stack.isEmpty() && stack.last() == '{')
+  {
+    // Member name in object ===================
+    if(pos >= end || *pos != '"')
+      return setError(QStringLiteral("Expected name"));
+
+    if(!scanString())
+      return tokenType;
+
+    nameStart = tokenStart;
+    nameLength = tokenLength;
+    nameEscaped = tokenEscaped;
+    afterName = true;
+    tokenType = NAME;
+    return tokenType;
+  }
+
+  return readValueToken();
+}
+
+JsonStreamReader::TokenType JsonStreamReader::readValueToken()
+{
+  if(pos >= end)
+    return setError(QStringLiteral("Unexpected end of data"));
+
+  tokenStart = pos;
+  switch(*pos)
+  {
+    case '{':
+    case '[':
+      stack.append(*pos);
+      tokenType = *pos == '{' ? START_OBJECT : START_ARRAY;
+      pos++;
+      needSeparator = false;
+      return tokenType;
+
+    case '"':
+      if(!scanString())
+        return tokenType;
+
+      tokenType = STRING;
+      break;
+
+    case 't':
+    case 'f':
+    case 'n':
+      {
+        const char *literal = *pos == 't' ? "true" : (*pos == 'f' ? "false" : "null");
+        qsizetype length = static_cast<qsizetype>(std::strlen(literal));
+        if(end - pos < length || std::strncmp(pos, literal, static_cast<size_t>(length)) != 0)
+          return setError(QStringLiteral("Invalid literal"));
+
+        pos += length;
+        tokenLength = length;
+        tokenType = *tokenStart == 'n' ? NULL_VALUE : BOOL;
+      }
+      break;
+
+    default:
+      if(*pos == '-' || (*pos >= '0' && *pos <= '9'))
+      {
+        while(pos < end && ((*pos >= '0' && *pos <= '9') || *pos == '-' || *pos == '+' || *pos == '.' ||
+                            *pos == 'e' || *pos == 'E'))
+          pos++;
+        tokenLength = pos - tokenStart;
+        tokenType = NUMBER;
+      }
+      else
+        return setError(QStringLiteral("Unexpected character"));
+  }
+
+  needSeparator = true;
+  return tokenType;
+}
+
+bool JsonStreamReader::scanString()
+{
+  // Skip quote
+  pos++;
+  tokenStart = pos;
+  tokenEscaped = false;
+
+  while(pos < end)
+  {
+    if(*pos == '"')
+    {
+      tokenLength = pos - tokenStart;
+      pos++;
+      return true;
+    }
+    else if(*pos == '\\')
+    {
+      tokenEscaped = true;
+      pos += 2;
+    }
+    else
+      pos++;
+  }
+
+  pos = end;
+  setError(QStringLiteral("Unterminated string"));
+  return false;
+}
+
+bool JsonStreamReader::readNextKey()
+{
+  if(readNext() != NAME)
+    return false;
+
+  readNext();
+  return tokenType != ERROR;
+}
+
+bool JsonStreamReader::readNextElement()
+{
+  TokenType type = readNext();
+  return type != END_ARRAY && type != ERROR && type != END;
+}
+
+QJsonValue JsonStreamReader::readValue()
+{
+  switch(tokenType)
+  {
+    case START_OBJECT:
+      {
+        QJsonObject object;
+        while(readNextKey())
+        {
+          QString name = getName();
+          object.insert(name, readValue());
+        }
+        return object;
+      }
+
+    case START_ARRAY:
+      {
+        QJsonArray array;
+        while(readNextElement())
+          array.append(readValue());
+        return array;
+      }
+
+    case STRING:
+      return getString();
+
+    case NUMBER:
+      {
+        // Keep integers like QJsonDocument does
+        bool ok;
+        qint64 value = QByteArrayView(tokenStart, tokenLength).toLongLong(&ok);
+        if(ok)
+          return value;
+        return getDouble();
+      }
+
+    case BOOL:
+      return getBool();
+
+    case NULL_VALUE:
+      return QJsonValue(QJsonValue::Null);
+
+    case NONE:
+    case END_OBJECT:
+    case END_ARRAY:
+    case NAME:
+    case END:
+    case ERROR:
+      break;
+  }
+  return QJsonValue(QJsonValue::Undefined);
+}
+
+void JsonStreamReader::skipValue()
+{
+  if(tokenType != START_OBJECT && tokenType != START_ARRAY)
+    return;
+
+  int depth = 1;
+  while(depth > 0)
+  {
+    switch(readNext())
+    {
+      case START_OBJECT:
+      case START_ARRAY:
+        depth++;
+        break;
+
+      case END_OBJECT:
+      case END_ARRAY:
+        depth--;
+        break;
+
+      case END:
+      case ERROR:
+        return;
+
+      case NONE:
+      case NAME:
+      case STRING:
+      case NUMBER:
+      case BOOL:
+      case NULL_VALUE:
+        break;
+    }
+  }
+}
+
+QString JsonStreamReader::getName() const
+{
+  return decode(nameStart, nameLength, nameEscaped);
+}
+
+bool JsonStreamReader::isName(const char *name) const
+{
+  if(nameEscaped)
+    return getName() == QLatin1String(name);
+
+  return static_cast<qsizetype>(std::strlen(name)) == nameLength &&
+         std::strncmp(name, nameStart, static_cast<size_t>(nameLength)) == 0;
+}
+
+QString JsonStreamReader::getString() const
+{
+  switch(tokenType)
+  {
+    case STRING:
+      return decode(tokenStart, tokenLength, tokenEscaped);
+
+    case NUMBER:
+      {
+        // Format like QVariant does for JSON numbers
+        bool ok;
+        qint64 value = QByteArrayView(tokenStart, tokenLength).toLongLong(&ok);
+        return ok ? QString::number(value) : QString::number(getDouble(), 'g', QLocale::FloatingPointShortest);
+      }
+
+    case BOOL:
+      return getBool() ? QStringLiteral("true") : QStringLiteral("false");
+
+    case NONE:
+    case START_OBJECT:
+    case END_OBJECT:
+    case START_ARRAY:
+    case END_ARRAY:
+    case NAME:
+    case NULL_VALUE:
+    case END:
+    case ERROR:
+      break;
+  }
+  return QString();
+}
+
+double JsonStreamReader::getDouble() const
+{
+  if(tokenType == NUMBER)
+    return QByteArrayView(tokenStart, tokenLength).toDouble();
+  else if(tokenType == STRING)
+    return getString().toDouble();
+  return 0.;
+}
+
+qint64 JsonStreamReader::getInteger() const
+{
+  if(tokenType == NUMBER)
+  {
+    bool ok;
+    qint64 value = QByteArrayView(tokenStart, tokenLength).toLongLong(&ok);
+    return ok ? value : static_cast<qint64>(getDouble());
+  }
+  else if(tokenType == STRING)
+    return getString().toLongLong();
+  return 0;
+}
+
+QString JsonStreamReader::decode(const char *str, qsizetype length, bool escaped)
+{
+  if(!escaped)
+    return QString::fromUtf8(str, length);
+
+  QString retval;
+  retval.reserve(length);
+
+  const char *segment = str, *strEnd = str + length;
+  for(const char *p = str; p < strEnd; p++)
+  {
+    if(*p != '\\' || p + 1 >= strEnd)
+      continue;
+
+    // Add unescaped part
+    retval.append(QString::fromUtf8(segment, p - segment));
+    p++;
+
+    switch(*p)
+    {
+      case 'b':
+        retval.append(QChar('\b'));
+        break;
+      case 'f':
+        retval.append(QChar('\f'));
+        break;
+      case 'n':
+        retval.append(QChar('\n'));
+        break;
+      case 'r':
+        retval.append(QChar('\r'));
+        break;
+      case 't':
+        retval.append(QChar('\t'));
+        break;
+      case 'u':
+        if(strEnd - p > 4)
+        {
+          // Surrogate pairs are combined by QString automatically
+          bool ok;
+          ushort code = QByteArrayView(p + 1, 4).toUShort(&ok, 16);
+          if(ok)
+            retval.append(QChar(code));
+          p += 4;
+        }
+        break;
+
+      default:
+        // Quote, slash and backslash
+        retval.append(QChar(*p));
+        break;
+    }
+    segment = p + 1;
+  }
+
+  retval.append(QString::fromUtf8(segment, strEnd - segment));
+  return retval;
+}
+
+} // namespace util
+} // namespace atools
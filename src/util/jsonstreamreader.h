@@ -0,0 +1,160 @@
+/*****************************************************************************
+* Copyright 2015-2026 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_UTIL_JSONSTREAMREADER_H
+#define ATOOLS_UTIL_JSONSTREAMREADER_H
+
+#include <QByteArray>
+#include <QJsonValue>
+#include <QVarLengthArray>
+
+namespace atools {
+namespace util {
+
+/*
+ * Pull parser reading JSON tokens directly from UTF-8 encoded bytes without building a document.
+ * Similar to QXmlStreamReader. Strings are decoded only when requested.
+ *
+ * Small parts like single objects of a large array can be read into a QJsonValue using readValue()
+ * while uninteresting parts are skipped using skipValue().
+ *
+ * Usage for an object:
+ * if(reader.readNext() == JsonStreamReader::START_OBJECT)
+ *   while(reader.readNextKey())
+ *     if(reader.isName("pilots")) ... else reader.skipValue();
+ *
+ * Errors stop reading and are reported by hasError(). Does not throw.
+ */
+class JsonStreamReader
+{
+public:
+  enum TokenType
+  {
+    NONE, /* Nothing read yet */
+    START_OBJECT,
+    END_OBJECT,
+    START_ARRAY,
+    END_ARRAY,
+    NAME, /* Name of a member in an object */
+    STRING,
+    NUMBER,
+    BOOL,
+    NULL_VALUE,
+    END, /* Top level value read completely */
+    ERROR
+  };
+
+  /* Data is not copied but shared implicitly */
+  explicit JsonStreamReader(const QByteArray& dataParam);
+
+  JsonStreamReader(const JsonStreamReader& other) = delete;
+  JsonStreamReader& operator=(const JsonStreamReader& other) = delete;
+
+  /* Read next token */
+  TokenType readNext();
+
+  TokenType getTokenType() const
+  {
+    return tokenType;
+  }
+
+  /* Read next member of the current object. Returns true and is positioned on the first token of the value
+   * if a member was found. Name is available by getName() then. Returns false at the end of the object. */
+  bool readNextKey();
+
+  /* Read next element of the current array. Returns true and is positioned on the first token of the element.
+   * Returns false at the end of the array. */
+  bool readNextElement();
+
+  /* Read the value starting at the current token completely into a JSON value. Current token is the last token
+   * of the value afterwards. */
+  QJsonValue readValue();
+
+  /* Skip the value starting at the current token including all nested objects and arrays */
+  void skipValue();
+
+  /* Name of the last read member */
+  QString getName() const;
+
+  /* Compare name of the last read member without decoding the bytes */
+  bool isName(const char *name) const;
+
+  /* Values for the current token. Numbers and booleans are also converted to string. */
+  QString getString() const;
+  double getDouble() const;
+  qint64 getInteger() const;
+  bool getBool() const
+  {
+    return tokenType == BOOL && tokenLength == 4;
+  }
+
+  bool hasError() const
+  {
+    return tokenType == ERROR;
+  }
+
+  const QString& getErrorString() const
+  {
+    return errorString;
+  }
+
+  /* Byte offset of the error or current position */
+  qint64 getOffset() const
+  {
+    return pos - data.constData();
+  }
+
+private:
+  TokenType setError(const QString& message);
+  TokenType readValueToken();
+  bool scanString();
+  void skipWhitespace();
+
+  /* Decode string with escapes */
+  static QString decode(const char *str, qsizetype length, bool escaped);
+
+  QByteArray data;
+  const char *pos = nullptr, *end = nullptr;
+
+  /* Current token or string content without quotes */
+  const char *tokenStart = nullptr;
+  qsizetype tokenLength = 0;
+  bool tokenEscaped = false;
+
+  /* Last member name */
+  const char *nameStart = nullptr;
+  qsizetype nameLength = 0;
+  bool nameEscaped = false;
+
+  TokenType tokenType = NONE;
+
+  /* Open objects and arrays as '{' and '[' */
+  QVarLengthArray<char, 32> stack;
+
+  /* A value was read and a comma or end is expected next */
+  bool needSeparator = false;
+
+  /* A name was read and a colon is expected next */
+  bool afterName = false;
+
+  QString errorString;
+};
+
+} // namespace util
+} // namespace atools
+
+#endif // ATOOLS_UTIL_JSONSTREAMREADER_H
@@ -0,0 +1,144 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "util/memoryusage.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QTextStream>
+
+#include <algorithm>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#elif defined(Q_OS_MACOS)
+#include <mach/mach.h>
+#endif
+
+namespace atools {
+namespace util {
+
+void MemoryUsage::add(const QString& component, qint64 bytes, qint64 count)
+{
+  for(MemoryUsageEntry& entry : entries)
+  {
+    if(entry.component == component)
+    {
+      entry.bytes += bytes;
+      entry.count += count;
+      return;
+    }
+  }
+
+  MemoryUsageEntry entry;
+  entry.component = component;
+  entry.bytes = bytes;
+  entry.count = count;
+  entries.append(entry);
+}
+
+void MemoryUsage::add(const QString& prefix, const MemoryUsage& other)
+{
+  for(const MemoryUsageEntry& entry : other.entries)
+    add(prefix + '/' + entry.component, entry.bytes, entry.count);
+}
+
+qint64 MemoryUsage::getTotalBytes() const
+{
+  qint64 total = 0;
+  for(const MemoryUsageEntry& entry : entries)
+    total += entry.bytes;
+  return total;
+}
+
+qint64 MemoryUsage::getTotalBytes(const QString& prefix) const
+{
+  qint64 total = 0;
+  for(const MemoryUsageEntry& entry : entries)
+  {
+    if(entry.component.startsWith(prefix))
+      total += entry.bytes;
+  }
+  return total;
+}
+
+QString MemoryUsage::getReport() const
+{
+  QList<MemoryUsageEntry> sorted(entries);
+  std::sort(sorted.begin(), sorted.end(), [](const MemoryUsageEntry& entry1, const MemoryUsageEntry& entry2) {
+    return entry1.component < entry2.component;
+  });
+
+  int width = 5;
+  for(const MemoryUsageEntry& entry : std::as_const(sorted))
+    width = std::max(width, static_cast<int>(entry.component.size()));
+
+  QString report;
+  QTextStream stream(&report);
+  for(const MemoryUsageEntry& entry : std::as_const(sorted))
+    stream << entry.component.leftJustified(width) << " " << QString::number(entry.bytes / 1024).rightJustified(10)
+           << " kB " << QString::number(entry.count).rightJustified(10) << Qt::endl;
+
+  stream << QStringLiteral("Total").leftJustified(width) << " "
+         << QString::number(getTotalBytes() / 1024).rightJustified(10) << " kB" << Qt::endl;
+  return report;
+}
+
+qint64 MemoryUsage::getAvailablePhysicalBytes()
+{
+#if defined(Q_OS_WIN)
+  MEMORYSTATUSEX status;
+  status.dwLength = sizeof(status);
+  if(GlobalMemoryStatusEx(&status))
+    return static_cast<qint64>(status.ullAvailPhys);
+
+#elif defined(Q_OS_LINUX)
+  // Line "MemAvailable:    8123456 kB" includes reclaimable caches
+  QFile file(QStringLiteral("/proc/meminfo"));
+  if(file.open(QIODevice::ReadOnly | QIODevice::Text))
+  {
+    while(!file.atEnd())
+    {
+      QByteArray line = file.readLine();
+      if(line.startsWith("MemAvailable:"))
+        return line.mid(13).trimmed().split(' ').value(0).toLongLong() * 1024;
+    }
+  }
+
+#elif defined(Q_OS_MACOS)
+  // Free and inactive pages can be used without swapping
+  vm_statistics64_data_t stats;
+  mach_msg_type_number_t count = HOST_VM_INFO64_COUNT;
+  if(host_statistics64(mach_host_self(), HOST_VM_INFO64, reinterpret_cast<host_info64_t>(&stats), &count) == KERN_SUCCESS)
+    return static_cast<qint64>(stats.free_count + stats.inactive_count) * static_cast<qint64>(vm_page_size);
+
+#endif
+  return -1;
+}
+
+QDebug operator<<(QDebug out, const MemoryUsage& usage)
+{
+  QDebugStateSaver saver(out);
+  out.noquote().nospace() << "MemoryUsage[total " << usage.getTotalBytes() / 1024 << " kB";
+  for(const MemoryUsageEntry& entry : usage.getEntries())
+    out << ", " << entry.component << " " << entry.bytes / 1024 << " kB/" << entry.count;
+  out << "]";
+  return out;
+}
+
+} // namespace util
+} // namespace atools
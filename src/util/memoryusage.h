@@ -0,0 +1,131 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_UTIL_MEMORYUSAGE_H
+#define ATOOLS_UTIL_MEMORYUSAGE_H
+
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+
+class QDebug;
+
+namespace atools {
+namespace util {
+
+/* Estimated heap memory of one component and number of contained objects */
+struct MemoryUsageEntry
+{
+  QString component;
+  qint64 bytes = 0, count = 0;
+};
+
+/*
+ * Collects estimated memory usage of large in-memory structures by component.
+ *
+ * Classes holding large structures provide a method getMemoryUsage(MemoryUsage&) const which adds one entry
+ * for each of their containers. Component names are prefixed by the class name like "MetarIndex/entries".
+ * Pass one instance to several classes to get an aggregate report.
+ *
+ * Sizes are estimations based on container capacity and element size. Heap memory of strings or lists
+ * inside elements is only counted where noted.
+ */
+class MemoryUsage
+{
+public:
+  /* Add bytes and object count for a component. Values are summed up if the component already exists. */
+  void add(const QString& component, qint64 bytes, qint64 count);
+
+  /* Add all entries of other with component names prefixed by prefix and a "/".
+   * Used to report several instances of the same class separately. */
+  void add(const QString& prefix, const MemoryUsage& other);
+
+  /* Sum of all bytes */
+  qint64 getTotalBytes() const;
+
+  /* Sum of bytes of all components having the given prefix, e.g. "RouteNetwork/" */
+  qint64 getTotalBytes(const QString& prefix) const;
+
+  const QList<atools::util::MemoryUsageEntry>& getEntries() const
+  {
+    return entries;
+  }
+
+  bool isEmpty() const
+  {
+    return entries.isEmpty();
+  }
+
+  void clear()
+  {
+    entries.clear();
+  }
+
+  /* Table with one line per component and total sorted by component name. Sizes in kB. */
+  QString getReport() const;
+
+  /* Physical memory which can be used without swapping as reported by the operating system.
+   * Returns -1 if not available. */
+  static qint64 getAvailablePhysicalBytes();
+
+  /* Estimation helpers for containers ==================================================== */
+
+  /* Reserved list memory */
+  template<typename TYPE>
+  static qint64 listBytes(const QList<TYPE>& list)
+  {
+    return static_cast<qint64>(list.capacity()) * static_cast<qint64>(sizeof(TYPE));
+  }
+
+  /* Reserved vector memory */
+  template<typename TYPE>
+  static qint64 vectorBytes(const std::vector<TYPE>& vector)
+  {
+    return static_cast<qint64>(vector.capacity()) * static_cast<qint64>(sizeof(TYPE));
+  }
+
+  /* Hash entries and one offset byte for each bucket as used by the Qt 6 span layout */
+  template<typename KEY, typename VALUE>
+  static qint64 hashBytes(const QHash<KEY, VALUE>& hash)
+  {
+    return static_cast<qint64>(hash.size()) * static_cast<qint64>(sizeof(KEY) + sizeof(VALUE)) +
+           static_cast<qint64>(hash.capacity());
+  }
+
+  template<typename KEY>
+  static qint64 hashBytes(const QSet<KEY>& set)
+  {
+    return static_cast<qint64>(set.size()) * static_cast<qint64>(sizeof(KEY)) + static_cast<qint64>(set.capacity());
+  }
+
+  /* Characters of the string */
+  static qint64 stringBytes(const QString& str)
+  {
+    return static_cast<qint64>(str.capacity()) * static_cast<qint64>(sizeof(QChar));
+  }
+
+private:
+  QList<atools::util::MemoryUsageEntry> entries;
+};
+
+QDebug operator<<(QDebug out, const atools::util::MemoryUsage& usage);
+
+} // namespace util
+} // namespace atools
+
+#endif // ATOOLS_UTIL_MEMORYUSAGE_H
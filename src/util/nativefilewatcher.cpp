@@ -0,0 +1,345 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "util/nativefilewatcher.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+
+#if defined(Q_OS_LINUX)
+#include <QSocketNotifier>
+
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#elif defined(Q_OS_WIN)
+#include <QWinEventNotifier>
+
+#include <windows.h>
+#endif
+
+namespace atools {
+namespace util {
+
+#if defined(Q_OS_LINUX)
+
+struct NativeFileWatcher::DirWatch
+{
+  QString path;
+  int wd = -1;
+};
+
+NativeFileWatcher::NativeFileWatcher(QObject *parent)
+  : QObject(parent)
+{
+  inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if(inotifyFd == -1)
+    qWarning() << Q_FUNC_INFO << "inotify_init1 failed" << errno;
+  else
+  {
+    notifier = new QSocketNotifier(inotifyFd, QSocketNotifier::Read, this);
+    connect(notifier, &QSocketNotifier::activated, this, &NativeFileWatcher::inotifyActivated);
+  }
+}
+
+NativeFileWatcher::~NativeFileWatcher()
+{
+  clear();
+  delete notifier;
+
+  if(inotifyFd != -1)
+    ::close(inotifyFd);
+}
+
+bool NativeFileWatcher::isValid() const
+{
+  return inotifyFd != -1;
+}
+
+bool NativeFileWatcher::addDirectory(const QString& path)
+{
+  if(inotifyFd == -1)
+    return false;
+
+  QString dir = QDir::cleanPath(path);
+  if(dirs.contains(dir))
+    return true;
+
+  // Close write covers files written at once and modify catches files which are kept open
+  int wd = inotify_add_watch(inotifyFd, QFile::encodeName(dir).constData(),
+                             IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                             IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR);
+  if(wd == -1)
+  {
+    qWarning() << Q_FUNC_INFO << "inotify_add_watch failed for" << dir << errno;
+    return false;
+  }
+
+  DirWatch *watch = new DirWatch;
+  watch->path = dir;
+  watch->wd = wd;
+  dirs.insert(dir, watch);
+  watchDescriptors.insert(wd, dir);
+  return true;
+}
+
+void NativeFileWatcher::removeWatch(DirWatch *watch)
+{
+  if(watch->wd != -1)
+  {
+    inotify_rm_watch(inotifyFd, watch->wd);
+    watchDescriptors.remove(watch->wd);
+  }
+  delete watch;
+}
+
+void NativeFileWatcher::inotifyActivated()
+{
+  // Buffer aligned for inotify_event
+  alignas(inotify_event) char buffer[16 * 1024];
+  QStringList paths;
+
+  // Read all pending events to coalesce them into one batch
+  while(true)
+  {
+    ssize_t len = ::read(inotifyFd, buffer, sizeof(buffer));
+    if(len <= 0)
+      break;
+
+    for(char *ptr = buffer; ptr < buffer + len; )
+    {
+      const inotify_event *event = reinterpret_cast<const inotify_event *>(ptr);
+      ptr += sizeof(inotify_event) + event->len;
+
+      if(event->mask & IN_Q_OVERFLOW)
+      {
+        // Events lost - report all directories as changed
+        for(const QString& dir : dirs.keys())
+        {
+          if(!paths.contains(dir))
+            paths.append(dir);
+        }
+        continue;
+      }
+
+      QString dir = watchDescriptors.value(event->wd);
+      if(dir.isEmpty())
+        continue;
+
+      if(event->mask & IN_IGNORED)
+      {
+        // Directory was removed or unmounted - watch is gone and can be added again
+        watchDescriptors.remove(event->wd);
+        delete dirs.take(dir);
+        continue;
+      }
+
+      if(event->len > 0)
+      {
+        QString file = dir + '/' + QFile::decodeName(event->name);
+        if(!paths.contains(file))
+          paths.append(file);
+      }
+
+      // Directory content changed
+      if(event->mask & (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF))
+      {
+        if(!paths.contains(dir))
+          paths.append(dir);
+      }
+    }
+  }
+
+  emitBatch(paths);
+}
+
+#elif defined(Q_OS_WIN)
+
+struct NativeFileWatcher::DirWatch
+{
+  QString path;
+  HANDLE handle = INVALID_HANDLE_VALUE;
+  OVERLAPPED overlapped;
+  QWinEventNotifier *notifier = nullptr;
+
+  /* Filled by ReadDirectoryChangesW. Has to be DWORD aligned. */
+  alignas(DWORD) char buffer[16 * 1024];
+};
+
+/* Start next overlapped read. Completion signals the event in overlapped. */
+static bool readChanges(HANDLE handle, OVERLAPPED *overlapped, char *buffer, DWORD size)
+{
+  return ReadDirectoryChangesW(handle, buffer, size, FALSE /* bWatchSubtree */,
+                               FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_SIZE |
+                               FILE_NOTIFY_CHANGE_LAST_WRITE, nullptr, overlapped, nullptr);
+}
+
+NativeFileWatcher::NativeFileWatcher(QObject *parent)
+  : QObject(parent)
+{
+}
+
+NativeFileWatcher::~NativeFileWatcher()
+{
+  clear();
+}
+
+bool NativeFileWatcher::isValid() const
+{
+  return true;
+}
+
+bool NativeFileWatcher::addDirectory(const QString& path)
+{
+  QString dir = QDir::cleanPath(path);
+  if(dirs.contains(dir))
+    return true;
+
+  HANDLE handle = CreateFileW(reinterpret_cast<const wchar_t *>(QDir::toNativeSeparators(dir).utf16()), FILE_LIST_DIRECTORY,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                              FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+  if(handle == INVALID_HANDLE_VALUE)
+  {
+    qWarning() << Q_FUNC_INFO << "CreateFileW failed for" << dir << GetLastError();
+    return false;
+  }
+
+  DirWatch *watch = new DirWatch;
+  watch->path = dir;
+  watch->handle = handle;
+  ZeroMemory(&watch->overlapped, sizeof(watch->overlapped));
+  watch->overlapped.hEvent = CreateEventW(nullptr, TRUE /* manual reset */, FALSE, nullptr);
+
+  if(!readChanges(handle, &watch->overlapped, watch->buffer, sizeof(watch->buffer)))
+  {
+    qWarning() << Q_FUNC_INFO << "ReadDirectoryChangesW failed for" << dir << GetLastError();
+    CloseHandle(watch->overlapped.hEvent);
+    CloseHandle(handle);
+    delete watch;
+    return false;
+  }
+
+  watch->notifier = new QWinEventNotifier(watch->overlapped.hEvent, this);
+  connect(watch->notifier, &QWinEventNotifier::activated, this, [this, watch]() {
+    directoryActivated(watch);
+  });
+
+  dirs.insert(dir, watch);
+  return true;
+}
+
+void NativeFileWatcher::removeWatch(DirWatch *watch)
+{
+  delete watch->notifier;
+
+  if(watch->handle != INVALID_HANDLE_VALUE)
+  {
+    // Wait for cancellation since the kernel writes into the buffer until then
+    DWORD bytes = 0;
+    CancelIoEx(watch->handle, &watch->overlapped);
+    GetOverlappedResult(watch->handle, &watch->overlapped, &bytes, TRUE);
+    CloseHandle(watch->handle);
+  }
+
+  CloseHandle(watch->overlapped.hEvent);
+  delete watch;
+}
+
+void NativeFileWatcher::directoryActivated(DirWatch *watch)
+{
+  QStringList paths;
+  DWORD bytes = 0;
+  bool ok = GetOverlappedResult(watch->handle, &watch->overlapped, &bytes, FALSE);
+  ResetEvent(watch->overlapped.hEvent);
+
+  if(!ok || bytes == 0)
+    // Buffer overflow or error - report directory to check all files
+    paths.append(watch->path);
+  else
+  {
+    for(const char *ptr = watch->buffer; ptr != nullptr; )
+    {
+      const FILE_NOTIFY_INFORMATION *info = reinterpret_cast<const FILE_NOTIFY_INFORMATION *>(ptr);
+      QString file = watch->path + '/' + QDir::fromNativeSeparators(
+        QString::fromWCharArray(info->FileName, static_cast<qsizetype>(info->FileNameLength / sizeof(WCHAR))));
+      if(!paths.contains(file))
+        paths.append(file);
+
+      // Directory content changed
+      if(info->Action != FILE_ACTION_MODIFIED && !paths.contains(watch->path))
+        paths.append(watch->path);
+
+      ptr = info->NextEntryOffset > 0 ? ptr + info->NextEntryOffset : nullptr;
+    }
+  }
+
+  // Continue watching
+  if(!readChanges(watch->handle, &watch->overlapped, watch->buffer, sizeof(watch->buffer)))
+    qWarning() << Q_FUNC_INFO << "ReadDirectoryChangesW failed for" << watch->path << GetLastError();
+
+  emitBatch(paths);
+}
+
+#else
+
+struct NativeFileWatcher::DirWatch
+{
+};
+
+NativeFileWatcher::NativeFileWatcher(QObject *parent)
+  : QObject(parent)
+{
+}
+
+NativeFileWatcher::~NativeFileWatcher()
+{
+}
+
+bool NativeFileWatcher::isValid() const
+{
+  return false;
+}
+
+bool NativeFileWatcher::addDirectory(const QString&)
+{
+  return false;
+}
+
+void NativeFileWatcher::removeWatch(DirWatch *watch)
+{
+  delete watch;
+}
+
+#endif
+
+void NativeFileWatcher::clear()
+{
+  for(DirWatch *watch : std::as_const(dirs))
+    removeWatch(watch);
+  dirs.clear();
+}
+
+void NativeFileWatcher::emitBatch(const QStringList& paths)
+{
+  if(!paths.isEmpty())
+    emit pathsChanged(paths);
+}
+
+} // namespace util
+} // namespace atools
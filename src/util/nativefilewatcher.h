@@ -0,0 +1,99 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_UTIL_NATIVEFILEWATCHER_H
+#define ATOOLS_UTIL_NATIVEFILEWATCHER_H
+
+#include <QHash>
+#include <QObject>
+#include <QStringList>
+
+class QSocketNotifier;
+
+namespace atools {
+namespace util {
+
+/*
+ * Watches directories using the operating system notification API. inotify is used on Linux and
+ * ReadDirectoryChangesW on Windows. Not available on other systems.
+ *
+ * Directories are watched instead of files since files replaced by renaming or deleting drop out of file watches.
+ * All events read at once are coalesced and sent as one batch of unique paths. No polling is needed.
+ */
+class NativeFileWatcher
+  : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit NativeFileWatcher(QObject *parent);
+  virtual ~NativeFileWatcher() override;
+
+  NativeFileWatcher(const NativeFileWatcher& other) = delete;
+  NativeFileWatcher& operator=(const NativeFileWatcher& other) = delete;
+
+  /* true if the native API is supported on this system and was initialized */
+  bool isValid() const;
+
+  /* Start watching the directory. Returns false on error or if not supported. */
+  bool addDirectory(const QString& path);
+
+  /* Stop watching all directories */
+  void clear();
+
+  /* Watched directories */
+  QStringList getDirectories() const
+  {
+    return dirs.keys();
+  }
+
+signals:
+  /* Changed files and directories. Directories are included if files were created, deleted or renamed in them. */
+  void pathsChanged(const QStringList& paths);
+
+private:
+  /* Platform dependent watch for one directory */
+  struct DirWatch;
+
+  void removeWatch(DirWatch *watch);
+
+  /* Emit collected paths once per batch */
+  void emitBatch(const QStringList& paths);
+
+  QHash<QString, DirWatch *> dirs;
+
+#ifdef Q_OS_LINUX
+  /* Called by notifier when inotify descriptor is readable */
+  void inotifyActivated();
+
+  int inotifyFd = -1;
+  QSocketNotifier *notifier = nullptr;
+
+  /* Watch descriptor to directory path */
+  QHash<int, QString> watchDescriptors;
+#endif
+
+#ifdef Q_OS_WIN
+  /* Called by event notifier when overlapped read of a directory is completed */
+  void directoryActivated(DirWatch *watch);
+#endif
+};
+
+} // namespace util
+} // namespace atools
+
+#endif // ATOOLS_UTIL_NATIVEFILEWATCHER_H
@@ -19,6 +19,9 @@
 #include "atools.h"
 
 #include <QVariant>
+#include <QtEndian>
+
+#include <cstring>
 
 namespace atools {
 namespace util {
@@ -51,7 +54,7 @@ size_t qHash(const atools::util::Prop& prop, size_t seed)
     case BYTES8:
     case BYTES16:
     case BYTES32:
-      return qHashMulti(seed, prop.getValueBytes(), prop.key);
+      return qHashMulti(seed, prop.getValueBytesView(), prop.key);
 
     case INVALID:
     case NONE:
@@ -115,20 +118,20 @@ QDataStream& operator<<(QDataStream& out, const Prop& prop)
 
     case BYTES8:
     case STRING8:
-      out << static_cast<quint8>(prop.bytes.size());
-      out.writeRawData(prop.bytes.constData(), prop.bytes.size());
+      out << static_cast<quint8>(prop.getValueBytesView().size());
+      out.writeRawData(prop.getValueBytesView().data(), prop.getValueBytesView().size());
       break;
 
     case BYTES16:
     case STRING16:
-      out << static_cast<quint16>(prop.bytes.size());
-      out.writeRawData(prop.bytes.constData(), prop.bytes.size());
+      out << static_cast<quint16>(prop.getValueBytesView().size());
+      out.writeRawData(prop.getValueBytesView().data(), prop.getValueBytesView().size());
       break;
 
     case BYTES32:
     case STRING32:
-      out << static_cast<quint32>(prop.bytes.size());
-      out.writeRawData(prop.bytes.constData(), prop.bytes.size());
+      out << static_cast<quint32>(prop.getValueBytesView().size());
+      out.writeRawData(prop.getValueBytesView().data(), prop.getValueBytesView().size());
       break;
 
     case NONE:
@@ -263,6 +266,256 @@ QDataStream& operator>>(QDataStream& in, Props& props)
   return in;
 }
 
+namespace propbin {
+
+template<typename TYPE>
+inline void append(QByteArray& buffer, TYPE value)
+{
+  TYPE le = qToLittleEndian(value);
+  buffer.append(reinterpret_cast<const char *>(&le), sizeof(TYPE));
+}
+
+/* Returns false if not enough data is left */
+template<typename TYPE>
+inline bool read(const char *& data, const char *end, TYPE& value)
+{
+  if(end - data < static_cast<qsizetype>(sizeof(TYPE)))
+    return false;
+
+  value = qFromLittleEndian<TYPE>(data);
+  data += sizeof(TYPE);
+  return true;
+}
+
+template<typename SIZETYPE>
+inline void appendBytes(QByteArray& buffer, QByteArrayView bytes)
+{
+  append<SIZETYPE>(buffer, static_cast<SIZETYPE>(bytes.size()));
+  buffer.append(bytes.data(), bytes.size());
+}
+
+/* Returns a view into data which is valid as long as data */
+template<typename SIZETYPE>
+inline bool readBytes(const char *& data, const char *end, QByteArrayView& bytes)
+{
+  SIZETYPE size;
+  if(!read(data, end, size) || end - data < static_cast<qsizetype>(size))
+    return false;
+
+  bytes = QByteArrayView(data, static_cast<qsizetype>(size));
+  data += size;
+  return true;
+}
+
+} // namespace propbin
+
+void Prop::appendBinary(QByteArray& buffer) const
+{
+  buffer.append(static_cast<char>(key));
+  buffer.append(static_cast<char>(type));
+
+  switch(type)
+  {
+    case INT8:
+    case BOOL:
+    case UINT8:
+      buffer.append(static_cast<char>(number.value));
+      break;
+
+    case INT16:
+    case UINT16:
+      propbin::append(buffer, static_cast<quint16>(number.value));
+      break;
+
+    case INT32:
+    case UINT32:
+      propbin::append(buffer, static_cast<quint32>(number.value));
+      break;
+
+    case INT64:
+      propbin::append(buffer, static_cast<qint64>(number.value));
+      break;
+
+    case FLOAT:
+      propbin::append(buffer, number.floatValue);
+      break;
+
+    case DOUBLE:
+      propbin::append(buffer, number.doubleValue);
+      break;
+
+    case BYTES8:
+    case STRING8:
+      propbin::appendBytes<quint8>(buffer, getValueBytesView());
+      break;
+
+    case BYTES16:
+    case STRING16:
+      propbin::appendBytes<quint16>(buffer, getValueBytesView());
+      break;
+
+    case BYTES32:
+    case STRING32:
+      propbin::appendBytes<quint32>(buffer, getValueBytesView());
+      break;
+
+    case NONE:
+    case INVALID:
+      break;
+  }
+}
+
+const char *Prop::readBinary(const char *data, const char *end)
+{
+  if(end - data < 2)
+    return nullptr;
+
+  key = static_cast<quint8>(*data++);
+  type = static_cast<ptinternal::PropType>(static_cast<quint8>(*data++));
+
+  bool ok = true, hasBytes = false;
+  QByteArrayView bytesView;
+  switch(type)
+  {
+    case INT8:
+      {
+        qint8 num;
+        ok = propbin::read(data, end, num);
+        number.value = num;
+      }
+      break;
+
+    case BOOL:
+    case UINT8:
+      {
+        quint8 num;
+        ok = propbin::read(data, end, num);
+        number.value = num;
+      }
+      break;
+
+    case INT16:
+      {
+        qint16 num;
+        ok = propbin::read(data, end, num);
+        number.value = num;
+      }
+      break;
+
+    case UINT16:
+      {
+        quint16 num;
+        ok = propbin::read(data, end, num);
+        number.value = num;
+      }
+      break;
+
+    case INT32:
+      {
+        qint32 num;
+        ok = propbin::read(data, end, num);
+        number.value = num;
+      }
+      break;
+
+    case UINT32:
+      {
+        quint32 num;
+        ok = propbin::read(data, end, num);
+        number.value = num;
+      }
+      break;
+
+    case INT64:
+      {
+        qint64 num;
+        ok = propbin::read(data, end, num);
+        number.value = num;
+      }
+      break;
+
+    case FLOAT:
+      ok = propbin::read(data, end, number.floatValue);
+      break;
+
+    case DOUBLE:
+      ok = propbin::read(data, end, number.doubleValue);
+      break;
+
+    case STRING8:
+    case BYTES8:
+      ok = hasBytes = propbin::readBytes<quint8>(data, end, bytesView);
+      break;
+
+    case STRING16:
+    case BYTES16:
+      ok = hasBytes = propbin::readBytes<quint16>(data, end, bytesView);
+      break;
+
+    case STRING32:
+    case BYTES32:
+      ok = hasBytes = propbin::readBytes<quint32>(data, end, bytesView);
+      break;
+
+    case NONE:
+      break;
+
+    case INVALID:
+    default:
+      // Invalid values are never written
+      ok = false;
+      break;
+  }
+
+  if(hasBytes)
+    setBytes(bytesView.data(), bytesView.size());
+
+  return ok ? data : nullptr;
+}
+
+void Props::appendBinary(QByteArray& buffer) const
+{
+  qsizetype countPos = buffer.size();
+  propbin::append(buffer, static_cast<propsSizeType>(0));
+
+  // Typical property is key, type and up to eight bytes
+  buffer.reserve(buffer.size() + size() * 10);
+
+  int count = 0;
+  for(auto it = constBegin(); it != constEnd() && count < MAX_PROPS_SIZE; ++it)
+  {
+    if(it.value().isValid())
+    {
+      it.value().appendBinary(buffer);
+      count++;
+    }
+  }
+
+  // Update count at start
+  qToLittleEndian(static_cast<propsSizeType>(count), buffer.data() + countPos);
+}
+
+qsizetype Props::readBinary(const char *data, qsizetype size)
+{
+  const char *cur = data, *end = data + size;
+  propsSizeType count;
+  if(!propbin::read(cur, end, count))
+    return -1;
+
+  reserve(this->size() + count);
+  for(int i = 0; i < count; i++)
+  {
+    Prop prop;
+    cur = prop.readBinary(cur, end);
+    if(cur == nullptr)
+      return -1;
+
+    insert(prop.getKey(), prop);
+  }
+
+  return cur - data;
+}
+
 Prop::Prop(int keyParam, const QVariant& valueParam)
   : key(keyParam)
 {
@@ -290,12 +543,12 @@ Prop::Prop(int keyParam, const QVariant& valueParam)
       break;
 
     case QMetaType::QString:
-      bytes = valueParam.toString().toUtf8();
+      setBytes(valueParam.toString().toUtf8());
       setTypeForString();
       break;
 
     case QMetaType::QByteArray:
-      bytes = valueParam.toByteArray();
+      setBytes(valueParam.toByteArray());
       setTypeForBytes();
       break;
 
@@ -315,11 +568,40 @@ Prop::Prop(int keyParam, const QVariant& valueParam)
   }
 }
 
+void Prop::setBytes(const QByteArray& value)
+{
+  if(value.size() <= SMALL_BYTES_SIZE)
+    setBytes(value.constData(), value.size());
+  else
+  {
+    // Share data with value
+    smallSize = -1;
+    bytes = value;
+  }
+}
+
+void Prop::setBytes(const char *data, qsizetype size)
+{
+  if(size <= SMALL_BYTES_SIZE)
+  {
+    bytes.clear();
+    smallSize = static_cast<qint8>(size);
+    if(size > 0)
+      std::memcpy(number.small, data, static_cast<size_t>(size));
+  }
+  else
+  {
+    smallSize = -1;
+    bytes = QByteArray(data, size);
+  }
+}
+
 void Prop::setTypeForBytes()
 {
-  if(bytes.size() <= std::numeric_limits<qint8>::max())
+  qsizetype size = getValueBytesView().size();
+  if(size <= std::numeric_limits<qint8>::max())
     type = BYTES8;
-  else if(bytes.size() <= std::numeric_limits<qint16>::max())
+  else if(size <= std::numeric_limits<qint16>::max())
     type = BYTES16;
   else
     type = BYTES32;
@@ -327,9 +609,10 @@ void Prop::setTypeForBytes()
 
 void Prop::setTypeForString()
 {
-  if(bytes.size() <= std::numeric_limits<qint8>::max())
+  qsizetype size = getValueBytesView().size();
+  if(size <= std::numeric_limits<qint8>::max())
     type = STRING8;
-  else if(bytes.size() <= std::numeric_limits<qint16>::max())
+  else if(size <= std::numeric_limits<qint16>::max())
     type = STRING16;
   else
     type = STRING32;
@@ -387,7 +670,11 @@ bool Prop::operator==(const Prop& other) const
       case atools::util::BYTES16:
       case atools::util::STRING32:
       case atools::util::BYTES32:
-        return bytes == other.bytes;
+        {
+          QByteArrayView view = getValueBytesView(), otherView = other.getValueBytesView();
+          return view.size() == otherView.size() &&
+                 (view.isEmpty() || std::memcmp(view.data(), otherView.data(), static_cast<size_t>(view.size())) == 0);
+        }
 
       case atools::util::NONE:
       case atools::util::INVALID:
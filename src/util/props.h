@@ -21,6 +21,7 @@
 #include <QMultiHash>
 #include <QList>
 #include <QDataStream>
+#include <QByteArrayView>
 
 class QVariant;
 
@@ -63,6 +64,7 @@ enum PropType : quint8
  * Key is an integer and should be defined by the user in an enumeration.
  *
  * Limitation for strings and byte arrays are a max of 2^32-1 characters.
+ * Strings and byte arrays up to SMALL_BYTES_SIZE bytes are stored inline without heap allocation.
  *
  * Types and storage size is set internally depending on values.
  *
@@ -71,6 +73,9 @@ enum PropType : quint8
 class Prop
 {
 public:
+  /* Maximum size of strings (UTF-8) and byte arrays which are stored inline */
+  static const int SMALL_BYTES_SIZE = 16;
+
   /* Constructs an invalid value which is not saved to streams. */
   explicit Prop()
     : type(ptinternal::INVALID)
@@ -160,7 +165,7 @@ public:
   explicit Prop(int keyParam, const QString& valueParam)
     : key(keyParam)
   {
-    bytes = valueParam.toUtf8();
+    setBytes(valueParam.toUtf8());
     setTypeForString();
   }
 
@@ -168,7 +173,7 @@ public:
   explicit Prop(int keyParam, const QByteArray& valueParam)
     : key(keyParam)
   {
-    bytes = valueParam;
+    setBytes(valueParam);
     setTypeForBytes();
   }
 
@@ -247,12 +252,18 @@ public:
 
   QString getValueString() const
   {
-    return QString(bytes);
+    return QString::fromUtf8(getValueBytesView());
   }
 
   QByteArray getValueBytes() const
   {
-    return bytes;
+    return smallSize >= 0 ? QByteArray(number.small, smallSize) : bytes;
+  }
+
+  /* Bytes of string (UTF-8) or byte array values without copying. Valid as long as this object is not modified. */
+  QByteArrayView getValueBytesView() const
+  {
+    return smallSize >= 0 ? QByteArrayView(number.small, smallSize) : QByteArrayView(bytes);
   }
 
   /* false for default constructed property values */
@@ -262,10 +273,22 @@ public:
   }
 
 private:
+  friend class Props;
+
   void setTypeForInt();
   void setTypeForBytes();
   void setTypeForString();
 
+  /* Copy into inline buffer if small enough or share array otherwise */
+  void setBytes(const QByteArray& value);
+  void setBytes(const char *data, qsizetype size);
+
+  /* Little endian binary layout used by Props::appendBinary() and Props::readBinary() */
+  void appendBinary(QByteArray& buffer) const;
+
+  /* Returns pointer behind the property or null if data is truncated or contains an unknown type */
+  const char *readBinary(const char *data, const char *end);
+
   template<typename TYPE>
   static void readIntType(QDataStream& in, Prop& prop);
 
@@ -283,15 +306,19 @@ private:
   /* Value type */
   ptinternal::PropType type;
 
-  /* Union for all integral data types */
+  /* Union for all integral data types and inline storage for short strings and bytes */
   union
   {
     long long value;
     float floatValue;
     double doubleValue;
+    char small[SMALL_BYTES_SIZE];
   } number;
 
-  /* Byte array for string and bytes */
+  /* Size of string or bytes in number.small or -1 if bytes is used */
+  qint8 smallSize = -1;
+
+  /* Byte array for longer string and bytes */
   QByteArray bytes;
 };
 
@@ -343,6 +370,27 @@ public:
       insert(prop.getKey(), prop);
   }
 
+  /* Appends all valid properties to buffer using a fixed little endian layout which is cheaper to pack
+   * and unpack than QDataStream. Layout is quint16 count followed by key, type and value of each property.
+   * Not compatible with the QDataStream operators. */
+  void appendBinary(QByteArray& buffer) const;
+
+  QByteArray toBinary() const
+  {
+    QByteArray buffer;
+    appendBinary(buffer);
+    return buffer;
+  }
+
+  /* Reads properties written by appendBinary() and adds them to this.
+   * Returns number of bytes consumed or -1 if data is truncated or invalid. */
+  qsizetype readBinary(const char *data, qsizetype size);
+
+  qsizetype readBinary(const QByteArray& data)
+  {
+    return readBinary(data.constData(), data.size());
+  }
+
 private:
   friend QDataStream& operator<<(QDataStream& out, const atools::util::Props& props);
   friend QDataStream& operator>>(QDataStream& in, atools::util::Props& props);
@@ -364,8 +412,18 @@ void Prop::readBytesType(QDataStream& in, Prop& prop)
 {
   TYPE size;
   in >> size;
-  prop.bytes.resize(size);
-  in.readRawData(prop.bytes.data(), size);
+  if(size <= SMALL_BYTES_SIZE)
+  {
+    prop.bytes.clear();
+    prop.smallSize = static_cast<qint8>(size);
+    in.readRawData(prop.number.small, size);
+  }
+  else
+  {
+    prop.smallSize = -1;
+    prop.bytes.resize(size);
+    in.readRawData(prop.bytes.data(), size);
+  }
 }
 
 } // namespace util
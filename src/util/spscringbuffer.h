@@ -0,0 +1,121 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_UTIL_SPSCRINGBUFFER_H
+#define ATOOLS_UTIL_SPSCRINGBUFFER_H
+
+#include <QtGlobal>
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+
+namespace atools {
+namespace util {
+
+/*
+ * Bounded lock free ring buffer for exactly one producer and one consumer thread.
+ *
+ * push() never blocks and returns false if the buffer is full. The consumer takes all available
+ * values at once using consume(). T has to be default constructible and copy assignable.
+ */
+template<typename T>
+class SpscRingBuffer
+{
+public:
+  /* Capacity is rounded up to the next power of two */
+  explicit SpscRingBuffer(int capacity)
+  {
+    quint64 size = 2;
+    while(size < static_cast<quint64>(capacity))
+      size <<= 1;
+
+    ring = new T[size];
+    mask = size - 1;
+  }
+
+  ~SpscRingBuffer()
+  {
+    delete[] ring;
+  }
+
+  SpscRingBuffer(const SpscRingBuffer& other) = delete;
+  SpscRingBuffer& operator=(const SpscRingBuffer& other) = delete;
+
+  /* Append a value. Producer thread only. Returns false if the buffer is full and the value was dropped. */
+  bool push(const T& value)
+  {
+    quint64 head = headPos.load(std::memory_order_relaxed);
+    if(head - tailPos.load(std::memory_order_acquire) > mask)
+      return false;
+
+    ring[head & mask] = value;
+    headPos.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /* Call func for up to maxNum available values in order and remove them. Consumer thread only.
+   * Returns number of values consumed. */
+  template<typename FUNC>
+  int consume(FUNC func, int maxNum = std::numeric_limits<int>::max())
+  {
+    quint64 tail = tailPos.load(std::memory_order_relaxed);
+    quint64 num = std::min(headPos.load(std::memory_order_acquire) - tail, static_cast<quint64>(maxNum));
+
+    for(quint64 i = 0; i < num; i++)
+      func(static_cast<const T&>(ring[(tail + i) & mask]));
+
+    // Release slots to producer once for the whole batch
+    tailPos.store(tail + num, std::memory_order_release);
+    return static_cast<int>(num);
+  }
+
+  /* Remove all values. Consumer thread only. */
+  void clear()
+  {
+    tailPos.store(headPos.load(std::memory_order_acquire), std::memory_order_release);
+  }
+
+  /* Approximate number of values if called while other threads work on the buffer */
+  int size() const
+  {
+    return static_cast<int>(headPos.load(std::memory_order_acquire) - tailPos.load(std::memory_order_acquire));
+  }
+
+  bool isEmpty() const
+  {
+    return size() == 0;
+  }
+
+  int capacity() const
+  {
+    return static_cast<int>(mask + 1);
+  }
+
+private:
+  T *ring;
+  quint64 mask;
+
+  /* Written by producer and consumer only. Separate cache lines avoid false sharing. */
+  alignas(64) std::atomic<quint64> headPos {0};
+  alignas(64) std::atomic<quint64> tailPos {0};
+};
+
+} // namespace util
+} // namespace atools
+
+#endif // ATOOLS_UTIL_SPSCRINGBUFFER_H
@@ -0,0 +1,115 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "util/stringpool.h"
+
+namespace atools {
+namespace util {
+
+StringPool::StringPool()
+{
+  clear();
+}
+
+StringPool::Handle StringPool::intern(const QString& str)
+{
+  if(str.isEmpty())
+    return EMPTY;
+
+  {
+    // Most strings are already in the pool - try with shared lock first
+    QReadLocker locker(&lock);
+    auto it = handles.constFind(str);
+    if(it != handles.constEnd())
+      return it.value();
+  }
+
+  QWriteLocker locker(&lock);
+  return insert(str);
+}
+
+StringPool::Handle StringPool::find(const QString& str) const
+{
+  if(str.isEmpty())
+    return EMPTY;
+
+  QReadLocker locker(&lock);
+  return handles.value(str, INVALID);
+}
+
+QString StringPool::string(Handle handle) const
+{
+  QReadLocker locker(&lock);
+  return handle < static_cast<Handle>(strings.size()) ? strings.at(handle) : QString();
+}
+
+QString StringPool::shared(const QString& str)
+{
+  if(str.isEmpty())
+    return QString();
+
+  {
+    QReadLocker locker(&lock);
+    auto it = handles.constFind(str);
+    if(it != handles.constEnd())
+      return strings.at(it.value());
+  }
+
+  QWriteLocker locker(&lock);
+  return strings.at(insert(str));
+}
+
+int StringPool::size() const
+{
+  QReadLocker locker(&lock);
+  return static_cast<int>(strings.size());
+}
+
+void StringPool::clear()
+{
+  QWriteLocker locker(&lock);
+  handles.clear();
+  strings.clear();
+
+  // Reserve handle 0 for the empty string
+  strings.append(QString());
+}
+
+StringPool::Handle StringPool::insert(const QString& str)
+{
+  // Check again since another thread might have added it between read and write lock
+  auto it = handles.constFind(str);
+  if(it != handles.constEnd())
+    return it.value();
+
+  Handle handle = static_cast<Handle>(strings.size());
+
+  // Detach from any larger buffer the string might be part of and drop unused capacity
+  QString copy(str.constData(), str.size());
+  strings.append(copy);
+  handles.insert(copy, handle);
+  return handle;
+}
+
+StringPool& StringPool::global()
+{
+  static StringPool pool;
+  return pool;
+}
+
+} // namespace util
+} // namespace atools
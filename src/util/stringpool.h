@@ -0,0 +1,90 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_UTIL_STRINGPOOL_H
+#define ATOOLS_UTIL_STRINGPOOL_H
+
+#include <QHash>
+#include <QList>
+#include <QReadWriteLock>
+#include <QString>
+
+#include <limits>
+
+namespace atools {
+namespace util {
+
+/*
+ * Interning pool for strings which are repeated many times like idents, region codes and airway names.
+ *
+ * Each distinct string is stored once and gets a compact integer handle. Handles can be compared and hashed
+ * instead of strings. shared() returns an implicitly shared copy of the pooled string which avoids
+ * keeping a separate buffer for each occurrence.
+ *
+ * Handles are only valid for the pool which created them. Handle 0 is the empty string.
+ * All methods are thread safe. Use global() or a separate pool per database compilation.
+ */
+class StringPool
+{
+public:
+  typedef quint32 Handle;
+
+  /* Handle for null or empty strings */
+  static const Handle EMPTY = 0;
+
+  /* Returned by find() if the string was not interned */
+  static const Handle INVALID = std::numeric_limits<Handle>::max();
+
+  StringPool();
+
+  StringPool(const StringPool& other) = delete;
+  StringPool& operator=(const StringPool& other) = delete;
+
+  /* Get handle for string and add it to the pool if needed */
+  Handle intern(const QString& str);
+
+  /* Get handle for string or INVALID if not in pool. Does not modify the pool. */
+  Handle find(const QString& str) const;
+
+  /* Get string for handle. Returns an empty string for invalid handles. */
+  QString string(Handle handle) const;
+
+  /* Get the pooled instance for the string which shares memory with all other instances */
+  QString shared(const QString& str);
+
+  /* Number of distinct strings including the empty string */
+  int size() const;
+
+  /* Removes all strings. All handles are invalid afterwards. */
+  void clear();
+
+  /* Pool shared by the whole application. Never cleared automatically. */
+  static StringPool& global();
+
+private:
+  /* Add string to pool. Needs write lock. */
+  Handle insert(const QString& str);
+
+  QHash<QString, Handle> handles;
+  QList<QString> strings;
+  mutable QReadWriteLock lock;
+};
+
+} // namespace util
+} // namespace atools
+
+#endif // ATOOLS_UTIL_STRINGPOOL_H
@@ -18,18 +18,30 @@
 #ifndef ATOOLS_UTIL_TIMEDCACHE_H
 #define ATOOLS_UTIL_TIMEDCACHE_H
 
-#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <list>
 
 namespace atools {
 namespace util {
 
-/* Simple hash that removes entries on timeout when they are accessed */
+/*
+ * Simple hash that removes entries on timeout when they are accessed.
+ *
+ * Timestamps use a monotonic clock which is cheap to read and not affected by changes of system time.
+ * Optionally bounded by number of entries. The least recently used entry is removed if the limit is exceeded.
+ */
 template<typename KEY, typename TYPE>
 class TimedCache
 {
 public:
-  TimedCache(int timeoutSeconds)
-    : timeout(timeoutSeconds)
+  /* maxEntries is the LRU size limit. 0 for unbounded. */
+  TimedCache(int timeoutSeconds, int maxEntries = 0)
+    : timeoutMs(timeoutSeconds * 1000LL), maxSize(maxEntries)
   {
   }
 
@@ -51,9 +63,10 @@ public:
   void clear()
   {
     hash.clear();
+    lru.clear();
   }
 
-  /* true if object is old. does not modify cache */
+  /* true if object is old or not in cache. does not modify cache */
   bool isTimedOut(const KEY& key) const;
 
   /* Flush from cache if old. true if timed out */
@@ -75,49 +88,92 @@ public:
 
   int size() const
   {
-    return hash.size();
+    return static_cast<int>(hash.size());
+  }
+
+  /* Milliseconds from monotonic clock */
+  static qint64 nowMs()
+  {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
   }
 
 private:
   struct Entry
   {
     TYPE value;
-    QDateTime timestamp;
+    qint64 timestampMs;
+
+    /* Position in LRU list */
+    typename std::list<KEY>::iterator lruPos;
   };
 
   TYPE *checkTimeout(const KEY& key);
 
+  /* Move entry to front of LRU list */
+  void touch(Entry& entry)
+  {
+    lru.splice(lru.begin(), lru, entry.lruPos);
+  }
+
   QHash<KEY, Entry> hash;
-  int timeout;
+
+  /* Keys with most recently used first */
+  std::list<KEY> lru;
+  qint64 timeoutMs;
+  int maxSize;
 };
 
 template<typename KEY, typename TYPE>
 void TimedCache<KEY, TYPE>::insert(const KEY& key, const TYPE& type)
 {
-  hash.insert(key, {type, QDateTime::currentDateTime()});
+  auto it = hash.find(key);
+  if(it != hash.end())
+  {
+    it->value = type;
+    it->timestampMs = nowMs();
+    touch(*it);
+  }
+  else
+  {
+    lru.push_front(key);
+    hash.insert(key, {type, nowMs(), lru.begin()});
+
+    // Remove least recently used
+    if(maxSize > 0 && hash.size() > maxSize)
+    {
+      hash.remove(lru.back());
+      lru.pop_back();
+    }
+  }
 }
 
 template<typename KEY, typename TYPE>
 TYPE *TimedCache<KEY, TYPE>::checkTimeout(const KEY& key)
 {
-  if(!hash.contains(key))
+  auto it = hash.find(key);
+  if(it == hash.end())
     return nullptr;
   else
   {
-    if(isTimedOut(key))
+    if(it->timestampMs + timeoutMs < nowMs())
     {
-      hash.remove(key);
+      lru.erase(it->lruPos);
+      hash.erase(it);
       return nullptr;
     }
     else
-      return &hash[key].value;
+    {
+      touch(*it);
+      return &it->value;
+    }
   }
 }
 
 template<typename KEY, typename TYPE>
 bool TimedCache<KEY, TYPE>::isTimedOut(const KEY& key) const
 {
-  return hash.value(key).timestamp.addSecs(timeout) < QDateTime::currentDateTime();
+  auto it = hash.constFind(key);
+  return it == hash.constEnd() || it->timestampMs + timeoutMs < nowMs();
 }
 
 template<typename KEY, typename TYPE>
@@ -129,8 +185,9 @@ bool TimedCache<KEY, TYPE>::timeOut(const KEY& key)
 template<typename KEY, typename TYPE>
 TYPE *TimedCache<KEY, TYPE>::valueNoTimeout(const KEY& key)
 {
-  if(containsNoTimeout(key))
-    return &hash[key].value;
+  auto it = hash.find(key);
+  if(it != hash.end())
+    return &it->value;
   else
     return nullptr;
 }
@@ -149,9 +206,111 @@ TYPE TimedCache<KEY, TYPE>::valueCopyAndTimeout(const KEY& key)
 template<typename KEY, typename TYPE>
 void TimedCache<KEY, TYPE>::remove(const KEY& key)
 {
-  hash.remove(key);
+  auto it = hash.find(key);
+  if(it != hash.end())
+  {
+    lru.erase(it->lruPos);
+    hash.erase(it);
+  }
 }
 
+/*
+ * Thread safe variant of TimedCache. Keys are distributed over SHARDS caches with one mutex each
+ * to reduce lock contention. Values are returned as copies since pointers are not valid outside of the lock.
+ * The LRU size limit is applied per shard.
+ */
+template<typename KEY, typename TYPE, int SHARDS = 16>
+class ShardedTimedCache
+{
+public:
+  /* maxEntries is the total size limit which is divided between shards. 0 for unbounded. */
+  ShardedTimedCache(int timeoutSeconds, int maxEntries = 0)
+  {
+    for(int i = 0; i < SHARDS; i++)
+      shards[static_cast<size_t>(i)] = new Shard(timeoutSeconds, maxEntries > 0 ? std::max(maxEntries / SHARDS, 1) : 0);
+  }
+
+  ~ShardedTimedCache()
+  {
+    qDeleteAll(shards);
+  }
+
+  ShardedTimedCache(const ShardedTimedCache& other) = delete;
+  ShardedTimedCache& operator=(const ShardedTimedCache& other) = delete;
+
+  void insert(const KEY& key, const TYPE& type)
+  {
+    Shard *shard = shardFor(key);
+    QMutexLocker locker(&shard->mutex);
+    shard->cache.insert(key, type);
+  }
+
+  /* Copy value to result and return true if found and not timed out. Timed out entries are removed. */
+  bool value(const KEY& key, TYPE& result)
+  {
+    Shard *shard = shardFor(key);
+    QMutexLocker locker(&shard->mutex);
+    TYPE *ptr = shard->cache.value(key);
+    if(ptr != nullptr)
+      result = *ptr;
+    return ptr != nullptr;
+  }
+
+  bool contains(const KEY& key)
+  {
+    Shard *shard = shardFor(key);
+    QMutexLocker locker(&shard->mutex);
+    return shard->cache.contains(key);
+  }
+
+  void remove(const KEY& key)
+  {
+    Shard *shard = shardFor(key);
+    QMutexLocker locker(&shard->mutex);
+    shard->cache.remove(key);
+  }
+
+  void clear()
+  {
+    for(Shard *shard : shards)
+    {
+      QMutexLocker locker(&shard->mutex);
+      shard->cache.clear();
+    }
+  }
+
+  int size() const
+  {
+    int num = 0;
+    for(Shard *shard : shards)
+    {
+      QMutexLocker locker(&shard->mutex);
+      num += shard->cache.size();
+    }
+    return num;
+  }
+
+private:
+  struct Shard
+  {
+    Shard(int timeoutSeconds, int maxEntries)
+      : cache(timeoutSeconds, maxEntries)
+    {
+    }
+
+    mutable QMutex mutex;
+    TimedCache<KEY, TYPE> cache;
+  };
+
+  Shard *shardFor(const KEY& key) const
+  {
+    return shards[static_cast<size_t>(qHash(key) % static_cast<size_t>(SHARDS))];
+  }
+
+  /* Allocated separately to avoid false sharing of mutexes */
+  std::array<Shard *, SHARDS> shards;
+};
+
 } // namespace util
 } // namespace atools
 
@@ -0,0 +1,211 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "util/tracer.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QMutex>
+#include <QSaveFile>
+#include <QThread>
+
+#include <chrono>
+
+namespace atools {
+namespace util {
+
+namespace tracer {
+
+struct Event
+{
+  const char *name, *category;
+  qint64 startUs, durationUs;
+  QString dynamicName, detail;
+};
+
+/* Event buffer of one thread. Never deleted since the thread local pointer might still refer to it. */
+struct ThreadBuffer
+{
+  QMutex mutex;
+  QList<Event> events;
+  QString threadName;
+  quint64 threadId = 0;
+  qint64 dropped = 0;
+};
+
+/* All buffers ever created guarded by buffersMutex */
+static QList<ThreadBuffer *> buffers;
+static QMutex buffersMutex;
+static std::atomic_int maxEventsPerThread(1000000);
+
+static ThreadBuffer *threadBuffer()
+{
+  thread_local ThreadBuffer *buffer = nullptr;
+  if(buffer == nullptr)
+  {
+    buffer = new ThreadBuffer;
+    QThread *thread = QThread::currentThread();
+    buffer->threadName = thread != nullptr ? thread->objectName() : QString();
+
+    QMutexLocker locker(&buffersMutex);
+    buffer->threadId = static_cast<quint64>(buffers.size()) + 1;
+    if(buffer->threadName.isEmpty())
+      buffer->threadName = QStringLiteral("Thread %1").arg(buffer->threadId);
+    buffers.append(buffer);
+  }
+  return buffer;
+}
+
+/* Quote and escape string for JSON */
+static QByteArray jsonString(const QString& str)
+{
+  QByteArray result("\"");
+  for(QChar c : str)
+  {
+    if(c == '"')
+      result.append("\\\"");
+    else if(c == '\\')
+      result.append("\\\\");
+    else if(c.unicode() < 0x20)
+      result.append(QStringLiteral("\\u%1").arg(c.unicode(), 4, 16, QChar('0')).toLatin1());
+    else
+      result.append(QString(c).toUtf8());
+  }
+  result.append('"');
+  return result;
+}
+
+} // namespace tracer
+
+std::atomic_bool Tracer::enabled(false);
+
+void Tracer::setEnabled(bool value)
+{
+  enabled.store(value);
+}
+
+qint64 Tracer::timestampUs()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Tracer::addEvent(const char *name, const char *category, qint64 startUs, qint64 durationUs,
+                      const QString& dynamicName, const QString& detail)
+{
+  tracer::ThreadBuffer *buffer = tracer::threadBuffer();
+  QMutexLocker locker(&buffer->mutex);
+  if(buffer->events.size() < tracer::maxEventsPerThread.load())
+    buffer->events.append(tracer::Event{name, category, startUs, durationUs, dynamicName, detail});
+  else
+    buffer->dropped++;
+}
+
+void Tracer::clear()
+{
+  QMutexLocker locker(&tracer::buffersMutex);
+  for(tracer::ThreadBuffer *buffer : std::as_const(tracer::buffers))
+  {
+    QMutexLocker bufferLocker(&buffer->mutex);
+    buffer->events.clear();
+    buffer->dropped = 0;
+  }
+}
+
+qint64 Tracer::getNumEvents()
+{
+  qint64 num = 0;
+  QMutexLocker locker(&tracer::buffersMutex);
+  for(tracer::ThreadBuffer *buffer : std::as_const(tracer::buffers))
+  {
+    QMutexLocker bufferLocker(&buffer->mutex);
+    num += buffer->events.size();
+  }
+  return num;
+}
+
+void Tracer::setMaxEventsPerThread(int value)
+{
+  tracer::maxEventsPerThread.store(value);
+}
+
+bool Tracer::writeChromeTrace(const QString& filename)
+{
+  QSaveFile file(filename);
+  if(!file.open(QIODevice::WriteOnly))
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot open" << filename << file.errorString();
+    return false;
+  }
+
+  const QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+  qint64 numEvents = 0, numDropped = 0;
+  bool first = true;
+
+  file.write("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+  QMutexLocker locker(&tracer::buffersMutex);
+  for(tracer::ThreadBuffer *buffer : std::as_const(tracer::buffers))
+  {
+    // Copy events to keep the lock short for the recording thread
+    QList<tracer::Event> events;
+    {
+      QMutexLocker bufferLocker(&buffer->mutex);
+      events = buffer->events;
+      numDropped += buffer->dropped;
+    }
+
+    const QByteArray tid = QByteArray::number(buffer->threadId);
+
+    // Metadata event for thread name
+    if(!first)
+      file.write(",\n");
+    first = false;
+    file.write("{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" + pid + ",\"tid\":" + tid +
+               ",\"args\":{\"name\":" + tracer::jsonString(buffer->threadName) + "}}");
+
+    // Complete events with duration
+    for(const tracer::Event& event : std::as_const(events))
+    {
+      QByteArray line(",\n{\"ph\":\"X\",\"name\":");
+      line.append(tracer::jsonString(event.dynamicName.isEmpty() ? QString::fromUtf8(event.name) : event.dynamicName));
+      line.append(",\"cat\":\"").append(event.category).append('"');
+      line.append(",\"ts\":").append(QByteArray::number(event.startUs));
+      line.append(",\"dur\":").append(QByteArray::number(event.durationUs));
+      line.append(",\"pid\":").append(pid).append(",\"tid\":").append(tid);
+      if(!event.detail.isEmpty())
+        line.append(",\"args\":{\"detail\":").append(tracer::jsonString(event.detail)).append('}');
+      line.append('}');
+      file.write(line);
+    }
+    numEvents += events.size();
+  }
+  locker.unlock();
+
+  file.write("\n]}\n");
+
+  if(!file.commit())
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot write" << filename << file.errorString();
+    return false;
+  }
+
+  qInfo() << Q_FUNC_INFO << "Wrote" << numEvents << "events to" << filename << "dropped" << numDropped;
+  return true;
+}
+
+} // namespace util
+} // namespace atools
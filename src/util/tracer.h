@@ -0,0 +1,128 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_UTIL_TRACER_H
+#define ATOOLS_UTIL_TRACER_H
+
+#include <QString>
+
+#include <atomic>
+
+namespace atools {
+namespace util {
+
+/*
+ * Collects timed spans of hot paths and writes them as Chrome trace event JSON which can be loaded into
+ * chrome://tracing or ui.perfetto.dev to inspect timelines of database compilation or requests.
+ *
+ * Each thread records into its own buffer which is locked only by the owning thread and while writing the file.
+ * Recording is off by default. A disabled span costs one relaxed atomic load.
+ *
+ * Usage:
+ * atools::util::Tracer::setEnabled(true);
+ * { ATOOLS_TRACE_SPAN("RouteFinder::calculateRoute"); ... }
+ * { ATOOLS_TRACE_SPAN_DETAIL("BglFile::readFile", filename); ... } // detail is evaluated only if enabled
+ * atools::util::Tracer::writeChromeTrace("trace.json");
+ */
+class Tracer
+{
+public:
+  /* Start or stop recording. Recorded events are kept until clear() is called. */
+  static void setEnabled(bool value);
+
+  static bool isEnabled()
+  {
+    return enabled.load(std::memory_order_relaxed);
+  }
+
+  /* Microseconds of a monotonic clock */
+  static qint64 timestampUs();
+
+  /* Add a finished span to the buffer of the calling thread. name and category have to be static strings.
+   * dynamicName replaces name if not empty. */
+  static void addEvent(const char *name, const char *category, qint64 startUs, qint64 durationUs,
+                       const QString& dynamicName = QString(), const QString& detail = QString());
+
+  /* Remove all recorded events from all threads */
+  static void clear();
+
+  /* Number of recorded events in all threads */
+  static qint64 getNumEvents();
+
+  /* Write all recorded events to a JSON file in Chrome trace event format. Recording can continue.
+   * Returns false on error. */
+  static bool writeChromeTrace(const QString& filename);
+
+  /* Maximum number of events per thread. Further events are dropped. Default is one million. */
+  static void setMaxEventsPerThread(int value);
+
+private:
+  static std::atomic_bool enabled;
+};
+
+/* Records the time from construction to destruction as a span if tracing was enabled on construction */
+class TraceSpan
+{
+public:
+  explicit TraceSpan(const char *nameParam, const char *categoryParam = "atools")
+    : name(nameParam), category(categoryParam), startUs(Tracer::isEnabled() ? Tracer::timestampUs() : -1)
+  {
+  }
+
+  ~TraceSpan()
+  {
+    if(startUs >= 0)
+      Tracer::addEvent(name, category, startUs, Tracer::timestampUs() - startUs, QString(), detail);
+  }
+
+  TraceSpan(const TraceSpan& other) = delete;
+  TraceSpan& operator=(const TraceSpan& other) = delete;
+
+  /* true if the span is recorded */
+  bool isActive() const
+  {
+    return startUs >= 0;
+  }
+
+  /* Additional information like a filename shown as argument of the event */
+  void setDetail(const QString& value)
+  {
+    detail = value;
+  }
+
+private:
+  const char *name, *category;
+  qint64 startUs;
+  QString detail;
+};
+
+} // namespace util
+} // namespace atools
+
+#define ATOOLS_TRACE_CONCAT_INTERNAL(a, b) a ## b
+#define ATOOLS_TRACE_CONCAT(a, b) ATOOLS_TRACE_CONCAT_INTERNAL(a, b)
+
+/* Span covering the rest of the current scope */
+#define ATOOLS_TRACE_SPAN(name) atools::util::TraceSpan ATOOLS_TRACE_CONCAT(traceSpan, __LINE__)(name)
+
+/* As above with a detail string which is only evaluated if tracing is enabled */
+#define ATOOLS_TRACE_SPAN_DETAIL(name, detail) \
+  atools::util::TraceSpan ATOOLS_TRACE_CONCAT(traceSpan, __LINE__)(name); \
+  if(ATOOLS_TRACE_CONCAT(traceSpan, __LINE__).isActive()) \
+    ATOOLS_TRACE_CONCAT(traceSpan, __LINE__).setDetail(detail)
+
+#endif // ATOOLS_UTIL_TRACER_H
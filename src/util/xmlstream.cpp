@@ -55,9 +55,9 @@ XmlStream::~XmlStream()
   delete reader;
 }
 
-void XmlStream::readUntilElement(const QString& name)
+void XmlStream::readUntilElement(QAnyStringView name)
 {
-  while(reader->name() != name)
+  while(QAnyStringView(reader->name()) != name)
     readNextStartElement();
 }
 
@@ -96,23 +96,81 @@ void XmlStream::skipCurrentElement(bool warning)
   reader->skipCurrentElement();
 }
 
-bool XmlStream::readElementTextBool()
+bool XmlStream::parseBool(QStringView text, bool& ok)
 {
-  QString str = reader->readElementText().simplified().toLower();
-  if(str == "yes" || str == "true" || str == "y" || str == "t" || str == "1")
-    return true;
-  else if(str == "no" || str == "false" || str == "n" || str == "f" || str == "0")
-    return false;
+  static const QLatin1String TRUE_VALUES[] = {QLatin1String("yes"), QLatin1String("true"), QLatin1String("y"),
+                                              QLatin1String("t"), QLatin1String("1")};
+  static const QLatin1String FALSE_VALUES[] = {QLatin1String("no"), QLatin1String("false"), QLatin1String("n"),
+                                               QLatin1String("f"), QLatin1String("0")};
+  ok = true;
+  for(QLatin1String value : TRUE_VALUES)
+  {
+    if(text.compare(value, Qt::CaseInsensitive) == 0)
+      return true;
+  }
+
+  for(QLatin1String value : FALSE_VALUES)
+  {
+    if(text.compare(value, Qt::CaseInsensitive) == 0)
+      return false;
+  }
 
-  qWarning() << Q_FUNC_INFO << "Reading of bool value failed. File"
-             << filename << "element" << reader->name() << "line" << reader->lineNumber();
+  ok = false;
   return false;
 }
 
+QStringView XmlStream::readElementTextView()
+{
+  // Keep capacity of buffer to avoid allocations
+  textBuffer.resize(0);
+
+  if(!reader->isStartElement())
+  {
+    qWarning() << Q_FUNC_INFO << "Not at start element. File" << filename << "line" << reader->lineNumber();
+    return textBuffer;
+  }
+
+  while(!reader->atEnd())
+  {
+    switch(reader->readNext())
+    {
+      case QXmlStreamReader::Characters:
+      case QXmlStreamReader::EntityReference:
+        // Text view is valid until next read - copy into buffer
+        textBuffer.append(reader->text());
+        break;
+
+      case QXmlStreamReader::StartElement:
+        // Skip unexpected nested elements
+        reader->skipCurrentElement();
+        break;
+
+      case QXmlStreamReader::EndElement:
+        return textBuffer;
+
+      default:
+        // Comments and processing instructions
+        break;
+    }
+  }
+  return textBuffer;
+}
+
+bool XmlStream::readElementTextBool()
+{
+  bool ok;
+  bool retval = parseBool(readElementTextView().trimmed(), ok);
+
+  if(!ok)
+    qWarning() << Q_FUNC_INFO << "Reading of bool value failed. File"
+               << filename << "element" << reader->name() << "line" << reader->lineNumber();
+  return retval;
+}
+
 int XmlStream::readElementTextInt()
 {
   bool ok;
-  int retval = reader->readElementText().toInt(&ok);
+  int retval = readElementTextView().toInt(&ok);
 
   if(!ok)
     qWarning() << Q_FUNC_INFO << "Reading of int value failed. File"
@@ -124,7 +182,7 @@ int XmlStream::readElementTextInt()
 float XmlStream::readElementTextFloat()
 {
   bool ok;
-  float retval = reader->readElementText().toFloat(&ok);
+  float retval = readElementTextView().toFloat(&ok);
 
   if(!ok)
     qWarning() << Q_FUNC_INFO << "Reading of float value failed. File"
@@ -132,35 +190,64 @@ float XmlStream::readElementTextFloat()
   return retval;
 }
 
-bool XmlStream::readAttributeBool(const QString& name, bool defaultValue)
+double XmlStream::readElementTextDouble()
+{
+  bool ok;
+  double retval = readElementTextView().toDouble(&ok);
+
+  if(!ok)
+    qWarning() << Q_FUNC_INFO << "Reading of double value failed. File"
+               << filename << "element" << reader->name() << "line" << reader->lineNumber();
+  return retval;
+}
+
+const QXmlStreamAttribute *XmlStream::findAttribute(const QXmlStreamAttributes& attributes, QAnyStringView name)
 {
-  if(reader->attributes().hasAttribute(name))
+  for(const QXmlStreamAttribute& attribute : attributes)
   {
-    QString str = reader->attributes().value(name).toString();
-    if(str == "yes" || str == "true" || str == "y" || str == "t" || str == "1")
-      return true;
-    else if(str == "no" || str == "false" || str == "n" || str == "f" || str == "0")
-      return false;
+    if(attribute.qualifiedName() == name)
+      return &attribute;
+  }
+  return nullptr;
+}
 
-    qWarning() << Q_FUNC_INFO << "Reading of bool value failed. File"
-               << filename << "element" << reader->name() << "attribute" << name << "line" << reader->lineNumber();
-    return defaultValue;
+bool XmlStream::readAttributeBool(QAnyStringView name, bool defaultValue)
+{
+  // Copy attributes only once - returned by value
+  const QXmlStreamAttributes attributes = reader->attributes();
+  const QXmlStreamAttribute *attribute = findAttribute(attributes, name);
+  if(attribute != nullptr)
+  {
+    bool ok;
+    bool value = parseBool(attribute->value(), ok);
+
+    if(!ok)
+    {
+      qWarning() << Q_FUNC_INFO << "Reading of bool value failed. File"
+                 << filename << "element" << reader->name() << "attribute" << name.toString()
+                 << "line" << reader->lineNumber();
+      return defaultValue;
+    }
+    return value;
   }
   else
     return defaultValue;
 }
 
-int XmlStream::readAttributeInt(const QString& name, int defaultValue)
+int XmlStream::readAttributeInt(QAnyStringView name, int defaultValue)
 {
-  if(reader->attributes().hasAttribute(name))
+  const QXmlStreamAttributes attributes = reader->attributes();
+  const QXmlStreamAttribute *attribute = findAttribute(attributes, name);
+  if(attribute != nullptr)
   {
     bool ok;
-    int value = reader->attributes().value(name).toInt(&ok);
+    int value = attribute->value().toInt(&ok);
 
     if(!ok)
     {
       qWarning() << Q_FUNC_INFO << "Reading of int value failed. File"
-                 << filename << "element" << reader->name() << "attribute" << name << "line" << reader->lineNumber();
+                 << filename << "element" << reader->name() << "attribute" << name.toString()
+                 << "line" << reader->lineNumber();
 
       return defaultValue;
     }
@@ -170,17 +257,20 @@ int XmlStream::readAttributeInt(const QString& name, int defaultValue)
     return defaultValue;
 }
 
-float XmlStream::readAttributeFloat(const QString& name, float defaultValue)
+float XmlStream::readAttributeFloat(QAnyStringView name, float defaultValue)
 {
-  if(reader->attributes().hasAttribute(name))
+  const QXmlStreamAttributes attributes = reader->attributes();
+  const QXmlStreamAttribute *attribute = findAttribute(attributes, name);
+  if(attribute != nullptr)
   {
     bool ok;
-    float value = reader->attributes().value(name).toFloat(&ok);
+    float value = attribute->value().toFloat(&ok);
 
     if(!ok)
     {
       qWarning() << Q_FUNC_INFO << "Reading of float value failed. File"
-                 << filename << "element" << reader->name() << "attribute" << name << "line" << reader->lineNumber();
+                 << filename << "element" << reader->name() << "attribute" << name.toString()
+                 << "line" << reader->lineNumber();
 
       return defaultValue;
     }
@@ -190,5 +280,46 @@ float XmlStream::readAttributeFloat(const QString& name, float defaultValue)
     return defaultValue;
 }
 
+double XmlStream::readAttributeDouble(QAnyStringView name, double defaultValue)
+{
+  const QXmlStreamAttributes attributes = reader->attributes();
+  const QXmlStreamAttribute *attribute = findAttribute(attributes, name);
+  if(attribute != nullptr)
+  {
+    bool ok;
+    double value = attribute->value().toDouble(&ok);
+
+    if(!ok)
+    {
+      qWarning() << Q_FUNC_INFO << "Reading of double value failed. File"
+                 << filename << "element" << reader->name() << "attribute" << name.toString()
+                 << "line" << reader->lineNumber();
+
+      return defaultValue;
+    }
+    return value;
+  }
+  else
+    return defaultValue;
+}
+
+int XmlStream::nameIndex(std::initializer_list<QLatin1String> names) const
+{
+  const QStringView name = reader->name();
+  int index = 0;
+  for(QLatin1String n : names)
+  {
+    if(name == n)
+      return index;
+    index++;
+  }
+  return -1;
+}
+
+bool XmlStream::isName(QLatin1String name) const
+{
+  return reader->name() == name;
+}
+
 } // namespace util
 } // namespace atools
@@ -20,7 +20,11 @@
 
 #include <QCoreApplication>
 
+#include <initializer_list>
+
 class QXmlStreamReader;
+class QXmlStreamAttribute;
+class QXmlStreamAttributes;
 class QIODevice;
 
 namespace atools {
@@ -29,6 +33,9 @@ namespace util {
 /*
  * Provides a simple extension to XML stream reader. Methods do error checking and throw exception on error.
  * Initializes a QXmlStreamReader on construction and cannot be copied.
+ *
+ * Number, bool and text view methods parse directly from the reader buffers and do not create
+ * intermediate strings which speeds up loading of large documents.
  */
 class XmlStream
 {
@@ -50,7 +57,7 @@ public:
   XmlStream& operator=(const XmlStream& other) = delete;
 
   /* Read until element with given name. Throws exception in case of error */
-  void readUntilElement(const QString& name);
+  void readUntilElement(QAnyStringView name);
 
   /* Read until next element and checks error. Throws exception in case of error */
   bool readNextStartElement();
@@ -62,11 +69,25 @@ public:
   bool readElementTextBool();
   int readElementTextInt();
   float readElementTextFloat();
+  double readElementTextDouble();
+
+  /* Reads the text of the current element like QXmlStreamReader::readElementText() but returns a view on an
+   * internal buffer which is reused for all calls. The view is valid until the next call.
+   * Reader is positioned at the end element afterwards. Nested elements, comments and processing instructions are skipped. */
+  QStringView readElementTextView();
 
   /* As above for attributes */
-  bool readAttributeBool(const QString& name, bool defaultValue = false);
-  int readAttributeInt(const QString& name, int defaultValue = 0);
-  float readAttributeFloat(const QString& name, float defaultValue = 0.f);
+  bool readAttributeBool(QAnyStringView name, bool defaultValue = false);
+  int readAttributeInt(QAnyStringView name, int defaultValue = 0);
+  float readAttributeFloat(QAnyStringView name, float defaultValue = 0.f);
+  double readAttributeDouble(QAnyStringView name, double defaultValue = 0.);
+
+  /* Index of the current element name in names or -1 if not found.
+   * Allows to use a switch statement on a table of latin1 names which are compared without conversion. */
+  int nameIndex(std::initializer_list<QLatin1String> names) const;
+
+  /* true if current element name is equal to name */
+  bool isName(QLatin1String name) const;
 
   /* Get underlying constructed stream reader */
   QXmlStreamReader& getReader()
@@ -83,9 +104,18 @@ private:
   /* Checks stream for error. Throws exception in case of error */
   void checkError();
 
+  /* Find attribute by qualified name in list. Returns null if not found. */
+  static const QXmlStreamAttribute *findAttribute(const QXmlStreamAttributes& attributes, QAnyStringView name);
+
+  /* Parse yes/no, true/false, etc. from text. ok is false if text is not a valid bool value. */
+  static bool parseBool(QStringView text, bool& ok);
+
   QXmlStreamReader *reader = nullptr;
   QString errorMsg = tr("Cannot open file %1. Reason: %2"), filename;
 
+  /* Reused buffer for readElementTextView() */
+  QString textBuffer;
+
 };
 
 } // namespace util
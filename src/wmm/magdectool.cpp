@@ -35,9 +35,12 @@ extern "C" {
 
 #include <QCoreApplication>
 #include <QDataStream>
+#include <QDebug>
 #include <QDir>
 #include <QFile>
 #include <QList>
+#include <QThreadPool>
+#include <QtEndian>
 
 #include <cstring>
 
@@ -163,6 +166,22 @@ QString MagDecTool::getVersion() const
   return VERSIONDATE_LARGE;
 }
 
+QString MagDecTool::getModelKey()
+{
+  // First line contains epoch, model name and release date like "2025.0 WMM-2025 11/13/2024"
+  QString header;
+  QFile file(QStringLiteral(":/atools/resources/wmm/WMM.COF"));
+  if(file.open(QIODevice::ReadOnly))
+  {
+    header = QString::fromLatin1(file.readLine()).simplified();
+    file.close();
+  }
+  else
+    qWarning() << Q_FUNC_INFO << "Cannot open" << file.fileName();
+
+  return QStringLiteral(VERSIONDATE_LARGE) + QStringLiteral(" ") + header;
+}
+
 float MagDecTool::getMagVar(const geo::Pos& pos)
 {
   if(pos.nearGrid(1.f, atools::geo::Pos::POS_EPSILON_500M))
@@ -198,14 +217,23 @@ QList<float> MagDecTool::readGeoidBuffer()
   QFile file(":/atools/resources/wmm/EGM9615.buf");
   if(file.open(QIODevice::ReadOnly))
   {
-    QDataStream ds(&file);
-    ds.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    // Convert big endian single precision floats as written by QDataStream in one pass.
+    // Use the resource data directly if it is stored uncompressed.
+    qsizetype size = static_cast<qsizetype>(file.size());
+    QByteArray bytes;
+    const uchar *data = file.map(0, size);
+    if(data == nullptr)
+    {
+      bytes = file.readAll();
+      data = reinterpret_cast<const uchar *>(bytes.constData());
+      size = bytes.size();
+    }
 
-    while(!ds.atEnd())
+    retval.resize(size / static_cast<qsizetype>(sizeof(float)));
+    for(qsizetype i = 0; i < retval.size(); i++)
     {
-      float value;
-      ds >> value;
-      retval.append(value);
+      quint32 value = qFromBigEndian<quint32>(data + i * static_cast<qsizetype>(sizeof(float)));
+      std::memcpy(&retval[i], &value, sizeof(float));
     }
     file.close();
   }
@@ -232,78 +260,75 @@ QList<float> MAG_GridInternal(int year, int month, MAGtype_MagneticModel *magnet
   maximum.UseGeoid = 1;
 
   // Only one date - no range
-  MAGtype_Date startdate, enddate;
-  startdate.DecimalYear = enddate.DecimalYear = year + (month - 1) / 12.;
+  MAGtype_Date startdate;
+  startdate.DecimalYear = year + (month - 1) / 12.;
 
-  int numTerms;
-  double b, c;
+  int numTerms = ((magneticModel->nMax + 1) * (magneticModel->nMax + 2) / 2);
 
-  MAGtype_MagneticModel *timedMagneticModel;
-  MAGtype_CoordSpherical coordSpherical;
-  MAGtype_MagneticResults magneticResultsSph, magneticResultsGeo, magneticResultsSphVar, magneticResultsGeoVar;
-  MAGtype_SphericalHarmonicVariables *sphericalVariables;
-  MAGtype_GeoMagneticElements geoMagneticElements, errors;
-  MAGtype_LegendreFunction *legendreFunction;
+  // Coefficients depend only on the date - modify once and share read only between all threads
+  MAGtype_MagneticModel *timedMagneticModel = MAG_AllocateModelMemory(numTerms);
+  MAG_TimelyModifyMagneticModel(startdate, magneticModel, timedMagneticModel);
 
-  double cord_step_size = 1.;
-  if(fabs(cord_step_size) < 1.0e-10)
-    cord_step_size = 99999.0; // checks to make sure that the step_size is not too small
-
-  numTerms = ((magneticModel->nMax + 1) * (magneticModel->nMax + 2) / 2);
-  timedMagneticModel = MAG_AllocateModelMemory(numTerms);
-  legendreFunction = MAG_AllocateLegendreFunctionMemory(numTerms); // For storing the ALF functions
-  sphericalVariables = MAG_AllocateSphVarMemory(magneticModel->nMax);
+  const int numLon = static_cast<int>(maximum.lambda - minimum.lambda) + 1;
+  const int numLat = static_cast<int>(maximum.phi - minimum.phi) + 1;
 
   QList<float> retval;
-  retval.reserve(360 * 181);
+  retval.resize(numLon * numLat);
+  float *data = retval.data();
 
-  b = minimum.phi;
-  c = minimum.lambda;
-  for(minimum.phi = b; minimum.phi <= maximum.phi; minimum.phi += cord_step_size) // Latitude Y loop
+  // Calculate latitude bands in parallel - each task writes only its own row
+  QThreadPool pool;
+  for(int row = 0; row < numLat; row++)
   {
-    for(minimum.lambda = c; minimum.lambda <= maximum.lambda; minimum.lambda += cord_step_size) // Longitude X loop
-    {
-      if(geoid->UseGeoid == 1)
-        // This converts the height above mean sea level to height above the WGS-84 ellipsoid
-        MAG_ConvertGeoidToEllipsoidHeight(&minimum, geoid);
-      else
-        minimum.HeightAboveEllipsoid = minimum.HeightAboveGeoid;
+    pool.start([ = ]() {
+          MAGtype_CoordSpherical coordSpherical;
+          MAGtype_MagneticResults magneticResultsSph, magneticResultsGeo;
+          MAGtype_GeoMagneticElements geoMagneticElements;
+
+          // Work memory for each thread
+          MAGtype_LegendreFunction *legendreFunction = MAG_AllocateLegendreFunctionMemory(numTerms);
+          MAGtype_SphericalHarmonicVariables *sphericalVariables = MAG_AllocateSphVarMemory(magneticModel->nMax);
+
+          MAGtype_CoordGeodetic coord = minimum;
+          coord.phi = minimum.phi + row; // Latitude Y
 
-      MAG_GeodeticToSpherical(ellipsoid, minimum, &coordSpherical);
+          for(int col = 0; col < numLon; col++)
+          {
+            coord.lambda = minimum.lambda + col; // Longitude X
 
-      // Compute Spherical Harmonic variables
-      MAG_ComputeSphericalHarmonicVariables(ellipsoid, coordSpherical, magneticModel->nMax, sphericalVariables);
+            if(geoid->UseGeoid == 1)
+              // This converts the height above mean sea level to height above the WGS-84 ellipsoid
+              MAG_ConvertGeoidToEllipsoidHeight(&coord, geoid);
+            else
+              coord.HeightAboveEllipsoid = coord.HeightAboveGeoid;
 
-      // Compute ALF  Equations 5-6, WMM Technical report
-      MAG_AssociatedLegendreFunction(coordSpherical, magneticModel->nMax, legendreFunction);
+            MAG_GeodeticToSpherical(ellipsoid, coord, &coordSpherical);
 
-      // This modifies the Magnetic coefficients to the correct date.
-      MAG_TimelyModifyMagneticModel(startdate, magneticModel, timedMagneticModel);
+            // Compute Spherical Harmonic variables
+            MAG_ComputeSphericalHarmonicVariables(ellipsoid, coordSpherical, magneticModel->nMax, sphericalVariables);
 
-      // Accumulate the spherical harmonic coefficients Equations 10:12 , WMM Technical report
-      MAG_Summation(legendreFunction, timedMagneticModel, *sphericalVariables, coordSpherical, &magneticResultsSph);
+            // Compute ALF  Equations 5-6, WMM Technical report
+            MAG_AssociatedLegendreFunction(coordSpherical, magneticModel->nMax, legendreFunction);
 
-      // Sum the Secular Variation Coefficients, Equations 13:15 , WMM Technical report
-      MAG_SecVarSummation(legendreFunction, timedMagneticModel, *sphericalVariables, coordSpherical,
-                          &magneticResultsSphVar);
+            // Accumulate the spherical harmonic coefficients Equations 10:12 , WMM Technical report
+            MAG_Summation(legendreFunction, timedMagneticModel, *sphericalVariables, coordSpherical, &magneticResultsSph);
 
-      // Map the computed Magnetic fields to Geodetic coordinates Equation 16 , WMM Technical report
-      MAG_RotateMagneticVector(coordSpherical, minimum, magneticResultsSph, &magneticResultsGeo);
+            // Map the computed Magnetic fields to Geodetic coordinates Equation 16 , WMM Technical report
+            MAG_RotateMagneticVector(coordSpherical, coord, magneticResultsSph, &magneticResultsGeo);
 
-      // Map the secular variation field components to Geodetic coordinates, Equation 17 , WMM Technical report
-      MAG_RotateMagneticVector(coordSpherical, minimum, magneticResultsSphVar, &magneticResultsGeoVar);
+            // Calculate the Geomagnetic elements, Equation 18 , WMM Technical report
+            MAG_CalculateGeoMagneticElements(&magneticResultsGeo, &geoMagneticElements);
 
-      // Calculate the Geomagnetic elements, Equation 18 , WMM Technical report
-      MAG_CalculateGeoMagneticElements(&magneticResultsGeo, &geoMagneticElements);
-      MAG_WMMErrorCalc(geoMagneticElements.H, &errors);
+            data[row * numLon + col] = static_cast<float>(geoMagneticElements.Decl);
+          } // Longitude Loop
 
-      retval.append(static_cast<float>(geoMagneticElements.Decl));
-    } // Longitude Loop
+          MAG_FreeLegendreMemory(legendreFunction);
+          MAG_FreeSphVarMemory(sphericalVariables);
+        });
   } // Latitude Loop
+  pool.waitForDone();
 
   MAG_FreeMagneticModelMemory(timedMagneticModel);
-  MAG_FreeLegendreMemory(legendreFunction);
-  MAG_FreeSphVarMemory(sphericalVariables);
 
   return retval;
 }
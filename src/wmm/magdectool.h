@@ -53,6 +53,10 @@ public:
   /* Get version information for the GeomagnetismLibrary */
   QString getVersion() const;
 
+  /* Identifies the library version and the coefficient file like "WMM-2025 2025.0 11/13/2024".
+   * Changes if the model is updated. Used as key for cached grids. */
+  static QString getModelKey();
+
   /* Get magnetic variance/declination. Positive is east and negative is west. */
   float getMagVar(const atools::geo::Pos& pos);
 
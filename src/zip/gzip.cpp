@@ -22,14 +22,28 @@
 #include <QByteArray>
 #include <QFile>
 #include <QDebug>
+#include <QThread>
+#include <QThreadPool>
+
+#include <vector>
 
 #define GZIP_WINDOWS_BIT 15 + 16
 #define GZIP_CHUNK_SIZE 32 * 1024
 
+/* Raw deflate without header and trailer for parallel compression */
+#define GZIP_RAW_WINDOWS_BIT -15
+
+/* Dictionary size taken from the end of the previous block. Equals the maximum deflate window. */
+#define GZIP_DICT_SIZE 32 * 1024
+
+/* Compress larger data in parallel */
+#define GZIP_PARALLEL_MIN_SIZE 4 * 1024 * 1024
+
 namespace atools {
 namespace zip {
 
-bool gzipCompress(const QByteArray& input, QByteArray& output, int level)
+/* Compress in calling thread */
+static bool gzipCompressSingle(const QByteArray& input, QByteArray& output, int level)
 {
   // Prepare output
   output.clear();
@@ -123,6 +137,234 @@ bool gzipCompress(const QByteArray& input, QByteArray& output, int level)
     return true;
 }
 
+bool gzipCompress(const QByteArray& input, QByteArray& output, int level)
+{
+  // Use all cores for large data
+  if(input.size() >= GZIP_PARALLEL_MIN_SIZE && QThread::idealThreadCount() > 1)
+    return gzipCompressParallel(input, output, level);
+  else
+    return gzipCompressSingle(input, output, level);
+}
+
+/* One block of the input for parallel compression */
+struct GzipBlock
+{
+  qsizetype offset, size;
+  QByteArray compressed;
+  uLong crc;
+  bool ok;
+};
+
+/* Raw deflate of one block using the previous data as dictionary. The last block finishes the stream and
+ * all others end with a sync flush to align them to a byte boundary for concatenation. */
+static bool deflateBlock(const QByteArray& input, GzipBlock& block, int level, bool last)
+{
+  z_stream strm;
+  strm.zalloc = Z_NULL;
+  strm.zfree = Z_NULL;
+  strm.opaque = Z_NULL;
+
+  if(deflateInit2(&strm, level, Z_DEFLATED, GZIP_RAW_WINDOWS_BIT, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    return false;
+
+  const Bytef *data = reinterpret_cast<const Bytef *>(input.constData());
+
+  // Allows back references into the previous block as a sequential compressor would do
+  if(block.offset > 0)
+  {
+    qsizetype dictSize = qMin(static_cast<qsizetype>(GZIP_DICT_SIZE), block.offset);
+    deflateSetDictionary(&strm, data + block.offset - dictSize, static_cast<uInt>(dictSize));
+  }
+
+  // Bound is for Z_FINISH - add space for the sync flush marker
+  block.compressed.resize(static_cast<qsizetype>(deflateBound(&strm, static_cast<uLong>(block.size))) + 64);
+
+  strm.next_in = const_cast<Bytef *>(data + block.offset);
+  strm.avail_in = static_cast<uInt>(block.size);
+  strm.next_out = reinterpret_cast<Bytef *>(block.compressed.data());
+  strm.avail_out = static_cast<uInt>(block.compressed.size());
+
+  int ret = deflate(&strm, last ? Z_FINISH : Z_SYNC_FLUSH);
+  bool ok = last ? ret == Z_STREAM_END : (ret == Z_OK && strm.avail_in == 0 && strm.avail_out > 0);
+
+  block.compressed.resize(static_cast<qsizetype>(strm.total_out));
+  block.crc = crc32(crc32(0L, Z_NULL, 0), data + block.offset, static_cast<uInt>(block.size));
+
+  deflateEnd(&strm);
+  return ok;
+}
+
+bool gzipCompressParallel(const QByteArray& input, QByteArray& output, int level, int blockSize, int numThreads)
+{
+  output.clear();
+  blockSize = qMax(blockSize, GZIP_DICT_SIZE);
+
+  if(numThreads <= 0)
+    numThreads = QThread::idealThreadCount();
+
+  // Not worth the overhead
+  if(input.size() < blockSize * 2LL || numThreads < 2)
+    return gzipCompressSingle(input, output, level);
+
+  level = qMax(-1, qMin(9, level));
+
+  std::vector<GzipBlock> blocks;
+  for(qsizetype offset = 0; offset < input.size(); offset += blockSize)
+    blocks.push_back({offset, qMin(static_cast<qsizetype>(blockSize), input.size() - offset), QByteArray(), 0L, false});
+
+  // Index of the next block to take
+  QAtomicInt nextBlock(0);
+  int numBlocks = static_cast<int>(blocks.size());
+  GzipBlock *blockData = blocks.data();
+
+  QThreadPool pool;
+  int threads = qMin(numThreads, numBlocks);
+  pool.setMaxThreadCount(threads);
+
+  for(int t = 0; t < threads; t++)
+  {
+    pool.start([&input, &nextBlock, blockData, numBlocks, level]() -> void {
+      int index;
+      while((index = nextBlock.fetchAndAddRelaxed(1)) < numBlocks)
+        blockData[index].ok = deflateBlock(input, blockData[index], level, index == numBlocks - 1);
+    });
+  }
+
+  pool.waitForDone();
+
+  // Header with magic number, deflate method, no flags, no timestamp, no extra flags and unknown OS
+  static const char HEADER[] = {'\x1f', '\x8b', '\x08', '\x00', '\x00', '\x00', '\x00', '\x00', '\x00', '\xff'};
+
+  qsizetype size = static_cast<qsizetype>(sizeof(HEADER)) + 8;
+  for(const GzipBlock& block : blocks)
+    size += block.compressed.size();
+  output.reserve(size);
+  output.append(HEADER, sizeof(HEADER));
+
+  uLong crc = crc32(0L, Z_NULL, 0);
+  for(const GzipBlock& block : blocks)
+  {
+    if(!block.ok)
+    {
+      qWarning() << Q_FUNC_INFO << "Error compressing block at" << block.offset;
+      output.clear();
+      return false;
+    }
+
+    output.append(block.compressed);
+    crc = crc32_combine(crc, block.crc, static_cast<z_off_t>(block.size));
+  }
+
+  // Trailer with CRC and uncompressed size modulo 2^32 in little endian
+  quint32 isize = static_cast<quint32>(input.size());
+  for(int i = 0; i < 4; i++)
+    output.append(static_cast<char>((crc >> (i * 8)) & 0xff));
+  for(int i = 0; i < 4; i++)
+    output.append(static_cast<char>((isize >> (i * 8)) & 0xff));
+
+  return true;
+}
+
+bool gzipCompress(QIODevice *input, QIODevice *output, int level)
+{
+  z_stream strm;
+  strm.zalloc = Z_NULL;
+  strm.zfree = Z_NULL;
+  strm.opaque = Z_NULL;
+  strm.avail_in = 0;
+  strm.next_in = Z_NULL;
+
+  if(deflateInit2(&strm, qMax(-1, qMin(9, level)), Z_DEFLATED, GZIP_WINDOWS_BIT, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    return false;
+
+  char in[GZIP_CHUNK_SIZE];
+  char out[GZIP_CHUNK_SIZE];
+  int ret = Z_OK, flush = Z_NO_FLUSH;
+
+  do
+  {
+    qint64 read = input->read(in, GZIP_CHUNK_SIZE);
+    if(read < 0)
+      break;
+
+    flush = input->atEnd() ? Z_FINISH : Z_NO_FLUSH;
+    strm.next_in = reinterpret_cast<Bytef *>(in);
+    strm.avail_in = static_cast<uInt>(read);
+
+    do
+    {
+      strm.next_out = reinterpret_cast<Bytef *>(out);
+      strm.avail_out = GZIP_CHUNK_SIZE;
+
+      ret = deflate(&strm, flush);
+      if(ret == Z_STREAM_ERROR)
+        break;
+
+      qint64 have = GZIP_CHUNK_SIZE - strm.avail_out;
+      if(have > 0 && output->write(out, have) != have)
+        ret = Z_STREAM_ERROR;
+    } while(strm.avail_out == 0 && ret != Z_STREAM_ERROR);
+  } while(flush != Z_FINISH && ret != Z_STREAM_ERROR);
+
+  deflateEnd(&strm);
+  return ret == Z_STREAM_END;
+}
+
+bool gzipDecompress(QIODevice *input, QIODevice *output)
+{
+  z_stream strm;
+  strm.zalloc = Z_NULL;
+  strm.zfree = Z_NULL;
+  strm.opaque = Z_NULL;
+  strm.avail_in = 0;
+  strm.next_in = Z_NULL;
+
+  if(inflateInit2(&strm, GZIP_WINDOWS_BIT) != Z_OK)
+    return false;
+
+  char in[GZIP_CHUNK_SIZE];
+  char out[GZIP_CHUNK_SIZE];
+  int ret = Z_OK;
+  bool error = false, outputFull = false;
+
+  while(!error)
+  {
+    // Read more only if all input is consumed and inflate has no pending output
+    if(strm.avail_in == 0 && !outputFull)
+    {
+      qint64 read = input->read(in, GZIP_CHUNK_SIZE);
+      if(read <= 0)
+        // End of input or error
+        break;
+
+      strm.next_in = reinterpret_cast<Bytef *>(in);
+      strm.avail_in = static_cast<uInt>(read);
+    }
+
+    strm.next_out = reinterpret_cast<Bytef *>(out);
+    strm.avail_out = GZIP_CHUNK_SIZE;
+
+    ret = inflate(&strm, Z_NO_FLUSH);
+    if(ret == Z_NEED_DICT || ret == Z_DATA_ERROR || ret == Z_MEM_ERROR || ret == Z_STREAM_ERROR)
+    {
+      error = true;
+      break;
+    }
+
+    qint64 have = GZIP_CHUNK_SIZE - strm.avail_out;
+    if(have > 0 && output->write(out, have) != have)
+      error = true;
+    outputFull = strm.avail_out == 0;
+
+    // Continue with the next member if files were concatenated
+    if(ret == Z_STREAM_END && (strm.avail_in > 0 || !input->atEnd()))
+      inflateReset(&strm);
+  }
+
+  inflateEnd(&strm);
+  return !error && ret == Z_STREAM_END;
+}
+
 bool gzipDecompress(const QByteArray& input, QByteArray& output)
 {
   // Prepare output
@@ -24,6 +24,7 @@
 
 class QByteArray;
 class QString;
+class QIODevice;
 
 /* Gzip compression support functions
  * https://www.ietf.org/rfc/rfc1952.txt
@@ -45,6 +46,24 @@ bool isGzipCompressed(const QByteArray& bytes);
 bool gzipCompress(const QByteArray& input, QByteArray& output, int level = -1);
 QByteArray gzipCompress(const QByteArray& input, int level = -1);
 
+/**
+ * @brief Compresses the given buffer in parallel by splitting it into blocks like pigz
+ * Each block is deflated in a separate thread using the end of the previous block as dictionary.
+ * The result is a single standard GZIP member which can be read by all decompressors.
+ * Falls back to single threaded compression for small input.
+ * @param blockSize Size of uncompressed blocks in bytes. Minimum is 32 kB.
+ * @param numThreads Number of threads. Uses QThread::idealThreadCount() if 0.
+ */
+bool gzipCompressParallel(const QByteArray& input, QByteArray& output, int level = -1, int blockSize = 128 * 1024,
+                          int numThreads = 0);
+
+/**
+ * @brief Streaming compression reading from input device and writing to output device
+ * Devices have to be open. Memory usage is independent of data size.
+ * @return @c true if the compression was successful, @c false otherwise
+ */
+bool gzipCompress(QIODevice *input, QIODevice *output, int level = -1);
+
 /**
  * @brief Decompresses the given buffer using the standard GZIP algorithm
  * @param input The buffer to be decompressed
@@ -54,6 +73,13 @@ QByteArray gzipCompress(const QByteArray& input, int level = -1);
 bool gzipDecompress(const QByteArray& input, QByteArray& output);
 QByteArray gzipDecompress(const QByteArray& input);
 
+/**
+ * @brief Streaming decompression reading from input device and writing to output device
+ * Devices have to be open. Memory usage is independent of data size. Concatenated GZIP members are supported.
+ * @return @c true if the decompression was successful, @c false otherwise
+ */
+bool gzipDecompress(QIODevice *input, QIODevice *output);
+
 /** Decompresses if gzip compressed
  * @return @c true if the decompression was successfull, @c false otherwise
  */
@@ -0,0 +1,218 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "zip/gzipdevice.h"
+
+#include <QDebug>
+
+#include <algorithm>
+#include <limits>
+
+/* Window bits for Gzip header and trailer */
+#define GZIP_DEVICE_WINDOWS_BIT 15 + 16
+#define GZIP_DEVICE_CHUNK_SIZE 32 * 1024
+
+namespace atools {
+namespace zip {
+
+GzipDevice::GzipDevice(QIODevice *deviceParam, int levelParam, QObject *parent)
+  : QIODevice(parent), device(deviceParam), level(levelParam)
+{
+  strm.zalloc = Z_NULL;
+  strm.zfree = Z_NULL;
+  strm.opaque = Z_NULL;
+  strm.avail_in = 0;
+  strm.next_in = Z_NULL;
+}
+
+GzipDevice::~GzipDevice()
+{
+  if(isOpen())
+    close();
+}
+
+bool GzipDevice::open(OpenMode mode)
+{
+  // Text mode conversion is not supported
+  mode.setFlag(QIODevice::Text, false);
+
+  if(mode != QIODevice::ReadOnly && mode != QIODevice::WriteOnly)
+  {
+    qWarning() << Q_FUNC_INFO << "Unsupported mode" << mode;
+    return false;
+  }
+
+  if(device == nullptr || !device->isOpen())
+  {
+    qWarning() << Q_FUNC_INFO << "Device not open";
+    return false;
+  }
+
+  int ret;
+  strm.avail_in = 0;
+  strm.next_in = Z_NULL;
+  if(mode == QIODevice::WriteOnly)
+    ret = deflateInit2(&strm, level, Z_DEFLATED, GZIP_DEVICE_WINDOWS_BIT, 8, Z_DEFAULT_STRATEGY);
+  else
+    ret = inflateInit2(&strm, GZIP_DEVICE_WINDOWS_BIT);
+
+  if(ret != Z_OK)
+  {
+    qWarning() << Q_FUNC_INFO << "Init failed" << ret;
+    return false;
+  }
+
+  initialized = true;
+  streamEnd = false;
+  buffer.resize(GZIP_DEVICE_CHUNK_SIZE);
+  return QIODevice::open(mode);
+}
+
+void GzipDevice::close()
+{
+  if(initialized)
+  {
+    if(openMode() & QIODevice::WriteOnly)
+    {
+      // Flush pending data and write trailer
+      if(!deflateToDevice(Z_FINISH))
+        qWarning() << Q_FUNC_INFO << "Error finishing stream";
+      deflateEnd(&strm);
+    }
+    else
+      inflateEnd(&strm);
+    initialized = false;
+  }
+
+  buffer.clear();
+  QIODevice::close();
+}
+
+bool GzipDevice::atEnd() const
+{
+  return streamEnd && QIODevice::bytesAvailable() == 0;
+}
+
+qint64 GzipDevice::bytesAvailable() const
+{
+  // Decompressed size is unknown - report at least one byte until the end is reached
+  return QIODevice::bytesAvailable() + (streamEnd ? 0 : 1);
+}
+
+qint64 GzipDevice::readData(char *data, qint64 maxSize)
+{
+  if(!initialized || streamEnd)
+    return streamEnd ? -1 : 0;
+
+  strm.next_out = reinterpret_cast<Bytef *>(data);
+  strm.avail_out = static_cast<uInt>(std::min(maxSize, static_cast<qint64>(std::numeric_limits<uInt>::max())));
+
+  while(strm.avail_out > 0)
+  {
+    if(strm.avail_in == 0)
+    {
+      qint64 read = device->read(buffer.data(), buffer.size());
+      if(read < 0)
+      {
+        setErrorString(device->errorString());
+        return -1;
+      }
+      else if(read == 0)
+      {
+        // No more input - stream ends here even if truncated
+        if(!device->isSequential() || device->atEnd())
+          streamEnd = true;
+        break;
+      }
+
+      strm.next_in = reinterpret_cast<Bytef *>(buffer.data());
+      strm.avail_in = static_cast<uInt>(read);
+    }
+
+    int ret = inflate(&strm, Z_NO_FLUSH);
+    if(ret == Z_NEED_DICT || ret == Z_DATA_ERROR || ret == Z_MEM_ERROR || ret == Z_STREAM_ERROR)
+    {
+      setErrorString(tr("Error decompressing Gzip data: %1").arg(strm.msg != nullptr ? strm.msg : QString::number(ret)));
+      return -1;
+    }
+
+    if(ret == Z_STREAM_END)
+    {
+      // Continue with the next member if files were concatenated
+      if(strm.avail_in > 0 || !device->atEnd())
+        inflateReset(&strm);
+      else
+      {
+        streamEnd = true;
+        break;
+      }
+    }
+  }
+
+  qint64 have = maxSize - strm.avail_out;
+  return have == 0 && streamEnd ? -1 : have;
+}
+
+qint64 GzipDevice::writeData(const char *data, qint64 maxSize)
+{
+  if(!initialized)
+    return -1;
+
+  // Pass input in pieces since avail_in is limited to uInt
+  const char *end = data + maxSize;
+  for(const char *cur = data; cur < end; )
+  {
+    qint64 size = std::min(end - cur, static_cast<qint64>(std::numeric_limits<uInt>::max()));
+    strm.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(cur));
+    strm.avail_in = static_cast<uInt>(size);
+
+    if(!deflateToDevice(Z_NO_FLUSH))
+      return -1;
+    cur += size;
+  }
+  return maxSize;
+}
+
+bool GzipDevice::deflateToDevice(int flush)
+{
+  int ret;
+  do
+  {
+    strm.next_out = reinterpret_cast<Bytef *>(buffer.data());
+    strm.avail_out = static_cast<uInt>(buffer.size());
+
+    ret = deflate(&strm, flush);
+    if(ret == Z_STREAM_ERROR)
+    {
+      setErrorString(tr("Error compressing Gzip data"));
+      return false;
+    }
+
+    qint64 have = buffer.size() - strm.avail_out;
+    if(have > 0 && device->write(buffer.constData(), have) != have)
+    {
+      setErrorString(device->errorString());
+      return false;
+    }
+    // Deflate has more output if the buffer was filled completely
+  } while(strm.avail_out == 0 || (flush == Z_FINISH && ret != Z_STREAM_END));
+
+  return true;
+}
+
+} // namespace zip
+} // namespace atools
@@ -0,0 +1,87 @@
+/*****************************************************************************
+* Copyright 2015-2025 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ATOOLS_ZIP_GZIPDEVICE_H
+#define ATOOLS_ZIP_GZIPDEVICE_H
+
+#include <QIODevice>
+
+#include <zlib.h>
+
+namespace atools {
+namespace zip {
+
+/*
+ * Sequential device which compresses or decompresses Gzip data on the fly while passing it to or from another device.
+ * Allows to write or read large files through QXmlStreamWriter or QXmlStreamReader with flat memory usage.
+ *
+ * Open with QIODevice::WriteOnly to compress everything written into the underlying device or
+ * with QIODevice::ReadOnly to decompress the underlying device. The underlying device has to be opened by the caller
+ * and is neither closed nor deleted. Concatenated Gzip members are read as one stream.
+ *
+ * close() has to be called after writing to flush remaining data and write the Gzip trailer.
+ */
+class GzipDevice
+  : public QIODevice
+{
+  Q_OBJECT
+
+public:
+  /* level is the compression level for writing. -1 is default. */
+  explicit GzipDevice(QIODevice *deviceParam, int levelParam = -1, QObject *parent = nullptr);
+  virtual ~GzipDevice() override;
+
+  GzipDevice(const GzipDevice& other) = delete;
+  GzipDevice& operator=(const GzipDevice& other) = delete;
+
+  /* Only ReadOnly and WriteOnly are supported */
+  virtual bool open(QIODevice::OpenMode mode) override;
+
+  /* Finishes the stream when writing */
+  virtual void close() override;
+
+  virtual bool isSequential() const override
+  {
+    return true;
+  }
+
+  virtual bool atEnd() const override;
+
+  virtual qint64 bytesAvailable() const override;
+
+protected:
+  virtual qint64 readData(char *data, qint64 maxSize) override;
+  virtual qint64 writeData(const char *data, qint64 maxSize) override;
+
+private:
+  /* Deflate all given input and write output to device. Returns false on error. */
+  bool deflateToDevice(int flush);
+
+  QIODevice *device;
+  int level;
+
+  z_stream strm;
+  bool initialized = false, streamEnd = false;
+
+  /* Compressed data read from device or compressed data to write */
+  QByteArray buffer;
+};
+
+} // namespace zip
+} // namespace atools
+
+#endif // ATOOLS_ZIP_GZIPDEVICE_H